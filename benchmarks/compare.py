@@ -0,0 +1,363 @@
+#!/usr/bin/env python3
+"""
+Cross-implementation benchmark of the three stacks on the same workloads.
+
+  seal       microsoft-seal's C++ backends, over their HTTP API (mini-backend
+             encrypts and decrypts, main-backend computes)
+  node-seal  node-seal's bindings, in a node subprocess (node-seal-driver.mjs)
+  tenseal    TenSEAL's bindings, in a python subprocess (this file, --worker)
+
+The workloads (workloads.json) are defined once. The inputs are generated
+here from the seed and handed to every stack: values for encrypt, sum and
+average, and standardized diabetes.csv rows for inference. Each stack runs
+a workload in the way it would serve it:
+
+  encrypt    N values, packed into as few ciphertexts as the slots allow,
+             serialized
+  sum        the total of N encrypted values, reduced to one slot
+  average    the same, divided by N under encryption
+  inference  logistic regression scores, 0.5 + 0.1973 x - 0.0048 x^3 with
+             x = w . features + b, feature-major (one ciphertext per feature)
+
+A run's latency is what a client of the stack sees. For seal that is an
+HTTP round trip, including Base64 and JSON. For the other two it is the
+in-process call. Keys and the input ciphertexts are built before the
+timed runs. Results are decrypted and checked against the plaintext
+computation.
+
+Reported per stack and workload (results.json, results.csv):
+  latency_ms_median, latency_ms_p95  over the repeated runs
+  throughput_per_s                   values (patients) per second at the median
+  ciphertext_bytes                   serialized inputs, with the stack's
+                                     default compression
+  rss_mb                             peak RSS of the subprocess. For seal it is the
+                                     sum of both backends' current RSS after the runs,
+                                     from /metrics.
+  max_error, ok                      against the plaintext result
+  params                             the encryption parameters the stack used
+
+Usage:
+  python3 benchmarks/compare.py [--stacks seal,node-seal,tenseal]
+      [--workloads benchmarks/workloads.json] [--only sum-4k,...]
+      [--repeat 5] [--out benchmarks/results]
+      [--mini http://localhost:18081] [--main http://localhost:18080]
+      [--node node]
+
+Only the Python standard library is needed here; TenSEAL must be importable by
+the same interpreter, and node-seal installed in node-seal/backend.
+"""
+
+import argparse
+import csv
+import json
+import os
+import platform
+import random
+import re
+import resource
+import statistics
+import subprocess
+import sys
+import time
+import urllib.request
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+SIGMOID = [0.5, 0.1973, 0.0, -0.0048]  # x^0 .. x^3, as fullyEndtoEndLogisticRegression.py
+RELATIVE_TOLERANCE = 1e-3  # CKKS sums and averages
+SCORE_TOLERANCE = 1e-2     # Inference scores, absolute
+
+
+# ==================== Workload inputs ====================
+
+def make_inputs(workload, seed):
+    """The plaintext inputs of a workload and the results every stack must reproduce"""
+    rng = random.Random(f"{seed}:{workload['name']}")
+    if workload["op"] in ("encrypt", "sum", "average"):
+        values = [float(rng.randrange(1000)) for _ in range(workload["values"])]
+        total = sum(values)
+        expected = {"encrypt": values, "sum": [total], "average": [total / len(values)]}[workload["op"]]
+        return {"values": values}, expected
+
+    if workload["op"] == "inference":
+        path = os.path.join(HERE, workload["dataset"])
+        with open(path, newline="") as f:
+            rows = list(csv.reader(f))
+        header, rows = rows[0], rows[1:]
+        # Feature columns: everything but an Id and the Outcome label
+        columns = [i for i, name in enumerate(header) if name not in ("Id", "Outcome")]
+        patients = [[float(row[i]) for i in columns] for row in rows[: workload["patients"]]]
+        features = [list(column) for column in zip(*patients)]
+        for column in features:
+            mean = statistics.fmean(column)
+            scale = statistics.pstdev(column) or 1.0
+            column[:] = [(v - mean) / scale for v in column]
+        weights, bias = workload["weights"], workload["bias"]
+        if len(weights) != len(features):
+            raise ValueError(f"{workload['name']}: {len(weights)} weights for {len(features)} features")
+        expected = []
+        for p in range(len(patients)):
+            x = bias + sum(w * column[p] for w, column in zip(weights, features))
+            expected.append(sum(c * x**k for k, c in enumerate(SIGMOID)))
+        return {"features": features, "weights": weights, "bias": bias, "sigmoid": SIGMOID}, expected
+
+    raise ValueError(f"Unknown op: {workload['op']}")
+
+
+def unit_count(workload):
+    return workload.get("values") or workload.get("patients")
+
+
+# ==================== seal: the C++ backends over HTTP ====================
+
+class SealHttp:
+    """microsoft-seal's mini-backend (encrypt/decrypt) and main-backend (compute)"""
+
+    def __init__(self, mini, main):
+        self.mini = mini.rstrip("/")
+        self.main = main.rstrip("/")
+
+    def post(self, base, path, body):
+        request = urllib.request.Request(base + path, data=json.dumps(body).encode(),
+                                         headers={"Content-Type": "application/json"})
+        with urllib.request.urlopen(request) as response:
+            if response.headers.get("X-HE-Result-Cache"):
+                raise RuntimeError(f"{path} was answered from main-backend's result cache")
+            return json.loads(response.read())
+
+    def rss_bytes(self):
+        total = 0
+        for base in (self.mini, self.main):
+            with urllib.request.urlopen(base + "/metrics") as response:
+                for line in response.read().decode().splitlines():
+                    if line.startswith("process_resident_memory_bytes "):
+                        total += int(float(line.split()[1]))
+        return total
+
+    def run(self, workload, inputs, repeat):
+        op = workload["op"]
+        runs_ms = []
+        if op == "inference":
+            encrypted = self.post(self.mini, "/ml/encrypt_patients", {
+                "patients": [list(p) for p in zip(*inputs["features"])],
+                "scheme": "ckks", "layout": "feature_major", "profile": "ml-inference"})
+            body = {"encrypted_features": encrypted["ciphertexts"], "scheme": "ckks",
+                    "layout": "feature_major", "profile": "ml-inference",
+                    "weights": inputs["weights"], "bias": inputs["bias"], "sigmoid": inputs["sigmoid"]}
+            for _ in range(repeat):
+                start = time.perf_counter()
+                scored = self.post(self.main, "/ml/logreg/predict", body)
+                runs_ms.append((time.perf_counter() - start) * 1000)
+            result = self.post(self.mini, "/ml/decrypt_scores", {
+                "ciphertexts": scored["encrypted_results"], "scheme": "ckks", "count": encrypted["count"],
+                "block_size": encrypted["block_size"], "layout": "feature_major",
+                "profile": "ml-inference"})["scores"]
+            params = "ckks ml-inference profile (n=16384)"
+            return self.report(runs_ms, encrypted["raw_bytes"], result, params)
+
+        values = inputs["values"]
+        if op == "encrypt":
+            for _ in range(repeat):
+                start = time.perf_counter()
+                encrypted = self.post(self.mini, "/encrypt_vector", {"values": values, "scheme": "ckks"})
+                runs_ms.append((time.perf_counter() - start) * 1000)
+            result = self.post(self.mini, "/decrypt_vector", {
+                "ciphertexts": encrypted["ciphertexts"], "scheme": "ckks", "count": len(values)})["values"]
+            return self.report(runs_ms, encrypted["raw_bytes"], result, self.profile_name(encrypted))
+
+        encrypted = self.post(self.mini, "/encrypt_vector", {"values": values, "scheme": "ckks"})
+        path = "/csv/sum" if op == "sum" else "/csv/average"
+        body = {"encrypted_values": encrypted["ciphertexts"], "scheme": "ckks", "packed": True}
+        if op == "average":
+            body["count"] = len(values)
+        for run in range(repeat):
+            # A different body per run keeps main-backend's result cache out of the timings
+            start = time.perf_counter()
+            computed = self.post(self.main, path, dict(body, run=run))
+            runs_ms.append((time.perf_counter() - start) * 1000)
+        result = self.post(self.mini, "/decrypt_vector", {
+            "ciphertexts": [computed["encrypted_result"]], "scheme": "ckks", "count": 1})["values"]
+        if op == "average" and not computed.get("divided_by_count", True):
+            raise RuntimeError("main-backend returned the sum, not the average")
+        return self.report(runs_ms, encrypted["raw_bytes"], result, self.profile_name(encrypted))
+
+    @staticmethod
+    def profile_name(encrypted):
+        return f"ckks {encrypted.get('profile', 'default')} profile ({encrypted.get('slot_count')} slots)"
+
+    def report(self, runs_ms, ciphertext_bytes, result, params):
+        return {"runs_ms": runs_ms, "ciphertext_bytes": ciphertext_bytes, "result": result,
+                "rss_bytes": self.rss_bytes(), "params": params}
+
+
+# ==================== Subprocess stacks ====================
+
+def run_subprocess(command, workload, inputs, repeat):
+    """Run one workload in a fresh process, so its peak RSS is the workload's own"""
+    request = json.dumps({"workload": workload, "inputs": inputs, "repeat": repeat})
+    done = subprocess.run(command, input=request, capture_output=True, text=True)
+    if done.returncode != 0:
+        # The error line of a python or node stack trace, not the whole trace
+        lines = done.stderr.strip().splitlines()
+        errors = [line for line in lines if re.match(r"\w*Error\b", line)]
+        raise RuntimeError((errors or lines or [f"{command[0]} exited with {done.returncode}"])[-1])
+    return json.loads(done.stdout)
+
+
+def tenseal_worker():
+    """--worker: one workload on TenSEAL, request on stdin, report on stdout"""
+    import tenseal as ts
+
+    request = json.load(sys.stdin)
+    workload, inputs, repeat = request["workload"], request["inputs"], request["repeat"]
+    op = workload["op"]
+
+    if op == "inference":
+        bits, degree = [60, 40, 40, 40, 40, 60], 16384
+    else:
+        bits, degree = [60, 40, 40, 60], 8192
+    context = ts.context(ts.SCHEME_TYPE.CKKS, poly_modulus_degree=degree, coeff_mod_bit_sizes=bits)
+    context.global_scale = 2**40
+    context.generate_galois_keys()
+    context.generate_relin_keys()
+    slots = degree // 2
+
+    def encrypt(values):
+        return [ts.ckks_vector(context, values[i : i + slots]) for i in range(0, len(values), slots)]
+
+    runs_ms = []
+    if op == "inference":
+        encrypted = [ts.ckks_vector(context, column) for column in inputs["features"]]
+        for _ in range(repeat):
+            start = time.perf_counter()
+            x = encrypted[0] * inputs["weights"][0]
+            for ct, w in zip(encrypted[1:], inputs["weights"][1:]):
+                x += ct * w
+            x += inputs["bias"]
+            scores = x.polyval(inputs["sigmoid"])
+            runs_ms.append((time.perf_counter() - start) * 1000)
+        result = scores.decrypt()
+    elif op == "encrypt":
+        for _ in range(repeat):
+            start = time.perf_counter()
+            serialized = [ct.serialize() for ct in encrypt(inputs["values"])]
+            runs_ms.append((time.perf_counter() - start) * 1000)
+        encrypted = [ts.ckks_vector_from(context, s) for s in serialized]
+        result = [v for ct in encrypted for v in ct.decrypt()]
+    else:
+        encrypted = encrypt(inputs["values"])
+        for _ in range(repeat):
+            start = time.perf_counter()
+            total = encrypted[0].copy()
+            for ct in encrypted[1:]:
+                total += ct
+            total = total.sum()
+            if op == "average":
+                total *= 1.0 / len(inputs["values"])
+            runs_ms.append((time.perf_counter() - start) * 1000)
+        result = total.decrypt()[:1]
+
+    json.dump({
+        "runs_ms": runs_ms,
+        "ciphertext_bytes": sum(len(ct.serialize()) for ct in encrypted),
+        "result": result,
+        "rss_bytes": resource.getrusage(resource.RUSAGE_SELF).ru_maxrss * 1024,
+        "params": f"ckks n={degree} {bits}",
+    }, sys.stdout)
+
+
+# ==================== Reports ====================
+
+def summarize(stack, workload, report, expected):
+    runs = sorted(report["runs_ms"])
+    median = statistics.median(runs)
+    p95 = runs[min(len(runs) - 1, int(round(0.95 * (len(runs) - 1))))]
+    result = report["result"]
+    if workload["op"] == "inference":
+        error = max(abs(a - b) for a, b in zip(result, expected))
+        ok = len(result) >= len(expected) and error <= SCORE_TOLERANCE
+    else:
+        error = max(abs(a - b) / max(1.0, abs(b)) for a, b in zip(result, expected))
+        ok = len(result) >= len(expected) and error <= RELATIVE_TOLERANCE
+    return {
+        "stack": stack,
+        "workload": workload["name"],
+        "op": workload["op"],
+        "n": unit_count(workload),
+        "latency_ms_median": round(median, 3),
+        "latency_ms_p95": round(p95, 3),
+        "throughput_per_s": round(unit_count(workload) / (median / 1000), 1) if median > 0 else None,
+        "ciphertext_bytes": report["ciphertext_bytes"],
+        "rss_mb": round(report["rss_bytes"] / 2**20, 1),
+        "max_error": error,
+        "ok": ok,
+        "params": report["params"],
+        "error": "",
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--stacks", default="seal,node-seal,tenseal")
+    parser.add_argument("--workloads", default=os.path.join(HERE, "workloads.json"))
+    parser.add_argument("--only", default="", help="comma-separated workload names")
+    parser.add_argument("--repeat", type=int, default=0, help="runs per workload (default: the file's)")
+    parser.add_argument("--out", default=os.path.join(HERE, "results"))
+    parser.add_argument("--mini", default="http://localhost:18081")
+    parser.add_argument("--main", default="http://localhost:18080")
+    parser.add_argument("--node", default="node")
+    parser.add_argument("--worker", choices=["tenseal"], help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.worker == "tenseal":
+        return tenseal_worker()
+
+    with open(args.workloads) as f:
+        config = json.load(f)
+    repeat = args.repeat or config.get("repeat", 5)
+    only = set(filter(None, args.only.split(",")))
+    workloads = [w for w in config["workloads"] if not only or w["name"] in only]
+
+    runners = {
+        "seal": lambda w, i: SealHttp(args.mini, args.main).run(w, i, repeat),
+        "node-seal": lambda w, i: run_subprocess([args.node, os.path.join(HERE, "node-seal-driver.mjs")],
+                                                 w, i, repeat),
+        "tenseal": lambda w, i: run_subprocess([sys.executable, os.path.abspath(__file__), "--worker=tenseal"],
+                                               w, i, repeat),
+    }
+    stacks = [s for s in args.stacks.split(",") if s]
+    for stack in stacks:
+        if stack not in runners:
+            parser.error(f"unknown stack {stack} ({', '.join(runners)})")
+
+    rows = []
+    for workload in workloads:
+        inputs, expected = make_inputs(workload, config.get("seed", 1))
+        for stack in stacks:
+            try:
+                row = summarize(stack, workload, runners[stack](workload, inputs), expected)
+            except Exception as err:  # One stack failing must not lose the others' numbers
+                row = {"stack": stack, "workload": workload["name"], "op": workload["op"],
+                       "n": unit_count(workload), "ok": False, "error": str(err)}
+            rows.append(row)
+            print(f"{workload['name']:>16} {stack:>9}: " + (
+                f"{row['latency_ms_median']} ms, {row['throughput_per_s']}/s, "
+                f"{row['ciphertext_bytes']} B, {row['rss_mb']} MB{'' if row['ok'] else ', WRONG RESULT'}"
+                if not row["error"] else f"failed: {row['error']}"), file=sys.stderr)
+
+    os.makedirs(args.out, exist_ok=True)
+    with open(os.path.join(args.out, "results.json"), "w") as f:
+        json.dump({"host": {"platform": platform.platform(), "cpus": os.cpu_count(),
+                            "python": platform.python_version()},
+                   "repeat": repeat, "results": rows}, f, indent=2)
+    fields = ["stack", "workload", "op", "n", "latency_ms_median", "latency_ms_p95", "throughput_per_s",
+              "ciphertext_bytes", "rss_mb", "max_error", "ok", "params", "error"]
+    with open(os.path.join(args.out, "results.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields, restval="")
+        writer.writeheader()
+        writer.writerows(rows)
+    return 0 if all(row["ok"] for row in rows) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,181 @@
+/**
+ * node-seal stack of compare.py
+ *
+ * Runs one workload on node-seal: the request ({ workload, inputs, repeat })
+ * on stdin, the report ({ runs_ms, ciphertext_bytes, result, rss_bytes,
+ * params }) on stdout. node-seal is the one installed for node-seal/backend.
+ *
+ * CKKS with the same parameters as the TenSEAL stack: n = 8192 and
+ * [60, 40, 40, 60] for encrypt, sum and average, n = 16384 and
+ * [60, 40, 40, 40, 40, 60] for inference, scale 2^40.
+ */
+
+import { createRequire } from "module";
+import { pathToFileURL } from "url";
+
+const require = createRequire(new URL("../node-seal/backend/package.json", import.meta.url));
+const { default: SEAL } = await import(pathToFileURL(require.resolve("node-seal")).href);
+
+const SCALE = 2 ** 40;
+
+function readStdin() {
+  return new Promise((resolve, reject) => {
+    const chunks = [];
+    process.stdin.on("data", (chunk) => chunks.push(chunk));
+    process.stdin.on("end", () => resolve(Buffer.concat(chunks).toString()));
+    process.stdin.on("error", reject);
+  });
+}
+
+function timed(runsMs, fn) {
+  const start = process.hrtime.bigint();
+  const value = fn();
+  runsMs.push(Number(process.hrtime.bigint() - start) / 1e6);
+  return value;
+}
+
+const { workload, inputs, repeat } = JSON.parse(await readStdin());
+const op = workload.op;
+
+const seal = await SEAL();
+const [degree, bits] = op === "inference" ? [16384, [60, 40, 40, 40, 40, 60]] : [8192, [60, 40, 40, 60]];
+const parms = seal.EncryptionParameters(seal.SchemeType.ckks);
+parms.setPolyModulusDegree(degree);
+parms.setCoeffModulus(seal.CoeffModulus.Create(degree, Int32Array.from(bits)));
+const context = seal.Context(parms, true, seal.SecurityLevel.tc128);
+if (!context.parametersSet()) {
+  throw new Error(`Invalid parameters: ${context.parametersErrorMessage()}`);
+}
+
+const keyGenerator = seal.KeyGenerator(context);
+const encryptor = seal.Encryptor(context, keyGenerator.createPublicKey());
+const decryptor = seal.Decryptor(context, keyGenerator.secretKey());
+const evaluator = seal.Evaluator(context);
+const encoder = seal.CKKSEncoder(context);
+const slots = encoder.slotCount;
+
+/** A plaintext of value in every slot, at the given scale and level */
+function constant(value, scale, parmsId) {
+  const plain = encoder.encode(Float64Array.from({ length: slots }, () => value), scale);
+  if (parmsId) evaluator.plainModSwitchTo(plain, parmsId, plain);
+  return plain;
+}
+
+function encrypt(values) {
+  const ciphertexts = [];
+  for (let i = 0; i < values.length; i += slots) {
+    const plain = encoder.encode(Float64Array.from(values.slice(i, i + slots)), SCALE);
+    ciphertexts.push(encryptor.encrypt(plain));
+    plain.delete();
+  }
+  return ciphertexts;
+}
+
+function decrypt(cipher) {
+  const plain = decryptor.decrypt(cipher);
+  const values = Array.from(encoder.decode(plain));
+  plain.delete();
+  return values;
+}
+
+const runsMs = [];
+let encrypted;
+let result;
+
+if (op === "encrypt") {
+  let serialized;
+  for (let run = 0; run < repeat; run++) {
+    serialized = timed(runsMs, () =>
+      encrypt(inputs.values).map((cipher) => {
+        const bytes = cipher.saveArray();
+        cipher.delete();
+        return bytes;
+      }),
+    );
+  }
+  encrypted = serialized.map((bytes) => {
+    const cipher = seal.CipherText();
+    cipher.loadArray(context, bytes);
+    return cipher;
+  });
+  result = encrypted.flatMap(decrypt).slice(0, inputs.values.length);
+} else if (op === "sum" || op === "average") {
+  const galoisKeys = keyGenerator.createGaloisKeys();
+  encrypted = encrypt(inputs.values);
+  let total;
+  for (let run = 0; run < repeat; run++) {
+    total?.delete();
+    total = timed(runsMs, () => {
+      const sum = encrypted[0].clone();
+      for (let i = 1; i < encrypted.length; i++) evaluator.add(sum, encrypted[i], sum);
+      evaluator.sumElements(sum, galoisKeys, seal.SchemeType.ckks, sum);
+      if (op === "average") {
+        const divisor = constant(1 / inputs.values.length, SCALE, sum.parmsId);
+        evaluator.multiplyPlain(sum, divisor, sum);
+        evaluator.rescaleToNext(sum, sum);
+        divisor.delete();
+      }
+      return sum;
+    });
+  }
+  result = decrypt(total).slice(0, 1);
+} else if (op === "inference") {
+  const relinKeys = keyGenerator.createRelinKeys();
+  encrypted = inputs.features.map((column) => encrypt(column)[0]);
+  const [c0, c1, , c3] = inputs.sigmoid;
+  let scores;
+  for (let run = 0; run < repeat; run++) {
+    scores?.delete();
+    scores = timed(runsMs, () => {
+      const plains = [];
+      const keep = (plain) => (plains.push(plain), plain);
+
+      // x = w . features + b, one rescale for the whole dot product
+      const x = seal.CipherText();
+      const term = seal.CipherText();
+      encrypted.forEach((cipher, f) => {
+        const weight = keep(constant(inputs.weights[f], SCALE));
+        evaluator.multiplyPlain(cipher, weight, f === 0 ? x : term);
+        if (f > 0) evaluator.add(x, term, x);
+      });
+      evaluator.rescaleToNext(x, x);
+      evaluator.addPlain(x, keep(constant(inputs.bias, x.scale, x.parmsId)), x);
+
+      // x^3 = x^2 . x
+      const cube = evaluator.square(x);
+      evaluator.relinearize(cube, relinKeys, cube);
+      evaluator.rescaleToNext(cube, cube);
+      const xLow = evaluator.cipherModSwitchTo(x, cube.parmsId);
+      evaluator.multiply(cube, xLow, cube);
+      evaluator.relinearize(cube, relinKeys, cube);
+      evaluator.rescaleToNext(cube, cube);
+
+      // c3 x^3 + c1 x at the same scale and level, then one rescale; the
+      // scale of c1 is picked so that c1 x lands on the scale of c3 x^3
+      const score = seal.CipherText();
+      evaluator.multiplyPlain(cube, keep(constant(c3, SCALE, cube.parmsId)), score);
+      evaluator.cipherModSwitchTo(x, cube.parmsId, xLow);
+      evaluator.multiplyPlain(xLow, keep(constant(c1, (cube.scale * SCALE) / x.scale, cube.parmsId)), term);
+      term.setScale(score.scale);
+      evaluator.add(score, term, score);
+      evaluator.rescaleToNext(score, score);
+      evaluator.addPlain(score, keep(constant(c0, score.scale, score.parmsId)), score);
+
+      for (const item of [x, term, cube, xLow, ...plains]) item.delete();
+      return score;
+    });
+  }
+  result = decrypt(scores).slice(0, inputs.features[0].length);
+} else {
+  throw new Error(`Unknown op: ${op}`);
+}
+
+process.stdout.write(
+  JSON.stringify({
+    runs_ms: runsMs,
+    ciphertext_bytes: encrypted.reduce((total, cipher) => total + cipher.saveArray().byteLength, 0),
+    result,
+    rss_bytes: process.resourceUsage().maxRSS * 1024,
+    params: `ckks n=${degree} [${bits.join(", ")}]`,
+  }),
+);
@@ -20,6 +20,7 @@ from sklearn.metrics import (
 import time
 import gc
 import os
+import json
 from concrete.ml.sklearn import LogisticRegression as FHELogisticRegression
 from concrete.ml.common.utils import FheMode
 
@@ -123,6 +124,21 @@ brier_plain_test = brier_score_loss(y_test, y_prob_plain)
 print(f"PLAINTEXT Test Log-loss: {ll_plain_test:.4f}")
 print(f"PLAINTEXT Test Brier score: {brier_plain_test:.4f}")
 
+print_header("Model Export", '-')
+# Float weights and the scaler for the C++ backend's /ml/logreg/predict
+# (main-backend --model-dir=models); clients pack the raw selected features
+os.makedirs('models', exist_ok=True)
+model_path = os.path.join('models', 'diabetes_logreg.json')
+with open(model_path, 'w') as f:
+    json.dump({
+        "features": [feature_names[i] if len(feature_names) == X.shape[1] else str(i) for i in selected_indices],
+        "weights": fhe_lr.sklearn_model.coef_.ravel().tolist(),
+        "bias": float(fhe_lr.sklearn_model.intercept_.ravel()[0]),
+        "mean": scaler.mean_.tolist(),
+        "scale": scaler.scale_.tolist(),
+    }, f, indent=2)
+print(f"Exported model to {model_path}")
+
 best_model = fhe_lr
 best_name = "Logistic Regression"
 best_acc = lr_plain_accuracy
@@ -0,0 +1,48 @@
+/**
+ * Base64 codec microbenchmarks
+ *
+ * Measures encode/decode throughput of the shared Base64 utility on buffers
+ * the size of typical ciphertexts and keys. bytes_per_second is reported so
+ * runs on different input sizes compare directly.
+ */
+
+#include "Base64.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+
+namespace {
+    std::string random_bytes(size_t size) {
+        std::mt19937_64 rng(42);
+        std::string data(size, '\0');
+        for (auto& c : data) c = static_cast<char>(rng());
+        return data;
+    }
+}
+
+static void bm_base64_encode(benchmark::State& state) {
+    const std::string input = random_bytes(static_cast<size_t>(state.range(0)));
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        base64::encode(input.data(), input.size(), out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetLabel(base64::implementation());
+}
+
+static void bm_base64_decode(benchmark::State& state) {
+    const std::string input = base64::encode(random_bytes(static_cast<size_t>(state.range(0))));
+    std::string out;
+    for (auto _ : state) {
+        base64::decode(input.data(), input.size(), out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetLabel(base64::implementation());
+}
+
+// 4 KB, a BFV/CKKS ciphertext at N=8192 (~400 KB) and a public key-sized blob (~1 MB)
+BENCHMARK(bm_base64_encode)->Arg(4 << 10)->Arg(400 << 10)->Arg(1 << 20);
+BENCHMARK(bm_base64_decode)->Arg(4 << 10)->Arg(400 << 10)->Arg(1 << 20);
@@ -0,0 +1,63 @@
+/**
+ * Key switching with and without compact key storage
+ *
+ * The default profile's chain {50, 30, 30, 50} has two 30-bit limbs of four,
+ * which set_compact_keys(true) holds as 32-bit words: what sum_slots_inplace
+ * (log2(slots) rotations) and relinearize_inplace pay for reading keys
+ * widened in the inner loop against the quarter less key memory they stream.
+ * state.range(0) selects the storage; the key_bytes counter reports it.
+ */
+
+#include "HomomorphicEncryption.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct Input {
+        std::unique_ptr<HomomorphicEncryption> he;
+        seal::Ciphertext x;
+    };
+
+    Input& input(bool compact) {
+        static Input shared[2];
+        Input& in = shared[compact];
+        if (!in.he) {
+            in.he = std::make_unique<HomomorphicEncryption>(true, false);
+            in.he->set_compact_keys(compact);
+            in.he->generate_keys();
+            std::vector<double> values(in.he->slot_count());
+            for (size_t i = 0; i < values.size(); i++) values[i] = 0.001 * static_cast<double>(i % 97);
+            in.x = in.he->deserialize(in.he->encrypt_vector(values)[0]);
+        }
+        return in;
+    }
+
+    Input& select_storage(benchmark::State& state) {
+        Input& in = input(state.range(0) != 0);
+        state.SetLabel(state.range(0) ? "compact" : "64-bit");
+        state.counters["key_bytes"] = static_cast<double>(in.he->key_bytes());
+        return in;
+    }
+}
+
+static void bm_slot_sum_keys(benchmark::State& state) {
+    Input& in = select_storage(state);
+    for (auto _ : state) {
+        seal::Ciphertext x = in.x;
+        in.he->sum_slots_inplace(x);
+        benchmark::DoNotOptimize(x.data());
+    }
+}
+BENCHMARK(bm_slot_sum_keys)->ArgName("compact")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+static void bm_relinearize_keys(benchmark::State& state) {
+    Input& in = select_storage(state);
+    const seal::Ciphertext product = in.he->multiply(in.x, in.x);
+    for (auto _ : state) {
+        seal::Ciphertext x = product;
+        in.he->relinearize_inplace(x);
+        benchmark::DoNotOptimize(x.data());
+    }
+}
+BENCHMARK(bm_relinearize_keys)->ArgName("compact")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,52 @@
+/**
+ * Concurrent request throughput with global vs. per-thread SEAL memory pools
+ * vs. per-thread scratch arenas
+ *
+ * Each benchmark thread plays one client issuing the packed-sum round trip of
+ * the frontend (encrypt_vector on mini-backend, sum_slots on main-backend)
+ * against one shared engine, as the Crow worker threads do. The argument
+ * selects the scratch pool: 0 = MemoryManager::GetPool() (global, locked),
+ * 1 = MemoryPoolHandle::ThreadLocal(), 2 = seal::ScratchArena per thread,
+ * reset after every request as ScratchArenaMiddleware does. items_per_second
+ * is the aggregate request rate across all clients.
+ */
+
+#include "HomomorphicEncryption.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+namespace {
+    const char* const pool_names[] = { "global pool", "thread-local pools", "scratch arenas" };
+
+    // One BFV engine per pool mode, created on first use and shared by all threads
+    HomomorphicEncryption& engine(int64_t mode) {
+        static auto make = [](int64_t mode) {
+            auto he = std::make_unique<HomomorphicEncryption>(false, true);
+            he->set_thread_local_pools(mode != 0);
+            if (mode == 2) he->set_scratch_arenas(size_t(16) << 20);
+            return he;
+        };
+        static std::unique_ptr<HomomorphicEncryption> engines[] = { make(0), make(1), make(2) };
+        return *engines[mode];
+    }
+}
+
+static void bm_packed_request(benchmark::State& state) {
+    HomomorphicEncryption& he = engine(state.range(0));
+    const WireOptions wire(WireFormat::binary, seal::compr_mode_type::none);
+    const std::vector<double> values(he.slot_count(), 1.0);
+
+    for (auto _ : state) {
+        std::vector<std::string> encrypted = he.encrypt_vector(values, wire);
+        std::string total = he.sum_slots(encrypted.front(), wire);
+        benchmark::DoNotOptimize(total.data());
+        HomomorphicEncryption::reset_scratch_arena();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetLabel(pool_names[state.range(0)]);
+}
+BENCHMARK(bm_packed_request)
+    ->ArgName("pool")->Arg(0)->Arg(1)->Arg(2)
+    ->Threads(1)->Threads(8)->Threads(32)
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,66 @@
+/**
+ * Packed column sums over synthetic datasets larger than the sample
+ *
+ * src/data/healthcare_dataset.csv has 55,500 rows, 14 CKKS ciphertexts at
+ * the default profile: too few to show how a column sum scales. Here the
+ * Billing Amount column of state.range(0) synthetic rows (see
+ * SyntheticHealthcare.h, as tools/he-gen.cpp writes them) is encrypted
+ * packed once per size, and each iteration sums its ciphertexts and then
+ * the slots, the work of /csv/sum?packed=1 after deserialization.
+ * bm_dataset_generate measures the generator itself, in rows per second.
+ */
+
+#include "HomomorphicEncryption.h"
+#include "SyntheticHealthcare.h"
+#include <benchmark/benchmark.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    HomomorphicEncryption& engine() {
+        static HomomorphicEncryption he(true);
+        return he;
+    }
+
+    const std::vector<seal::Ciphertext>& column(size_t rows) {
+        static std::map<size_t, std::vector<seal::Ciphertext>> columns;
+        auto& ciphertexts = columns[rows];
+        if (ciphertexts.empty()) {
+            const SyntheticHealthcare generator;
+            for (const std::string& encrypted :
+                 engine().encrypt_vector(generator.column(SyntheticHealthcare::billing_amount, 0, rows))) {
+                ciphertexts.push_back(engine().deserialize(encrypted));
+            }
+        }
+        return ciphertexts;
+    }
+}
+
+static void bm_dataset_sum(benchmark::State& state) {
+    const size_t rows = static_cast<size_t>(state.range(0));
+    const std::vector<seal::Ciphertext>& ciphertexts = column(rows);
+    for (auto _ : state) {
+        seal::Ciphertext total = engine().sum(ciphertexts);
+        engine().sum_slots_inplace(total);
+        benchmark::DoNotOptimize(total.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows));
+    state.counters["ciphertexts"] = static_cast<double>(ciphertexts.size());
+}
+BENCHMARK(bm_dataset_sum)->ArgName("rows")->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+static void bm_dataset_generate(benchmark::State& state) {
+    const SyntheticHealthcare generator;
+    uint64_t next = 0;
+    std::string csv;
+    for (auto _ : state) {
+        csv.clear();
+        for (int i = 0; i < 1024; i++) SyntheticHealthcare::append_csv(generator.row(next++), csv);
+        benchmark::DoNotOptimize(csv.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 1024));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * csv.size()));
+}
+BENCHMARK(bm_dataset_generate)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,87 @@
+/**
+ * CKKS matrix-vector products: the plain diagonal method vs. DiagonalMatrix
+ *
+ * A dense d x d matrix (d = state.range(0)) times a packed encrypted vector,
+ * at N = 8192 with mult-depth-2's chain and Galois keys for baby steps up to
+ * 15. "diagonal" rotates x by 1 d - 1 times and multiplies each rotation by
+ * its diagonal; "baby_step_giant_step" is DiagonalMatrix, with hoisted baby
+ * rotations and Horner-style giant rotations. The "rotations" counter reports
+ * key switches per product; both encode their diagonals once, outside the loop.
+ */
+
+#include "HomomorphicEncryption.h"
+#include "DiagonalMatrix.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct Input {
+        std::unique_ptr<HomomorphicEncryption> he;
+        seal::Ciphertext x;
+    };
+
+    const Input& input() {
+        static Input shared = [] {
+            Input in;
+            ParameterProfile profile = profiles::get("mult-depth-2");
+            profile.baby_steps = 16;
+            in.he = std::make_unique<HomomorphicEncryption>(true, true, profile);
+            std::vector<double> values(in.he->slot_count());
+            for (size_t i = 0; i < values.size(); i++) values[i] = 0.01 * static_cast<double>(i % 256);
+            in.x = in.he->deserialize(in.he->encrypt_vector(values)[0]);
+            return in;
+        }();
+        return shared;
+    }
+
+    std::vector<std::vector<double>> matrix(size_t d) {
+        std::vector<std::vector<double>> rows(d, std::vector<double>(d));
+        for (size_t i = 0; i < d; i++) {
+            for (size_t j = 0; j < d; j++) rows[i][j] = 1.0 / static_cast<double>(1 + (i * 31 + j * 17) % 97);
+        }
+        return rows;
+    }
+}
+
+static void bm_matvec_diagonal(benchmark::State& state) {
+    const Input& in = input();
+    const HomomorphicEncryption& he = *in.he;
+    const size_t d = static_cast<size_t>(state.range(0));
+    const auto rows = matrix(d);
+
+    std::vector<seal::Plaintext> diagonals(d);
+    for (size_t k = 0; k < d; k++) {
+        std::vector<double> tiled(he.slot_count());
+        for (size_t s = 0; s < tiled.size(); s++) tiled[s] = rows[s % d][(s + k) % d];
+        diagonals[k] = std::move(he.encode_weights(tiled, true, in.x.parms_id())[0]);
+    }
+
+    for (auto _ : state) {
+        std::vector<seal::Ciphertext> rotated(d);
+        rotated[0] = in.x;
+        for (size_t k = 1; k < d; k++) rotated[k] = std::move(he.rotate_many(rotated[k - 1], {1})[0]);
+        seal::Ciphertext result = he.weighted_sum(rotated.data(), diagonals);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.counters["rotations"] = static_cast<double>(d - 1);
+    state.SetLabel("diagonal");
+}
+BENCHMARK(bm_matvec_diagonal)->ArgName("d")->Arg(16)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+
+static void bm_matvec_baby_step_giant_step(benchmark::State& state) {
+    const Input& in = input();
+    const size_t d = static_cast<size_t>(state.range(0));
+    DiagonalMatrix encoded(*in.he, matrix(d));
+    benchmark::DoNotOptimize(encoded.multiply(in.x, true).data());  // Encodes the diagonals
+
+    MatrixVectorStats stats;
+    for (auto _ : state) {
+        seal::Ciphertext result = encoded.multiply(in.x, true, &stats);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.counters["rotations"] = static_cast<double>(stats.baby_rotations + stats.giant_rotations);
+    state.counters["baby_step"] = static_cast<double>(encoded.baby_step());
+    state.SetLabel("baby_step_giant_step");
+}
+BENCHMARK(bm_matvec_baby_step_giant_step)->ArgName("d")->Arg(16)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+Perf-regression check: a fixed subset of sealbench and he-bench against
+bench/baseline.json (ctest -L perf, see HE_PERF_CHECK in CMakeLists.txt)
+
+Each suite runs with --benchmark_repetitions and writes Google Benchmark's
+JSON (--benchmark_out); the per-repetition real times (the manual time for
+he-bench, i.e. the wrapper call alone) are reduced to a median and a median
+absolute deviation per benchmark. A benchmark has regressed when its median
+is more than --threshold percent above the baseline's AND the difference is
+larger than the noise of either side (3 scaled MADs, and at least 10 us), so
+a noisy benchmark cannot fail the check on one slow repetition. The
+repetitions of one process still share its luck (frequency, neighbours,
+memory placement), so regressed benchmarks are measured again in a fresh
+process and only fail if the faster of the two medians is still over the
+threshold (--update likewise keeps the faster of two runs). A benchmark of
+the baseline that no longer runs fails too; one that is not in the baseline
+is reported as new.
+
+Baselines are host-specific: regenerate bench/baseline.json on the machine
+that runs the check (--update, or the perf-baseline target) and commit it.
+
+Usage:
+  perf_check.py --sealbench PATH --he-bench PATH [--baseline FILE]
+      [--threshold 10] [--repetitions 5] [--output results.json] [--update]
+"""
+
+import argparse
+import json
+import os
+import platform
+import re
+import statistics
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# The checked subset: SEAL's addition, CKKS multiplication and NTTs at the
+# degrees the profiles use, the wrapper methods a sum or an inference
+# request goes through, and a packed column sum over a million synthetic
+# rows (bench/dataset.cpp)
+SUITES = {
+    "sealbench": r"^n=(4096|8192) / log\(q\)=[0-9]+ / "
+                 r"(BFV / EvaluateAddCt|CKKS / EvaluateMulCt|UTIL / NTT(Forward|Inverse)[A-Za-z]*)/",
+    "he-bench": r"^bm_(sum_fused/operands:1000$|dataset_sum/rows:1048576$"
+                r"|wrapper_(add|sum|sum_slots|encrypt_vector|decrypt_vector|multiply_relinearize)"
+                r"/scheme:[01]/N:8192/)",
+}
+
+NANOSECONDS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+NOISE_MADS = 3.0
+MAD_TO_SIGMA = 1.4826  # A normal distribution's standard deviation per MAD
+# sealbench times a fixed 10 iterations, too few to resolve a few microseconds
+MIN_DELTA_NS = 10_000
+
+
+def run_suite(binary, pattern, repetitions):
+    """Median and MAD (ns) of every benchmark of one suite matching pattern"""
+    with tempfile.TemporaryDirectory() as scratch:
+        out = os.path.join(scratch, "out.json")
+        done = subprocess.run([binary, f"--benchmark_filter={pattern}",
+                               f"--benchmark_repetitions={repetitions}",
+                               "--benchmark_display_aggregates_only=true",
+                               f"--benchmark_out={out}", "--benchmark_out_format=json"],
+                              stdout=subprocess.DEVNULL)
+        if done.returncode != 0 or not os.path.exists(out) or not os.path.getsize(out):
+            raise RuntimeError(f"{binary} exited with {done.returncode} and no results")
+        with open(out) as f:
+            report = json.load(f)
+
+    runs = {}
+    for bm in report["benchmarks"]:
+        if bm.get("run_type", "iteration") != "iteration":
+            continue
+        name = bm.get("run_name", bm["name"])
+        if bm.get("error_occurred"):
+            raise RuntimeError(f"{name}: {bm.get('error_message', 'failed')}")
+        runs.setdefault(name, []).append(bm["real_time"] * NANOSECONDS[bm.get("time_unit", "ns")])
+
+    results = {}
+    for name, times in runs.items():
+        median = statistics.median(times)
+        results[name] = {
+            "median_ns": round(median, 1),
+            "mad_ns": round(statistics.median(abs(t - median) for t in times), 1),
+            "runs": len(times),
+        }
+    return results
+
+
+def exact_filter(names):
+    """A --benchmark_filter for exactly these benchmarks. Benchmark's regex
+    rejects escapes of ordinary characters, which re.escape adds for spaces"""
+    return "^(" + "|".join(re.sub(r"([\\^$.|?*+()\[\]{}])", r"\\\1", name) for name in names) + ")$"
+
+
+def compare(baseline, current, threshold):
+    """Rows of (suite, name, baseline, current, change, status)"""
+    rows = []
+    for suite in SUITES:
+        base = baseline.get("suites", {}).get(suite, {})
+        now = current[suite]
+        for name in sorted(set(base) | set(now)):
+            if name not in now:
+                rows.append((suite, name, base[name], None, None, "missing"))
+                continue
+            if name not in base:
+                rows.append((suite, name, None, now[name], None, "new"))
+                continue
+            b, c = base[name], now[name]
+            change = c["median_ns"] / b["median_ns"] - 1
+            noise = max(MIN_DELTA_NS, NOISE_MADS * MAD_TO_SIGMA * max(b["mad_ns"], c["mad_ns"]))
+            if change > threshold and c["median_ns"] - b["median_ns"] > noise:
+                status = "regressed"
+            elif change < -threshold and b["median_ns"] - c["median_ns"] > noise:
+                status = "improved"
+            else:
+                status = "ok"
+            rows.append((suite, name, b, c, change, status))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--sealbench", required=True)
+    parser.add_argument("--he-bench", required=True)
+    parser.add_argument("--baseline", default=os.path.join(HERE, "baseline.json"))
+    parser.add_argument("--threshold", type=float, default=10.0, help="percent slowdown that fails")
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--output", help="write the comparison here as JSON")
+    parser.add_argument("--update", action="store_true", help="write this run as the baseline")
+    args = parser.parse_args()
+
+    binaries = {"sealbench": args.sealbench, "he-bench": args.he_bench}
+    current = {suite: run_suite(binaries[suite], pattern, args.repetitions) for suite, pattern in SUITES.items()}
+
+    if args.update:
+        # Best of two processes, as regressions are confirmed below
+        for suite, pattern in SUITES.items():
+            for name, result in run_suite(binaries[suite], pattern, args.repetitions).items():
+                if name not in current[suite] or result["median_ns"] < current[suite][name]["median_ns"]:
+                    current[suite][name] = result
+        with open(args.baseline, "w") as f:
+            json.dump({"host": {"platform": platform.platform(), "machine": platform.machine(),
+                                "cpus": os.cpu_count()},
+                       "repetitions": args.repetitions, "suites": current}, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"Wrote {sum(map(len, current.values()))} benchmarks to {args.baseline}")
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    rows = compare(baseline, current, args.threshold / 100)
+
+    # Confirm regressions in a second process, keeping the faster measurement
+    for suite in SUITES:
+        regressed = [name for s, name, *_, status in rows if s == suite and status == "regressed"]
+        if regressed:
+            again = run_suite(binaries[suite], exact_filter(regressed), args.repetitions)
+            for name, result in again.items():
+                if result["median_ns"] < current[suite][name]["median_ns"]:
+                    current[suite][name] = result
+    if any(status == "regressed" for *_, status in rows):
+        rows = compare(baseline, current, args.threshold / 100)
+
+    width = max(len(name) for _, name, *_ in rows)
+    for suite, name, b, c, change, status in rows:
+        times = (f"{b['median_ns'] / 1e3:12.1f} us -> {c['median_ns'] / 1e3:12.1f} us  {change:+7.1%}"
+                 if b and c else "")
+        print(f"{suite:>9}  {name:<{width}}  {times:<46}  {status}")
+    failed = [row for row in rows if row[5] in ("regressed", "missing")]
+    print(f"{len(failed)} of {len(rows)} benchmarks regressed or missing "
+          f"(threshold {args.threshold:g}%, baseline from {baseline.get('host', {}).get('platform', '?')})")
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({"threshold_pct": args.threshold, "results": [
+                {"suite": suite, "name": name, "baseline": b, "current": c,
+                 "change_pct": None if change is None else round(change * 100, 2), "status": status}
+                for suite, name, b, c, change, status in rows]}, f, indent=2)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
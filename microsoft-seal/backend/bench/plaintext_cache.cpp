@@ -0,0 +1,61 @@
+/**
+ * CKKS constant and weight encoding with and without the plaintext cache
+ *
+ * What an inference request pays per ciphertext before its multiply_plain or
+ * add_plain, at N = 8192 with mult-depth-2's chain: encode_weights of one
+ * packed weight vector, and add_constant_inplace of a bias. state.range(0)
+ * selects the cache: 0 encodes every call (set_plaintext_cache(0)), 1 hits
+ * the plaintext encoded by the first call.
+ */
+
+#include "HomomorphicEncryption.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct Input {
+        std::unique_ptr<HomomorphicEncryption> he;
+        seal::Ciphertext x;
+        std::vector<double> weights;
+    };
+
+    Input& input() {
+        static Input shared = [] {
+            Input in;
+            in.he = std::make_unique<HomomorphicEncryption>(true, true, profiles::get("mult-depth-2"));
+            in.weights.resize(in.he->slot_count());
+            for (size_t i = 0; i < in.weights.size(); i++) in.weights[i] = 0.001 * static_cast<double>(i % 97);
+            in.x = in.he->deserialize(in.he->encrypt_vector(in.weights)[0]);
+            return in;
+        }();
+        return shared;
+    }
+
+    void select_cache(HomomorphicEncryption& he, benchmark::State& state) {
+        he.set_plaintext_cache(0);
+        if (state.range(0)) he.set_plaintext_cache(size_t(64) << 20);
+        state.SetLabel(state.range(0) ? "cached" : "encode");
+    }
+}
+
+static void bm_encode_weights(benchmark::State& state) {
+    Input& in = input();
+    select_cache(*in.he, state);
+    for (auto _ : state) {
+        std::vector<seal::Plaintext> encoded = in.he->encode_weights(in.weights, true, in.x.parms_id());
+        benchmark::DoNotOptimize(encoded[0].data());
+    }
+}
+BENCHMARK(bm_encode_weights)->ArgName("cached")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void bm_add_constant(benchmark::State& state) {
+    Input& in = input();
+    select_cache(*in.he, state);
+    seal::Ciphertext x = in.x;
+    for (auto _ : state) {
+        in.he->add_constant_inplace(x, -0.25);
+        benchmark::DoNotOptimize(x.data());
+    }
+}
+BENCHMARK(bm_add_constant)->ArgName("cached")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,85 @@
+/**
+ * CKKS polynomial evaluation: Horner's rule vs. PolynomialEvaluator
+ *
+ * A packed ml-inference ciphertext is put through a degree-state.range(0)
+ * polynomial with all coefficients nonzero. "horner" multiplies by x once per
+ * degree, spending a level each time (degree 5 is the most the profile's six
+ * levels allow); "paterson_stockmeyer" is PolynomialEvaluator, whose baby and
+ * giant steps spend about log2(degree) levels. The "products" and "levels"
+ * counters report ciphertext products and levels spent per evaluation.
+ */
+
+#include "HomomorphicEncryption.h"
+#include "PolynomialEvaluator.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct Input {
+        std::unique_ptr<HomomorphicEncryption> he;
+        seal::Ciphertext x;
+    };
+
+    const Input& input() {
+        static Input shared = [] {
+            Input in;
+            in.he = std::make_unique<HomomorphicEncryption>(true, true, profiles::get("ml-inference"));
+            std::vector<double> values(in.he->slot_count(), 0.5);
+            in.x = in.he->deserialize(in.he->encrypt_vector(values)[0]);
+            return in;
+        }();
+        return shared;
+    }
+
+    std::vector<double> coefficients(size_t degree) {
+        std::vector<double> c;
+        for (size_t i = 0; i <= degree; i++) c.push_back(1.0 / static_cast<double>(i + 1));
+        return c;
+    }
+}
+
+static void bm_polynomial_horner(benchmark::State& state) {
+    const Input& in = input();
+    const HomomorphicEncryption& he = *in.he;
+    const std::vector<double> c = coefficients(static_cast<size_t>(state.range(0)));
+    const size_t top = he.chain_index(in.x);
+
+    for (auto _ : state) {
+        // ((c_d x + c_{d-1}) x + c_{d-2}) x + ...
+        seal::Ciphertext result = in.x;
+        he.multiply_constant_to(result, c.back(), top - 1, in.x.scale());
+        he.add_constant_inplace(result, c[c.size() - 2]);
+        for (size_t i = c.size() - 2; i-- > 0;) {
+            seal::Ciphertext x = in.x;
+            he.match_level_inplace(result, x);
+            result = he.multiply(result, x);
+            he.relinearize_inplace(result);
+            he.rescale_inplace(result);
+            he.add_constant_inplace(result, c[i]);
+        }
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.counters["products"] = static_cast<double>(c.size() - 2);
+    state.counters["levels"] = static_cast<double>(c.size() - 1);
+    state.SetLabel("horner");
+}
+BENCHMARK(bm_polynomial_horner)->ArgName("degree")->Arg(3)->Arg(5)->Unit(benchmark::kMillisecond);
+
+static void bm_polynomial_paterson_stockmeyer(benchmark::State& state) {
+    const Input& in = input();
+    const std::vector<double> c = coefficients(static_cast<size_t>(state.range(0)));
+
+    PolynomialStats stats;
+    for (auto _ : state) {
+        PolynomialEvaluator polynomial(*in.he, in.x);
+        seal::Ciphertext result = polynomial.evaluate(c);
+        benchmark::DoNotOptimize(result.data());
+        stats = polynomial.stats();
+    }
+    state.counters["products"] = static_cast<double>(stats.power_products + stats.giant_products);
+    state.counters["levels"] = static_cast<double>(stats.depth);
+    state.SetLabel("paterson_stockmeyer");
+}
+BENCHMARK(bm_polynomial_paterson_stockmeyer)->ArgName("degree")->Arg(3)->Arg(5)->Arg(7)->Arg(15)
+    ->Unit(benchmark::kMillisecond);
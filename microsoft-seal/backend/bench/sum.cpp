@@ -0,0 +1,91 @@
+/**
+ * BFV ciphertext sums: add_inplace per operand vs. the fused add_many
+ *
+ * state.range(0) ciphertexts at the default profile are added together.
+ * "sequential" is the left fold HomomorphicEncryption::sum used to run,
+ * which reads, adds and reduces the running sum once per operand; "fused"
+ * is Evaluator::add_many over pointers, as sum_range now calls it, which
+ * reduces lazily and writes the result once. Operands cycle through 16
+ * distinct ciphertexts (~6 MB, more than the caches) so 100k operands fit
+ * in memory. "batch" sums the same operands copied once into a contiguous
+ * seal::CiphertextBatch, whose every RNS component is read at a constant
+ * stride; it stops at 1000 operands, whose copies alone take ~400 MB.
+ * Those copies are distinct memory where the other cases re-read 16
+ * ciphertexts, so at 1000 operands "batch" measures memory bandwidth.
+ */
+
+#include "HomomorphicEncryption.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct Operands {
+        std::unique_ptr<HomomorphicEncryption> he;
+        std::vector<seal::Ciphertext> distinct;
+        std::vector<const seal::Ciphertext*> pointers;
+    };
+
+    const Operands& operands(size_t count) {
+        static Operands shared = [] {
+            Operands ops;
+            ops.he = std::make_unique<HomomorphicEncryption>(false, true);
+            for (int i = 0; i < 16; i++) {
+                ops.distinct.push_back(ops.he->deserialize(ops.he->encrypt(i)));
+            }
+            return ops;
+        }();
+        shared.pointers.clear();
+        for (size_t i = 0; i < count; i++) {
+            shared.pointers.push_back(&shared.distinct[i % shared.distinct.size()]);
+        }
+        return shared;
+    }
+}
+
+static void bm_sum_sequential(benchmark::State& state) {
+    const Operands& ops = operands(static_cast<size_t>(state.range(0)));
+    seal::Evaluator evaluator(*ops.he->seal_context());
+
+    for (auto _ : state) {
+        seal::Ciphertext result = *ops.pointers[0];
+        for (size_t i = 1; i < ops.pointers.size(); i++) {
+            evaluator.add_inplace(result, *ops.pointers[i]);
+        }
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ops.pointers.size()));
+    state.SetLabel("sequential");
+}
+BENCHMARK(bm_sum_sequential)->ArgName("operands")->Arg(10)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void bm_sum_fused(benchmark::State& state) {
+    const Operands& ops = operands(static_cast<size_t>(state.range(0)));
+    seal::Evaluator evaluator(*ops.he->seal_context());
+
+    for (auto _ : state) {
+        seal::Ciphertext result;
+        evaluator.add_many(ops.pointers.data(), ops.pointers.size(), result);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ops.pointers.size()));
+    state.SetLabel("fused");
+}
+BENCHMARK(bm_sum_fused)->ArgName("operands")->Arg(10)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void bm_sum_batch(benchmark::State& state) {
+    const Operands& ops = operands(static_cast<size_t>(state.range(0)));
+    const seal::SEALContext& context = *ops.he->seal_context();
+    seal::Evaluator evaluator(context);
+    seal::CiphertextBatch batch;
+    batch.assign(context, ops.pointers.data(), ops.pointers.size());
+
+    for (auto _ : state) {
+        seal::Ciphertext result;
+        evaluator.add_many(batch, result);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ops.pointers.size()));
+    state.SetLabel("batch");
+}
+BENCHMARK(bm_sum_batch)->ArgName("operands")->Arg(10)->Arg(1000)->Unit(benchmark::kMillisecond);
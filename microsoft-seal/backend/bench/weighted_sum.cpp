@@ -0,0 +1,91 @@
+/**
+ * BFV weighted sums over a packed column: multiply_plain per ciphertext vs.
+ * a resident NTT chain, and the resident chain under BGV
+ *
+ * A column of state.range(0) packed ciphertexts is multiplied slot-wise by
+ * integer weights and summed, as POST /store/weighted_sum does. "per-call" is
+ * the plain Evaluator chain, in which every multiply_plain transforms the
+ * ciphertext and its weights to NTT form and back; "resident NTT" is
+ * HomomorphicEncryption::weighted_sum with weights from encode_weights.
+ * "BGV" is the same weighted_sum under BGV, whose ciphertexts are a limb
+ * smaller and already in NTT form, and whose sum is switched down one more.
+ */
+
+#include "HomomorphicEncryption.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct Column {
+        std::unique_ptr<HomomorphicEncryption> he;
+        std::vector<seal::Ciphertext> ciphertexts;
+        std::vector<double> weights;
+    };
+
+    Column make_column(size_t ciphertext_count, seal::scheme_type scheme = seal::scheme_type::bfv) {
+        Column column;
+        column.he = std::make_unique<HomomorphicEncryption>(scheme, true);
+        const size_t count = ciphertext_count * column.he->slot_count();
+        for (const std::string& ct : column.he->encrypt_vector(std::vector<double>(count, 3.0))) {
+            column.ciphertexts.push_back(column.he->deserialize(ct));
+        }
+        for (size_t i = 0; i < count; i++) {
+            column.weights.push_back(static_cast<double>(i % 5));
+        }
+        return column;
+    }
+}
+
+static void bm_weighted_sum_per_call(benchmark::State& state) {
+    Column column = make_column(static_cast<size_t>(state.range(0)));
+    seal::BatchEncoder encoder(*column.he->seal_context());
+    seal::Evaluator evaluator(*column.he->seal_context());
+    std::vector<seal::Plaintext> weights(column.ciphertexts.size());
+    for (size_t i = 0; i < weights.size(); i++) {
+        auto first = column.weights.begin() + i * encoder.slot_count();
+        encoder.encode(std::vector<int64_t>(first, first + encoder.slot_count()), weights[i]);
+    }
+
+    for (auto _ : state) {
+        seal::Ciphertext result;
+        seal::Ciphertext term;
+        evaluator.multiply_plain(column.ciphertexts[0], weights[0], result);
+        for (size_t i = 1; i < weights.size(); i++) {
+            evaluator.multiply_plain(column.ciphertexts[i], weights[i], term);
+            evaluator.add_inplace(result, term);
+        }
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * weights.size()));
+    state.SetLabel("per-call");
+}
+BENCHMARK(bm_weighted_sum_per_call)->ArgName("ciphertexts")->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond);
+
+static void bm_weighted_sum_resident_ntt(benchmark::State& state) {
+    Column column = make_column(static_cast<size_t>(state.range(0)));
+    std::vector<seal::Plaintext> weights =
+        column.he->encode_weights(column.weights, true, column.ciphertexts[0].parms_id());
+
+    for (auto _ : state) {
+        seal::Ciphertext result = column.he->weighted_sum(column.ciphertexts.data(), weights);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * weights.size()));
+    state.SetLabel("resident NTT");
+}
+BENCHMARK(bm_weighted_sum_resident_ntt)->ArgName("ciphertexts")->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond);
+
+static void bm_weighted_sum_bgv(benchmark::State& state) {
+    Column column = make_column(static_cast<size_t>(state.range(0)), seal::scheme_type::bgv);
+    std::vector<seal::Plaintext> weights =
+        column.he->encode_weights(column.weights, true, column.ciphertexts[0].parms_id());
+
+    for (auto _ : state) {
+        seal::Ciphertext result = column.he->weighted_sum(column.ciphertexts.data(), weights);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * weights.size()));
+    state.SetLabel("BGV");
+}
+BENCHMARK(bm_weighted_sum_bgv)->ArgName("ciphertexts")->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,399 @@
+/**
+ * HomomorphicEncryption methods against the raw SEAL operations they wrap
+ *
+ * Every benchmark runs one wrapper call and its SEAL equivalent per
+ * iteration, for every scheme (state.range(0): 0 = BFV, 1 = CKKS, 2 = BGV) at
+ * N = 4096, 8192 and 16384 (profiles sum-fast, default and ml-inference,
+ * state.range(1)). The reported time is the wrapper's; the "seal_us"
+ * counter is the raw operation's mean and "overhead_pct" the wrapper's extra
+ * cost relative to it, so a regression in the glue (Base64, wire framing,
+ * encoding, metrics, scratch pools) shows up even when SEAL itself is
+ * unchanged. String methods (encrypt, decrypt, add, sum, ...) include their
+ * serialization, as an HTTP endpoint pays it, but uncompressed: compression
+ * costs several times the operation and is measured on its own by
+ * bm_wrapper_serialize / bm_wrapper_deserialize (state.range(2) = 1).
+ *
+ * The raw side has its own keys for the same parameters; each engine and its
+ * raw counterpart are created on first use and kept for the whole run. Raw
+ * BGV encryptions start at the level the wrapper's do (below the top, see
+ * HomomorphicEncryption::init_bgv), so both sides work on ciphertexts of the
+ * same size.
+ */
+
+#include "HomomorphicEncryption.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct Engine {
+        std::unique_ptr<HomomorphicEncryption> he;
+        bool use_ckks = false;
+        bool use_bgv = false;
+        seal::parms_id_type fresh_parms;  // Level of the wrapper's public-key encryptions
+        double scale = 1.0;
+
+        // Raw SEAL objects for the same parameters
+        std::unique_ptr<seal::KeyGenerator> keygen;
+        seal::PublicKey public_key;
+        seal::RelinKeys relin_keys;
+        seal::GaloisKeys galois_keys;  // Slot-sum steps only, created on first use
+        std::unique_ptr<seal::Encryptor> encryptor;
+        std::unique_ptr<seal::Decryptor> decryptor;
+        std::unique_ptr<seal::Evaluator> evaluator;
+        std::unique_ptr<seal::CKKSEncoder> ckks_encoder;
+        std::unique_ptr<seal::BatchEncoder> bfv_encoder;
+
+        void encode(const std::vector<double>& values, seal::Plaintext& plain) const {
+            if (use_ckks) {
+                ckks_encoder->encode(values, scale, plain);
+            } else {
+                std::vector<int64_t> integers(values.begin(), values.end());
+                bfv_encoder->encode(integers, plain);
+            }
+        }
+
+        seal::Ciphertext encrypt(const std::vector<double>& values) const {
+            seal::Plaintext plain;
+            encode(values, plain);
+            seal::Ciphertext encrypted;
+            if (use_bgv) {
+                encryptor->encrypt_zero(fresh_parms, encrypted);
+                evaluator->add_plain_inplace(encrypted, plain);
+            } else {
+                encryptor->encrypt(plain, encrypted);
+            }
+            return encrypted;
+        }
+
+        std::vector<double> decode(const seal::Plaintext& plain) const {
+            std::vector<double> values;
+            if (use_ckks) {
+                ckks_encoder->decode(plain, values);
+            } else {
+                std::vector<int64_t> integers;
+                bfv_encoder->decode(plain, integers);
+                values.assign(integers.begin(), integers.end());
+            }
+            return values;
+        }
+
+        const seal::GaloisKeys& slot_sum_keys() {
+            if (galois_keys.size() == 0) {
+                std::vector<int> steps;
+                const size_t row = use_ckks ? he->slot_count() : he->slot_count() / 2;
+                for (size_t step = 1; step < row; step <<= 1) steps.push_back(static_cast<int>(step));
+                if (!use_ckks) steps.push_back(0);  // Column rotation
+                keygen->create_galois_keys(steps, galois_keys);
+            }
+            return galois_keys;
+        }
+    };
+
+    const char* profile_for(int64_t degree) {
+        return degree == 4096 ? "sum-fast" : degree == 8192 ? "default" : "ml-inference";
+    }
+
+    Engine& engine(const benchmark::State& state) {
+        static std::map<std::pair<int64_t, int64_t>, std::unique_ptr<Engine>> engines;
+        auto& slot = engines[{state.range(0), state.range(1)}];
+        if (!slot) {
+            slot = std::make_unique<Engine>();
+            Engine& e = *slot;
+            const seal::scheme_type scheme = state.range(0) == 1   ? seal::scheme_type::ckks
+                                             : state.range(0) == 2 ? seal::scheme_type::bgv
+                                                                   : seal::scheme_type::bfv;
+            e.use_ckks = scheme == seal::scheme_type::ckks;
+            e.use_bgv = scheme == seal::scheme_type::bgv;
+            const ParameterProfile& profile = profiles::get(profile_for(state.range(1)));
+            e.he = std::make_unique<HomomorphicEncryption>(scheme, true, profile);
+            e.fresh_parms = e.he->deserialize(e.he->encrypt(0.0)).parms_id();
+            e.scale = std::pow(2.0, profile.scale_bits);
+            const seal::SEALContext& context = *e.he->seal_context();
+            e.keygen = std::make_unique<seal::KeyGenerator>(context);
+            e.keygen->create_public_key(e.public_key);
+            e.keygen->create_relin_keys(e.relin_keys);
+            e.encryptor = std::make_unique<seal::Encryptor>(context, e.public_key, e.keygen->secret_key());
+            e.decryptor = std::make_unique<seal::Decryptor>(context, e.keygen->secret_key());
+            e.evaluator = std::make_unique<seal::Evaluator>(context);
+            if (e.use_ckks) {
+                e.ckks_encoder = std::make_unique<seal::CKKSEncoder>(context);
+            } else {
+                e.bfv_encoder = std::make_unique<seal::BatchEncoder>(context);
+            }
+        }
+        return *slot;
+    }
+
+    // Values filling every slot, small enough for either scheme
+    std::vector<double> slot_values(const Engine& e) {
+        std::vector<double> values(e.he->slot_count());
+        for (size_t i = 0; i < values.size(); i++) values[i] = static_cast<double>(i % 7);
+        return values;
+    }
+
+    std::vector<double> first_slot(const Engine& e, double value) {
+        std::vector<double> values(e.he->slot_count(), 0.0);
+        values[0] = value;
+        return values;
+    }
+
+    // No compression, so string methods measure the glue rather than zstd/zlib
+    const WireOptions uncompressed(WireFormat::base64, seal::compr_mode_type::none);
+
+    // Times wrapper() as the iteration time and raw() next to it, then reports the overhead
+    template <typename Wrapper, typename Raw>
+    void compare(benchmark::State& state, const Engine& e, const Wrapper& wrapper, const Raw& raw) {
+        using clock = std::chrono::steady_clock;
+        double wrapper_seconds = 0;
+        double raw_seconds = 0;
+        for (auto _ : state) {
+            const auto start = clock::now();
+            wrapper();
+            const auto middle = clock::now();
+            raw();
+            const auto end = clock::now();
+            const double elapsed = std::chrono::duration<double>(middle - start).count();
+            state.SetIterationTime(elapsed);
+            wrapper_seconds += elapsed;
+            raw_seconds += std::chrono::duration<double>(end - middle).count();
+        }
+        state.counters["seal_us"] = 1e6 * raw_seconds / static_cast<double>(state.iterations());
+        state.counters["overhead_pct"] = raw_seconds > 0 ? 100.0 * (wrapper_seconds / raw_seconds - 1.0) : 0.0;
+        state.SetLabel(e.he->parameter_profile().name);
+    }
+
+    void schemes_and_degrees(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"scheme", "N"});
+        for (int64_t scheme : {0, 1, 2}) {
+            for (int64_t degree : {4096, 8192, 16384}) b->Args({scheme, degree});
+        }
+        b->UseManualTime()->Unit(benchmark::kMicrosecond);
+    }
+
+    void schemes_degrees_and_operands(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"scheme", "N", "operands"});
+        for (int64_t scheme : {0, 1, 2}) {
+            for (int64_t degree : {4096, 8192, 16384}) {
+                for (int64_t operands : {16, 256}) b->Args({scheme, degree, operands});
+            }
+        }
+        b->UseManualTime()->Unit(benchmark::kMillisecond);
+    }
+
+    void schemes_degrees_and_compression(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"scheme", "N", "compressed"});
+        for (int64_t scheme : {0, 1, 2}) {
+            for (int64_t degree : {4096, 8192, 16384}) {
+                for (int64_t compressed : {0, 1}) b->Args({scheme, degree, compressed});
+            }
+        }
+        b->UseManualTime()->Unit(benchmark::kMicrosecond);
+    }
+}
+
+// encrypt: encode, public-key encryption, save and Base64 vs. encode and encryption
+static void bm_wrapper_encrypt(benchmark::State& state) {
+    Engine& e = engine(state);
+    const std::vector<double> raw_values = first_slot(e, 42.0);
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->encrypt(42.0, uncompressed)); },
+            [&] { benchmark::DoNotOptimize(e.encrypt(raw_values).data()); });
+}
+BENCHMARK(bm_wrapper_encrypt)->Apply(schemes_and_degrees);
+
+// encrypt_symmetric: seeded secret-key encryption and save vs. secret-key encryption
+static void bm_wrapper_encrypt_symmetric(benchmark::State& state) {
+    Engine& e = engine(state);
+    seal::Plaintext plain;
+    e.encode(first_slot(e, 42.0), plain);
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->encrypt_symmetric(42.0, uncompressed)); },
+            [&] {
+                seal::Ciphertext encrypted;
+                e.encryptor->encrypt_symmetric(plain, encrypted);
+                benchmark::DoNotOptimize(encrypted.data());
+            });
+}
+BENCHMARK(bm_wrapper_encrypt_symmetric)->Apply(schemes_and_degrees);
+
+// decrypt: Base64, load, decryption and decoding vs. decryption and decoding
+static void bm_wrapper_decrypt(benchmark::State& state) {
+    Engine& e = engine(state);
+    const std::string encrypted = e.he->encrypt(42.0, uncompressed);
+    const seal::Ciphertext raw = e.encrypt(first_slot(e, 42.0));
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->decrypt(encrypted)); },
+            [&] {
+                seal::Plaintext plain;
+                e.decryptor->decrypt(raw, plain);
+                benchmark::DoNotOptimize(e.decode(plain)[0]);
+            });
+}
+BENCHMARK(bm_wrapper_decrypt)->Apply(schemes_and_degrees);
+
+// add (strings): two loads, one addition and a save vs. one addition
+static void bm_wrapper_add(benchmark::State& state) {
+    Engine& e = engine(state);
+    const std::string a = e.he->encrypt(1.0, uncompressed);
+    const std::string b = e.he->encrypt(2.0, uncompressed);
+    const seal::Ciphertext raw_a = e.encrypt(first_slot(e, 1.0));
+    const seal::Ciphertext raw_b = e.encrypt(first_slot(e, 2.0));
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->add(a, b, uncompressed)); },
+            [&] {
+                seal::Ciphertext sum;
+                e.evaluator->add(raw_a, raw_b, sum);
+                benchmark::DoNotOptimize(sum.data());
+            });
+}
+BENCHMARK(bm_wrapper_add)->Apply(schemes_and_degrees);
+
+// add_inplace (objects): the stored-ciphertext path, no serialization
+static void bm_wrapper_add_inplace(benchmark::State& state) {
+    Engine& e = engine(state);
+    seal::Ciphertext a = e.he->deserialize(e.he->encrypt(1.0, uncompressed));
+    const seal::Ciphertext b = e.he->deserialize(e.he->encrypt(2.0, uncompressed));
+    seal::Ciphertext raw_a = e.encrypt(first_slot(e, 1.0));
+    const seal::Ciphertext raw_b = e.encrypt(first_slot(e, 2.0));
+    compare(state, e, [&] { e.he->add_inplace(a, b); }, [&] { e.evaluator->add_inplace(raw_a, raw_b); });
+}
+BENCHMARK(bm_wrapper_add_inplace)->Apply(schemes_and_degrees);
+
+// sum (strings): operands loads and the batched fold vs. add_many over loaded ciphertexts
+static void bm_wrapper_sum(benchmark::State& state) {
+    Engine& e = engine(state);
+    const size_t operands = static_cast<size_t>(state.range(2));
+    std::vector<std::string> encrypted;
+    std::vector<seal::Ciphertext> raw;
+    for (size_t i = 0; i < operands; i++) {
+        encrypted.push_back(e.he->encrypt(static_cast<double>(i % 5), uncompressed));
+        raw.push_back(e.encrypt(first_slot(e, static_cast<double>(i % 5))));
+    }
+    const CiphertextViews operand_views = views(encrypted);
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->sum(operand_views, uncompressed)); },
+            [&] {
+                seal::Ciphertext sum;
+                e.evaluator->add_many(raw, sum);
+                benchmark::DoNotOptimize(sum.data());
+            });
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * operands));
+}
+BENCHMARK(bm_wrapper_sum)->Apply(schemes_degrees_and_operands);
+
+// encrypt_vector: one full ciphertext of slots, encoded, encrypted and saved
+static void bm_wrapper_encrypt_vector(benchmark::State& state) {
+    Engine& e = engine(state);
+    const std::vector<double> values = slot_values(e);
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->encrypt_vector(values, uncompressed)); },
+            [&] { benchmark::DoNotOptimize(e.encrypt(values).data()); });
+}
+BENCHMARK(bm_wrapper_encrypt_vector)->Apply(schemes_and_degrees);
+
+// decrypt_vector: one full ciphertext loaded, decrypted and decoded
+static void bm_wrapper_decrypt_vector(benchmark::State& state) {
+    Engine& e = engine(state);
+    const std::vector<std::string> encrypted = e.he->encrypt_vector(slot_values(e), uncompressed);
+    const seal::Ciphertext raw = e.encrypt(slot_values(e));
+    const CiphertextViews encrypted_views = views(encrypted);
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->decrypt_vector(encrypted_views)); },
+            [&] {
+                seal::Plaintext plain;
+                e.decryptor->decrypt(raw, plain);
+                benchmark::DoNotOptimize(e.decode(plain).data());
+            });
+}
+BENCHMARK(bm_wrapper_decrypt_vector)->Apply(schemes_and_degrees);
+
+// sum_slots_inplace: log2(slots) rotate-and-add steps (BFV: rows, then columns)
+static void bm_wrapper_sum_slots(benchmark::State& state) {
+    Engine& e = engine(state);
+    const seal::Ciphertext input = e.he->deserialize(e.he->encrypt_vector(slot_values(e))[0]);
+    const seal::Ciphertext raw_input = e.encrypt(slot_values(e));
+    const seal::GaloisKeys& keys = e.slot_sum_keys();
+    compare(state, e,
+            [&] {
+                seal::Ciphertext total = input;
+                e.he->sum_slots_inplace(total);
+                benchmark::DoNotOptimize(total.data());
+            },
+            [&] {
+                seal::Ciphertext total = raw_input;
+                seal::Ciphertext rotated;
+                if (e.use_ckks) {
+                    for (size_t step = 1; step < e.he->slot_count(); step <<= 1) {
+                        e.evaluator->rotate_vector(total, static_cast<int>(step), keys, rotated);
+                        e.evaluator->add_inplace(total, rotated);
+                    }
+                } else {
+                    for (size_t step = 1; step < e.he->slot_count() / 2; step <<= 1) {
+                        e.evaluator->rotate_rows(total, static_cast<int>(step), keys, rotated);
+                        e.evaluator->add_inplace(total, rotated);
+                    }
+                    e.evaluator->rotate_columns(total, keys, rotated);
+                    e.evaluator->add_inplace(total, rotated);
+                }
+                benchmark::DoNotOptimize(total.data());
+            });
+}
+BENCHMARK(bm_wrapper_sum_slots)->Apply(schemes_and_degrees);
+
+// multiply + relinearize_inplace: one tensor product and one key switch
+static void bm_wrapper_multiply_relinearize(benchmark::State& state) {
+    Engine& e = engine(state);
+    const seal::Ciphertext a = e.he->deserialize(e.he->encrypt(3.0));
+    const seal::Ciphertext b = e.he->deserialize(e.he->encrypt(4.0));
+    const seal::Ciphertext raw_a = e.encrypt(first_slot(e, 3.0));
+    const seal::Ciphertext raw_b = e.encrypt(first_slot(e, 4.0));
+    if (e.use_ckks && e.he->chain_index(a) == 0) {
+        state.SkipWithError("No level for a CKKS product in this profile");
+        return;
+    }
+    compare(state, e,
+            [&] {
+                seal::Ciphertext product = e.he->multiply(a, b);
+                e.he->relinearize_inplace(product);
+                benchmark::DoNotOptimize(product.data());
+            },
+            [&] {
+                seal::Ciphertext product;
+                e.evaluator->multiply(raw_a, raw_b, product);
+                e.evaluator->relinearize_inplace(product, e.relin_keys);
+                benchmark::DoNotOptimize(product.data());
+            });
+}
+BENCHMARK(bm_wrapper_multiply_relinearize)->Apply(schemes_and_degrees);
+
+// serialize: save and Base64 vs. save into a buffer, uncompressed or with the default compression
+static void bm_wrapper_serialize(benchmark::State& state) {
+    Engine& e = engine(state);
+    const seal::compr_mode_type compression =
+        state.range(2) ? seal::Serialization::compr_mode_default : seal::compr_mode_type::none;
+    const WireOptions wire(WireFormat::base64, compression);
+    const seal::Ciphertext encrypted = e.he->deserialize(e.he->encrypt_vector(slot_values(e), uncompressed)[0]);
+    std::vector<seal::seal_byte> buffer(static_cast<size_t>(encrypted.save_size(compression)));
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->serialize(encrypted, wire)); },
+            [&] { benchmark::DoNotOptimize(encrypted.save(buffer.data(), buffer.size(), compression)); });
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+BENCHMARK(bm_wrapper_serialize)->Apply(schemes_degrees_and_compression);
+
+// deserialize: Base64 and load vs. load from a buffer
+static void bm_wrapper_deserialize(benchmark::State& state) {
+    Engine& e = engine(state);
+    const seal::compr_mode_type compression =
+        state.range(2) ? seal::Serialization::compr_mode_default : seal::compr_mode_type::none;
+    const seal::Ciphertext encrypted = e.he->deserialize(e.he->encrypt_vector(slot_values(e), uncompressed)[0]);
+    const std::string serialized = e.he->serialize(encrypted, WireOptions(WireFormat::base64, compression));
+    std::vector<seal::seal_byte> buffer(static_cast<size_t>(encrypted.save_size(compression)));
+    const size_t size = static_cast<size_t>(encrypted.save(buffer.data(), buffer.size(), compression));
+    compare(state, e, [&] { benchmark::DoNotOptimize(e.he->deserialize(serialized).data()); },
+            [&] {
+                seal::Ciphertext loaded;
+                loaded.load(*e.he->seal_context(), buffer.data(), size);
+                benchmark::DoNotOptimize(loaded.data());
+            });
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+BENCHMARK(bm_wrapper_deserialize)->Apply(schemes_degrees_and_compression);
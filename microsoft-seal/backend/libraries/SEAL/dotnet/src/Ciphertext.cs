@@ -3,7 +3,9 @@
 
 using Microsoft.Research.SEAL.Tools;
 using System;
+using System.Collections.Generic;
 using System.IO;
+using System.Linq;
 using System.Runtime.InteropServices;
 
 namespace Microsoft.Research.SEAL
@@ -595,6 +597,243 @@ namespace Microsoft.Research.SEAL
                 stream);
         }
 
+        /// <summary>Saves the ciphertext to a byte array.</summary>
+        /// <remarks>
+        /// Saves the ciphertext directly to <paramref name="buffer"/> from
+        /// <paramref name="offset"/> on. The array is pinned for the call instead of
+        /// the data going through a temporary buffer and a stream, so it needs room for
+        /// up to SaveSize(comprMode) bytes. The output is in binary format and not
+        /// human-readable.
+        /// </remarks>
+        /// <param name="buffer">The array to save the ciphertext to</param>
+        /// <param name="offset">The position in the array to start writing at</param>
+        /// <param name="comprMode">The desired compression mode</param>
+        /// <exception cref="ArgumentNullException">if buffer is null</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if offset is outside the
+        /// array</exception>
+        /// <exception cref="ArgumentException">if compression mode is not
+        /// supported</exception>
+        /// <exception cref="IOException">if the ciphertext does not fit in the
+        /// array</exception>
+        /// <exception cref="InvalidOperationException">if the data to be saved
+        /// is invalid, or if compression failed</exception>
+        public long Save(byte[] buffer, int offset, ComprModeType? comprMode = null)
+        {
+            comprMode = comprMode ?? Serialization.ComprModeDefault;
+            if (!Serialization.IsSupportedComprMode(comprMode.Value))
+                throw new ArgumentException("Unsupported compression mode");
+
+            return Serialization.Save(
+                (IntPtr outptr, ulong size, byte cm, out long outBytes) =>
+                    NativeMethods.Ciphertext_Save(NativePtr, outptr, size,
+                    cm, out outBytes),
+                comprMode.Value, buffer, offset);
+        }
+
+        /// <summary>Saves the ciphertext to unmanaged memory.</summary>
+        /// <remarks>
+        /// Saves the ciphertext directly to <paramref name="size"/> bytes at
+        /// <paramref name="buffer"/>, e.g. a pinned Span, memory-mapped file or
+        /// native allocation. The output is in binary format and not human-readable.
+        /// </remarks>
+        /// <param name="buffer">The memory to save the ciphertext to</param>
+        /// <param name="size">The number of bytes available at buffer</param>
+        /// <param name="comprMode">The desired compression mode</param>
+        /// <exception cref="ArgumentNullException">if buffer is zero</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if size is negative</exception>
+        /// <exception cref="ArgumentException">if compression mode is not
+        /// supported</exception>
+        /// <exception cref="IOException">if the ciphertext does not fit in
+        /// size bytes</exception>
+        /// <exception cref="InvalidOperationException">if the data to be saved
+        /// is invalid, or if compression failed</exception>
+        public long Save(IntPtr buffer, long size, ComprModeType? comprMode = null)
+        {
+            if (IntPtr.Zero == buffer)
+                throw new ArgumentNullException(nameof(buffer));
+            if (size < 0)
+                throw new ArgumentOutOfRangeException(nameof(size));
+            comprMode = comprMode ?? Serialization.ComprModeDefault;
+            if (!Serialization.IsSupportedComprMode(comprMode.Value))
+                throw new ArgumentException("Unsupported compression mode");
+
+            NativeMethods.Ciphertext_Save(NativePtr, buffer, (ulong)size,
+                (byte)comprMode.Value, out long outBytes);
+            return outBytes;
+        }
+
+        /// <summary>Loads a ciphertext from a byte array overwriting the current
+        /// ciphertext.</summary>
+        /// <remarks>
+        /// Loads a ciphertext directly from <paramref name="count"/> bytes of
+        /// <paramref name="buffer"/> at <paramref name="offset"/>, pinning the array
+        /// instead of copying it. The loaded ciphertext is verified to be valid for the
+        /// given SEALContext.
+        /// </remarks>
+        /// <param name="context">The SEALContext</param>
+        /// <param name="buffer">The array to load the ciphertext from</param>
+        /// <param name="offset">The position in the array to start reading at</param>
+        /// <param name="count">The number of bytes available from offset</param>
+        /// <exception cref="ArgumentNullException">if context or buffer is
+        /// null</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if offset and count do not
+        /// describe a range in the array</exception>
+        /// <exception cref="ArgumentException">if the encryption parameters are not valid</exception>
+        /// <exception cref="IOException">if the data ended unexpectedly</exception>
+        /// <exception cref="InvalidOperationException">if the data cannot be loaded
+        /// by this version of Microsoft SEAL, if the loaded data is invalid, or if the
+        /// loaded compression mode is not supported</exception>
+        public long Load(SEALContext context, byte[] buffer, int offset, int count)
+        {
+            if (null == context)
+                throw new ArgumentNullException(nameof(context));
+
+            return Serialization.Load(
+                (IntPtr inptr, ulong size, out long inBytes) =>
+                    NativeMethods.Ciphertext_Load(NativePtr, context.NativePtr,
+                    inptr, size, out inBytes),
+                buffer, offset, count);
+        }
+
+        /// <summary>Loads a ciphertext from unmanaged memory overwriting the current
+        /// ciphertext.</summary>
+        /// <remarks>
+        /// Loads a ciphertext directly from <paramref name="size"/> bytes at
+        /// <paramref name="buffer"/>. The loaded ciphertext is verified to be valid for
+        /// the given SEALContext.
+        /// </remarks>
+        /// <param name="context">The SEALContext</param>
+        /// <param name="buffer">The memory to load the ciphertext from</param>
+        /// <param name="size">The number of bytes available at buffer</param>
+        /// <exception cref="ArgumentNullException">if context is null or buffer is
+        /// zero</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if size is negative</exception>
+        /// <exception cref="ArgumentException">if the encryption parameters are not valid</exception>
+        /// <exception cref="IOException">if the data ended unexpectedly</exception>
+        /// <exception cref="InvalidOperationException">if the data cannot be loaded
+        /// by this version of Microsoft SEAL, if the loaded data is invalid, or if the
+        /// loaded compression mode is not supported</exception>
+        public long Load(SEALContext context, IntPtr buffer, long size)
+        {
+            if (null == context)
+                throw new ArgumentNullException(nameof(context));
+            if (IntPtr.Zero == buffer)
+                throw new ArgumentNullException(nameof(buffer));
+            if (size < 0)
+                throw new ArgumentOutOfRangeException(nameof(size));
+
+            NativeMethods.Ciphertext_Load(NativePtr, context.NativePtr, buffer,
+                (ulong)size, out long inBytes);
+            return inBytes;
+        }
+
+        /// <summary>
+        /// Returns an upper bound on the size of the ciphertexts, as if they were
+        /// written one after another by <see cref="SaveMany"/>.
+        /// </summary>
+        /// <param name="ciphertexts">The ciphertexts to save</param>
+        /// <param name="comprMode">The compression mode</param>
+        /// <exception cref="ArgumentNullException">if ciphertexts or any of its
+        /// elements is null</exception>
+        /// <exception cref="ArgumentException">if the compression mode is not
+        /// supported</exception>
+        /// <exception cref="InvalidOperationException">if the size does not fit in
+        /// the return type</exception>
+        public static long SaveSizeMany(IEnumerable<Ciphertext> ciphertexts, ComprModeType? comprMode = null)
+        {
+            IntPtr[] handles = Handles(ciphertexts, nameof(ciphertexts));
+            comprMode = comprMode ?? Serialization.ComprModeDefault;
+            if (!Serialization.IsSupportedComprMode(comprMode.Value))
+                throw new ArgumentException("Unsupported compression mode");
+
+            NativeMethods.Ciphertext_SaveSizeMany(
+                (ulong)handles.Length, handles, (byte)comprMode.Value, out long outBytes);
+            return outBytes;
+        }
+
+        /// <summary>Saves ciphertexts one after another to a byte array.</summary>
+        /// <remarks>
+        /// Saves every ciphertext in a single call to the native library, back to back
+        /// from <paramref name="offset"/> on, with the array pinned instead of copied.
+        /// Each ciphertext starts with a header holding its size, so
+        /// <see cref="LoadMany"/> can read them back. The array needs room for up to
+        /// <see cref="SaveSizeMany"/> bytes.
+        /// </remarks>
+        /// <param name="ciphertexts">The ciphertexts to save</param>
+        /// <param name="buffer">The array to save the ciphertexts to</param>
+        /// <param name="offset">The position in the array to start writing at</param>
+        /// <param name="comprMode">The desired compression mode</param>
+        /// <exception cref="ArgumentNullException">if ciphertexts, any of its
+        /// elements, or buffer is null</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if offset is outside the
+        /// array</exception>
+        /// <exception cref="ArgumentException">if compression mode is not
+        /// supported</exception>
+        /// <exception cref="IOException">if the ciphertexts do not fit in the
+        /// array</exception>
+        /// <exception cref="InvalidOperationException">if the data to be saved
+        /// is invalid, or if compression failed</exception>
+        public static long SaveMany(IEnumerable<Ciphertext> ciphertexts, byte[] buffer, int offset,
+            ComprModeType? comprMode = null)
+        {
+            IntPtr[] handles = Handles(ciphertexts, nameof(ciphertexts));
+            comprMode = comprMode ?? Serialization.ComprModeDefault;
+            if (!Serialization.IsSupportedComprMode(comprMode.Value))
+                throw new ArgumentException("Unsupported compression mode");
+
+            return Serialization.Save(
+                (IntPtr outptr, ulong size, byte cm, out long outBytes) =>
+                    NativeMethods.Ciphertext_SaveMany((ulong)handles.Length, handles,
+                    outptr, size, cm, out outBytes),
+                comprMode.Value, buffer, offset);
+        }
+
+        /// <summary>Loads ciphertexts saved by <see cref="SaveMany"/> from a byte
+        /// array, overwriting the given ones.</summary>
+        /// <remarks>
+        /// Loads one ciphertext into each element of <paramref name="ciphertexts"/>, in
+        /// order, in a single call to the native library. Each loaded ciphertext is
+        /// verified to be valid for the given SEALContext; if one is not, the ones
+        /// before it have been loaded already.
+        /// </remarks>
+        /// <param name="context">The SEALContext</param>
+        /// <param name="ciphertexts">The ciphertexts to overwrite</param>
+        /// <param name="buffer">The array to load the ciphertexts from</param>
+        /// <param name="offset">The position in the array to start reading at</param>
+        /// <param name="count">The number of bytes available from offset</param>
+        /// <exception cref="ArgumentNullException">if context, ciphertexts, any of its
+        /// elements, or buffer is null</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if offset and count do not
+        /// describe a range in the array</exception>
+        /// <exception cref="ArgumentException">if the encryption parameters are not valid</exception>
+        /// <exception cref="IOException">if the data ended unexpectedly</exception>
+        /// <exception cref="InvalidOperationException">if the data cannot be loaded
+        /// by this version of Microsoft SEAL, if the loaded data is invalid, or if the
+        /// loaded compression mode is not supported</exception>
+        public static long LoadMany(SEALContext context, IEnumerable<Ciphertext> ciphertexts, byte[] buffer,
+            int offset, int count)
+        {
+            if (null == context)
+                throw new ArgumentNullException(nameof(context));
+            IntPtr[] handles = Handles(ciphertexts, nameof(ciphertexts));
+
+            return Serialization.Load(
+                (IntPtr inptr, ulong size, out long inBytes) =>
+                    NativeMethods.Ciphertext_LoadMany((ulong)handles.Length, handles,
+                    context.NativePtr, inptr, size, out inBytes),
+                buffer, offset, count);
+        }
+
+        private static IntPtr[] Handles(IEnumerable<Ciphertext> ciphertexts, string name)
+        {
+            if (null == ciphertexts)
+                throw new ArgumentNullException(name);
+            IntPtr[] handles = ciphertexts.Select(c => c?.NativePtr ?? IntPtr.Zero).ToArray();
+            if (handles.Contains(IntPtr.Zero))
+                throw new ArgumentNullException(name);
+            return handles;
+        }
+
         /// <summary>
         /// Returns whether the ciphertext is in NTT form.
         /// </summary>
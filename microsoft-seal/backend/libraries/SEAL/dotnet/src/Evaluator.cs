@@ -188,6 +188,48 @@ namespace Microsoft.Research.SEAL
             NativeMethods.Evaluator_AddMany(NativePtr, (ulong)encarray.Length, encarray, destination.NativePtr);
         }
 
+        /// <summary>
+        /// Adds pairs of ciphertexts.
+        /// </summary>
+        /// <remarks>
+        /// This function adds encrypteds1[i] and encrypteds2[i] and stores the result in destinations[i], for every i,
+        /// in a single call to the native library. A destination may be one of its own inputs.
+        /// </remarks>
+        /// <param name="encrypteds1">The first inputs</param>
+        /// <param name="encrypteds2">The second inputs</param>
+        /// <param name="destinations">The ciphertexts to overwrite with the sums</param>
+        /// <exception cref="ArgumentNullException">if encrypteds1, encrypteds2, destinations or any of their elements
+        /// is null</exception>
+        /// <exception cref="ArgumentException">if encrypteds1, encrypteds2 and destinations differ in length</exception>
+        /// <exception cref="ArgumentException">if a pair is not valid for the encryption parameters</exception>
+        /// <exception cref="ArgumentException">if a pair is in different NTT forms</exception>
+        /// <exception cref="ArgumentException">if a pair is at different level or scale</exception>
+        /// <exception cref="InvalidOperationException">if a result ciphertext is transparent</exception>
+        public void AddBatch(IEnumerable<Ciphertext> encrypteds1, IEnumerable<Ciphertext> encrypteds2,
+            IEnumerable<Ciphertext> destinations)
+        {
+            if (null == encrypteds1)
+                throw new ArgumentNullException(nameof(encrypteds1));
+            if (null == encrypteds2)
+                throw new ArgumentNullException(nameof(encrypteds2));
+            if (null == destinations)
+                throw new ArgumentNullException(nameof(destinations));
+
+            IntPtr[] encarray1 = encrypteds1.Select(c => c?.NativePtr ?? IntPtr.Zero).ToArray();
+            IntPtr[] encarray2 = encrypteds2.Select(c => c?.NativePtr ?? IntPtr.Zero).ToArray();
+            IntPtr[] destarray = destinations.Select(c => c?.NativePtr ?? IntPtr.Zero).ToArray();
+            if (encarray1.Length != encarray2.Length || encarray1.Length != destarray.Length)
+                throw new ArgumentException("encrypteds1, encrypteds2 and destinations must have the same length");
+            if (encarray1.Contains(IntPtr.Zero))
+                throw new ArgumentNullException(nameof(encrypteds1));
+            if (encarray2.Contains(IntPtr.Zero))
+                throw new ArgumentNullException(nameof(encrypteds2));
+            if (destarray.Contains(IntPtr.Zero))
+                throw new ArgumentNullException(nameof(destinations));
+
+            NativeMethods.Evaluator_AddBatch(NativePtr, (ulong)encarray1.Length, encarray1, encarray2, destarray);
+        }
+
         /// <summary>
         /// Subtracts two ciphertexts.
         /// </summary>
@@ -321,6 +321,9 @@ namespace Microsoft.Research.SEAL
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void Evaluator_AddMany(IntPtr thisptr, ulong count, IntPtr[] encrypteds, IntPtr destination);
 
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void Evaluator_AddBatch(IntPtr thisptr, ulong count, IntPtr[] encrypteds1, IntPtr[] encrypteds2, IntPtr[] destinations);
+
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void Evaluator_AddPlain(IntPtr thisptr, IntPtr encrypted, IntPtr plain, IntPtr destination);
 
@@ -511,6 +514,21 @@ namespace Microsoft.Research.SEAL
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void Ciphertext_UnsafeLoad(IntPtr thisptr, IntPtr context, byte[] inptr, ulong size, out long inBytes);
 
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void Ciphertext_Save(IntPtr thisptr, IntPtr outptr, ulong size, byte comprMode, out long outBytes);
+
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void Ciphertext_Load(IntPtr thisptr, IntPtr context, IntPtr inptr, ulong size, out long inBytes);
+
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void Ciphertext_SaveSizeMany(ulong count, IntPtr[] ciphers, byte comprMode, out long result);
+
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void Ciphertext_SaveMany(ulong count, IntPtr[] ciphers, IntPtr outptr, ulong size, byte comprMode, out long outBytes);
+
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void Ciphertext_LoadMany(ulong count, IntPtr[] ciphers, IntPtr context, IntPtr inptr, ulong size, out long inBytes);
+
 #endregion
 
 #region Plaintext methods
@@ -675,6 +693,12 @@ namespace Microsoft.Research.SEAL
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void KSwitchKeys_Load(IntPtr thisptr, IntPtr context, byte[] inptr, ulong size, out long inBytes);
 
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void KSwitchKeys_Save(IntPtr thisptr, IntPtr outptr, ulong size, byte comprMode, out long outBytes);
+
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void KSwitchKeys_Load(IntPtr thisptr, IntPtr context, IntPtr inptr, ulong size, out long inBytes);
+
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void KSwitchKeys_UnsafeLoad(IntPtr thisptr, IntPtr context, byte[] inptr, ulong size, out long inBytes);
 
@@ -760,6 +784,12 @@ namespace Microsoft.Research.SEAL
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void PublicKey_Load(IntPtr thisptr, IntPtr context, byte[] inptr, ulong size, out long inBytes);
 
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void PublicKey_Save(IntPtr thisptr, IntPtr outptr, ulong size, byte comprMode, out long outBytes);
+
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void PublicKey_Load(IntPtr thisptr, IntPtr context, IntPtr inptr, ulong size, out long inBytes);
+
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void PublicKey_UnsafeLoad(IntPtr thisptr, IntPtr context, byte[] inptr, ulong size, out long inBytes);
 
@@ -797,6 +827,12 @@ namespace Microsoft.Research.SEAL
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void SecretKey_Load(IntPtr thisptr, IntPtr context, byte[] inptr, ulong size, out long inBytes);
 
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void SecretKey_Save(IntPtr thisptr, IntPtr outptr, ulong size, byte comprMode, out long outBytes);
+
+        [DllImport(sealc, PreserveSig = false)]
+        internal static extern void SecretKey_Load(IntPtr thisptr, IntPtr context, IntPtr inptr, ulong size, out long inBytes);
+
         [DllImport(sealc, PreserveSig = false)]
         internal static extern void SecretKey_UnsafeLoad(IntPtr thisptr, IntPtr context, byte[] inptr, ulong size, out long inBytes);
 
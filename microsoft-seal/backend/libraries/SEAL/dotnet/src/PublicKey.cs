@@ -199,6 +199,136 @@ namespace Microsoft.Research.SEAL
                 stream);
         }
 
+        /// <summary>Saves the PublicKey to a byte array.</summary>
+        /// <remarks>
+        /// Saves the PublicKey directly to <paramref name="buffer"/> from
+        /// <paramref name="offset"/> on. The array is pinned for the call instead of
+        /// the data going through a temporary buffer and a stream, so it needs room for
+        /// up to SaveSize(comprMode) bytes. The output is in binary format and not
+        /// human-readable.
+        /// </remarks>
+        /// <param name="buffer">The array to save the PublicKey to</param>
+        /// <param name="offset">The position in the array to start writing at</param>
+        /// <param name="comprMode">The desired compression mode</param>
+        /// <exception cref="ArgumentNullException">if buffer is null</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if offset is outside the
+        /// array</exception>
+        /// <exception cref="ArgumentException">if compression mode is not
+        /// supported</exception>
+        /// <exception cref="IOException">if the PublicKey does not fit in the
+        /// array</exception>
+        /// <exception cref="InvalidOperationException">if the data to be saved
+        /// is invalid, or if compression failed</exception>
+        public long Save(byte[] buffer, int offset, ComprModeType? comprMode = null)
+        {
+            comprMode = comprMode ?? Serialization.ComprModeDefault;
+            if (!Serialization.IsSupportedComprMode(comprMode.Value))
+                throw new ArgumentException("Unsupported compression mode");
+
+            return Serialization.Save(
+                (IntPtr outptr, ulong size, byte cm, out long outBytes) =>
+                    NativeMethods.PublicKey_Save(NativePtr, outptr, size,
+                    cm, out outBytes),
+                comprMode.Value, buffer, offset);
+        }
+
+        /// <summary>Saves the PublicKey to unmanaged memory.</summary>
+        /// <remarks>
+        /// Saves the PublicKey directly to <paramref name="size"/> bytes at
+        /// <paramref name="buffer"/>, e.g. a pinned Span, memory-mapped file or
+        /// native allocation. The output is in binary format and not human-readable.
+        /// </remarks>
+        /// <param name="buffer">The memory to save the PublicKey to</param>
+        /// <param name="size">The number of bytes available at buffer</param>
+        /// <param name="comprMode">The desired compression mode</param>
+        /// <exception cref="ArgumentNullException">if buffer is zero</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if size is negative</exception>
+        /// <exception cref="ArgumentException">if compression mode is not
+        /// supported</exception>
+        /// <exception cref="IOException">if the PublicKey does not fit in
+        /// size bytes</exception>
+        /// <exception cref="InvalidOperationException">if the data to be saved
+        /// is invalid, or if compression failed</exception>
+        public long Save(IntPtr buffer, long size, ComprModeType? comprMode = null)
+        {
+            if (IntPtr.Zero == buffer)
+                throw new ArgumentNullException(nameof(buffer));
+            if (size < 0)
+                throw new ArgumentOutOfRangeException(nameof(size));
+            comprMode = comprMode ?? Serialization.ComprModeDefault;
+            if (!Serialization.IsSupportedComprMode(comprMode.Value))
+                throw new ArgumentException("Unsupported compression mode");
+
+            NativeMethods.PublicKey_Save(NativePtr, buffer, (ulong)size,
+                (byte)comprMode.Value, out long outBytes);
+            return outBytes;
+        }
+
+        /// <summary>Loads a PublicKey from a byte array overwriting the current
+        /// PublicKey.</summary>
+        /// <remarks>
+        /// Loads a PublicKey directly from <paramref name="count"/> bytes of
+        /// <paramref name="buffer"/> at <paramref name="offset"/>, pinning the array
+        /// instead of copying it. The loaded PublicKey is verified to be valid for the
+        /// given SEALContext.
+        /// </remarks>
+        /// <param name="context">The SEALContext</param>
+        /// <param name="buffer">The array to load the PublicKey from</param>
+        /// <param name="offset">The position in the array to start reading at</param>
+        /// <param name="count">The number of bytes available from offset</param>
+        /// <exception cref="ArgumentNullException">if context or buffer is
+        /// null</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if offset and count do not
+        /// describe a range in the array</exception>
+        /// <exception cref="ArgumentException">if the encryption parameters are not valid</exception>
+        /// <exception cref="IOException">if the data ended unexpectedly</exception>
+        /// <exception cref="InvalidOperationException">if the data cannot be loaded
+        /// by this version of Microsoft SEAL, if the loaded data is invalid, or if the
+        /// loaded compression mode is not supported</exception>
+        public long Load(SEALContext context, byte[] buffer, int offset, int count)
+        {
+            if (null == context)
+                throw new ArgumentNullException(nameof(context));
+
+            return Serialization.Load(
+                (IntPtr inptr, ulong size, out long inBytes) =>
+                    NativeMethods.PublicKey_Load(NativePtr, context.NativePtr,
+                    inptr, size, out inBytes),
+                buffer, offset, count);
+        }
+
+        /// <summary>Loads a PublicKey from unmanaged memory overwriting the current
+        /// PublicKey.</summary>
+        /// <remarks>
+        /// Loads a PublicKey directly from <paramref name="size"/> bytes at
+        /// <paramref name="buffer"/>. The loaded PublicKey is verified to be valid for
+        /// the given SEALContext.
+        /// </remarks>
+        /// <param name="context">The SEALContext</param>
+        /// <param name="buffer">The memory to load the PublicKey from</param>
+        /// <param name="size">The number of bytes available at buffer</param>
+        /// <exception cref="ArgumentNullException">if context is null or buffer is
+        /// zero</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if size is negative</exception>
+        /// <exception cref="ArgumentException">if the encryption parameters are not valid</exception>
+        /// <exception cref="IOException">if the data ended unexpectedly</exception>
+        /// <exception cref="InvalidOperationException">if the data cannot be loaded
+        /// by this version of Microsoft SEAL, if the loaded data is invalid, or if the
+        /// loaded compression mode is not supported</exception>
+        public long Load(SEALContext context, IntPtr buffer, long size)
+        {
+            if (null == context)
+                throw new ArgumentNullException(nameof(context));
+            if (IntPtr.Zero == buffer)
+                throw new ArgumentNullException(nameof(buffer));
+            if (size < 0)
+                throw new ArgumentOutOfRangeException(nameof(size));
+
+            NativeMethods.PublicKey_Load(NativePtr, context.NativePtr, buffer,
+                (ulong)size, out long inBytes);
+            return inBytes;
+        }
+
         /// <summary>
         /// Returns a copy of ParmsId.
         /// </summary>
@@ -25,7 +25,13 @@ namespace Microsoft.Research.SEAL
         ZLIB = 1,
 
         /// <summary>Use Zstandard compression.</summary>
-        ZSTD = 2
+        ZSTD = 2,
+
+        /// <summary>
+        /// Bit-pack each RNS component of a ciphertext to the width of its largest
+        /// coefficient; other objects are saved as with None.
+        /// </summary>
+        Bitpack = 3
     }
 
     /// <summary>Class to provide functionality for serialization.</summary>
@@ -240,6 +246,12 @@ namespace Microsoft.Research.SEAL
         internal delegate void LoadDelegate(
             byte[] inptr, ulong size, out long inBytes);
 
+        internal delegate void SavePtrDelegate(
+            IntPtr outptr, ulong size, byte comprMode, out long outBytes);
+
+        internal delegate void LoadPtrDelegate(
+            IntPtr inptr, ulong size, out long inBytes);
+
         /// <summary>Saves data to a given binary stream.</summary>
         /// <remarks>
         /// First this function allocates a buffer of size <paramref name="size" />. The buffer is used by the
@@ -356,6 +368,84 @@ namespace Microsoft.Research.SEAL
                 throw new InvalidOperationException("Size indicated by loaded SEALHeader is out of bounds", ex);
             }
         }
+
+        /// <summary>Saves data directly to a byte array.</summary>
+        /// <remarks>
+        /// The array is pinned while <paramref name="SaveData"/> writes to it from
+        /// <paramref name="offset"/>, so no temporary buffer is allocated and nothing is
+        /// copied. This function is intended only for internal use.
+        /// </remarks>
+        /// <param name="SaveData">The delegate that writes some number of bytes to a given buffer</param>
+        /// <param name="comprMode">The desired compression mode</param>
+        /// <param name="buffer">The destination array</param>
+        /// <param name="offset">The position in the array to start writing at</param>
+        /// <exception cref="ArgumentNullException">if SaveData or buffer is null</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if offset is outside the array</exception>
+        /// <exception cref="IOException">if the data does not fit in the array</exception>
+        /// <exception cref="InvalidOperationException">if the data to be saved is invalid, if compression mode is not
+        /// supported, or if compression failed</exception>
+        internal static long Save(SavePtrDelegate SaveData, ComprModeType comprMode, byte[] buffer, int offset)
+        {
+            if (null == SaveData)
+                throw new ArgumentNullException(nameof(SaveData));
+            if (null == buffer)
+                throw new ArgumentNullException(nameof(buffer));
+            if (offset < 0 || offset > buffer.Length)
+                throw new ArgumentOutOfRangeException(nameof(offset));
+            if (!IsSupportedComprMode(comprMode))
+                throw new InvalidOperationException("Unsupported compression mode");
+
+            GCHandle handle = GCHandle.Alloc(buffer, GCHandleType.Pinned);
+            try
+            {
+                SaveData(IntPtr.Add(handle.AddrOfPinnedObject(), offset), (ulong)(buffer.Length - offset),
+                    (byte)comprMode, out long outBytes);
+                return outBytes;
+            }
+            finally
+            {
+                handle.Free();
+            }
+        }
+
+        /// <summary>Loads data directly from a byte array.</summary>
+        /// <remarks>
+        /// The array is pinned while <paramref name="LoadData"/> reads from it, so the data
+        /// is not first copied to a temporary buffer. This function is intended only for
+        /// internal use.
+        /// </remarks>
+        /// <param name="LoadData">The delegate that reads some number of bytes from a given buffer</param>
+        /// <param name="buffer">The source array</param>
+        /// <param name="offset">The position in the array to start reading at</param>
+        /// <param name="count">The number of bytes available from offset</param>
+        /// <exception cref="ArgumentNullException">if LoadData or buffer is null</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if offset and count do not describe a range in the
+        /// array</exception>
+        /// <exception cref="IOException">if the data ends unexpectedly</exception>
+        /// <exception cref="InvalidOperationException">if the loaded data is invalid, or if the loaded compression
+        /// mode is not supported</exception>
+        internal static long Load(LoadPtrDelegate LoadData, byte[] buffer, int offset, int count)
+        {
+            if (null == LoadData)
+                throw new ArgumentNullException(nameof(LoadData));
+            if (null == buffer)
+                throw new ArgumentNullException(nameof(buffer));
+            if (offset < 0 || offset > buffer.Length)
+                throw new ArgumentOutOfRangeException(nameof(offset));
+            if (count < 0 || count > buffer.Length - offset)
+                throw new ArgumentOutOfRangeException(nameof(count));
+
+            GCHandle handle = GCHandle.Alloc(buffer, GCHandleType.Pinned);
+            try
+            {
+                LoadData(IntPtr.Add(handle.AddrOfPinnedObject(), offset), (ulong)count, out long inBytes);
+                return inBytes;
+            }
+            finally
+            {
+                handle.Free();
+            }
+        }
     }
 
     /// <summary>Class to contain header information for legacy headers.</summary>
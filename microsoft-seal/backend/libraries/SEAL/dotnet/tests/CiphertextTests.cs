@@ -6,7 +6,9 @@ using Microsoft.VisualStudio.TestTools.UnitTesting;
 using System;
 using System.Collections.Generic;
 using System.IO;
+using System.Linq;
 using System.Numerics;
+using System.Runtime.InteropServices;
 
 namespace SEALNetTest
 {
@@ -265,6 +267,94 @@ namespace SEALNetTest
             }
         }
 
+        [TestMethod]
+        public void BufferSaveLoadTest()
+        {
+            SEALContext context = GlobalContext.BFVContext;
+            KeyGenerator keygen = new KeyGenerator(context);
+            keygen.CreatePublicKey(out PublicKey publicKey);
+
+            Encryptor encryptor = new Encryptor(context, publicKey);
+            Ciphertext cipher = new Ciphertext();
+            encryptor.Encrypt(new Plaintext("2x^3 + 4x^2 + 5x^1 + 6"), cipher);
+            ulong ulongCount = cipher.Size * cipher.PolyModulusDegree * cipher.CoeffModulusSize;
+
+            // Managed array, at an offset
+            byte[] buffer = new byte[16 + cipher.SaveSize()];
+            long saved = cipher.Save(buffer, 16);
+            Assert.IsTrue(saved > 0 && saved <= cipher.SaveSize());
+
+            Ciphertext loaded = new Ciphertext();
+            Assert.AreEqual(saved, loaded.Load(context, buffer, 16, (int)saved));
+            Assert.IsTrue(ValCheck.IsValidFor(loaded, context));
+            for (ulong i = 0; i < ulongCount; i++)
+            {
+                Assert.AreEqual(cipher[i], loaded[i]);
+            }
+
+            // Unmanaged memory
+            IntPtr memory = Marshal.AllocHGlobal((IntPtr)cipher.SaveSize(ComprModeType.None));
+            try
+            {
+                saved = cipher.Save(memory, cipher.SaveSize(ComprModeType.None), ComprModeType.None);
+                loaded = new Ciphertext();
+                Assert.AreEqual(saved, loaded.Load(context, memory, saved));
+            }
+            finally
+            {
+                Marshal.FreeHGlobal(memory);
+            }
+            for (ulong i = 0; i < ulongCount; i++)
+            {
+                Assert.AreEqual(cipher[i], loaded[i]);
+            }
+
+            Utilities.AssertThrows<ArgumentNullException>(() => cipher.Save((byte[])null, 0));
+            Utilities.AssertThrows<ArgumentOutOfRangeException>(() => cipher.Save(buffer, buffer.Length + 1));
+            Utilities.AssertThrows<IOException>(() => cipher.Save(new byte[16], 0));
+            Utilities.AssertThrows<ArgumentOutOfRangeException>(() => loaded.Load(context, buffer, 16, buffer.Length));
+        }
+
+        [TestMethod]
+        public void SaveManyLoadManyTest()
+        {
+            SEALContext context = GlobalContext.BFVContext;
+            KeyGenerator keygen = new KeyGenerator(context);
+            keygen.CreatePublicKey(out PublicKey publicKey);
+
+            Encryptor encryptor = new Encryptor(context, publicKey);
+            Decryptor decryptor = new Decryptor(context, keygen.SecretKey);
+            Ciphertext[] ciphers = new Ciphertext[5];
+            for (int i = 0; i < ciphers.Length; i++)
+            {
+                ciphers[i] = new Ciphertext();
+                encryptor.Encrypt(new Plaintext((i + 1).ToString()), ciphers[i]);
+            }
+
+            long saveSize = Ciphertext.SaveSizeMany(ciphers);
+            Assert.AreEqual(ciphers.Sum(c => c.SaveSize()), saveSize);
+            byte[] buffer = new byte[saveSize];
+            long saved = Ciphertext.SaveMany(ciphers, buffer, 0);
+
+            Ciphertext[] loaded = new Ciphertext[ciphers.Length];
+            for (int i = 0; i < loaded.Length; i++)
+            {
+                loaded[i] = new Ciphertext();
+            }
+            Assert.AreEqual(saved, Ciphertext.LoadMany(context, loaded, buffer, 0, (int)saved));
+
+            Plaintext plain = new Plaintext();
+            for (int i = 0; i < loaded.Length; i++)
+            {
+                decryptor.Decrypt(loaded[i], plain);
+                Assert.AreEqual((ulong)(i + 1), plain[0]);
+            }
+
+            Utilities.AssertThrows<ArgumentNullException>(() => Ciphertext.SaveMany(new Ciphertext[] { null }, buffer, 0));
+            Utilities.AssertThrows<IOException>(() => Ciphertext.SaveMany(ciphers, new byte[saveSize / 2], 0));
+            Utilities.AssertThrows<IOException>(() => Ciphertext.LoadMany(context, loaded, buffer, 0, (int)saved / 2));
+        }
+
         [TestMethod]
         public void BFVIndexTest()
         {
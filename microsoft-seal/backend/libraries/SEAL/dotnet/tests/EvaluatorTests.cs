@@ -409,6 +409,57 @@ namespace SEALNetTest
             }
         }
 
+        [TestMethod]
+        public void AddBatchTest()
+        {
+            EncryptionParameters parms = new EncryptionParameters(SchemeType.BFV)
+            {
+                PolyModulusDegree = 64,
+                PlainModulus = new Modulus(1 << 6),
+                CoeffModulus = CoeffModulus.Create(64, new int[] { 40 })
+            };
+            SEALContext context = new SEALContext(parms,
+                expandModChain: false,
+                secLevel: SecLevelType.None);
+            KeyGenerator keygen = new KeyGenerator(context);
+            keygen.CreatePublicKey(out PublicKey publicKey);
+
+            Encryptor encryptor = new Encryptor(context, publicKey);
+            Decryptor decryptor = new Decryptor(context, keygen.SecretKey);
+            Evaluator evaluator = new Evaluator(context);
+
+            Ciphertext[] encrypteds1 = new Ciphertext[4];
+            Ciphertext[] encrypteds2 = new Ciphertext[4];
+            Ciphertext[] destinations = new Ciphertext[4];
+            for (int i = 0; i < encrypteds1.Length; i++)
+            {
+                encrypteds1[i] = new Ciphertext();
+                encrypteds2[i] = new Ciphertext();
+                encryptor.Encrypt(new Plaintext((i + 1).ToString()), encrypteds1[i]);
+                encryptor.Encrypt(new Plaintext((10 * (i + 1)).ToString("X")), encrypteds2[i]);
+                destinations[i] = new Ciphertext();
+            }
+            // A destination may be one of its inputs
+            destinations[3] = encrypteds1[3];
+
+            evaluator.AddBatch(encrypteds1, encrypteds2, destinations);
+
+            Plaintext plaindest = new Plaintext();
+            for (int i = 0; i < destinations.Length; i++)
+            {
+                decryptor.Decrypt(destinations[i], plaindest);
+                Assert.AreEqual((ulong)(11 * (i + 1)), plaindest[0]);
+            }
+
+            // AddMany into one of its own inputs
+            evaluator.AddMany(encrypteds2, encrypteds2[0]);
+            decryptor.Decrypt(encrypteds2[0], plaindest);
+            Assert.AreEqual(100ul % 64ul, plaindest[0]);
+
+            Utilities.AssertThrows<ArgumentException>(() => evaluator.AddBatch(encrypteds1, encrypteds2, new Ciphertext[1]));
+            Utilities.AssertThrows<ArgumentNullException>(() => evaluator.AddBatch(encrypteds1, encrypteds2, new Ciphertext[4]));
+        }
+
         [TestMethod]
         public void SubTest()
         {
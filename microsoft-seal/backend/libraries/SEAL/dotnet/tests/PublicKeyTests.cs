@@ -150,6 +150,29 @@ namespace SEALNetTest
             }
         }
 
+        [TestMethod]
+        public void BufferSaveLoadTest()
+        {
+            SEALContext context = GlobalContext.BFVContext;
+            KeyGenerator keygen = new KeyGenerator(context);
+            keygen.CreatePublicKey(out PublicKey pub);
+            keygen.CreateRelinKeys(out RelinKeys relinKeys);
+
+            byte[] buffer = new byte[pub.SaveSize()];
+            long saved = pub.Save(buffer, 0);
+            PublicKey pub2 = new PublicKey();
+            Assert.AreEqual(saved, pub2.Load(context, buffer, 0, (int)saved));
+            Assert.AreEqual(pub.ParmsId, pub2.ParmsId);
+            Assert.IsTrue(ValCheck.IsValidFor(pub2, context));
+
+            buffer = new byte[relinKeys.SaveSize()];
+            saved = relinKeys.Save(buffer, 0);
+            RelinKeys relinKeys2 = new RelinKeys();
+            Assert.AreEqual(saved, relinKeys2.Load(context, buffer, 0, (int)saved));
+            Assert.AreEqual(relinKeys.Size, relinKeys2.Size);
+            Assert.IsTrue(ValCheck.IsValidFor(relinKeys2, context));
+        }
+
         [TestMethod]
         public void ExceptionsTest()
         {
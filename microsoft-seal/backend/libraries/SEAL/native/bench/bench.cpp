@@ -70,6 +70,7 @@ namespace sealbench
         SEAL_BENCHMARK_REGISTER(BFV, n, log_q, Decrypt, bm_bfv_decrypt, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EncodeBatch, bm_bfv_encode_batch, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(BFV, n, log_q, DecodeBatch, bm_bfv_decode_batch, bm_env_bfv);
+        SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EncodeBatchMany8, bm_bfv_encode_batch_many, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EvaluateAddCt, bm_bfv_add_ct, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EvaluateAddPt, bm_bfv_add_pt, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EvaluateNegate, bm_bfv_negate, bm_env_bfv);
@@ -87,6 +88,7 @@ namespace sealbench
             SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EvaluateRelinInplace, bm_bfv_relin_inplace, bm_env_bfv);
             SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EvaluateRotateRows, bm_bfv_rotate_rows, bm_env_bfv);
             SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EvaluateRotateCols, bm_bfv_rotate_cols, bm_env_bfv);
+            SEAL_BENCHMARK_REGISTER(BFV, n, log_q, EvaluateRotateMany8, bm_bfv_rotate_many, bm_env_bfv);
         }
 
         SEAL_BENCHMARK_REGISTER(BGV, n, log_q, EncryptSecret, bm_bgv_encrypt_secret, bm_env_bgv);
@@ -142,6 +144,7 @@ namespace sealbench
         {
             SEAL_BENCHMARK_REGISTER(CKKS, n, log_q, EvaluateRelinInplace, bm_ckks_relin_inplace, bm_env_ckks);
             SEAL_BENCHMARK_REGISTER(CKKS, n, log_q, EvaluateRotate, bm_ckks_rotate, bm_env_ckks);
+            SEAL_BENCHMARK_REGISTER(CKKS, n, log_q, EvaluateRotateMany8, bm_ckks_rotate_many, bm_env_ckks);
         }
         SEAL_BENCHMARK_REGISTER(UTIL, n, log_q, NTTForward, bm_util_ntt_forward, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(UTIL, n, log_q, NTTInverse, bm_util_ntt_inverse, bm_env_bfv);
@@ -149,8 +152,43 @@ namespace sealbench
         SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTInverseLowLevel, bm_util_ntt_inverse_low_level, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTForwardLowLevelLazy, bm_util_ntt_forward_low_level_lazy, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTInverseLowLevelLazy, bm_util_ntt_inverse_low_level_lazy, bm_env_bfv);
+        SEAL_BENCHMARK_REGISTER(
+            UTIL, n, log_q, DecryptScaleAndRound, bm_util_decrypt_scale_and_round, bm_env_bfv);
+        if (bm_env_bfv->context().first_context_data()->parms().coeff_modulus().size() > 1)
+        {
+            SEAL_BENCHMARK_REGISTER(
+                UTIL, n, log_q, DivideAndRoundQLastNTT, bm_util_divide_and_round_q_last_ntt, bm_env_bfv);
+        }
+        SEAL_BENCHMARK_REGISTER(UTIL, n, log_q, PRNGBlake2xb, bm_util_prng_blake2xb, bm_env_bfv);
+        SEAL_BENCHMARK_REGISTER(UTIL, n, log_q, PRNGShake256, bm_util_prng_shake256, bm_env_bfv);
+        SEAL_BENCHMARK_REGISTER(UTIL, n, log_q, PRNGAES128CTR, bm_util_prng_aes128ctr, bm_env_bfv);
     }
 
+
+    /**
+    Relinearization and rotation with hybrid key switching: the data primes of a default parameter set followed by
+    special_modulus_size special primes, so that keys have one component per group of that many data primes.
+    Registered for 1, 2 and 4 special primes, and reporting the size of the relinearization key, to compare latency
+    and key size for the same multiplicative depth.
+    */
+    void register_bm_key_switching(const shared_ptr<BMEnv> &bm_env)
+    {
+        auto &parms = bm_env->parms();
+        int n = static_cast<int>(parms.poly_modulus_degree());
+        int log_q = static_cast<int>(bm_env->context().key_context_data()->total_coeff_modulus_bit_count());
+        string prefix = string("n=") + to_string(n) + string(" / log(q)=") + to_string(log_q) +
+                        string(" / CKKS / special=") + to_string(parms.special_modulus_size()) + string(" / ");
+        double key_bytes = static_cast<double>(bm_env->rlk().save_size(compr_mode_type::none));
+        RegisterBenchmark((prefix + "EvaluateRelinInplace").c_str(), [=](State &st) {
+            bm_ckks_relin_inplace(st, bm_env);
+            st.counters["key_bytes"] = key_bytes;
+        })
+            ->Unit(benchmark::kMicrosecond)
+            ->Iterations(10);
+        RegisterBenchmark((prefix + "EvaluateRotate").c_str(), [=](State &st) { bm_ckks_rotate(st, bm_env); })
+            ->Unit(benchmark::kMicrosecond)
+            ->Iterations(10);
+    }
 } // namespace sealbench
 
 int main(int argc, char **argv)
@@ -203,6 +241,31 @@ int main(int argc, char **argv)
         }
     }
 
+    // Hybrid key switching at the larger degrees, where there are enough data primes to group.
+    vector<shared_ptr<BMEnv>> bm_key_switching_envs;
+    for (auto &i : default_parms)
+    {
+        if (i.first < 16384)
+        {
+            continue;
+        }
+        vector<int> bit_sizes;
+        for (auto &prime : i.second)
+        {
+            bit_sizes.push_back(prime.bit_count());
+        }
+        for (size_t special : { 1, 2, 4 })
+        {
+            vector<int> special_bit_sizes = bit_sizes;
+            special_bit_sizes.insert(special_bit_sizes.end(), special - 1, bit_sizes.back());
+            EncryptionParameters parms_ckks(scheme_type::ckks);
+            parms_ckks.set_poly_modulus_degree(i.first);
+            parms_ckks.set_coeff_modulus(CoeffModulus::Create(i.first, special_bit_sizes));
+            parms_ckks.set_special_modulus_size(special);
+            bm_key_switching_envs.push_back(make_shared<BMEnv>(parms_ckks));
+        }
+    }
+
     // Now that precomputation have taken place, here is the total memory consumption by SEAL memory pool.
     cout << "[" << setw(7) << right << (seal::MemoryManager::GetPool().alloc_byte_count() >> 20) << " MB] "
          << "Total allocation from the memory pool" << endl;
@@ -212,6 +275,10 @@ int main(int argc, char **argv)
     {
         sealbench::register_bm_family(i, bm_env_map);
     }
+    for (auto &bm_env : bm_key_switching_envs)
+    {
+        sealbench::register_bm_key_switching(bm_env);
+    }
 
     RunSpecifiedBenchmarks();
 
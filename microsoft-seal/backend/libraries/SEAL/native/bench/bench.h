@@ -356,6 +356,15 @@ namespace sealbench
     void bm_util_ntt_forward_low_level_lazy(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_util_ntt_inverse_low_level_lazy(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
 
+    // RNSTool benchmark cases
+    void bm_util_decrypt_scale_and_round(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_util_divide_and_round_q_last_ntt(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+
+    // PRNG benchmark cases
+    void bm_util_prng_blake2xb(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_util_prng_shake256(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_util_prng_aes128ctr(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+
     // KeyGen benchmark cases
     void bm_keygen_secret(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_keygen_public(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
@@ -368,6 +377,7 @@ namespace sealbench
     void bm_bfv_decrypt(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bfv_encode_batch(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bfv_decode_batch(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_bfv_encode_batch_many(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bfv_add_ct(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bfv_add_pt(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bfv_negate(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
@@ -380,6 +390,7 @@ namespace sealbench
     void bm_bfv_relin_inplace(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bfv_rotate_rows(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bfv_rotate_cols(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_bfv_rotate_many(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
 
     // BGV-specific benchmark cases
     void bm_bgv_encrypt_secret(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
@@ -425,4 +436,5 @@ namespace sealbench
     void bm_ckks_rescale_inplace(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_ckks_relin_inplace(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_ckks_rotate(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_ckks_rotate_many(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
 } // namespace sealbench
@@ -86,6 +86,25 @@ namespace sealbench
         }
     }
 
+    void bm_bfv_encode_batch_many(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        vector<uint64_t> &msg = bm_env->msg_uint64();
+        vector<uint64_t> values(8 * msg.size());
+        vector<Plaintext> pt;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            for (size_t i = 0; i < 8; i++)
+            {
+                bm_env->randomize_message_uint64(msg);
+                copy(msg.begin(), msg.end(), values.begin() + static_cast<ptrdiff_t>(i * msg.size()));
+            }
+
+            state.ResumeTiming();
+            bm_env->batch_encoder()->encode_many(values.data(), values.size(), pt);
+        }
+    }
+
     void bm_bfv_add_ct(State &state, shared_ptr<BMEnv> bm_env)
     {
         vector<Ciphertext> &ct = bm_env->ct();
@@ -252,4 +271,20 @@ namespace sealbench
             bm_env->evaluator()->rotate_columns(ct[0], bm_env->glk(), ct[2]);
         }
     }
+
+    void bm_bfv_rotate_many(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        vector<Ciphertext> &ct = bm_env->ct();
+        vector<Ciphertext> rotated;
+        // BMEnv only has the Galois key for one step; eight rotations by it still share one decomposition
+        const vector<int> steps(8, 1);
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            bm_env->randomize_ct_bfv(ct[0]);
+
+            state.ResumeTiming();
+            bm_env->evaluator()->rotate_many(ct[0], steps, bm_env->glk(), rotated);
+        }
+    }
 } // namespace sealbench
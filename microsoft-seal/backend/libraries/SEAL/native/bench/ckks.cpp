@@ -266,4 +266,20 @@ namespace sealbench
             bm_env->evaluator()->rotate_vector(ct[0], 1, bm_env->glk(), ct[2]);
         }
     }
+
+    void bm_ckks_rotate_many(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        vector<Ciphertext> &ct = bm_env->ct();
+        vector<Ciphertext> rotated;
+        // BMEnv only has the Galois key for one step; eight rotations by it still share one decomposition
+        const vector<int> steps(8, 1);
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            bm_env->randomize_ct_ckks(ct[0]);
+
+            state.ResumeTiming();
+            bm_env->evaluator()->rotate_many(ct[0], steps, bm_env->glk(), rotated);
+        }
+    }
 } // namespace sealbench
@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/seal.h"
+#include "seal/util/rlwe.h"
+#include "bench.h"
+
+using namespace benchmark;
+using namespace sealbench;
+using namespace seal;
+using namespace std;
+
+/**
+This file defines benchmarks for expanding a seed into a uniform polynomial with each PRNG, which is how the second
+component of a seeded ciphertext or key is recovered.
+*/
+
+namespace sealbench
+{
+    namespace
+    {
+        void bm_util_prng(State &state, shared_ptr<BMEnv> bm_env, UniformRandomGeneratorFactory &factory)
+        {
+            const EncryptionParameters &parms = bm_env->context().first_context_data()->parms();
+            vector<Ciphertext> &ct = bm_env->ct();
+            prng_seed_type seed = { 1, 2, 3, 4, 5, 6, 7, 8 };
+            for (auto _ : state)
+            {
+                // A fresh PRNG per polynomial, as when loading seeded objects
+                auto prng = factory.create(seed);
+                util::sample_poly_uniform(prng, parms, ct[0].data());
+            }
+        }
+    } // namespace
+
+    void bm_util_prng_blake2xb(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        Blake2xbPRNGFactory factory;
+        bm_util_prng(state, bm_env, factory);
+    }
+
+    void bm_util_prng_shake256(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        Shake256PRNGFactory factory;
+        bm_util_prng(state, bm_env, factory);
+    }
+
+    void bm_util_prng_aes128ctr(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        AES128CTRPRNGFactory factory;
+        bm_util_prng(state, bm_env, factory);
+    }
+} // namespace sealbench
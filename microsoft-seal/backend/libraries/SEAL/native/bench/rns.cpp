@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/seal.h"
+#include "seal/util/rns.h"
+#include "bench.h"
+
+using namespace benchmark;
+using namespace sealbench;
+using namespace seal;
+using namespace std;
+
+/**
+This file defines benchmarks for the RNSTool steps that dominate BFV decryption and modulus switching, without the
+rest of Decryptor::decrypt and Evaluator::mod_switch_to_next.
+*/
+
+namespace sealbench
+{
+    void bm_util_decrypt_scale_and_round(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        auto context_data = bm_env->context().first_context_data();
+        const util::RNSTool *rns_tool = context_data->rns_tool();
+        vector<uint64_t> destination(context_data->parms().poly_modulus_degree());
+        vector<Ciphertext> &ct = bm_env->ct();
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            bm_env->randomize_ct_bfv(ct[0]);
+
+            state.ResumeTiming();
+            rns_tool->decrypt_scale_and_round(
+                util::ConstRNSIter(ct[0].data(), ct[0].poly_modulus_degree()), destination.data(),
+                seal::MemoryManager::GetPool());
+        }
+    }
+
+    void bm_util_divide_and_round_q_last_ntt(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        auto context_data = bm_env->context().first_context_data();
+        const util::RNSTool *rns_tool = context_data->rns_tool();
+        vector<Ciphertext> &ct = bm_env->ct();
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            bm_env->randomize_ct_bfv(ct[0]);
+
+            state.ResumeTiming();
+            rns_tool->divide_and_round_q_last_ntt_inplace(
+                util::RNSIter(ct[0].data(), ct[0].poly_modulus_degree()), context_data->small_ntt_tables(),
+                seal::MemoryManager::GetPool());
+        }
+    }
+} // namespace sealbench
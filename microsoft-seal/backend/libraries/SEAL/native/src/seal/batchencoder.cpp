@@ -8,12 +8,19 @@
 #include <limits>
 #include <random>
 #include <stdexcept>
+#include <type_traits>
 
 using namespace std;
 using namespace seal::util;
 
 namespace seal
 {
+    namespace
+    {
+        // Plaintexts per batched NTT call of encode_many and decode_many; the AVX2 kernels go across four at a time
+        constexpr size_t ntt_batch_count = 4;
+    } // namespace
+
     BatchEncoder::BatchEncoder(const SEALContext &context) : context_(context)
     {
         // Verify parameters
@@ -107,6 +114,62 @@ namespace seal
         }
     }
 
+    void BatchEncoder::write_matrix(const uint64_t *values, size_t count, uint64_t *destination) const
+    {
+        // Zero-fill first, so a short input scatters only its own values
+        if (count < slots_)
+        {
+            set_zero_uint(slots_, destination);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            destination[matrix_reps_index_map_[i]] = values[i];
+        }
+    }
+
+    void BatchEncoder::write_matrix(const int64_t *values, size_t count, uint64_t *destination) const
+    {
+        uint64_t modulus = context_.first_context_data()->parms().plain_modulus().value();
+        if (count < slots_)
+        {
+            set_zero_uint(slots_, destination);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            destination[matrix_reps_index_map_[i]] = (values[i] < 0) ? (modulus + static_cast<uint64_t>(values[i]))
+                                                                     : static_cast<uint64_t>(values[i]);
+        }
+    }
+
+    void BatchEncoder::read_matrix(const uint64_t *coeffs, uint64_t *destination) const
+    {
+        for (size_t i = 0; i < slots_; i++)
+        {
+            destination[i] = coeffs[matrix_reps_index_map_[i]];
+        }
+    }
+
+    void BatchEncoder::read_matrix(const uint64_t *coeffs, int64_t *destination) const
+    {
+        uint64_t modulus = context_.first_context_data()->parms().plain_modulus().value();
+        uint64_t plain_modulus_div_two = modulus >> 1;
+        for (size_t i = 0; i < slots_; i++)
+        {
+            uint64_t curr_value = coeffs[matrix_reps_index_map_[i]];
+            destination[i] = (curr_value > plain_modulus_div_two)
+                                 ? (static_cast<int64_t>(curr_value) - static_cast<int64_t>(modulus))
+                                 : static_cast<int64_t>(curr_value);
+        }
+    }
+
+    void BatchEncoder::copy_coeffs(const Plaintext &plain, uint64_t *destination) const
+    {
+        // Never include the leading zero coefficient (if present)
+        size_t plain_coeff_count = min(plain.coeff_count(), slots_);
+        set_uint(plain.data(), plain_coeff_count, destination);
+        set_zero_uint(slots_ - plain_coeff_count, destination + plain_coeff_count);
+    }
+
     void BatchEncoder::encode(const vector<uint64_t> &values_matrix, Plaintext &destination) const
     {
         auto &context_data = *context_.first_context_data();
@@ -134,14 +197,7 @@ namespace seal
 
         // First write the values to destination coefficients.
         // Read in top row, then bottom row.
-        for (size_t i = 0; i < values_matrix_size; i++)
-        {
-            *(destination.data() + matrix_reps_index_map_[i]) = values_matrix[i];
-        }
-        for (size_t i = values_matrix_size; i < slots_; i++)
-        {
-            *(destination.data() + matrix_reps_index_map_[i]) = 0;
-        }
+        write_matrix(values_matrix.data(), values_matrix_size, destination.data());
 
         // Transform destination using inverse of negacyclic NTT
         // Note: We already performed bit-reversal when reading in the matrix
@@ -151,7 +207,6 @@ namespace seal
     void BatchEncoder::encode(const vector<int64_t> &values_matrix, Plaintext &destination) const
     {
         auto &context_data = *context_.first_context_data();
-        uint64_t modulus = context_data.parms().plain_modulus().value();
 
         // Validate input parameters
         size_t values_matrix_size = values_matrix.size();
@@ -160,6 +215,7 @@ namespace seal
             throw invalid_argument("values_matrix size is too large");
         }
 #ifdef SEAL_DEBUG
+        uint64_t modulus = context_data.parms().plain_modulus().value();
         uint64_t plain_modulus_div_two = modulus >> 1;
         for (auto v : values_matrix)
         {
@@ -176,16 +232,7 @@ namespace seal
 
         // First write the values to destination coefficients.
         // Read in top row, then bottom row.
-        for (size_t i = 0; i < values_matrix_size; i++)
-        {
-            *(destination.data() + matrix_reps_index_map_[i]) =
-                (values_matrix[i] < 0) ? (modulus + static_cast<uint64_t>(values_matrix[i]))
-                                       : static_cast<uint64_t>(values_matrix[i]);
-        }
-        for (size_t i = values_matrix_size; i < slots_; i++)
-        {
-            *(destination.data() + matrix_reps_index_map_[i]) = 0;
-        }
+        write_matrix(values_matrix.data(), values_matrix_size, destination.data());
 
         // Transform destination using inverse of negacyclic NTT
         // Note: We already performed bit-reversal when reading in the matrix
@@ -218,14 +265,7 @@ namespace seal
         destination.parms_id() = parms_id_zero;
 
         // First write the values to destination coefficients. Read in top row, then bottom row.
-        for (size_t i = 0; i < values_matrix_size; i++)
-        {
-            *(destination.data() + matrix_reps_index_map_[i]) = values_matrix[i];
-        }
-        for (size_t i = values_matrix_size; i < slots_; i++)
-        {
-            *(destination.data() + matrix_reps_index_map_[i]) = 0;
-        }
+        write_matrix(values_matrix.data(), values_matrix_size, destination.data());
 
         // Transform destination using inverse of negacyclic NTT
         // Note: We already performed bit-reversal when reading in the matrix
@@ -235,7 +275,6 @@ namespace seal
     void BatchEncoder::encode(gsl::span<const int64_t> values_matrix, Plaintext &destination) const
     {
         auto &context_data = *context_.first_context_data();
-        uint64_t modulus = context_data.parms().plain_modulus().value();
 
         // Validate input parameters
         size_t values_matrix_size = static_cast<size_t>(values_matrix.size());
@@ -244,6 +283,7 @@ namespace seal
             throw invalid_argument("values_matrix size is too large");
         }
 #ifdef SEAL_DEBUG
+        uint64_t modulus = context_data.parms().plain_modulus().value();
         uint64_t plain_modulus_div_two = modulus >> 1;
         for (auto v : values_matrix)
         {
@@ -259,16 +299,7 @@ namespace seal
         destination.parms_id() = parms_id_zero;
 
         // First write the values to destination coefficients. Read in top row, then bottom row.
-        for (size_t i = 0; i < values_matrix_size; i++)
-        {
-            *(destination.data() + matrix_reps_index_map_[i]) =
-                (values_matrix[i] < 0) ? (modulus + static_cast<uint64_t>(values_matrix[i]))
-                                       : static_cast<uint64_t>(values_matrix[i]);
-        }
-        for (size_t i = values_matrix_size; i < slots_; i++)
-        {
-            *(destination.data() + matrix_reps_index_map_[i]) = 0;
-        }
+        write_matrix(values_matrix.data(), values_matrix_size, destination.data());
 
         // Transform destination using inverse of negacyclic NTT
         // Note: We already performed bit-reversal when reading in the matrix
@@ -357,6 +388,188 @@ namespace seal
                                  : static_cast<int64_t>(curr_value);
         }
     }
+    uint64_t BatchEncoder::decode_slot(const Plaintext &plain, size_t slot) const
+    {
+        if (slot >= slots_)
+        {
+            throw invalid_argument("slot index is out of range");
+        }
+        auto &modulus = context_.first_context_data()->parms().plain_modulus();
+
+        // The NTT leaves the evaluation at roots_of_unity_[j] in bit-reversed position j
+        MultiplyUIntModOperand root;
+        root.set(roots_of_unity_[util::reverse_bits(matrix_reps_index_map_[slot], get_power_of_two(slots_))], modulus);
+
+        // Never include the leading zero coefficient (if present)
+        size_t plain_coeff_count = min(plain.coeff_count(), slots_);
+        uint64_t value = 0;
+        for (size_t k = plain_coeff_count; k-- > 0;)
+        {
+            value = add_uint_mod(multiply_uint_mod(value, root, modulus), plain[k], modulus);
+        }
+        return value;
+    }
+
+    void BatchEncoder::decode_slots(
+        const Plaintext &plain, const vector<size_t> &slots, vector<uint64_t> &destination) const
+    {
+        if (!is_valid_for(plain, context_))
+        {
+            throw invalid_argument("plain is not valid for encryption parameters");
+        }
+        if (plain.is_ntt_form())
+        {
+            throw invalid_argument("plain cannot be in NTT form");
+        }
+
+        destination.resize(slots.size());
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            destination[i] = decode_slot(plain, slots[i]);
+        }
+    }
+
+    void BatchEncoder::decode_slots(
+        const Plaintext &plain, const vector<size_t> &slots, vector<int64_t> &destination) const
+    {
+        vector<uint64_t> values;
+        decode_slots(plain, slots, values);
+
+        uint64_t modulus = context_.first_context_data()->parms().plain_modulus().value();
+        uint64_t plain_modulus_div_two = modulus >> 1;
+        destination.resize(values.size());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            destination[i] = (values[i] > plain_modulus_div_two)
+                                 ? (static_cast<int64_t>(values[i]) - static_cast<int64_t>(modulus))
+                                 : static_cast<int64_t>(values[i]);
+        }
+    }
+
+    template <typename T>
+    void BatchEncoder::encode_many_internal(
+        const T *values, size_t value_count, vector<Plaintext> &destinations, MemoryPoolHandle pool) const
+    {
+        if (!values && value_count)
+        {
+            throw invalid_argument("values cannot be null");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+
+        auto &context_data = *context_.first_context_data();
+#ifdef SEAL_DEBUG
+        uint64_t modulus = context_data.parms().plain_modulus().value();
+        for (size_t i = 0; i < value_count; i++)
+        {
+            // Validate the i-th input
+            bool valid = is_signed<T>::value ? !unsigned_gt(llabs(static_cast<int64_t>(values[i])), modulus >> 1)
+                                             : static_cast<uint64_t>(values[i]) < modulus;
+            if (!valid)
+            {
+                throw invalid_argument("input value is larger than plain_modulus");
+            }
+        }
+#endif
+        size_t plain_count = value_count / slots_ + (value_count % slots_ != 0);
+        destinations.resize(plain_count);
+        if (!plain_count)
+        {
+            return;
+        }
+
+        // Matrices are written back to back for the batched inverse NTT, then copied out
+        size_t batch_count = min(plain_count, ntt_batch_count);
+        auto batch(allocate_uint(mul_safe(batch_count, slots_), pool));
+        for (size_t first = 0; first < plain_count; first += batch_count)
+        {
+            size_t count = min(batch_count, plain_count - first);
+            for (size_t j = 0; j < count; j++)
+            {
+                size_t offset = (first + j) * slots_;
+                write_matrix(values + offset, min(slots_, value_count - offset), batch.get() + j * slots_);
+            }
+            inverse_ntt_negacyclic_harvey(batch.get(), count, *context_data.plain_ntt_tables());
+            for (size_t j = 0; j < count; j++)
+            {
+                Plaintext &destination = destinations[first + j];
+                destination.resize(slots_);
+                destination.parms_id() = parms_id_zero;
+                set_uint(batch.get() + j * slots_, slots_, destination.data());
+            }
+        }
+    }
+
+    void BatchEncoder::encode_many(
+        const uint64_t *values, size_t value_count, vector<Plaintext> &destinations, MemoryPoolHandle pool) const
+    {
+        encode_many_internal(values, value_count, destinations, move(pool));
+    }
+
+    void BatchEncoder::encode_many(
+        const int64_t *values, size_t value_count, vector<Plaintext> &destinations, MemoryPoolHandle pool) const
+    {
+        encode_many_internal(values, value_count, destinations, move(pool));
+    }
+
+    template <typename T>
+    void BatchEncoder::decode_many_internal(
+        const vector<Plaintext> &plains, vector<T> &destination, MemoryPoolHandle pool) const
+    {
+        for (auto &plain : plains)
+        {
+            if (!is_valid_for(plain, context_))
+            {
+                throw invalid_argument("plain is not valid for encryption parameters");
+            }
+            if (plain.is_ntt_form())
+            {
+                throw invalid_argument("plain cannot be in NTT form");
+            }
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+
+        auto &context_data = *context_.first_context_data();
+        destination.resize(mul_safe(plains.size(), slots_));
+        if (plains.empty())
+        {
+            return;
+        }
+
+        size_t batch_count = min(plains.size(), ntt_batch_count);
+        auto batch(allocate_uint(mul_safe(batch_count, slots_), pool));
+        for (size_t first = 0; first < plains.size(); first += batch_count)
+        {
+            size_t count = min(batch_count, plains.size() - first);
+            for (size_t j = 0; j < count; j++)
+            {
+                copy_coeffs(plains[first + j], batch.get() + j * slots_);
+            }
+            ntt_negacyclic_harvey(batch.get(), count, *context_data.plain_ntt_tables());
+            for (size_t j = 0; j < count; j++)
+            {
+                read_matrix(batch.get() + j * slots_, destination.data() + (first + j) * slots_);
+            }
+        }
+    }
+
+    void BatchEncoder::decode_many(
+        const vector<Plaintext> &plains, vector<uint64_t> &destination, MemoryPoolHandle pool) const
+    {
+        decode_many_internal(plains, destination, move(pool));
+    }
+
+    void BatchEncoder::decode_many(
+        const vector<Plaintext> &plains, vector<int64_t> &destination, MemoryPoolHandle pool) const
+    {
+        decode_many_internal(plains, destination, move(pool));
+    }
+
 #ifdef SEAL_USE_MSGSL
     void BatchEncoder::decode(const Plaintext &plain, gsl::span<uint64_t> destination, MemoryPoolHandle pool) const
     {
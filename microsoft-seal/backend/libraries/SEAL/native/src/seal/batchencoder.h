@@ -211,6 +211,108 @@ namespace seal
             const Plaintext &plain, gsl::span<std::int64_t> destination,
             MemoryPoolHandle pool = MemoryManager::GetPool()) const;
 #endif
+        /**
+        Batches a long vector of integers modulo the plaintext modulus into as many
+        plaintexts as it takes: destinations is resized to ceil(value_count / slot_count())
+        and its i-th plaintext holds values [i * slot_count(), (i + 1) * slot_count()),
+        the last one zero-padded, exactly as encode of each chunk would produce. The
+        setup is done once, and the inverse NTTs run through the batched entry points
+        (see util::inverse_ntt_negacyclic_harvey) on a few plaintexts at a time.
+
+        @param[in] values The integers modulo plaintext modulus to batch
+        @param[in] value_count The number of values
+        @param[out] destinations The plaintexts to overwrite with the result
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if values is null and value_count is not zero
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        void encode_many(
+            const std::uint64_t *values, std::size_t value_count, std::vector<Plaintext> &destinations,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Batches a long vector of signed integers into as many plaintexts as it takes,
+        as the signed encode does for each chunk; see the unsigned encode_many.
+
+        @param[in] values The integers to batch, of absolute value at most half the plaintext modulus
+        @param[in] value_count The number of values
+        @param[out] destinations The plaintexts to overwrite with the result
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if values is null and value_count is not zero
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        void encode_many(
+            const std::int64_t *values, std::size_t value_count, std::vector<Plaintext> &destinations,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Inverse of encode_many. Unbatches the plaintexts one after another into
+        destination, which is resized to plains.size() * slot_count(), exactly as
+        decode of each plaintext would; the forward NTTs run through the batched
+        entry points.
+
+        @param[in] plains The plaintext polynomials to unbatch
+        @param[out] destination The vector to be overwritten with the values in the slots
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if a plaintext is not valid for the encryption parameters
+        @throws std::invalid_argument if a plaintext is in NTT form
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        void decode_many(
+            const std::vector<Plaintext> &plains, std::vector<std::uint64_t> &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Inverse of the signed encode_many; see the unsigned decode_many.
+
+        @param[in] plains The plaintext polynomials to unbatch
+        @param[out] destination The vector to be overwritten with the values in the slots
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if a plaintext is not valid for the encryption parameters
+        @throws std::invalid_argument if a plaintext is in NTT form
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        void decode_many(
+            const std::vector<Plaintext> &plains, std::vector<std::int64_t> &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Decodes only the given slots of a plaintext. Each slot is the plaintext
+        polynomial evaluated at that slot's root of unity modulo the plaintext
+        modulus, computed by Horner's rule in O(N) instead of the full O(N log N)
+        NTT, so reading a few slots (e.g. a scalar result in slot 0) is cheaper
+        than decode. The input plaintext must be valid for the encryption
+        parameters and not in NTT form, as for decode.
+
+        @param[in] plain The plaintext polynomial to unbatch
+        @param[in] slots The slot indices to decode, each less than slot_count()
+        @param[out] destination The vector to be overwritten with the values in
+        the given slots, in the same order
+        @throws std::invalid_argument if plain is not valid for the encryption parameters
+        @throws std::invalid_argument if plain is in NTT form
+        @throws std::invalid_argument if a slot index is out of range
+        */
+        void decode_slots(
+            const Plaintext &plain, const std::vector<std::size_t> &slots,
+            std::vector<std::uint64_t> &destination) const;
+
+        /**
+        Decodes only the given slots of a plaintext into signed integers, as the
+        signed decode does (values above half the plaintext modulus are negative);
+        see the unsigned decode_slots.
+
+        @param[in] plain The plaintext polynomial to unbatch
+        @param[in] slots The slot indices to decode, each less than slot_count()
+        @param[out] destination The vector to be overwritten with the values in
+        the given slots, in the same order
+        @throws std::invalid_argument if plain is not valid for the encryption parameters
+        @throws std::invalid_argument if plain is in NTT form
+        @throws std::invalid_argument if a slot index is out of range
+        */
+        void decode_slots(
+            const Plaintext &plain, const std::vector<std::size_t> &slots,
+            std::vector<std::int64_t> &destination) const;
+
         /**
         Returns the number of slots.
         */
@@ -234,6 +336,31 @@ namespace seal
 
         void reverse_bits(std::uint64_t *input);
 
+        // Writes count values (count <= slots_) to their bit-reversed coefficient positions, zeros to the rest
+        void write_matrix(const std::uint64_t *values, std::size_t count, std::uint64_t *destination) const;
+
+        void write_matrix(const std::int64_t *values, std::size_t count, std::uint64_t *destination) const;
+
+        // Reads the slots of forward-transformed coefficients, top row then bottom row
+        void read_matrix(const std::uint64_t *coeffs, std::uint64_t *destination) const;
+
+        void read_matrix(const std::uint64_t *coeffs, std::int64_t *destination) const;
+
+        // Copies a valid plaintext's coefficients into slots_ words, zero-padded
+        void copy_coeffs(const Plaintext &plain, std::uint64_t *destination) const;
+
+        template <typename T>
+        void encode_many_internal(
+            const T *values, std::size_t value_count, std::vector<Plaintext> &destinations,
+            MemoryPoolHandle pool) const;
+
+        template <typename T>
+        void decode_many_internal(
+            const std::vector<Plaintext> &plains, std::vector<T> &destination, MemoryPoolHandle pool) const;
+
+        // Value of one slot of a valid plaintext in coefficient form, by Horner's rule
+        std::uint64_t decode_slot(const Plaintext &plain, std::size_t slot) const;
+
         MemoryPoolHandle pool_ = MemoryManager::GetPool();
 
         SEALContext context_;
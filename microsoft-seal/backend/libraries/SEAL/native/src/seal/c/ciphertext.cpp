@@ -7,6 +7,7 @@
 
 // SEAL
 #include "seal/ciphertext.h"
+#include "seal/util/common.h"
 
 using namespace std;
 using namespace seal;
@@ -575,3 +576,103 @@ SEAL_C_FUNC Ciphertext_Load(void *thisptr, void *context, uint8_t *inptr, uint64
         return COR_E_IO;
     }
 }
+
+SEAL_C_FUNC Ciphertext_SaveSizeMany(uint64_t count, void **ciphers, uint8_t compr_mode, int64_t *result)
+{
+    IfNullRet(ciphers, E_POINTER);
+    IfNullRet(result, E_POINTER);
+
+    Ciphertext **ciphers_pp = reinterpret_cast<Ciphertext **>(ciphers);
+    try
+    {
+        streamoff total = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            IfNullRet(ciphers_pp[i], E_POINTER);
+            total = util::add_safe(total, ciphers_pp[i]->save_size(static_cast<compr_mode_type>(compr_mode)));
+        }
+        *result = util::safe_cast<int64_t>(total);
+        return S_OK;
+    }
+    catch (const invalid_argument &)
+    {
+        return E_INVALIDARG;
+    }
+    catch (const logic_error &)
+    {
+        return COR_E_INVALIDOPERATION;
+    }
+}
+
+SEAL_C_FUNC Ciphertext_SaveMany(
+    uint64_t count, void **ciphers, uint8_t *outptr, uint64_t size, uint8_t compr_mode, int64_t *out_bytes)
+{
+    IfNullRet(ciphers, E_POINTER);
+    IfNullRet(outptr, E_POINTER);
+    IfNullRet(out_bytes, E_POINTER);
+
+    // The ciphertexts are written back to back; each starts with a SEALHeader holding its size, so LoadMany can
+    // find where the next one begins
+    Ciphertext **ciphers_pp = reinterpret_cast<Ciphertext **>(ciphers);
+    try
+    {
+        size_t offset = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            IfNullRet(ciphers_pp[i], E_POINTER);
+            offset += static_cast<size_t>(ciphers_pp[i]->save(
+                reinterpret_cast<seal_byte *>(outptr) + offset, util::safe_cast<size_t>(size) - offset,
+                static_cast<compr_mode_type>(compr_mode)));
+        }
+        *out_bytes = util::safe_cast<int64_t>(offset);
+        return S_OK;
+    }
+    catch (const invalid_argument &)
+    {
+        return E_INVALIDARG;
+    }
+    catch (const logic_error &)
+    {
+        return COR_E_INVALIDOPERATION;
+    }
+    catch (const runtime_error &)
+    {
+        return COR_E_IO;
+    }
+}
+
+SEAL_C_FUNC Ciphertext_LoadMany(
+    uint64_t count, void **ciphers, void *context, uint8_t *inptr, uint64_t size, int64_t *in_bytes)
+{
+    IfNullRet(ciphers, E_POINTER);
+    const SEALContext *ctx = FromVoid<SEALContext>(context);
+    IfNullRet(ctx, E_POINTER);
+    IfNullRet(inptr, E_POINTER);
+    IfNullRet(in_bytes, E_POINTER);
+
+    Ciphertext **ciphers_pp = reinterpret_cast<Ciphertext **>(ciphers);
+    try
+    {
+        size_t offset = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            IfNullRet(ciphers_pp[i], E_POINTER);
+            offset += static_cast<size_t>(ciphers_pp[i]->load(
+                *ctx, reinterpret_cast<seal_byte *>(inptr) + offset, util::safe_cast<size_t>(size) - offset));
+        }
+        *in_bytes = util::safe_cast<int64_t>(offset);
+        return S_OK;
+    }
+    catch (const invalid_argument &)
+    {
+        return E_INVALIDARG;
+    }
+    catch (const logic_error &)
+    {
+        return COR_E_INVALIDOPERATION;
+    }
+    catch (const runtime_error &)
+    {
+        return COR_E_IO;
+    }
+}
@@ -84,3 +84,11 @@ SEAL_C_FUNC Ciphertext_Save(void *thisptr, uint8_t *outptr, uint64_t size, uint8
 SEAL_C_FUNC Ciphertext_UnsafeLoad(void *thisptr, void *context, uint8_t *inptr, uint64_t size, int64_t *in_bytes);
 
 SEAL_C_FUNC Ciphertext_Load(void *thisptr, void *context, uint8_t *inptr, uint64_t size, int64_t *in_bytes);
+
+SEAL_C_FUNC Ciphertext_SaveSizeMany(uint64_t count, void **ciphers, uint8_t compr_mode, int64_t *result);
+
+SEAL_C_FUNC Ciphertext_SaveMany(
+    uint64_t count, void **ciphers, uint8_t *outptr, uint64_t size, uint8_t compr_mode, int64_t *out_bytes);
+
+SEAL_C_FUNC Ciphertext_LoadMany(
+    uint64_t count, void **ciphers, void *context, uint8_t *inptr, uint64_t size, int64_t *in_bytes);
@@ -114,17 +114,65 @@ SEAL_C_FUNC Evaluator_AddMany(void *thisptr, uint64_t count, void **encrypteds,
     IfNullRet(destination_ptr, E_POINTER);
 
     Ciphertext **encrypteds_pp = reinterpret_cast<Ciphertext **>(encrypteds);
-    vector<Ciphertext> encrypteds_vec;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        IfNullRet(encrypteds_pp[i], E_POINTER);
+    }
 
-    encrypteds_vec.reserve(count);
+    // Sum straight from the handles instead of copying every input into a vector first; add_many rejects a
+    // destination that is also an input, so only then sum into a temporary
+    const Ciphertext *const *inputs = encrypteds_pp;
+    bool aliased = find(encrypteds_pp, encrypteds_pp + count, destination_ptr) != encrypteds_pp + count;
+
+    try
+    {
+        if (aliased)
+        {
+            Ciphertext sum;
+            eval->add_many(inputs, count, sum);
+            *destination_ptr = move(sum);
+        }
+        else
+        {
+            eval->add_many(inputs, count, *destination_ptr);
+        }
+        return S_OK;
+    }
+    catch (const invalid_argument &)
+    {
+        return E_INVALIDARG;
+    }
+    catch (const logic_error &)
+    {
+        return COR_E_INVALIDOPERATION;
+    }
+}
+
+SEAL_C_FUNC Evaluator_AddBatch(
+    void *thisptr, uint64_t count, void **encrypteds1, void **encrypteds2, void **destinations)
+{
+    Evaluator *eval = FromVoid<Evaluator>(thisptr);
+    IfNullRet(eval, E_POINTER);
+    IfNullRet(encrypteds1, E_POINTER);
+    IfNullRet(encrypteds2, E_POINTER);
+    IfNullRet(destinations, E_POINTER);
+
+    Ciphertext **encrypteds1_pp = reinterpret_cast<Ciphertext **>(encrypteds1);
+    Ciphertext **encrypteds2_pp = reinterpret_cast<Ciphertext **>(encrypteds2);
+    Ciphertext **destinations_pp = reinterpret_cast<Ciphertext **>(destinations);
     for (uint64_t i = 0; i < count; i++)
     {
-        encrypteds_vec.emplace_back(*encrypteds_pp[i]);
+        IfNullRet(encrypteds1_pp[i], E_POINTER);
+        IfNullRet(encrypteds2_pp[i], E_POINTER);
+        IfNullRet(destinations_pp[i], E_POINTER);
     }
 
     try
     {
-        eval->add_many(encrypteds_vec, *destination_ptr);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            eval->add(*encrypteds1_pp[i], *encrypteds2_pp[i], *destinations_pp[i]);
+        }
         return S_OK;
     }
     catch (const invalid_argument &)
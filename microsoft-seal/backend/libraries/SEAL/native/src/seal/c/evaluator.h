@@ -23,6 +23,9 @@ SEAL_C_FUNC Evaluator_Add(void *thisptr, void *encrypted1, void *encrypted2, voi
 
 SEAL_C_FUNC Evaluator_AddMany(void *thisptr, uint64_t count, void **encrypteds, void *destination);
 
+SEAL_C_FUNC Evaluator_AddBatch(
+    void *thisptr, uint64_t count, void **encrypteds1, void **encrypteds2, void **destinations);
+
 SEAL_C_FUNC Evaluator_AddPlain(void *thisptr, void *encrypted, void *plain, void *destination);
 
 SEAL_C_FUNC Evaluator_Sub(void *thisptr, void *encrypted1, void *encrypted2, void *destination);
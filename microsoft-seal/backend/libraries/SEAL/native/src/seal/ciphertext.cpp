@@ -7,12 +7,77 @@
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/rlwe.h"
 #include <algorithm>
+#include <cstring>
 
 using namespace std;
 using namespace seal::util;
 
 namespace seal
 {
+    namespace
+    {
+        // Bytes of n coefficients of the given width packed back to back
+        inline size_t packed_byte_count(size_t n, int width)
+        {
+            return static_cast<size_t>((static_cast<uint64_t>(n) * static_cast<uint64_t>(width) + 7) / 8);
+        }
+
+        // Widths up to this always leave a coefficient inside one unaligned 64-bit word, whatever its bit offset;
+        // wider components are saved whole, as width 64
+        constexpr int max_packed_width = bits_per_uint64 - bits_per_byte;
+
+        inline bool is_saved_width(int width)
+        {
+            return width <= max_packed_width || width == bits_per_uint64;
+        }
+
+        // Packs n values below 2^width into a little-endian bit stream of packed_byte_count(n, width) bytes. The
+        // output must have room for bytes_per_uint64 more: every step stores a whole word, without branches.
+        void pack_bits(const uint64_t *in, size_t n, int width, seal_byte *out)
+        {
+            if (width == bits_per_uint64)
+            {
+                memcpy(out, in, n * bytes_per_uint64);
+                return;
+            }
+            // Every 8 coefficients end on a byte boundary, so groups of 8 are packed independently of each other
+            for (size_t group = 0; group < n; group += bits_per_byte, in += bits_per_byte, out += width)
+            {
+                size_t group_size = min<size_t>(bits_per_byte, n - group);
+                seal_byte *word = out;
+                uint64_t acc = 0;
+                int filled = 0;
+                for (size_t i = 0; i < group_size; i++)
+                {
+                    acc |= in[i] << filled;
+                    filled += width;
+                    memcpy(word, &acc, bytes_per_uint64);
+                    word += filled / bits_per_byte;
+                    acc >>= filled & ~(bits_per_byte - 1);
+                    filled &= bits_per_byte - 1;
+                }
+            }
+        }
+
+        // Inverse of pack_bits; reads up to bytes_per_uint64 bytes past the packed ones
+        void unpack_bits(const seal_byte *in, size_t n, int width, uint64_t *out)
+        {
+            if (width == bits_per_uint64)
+            {
+                memcpy(out, in, n * bytes_per_uint64);
+                return;
+            }
+            const uint64_t mask = (uint64_t(1) << width) - 1;
+            uint64_t bit = 0;
+            for (size_t i = 0; i < n; i++, bit += static_cast<uint64_t>(width))
+            {
+                uint64_t word;
+                memcpy(&word, in + bit / bits_per_byte, bytes_per_uint64);
+                out[i] = (word >> (bit % bits_per_byte)) & mask;
+            }
+        }
+    } // namespace
+
     Ciphertext &Ciphertext::operator=(const Ciphertext &assign)
     {
         // Check for self-assignment
@@ -155,6 +220,11 @@ namespace seal
         // We need to consider two cases: seeded and unseeded; these have very
         // different size characteristics and we need the exact size when
         // compr_mode is compr_mode_type::none.
+        if (compr_mode == compr_mode_type::bitpack)
+        {
+            return bitpacked_save_size(bitpack_widths());
+        }
+
         size_t data_size;
         if (has_seed_marker())
         {
@@ -187,6 +257,146 @@ namespace seal
         return safe_cast<streamoff>(add_safe(sizeof(Serialization::SEALHeader), members_size));
     }
 
+    vector<uint8_t> Ciphertext::bitpack_widths() const
+    {
+        // A seeded ciphertext saves only its first polynomial
+        size_t limb_count = mul_safe(has_seed_marker() ? size_t(1) : size_, coeff_modulus_size_);
+        vector<uint8_t> widths(limb_count, 0);
+        const ct_coeff_type *limb = data_.cbegin();
+        for (size_t i = 0; i < limb_count; i++, limb += poly_modulus_degree_)
+        {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < poly_modulus_degree_; j++)
+            {
+                bits |= limb[j];
+            }
+            int width = get_significant_bit_count(bits);
+            widths[i] = static_cast<uint8_t>(is_saved_width(width) ? width : bits_per_uint64);
+        }
+        return widths;
+    }
+
+    streamoff Ciphertext::bitpacked_save_size(const vector<uint8_t> &widths) const
+    {
+        size_t data_size = sizeof(uint64_t); // coefficient count
+        for (auto width : widths)
+        {
+            data_size = add_safe(data_size, sizeof(uint8_t), packed_byte_count(poly_modulus_degree_, width));
+        }
+        if (has_seed_marker())
+        {
+            data_size = add_safe(
+                data_size, static_cast<size_t>(UniformRandomGeneratorInfo::SaveSize(compr_mode_type::none)));
+        }
+
+        return safe_cast<streamoff>(add_safe(
+            sizeof(Serialization::SEALHeader),
+            sizeof(parms_id_type), // parms_id_
+            sizeof(seal_byte), // is_ntt_form_
+            sizeof(uint64_t), // size_
+            sizeof(uint64_t), // poly_modulus_degree_
+            sizeof(uint64_t), // coeff_modulus_size_
+            sizeof(double), // scale_
+            sizeof(uint64_t), // correction_factor_
+            data_size));
+    }
+
+    bool Ciphertext::is_bitpacked(istream &stream)
+    {
+        auto state = stream.rdstate();
+        auto start = stream.tellg();
+        if (start == streampos(-1))
+        {
+            stream.clear(state);
+            return false;
+        }
+        Serialization::SEALHeader header;
+        try
+        {
+            Serialization::LoadHeader(stream, header, false);
+        }
+        catch (...)
+        {
+            // Serialization::Load reports the bad header
+        }
+        stream.clear(state);
+        stream.seekg(start);
+        return header.compr_mode == compr_mode_type::bitpack;
+    }
+
+    bool Ciphertext::is_bitpacked(const seal_byte *in, size_t size)
+    {
+        if (!in || size < sizeof(Serialization::SEALHeader))
+        {
+            return false;
+        }
+        Serialization::SEALHeader header;
+        memcpy(&header, in, sizeof(Serialization::SEALHeader));
+        return header.compr_mode == compr_mode_type::bitpack;
+    }
+
+    void Ciphertext::save_metadata(ostream &stream) const
+    {
+        stream.write(reinterpret_cast<const char *>(&parms_id_), sizeof(parms_id_type));
+        seal_byte is_ntt_form_byte = static_cast<seal_byte>(is_ntt_form_);
+        stream.write(reinterpret_cast<const char *>(&is_ntt_form_byte), sizeof(seal_byte));
+        uint64_t size64 = safe_cast<uint64_t>(size_);
+        stream.write(reinterpret_cast<const char *>(&size64), sizeof(uint64_t));
+        uint64_t poly_modulus_degree64 = safe_cast<uint64_t>(poly_modulus_degree_);
+        stream.write(reinterpret_cast<const char *>(&poly_modulus_degree64), sizeof(uint64_t));
+        uint64_t coeff_modulus_size64 = safe_cast<uint64_t>(coeff_modulus_size_);
+        stream.write(reinterpret_cast<const char *>(&coeff_modulus_size64), sizeof(uint64_t));
+        stream.write(reinterpret_cast<const char *>(&scale_), sizeof(double));
+        stream.write(reinterpret_cast<const char *>(&correction_factor_), sizeof(uint64_t));
+    }
+
+    void Ciphertext::save_members_bitpacked(ostream &stream, const vector<uint8_t> &widths) const
+    {
+        auto old_except_mask = stream.exceptions();
+        try
+        {
+            // Throw exceptions on std::ios_base::badbit and std::ios_base::failbit
+            stream.exceptions(ios_base::badbit | ios_base::failbit);
+
+            save_metadata(stream);
+
+            // Coefficient count, then each RNS component as its width and that many bits per coefficient
+            uint64_t count64 = safe_cast<uint64_t>(mul_safe(widths.size(), poly_modulus_degree_));
+            stream.write(reinterpret_cast<const char *>(&count64), sizeof(uint64_t));
+            auto pool = data_.pool();
+            auto packed = allocate<seal_byte>(
+                add_safe(mul_safe(poly_modulus_degree_, sizeof(uint64_t)), sizeof(uint64_t)), pool);
+            const ct_coeff_type *limb = data_.cbegin();
+            for (auto width : widths)
+            {
+                size_t byte_count = packed_byte_count(poly_modulus_degree_, width);
+                pack_bits(limb, poly_modulus_degree_, width, packed.get());
+                stream.write(reinterpret_cast<const char *>(&width), sizeof(uint8_t));
+                stream.write(reinterpret_cast<const char *>(packed.get()), safe_cast<streamsize>(byte_count));
+                limb += poly_modulus_degree_;
+            }
+
+            if (has_seed_marker())
+            {
+                UniformRandomGeneratorInfo info;
+                size_t info_size = static_cast<size_t>(UniformRandomGeneratorInfo::SaveSize(compr_mode_type::none));
+                info.load(reinterpret_cast<const seal_byte *>(data(1) + 1), info_size);
+                info.save(stream, compr_mode_type::none);
+            }
+        }
+        catch (const ios_base::failure &)
+        {
+            stream.exceptions(old_except_mask);
+            throw runtime_error("I/O error");
+        }
+        catch (...)
+        {
+            stream.exceptions(old_except_mask);
+            throw;
+        }
+        stream.exceptions(old_except_mask);
+    }
+
     void Ciphertext::save_members(ostream &stream) const
     {
         auto old_except_mask = stream.exceptions();
@@ -195,17 +405,7 @@ namespace seal
             // Throw exceptions on std::ios_base::badbit and std::ios_base::failbit
             stream.exceptions(ios_base::badbit | ios_base::failbit);
 
-            stream.write(reinterpret_cast<const char *>(&parms_id_), sizeof(parms_id_type));
-            seal_byte is_ntt_form_byte = static_cast<seal_byte>(is_ntt_form_);
-            stream.write(reinterpret_cast<const char *>(&is_ntt_form_byte), sizeof(seal_byte));
-            uint64_t size64 = safe_cast<uint64_t>(size_);
-            stream.write(reinterpret_cast<const char *>(&size64), sizeof(uint64_t));
-            uint64_t poly_modulus_degree64 = safe_cast<uint64_t>(poly_modulus_degree_);
-            stream.write(reinterpret_cast<const char *>(&poly_modulus_degree64), sizeof(uint64_t));
-            uint64_t coeff_modulus_size64 = safe_cast<uint64_t>(coeff_modulus_size_);
-            stream.write(reinterpret_cast<const char *>(&coeff_modulus_size64), sizeof(uint64_t));
-            stream.write(reinterpret_cast<const char *>(&scale_), sizeof(double));
-            stream.write(reinterpret_cast<const char *>(&correction_factor_), sizeof(uint64_t));
+            save_metadata(stream);
 
             if (has_seed_marker())
             {
@@ -246,7 +446,9 @@ namespace seal
         stream.exceptions(old_except_mask);
     }
 
-    void Ciphertext::load_members(const SEALContext &context, istream &stream, SEAL_MAYBE_UNUSED SEALVersion version)
+    void Ciphertext::load_members(
+        const SEALContext &context, istream &stream, SEAL_MAYBE_UNUSED SEALVersion version, bool bitpacked,
+        bool in_place)
     {
         // Verify parameters
         if (!context.parameters_set())
@@ -255,6 +457,22 @@ namespace seal
         }
 
         Ciphertext new_data(data_.pool());
+        bool taken_over = false;
+        if (in_place && !is_view())
+        {
+            // Load into this ciphertext's allocation; it is handed back empty should loading fail
+            swap(new_data.data_, data_);
+            new_data.data_.clear();
+            clear();
+            taken_over = true;
+        }
+        auto hand_back = [&]() {
+            if (taken_over)
+            {
+                new_data.data_.clear();
+                swap(new_data.data_, data_);
+            }
+        };
 
         auto old_except_mask = stream.exceptions();
         try
@@ -307,18 +525,53 @@ namespace seal
             auto total_uint64_count =
                 mul_safe(new_data.size_, new_data.poly_modulus_degree_, new_data.coeff_modulus_size_);
 
-            // Reserve memory for the entire (expected) ciphertext data
-            new_data.data_.reserve(total_uint64_count);
-
-            // Load the data. Note that we are supplying also the expected maximum
-            // size of the loaded DynArray. This is an important security measure to
-            // prevent a malformed DynArray from causing arbitrarily large memory
-            // allocations.
-            new_data.data_.load(stream, total_uint64_count);
+            // Reserve memory for the entire (expected) ciphertext data, unless an allocation taken over holds it
+            if (new_data.data_.capacity() < total_uint64_count)
+            {
+                new_data.data_.reserve(total_uint64_count);
+            }
 
             // Expected buffer size in the seeded case
             auto seeded_uint64_count = poly_modulus_degree64 * coeff_modulus_size64;
 
+            if (bitpacked)
+            {
+                // As with the DynArray below, the count must be one the metadata allows before anything is
+                // allocated for it
+                uint64_t count64 = 0;
+                stream.read(reinterpret_cast<char *>(&count64), sizeof(uint64_t));
+                if (!unsigned_eq(count64, total_uint64_count) && count64 != seeded_uint64_count)
+                {
+                    throw logic_error("ciphertext data is invalid");
+                }
+                new_data.data_.resize(safe_cast<size_t>(count64));
+
+                auto pool = data_.pool();
+                auto packed = allocate<seal_byte>(
+                    add_safe(mul_safe(new_data.poly_modulus_degree_, sizeof(uint64_t)), sizeof(uint64_t)), pool);
+                ct_coeff_type *limb = new_data.data_.begin();
+                for (size_t i = 0; i < new_data.data_.size(); i += new_data.poly_modulus_degree_)
+                {
+                    uint8_t width = 0;
+                    stream.read(reinterpret_cast<char *>(&width), sizeof(uint8_t));
+                    if (!is_saved_width(width))
+                    {
+                        throw logic_error("ciphertext data is invalid");
+                    }
+                    size_t byte_count = packed_byte_count(new_data.poly_modulus_degree_, width);
+                    stream.read(reinterpret_cast<char *>(packed.get()), safe_cast<streamsize>(byte_count));
+                    unpack_bits(packed.get(), new_data.poly_modulus_degree_, width, limb + i);
+                }
+            }
+            else
+            {
+                // Load the data. Note that we are supplying also the expected maximum
+                // size of the loaded DynArray. This is an important security measure to
+                // prevent a malformed DynArray from causing arbitrarily large memory
+                // allocations.
+                new_data.data_.load(stream, total_uint64_count);
+            }
+
             // This is the case where we need to expand a seed, otherwise full
             // ciphertext data was already (possibly) loaded and we are done
             if (unsigned_eq(new_data.data_.size(), seeded_uint64_count))
@@ -361,11 +614,13 @@ namespace seal
         catch (const ios_base::failure &)
         {
             stream.exceptions(old_except_mask);
+            hand_back();
             throw runtime_error("I/O error");
         }
         catch (...)
         {
             stream.exceptions(old_except_mask);
+            hand_back();
             throw;
         }
         stream.exceptions(old_except_mask);
@@ -379,4 +634,111 @@ namespace seal
             this->is_ntt_form() = true;
         }
     }
+
+    streamoff Ciphertext::unsafe_load_view(const SEALContext &context, const seal_byte *in, size_t size)
+    {
+        // Verify parameters
+        if (!context.parameters_set())
+        {
+            throw invalid_argument("encryption parameters are not set correctly");
+        }
+
+        Serialization::SEALHeader header;
+        Serialization::LoadHeader(in, size, header, false);
+        if (!Serialization::IsValidHeader(header))
+        {
+            throw logic_error("loaded SEALHeader is invalid");
+        }
+        if (header.version_major != SEAL_VERSION_MAJOR)
+        {
+            throw logic_error("incompatible version");
+        }
+        if (header.compr_mode != compr_mode_type::none)
+        {
+            throw invalid_argument("only uncompressed ciphertexts can be viewed");
+        }
+        if (header.size > size)
+        {
+            throw invalid_argument("insufficient size");
+        }
+
+        // The members in the order save_members writes them
+        size_t offset = sizeof(Serialization::SEALHeader);
+        auto read = [&](void *out, size_t bytes) {
+            if (header.size - offset < bytes)
+            {
+                throw logic_error("ciphertext data is invalid");
+            }
+            memcpy(out, in + offset, bytes);
+            offset += bytes;
+        };
+
+        Ciphertext new_data(data_.pool());
+        seal_byte is_ntt_form_byte;
+        uint64_t size64 = 0;
+        uint64_t poly_modulus_degree64 = 0;
+        uint64_t coeff_modulus_size64 = 0;
+        read(&new_data.parms_id_, sizeof(parms_id_type));
+        read(&is_ntt_form_byte, sizeof(seal_byte));
+        read(&size64, sizeof(uint64_t));
+        read(&poly_modulus_degree64, sizeof(uint64_t));
+        read(&coeff_modulus_size64, sizeof(uint64_t));
+        read(&new_data.scale_, sizeof(double));
+        read(&new_data.correction_factor_, sizeof(uint64_t));
+        new_data.is_ntt_form_ = (is_ntt_form_byte == seal_byte{}) ? false : true;
+        new_data.size_ = safe_cast<size_t>(size64);
+        new_data.poly_modulus_degree_ = safe_cast<size_t>(poly_modulus_degree64);
+        new_data.coeff_modulus_size_ = safe_cast<size_t>(coeff_modulus_size64);
+        if (!is_metadata_valid_for(new_data, context, true))
+        {
+            throw logic_error("ciphertext data is invalid");
+        }
+
+        // BGV ciphertexts cannot be converted to NTT form in place, as load_members does
+        if (context.key_context_data()->parms().scheme() == scheme_type::bgv && !new_data.is_ntt_form_)
+        {
+            throw invalid_argument("BGV ciphertexts must be saved in NTT form to be viewed");
+        }
+
+        // The DynArray is saved with a SEALHeader of its own
+        Serialization::SEALHeader data_header;
+        Serialization::LoadHeader(in + offset, header.size - offset, data_header, false);
+        if (!Serialization::IsValidHeader(data_header) || data_header.compr_mode != compr_mode_type::none ||
+            data_header.size != header.size - offset)
+        {
+            throw logic_error("ciphertext data is invalid");
+        }
+        offset += sizeof(Serialization::SEALHeader);
+
+        // A seeded ciphertext holds one polynomial and would need expanding
+        auto total_uint64_count = mul_safe(new_data.size_, new_data.poly_modulus_degree_, new_data.coeff_modulus_size_);
+        uint64_t count64 = 0;
+        read(&count64, sizeof(uint64_t));
+        if (count64 != total_uint64_count)
+        {
+            throw invalid_argument("only ciphertexts saved unseeded can be viewed");
+        }
+        if (header.size - offset != mul_safe(total_uint64_count, sizeof(ct_coeff_type)))
+        {
+            throw logic_error("ciphertext data is invalid");
+        }
+        const seal_byte *coeffs = in + offset;
+        if (reinterpret_cast<uintptr_t>(coeffs) % alignof(ct_coeff_type))
+        {
+            throw invalid_argument("ciphertext data is not aligned");
+        }
+
+        // The DynArray aliases the memory; the Pointer never frees it
+        auto alias = Pointer<ct_coeff_type>::Aliasing(reinterpret_cast<ct_coeff_type *>(const_cast<seal_byte *>(coeffs)));
+        swap(new_data.data_.data_, alias);
+        new_data.data_.size_ = total_uint64_count;
+        new_data.data_.capacity_ = total_uint64_count;
+        if (!is_buffer_valid(new_data))
+        {
+            throw logic_error("ciphertext data is invalid");
+        }
+
+        swap(*this, new_data);
+        return safe_cast<streamoff>(header.size);
+    }
 } // namespace seal
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace seal
 {
@@ -285,6 +286,28 @@ namespace seal
             data_.release();
         }
 
+        /**
+        Resets the ciphertext to an empty state, as release does, but keeps its
+        allocation for the next resize or load_in_place. A view (see load_view)
+        stops viewing its memory.
+        */
+        inline void clear() noexcept
+        {
+            if (is_view())
+            {
+                release();
+                return;
+            }
+            parms_id_ = parms_id_zero;
+            is_ntt_form_ = false;
+            size_ = 0;
+            poly_modulus_degree_ = 0;
+            coeff_modulus_size_ = 0;
+            scale_ = 1.0;
+            correction_factor_ = 1;
+            data_.clear();
+        }
+
         /**
         Copies a given ciphertext to the current one.
 
@@ -457,7 +480,8 @@ namespace seal
 
         /**
         Returns an upper bound on the size of the ciphertext, as if it was written
-        to an output stream.
+        to an output stream. For compr_mode_type::none and compr_mode_type::bitpack
+        the size is exact; the latter reads every coefficient to find the widths.
 
         @param[in] compr_mode The compression mode
         @throws std::invalid_argument if the compression mode is not supported
@@ -480,6 +504,13 @@ namespace seal
             std::ostream &stream, compr_mode_type compr_mode = Serialization::compr_mode_default) const
         {
             using namespace std::placeholders;
+            if (compr_mode == compr_mode_type::bitpack)
+            {
+                auto widths = bitpack_widths();
+                return Serialization::Save(
+                    std::bind(&Ciphertext::save_members_bitpacked, this, _1, std::cref(widths)),
+                    bitpacked_save_size(widths), stream, compr_mode, false);
+            }
             return Serialization::Save(
                 std::bind(&Ciphertext::save_members, this, _1), save_size(compr_mode_type::none), stream, compr_mode,
                 false);
@@ -501,7 +532,9 @@ namespace seal
         inline std::streamoff unsafe_load(const SEALContext &context, std::istream &stream)
         {
             using namespace std::placeholders;
-            return Serialization::Load(std::bind(&Ciphertext::load_members, this, context, _1, _2), stream, false);
+            return Serialization::Load(
+                std::bind(&Ciphertext::load_members, this, context, _1, _2, is_bitpacked(stream), false), stream,
+                false);
         }
 
         /**
@@ -544,6 +577,13 @@ namespace seal
             seal_byte *out, std::size_t size, compr_mode_type compr_mode = Serialization::compr_mode_default) const
         {
             using namespace std::placeholders;
+            if (compr_mode == compr_mode_type::bitpack)
+            {
+                auto widths = bitpack_widths();
+                return Serialization::Save(
+                    std::bind(&Ciphertext::save_members_bitpacked, this, _1, std::cref(widths)),
+                    bitpacked_save_size(widths), out, size, compr_mode, false);
+            }
             return Serialization::Save(
                 std::bind(&Ciphertext::save_members, this, _1), save_size(compr_mode_type::none), out, size, compr_mode,
                 false);
@@ -568,7 +608,9 @@ namespace seal
         inline std::streamoff unsafe_load(const SEALContext &context, const seal_byte *in, std::size_t size)
         {
             using namespace std::placeholders;
-            return Serialization::Load(std::bind(&Ciphertext::load_members, this, context, _1, _2), in, size, false);
+            return Serialization::Load(
+                std::bind(&Ciphertext::load_members, this, context, _1, _2, is_bitpacked(in, size), false), in, size,
+                false);
         }
 
         /**
@@ -598,6 +640,134 @@ namespace seal
             return in_size;
         }
 
+        /**
+        Loads a ciphertext from a given memory location overwriting the current
+        ciphertext, as unsafe_load does, but into the current ciphertext's own
+        allocation when it is large enough, so that a ciphertext loaded again and
+        again (e.g. one recycled across requests) allocates nothing. Unlike with
+        unsafe_load, the current ciphertext is lost if loading fails: it is left
+        empty, keeping its allocation. A view (see load_view) is never written;
+        loading into one allocates as unsafe_load does.
+
+        @param[in] context The SEALContext
+        @param[in] in The memory location to load the ciphertext from
+        @param[in] size The number of bytes available in the given memory location
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::invalid_argument if in is null or if size is too small to
+        contain a SEALHeader
+        @throws std::logic_error if the data cannot be loaded by this version of
+        Microsoft SEAL, if the loaded data is invalid, or if decompression failed
+        @throws std::runtime_error if I/O operations failed
+        */
+        inline std::streamoff unsafe_load_in_place(const SEALContext &context, const seal_byte *in, std::size_t size)
+        {
+            using namespace std::placeholders;
+            return Serialization::Load(
+                std::bind(&Ciphertext::load_members, this, context, _1, _2, is_bitpacked(in, size), true), in, size,
+                false);
+        }
+
+        /**
+        Loads a ciphertext from a given memory location into the current
+        ciphertext's allocation, as unsafe_load_in_place does. The loaded
+        ciphertext is verified to be valid for the given SEALContext; if it is
+        not, the current ciphertext is left empty, keeping its allocation.
+
+        @param[in] context The SEALContext
+        @param[in] in The memory location to load the ciphertext from
+        @param[in] size The number of bytes available in the given memory location
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::invalid_argument if in is null or if size is too small to
+        contain a SEALHeader
+        @throws std::logic_error if the data cannot be loaded by this version of
+        Microsoft SEAL, if the loaded data is invalid, or if decompression failed
+        @throws std::runtime_error if I/O operations failed
+        */
+        inline std::streamoff load_in_place(const SEALContext &context, const seal_byte *in, std::size_t size)
+        {
+            auto in_size = unsafe_load_in_place(context, in, size);
+            if (!is_valid_for(*this, context))
+            {
+                clear();
+                throw std::logic_error("ciphertext data is invalid");
+            }
+            return in_size;
+        }
+
+        /**
+        Makes this ciphertext a view of a ciphertext saved uncompressed at a given
+        memory location, e.g. in a memory-mapped file. No memory is allocated and
+        no coefficient data is copied: the ciphertext aliases the data where it
+        is. The memory must stay valid, and is never written, for as long as the
+        view lives. A view may be used wherever a const ciphertext is expected and
+        copied, which makes an ordinary owning ciphertext; it must not be used as
+        the destination of any operation, since the memory may be read-only. No
+        checking of the validity of the coefficient data is performed. This
+        function should not be used unless the ciphertext comes from a fully
+        trusted source.
+
+        @param[in] context The SEALContext
+        @param[in] in The memory location of the saved ciphertext
+        @param[in] size The number of bytes available in the given memory location
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::invalid_argument if in is null or if size is too small to
+        contain the ciphertext
+        @throws std::invalid_argument if the ciphertext was saved compressed or
+        seeded, or if its coefficient data is not aligned for ct_coeff_type
+        @throws std::logic_error if the data cannot be loaded by this version of
+        Microsoft SEAL or if the loaded metadata is invalid
+        */
+        std::streamoff unsafe_load_view(const SEALContext &context, const seal_byte *in, std::size_t size);
+
+        /**
+        Makes this ciphertext a view of a ciphertext saved uncompressed at a given
+        memory location, as unsafe_load_view does. The viewed ciphertext is
+        verified to be valid for the given SEALContext, which reads all of its
+        coefficient data once.
+
+        @param[in] context The SEALContext
+        @param[in] in The memory location of the saved ciphertext
+        @param[in] size The number of bytes available in the given memory location
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::invalid_argument if in is null or if size is too small to
+        contain the ciphertext
+        @throws std::invalid_argument if the ciphertext was saved compressed or
+        seeded, or if its coefficient data is not aligned for ct_coeff_type
+        @throws std::logic_error if the data cannot be loaded by this version of
+        Microsoft SEAL or if the loaded data is invalid
+        */
+        inline std::streamoff load_view(const SEALContext &context, const seal_byte *in, std::size_t size)
+        {
+            Ciphertext new_data(pool());
+            auto in_size = new_data.unsafe_load_view(context, in, size);
+            if (!is_valid_for(new_data, context))
+            {
+                throw std::logic_error("ciphertext data is invalid");
+            }
+            std::swap(*this, new_data);
+            return in_size;
+        }
+
+        /**
+        Returns whether the ciphertext is a view of memory it does not own (see
+        load_view).
+        */
+        SEAL_NODISCARD inline bool is_view() const noexcept
+        {
+            return data_.data_.is_alias();
+        }
+
+        /**
+        Returns the offset of the coefficient data in the uncompressed save of
+        this ciphertext. Writers that want the saved ciphertext to be viewable
+        with load_view place it so that this offset is suitably aligned.
+        */
+        SEAL_NODISCARD inline std::size_t view_data_offset() const
+        {
+            return static_cast<std::size_t>(save_size(compr_mode_type::none)) -
+                   data_.size() * sizeof(ct_coeff_type);
+        }
+
         /**
         Returns whether the ciphertext is in NTT form.
         */
@@ -689,9 +859,24 @@ namespace seal
 
         void expand_seed(const SEALContext &context, const UniformRandomGeneratorInfo &prng_info, SEALVersion version);
 
+        void save_metadata(std::ostream &stream) const;
+
         void save_members(std::ostream &stream) const;
 
-        void load_members(const SEALContext &context, std::istream &stream, SEALVersion version);
+        // Significant bits of each saved RNS component (the first polynomial only, when seeded)
+        std::vector<std::uint8_t> bitpack_widths() const;
+
+        std::streamoff bitpacked_save_size(const std::vector<std::uint8_t> &widths) const;
+
+        void save_members_bitpacked(std::ostream &stream, const std::vector<std::uint8_t> &widths) const;
+
+        void load_members(
+            const SEALContext &context, std::istream &stream, SEALVersion version, bool bitpacked, bool in_place);
+
+        // Whether the SEALHeader at the current position says compr_mode_type::bitpack; the stream is left unmoved
+        static bool is_bitpacked(std::istream &stream);
+
+        static bool is_bitpacked(const seal_byte *in, std::size_t size);
 
         inline bool has_seed_marker() const noexcept
         {
@@ -0,0 +1,158 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/ciphertextbatch.h"
+#include "seal/valcheck.h"
+#include "seal/util/common.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+using namespace seal::util;
+
+namespace seal
+{
+    void CiphertextBatch::resize(const SEALContext &context, parms_id_type parms_id, size_t count, size_t size)
+    {
+        // Verify parameters
+        if (!context.parameters_set())
+        {
+            throw invalid_argument("encryption parameters are not set correctly");
+        }
+        auto context_data_ptr = context.get_context_data(parms_id);
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("parms_id is not valid for encryption parameters");
+        }
+        if (size < SEAL_CIPHERTEXT_SIZE_MIN || size > SEAL_CIPHERTEXT_SIZE_MAX)
+        {
+            throw invalid_argument("invalid size");
+        }
+
+        auto &parms = context_data_ptr->parms();
+        size_t poly_modulus_degree = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = parms.coeff_modulus().size();
+        size_t total = mul_safe(count, size, poly_modulus_degree, coeff_modulus_size);
+
+        // Every coefficient becomes zero, not only those past the old size
+        data_.resize(0, false);
+        data_.resize(total, true);
+
+        parms_id_ = parms_id;
+        is_ntt_form_ = false;
+        count_ = count;
+        size_ = size;
+        poly_modulus_degree_ = poly_modulus_degree;
+        coeff_modulus_size_ = coeff_modulus_size;
+        scale_ = 1.0;
+        correction_factor_ = 1;
+    }
+
+    void CiphertextBatch::assign(const SEALContext &context, const Ciphertext *const *encrypteds, size_t count)
+    {
+        if (!encrypteds || count == 0)
+        {
+            throw invalid_argument("encrypteds cannot be empty");
+        }
+        const Ciphertext &first = *encrypteds[0];
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!is_metadata_valid_for(*encrypteds[i], context) || !is_buffer_valid(*encrypteds[i]))
+            {
+                throw invalid_argument("encrypteds is not valid for encryption parameters");
+            }
+        }
+
+        resize(context, first.parms_id(), count, first.size());
+        is_ntt_form_ = first.is_ntt_form();
+        scale_ = first.scale();
+        correction_factor_ = first.correction_factor();
+        for (size_t i = 0; i < count; i++)
+        {
+            set(i, *encrypteds[i]);
+        }
+    }
+
+    void CiphertextBatch::assign(const SEALContext &context, const vector<Ciphertext> &encrypteds)
+    {
+        vector<const Ciphertext *> pointers(encrypteds.size());
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            pointers[i] = &encrypteds[i];
+        }
+        assign(context, pointers.data(), pointers.size());
+    }
+
+    void CiphertextBatch::set(size_t index, const Ciphertext &encrypted)
+    {
+        if (index >= count_)
+        {
+            throw out_of_range("index must be within [0, count)");
+        }
+        if (!matches(encrypted))
+        {
+            throw invalid_argument("encrypted does not match the batch");
+        }
+
+        // A ciphertext is stored polynomial by polynomial, each with all of its RNS components
+        for (size_t poly = 0; poly < size_; poly++)
+        {
+            for (size_t limb = 0; limb < coeff_modulus_size_; limb++)
+            {
+                const ct_coeff_type *source = encrypted.data(poly) + limb * poly_modulus_degree_;
+                copy_n(source, poly_modulus_degree_, data(limb, index, poly));
+            }
+        }
+    }
+
+    void CiphertextBatch::get(const SEALContext &context, size_t index, Ciphertext &destination) const
+    {
+        if (index >= count_)
+        {
+            throw out_of_range("index must be within [0, count)");
+        }
+        destination.resize(context, parms_id_, size_);
+        if (destination.poly_modulus_degree() != poly_modulus_degree_ ||
+            destination.coeff_modulus_size() != coeff_modulus_size_)
+        {
+            throw invalid_argument("batch is not valid for encryption parameters");
+        }
+        destination.is_ntt_form() = is_ntt_form_;
+        destination.scale() = scale_;
+        destination.correction_factor() = correction_factor_;
+        for (size_t poly = 0; poly < size_; poly++)
+        {
+            for (size_t limb = 0; limb < coeff_modulus_size_; limb++)
+            {
+                copy_n(
+                    data(limb, index, poly), poly_modulus_degree_,
+                    destination.data(poly) + limb * poly_modulus_degree_);
+            }
+        }
+    }
+
+    streamoff CiphertextBatch::save(
+        const SEALContext &context, size_t index, ostream &stream, compr_mode_type compr_mode) const
+    {
+        Ciphertext encrypted(pool());
+        get(context, index, encrypted);
+        return encrypted.save(stream, compr_mode);
+    }
+
+    streamoff CiphertextBatch::save(
+        const SEALContext &context, size_t index, seal_byte *out, size_t size, compr_mode_type compr_mode) const
+    {
+        Ciphertext encrypted(pool());
+        get(context, index, encrypted);
+        return encrypted.save(out, size, compr_mode);
+    }
+
+    bool CiphertextBatch::matches(const Ciphertext &encrypted) const noexcept
+    {
+        return encrypted.parms_id() == parms_id_ && encrypted.size() == size_ &&
+               encrypted.poly_modulus_degree() == poly_modulus_degree_ &&
+               encrypted.coeff_modulus_size() == coeff_modulus_size_ && encrypted.is_ntt_form() == is_ntt_form_ &&
+               are_close<double>(encrypted.scale(), scale_) && encrypted.correction_factor() == correction_factor_ &&
+               encrypted.dyn_array().size() == size_ * poly_modulus_degree_ * coeff_modulus_size_;
+    }
+} // namespace seal
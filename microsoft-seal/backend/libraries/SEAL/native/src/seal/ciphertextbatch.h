@@ -0,0 +1,323 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/ciphertext.h"
+#include "seal/context.h"
+#include "seal/dynarray.h"
+#include "seal/memorymanager.h"
+#include "seal/serialization.h"
+#include "seal/util/defines.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace seal
+{
+    /**
+    Holds many ciphertexts of the same shape (parms_id, size, NTT form, scale and correction factor) in one
+    contiguous buffer, laid out limb-major: RNS component j of polynomial 0 of every ciphertext, then of
+    polynomial 1 of every ciphertext, and so on, before component j + 1. An operation over the whole batch
+    (Evaluator::add_inplace, multiply_plain_inplace, transform_to_ntt_inplace, add_many) then walks memory in
+    order, or at a constant stride, with one modulus and one set of NTT tables per component, instead of visiting
+    a separately allocated ciphertext per operand.
+
+    Ciphertexts are copied in with assign or set and out with get or save; a batch cannot be used where a
+    Ciphertext is expected.
+
+    @par Thread Safety
+    In general, reading from CiphertextBatch is thread-safe as long as no other thread is concurrently mutating it.
+    */
+    class CiphertextBatch
+    {
+    public:
+        using ct_coeff_type = Ciphertext::ct_coeff_type;
+
+        /**
+        Constructs an empty batch allocating no memory.
+
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        CiphertextBatch(MemoryPoolHandle pool = MemoryManager::GetPool()) : data_(std::move(pool))
+        {}
+
+        /**
+        Constructs a batch of count ciphertexts of the given size at the given level, with every coefficient zero.
+
+        @param[in] context The SEALContext
+        @param[in] parms_id The parms_id of the ciphertexts
+        @param[in] count The number of ciphertexts
+        @param[in] size The number of polynomials per ciphertext
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters
+        @throws std::invalid_argument if size is less than 2 or too large
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        CiphertextBatch(
+            const SEALContext &context, parms_id_type parms_id, std::size_t count, std::size_t size = 2,
+            MemoryPoolHandle pool = MemoryManager::GetPool())
+            : data_(std::move(pool))
+        {
+            resize(context, parms_id, count, size);
+        }
+
+        /**
+        Reshapes the batch to count ciphertexts of the given size at the given level, with every coefficient zero.
+        The NTT form, scale and correction factor are reset.
+
+        @param[in] context The SEALContext
+        @param[in] parms_id The parms_id of the ciphertexts
+        @param[in] count The number of ciphertexts
+        @param[in] size The number of polynomials per ciphertext
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters
+        @throws std::invalid_argument if size is less than 2 or too large
+        */
+        void resize(const SEALContext &context, parms_id_type parms_id, std::size_t count, std::size_t size = 2);
+
+        /**
+        Copies count ciphertexts into the batch, which takes their shape.
+
+        @param[in] context The SEALContext
+        @param[in] encrypteds Pointers to the ciphertexts
+        @param[in] count The number of ciphertexts
+        @throws std::invalid_argument if encrypteds is null or count is zero
+        @throws std::invalid_argument if encrypteds are not valid for the encryption parameters
+        @throws std::invalid_argument if encrypteds differ in parms_id, size, NTT form, scale or correction factor
+        */
+        void assign(const SEALContext &context, const Ciphertext *const *encrypteds, std::size_t count);
+
+        /**
+        Copies a vector of ciphertexts into the batch, which takes their shape.
+
+        @param[in] context The SEALContext
+        @param[in] encrypteds The ciphertexts
+        @throws std::invalid_argument if encrypteds is empty
+        @throws std::invalid_argument if encrypteds are not valid for the encryption parameters
+        @throws std::invalid_argument if encrypteds differ in parms_id, size, NTT form, scale or correction factor
+        */
+        void assign(const SEALContext &context, const std::vector<Ciphertext> &encrypteds);
+
+        /**
+        Overwrites ciphertext index of the batch.
+
+        @param[in] index The position in the batch
+        @param[in] encrypted The ciphertext to copy in
+        @throws std::out_of_range if index is not less than count()
+        @throws std::invalid_argument if encrypted does not have the batch's shape
+        */
+        void set(std::size_t index, const Ciphertext &encrypted);
+
+        /**
+        Copies ciphertext index of the batch out.
+
+        @param[in] context The SEALContext
+        @param[in] index The position in the batch
+        @param[out] destination The ciphertext to overwrite
+        @throws std::out_of_range if index is not less than count()
+        @throws std::invalid_argument if the batch is not valid for the encryption parameters
+        */
+        void get(const SEALContext &context, std::size_t index, Ciphertext &destination) const;
+
+        /**
+        Saves ciphertext index of the batch to an output stream in the format of Ciphertext::save. The ciphertext
+        is gathered into a temporary allocated from the batch's pool.
+
+        @param[in] context The SEALContext
+        @param[in] index The position in the batch
+        @param[out] stream The stream to save the ciphertext to
+        @param[in] compr_mode The desired compression mode
+        @throws std::out_of_range if index is not less than count()
+        @throws std::invalid_argument if the batch is not valid for the encryption parameters
+        @throws std::logic_error if the data to be saved is invalid, or if compression failed
+        @throws std::runtime_error if I/O operations failed
+        */
+        std::streamoff save(
+            const SEALContext &context, std::size_t index, std::ostream &stream,
+            compr_mode_type compr_mode = Serialization::compr_mode_default) const;
+
+        /**
+        Saves ciphertext index of the batch to a given memory location in the format of Ciphertext::save, as the
+        stream overload does.
+
+        @param[in] context The SEALContext
+        @param[in] index The position in the batch
+        @param[out] out The memory location to write the ciphertext to
+        @param[in] size The number of bytes available in the given memory location
+        @param[in] compr_mode The desired compression mode
+        @throws std::out_of_range if index is not less than count()
+        @throws std::invalid_argument if the batch is not valid for the encryption parameters
+        @throws std::invalid_argument if out is null or if size is too small
+        @throws std::logic_error if the data to be saved is invalid, or if compression failed
+        */
+        std::streamoff save(
+            const SEALContext &context, std::size_t index, seal_byte *out, std::size_t size,
+            compr_mode_type compr_mode = Serialization::compr_mode_default) const;
+
+        /**
+        Returns the coefficients of RNS component limb of every polynomial of every ciphertext: size() * count()
+        polynomials of poly_modulus_degree() coefficients each, polynomial 0 of every ciphertext first.
+
+        @param[in] limb The RNS component
+        */
+        SEAL_NODISCARD inline ct_coeff_type *data(std::size_t limb)
+        {
+            return data_.begin() + limb * count_ * size_ * poly_modulus_degree_;
+        }
+
+        /**
+        Returns the coefficients of RNS component limb of every polynomial of every ciphertext.
+
+        @param[in] limb The RNS component
+        */
+        SEAL_NODISCARD inline const ct_coeff_type *data(std::size_t limb) const
+        {
+            return data_.cbegin() + limb * count_ * size_ * poly_modulus_degree_;
+        }
+
+        /**
+        Returns RNS component limb of polynomial poly of ciphertext index.
+        */
+        SEAL_NODISCARD inline ct_coeff_type *data(std::size_t limb, std::size_t index, std::size_t poly)
+        {
+            return data(limb) + (poly * count_ + index) * poly_modulus_degree_;
+        }
+
+        /**
+        Returns RNS component limb of polynomial poly of ciphertext index.
+        */
+        SEAL_NODISCARD inline const ct_coeff_type *data(std::size_t limb, std::size_t index, std::size_t poly) const
+        {
+            return data(limb) + (poly * count_ + index) * poly_modulus_degree_;
+        }
+
+        /**
+        Returns the number of ciphertexts in the batch.
+        */
+        SEAL_NODISCARD inline std::size_t count() const noexcept
+        {
+            return count_;
+        }
+
+        /**
+        Returns whether the batch holds no ciphertexts.
+        */
+        SEAL_NODISCARD inline bool empty() const noexcept
+        {
+            return count_ == 0;
+        }
+
+        /**
+        Returns the number of polynomials in each ciphertext.
+        */
+        SEAL_NODISCARD inline std::size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        /**
+        Returns the degree of the polynomial modulus.
+        */
+        SEAL_NODISCARD inline std::size_t poly_modulus_degree() const noexcept
+        {
+            return poly_modulus_degree_;
+        }
+
+        /**
+        Returns the number of primes in the coefficient modulus.
+        */
+        SEAL_NODISCARD inline std::size_t coeff_modulus_size() const noexcept
+        {
+            return coeff_modulus_size_;
+        }
+
+        /**
+        Returns a const reference to the parms_id of the ciphertexts.
+        */
+        SEAL_NODISCARD inline const parms_id_type &parms_id() const noexcept
+        {
+            return parms_id_;
+        }
+
+        /**
+        Returns whether the ciphertexts are in NTT form.
+        */
+        SEAL_NODISCARD inline bool is_ntt_form() const noexcept
+        {
+            return is_ntt_form_;
+        }
+
+        /**
+        Returns a reference to whether the ciphertexts are in NTT form.
+        */
+        SEAL_NODISCARD inline bool &is_ntt_form() noexcept
+        {
+            return is_ntt_form_;
+        }
+
+        /**
+        Returns the scale of the ciphertexts (CKKS).
+        */
+        SEAL_NODISCARD inline double scale() const noexcept
+        {
+            return scale_;
+        }
+
+        /**
+        Returns a reference to the scale of the ciphertexts (CKKS).
+        */
+        SEAL_NODISCARD inline double &scale() noexcept
+        {
+            return scale_;
+        }
+
+        /**
+        Returns the correction factor of the ciphertexts (BGV).
+        */
+        SEAL_NODISCARD inline std::uint64_t correction_factor() const noexcept
+        {
+            return correction_factor_;
+        }
+
+        /**
+        Returns a reference to the correction factor of the ciphertexts (BGV).
+        */
+        SEAL_NODISCARD inline std::uint64_t &correction_factor() noexcept
+        {
+            return correction_factor_;
+        }
+
+        /**
+        Returns the memory pool the batch allocates from.
+        */
+        SEAL_NODISCARD inline MemoryPoolHandle pool() const noexcept
+        {
+            return data_.pool();
+        }
+
+    private:
+        // Whether encrypted has the shape of the batch's ciphertexts
+        SEAL_NODISCARD bool matches(const Ciphertext &encrypted) const noexcept;
+
+        parms_id_type parms_id_ = parms_id_zero;
+
+        bool is_ntt_form_ = false;
+
+        std::size_t count_ = 0;
+
+        std::size_t size_ = 0;
+
+        std::size_t poly_modulus_degree_ = 0;
+
+        std::size_t coeff_modulus_size_ = 0;
+
+        double scale_ = 1.0;
+
+        std::uint64_t correction_factor_ = 1;
+
+        DynArray<ct_coeff_type> data_;
+    };
+} // namespace seal
@@ -2,6 +2,9 @@
 // Licensed under the MIT license.
 
 #include "seal/ckks.h"
+#include "seal/util/cpufeatures.h"
+#include "seal/util/fftavx2.h"
+#include "seal/util/fftavx512.h"
 #include <random>
 #include <stdexcept>
 
@@ -107,7 +110,8 @@ namespace seal
         // Compute the scaled value
         value *= scale;
 
-        int coeff_bit_count = static_cast<int>(log2(fabs(value))) + 2;
+        // Don't compute logarithms of numbers less than 1
+        int coeff_bit_count = static_cast<int>(log2(max<>(fabs(value), 1.0))) + 2;
         if (coeff_bit_count >= context_data.total_coeff_modulus_bit_count())
         {
             throw invalid_argument("encoded value is too large");
@@ -213,6 +217,44 @@ namespace seal
         destination.scale() = scale;
     }
 
+    void CKKSEncoder::fft_transform_to_rev(complex<double> *values, int log_n, const double *scalar) const
+    {
+#ifdef SEAL_USE_AVX512
+        if (use_avx512() && log_n >= 3)
+        {
+            avx512::fft_transform_to_rev(values, log_n, root_powers_.get(), scalar);
+            return;
+        }
+#endif
+#ifdef SEAL_USE_AVX2
+        if (use_avx2() && log_n >= 3)
+        {
+            avx2::fft_transform_to_rev(values, log_n, root_powers_.get(), scalar);
+            return;
+        }
+#endif
+        fft_handler_.transform_to_rev(values, log_n, root_powers_.get(), scalar);
+    }
+
+    void CKKSEncoder::fft_transform_from_rev(complex<double> *values, int log_n, const double *scalar) const
+    {
+#ifdef SEAL_USE_AVX512
+        if (use_avx512() && log_n >= 3)
+        {
+            avx512::fft_transform_from_rev(values, log_n, inv_root_powers_.get(), scalar);
+            return;
+        }
+#endif
+#ifdef SEAL_USE_AVX2
+        if (use_avx2() && log_n >= 3)
+        {
+            avx2::fft_transform_from_rev(values, log_n, inv_root_powers_.get(), scalar);
+            return;
+        }
+#endif
+        fft_handler_.transform_from_rev(values, log_n, inv_root_powers_.get(), scalar);
+    }
+
     void CKKSEncoder::encode_internal(int64_t value, parms_id_type parms_id, Plaintext &destination) const
     {
         // Verify parameters.
@@ -11,6 +11,7 @@
 #include "seal/util/dwthandler.h"
 #include "seal/util/uintarithsmallmod.h"
 #include "seal/util/uintcore.h"
+#include <algorithm>
 #include <cmath>
 #include <complex>
 #include <limits>
@@ -432,6 +433,83 @@ namespace seal
             decode_internal(plain, destination.data(), std::move(pool));
         }
 #endif
+        /**
+        Decodes only the given slots of a plaintext polynomial. Each slot is the
+        plaintext polynomial evaluated at that slot's root of unity, computed as
+        one inner product of the coefficients with the root's powers instead of
+        the full inverse FFT, so reading a few slots (e.g. a scalar result in
+        slot 0) skips the O(N log N) transform; the inverse NTT and CRT
+        composition of the coefficients remain. Dynamic memory allocations in
+        the process are allocated from the memory pool pointed to by the given
+        MemoryPoolHandle.
+
+        @tparam T Vector value type (double or std::complex<double>)
+        @param[in] plain The plaintext to decode
+        @param[in] slots The slot indices to decode, each less than slot_count()
+        @param[out] destination The vector to be overwritten with the values in
+        the given slots, in the same order
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if plain is not in NTT form or is invalid
+        for the encryption parameters
+        @throws std::invalid_argument if a slot index is out of range
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        template <
+            typename T, typename = std::enable_if_t<
+                            std::is_same<std::remove_cv_t<T>, double>::value ||
+                            std::is_same<std::remove_cv_t<T>, std::complex<double>>::value>>
+        inline void decode_slots(
+            const Plaintext &plain, const std::vector<std::size_t> &slots, std::vector<T> &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            for (auto slot : slots)
+            {
+                if (slot >= slots_)
+                {
+                    throw std::invalid_argument("slot index is out of range");
+                }
+            }
+            if (!complex_roots_)
+            {
+                std::vector<T> values;
+                decode(plain, values, std::move(pool));
+                destination.resize(slots.size());
+                for (std::size_t s = 0; s < slots.size(); s++)
+                {
+                    destination[s] = values[slots[s]];
+                }
+                return;
+            }
+            auto coefficients = decode_coefficients(plain, pool);
+            std::size_t coeff_count = context_.get_context_data(plain.parms_id())->parms().poly_modulus_degree();
+            std::size_t m = coeff_count << 1;
+            int logn = util::get_power_of_two(coeff_count);
+
+            destination.resize(slots.size());
+            for (std::size_t s = 0; s < slots.size(); s++)
+            {
+                // The FFT leaves the evaluation at the (2 j + 1)-th power of the primitive m-th root
+                // in bit-reversed position j; the coefficients are real
+                std::uint64_t power =
+                    2 * util::reverse_bits(static_cast<std::uint64_t>(matrix_reps_index_map_[slots[s]]), logn) + 1;
+                double real = 0.0;
+                double imag = 0.0;
+                std::uint64_t exponent = 0;
+                for (std::size_t k = 0; k < coeff_count; k++)
+                {
+                    double coefficient = coefficients[k].real();
+                    if (coefficient != 0.0)
+                    {
+                        std::complex<double> root = complex_roots_->get_root(static_cast<std::size_t>(exponent));
+                        real += coefficient * root.real();
+                        imag += coefficient * root.imag();
+                    }
+                    exponent = (exponent + power) & (m - 1);
+                }
+                destination[s] = from_complex<T>(std::complex<double>(real, imag));
+            }
+        }
+
         /**
         Returns the number of complex numbers encoded.
         */
@@ -486,6 +564,14 @@ namespace seal
                 throw std::invalid_argument("scale out of bounds");
             }
 
+            // The same real value in every slot is a constant polynomial, which needs no FFT
+            if (values_size == slots_ && std::imag(values[0]) == 0 &&
+                std::all_of(values, values + values_size, [&](const T &value) { return value == values[0]; }))
+            {
+                encode_internal(std::real(values[0]), parms_id, scale, destination, std::move(pool));
+                return;
+            }
+
             auto ntt_tables = context_data.small_ntt_tables();
 
             // values_size is guaranteed to be no bigger than slots_
@@ -499,7 +585,7 @@ namespace seal
                 conj_values[matrix_reps_index_map_[i + slots_]] = std::conj(values[i]);
             }
             double fix = scale / static_cast<double>(n);
-            fft_handler_.transform_from_rev(conj_values.get(), util::get_power_of_two(n), inv_root_powers_.get(), &fix);
+            fft_transform_from_rev(conj_values.get(), util::get_power_of_two(n), &fix);
 
             double max_coeff = 0;
             for (std::size_t i = 0; i < n; i++)
@@ -628,11 +714,8 @@ namespace seal
             destination.scale() = scale;
         }
 
-        template <
-            typename T, typename = std::enable_if_t<
-                            std::is_same<std::remove_cv_t<T>, double>::value ||
-                            std::is_same<std::remove_cv_t<T>, std::complex<double>>::value>>
-        void decode_internal(const Plaintext &plain, T *destination, MemoryPoolHandle pool) const
+        // Coefficients of a plaintext divided by its scale, as floating-point numbers
+        util::Pointer<std::complex<double>> decode_coefficients(const Plaintext &plain, MemoryPoolHandle pool) const
         {
             // Verify parameters.
             if (!is_valid_for(plain, context_))
@@ -643,10 +726,6 @@ namespace seal
             {
                 throw std::invalid_argument("plain is not in NTT form");
             }
-            if (!destination)
-            {
-                throw std::invalid_argument("destination cannot be null");
-            }
             if (!pool)
             {
                 throw std::invalid_argument("pool is uninitialized");
@@ -732,7 +811,24 @@ namespace seal
                 // res[i] = res_accum * inv_scale;
             }
 
-            fft_handler_.transform_to_rev(res.get(), logn, root_powers_.get());
+            return res;
+        }
+
+        template <
+            typename T, typename = std::enable_if_t<
+                            std::is_same<std::remove_cv_t<T>, double>::value ||
+                            std::is_same<std::remove_cv_t<T>, std::complex<double>>::value>>
+        void decode_internal(const Plaintext &plain, T *destination, MemoryPoolHandle pool) const
+        {
+            if (!destination)
+            {
+                throw std::invalid_argument("destination cannot be null");
+            }
+            auto res = decode_coefficients(plain, pool);
+            std::size_t coeff_count = context_.get_context_data(plain.parms_id())->parms().poly_modulus_degree();
+            int logn = util::get_power_of_two(coeff_count);
+
+            fft_transform_to_rev(res.get(), logn, nullptr);
 
             for (std::size_t i = 0; i < slots_; i++)
             {
@@ -747,12 +843,22 @@ namespace seal
             std::complex<double> value, parms_id_type parms_id, double scale, Plaintext &destination,
             MemoryPoolHandle pool) const
         {
-            auto input = util::allocate<std::complex<double>>(slots_, pool_, value);
+            if (value.imag() == 0)
+            {
+                encode_internal(value.real(), parms_id, scale, destination, std::move(pool));
+                return;
+            }
+            auto input = util::allocate<std::complex<double>>(slots_, pool, value);
             encode_internal(input.get(), slots_, parms_id, scale, destination, std::move(pool));
         }
 
         void encode_internal(std::int64_t value, parms_id_type parms_id, Plaintext &destination) const;
 
+        // fft_handler_ transforms with root_powers_ and inv_root_powers_, or the AVX-512 or AVX2 kernels if available
+        void fft_transform_to_rev(std::complex<double> *values, int log_n, const double *scalar) const;
+
+        void fft_transform_from_rev(std::complex<double> *values, int log_n, const double *scalar) const;
+
         MemoryPoolHandle pool_ = MemoryManager::GetPool();
 
         SEALContext context_;
@@ -419,12 +419,12 @@ namespace seal
         return context_data;
     }
 
-    parms_id_type SEALContext::create_next_context_data(const parms_id_type &prev_parms_id)
+    parms_id_type SEALContext::create_next_context_data(const parms_id_type &prev_parms_id, size_t drop_count)
     {
-        // Create the next set of parameters by removing last modulus
+        // Create the next set of parameters by removing the last moduli
         auto next_parms = context_data_map_.at(prev_parms_id)->parms_;
         auto next_coeff_modulus = next_parms.coeff_modulus();
-        next_coeff_modulus.pop_back();
+        next_coeff_modulus.resize(next_coeff_modulus.size() - drop_count);
         next_parms.set_coeff_modulus(next_coeff_modulus);
         auto next_parms_id = next_parms.parms_id();
 
@@ -474,17 +474,19 @@ namespace seal
         context_data_map_.emplace(make_pair(parms.parms_id(), make_shared<const ContextData>(validate(parms))));
         key_parms_id_ = parms.parms_id();
 
-        // Then create first_parms_id_ if the parameters are valid and there is
-        // more than one modulus in coeff_modulus. This is equivalent to expanding
-        // the chain by one step. Otherwise, we set first_parms_id_ to equal
-        // key_parms_id_.
-        if (!context_data_map_.at(key_parms_id_)->qualifiers_.parameters_set() || parms.coeff_modulus().size() == 1)
+        // Then create first_parms_id_ if the parameters are valid and there are
+        // more moduli in coeff_modulus than special primes. This is equivalent to
+        // expanding the chain by one step that drops the special primes. Otherwise,
+        // we set first_parms_id_ to equal key_parms_id_.
+        size_t special_modulus_size = parms.special_modulus_size();
+        if (!context_data_map_.at(key_parms_id_)->qualifiers_.parameters_set() ||
+            parms.coeff_modulus().size() <= special_modulus_size)
         {
             first_parms_id_ = key_parms_id_;
         }
         else
         {
-            auto next_parms_id = create_next_context_data(key_parms_id_);
+            auto next_parms_id = create_next_context_data(key_parms_id_, special_modulus_size);
             first_parms_id_ = (next_parms_id == parms_id_zero) ? key_parms_id_ : next_parms_id;
         }
 
@@ -625,13 +625,25 @@ namespace seal
         support for keyswitching is required by Evaluator::relinearize,
         Evaluator::apply_galois, and all rotation and conjugation operations. For
         keyswitching to be available, the coefficient modulus parameter must consist
-        of at least two prime number factors.
+        of more prime number factors than its special primes.
         */
         SEAL_NODISCARD inline bool using_keyswitching() const noexcept
         {
             return using_keyswitching_;
         }
 
+        /**
+        Returns the number of decomposition digits of a keyswitching key: the
+        data primes at the first level, in digits of special_modulus_size() primes
+        (see EncryptionParameters::set_special_modulus_size).
+        */
+        SEAL_NODISCARD inline std::size_t key_switch_digit_count() const
+        {
+            return util::divide_round_up(
+                first_context_data()->parms().coeff_modulus().size(),
+                key_context_data()->parms().special_modulus_size());
+        }
+
     private:
         /**
         Creates an instance of SEALContext, and performs several pre-computations
@@ -650,12 +662,13 @@ namespace seal
         ContextData validate(EncryptionParameters parms);
 
         /**
-        Create the next context_data by dropping the last element from coeff_modulus.
+        Create the next context_data by dropping the last drop_count elements from
+        coeff_modulus (the special primes after the key level, one otherwise).
         If the new encryption parameters are not valid, returns parms_id_zero.
         Otherwise, returns the parms_id of the next parameter and appends the next
         context_data to the chain.
         */
-        parms_id_type create_next_context_data(const parms_id_type &prev_parms);
+        parms_id_type create_next_context_data(const parms_id_type &prev_parms, std::size_t drop_count = 1);
 
         MemoryPoolHandle pool_;
 
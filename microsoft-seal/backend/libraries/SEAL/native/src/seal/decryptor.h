@@ -130,6 +130,6 @@ namespace seal
 
         util::Pointer<std::uint64_t> secret_key_array_;
 
-        mutable util::ReaderWriterLocker secret_key_array_locker_;
+        mutable util::ReaderWriterLocker secret_key_array_locker_{ util::LockSite::secret_key };
     };
 } // namespace seal
@@ -26,6 +26,9 @@ namespace seal
 
             stream.write(reinterpret_cast<const char *>(&scheme), sizeof(uint8_t));
             stream.write(reinterpret_cast<const char *>(&poly_modulus_degree64), sizeof(uint64_t));
+            // Special primes beyond the default one go in the high half of the coeff_modulus size, so that the
+            // format is unchanged for the default and older versions reject other counts as an invalid size
+            coeff_modulus_size64 |= static_cast<uint64_t>(special_modulus_size_ - 1) << 32;
             stream.write(reinterpret_cast<const char *>(&coeff_modulus_size64), sizeof(uint64_t));
             for (const auto &mod : coeff_modulus_)
             {
@@ -76,12 +79,18 @@ namespace seal
             // Read the coeff_modulus size
             uint64_t coeff_modulus_size64 = 0;
             stream.read(reinterpret_cast<char *>(&coeff_modulus_size64), sizeof(uint64_t));
+            uint64_t special_modulus_size64 = (coeff_modulus_size64 >> 32) + 1;
+            coeff_modulus_size64 &= 0xFFFFFFFFULL;
 
             // Only check for upper bound; lower bound is zero for scheme_type::none
             if (coeff_modulus_size64 > SEAL_COEFF_MOD_COUNT_MAX)
             {
                 throw logic_error("coeff_modulus is invalid");
             }
+            if (special_modulus_size64 > SEAL_COEFF_MOD_COUNT_MAX)
+            {
+                throw logic_error("special_modulus_size is invalid");
+            }
 
             // Read the coeff_modulus
             vector<Modulus> coeff_modulus;
@@ -102,6 +111,7 @@ namespace seal
             // Only BFV and BGV uses plain_modulus; set_plain_modulus checks that for
             // other schemes it is zero
             parms.set_plain_modulus(plain_modulus);
+            parms.set_special_modulus_size(safe_cast<size_t>(special_modulus_size64));
 
             // Set the loaded parameters
             swap(*this, parms);
@@ -125,10 +135,13 @@ namespace seal
     {
         size_t coeff_modulus_size = coeff_modulus_.size();
 
+        // The default single special prime adds nothing, so parameters (and the keys stored by parms_id) that
+        // predate special_modulus_size keep their parms_id
+        size_t special_modulus_count = special_modulus_size_ == 1 ? size_t(0) : size_t(1);
         size_t total_uint64_count = add_safe(
             size_t(1), // scheme
             size_t(1), // poly_modulus_degree
-            coeff_modulus_size, plain_modulus_.uint64_count());
+            coeff_modulus_size, plain_modulus_.uint64_count(), special_modulus_count);
 
         auto param_data(allocate_uint(total_uint64_count, pool_));
         uint64_t *param_data_ptr = param_data.get();
@@ -147,6 +160,11 @@ namespace seal
         set_uint(plain_modulus_.data(), plain_modulus_.uint64_count(), param_data_ptr);
         param_data_ptr += plain_modulus_.uint64_count();
 
+        if (special_modulus_count)
+        {
+            *param_data_ptr++ = static_cast<uint64_t>(special_modulus_size_);
+        }
+
         HashFunction::hash(param_data.get(), total_uint64_count, parms_id_);
 
         // Did we somehow manage to get a zero block as result? This is reserved for
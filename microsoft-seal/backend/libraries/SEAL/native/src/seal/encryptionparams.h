@@ -253,6 +253,36 @@ namespace seal
             set_plain_modulus(Modulus(plain_modulus));
         }
 
+        /**
+        Sets the number of primes at the end of the coefficient modulus that are
+        special primes for key switching; they are dropped before the first data
+        level, and the others carry data. The default of 1 is key switching as
+        Microsoft SEAL has always done it, with one decomposition digit per data
+        prime. With k special primes, key switching is hybrid: the data primes
+        are taken in digits of k consecutive primes each, so there are
+        ceil(data primes / k) digits. Fewer digits mean smaller keys and less
+        work per key switch, at the price of k - 1 more primes (bits of modulus)
+        that carry no data. Key switching noise stays small as long as the product
+        of the special primes is at least as large as every digit's product of
+        data primes, e.g. with special primes as large as the largest data prime.
+
+        @param[in] special_modulus_size The number of special primes
+        @throws std::invalid_argument if special_modulus_size is zero or larger
+        than SEAL_COEFF_MOD_COUNT_MAX
+        */
+        inline void set_special_modulus_size(std::size_t special_modulus_size)
+        {
+            if (!special_modulus_size || special_modulus_size > SEAL_COEFF_MOD_COUNT_MAX)
+            {
+                throw std::invalid_argument("special_modulus_size is invalid");
+            }
+
+            special_modulus_size_ = special_modulus_size;
+
+            // Re-compute the parms_id
+            compute_parms_id();
+        }
+
         /**
         Sets the random number generator factory to use for encryption. By default,
         the random generator is set to UniformRandomGeneratorFactory::default_factory().
@@ -290,6 +320,14 @@ namespace seal
             return coeff_modulus_;
         }
 
+        /**
+        Returns the number of special primes at the end of the coefficient modulus.
+        */
+        SEAL_NODISCARD inline std::size_t special_modulus_size() const noexcept
+        {
+            return special_modulus_size_;
+        }
+
         /**
         Returns a const reference to the currently set plaintext modulus parameter.
         */
@@ -501,6 +539,8 @@ namespace seal
 
         Modulus plain_modulus_{};
 
+        std::size_t special_modulus_size_ = 1;
+
         parms_id_type parms_id_ = parms_id_zero;
     };
 } // namespace seal
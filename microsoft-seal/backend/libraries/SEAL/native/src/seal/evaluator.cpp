@@ -5,6 +5,8 @@
 #include "seal/util/common.h"
 #include "seal/util/galois.h"
 #include "seal/util/numth.h"
+#include "seal/util/opcounters.h"
+#include "seal/util/parallel.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/polycore.h"
 #include "seal/util/scalingvariant.h"
@@ -47,6 +49,47 @@ namespace seal
             return !(scale <= 0 || (static_cast<int>(log2(scale)) >= scale_bit_count_bound));
         }
 
+        /**
+        Returns a plaintext value in [0, plain_modulus) lifted modulo a prime of the coefficient modulus the way
+        transform_to_ntt_inplace lifts plaintext coefficients: values in the upper half stand for value -
+        plain_modulus.
+        */
+        SEAL_NODISCARD inline uint64_t lift_plain_value(
+            uint64_t value, const SEALContext::ContextData &context_data, const Modulus &modulus)
+        {
+            uint64_t lifted = barrett_reduce_64(value, modulus);
+            if (value >= context_data.plain_upper_half_threshold())
+            {
+                uint64_t plain_modulus = barrett_reduce_64(context_data.parms().plain_modulus().value(), modulus);
+                lifted = sub_uint_mod(lifted, plain_modulus, modulus);
+            }
+            return lifted;
+        }
+
+        // Polynomials of one RNS component a parallel task of a batch NTT transforms together
+        constexpr size_t batch_ntt_tile = 16;
+
+        /**
+        Returns the context data of a batch's ciphertexts, or null if the batch does not fit the encryption
+        parameters.
+        */
+        SEAL_NODISCARD inline const SEALContext::ContextData *batch_context_data(
+            const CiphertextBatch &batch, const SEALContext &context)
+        {
+            auto context_data_ptr = context.get_context_data(batch.parms_id());
+            if (!context_data_ptr)
+            {
+                return nullptr;
+            }
+            auto &parms = context_data_ptr->parms();
+            if (batch.poly_modulus_degree() != parms.poly_modulus_degree() ||
+                batch.coeff_modulus_size() != parms.coeff_modulus().size() || batch.size() < SEAL_CIPHERTEXT_SIZE_MIN)
+            {
+                return nullptr;
+            }
+            return context_data_ptr.get();
+        }
+
         /**
         Returns (f, e1, e2) such that
         (1) e1 * factor1 = e2 * factor2 = f mod p;
@@ -116,6 +159,276 @@ namespace seal
             }
             return make_tuple(multiply_uint_mod(e1, factor1, plain_modulus), e1, e2);
         }
+
+        /**
+        Computes the RNS component key_index of a key switching product: the sum over J of the decomposition digit
+        operands[J], in NTT form modulo the key modulus at key_index with coefficients in [0, 4q), times that component
+        of each part of the key, whose limb at key_index key_limb(J, K) returns (64-bit words, or 32-bit words of a
+        compact key, widened as they are read). Writes the key_component_count fully reduced results to
+        destination_iter.
+
+        Each output coefficient is summed over the digits in a 128-bit register and reduced once, rather than digit by
+        digit into an array of 128-bit accumulators that is loaded and stored once per digit.
+        */
+        template <typename KeyWord, typename KeyLimb>
+        void accumulate_key_products(
+            KeyLimb &&key_limb, size_t key_component_count, const uint64_t *const *operands,
+            size_t decomp_modulus_size, const Modulus &modulus, size_t coeff_count, PolyIter destination_iter)
+        {
+            // Product of two numbers is up to 60 + 60 = 120 bits, so we can sum up to 256 of them without reduction.
+            size_t lazy_reduction_summand_bound = size_t(SEAL_MULTIPLY_ACCUMULATE_USER_MOD_MAX);
+
+            vector<const KeyWord *> keys(decomp_modulus_size);
+            for (size_t K = 0; K < key_component_count; K++)
+            {
+                for (size_t J = 0; J < decomp_modulus_size; J++)
+                {
+                    keys[J] = key_limb(J, K);
+                }
+                CoeffIter destination = *destination_iter[K];
+                for (size_t l = 0; l < coeff_count; l++)
+                {
+                    // Partial sums are reduced every lazy_reduction_summand_bound products
+                    unsigned long long accumulator[2]{ 0, 0 };
+                    for (size_t first = 0; first < decomp_modulus_size; first += lazy_reduction_summand_bound)
+                    {
+                        size_t last = min(decomp_modulus_size, first + lazy_reduction_summand_bound);
+                        for (size_t J = first; J < last; J++)
+                        {
+                            unsigned long long qword[2]{ 0, 0 };
+                            multiply_uint64(operands[J][l], static_cast<uint64_t>(keys[J][l]), qword);
+                            add_uint128(qword, accumulator, accumulator);
+                        }
+                        accumulator[0] = barrett_reduce_128(accumulator, modulus);
+                        accumulator[1] = 0;
+                    }
+                    destination[l] = accumulator[0];
+                }
+            }
+        }
+
+        // The above with the keyswitching key at kswitch_keys_index, compact or not
+        void accumulate_key_products(
+            const KSwitchKeys &kswitch_keys, size_t kswitch_keys_index, const uint64_t *const *operands,
+            size_t decomp_modulus_size, size_t key_index, const Modulus &modulus, size_t coeff_count,
+            PolyIter destination_iter)
+        {
+            if (kswitch_keys.is_compact(kswitch_keys_index))
+            {
+                auto &key = kswitch_keys.compact_data(kswitch_keys_index);
+                if (key.is_narrow(key_index))
+                {
+                    accumulate_key_products<uint32_t>(
+                        [&](size_t J, size_t K) { return key.narrow_limb(J, K, key_index); }, key.component_count(),
+                        operands, decomp_modulus_size, modulus, coeff_count, destination_iter);
+                }
+                else
+                {
+                    accumulate_key_products<uint64_t>(
+                        [&](size_t J, size_t K) { return key.wide_limb(J, K, key_index); }, key.component_count(),
+                        operands, decomp_modulus_size, modulus, coeff_count, destination_iter);
+                }
+                return;
+            }
+            auto &key_vector = kswitch_keys.data()[kswitch_keys_index];
+            accumulate_key_products<uint64_t>(
+                [&](size_t J, size_t K) { return key_vector[J].data().data(K) + key_index * coeff_count; },
+                key_vector[0].data().size(), operands, decomp_modulus_size, modulus, coeff_count, destination_iter);
+        }
+
+        // Checks the used component of kswitch_keys: the compact form, or each PublicKey
+        bool is_kswitch_key_valid(const KSwitchKeys &kswitch_keys, size_t index, const SEALContext &context)
+        {
+            auto &key_vector = kswitch_keys.data()[index];
+            if (kswitch_keys.is_compact(index))
+            {
+                // compact() checked the keys; their PublicKeys kept the metadata
+                return key_vector.size() == context.key_switch_digit_count() &&
+                       kswitch_keys.compact_data(index).component_count() == SEAL_CIPHERTEXT_SIZE_MIN &&
+                       all_of(key_vector.begin(), key_vector.end(), [&](const PublicKey &key) {
+                           return key.parms_id() == context.key_parms_id();
+                       });
+            }
+            for (auto &each_key : key_vector)
+            {
+                if (!is_metadata_valid_for(each_key, context) || !is_buffer_valid(each_key))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+        Decomposes target for hybrid key switching (special_modulus_size() > 1): digit J holds the residues modulo
+        special_modulus_size() consecutive primes of the level (fewer in the last digit) and is extended to the other
+        primes of the product's base, the level's primes followed by the special primes, by fast base conversion.
+        That yields the digit plus a small multiple of the digit's modulus, which vanishes against the key: its
+        component J is a multiple of that modulus times the special primes' product. Writes digit J modulo prime I of
+        the product's base to decomposition_iter[I][J], in NTT form with coefficients in [0, 4q). t_target is target
+        in coefficient form; target_iter is target as given, which CKKS and BGV hold in NTT form already.
+        */
+        void decompose_hybrid(
+            const SEALContext &context, const EncryptionParameters &parms, ConstRNSIter target_iter,
+            ConstRNSIter t_target, PolyIter decomposition_iter, MemoryPoolHandle pool)
+        {
+            auto &key_context_data = *context.key_context_data();
+            auto &key_modulus = key_context_data.parms().coeff_modulus();
+            auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
+            auto &coeff_modulus = parms.coeff_modulus();
+            size_t coeff_count = parms.poly_modulus_degree();
+            size_t decomp_modulus_size = coeff_modulus.size();
+            size_t digit_size = key_context_data.parms().special_modulus_size();
+            size_t digit_count = divide_round_up(decomp_modulus_size, digit_size);
+            size_t rns_modulus_size = decomp_modulus_size + digit_size;
+            size_t key_modulus_size = key_modulus.size();
+            bool in_ntt_form = parms.scheme() == scheme_type::ckks || parms.scheme() == scheme_type::bgv;
+            auto key_index = [&](size_t I) {
+                return I < decomp_modulus_size ? I : key_modulus_size - rns_modulus_size + I;
+            };
+
+            parallel_iterate(iter(size_t(0)), digit_count, rns_modulus_size * coeff_count, [&](auto J) {
+                auto digit_pool = parallel_pool(pool);
+                size_t first = J * digit_size;
+                size_t count = min(digit_size, decomp_modulus_size - first);
+
+                // The digit's own primes hold it already; the others are the conversion's output base
+                vector<Modulus> ibase(coeff_modulus.begin() + first, coeff_modulus.begin() + first + count);
+                vector<Modulus> obase;
+                for (size_t I = 0; I < rns_modulus_size; I++)
+                {
+                    if (I < first || I >= first + count)
+                    {
+                        obase.push_back(key_modulus[key_index(I)]);
+                    }
+                }
+                BaseConverter converter(RNSBase(ibase, digit_pool), RNSBase(obase, digit_pool), digit_pool);
+                SEAL_ALLOCATE_GET_RNS_ITER(extended, coeff_count, obase.size(), digit_pool);
+                converter.fast_convert_array(ConstRNSIter(t_target[first].ptr(), coeff_count), extended, digit_pool);
+
+                for (size_t I = 0, o = 0; I < rns_modulus_size; I++)
+                {
+                    CoeffIter destination = decomposition_iter[I][J];
+                    if (I < first || I >= first + count)
+                    {
+                        set_uint(extended[o++], coeff_count, destination);
+                    }
+                    else if (in_ntt_form)
+                    {
+                        set_uint(target_iter[I], coeff_count, destination);
+                        continue;
+                    }
+                    else
+                    {
+                        set_uint(t_target[I], coeff_count, destination);
+                    }
+                    ntt_negacyclic_harvey_lazy(destination, key_ntt_tables[key_index(I)]);
+                }
+            });
+        }
+
+        /**
+        Divides the key switching product t_poly_prod_iter (one polynomial per component, over the level's primes
+        followed by the special primes, in NTT form) by the special primes' product P and adds it to encrypted, for
+        hybrid key switching. The product modulo P is converted to the level's primes by fast base conversion; its
+        small multiple of P adds at most special_modulus_size() - 1 to each coefficient of the result, which is
+        floored rather than rounded. BGV adds the multiple of P that makes the subtracted part a multiple of the plain
+        modulus too, as with a single special prime.
+        */
+        void mod_down_hybrid(
+            const SEALContext &context, Ciphertext &encrypted, PolyIter t_poly_prod_iter, size_t key_component_count,
+            MemoryPoolHandle pool)
+        {
+            auto &parms = context.get_context_data(encrypted.parms_id())->parms();
+            auto &key_context_data = *context.key_context_data();
+            auto &key_modulus = key_context_data.parms().coeff_modulus();
+            auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
+            auto scheme = parms.scheme();
+            auto &coeff_modulus = parms.coeff_modulus();
+            size_t coeff_count = parms.poly_modulus_degree();
+            size_t decomp_modulus_size = coeff_modulus.size();
+            size_t special_modulus_size = key_context_data.parms().special_modulus_size();
+            size_t special_first = key_modulus.size() - special_modulus_size;
+            bool is_bgv = scheme == scheme_type::bgv;
+
+            // Converted to the level's primes, and for BGV also the plain modulus last
+            vector<Modulus> special(key_modulus.begin() + special_first, key_modulus.end());
+            vector<Modulus> obase(coeff_modulus.begin(), coeff_modulus.end());
+            if (is_bgv)
+            {
+                obase.push_back(parms.plain_modulus());
+            }
+            BaseConverter converter(RNSBase(special, pool), RNSBase(obase, pool), pool);
+
+            // P and P^(-1) modulo each prime of obase
+            vector<uint64_t> p_mod(obase.size());
+            vector<MultiplyUIntModOperand> inv_p_mod(obase.size());
+            for (size_t i = 0; i < obase.size(); i++)
+            {
+                uint64_t product = 1;
+                for (auto &prime : special)
+                {
+                    product = multiply_uint_mod(product, barrett_reduce_64(prime.value(), obase[i]), obase[i]);
+                }
+                uint64_t inverse;
+                if (!try_invert_uint_mod(product, obase[i], inverse))
+                {
+                    throw logic_error("special primes are not invertible");
+                }
+                p_mod[i] = product;
+                inv_p_mod[i].set(inverse, obase[i]);
+            }
+
+            SEAL_ALLOCATE_GET_RNS_ITER(converted, coeff_count, obase.size(), pool);
+            SEAL_ITERATE(iter(encrypted, t_poly_prod_iter), key_component_count, [&](auto I) {
+                // The product modulo P, in coefficient form
+                RNSIter t_special(get<1>(I)[decomp_modulus_size].ptr(), coeff_count);
+                inverse_ntt_negacyclic_harvey(t_special, special_modulus_size, key_ntt_tables + special_first);
+                converter.fast_convert_array(t_special, converted, pool);
+
+                if (is_bgv)
+                {
+                    // k = -x * P^(-1) mod t, so that x + k * P is zero modulo t
+                    const Modulus &plain_modulus = obase.back();
+                    CoeffIter k = converted[decomp_modulus_size];
+                    SEAL_ITERATE(k, coeff_count, [&](auto &K) {
+                        K = negate_uint_mod(multiply_uint_mod(K, inv_p_mod.back(), plain_modulus), plain_modulus);
+                    });
+                }
+
+                parallel_iterate(
+                    iter(get<0>(I), get<1>(I), coeff_modulus, converted, p_mod, inv_p_mod, key_ntt_tables),
+                    decomp_modulus_size, coeff_count, [&](auto J) {
+                        const Modulus &modulus = get<2>(J);
+                        CoeffIter delta = get<3>(J);
+                        if (is_bgv)
+                        {
+                            // delta = x + k * P mod q_i
+                            CoeffIter k = converted[decomp_modulus_size];
+                            uint64_t p = get<4>(J);
+                            SEAL_ITERATE(iter(delta, k), coeff_count, [&](auto K) {
+                                get<0>(K) = multiply_add_uint_mod(
+                                    barrett_reduce_64(get<1>(K), modulus), p, get<0>(K), modulus);
+                            });
+                        }
+                        if (scheme == scheme_type::bfv)
+                        {
+                            inverse_ntt_negacyclic_harvey(get<1>(J), get<6>(J));
+                        }
+                        else
+                        {
+                            ntt_negacyclic_harvey(delta, get<6>(J));
+                        }
+
+                        // (ct - delta) * P^(-1) mod q_i
+                        SEAL_ITERATE(iter(get<1>(J), delta), coeff_count, [&](auto K) {
+                            uint64_t ct = barrett_reduce_64(get<0>(K), modulus);
+                            get<0>(K) = multiply_uint_mod(sub_uint_mod(ct, get<1>(K), modulus), get<5>(J), modulus);
+                        });
+                        add_poly_coeffmod(get<1>(J), get<0>(J), coeff_count, modulus, get<0>(J));
+                    });
+            });
+        }
     } // namespace
 
     Evaluator::Evaluator(const SEALContext &context) : context_(context)
@@ -241,23 +554,328 @@ namespace seal
 
     void Evaluator::add_many(const vector<Ciphertext> &encrypteds, Ciphertext &destination) const
     {
-        if (encrypteds.empty())
+        vector<const Ciphertext *> pointers(encrypteds.size());
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            pointers[i] = &encrypteds[i];
+        }
+        add_many(pointers.data(), pointers.size(), destination);
+    }
+
+    void Evaluator::add_many(const Ciphertext *const *encrypteds, size_t count, Ciphertext &destination) const
+    {
+        if (!encrypteds || count == 0)
         {
             throw invalid_argument("encrypteds cannot be empty");
         }
-        for (size_t i = 0; i < encrypteds.size(); i++)
+        for (size_t i = 0; i < count; i++)
         {
-            if (&encrypteds[i] == &destination)
+            if (encrypteds[i] == &destination)
             {
                 throw invalid_argument("encrypteds must be different from destination");
             }
         }
 
-        destination = encrypteds[0];
-        for (size_t i = 1; i < encrypteds.size(); i++)
+        // Verify parameters.
+        const Ciphertext &first = *encrypteds[0];
+        bool fused = true;
+        for (size_t i = 0; i < count; i++)
         {
-            add_inplace(destination, encrypteds[i]);
+            const Ciphertext &encrypted = *encrypteds[i];
+            if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+            {
+                throw invalid_argument("encrypteds is not valid for encryption parameters");
+            }
+            if (encrypted.parms_id() != first.parms_id())
+            {
+                throw invalid_argument("encrypteds parameter mismatch");
+            }
+            if (encrypted.is_ntt_form() != first.is_ntt_form())
+            {
+                throw invalid_argument("NTT form mismatch");
+            }
+            if (!are_same_scale(encrypted, first))
+            {
+                throw invalid_argument("scale mismatch");
+            }
+            fused = fused && encrypted.size() == first.size() &&
+                    encrypted.correction_factor() == first.correction_factor();
         }
+
+        if (!fused)
+        {
+            // Sizes or correction factors differ; add_inplace knows how to combine those
+            destination = first;
+            for (size_t i = 1; i < count; i++)
+            {
+                add_inplace(destination, *encrypteds[i]);
+            }
+            return;
+        }
+
+        // Extract encryption parameters.
+        auto &context_data = *context_.get_context_data(first.parms_id());
+        auto &parms = context_data.parms();
+        auto &coeff_modulus = parms.coeff_modulus();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+        size_t encrypted_size = first.size();
+
+        // Prepare destination
+        destination.resize(context_, context_data.parms_id(), encrypted_size);
+        destination.is_ntt_form() = first.is_ntt_form();
+        destination.scale() = first.scale();
+        destination.correction_factor() = first.correction_factor();
+
+        // Sum every RNS component of every polynomial across all ciphertexts in one pass
+        vector<const uint64_t *> operands(count);
+        for (size_t poly = 0; poly < encrypted_size; poly++)
+        {
+            for (size_t rns = 0; rns < coeff_modulus_size; rns++)
+            {
+                size_t offset = (poly * coeff_modulus_size + rns) * coeff_count;
+                for (size_t i = 0; i < count; i++)
+                {
+                    operands[i] = encrypteds[i]->data() + offset;
+                }
+                add_poly_coeffmod_many(
+                    operands.data(), count, coeff_count, coeff_modulus[rns], destination.data() + offset);
+            }
+        }
+
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (destination.is_transparent())
+        {
+            throw logic_error("result ciphertext is transparent");
+        }
+#endif
+    }
+
+    void Evaluator::add_many(const CiphertextBatch &batch, Ciphertext &destination) const
+    {
+        // Verify parameters.
+        auto context_data_ptr = batch_context_data(batch, context_);
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("batch is not valid for encryption parameters");
+        }
+        if (batch.empty())
+        {
+            throw invalid_argument("batch cannot be empty");
+        }
+
+        // Extract encryption parameters.
+        auto &coeff_modulus = context_data_ptr->parms().coeff_modulus();
+        size_t coeff_count = batch.poly_modulus_degree();
+        size_t coeff_modulus_size = batch.coeff_modulus_size();
+        size_t encrypted_size = batch.size();
+        size_t count = batch.count();
+
+        // Prepare destination
+        destination.resize(context_, batch.parms_id(), encrypted_size);
+        destination.is_ntt_form() = batch.is_ntt_form();
+        destination.scale() = batch.scale();
+        destination.correction_factor() = batch.correction_factor();
+
+        // The operands of each RNS component of each polynomial lie at a constant stride
+        vector<const uint64_t *> operands(count);
+        for (size_t rns = 0; rns < coeff_modulus_size; rns++)
+        {
+            for (size_t poly = 0; poly < encrypted_size; poly++)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    operands[i] = batch.data(rns, i, poly);
+                }
+                add_poly_coeffmod_many(
+                    operands.data(), count, coeff_count, coeff_modulus[rns],
+                    destination.data(poly) + rns * coeff_count);
+            }
+        }
+
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (destination.is_transparent())
+        {
+            throw logic_error("result ciphertext is transparent");
+        }
+#endif
+    }
+
+    void Evaluator::add_inplace(CiphertextBatch &batch1, const CiphertextBatch &batch2) const
+    {
+        // Verify parameters.
+        auto context_data_ptr = batch_context_data(batch1, context_);
+        if (!context_data_ptr || !batch_context_data(batch2, context_))
+        {
+            throw invalid_argument("batch is not valid for encryption parameters");
+        }
+        if (batch1.count() != batch2.count() || batch1.parms_id() != batch2.parms_id() ||
+            batch1.size() != batch2.size())
+        {
+            throw invalid_argument("batch1 and batch2 shape mismatch");
+        }
+        if (batch1.is_ntt_form() != batch2.is_ntt_form())
+        {
+            throw invalid_argument("NTT form mismatch");
+        }
+        if (!are_same_scale(batch1, batch2))
+        {
+            throw invalid_argument("scale mismatch");
+        }
+        if (batch1.correction_factor() != batch2.correction_factor())
+        {
+            throw invalid_argument("correction factor mismatch");
+        }
+
+        // Extract encryption parameters.
+        auto &coeff_modulus = context_data_ptr->parms().coeff_modulus();
+        size_t coeff_count = batch1.poly_modulus_degree();
+        size_t coeff_modulus_size = batch1.coeff_modulus_size();
+        size_t poly_count = batch1.size() * batch1.count();
+
+        // Each RNS component of the whole batch is one run of coefficients under one modulus
+        if (try_parallel_for_each_rns(poly_count, coeff_modulus_size, coeff_count, [&](size_t i, size_t j) {
+                add_poly_coeffmod(
+                    batch1.data(j) + i * coeff_count, batch2.data(j) + i * coeff_count, coeff_count,
+                    coeff_modulus[j], batch1.data(j) + i * coeff_count);
+            }))
+        {
+            return;
+        }
+        for (size_t rns = 0; rns < coeff_modulus_size; rns++)
+        {
+            add_poly_coeffmod(
+                batch1.data(rns), batch2.data(rns), poly_count * coeff_count, coeff_modulus[rns], batch1.data(rns));
+        }
+    }
+
+    void Evaluator::multiply_plain_inplace(CiphertextBatch &batch, const Plaintext &plain_ntt) const
+    {
+        // Verify parameters.
+        auto context_data_ptr = batch_context_data(batch, context_);
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("batch is not valid for encryption parameters");
+        }
+        if (!batch.is_ntt_form())
+        {
+            throw invalid_argument("batch is not in NTT form");
+        }
+        if (!plain_ntt.is_ntt_form())
+        {
+            throw invalid_argument("plain_ntt is not in NTT form");
+        }
+        if (plain_ntt.parms_id() != batch.parms_id())
+        {
+            throw invalid_argument("batch and plain_ntt parameter mismatch");
+        }
+
+        // Extract encryption parameters.
+        auto &context_data = *context_data_ptr;
+        auto &coeff_modulus = context_data.parms().coeff_modulus();
+        size_t coeff_count = batch.poly_modulus_degree();
+        size_t coeff_modulus_size = batch.coeff_modulus_size();
+        size_t poly_count = batch.size() * batch.count();
+        if (plain_ntt.coeff_count() != coeff_count * coeff_modulus_size)
+        {
+            throw invalid_argument("plain_ntt is not valid for encryption parameters");
+        }
+        double new_scale = batch.scale() * plain_ntt.scale();
+        if (!is_scale_within_bounds(new_scale, context_data))
+        {
+            throw invalid_argument("scale out of bounds");
+        }
+
+        // Component j of the plaintext stays in cache while it multiplies component j of every polynomial
+        auto multiply = [&](size_t i, size_t j) {
+            uint64_t *poly = batch.data(j) + i * coeff_count;
+            dyadic_product_coeffmod(poly, plain_ntt.data() + j * coeff_count, coeff_count, coeff_modulus[j], poly);
+        };
+        if (!try_parallel_for_each_rns(poly_count, coeff_modulus_size, coeff_count, multiply))
+        {
+            for (size_t rns = 0; rns < coeff_modulus_size; rns++)
+            {
+                for (size_t i = 0; i < poly_count; i++)
+                {
+                    multiply(i, rns);
+                }
+            }
+        }
+        batch.scale() = new_scale;
+    }
+
+    void Evaluator::transform_to_ntt_inplace(CiphertextBatch &batch) const
+    {
+        // Verify parameters.
+        auto context_data_ptr = batch_context_data(batch, context_);
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("batch is not valid for encryption parameters");
+        }
+        if (batch.is_ntt_form())
+        {
+            throw invalid_argument("batch is already in NTT form");
+        }
+
+        size_t coeff_count = batch.poly_modulus_degree();
+        size_t coeff_modulus_size = batch.coeff_modulus_size();
+        size_t poly_count = batch.size() * batch.count();
+        auto ntt_tables = iter(context_data_ptr->small_ntt_tables());
+
+        // The tables of component j serve every polynomial of the batch in turn; tasks take a tile of
+        // batch_ntt_tile polynomials, which the batched kernel transforms together
+        size_t tile_count = (poly_count + batch_ntt_tile - 1) / batch_ntt_tile;
+        auto transform = [&](size_t t, size_t j) {
+            size_t first = t * batch_ntt_tile;
+            ntt_negacyclic_harvey(
+                CoeffIter(batch.data(j) + first * coeff_count), min(batch_ntt_tile, poly_count - first),
+                ntt_tables[j]);
+        };
+        if (!try_parallel_for_each_rns(tile_count, coeff_modulus_size, batch_ntt_tile * coeff_count, transform))
+        {
+            for (size_t rns = 0; rns < coeff_modulus_size; rns++)
+            {
+                ntt_negacyclic_harvey(CoeffIter(batch.data(rns)), poly_count, ntt_tables[rns]);
+            }
+        }
+        batch.is_ntt_form() = true;
+    }
+
+    void Evaluator::transform_from_ntt_inplace(CiphertextBatch &batch_ntt) const
+    {
+        // Verify parameters.
+        auto context_data_ptr = batch_context_data(batch_ntt, context_);
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("batch_ntt is not valid for encryption parameters");
+        }
+        if (!batch_ntt.is_ntt_form())
+        {
+            throw invalid_argument("batch_ntt is not in NTT form");
+        }
+
+        size_t coeff_count = batch_ntt.poly_modulus_degree();
+        size_t coeff_modulus_size = batch_ntt.coeff_modulus_size();
+        size_t poly_count = batch_ntt.size() * batch_ntt.count();
+        auto ntt_tables = iter(context_data_ptr->small_ntt_tables());
+
+        size_t tile_count = (poly_count + batch_ntt_tile - 1) / batch_ntt_tile;
+        auto transform = [&](size_t t, size_t j) {
+            size_t first = t * batch_ntt_tile;
+            inverse_ntt_negacyclic_harvey(
+                CoeffIter(batch_ntt.data(j) + first * coeff_count), min(batch_ntt_tile, poly_count - first),
+                ntt_tables[j]);
+        };
+        if (!try_parallel_for_each_rns(tile_count, coeff_modulus_size, batch_ntt_tile * coeff_count, transform))
+        {
+            for (size_t rns = 0; rns < coeff_modulus_size; rns++)
+            {
+                inverse_ntt_negacyclic_harvey(CoeffIter(batch_ntt.data(rns)), poly_count, ntt_tables[rns]);
+            }
+        }
+        batch_ntt.is_ntt_form() = false;
     }
 
     void Evaluator::sub_inplace(Ciphertext &encrypted1, const Ciphertext &encrypted2) const
@@ -1668,37 +2286,67 @@ namespace seal
             return;
         }
 
-        // Do first level of multiplications
-        vector<Ciphertext> product_vec;
-        for (size_t i = 0; i < encrypteds.size() - 1; i += 2)
+        // A balanced product tree, built one level at a time. The products of a level are independent, so they run
+        // concurrently on the ParallelExecution executor when there is one, each relinearized in the task that
+        // computes it; the last product is computed on the calling thread, directly into destination. Leaves are
+        // read in place rather than copied. Helper tasks make their scratch allocations from thread-local pools, so
+        // every intermediate product is allocated from pool up front, with room for its unrelinearized size.
+        vector<const Ciphertext *> level;
+        level.reserve(encrypteds.size());
+        for (auto &encrypted : encrypteds)
+        {
+            level.push_back(&encrypted);
+        }
+        vector<Ciphertext> products;
+        while (level.size() > 2)
         {
-            Ciphertext temp(context_, context_data.parms_id(), pool);
-            if (encrypteds[i].data() == encrypteds[i + 1].data())
+            size_t pair_count = level.size() / 2;
+            vector<Ciphertext> next_products;
+            next_products.reserve(pair_count + 1);
+            for (size_t i = 0; i < pair_count; i++)
             {
-                square(encrypteds[i], temp);
+                next_products.emplace_back(
+                    context_, context_data.parms_id(), level[2 * i]->size() + level[2 * i + 1]->size() - 1, pool);
             }
-            else
+            parallel_for(pair_count, parallel_task_count(pair_count), [&](size_t i) {
+                multiply_relinearize(
+                    *level[2 * i], *level[2 * i + 1], relin_keys, next_products[i], parallel_pool(pool));
+            });
+
+            // An odd ciphertext out moves up a level unchanged
+            const Ciphertext *odd = (level.size() & 1) ? level.back() : nullptr;
+            if (odd && !products.empty() && odd == &products.back())
+            {
+                next_products.emplace_back(move(products.back()));
+                odd = &next_products.back();
+            }
+            products = move(next_products);
+            level.clear();
+            for (size_t i = 0; i < pair_count; i++)
+            {
+                level.push_back(&products[i]);
+            }
+            if (odd)
             {
-                multiply(encrypteds[i], encrypteds[i + 1], temp);
+                level.push_back(odd);
             }
-            relinearize_inplace(temp, relin_keys, pool);
-            product_vec.emplace_back(std::move(temp));
         }
-        if (encrypteds.size() & 1)
+        multiply_relinearize(*level[0], *level[1], relin_keys, destination, move(pool));
+    }
+
+    void Evaluator::multiply_relinearize(
+        const Ciphertext &encrypted1, const Ciphertext &encrypted2, const RelinKeys &relin_keys,
+        Ciphertext &destination, MemoryPoolHandle pool) const
+    {
+        if (encrypted1.data() == encrypted2.data())
         {
-            product_vec.emplace_back(encrypteds.back());
+            square(encrypted1, destination, pool);
         }
-
-        // Repeatedly multiply and add to the back of the vector until the end is reached
-        for (size_t i = 0; i < product_vec.size() - 1; i += 2)
+        else
         {
-            Ciphertext temp(context_, context_data.parms_id(), pool);
-            multiply(product_vec[i], product_vec[i + 1], temp);
-            relinearize_inplace(temp, relin_keys, pool);
-            product_vec.emplace_back(std::move(temp));
+            multiply(encrypted1, encrypted2, destination, pool);
         }
-
-        destination = product_vec.back();
+        relinearize_inplace(destination, relin_keys, move(pool));
     }
 
     void Evaluator::exponentiate_inplace(
@@ -1729,9 +2377,59 @@ namespace seal
             return;
         }
 
-        // Create a vector of copies of encrypted
-        vector<Ciphertext> exp_vector(static_cast<size_t>(exponent), encrypted);
-        multiply_many(exp_vector, relin_keys, encrypted, std::move(pool));
+        auto &parms = context_data_ptr->parms();
+        if (parms.scheme() != scheme_type::bfv && parms.scheme() != scheme_type::bgv)
+        {
+            throw logic_error("unsupported scheme");
+        }
+
+        // Square-and-multiply from the lowest bit: power runs through encrypted^(2^i), and result collects the
+        // powers of the set bits. Each round squares power and multiplies result by the previous power; the two
+        // are independent, so they run concurrently when there is an executor. This takes floor(log2(exponent)) +
+        // popcount(exponent) - 1 multiplications in floor(log2(exponent)) + 1 rounds, and result ends up at the
+        // same depth, ceil(log2(exponent)), as a balanced product tree of exponent copies. As in multiply_many,
+        // the ciphertexts are allocated from pool on the calling thread with room for unrelinearized products.
+        size_t size_capacity = max<size_t>(2 * encrypted.size() - 1, 3);
+        Ciphertext power(context_, encrypted.parms_id(), size_capacity, pool);
+        Ciphertext next_power(context_, encrypted.parms_id(), size_capacity, pool);
+        Ciphertext result(context_, encrypted.parms_id(), size_capacity, pool);
+        power = encrypted;
+        bool have_result = false;
+        while (true)
+        {
+            bool bit = exponent & 1;
+            exponent >>= 1;
+            bool multiply_result = bit && have_result;
+            if (bit && !have_result)
+            {
+                result = power;
+                have_result = true;
+            }
+            if (!exponent && !multiply_result)
+            {
+                break;
+            }
+
+            // Item 0 multiplies result by power, item 1 squares power; either may be missing
+            size_t first_item = multiply_result ? 0 : 1;
+            size_t item_count = (exponent ? 2 : 1) - first_item;
+            parallel_for(item_count, parallel_task_count(item_count), [&](size_t item) {
+                if (first_item + item == 0)
+                {
+                    multiply_relinearize(result, power, relin_keys, result, parallel_pool(pool));
+                }
+                else
+                {
+                    multiply_relinearize(power, power, relin_keys, next_power, parallel_pool(pool));
+                }
+            });
+            if (!exponent)
+            {
+                break;
+            }
+            swap(power, next_power);
+        }
+        encrypted = result;
     }
 
     void Evaluator::add_plain_inplace(Ciphertext &encrypted, const Plaintext &plain, MemoryPoolHandle pool) const
@@ -2112,63 +2810,401 @@ namespace seal
         RNSIter temp_iter(temp.get(), coeff_count);
         ntt_negacyclic_harvey(temp_iter, coeff_modulus_size, ntt_tables);
 
-        SEAL_ITERATE(iter(encrypted), encrypted_size, [&](auto I) {
-            SEAL_ITERATE(iter(I, temp_iter, coeff_modulus, ntt_tables), coeff_modulus_size, [&](auto J) {
-                // Lazy reduction
-                ntt_negacyclic_harvey_lazy(get<0>(J), get<3>(J));
-                dyadic_product_coeffmod(get<0>(J), get<1>(J), coeff_count, get<2>(J), get<0>(J));
-                inverse_ntt_negacyclic_harvey(get<0>(J), get<3>(J));
-            });
-        });
+        SEAL_ITERATE(iter(encrypted), encrypted_size, [&](auto I) {
+            SEAL_ITERATE(iter(I, temp_iter, coeff_modulus, ntt_tables), coeff_modulus_size, [&](auto J) {
+                // Lazy reduction
+                ntt_negacyclic_harvey_lazy(get<0>(J), get<3>(J));
+                dyadic_product_coeffmod(get<0>(J), get<1>(J), coeff_count, get<2>(J), get<0>(J));
+                inverse_ntt_negacyclic_harvey(get<0>(J), get<3>(J));
+            });
+        });
+
+        // Set the scale
+        if (parms.scheme() == scheme_type::ckks)
+        {
+            encrypted.scale() *= plain.scale();
+            if (!is_scale_within_bounds(encrypted.scale(), context_data))
+            {
+                throw invalid_argument("scale out of bounds");
+            }
+        }
+    }
+
+    void Evaluator::multiply_plain_ntt(Ciphertext &encrypted_ntt, const Plaintext &plain_ntt) const
+    {
+        // Verify parameters.
+        if (!plain_ntt.is_ntt_form())
+        {
+            throw invalid_argument("plain_ntt is not in NTT form");
+        }
+        if (encrypted_ntt.parms_id() != plain_ntt.parms_id())
+        {
+            throw invalid_argument("encrypted_ntt and plain_ntt parameter mismatch");
+        }
+
+        // Extract encryption parameters.
+        auto &context_data = *context_.get_context_data(encrypted_ntt.parms_id());
+        auto &parms = context_data.parms();
+        auto &coeff_modulus = parms.coeff_modulus();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+        size_t encrypted_ntt_size = encrypted_ntt.size();
+
+        // Size check
+        if (!product_fits_in(encrypted_ntt_size, coeff_count, coeff_modulus_size))
+        {
+            throw logic_error("invalid parameters");
+        }
+
+        ConstRNSIter plain_ntt_iter(plain_ntt.data(), coeff_count);
+        SEAL_ITERATE(iter(encrypted_ntt), encrypted_ntt_size, [&](auto I) {
+            dyadic_product_coeffmod(I, plain_ntt_iter, coeff_modulus_size, coeff_modulus, I);
+        });
+
+        // Set the scale
+        encrypted_ntt.scale() *= plain_ntt.scale();
+        if (!is_scale_within_bounds(encrypted_ntt.scale(), context_data))
+        {
+            throw invalid_argument("scale out of bounds");
+        }
+    }
+
+    void Evaluator::multiply_plain_accumulate(
+        Ciphertext &destination, const Ciphertext &encrypted, const Plaintext &plain_ntt, MemoryPoolHandle pool) const
+    {
+        // Verify parameters.
+        if (!is_metadata_valid_for(destination, context_) || !is_buffer_valid(destination))
+        {
+            throw invalid_argument("destination is not valid for encryption parameters");
+        }
+        if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (!is_metadata_valid_for(plain_ntt, context_) || !is_buffer_valid(plain_ntt))
+        {
+            throw invalid_argument("plain_ntt is not valid for encryption parameters");
+        }
+        if (!destination.is_ntt_form() || !encrypted.is_ntt_form())
+        {
+            throw invalid_argument("destination or encrypted is not in NTT form");
+        }
+        if (!plain_ntt.is_ntt_form())
+        {
+            throw invalid_argument("plain_ntt is not in NTT form");
+        }
+        if (destination.parms_id() != encrypted.parms_id() || plain_ntt.parms_id() != encrypted.parms_id())
+        {
+            throw invalid_argument("destination, encrypted and plain_ntt parameter mismatch");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+
+        // Extract encryption parameters.
+        auto &context_data = *context_.get_context_data(encrypted.parms_id());
+        auto &coeff_modulus = context_data.parms().coeff_modulus();
+        size_t coeff_count = context_data.parms().poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+        size_t encrypted_size = encrypted.size();
+
+        double product_scale = encrypted.scale() * plain_ntt.scale();
+        if (!is_scale_within_bounds(product_scale, context_data))
+        {
+            throw invalid_argument("scale out of bounds");
+        }
+        if (!are_close<double>(destination.scale(), product_scale))
+        {
+            throw invalid_argument("scale mismatch");
+        }
+
+        if (destination.correction_factor() != encrypted.correction_factor())
+        {
+            // add_inplace knows how to combine different correction factors
+            Ciphertext product(pool);
+            multiply_plain(encrypted, plain_ntt, product, pool);
+            add_inplace(destination, product);
+            return;
+        }
+
+        // Polynomials that only encrypted has are products added to zero
+        if (destination.size() < encrypted_size)
+        {
+            destination.resize(context_, destination.parms_id(), encrypted_size);
+        }
+
+        auto accumulate = [&](size_t i, size_t j) {
+            size_t offset = j * coeff_count;
+            dyadic_product_accumulate_coeffmod(
+                encrypted.data(i) + offset, plain_ntt.data() + offset, coeff_count, coeff_modulus[j],
+                destination.data(i) + offset);
+        };
+        if (!try_parallel_for_each_rns(encrypted_size, coeff_modulus_size, coeff_count, accumulate))
+        {
+            for (size_t i = 0; i < encrypted_size; i++)
+            {
+                for (size_t j = 0; j < coeff_modulus_size; j++)
+                {
+                    accumulate(i, j);
+                }
+            }
+        }
+
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (destination.is_transparent())
+        {
+            throw logic_error("result ciphertext is transparent");
+        }
+#endif
+    }
+
+    void Evaluator::multiply_plain_add_many(
+        const vector<Ciphertext> &encrypteds, const vector<Plaintext> &plains_ntt, Ciphertext &destination,
+        MemoryPoolHandle pool) const
+    {
+        if (encrypteds.size() != plains_ntt.size())
+        {
+            throw invalid_argument("encrypteds and plains_ntt have different lengths");
+        }
+        vector<const Ciphertext *> encrypted_pointers(encrypteds.size());
+        vector<const Plaintext *> plain_pointers(plains_ntt.size());
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            encrypted_pointers[i] = &encrypteds[i];
+            plain_pointers[i] = &plains_ntt[i];
+        }
+        multiply_plain_add_many(
+            encrypted_pointers.data(), plain_pointers.data(), encrypteds.size(), destination, std::move(pool));
+    }
+
+    void Evaluator::multiply_plain_add_many(
+        const Ciphertext *const *encrypteds, const Plaintext *const *plains_ntt, size_t count,
+        Ciphertext &destination, MemoryPoolHandle pool) const
+    {
+        if (!encrypteds || !plains_ntt || count == 0)
+        {
+            throw invalid_argument("encrypteds cannot be empty");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            if (encrypteds[i] == &destination)
+            {
+                throw invalid_argument("encrypteds must be different from destination");
+            }
+        }
+
+        // Verify parameters.
+        const Ciphertext &first = *encrypteds[0];
+        double product_scale = first.scale() * plains_ntt[0]->scale();
+        bool fused = true;
+        for (size_t i = 0; i < count; i++)
+        {
+            const Ciphertext &encrypted = *encrypteds[i];
+            const Plaintext &plain_ntt = *plains_ntt[i];
+            if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+            {
+                throw invalid_argument("encrypteds is not valid for encryption parameters");
+            }
+            if (!is_metadata_valid_for(plain_ntt, context_) || !is_buffer_valid(plain_ntt))
+            {
+                throw invalid_argument("plains_ntt is not valid for encryption parameters");
+            }
+            if (!encrypted.is_ntt_form() || !plain_ntt.is_ntt_form())
+            {
+                throw invalid_argument("encrypteds or plains_ntt is not in NTT form");
+            }
+            if (encrypted.parms_id() != first.parms_id() || plain_ntt.parms_id() != first.parms_id())
+            {
+                throw invalid_argument("encrypteds and plains_ntt parameter mismatch");
+            }
+            if (!are_close<double>(encrypted.scale() * plain_ntt.scale(), product_scale))
+            {
+                throw invalid_argument("scale mismatch");
+            }
+            fused = fused && encrypted.size() == first.size() &&
+                    encrypted.correction_factor() == first.correction_factor();
+        }
+
+        // Extract encryption parameters.
+        auto &context_data = *context_.get_context_data(first.parms_id());
+        auto &coeff_modulus = context_data.parms().coeff_modulus();
+        size_t coeff_count = context_data.parms().poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+        size_t encrypted_size = first.size();
+        if (!is_scale_within_bounds(product_scale, context_data))
+        {
+            throw invalid_argument("scale out of bounds");
+        }
+
+        if (!fused)
+        {
+            // Sizes or correction factors differ; multiply_plain_accumulate handles those
+            multiply_plain(first, *plains_ntt[0], destination, pool);
+            for (size_t i = 1; i < count; i++)
+            {
+                multiply_plain_accumulate(destination, *encrypteds[i], *plains_ntt[i], pool);
+            }
+            return;
+        }
+
+        // Prepare destination
+        destination.resize(context_, first.parms_id(), encrypted_size);
+        destination.is_ntt_form() = true;
+        destination.scale() = product_scale;
+        destination.correction_factor() = first.correction_factor();
+
+        // Sum the products of every RNS component of every polynomial in one pass
+        auto sum_products = [&](size_t i, size_t j) {
+            size_t offset = j * coeff_count;
+            vector<const uint64_t *> operands1(count);
+            vector<const uint64_t *> operands2(count);
+            for (size_t k = 0; k < count; k++)
+            {
+                operands1[k] = encrypteds[k]->data(i) + offset;
+                operands2[k] = plains_ntt[k]->data() + offset;
+            }
+            dyadic_product_coeffmod_many(
+                operands1.data(), operands2.data(), count, coeff_count, coeff_modulus[j],
+                destination.data(i) + offset);
+        };
+        if (!try_parallel_for_each_rns(encrypted_size, coeff_modulus_size, coeff_count, sum_products))
+        {
+            for (size_t i = 0; i < encrypted_size; i++)
+            {
+                for (size_t j = 0; j < coeff_modulus_size; j++)
+                {
+                    sum_products(i, j);
+                }
+            }
+        }
+
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (destination.is_transparent())
+        {
+            throw logic_error("result ciphertext is transparent");
+        }
+#endif
+    }
+
+    void Evaluator::multiply_scalar_inplace(Ciphertext &encrypted, uint64_t scalar) const
+    {
+        // Verify parameters.
+        if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+
+        // Extract encryption parameters.
+        auto &context_data = *context_.get_context_data(encrypted.parms_id());
+        auto &parms = context_data.parms();
+        if (parms.scheme() != scheme_type::bfv && parms.scheme() != scheme_type::bgv)
+        {
+            throw invalid_argument("unsupported scheme");
+        }
+        auto &coeff_modulus = parms.coeff_modulus();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+        size_t encrypted_size = encrypted.size();
+
+        scalar = barrett_reduce_64(scalar, parms.plain_modulus());
+        vector<MultiplyUIntModOperand> operands(coeff_modulus_size);
+        for (size_t j = 0; j < coeff_modulus_size; j++)
+        {
+            operands[j].set(lift_plain_value(scalar, context_data, coeff_modulus[j]), coeff_modulus[j]);
+        }
 
-        // Set the scale
-        if (parms.scheme() == scheme_type::ckks)
+        auto multiply = [&](size_t i, size_t j) {
+            CoeffIter poly(encrypted.data(i) + j * coeff_count);
+            multiply_poly_scalar_coeffmod(poly, coeff_count, operands[j], coeff_modulus[j], poly);
+        };
+        if (!try_parallel_for_each_rns(encrypted_size, coeff_modulus_size, coeff_count, multiply))
         {
-            encrypted.scale() *= plain.scale();
-            if (!is_scale_within_bounds(encrypted.scale(), context_data))
+            for (size_t i = 0; i < encrypted_size; i++)
             {
-                throw invalid_argument("scale out of bounds");
+                for (size_t j = 0; j < coeff_modulus_size; j++)
+                {
+                    multiply(i, j);
+                }
             }
         }
+
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (encrypted.is_transparent())
+        {
+            throw logic_error("result ciphertext is transparent");
+        }
+#endif
     }
 
-    void Evaluator::multiply_plain_ntt(Ciphertext &encrypted_ntt, const Plaintext &plain_ntt) const
+    void Evaluator::add_scalar_inplace(Ciphertext &encrypted, uint64_t scalar) const
     {
         // Verify parameters.
-        if (!plain_ntt.is_ntt_form())
-        {
-            throw invalid_argument("plain_ntt is not in NTT form");
-        }
-        if (encrypted_ntt.parms_id() != plain_ntt.parms_id())
+        if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
         {
-            throw invalid_argument("encrypted_ntt and plain_ntt parameter mismatch");
+            throw invalid_argument("encrypted is not valid for encryption parameters");
         }
 
         // Extract encryption parameters.
-        auto &context_data = *context_.get_context_data(encrypted_ntt.parms_id());
+        auto &context_data = *context_.get_context_data(encrypted.parms_id());
         auto &parms = context_data.parms();
+        if (parms.scheme() != scheme_type::bfv && parms.scheme() != scheme_type::bgv)
+        {
+            throw invalid_argument("unsupported scheme");
+        }
         auto &coeff_modulus = parms.coeff_modulus();
+        auto &plain_modulus = parms.plain_modulus();
         size_t coeff_count = parms.poly_modulus_degree();
         size_t coeff_modulus_size = coeff_modulus.size();
-        size_t encrypted_ntt_size = encrypted_ntt.size();
 
-        // Size check
-        if (!product_fits_in(encrypted_ntt_size, coeff_count, coeff_modulus_size))
+        scalar = barrett_reduce_64(scalar, plain_modulus);
+        uint64_t fix = 0;
+        if (parms.scheme() == scheme_type::bfv)
         {
-            throw logic_error("invalid parameters");
+            // round(q * scalar / t) = floor(q / t) * scalar + floor(((q mod t) * scalar + floor((t + 1) / 2)) / t),
+            // as multiply_add_plain_with_scaling_variant computes it
+            unsigned long long product[2]{ 0, 0 };
+            uint64_t numerator[2]{ 0, 0 };
+            multiply_uint64(scalar, context_data.coeff_modulus_mod_plain_modulus(), product);
+            unsigned char carry = add_uint64(*product, context_data.plain_upper_half_threshold(), numerator);
+            numerator[1] = static_cast<uint64_t>(product[1]) + static_cast<uint64_t>(carry);
+            uint64_t quotient[2]{ 0, 0 };
+            divide_uint128_inplace(numerator, plain_modulus.value(), quotient);
+            fix = quotient[0];
+        }
+        else
+        {
+            // As in add_plain_inplace, a BGV plaintext is scaled by the correction factor first
+            scalar = multiply_uint_mod(scalar, barrett_reduce_64(encrypted.correction_factor(), plain_modulus),
+                plain_modulus);
         }
 
-        ConstRNSIter plain_ntt_iter(plain_ntt.data(), coeff_count);
-        SEAL_ITERATE(iter(encrypted_ntt), encrypted_ntt_size, [&](auto I) {
-            dyadic_product_coeffmod(I, plain_ntt_iter, coeff_modulus_size, coeff_modulus, I);
-        });
+        // A constant polynomial is its constant coefficient, or the same value at every NTT point
+        size_t count = encrypted.is_ntt_form() ? coeff_count : 1;
+        auto coeff_div_plain_modulus = context_data.coeff_div_plain_modulus();
+        for (size_t j = 0; j < coeff_modulus_size; j++)
+        {
+            uint64_t value = parms.scheme() == scheme_type::bfv
+                                 ? multiply_add_uint_mod(scalar, coeff_div_plain_modulus[j], fix, coeff_modulus[j])
+                                 : lift_plain_value(scalar, context_data, coeff_modulus[j]);
+            CoeffIter poly(encrypted.data() + j * coeff_count);
+            add_poly_scalar_coeffmod(poly, count, value, coeff_modulus[j], poly);
+        }
 
-        // Set the scale
-        encrypted_ntt.scale() *= plain_ntt.scale();
-        if (!is_scale_within_bounds(encrypted_ntt.scale(), context_data))
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (encrypted.is_transparent())
         {
-            throw invalid_argument("scale out of bounds");
+            throw logic_error("result ciphertext is transparent");
         }
+#endif
     }
 
     void Evaluator::transform_to_ntt_inplace(Plaintext &plain, parms_id_type parms_id, MemoryPoolHandle pool) const
@@ -2520,6 +3556,221 @@ namespace seal
         }
     }
 
+    void Evaluator::rotate_many(
+        const Ciphertext &encrypted, const vector<int> &steps, const GaloisKeys &galois_keys,
+        vector<Ciphertext> &destinations, MemoryPoolHandle pool) const
+    {
+        // Verify parameters.
+        if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        auto &context_data = *context_.get_context_data(encrypted.parms_id());
+        if (!context_data.qualifiers().using_batching)
+        {
+            throw logic_error("encryption parameters do not support batching");
+        }
+        if (galois_keys.parms_id() != context_.key_parms_id())
+        {
+            throw invalid_argument("galois_keys is not valid for encryption parameters");
+        }
+        if (!context_.using_keyswitching())
+        {
+            throw logic_error("keyswitching is not supported by the context");
+        }
+        if (encrypted.size() > 2)
+        {
+            throw invalid_argument("encrypted size must be 2");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+
+        auto &parms = context_data.parms();
+        auto scheme = parms.scheme();
+        if (scheme == scheme_type::bfv && encrypted.is_ntt_form())
+        {
+            throw invalid_argument("BFV encrypted cannot be in NTT form");
+        }
+        if ((scheme == scheme_type::ckks || scheme == scheme_type::bgv) && !encrypted.is_ntt_form())
+        {
+            throw invalid_argument("encrypted must be in NTT form");
+        }
+
+        // Extract encryption parameters.
+        auto &key_context_data = *context_.key_context_data();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t decomp_modulus_size = parms.coeff_modulus().size();
+        auto &key_modulus = key_context_data.parms().coeff_modulus();
+        size_t key_modulus_size = key_modulus.size();
+        size_t special_modulus_size = key_context_data.parms().special_modulus_size();
+        size_t rns_modulus_size = decomp_modulus_size + special_modulus_size;
+        size_t digit_count = divide_round_up(decomp_modulus_size, special_modulus_size);
+        auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
+        auto galois_tool = context_data.galois_tool();
+
+        // Size check
+        if (!product_fits_in(coeff_count, rns_modulus_size, decomp_modulus_size))
+        {
+            throw logic_error("invalid parameters");
+        }
+
+        // Results are collected separately since destinations may alias encrypted
+        vector<Ciphertext> results(steps.size());
+        Pointer<uint64_t> decomposition;
+        PolyIter decomposition_iter;
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            int step = steps[i];
+            Ciphertext &result = results[i];
+            result = encrypted;
+            if (step == 0)
+            {
+                continue;
+            }
+
+            // Steps without a Galois key of their own are composed from several rotations
+            uint32_t galois_elt = galois_tool->get_elt_from_step(step);
+            if (!galois_keys.has_key(galois_elt))
+            {
+                rotate_internal(result, step, galois_keys, pool);
+                continue;
+            }
+
+            // Decompose encrypted.data(1) on first use: digit J modulo each key modulus, in NTT form
+            if (!decomposition)
+            {
+                decomposition = allocate_poly_array(rns_modulus_size, coeff_count, digit_count, pool);
+                decomposition_iter = PolyIter(decomposition.get(), coeff_count, digit_count);
+                ConstRNSIter target_iter(encrypted.data(1), coeff_count);
+
+                SEAL_ALLOCATE_GET_RNS_ITER(t_target, coeff_count, decomp_modulus_size, pool);
+                set_uint(target_iter, decomp_modulus_size * coeff_count, t_target);
+
+                // In CKKS or BGV, t_target is in NTT form; switch back to normal form
+                if (scheme == scheme_type::ckks || scheme == scheme_type::bgv)
+                {
+                    inverse_ntt_negacyclic_harvey(t_target, decomp_modulus_size, key_ntt_tables);
+                }
+
+                if (special_modulus_size > 1)
+                {
+                    decompose_hybrid(context_, parms, target_iter, t_target, decomposition_iter, pool);
+                }
+                else
+                {
+                    parallel_iterate(
+                        iter(size_t(0), decomposition_iter), rns_modulus_size, decomp_modulus_size * coeff_count,
+                        [&](auto J) {
+                            size_t key_index = (get<0>(J) == decomp_modulus_size ? key_modulus_size - 1 : get<0>(J));
+                            bool in_ntt_form = scheme == scheme_type::ckks || scheme == scheme_type::bgv;
+                            SEAL_ITERATE(iter(size_t(0), get<1>(J)), decomp_modulus_size, [&](auto K) {
+                                // RNS-NTT form exists in input
+                                if (in_ntt_form && get<0>(J) == get<0>(K))
+                                {
+                                    set_uint(target_iter[get<0>(K)], coeff_count, get<1>(K));
+                                    return;
+                                }
+                                if (key_modulus[get<0>(K)] <= key_modulus[key_index])
+                                {
+                                    set_uint(t_target[get<0>(K)], coeff_count, get<1>(K));
+                                }
+                                else
+                                {
+                                    modulo_poly_coeffs(
+                                        t_target[get<0>(K)], coeff_count, key_modulus[key_index], get<1>(K));
+                                }
+                            });
+
+                            // NTT conversion lazy outputs in [0, 4q); the digits share the tables at key_index, so the
+                            // runs of them before and after the one already in NTT form are transformed together
+                            size_t skipped = in_ntt_form ? get<0>(J) : decomp_modulus_size;
+                            size_t before = min(skipped, decomp_modulus_size);
+                            ntt_negacyclic_harvey_lazy(get<1>(J)[0], before, key_ntt_tables[key_index]);
+                            if (before + 1 < decomp_modulus_size)
+                            {
+                                ntt_negacyclic_harvey_lazy(
+                                    get<1>(J)[before + 1], decomp_modulus_size - before - 1, key_ntt_tables[key_index]);
+                            }
+                        });
+                }
+            }
+
+            apply_galois_hoisted_inplace(result, galois_elt, decomposition_iter, galois_keys, pool);
+        }
+        destinations.swap(results);
+    }
+
+    void Evaluator::apply_galois_hoisted_inplace(
+        Ciphertext &encrypted, uint32_t galois_elt, ConstPolyIter decomposition_iter, const GaloisKeys &galois_keys,
+        MemoryPoolHandle pool) const
+    {
+        auto &parms = context_.get_context_data(encrypted.parms_id())->parms();
+        auto &coeff_modulus = parms.coeff_modulus();
+        auto &key_modulus = context_.key_context_data()->parms().coeff_modulus();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t decomp_modulus_size = coeff_modulus.size();
+        size_t key_modulus_size = key_modulus.size();
+        size_t special_modulus_size = context_.key_context_data()->parms().special_modulus_size();
+        size_t rns_modulus_size = decomp_modulus_size + special_modulus_size;
+        size_t digit_count = divide_round_up(decomp_modulus_size, special_modulus_size);
+        // Use key_context_data where permutation tables exist since previous runs.
+        auto galois_tool = context_.key_context_data()->galois_tool();
+
+        // Check only the used component in GaloisKeys.
+        size_t key_vector_index = GaloisKeys::get_index(galois_elt);
+        if (!is_kswitch_key_valid(galois_keys, key_vector_index, context_))
+        {
+            throw invalid_argument("galois_keys is not valid for encryption parameters");
+        }
+        size_t key_component_count = SEAL_CIPHERTEXT_SIZE_MIN;
+
+        // Apply Galois to encrypted.data(0); encrypted.data(1) is replaced by the key switching product
+        SEAL_ALLOCATE_GET_RNS_ITER(temp, coeff_count, decomp_modulus_size, pool);
+        auto encrypted_iter = iter(encrypted);
+        if (parms.scheme() == scheme_type::bfv)
+        {
+            galois_tool->apply_galois(encrypted_iter[0], decomp_modulus_size, galois_elt, coeff_modulus, temp);
+        }
+        else
+        {
+            galois_tool->apply_galois_ntt(encrypted_iter[0], decomp_modulus_size, galois_elt, temp);
+        }
+        set_poly(temp, coeff_count, decomp_modulus_size, encrypted.data(0));
+        set_zero_poly(coeff_count, decomp_modulus_size, encrypted.data(1));
+
+        // Temporary result
+        auto t_poly_prod(allocate_zero_poly_array(key_component_count, coeff_count, rns_modulus_size, pool));
+
+        // The automorphism is a permutation of NTT coefficients, so each digit of the decomposition of
+        // encrypted.data(1) permuted is a digit of the decomposition of its image
+        parallel_iterate(iter(size_t(0)), rns_modulus_size, digit_count * coeff_count, [&](auto I) {
+            size_t key_index = (I < decomp_modulus_size ? I : key_modulus_size - rns_modulus_size + I);
+            PolyIter t_poly_prod_iter(t_poly_prod.get() + (I * coeff_count), coeff_count, rns_modulus_size);
+            SEAL_ALLOCATE_GET_RNS_ITER(t_digits, coeff_count, digit_count, parallel_pool(pool));
+            vector<const uint64_t *> digits(digit_count);
+            SEAL_ITERATE(iter(size_t(0), t_digits), digit_count, [&](auto J) {
+                galois_tool->apply_galois_ntt(decomposition_iter[I][get<0>(J)], galois_elt, get<1>(J));
+                digits[get<0>(J)] = get<1>(J).ptr();
+            });
+            accumulate_key_products(
+                galois_keys, key_vector_index, digits.data(), digit_count, key_index, key_modulus[key_index],
+                coeff_count, t_poly_prod_iter);
+        });
+
+        // Perform modulus switching with scaling
+        add_key_switching_product_inplace(
+            encrypted, PolyIter(t_poly_prod.get(), coeff_count, rns_modulus_size), key_component_count, pool);
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (encrypted.is_transparent())
+        {
+            throw logic_error("result ciphertext is transparent");
+        }
+#endif
+    }
+
     void Evaluator::switch_key_inplace(
         Ciphertext &encrypted, ConstRNSIter target_iter, const KSwitchKeys &kswitch_keys, size_t kswitch_keys_index,
         MemoryPoolHandle pool) const
@@ -2577,9 +3828,9 @@ namespace seal
         size_t decomp_modulus_size = parms.coeff_modulus().size();
         auto &key_modulus = key_parms.coeff_modulus();
         size_t key_modulus_size = key_modulus.size();
-        size_t rns_modulus_size = decomp_modulus_size + 1;
+        size_t special_modulus_size = key_parms.special_modulus_size();
+        size_t rns_modulus_size = decomp_modulus_size + special_modulus_size;
         auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
-        auto modswitch_factors = key_context_data.rns_tool()->inv_q_last_mod_q();
 
         // Size check
         if (!product_fits_in(coeff_count, rns_modulus_size, size_t(2)))
@@ -2587,18 +3838,12 @@ namespace seal
             throw logic_error("invalid parameters");
         }
 
-        // Prepare input
-        auto &key_vector = kswitch_keys.data()[kswitch_keys_index];
-        size_t key_component_count = key_vector[0].data().size();
-
         // Check only the used component in KSwitchKeys.
-        for (auto &each_key : key_vector)
+        if (!is_kswitch_key_valid(kswitch_keys, kswitch_keys_index, context_))
         {
-            if (!is_metadata_valid_for(each_key, context_) || !is_buffer_valid(each_key))
-            {
-                throw invalid_argument("kswitch_keys is not valid for encryption parameters");
-            }
+            throw invalid_argument("kswitch_keys is not valid for encryption parameters");
         }
+        size_t key_component_count = SEAL_CIPHERTEXT_SIZE_MIN;
 
         // Create a copy of target_iter
         SEAL_ALLOCATE_GET_RNS_ITER(t_target, coeff_count, decomp_modulus_size, pool);
@@ -2613,104 +3858,103 @@ namespace seal
         // Temporary result
         auto t_poly_prod(allocate_zero_poly_array(key_component_count, coeff_count, rns_modulus_size, pool));
 
-        SEAL_ITERATE(iter(size_t(0)), rns_modulus_size, [&](auto I) {
-            size_t key_index = (I == decomp_modulus_size ? key_modulus_size - 1 : I);
+        // Hybrid key switching decomposes target once into digits modulo every prime of the product
+        if (special_modulus_size > 1)
+        {
+            size_t digit_count = divide_round_up(decomp_modulus_size, special_modulus_size);
+            auto decomposition(allocate_poly_array(rns_modulus_size, coeff_count, digit_count, pool));
+            PolyIter decomposition_iter(decomposition.get(), coeff_count, digit_count);
+            decompose_hybrid(context_, parms, target_iter, t_target, decomposition_iter, pool);
 
-            // Product of two numbers is up to 60 + 60 = 120 bits, so we can sum up to 256 of them without reduction.
-            size_t lazy_reduction_summand_bound = size_t(SEAL_MULTIPLY_ACCUMULATE_USER_MOD_MAX);
-            size_t lazy_reduction_counter = lazy_reduction_summand_bound;
+            parallel_iterate(iter(size_t(0)), rns_modulus_size, digit_count * coeff_count, [&](auto I) {
+                size_t key_index = (I < decomp_modulus_size ? I : key_modulus_size - rns_modulus_size + I);
+                PolyIter t_poly_prod_iter(t_poly_prod.get() + (I * coeff_count), coeff_count, rns_modulus_size);
+                vector<const uint64_t *> digits(digit_count);
+                for (size_t J = 0; J < digit_count; J++)
+                {
+                    digits[J] = decomposition_iter[I][J].ptr();
+                }
+                accumulate_key_products(
+                    kswitch_keys, kswitch_keys_index, digits.data(), digit_count, key_index, key_modulus[key_index],
+                    coeff_count, t_poly_prod_iter);
+            });
+            add_key_switching_product_inplace(
+                encrypted, PolyIter(t_poly_prod.get(), coeff_count, rns_modulus_size), key_component_count, pool);
+            return;
+        }
 
-            // Allocate memory for a lazy accumulator (128-bit coefficients)
-            auto t_poly_lazy(allocate_zero_poly_array(key_component_count, coeff_count, 2, pool));
+        // Each output RNS component is independent; they may be computed concurrently. Batching several
+        // ciphertexts per component, so that each part of the key is read once per batch as GPU libraries do, was
+        // no faster: the NTTs dominate, and even an N = 32768 key stays in the last-level cache between ciphertexts
+        parallel_iterate(iter(size_t(0)), rns_modulus_size, decomp_modulus_size * coeff_count, [&](auto I) {
+            size_t key_index = (I == decomp_modulus_size ? key_modulus_size - 1 : I);
 
-            // Semantic misuse of PolyIter; this is really pointing to the data for a single RNS factor
-            PolyIter accumulator_iter(t_poly_lazy.get(), 2, coeff_count);
+            // PolyIter pointing to the destination t_poly_prod, shifted to the appropriate modulus
+            PolyIter t_poly_prod_iter(t_poly_prod.get() + (I * coeff_count), coeff_count, rns_modulus_size);
 
-            // Multiply with keys and perform lazy reduction on product's coefficients
+            // Every digit is converted to the modulus at key_index, so those that need an NTT share its tables
+            // and are transformed together in t_digits
+            SEAL_ALLOCATE_GET_RNS_ITER(t_digits, coeff_count, decomp_modulus_size, parallel_pool(pool));
+            vector<const uint64_t *> digits(decomp_modulus_size);
+            size_t ntt_count = 0;
             SEAL_ITERATE(iter(size_t(0)), decomp_modulus_size, [&](auto J) {
-                SEAL_ALLOCATE_GET_COEFF_ITER(t_ntt, coeff_count, pool);
-                ConstCoeffIter t_operand;
-
                 // RNS-NTT form exists in input
                 if ((scheme == scheme_type::ckks || scheme == scheme_type::bgv) && (I == J))
                 {
-                    t_operand = target_iter[J];
-                }
-                // Perform RNS-NTT conversion
-                else
-                {
-                    // No need to perform RNS conversion (modular reduction)
-                    if (key_modulus[J] <= key_modulus[key_index])
-                    {
-                        set_uint(t_target[J], coeff_count, t_ntt);
-                    }
-                    // Perform RNS conversion (modular reduction)
-                    else
-                    {
-                        modulo_poly_coeffs(t_target[J], coeff_count, key_modulus[key_index], t_ntt);
-                    }
-                    // NTT conversion lazy outputs in [0, 4q)
-                    ntt_negacyclic_harvey_lazy(t_ntt, key_ntt_tables[key_index]);
-                    t_operand = t_ntt;
-                }
-
-                // Multiply with keys and modular accumulate products in a lazy fashion
-                SEAL_ITERATE(iter(key_vector[J].data(), accumulator_iter), key_component_count, [&](auto K) {
-                    if (!lazy_reduction_counter)
-                    {
-                        SEAL_ITERATE(iter(t_operand, get<0>(K)[key_index], get<1>(K)), coeff_count, [&](auto L) {
-                            unsigned long long qword[2]{ 0, 0 };
-                            multiply_uint64(get<0>(L), get<1>(L), qword);
-
-                            // Accumulate product of t_operand and t_key_acc to t_poly_lazy and reduce
-                            add_uint128(qword, get<2>(L).ptr(), qword);
-                            get<2>(L)[0] = barrett_reduce_128(qword, key_modulus[key_index]);
-                            get<2>(L)[1] = 0;
-                        });
-                    }
-                    else
-                    {
-                        // Same as above but no reduction
-                        SEAL_ITERATE(iter(t_operand, get<0>(K)[key_index], get<1>(K)), coeff_count, [&](auto L) {
-                            unsigned long long qword[2]{ 0, 0 };
-                            multiply_uint64(get<0>(L), get<1>(L), qword);
-                            add_uint128(qword, get<2>(L).ptr(), qword);
-                            get<2>(L)[0] = qword[0];
-                            get<2>(L)[1] = qword[1];
-                        });
-                    }
-                });
-
-                if (!--lazy_reduction_counter)
-                {
-                    lazy_reduction_counter = lazy_reduction_summand_bound;
+                    digits[J] = target_iter[J].ptr();
+                    return;
                 }
-            });
 
-            // PolyIter pointing to the destination t_poly_prod, shifted to the appropriate modulus
-            PolyIter t_poly_prod_iter(t_poly_prod.get() + (I * coeff_count), coeff_count, rns_modulus_size);
-
-            // Final modular reduction
-            SEAL_ITERATE(iter(accumulator_iter, t_poly_prod_iter), key_component_count, [&](auto K) {
-                if (lazy_reduction_counter == lazy_reduction_summand_bound)
+                // Perform RNS-NTT conversion
+                CoeffIter t_digit = t_digits[ntt_count++];
+                // No need to perform RNS conversion (modular reduction)
+                if (key_modulus[J] <= key_modulus[key_index])
                 {
-                    SEAL_ITERATE(iter(get<0>(K), *get<1>(K)), coeff_count, [&](auto L) {
-                        get<1>(L) = static_cast<uint64_t>(*get<0>(L));
-                    });
+                    set_uint(t_target[J], coeff_count, t_digit);
                 }
+                // Perform RNS conversion (modular reduction)
                 else
                 {
-                    // Same as above except need to still do reduction
-                    SEAL_ITERATE(iter(get<0>(K), *get<1>(K)), coeff_count, [&](auto L) {
-                        get<1>(L) = barrett_reduce_128(get<0>(L).ptr(), key_modulus[key_index]);
-                    });
+                    modulo_poly_coeffs(t_target[J], coeff_count, key_modulus[key_index], t_digit);
                 }
+                digits[J] = t_digit.ptr();
             });
+            // NTT conversion lazy outputs in [0, 4q)
+            ntt_negacyclic_harvey_lazy(t_digits[0], ntt_count, key_ntt_tables[key_index]);
+
+            accumulate_key_products(
+                kswitch_keys, kswitch_keys_index, digits.data(), decomp_modulus_size, key_index,
+                key_modulus[key_index], coeff_count, t_poly_prod_iter);
         });
         // Accumulated products are now stored in t_poly_prod
 
         // Perform modulus switching with scaling
-        PolyIter t_poly_prod_iter(t_poly_prod.get(), coeff_count, rns_modulus_size);
+        add_key_switching_product_inplace(
+            encrypted, PolyIter(t_poly_prod.get(), coeff_count, rns_modulus_size), key_component_count, pool);
+    }
+
+    void Evaluator::add_key_switching_product_inplace(
+        Ciphertext &encrypted, PolyIter t_poly_prod_iter, size_t key_component_count, MemoryPoolHandle pool) const
+    {
+        // Every key switch, hoisted or not, ends here
+        SEAL_COUNT_OPERATION(key_switch_count, 1);
+
+        auto &parms = context_.get_context_data(encrypted.parms_id())->parms();
+        auto &key_context_data = *context_.key_context_data();
+        auto scheme = parms.scheme();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t decomp_modulus_size = parms.coeff_modulus().size();
+        auto &key_modulus = key_context_data.parms().coeff_modulus();
+        size_t key_modulus_size = key_modulus.size();
+        auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
+        auto modswitch_factors = key_context_data.rns_tool()->inv_q_last_mod_q();
+
+        if (key_context_data.parms().special_modulus_size() > 1)
+        {
+            mod_down_hybrid(context_, encrypted, t_poly_prod_iter, key_component_count, pool);
+            return;
+        }
+
         SEAL_ITERATE(iter(encrypted, t_poly_prod_iter), key_component_count, [&](auto I) {
             if (scheme == scheme_type::bgv)
             {
@@ -2769,52 +4013,55 @@ namespace seal
                     J = barrett_reduce_64(J + qk_half, key_modulus[key_modulus_size - 1]);
                 });
 
-                SEAL_ITERATE(iter(I, key_modulus, key_ntt_tables, modswitch_factors), decomp_modulus_size, [&](auto J) {
-                    SEAL_ALLOCATE_GET_COEFF_ITER(t_ntt, coeff_count, pool);
-
-                    // (ct mod 4qk) mod qi
-                    uint64_t qi = get<1>(J).value();
-                    if (qk > qi)
-                    {
-                        // This cannot be spared. NTT only tolerates input that is less than 4*modulus (i.e. qk <=4*qi).
-                        modulo_poly_coeffs(t_last, coeff_count, get<1>(J), t_ntt);
-                    }
-                    else
-                    {
-                        set_uint(t_last, coeff_count, t_ntt);
-                    }
-
-                    // Lazy substraction, results in [0, 2*qi), since fix is in [0, qi].
-                    uint64_t fix = qi - barrett_reduce_64(qk_half, get<1>(J));
-                    SEAL_ITERATE(t_ntt, coeff_count, [fix](auto &K) { K += fix; });
-
-                    uint64_t qi_lazy = qi << 1; // some multiples of qi
-                    if (scheme == scheme_type::ckks)
-                    {
-                        // This ntt_negacyclic_harvey_lazy results in [0, 4*qi).
-                        ntt_negacyclic_harvey_lazy(t_ntt, get<2>(J));
+                parallel_iterate(
+                    iter(I, key_modulus, key_ntt_tables, modswitch_factors), decomp_modulus_size, coeff_count,
+                    [&](auto J) {
+                        SEAL_ALLOCATE_GET_COEFF_ITER(t_ntt, coeff_count, parallel_pool(pool));
+
+                        // (ct mod 4qk) mod qi
+                        uint64_t qi = get<1>(J).value();
+                        if (qk > qi)
+                        {
+                            // This cannot be spared. NTT only tolerates input that is less than 4*modulus (i.e.
+                            // qk <=4*qi).
+                            modulo_poly_coeffs(t_last, coeff_count, get<1>(J), t_ntt);
+                        }
+                        else
+                        {
+                            set_uint(t_last, coeff_count, t_ntt);
+                        }
+
+                        // Lazy substraction, results in [0, 2*qi), since fix is in [0, qi].
+                        uint64_t fix = qi - barrett_reduce_64(qk_half, get<1>(J));
+                        SEAL_ITERATE(t_ntt, coeff_count, [fix](auto &K) { K += fix; });
+
+                        uint64_t qi_lazy = qi << 1; // some multiples of qi
+                        if (scheme == scheme_type::ckks)
+                        {
+                            // This ntt_negacyclic_harvey_lazy results in [0, 4*qi).
+                            ntt_negacyclic_harvey_lazy(t_ntt, get<2>(J));
 #if SEAL_USER_MOD_BIT_COUNT_MAX > 60
-                        // Reduce from [0, 4qi) to [0, 2qi)
-                        SEAL_ITERATE(
-                            t_ntt, coeff_count, [&](auto &K) { K -= SEAL_COND_SELECT(K >= qi_lazy, qi_lazy, 0); });
+                            // Reduce from [0, 4qi) to [0, 2qi)
+                            SEAL_ITERATE(
+                                t_ntt, coeff_count, [&](auto &K) { K -= SEAL_COND_SELECT(K >= qi_lazy, qi_lazy, 0); });
 #else
-                        // Since SEAL uses at most 60bit moduli, 8*qi < 2^63.
-                        qi_lazy = qi << 2;
+                            // Since SEAL uses at most 60bit moduli, 8*qi < 2^63.
+                            qi_lazy = qi << 2;
 #endif
-                    }
-                    else if (scheme == scheme_type::bfv)
-                    {
-                        inverse_ntt_negacyclic_harvey_lazy(get<0, 1>(J), get<2>(J));
-                    }
+                        }
+                        else if (scheme == scheme_type::bfv)
+                        {
+                            inverse_ntt_negacyclic_harvey_lazy(get<0, 1>(J), get<2>(J));
+                        }
 
-                    // ((ct mod qi) - (ct mod qk)) mod qi with output in [0, 2 * qi_lazy)
-                    SEAL_ITERATE(
-                        iter(get<0, 1>(J), t_ntt), coeff_count, [&](auto K) { get<0>(K) += qi_lazy - get<1>(K); });
+                        // ((ct mod qi) - (ct mod qk)) mod qi with output in [0, 2 * qi_lazy)
+                        SEAL_ITERATE(
+                            iter(get<0, 1>(J), t_ntt), coeff_count, [&](auto K) { get<0>(K) += qi_lazy - get<1>(K); });
 
-                    // qk^(-1) * ((ct mod qi) - (ct mod qk)) mod qi
-                    multiply_poly_scalar_coeffmod(get<0, 1>(J), coeff_count, get<3>(J), get<1>(J), get<0, 1>(J));
-                    add_poly_coeffmod(get<0, 1>(J), get<0, 0>(J), coeff_count, get<1>(J), get<0, 0>(J));
-                });
+                        // qk^(-1) * ((ct mod qi) - (ct mod qk)) mod qi
+                        multiply_poly_scalar_coeffmod(get<0, 1>(J), coeff_count, get<3>(J), get<1>(J), get<0, 1>(J));
+                        add_poly_coeffmod(get<0, 1>(J), get<0, 0>(J), coeff_count, get<1>(J), get<0, 0>(J));
+                    });
             }
         });
     }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "seal/ciphertext.h"
+#include "seal/ciphertextbatch.h"
 #include "seal/context.h"
 #include "seal/galoiskeys.h"
 #include "seal/memorymanager.h"
@@ -157,6 +158,85 @@ namespace seal
         */
         void add_many(const std::vector<Ciphertext> &encrypteds, Ciphertext &destination) const;
 
+        /**
+        Adds together count ciphertexts given by pointer and stores the result in the destination parameter. This is
+        the same as the vector overload but lets callers sum ciphertexts they do not hold contiguously.
+
+        When all ciphertexts have the same size (and in BGV the same correction factor), each coefficient is summed
+        in a single pass with lazy modular reduction, which reads every input once and writes the result once;
+        otherwise the ciphertexts are added one by one.
+
+        @param[in] encrypteds Pointers to the ciphertexts to add
+        @param[in] count The number of ciphertexts
+        @param[out] destination The ciphertext to overwrite with the addition result
+        @throws std::invalid_argument if encrypteds is null or count is zero
+        @throws std::invalid_argument if encrypteds are not valid for the encryption
+        parameters
+        @throws std::invalid_argument if encrypteds are in different NTT forms
+        @throws std::invalid_argument if encrypteds are at different level or scale
+        @throws std::invalid_argument if destination is one of encrypteds
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void add_many(const Ciphertext *const *encrypteds, std::size_t count, Ciphertext &destination) const;
+
+        /**
+        Adds all ciphertexts of a batch together and stores the result in the destination parameter, as add_many
+        does for ciphertexts held separately. Each RNS component is summed with lazy modular reduction over the
+        batch's contiguous storage.
+
+        @param[in] batch The ciphertexts to add
+        @param[out] destination The ciphertext to overwrite with the addition result
+        @throws std::invalid_argument if batch is empty
+        @throws std::invalid_argument if batch is not valid for the encryption parameters
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void add_many(const CiphertextBatch &batch, Ciphertext &destination) const;
+
+        /**
+        Adds the ciphertexts of batch2 to those of batch1 one by one and stores the results in batch1. Every RNS
+        component of the whole batch is added in one pass over contiguous memory.
+
+        @param[in] batch1 The first ciphertexts to add, overwritten with the sums
+        @param[in] batch2 The second ciphertexts to add
+        @throws std::invalid_argument if batch1 or batch2 is not valid for the encryption parameters
+        @throws std::invalid_argument if batch1 and batch2 differ in count, parms_id, size, NTT form, scale or
+        correction factor
+        */
+        void add_inplace(CiphertextBatch &batch1, const CiphertextBatch &batch2) const;
+
+        /**
+        Multiplies every ciphertext of a batch in NTT form with the same plaintext in NTT form, as
+        multiply_plain_inplace does for one ciphertext. Each RNS component of the plaintext is read once for the
+        whole batch.
+
+        @param[in] batch The ciphertexts to multiply, in NTT form
+        @param[in] plain_ntt The plaintext to multiply with, in NTT form at the batch's parms_id
+        @throws std::invalid_argument if batch is not valid for the encryption parameters
+        @throws std::invalid_argument if batch or plain_ntt is not in NTT form
+        @throws std::invalid_argument if plain_ntt is not at the batch's parms_id
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        */
+        void multiply_plain_inplace(CiphertextBatch &batch, const Plaintext &plain_ntt) const;
+
+        /**
+        Transforms every ciphertext of a batch to NTT domain. The NTT tables of each RNS component are used for
+        all of the batch's polynomials in turn.
+
+        @param[in] batch The ciphertexts to transform
+        @throws std::invalid_argument if batch is not valid for the encryption parameters
+        @throws std::invalid_argument if batch is already in NTT form
+        */
+        void transform_to_ntt_inplace(CiphertextBatch &batch) const;
+
+        /**
+        Transforms every ciphertext of a batch back from NTT domain.
+
+        @param[in] batch_ntt The ciphertexts to transform
+        @throws std::invalid_argument if batch_ntt is not valid for the encryption parameters
+        @throws std::invalid_argument if batch_ntt is not in NTT form
+        */
+        void transform_from_ntt_inplace(CiphertextBatch &batch_ntt) const;
+
         /**
         Subtracts two ciphertexts. This function computes the difference of encrypted1 and encrypted2, and stores the
         result in encrypted1.
@@ -664,6 +744,10 @@ namespace seal
         relinearization the given relinearization keys are used. Dynamic memory allocations in the process are allocated
         from the memory pool pointed to by the given MemoryPoolHandle.
 
+        The products at each level of the product tree are independent and run concurrently when an executor is set
+        with ParallelExecution::SetExecutor, so the latency is that of ceil(log2(encrypteds.size())) multiplications
+        given enough threads.
+
         @param[in] encrypteds The ciphertexts to multiply
         @param[in] relin_keys The relinearization keys
         @param[out] destination The ciphertext to overwrite with the multiplication result
@@ -688,6 +772,10 @@ namespace seal
         in a depth-optimal order, and relinearization is performed automatically after every multiplication in the
         process. In relinearization the given relinearization keys are used.
 
+        The power is computed by repeated squaring in about 2 log2(exponent) multiplications; when an executor is set
+        with ParallelExecution::SetExecutor, each squaring runs concurrently with the multiplication that folds the
+        previous power into the result.
+
         @param[in] encrypted The ciphertext to exponentiate
         @param[in] exponent The power to raise the ciphertext to
         @param[in] relin_keys The relinearization keys
@@ -850,6 +938,143 @@ namespace seal
             multiply_plain_inplace(destination, plain, std::move(pool));
         }
 
+        /**
+        Multiplies a ciphertext in NTT form with a plaintext in NTT form and adds the product to destination. Each
+        coefficient of the product is added as it is formed, so no temporary ciphertext is written and read back as
+        with multiply_plain followed by add_inplace. A destination with fewer polynomials than encrypted is extended
+        with zeros first. In BGV, if the correction factors differ, the product is formed and added by add_inplace.
+        Dynamic memory allocations in that case are allocated from the memory pool pointed to by the given
+        MemoryPoolHandle.
+
+        @param[in] destination The ciphertext to add the product to, in NTT form at the level of encrypted and at
+        the scale of the product
+        @param[in] encrypted The ciphertext to multiply, in NTT form
+        @param[in] plain_ntt The plaintext to multiply, in NTT form at the level of encrypted
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if destination, encrypted or plain_ntt is not valid for the encryption
+        parameters
+        @throws std::invalid_argument if destination, encrypted or plain_ntt is not in NTT form
+        @throws std::invalid_argument if destination, encrypted and plain_ntt are at different levels
+        @throws std::invalid_argument if the scale of destination is not that of the product
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void multiply_plain_accumulate(
+            Ciphertext &destination, const Ciphertext &encrypted, const Plaintext &plain_ntt,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Computes the sum of the products of count ciphertexts in NTT form with as many plaintexts in NTT form, the
+        k-way form of multiply_plain_accumulate, and stores it in the destination parameter. When all ciphertexts
+        have the same size and correction factor, every RNS component is summed a block of coefficients at a time
+        with lazy modular reduction, so each ciphertext and plaintext is read once and the result is written once;
+        otherwise the products are accumulated one by one, with dynamic memory allocations from the memory pool
+        pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypteds Pointers to the ciphertexts to multiply, in NTT form
+        @param[in] plains_ntt Pointers to the plaintexts to multiply, in NTT form at the level of the ciphertexts
+        @param[in] count The number of products
+        @param[out] destination The ciphertext to overwrite with the sum of the products
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypteds or plains_ntt is null or count is zero
+        @throws std::invalid_argument if encrypteds or plains_ntt are not valid for the encryption parameters
+        @throws std::invalid_argument if encrypteds or plains_ntt are not in NTT form
+        @throws std::invalid_argument if encrypteds and plains_ntt are at different levels
+        @throws std::invalid_argument if the products have different scales
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if destination is one of encrypteds
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void multiply_plain_add_many(
+            const Ciphertext *const *encrypteds, const Plaintext *const *plains_ntt, std::size_t count,
+            Ciphertext &destination, MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Computes the sum of the products of a vector of ciphertexts in NTT form with a vector of plaintexts in NTT
+        form of the same length and stores it in the destination parameter, as the pointer overload does.
+
+        @param[in] encrypteds The ciphertexts to multiply, in NTT form
+        @param[in] plains_ntt The plaintexts to multiply, in NTT form at the level of the ciphertexts
+        @param[out] destination The ciphertext to overwrite with the sum of the products
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypteds is empty or plains_ntt has a different length
+        @throws std::invalid_argument if encrypteds or plains_ntt are not valid for the encryption parameters
+        @throws std::invalid_argument if encrypteds or plains_ntt are not in NTT form
+        @throws std::invalid_argument if encrypteds and plains_ntt are at different levels
+        @throws std::invalid_argument if the products have different scales
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if destination is one of encrypteds
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void multiply_plain_add_many(
+            const std::vector<Ciphertext> &encrypteds, const std::vector<Plaintext> &plains_ntt,
+            Ciphertext &destination, MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Multiplies every slot of a BFV or BGV ciphertext by the same integer, taken modulo the plain modulus. This
+        gives the same result as multiply_plain with a batched plaintext holding scalar in every slot, which is the
+        constant polynomial scalar, but needs neither an encoding nor an NTT: each RNS component is multiplied by
+        scalar lifted to its prime, in coefficient or NTT form alike.
+
+        @param[in] encrypted The ciphertext to multiply
+        @param[in] scalar The integer to multiply by
+        @throws std::invalid_argument if encrypted is not valid for the encryption parameters
+        @throws std::invalid_argument if the scheme is not BFV or BGV
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void multiply_scalar_inplace(Ciphertext &encrypted, std::uint64_t scalar) const;
+
+        /**
+        Multiplies every slot of a BFV or BGV ciphertext by the same integer and stores the result in the
+        destination parameter, as multiply_scalar_inplace does.
+
+        @param[in] encrypted The ciphertext to multiply
+        @param[in] scalar The integer to multiply by
+        @param[out] destination The ciphertext to overwrite with the multiplication result
+        @throws std::invalid_argument if encrypted is not valid for the encryption parameters
+        @throws std::invalid_argument if the scheme is not BFV or BGV
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void multiply_scalar(const Ciphertext &encrypted, std::uint64_t scalar, Ciphertext &destination) const
+        {
+            destination = encrypted;
+            multiply_scalar_inplace(destination, scalar);
+        }
+
+        /**
+        Adds the same integer, taken modulo the plain modulus, to every slot of a BFV or BGV ciphertext. This gives
+        the same result as add_plain with a batched plaintext holding scalar in every slot, but without encoding it:
+        the scaled constant is added to one coefficient of each RNS component in coefficient form, or to every
+        coefficient in NTT form, where a constant polynomial has the same value at every point.
+
+        @param[in] encrypted The ciphertext to add to
+        @param[in] scalar The integer to add
+        @throws std::invalid_argument if encrypted is not valid for the encryption parameters
+        @throws std::invalid_argument if the scheme is not BFV or BGV
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void add_scalar_inplace(Ciphertext &encrypted, std::uint64_t scalar) const;
+
+        /**
+        Adds the same integer to every slot of a BFV or BGV ciphertext and stores the result in the destination
+        parameter, as add_scalar_inplace does.
+
+        @param[in] encrypted The ciphertext to add to
+        @param[in] scalar The integer to add
+        @param[out] destination The ciphertext to overwrite with the addition result
+        @throws std::invalid_argument if encrypted is not valid for the encryption parameters
+        @throws std::invalid_argument if the scheme is not BFV or BGV
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void add_scalar(const Ciphertext &encrypted, std::uint64_t scalar, Ciphertext &destination) const
+        {
+            destination = encrypted;
+            add_scalar_inplace(destination, scalar);
+        }
+
         /**
         Transforms a plaintext to NTT domain. This functions applies the Number Theoretic Transform to a plaintext by
         first embedding integers modulo the plaintext modulus to integers modulo the coefficient modulus and then
@@ -1292,6 +1517,37 @@ namespace seal
             complex_conjugate_inplace(destination, galois_keys, std::move(pool));
         }
 
+        /**
+        Rotates a ciphertext by several numbers of steps at once, as rotate_rows does for the BFV/BGV scheme and
+        rotate_vector for the CKKS scheme. The RNS decomposition of encrypted and its NTTs, which dominate the cost of
+        key switching, are computed once and shared by all steps that have Galois keys of their own; every such
+        rotation then only costs a permutation, the products with its key and the final modulus switch. Other steps
+        are composed from several rotations as in rotate_rows. The results decrypt to the same values as those of
+        rotate_rows or rotate_vector. Dynamic memory allocations in the process are allocated from the memory pool
+        pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to rotate
+        @param[in] steps The numbers of steps to rotate (positive left, negative right)
+        @param[in] galois_keys The Galois keys
+        @param[out] destinations The ciphertexts to overwrite with the rotated results, one for each entry of steps
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if the encryption parameters do not support batching
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if some step has too big absolute value
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void rotate_many(
+            const Ciphertext &encrypted, const std::vector<int> &steps, const GaloisKeys &galois_keys,
+            std::vector<Ciphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
         /**
         Enables access to private members of seal::Evaluator for SEAL_C.
         */
@@ -1322,6 +1578,11 @@ namespace seal
             Ciphertext &encrypted, const RelinKeys &relin_keys, std::size_t destination_size,
             MemoryPoolHandle pool) const;
 
+        // One node of multiply_many and exponentiate_inplace; squares if both operands are the same ciphertext
+        void multiply_relinearize(
+            const Ciphertext &encrypted1, const Ciphertext &encrypted2, const RelinKeys &relin_keys,
+            Ciphertext &destination, MemoryPoolHandle pool) const;
+
         void mod_switch_scale_to_next(
             const Ciphertext &encrypted, Ciphertext &destination, MemoryPoolHandle pool) const;
 
@@ -1359,6 +1620,14 @@ namespace seal
             Ciphertext &encrypted, util::ConstRNSIter target_iter, const KSwitchKeys &kswitch_keys,
             std::size_t key_index, MemoryPoolHandle pool = MemoryManager::GetPool()) const;
 
+        void apply_galois_hoisted_inplace(
+            Ciphertext &encrypted, std::uint32_t galois_elt, util::ConstPolyIter decomposition_iter,
+            const GaloisKeys &galois_keys, MemoryPoolHandle pool) const;
+
+        void add_key_switching_product_inplace(
+            Ciphertext &encrypted, util::PolyIter t_poly_prod_iter, std::size_t key_component_count,
+            MemoryPoolHandle pool) const;
+
         void multiply_plain_normal(Ciphertext &encrypted, const Plaintext &plain, MemoryPoolHandle pool) const;
 
         void multiply_plain_ntt(Ciphertext &encrypted_ntt, const Plaintext &plain_ntt) const;
@@ -6,6 +6,7 @@
 #include "seal/util/common.h"
 #include "seal/util/galois.h"
 #include "seal/util/ntt.h"
+#include "seal/util/parallel.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/polycore.h"
 #include "seal/util/rlwe.h"
@@ -187,6 +188,7 @@ namespace seal
         // The max number of keys is equal to number of coefficients
         galois_keys.data().resize(coeff_count);
 
+        vector<uint32_t> new_elts;
         for (auto galois_elt : galois_elts)
         {
             // Verify coprime conditions.
@@ -196,23 +198,40 @@ namespace seal
             }
 
             // Do we already have the key?
-            if (galois_keys.has_key(galois_elt))
+            if (find(new_elts.begin(), new_elts.end(), galois_elt) == new_elts.end())
             {
-                continue;
+                new_elts.push_back(galois_elt);
             }
+        }
+        if (!new_elts.empty() && !context_.using_keyswitching())
+        {
+            throw logic_error("keyswitching is not supported by the context");
+        }
 
-            // Rotate secret key for each coeff_modulus
-            SEAL_ALLOCATE_GET_RNS_ITER(rotated_secret_key, coeff_count, coeff_modulus_size, pool_);
-            RNSIter secret_key(secret_key_.data().data(), coeff_count);
-            galois_tool->apply_galois_ntt(secret_key, coeff_modulus_size, galois_elt, rotated_secret_key);
-
-            // Initialize Galois key
-            // This is the location in the galois_keys vector
-            size_t index = GaloisKeys::get_index(galois_elt);
-
-            // Create Galois keys.
-            generate_one_kswitch_key(rotated_secret_key, galois_keys.data()[index], save_seed);
+        // Every component of every key is one work item: the secret key's RNS component rotated by the Galois
+        // element, then encrypted into the key. The items are independent, so they run concurrently on the
+        // ParallelExecution executor when there is one; each encryption draws its own randomness, so the keys do
+        // not depend on the order the items run in
+        size_t decomp_mod_count = context_.key_switch_digit_count();
+        size_t data_modulus_size = context_.first_context_data()->parms().coeff_modulus().size();
+        size_t digit_size = parms.special_modulus_size();
+        for (auto galois_elt : new_elts)
+        {
+            galois_keys.data()[GaloisKeys::get_index(galois_elt)].resize(decomp_mod_count);
         }
+        size_t item_count = new_elts.size() * decomp_mod_count;
+        parallel_for(item_count, parallel_task_count(item_count), [&](size_t item) {
+            uint32_t galois_elt = new_elts[item / decomp_mod_count];
+            size_t j = item % decomp_mod_count;
+            size_t first = j * digit_size;
+            size_t count = min(digit_size, data_modulus_size - first);
+            auto pool = parallel_pool(pool_);
+            SEAL_ALLOCATE_GET_RNS_ITER(rotated_secret_key, coeff_count, count, pool);
+            ConstRNSIter secret_key(secret_key_.data().data() + first * coeff_count, coeff_count);
+            galois_tool->apply_galois_ntt(secret_key, count, galois_elt, rotated_secret_key);
+            generate_kswitch_key_component(
+                rotated_secret_key, j, galois_keys.data()[GaloisKeys::get_index(galois_elt)][j], save_seed, pool);
+        });
 
         // Set the parms_id
         galois_keys.parms_id_ = context_data.parms_id();
@@ -298,39 +317,33 @@ namespace seal
         secret_key_array_.acquire(secret_key_array);
     }
 
-    void KeyGenerator::generate_one_kswitch_key(ConstRNSIter new_key, vector<PublicKey> &destination, bool save_seed)
+    void KeyGenerator::generate_kswitch_key_component(
+        ConstRNSIter new_key_j, size_t j, PublicKey &destination, bool save_seed, MemoryPoolHandle pool) const
     {
-        if (!context_.using_keyswitching())
-        {
-            throw logic_error("keyswitching is not supported by the context");
-        }
-
         size_t coeff_count = context_.key_context_data()->parms().poly_modulus_degree();
-        size_t decomp_mod_count = context_.first_context_data()->parms().coeff_modulus().size();
         auto &key_context_data = *context_.key_context_data();
-        auto &key_parms = key_context_data.parms();
-        auto &key_modulus = key_parms.coeff_modulus();
-
-        // Size check
-        if (!product_fits_in(coeff_count, decomp_mod_count))
+        auto &key_modulus = key_context_data.parms().coeff_modulus();
+        size_t special_modulus_size = key_context_data.parms().special_modulus_size();
+        size_t data_modulus_size = key_modulus.size() - special_modulus_size;
+        size_t first = j * special_modulus_size;
+        size_t count = min(special_modulus_size, data_modulus_size - first);
+
+        SEAL_ALLOCATE_GET_COEFF_ITER(temp, coeff_count, pool);
+        encrypt_zero_symmetric(secret_key_, context_, key_context_data.parms_id(), true, save_seed, destination.data());
+
+        // The digit's RNS factors of the first destination polynomial
+        RNSIter destination_iter = (*iter(destination.data()));
+        for (size_t i = 0; i < count; i++)
         {
-            throw logic_error("invalid parameters");
+            const Modulus &modulus = key_modulus[first + i];
+            uint64_t factor = 1;
+            for (size_t k = data_modulus_size; k < key_modulus.size(); k++)
+            {
+                factor = multiply_uint_mod(factor, barrett_reduce_64(key_modulus[k].value(), modulus), modulus);
+            }
+            multiply_poly_scalar_coeffmod(new_key_j[i], coeff_count, factor, modulus, temp);
+            add_poly_coeffmod(destination_iter[first + i], temp, coeff_count, modulus, destination_iter[first + i]);
         }
-
-        // KSwitchKeys data allocated from pool given by MemoryManager::GetPool.
-        destination.resize(decomp_mod_count);
-
-        SEAL_ITERATE(iter(new_key, key_modulus, destination, size_t(0)), decomp_mod_count, [&](auto I) {
-            SEAL_ALLOCATE_GET_COEFF_ITER(temp, coeff_count, pool_);
-            encrypt_zero_symmetric(
-                secret_key_, context_, key_context_data.parms_id(), true, save_seed, get<2>(I).data());
-            uint64_t factor = barrett_reduce_64(key_modulus.back().value(), get<1>(I));
-            multiply_poly_scalar_coeffmod(get<0>(I), coeff_count, factor, get<1>(I), temp);
-
-            // We use the SeqIter at get<3>(I) to find the i-th RNS factor of the first destination polynomial.
-            CoeffIter destination_iter = (*iter(get<2>(I).data()))[get<3>(I)];
-            add_poly_coeffmod(destination_iter, temp, coeff_count, get<1>(I), destination_iter);
-        });
     }
 
     void KeyGenerator::generate_kswitch_keys(
@@ -356,9 +369,31 @@ namespace seal
             throw invalid_argument("iterator is incompatible with encryption parameters");
         }
 #endif
+        if (!context_.using_keyswitching())
+        {
+            throw logic_error("keyswitching is not supported by the context");
+        }
+        size_t decomp_mod_count = context_.key_switch_digit_count();
+        size_t digit_size = key_parms.special_modulus_size();
+
+        // Size check
+        if (!product_fits_in(coeff_count, decomp_mod_count))
+        {
+            throw logic_error("invalid parameters");
+        }
+
+        // One work item per component of every key, as in create_galois_keys
         destination.data().resize(num_keys);
-        SEAL_ITERATE(iter(new_keys, destination.data()), num_keys, [&](auto I) {
-            this->generate_one_kswitch_key(get<0>(I), get<1>(I), save_seed);
+        for (auto &key : destination.data())
+        {
+            key.resize(decomp_mod_count);
+        }
+        size_t item_count = num_keys * decomp_mod_count;
+        parallel_for(item_count, parallel_task_count(item_count), [&](size_t item) {
+            size_t j = item % decomp_mod_count;
+            ConstRNSIter new_key_j(new_keys[item / decomp_mod_count][j * digit_size].ptr(), coeff_count);
+            generate_kswitch_key_component(
+                new_key_j, j, destination.data()[item / decomp_mod_count][j], save_seed, parallel_pool(pool_));
         });
     }
 } // namespace seal
@@ -327,10 +327,14 @@ namespace seal
             util::ConstPolyIter new_keys, std::size_t num_keys, KSwitchKeys &destination, bool save_seed = false);
 
         /**
-        Generates one key switching key for a new key.
+        Generates component j of a key switching key from the RNS components of the new key in decomposition digit j
+        (new_key_j holds just those): an encryption of zero, plus the new key times the product of the special
+        primes in each of those components. Components are independent of each other, so they may be generated
+        concurrently (with pool from util::parallel_pool).
         */
-        void generate_one_kswitch_key(
-            util::ConstRNSIter new_key, std::vector<PublicKey> &destination, bool save_seed = false);
+        void generate_kswitch_key_component(
+            util::ConstRNSIter new_key_j, std::size_t j, PublicKey &destination, bool save_seed,
+            MemoryPoolHandle pool) const;
 
         /**
         Generates and returns the specified number of relinearization keys.
@@ -373,7 +377,7 @@ namespace seal
 
         util::Pointer<std::uint64_t> secret_key_array_;
 
-        mutable util::ReaderWriterLocker secret_key_array_locker_;
+        mutable util::ReaderWriterLocker secret_key_array_locker_{ util::LockSite::secret_key };
 
         bool sk_generated_ = false;
     };
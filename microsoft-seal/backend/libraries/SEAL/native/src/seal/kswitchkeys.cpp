@@ -2,6 +2,8 @@
 // Licensed under the MIT license.
 
 #include "seal/kswitchkeys.h"
+#include "seal/util/common.h"
+#include <algorithm>
 #include <stdexcept>
 
 using namespace std;
@@ -35,10 +37,174 @@ namespace seal
                 keys_[i][j] = assign.keys_[i][j];
             }
         }
+        compact_ = assign.compact_;
 
         return *this;
     }
 
+    void KSwitchKeys::compact(const SEALContext &context)
+    {
+        if (size() == 0)
+        {
+            return;
+        }
+        if (!context.parameters_set() || parms_id_ != context.key_parms_id())
+        {
+            throw invalid_argument("keys are not valid for encryption parameters");
+        }
+        auto &key_modulus = context.key_context_data()->parms().coeff_modulus();
+        size_t coeff_count = context.key_context_data()->parms().poly_modulus_degree();
+        size_t key_modulus_size = key_modulus.size();
+        vector<bool> narrow(key_modulus_size);
+        vector<size_t> rank(key_modulus_size);
+        size_t narrow_count = 0;
+        for (size_t limb = 0; limb < key_modulus_size; limb++)
+        {
+            narrow[limb] = key_modulus[limb].bit_count() <= 32;
+            rank[limb] = narrow[limb] ? narrow_count++ : limb - narrow_count;
+        }
+        if (!narrow_count)
+        {
+            return;
+        }
+        size_t wide_count = key_modulus_size - narrow_count;
+
+        compact_.resize(keys_.size());
+        for (size_t index = 0; index < keys_.size(); index++)
+        {
+            auto &key_vector = keys_[index];
+            if (key_vector.empty() || is_compact(index))
+            {
+                continue;
+            }
+            for (auto &key : key_vector)
+            {
+                if (!is_metadata_valid_for(key, context) || !is_buffer_valid(key))
+                {
+                    throw invalid_argument("keys are not valid for encryption parameters");
+                }
+            }
+
+            CompactKey compact_key;
+            compact_key.coeff_count_ = coeff_count;
+            compact_key.component_count_ = key_vector[0].data().size();
+            compact_key.narrow_count_ = narrow_count;
+            compact_key.narrow_ = narrow;
+            compact_key.rank_ = rank;
+            size_t limb_count = mul_safe(key_vector.size(), compact_key.component_count_, coeff_count);
+            compact_key.narrow_data_ = DynArray<uint32_t>(mul_safe(limb_count, narrow_count), pool_);
+            compact_key.wide_data_ = DynArray<uint64_t>(mul_safe(limb_count, wide_count), pool_);
+            for (size_t digit = 0; digit < key_vector.size(); digit++)
+            {
+                for (size_t component = 0; component < compact_key.component_count_; component++)
+                {
+                    const uint64_t *source = key_vector[digit].data().data(component);
+                    for (size_t limb = 0; limb < key_modulus_size; limb++, source += coeff_count)
+                    {
+                        if (narrow[limb])
+                        {
+                            auto destination = const_cast<uint32_t *>(compact_key.narrow_limb(digit, component, limb));
+                            transform(source, source + coeff_count, destination, [](uint64_t coeff) {
+                                return static_cast<uint32_t>(coeff);
+                            });
+                        }
+                        else
+                        {
+                            copy_n(
+                                source, coeff_count,
+                                const_cast<uint64_t *>(compact_key.wide_limb(digit, component, limb)));
+                        }
+                    }
+                }
+            }
+            compact_[index] = move(compact_key);
+
+            // Keep each key's metadata only: its data is released to the pool
+            for (auto &key : key_vector)
+            {
+                key.pk_.resize(0);
+                Ciphertext metadata(pool_);
+                metadata = key.pk_;
+                key.pk_ = move(metadata);
+            }
+        }
+    }
+
+    void KSwitchKeys::expand()
+    {
+        for (size_t index = 0; index < keys_.size(); index++)
+        {
+            if (is_compact(index))
+            {
+                keys_[index] = expanded_key(index);
+            }
+        }
+        compact_.clear();
+    }
+
+    vector<PublicKey> KSwitchKeys::expanded_key(size_t index) const
+    {
+        auto &key_vector = data(index);
+        if (!is_compact(index))
+        {
+            return key_vector;
+        }
+        auto &compact_key = compact_[index];
+        vector<PublicKey> result;
+        result.reserve(key_vector.size());
+        for (size_t digit = 0; digit < key_vector.size(); digit++)
+        {
+            result.emplace_back(PublicKey(pool_));
+            result.back() = key_vector[digit];
+            Ciphertext &key = result.back().pk_;
+            key.resize(SEAL_CIPHERTEXT_SIZE_MIN);
+            size_t coeff_count = compact_key.coeff_count_;
+            for (size_t component = 0; component < compact_key.component_count_; component++)
+            {
+                uint64_t *destination = key.data(component);
+                for (size_t limb = 0; limb < compact_key.narrow_.size(); limb++, destination += coeff_count)
+                {
+                    if (compact_key.narrow_[limb])
+                    {
+                        copy_n(compact_key.narrow_limb(digit, component, limb), coeff_count, destination);
+                    }
+                    else
+                    {
+                        copy_n(compact_key.wide_limb(digit, component, limb), coeff_count, destination);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    size_t KSwitchKeys::data_bytes() const noexcept
+    {
+        size_t bytes = 0;
+        for (size_t index = 0; index < keys_.size(); index++)
+        {
+            if (is_compact(index))
+            {
+                bytes += compact_[index].data_bytes();
+                continue;
+            }
+            for (auto &key : keys_[index])
+            {
+                bytes += key.data().dyn_array().size() * sizeof(uint64_t);
+            }
+        }
+        return bytes;
+    }
+
+    streamoff KSwitchKeys::expanded_save_size(const PublicKey &key)
+    {
+        // Uncompressed, only the data grows: SEAL_CIPHERTEXT_SIZE_MIN polynomials of every limb
+        size_t data_bytes = mul_safe(
+            size_t(SEAL_CIPHERTEXT_SIZE_MIN), key.data().poly_modulus_degree(), key.data().coeff_modulus_size(),
+            sizeof(uint64_t));
+        return add_safe(key.save_size(compr_mode_type::none), safe_cast<streamoff>(data_bytes));
+    }
+
     void KSwitchKeys::save_members(ostream &stream) const
     {
         auto old_except_mask = stream.exceptions();
@@ -62,7 +228,15 @@ namespace seal
                 uint64_t keys_dim2 = static_cast<uint64_t>(keys_[index].size());
                 stream.write(reinterpret_cast<const char *>(&keys_dim2), sizeof(uint64_t));
 
-                // Loop over keys_dim2 and save all (or none)
+                // Loop over keys_dim2 and save all (or none); a compact key is saved in 64-bit storage
+                if (is_compact(index))
+                {
+                    for (auto &key : expanded_key(index))
+                    {
+                        key.save(stream, compr_mode_type::none);
+                    }
+                    continue;
+                }
                 for (size_t j = 0; j < keys_dim2; j++)
                 {
                     // Save the key
@@ -141,5 +315,6 @@ namespace seal
         stream.exceptions(old_except_mask);
 
         swap(keys_, new_keys);
+        compact_.clear();
     }
 } // namespace seal
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "seal/dynarray.h"
 #include "seal/encryptionparams.h"
 #include "seal/memorymanager.h"
 #include "seal/publickey.h"
@@ -30,6 +31,10 @@ namespace seal
     other thread is concurrently mutating it. This is due to the underlying
     data structure storing the keyswitching keys not being thread-safe.
 
+    @par Compact Storage
+    Limbs of the keys modulo primes of at most 32 bits can be held as 32-bit
+    words instead (see compact()), which key switching widens as it reads them.
+
     @see RelinKeys for the class that stores the relinearization keys.
     @see GaloisKeys for the class that stores the Galois keys.
     */
@@ -40,6 +45,83 @@ namespace seal
         friend class GaloisKeys;
 
     public:
+        /**
+        One keyswitching key (all of its decomposition digits) in compact form:
+        each limb modulo a prime of at most 32 bits is stored as 32-bit words,
+        the others as 64-bit words, both in NTT form as in the PublicKeys.
+        */
+        class CompactKey
+        {
+            friend class KSwitchKeys;
+
+        public:
+            SEAL_NODISCARD inline bool empty() const noexcept
+            {
+                return component_count_ == 0;
+            }
+
+            SEAL_NODISCARD inline std::size_t component_count() const noexcept
+            {
+                return component_count_;
+            }
+
+            /**
+            Returns whether the limb of the given key modulus index is stored as
+            32-bit words.
+            */
+            SEAL_NODISCARD inline bool is_narrow(std::size_t limb) const
+            {
+                return narrow_[limb];
+            }
+
+            /**
+            Returns the coefficients of a 32-bit limb of the given component of the
+            key of the given decomposition digit.
+            */
+            SEAL_NODISCARD inline const std::uint32_t *narrow_limb(
+                std::size_t digit, std::size_t component, std::size_t limb) const
+            {
+                return narrow_data_.cbegin() +
+                       ((digit * component_count_ + component) * narrow_count_ + rank_[limb]) * coeff_count_;
+            }
+
+            /**
+            Returns the coefficients of a 64-bit limb of the given component of the
+            key of the given decomposition digit.
+            */
+            SEAL_NODISCARD inline const std::uint64_t *wide_limb(
+                std::size_t digit, std::size_t component, std::size_t limb) const
+            {
+                return wide_data_.cbegin() +
+                       ((digit * component_count_ + component) * (narrow_.size() - narrow_count_) + rank_[limb]) *
+                           coeff_count_;
+            }
+
+            /**
+            Returns the number of bytes of key data held.
+            */
+            SEAL_NODISCARD inline std::size_t data_bytes() const noexcept
+            {
+                return narrow_data_.size() * sizeof(std::uint32_t) + wide_data_.size() * sizeof(std::uint64_t);
+            }
+
+        private:
+            std::size_t coeff_count_ = 0;
+
+            std::size_t component_count_ = 0;
+
+            std::size_t narrow_count_ = 0;
+
+            // Whether each limb is narrow, and its position among the limbs of the same width
+            std::vector<bool> narrow_{};
+
+            std::vector<std::size_t> rank_{};
+
+            DynArray<std::uint32_t> narrow_data_{};
+
+            DynArray<std::uint64_t> wide_data_{};
+        };
+
         /**
         Creates an empty KSwitchKeys.
         */
@@ -130,6 +212,62 @@ namespace seal
             return keys_[index];
         }
 
+        /**
+        Moves every key to compact storage: limbs modulo primes of at most 32 bits
+        are kept as 32-bit words, the rest as before, and the 64-bit copies are
+        released. The PublicKeys in data() keep their metadata but hold no data
+        while their key is compact; read a key through expanded_key() instead. A
+        key later replaced through data() is used as given, and compacted by the
+        next call. Does nothing without keys, or if no prime of the key modulus has
+        at most 32 bits.
+
+        @param[in] context The SEALContext
+        @throws std::invalid_argument if the keys are not valid for the context
+        */
+        void compact(const SEALContext &context);
+
+        /**
+        Moves every compact key back to 64-bit storage in data().
+        */
+        void expand();
+
+        /**
+        Returns whether the keyswitching key at a given index is in compact
+        storage.
+
+        @param[in] index The index of the keyswitching key
+        */
+        SEAL_NODISCARD inline bool is_compact(std::size_t index) const noexcept
+        {
+            return index < compact_.size() && !compact_[index].empty() && index < keys_.size() &&
+                   !keys_[index].empty() && keys_[index][0].data().dyn_array().empty();
+        }
+
+        /**
+        Returns the compact form of the keyswitching key at a given index, valid
+        only if is_compact(index).
+
+        @param[in] index The index of the keyswitching key
+        */
+        SEAL_NODISCARD inline const CompactKey &compact_data(std::size_t index) const
+        {
+            return compact_[index];
+        }
+
+        /**
+        Returns a copy of the keyswitching key at a given index in 64-bit
+        storage, whether or not it is compact.
+
+        @param[in] index The index of the keyswitching key
+        @throws std::invalid_argument if the key at the given index does not exist
+        */
+        SEAL_NODISCARD std::vector<PublicKey> expanded_key(std::size_t index) const;
+
+        /**
+        Returns the number of bytes of key data held, compact or not.
+        */
+        SEAL_NODISCARD std::size_t data_bytes() const noexcept;
+
         /**
         Returns a reference to parms_id.
 
@@ -162,12 +300,15 @@ namespace seal
             compr_mode_type compr_mode = Serialization::compr_mode_default) const
         {
             std::size_t total_key_size = util::mul_safe(keys_.size(), sizeof(std::uint64_t)); // keys_dim2
-            for (auto &key_dim1 : keys_)
+            for (std::size_t index = 0; index < keys_.size(); index++)
             {
-                for (auto &key_dim2 : key_dim1)
+                for (auto &key_dim2 : keys_[index])
                 {
+                    // A compact key is saved in 64-bit storage
                     total_key_size = util::add_safe(
-                        total_key_size, util::safe_cast<std::size_t>(key_dim2.save_size(compr_mode_type::none)));
+                        total_key_size, util::safe_cast<std::size_t>(
+                                            is_compact(index) ? expanded_save_size(key_dim2)
+                                                              : key_dim2.save_size(compr_mode_type::none)));
                 }
             }
 
@@ -328,6 +469,9 @@ namespace seal
     private:
         void save_members(std::ostream &stream) const;
 
+        // The save_size of a PublicKey with the metadata of key and its data
+        static std::streamoff expanded_save_size(const PublicKey &key);
+
         void load_members(const SEALContext &context, std::istream &stream, SEALVersion version);
 
         MemoryPoolHandle pool_ = MemoryManager::GetPool();
@@ -338,5 +482,11 @@ namespace seal
         The vector of keyswitching keys.
         */
         std::vector<std::vector<PublicKey>> keys_{};
+
+        /**
+        The compact forms of the keyswitching keys, by the same index; see
+        is_compact().
+        */
+        std::vector<CompactKey> compact_{};
     };
 } // namespace seal
@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include "seal/util/lockcounters.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace seal
+{
+    using LockSite = util::LockSite;
+
+    using LockMode = util::LockMode;
+
+    /**
+    Acquisition counts and wait times of Microsoft SEAL's internal locks, per lock
+    site (see LockSite): the spinlock of each memory pool size class, the table of
+    size classes of a thread-safe memory pool, the process-wide NTT tables cache,
+    and the secret key powers of key generators and decryptors. A lock that was
+    free at the first attempt counts an acquisition; one that was not also counts
+    as contended, with the time spent waiting for it.
+
+    Every thread counts into counters of its own, so counting adds no contention
+    of its own. Threads can be given a label (e.g. the pool they belong to), and
+    the counts are read summed per label, threads that have exited included.
+
+    The counts stay zero unless Microsoft SEAL is built with SEAL_USE_LOCK_COUNTS
+    set to ON; uncounted builds take the locks exactly as before.
+
+    @par Thread Safety
+    All functions may be called from any thread.
+    */
+    class LockCounts
+    {
+    public:
+        struct Counts
+        {
+            std::uint64_t acquisitions = 0;
+
+            std::uint64_t contended = 0;
+
+            std::uint64_t wait_ns = 0;
+        };
+
+        // The counts of the threads sharing a label, by site and mode
+        struct ThreadGroup
+        {
+            std::string label;
+
+            std::array<std::array<Counts, util::lock_mode_count>, util::lock_site_count> counts{};
+
+            SEAL_NODISCARD inline const Counts &at(LockSite site, LockMode mode) const noexcept
+            {
+                return counts[static_cast<std::size_t>(site)][static_cast<std::size_t>(mode)];
+            }
+        };
+
+        LockCounts() = delete;
+
+        /**
+        Returns whether Microsoft SEAL was built to count lock acquisitions.
+        */
+        SEAL_NODISCARD static bool Enabled() noexcept;
+
+        /**
+        Returns the name of a lock site, e.g. "memory_pool_head".
+        */
+        SEAL_NODISCARD static const char *SiteName(LockSite site) noexcept;
+
+        /**
+        Returns "shared" or "exclusive".
+        */
+        SEAL_NODISCARD static const char *ModeName(LockMode mode) noexcept;
+
+        /**
+        Labels the calling thread; its counts, past and future, are reported under
+        the label. Threads start with an empty label.
+
+        @param[in] label The label, e.g. "compute"
+        */
+        static void SetThreadLabel(const std::string &label);
+
+        /**
+        Returns the counts of all threads that ever took a counted lock, summed per
+        label and ordered by label.
+        */
+        SEAL_NODISCARD static std::vector<ThreadGroup> ByLabel();
+    };
+} // namespace seal
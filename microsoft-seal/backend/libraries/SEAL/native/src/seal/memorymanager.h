@@ -10,6 +10,7 @@
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 /*
 For .NET Framework wrapper support (C++/CLI) we need to
@@ -200,6 +201,58 @@ namespace seal
             return !pool_ ? std::size_t(0) : pool_->alloc_byte_count();
         }
 
+        /**
+        Returns the usage of each allocation size of the memory pool pointed to
+        by the current MemoryPoolHandle, largest size first.
+        */
+        SEAL_NODISCARD inline std::vector<util::MemoryPoolSizeClass> size_classes() const
+        {
+            return !pool_ ? std::vector<util::MemoryPoolSizeClass>() : pool_->size_classes();
+        }
+
+        /**
+        Returns memory to the system. Every block of the memory pool none of
+        whose allocations is in use is freed; the pool grows again when the
+        memory is needed. Long-running processes can call this when idle to
+        give back the memory of a past peak. Returns the number of bytes freed.
+        */
+        inline std::size_t trim()
+        {
+            return !pool_ ? std::size_t(0) : pool_->trim();
+        }
+
+        /**
+        Caps the memory held by the memory pool. Once the pool holds this many
+        bytes, allocations it cannot serve from free memory come directly from
+        the system allocator and are returned to it when released, instead of
+        growing the pool.
+
+        @param[in] byte_count The cap; the maximum size_t value means no cap
+        @throws std::logic_error if the MemoryPoolHandle is uninitialized or
+        points to a ScratchArena
+        */
+        inline void set_byte_count_limit(std::size_t byte_count)
+        {
+            static_cast<util::MemoryPool &>(*this).set_byte_count_limit(byte_count);
+        }
+
+        /**
+        Returns the cap set with set_byte_count_limit.
+        */
+        SEAL_NODISCARD inline std::size_t byte_count_limit() const noexcept
+        {
+            return !pool_ ? std::size_t(0) : pool_->byte_count_limit();
+        }
+
+        /**
+        Returns the number of allocations that bypassed the memory pool because
+        of its cap.
+        */
+        SEAL_NODISCARD inline std::uint64_t unpooled_count() const noexcept
+        {
+            return !pool_ ? std::uint64_t(0) : pool_->unpooled_count();
+        }
+
         /**
         Returns the number of MemoryPoolHandle objects sharing this memory pool.
         */
@@ -239,6 +292,179 @@ namespace seal
         std::shared_ptr<util::MemoryPool> pool_ = nullptr;
     };
 
+    /**
+    A bump-pointer scratch arena for the temporaries of a single thread. A
+    ScratchArena converts to a MemoryPoolHandle, so it can be passed to every
+    function that takes one. Allocations are carved from large blocks and
+    recycled through unlocked free lists, so no allocation takes a lock or calls
+    the system allocator once the arena has grown to the peak usage of the
+    workload. Calling reset() after each unit of work (e.g. a request) reclaims
+    all memory at once and merges the blocks into one.
+
+    @par Thread Safety
+    A ScratchArena is not thread-safe: it must be used by one thread at a time,
+    and objects that hold memory from it (e.g. a Ciphertext created with it as
+    its pool) must not be released on another thread. Work items that Microsoft
+    SEAL runs on helper threads (see ParallelExecution) use the thread-local
+    memory pool of their thread instead.
+    */
+    class ScratchArena
+    {
+    public:
+        /**
+        Creates a new ScratchArena.
+
+        @param[in] initial_byte_count The size of the first block; zero sizes the
+        first block by the first allocation
+        @param[in] clear_on_destruction Indicates whether the memory should be
+        cleared when reset or destroyed
+        @throws std::invalid_argument if initial_byte_count is too large
+        */
+        explicit ScratchArena(std::size_t initial_byte_count = 0, bool clear_on_destruction = false)
+            : arena_(std::make_shared<util::MemoryPoolArena>(initial_byte_count, clear_on_destruction))
+        {}
+
+        /**
+        Returns a MemoryPoolHandle pointing to the arena.
+        */
+        SEAL_NODISCARD inline MemoryPoolHandle pool() const noexcept
+        {
+            return MemoryPoolHandle(arena_);
+        }
+
+        /**
+        Returns a MemoryPoolHandle pointing to the arena.
+        */
+        SEAL_NODISCARD inline operator MemoryPoolHandle() const noexcept
+        {
+            return pool();
+        }
+
+        /**
+        Reclaims all memory of the arena.
+
+        @throws std::logic_error if allocations from the arena are still in use
+        */
+        inline void reset()
+        {
+            arena_->reset();
+        }
+
+        /**
+        Returns the number of allocations from the arena that are still in use.
+        */
+        SEAL_NODISCARD inline std::size_t outstanding_count() const noexcept
+        {
+            return arena_->outstanding_count();
+        }
+
+        /**
+        Returns the total size of the blocks of the arena.
+        */
+        SEAL_NODISCARD inline std::size_t alloc_byte_count() const noexcept
+        {
+            return arena_->alloc_byte_count();
+        }
+
+    private:
+        std::shared_ptr<util::MemoryPoolArena> arena_;
+    };
+
+    /**
+    Counts the memory that the threads it is attached to (see MemoryUsageGuard)
+    take from memory pools: the bytes handed out, and the bytes held at present
+    and at most, net of what those threads gave back.
+
+    Every allocation counts, whichever memory pool or MMProf it comes from,
+    including allocations that bypass a pool at its cap. The sizes are those of
+    the pool allocations, so an allocation rounded up to an existing size class
+    counts with that size. An allocation that is released on a thread the
+    MemoryUsage is not attached to stays counted as held; one taken before the
+    MemoryUsage was attached and released while it is counts as given back, so
+    the bytes held can go negative.
+
+    @par Thread Safety
+    The counters are atomic: one MemoryUsage may be attached to several threads
+    at once, e.g. the threads working on one request.
+    */
+    class MemoryUsage
+    {
+    public:
+        MemoryUsage() = default;
+
+        /**
+        Returns the total bytes handed out.
+        */
+        SEAL_NODISCARD inline std::uint64_t allocated_byte_count() const noexcept
+        {
+            return counters_.allocated_byte_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+        Returns the number of allocations handed out.
+        */
+        SEAL_NODISCARD inline std::uint64_t allocation_count() const noexcept
+        {
+            return counters_.allocation_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+        Returns the bytes handed out and not given back.
+        */
+        SEAL_NODISCARD inline std::int64_t held_byte_count() const noexcept
+        {
+            return counters_.held_byte_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+        Returns the largest number of bytes held at any time.
+        */
+        SEAL_NODISCARD inline std::int64_t peak_byte_count() const noexcept
+        {
+            return counters_.peak_byte_count.load(std::memory_order_relaxed);
+        }
+
+    private:
+        MemoryUsage(const MemoryUsage &copy) = delete;
+
+        MemoryUsage &operator=(const MemoryUsage &assign) = delete;
+
+        friend class MemoryUsageGuard;
+
+        util::MemoryUsageCounters counters_;
+    };
+
+    /**
+    Attaches a MemoryUsage to the calling thread for the lifetime of the guard,
+    then restores the one attached before (if any). The MemoryUsage must outlive
+    the guard; a null pointer detaches the thread for the guard's lifetime.
+    */
+    class MemoryUsageGuard
+    {
+    public:
+        /**
+        Attaches a MemoryUsage to the calling thread.
+
+        @param[in] usage The MemoryUsage to count for, or nullptr for none
+        */
+        explicit MemoryUsageGuard(MemoryUsage *usage) noexcept : previous_(util::thread_memory_usage())
+        {
+            util::thread_memory_usage() = usage ? &usage->counters_ : nullptr;
+        }
+
+        ~MemoryUsageGuard() noexcept
+        {
+            util::thread_memory_usage() = previous_;
+        }
+
+    private:
+        MemoryUsageGuard(const MemoryUsageGuard &copy) = delete;
+
+        MemoryUsageGuard &operator=(const MemoryUsageGuard &assign) = delete;
+
+        util::MemoryUsageCounters *previous_;
+    };
+
     using mm_prof_opt_t = std::uint64_t;
 
     /**
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include "seal/util/opcounters.h"
+#include <atomic>
+#include <cstdint>
+
+namespace seal
+{
+    /**
+    Counts the expensive primitives that the threads it is attached to (see
+    OperationCountsGuard) run: negacyclic NTTs in either direction, key switches,
+    RNS base conversions, and memory pool allocations. The helper tasks of a
+    parallel loop count for the counts of the thread that started the loop.
+
+    An NTT counts once per residue polynomial, i.e. per prime, so transforming a
+    ciphertext of size 2 over 3 primes counts 6. A key switch counts once per
+    relinearization or Galois automorphism, including each rotation of a hoisted
+    batch. A base conversion counts once per polynomial converted.
+
+    The counts stay zero when Microsoft SEAL is built with SEAL_USE_OPERATION_COUNTS
+    set to OFF.
+
+    @par Thread Safety
+    The counters are atomic: one OperationCounts may be attached to several
+    threads at once, e.g. the threads working on one request.
+    */
+    class OperationCounts
+    {
+    public:
+        OperationCounts() = default;
+
+        /**
+        Returns the number of residue polynomials transformed to NTT form.
+        */
+        SEAL_NODISCARD inline std::uint64_t forward_ntt_count() const noexcept
+        {
+            return counters_.forward_ntt_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+        Returns the number of residue polynomials transformed back from NTT form.
+        */
+        SEAL_NODISCARD inline std::uint64_t inverse_ntt_count() const noexcept
+        {
+            return counters_.inverse_ntt_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+        Returns the number of key switches.
+        */
+        SEAL_NODISCARD inline std::uint64_t key_switch_count() const noexcept
+        {
+            return counters_.key_switch_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+        Returns the number of RNS base conversions.
+        */
+        SEAL_NODISCARD inline std::uint64_t base_conversion_count() const noexcept
+        {
+            return counters_.base_conversion_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+        Returns the number of memory pool allocations.
+        */
+        SEAL_NODISCARD inline std::uint64_t allocation_count() const noexcept
+        {
+            return counters_.allocation_count.load(std::memory_order_relaxed);
+        }
+
+    private:
+        OperationCounts(const OperationCounts &copy) = delete;
+
+        OperationCounts &operator=(const OperationCounts &assign) = delete;
+
+        friend class OperationCountsGuard;
+
+        util::OperationCounters counters_;
+    };
+
+    /**
+    Attaches an OperationCounts to the calling thread for the lifetime of the
+    guard, then restores the one attached before (if any). The OperationCounts
+    must outlive the guard; a null pointer detaches the thread for the guard's
+    lifetime.
+    */
+    class OperationCountsGuard
+    {
+    public:
+        /**
+        Attaches an OperationCounts to the calling thread.
+
+        @param[in] counts The OperationCounts to count for, or nullptr for none
+        */
+        explicit OperationCountsGuard(OperationCounts *counts) noexcept : previous_(util::thread_operation_counters())
+        {
+            util::thread_operation_counters() = counts ? &counts->counters_ : nullptr;
+        }
+
+        ~OperationCountsGuard() noexcept
+        {
+            util::thread_operation_counters() = previous_;
+        }
+
+    private:
+        OperationCountsGuard(const OperationCountsGuard &copy) = delete;
+
+        OperationCountsGuard &operator=(const OperationCountsGuard &assign) = delete;
+
+        util::OperationCounters *previous_;
+    };
+} // namespace seal
@@ -0,0 +1,240 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/parallel.h"
+#include "seal/util/opcounters.h"
+#include "seal/util/parallel.h"
+#include <algorithm>
+#include <stdexcept>
+#ifndef _M_CEE
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#endif
+
+using namespace std;
+using namespace seal::util;
+
+namespace seal
+{
+#ifndef _M_CEE
+    namespace
+    {
+        // The executor is read under the mutex; concurrency is mirrored in an atomic so that the common sequential
+        // case costs a single load
+        mutex executor_mutex;
+        shared_ptr<ParallelExecutor> executor;
+        atomic<size_t> executor_concurrency{ 0 };
+        atomic<size_t> min_coeffs_per_task{ ParallelExecution::default_min_coeffs_per_task };
+
+        enum class ThreadRole
+        {
+            none,
+            caller,
+            helper
+        };
+
+        thread_local ThreadRole thread_role = ThreadRole::none;
+
+        // Also attaches the helper tasks to the OperationCounts of the thread that started the loop
+        class ThreadRoleGuard
+        {
+        public:
+            ThreadRoleGuard(ThreadRole role, OperationCounters *counters)
+                : previous_(thread_role), previous_counters_(thread_operation_counters())
+            {
+                thread_role = role;
+                thread_operation_counters() = counters;
+            }
+
+            ~ThreadRoleGuard()
+            {
+                thread_role = previous_;
+                thread_operation_counters() = previous_counters_;
+            }
+
+        private:
+            ThreadRole previous_;
+
+            OperationCounters *previous_counters_;
+        };
+
+        // Shared by the caller and the helper tasks of one parallel_for; helpers may outlive the call
+        struct ParallelForState
+        {
+            const function<void(size_t)> *body;
+
+            size_t count;
+
+            OperationCounters *counters;
+
+            atomic<size_t> next{ 0 };
+
+            mutex finished_mutex;
+
+            condition_variable finished_cv;
+
+            size_t finished = 0;
+
+            exception_ptr error;
+        };
+
+        // Claims and runs items until none are left. body is only used after a successful claim, while the caller
+        // is still waiting for that item.
+        void run_items(ParallelForState &state, ThreadRole role)
+        {
+            ThreadRoleGuard guard(role, state.counters);
+            size_t done = 0;
+            exception_ptr error;
+            for (size_t i; (i = state.next.fetch_add(1, memory_order_relaxed)) < state.count; done++)
+            {
+                try
+                {
+                    (*state.body)(i);
+                }
+                catch (...)
+                {
+                    if (!error)
+                    {
+                        error = current_exception();
+                    }
+                }
+            }
+            if (done)
+            {
+                lock_guard<mutex> lock(state.finished_mutex);
+                if (error && !state.error)
+                {
+                    state.error = error;
+                }
+                state.finished += done;
+                if (state.finished == state.count)
+                {
+                    state.finished_cv.notify_all();
+                }
+            }
+        }
+    } // namespace
+#endif
+
+    void ParallelExecution::SetExecutor(shared_ptr<ParallelExecutor> new_executor, size_t new_min_coeffs_per_task)
+    {
+        if (!new_min_coeffs_per_task)
+        {
+            throw invalid_argument("min_coeffs_per_task must be positive");
+        }
+#ifdef _M_CEE
+        if (new_executor)
+        {
+            throw logic_error("intra-operation parallelism is not supported");
+        }
+#else
+        size_t concurrency = new_executor ? new_executor->concurrency() : 0;
+        lock_guard<mutex> lock(executor_mutex);
+        executor = move(new_executor);
+        min_coeffs_per_task.store(new_min_coeffs_per_task, memory_order_relaxed);
+        executor_concurrency.store(concurrency, memory_order_relaxed);
+#endif
+    }
+
+    shared_ptr<ParallelExecutor> ParallelExecution::GetExecutor()
+    {
+#ifdef _M_CEE
+        return nullptr;
+#else
+        lock_guard<mutex> lock(executor_mutex);
+        return executor;
+#endif
+    }
+
+    size_t ParallelExecution::MinCoeffsPerTask() noexcept
+    {
+#ifdef _M_CEE
+        return default_min_coeffs_per_task;
+#else
+        return min_coeffs_per_task.load(memory_order_relaxed);
+#endif
+    }
+
+    namespace util
+    {
+        size_t parallel_task_count(size_t count, size_t coeffs_per_item) noexcept
+        {
+#ifdef _M_CEE
+            return 1;
+#else
+            size_t concurrency = executor_concurrency.load(memory_order_relaxed);
+            if (!concurrency || count < 2 || thread_role != ThreadRole::none)
+            {
+                return 1;
+            }
+            size_t by_work = count * coeffs_per_item / min_coeffs_per_task.load(memory_order_relaxed);
+            return max<size_t>(min({ count, by_work, concurrency + 1 }), 1);
+#endif
+        }
+
+        size_t parallel_task_count(size_t count) noexcept
+        {
+#ifdef _M_CEE
+            return 1;
+#else
+            size_t concurrency = executor_concurrency.load(memory_order_relaxed);
+            if (!concurrency || count < 2 || thread_role != ThreadRole::none)
+            {
+                return 1;
+            }
+            return min(count, concurrency + 1);
+#endif
+        }
+
+        void parallel_for(size_t count, size_t task_count, const function<void(size_t)> &body)
+        {
+#ifndef _M_CEE
+            shared_ptr<ParallelExecutor> current = ParallelExecution::GetExecutor();
+            if (current && task_count > 1 && count > 1)
+            {
+                auto state = make_shared<ParallelForState>();
+                state->body = &body;
+                state->count = count;
+                state->counters = thread_operation_counters();
+                try
+                {
+                    for (size_t i = 1; i < min(task_count, count); i++)
+                    {
+                        current->schedule([state] { run_items(*state, ThreadRole::helper); });
+                    }
+                }
+                catch (...)
+                {
+                    // Fewer helpers; the calling thread picks up their share
+                }
+                run_items(*state, ThreadRole::caller);
+
+                unique_lock<mutex> lock(state->finished_mutex);
+                state->finished_cv.wait(lock, [&] { return state->finished == count; });
+                if (state->error)
+                {
+                    rethrow_exception(state->error);
+                }
+                return;
+            }
+#endif
+            for (size_t i = 0; i < count; i++)
+            {
+                body(i);
+            }
+        }
+
+        MemoryPoolHandle parallel_pool(const MemoryPoolHandle &pool)
+        {
+#ifndef _M_CEE
+            if (thread_role == ThreadRole::helper)
+            {
+                return MemoryPoolHandle::ThreadLocal();
+            }
+#endif
+            return pool;
+        }
+    } // namespace util
+} // namespace seal
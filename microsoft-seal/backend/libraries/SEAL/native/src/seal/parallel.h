@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace seal
+{
+    /**
+    Runs tasks on behalf of Microsoft SEAL's opt-in intra-operation parallelism, typically by handing them to an
+    existing thread pool of the application.
+
+    @par Scheduling Contract
+    SEAL never waits for a scheduled task to start: the calling thread processes the work items itself and the
+    scheduled tasks only help. A task that starts after all work has been claimed returns immediately. It is
+    therefore safe to call SEAL from a thread of the same pool that runs the scheduled tasks, and a FIFO queue
+    with no work stealing is sufficient.
+    */
+    class ParallelExecutor
+    {
+    public:
+        virtual ~ParallelExecutor() = default;
+
+        /**
+        Schedules a task to run asynchronously. The task does not throw.
+
+        @param[in] task The task to run
+        */
+        virtual void schedule(std::function<void()> task) = 0;
+
+        /**
+        Returns the number of threads that run scheduled tasks.
+        */
+        SEAL_NODISCARD virtual std::size_t concurrency() const = 0;
+    };
+
+    /**
+    Controls intra-operation parallelism. By default every homomorphic operation runs on the calling thread. Once an
+    executor is set, loops over the RNS components inside the NTTs, dyadic products and key switching of large
+    parameter sets are split across it: the NTT of each component, for example, becomes one work item. This helps
+    latency when there are fewer concurrent operations than cores, and adds overhead otherwise.
+
+    @par Minimum Work
+    A loop is split only into tasks that touch at least min_coeffs_per_task coefficients in total, so loops over
+    few components or small poly_modulus_degree stay sequential. The default of 16384 coefficients corresponds to
+    one component of degree 16384. Key generation splits the components of relinearization and Galois keys
+    across the executor whatever this minimum, since each is a full encryption, and so do Evaluator::multiply_many
+    and Evaluator::exponentiate_inplace with their independent multiplications.
+
+    @par Thread Safety
+    The settings may be changed at any time; operations that are already running keep using the previous executor.
+    While a task runs on a helper thread, SEAL makes its scratch allocations from that thread's thread-local memory
+    pool instead of the MemoryPoolHandle passed to the operation.
+    */
+    class ParallelExecution
+    {
+    public:
+        ParallelExecution() = delete;
+
+        /**
+        Sets the executor used for intra-operation parallelism; nullptr restores sequential execution.
+
+        @param[in] executor The executor
+        @param[in] min_coeffs_per_task The minimum number of coefficients per task
+        @throws std::invalid_argument if min_coeffs_per_task is zero
+        */
+        static void SetExecutor(
+            std::shared_ptr<ParallelExecutor> executor, std::size_t min_coeffs_per_task = default_min_coeffs_per_task);
+
+        /**
+        Returns the current executor, or nullptr if operations run sequentially.
+        */
+        SEAL_NODISCARD static std::shared_ptr<ParallelExecutor> GetExecutor();
+
+        /**
+        Returns the current minimum number of coefficients per task.
+        */
+        SEAL_NODISCARD static std::size_t MinCoeffsPerTask() noexcept;
+
+        static constexpr std::size_t default_min_coeffs_per_task = 16384;
+    };
+} // namespace seal
@@ -6,6 +6,7 @@
 #include "seal/util/common.h"
 #include "seal/util/fips202.h"
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <random>
 #if (SEAL_SYSTEM == SEAL_SYSTEM_WINDOWS)
@@ -167,6 +168,9 @@ namespace seal
         case prng_type::shake256:
             return make_shared<Shake256PRNG>(seed_);
 
+        case prng_type::aes128ctr:
+            return make_shared<AES128CTRPRNG>(seed_);
+
         case prng_type::unknown:
             return nullptr;
         }
@@ -192,10 +196,28 @@ namespace seal
         }
     }
 
+    namespace
+    {
+        // Read and replaced with atomic_load and atomic_store
+        shared_ptr<UniformRandomGeneratorFactory> &default_factory()
+        {
+            static shared_ptr<UniformRandomGeneratorFactory> factory{ new SEAL_DEFAULT_PRNG_FACTORY() };
+            return factory;
+        }
+    } // namespace
+
     auto UniformRandomGeneratorFactory::DefaultFactory() -> shared_ptr<UniformRandomGeneratorFactory>
     {
-        static shared_ptr<UniformRandomGeneratorFactory> default_factory{ new SEAL_DEFAULT_PRNG_FACTORY() };
-        return default_factory;
+        return atomic_load(&default_factory());
+    }
+
+    void UniformRandomGeneratorFactory::SetDefaultFactory(shared_ptr<UniformRandomGeneratorFactory> factory)
+    {
+        if (!factory)
+        {
+            throw invalid_argument("factory cannot be null");
+        }
+        atomic_store(&default_factory(), move(factory));
     }
 
     void Blake2xbPRNG::refill_buffer()
@@ -222,4 +244,35 @@ namespace seal
         seal_memzero(seed_ext.data(), seed_ext.size() * bytes_per_uint64);
         counter_++;
     }
+
+    AES128CTRPRNG::AES128CTRPRNG(prng_seed_type seed) : UniformRandomGenerator(seed)
+    {
+        // The first 16 bytes are the AES key, the next 8 the nonce
+        array<uint8_t, 24> derived;
+        if (blake2b(
+                derived.data(), derived.size(), seed_.cbegin(), seed_.size() * sizeof(decltype(seed_)::type), nullptr,
+                0) != 0)
+        {
+            throw runtime_error("blake2b failed");
+        }
+        aes128_expand_key(derived.data(), round_keys_);
+        for (size_t i = 0; i < 8; i++)
+        {
+            nonce_ |= static_cast<uint64_t>(derived[16 + i]) << (8 * i);
+        }
+        seal_memzero(derived.data(), derived.size());
+    }
+
+    AES128CTRPRNG::~AES128CTRPRNG()
+    {
+        seal_memzero(round_keys_.data(), round_keys_.size());
+    }
+
+    void AES128CTRPRNG::refill_buffer()
+    {
+        // Fill the randomness buffer with the next buffer_size_ / 16 counter blocks
+        size_t block_count = buffer_size_ / 16;
+        aes128_ctr(round_keys_, nonce_, counter_, block_count, reinterpret_cast<uint8_t *>(buffer_begin_));
+        counter_ += block_count;
+    }
 } // namespace seal
@@ -6,6 +6,7 @@
 #include "seal/dynarray.h"
 #include "seal/memorymanager.h"
 #include "seal/version.h"
+#include "seal/util/aes.h"
 #include "seal/util/common.h"
 #include "seal/util/defines.h"
 #include <algorithm>
@@ -32,7 +33,9 @@ namespace seal
 
         blake2xb = 1,
 
-        shake256 = 2
+        shake256 = 2,
+
+        aes128ctr = 3
     };
 
     /**
@@ -142,6 +145,9 @@ namespace seal
             case prng_type::shake256:
                 /* fall through */
 
+            case prng_type::aes128ctr:
+                /* fall through */
+
             case prng_type::unknown:
                 return true;
             }
@@ -469,6 +475,20 @@ namespace seal
         */
         static auto DefaultFactory() -> std::shared_ptr<UniformRandomGeneratorFactory>;
 
+        /**
+        Replaces the default random number generator factory, which SEALContext
+        installs into encryption parameters without one and which expands the
+        public seeds of seeded ciphertexts and keys. Meant to be called once at
+        startup, before any SEALContext is created; contexts created earlier
+        keep the factory they were given. The new default also picks the PRNG
+        type recorded with seeded objects, so those can only be loaded by SEAL
+        builds that know that type.
+
+        @param[in] factory The new default factory
+        @throws std::invalid_argument if factory is null
+        */
+        static void SetDefaultFactory(std::shared_ptr<UniformRandomGeneratorFactory> factory);
+
         /**
         Returns whether the random number generator factory creates random number
         generators seeded with a random seed, or if a default seed is used.
@@ -636,4 +656,81 @@ namespace seal
 
     private:
     };
+
+    /**
+    Provides an implementation of UniformRandomGenerator for using AES-128 in
+    counter mode for generating randomness with given 512-bit seed. The AES key
+    and a 64-bit nonce are derived from the seed with BLAKE2b, and each refill
+    encrypts the next run of counter blocks. On CPUs with AES-NI this is several
+    times faster than Blake2xbPRNG; elsewhere a portable, table-based AES is
+    used, which gives the same output but is slower and not constant-time.
+    */
+    class AES128CTRPRNG : public UniformRandomGenerator
+    {
+    public:
+        /**
+        Creates a new AES128CTRPRNG instance initialized with the given seed.
+
+        @param[in] seed The seed for the random number generator
+        */
+        AES128CTRPRNG(prng_seed_type seed);
+
+        /**
+        Destroys the random number generator, zeroing the expanded key.
+        */
+        ~AES128CTRPRNG();
+
+    protected:
+        SEAL_NODISCARD prng_type type() const noexcept override
+        {
+            return prng_type::aes128ctr;
+        }
+
+        void refill_buffer() override;
+
+    private:
+        util::AES128RoundKeys round_keys_{};
+
+        std::uint64_t nonce_ = 0;
+
+        std::uint64_t counter_ = 0;
+    };
+
+    class AES128CTRPRNGFactory : public UniformRandomGeneratorFactory
+    {
+    public:
+        /**
+        Creates a new AES128CTRPRNGFactory. The seed will be sampled randomly for
+        each AES128CTRPRNG instance created by the factory instance, which is
+        desirable in most normal use-cases.
+        */
+        AES128CTRPRNGFactory() : UniformRandomGeneratorFactory()
+        {}
+
+        /**
+        Creates a new AES128CTRPRNGFactory and sets the default seed to the given
+        value. For debugging purposes it may sometimes be convenient to have the
+        same randomness be used deterministically and repeatedly. Such randomness
+        sampling is naturally insecure and must be strictly restricted to debugging
+        situations. Thus, most users should never use this constructor.
+
+        @param[in] default_seed The default value for a seed to be used by all
+        created instances of AES128CTRPRNG
+        */
+        AES128CTRPRNGFactory(prng_seed_type default_seed) : UniformRandomGeneratorFactory(default_seed)
+        {}
+
+        /**
+        Destroys the random number generator factory.
+        */
+        ~AES128CTRPRNGFactory() = default;
+
+    protected:
+        SEAL_NODISCARD auto create_impl(prng_seed_type seed) -> std::shared_ptr<UniformRandomGenerator> override
+        {
+            return std::make_shared<AES128CTRPRNG>(seed);
+        }
+
+    private:
+    };
 } // namespace seal
@@ -5,6 +5,7 @@
 
 #include "seal/batchencoder.h"
 #include "seal/ciphertext.h"
+#include "seal/ciphertextbatch.h"
 #include "seal/ckks.h"
 #include "seal/context.h"
 #include "seal/decryptor.h"
@@ -14,8 +15,11 @@
 #include "seal/evaluator.h"
 #include "seal/galoiskeys.h"
 #include "seal/keygenerator.h"
+#include "seal/lockcounts.h"
 #include "seal/memorymanager.h"
 #include "seal/modulus.h"
+#include "seal/operationcounts.h"
+#include "seal/parallel.h"
 #include "seal/plaintext.h"
 #include "seal/publickey.h"
 #include "seal/randomgen.h"
@@ -100,6 +100,8 @@ namespace seal
             return ztools::zlib_deflate_size_bound(in_size);
 #endif
         case compr_mode_type::none:
+            /* fall through */
+        case compr_mode_type::bitpack:
             // No compression
             return in_size;
 
@@ -255,7 +257,10 @@ namespace seal
             switch (compr_mode)
             {
             case compr_mode_type::none:
-                // We set the compression mode and size here, and save the header
+                /* fall through */
+            case compr_mode_type::bitpack:
+                // We set the compression mode and size here, and save the header; save_members bit-packs, if the
+                // object does, and raw_size is then its packed size
                 header.compr_mode = compr_mode;
                 header.size = safe_cast<uint64_t>(raw_size);
                 SaveHeader(header, stream);
@@ -376,6 +381,8 @@ namespace seal
             switch (header.compr_mode)
             {
             case compr_mode_type::none:
+                /* fall through */
+            case compr_mode_type::bitpack:
                 // Read rest of the data
                 load_members(stream, version);
                 if (header.size != safe_cast<uint64_t>(stream.tellg() - stream_start_pos))
@@ -18,7 +18,7 @@ namespace seal
     integers modulo prime numbers much smaller than the word size, resulting in
     a large number of zero bytes in the output. Any compression algorithm should
     be able to clean up these zero bytes and hence compress both ciphertext and
-    key data.
+    key data. Bit-packing removes them without a general-purpose compressor.
     */
     enum class compr_mode_type : std::uint8_t
     {
@@ -32,6 +32,9 @@ namespace seal
         // Use Zstandard compression
         zstd = 2,
 #endif
+        // Ciphertexts (and public keys) store each RNS component of each polynomial at the bit width its largest
+        // coefficient needs; other objects are saved as with none. Always available.
+        bitpack = 3,
     };
 
     /**
@@ -109,7 +112,9 @@ namespace seal
 #endif
 #ifdef SEAL_USE_ZSTD
             case static_cast<std::uint8_t>(compr_mode_type::zstd):
+                /* fall through */
 #endif
+            case static_cast<std::uint8_t>(compr_mode_type::bitpack):
                 return true;
             }
             return false;
@@ -128,7 +133,8 @@ namespace seal
         /**
         Returns an upper bound on the output size of data compressed according to
         a given compression mode with given input size. If compr_mode is
-        compr_mode_type::none, the return value is exactly in_size.
+        compr_mode_type::none or compr_mode_type::bitpack, the return value is
+        exactly in_size (objects that bit-pack compute their own size).
 
         @param[in] in_size The input size to a compression algorithm
         @param[in] in_size The compression mode
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        The expanded key of AES-128: eleven 16-byte round keys.
+        */
+        using AES128RoundKeys = std::array<std::uint8_t, 176>;
+
+        /**
+        Expands a 16-byte AES-128 key into its round keys (FIPS 197, Section 5.2).
+        */
+        void aes128_expand_key(const std::uint8_t *key, AES128RoundKeys &round_keys);
+
+        /**
+        Writes block_count 16-byte blocks of AES-128 in counter mode to destination: block i is the encryption of the
+        counter block whose bytes 0-7 hold counter + i (mod 2^64) and bytes 8-15 hold nonce, both little-endian.
+
+        Uses the AES-NI kernel when use_aes_ni() is true. The portable fallback uses table lookups indexed by secret
+        data, so it is not constant-time; it exists so that seeds expanded with AES-NI on one host expand to the same
+        bytes on any other.
+        */
+        void aes128_ctr(
+            const AES128RoundKeys &round_keys, std::uint64_t nonce, std::uint64_t counter, std::size_t block_count,
+            std::uint8_t *destination);
+    } // namespace util
+} // namespace seal
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_AES_NI_FLAGS; see the note in nttavx2.cpp.
+
+#include "seal/util/aesni.h"
+
+#ifdef SEAL_USE_AES_NI
+#include <wmmintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace aesni
+        {
+            namespace
+            {
+                constexpr size_t lanes = 8;
+
+                inline __m128i counter_block(uint64_t nonce, uint64_t counter)
+                {
+                    return _mm_set_epi64x(static_cast<long long>(nonce), static_cast<long long>(counter));
+                }
+            } // namespace
+
+            void aes128_ctr(
+                const uint8_t *round_keys, uint64_t nonce, uint64_t counter, size_t block_count, uint8_t *destination)
+            {
+                __m128i keys[11];
+                for (size_t r = 0; r < 11; r++)
+                {
+                    keys[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(round_keys + 16 * r));
+                }
+                __m128i *out = reinterpret_cast<__m128i *>(destination);
+
+                size_t i = 0;
+                for (; i + lanes <= block_count; i += lanes)
+                {
+                    __m128i blocks[lanes];
+                    for (size_t j = 0; j < lanes; j++)
+                    {
+                        blocks[j] = _mm_xor_si128(counter_block(nonce, counter + i + j), keys[0]);
+                    }
+                    for (size_t r = 1; r < 10; r++)
+                    {
+                        for (size_t j = 0; j < lanes; j++)
+                        {
+                            blocks[j] = _mm_aesenc_si128(blocks[j], keys[r]);
+                        }
+                    }
+                    for (size_t j = 0; j < lanes; j++)
+                    {
+                        _mm_storeu_si128(out + i + j, _mm_aesenclast_si128(blocks[j], keys[10]));
+                    }
+                }
+                for (; i < block_count; i++)
+                {
+                    __m128i block = _mm_xor_si128(counter_block(nonce, counter + i), keys[0]);
+                    for (size_t r = 1; r < 10; r++)
+                    {
+                        block = _mm_aesenc_si128(block, keys[r]);
+                    }
+                    _mm_storeu_si128(out + i, _mm_aesenclast_si128(block, keys[10]));
+                }
+            }
+        } // namespace aesni
+    } // namespace util
+} // namespace seal
+
+#endif
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_AES_NI
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        AES-NI kernels for the AES128CTR PRNG. They produce exactly the same output as the portable implementation in
+        aes.cpp and must only be called when use_aes_ni() is true; aes128_ctr dispatches to them automatically.
+        */
+        namespace aesni
+        {
+            /**
+            Same as aes128_ctr, with round_keys pointing to the 176 bytes of an AES128RoundKeys. Eight counter blocks
+            are encrypted at a time, which hides the latency of the AESENC instruction.
+            */
+            void aes128_ctr(
+                const std::uint8_t *round_keys, std::uint64_t nonce, std::uint64_t counter, std::size_t block_count,
+                std::uint8_t *destination);
+        } // namespace aesni
+    } // namespace util
+} // namespace seal
+
+#endif
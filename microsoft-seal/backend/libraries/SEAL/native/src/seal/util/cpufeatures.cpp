@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/util/cpufeatures.h"
+#include <cstdlib>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#define SEAL_CPUID_MSVC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define SEAL_CPUID_GNU
+#elif defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1UL << 22)
+#endif
+#define SEAL_HWCAP_LINUX
+#endif
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace
+        {
+#if defined(SEAL_CPUID_MSVC) || defined(SEAL_CPUID_GNU)
+            // Returns EAX, EBX, ECX, EDX of the given CPUID leaf and subleaf; all zero if the leaf is not supported
+            void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4])
+            {
+#ifdef SEAL_CPUID_MSVC
+                int info[4];
+                __cpuid(info, 0);
+                if (static_cast<unsigned>(info[0]) < leaf)
+                {
+                    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+                    return;
+                }
+                __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+                for (int i = 0; i < 4; i++)
+                {
+                    regs[i] = static_cast<unsigned>(info[i]);
+                }
+#else
+                if (!__get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3]))
+                {
+                    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+                }
+#endif
+            }
+
+            // Returns the XCR0 register, i.e., which register states the operating system saves
+            unsigned long long xgetbv0()
+            {
+#ifdef SEAL_CPUID_MSVC
+                return _xgetbv(0);
+#else
+                unsigned eax, edx;
+                __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+                return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+            }
+#endif
+
+            CPUFeatures detect_cpu_features()
+            {
+                CPUFeatures features;
+#if defined(SEAL_CPUID_MSVC) || defined(SEAL_CPUID_GNU)
+                unsigned regs[4];
+                cpuid(1, 0, regs);
+                bool osxsave = (regs[2] >> 27) & 1;
+                bool avx = (regs[2] >> 28) & 1;
+
+                // AES-NI works on XMM registers, which every x86-64 OS saves
+                features.aes = (regs[2] >> 25) & 1;
+
+                // The OS must save the XMM and YMM register state
+                bool ymm_state = osxsave && ((xgetbv0() & 0x6) == 0x6);
+
+                // AVX-512 additionally needs the opmask and ZMM register state
+                bool zmm_state = ymm_state && ((xgetbv0() & 0xE0) == 0xE0);
+
+                cpuid(7, 0, regs);
+                features.avx2 = avx && ymm_state && ((regs[1] >> 5) & 1);
+                features.avx512f = zmm_state && ((regs[1] >> 16) & 1);
+#elif defined(SEAL_HWCAP_LINUX)
+                features.sve = (getauxval(AT_HWCAP) & HWCAP_SVE) != 0;
+#endif
+                if (getenv("SEAL_DISABLE_AVX2"))
+                {
+                    features.avx2 = false;
+                }
+                if (getenv("SEAL_DISABLE_AVX512"))
+                {
+                    features.avx512f = false;
+                }
+                if (getenv("SEAL_DISABLE_AES_NI"))
+                {
+                    features.aes = false;
+                }
+                if (getenv("SEAL_DISABLE_SVE"))
+                {
+                    features.sve = false;
+                }
+                return features;
+            }
+        } // namespace
+
+        const CPUFeatures &cpu_features()
+        {
+            static const CPUFeatures features = detect_cpu_features();
+            return features;
+        }
+    } // namespace util
+} // namespace seal
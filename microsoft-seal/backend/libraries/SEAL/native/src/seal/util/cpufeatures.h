@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        Instruction set extensions of the host CPU that SEAL has optional kernels for. The features are detected once,
+        on first use, and take operating system support for the extended register state into account.
+
+        Setting the environment variable SEAL_DISABLE_AVX2, SEAL_DISABLE_AVX512, SEAL_DISABLE_AES_NI or
+        SEAL_DISABLE_SVE (to any value) before the first use masks that extension, which forces the next best kernels; this is meant for benchmarking
+        and validating the vectorized paths. NEON is part of the AArch64 baseline and needs no runtime check.
+        */
+        struct CPUFeatures
+        {
+            bool avx2 = false;
+
+            bool avx512f = false;
+
+            bool aes = false;
+
+            bool sve = false;
+        };
+
+        /**
+        Returns the features of the host CPU.
+        */
+        SEAL_NODISCARD const CPUFeatures &cpu_features();
+
+        /**
+        Returns true if SEAL was built with AVX2 kernels and the host CPU can run them.
+        */
+        SEAL_NODISCARD inline bool use_avx2()
+        {
+#ifdef SEAL_USE_AVX2
+            return cpu_features().avx2;
+#else
+            return false;
+#endif
+        }
+
+        /**
+        Returns true if SEAL was built with AVX-512 kernels and the host CPU can run them.
+        */
+        SEAL_NODISCARD inline bool use_avx512()
+        {
+#ifdef SEAL_USE_AVX512
+            return cpu_features().avx512f;
+#else
+            return false;
+#endif
+        }
+
+        /**
+        Returns true if SEAL was built with AES-NI kernels and the host CPU can run them.
+        */
+        SEAL_NODISCARD inline bool use_aes_ni()
+        {
+#ifdef SEAL_USE_AES_NI
+            return cpu_features().aes;
+#else
+            return false;
+#endif
+        }
+
+        /**
+        Returns true if SEAL was built with SVE kernels and the host CPU can run them.
+        */
+        SEAL_NODISCARD inline bool use_sve()
+        {
+#ifdef SEAL_USE_SVE
+            return cpu_features().sve;
+#else
+            return false;
+#endif
+        }
+    } // namespace util
+} // namespace seal
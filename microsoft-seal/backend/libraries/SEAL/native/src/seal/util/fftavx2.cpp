@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_AVX2_FLAGS. Nothing in it may run before use_avx2() has been checked,
+// and it must not use inline functions or templates shared with other translation units: the linker could pick the
+// AVX2 copy for the whole program. All helpers are therefore in an anonymous namespace, and std::complex values are
+// only accessed as pairs of doubles.
+
+#include "seal/util/fftavx2.h"
+
+#ifdef SEAL_USE_AVX2
+#include <cstddef>
+#include <immintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx2
+        {
+            namespace
+            {
+                // Roots split into real and imaginary parts, one per complex lane
+                struct Root2
+                {
+                    __m256d re;
+                    __m256d im;
+                };
+
+                // The same root (real, imaginary) for both lanes
+                inline Root2 broadcast(const double *root)
+                {
+                    return { _mm256_broadcast_sd(root), _mm256_broadcast_sd(root + 1) };
+                }
+
+                // Two consecutive roots, one per lane
+                inline Root2 load_pair(const double *roots)
+                {
+                    __m256d r = _mm256_loadu_pd(roots);
+                    return { _mm256_movedup_pd(r), _mm256_permute_pd(r, 0xF) };
+                }
+
+                inline Root2 scale(const Root2 &r, __m256d s)
+                {
+                    return { _mm256_mul_pd(r.re, s), _mm256_mul_pd(r.im, s) };
+                }
+
+                // (ar * rr - ai * ri, ai * rr + ar * ri), the products and sums of std::complex<double> multiplication
+                inline __m256d mul_root(__m256d a, const Root2 &r)
+                {
+                    return _mm256_addsub_pd(_mm256_mul_pd(a, r.re), _mm256_mul_pd(_mm256_permute_pd(a, 0x5), r.im));
+                }
+
+                // Two (x, y) pairs of neighboring groups in a and b, to x = (x0, x1) and y = (y0, y1)
+                inline void split_pairs(__m256d a, __m256d b, __m256d &x, __m256d &y)
+                {
+                    x = _mm256_permute2f128_pd(a, b, 0x20);
+                    y = _mm256_permute2f128_pd(a, b, 0x31);
+                }
+
+                inline void store_pairs(double *values, __m256d x, __m256d y)
+                {
+                    _mm256_storeu_pd(values, _mm256_permute2f128_pd(x, y, 0x20));
+                    _mm256_storeu_pd(values + 4, _mm256_permute2f128_pd(x, y, 0x31));
+                }
+            } // namespace
+
+            void fft_transform_to_rev(
+                complex<double> *values, int log_n, const complex<double> *roots, const double *scalar)
+            {
+                double *data = reinterpret_cast<double *>(values);
+                const double *root = reinterpret_cast<const double *>(roots);
+                size_t n = size_t(1) << log_n;
+                size_t gap = n >> 1;
+                size_t m = 1;
+
+                // root + 2 * k is roots[k]; the 0-th power is unused
+                size_t k = 1;
+                for (; m < (n >> 1); m <<= 1)
+                {
+                    for (size_t i = 0; i < m; i++, k++)
+                    {
+                        Root2 r = broadcast(root + 2 * k);
+                        double *x = data + 4 * gap * i;
+                        double *y = x + 2 * gap;
+                        for (size_t j = 0; j < gap; j += 2, x += 4, y += 4)
+                        {
+                            __m256d u = _mm256_loadu_pd(x);
+                            __m256d v = mul_root(_mm256_loadu_pd(y), r);
+                            _mm256_storeu_pd(x, _mm256_add_pd(u, v));
+                            _mm256_storeu_pd(y, _mm256_sub_pd(u, v));
+                        }
+                    }
+                    gap >>= 1;
+                }
+
+                // Last layer: one butterfly per root, two groups at a time
+                __m256d s = _mm256_set1_pd(scalar ? *scalar : 1.0);
+                for (size_t i = 0; i < m; i += 2, k += 2, data += 8)
+                {
+                    __m256d u;
+                    __m256d y;
+                    split_pairs(_mm256_loadu_pd(data), _mm256_loadu_pd(data + 4), u, y);
+                    Root2 r = load_pair(root + 2 * k);
+                    if (scalar)
+                    {
+                        r = scale(r, s);
+                        u = _mm256_mul_pd(u, s);
+                    }
+                    __m256d v = mul_root(y, r);
+                    store_pairs(data, _mm256_add_pd(u, v), _mm256_sub_pd(u, v));
+                }
+            }
+
+            void fft_transform_from_rev(
+                complex<double> *values, int log_n, const complex<double> *roots, const double *scalar)
+            {
+                double *data = reinterpret_cast<double *>(values);
+                const double *root = reinterpret_cast<const double *>(roots);
+                size_t n = size_t(1) << log_n;
+                size_t gap = 1;
+                size_t m = n >> 1;
+
+                // First layer: one butterfly per root, two groups at a time
+                size_t k = 1;
+                double *x = data;
+                for (size_t i = 0; i < m; i += 2, k += 2, x += 8)
+                {
+                    __m256d u;
+                    __m256d v;
+                    split_pairs(_mm256_loadu_pd(x), _mm256_loadu_pd(x + 4), u, v);
+                    store_pairs(x, _mm256_add_pd(u, v), mul_root(_mm256_sub_pd(u, v), load_pair(root + 2 * k)));
+                }
+                m >>= 1;
+                gap <<= 1;
+
+                for (; m > 1; m >>= 1)
+                {
+                    for (size_t i = 0; i < m; i++, k++)
+                    {
+                        Root2 r = broadcast(root + 2 * k);
+                        x = data + 4 * gap * i;
+                        double *y = x + 2 * gap;
+                        for (size_t j = 0; j < gap; j += 2, x += 4, y += 4)
+                        {
+                            __m256d u = _mm256_loadu_pd(x);
+                            __m256d v = _mm256_loadu_pd(y);
+                            _mm256_storeu_pd(x, _mm256_add_pd(u, v));
+                            _mm256_storeu_pd(y, mul_root(_mm256_sub_pd(u, v), r));
+                        }
+                    }
+                    gap <<= 1;
+                }
+
+                // Last layer, with the scalar merged in
+                Root2 r = broadcast(root + 2 * k);
+                __m256d s = _mm256_set1_pd(scalar ? *scalar : 1.0);
+                if (scalar)
+                {
+                    r = scale(r, s);
+                }
+                x = data;
+                double *y = x + 2 * gap;
+                for (size_t j = 0; j < gap; j += 2, x += 4, y += 4)
+                {
+                    __m256d u = _mm256_loadu_pd(x);
+                    __m256d v = _mm256_loadu_pd(y);
+                    __m256d sum = _mm256_add_pd(u, v);
+                    _mm256_storeu_pd(x, scalar ? _mm256_mul_pd(sum, s) : sum);
+                    _mm256_storeu_pd(y, mul_root(_mm256_sub_pd(u, v), r));
+                }
+            }
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_AVX2
+#include <complex>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        AVX2 kernels for the complex DWT of CKKSEncoder. They compute the same butterflies as
+        DWTHandler<std::complex<double>, std::complex<double>, double> in the same order and without FMA, so for finite
+        inputs the output matches the portable transform unless the compiler contracted the portable code into FMAs.
+        They must only be called when use_avx2() is true; CKKSEncoder dispatches to them automatically.
+
+        Two complex values are processed per instruction. The last layer of each direction, which has a single
+        butterfly per root, is vectorized across neighboring groups instead.
+
+        The implementation is compiled with AVX2 enabled, so it only reads and writes through the pointers and must
+        not instantiate any inline function (including std::complex arithmetic) that other translation units also use.
+        */
+        namespace avx2
+        {
+            /**
+            Same as DWTHandler::transform_to_rev, used by CKKSEncoder::decode.
+
+            @param[in,out] values The 2^log_n values in normal order; outputs in bit-reversed order
+            @param[in] log_n Logarithm of the transform size; must be at least 3
+            @param[in] roots Powers of the root in bit-reversed order
+            @param[in] scalar An optional scalar that is multiplied to all output values
+            */
+            void fft_transform_to_rev(
+                std::complex<double> *values, int log_n, const std::complex<double> *roots, const double *scalar);
+
+            /**
+            Same as DWTHandler::transform_from_rev, used by CKKSEncoder::encode.
+
+            @param[in,out] values The 2^log_n values in bit-reversed order; outputs in normal order
+            @param[in] log_n Logarithm of the transform size; must be at least 3
+            @param[in] roots Powers of the root in scrambled order
+            @param[in] scalar An optional scalar that is multiplied to all output values
+            */
+            void fft_transform_from_rev(
+                std::complex<double> *values, int log_n, const std::complex<double> *roots, const double *scalar);
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
+#endif
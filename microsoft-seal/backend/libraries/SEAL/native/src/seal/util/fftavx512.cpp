@@ -0,0 +1,226 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_AVX512_FLAGS. Nothing in it may run before use_avx512() has been
+// checked, and it must not use inline functions or templates shared with other translation units; see fftavx2.cpp.
+
+#include "seal/util/fftavx512.h"
+
+#ifdef SEAL_USE_AVX512
+#include <cstddef>
+#include <immintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx512
+        {
+            namespace
+            {
+                // Roots split into real and imaginary parts, one per complex lane
+                struct Root4
+                {
+                    __m512d re;
+                    __m512d im;
+                };
+
+                inline Root4 split(__m512d r)
+                {
+                    return { _mm512_movedup_pd(r), _mm512_permute_pd(r, 0xFF) };
+                }
+
+                // The same root for all lanes
+                inline Root4 broadcast(const double *root)
+                {
+                    return { _mm512_set1_pd(root[0]), _mm512_set1_pd(root[1]) };
+                }
+
+                // Two consecutive roots, each for two neighboring lanes
+                inline Root4 load_pairs(const double *roots)
+                {
+                    __m512d r = _mm512_castpd256_pd512(_mm256_loadu_pd(roots));
+                    return split(_mm512_shuffle_f64x2(r, r, _MM_SHUFFLE(1, 1, 0, 0)));
+                }
+
+                // Four consecutive roots, one per lane
+                inline Root4 load_quad(const double *roots)
+                {
+                    return split(_mm512_loadu_pd(roots));
+                }
+
+                inline Root4 scale(const Root4 &r, __m512d s)
+                {
+                    return { _mm512_mul_pd(r.re, s), _mm512_mul_pd(r.im, s) };
+                }
+
+                // (ar * rr - ai * ri, ai * rr + ar * ri), the products and sums of std::complex<double> multiplication
+                inline __m512d mul_root(__m512d a, const Root4 &r)
+                {
+                    __m512d t1 = _mm512_mul_pd(a, r.re);
+                    __m512d t2 = _mm512_mul_pd(_mm512_permute_pd(a, 0x55), r.im);
+                    return _mm512_mask_sub_pd(_mm512_add_pd(t1, t2), 0x55, t1, t2);
+                }
+
+                // Two groups of (x0, x1, y0, y1) in a and b, to the x and the y halves of both
+                inline void split_gap2(__m512d a, __m512d b, __m512d &x, __m512d &y)
+                {
+                    x = _mm512_shuffle_f64x2(a, b, _MM_SHUFFLE(1, 0, 1, 0));
+                    y = _mm512_shuffle_f64x2(a, b, _MM_SHUFFLE(3, 2, 3, 2));
+                }
+
+                inline void store_gap2(double *values, __m512d x, __m512d y)
+                {
+                    _mm512_storeu_pd(values, _mm512_shuffle_f64x2(x, y, _MM_SHUFFLE(1, 0, 1, 0)));
+                    _mm512_storeu_pd(values + 8, _mm512_shuffle_f64x2(x, y, _MM_SHUFFLE(3, 2, 3, 2)));
+                }
+
+                // Four (x, y) pairs of neighboring groups in a and b, to x = (x0, ..., x3) and y = (y0, ..., y3)
+                inline void split_gap1(__m512d a, __m512d b, __m512d &x, __m512d &y)
+                {
+                    x = _mm512_shuffle_f64x2(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                    y = _mm512_shuffle_f64x2(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                }
+
+                inline void store_gap1(double *values, __m512d x, __m512d y)
+                {
+                    __m512d lo = _mm512_shuffle_f64x2(x, y, _MM_SHUFFLE(1, 0, 1, 0));
+                    __m512d hi = _mm512_shuffle_f64x2(x, y, _MM_SHUFFLE(3, 2, 3, 2));
+                    _mm512_storeu_pd(values, _mm512_shuffle_f64x2(lo, lo, _MM_SHUFFLE(3, 1, 2, 0)));
+                    _mm512_storeu_pd(values + 8, _mm512_shuffle_f64x2(hi, hi, _MM_SHUFFLE(3, 1, 2, 0)));
+                }
+            } // namespace
+
+            void fft_transform_to_rev(
+                complex<double> *values, int log_n, const complex<double> *roots, const double *scalar)
+            {
+                double *data = reinterpret_cast<double *>(values);
+                const double *root = reinterpret_cast<const double *>(roots);
+                size_t n = size_t(1) << log_n;
+                size_t gap = n >> 1;
+                size_t m = 1;
+
+                // root + 2 * k is roots[k]; the 0-th power is unused
+                size_t k = 1;
+                for (; gap >= 4; m <<= 1)
+                {
+                    for (size_t i = 0; i < m; i++, k++)
+                    {
+                        Root4 r = broadcast(root + 2 * k);
+                        double *x = data + 4 * gap * i;
+                        double *y = x + 2 * gap;
+                        for (size_t j = 0; j < gap; j += 4, x += 8, y += 8)
+                        {
+                            __m512d u = _mm512_loadu_pd(x);
+                            __m512d v = mul_root(_mm512_loadu_pd(y), r);
+                            _mm512_storeu_pd(x, _mm512_add_pd(u, v));
+                            _mm512_storeu_pd(y, _mm512_sub_pd(u, v));
+                        }
+                    }
+                    gap >>= 1;
+                }
+
+                // Two butterflies per root, two groups at a time
+                double *x = data;
+                for (size_t i = 0; i < m; i += 2, k += 2, x += 16)
+                {
+                    __m512d u;
+                    __m512d y;
+                    split_gap2(_mm512_loadu_pd(x), _mm512_loadu_pd(x + 8), u, y);
+                    __m512d v = mul_root(y, load_pairs(root + 2 * k));
+                    store_gap2(x, _mm512_add_pd(u, v), _mm512_sub_pd(u, v));
+                }
+                m <<= 1;
+
+                // Last layer: one butterfly per root, four groups at a time
+                __m512d s = _mm512_set1_pd(scalar ? *scalar : 1.0);
+                for (size_t i = 0; i < m; i += 4, k += 4, data += 16)
+                {
+                    __m512d u;
+                    __m512d y;
+                    split_gap1(_mm512_loadu_pd(data), _mm512_loadu_pd(data + 8), u, y);
+                    Root4 r = load_quad(root + 2 * k);
+                    if (scalar)
+                    {
+                        r = scale(r, s);
+                        u = _mm512_mul_pd(u, s);
+                    }
+                    __m512d v = mul_root(y, r);
+                    store_gap1(data, _mm512_add_pd(u, v), _mm512_sub_pd(u, v));
+                }
+            }
+
+            void fft_transform_from_rev(
+                complex<double> *values, int log_n, const complex<double> *roots, const double *scalar)
+            {
+                double *data = reinterpret_cast<double *>(values);
+                const double *root = reinterpret_cast<const double *>(roots);
+                size_t n = size_t(1) << log_n;
+                size_t m = n >> 1;
+
+                // First layer: one butterfly per root, four groups at a time
+                size_t k = 1;
+                double *x = data;
+                for (size_t i = 0; i < m; i += 4, k += 4, x += 16)
+                {
+                    __m512d u;
+                    __m512d v;
+                    split_gap1(_mm512_loadu_pd(x), _mm512_loadu_pd(x + 8), u, v);
+                    store_gap1(x, _mm512_add_pd(u, v), mul_root(_mm512_sub_pd(u, v), load_quad(root + 2 * k)));
+                }
+                m >>= 1;
+
+                // Two butterflies per root, two groups at a time
+                x = data;
+                for (size_t i = 0; i < m; i += 2, k += 2, x += 16)
+                {
+                    __m512d u;
+                    __m512d v;
+                    split_gap2(_mm512_loadu_pd(x), _mm512_loadu_pd(x + 8), u, v);
+                    store_gap2(x, _mm512_add_pd(u, v), mul_root(_mm512_sub_pd(u, v), load_pairs(root + 2 * k)));
+                }
+                m >>= 1;
+
+                size_t gap = 4;
+                for (; m > 1; m >>= 1)
+                {
+                    for (size_t i = 0; i < m; i++, k++)
+                    {
+                        Root4 r = broadcast(root + 2 * k);
+                        x = data + 4 * gap * i;
+                        double *y = x + 2 * gap;
+                        for (size_t j = 0; j < gap; j += 4, x += 8, y += 8)
+                        {
+                            __m512d u = _mm512_loadu_pd(x);
+                            __m512d v = _mm512_loadu_pd(y);
+                            _mm512_storeu_pd(x, _mm512_add_pd(u, v));
+                            _mm512_storeu_pd(y, mul_root(_mm512_sub_pd(u, v), r));
+                        }
+                    }
+                    gap <<= 1;
+                }
+
+                // Last layer, with the scalar merged in
+                Root4 r = broadcast(root + 2 * k);
+                __m512d s = _mm512_set1_pd(scalar ? *scalar : 1.0);
+                if (scalar)
+                {
+                    r = scale(r, s);
+                }
+                x = data;
+                double *y = x + 2 * gap;
+                for (size_t j = 0; j < gap; j += 4, x += 8, y += 8)
+                {
+                    __m512d u = _mm512_loadu_pd(x);
+                    __m512d v = _mm512_loadu_pd(y);
+                    __m512d sum = _mm512_add_pd(u, v);
+                    _mm512_storeu_pd(x, scalar ? _mm512_mul_pd(sum, s) : sum);
+                    _mm512_storeu_pd(y, mul_root(_mm512_sub_pd(u, v), r));
+                }
+            }
+        } // namespace avx512
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_AVX512
+#include <complex>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        AVX-512F kernels for the complex DWT of CKKSEncoder, with the same contract as the AVX2 kernels in fftavx2.h.
+        They must only be called when use_avx512() is true; the dispatch prefers them over AVX2.
+
+        Four complex values are processed per instruction. The layers with two butterflies and with one butterfly per
+        root are vectorized across two and four neighboring groups.
+        */
+        namespace avx512
+        {
+            /**
+            Same as DWTHandler::transform_to_rev, used by CKKSEncoder::decode.
+
+            @param[in,out] values The 2^log_n values in normal order; outputs in bit-reversed order
+            @param[in] log_n Logarithm of the transform size; must be at least 3
+            @param[in] roots Powers of the root in bit-reversed order
+            @param[in] scalar An optional scalar that is multiplied to all output values
+            */
+            void fft_transform_to_rev(
+                std::complex<double> *values, int log_n, const std::complex<double> *roots, const double *scalar);
+
+            /**
+            Same as DWTHandler::transform_from_rev, used by CKKSEncoder::encode.
+
+            @param[in,out] values The 2^log_n values in bit-reversed order; outputs in normal order
+            @param[in] log_n Logarithm of the transform size; must be at least 3
+            @param[in] roots Powers of the root in scrambled order
+            @param[in] scalar An optional scalar that is multiplied to all output values
+            */
+            void fft_transform_from_rev(
+                std::complex<double> *values, int log_n, const std::complex<double> *roots, const double *scalar);
+        } // namespace avx512
+    } // namespace util
+} // namespace seal
+#endif
@@ -15,7 +15,7 @@ namespace seal
         // ensure symbol is created.
         constexpr uint32_t GaloisTool::generator_;
 
-        void GaloisTool::generate_table_ntt(uint32_t galois_elt, Pointer<uint32_t> &result) const
+        const uint32_t *GaloisTool::generate_table_ntt(uint32_t galois_elt) const
         {
 #ifdef SEAL_DEBUG
             if (!(galois_elt & 1) || (galois_elt >= 2 * (uint64_t(1) << coeff_count_power_)))
@@ -23,13 +23,6 @@ namespace seal
                 throw invalid_argument("Galois element is not valid");
             }
 #endif
-            ReaderLock reader_lock(permutation_tables_locker_.acquire_read());
-            if (result)
-            {
-                return;
-            }
-            reader_lock.unlock();
-
             auto temp(allocate<uint32_t>(coeff_count_, pool_));
             auto temp_ptr = temp.get();
 
@@ -42,12 +35,30 @@ namespace seal
                 *temp_ptr++ = reverse_bits<uint32_t>(static_cast<uint32_t>(index_raw), coeff_count_power_);
             }
 
-            WriterLock writer_lock(permutation_tables_locker_.acquire_write());
-            if (result)
+            // Another thread may have published the same table meanwhile
+            lock_guard<mutex> lock(permutation_tables_mutex_);
+            auto &slot = permutation_tables_[GetIndexFromElt(galois_elt)];
+            const uint32_t *table = slot.load(memory_order_relaxed);
+            if (table)
+            {
+                return table;
+            }
+            table = temp.get();
+            permutation_table_storage_.push_back(std::move(temp));
+            slot.store(table, memory_order_release);
+            return table;
+        }
+
+        void GaloisTool::precompute_tables_ntt(const vector<uint32_t> &galois_elts) const
+        {
+            for (uint32_t galois_elt : galois_elts)
             {
-                return;
+                if (!(galois_elt & 1) || (galois_elt >= 2 * (uint64_t(1) << coeff_count_power_)))
+                {
+                    throw invalid_argument("Galois element is not valid");
+                }
+                static_cast<void>(table_ntt(galois_elt));
             }
-            result.acquire(std::move(temp));
         }
 
         uint32_t GaloisTool::get_elt_from_step(int step) const
@@ -141,8 +152,12 @@ namespace seal
             coeff_count_power_ = coeff_count_power;
             coeff_count_ = size_t(1) << coeff_count_power_;
 
-            // Capacity for coeff_count_ number of tables
-            permutation_tables_ = allocate<Pointer<uint32_t>>(coeff_count_, pool_);
+            // Capacity for coeff_count_ number of tables, all empty
+            permutation_tables_.reset(new atomic<const uint32_t *>[coeff_count_]);
+            for (size_t i = 0; i < coeff_count_; i++)
+            {
+                permutation_tables_[i].store(nullptr, memory_order_relaxed);
+            }
         }
 
         void GaloisTool::apply_galois(
@@ -210,8 +225,7 @@ namespace seal
                 throw invalid_argument("Galois element is not valid");
             }
 #endif
-            generate_table_ntt(galois_elt, permutation_tables_[GetIndexFromElt(galois_elt)]);
-            auto table = iter(permutation_tables_[GetIndexFromElt(galois_elt)]);
+            auto table = iter(table_ntt(galois_elt));
 
             // Perform permutation.
             SEAL_ITERATE(iter(table, result), coeff_count_, [&](auto I) { get<1>(I) = operand[get<0>(I)]; });
@@ -8,9 +8,13 @@
 #include "seal/util/defines.h"
 #include "seal/util/iterator.h"
 #include "seal/util/pointer.h"
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <vector>
 
 namespace seal
 {
@@ -118,6 +122,15 @@ namespace seal
                 });
             }
 
+            /**
+            Builds the permutation tables of apply_galois_ntt for the given Galois elements now, so that applying them
+            later is a plain table lookup. Tables that already exist are kept; this may be called concurrently with
+            apply_galois_ntt.
+
+            @throws std::invalid_argument if a Galois element is not valid
+            */
+            void precompute_tables_ntt(const std::vector<std::uint32_t> &galois_elts) const;
+
             /**
             Compute the Galois element corresponding to a given rotation step.
             */
@@ -158,7 +171,14 @@ namespace seal
 
             void initialize(int coeff_count_power);
 
-            void generate_table_ntt(std::uint32_t galois_elt, Pointer<std::uint32_t> &result) const;
+            SEAL_NODISCARD inline const std::uint32_t *table_ntt(std::uint32_t galois_elt) const
+            {
+                const std::uint32_t *table =
+                    permutation_tables_[GetIndexFromElt(galois_elt)].load(std::memory_order_acquire);
+                return table ? table : generate_table_ntt(galois_elt);
+            }
+
+            const std::uint32_t *generate_table_ntt(std::uint32_t galois_elt) const;
 
             MemoryPoolHandle pool_;
 
@@ -168,9 +188,13 @@ namespace seal
 
             static constexpr std::uint32_t generator_ = 3;
 
-            mutable Pointer<Pointer<std::uint32_t>> permutation_tables_;
+            // One slot per Galois element; a table is published once and never changes, so lookups take no lock
+            std::unique_ptr<std::atomic<const std::uint32_t *>[]> permutation_tables_;
+
+            // Owns the published tables (64-byte aligned by the pool); only touched under the mutex
+            mutable std::vector<Pointer<std::uint32_t>> permutation_table_storage_;
 
-            mutable util::ReaderWriterLocker permutation_tables_locker_;
+            mutable std::mutex permutation_tables_mutex_;
         };
     } // namespace util
 } // namespace seal
@@ -0,0 +1,219 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/util/common.h"
+#include "seal/util/hugepages.h"
+#include <atomic>
+#include <new>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#define SEAL_HUGE_PAGES_LINUX
+#endif
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace
+        {
+            atomic<huge_page_mode> config_mode{ huge_page_mode::none };
+            atomic<size_t> config_min_byte_count{ size_t(2) << 20 };
+            atomic<bool> config_numa_local{ false };
+
+            atomic<size_t> transparent_byte_count{ 0 };
+            atomic<size_t> hugetlb_2mb_page_count{ 0 };
+            atomic<size_t> hugetlb_1gb_page_count{ 0 };
+            atomic<size_t> fallback_count{ 0 };
+
+            constexpr size_t page_2mb = size_t(1) << 21;
+            constexpr size_t page_1gb = size_t(1) << 30;
+
+            inline size_t round_up(size_t byte_count, size_t page)
+            {
+                return add_safe(byte_count, page - 1) & ~(page - 1);
+            }
+
+#ifdef SEAL_HUGE_PAGES_LINUX
+            // Prefers the node of the calling thread for the pages of [ptr, ptr + length), before they are touched.
+            // Failures (no NUMA support, or a seccomp filter) leave the default first-touch policy in place.
+            void bind_local(void *ptr, size_t length) noexcept
+            {
+                unsigned cpu = 0;
+                unsigned node = 0;
+                if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= 64)
+                {
+                    return;
+                }
+                constexpr int mpol_preferred = 1;
+                unsigned long nodemask = 1UL << node;
+                static_cast<void>(syscall(SYS_mbind, ptr, length, mpol_preferred, &nodemask, 64UL, 0U));
+            }
+
+            seal_byte *map_hugetlb(size_t byte_count, size_t page, int page_shift)
+            {
+                size_t length = round_up(byte_count, page);
+                void *ptr = mmap(
+                    nullptr, length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (page_shift << MAP_HUGE_SHIFT), -1, 0);
+                return ptr == MAP_FAILED ? nullptr : static_cast<seal_byte *>(ptr);
+            }
+
+            // 2 MiB aligned anonymous memory, marked for transparent huge pages
+            seal_byte *map_transparent(size_t byte_count)
+            {
+                size_t length = round_up(byte_count, page_2mb);
+                void *ptr = mmap(nullptr, length + page_2mb, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (ptr == MAP_FAILED)
+                {
+                    return nullptr;
+                }
+
+                // Trim the mapping to the aligned part
+                auto address = reinterpret_cast<uintptr_t>(ptr);
+                uintptr_t aligned = (address + page_2mb - 1) & ~uintptr_t(page_2mb - 1);
+                if (aligned > address)
+                {
+                    munmap(ptr, aligned - address);
+                }
+                size_t tail = address + length + page_2mb - (aligned + length);
+                if (tail)
+                {
+                    munmap(reinterpret_cast<void *>(aligned + length), tail);
+                }
+                madvise(reinterpret_cast<void *>(aligned), length, MADV_HUGEPAGE);
+                return reinterpret_cast<seal_byte *>(aligned);
+            }
+#endif
+        } // namespace
+
+        void set_huge_page_config(const HugePageConfig &config)
+        {
+#ifndef SEAL_HUGE_PAGES_LINUX
+            if (config.mode != huge_page_mode::none)
+            {
+                throw invalid_argument("huge pages are not supported on this platform");
+            }
+#endif
+            if (config.mode > huge_page_mode::hugetlb_1gb)
+            {
+                throw invalid_argument("invalid huge page mode");
+            }
+            config_min_byte_count.store(config.min_byte_count, memory_order_relaxed);
+            config_numa_local.store(config.numa_local, memory_order_relaxed);
+            config_mode.store(config.mode, memory_order_relaxed);
+        }
+
+        HugePageConfig huge_page_config() noexcept
+        {
+            HugePageConfig config;
+            config.mode = config_mode.load(memory_order_relaxed);
+            config.min_byte_count = config_min_byte_count.load(memory_order_relaxed);
+            config.numa_local = config_numa_local.load(memory_order_relaxed);
+            return config;
+        }
+
+        HugePageStats huge_page_stats() noexcept
+        {
+            HugePageStats stats;
+            stats.transparent_byte_count = transparent_byte_count.load(memory_order_relaxed);
+            stats.hugetlb_2mb_page_count = hugetlb_2mb_page_count.load(memory_order_relaxed);
+            stats.hugetlb_1gb_page_count = hugetlb_1gb_page_count.load(memory_order_relaxed);
+            stats.fallback_count = fallback_count.load(memory_order_relaxed);
+            return stats;
+        }
+
+        seal_byte *allocate_pool_block(size_t byte_count, huge_page_mode &backing)
+        {
+            huge_page_mode mode = config_mode.load(memory_order_relaxed);
+            seal_byte *ptr = nullptr;
+#ifdef SEAL_HUGE_PAGES_LINUX
+            if (mode != huge_page_mode::none && byte_count >= config_min_byte_count.load(memory_order_relaxed))
+            {
+                if (mode == huge_page_mode::hugetlb_1gb)
+                {
+                    ptr = map_hugetlb(byte_count, page_1gb, 30);
+                    if (ptr)
+                    {
+                        hugetlb_1gb_page_count.fetch_add(round_up(byte_count, page_1gb) / page_1gb);
+                        backing = huge_page_mode::hugetlb_1gb;
+                    }
+                }
+                if (!ptr && mode >= huge_page_mode::hugetlb_2mb)
+                {
+                    ptr = map_hugetlb(byte_count, page_2mb, 21);
+                    if (ptr)
+                    {
+                        hugetlb_2mb_page_count.fetch_add(round_up(byte_count, page_2mb) / page_2mb);
+                        backing = huge_page_mode::hugetlb_2mb;
+                    }
+                }
+                if (!ptr)
+                {
+                    ptr = map_transparent(byte_count);
+                    if (ptr)
+                    {
+                        transparent_byte_count.fetch_add(round_up(byte_count, page_2mb));
+                        backing = huge_page_mode::transparent;
+                    }
+                }
+                if (ptr)
+                {
+                    if (backing != mode)
+                    {
+                        fallback_count.fetch_add(1);
+                    }
+                    if (config_numa_local.load(memory_order_relaxed))
+                    {
+                        size_t page = backing == huge_page_mode::hugetlb_1gb ? page_1gb : page_2mb;
+                        bind_local(ptr, round_up(byte_count, page));
+                    }
+                    return ptr;
+                }
+                fallback_count.fetch_add(1);
+            }
+#endif
+            ptr = SEAL_MALLOC(byte_count);
+            if (ptr == nullptr)
+            {
+                throw bad_alloc();
+            }
+            backing = huge_page_mode::none;
+            return ptr;
+        }
+
+        void free_pool_block(seal_byte *ptr, size_t byte_count, huge_page_mode backing) noexcept
+        {
+            switch (backing)
+            {
+#ifdef SEAL_HUGE_PAGES_LINUX
+            case huge_page_mode::transparent:
+                munmap(ptr, round_up(byte_count, page_2mb));
+                transparent_byte_count.fetch_sub(round_up(byte_count, page_2mb));
+                break;
+
+            case huge_page_mode::hugetlb_2mb:
+                munmap(ptr, round_up(byte_count, page_2mb));
+                hugetlb_2mb_page_count.fetch_sub(round_up(byte_count, page_2mb) / page_2mb);
+                break;
+
+            case huge_page_mode::hugetlb_1gb:
+                munmap(ptr, round_up(byte_count, page_1gb));
+                hugetlb_1gb_page_count.fetch_sub(round_up(byte_count, page_1gb) / page_1gb);
+                break;
+#endif
+            default:
+                SEAL_FREE(ptr);
+                break;
+            }
+        }
+    } // namespace util
+} // namespace seal
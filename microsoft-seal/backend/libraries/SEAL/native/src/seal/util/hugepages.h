@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        Page sizes the memory pools can back their large allocations with. transparent maps 2 MiB aligned memory and
+        asks the kernel for transparent huge pages (madvise), which it grants as they are available; hugetlb_2mb and
+        hugetlb_1gb map explicit huge pages from the reserved hugetlbfs pool (vm.nr_hugepages, or the per-size counts
+        under /sys/kernel/mm/hugepages).
+        */
+        enum class huge_page_mode : std::uint8_t
+        {
+            none = 0,
+
+            transparent = 1,
+
+            hugetlb_2mb = 2,
+
+            hugetlb_1gb = 3
+        };
+
+        /**
+        Process-wide allocation policy of the memory pools; see set_huge_page_config.
+        */
+        struct HugePageConfig
+        {
+            huge_page_mode mode = huge_page_mode::none;
+
+            // Allocations smaller than this keep using the ordinary allocator
+            std::size_t min_byte_count = std::size_t(2) << 20;
+
+            // Prefer the NUMA node of the allocating thread, even for pages first touched by another thread
+            bool numa_local = false;
+        };
+
+        /**
+        Memory counts of the huge page allocator. Mapped memory is counted until it is unmapped; for transparent huge
+        pages the kernel decides how much of transparent_byte_count is actually backed by huge pages (AnonHugePages in
+        /proc/self/smaps_rollup).
+        */
+        struct HugePageStats
+        {
+            std::size_t transparent_byte_count = 0;
+
+            std::size_t hugetlb_2mb_page_count = 0;
+
+            std::size_t hugetlb_1gb_page_count = 0;
+
+            // Allocations that could not get the configured page size and used a smaller one
+            std::size_t fallback_count = 0;
+        };
+
+        /**
+        Sets how the memory pools (MemoryPoolMT, MemoryPoolST and MemoryPoolArena) allocate their blocks from now on.
+        Blocks allocated before keep their backing. Explicit huge pages that cannot be mapped fall back to 2 MiB
+        pages, then to transparent huge pages, then to the ordinary allocator.
+
+        @throws std::invalid_argument if mode is not none and the platform has no huge page support (only Linux has)
+        */
+        void set_huge_page_config(const HugePageConfig &config);
+
+        SEAL_NODISCARD HugePageConfig huge_page_config() noexcept;
+
+        SEAL_NODISCARD HugePageStats huge_page_stats() noexcept;
+
+        /**
+        Allocates byte_count bytes, aligned to at least 64 bytes, for a memory pool block according to the current
+        configuration; backing receives what has to be passed to free_pool_block.
+
+        @throws std::bad_alloc if the allocation fails
+        */
+        SEAL_NODISCARD seal_byte *allocate_pool_block(std::size_t byte_count, huge_page_mode &backing);
+
+        /**
+        Frees a block from allocate_pool_block with the same byte_count and backing.
+        */
+        void free_pool_block(seal_byte *ptr, std::size_t byte_count, huge_page_mode backing) noexcept;
+    } // namespace util
+} // namespace seal
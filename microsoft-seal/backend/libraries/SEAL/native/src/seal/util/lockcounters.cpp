@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/lockcounts.h"
+#include "seal/util/lockcounters.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace
+        {
+            struct Registration;
+
+            // Live threads' counters, and what exited threads counted, summed per label. Never destroyed, since
+            // threads may exit after static destruction has started.
+            struct Registry
+            {
+                mutex registry_mutex;
+
+                vector<Registration *> live;
+
+                map<string, LockCounts::ThreadGroup> exited;
+            };
+
+            Registry &registry()
+            {
+                static Registry *instance = new Registry;
+                return *instance;
+            }
+
+            void add(LockCounts::ThreadGroup &group, const ThreadLockCounters &counters)
+            {
+                for (size_t site = 0; site < lock_site_count; site++)
+                {
+                    for (size_t mode = 0; mode < lock_mode_count; mode++)
+                    {
+                        const LockSiteCounters &from = counters.sites[site][mode];
+                        LockCounts::Counts &to = group.counts[site][mode];
+                        to.acquisitions += from.acquisitions.load(memory_order_relaxed);
+                        to.contended += from.contended.load(memory_order_relaxed);
+                        to.wait_ns += from.wait_ns.load(memory_order_relaxed);
+                    }
+                }
+            }
+
+            struct Registration
+            {
+                ThreadLockCounters counters;
+
+                string label;
+
+                Registration()
+                {
+                    Registry &reg = registry();
+                    lock_guard<mutex> lock(reg.registry_mutex);
+                    reg.live.push_back(this);
+                }
+
+                ~Registration()
+                {
+                    Registry &reg = registry();
+                    lock_guard<mutex> lock(reg.registry_mutex);
+                    LockCounts::ThreadGroup &group = reg.exited[label];
+                    group.label = label;
+                    add(group, counters);
+                    for (auto it = reg.live.begin(); it != reg.live.end(); ++it)
+                    {
+                        if (*it == this)
+                        {
+                            reg.live.erase(it);
+                            break;
+                        }
+                    }
+                }
+            };
+
+            Registration &thread_registration()
+            {
+                static thread_local Registration registration;
+                return registration;
+            }
+        } // namespace
+
+        ThreadLockCounters &thread_lock_counters()
+        {
+            return thread_registration().counters;
+        }
+    } // namespace util
+
+    bool LockCounts::Enabled() noexcept
+    {
+#ifdef SEAL_USE_LOCK_COUNTS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const char *LockCounts::SiteName(LockSite site) noexcept
+    {
+        switch (site)
+        {
+        case LockSite::memory_pool_head:
+            return "memory_pool_head";
+        case LockSite::memory_pool_table:
+            return "memory_pool_table";
+        case LockSite::ntt_tables:
+            return "ntt_tables";
+        case LockSite::secret_key:
+            return "secret_key";
+        default:
+            return "other";
+        }
+    }
+
+    const char *LockCounts::ModeName(LockMode mode) noexcept
+    {
+        return mode == LockMode::shared ? "shared" : "exclusive";
+    }
+
+    void LockCounts::SetThreadLabel(const string &label)
+    {
+        util::Registration &registration = util::thread_registration();
+        lock_guard<mutex> lock(util::registry().registry_mutex);
+        registration.label = label;
+    }
+
+    vector<LockCounts::ThreadGroup> LockCounts::ByLabel()
+    {
+        util::Registry &reg = util::registry();
+        lock_guard<mutex> lock(reg.registry_mutex);
+        map<string, ThreadGroup> groups = reg.exited;
+        for (const util::Registration *registration : reg.live)
+        {
+            ThreadGroup &group = groups[registration->label];
+            group.label = registration->label;
+            util::add(group, registration->counters);
+        }
+        vector<ThreadGroup> result;
+        for (auto &group : groups)
+        {
+            result.push_back(move(group.second));
+        }
+        return result;
+    }
+} // namespace seal
@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        // The locks counted by seal::LockCounts, by what they guard
+        enum class LockSite : std::uint8_t
+        {
+            // A MemoryPoolHeadMT's spinlock: every allocation and release of its size class
+            memory_pool_head = 0,
+
+            // A MemoryPoolMT's table of heads: read for every allocation, written for a new size class
+            memory_pool_table = 1,
+
+            // The process-wide NTTTables cache: read for every context created, written for new primes
+            ntt_tables = 2,
+
+            // The secret key powers of a KeyGenerator or Decryptor
+            secret_key = 3,
+
+            // Any other ReaderWriterLocker
+            other = 4
+        };
+
+        constexpr std::size_t lock_site_count = 5;
+
+        enum class LockMode : std::uint8_t
+        {
+            shared = 0,
+
+            exclusive = 1
+        };
+
+        constexpr std::size_t lock_mode_count = 2;
+
+        struct LockSiteCounters
+        {
+            std::atomic<std::uint64_t> acquisitions{ 0 };
+
+            // Acquisitions that found the lock taken and waited for it
+            std::atomic<std::uint64_t> contended{ 0 };
+
+            std::atomic<std::uint64_t> wait_ns{ 0 };
+        };
+
+        // One thread's counters. Only that thread writes them, so an update is a plain load and store without a
+        // locked instruction or a cache line shared with other threads; seal::LockCounts reads them from any thread.
+        struct ThreadLockCounters
+        {
+            LockSiteCounters sites[lock_site_count][lock_mode_count];
+        };
+
+        // The calling thread's counters, registered for seal::LockCounts on first use
+        SEAL_NODISCARD ThreadLockCounters &thread_lock_counters();
+
+        inline void count_lock(LockSite site, LockMode mode, bool contended, std::uint64_t wait_ns) noexcept
+        {
+            LockSiteCounters &counters =
+                thread_lock_counters().sites[static_cast<std::size_t>(site)][static_cast<std::size_t>(mode)];
+            counters.acquisitions.store(
+                counters.acquisitions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (contended)
+            {
+                counters.contended.store(
+                    counters.contended.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                counters.wait_ns.store(
+                    counters.wait_ns.load(std::memory_order_relaxed) + wait_ns, std::memory_order_relaxed);
+            }
+        }
+
+        // Times the wait for a lock that was not free at the first attempt
+        class LockWait
+        {
+        public:
+            LockWait() noexcept : start_(std::chrono::steady_clock::now())
+            {}
+
+            SEAL_NODISCARD inline std::uint64_t elapsed_ns() const noexcept
+            {
+                return static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_)
+                        .count());
+            }
+
+        private:
+            std::chrono::steady_clock::time_point start_;
+        };
+    } // namespace util
+} // namespace seal
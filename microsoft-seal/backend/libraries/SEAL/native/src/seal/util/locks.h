@@ -4,6 +4,7 @@
 #pragma once
 
 #include "seal/util/defines.h"
+#include "seal/util/lockcounters.h"
 
 #ifdef SEAL_USE_SHARED_MUTEX
 #include <mutex>
@@ -20,16 +21,49 @@ namespace seal
         class SEAL_NODISCARD ReaderWriterLocker
         {
         public:
-            ReaderWriterLocker() = default;
+            // The site tags the lock's acquisitions for seal::LockCounts
+            explicit ReaderWriterLocker(LockSite site = LockSite::other) noexcept
+#ifdef SEAL_USE_LOCK_COUNTS
+                : site_(site)
+#endif
+            {
+                (void)site;
+            }
 
             SEAL_NODISCARD inline ReaderLock acquire_read()
             {
+#ifdef SEAL_USE_LOCK_COUNTS
+                ReaderLock lock(rw_lock_mutex_, std::try_to_lock);
+                if (lock.owns_lock())
+                {
+                    count_lock(site_, LockMode::shared, false, 0);
+                    return lock;
+                }
+                LockWait wait;
+                lock.lock();
+                count_lock(site_, LockMode::shared, true, wait.elapsed_ns());
+                return lock;
+#else
                 return ReaderLock(rw_lock_mutex_);
+#endif
             }
 
             SEAL_NODISCARD inline WriterLock acquire_write()
             {
+#ifdef SEAL_USE_LOCK_COUNTS
+                WriterLock lock(rw_lock_mutex_, std::try_to_lock);
+                if (lock.owns_lock())
+                {
+                    count_lock(site_, LockMode::exclusive, false, 0);
+                    return lock;
+                }
+                LockWait wait;
+                lock.lock();
+                count_lock(site_, LockMode::exclusive, true, wait.elapsed_ns());
+                return lock;
+#else
                 return WriterLock(rw_lock_mutex_);
+#endif
             }
 
             SEAL_NODISCARD inline ReaderLock try_acquire_read() noexcept
@@ -48,6 +82,10 @@ namespace seal
             ReaderWriterLocker &operator=(const ReaderWriterLocker &assign) = delete;
 
             std::shared_mutex rw_lock_mutex_{};
+
+#ifdef SEAL_USE_LOCK_COUNTS
+            LockSite site_;
+#endif
         };
     } // namespace util
 } // namespace seal
@@ -179,8 +217,16 @@ namespace seal
             friend class WriterLock;
 
         public:
-            ReaderWriterLocker() noexcept : reader_locks_(0), writer_locked_(false)
-            {}
+            // The site tags the lock's acquisitions for seal::LockCounts
+            explicit ReaderWriterLocker(LockSite site = LockSite::other) noexcept
+                : reader_locks_(0), writer_locked_(false)
+#ifdef SEAL_USE_LOCK_COUNTS
+                  ,
+                  site_(site)
+#endif
+            {
+                (void)site;
+            }
 
             SEAL_NODISCARD inline ReaderLock acquire_read() noexcept
             {
@@ -210,6 +256,10 @@ namespace seal
             std::atomic<int> reader_locks_;
 
             std::atomic<bool> writer_locked_;
+
+#ifdef SEAL_USE_LOCK_COUNTS
+            LockSite site_;
+#endif
         };
 
         inline void ReaderLock::unlock() noexcept
@@ -224,6 +274,14 @@ namespace seal
 
         inline void ReaderLock::acquire(ReaderWriterLocker &locker) noexcept
         {
+#ifdef SEAL_USE_LOCK_COUNTS
+            if (try_acquire(locker))
+            {
+                count_lock(locker.site_, LockMode::shared, false, 0);
+                return;
+            }
+            LockWait wait;
+#endif
             unlock();
             do
             {
@@ -236,6 +294,9 @@ namespace seal
                         ;
                 }
             } while (locker_ == nullptr);
+#ifdef SEAL_USE_LOCK_COUNTS
+            count_lock(locker.site_, LockMode::shared, true, wait.elapsed_ns());
+#endif
         }
 
         SEAL_NODISCARD inline bool ReaderLock::try_acquire(ReaderWriterLocker &locker) noexcept
@@ -253,6 +314,14 @@ namespace seal
 
         inline void WriterLock::acquire(ReaderWriterLocker &locker) noexcept
         {
+#ifdef SEAL_USE_LOCK_COUNTS
+            if (try_acquire(locker))
+            {
+                count_lock(locker.site_, LockMode::exclusive, false, 0);
+                return;
+            }
+            LockWait wait;
+#endif
             unlock();
             bool expected = false;
             while (!locker.writer_locked_.compare_exchange_strong(expected, true, std::memory_order_acquire))
@@ -262,6 +331,9 @@ namespace seal
             locker_ = &locker;
             while (locker.reader_locks_.load(std::memory_order_acquire) != 0)
                 ;
+#ifdef SEAL_USE_LOCK_COUNTS
+            count_lock(locker.site_, LockMode::exclusive, true, wait.elapsed_ns());
+#endif
         }
 
         SEAL_NODISCARD inline bool WriterLock::try_acquire(ReaderWriterLocker &locker) noexcept
@@ -293,3 +365,33 @@ namespace seal
     } // namespace util
 } // namespace seal
 #endif
+
+namespace seal
+{
+    namespace util
+    {
+        // Takes a spinlock such as a memory pool head's, counting the acquisition under the given site
+        inline void spin_lock(std::atomic<bool> &locked, LockSite site) noexcept
+        {
+            bool expected = false;
+#ifdef SEAL_USE_LOCK_COUNTS
+            if (locked.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                count_lock(site, LockMode::exclusive, false, 0);
+                return;
+            }
+            LockWait wait;
+            expected = false;
+#else
+            (void)site;
+#endif
+            while (!locked.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                expected = false;
+            }
+#ifdef SEAL_USE_LOCK_COUNTS
+            count_lock(site, LockMode::exclusive, true, wait.elapsed_ns());
+#endif
+        }
+    } // namespace util
+} // namespace seal
@@ -4,6 +4,7 @@
 #include "seal/util/common.h"
 #include "seal/util/mempool.h"
 #include "seal/util/uintarith.h"
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <stdexcept>
@@ -26,9 +27,151 @@ namespace seal
         // ensure symbol is created.
         constexpr size_t MemoryPool::first_alloc_count;
 
-        MemoryPoolHeadMT::MemoryPoolHeadMT(size_t item_byte_count, bool clear_on_destruction)
-            : clear_on_destruction_(clear_on_destruction), locked_(false), item_byte_count_(item_byte_count),
-              item_count_(MemoryPool::first_alloc_count), first_item_(nullptr)
+        // Required for C++14 compliance: static constexpr member variables are not necessarily inlined so need to
+        // ensure symbol is created.
+        constexpr size_t MemoryPoolArena::alignment;
+
+        namespace
+        {
+            // Frees the allocations all of whose items are on the free list and unlinks those items; returns the
+            // number of items freed. Allocations that were never carved from count as unused too.
+            size_t trim_allocations(
+                vector<MemoryPoolHead::allocation> &allocs, MemoryPoolItem *&first_item, size_t item_byte_count,
+                bool clear)
+            {
+                if (allocs.empty())
+                {
+                    return 0;
+                }
+
+                // The allocation of a free item is the last one starting at or before its data
+                vector<size_t> order(allocs.size());
+                iota(order.begin(), order.end(), size_t(0));
+                sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                    return allocs[a].data_ptr < allocs[b].data_ptr;
+                });
+                auto owner = [&](const MemoryPoolItem *item) {
+                    auto next = upper_bound(order.begin(), order.end(), item->data(), [&](const seal_byte *data, size_t i) {
+                        return data < allocs[i].data_ptr;
+                    });
+                    return *(next - 1);
+                };
+
+                vector<size_t> free_counts(allocs.size(), 0);
+                for (const MemoryPoolItem *item = first_item; item; item = item->next())
+                {
+                    free_counts[owner(item)]++;
+                }
+                vector<bool> unused(allocs.size());
+                bool any_unused = false;
+                for (size_t i = 0; i < allocs.size(); i++)
+                {
+                    unused[i] = free_counts[i] == allocs[i].size - allocs[i].free;
+                    any_unused = any_unused || unused[i];
+                }
+                if (!any_unused)
+                {
+                    return 0;
+                }
+
+                MemoryPoolItem **link = &first_item;
+                while (*link)
+                {
+                    MemoryPoolItem *item = *link;
+                    if (unused[owner(item)])
+                    {
+                        *link = item->next();
+                        delete item;
+                    }
+                    else
+                    {
+                        link = &item->next();
+                    }
+                }
+
+                size_t freed_count = 0;
+                vector<MemoryPoolHead::allocation> kept;
+                for (size_t i = 0; i < allocs.size(); i++)
+                {
+                    if (!unused[i])
+                    {
+                        kept.push_back(allocs[i]);
+                        continue;
+                    }
+                    size_t alloc_byte_count = mul_safe(item_byte_count, allocs[i].size);
+                    if (clear)
+                    {
+                        seal_memzero(allocs[i].data_ptr, alloc_byte_count);
+                    }
+                    free_pool_block(allocs[i].data_ptr, alloc_byte_count, allocs[i].backing);
+                    freed_count += allocs[i].size;
+                }
+                allocs.swap(kept);
+                return freed_count;
+            }
+
+            // Free items of a head: those on the free list and those not yet carved
+            size_t free_item_count(const vector<MemoryPoolHead::allocation> &allocs, const MemoryPoolItem *first_item)
+            {
+                size_t count = 0;
+                for (const MemoryPoolItem *item = first_item; item; item = item->next())
+                {
+                    count++;
+                }
+                for (const auto &alloc : allocs)
+                {
+                    count += alloc.free;
+                }
+                return count;
+            }
+
+            // Whether a head may add a block of byte_count bytes without exceeding its pool's budget
+            bool fits_budget(const MemoryPoolBudget *budget, size_t byte_count) noexcept
+            {
+                if (!budget)
+                {
+                    return true;
+                }
+                size_t limit = budget->limit.load(memory_order_relaxed);
+                size_t held = budget->alloc_byte_count.load(memory_order_relaxed);
+                return held <= limit && byte_count <= limit - held;
+            }
+
+            // An item outside the head's blocks, for when the budget is exhausted
+            MemoryPoolItem *new_unpooled_item(MemoryPoolBudget *budget, size_t item_byte_count)
+            {
+                seal_byte *data = SEAL_MALLOC(item_byte_count);
+                if (data == nullptr)
+                {
+                    throw bad_alloc();
+                }
+                budget->unpooled_count.fetch_add(1, memory_order_relaxed);
+                return new MemoryPoolItem(data, false);
+            }
+        } // namespace
+
+        void MemoryUsageCounters::acquired(size_t byte_count) noexcept
+        {
+            allocated_byte_count.fetch_add(byte_count, memory_order_relaxed);
+            allocation_count.fetch_add(1, memory_order_relaxed);
+            int64_t held =
+                held_byte_count.fetch_add(static_cast<int64_t>(byte_count), memory_order_relaxed) +
+                static_cast<int64_t>(byte_count);
+            int64_t peak = peak_byte_count.load(memory_order_relaxed);
+            while (held > peak && !peak_byte_count.compare_exchange_weak(peak, held, memory_order_relaxed))
+            {
+            }
+        }
+
+        MemoryUsageCounters *&thread_memory_usage() noexcept
+        {
+            static thread_local MemoryUsageCounters *usage = nullptr;
+            return usage;
+        }
+
+        MemoryPoolHeadMT::MemoryPoolHeadMT(size_t item_byte_count, bool clear_on_destruction, MemoryPoolBudget *budget)
+            : clear_on_destruction_(clear_on_destruction), budget_(budget), locked_(false),
+              item_byte_count_(item_byte_count), item_count_(MemoryPool::first_alloc_count), first_item_(nullptr)
         {
             if ((item_byte_count_ == 0) || (item_byte_count_ > MemoryPool::max_batch_alloc_byte_count) ||
                 (mul_safe(item_byte_count_, MemoryPool::first_alloc_count) > MemoryPool::max_batch_alloc_byte_count))
@@ -40,7 +183,8 @@ namespace seal
             allocation new_alloc;
             try
             {
-                new_alloc.data_ptr = SEAL_MALLOC(mul_safe(MemoryPool::first_alloc_count, item_byte_count_));
+                new_alloc.data_ptr = allocate_pool_block(
+                    mul_safe(MemoryPool::first_alloc_count, item_byte_count_), new_alloc.backing);
             }
             catch (const bad_alloc &)
             {
@@ -58,6 +202,10 @@ namespace seal
             new_alloc.head_ptr = new_alloc.data_ptr;
             allocs_.clear();
             allocs_.push_back(new_alloc);
+            if (budget_)
+            {
+                budget_->alloc_byte_count.fetch_add(item_byte_count_ * new_alloc.size, memory_order_relaxed);
+            }
         }
 
         MemoryPoolHeadMT::~MemoryPoolHeadMT() noexcept
@@ -88,7 +236,7 @@ namespace seal
                     seal_memzero(alloc.data_ptr, curr_alloc_byte_count);
 
                     // Delete this allocation
-                    SEAL_FREE(alloc.data_ptr);
+                    free_pool_block(alloc.data_ptr, curr_alloc_byte_count, alloc.backing);
                 }
             }
             else
@@ -97,30 +245,30 @@ namespace seal
                 for (auto &alloc : allocs_)
                 {
                     // Delete this allocation
-                    SEAL_FREE(alloc.data_ptr);
+                    free_pool_block(alloc.data_ptr, item_byte_count_ * alloc.size, alloc.backing);
                 }
             }
+            if (budget_)
+            {
+                budget_->alloc_byte_count.fetch_sub(item_byte_count_ * item_count_, memory_order_relaxed);
+            }
 
             allocs_.clear();
         }
 
-        MemoryPoolItem *MemoryPoolHeadMT::get()
+        MemoryPoolItem *MemoryPoolHeadMT::take()
         {
-            bool expected = false;
-            while (!locked_.compare_exchange_strong(expected, true, memory_order_acquire))
-            {
-                expected = false;
-            }
+            spin_lock(locked_, LockSite::memory_pool_head);
             MemoryPoolItem *old_first = first_item_;
 
             // Is pool empty?
             if (old_first == nullptr)
             {
-                allocation &last_alloc = allocs_.back();
                 MemoryPoolItem *new_item = nullptr;
-                if (last_alloc.free > 0)
+                if (!allocs_.empty() && allocs_.back().free > 0)
                 {
                     // Pool is empty; there is memory
+                    allocation &last_alloc = allocs_.back();
                     new_item = new MemoryPoolItem(last_alloc.head_ptr);
                     last_alloc.free--;
                     last_alloc.head_ptr += item_byte_count_;
@@ -130,19 +278,29 @@ namespace seal
                     // Pool is empty; there is no memory
                     allocation new_alloc;
 
-                    // Increase allocation size unless we are already at max
-                    size_t new_size = safe_cast<size_t>(
-                        ceil(MemoryPool::alloc_size_multiplier * static_cast<double>(last_alloc.size)));
+                    // Increase allocation size unless we are already at max; a trimmed head starts over
+                    size_t last_size = allocs_.empty() ? MemoryPool::first_alloc_count : allocs_.back().size;
+                    size_t new_size = allocs_.empty() ? last_size
+                                                      : safe_cast<size_t>(ceil(
+                                                            MemoryPool::alloc_size_multiplier *
+                                                            static_cast<double>(last_size)));
                     size_t new_alloc_byte_count = mul_safe(new_size, item_byte_count_);
                     if (new_alloc_byte_count > MemoryPool::max_batch_alloc_byte_count)
                     {
-                        new_size = last_alloc.size;
+                        new_size = last_size;
                         new_alloc_byte_count = new_size * item_byte_count_;
                     }
 
+                    // Over budget: this item bypasses the pool
+                    if (!fits_budget(budget_, new_alloc_byte_count))
+                    {
+                        locked_.store(false, memory_order_release);
+                        return new_unpooled_item(budget_, item_byte_count_);
+                    }
+
                     try
                     {
-                        new_alloc.data_ptr = SEAL_MALLOC(new_alloc_byte_count);
+                        new_alloc.data_ptr = allocate_pool_block(new_alloc_byte_count, new_alloc.backing);
                     }
                     catch (const bad_alloc &)
                     {
@@ -160,6 +318,10 @@ namespace seal
                     new_alloc.head_ptr = new_alloc.data_ptr + item_byte_count_;
                     allocs_.push_back(new_alloc);
                     item_count_ += new_size;
+                    if (budget_)
+                    {
+                        budget_->alloc_byte_count.fetch_add(new_alloc_byte_count, memory_order_relaxed);
+                    }
                     new_item = new MemoryPoolItem(new_alloc.data_ptr);
                 }
 
@@ -174,8 +336,49 @@ namespace seal
             return old_first;
         }
 
-        MemoryPoolHeadST::MemoryPoolHeadST(size_t item_byte_count, bool clear_on_destruction)
-            : clear_on_destruction_(clear_on_destruction), item_byte_count_(item_byte_count),
+        void MemoryPoolHeadMT::lock() const noexcept
+        {
+            spin_lock(locked_, LockSite::memory_pool_head);
+        }
+
+        void MemoryPoolHeadMT::free_unpooled(MemoryPoolItem *item) noexcept
+        {
+            if (clear_on_destruction_)
+            {
+                seal_memzero(item->data(), item_byte_count_);
+            }
+            SEAL_FREE(item->data());
+            delete item;
+        }
+
+        MemoryPoolSizeClass MemoryPoolHeadMT::size_class() const
+        {
+            lock();
+            MemoryPoolSizeClass result{ item_byte_count_, item_count_, free_item_count(allocs_, first_item_),
+                                        allocs_.size() };
+            locked_.store(false, memory_order_release);
+            return result;
+        }
+
+        size_t MemoryPoolHeadMT::trim()
+        {
+            lock();
+            MemoryPoolItem *first_item = first_item_;
+            size_t freed_count = trim_allocations(allocs_, first_item, item_byte_count_, clear_on_destruction_);
+            first_item_ = first_item;
+            item_count_ -= freed_count;
+            locked_.store(false, memory_order_release);
+
+            size_t freed_byte_count = freed_count * item_byte_count_;
+            if (budget_)
+            {
+                budget_->alloc_byte_count.fetch_sub(freed_byte_count, memory_order_relaxed);
+            }
+            return freed_byte_count;
+        }
+
+        MemoryPoolHeadST::MemoryPoolHeadST(size_t item_byte_count, bool clear_on_destruction, MemoryPoolBudget *budget)
+            : clear_on_destruction_(clear_on_destruction), budget_(budget), item_byte_count_(item_byte_count),
               item_count_(MemoryPool::first_alloc_count), first_item_(nullptr)
         {
             if ((item_byte_count_ == 0) || (item_byte_count_ > MemoryPool::max_batch_alloc_byte_count) ||
@@ -188,7 +391,8 @@ namespace seal
             allocation new_alloc;
             try
             {
-                new_alloc.data_ptr = SEAL_MALLOC(mul_safe(MemoryPool::first_alloc_count, item_byte_count_));
+                new_alloc.data_ptr = allocate_pool_block(
+                    mul_safe(MemoryPool::first_alloc_count, item_byte_count_), new_alloc.backing);
             }
             catch (const bad_alloc &)
             {
@@ -206,6 +410,10 @@ namespace seal
             new_alloc.head_ptr = new_alloc.data_ptr;
             allocs_.clear();
             allocs_.push_back(new_alloc);
+            if (budget_)
+            {
+                budget_->alloc_byte_count.fetch_add(item_byte_count_ * new_alloc.size, memory_order_relaxed);
+            }
         }
 
         MemoryPoolHeadST::~MemoryPoolHeadST() noexcept
@@ -230,7 +438,7 @@ namespace seal
                     seal_memzero(alloc.data_ptr, curr_alloc_byte_count);
 
                     // Delete this allocation
-                    SEAL_FREE(alloc.data_ptr);
+                    free_pool_block(alloc.data_ptr, curr_alloc_byte_count, alloc.backing);
                 }
             }
             else
@@ -239,25 +447,29 @@ namespace seal
                 for (auto &alloc : allocs_)
                 {
                     // Delete this allocation
-                    SEAL_FREE(alloc.data_ptr);
+                    free_pool_block(alloc.data_ptr, item_byte_count_ * alloc.size, alloc.backing);
                 }
             }
+            if (budget_)
+            {
+                budget_->alloc_byte_count.fetch_sub(item_byte_count_ * item_count_, memory_order_relaxed);
+            }
 
             allocs_.clear();
         }
 
-        MemoryPoolItem *MemoryPoolHeadST::get()
+        MemoryPoolItem *MemoryPoolHeadST::take()
         {
             MemoryPoolItem *old_first = first_item_;
 
             // Is pool empty?
             if (old_first == nullptr)
             {
-                allocation &last_alloc = allocs_.back();
                 MemoryPoolItem *new_item = nullptr;
-                if (last_alloc.free > 0)
+                if (!allocs_.empty() && allocs_.back().free > 0)
                 {
                     // Pool is empty; there is memory
+                    allocation &last_alloc = allocs_.back();
                     new_item = new MemoryPoolItem(last_alloc.head_ptr);
                     last_alloc.free--;
                     last_alloc.head_ptr += item_byte_count_;
@@ -267,19 +479,28 @@ namespace seal
                     // Pool is empty; there is no memory
                     allocation new_alloc;
 
-                    // Increase allocation size unless we are already at max
-                    size_t new_size = safe_cast<size_t>(
-                        ceil(MemoryPool::alloc_size_multiplier * static_cast<double>(last_alloc.size)));
+                    // Increase allocation size unless we are already at max; a trimmed head starts over
+                    size_t last_size = allocs_.empty() ? MemoryPool::first_alloc_count : allocs_.back().size;
+                    size_t new_size = allocs_.empty() ? last_size
+                                                      : safe_cast<size_t>(ceil(
+                                                            MemoryPool::alloc_size_multiplier *
+                                                            static_cast<double>(last_size)));
                     size_t new_alloc_byte_count = mul_safe(new_size, item_byte_count_);
                     if (new_alloc_byte_count > MemoryPool::max_batch_alloc_byte_count)
                     {
-                        new_size = last_alloc.size;
+                        new_size = last_size;
                         new_alloc_byte_count = new_size * item_byte_count_;
                     }
 
+                    // Over budget: this item bypasses the pool
+                    if (!fits_budget(budget_, new_alloc_byte_count))
+                    {
+                        return new_unpooled_item(budget_, item_byte_count_);
+                    }
+
                     try
                     {
-                        new_alloc.data_ptr = SEAL_MALLOC(new_alloc_byte_count);
+                        new_alloc.data_ptr = allocate_pool_block(new_alloc_byte_count, new_alloc.backing);
                     }
                     catch (const bad_alloc &)
                     {
@@ -297,6 +518,10 @@ namespace seal
                     new_alloc.head_ptr = new_alloc.data_ptr + item_byte_count_;
                     allocs_.push_back(new_alloc);
                     item_count_ += new_size;
+                    if (budget_)
+                    {
+                        budget_->alloc_byte_count.fetch_add(new_alloc_byte_count, memory_order_relaxed);
+                    }
                     new_item = new MemoryPoolItem(new_alloc.data_ptr);
                 }
 
@@ -309,6 +534,34 @@ namespace seal
             return old_first;
         }
 
+        void MemoryPoolHeadST::free_unpooled(MemoryPoolItem *item) noexcept
+        {
+            if (clear_on_destruction_)
+            {
+                seal_memzero(item->data(), item_byte_count_);
+            }
+            SEAL_FREE(item->data());
+            delete item;
+        }
+
+        MemoryPoolSizeClass MemoryPoolHeadST::size_class() const
+        {
+            return { item_byte_count_, item_count_, free_item_count(allocs_, first_item_), allocs_.size() };
+        }
+
+        size_t MemoryPoolHeadST::trim()
+        {
+            size_t freed_count = trim_allocations(allocs_, first_item_, item_byte_count_, clear_on_destruction_);
+            item_count_ -= freed_count;
+
+            size_t freed_byte_count = freed_count * item_byte_count_;
+            if (budget_)
+            {
+                budget_->alloc_byte_count.fetch_sub(freed_byte_count, memory_order_relaxed);
+            }
+            return freed_byte_count;
+        }
+
         const size_t MemoryPool::max_single_alloc_byte_count = []() -> size_t {
             int bit_shift = static_cast<int>(ceil(log2(MemoryPool::alloc_size_multiplier)));
             if (bit_shift < 0 || unsigned_geq(bit_shift, sizeof(size_t) * static_cast<size_t>(bits_per_byte)))
@@ -402,7 +655,7 @@ namespace seal
                 throw runtime_error("maximum pool head count reached");
             }
 
-            MemoryPoolHead *new_head = new MemoryPoolHeadMT(byte_count, clear_on_destruction_);
+            MemoryPoolHead *new_head = new MemoryPoolHeadMT(byte_count, clear_on_destruction_, &budget_);
             if (!pools_.empty())
             {
                 pools_.insert(pools_.begin() + static_cast<ptrdiff_t>(start), new_head);
@@ -424,6 +677,28 @@ namespace seal
             });
         }
 
+        vector<MemoryPoolSizeClass> MemoryPoolMT::size_classes() const
+        {
+            ReaderLock lock(pools_locker_.acquire_read());
+            vector<MemoryPoolSizeClass> result;
+            for (const MemoryPoolHead *head : pools_)
+            {
+                result.push_back(head->size_class());
+            }
+            return result;
+        }
+
+        size_t MemoryPoolMT::trim()
+        {
+            ReaderLock lock(pools_locker_.acquire_read());
+            size_t freed_byte_count = 0;
+            for (MemoryPoolHead *head : pools_)
+            {
+                freed_byte_count = add_safe(freed_byte_count, head->trim());
+            }
+            return freed_byte_count;
+        }
+
         MemoryPoolST::~MemoryPoolST() noexcept
         {
             for (MemoryPoolHead *head : pools_)
@@ -473,7 +748,7 @@ namespace seal
                 throw runtime_error("maximum pool head count reached");
             }
 
-            MemoryPoolHead *new_head = new MemoryPoolHeadST(byte_count, clear_on_destruction_);
+            MemoryPoolHead *new_head = new MemoryPoolHeadST(byte_count, clear_on_destruction_, &budget_);
             if (!pools_.empty())
             {
                 pools_.insert(pools_.begin() + static_cast<ptrdiff_t>(start), new_head);
@@ -492,5 +767,207 @@ namespace seal
                 return add_safe(byte_count, mul_safe(head->item_count(), head->item_byte_count()));
             });
         }
+        vector<MemoryPoolSizeClass> MemoryPoolST::size_classes() const
+        {
+            vector<MemoryPoolSizeClass> result;
+            for (const MemoryPoolHead *head : pools_)
+            {
+                result.push_back(head->size_class());
+            }
+            return result;
+        }
+
+        size_t MemoryPoolST::trim()
+        {
+            size_t freed_byte_count = 0;
+            for (MemoryPoolHead *head : pools_)
+            {
+                freed_byte_count = add_safe(freed_byte_count, head->trim());
+            }
+            return freed_byte_count;
+        }
+
+        MemoryPoolItem *MemoryPoolHeadArena::take()
+        {
+            MemoryPoolItem *item = first_item_;
+            if (item)
+            {
+                first_item_ = item->next();
+            }
+            else
+            {
+                // Carve the item record and its data from the arena, with the data aligned like the record
+                constexpr size_t record_byte_count =
+                    (sizeof(MemoryPoolItem) + MemoryPoolArena::alignment - 1) & ~(MemoryPoolArena::alignment - 1);
+                seal_byte *record = arena_.allocate(add_safe(record_byte_count, item_byte_count_));
+                item = new (record) MemoryPoolItem(record + record_byte_count);
+                item_count_++;
+            }
+            arena_.outstanding_count_++;
+            return item;
+        }
+
+        void MemoryPoolHeadArena::put(MemoryPoolItem *new_first) noexcept
+        {
+            new_first->next() = first_item_;
+            first_item_ = new_first;
+            arena_.outstanding_count_--;
+        }
+
+        MemoryPoolSizeClass MemoryPoolHeadArena::size_class() const
+        {
+            size_t free_count = 0;
+            for (const MemoryPoolItem *item = first_item_; item; item = item->next())
+            {
+                free_count++;
+            }
+            return { item_byte_count_, item_count_, free_count, 0 };
+        }
+
+        MemoryPoolArena::MemoryPoolArena(size_t initial_byte_count, bool clear_on_destruction)
+            : clear_on_destruction_(clear_on_destruction), initial_byte_count_(initial_byte_count)
+        {
+            if (initial_byte_count > MemoryPool::max_batch_alloc_byte_count)
+            {
+                throw invalid_argument("invalid allocation size");
+            }
+            if (initial_byte_count)
+            {
+                add_block(initial_byte_count);
+            }
+        }
+
+        MemoryPoolArena::~MemoryPoolArena() noexcept
+        {
+            for (MemoryPoolHead *head : pools_)
+            {
+                delete head;
+            }
+            pools_.clear();
+            free_blocks();
+        }
+
+        Pointer<seal_byte> MemoryPoolArena::get_for_byte_count(size_t byte_count)
+        {
+            if (byte_count > MemoryPool::max_single_alloc_byte_count)
+            {
+                throw invalid_argument("invalid allocation size");
+            }
+            else if (byte_count == 0)
+            {
+                return Pointer<seal_byte>();
+            }
+
+            // Attempt to find size; heads are sorted by decreasing item size as in MemoryPoolST.
+            size_t start = 0;
+            size_t end = pools_.size();
+            while (start < end)
+            {
+                size_t mid = (start + end) / 2;
+                MemoryPoolHead *mid_head = pools_[mid];
+                size_t mid_byte_count = mid_head->item_byte_count();
+                if (byte_count < mid_byte_count)
+                {
+                    start = mid + 1;
+                }
+                else if (byte_count > mid_byte_count)
+                {
+                    end = mid;
+                }
+                else
+                {
+                    return Pointer<seal_byte>(mid_head);
+                }
+            }
+
+            if (pools_.size() >= max_pool_head_count)
+            {
+                throw runtime_error("maximum pool head count reached");
+            }
+
+            MemoryPoolHead *new_head = new MemoryPoolHeadArena(byte_count, *this);
+            pools_.insert(pools_.begin() + static_cast<ptrdiff_t>(start), new_head);
+            return Pointer<seal_byte>(new_head);
+        }
+
+        size_t MemoryPoolArena::alloc_byte_count() const
+        {
+            return accumulate(blocks_.cbegin(), blocks_.cend(), size_t(0), [](size_t byte_count, const block &b) {
+                return add_safe(byte_count, b.size);
+            });
+        }
+
+        vector<MemoryPoolSizeClass> MemoryPoolArena::size_classes() const
+        {
+            vector<MemoryPoolSizeClass> result;
+            for (const MemoryPoolHead *head : pools_)
+            {
+                result.push_back(head->size_class());
+            }
+            return result;
+        }
+
+        void MemoryPoolArena::reset()
+        {
+            if (outstanding_count_)
+            {
+                throw logic_error("arena has outstanding allocations");
+            }
+            for (MemoryPoolHead *head : pools_)
+            {
+                static_cast<MemoryPoolHeadArena *>(head)->reset();
+            }
+
+            // Merge the blocks so that the next round of allocations fits in one
+            if (blocks_.size() > 1)
+            {
+                size_t total_byte_count = alloc_byte_count();
+                free_blocks();
+                add_block(total_byte_count);
+            }
+            else if (clear_on_destruction_ && !blocks_.empty())
+            {
+                seal_memzero(blocks_.back().data_ptr, block_used_);
+            }
+            block_used_ = 0;
+        }
+
+        seal_byte *MemoryPoolArena::allocate(size_t byte_count)
+        {
+            byte_count = add_safe(byte_count, alignment - 1) & ~(alignment - 1);
+            if (blocks_.empty() || byte_count > blocks_.back().size - block_used_)
+            {
+                // Grow geometrically so that the number of blocks stays logarithmic in the peak usage
+                size_t new_byte_count = blocks_.empty() ? initial_byte_count_ : mul_safe(blocks_.back().size, size_t(2));
+                add_block(max<size_t>(byte_count, min(new_byte_count, MemoryPool::max_batch_alloc_byte_count)));
+            }
+            seal_byte *result = blocks_.back().data_ptr + block_used_;
+            block_used_ += byte_count;
+            return result;
+        }
+
+        void MemoryPoolArena::add_block(size_t byte_count)
+        {
+            block new_block;
+            new_block.alloc_ptr = allocate_pool_block(add_safe(byte_count, alignment - 1), new_block.backing);
+            auto address = reinterpret_cast<uintptr_t>(new_block.alloc_ptr);
+            new_block.data_ptr = new_block.alloc_ptr + (((address + alignment - 1) & ~(alignment - 1)) - address);
+            new_block.size = byte_count;
+            blocks_.push_back(new_block);
+            block_used_ = 0;
+        }
+
+        void MemoryPoolArena::free_blocks() noexcept
+        {
+            for (auto &b : blocks_)
+            {
+                if (clear_on_destruction_)
+                {
+                    seal_memzero(b.data_ptr, b.size);
+                }
+                free_pool_block(b.alloc_ptr, b.size + alignment - 1, b.backing);
+            }
+            blocks_.clear();
+        }
     } // namespace util
 } // namespace seal
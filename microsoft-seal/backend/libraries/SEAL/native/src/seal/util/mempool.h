@@ -6,7 +6,9 @@
 #include "seal/util/common.h"
 #include "seal/util/defines.h"
 #include "seal/util/globals.h"
+#include "seal/util/hugepages.h"
 #include "seal/util/locks.h"
+#include "seal/util/opcounters.h"
 #include <algorithm>
 #include <atomic>
 #include <cstdint>
@@ -31,10 +33,64 @@ namespace seal
         template <typename T = void, typename = std::enable_if_t<std::is_standard_layout<T>::value>>
         class Pointer;
 
+        // Usage of one allocation size (size class) of a memory pool
+        struct MemoryPoolSizeClass
+        {
+            // Byte size of the allocations of this class
+            std::size_t item_byte_count;
+
+            // Allocations held by the pool, in use or free
+            std::size_t item_count;
+
+            // Allocations held by the pool that are not in use
+            std::size_t free_item_count;
+
+            // Number of blocks the allocations are carved from
+            std::size_t block_count;
+        };
+
+        // Byte budget shared by a memory pool and its heads. Once the pool holds limit bytes, heads that run out of
+        // items hand out unpooled ones instead of growing: those come from the system allocator and go back to it
+        // when released.
+        struct MemoryPoolBudget
+        {
+            std::atomic<std::size_t> limit{ (std::numeric_limits<std::size_t>::max)() };
+
+            // Bytes held by the pool's blocks
+            std::atomic<std::size_t> alloc_byte_count{ 0 };
+
+            // Unpooled items handed out so far
+            std::atomic<std::uint64_t> unpooled_count{ 0 };
+        };
+
+        // Allocation counters of a seal::MemoryUsage. Items handed out and returned on a thread count for the
+        // counters the thread is attached to (see thread_memory_usage); returns on other threads are not subtracted,
+        // so held_byte_count is what the attached threads took and have not given back.
+        struct MemoryUsageCounters
+        {
+            std::atomic<std::uint64_t> allocated_byte_count{ 0 };
+
+            std::atomic<std::uint64_t> allocation_count{ 0 };
+
+            std::atomic<std::int64_t> held_byte_count{ 0 };
+
+            std::atomic<std::int64_t> peak_byte_count{ 0 };
+
+            void acquired(std::size_t byte_count) noexcept;
+
+            inline void released(std::size_t byte_count) noexcept
+            {
+                held_byte_count.fetch_sub(static_cast<std::int64_t>(byte_count), std::memory_order_relaxed);
+            }
+        };
+
+        // The counters the calling thread reports to, or nullptr
+        SEAL_NODISCARD MemoryUsageCounters *&thread_memory_usage() noexcept;
+
         class MemoryPoolItem
         {
         public:
-            MemoryPoolItem(seal_byte *data) noexcept : data_(data)
+            MemoryPoolItem(seal_byte *data, bool pooled = true) noexcept : data_(data), pooled_(pooled)
             {}
 
             SEAL_NODISCARD inline seal_byte *data() noexcept
@@ -57,6 +113,12 @@ namespace seal
                 return next_;
             }
 
+            // Whether the data belongs to a block of the head; unpooled data is freed when the item is returned
+            SEAL_NODISCARD inline bool pooled() const noexcept
+            {
+                return pooled_;
+            }
+
         private:
             MemoryPoolItem(const MemoryPoolItem &copy) = delete;
 
@@ -65,6 +127,8 @@ namespace seal
             seal_byte *data_ = nullptr;
 
             MemoryPoolItem *next_ = nullptr;
+
+            bool pooled_ = true;
         };
 
         class MemoryPoolHead
@@ -72,7 +136,7 @@ namespace seal
         public:
             struct allocation
             {
-                allocation() : size(0), data_ptr(nullptr), free(0), head_ptr(nullptr)
+                allocation() : size(0), data_ptr(nullptr), free(0), head_ptr(nullptr), backing(huge_page_mode::none)
                 {}
 
                 // Size of the allocation (number of items it can hold)
@@ -86,6 +150,9 @@ namespace seal
 
                 // Pointer to current head of allocation
                 seal_byte *head_ptr;
+
+                // Pages the allocation was mapped with; see allocate_pool_block
+                huge_page_mode backing;
             };
 
             // The overriding functions are noexcept(false)
@@ -97,17 +164,50 @@ namespace seal
             // Total number of items allocated
             virtual std::size_t item_count() const noexcept = 0;
 
-            virtual MemoryPoolItem *get() = 0;
+            // Hands out an item, counted for the calling thread's MemoryUsage and OperationCounts if it has them
+            SEAL_NODISCARD inline MemoryPoolItem *get()
+            {
+                MemoryPoolItem *item = take();
+                SEAL_COUNT_OPERATION(allocation_count, 1);
+                if (MemoryUsageCounters *usage = thread_memory_usage())
+                {
+                    usage->acquired(item_byte_count());
+                }
+                return item;
+            }
 
             // Return item back to this pool
-            virtual void add(MemoryPoolItem *new_first) noexcept = 0;
+            inline void add(MemoryPoolItem *new_first) noexcept
+            {
+                if (MemoryUsageCounters *usage = thread_memory_usage())
+                {
+                    usage->released(item_byte_count());
+                }
+                put(new_first);
+            }
+
+            // Current usage of this head
+            virtual MemoryPoolSizeClass size_class() const = 0;
+
+            // Frees the allocations none of whose items are in use and returns the number of bytes freed
+            virtual std::size_t trim()
+            {
+                return 0;
+            }
+
+        protected:
+            virtual MemoryPoolItem *take() = 0;
+
+            virtual void put(MemoryPoolItem *new_first) noexcept = 0;
         };
 
         class MemoryPoolHeadMT : public MemoryPoolHead
         {
         public:
-            // Creates a new MemoryPoolHeadMT with allocation for one single item.
-            MemoryPoolHeadMT(std::size_t item_byte_count, bool clear_on_destruction = false);
+            // Creates a new MemoryPoolHeadMT with allocation for one single item. A budget, if given, must outlive
+            // the head.
+            MemoryPoolHeadMT(
+                std::size_t item_byte_count, bool clear_on_destruction = false, MemoryPoolBudget *budget = nullptr);
 
             ~MemoryPoolHeadMT() noexcept override;
 
@@ -123,15 +223,21 @@ namespace seal
                 return item_count_;
             }
 
-            MemoryPoolItem *get() override;
+            SEAL_NODISCARD MemoryPoolSizeClass size_class() const override;
+
+            std::size_t trim() override;
+
+        protected:
+            MemoryPoolItem *take() override;
 
-            inline void add(MemoryPoolItem *new_first) noexcept override
+            inline void put(MemoryPoolItem *new_first) noexcept override
             {
-                bool expected = false;
-                while (!locked_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                if (!new_first->pooled())
                 {
-                    expected = false;
+                    free_unpooled(new_first);
+                    return;
                 }
+                spin_lock(locked_, LockSite::memory_pool_head);
                 MemoryPoolItem *old_first = first_item_;
                 new_first->next() = old_first;
                 first_item_ = new_first;
@@ -143,8 +249,14 @@ namespace seal
 
             MemoryPoolHeadMT &operator=(const MemoryPoolHeadMT &assign) = delete;
 
+            void lock() const noexcept;
+
+            void free_unpooled(MemoryPoolItem *item) noexcept;
+
             const bool clear_on_destruction_;
 
+            MemoryPoolBudget *const budget_;
+
             mutable std::atomic<bool> locked_;
 
             const std::size_t item_byte_count_;
@@ -159,8 +271,10 @@ namespace seal
         class MemoryPoolHeadST : public MemoryPoolHead
         {
         public:
-            // Creates a new MemoryPoolHeadST with allocation for one single item.
-            MemoryPoolHeadST(std::size_t item_byte_count, bool clear_on_destruction = false);
+            // Creates a new MemoryPoolHeadST with allocation for one single item. A budget, if given, must outlive
+            // the head.
+            MemoryPoolHeadST(
+                std::size_t item_byte_count, bool clear_on_destruction = false, MemoryPoolBudget *budget = nullptr);
 
             ~MemoryPoolHeadST() noexcept override;
 
@@ -176,10 +290,20 @@ namespace seal
                 return item_count_;
             }
 
-            SEAL_NODISCARD MemoryPoolItem *get() override;
+            SEAL_NODISCARD MemoryPoolSizeClass size_class() const override;
+
+            std::size_t trim() override;
 
-            inline void add(MemoryPoolItem *new_first) noexcept override
+        protected:
+            SEAL_NODISCARD MemoryPoolItem *take() override;
+
+            inline void put(MemoryPoolItem *new_first) noexcept override
             {
+                if (!new_first->pooled())
+                {
+                    free_unpooled(new_first);
+                    return;
+                }
                 new_first->next() = first_item_;
                 first_item_ = new_first;
             }
@@ -189,8 +313,12 @@ namespace seal
 
             MemoryPoolHeadST &operator=(const MemoryPoolHeadST &assign) = delete;
 
+            void free_unpooled(MemoryPoolItem *item) noexcept;
+
             const bool clear_on_destruction_;
 
+            MemoryPoolBudget *const budget_;
+
             std::size_t item_byte_count_;
 
             std::size_t item_count_;
@@ -223,6 +351,35 @@ namespace seal
             virtual std::size_t pool_count() const = 0;
 
             virtual std::size_t alloc_byte_count() const = 0;
+
+            // Usage of each allocation size, largest first
+            SEAL_NODISCARD virtual std::vector<MemoryPoolSizeClass> size_classes() const = 0;
+
+            // Returns memory that no allocation uses to the system and returns the number of bytes freed
+            virtual std::size_t trim()
+            {
+                return 0;
+            }
+
+            // Caps the bytes the pool holds; beyond the cap allocations bypass the pool (see MemoryPoolBudget)
+            virtual void set_byte_count_limit(std::size_t byte_count)
+            {
+                budget_.limit.store(byte_count, std::memory_order_relaxed);
+            }
+
+            SEAL_NODISCARD inline std::size_t byte_count_limit() const noexcept
+            {
+                return budget_.limit.load(std::memory_order_relaxed);
+            }
+
+            // Number of allocations that bypassed the pool because of the cap
+            SEAL_NODISCARD inline std::uint64_t unpooled_count() const noexcept
+            {
+                return budget_.unpooled_count.load(std::memory_order_relaxed);
+            }
+
+        protected:
+            MemoryPoolBudget budget_;
         };
 
         class MemoryPoolMT : public MemoryPool
@@ -243,6 +400,10 @@ namespace seal
 
             SEAL_NODISCARD std::size_t alloc_byte_count() const override;
 
+            SEAL_NODISCARD std::vector<MemoryPoolSizeClass> size_classes() const override;
+
+            std::size_t trim() override;
+
         protected:
             MemoryPoolMT(const MemoryPoolMT &copy) = delete;
 
@@ -250,7 +411,7 @@ namespace seal
 
             const bool clear_on_destruction_;
 
-            mutable ReaderWriterLocker pools_locker_;
+            mutable ReaderWriterLocker pools_locker_{ LockSite::memory_pool_table };
 
             std::vector<MemoryPoolHead *> pools_;
         };
@@ -272,6 +433,10 @@ namespace seal
 
             std::size_t alloc_byte_count() const override;
 
+            SEAL_NODISCARD std::vector<MemoryPoolSizeClass> size_classes() const override;
+
+            std::size_t trim() override;
+
         protected:
             MemoryPoolST(const MemoryPoolST &copy) = delete;
 
@@ -281,5 +446,137 @@ namespace seal
 
             std::vector<MemoryPoolHead *> pools_;
         };
+
+        class MemoryPoolArena;
+
+        // Size class of a MemoryPoolArena: items are carved from the arena's blocks and recycled through an unlocked
+        // free list until the arena is reset.
+        class MemoryPoolHeadArena : public MemoryPoolHead
+        {
+        public:
+            MemoryPoolHeadArena(std::size_t item_byte_count, MemoryPoolArena &arena) noexcept
+                : arena_(arena), item_byte_count_(item_byte_count), item_count_(0), first_item_(nullptr)
+            {}
+
+            ~MemoryPoolHeadArena() noexcept override = default;
+
+            // Byte size of the allocations (items) owned by this pool
+            SEAL_NODISCARD inline std::size_t item_byte_count() const noexcept override
+            {
+                return item_byte_count_;
+            }
+
+            // Returns the number of items carved since the last reset
+            SEAL_NODISCARD inline std::size_t item_count() const noexcept override
+            {
+                return item_count_;
+            }
+
+            SEAL_NODISCARD MemoryPoolSizeClass size_class() const override;
+
+            // Forgets all items; their memory belongs to the arena
+            inline void reset() noexcept
+            {
+                item_count_ = 0;
+                first_item_ = nullptr;
+            }
+
+        protected:
+            SEAL_NODISCARD MemoryPoolItem *take() override;
+
+            void put(MemoryPoolItem *new_first) noexcept override;
+
+        private:
+            MemoryPoolHeadArena(const MemoryPoolHeadArena &copy) = delete;
+
+            MemoryPoolHeadArena &operator=(const MemoryPoolHeadArena &assign) = delete;
+
+            MemoryPoolArena &arena_;
+
+            std::size_t item_byte_count_;
+
+            std::size_t item_count_;
+
+            MemoryPoolItem *first_item_;
+        };
+
+        // Thread-unsafe bump-pointer pool. Allocations (and their MemoryPoolItem records) are carved from large
+        // blocks without taking a lock or calling the allocator; reset() reclaims everything at once and merges the
+        // blocks, so a workload that repeats (e.g. one request per reset) runs out of a single block.
+        class MemoryPoolArena : public MemoryPool
+        {
+        public:
+            // Alignment of every allocation, so that no two allocations share a cache line
+            static constexpr std::size_t alignment = 64;
+
+            MemoryPoolArena(std::size_t initial_byte_count = 0, bool clear_on_destruction = false);
+
+            ~MemoryPoolArena() noexcept override;
+
+            SEAL_NODISCARD Pointer<seal_byte> get_for_byte_count(std::size_t byte_count) override;
+
+            SEAL_NODISCARD inline std::size_t pool_count() const override
+            {
+                return pools_.size();
+            }
+
+            // Total size of the blocks
+            SEAL_NODISCARD std::size_t alloc_byte_count() const override;
+
+            SEAL_NODISCARD std::vector<MemoryPoolSizeClass> size_classes() const override;
+
+            // An arena never bypasses itself; reset() is what returns its memory
+            void set_byte_count_limit(std::size_t byte_count) override
+            {
+                (void)byte_count;
+                throw std::logic_error("arena has no byte count limit");
+            }
+
+            // Number of allocations not yet returned
+            SEAL_NODISCARD inline std::size_t outstanding_count() const noexcept
+            {
+                return outstanding_count_;
+            }
+
+            // Reclaims all memory; throws std::logic_error if allocations are still outstanding.
+            void reset();
+
+        private:
+            friend class MemoryPoolHeadArena;
+
+            struct block
+            {
+                seal_byte *alloc_ptr;
+
+                seal_byte *data_ptr;
+
+                std::size_t size;
+
+                huge_page_mode backing;
+            };
+
+            MemoryPoolArena(const MemoryPoolArena &copy) = delete;
+
+            MemoryPoolArena &operator=(const MemoryPoolArena &assign) = delete;
+
+            // Returns byte_count bytes (rounded up to the alignment) from the current block, adding a block if needed
+            SEAL_NODISCARD seal_byte *allocate(std::size_t byte_count);
+
+            void add_block(std::size_t byte_count);
+
+            void free_blocks() noexcept;
+
+            const bool clear_on_destruction_;
+
+            std::size_t initial_byte_count_;
+
+            std::vector<block> blocks_;
+
+            std::size_t block_used_ = 0;
+
+            std::size_t outstanding_count_ = 0;
+
+            std::vector<MemoryPoolHead *> pools_;
+        };
     } // namespace util
 } // namespace seal
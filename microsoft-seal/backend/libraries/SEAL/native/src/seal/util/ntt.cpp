@@ -2,13 +2,19 @@
 // Licensed under the MIT license.
 
 #include "seal/util/ntt.h"
+#include "seal/util/cpufeatures.h"
+#include "seal/util/nttavx2.h"
+#include "seal/util/nttsve.h"
+#include "seal/util/opcounters.h"
 #include "seal/util/uintarith.h"
 #include "seal/util/uintarithsmallmod.h"
+#include "seal/util/locks.h"
 #include <algorithm>
+#include <map>
+#include <utility>
 #ifdef SEAL_USE_INTEL_HEXL
 #include "seal/memorymanager.h"
 #include "seal/util/iterator.h"
-#include "seal/util/locks.h"
 #include "seal/util/pointer.h"
 #include <unordered_map>
 #include "hexl/hexl.hpp"
@@ -157,7 +163,7 @@ namespace intel
         {
             static unordered_map<pair<uint64_t, uint64_t>, hexl::NTT, HashPair> ntt_cache_;
 
-            static seal::util::ReaderWriterLocker ntt_cache_locker_;
+            static seal::util::ReaderWriterLocker ntt_cache_locker_{ seal::util::LockSite::ntt_tables };
 
             pair<uint64_t, uint64_t> key{ N, modulus };
 
@@ -299,6 +305,63 @@ namespace seal
             ntt_handler_ = NTTHandler(mod_arith_lazy_);
         }
 
+        namespace
+        {
+            // Process-wide NTTTables keyed by (coeff_count_power, modulus value). Entries are never modified once
+            // inserted, so references to them stay valid until clear() is called.
+            class NTTTablesCache
+            {
+            public:
+                SEAL_NODISCARD static NTTTablesCache &Get()
+                {
+                    static NTTTablesCache cache;
+                    return cache;
+                }
+
+                SEAL_NODISCARD NTTTables copy(int coeff_count_power, const Modulus &modulus, MemoryPoolHandle pool)
+                {
+                    key_type key(coeff_count_power, modulus.value());
+                    {
+                        ReaderLock lock(locker_.acquire_read());
+                        auto it = tables_.find(key);
+                        if (it != tables_.end())
+                        {
+                            return { it->second, move(pool) };
+                        }
+                    }
+
+                    // Generate without holding the lock; if another thread got here first its tables are kept
+                    NTTTables tables(coeff_count_power, modulus, pool_);
+                    WriterLock lock(locker_.acquire_write());
+                    auto it = tables_.emplace(key, move(tables)).first;
+                    return { it->second, move(pool) };
+                }
+
+                SEAL_NODISCARD size_t size()
+                {
+                    ReaderLock lock(locker_.acquire_read());
+                    return tables_.size();
+                }
+
+                void clear()
+                {
+                    WriterLock lock(locker_.acquire_write());
+                    tables_.clear();
+                }
+
+            private:
+                using key_type = pair<int, uint64_t>;
+
+                NTTTablesCache() = default;
+
+                MemoryPoolHandle pool_ = MemoryPoolHandle::New();
+
+                ReaderWriterLocker locker_{ LockSite::ntt_tables };
+
+                map<key_type, NTTTables> tables_;
+            };
+        } // namespace
+
         class NTTTablesCreateIter
         {
         public:
@@ -332,7 +395,7 @@ namespace seal
             // Dereferencing creates NTTTables and returns by value
             inline value_type operator*() const
             {
-                return { coeff_count_power_, modulus_[index_], pool_ };
+                return NTTTablesCache::Get().copy(coeff_count_power_, modulus_[index_], pool_);
             }
 
             // Pre-increment
@@ -391,8 +454,37 @@ namespace seal
             tables = allocate(iter, modulus.size(), pool);
         }
 
+        size_t NTTTablesCacheSize()
+        {
+            return NTTTablesCache::Get().size();
+        }
+
+        void ClearNTTTablesCache()
+        {
+            NTTTablesCache::Get().clear();
+        }
+
+#if defined(SEAL_USE_AVX2) || defined(SEAL_USE_SVE)
+        namespace
+        {
+            // The last inverse layer uses the last root scaled by n^(-1), as in DWTHandler::transform_from_rev
+            MultiplyUIntModOperand scaled_last_inv_root(const NTTTables &tables)
+            {
+                const Modulus &modulus = tables.modulus();
+                MultiplyUIntModOperand scaled_root;
+                scaled_root.set(
+                    multiply_uint_mod(
+                        tables.get_from_inv_root_powers(tables.coeff_count() - 1).operand, tables.inv_degree_modulo(),
+                        modulus),
+                    modulus);
+                return scaled_root;
+            }
+        } // namespace
+#endif
+
         void ntt_negacyclic_harvey_lazy(CoeffIter operand, const NTTTables &tables)
         {
+            SEAL_COUNT_OPERATION(forward_ntt_count, 1);
 #ifdef SEAL_USE_INTEL_HEXL
             size_t N = size_t(1) << tables.coeff_count_power();
             uint64_t p = tables.modulus().value();
@@ -400,11 +492,51 @@ namespace seal
 
             intel::seal_ext::compute_forward_ntt(operand, N, p, root, 4, 4);
 #else
+#ifdef SEAL_USE_AVX2
+            if (use_avx2() && tables.coeff_count_power() >= 3)
+            {
+                avx2::ntt_negacyclic_harvey_lazy(
+                    operand.ptr(), tables.coeff_count_power(), tables.get_from_root_powers(),
+                    tables.modulus().value());
+                return;
+            }
+#endif
+#ifdef SEAL_USE_SVE
+            if (use_sve())
+            {
+                sve::ntt_negacyclic_harvey_lazy(
+                    operand.ptr(), tables.coeff_count_power(), tables.get_from_root_powers(),
+                    tables.modulus().value());
+                return;
+            }
+#endif
+            // The portable path is not specialized per transform size: kernels with every layer instantiated for
+            // N = 4096, 8192 and 16384 (constant gaps and trip counts, layers fused in pairs) were bit-exact but
+            // no faster than this loop, which is already unrolled by four and bound by the Shoup products
             tables.ntt_handler().transform_to_rev(
                 operand.ptr(), tables.coeff_count_power(), tables.get_from_root_powers());
 #endif
         }
 
+        void ntt_negacyclic_harvey_lazy(CoeffIter operand, size_t count, const NTTTables &tables)
+        {
+#if defined(SEAL_USE_AVX2) && !defined(SEAL_USE_INTEL_HEXL)
+            if (use_avx2() && tables.coeff_count_power() >= 3)
+            {
+                SEAL_COUNT_OPERATION(forward_ntt_count, count);
+                avx2::ntt_negacyclic_harvey_lazy(
+                    operand.ptr(), count, tables.coeff_count_power(), tables.get_from_root_powers(),
+                    tables.modulus().value());
+                return;
+            }
+#endif
+            size_t n = tables.coeff_count();
+            for (size_t i = 0; i < count; i++)
+            {
+                ntt_negacyclic_harvey_lazy(operand + i * n, tables);
+            }
+        }
+
         void ntt_negacyclic_harvey(CoeffIter operand, const NTTTables &tables)
         {
 #ifdef SEAL_USE_INTEL_HEXL
@@ -412,6 +544,7 @@ namespace seal
             uint64_t p = tables.modulus().value();
             uint64_t root = tables.get_root();
 
+            SEAL_COUNT_OPERATION(forward_ntt_count, 1);
             intel::seal_ext::compute_forward_ntt(operand, N, p, root, 4, 1);
 #else
             ntt_negacyclic_harvey_lazy(operand, tables);
@@ -436,8 +569,34 @@ namespace seal
 #endif
         }
 
+        void ntt_negacyclic_harvey(CoeffIter operand, size_t count, const NTTTables &tables)
+        {
+#ifdef SEAL_USE_INTEL_HEXL
+            size_t n = tables.coeff_count();
+            for (size_t i = 0; i < count; i++)
+            {
+                ntt_negacyclic_harvey(operand + i * n, tables);
+            }
+#else
+            ntt_negacyclic_harvey_lazy(operand, count, tables);
+            std::uint64_t modulus = tables.modulus().value();
+            std::uint64_t two_times_modulus = modulus * 2;
+            SEAL_ITERATE(operand, count * tables.coeff_count(), [&](auto &I) {
+                if (I >= two_times_modulus)
+                {
+                    I -= two_times_modulus;
+                }
+                if (I >= modulus)
+                {
+                    I -= modulus;
+                }
+            });
+#endif
+        }
+
         void inverse_ntt_negacyclic_harvey_lazy(CoeffIter operand, const NTTTables &tables)
         {
+            SEAL_COUNT_OPERATION(inverse_ntt_count, 1);
 #ifdef SEAL_USE_INTEL_HEXL
             size_t N = size_t(1) << tables.coeff_count_power();
             uint64_t p = tables.modulus().value();
@@ -445,17 +604,55 @@ namespace seal
             intel::seal_ext::compute_inverse_ntt(operand, N, p, root, 2, 2);
 #else
             MultiplyUIntModOperand inv_degree_modulo = tables.inv_degree_modulo();
+#ifdef SEAL_USE_AVX2
+            if (use_avx2() && tables.coeff_count_power() >= 3)
+            {
+                avx2::inverse_ntt_negacyclic_harvey_lazy(
+                    operand.ptr(), tables.coeff_count_power(), tables.get_from_inv_root_powers(),
+                    tables.modulus().value(), inv_degree_modulo, scaled_last_inv_root(tables));
+                return;
+            }
+#endif
+#ifdef SEAL_USE_SVE
+            if (use_sve())
+            {
+                sve::inverse_ntt_negacyclic_harvey_lazy(
+                    operand.ptr(), tables.coeff_count_power(), tables.get_from_inv_root_powers(),
+                    tables.modulus().value(), inv_degree_modulo, scaled_last_inv_root(tables));
+                return;
+            }
+#endif
             tables.ntt_handler().transform_from_rev(
                 operand.ptr(), tables.coeff_count_power(), tables.get_from_inv_root_powers(), &inv_degree_modulo);
 #endif
         }
 
+        void inverse_ntt_negacyclic_harvey_lazy(CoeffIter operand, size_t count, const NTTTables &tables)
+        {
+#if defined(SEAL_USE_AVX2) && !defined(SEAL_USE_INTEL_HEXL)
+            if (use_avx2() && tables.coeff_count_power() >= 3)
+            {
+                SEAL_COUNT_OPERATION(inverse_ntt_count, count);
+                avx2::inverse_ntt_negacyclic_harvey_lazy(
+                    operand.ptr(), count, tables.coeff_count_power(), tables.get_from_inv_root_powers(),
+                    tables.modulus().value(), tables.inv_degree_modulo(), scaled_last_inv_root(tables));
+                return;
+            }
+#endif
+            size_t n = tables.coeff_count();
+            for (size_t i = 0; i < count; i++)
+            {
+                inverse_ntt_negacyclic_harvey_lazy(operand + i * n, tables);
+            }
+        }
+
         void inverse_ntt_negacyclic_harvey(CoeffIter operand, const NTTTables &tables)
         {
 #ifdef SEAL_USE_INTEL_HEXL
             size_t N = size_t(1) << tables.coeff_count_power();
             uint64_t p = tables.modulus().value();
             uint64_t root = tables.get_root();
+            SEAL_COUNT_OPERATION(inverse_ntt_count, 1);
             intel::seal_ext::compute_inverse_ntt(operand, N, p, root, 2, 1);
 #else
             inverse_ntt_negacyclic_harvey_lazy(operand, tables);
@@ -471,6 +668,26 @@ namespace seal
                     I -= modulus;
                 }
             });
+#endif
+        }
+
+        void inverse_ntt_negacyclic_harvey(CoeffIter operand, size_t count, const NTTTables &tables)
+        {
+#ifdef SEAL_USE_INTEL_HEXL
+            size_t n = tables.coeff_count();
+            for (size_t i = 0; i < count; i++)
+            {
+                inverse_ntt_negacyclic_harvey(operand + i * n, tables);
+            }
+#else
+            inverse_ntt_negacyclic_harvey_lazy(operand, count, tables);
+            std::uint64_t modulus = tables.modulus().value();
+            SEAL_ITERATE(operand, count * tables.coeff_count(), [&](auto &I) {
+                if (I >= modulus)
+                {
+                    I -= modulus;
+                }
+            });
 #endif
         }
     } // namespace util
@@ -8,6 +8,7 @@
 #include "seal/util/defines.h"
 #include "seal/util/dwthandler.h"
 #include "seal/util/iterator.h"
+#include "seal/util/parallel.h"
 #include "seal/util/pointer.h"
 #include "seal/util/uintarithsmallmod.h"
 #include "seal/util/uintcore.h"
@@ -74,9 +75,16 @@ namespace seal
         public:
             NTTTables(NTTTables &&source) = default;
 
-            NTTTables(NTTTables &copy)
-                : pool_(copy.pool_), root_(copy.root_), coeff_count_power_(copy.coeff_count_power_),
-                  coeff_count_(copy.coeff_count_), modulus_(copy.modulus_), inv_degree_modulo_(copy.inv_degree_modulo_)
+            NTTTables(NTTTables &copy) : NTTTables(copy, copy.pool_)
+            {}
+
+            /**
+            Copies the tables into memory allocated from the given pool.
+            */
+            NTTTables(const NTTTables &copy, MemoryPoolHandle pool)
+                : pool_(std::move(pool)), root_(copy.root_), inv_root_(copy.inv_root_),
+                  coeff_count_power_(copy.coeff_count_power_), coeff_count_(copy.coeff_count_), modulus_(copy.modulus_),
+                  inv_degree_modulo_(copy.inv_degree_modulo_), mod_arith_lazy_(modulus_), ntt_handler_(mod_arith_lazy_)
             {
                 root_powers_ = allocate<MultiplyUIntModOperand>(coeff_count_, pool_);
                 inv_root_powers_ = allocate<MultiplyUIntModOperand>(coeff_count_, pool_);
@@ -185,6 +193,10 @@ namespace seal
         /**
         Allocate and construct an array of NTTTables each with different a modulus.
 
+        The tables depend only on coeff_count_power and the modulus, and every level of a modulus switching chain (and
+        every RNSTool built for it) asks for the same primes again. Tables are therefore generated once per process and
+        kept in a cache; later calls only copy them into memory allocated from pool.
+
         @throws std::invalid_argument if modulus is empty, modulus does not support NTT, coeff_count_power is invalid,
         or pool is uninitialized.
         */
@@ -192,8 +204,25 @@ namespace seal
             int coeff_count_power, const std::vector<Modulus> &modulus, Pointer<NTTTables> &tables,
             MemoryPoolHandle pool);
 
+        /**
+        Returns the number of NTTTables held by the process-wide cache used by CreateNTTTables.
+        */
+        SEAL_NODISCARD std::size_t NTTTablesCacheSize();
+
+        /**
+        Releases the NTTTables held by the process-wide cache used by CreateNTTTables. Tables already copied out of
+        the cache are not affected.
+        */
+        void ClearNTTTablesCache();
+
         void ntt_negacyclic_harvey_lazy(CoeffIter operand, const NTTTables &tables);
 
+        /**
+        Transforms count polynomials modulo the same prime, stored back to back, exactly as count calls of the
+        single-polynomial overload would. With AVX2 the last two layers run across four polynomials at a time.
+        */
+        void ntt_negacyclic_harvey_lazy(CoeffIter operand, std::size_t count, const NTTTables &tables);
+
         inline void ntt_negacyclic_harvey_lazy(
             RNSIter operand, std::size_t coeff_modulus_size, ConstNTTTablesIter tables)
         {
@@ -207,7 +236,7 @@ namespace seal
                 throw std::invalid_argument("tables");
             }
 #endif
-            SEAL_ITERATE(iter(operand, tables), coeff_modulus_size, [&](auto I) {
+            parallel_iterate(iter(operand, tables), coeff_modulus_size, operand.poly_modulus_degree(), [&](auto I) {
                 ntt_negacyclic_harvey_lazy(get<0>(I), get<1>(I));
             });
         }
@@ -224,12 +253,20 @@ namespace seal
                 throw std::invalid_argument("tables");
             }
 #endif
+            if (try_parallel_for_each_rns(
+                    size, operand.coeff_modulus_size(), operand.poly_modulus_degree(),
+                    [&](std::size_t i, std::size_t j) { ntt_negacyclic_harvey_lazy(operand[i][j], tables[j]); }))
+            {
+                return;
+            }
             SEAL_ITERATE(
                 operand, size, [&](auto I) { ntt_negacyclic_harvey_lazy(I, operand.coeff_modulus_size(), tables); });
         }
 
         void ntt_negacyclic_harvey(CoeffIter operand, const NTTTables &tables);
 
+        void ntt_negacyclic_harvey(CoeffIter operand, std::size_t count, const NTTTables &tables);
+
         inline void ntt_negacyclic_harvey(RNSIter operand, std::size_t coeff_modulus_size, ConstNTTTablesIter tables)
         {
 #ifdef SEAL_DEBUG
@@ -242,7 +279,7 @@ namespace seal
                 throw std::invalid_argument("tables");
             }
 #endif
-            SEAL_ITERATE(iter(operand, tables), coeff_modulus_size, [&](auto I) {
+            parallel_iterate(iter(operand, tables), coeff_modulus_size, operand.poly_modulus_degree(), [&](auto I) {
                 ntt_negacyclic_harvey(get<0>(I), get<1>(I));
             });
         }
@@ -259,12 +296,24 @@ namespace seal
                 throw std::invalid_argument("tables");
             }
 #endif
+            if (try_parallel_for_each_rns(
+                    size, operand.coeff_modulus_size(), operand.poly_modulus_degree(),
+                    [&](std::size_t i, std::size_t j) { ntt_negacyclic_harvey(operand[i][j], tables[j]); }))
+            {
+                return;
+            }
             SEAL_ITERATE(
                 operand, size, [&](auto I) { ntt_negacyclic_harvey(I, operand.coeff_modulus_size(), tables); });
         }
 
         void inverse_ntt_negacyclic_harvey_lazy(CoeffIter operand, const NTTTables &tables);
 
+        /**
+        Inverse-transforms count polynomials modulo the same prime, stored back to back, exactly as count calls of
+        the single-polynomial overload would.
+        */
+        void inverse_ntt_negacyclic_harvey_lazy(CoeffIter operand, std::size_t count, const NTTTables &tables);
+
         inline void inverse_ntt_negacyclic_harvey_lazy(
             RNSIter operand, std::size_t coeff_modulus_size, ConstNTTTablesIter tables)
         {
@@ -278,9 +327,9 @@ namespace seal
                 throw std::invalid_argument("tables");
             }
 #endif
-            SEAL_ITERATE(iter(operand, tables), coeff_modulus_size, [&](auto I) {
-                inverse_ntt_negacyclic_harvey_lazy(get<0>(I), get<1>(I));
-            });
+            parallel_iterate(
+                iter(operand, tables), coeff_modulus_size, operand.poly_modulus_degree(),
+                [&](auto I) { inverse_ntt_negacyclic_harvey_lazy(get<0>(I), get<1>(I)); });
         }
 
         inline void inverse_ntt_negacyclic_harvey_lazy(PolyIter operand, std::size_t size, ConstNTTTablesIter tables)
@@ -295,6 +344,14 @@ namespace seal
                 throw std::invalid_argument("tables");
             }
 #endif
+            if (try_parallel_for_each_rns(
+                    size, operand.coeff_modulus_size(), operand.poly_modulus_degree(),
+                    [&](std::size_t i, std::size_t j) {
+                        inverse_ntt_negacyclic_harvey_lazy(operand[i][j], tables[j]);
+                    }))
+            {
+                return;
+            }
             SEAL_ITERATE(operand, size, [&](auto I) {
                 inverse_ntt_negacyclic_harvey_lazy(I, operand.coeff_modulus_size(), tables);
             });
@@ -302,6 +359,8 @@ namespace seal
 
         void inverse_ntt_negacyclic_harvey(CoeffIter operand, const NTTTables &tables);
 
+        void inverse_ntt_negacyclic_harvey(CoeffIter operand, std::size_t count, const NTTTables &tables);
+
         inline void inverse_ntt_negacyclic_harvey(
             RNSIter operand, std::size_t coeff_modulus_size, ConstNTTTablesIter tables)
         {
@@ -315,7 +374,7 @@ namespace seal
                 throw std::invalid_argument("tables");
             }
 #endif
-            SEAL_ITERATE(iter(operand, tables), coeff_modulus_size, [&](auto I) {
+            parallel_iterate(iter(operand, tables), coeff_modulus_size, operand.poly_modulus_degree(), [&](auto I) {
                 inverse_ntt_negacyclic_harvey(get<0>(I), get<1>(I));
             });
         }
@@ -332,6 +391,12 @@ namespace seal
                 throw std::invalid_argument("tables");
             }
 #endif
+            if (try_parallel_for_each_rns(
+                    size, operand.coeff_modulus_size(), operand.poly_modulus_degree(),
+                    [&](std::size_t i, std::size_t j) { inverse_ntt_negacyclic_harvey(operand[i][j], tables[j]); }))
+            {
+                return;
+            }
             SEAL_ITERATE(
                 operand, size, [&](auto I) { inverse_ntt_negacyclic_harvey(I, operand.coeff_modulus_size(), tables); });
         }
@@ -0,0 +1,482 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_AVX2_FLAGS. Nothing in it may run before use_avx2() has been checked,
+// and it must not use inline functions or templates shared with other translation units: the linker could pick the
+// AVX2 copy for the whole program. All helpers are therefore in an anonymous namespace.
+
+#include "seal/util/nttavx2.h"
+
+#ifdef SEAL_USE_AVX2
+#include <cstddef>
+#include <immintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx2
+        {
+            namespace
+            {
+                /*
+                From this transform size on, where one polynomial no longer fits in L1, the single-polynomial kernels
+                run depth-first: once the groups of a layer fit in a block of ntt_block_size coefficients (8 KB, with
+                the roots its layers use 24 KB), each block goes through all of its remaining layers in turn instead of
+                every layer passing over the whole array. The butterflies are the same, so is the output.
+                */
+                constexpr size_t ntt_blocked_min_size = 8192;
+
+                constexpr size_t ntt_block_size = 1024;
+
+                static_assert(ntt_blocked_min_size > ntt_block_size, "blocked layers need more than one block");
+
+                // Four MultiplyUIntModOperands, one per lane, with the high halves split off for _mm256_mul_epu32
+                struct Operand4
+                {
+                    __m256i operand;
+                    __m256i operand_hi;
+                    __m256i quotient;
+                    __m256i quotient_hi;
+                };
+
+                struct Modulus4
+                {
+                    __m256i value;
+                    __m256i value_hi;
+                    __m256i two_times_value;
+                    __m256i two_times_value_minus_one;
+                };
+
+                inline Operand4 make_operand4(__m256i operand, __m256i quotient)
+                {
+                    return { operand, _mm256_srli_epi64(operand, 32), quotient, _mm256_srli_epi64(quotient, 32) };
+                }
+
+                inline Operand4 broadcast(const MultiplyUIntModOperand &r)
+                {
+                    return make_operand4(
+                        _mm256_set1_epi64x(static_cast<long long>(r.operand)),
+                        _mm256_set1_epi64x(static_cast<long long>(r.quotient)));
+                }
+
+                inline Modulus4 make_modulus4(uint64_t modulus)
+                {
+                    return { _mm256_set1_epi64x(static_cast<long long>(modulus)),
+                             _mm256_set1_epi64x(static_cast<long long>(modulus >> 32)),
+                             _mm256_set1_epi64x(static_cast<long long>(modulus << 1)),
+                             _mm256_set1_epi64x(static_cast<long long>((modulus << 1) - 1)) };
+                }
+
+                // Low 64 bits of a * b, given a >> 32 and b >> 32
+                inline __m256i mul_lo(__m256i a, __m256i a_hi, __m256i b, __m256i b_hi)
+                {
+                    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, b_hi), _mm256_mul_epu32(a_hi, b));
+                    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+                }
+
+                // High 64 bits of a * b, given a >> 32 and b >> 32
+                inline __m256i mul_hi(__m256i a, __m256i a_hi, __m256i b, __m256i b_hi)
+                {
+                    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+                    __m256i lolo = _mm256_mul_epu32(a, b);
+                    __m256i lohi = _mm256_mul_epu32(a, b_hi);
+                    __m256i hilo = _mm256_mul_epu32(a_hi, b);
+                    __m256i hihi = _mm256_mul_epu32(a_hi, b_hi);
+
+                    // Carry out of the middle 32 bits; at most 3 * 2^32 so it cannot overflow
+                    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(lolo, 32), _mm256_and_si256(lohi, low_mask));
+                    mid = _mm256_add_epi64(mid, _mm256_and_si256(hilo, low_mask));
+
+                    __m256i hi = _mm256_add_epi64(hihi, _mm256_srli_epi64(lohi, 32));
+                    hi = _mm256_add_epi64(hi, _mm256_srli_epi64(hilo, 32));
+                    return _mm256_add_epi64(hi, _mm256_srli_epi64(mid, 32));
+                }
+
+                // multiply_uint_mod_lazy on four lanes: a * r mod p in [0, 2p)
+                inline __m256i mul_lazy(__m256i a, const Operand4 &r, const Modulus4 &m)
+                {
+                    __m256i a_hi = _mm256_srli_epi64(a, 32);
+                    __m256i q = mul_hi(a, a_hi, r.quotient, r.quotient_hi);
+                    __m256i product = mul_lo(a, a_hi, r.operand, r.operand_hi);
+                    return _mm256_sub_epi64(product, mul_lo(q, _mm256_srli_epi64(q, 32), m.value, m.value_hi));
+                }
+
+                // Subtract 2p from lanes >= 2p; lanes are below 4p < 2^63, so the signed comparison is exact
+                inline __m256i guard(__m256i a, const Modulus4 &m)
+                {
+                    __m256i mask = _mm256_cmpgt_epi64(a, m.two_times_value_minus_one);
+                    return _mm256_sub_epi64(a, _mm256_and_si256(mask, m.two_times_value));
+                }
+
+                // Forward (Cooley-Tukey) butterfly, as in DWTHandler::transform_to_rev
+                inline void forward_butterfly(__m256i &x, __m256i &y, const Operand4 &r, const Modulus4 &m)
+                {
+                    __m256i u = guard(x, m);
+                    __m256i v = mul_lazy(y, r, m);
+                    x = _mm256_add_epi64(u, v);
+                    y = _mm256_sub_epi64(_mm256_add_epi64(u, m.two_times_value), v);
+                }
+
+                // Inverse (Gentleman-Sande) butterfly, as in DWTHandler::transform_from_rev
+                inline void inverse_butterfly(__m256i &x, __m256i &y, const Operand4 &r, const Modulus4 &m)
+                {
+                    __m256i u = x;
+                    __m256i v = y;
+                    x = guard(_mm256_add_epi64(u, v), m);
+                    y = mul_lazy(_mm256_sub_epi64(_mm256_add_epi64(u, m.two_times_value), v), r, m);
+                }
+
+                inline __m256i load(const uint64_t *p)
+                {
+                    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                }
+
+                inline void store(uint64_t *p, __m256i a)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+                }
+
+                // Roots for two adjacent groups of gap 2: lanes r[0], r[0], r[1], r[1]
+                inline Operand4 load_roots_gap2(const MultiplyUIntModOperand *r)
+                {
+                    // operand 0, quotient 0, operand 1, quotient 1
+                    __m256i pair = load(reinterpret_cast<const uint64_t *>(r));
+                    return make_operand4(_mm256_permute4x64_epi64(pair, 0xA0), _mm256_permute4x64_epi64(pair, 0xF5));
+                }
+
+                // Roots for four adjacent groups of gap 1, in the lane order of unpack: r[0], r[2], r[1], r[3]
+                inline Operand4 load_roots_gap1(const MultiplyUIntModOperand *r)
+                {
+                    __m256i r01 = load(reinterpret_cast<const uint64_t *>(r));
+                    __m256i r23 = load(reinterpret_cast<const uint64_t *>(r + 2));
+                    return make_operand4(_mm256_unpacklo_epi64(r01, r23), _mm256_unpackhi_epi64(r01, r23));
+                }
+
+                /*
+                Layers with gap 2 and gap 1 have fewer than four butterflies per root. They are vectorized across
+                groups: for gap 2 the x and y halves of two neighboring groups are gathered with 128-bit permutes,
+                for gap 1 those of four groups with 64-bit unpacks. The same shuffles scatter the results back.
+                */
+                template <bool Forward>
+                inline void layer_gap2(
+                    uint64_t *values, size_t groups, const MultiplyUIntModOperand *roots, const Modulus4 &m)
+                {
+                    for (size_t i = 0; i < groups; i += 2, values += 8, roots += 2)
+                    {
+                        __m256i a = load(values);
+                        __m256i b = load(values + 4);
+                        __m256i x = _mm256_permute2x128_si256(a, b, 0x20);
+                        __m256i y = _mm256_permute2x128_si256(a, b, 0x31);
+                        Operand4 r = load_roots_gap2(roots);
+                        if (Forward)
+                        {
+                            forward_butterfly(x, y, r, m);
+                        }
+                        else
+                        {
+                            inverse_butterfly(x, y, r, m);
+                        }
+                        store(values, _mm256_permute2x128_si256(x, y, 0x20));
+                        store(values + 4, _mm256_permute2x128_si256(x, y, 0x31));
+                    }
+                }
+
+                template <bool Forward>
+                inline void layer_gap1(
+                    uint64_t *values, size_t groups, const MultiplyUIntModOperand *roots, const Modulus4 &m)
+                {
+                    for (size_t i = 0; i < groups; i += 4, values += 8, roots += 4)
+                    {
+                        __m256i a = load(values);
+                        __m256i b = load(values + 4);
+                        __m256i x = _mm256_unpacklo_epi64(a, b);
+                        __m256i y = _mm256_unpackhi_epi64(a, b);
+                        Operand4 r = load_roots_gap1(roots);
+                        if (Forward)
+                        {
+                            forward_butterfly(x, y, r, m);
+                        }
+                        else
+                        {
+                            inverse_butterfly(x, y, r, m);
+                        }
+                        store(values, _mm256_unpacklo_epi64(x, y));
+                        store(values + 4, _mm256_unpackhi_epi64(x, y));
+                    }
+                }
+
+                // One forward layer of the given gap on groups [first, first + count); layer_roots[i] is for group i
+                inline void forward_layer(
+                    uint64_t *values, size_t gap, size_t first, size_t count, const MultiplyUIntModOperand *layer_roots,
+                    const Modulus4 &m)
+                {
+                    for (size_t i = first; i < first + count; i++)
+                    {
+                        const Operand4 r = broadcast(layer_roots[i]);
+                        uint64_t *x = values + 2 * gap * i;
+                        uint64_t *y = x + gap;
+                        for (size_t j = 0; j < gap; j += 4, x += 4, y += 4)
+                        {
+                            __m256i vx = load(x);
+                            __m256i vy = load(y);
+                            forward_butterfly(vx, vy, r, m);
+                            store(x, vx);
+                            store(y, vy);
+                        }
+                    }
+                }
+
+                // One inverse layer of the given gap on groups [first, first + count)
+                inline void inverse_layer(
+                    uint64_t *values, size_t gap, size_t first, size_t count, const MultiplyUIntModOperand *layer_roots,
+                    const Modulus4 &m)
+                {
+                    for (size_t i = first; i < first + count; i++)
+                    {
+                        const Operand4 r = broadcast(layer_roots[i]);
+                        uint64_t *x = values + 2 * gap * i;
+                        uint64_t *y = x + gap;
+                        for (size_t j = 0; j < gap; j += 4, x += 4, y += 4)
+                        {
+                            __m256i vx = load(x);
+                            __m256i vy = load(y);
+                            inverse_butterfly(vx, vy, r, m);
+                            store(x, vx);
+                            store(y, vy);
+                        }
+                    }
+                }
+
+                // Layers of gap 4 and more; returns the number of groups of the gap-2 layer
+                inline size_t forward_wide_layers(
+                    uint64_t *values, size_t n, const MultiplyUIntModOperand *&roots, const Modulus4 &m)
+                {
+                    size_t groups = 1;
+                    for (size_t gap = n >> 1; gap >= 4; gap >>= 1, groups <<= 1)
+                    {
+                        forward_layer(values, gap, 0, groups, roots, m);
+                        roots += groups;
+                    }
+                    return groups;
+                }
+
+                // Layers from the given gap (at least 4) on, the last one merged with the multiplication by n^(-1)
+                inline void inverse_wide_layers(
+                    uint64_t *values, size_t gap, size_t groups, const MultiplyUIntModOperand *roots,
+                    const Modulus4 &m, const MultiplyUIntModOperand &inv_degree,
+                    const MultiplyUIntModOperand &scaled_last_root)
+                {
+                    for (; groups > 1; gap <<= 1, groups >>= 1)
+                    {
+                        inverse_layer(values, gap, 0, groups, roots, m);
+                        roots += groups;
+                    }
+
+                    // Last layer: the multiplication by n^(-1) is merged into the butterfly
+                    const Operand4 r = broadcast(scaled_last_root);
+                    const Operand4 s = broadcast(inv_degree);
+                    uint64_t *x = values;
+                    uint64_t *y = x + gap;
+                    for (size_t j = 0; j < gap; j += 4, x += 4, y += 4)
+                    {
+                        __m256i u = guard(load(x), m);
+                        __m256i v = load(y);
+                        store(x, mul_lazy(guard(_mm256_add_epi64(u, v), m), s, m));
+                        store(y, mul_lazy(_mm256_sub_epi64(_mm256_add_epi64(u, m.two_times_value), v), r, m));
+                    }
+                }
+
+                // 4x4 transpose of 64-bit lanes; its own inverse
+                inline void transpose(__m256i &a, __m256i &b, __m256i &c, __m256i &d)
+                {
+                    __m256i t0 = _mm256_unpacklo_epi64(a, b);
+                    __m256i t1 = _mm256_unpackhi_epi64(a, b);
+                    __m256i t2 = _mm256_unpacklo_epi64(c, d);
+                    __m256i t3 = _mm256_unpackhi_epi64(c, d);
+                    a = _mm256_permute2x128_si256(t0, t2, 0x20);
+                    b = _mm256_permute2x128_si256(t1, t3, 0x20);
+                    c = _mm256_permute2x128_si256(t0, t2, 0x31);
+                    d = _mm256_permute2x128_si256(t1, t3, 0x31);
+                }
+
+                /*
+                The gap-2 and gap-1 layers of four polynomials at once. Each block of four coefficients of the four
+                polynomials is transposed so that a lane holds one polynomial: both layers then run in registers with
+                broadcast roots, and the block is transposed back.
+                */
+                template <bool Forward>
+                inline void narrow_layers4(
+                    uint64_t *values, size_t n, const MultiplyUIntModOperand *roots_gap2,
+                    const MultiplyUIntModOperand *roots_gap1, const Modulus4 &m)
+                {
+                    uint64_t *p0 = values;
+                    uint64_t *p1 = p0 + n;
+                    uint64_t *p2 = p1 + n;
+                    uint64_t *p3 = p2 + n;
+                    for (size_t k = 0; k < n; k += 4, roots_gap2++, roots_gap1 += 2)
+                    {
+                        __m256i c0 = load(p0 + k);
+                        __m256i c1 = load(p1 + k);
+                        __m256i c2 = load(p2 + k);
+                        __m256i c3 = load(p3 + k);
+                        transpose(c0, c1, c2, c3);
+                        const Operand4 r2 = broadcast(*roots_gap2);
+                        const Operand4 r1a = broadcast(roots_gap1[0]);
+                        const Operand4 r1b = broadcast(roots_gap1[1]);
+                        if (Forward)
+                        {
+                            forward_butterfly(c0, c2, r2, m);
+                            forward_butterfly(c1, c3, r2, m);
+                            forward_butterfly(c0, c1, r1a, m);
+                            forward_butterfly(c2, c3, r1b, m);
+                        }
+                        else
+                        {
+                            inverse_butterfly(c0, c1, r1a, m);
+                            inverse_butterfly(c2, c3, r1b, m);
+                            inverse_butterfly(c0, c2, r2, m);
+                            inverse_butterfly(c1, c3, r2, m);
+                        }
+                        transpose(c0, c1, c2, c3);
+                        store(p0 + k, c0);
+                        store(p1 + k, c1);
+                        store(p2 + k, c2);
+                        store(p3 + k, c3);
+                    }
+                }
+            } // namespace
+
+            void ntt_negacyclic_harvey_lazy(
+                uint64_t *values, int log_n, const MultiplyUIntModOperand *roots, uint64_t modulus)
+            {
+                size_t n = size_t(1) << log_n;
+                const Modulus4 m = make_modulus4(modulus);
+
+                if (n >= ntt_blocked_min_size)
+                {
+                    // The layer with g groups uses roots[g, 2g). Layers whose groups span more than a block run over
+                    // the whole array; every block then runs the remaining layers on itself while it stays in L1
+                    size_t gap = n >> 1;
+                    size_t groups = 1;
+                    for (; gap >= ntt_block_size; gap >>= 1, groups <<= 1)
+                    {
+                        forward_layer(values, gap, 0, groups, roots + groups, m);
+                    }
+                    for (size_t block = 0; block < n / ntt_block_size; block++)
+                    {
+                        size_t offset = block * ntt_block_size;
+                        for (size_t g = gap, layer_groups = groups; g >= 4; g >>= 1, layer_groups <<= 1)
+                        {
+                            size_t per_block = ntt_block_size / (2 * g);
+                            forward_layer(values, g, block * per_block, per_block, roots + layer_groups, m);
+                        }
+                        layer_gap2<true>(values + offset, ntt_block_size / 4, roots + n / 4 + offset / 4, m);
+                        layer_gap1<true>(values + offset, ntt_block_size / 2, roots + n / 2 + offset / 2, m);
+                    }
+                    return;
+                }
+
+                // Roots are consumed in the same order as DWTHandler: one per group, starting at index 1
+                roots++;
+                size_t groups = forward_wide_layers(values, n, roots, m);
+                layer_gap2<true>(values, groups, roots, m);
+                roots += groups;
+                groups <<= 1;
+                layer_gap1<true>(values, groups, roots, m);
+            }
+
+            void ntt_negacyclic_harvey_lazy(
+                uint64_t *values, size_t count, int log_n, const MultiplyUIntModOperand *roots, uint64_t modulus)
+            {
+                size_t n = size_t(1) << log_n;
+                const Modulus4 m = make_modulus4(modulus);
+                size_t tiled = count & ~size_t(3);
+                for (size_t t = 0; t < tiled; t += 4)
+                {
+                    uint64_t *tile = values + t * n;
+                    const MultiplyUIntModOperand *narrow_roots = nullptr;
+                    for (size_t i = 0; i < 4; i++)
+                    {
+                        narrow_roots = roots + 1;
+                        forward_wide_layers(tile + i * n, n, narrow_roots, m);
+                    }
+                    narrow_layers4<true>(tile, n, narrow_roots, narrow_roots + n / 4, m);
+                }
+                for (size_t i = tiled; i < count; i++)
+                {
+                    ntt_negacyclic_harvey_lazy(values + i * n, log_n, roots, modulus);
+                }
+            }
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                uint64_t *values, int log_n, const MultiplyUIntModOperand *roots, uint64_t modulus,
+                const MultiplyUIntModOperand &inv_degree, const MultiplyUIntModOperand &scaled_last_root)
+            {
+                size_t n = size_t(1) << log_n;
+                const Modulus4 m = make_modulus4(modulus);
+
+                if (n >= ntt_blocked_min_size)
+                {
+                    // The layer with g groups uses roots[n - 2g + 1, n - g + 1). Every block runs the layers whose
+                    // groups fit in it on itself while it stays in L1; the rest run over the whole array
+                    for (size_t block = 0; block < n / ntt_block_size; block++)
+                    {
+                        size_t offset = block * ntt_block_size;
+                        layer_gap1<false>(values + offset, ntt_block_size / 2, roots + 1 + offset / 2, m);
+                        layer_gap2<false>(values + offset, ntt_block_size / 4, roots + n / 2 + 1 + offset / 4, m);
+                        for (size_t g = 4, layer_groups = n / 8; g < ntt_block_size; g <<= 1, layer_groups >>= 1)
+                        {
+                            size_t per_block = ntt_block_size / (2 * g);
+                            inverse_layer(
+                                values, g, block * per_block, per_block, roots + n - 2 * layer_groups + 1, m);
+                        }
+                    }
+                    size_t groups = n / (2 * ntt_block_size);
+                    inverse_wide_layers(
+                        values, ntt_block_size, groups, roots + n - 2 * groups + 1, m, inv_degree, scaled_last_root);
+                    return;
+                }
+
+                roots++;
+                size_t groups = n >> 1;
+                layer_gap1<false>(values, groups, roots, m);
+                roots += groups;
+                groups >>= 1;
+                layer_gap2<false>(values, groups, roots, m);
+                roots += groups;
+                groups >>= 1;
+                inverse_wide_layers(values, 4, groups, roots, m, inv_degree, scaled_last_root);
+            }
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                uint64_t *values, size_t count, int log_n, const MultiplyUIntModOperand *roots, uint64_t modulus,
+                const MultiplyUIntModOperand &inv_degree, const MultiplyUIntModOperand &scaled_last_root)
+            {
+                size_t n = size_t(1) << log_n;
+                const Modulus4 m = make_modulus4(modulus);
+                const MultiplyUIntModOperand *roots_gap1 = roots + 1;
+                const MultiplyUIntModOperand *roots_gap2 = roots_gap1 + n / 2;
+                const MultiplyUIntModOperand *wide_roots = roots_gap2 + n / 4;
+                size_t tiled = count & ~size_t(3);
+                for (size_t t = 0; t < tiled; t += 4)
+                {
+                    uint64_t *tile = values + t * n;
+                    narrow_layers4<false>(tile, n, roots_gap2, roots_gap1, m);
+                    for (size_t i = 0; i < 4; i++)
+                    {
+                        inverse_wide_layers(tile + i * n, 4, n >> 3, wide_roots, m, inv_degree, scaled_last_root);
+                    }
+                }
+                for (size_t i = tiled; i < count; i++)
+                {
+                    inverse_ntt_negacyclic_harvey_lazy(
+                        values + i * n, log_n, roots, modulus, inv_degree, scaled_last_root);
+                }
+            }
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_AVX2
+#include "seal/util/uintarithsmallmod.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        AVX2 kernels for the negacyclic NTT. They produce exactly the same output as the portable DWTHandler-based
+        implementation and must only be called when use_avx2() is true; ntt_negacyclic_harvey_lazy and
+        inverse_ntt_negacyclic_harvey_lazy dispatch to them automatically.
+
+        Four coefficients are processed per instruction. AVX2 has no 64x64-bit multiplication, so the lazy Shoup
+        product of the Harvey butterfly is assembled from 32x32-bit multiplications. The last two layers, which have
+        fewer than four butterflies per root, are vectorized across neighboring groups instead; the batched overloads
+        vectorize them across four polynomials, with one transpose per block of four coefficients for both layers.
+
+        The implementation is compiled with AVX2 enabled, so it takes plain pointers and values rather than NTTTables:
+        it must not instantiate any inline function that other translation units also use.
+        */
+        namespace avx2
+        {
+            /**
+            Forward transform; inputs in [0, 4 * modulus), outputs in [0, 4 * modulus) in bit-reversed order.
+
+            @param[in,out] values The 2^log_n coefficients
+            @param[in] log_n Logarithm of the transform size; must be at least 3
+            @param[in] roots NTTTables::get_from_root_powers()
+            @param[in] modulus The modulus, at most 61 bits
+            */
+            void ntt_negacyclic_harvey_lazy(
+                std::uint64_t *values, int log_n, const MultiplyUIntModOperand *roots, std::uint64_t modulus);
+
+            /**
+            Forward transform of count polynomials stored back to back, as count calls of the overload above.
+            */
+            void ntt_negacyclic_harvey_lazy(
+                std::uint64_t *values, std::size_t count, int log_n, const MultiplyUIntModOperand *roots,
+                std::uint64_t modulus);
+
+            /**
+            Inverse transform, including the multiplication by n^(-1) merged into the last layer; inputs in
+            [0, 2 * modulus), outputs in [0, 2 * modulus).
+
+            @param[in,out] values The 2^log_n coefficients in bit-reversed order
+            @param[in] log_n Logarithm of the transform size; must be at least 3
+            @param[in] roots NTTTables::get_from_inv_root_powers()
+            @param[in] modulus The modulus, at most 61 bits
+            @param[in] inv_degree NTTTables::inv_degree_modulo()
+            @param[in] scaled_last_root roots[2^log_n - 1] multiplied by n^(-1) modulo modulus
+            */
+            void inverse_ntt_negacyclic_harvey_lazy(
+                std::uint64_t *values, int log_n, const MultiplyUIntModOperand *roots, std::uint64_t modulus,
+                const MultiplyUIntModOperand &inv_degree, const MultiplyUIntModOperand &scaled_last_root);
+
+            /**
+            Inverse transform of count polynomials stored back to back, as count calls of the overload above.
+            */
+            void inverse_ntt_negacyclic_harvey_lazy(
+                std::uint64_t *values, std::size_t count, int log_n, const MultiplyUIntModOperand *roots,
+                std::uint64_t modulus, const MultiplyUIntModOperand &inv_degree,
+                const MultiplyUIntModOperand &scaled_last_root);
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,165 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_SVE_FLAGS. Nothing in it may run before use_sve() has been checked, and
+// it must not use inline functions or templates shared with other translation units: the linker could pick the SVE
+// copy for the whole program. All helpers are therefore in an anonymous namespace.
+
+#include "seal/util/nttsve.h"
+
+#ifdef SEAL_USE_SVE
+#include <cstddef>
+#include <arm_sve.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace sve
+        {
+            namespace
+            {
+                // multiply_uint_mod_lazy: a * r mod p in [0, 2p)
+                inline uint64_t mul_lazy(uint64_t a, const MultiplyUIntModOperand &r, uint64_t p)
+                {
+                    uint64_t q = static_cast<uint64_t>((static_cast<unsigned __int128>(a) * r.quotient) >> 64);
+                    return a * r.operand - q * p;
+                }
+
+                inline svuint64_t mul_lazy(svbool_t pg, svuint64_t a, const MultiplyUIntModOperand &r, uint64_t p)
+                {
+                    svuint64_t q = svmulh_n_u64_x(pg, a, r.quotient);
+                    return svmls_n_u64_x(pg, svmul_n_u64_x(pg, a, r.operand), q, p);
+                }
+
+                inline uint64_t guard(uint64_t a, uint64_t two_p)
+                {
+                    return a >= two_p ? a - two_p : a;
+                }
+
+                inline svuint64_t guard(svbool_t pg, svuint64_t a, uint64_t two_p)
+                {
+                    return svsub_n_u64_m(svcmpge_n_u64(pg, a, two_p), a, two_p);
+                }
+
+                // One group of forward butterflies, as in DWTHandler::transform_to_rev
+                void forward_group(
+                    uint64_t *x, uint64_t *y, size_t gap, const MultiplyUIntModOperand &r, uint64_t p, size_t lanes)
+                {
+                    const uint64_t two_p = p << 1;
+                    if (gap < lanes)
+                    {
+                        for (size_t j = 0; j < gap; j++)
+                        {
+                            uint64_t u = guard(x[j], two_p);
+                            uint64_t v = mul_lazy(y[j], r, p);
+                            x[j] = u + v;
+                            y[j] = u + two_p - v;
+                        }
+                        return;
+                    }
+                    for (size_t j = 0; j < gap; j += lanes)
+                    {
+                        svbool_t pg = svwhilelt_b64_u64(j, gap);
+                        svuint64_t u = guard(pg, svld1_u64(pg, x + j), two_p);
+                        svuint64_t v = mul_lazy(pg, svld1_u64(pg, y + j), r, p);
+                        svst1_u64(pg, x + j, svadd_u64_x(pg, u, v));
+                        svst1_u64(pg, y + j, svsub_u64_x(pg, svadd_n_u64_x(pg, u, two_p), v));
+                    }
+                }
+
+                // One group of inverse butterflies, as in DWTHandler::transform_from_rev
+                void inverse_group(
+                    uint64_t *x, uint64_t *y, size_t gap, const MultiplyUIntModOperand &r, uint64_t p, size_t lanes)
+                {
+                    const uint64_t two_p = p << 1;
+                    if (gap < lanes)
+                    {
+                        for (size_t j = 0; j < gap; j++)
+                        {
+                            uint64_t u = x[j];
+                            uint64_t v = y[j];
+                            x[j] = guard(u + v, two_p);
+                            y[j] = mul_lazy(u + two_p - v, r, p);
+                        }
+                        return;
+                    }
+                    for (size_t j = 0; j < gap; j += lanes)
+                    {
+                        svbool_t pg = svwhilelt_b64_u64(j, gap);
+                        svuint64_t u = svld1_u64(pg, x + j);
+                        svuint64_t v = svld1_u64(pg, y + j);
+                        svst1_u64(pg, x + j, guard(pg, svadd_u64_x(pg, u, v), two_p));
+                        svst1_u64(pg, y + j, mul_lazy(pg, svsub_u64_x(pg, svadd_n_u64_x(pg, u, two_p), v), r, p));
+                    }
+                }
+            } // namespace
+
+            void ntt_negacyclic_harvey_lazy(
+                uint64_t *values, int log_n, const MultiplyUIntModOperand *roots, uint64_t modulus)
+            {
+                const size_t n = size_t(1) << log_n;
+                const size_t lanes = svcntd();
+
+                // Roots are consumed in the same order as DWTHandler: one per group, starting at index 1
+                roots++;
+                for (size_t gap = n >> 1, groups = 1; gap > 0; gap >>= 1, groups <<= 1)
+                {
+                    for (size_t i = 0; i < groups; i++)
+                    {
+                        uint64_t *x = values + 2 * gap * i;
+                        forward_group(x, x + gap, gap, *roots++, modulus, lanes);
+                    }
+                }
+            }
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                uint64_t *values, int log_n, const MultiplyUIntModOperand *roots, uint64_t modulus,
+                const MultiplyUIntModOperand &inv_degree, const MultiplyUIntModOperand &scaled_last_root)
+            {
+                const size_t n = size_t(1) << log_n;
+                const size_t lanes = svcntd();
+                const uint64_t two_p = modulus << 1;
+
+                roots++;
+                size_t gap = 1;
+                for (size_t groups = n >> 1; groups > 1; gap <<= 1, groups >>= 1)
+                {
+                    for (size_t i = 0; i < groups; i++)
+                    {
+                        uint64_t *x = values + 2 * gap * i;
+                        inverse_group(x, x + gap, gap, *roots++, modulus, lanes);
+                    }
+                }
+
+                // Last layer: the multiplication by n^(-1) is merged into the butterfly
+                uint64_t *x = values;
+                uint64_t *y = values + gap;
+                if (gap < lanes)
+                {
+                    for (size_t j = 0; j < gap; j++)
+                    {
+                        uint64_t u = guard(x[j], two_p);
+                        uint64_t v = y[j];
+                        x[j] = mul_lazy(guard(u + v, two_p), inv_degree, modulus);
+                        y[j] = mul_lazy(u + two_p - v, scaled_last_root, modulus);
+                    }
+                    return;
+                }
+                for (size_t j = 0; j < gap; j += lanes)
+                {
+                    svbool_t pg = svwhilelt_b64_u64(j, gap);
+                    svuint64_t u = guard(pg, svld1_u64(pg, x + j), two_p);
+                    svuint64_t v = svld1_u64(pg, y + j);
+                    svst1_u64(pg, x + j, mul_lazy(pg, guard(pg, svadd_u64_x(pg, u, v), two_p), inv_degree, modulus));
+                    svst1_u64(
+                        pg, y + j,
+                        mul_lazy(pg, svsub_u64_x(pg, svadd_n_u64_x(pg, u, two_p), v), scaled_last_root, modulus));
+                }
+            }
+        } // namespace sve
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_SVE
+#include "seal/util/uintarithsmallmod.h"
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        SVE kernels for the negacyclic NTT, with the same contract as the AVX2 kernels in nttavx2.h. They produce
+        exactly the same output as the portable implementation and must only be called when use_sve() is true.
+
+        SVE has 64-bit vector multiply and multiply-high instructions, so the lazy Shoup product maps directly onto
+        the vector unit. The code is vector-length agnostic; layers whose gap is shorter than a vector run scalar.
+        */
+        namespace sve
+        {
+            /**
+            Forward transform; inputs in [0, 4 * modulus), outputs in [0, 4 * modulus) in bit-reversed order.
+
+            @param[in,out] values The 2^log_n coefficients
+            @param[in] log_n Logarithm of the transform size
+            @param[in] roots NTTTables::get_from_root_powers()
+            @param[in] modulus The modulus, at most 61 bits
+            */
+            void ntt_negacyclic_harvey_lazy(
+                std::uint64_t *values, int log_n, const MultiplyUIntModOperand *roots, std::uint64_t modulus);
+
+            /**
+            Inverse transform, including the multiplication by n^(-1); inputs in [0, 2 * modulus), outputs in
+            [0, 2 * modulus).
+
+            @param[in,out] values The 2^log_n coefficients in bit-reversed order
+            @param[in] log_n Logarithm of the transform size
+            @param[in] roots NTTTables::get_from_inv_root_powers()
+            @param[in] modulus The modulus, at most 61 bits
+            @param[in] inv_degree NTTTables::inv_degree_modulo()
+            @param[in] scaled_last_root roots[2^log_n - 1] multiplied by n^(-1) modulo modulus
+            */
+            void inverse_ntt_negacyclic_harvey_lazy(
+                std::uint64_t *values, int log_n, const MultiplyUIntModOperand *roots, std::uint64_t modulus,
+                const MultiplyUIntModOperand &inv_degree, const MultiplyUIntModOperand &scaled_last_root);
+        } // namespace sve
+    } // namespace util
+} // namespace seal
+#endif
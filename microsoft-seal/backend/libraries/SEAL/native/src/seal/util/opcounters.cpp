@@ -0,0 +1,16 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/util/opcounters.h"
+
+namespace seal
+{
+    namespace util
+    {
+        OperationCounters *&thread_operation_counters() noexcept
+        {
+            static thread_local OperationCounters *counters = nullptr;
+            return counters;
+        }
+    } // namespace util
+} // namespace seal
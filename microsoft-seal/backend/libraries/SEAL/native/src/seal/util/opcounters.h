@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include <atomic>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        // Counters of a seal::OperationCounts. Operations run on a thread count for the counters the thread is
+        // attached to (see thread_operation_counters), and so do those run by the helper tasks of a parallel loop
+        // the thread started.
+        struct OperationCounters
+        {
+            // Residue polynomials (one prime, N coefficients) transformed to NTT form
+            std::atomic<std::uint64_t> forward_ntt_count{ 0 };
+
+            // Residue polynomials transformed back from NTT form
+            std::atomic<std::uint64_t> inverse_ntt_count{ 0 };
+
+            // Key switches: relinearizations and Galois automorphisms
+            std::atomic<std::uint64_t> key_switch_count{ 0 };
+
+            // RNS base conversions of a polynomial (BFV multiplication and decryption)
+            std::atomic<std::uint64_t> base_conversion_count{ 0 };
+
+            // Items handed out by memory pools
+            std::atomic<std::uint64_t> allocation_count{ 0 };
+        };
+
+        // The counters the calling thread reports to, or nullptr
+        SEAL_NODISCARD OperationCounters *&thread_operation_counters() noexcept;
+    } // namespace util
+} // namespace seal
+
+#ifdef SEAL_USE_OPERATION_COUNTS
+// Adds count to one field of the calling thread's OperationCounters, if it has any
+#define SEAL_COUNT_OPERATION(field, count)                                                           \
+    do                                                                                               \
+    {                                                                                                \
+        if (seal::util::OperationCounters *_seal_counters = seal::util::thread_operation_counters()) \
+        {                                                                                            \
+            _seal_counters->field.fetch_add(count, std::memory_order_relaxed);                       \
+        }                                                                                            \
+    } while (false)
+#else
+#define SEAL_COUNT_OPERATION(field, count) \
+    do                                     \
+    {                                      \
+    } while (false)
+#endif
@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/memorymanager.h"
+#include "seal/parallel.h"
+#include "seal/util/defines.h"
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        Returns the number of tasks, including the calling thread, that a loop over count items of coeffs_per_item
+        coefficients each should be split into under the current ParallelExecution settings. Returns 1 if the loop
+        should run sequentially, in particular when called from inside a parallel loop.
+        */
+        SEAL_NODISCARD std::size_t parallel_task_count(std::size_t count, std::size_t coeffs_per_item) noexcept;
+
+        /**
+        Same for a loop over count items that are each worth a task whatever the minimum work per task, such as the
+        components of key switching keys in key generation (a full encryption each): up to count tasks, capped at the
+        executor's concurrency plus the calling thread.
+        */
+        SEAL_NODISCARD std::size_t parallel_task_count(std::size_t count) noexcept;
+
+        /**
+        Calls body(i) for every i in [0, count), on the calling thread and up to task_count - 1 helper tasks of the
+        current executor. Returns when all calls have completed; afterwards the first exception thrown by body, if
+        any, is rethrown.
+        */
+        void parallel_for(std::size_t count, std::size_t task_count, const std::function<void(std::size_t)> &body);
+
+        /**
+        Same as SEAL_ITERATE(it, count, body), except that the items may be processed concurrently when there is
+        enough work. The calls of body must be independent of each other, and body must allocate from
+        parallel_pool(pool) rather than from pool.
+        */
+        template <typename It, typename Func>
+        inline void parallel_iterate(It it, std::size_t count, std::size_t coeffs_per_item, Func &&body)
+        {
+            std::size_t task_count = parallel_task_count(count, coeffs_per_item);
+            if (task_count < 2)
+            {
+                SEAL_ITERATE(it, count, std::forward<Func>(body));
+                return;
+            }
+            parallel_for(count, task_count, [&](std::size_t i) { body(*(it + i)); });
+        }
+
+        /**
+        Calls body(i, j) for every RNS component j of every polynomial i in [0, size), possibly concurrently, if
+        the size * coeff_modulus_size components of coeff_count coefficients each are enough work to split. Returns
+        false without calling body otherwise, and the caller runs its sequential loop instead. Flattening the two
+        loops keeps all threads busy across polynomial boundaries.
+        */
+        template <typename Func>
+        SEAL_NODISCARD inline bool try_parallel_for_each_rns(
+            std::size_t size, std::size_t coeff_modulus_size, std::size_t coeff_count, Func &&body)
+        {
+            std::size_t count = size * coeff_modulus_size;
+            std::size_t task_count = parallel_task_count(count, coeff_count);
+            if (task_count < 2)
+            {
+                return false;
+            }
+            parallel_for(
+                count, task_count, [&](std::size_t i) { body(i / coeff_modulus_size, i % coeff_modulus_size); });
+            return true;
+        }
+
+        /**
+        Returns pool, or the thread-local memory pool when called from a helper task of parallel_for. Memory
+        pools need not be thread-safe, so work items running on helper threads must not share the caller's pool.
+        */
+        SEAL_NODISCARD MemoryPoolHandle parallel_pool(const MemoryPoolHandle &pool);
+    } // namespace util
+} // namespace seal
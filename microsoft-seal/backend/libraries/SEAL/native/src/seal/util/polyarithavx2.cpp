@@ -0,0 +1,241 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_AVX2_FLAGS; see the note in nttavx2.cpp.
+
+#include "seal/util/polyarithavx2.h"
+
+#ifdef SEAL_USE_AVX2
+#include <immintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx2
+        {
+            namespace
+            {
+                inline __m256i load(const uint64_t *ptr)
+                {
+                    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+                }
+
+                inline void store(uint64_t *ptr, __m256i value)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(ptr), value);
+                }
+
+                // Applies op to four coefficients at a time; the last count % 4 go through masked loads and stores
+                template <typename Op>
+                inline void for_each4(
+                    const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t *result, Op op)
+                {
+                    size_t i = 0;
+                    for (; i + 4 <= count; i += 4)
+                    {
+                        store(result + i, op(load(operand1 + i), load(operand2 + i)));
+                    }
+                    if (i < count)
+                    {
+                        __m256i mask = _mm256_cmpgt_epi64(
+                            _mm256_set1_epi64x(static_cast<long long>(count - i)), _mm256_setr_epi64x(0, 1, 2, 3));
+                        __m256i a = _mm256_maskload_epi64(reinterpret_cast<const long long *>(operand1 + i), mask);
+                        __m256i b = _mm256_maskload_epi64(reinterpret_cast<const long long *>(operand2 + i), mask);
+                        _mm256_maskstore_epi64(reinterpret_cast<long long *>(result + i), mask, op(a, b));
+                    }
+                }
+
+                // Replaces acc[i] with op(operand1[i], operand2[i], acc[i]), four coefficients at a time
+                template <typename Op>
+                inline void for_each4_acc(
+                    const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t *acc, Op op)
+                {
+                    size_t i = 0;
+                    for (; i + 4 <= count; i += 4)
+                    {
+                        store(acc + i, op(load(operand1 + i), load(operand2 + i), load(acc + i)));
+                    }
+                    if (i < count)
+                    {
+                        __m256i mask = _mm256_cmpgt_epi64(
+                            _mm256_set1_epi64x(static_cast<long long>(count - i)), _mm256_setr_epi64x(0, 1, 2, 3));
+                        __m256i a = _mm256_maskload_epi64(reinterpret_cast<const long long *>(operand1 + i), mask);
+                        __m256i b = _mm256_maskload_epi64(reinterpret_cast<const long long *>(operand2 + i), mask);
+                        __m256i c = _mm256_maskload_epi64(reinterpret_cast<const long long *>(acc + i), mask);
+                        _mm256_maskstore_epi64(reinterpret_cast<long long *>(acc + i), mask, op(a, b, c));
+                    }
+                }
+
+                // Subtracts p from the lanes of x that are at least p; x must be below 2^63
+                inline __m256i reduce_once(__m256i x, __m256i p)
+                {
+                    return _mm256_sub_epi64(x, _mm256_andnot_si256(_mm256_cmpgt_epi64(p, x), p));
+                }
+
+                // Full 128-bit product a * b in lo and hi
+                inline void mul_wide(__m256i a, __m256i b, __m256i &lo, __m256i &hi)
+                {
+                    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+                    __m256i a_hi = _mm256_srli_epi64(a, 32);
+                    __m256i b_hi = _mm256_srli_epi64(b, 32);
+                    __m256i lolo = _mm256_mul_epu32(a, b);
+                    __m256i lohi = _mm256_mul_epu32(a, b_hi);
+                    __m256i hilo = _mm256_mul_epu32(a_hi, b);
+                    __m256i hihi = _mm256_mul_epu32(a_hi, b_hi);
+
+                    // Middle 32-bit column plus carries; at most 3 * 2^32 so it cannot overflow
+                    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(lolo, 32), _mm256_and_si256(lohi, low_mask));
+                    mid = _mm256_add_epi64(mid, _mm256_and_si256(hilo, low_mask));
+                    lo = _mm256_or_si256(_mm256_slli_epi64(mid, 32), _mm256_and_si256(lolo, low_mask));
+                    hi = _mm256_add_epi64(hihi, _mm256_srli_epi64(lohi, 32));
+                    hi = _mm256_add_epi64(hi, _mm256_srli_epi64(hilo, 32));
+                    hi = _mm256_add_epi64(hi, _mm256_srli_epi64(mid, 32));
+                }
+
+                // Low 64 bits of a * b
+                inline __m256i mul_lo(__m256i a, __m256i b)
+                {
+                    __m256i cross = _mm256_add_epi64(
+                        _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)), _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b));
+                    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+                }
+
+                // (hi:lo) >> shift for 0 < shift < 64
+                inline __m256i shift_right_128(__m256i lo, __m256i hi, __m128i shift, __m128i complement)
+                {
+                    return _mm256_or_si256(_mm256_srl_epi64(lo, shift), _mm256_sll_epi64(hi, complement));
+                }
+
+                // a * b mod p, fully reduced, for a and b in [0, 4p)
+                class BarrettProduct
+                {
+                public:
+                    BarrettProduct(uint64_t modulus, int modulus_bit_count, uint64_t barrett_ratio)
+                        : p_(_mm256_set1_epi64x(static_cast<long long>(modulus))),
+                          two_p_(_mm256_set1_epi64x(static_cast<long long>(modulus << 1))),
+                          ratio_(_mm256_set1_epi64x(static_cast<long long>(barrett_ratio))),
+                          shift1_(_mm_cvtsi32_si128(modulus_bit_count - 1)),
+                          shift1_complement_(_mm_cvtsi32_si128(65 - modulus_bit_count)),
+                          shift2_(_mm_cvtsi32_si128(modulus_bit_count + 1)),
+                          shift2_complement_(_mm_cvtsi32_si128(63 - modulus_bit_count))
+                    {}
+
+                    inline __m256i operator()(__m256i a, __m256i b) const
+                    {
+                        // Lazy NTT outputs are in [0, 4p); reducing them first keeps z = a * b below 2^(2k)
+                        a = reduce_once(reduce_once(a, two_p_), p_);
+                        b = reduce_once(reduce_once(b, two_p_), p_);
+
+                        // Barrett reduction of z: q = floor(floor(z / 2^(k-1)) * ratio / 2^(k+1))
+                        // underestimates floor(z / p) by at most 2
+                        __m256i z_lo, z_hi, t_lo, t_hi;
+                        mul_wide(a, b, z_lo, z_hi);
+                        mul_wide(shift_right_128(z_lo, z_hi, shift1_, shift1_complement_), ratio_, t_lo, t_hi);
+                        __m256i q = shift_right_128(t_lo, t_hi, shift2_, shift2_complement_);
+
+                        // z - q * p is below 3p, so it fits in its low 64 bits
+                        __m256i r = _mm256_sub_epi64(z_lo, mul_lo(q, p_));
+                        return reduce_once(reduce_once(r, p_), p_);
+                    }
+
+                private:
+                    __m256i p_;
+                    __m256i two_p_;
+                    __m256i ratio_;
+                    __m128i shift1_;
+                    __m128i shift1_complement_;
+                    __m128i shift2_;
+                    __m128i shift2_complement_;
+                };
+            } // namespace
+
+            void add_poly_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus, uint64_t *result)
+            {
+                const __m256i p = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                for_each4(operand1, operand2, count, result, [p](__m256i a, __m256i b) {
+                    return reduce_once(_mm256_add_epi64(a, b), p);
+                });
+            }
+
+            void add_poly_lazy(const uint64_t *operand, size_t count, uint64_t *acc)
+            {
+                for_each4(acc, operand, count, acc, [](__m256i a, __m256i b) { return _mm256_add_epi64(a, b); });
+            }
+
+            void reduce_lazy_sum(
+                const uint64_t *input, size_t count, uint64_t modulus, size_t operand_count, uint64_t *result)
+            {
+                // Inputs stay below 2^63, so the signed comparisons in reduce_once are valid
+                size_t top = 1;
+                while (top * 2 < operand_count)
+                {
+                    top *= 2;
+                }
+                auto reduce = [&](__m256i x) {
+                    for (size_t multiple = top; multiple; multiple >>= 1)
+                    {
+                        x = reduce_once(x, _mm256_set1_epi64x(static_cast<long long>(multiple * modulus)));
+                    }
+                    return x;
+                };
+
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    store(result + i, reduce(load(input + i)));
+                }
+                if (i < count)
+                {
+                    __m256i mask = _mm256_cmpgt_epi64(
+                        _mm256_set1_epi64x(static_cast<long long>(count - i)), _mm256_setr_epi64x(0, 1, 2, 3));
+                    __m256i x = _mm256_maskload_epi64(reinterpret_cast<const long long *>(input + i), mask);
+                    _mm256_maskstore_epi64(reinterpret_cast<long long *>(result + i), mask, reduce(x));
+                }
+            }
+
+            void sub_poly_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus, uint64_t *result)
+            {
+                const __m256i p = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                for_each4(operand1, operand2, count, result, [p](__m256i a, __m256i b) {
+                    __m256i borrow = _mm256_cmpgt_epi64(b, a);
+                    return _mm256_add_epi64(_mm256_sub_epi64(a, b), _mm256_and_si256(borrow, p));
+                });
+            }
+
+            void dyadic_product_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus,
+                int modulus_bit_count, uint64_t barrett_ratio, uint64_t *result)
+            {
+                BarrettProduct product(modulus, modulus_bit_count, barrett_ratio);
+                for_each4(operand1, operand2, count, result, product);
+            }
+
+            void dyadic_product_accumulate_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus,
+                int modulus_bit_count, uint64_t barrett_ratio, uint64_t *acc)
+            {
+                const __m256i p = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                BarrettProduct product(modulus, modulus_bit_count, barrett_ratio);
+                for_each4_acc(operand1, operand2, count, acc, [&](__m256i a, __m256i b, __m256i c) {
+                    return reduce_once(_mm256_add_epi64(c, product(a, b)), p);
+                });
+            }
+
+            void dyadic_product_lazy(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus,
+                int modulus_bit_count, uint64_t barrett_ratio, uint64_t *acc)
+            {
+                BarrettProduct product(modulus, modulus_bit_count, barrett_ratio);
+                for_each4_acc(operand1, operand2, count, acc, [&](__m256i a, __m256i b, __m256i c) {
+                    return _mm256_add_epi64(c, product(a, b));
+                });
+            }
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_AVX2
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        AVX2 kernels for element-wise polynomial arithmetic. They produce exactly the same output as the portable
+        implementation in polyarithsmallmod.cpp and must only be called when use_avx2() is true; add_poly_coeffmod,
+        add_poly_coeffmod_many, sub_poly_coeffmod and the dyadic_product functions dispatch to them automatically.
+
+        The dyadic product reduces with a single-word Barrett ratio floor(2^(2k) / modulus), where k is the bit count
+        of the modulus, which needs fewer 32x32-bit multiplications than the two-word Modulus::const_ratio(). The
+        result is fully reduced, so it is the same as the portable one. All outputs may alias either input.
+        */
+        namespace avx2
+        {
+            /**
+            Computes result[i] = operand1[i] + operand2[i] mod modulus for inputs reduced modulo modulus.
+            */
+            void add_poly_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            /**
+            Computes acc[i] += operand[i] without reduction, for the lazy sums of add_poly_coeffmod_many.
+            */
+            void add_poly_lazy(const std::uint64_t *operand, std::size_t count, std::uint64_t *acc);
+
+            /**
+            Reduces input[i], a sum of at most operand_count coefficients in [0, modulus) that is below 2^63, modulo
+            modulus into result[i]. result may alias input.
+            */
+            void reduce_lazy_sum(
+                const std::uint64_t *input, std::size_t count, std::uint64_t modulus, std::size_t operand_count,
+                std::uint64_t *result);
+
+            /**
+            Computes result[i] = operand1[i] - operand2[i] mod modulus for inputs reduced modulo modulus.
+            */
+            void sub_poly_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            /**
+            Computes result[i] = operand1[i] * operand2[i] mod modulus for inputs in [0, 4 * modulus), which covers the
+            outputs of the lazy NTT that several Evaluator functions feed in directly.
+
+            @param[in] modulus_bit_count The bit count k of the modulus; between 2 and 61
+            @param[in] barrett_ratio floor(2^(2k) / modulus)
+            */
+            void dyadic_product_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio, std::uint64_t *result);
+
+            /**
+            Computes acc[i] = acc[i] + operand1[i] * operand2[i] mod modulus for acc[i] in [0, modulus) and operands
+            as in dyadic_product_coeffmod.
+            */
+            void dyadic_product_accumulate_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio, std::uint64_t *acc);
+
+            /**
+            Computes acc[i] += operand1[i] * operand2[i] mod modulus, adding the reduced product without reducing the
+            sum, for the lazy sums of dyadic_product_coeffmod_many.
+            */
+            void dyadic_product_lazy(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio, std::uint64_t *acc);
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_AVX512_FLAGS; see the note in nttavx2.cpp.
+
+#include "seal/util/polyarithavx512.h"
+
+#ifdef SEAL_USE_AVX512
+#include <immintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx512
+        {
+            namespace
+            {
+                // Applies op to eight coefficients at a time; the last count % 8 go through masked loads and stores
+                template <typename Op>
+                inline void for_each8(
+                    const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t *result, Op op)
+                {
+                    size_t i = 0;
+                    for (; i + 8 <= count; i += 8)
+                    {
+                        __m512i a = _mm512_loadu_si512(operand1 + i);
+                        __m512i b = _mm512_loadu_si512(operand2 + i);
+                        _mm512_storeu_si512(result + i, op(a, b));
+                    }
+                    if (i < count)
+                    {
+                        __mmask8 mask = static_cast<__mmask8>((1U << (count - i)) - 1);
+                        __m512i a = _mm512_maskz_loadu_epi64(mask, operand1 + i);
+                        __m512i b = _mm512_maskz_loadu_epi64(mask, operand2 + i);
+                        _mm512_mask_storeu_epi64(result + i, mask, op(a, b));
+                    }
+                }
+
+                // Subtracts p from the lanes of x that are at least p: x - p wraps around exactly when x < p
+                inline __m512i reduce_once(__m512i x, __m512i p)
+                {
+                    return _mm512_min_epu64(x, _mm512_sub_epi64(x, p));
+                }
+
+                // Full 128-bit product a * b in lo and hi
+                inline void mul_wide(__m512i a, __m512i b, __m512i &lo, __m512i &hi)
+                {
+                    const __m512i low_mask = _mm512_set1_epi64(0xFFFFFFFF);
+                    __m512i a_hi = _mm512_srli_epi64(a, 32);
+                    __m512i b_hi = _mm512_srli_epi64(b, 32);
+                    __m512i lolo = _mm512_mul_epu32(a, b);
+                    __m512i lohi = _mm512_mul_epu32(a, b_hi);
+                    __m512i hilo = _mm512_mul_epu32(a_hi, b);
+                    __m512i hihi = _mm512_mul_epu32(a_hi, b_hi);
+
+                    // Middle 32-bit column plus carries; at most 3 * 2^32 so it cannot overflow
+                    __m512i mid = _mm512_add_epi64(_mm512_srli_epi64(lolo, 32), _mm512_and_si512(lohi, low_mask));
+                    mid = _mm512_add_epi64(mid, _mm512_and_si512(hilo, low_mask));
+                    lo = _mm512_or_si512(_mm512_slli_epi64(mid, 32), _mm512_and_si512(lolo, low_mask));
+                    hi = _mm512_add_epi64(hihi, _mm512_srli_epi64(lohi, 32));
+                    hi = _mm512_add_epi64(hi, _mm512_srli_epi64(hilo, 32));
+                    hi = _mm512_add_epi64(hi, _mm512_srli_epi64(mid, 32));
+                }
+
+                // Low 64 bits of a * b; _mm512_mullo_epi64 would need AVX-512DQ
+                inline __m512i mul_lo(__m512i a, __m512i b)
+                {
+                    __m512i cross = _mm512_add_epi64(
+                        _mm512_mul_epu32(a, _mm512_srli_epi64(b, 32)), _mm512_mul_epu32(_mm512_srli_epi64(a, 32), b));
+                    return _mm512_add_epi64(_mm512_mul_epu32(a, b), _mm512_slli_epi64(cross, 32));
+                }
+
+                // (hi:lo) >> shift for 0 < shift < 64
+                inline __m512i shift_right_128(__m512i lo, __m512i hi, __m128i shift, __m128i complement)
+                {
+                    return _mm512_or_si512(_mm512_srl_epi64(lo, shift), _mm512_sll_epi64(hi, complement));
+                }
+            } // namespace
+
+            void add_poly_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus, uint64_t *result)
+            {
+                const __m512i p = _mm512_set1_epi64(static_cast<long long>(modulus));
+                for_each8(operand1, operand2, count, result, [p](__m512i a, __m512i b) {
+                    return reduce_once(_mm512_add_epi64(a, b), p);
+                });
+            }
+
+            void add_poly_lazy(const uint64_t *operand, size_t count, uint64_t *acc)
+            {
+                for_each8(acc, operand, count, acc, [](__m512i a, __m512i b) { return _mm512_add_epi64(a, b); });
+            }
+
+            void reduce_lazy_sum(
+                const uint64_t *input, size_t count, uint64_t modulus, size_t operand_count, uint64_t *result)
+            {
+                size_t top = 1;
+                while (top * 2 < operand_count)
+                {
+                    top *= 2;
+                }
+                auto reduce = [&](__m512i x) {
+                    for (size_t multiple = top; multiple; multiple >>= 1)
+                    {
+                        x = reduce_once(x, _mm512_set1_epi64(static_cast<long long>(multiple * modulus)));
+                    }
+                    return x;
+                };
+
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    _mm512_storeu_si512(result + i, reduce(_mm512_loadu_si512(input + i)));
+                }
+                if (i < count)
+                {
+                    __mmask8 mask = static_cast<__mmask8>((1U << (count - i)) - 1);
+                    _mm512_mask_storeu_epi64(result + i, mask, reduce(_mm512_maskz_loadu_epi64(mask, input + i)));
+                }
+            }
+
+            void sub_poly_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus, uint64_t *result)
+            {
+                const __m512i p = _mm512_set1_epi64(static_cast<long long>(modulus));
+                for_each8(operand1, operand2, count, result, [p](__m512i a, __m512i b) {
+                    // a - b wraps around exactly when a < b, and then a - b + p is the smaller value
+                    __m512i diff = _mm512_sub_epi64(a, b);
+                    return _mm512_min_epu64(diff, _mm512_add_epi64(diff, p));
+                });
+            }
+
+            void dyadic_product_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus,
+                int modulus_bit_count, uint64_t barrett_ratio, uint64_t *result)
+            {
+                const __m512i p = _mm512_set1_epi64(static_cast<long long>(modulus));
+                const __m512i two_p = _mm512_set1_epi64(static_cast<long long>(modulus << 1));
+                const __m512i ratio = _mm512_set1_epi64(static_cast<long long>(barrett_ratio));
+                const __m128i shift1 = _mm_cvtsi32_si128(modulus_bit_count - 1);
+                const __m128i shift1_complement = _mm_cvtsi32_si128(65 - modulus_bit_count);
+                const __m128i shift2 = _mm_cvtsi32_si128(modulus_bit_count + 1);
+                const __m128i shift2_complement = _mm_cvtsi32_si128(63 - modulus_bit_count);
+                for_each8(operand1, operand2, count, result, [&](__m512i a, __m512i b) {
+                    // Input and Barrett reduction as in the AVX2 kernel
+                    a = reduce_once(reduce_once(a, two_p), p);
+                    b = reduce_once(reduce_once(b, two_p), p);
+                    __m512i z_lo, z_hi, t_lo, t_hi;
+                    mul_wide(a, b, z_lo, z_hi);
+                    mul_wide(shift_right_128(z_lo, z_hi, shift1, shift1_complement), ratio, t_lo, t_hi);
+                    __m512i q = shift_right_128(t_lo, t_hi, shift2, shift2_complement);
+                    __m512i r = _mm512_sub_epi64(z_lo, mul_lo(q, p));
+                    return reduce_once(reduce_once(r, p), p);
+                });
+            }
+        } // namespace avx512
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_AVX512
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        AVX-512F kernels for element-wise polynomial arithmetic, with the same contract as the AVX2 kernels in
+        polyarithavx2.h. They must only be called when use_avx512() is true; the dispatch prefers them over AVX2.
+
+        Eight coefficients are processed per instruction, and the unsigned 64-bit min and compare instructions of
+        AVX-512F make the conditional subtractions cheaper than with AVX2. Only AVX-512F is required.
+        */
+        namespace avx512
+        {
+            /**
+            Computes result[i] = operand1[i] + operand2[i] mod modulus for inputs reduced modulo modulus.
+            */
+            void add_poly_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            /**
+            Computes acc[i] += operand[i] without reduction, for the lazy sums of add_poly_coeffmod_many.
+            */
+            void add_poly_lazy(const std::uint64_t *operand, std::size_t count, std::uint64_t *acc);
+
+            /**
+            Reduces input[i], a sum of at most operand_count coefficients in [0, modulus) that is below 2^63, modulo
+            modulus into result[i]. result may alias input.
+            */
+            void reduce_lazy_sum(
+                const std::uint64_t *input, std::size_t count, std::uint64_t modulus, std::size_t operand_count,
+                std::uint64_t *result);
+
+            /**
+            Computes result[i] = operand1[i] - operand2[i] mod modulus for inputs reduced modulo modulus.
+            */
+            void sub_poly_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            /**
+            Computes result[i] = operand1[i] * operand2[i] mod modulus for inputs in [0, 4 * modulus), which covers the
+            outputs of the lazy NTT that several Evaluator functions feed in directly.
+
+            @param[in] modulus_bit_count The bit count k of the modulus; between 2 and 61
+            @param[in] barrett_ratio floor(2^(2k) / modulus)
+            */
+            void dyadic_product_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio, std::uint64_t *result);
+        } // namespace avx512
+    } // namespace util
+} // namespace seal
+#endif
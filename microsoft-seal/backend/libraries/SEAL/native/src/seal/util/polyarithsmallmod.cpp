@@ -1,13 +1,21 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include "seal/util/cpufeatures.h"
+#include "seal/util/polyarithavx2.h"
+#include "seal/util/polyarithavx512.h"
 #include "seal/util/polyarithsmallmod.h"
+#include "seal/util/polyarithsve.h"
 #include "seal/util/uintarith.h"
 #include "seal/util/uintcore.h"
+#include <limits>
 
 #ifdef SEAL_USE_INTEL_HEXL
 #include "hexl/hexl.hpp"
 #endif
+#ifdef SEAL_USE_NEON
+#include <arm_neon.h>
+#endif
 
 using namespace std;
 
@@ -15,6 +23,56 @@ namespace seal
 {
     namespace util
     {
+#if defined(SEAL_USE_NEON) && !defined(SEAL_DEBUG)
+        namespace
+        {
+            // NEON has 64-bit lane add, subtract and compare but no 64-bit multiply, so only the additive kernels are
+            // vectorized. Both process the leading even number of coefficients and return how many they processed.
+            size_t add_poly_coeffmod_neon(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus, uint64_t *result)
+            {
+                const uint64x2_t p = vdupq_n_u64(modulus);
+                size_t i = 0;
+                for (; i + 2 <= count; i += 2)
+                {
+                    uint64x2_t sum = vaddq_u64(vld1q_u64(operand1 + i), vld1q_u64(operand2 + i));
+                    vst1q_u64(result + i, vsubq_u64(sum, vandq_u64(vcgeq_u64(sum, p), p)));
+                }
+                return i;
+            }
+
+            size_t sub_poly_coeffmod_neon(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus, uint64_t *result)
+            {
+                const uint64x2_t p = vdupq_n_u64(modulus);
+                size_t i = 0;
+                for (; i + 2 <= count; i += 2)
+                {
+                    uint64x2_t a = vld1q_u64(operand1 + i);
+                    uint64x2_t b = vld1q_u64(operand2 + i);
+                    uint64x2_t diff = vsubq_u64(a, b);
+                    vst1q_u64(result + i, vaddq_u64(diff, vandq_u64(vcltq_u64(a, b), p)));
+                }
+                return i;
+            }
+        } // namespace
+#endif
+#if defined(SEAL_USE_AVX2) || defined(SEAL_USE_AVX512)
+        namespace
+        {
+            // floor(2^(2k) / modulus) for the k-bit modulus, as expected by the AVX2 and AVX-512 dyadic products
+            uint64_t single_word_barrett_ratio(const Modulus &modulus)
+            {
+                int shift = 2 * modulus.bit_count();
+                uint64_t numerator[2]{ 0, 0 };
+                numerator[shift / 64] = uint64_t(1) << (shift % 64);
+                uint64_t quotient[2]{ 0, 0 };
+                divide_uint128_inplace(numerator, modulus.value(), quotient);
+                return quotient[0];
+            }
+        } // namespace
+#endif
+
         void modulo_poly_coeffs(ConstCoeffIter poly, std::size_t coeff_count, const Modulus &modulus, CoeffIter result)
         {
 #ifdef SEAL_DEBUG
@@ -67,6 +125,29 @@ namespace seal
 #ifdef SEAL_USE_INTEL_HEXL
             intel::hexl::EltwiseAddMod(&result[0], &operand1[0], &operand2[0], coeff_count, modulus_value);
 #else
+#ifndef SEAL_DEBUG
+#ifdef SEAL_USE_AVX512
+            if (use_avx512())
+            {
+                avx512::add_poly_coeffmod(operand1, operand2, coeff_count, modulus_value, result);
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (use_avx2())
+            {
+                avx2::add_poly_coeffmod(operand1, operand2, coeff_count, modulus_value, result);
+                return;
+            }
+#endif
+#endif
+#if defined(SEAL_USE_NEON) && !defined(SEAL_DEBUG)
+            size_t neon_count = add_poly_coeffmod_neon(operand1, operand2, coeff_count, modulus_value, result);
+            operand1 += neon_count;
+            operand2 += neon_count;
+            result += neon_count;
+            coeff_count -= neon_count;
+#endif
 
             SEAL_ITERATE(iter(operand1, operand2, result), coeff_count, [&](auto I) {
 #ifdef SEAL_DEBUG
@@ -85,6 +166,130 @@ namespace seal
 #endif
         }
 
+        namespace
+        {
+            // Adds operand to acc without reduction
+            inline void add_poly_lazy(const uint64_t *operand, size_t count, uint64_t *acc)
+            {
+#ifndef SEAL_DEBUG
+#ifdef SEAL_USE_AVX512
+                if (use_avx512())
+                {
+                    avx512::add_poly_lazy(operand, count, acc);
+                    return;
+                }
+#endif
+#ifdef SEAL_USE_AVX2
+                if (use_avx2())
+                {
+                    avx2::add_poly_lazy(operand, count, acc);
+                    return;
+                }
+#endif
+#endif
+                for (size_t j = 0; j < count; j++)
+                {
+                    acc[j] += operand[j];
+                }
+            }
+
+            // Reduces sums of operand_count coefficients in [0, modulus) by subtracting modulus times each power of
+            // two below operand_count where it fits; the sums must be below 2^63
+            inline void reduce_lazy_sum(
+                const uint64_t *input, size_t count, uint64_t modulus, size_t operand_count, uint64_t *result)
+            {
+#ifndef SEAL_DEBUG
+#ifdef SEAL_USE_AVX512
+                if (use_avx512())
+                {
+                    avx512::reduce_lazy_sum(input, count, modulus, operand_count, result);
+                    return;
+                }
+#endif
+#ifdef SEAL_USE_AVX2
+                if (use_avx2())
+                {
+                    avx2::reduce_lazy_sum(input, count, modulus, operand_count, result);
+                    return;
+                }
+#endif
+#endif
+                size_t top = 1;
+                while (top * 2 < operand_count)
+                {
+                    top *= 2;
+                }
+                for (size_t j = 0; j < count; j++)
+                {
+                    uint64_t x = input[j];
+                    for (size_t multiple = top; multiple; multiple >>= 1)
+                    {
+                        const uint64_t subtrahend = multiple * modulus;
+                        x = SEAL_COND_SELECT(x >= subtrahend, x - subtrahend, x);
+                    }
+                    result[j] = x;
+                }
+            }
+        } // namespace
+
+        void add_poly_coeffmod_many(
+            const uint64_t *const *operands, size_t count, size_t coeff_count, const Modulus &modulus,
+            CoeffIter result)
+        {
+#ifdef SEAL_DEBUG
+            if (!operands || !count)
+            {
+                throw std::invalid_argument("operands");
+            }
+            if (modulus.is_zero())
+            {
+                throw std::invalid_argument("modulus");
+            }
+            if (!result && coeff_count > 0)
+            {
+                throw std::invalid_argument("result");
+            }
+            for (size_t k = 0; k < count; k++)
+            {
+                for (size_t j = 0; j < coeff_count; j++)
+                {
+                    if (operands[k][j] >= modulus.value())
+                    {
+                        throw std::invalid_argument("operands");
+                    }
+                }
+            }
+#endif
+            // A sum of k reduced coefficients is at most k * (modulus - 1); up to lazy_count of them stay below 2^63,
+            // which keeps the signed AVX2 comparisons valid. That is at least 4 operands per reduction even for
+            // 61-bit moduli, and thousands for typical 40- to 50-bit primes.
+            const uint64_t modulus_value = modulus.value();
+            const size_t lazy_count = static_cast<size_t>(((uint64_t(1) << 63) - 1) / (modulus_value - 1));
+
+            // Accumulate a block of coefficients at a time so the partial sums stay in L1 while all operands stream
+            // through it
+            constexpr size_t block_size = 1024;
+            uint64_t acc[block_size];
+            for (size_t begin = 0; begin < coeff_count; begin += block_size)
+            {
+                const size_t len = min(block_size, coeff_count - begin);
+                copy_n(operands[0] + begin, len, acc);
+
+                size_t pending = 1;
+                for (size_t k = 1; k < count; k++)
+                {
+                    if (pending == lazy_count)
+                    {
+                        reduce_lazy_sum(acc, len, modulus_value, pending, acc);
+                        pending = 1;
+                    }
+                    add_poly_lazy(operands[k] + begin, len, acc);
+                    pending++;
+                }
+                reduce_lazy_sum(acc, len, modulus_value, pending, result.ptr() + begin);
+            }
+        }
+
         void sub_poly_coeffmod(
             ConstCoeffIter operand1, ConstCoeffIter operand2, std::size_t coeff_count, const Modulus &modulus,
             CoeffIter result)
@@ -112,6 +317,29 @@ namespace seal
 #ifdef SEAL_USE_INTEL_HEXL
             intel::hexl::EltwiseSubMod(result, operand1, operand2, coeff_count, modulus_value);
 #else
+#ifndef SEAL_DEBUG
+#ifdef SEAL_USE_AVX512
+            if (use_avx512())
+            {
+                avx512::sub_poly_coeffmod(operand1, operand2, coeff_count, modulus_value, result);
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (use_avx2())
+            {
+                avx2::sub_poly_coeffmod(operand1, operand2, coeff_count, modulus_value, result);
+                return;
+            }
+#endif
+#endif
+#if defined(SEAL_USE_NEON) && !defined(SEAL_DEBUG)
+            size_t neon_count = sub_poly_coeffmod_neon(operand1, operand2, coeff_count, modulus_value, result);
+            operand1 += neon_count;
+            operand2 += neon_count;
+            result += neon_count;
+            coeff_count -= neon_count;
+#endif
             SEAL_ITERATE(iter(operand1, operand2, result), coeff_count, [&](auto I) {
 #ifdef SEAL_DEBUG
                 if (get<0>(I) >= modulus_value)
@@ -255,6 +483,32 @@ namespace seal
             const uint64_t modulus_value = modulus.value();
             const uint64_t const_ratio_0 = modulus.const_ratio()[0];
             const uint64_t const_ratio_1 = modulus.const_ratio()[1];
+#ifdef SEAL_USE_AVX512
+            if (use_avx512())
+            {
+                avx512::dyadic_product_coeffmod(
+                    operand1, operand2, coeff_count, modulus_value, modulus.bit_count(),
+                    single_word_barrett_ratio(modulus), result);
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (use_avx2())
+            {
+                avx2::dyadic_product_coeffmod(
+                    operand1, operand2, coeff_count, modulus_value, modulus.bit_count(),
+                    single_word_barrett_ratio(modulus), result);
+                return;
+            }
+#endif
+#ifdef SEAL_USE_SVE
+            if (use_sve())
+            {
+                sve::dyadic_product_coeffmod(
+                    operand1, operand2, coeff_count, modulus_value, const_ratio_0, const_ratio_1, result);
+                return;
+            }
+#endif
 
             SEAL_ITERATE(iter(operand1, operand2, result), coeff_count, [&](auto I) {
                 // Reduces z using base 2^64 Barrett reduction
@@ -283,6 +537,120 @@ namespace seal
 #endif
         }
 
+        namespace
+        {
+            // Block of coefficients whose products and partial sums stay in L1
+            constexpr size_t dyadic_block_size = 1024;
+
+            // Computes acc[i] += operand1[i] * operand2[i] mod modulus without reducing the sum
+            inline void dyadic_product_lazy(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, const Modulus &modulus,
+                uint64_t *acc)
+            {
+#if !defined(SEAL_DEBUG) && !defined(SEAL_USE_INTEL_HEXL) && defined(SEAL_USE_AVX2)
+                if (use_avx2() && !use_avx512())
+                {
+                    avx2::dyadic_product_lazy(
+                        operand1, operand2, count, modulus.value(), modulus.bit_count(),
+                        single_word_barrett_ratio(modulus), acc);
+                    return;
+                }
+#endif
+                uint64_t product[dyadic_block_size];
+                for (size_t begin = 0; begin < count; begin += dyadic_block_size)
+                {
+                    const size_t len = min(dyadic_block_size, count - begin);
+                    dyadic_product_coeffmod(operand1 + begin, operand2 + begin, len, modulus, product);
+                    add_poly_lazy(product, len, acc + begin);
+                }
+            }
+        } // namespace
+
+        void dyadic_product_accumulate_coeffmod(
+            ConstCoeffIter operand1, ConstCoeffIter operand2, size_t coeff_count, const Modulus &modulus,
+            CoeffIter result)
+        {
+#ifdef SEAL_DEBUG
+            if (!operand1 && coeff_count > 0)
+            {
+                throw invalid_argument("operand1");
+            }
+            if (!operand2 && coeff_count > 0)
+            {
+                throw invalid_argument("operand2");
+            }
+            if (!result && coeff_count > 0)
+            {
+                throw invalid_argument("result");
+            }
+            if (modulus.is_zero())
+            {
+                throw invalid_argument("modulus");
+            }
+#endif
+#if !defined(SEAL_USE_INTEL_HEXL) && defined(SEAL_USE_AVX2)
+            // AVX-512 hosts keep the wider product and addition kernels below
+            if (use_avx2() && !use_avx512())
+            {
+                avx2::dyadic_product_accumulate_coeffmod(
+                    operand1, operand2, coeff_count, modulus.value(), modulus.bit_count(),
+                    single_word_barrett_ratio(modulus), result);
+                return;
+            }
+#endif
+            // Otherwise each block of products is formed in L1 and added from there
+            uint64_t product[dyadic_block_size];
+            for (size_t begin = 0; begin < coeff_count; begin += dyadic_block_size)
+            {
+                const size_t len = min(dyadic_block_size, coeff_count - begin);
+                dyadic_product_coeffmod(operand1 + begin, operand2 + begin, len, modulus, product);
+                add_poly_coeffmod(product, result + begin, len, modulus, result + begin);
+            }
+        }
+
+        void dyadic_product_coeffmod_many(
+            const uint64_t *const *operands1, const uint64_t *const *operands2, size_t count, size_t coeff_count,
+            const Modulus &modulus, CoeffIter result)
+        {
+#ifdef SEAL_DEBUG
+            if (!operands1 || !operands2 || !count)
+            {
+                throw invalid_argument("operands");
+            }
+            if (modulus.is_zero())
+            {
+                throw invalid_argument("modulus");
+            }
+            if (!result && coeff_count > 0)
+            {
+                throw invalid_argument("result");
+            }
+#endif
+            // Reduced products take the headroom of reduced summands in add_poly_coeffmod_many
+            const uint64_t modulus_value = modulus.value();
+            const size_t lazy_count = static_cast<size_t>(((uint64_t(1) << 63) - 1) / (modulus_value - 1));
+
+            uint64_t acc[dyadic_block_size];
+            for (size_t begin = 0; begin < coeff_count; begin += dyadic_block_size)
+            {
+                const size_t len = min(dyadic_block_size, coeff_count - begin);
+                dyadic_product_coeffmod(operands1[0] + begin, operands2[0] + begin, len, modulus, acc);
+
+                size_t pending = 1;
+                for (size_t k = 1; k < count; k++)
+                {
+                    if (pending == lazy_count)
+                    {
+                        reduce_lazy_sum(acc, len, modulus_value, pending, acc);
+                        pending = 1;
+                    }
+                    dyadic_product_lazy(operands1[k] + begin, operands2[k] + begin, len, modulus, acc);
+                    pending++;
+                }
+                reduce_lazy_sum(acc, len, modulus_value, pending, result.ptr() + begin);
+            }
+        }
+
         uint64_t poly_infty_norm_coeffmod(ConstCoeffIter operand, size_t coeff_count, const Modulus &modulus)
         {
 #ifdef SEAL_DEBUG
@@ -7,6 +7,7 @@
 #include "seal/util/common.h"
 #include "seal/util/defines.h"
 #include "seal/util/iterator.h"
+#include "seal/util/parallel.h"
 #include "seal/util/pointer.h"
 #include "seal/util/polycore.h"
 #include "seal/util/uintarithsmallmod.h"
@@ -163,6 +164,16 @@ namespace seal
             ConstCoeffIter operand1, ConstCoeffIter operand2, std::size_t coeff_count, const Modulus &modulus,
             CoeffIter result);
 
+        /**
+        Adds count polynomials with coefficients in [0, modulus) and stores the reduced sum in result, which may
+        alias operands[0]. The sum is accumulated in 64 bits and only reduced when the headroom above modulus is
+        used up, so each operand costs one addition per coefficient instead of an addition and a conditional
+        subtraction, and the result is written once instead of once per operand.
+        */
+        void add_poly_coeffmod_many(
+            const std::uint64_t *const *operands, std::size_t count, std::size_t coeff_count, const Modulus &modulus,
+            CoeffIter result);
+
         inline void add_poly_coeffmod(
             ConstRNSIter operand1, ConstRNSIter operand2, std::size_t coeff_modulus_size, ConstModulusIter modulus,
             RNSIter result)
@@ -506,6 +517,26 @@ namespace seal
             ConstCoeffIter operand1, ConstCoeffIter operand2, std::size_t coeff_count, const Modulus &modulus,
             CoeffIter result);
 
+        /**
+        Computes result[i] = result[i] + operand1[i] * operand2[i] mod modulus for result[i] in [0, modulus) and
+        operands in [0, modulus). The product is added as it is formed, so result is read and written once instead
+        of a temporary product being written and read back.
+        */
+        void dyadic_product_accumulate_coeffmod(
+            ConstCoeffIter operand1, ConstCoeffIter operand2, std::size_t coeff_count, const Modulus &modulus,
+            CoeffIter result);
+
+        /**
+        Computes the sum of the dyadic products operands1[k] * operands2[k] for k < count, with coefficients in
+        [0, modulus), and stores it reduced in result, which may alias any of the operands. As in
+        add_poly_coeffmod_many, the reduced products are summed in 64 bits over a block of coefficients held in L1
+        and the sum is only reduced when its headroom is used up, so every operand is read once and the result is
+        written once.
+        */
+        void dyadic_product_coeffmod_many(
+            const std::uint64_t *const *operands1, const std::uint64_t *const *operands2, std::size_t count,
+            std::size_t coeff_count, const Modulus &modulus, CoeffIter result);
+
         inline void dyadic_product_coeffmod(
             ConstRNSIter operand1, ConstRNSIter operand2, std::size_t coeff_modulus_size, ConstModulusIter modulus,
             RNSIter result)
@@ -534,9 +565,10 @@ namespace seal
             }
 #endif
             auto poly_modulus_degree = result.poly_modulus_degree();
-            SEAL_ITERATE(iter(operand1, operand2, modulus, result), coeff_modulus_size, [&](auto I) {
-                dyadic_product_coeffmod(get<0>(I), get<1>(I), poly_modulus_degree, get<2>(I), get<3>(I));
-            });
+            parallel_iterate(
+                iter(operand1, operand2, modulus, result), coeff_modulus_size, poly_modulus_degree, [&](auto I) {
+                    dyadic_product_coeffmod(get<0>(I), get<1>(I), poly_modulus_degree, get<2>(I), get<3>(I));
+                });
         }
 
         inline void dyadic_product_coeffmod(
@@ -566,6 +598,15 @@ namespace seal
             }
 #endif
             auto coeff_modulus_size = result.coeff_modulus_size();
+            auto poly_modulus_degree = result.poly_modulus_degree();
+            if (try_parallel_for_each_rns(
+                    size, coeff_modulus_size, poly_modulus_degree, [&](std::size_t i, std::size_t j) {
+                        dyadic_product_coeffmod(
+                            operand1[i][j], operand2[i][j], poly_modulus_degree, modulus[j], result[i][j]);
+                    }))
+            {
+                return;
+            }
             SEAL_ITERATE(iter(operand1, operand2, result), size, [&](auto I) {
                 dyadic_product_coeffmod(get<0>(I), get<1>(I), coeff_modulus_size, modulus, get<2>(I));
             });
@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_SVE_FLAGS; see the note in nttsve.cpp.
+
+#include "seal/util/polyarithsve.h"
+
+#ifdef SEAL_USE_SVE
+#include <arm_sve.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace sve
+        {
+            namespace
+            {
+                // Adds one to the lanes of a where sum < addend, i.e., where the addition that produced sum wrapped
+                inline svuint64_t add_carry(svbool_t pg, svuint64_t a, svuint64_t sum, svuint64_t addend)
+                {
+                    return svadd_n_u64_m(svcmplt_u64(pg, sum, addend), a, 1);
+                }
+            } // namespace
+
+            void dyadic_product_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t count, uint64_t modulus,
+                uint64_t const_ratio_0, uint64_t const_ratio_1, uint64_t *result)
+            {
+                const size_t lanes = svcntd();
+                for (size_t i = 0; i < count; i += lanes)
+                {
+                    svbool_t pg = svwhilelt_b64_u64(i, count);
+                    svuint64_t a = svld1_u64(pg, operand1 + i);
+                    svuint64_t b = svld1_u64(pg, operand2 + i);
+                    svuint64_t z0 = svmul_u64_x(pg, a, b);
+                    svuint64_t z1 = svmulh_u64_x(pg, a, b);
+
+                    // Round 1, as in the scalar code
+                    svuint64_t carry = svmulh_n_u64_x(pg, z0, const_ratio_0);
+                    svuint64_t lo = svmul_n_u64_x(pg, z0, const_ratio_1);
+                    svuint64_t tmp1 = svadd_u64_x(pg, lo, carry);
+                    svuint64_t tmp3 = add_carry(pg, svmulh_n_u64_x(pg, z0, const_ratio_1), tmp1, carry);
+
+                    // Round 2
+                    lo = svmul_n_u64_x(pg, z1, const_ratio_0);
+                    tmp1 = svadd_u64_x(pg, tmp1, lo);
+                    carry = add_carry(pg, svmulh_n_u64_x(pg, z1, const_ratio_0), tmp1, lo);
+
+                    // tmp1 = z1 * const_ratio_1 + tmp3 + carry
+                    tmp1 = svmla_n_u64_x(pg, svadd_u64_x(pg, tmp3, carry), z1, const_ratio_1);
+
+                    // Barrett subtraction; one more conditional subtraction is enough
+                    svuint64_t r = svmls_n_u64_x(pg, z0, tmp1, modulus);
+                    r = svsub_n_u64_m(svcmpge_n_u64(pg, r, modulus), r, modulus);
+                    svst1_u64(pg, result + i, r);
+                }
+            }
+        } // namespace sve
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_SVE
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        SVE kernels for element-wise polynomial arithmetic. They produce exactly the same output as the portable
+        implementation in polyarithsmallmod.cpp and must only be called when use_sve() is true.
+        */
+        namespace sve
+        {
+            /**
+            Computes result[i] = operand1[i] * operand2[i] mod modulus using base 2^64 Barrett reduction.
+
+            @param[in] operand1 The first operand, reduced modulo modulus
+            @param[in] operand2 The second operand, reduced modulo modulus
+            @param[in] count The number of coefficients
+            @param[in] modulus The modulus
+            @param[in] const_ratio_0 Modulus::const_ratio()[0]
+            @param[in] const_ratio_1 Modulus::const_ratio()[1]
+            @param[out] result The product; may alias either operand
+            */
+            void dyadic_product_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t count,
+                std::uint64_t modulus, std::uint64_t const_ratio_0, std::uint64_t const_ratio_1,
+                std::uint64_t *result);
+        } // namespace sve
+    } // namespace util
+} // namespace seal
+#endif
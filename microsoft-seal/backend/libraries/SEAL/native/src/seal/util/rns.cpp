@@ -2,9 +2,13 @@
 // Licensed under the MIT license.
 
 #include "seal/util/common.h"
+#include "seal/util/cpufeatures.h"
 #include "seal/util/numth.h"
+#include "seal/util/opcounters.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/rns.h"
+#include "seal/util/rnsavx2.h"
+#include "seal/util/rnsavx512.h"
 #include "seal/util/uintarithmod.h"
 #include "seal/util/uintarithsmallmod.h"
 #include <algorithm>
@@ -417,6 +421,7 @@ namespace seal
 
         void BaseConverter::fast_convert_array(ConstRNSIter in, RNSIter out, MemoryPoolHandle pool) const
         {
+            SEAL_COUNT_OPERATION(base_conversion_count, 1);
 #ifdef SEAL_DEBUG
             if (in.poly_modulus_degree() != out.poly_modulus_degree())
             {
@@ -427,6 +432,39 @@ namespace seal
             size_t obase_size = obase_.size();
             size_t count = in.poly_modulus_degree();
 
+#if !defined(SEAL_DEBUG) && (defined(SEAL_USE_AVX2) || defined(SEAL_USE_AVX512))
+            // The kernels take the moduli as plain values and compute the product block by block
+            auto convert_blocked = [&](size_t block, auto kernel) {
+                auto moduli(allocate_uint(ibase_size + obase_size, pool));
+                for (size_t i = 0; i < ibase_size; i++)
+                {
+                    moduli[i] = ibase_[i].value();
+                }
+                for (size_t j = 0; j < obase_size; j++)
+                {
+                    moduli[ibase_size + j] = obase_[j].value();
+                }
+                auto block_temp(allocate_uint(mul_safe(ibase_size, block), pool));
+                kernel(
+                    static_cast<const uint64_t *>(in), moduli.get(), ibase_.inv_punctured_prod_mod_base_array(),
+                    ibase_size, moduli.get() + ibase_size, base_change_matrix_operands_.get(), obase_size, count,
+                    static_cast<uint64_t *>(out), block_temp.get());
+            };
+#ifdef SEAL_USE_AVX512
+            if (use_avx512() && !(count & 7))
+            {
+                convert_blocked(avx512::fast_convert_block_size, avx512::fast_convert_array);
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (use_avx2() && !(count & 3))
+            {
+                convert_blocked(avx2::fast_convert_block_size, avx2::fast_convert_array);
+                return;
+            }
+#endif
+#endif
             // Note that the stride size is ibase_size
             SEAL_ALLOCATE_GET_STRIDE_ITER(temp, uint64_t, count, ibase_size, pool);
 
@@ -465,6 +503,7 @@ namespace seal
         // See "An Improved RNS Variant of the BFV Homomorphic Encryption Scheme" (CT-RSA 2019) for details
         void BaseConverter::exact_convert_array(ConstRNSIter in, CoeffIter out, MemoryPoolHandle pool) const
         {
+            SEAL_COUNT_OPERATION(base_conversion_count, 1);
             size_t ibase_size = ibase_.size();
             size_t obase_size = obase_.size();
             size_t count = in.poly_modulus_degree();
@@ -559,6 +598,16 @@ namespace seal
                     get<0>(J) = modulo_uint(get<1>(J), ibase_.size(), get<1>(I));
                 });
             });
+
+            base_change_matrix_operands_ =
+                allocate<MultiplyUIntModOperand>(mul_safe(obase_.size(), ibase_.size()), pool_);
+            for (size_t j = 0; j < obase_.size(); j++)
+            {
+                for (size_t i = 0; i < ibase_.size(); i++)
+                {
+                    base_change_matrix_operands_[j * ibase_.size() + i].set(base_change_matrix_[j][i], obase_[j]);
+                }
+            }
         }
 
         RNSTool::RNSTool(
@@ -811,6 +860,33 @@ namespace seal
             add_poly_scalar_coeffmod(last_input, coeff_count_, half, last_modulus, last_input);
 
             SEAL_ALLOCATE_GET_COEFF_ITER(temp, coeff_count_, pool);
+#if !defined(SEAL_DEBUG) && (defined(SEAL_USE_AVX2) || defined(SEAL_USE_AVX512))
+            // Two passes per modulus: temp = (ct mod qk) mod qi - half + qi, in [0, 2qi), and then
+            // qk^(-1) * ((ct mod qi) + 2qi - temp) mod qi
+            auto divide_vectorized = [&](auto modulo_poly_add_scalar, auto sub_multiply_scalar) {
+                SEAL_ITERATE(iter(input, inv_q_last_mod_q_, base_q_->base()), base_q_size - 1, [&](auto I) {
+                    const uint64_t qi = get<2>(I).value();
+                    uint64_t half_mod = barrett_reduce_64(half, get<2>(I));
+                    modulo_poly_add_scalar(
+                        last_input, coeff_count_, qi, get<2>(I).const_ratio()[1], qi - half_mod, temp);
+                    sub_multiply_scalar(get<0>(I), temp, coeff_count_, qi << 1, get<1>(I), qi, get<0>(I));
+                });
+            };
+#ifdef SEAL_USE_AVX512
+            if (use_avx512() && !(coeff_count_ & 7))
+            {
+                divide_vectorized(avx512::modulo_poly_add_scalar, avx512::sub_multiply_scalar);
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (use_avx2() && !(coeff_count_ & 3))
+            {
+                divide_vectorized(avx2::modulo_poly_add_scalar, avx2::sub_multiply_scalar);
+                return;
+            }
+#endif
+#endif
             SEAL_ITERATE(iter(input, inv_q_last_mod_q_, base_q_->base()), base_q_size - 1, [&](auto I) {
                 // (ct mod qk) mod qi
                 modulo_poly_coeffs(last_input, coeff_count_, get<2>(I), temp);
@@ -860,6 +936,45 @@ namespace seal
             add_poly_scalar_coeffmod(last_input, coeff_count_, half, last_modulus, last_input);
 
             SEAL_ALLOCATE_GET_COEFF_ITER(temp, coeff_count_, pool);
+#if !defined(SEAL_DEBUG) && (defined(SEAL_USE_AVX2) || defined(SEAL_USE_AVX512))
+            // As below, with the reduction and lazy subtraction before the NTT fused into one pass and the one after
+            // it fused with the multiplication. Reducing mod qi leaves values below qi unchanged, so the kernel also
+            // covers qi > qk.
+            auto divide_vectorized = [&](auto modulo_poly_add_scalar, auto sub_multiply_scalar) {
+                SEAL_ITERATE(
+                    iter(input, inv_q_last_mod_q_, base_q_->base(), rns_ntt_tables), base_q_size - 1, [&](auto I) {
+                        const uint64_t qi = get<2>(I).value();
+                        uint64_t neg_half_mod = qi - barrett_reduce_64(half, get<2>(I));
+                        modulo_poly_add_scalar(
+                            last_input, coeff_count_, qi, get<2>(I).const_ratio()[1], neg_half_mod, temp);
+#if SEAL_USER_MOD_BIT_COUNT_MAX <= 60
+                        uint64_t qi_lazy = qi << 2;
+                        ntt_negacyclic_harvey_lazy(temp, get<3>(I));
+#else
+                        uint64_t qi_lazy = qi << 1;
+                        ntt_negacyclic_harvey_lazy(temp, get<3>(I));
+                        SEAL_ITERATE(temp, coeff_count_, [&](auto &J) {
+                            J -= (qi_lazy & static_cast<uint64_t>(-static_cast<int64_t>(J >= qi_lazy)));
+                        });
+#endif
+                        sub_multiply_scalar(get<0>(I), temp, coeff_count_, qi_lazy, get<1>(I), qi, get<0>(I));
+                    });
+            };
+#ifdef SEAL_USE_AVX512
+            if (use_avx512() && !(coeff_count_ & 7))
+            {
+                divide_vectorized(avx512::modulo_poly_add_scalar, avx512::sub_multiply_scalar);
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (use_avx2() && !(coeff_count_ & 3))
+            {
+                divide_vectorized(avx2::modulo_poly_add_scalar, avx2::sub_multiply_scalar);
+                return;
+            }
+#endif
+#endif
             SEAL_ITERATE(iter(input, inv_q_last_mod_q_, base_q_->base(), rns_ntt_tables), base_q_size - 1, [&](auto I) {
                 // (ct mod qk) mod qi
                 if (get<2>(I).value() < last_modulus.value())
@@ -1153,6 +1268,39 @@ namespace seal
             size_t base_q_size = base_q_->size();
             size_t base_t_gamma_size = base_t_gamma_->size();
 
+#if !defined(SEAL_DEBUG) && (defined(SEAL_USE_AVX2) || defined(SEAL_USE_AVX512))
+            // The same steps as below, each a single pass over the coefficients
+            auto decrypt_vectorized = [&](auto multiply_poly_scalar, auto scale_and_round) {
+                SEAL_ALLOCATE_GET_RNS_ITER(temp, coeff_count_, base_q_size, pool);
+                SEAL_ITERATE(iter(input, prod_t_gamma_mod_q_, base_q_->base(), temp), base_q_size, [&](auto I) {
+                    multiply_poly_scalar(get<0>(I), coeff_count_, get<1>(I), get<2>(I).value(), get<3>(I));
+                });
+                SEAL_ALLOCATE_GET_RNS_ITER(temp_t_gamma, coeff_count_, base_t_gamma_size, pool);
+                base_q_to_t_gamma_conv_->fast_convert_array(temp, temp_t_gamma, pool);
+                SEAL_ITERATE(
+                    iter(temp_t_gamma, neg_inv_q_mod_t_gamma_, base_t_gamma_->base()), base_t_gamma_size,
+                    [&](auto I) {
+                        multiply_poly_scalar(get<0>(I), coeff_count_, get<1>(I), get<2>(I).value(), get<0>(I));
+                    });
+                scale_and_round(
+                    temp_t_gamma[0], temp_t_gamma[1], coeff_count_, t_.value(), t_.const_ratio()[1], gamma_.value(),
+                    inv_gamma_mod_t_, destination);
+            };
+#ifdef SEAL_USE_AVX512
+            if (use_avx512() && !(coeff_count_ & 7))
+            {
+                decrypt_vectorized(avx512::multiply_poly_scalar, avx512::decrypt_scale_and_round);
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (use_avx2() && !(coeff_count_ & 3))
+            {
+                decrypt_vectorized(avx2::multiply_poly_scalar, avx2::decrypt_scale_and_round);
+                return;
+            }
+#endif
+#endif
             // Compute |gamma * t|_qi * ct(s)
             SEAL_ALLOCATE_GET_RNS_ITER(temp, coeff_count_, base_q_size, pool);
             SEAL_ITERATE(iter(input, prod_t_gamma_mod_q_, base_q_->base(), temp), base_q_size, [&](auto I) {
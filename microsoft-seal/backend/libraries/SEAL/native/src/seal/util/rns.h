@@ -185,6 +185,9 @@ namespace seal
             RNSBase obase_;
 
             Pointer<Pointer<std::uint64_t>> base_change_matrix_;
+
+            // The same matrix row by row with Shoup quotients, for the vectorized fast_convert_array
+            Pointer<MultiplyUIntModOperand> base_change_matrix_operands_;
         };
 
         class RNSTool
@@ -0,0 +1,244 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_AVX2_FLAGS; see the note in nttavx2.cpp.
+
+#include "seal/util/rnsavx2.h"
+
+#ifdef SEAL_USE_AVX2
+#include <algorithm>
+#include <immintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx2
+        {
+            namespace
+            {
+                // A MultiplyUIntModOperand in all lanes, with the high halves split off for _mm256_mul_epu32
+                struct Operand4
+                {
+                    __m256i operand;
+                    __m256i operand_hi;
+                    __m256i quotient;
+                    __m256i quotient_hi;
+                };
+
+                struct Modulus4
+                {
+                    __m256i value;
+                    __m256i value_hi;
+                    __m256i value_minus_one;
+                    __m256i two_times_value;
+                    __m256i two_times_value_minus_one;
+                };
+
+                inline Operand4 broadcast(const MultiplyUIntModOperand &r)
+                {
+                    return { _mm256_set1_epi64x(static_cast<long long>(r.operand)),
+                             _mm256_set1_epi64x(static_cast<long long>(r.operand >> 32)),
+                             _mm256_set1_epi64x(static_cast<long long>(r.quotient)),
+                             _mm256_set1_epi64x(static_cast<long long>(r.quotient >> 32)) };
+                }
+
+                inline Modulus4 make_modulus4(uint64_t modulus)
+                {
+                    return { _mm256_set1_epi64x(static_cast<long long>(modulus)),
+                             _mm256_set1_epi64x(static_cast<long long>(modulus >> 32)),
+                             _mm256_set1_epi64x(static_cast<long long>(modulus - 1)),
+                             _mm256_set1_epi64x(static_cast<long long>(modulus << 1)),
+                             _mm256_set1_epi64x(static_cast<long long>((modulus << 1) - 1)) };
+                }
+
+                inline __m256i load(const uint64_t *p)
+                {
+                    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                }
+
+                inline void store(uint64_t *p, __m256i a)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+                }
+
+                // Low 64 bits of a * b, given a >> 32 and b >> 32
+                inline __m256i mul_lo(__m256i a, __m256i a_hi, __m256i b, __m256i b_hi)
+                {
+                    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, b_hi), _mm256_mul_epu32(a_hi, b));
+                    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+                }
+
+                // High 64 bits of a * b, given a >> 32 and b >> 32
+                inline __m256i mul_hi(__m256i a, __m256i a_hi, __m256i b, __m256i b_hi)
+                {
+                    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+                    __m256i lolo = _mm256_mul_epu32(a, b);
+                    __m256i lohi = _mm256_mul_epu32(a, b_hi);
+                    __m256i hilo = _mm256_mul_epu32(a_hi, b);
+                    __m256i hihi = _mm256_mul_epu32(a_hi, b_hi);
+
+                    // Carry out of the middle 32 bits; at most 3 * 2^32 so it cannot overflow
+                    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(lolo, 32), _mm256_and_si256(lohi, low_mask));
+                    mid = _mm256_add_epi64(mid, _mm256_and_si256(hilo, low_mask));
+                    __m256i hi = _mm256_add_epi64(hihi, _mm256_srli_epi64(lohi, 32));
+                    hi = _mm256_add_epi64(hi, _mm256_srli_epi64(hilo, 32));
+                    return _mm256_add_epi64(hi, _mm256_srli_epi64(mid, 32));
+                }
+
+                // multiply_uint_mod_lazy on four lanes: a * r mod p in [0, 2p)
+                inline __m256i mul_lazy(__m256i a, const Operand4 &r, const Modulus4 &m)
+                {
+                    __m256i a_hi = _mm256_srli_epi64(a, 32);
+                    __m256i q = mul_hi(a, a_hi, r.quotient, r.quotient_hi);
+                    __m256i product = mul_lo(a, a_hi, r.operand, r.operand_hi);
+                    return _mm256_sub_epi64(product, mul_lo(q, _mm256_srli_epi64(q, 32), m.value, m.value_hi));
+                }
+
+                // Subtract p from lanes >= p; lanes are below 2^63, so the signed comparison is exact
+                inline __m256i reduce_once(__m256i a, const Modulus4 &m)
+                {
+                    __m256i mask = _mm256_cmpgt_epi64(a, m.value_minus_one);
+                    return _mm256_sub_epi64(a, _mm256_and_si256(mask, m.value));
+                }
+
+                // Subtract 2p from lanes >= 2p
+                inline __m256i guard(__m256i a, const Modulus4 &m)
+                {
+                    __m256i mask = _mm256_cmpgt_epi64(a, m.two_times_value_minus_one);
+                    return _mm256_sub_epi64(a, _mm256_and_si256(mask, m.two_times_value));
+                }
+
+                // barrett_reduce_64 on four lanes, with ratio the high word of the modulus' const_ratio
+                inline __m256i barrett_reduce(__m256i x, __m256i ratio, __m256i ratio_hi, const Modulus4 &m)
+                {
+                    __m256i x_hi = _mm256_srli_epi64(x, 32);
+                    __m256i q = mul_hi(x, x_hi, ratio, ratio_hi);
+                    __m256i product = mul_lo(q, _mm256_srli_epi64(q, 32), m.value, m.value_hi);
+                    return reduce_once(_mm256_sub_epi64(x, product), m);
+                }
+            } // namespace
+
+            void fast_convert_array(
+                const uint64_t *in, const uint64_t *ibase, const MultiplyUIntModOperand *inv_punctured_prod,
+                size_t ibase_size, const uint64_t *obase, const MultiplyUIntModOperand *base_change_matrix,
+                size_t obase_size, size_t count, uint64_t *out, uint64_t *temp)
+            {
+                const size_t block = fast_convert_block_size;
+                for (size_t start = 0; start < count; start += block)
+                {
+                    size_t length = min(block, count - start);
+
+                    // [in[i] * (q / q_i)^(-1)]_{q_i}, fully reduced as in the portable code
+                    for (size_t i = 0; i < ibase_size; i++)
+                    {
+                        const Modulus4 m = make_modulus4(ibase[i]);
+                        const Operand4 r = broadcast(inv_punctured_prod[i]);
+                        const uint64_t *x = in + i * count + start;
+                        uint64_t *t = temp + i * block;
+                        for (size_t k = 0; k < length; k += 4)
+                        {
+                            store(t + k, reduce_once(mul_lazy(load(x + k), r, m), m));
+                        }
+                    }
+
+                    // One output row at a time, accumulating the products in [0, 2p)
+                    for (size_t j = 0; j < obase_size; j++)
+                    {
+                        const Modulus4 m = make_modulus4(obase[j]);
+                        const MultiplyUIntModOperand *row = base_change_matrix + j * ibase_size;
+                        uint64_t *result = out + j * count + start;
+
+                        Operand4 r = broadcast(row[0]);
+                        for (size_t k = 0; k < length; k += 4)
+                        {
+                            store(result + k, mul_lazy(load(temp + k), r, m));
+                        }
+                        for (size_t i = 1; i < ibase_size; i++)
+                        {
+                            r = broadcast(row[i]);
+                            const uint64_t *t = temp + i * block;
+                            for (size_t k = 0; k < length; k += 4)
+                            {
+                                __m256i sum = _mm256_add_epi64(load(result + k), mul_lazy(load(t + k), r, m));
+                                store(result + k, guard(sum, m));
+                            }
+                        }
+                        for (size_t k = 0; k < length; k += 4)
+                        {
+                            store(result + k, reduce_once(load(result + k), m));
+                        }
+                    }
+                }
+            }
+            void multiply_poly_scalar(
+                const uint64_t *in, size_t count, const MultiplyUIntModOperand &scalar, uint64_t modulus, uint64_t *out)
+            {
+                const Modulus4 m = make_modulus4(modulus);
+                const Operand4 r = broadcast(scalar);
+                for (size_t k = 0; k < count; k += 4)
+                {
+                    store(out + k, reduce_once(mul_lazy(load(in + k), r, m), m));
+                }
+            }
+
+            void modulo_poly_add_scalar(
+                const uint64_t *in, size_t count, uint64_t modulus, uint64_t barrett_ratio, uint64_t addend,
+                uint64_t *out)
+            {
+                const Modulus4 m = make_modulus4(modulus);
+                const __m256i ratio = _mm256_set1_epi64x(static_cast<long long>(barrett_ratio));
+                const __m256i ratio_hi = _mm256_srli_epi64(ratio, 32);
+                const __m256i add = _mm256_set1_epi64x(static_cast<long long>(addend));
+                for (size_t k = 0; k < count; k += 4)
+                {
+                    __m256i x = load(in + k);
+                    store(out + k, _mm256_add_epi64(barrett_reduce(x, ratio, ratio_hi, m), add));
+                }
+            }
+
+            void sub_multiply_scalar(
+                const uint64_t *in, const uint64_t *sub, size_t count, uint64_t offset,
+                const MultiplyUIntModOperand &scalar, uint64_t modulus, uint64_t *out)
+            {
+                const Modulus4 m = make_modulus4(modulus);
+                const Operand4 r = broadcast(scalar);
+                const __m256i off = _mm256_set1_epi64x(static_cast<long long>(offset));
+                for (size_t k = 0; k < count; k += 4)
+                {
+                    __m256i x = _mm256_sub_epi64(_mm256_add_epi64(load(in + k), off), load(sub + k));
+                    store(out + k, reduce_once(mul_lazy(x, r, m), m));
+                }
+            }
+
+            void decrypt_scale_and_round(
+                const uint64_t *t_part, const uint64_t *gamma_part, size_t count, uint64_t t, uint64_t t_barrett_ratio,
+                uint64_t gamma, const MultiplyUIntModOperand &inv_gamma_mod_t, uint64_t *out)
+            {
+                const Modulus4 m = make_modulus4(t);
+                const Operand4 r = broadcast(inv_gamma_mod_t);
+                const __m256i ratio = _mm256_set1_epi64x(static_cast<long long>(t_barrett_ratio));
+                const __m256i ratio_hi = _mm256_srli_epi64(ratio, 32);
+                const __m256i g = _mm256_set1_epi64x(static_cast<long long>(gamma));
+                const __m256i gamma_div_2 = _mm256_set1_epi64x(static_cast<long long>(gamma >> 1));
+                for (size_t k = 0; k < count; k += 4)
+                {
+                    __m256i a = load(t_part + k);
+                    __m256i b = load(gamma_part + k);
+
+                    // Centered: above gamma / 2 the gamma component stands for b - gamma, so add gamma - b
+                    __m256i negative = _mm256_cmpgt_epi64(b, gamma_div_2);
+                    __m256i v = _mm256_blendv_epi8(b, _mm256_sub_epi64(g, b), negative);
+                    v = barrett_reduce(v, ratio, ratio_hi, m);
+                    __m256i sum = reduce_once(_mm256_add_epi64(a, v), m);
+                    __m256i difference = reduce_once(_mm256_sub_epi64(_mm256_add_epi64(a, m.value), v), m);
+                    __m256i x = _mm256_blendv_epi8(difference, sum, negative);
+                    store(out + k, reduce_once(mul_lazy(x, r, m), m));
+                }
+            }
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
+#endif
@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+
+#ifdef SEAL_USE_AVX2
+#include "seal/util/uintarithsmallmod.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        /**
+        AVX2 kernels for the fast RNS base conversion of the BEHZ multiplication and for the per-coefficient steps of
+        BFV decryption and modulus switching. They produce exactly the same output as the portable code in rns.cpp
+        and must only be called when use_avx2() is true; BaseConverter::fast_convert_array,
+        RNSTool::decrypt_scale_and_round and RNSTool::divide_and_round_q_last_inplace (and its NTT variant) dispatch
+        to them automatically.
+
+        The conversion is the product of the obase_size x ibase_size base-change matrix with the ibase_size x count
+        input, taken modulo each obase element. It is computed in blocks of fast_convert_block_size coefficients, so
+        that the scaled inputs of a block stay in the L1 cache while all output rows are accumulated from them. Four
+        coefficients are processed per instruction with lazy Shoup products assembled from 32x32-bit multiplications;
+        the sums are kept in [0, 2p) and fully reduced only once per output.
+
+        The implementation is compiled with AVX2 enabled, so it takes plain pointers rather than RNSBase: it must not
+        instantiate any inline function that other translation units also use.
+        */
+        namespace avx2
+        {
+            /**
+            Number of coefficients converted per block; temp must have room for ibase_size blocks.
+            */
+            constexpr std::size_t fast_convert_block_size = 128;
+
+            /**
+            Computes out[j][k] = sum_i [in[i][k] * inv_punctured_prod[i]]_{ibase[i]} * base_change_matrix[j][i] mod
+            obase[j]. All moduli must be below 2^62.
+
+            @param[in] in The ibase_size rows of count coefficients, with a stride of count
+            @param[in] ibase The ibase moduli
+            @param[in] inv_punctured_prod The ibase_size factors (q / q_i)^(-1) mod q_i
+            @param[in] ibase_size The number of input rows
+            @param[in] obase The obase moduli
+            @param[in] base_change_matrix The obase_size x ibase_size entries (q / q_i) mod p_j, row by row
+            @param[in] obase_size The number of output rows
+            @param[in] count The number of coefficients per row; must be a multiple of 4
+            @param[out] out The obase_size rows of count coefficients, with a stride of count
+            @param temp Scratch space for ibase_size * fast_convert_block_size values
+            */
+            void fast_convert_array(
+                const std::uint64_t *in, const std::uint64_t *ibase, const MultiplyUIntModOperand *inv_punctured_prod,
+                std::size_t ibase_size, const std::uint64_t *obase, const MultiplyUIntModOperand *base_change_matrix,
+                std::size_t obase_size, std::size_t count, std::uint64_t *out, std::uint64_t *temp);
+
+            /**
+            Computes out[k] = in[k] * scalar mod modulus, fully reduced, for any 64-bit in[k]; the same as
+            multiply_poly_scalar_coeffmod. count must be a multiple of 4. out may alias in.
+            */
+            void multiply_poly_scalar(
+                const std::uint64_t *in, std::size_t count, const MultiplyUIntModOperand &scalar, std::uint64_t modulus,
+                std::uint64_t *out);
+
+            /**
+            Computes out[k] = barrett_reduce_64(in[k], modulus) + addend without a further reduction, the first step of
+            RNSTool::divide_and_round_q_last_inplace and its NTT variant. count must be a multiple of 4.
+
+            @param[in] barrett_ratio The high word of modulus.const_ratio()
+            */
+            void modulo_poly_add_scalar(
+                const std::uint64_t *in, std::size_t count, std::uint64_t modulus, std::uint64_t barrett_ratio,
+                std::uint64_t addend, std::uint64_t *out);
+
+            /**
+            Computes out[k] = (in[k] + offset - sub[k]) * scalar mod modulus, fully reduced, the last step of
+            RNSTool::divide_and_round_q_last_inplace and its NTT variant. sub[k] must not exceed in[k] + offset and the
+            sum must stay below 2^64. count must be a multiple of 4. out may alias in.
+            */
+            void sub_multiply_scalar(
+                const std::uint64_t *in, const std::uint64_t *sub, std::size_t count, std::uint64_t offset,
+                const MultiplyUIntModOperand &scalar, std::uint64_t modulus, std::uint64_t *out);
+
+            /**
+            The final step of RNSTool::decrypt_scale_and_round: from the phase scaled to base {t, gamma}, subtracts
+            the centered gamma component from the t component and multiplies by gamma^(-1) mod t. count must be a
+            multiple of 4.
+
+            @param[in] t_part The coefficients mod t
+            @param[in] gamma_part The coefficients mod gamma
+            @param[in] t_barrett_ratio The high word of t.const_ratio()
+            @param[in] inv_gamma_mod_t gamma^(-1) mod t
+            */
+            void decrypt_scale_and_round(
+                const std::uint64_t *t_part, const std::uint64_t *gamma_part, std::size_t count, std::uint64_t t,
+                std::uint64_t t_barrett_ratio, std::uint64_t gamma, const MultiplyUIntModOperand &inv_gamma_mod_t,
+                std::uint64_t *out);
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
+#endif
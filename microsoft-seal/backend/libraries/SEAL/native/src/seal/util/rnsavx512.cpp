@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// This translation unit is compiled with SEAL_AVX512_FLAGS; see the note in nttavx2.cpp.
+
+#include "seal/util/rnsavx512.h"
+
+#ifdef SEAL_USE_AVX512
+#include <algorithm>
+#include <immintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx512
+        {
+            namespace
+            {
+                // A MultiplyUIntModOperand in all lanes, with the high halves split off for _mm512_mul_epu32
+                struct Operand8
+                {
+                    __m512i operand;
+                    __m512i operand_hi;
+                    __m512i quotient;
+                    __m512i quotient_hi;
+                };
+
+                struct Modulus8
+                {
+                    __m512i value;
+                    __m512i value_hi;
+                    __m512i two_times_value;
+                };
+
+                inline Operand8 broadcast(const MultiplyUIntModOperand &r)
+                {
+                    return { _mm512_set1_epi64(static_cast<long long>(r.operand)),
+                             _mm512_set1_epi64(static_cast<long long>(r.operand >> 32)),
+                             _mm512_set1_epi64(static_cast<long long>(r.quotient)),
+                             _mm512_set1_epi64(static_cast<long long>(r.quotient >> 32)) };
+                }
+
+                inline Modulus8 make_modulus8(uint64_t modulus)
+                {
+                    return { _mm512_set1_epi64(static_cast<long long>(modulus)),
+                             _mm512_set1_epi64(static_cast<long long>(modulus >> 32)),
+                             _mm512_set1_epi64(static_cast<long long>(modulus << 1)) };
+                }
+
+                // Low 64 bits of a * b, given a >> 32 and b >> 32; _mm512_mullo_epi64 would need AVX-512DQ
+                inline __m512i mul_lo(__m512i a, __m512i a_hi, __m512i b, __m512i b_hi)
+                {
+                    __m512i cross = _mm512_add_epi64(_mm512_mul_epu32(a, b_hi), _mm512_mul_epu32(a_hi, b));
+                    return _mm512_add_epi64(_mm512_mul_epu32(a, b), _mm512_slli_epi64(cross, 32));
+                }
+
+                // High 64 bits of a * b, given a >> 32 and b >> 32
+                inline __m512i mul_hi(__m512i a, __m512i a_hi, __m512i b, __m512i b_hi)
+                {
+                    const __m512i low_mask = _mm512_set1_epi64(0xFFFFFFFF);
+                    __m512i lolo = _mm512_mul_epu32(a, b);
+                    __m512i lohi = _mm512_mul_epu32(a, b_hi);
+                    __m512i hilo = _mm512_mul_epu32(a_hi, b);
+                    __m512i hihi = _mm512_mul_epu32(a_hi, b_hi);
+
+                    // Carry out of the middle 32 bits; at most 3 * 2^32 so it cannot overflow
+                    __m512i mid = _mm512_add_epi64(_mm512_srli_epi64(lolo, 32), _mm512_and_si512(lohi, low_mask));
+                    mid = _mm512_add_epi64(mid, _mm512_and_si512(hilo, low_mask));
+                    __m512i hi = _mm512_add_epi64(hihi, _mm512_srli_epi64(lohi, 32));
+                    hi = _mm512_add_epi64(hi, _mm512_srli_epi64(hilo, 32));
+                    return _mm512_add_epi64(hi, _mm512_srli_epi64(mid, 32));
+                }
+
+                // multiply_uint_mod_lazy on eight lanes: a * r mod p in [0, 2p)
+                inline __m512i mul_lazy(__m512i a, const Operand8 &r, const Modulus8 &m)
+                {
+                    __m512i a_hi = _mm512_srli_epi64(a, 32);
+                    __m512i q = mul_hi(a, a_hi, r.quotient, r.quotient_hi);
+                    __m512i product = mul_lo(a, a_hi, r.operand, r.operand_hi);
+                    return _mm512_sub_epi64(product, mul_lo(q, _mm512_srli_epi64(q, 32), m.value, m.value_hi));
+                }
+
+                // Subtracts p from the lanes of x that are at least p: x - p wraps around exactly when x < p
+                inline __m512i reduce_once(__m512i x, __m512i p)
+                {
+                    return _mm512_min_epu64(x, _mm512_sub_epi64(x, p));
+                }
+
+                // barrett_reduce_64 on eight lanes, with ratio the high word of the modulus' const_ratio
+                inline __m512i barrett_reduce(__m512i x, __m512i ratio, __m512i ratio_hi, const Modulus8 &m)
+                {
+                    __m512i q = mul_hi(x, _mm512_srli_epi64(x, 32), ratio, ratio_hi);
+                    __m512i product = mul_lo(q, _mm512_srli_epi64(q, 32), m.value, m.value_hi);
+                    return reduce_once(_mm512_sub_epi64(x, product), m.value);
+                }
+            } // namespace
+
+            void fast_convert_array(
+                const uint64_t *in, const uint64_t *ibase, const MultiplyUIntModOperand *inv_punctured_prod,
+                size_t ibase_size, const uint64_t *obase, const MultiplyUIntModOperand *base_change_matrix,
+                size_t obase_size, size_t count, uint64_t *out, uint64_t *temp)
+            {
+                const size_t block = fast_convert_block_size;
+                for (size_t start = 0; start < count; start += block)
+                {
+                    size_t length = min(block, count - start);
+
+                    // [in[i] * (q / q_i)^(-1)]_{q_i}, fully reduced as in the portable code
+                    for (size_t i = 0; i < ibase_size; i++)
+                    {
+                        const Modulus8 m = make_modulus8(ibase[i]);
+                        const Operand8 r = broadcast(inv_punctured_prod[i]);
+                        const uint64_t *x = in + i * count + start;
+                        uint64_t *t = temp + i * block;
+                        for (size_t k = 0; k < length; k += 8)
+                        {
+                            __m512i product = mul_lazy(_mm512_loadu_si512(x + k), r, m);
+                            _mm512_storeu_si512(t + k, reduce_once(product, m.value));
+                        }
+                    }
+
+                    // One output row at a time, accumulating the products in [0, 2p)
+                    for (size_t j = 0; j < obase_size; j++)
+                    {
+                        const Modulus8 m = make_modulus8(obase[j]);
+                        const MultiplyUIntModOperand *row = base_change_matrix + j * ibase_size;
+                        uint64_t *result = out + j * count + start;
+
+                        Operand8 r = broadcast(row[0]);
+                        for (size_t k = 0; k < length; k += 8)
+                        {
+                            _mm512_storeu_si512(result + k, mul_lazy(_mm512_loadu_si512(temp + k), r, m));
+                        }
+                        for (size_t i = 1; i < ibase_size; i++)
+                        {
+                            r = broadcast(row[i]);
+                            const uint64_t *t = temp + i * block;
+                            for (size_t k = 0; k < length; k += 8)
+                            {
+                                __m512i sum = _mm512_add_epi64(
+                                    _mm512_loadu_si512(result + k), mul_lazy(_mm512_loadu_si512(t + k), r, m));
+                                _mm512_storeu_si512(result + k, reduce_once(sum, m.two_times_value));
+                            }
+                        }
+                        for (size_t k = 0; k < length; k += 8)
+                        {
+                            _mm512_storeu_si512(result + k, reduce_once(_mm512_loadu_si512(result + k), m.value));
+                        }
+                    }
+                }
+            }
+            void multiply_poly_scalar(
+                const uint64_t *in, size_t count, const MultiplyUIntModOperand &scalar, uint64_t modulus, uint64_t *out)
+            {
+                const Modulus8 m = make_modulus8(modulus);
+                const Operand8 r = broadcast(scalar);
+                for (size_t k = 0; k < count; k += 8)
+                {
+                    _mm512_storeu_si512(out + k, reduce_once(mul_lazy(_mm512_loadu_si512(in + k), r, m), m.value));
+                }
+            }
+
+            void modulo_poly_add_scalar(
+                const uint64_t *in, size_t count, uint64_t modulus, uint64_t barrett_ratio, uint64_t addend,
+                uint64_t *out)
+            {
+                const Modulus8 m = make_modulus8(modulus);
+                const __m512i ratio = _mm512_set1_epi64(static_cast<long long>(barrett_ratio));
+                const __m512i ratio_hi = _mm512_srli_epi64(ratio, 32);
+                const __m512i add = _mm512_set1_epi64(static_cast<long long>(addend));
+                for (size_t k = 0; k < count; k += 8)
+                {
+                    __m512i x = _mm512_loadu_si512(in + k);
+                    _mm512_storeu_si512(out + k, _mm512_add_epi64(barrett_reduce(x, ratio, ratio_hi, m), add));
+                }
+            }
+
+            void sub_multiply_scalar(
+                const uint64_t *in, const uint64_t *sub, size_t count, uint64_t offset,
+                const MultiplyUIntModOperand &scalar, uint64_t modulus, uint64_t *out)
+            {
+                const Modulus8 m = make_modulus8(modulus);
+                const Operand8 r = broadcast(scalar);
+                const __m512i off = _mm512_set1_epi64(static_cast<long long>(offset));
+                for (size_t k = 0; k < count; k += 8)
+                {
+                    __m512i x = _mm512_sub_epi64(
+                        _mm512_add_epi64(_mm512_loadu_si512(in + k), off), _mm512_loadu_si512(sub + k));
+                    _mm512_storeu_si512(out + k, reduce_once(mul_lazy(x, r, m), m.value));
+                }
+            }
+
+            void decrypt_scale_and_round(
+                const uint64_t *t_part, const uint64_t *gamma_part, size_t count, uint64_t t, uint64_t t_barrett_ratio,
+                uint64_t gamma, const MultiplyUIntModOperand &inv_gamma_mod_t, uint64_t *out)
+            {
+                const Modulus8 m = make_modulus8(t);
+                const Operand8 r = broadcast(inv_gamma_mod_t);
+                const __m512i ratio = _mm512_set1_epi64(static_cast<long long>(t_barrett_ratio));
+                const __m512i ratio_hi = _mm512_srli_epi64(ratio, 32);
+                const __m512i g = _mm512_set1_epi64(static_cast<long long>(gamma));
+                const __m512i gamma_div_2 = _mm512_set1_epi64(static_cast<long long>(gamma >> 1));
+                for (size_t k = 0; k < count; k += 8)
+                {
+                    __m512i a = _mm512_loadu_si512(t_part + k);
+                    __m512i b = _mm512_loadu_si512(gamma_part + k);
+
+                    // Centered: above gamma / 2 the gamma component stands for b - gamma, so add gamma - b
+                    __mmask8 negative = _mm512_cmpgt_epu64_mask(b, gamma_div_2);
+                    __m512i v = _mm512_mask_sub_epi64(b, negative, g, b);
+                    v = barrett_reduce(v, ratio, ratio_hi, m);
+                    __m512i sum = reduce_once(_mm512_add_epi64(a, v), m.value);
+                    __m512i difference = reduce_once(_mm512_sub_epi64(_mm512_add_epi64(a, m.value), v), m.value);
+                    __m512i x = _mm512_mask_blend_epi64(negative, difference, sum);
+                    _mm512_storeu_si512(out + k, reduce_once(mul_lazy(x, r, m), m.value));
+                }
+            }
+        } // namespace avx512
+    } // namespace util
+} // namespace seal
+#endif
@@ -500,6 +500,74 @@ namespace seal
                 {
                     reinterpret_cast<PointerStorage *>(ptr_storage)->free(addr);
                 }
+
+                // Compression and decompression contexts of the calling thread, created on first use and reused by
+                // every later call: creating a context and sizing its workspace costs about as much as compressing
+                // a small ciphertext. Their memory comes from the global pool, since they outlive the pools passed
+                // to any one call.
+                class ZstdContexts
+                {
+                public:
+                    ZstdContexts() : ptr_storage_(MemoryPoolHandle::Global())
+                    {
+                        mem_.customAlloc = zstd_alloc_impl;
+                        mem_.customFree = zstd_free_impl;
+                        mem_.opaque = &ptr_storage_;
+                    }
+
+                    ~ZstdContexts()
+                    {
+                        ZSTD_freeCCtx(cctx_);
+                        ZSTD_freeDCtx(dctx_);
+                    }
+
+                    ZstdContexts(const ZstdContexts &) = delete;
+
+                    ZstdContexts &operator=(const ZstdContexts &) = delete;
+
+                    // Ready for a new frame, even if the last call stopped in the middle of one; nullptr if the
+                    // allocator failed
+                    ZSTD_CCtx *cctx()
+                    {
+                        if (!cctx_)
+                        {
+                            cctx_ = ZSTD_createCCtx_advanced(mem_);
+                        }
+                        else
+                        {
+                            ZSTD_CCtx_reset(cctx_, ZSTD_reset_session_only);
+                        }
+                        return cctx_;
+                    }
+
+                    ZSTD_DCtx *dctx()
+                    {
+                        if (!dctx_)
+                        {
+                            dctx_ = ZSTD_createDCtx_advanced(mem_);
+                        }
+                        else
+                        {
+                            ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+                        }
+                        return dctx_;
+                    }
+
+                private:
+                    PointerStorage ptr_storage_;
+
+                    ZSTD_customMem mem_;
+
+                    ZSTD_CCtx *cctx_ = nullptr;
+
+                    ZSTD_DCtx *dctx_ = nullptr;
+                };
+
+                ZstdContexts &thread_zstd_contexts()
+                {
+                    thread_local ZstdContexts contexts;
+                    return contexts;
+                }
             } // namespace
 
             unsigned zstd_deflate_array_inplace(DynArray<seal_byte> &in, MemoryPoolHandle pool)
@@ -509,15 +577,7 @@ namespace seal
                     throw invalid_argument("pool is uninitialized");
                 }
 
-                PointerStorage ptr_storage(pool);
-
-                // Set up the custom allocator
-                ZSTD_customMem mem;
-                mem.customAlloc = zstd_alloc_impl;
-                mem.customFree = zstd_free_impl;
-                mem.opaque = &ptr_storage;
-
-                ZSTD_CCtx *cctx = ZSTD_createCCtx_advanced(mem);
+                ZSTD_CCtx *cctx = thread_zstd_contexts().cctx();
                 if (!cctx)
                 {
                     // Failed to set up the context; there is something wrong with the allocator
@@ -660,8 +720,6 @@ namespace seal
                     in.resize(bytes_written_to_in);
                 }
 
-                ZSTD_freeCCtx(cctx);
-
                 return ZSTD_error_no_error;
             }
 
@@ -681,13 +739,7 @@ namespace seal
                 auto in(allocate<unsigned char>(buffer_size, pool));
                 auto out(allocate<unsigned char>(buffer_size, pool));
 
-                PointerStorage ptr_storage(pool);
-                ZSTD_customMem mem;
-                mem.customAlloc = zstd_alloc_impl;
-                mem.customFree = zstd_free_impl;
-                mem.opaque = &ptr_storage;
-
-                ZSTD_DCtx *dctx = ZSTD_createDCtx_advanced(mem);
+                ZSTD_DCtx *dctx = thread_zstd_contexts().dctx();
                 if (!dctx)
                 {
                     // Failed to set up the context; there is something wrong with the allocator
@@ -740,8 +792,6 @@ namespace seal
                     }
                 }
 
-                ZSTD_freeDCtx(dctx);
-
                 in_stream.exceptions(in_stream_except_mask);
                 out_stream.exceptions(out_stream_except_mask);
                 return ZSTD_error_no_error;
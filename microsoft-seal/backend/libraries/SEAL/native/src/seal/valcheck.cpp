@@ -156,7 +156,7 @@ namespace seal
             return false;
         }
 
-        size_t decomp_mod_count = context.first_context_data()->parms().coeff_modulus().size();
+        size_t decomp_mod_count = context.key_switch_digit_count();
         for (auto &a : in.data())
         {
             // Check that each highest level component has right size
@@ -119,4 +119,103 @@ namespace sealtest
             ASSERT_EQ(0ULL, short_plain_vec2[i]);
         }
     }
+
+    TEST(BatchEncoderTest, DecodeSlots)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(64);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 60 }));
+        parms.set_plain_modulus(257);
+
+        SEALContext context(parms, false, sec_level_type::none);
+        BatchEncoder batch_encoder(context);
+        vector<int64_t> plain_vec;
+        for (int64_t i = 0; i < static_cast<int64_t>(batch_encoder.slot_count()); i++)
+        {
+            plain_vec.push_back((i * 37) % 200 - 100);
+        }
+
+        Plaintext plain;
+        batch_encoder.encode(plain_vec, plain);
+        vector<size_t> slots;
+        for (size_t i = 0; i < batch_encoder.slot_count(); i++)
+        {
+            slots.push_back(i);
+        }
+        vector<int64_t> decoded;
+        batch_encoder.decode_slots(plain, slots, decoded);
+        ASSERT_TRUE(plain_vec == decoded);
+
+        vector<uint64_t> full;
+        batch_encoder.decode(plain, full);
+        vector<uint64_t> sparse;
+        batch_encoder.decode_slots(plain, { 63, 0, 32, 31 }, sparse);
+        ASSERT_EQ(4ULL, sparse.size());
+        ASSERT_EQ(full[63], sparse[0]);
+        ASSERT_EQ(full[0], sparse[1]);
+        ASSERT_EQ(full[32], sparse[2]);
+        ASSERT_EQ(full[31], sparse[3]);
+
+        // A constant plaintext has the same value in every slot
+        batch_encoder.encode(vector<uint64_t>(batch_encoder.slot_count(), 5), plain);
+        batch_encoder.decode_slots(plain, { 0, 17 }, sparse);
+        ASSERT_EQ(5ULL, sparse[0]);
+        ASSERT_EQ(5ULL, sparse[1]);
+
+        ASSERT_THROW(batch_encoder.decode_slots(plain, { 64 }, sparse), invalid_argument);
+    }
+    TEST(BatchEncoderTest, EncodeDecodeMany)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(64);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 60 }));
+        parms.set_plain_modulus(257);
+
+        SEALContext context(parms, false, sec_level_type::none);
+        BatchEncoder batch_encoder(context);
+        size_t slots = batch_encoder.slot_count();
+
+        // Six plaintexts and a partial seventh, past one batch of the NTTs
+        vector<int64_t> values;
+        for (int64_t i = 0; i < static_cast<int64_t>(6 * slots + 5); i++)
+        {
+            values.push_back((i * 37) % 257 - 128);
+        }
+        vector<Plaintext> plains;
+        batch_encoder.encode_many(values.data(), values.size(), plains);
+        ASSERT_EQ(7ULL, plains.size());
+        for (size_t i = 0; i < plains.size(); i++)
+        {
+            vector<int64_t> chunk(
+                values.begin() + static_cast<ptrdiff_t>(i * slots),
+                values.begin() + static_cast<ptrdiff_t>(min(values.size(), (i + 1) * slots)));
+            Plaintext plain;
+            batch_encoder.encode(chunk, plain);
+            ASSERT_TRUE(plain == plains[i]);
+        }
+
+        vector<int64_t> decoded;
+        batch_encoder.decode_many(plains, decoded);
+        ASSERT_EQ(7 * slots, decoded.size());
+        for (size_t i = 0; i < decoded.size(); i++)
+        {
+            ASSERT_EQ(i < values.size() ? values[i] : 0, decoded[i]);
+        }
+
+        vector<uint64_t> unsigned_values(2 * slots);
+        for (size_t i = 0; i < unsigned_values.size(); i++)
+        {
+            unsigned_values[i] = (i * 91) % 257;
+        }
+        batch_encoder.encode_many(unsigned_values.data(), unsigned_values.size(), plains);
+        ASSERT_EQ(2ULL, plains.size());
+        vector<uint64_t> unsigned_decoded;
+        batch_encoder.decode_many(plains, unsigned_decoded);
+        ASSERT_TRUE(unsigned_values == unsigned_decoded);
+
+        batch_encoder.encode_many(unsigned_values.data(), 0, plains);
+        ASSERT_TRUE(plains.empty());
+        batch_encoder.decode_many(plains, unsigned_decoded);
+        ASSERT_TRUE(unsigned_decoded.empty());
+    }
 } // namespace sealtest
@@ -4,10 +4,12 @@
 #include "seal/ciphertext.h"
 #include "seal/context.h"
 #include "seal/encryptor.h"
+#include "seal/evaluator.h"
 #include "seal/keygenerator.h"
 #include "seal/memorymanager.h"
 #include "seal/modulus.h"
 #include "gtest/gtest.h"
+#include <thread>
 
 using namespace seal;
 using namespace seal::util;
@@ -127,6 +129,236 @@ namespace sealtest
         ASSERT_TRUE(ctxt.data() != ctxt2.data());
     }
 
+    TEST(CiphertextTest, BitpackSaveLoadCiphertext)
+    {
+        for (auto scheme : { scheme_type::bfv, scheme_type::bgv })
+        {
+            EncryptionParameters parms(scheme);
+            parms.set_poly_modulus_degree(1024);
+            parms.set_coeff_modulus(CoeffModulus::Create(1024, { 27, 20, 30 }));
+            parms.set_plain_modulus(65537);
+            SEALContext context(parms, false, sec_level_type::none);
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            Encryptor encryptor(context, pk, keygen.secret_key());
+
+            Ciphertext ctxt, loaded;
+            encryptor.encrypt(Plaintext("Ax^10 + 9x^9 + 1"), ctxt);
+
+            // Data-level components of 27 and 20 bits take 47 of every 128 bits, plus a few bytes of metadata
+            auto packed_size = ctxt.save_size(compr_mode_type::bitpack);
+            ASSERT_LT(packed_size * 100, ctxt.save_size(compr_mode_type::none) * 40);
+            vector<seal_byte> buffer(static_cast<size_t>(packed_size));
+            ASSERT_EQ(packed_size, ctxt.save(buffer.data(), buffer.size(), compr_mode_type::bitpack));
+            ASSERT_EQ(packed_size, loaded.load(context, buffer.data(), buffer.size()));
+            ASSERT_TRUE(ctxt.parms_id() == loaded.parms_id());
+            ASSERT_EQ(ctxt.is_ntt_form(), loaded.is_ntt_form());
+            ASSERT_TRUE(is_equal_uint(ctxt.data(), loaded.data(), ctxt.dyn_array().size()));
+
+            // Streams, and a seeded ciphertext, which saves only its first polynomial and the seed
+            stringstream stream;
+            Serializable<Ciphertext> seeded_serializable = encryptor.encrypt_symmetric(Plaintext("1x^3 + 2"));
+            auto seeded_size = seeded_serializable.save(stream, compr_mode_type::bitpack);
+            ASSERT_LT(seeded_size * 100, seeded_serializable.save_size(compr_mode_type::none) * 40);
+            ASSERT_EQ(seeded_size, loaded.load(context, stream));
+            ASSERT_EQ(2, loaded.size());
+            ctxt.save(stream, compr_mode_type::bitpack);
+            loaded.load(context, stream);
+            ASSERT_TRUE(is_equal_uint(ctxt.data(), loaded.data(), ctxt.dyn_array().size()));
+
+            // Public keys save through their ciphertext
+            PublicKey pk2;
+            pk.save(stream, compr_mode_type::bitpack);
+            pk2.load(context, stream);
+            ASSERT_TRUE(is_equal_uint(pk.data().data(), pk2.data().data(), pk.data().dyn_array().size()));
+
+            // A width over 64 is rejected, as is a bit-packed save for load_view
+            size_t width_offset = sizeof(Serialization::SEALHeader) + sizeof(parms_id_type) + 1 + 6 * sizeof(uint64_t);
+            ASSERT_EQ(seal_byte{ 27 }, buffer[width_offset]);
+            buffer[width_offset] = seal_byte{ 65 };
+            ASSERT_THROW(loaded.load(context, buffer.data(), buffer.size()), logic_error);
+            buffer[width_offset] = seal_byte{ 27 };
+            ASSERT_THROW(loaded.load_view(context, buffer.data(), buffer.size()), invalid_argument);
+        }
+    }
+
+#ifdef SEAL_USE_ZSTD
+    TEST(CiphertextTest, ZstdSaveLoadReusesContexts)
+    {
+        // Each thread keeps one compression and one decompression context for all its saves and loads; a load
+        // that fails halfway must not affect the next one
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(1024);
+        parms.set_coeff_modulus(CoeffModulus::BFVDefault(1024));
+        parms.set_plain_modulus(0xF0F0);
+        SEALContext context(parms, false);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        Encryptor encryptor(context, pk);
+
+        auto round_trips = [&](const string &hex) {
+            Ciphertext small(context), large, loaded;
+            encryptor.encrypt(Plaintext(hex), large);
+            for (int i = 0; i < 4; i++)
+            {
+                for (const Ciphertext *ctxt : { &small, &large })
+                {
+                    vector<seal_byte> buffer(static_cast<size_t>(ctxt->save_size(compr_mode_type::zstd)));
+                    size_t size =
+                        static_cast<size_t>(ctxt->save(buffer.data(), buffer.size(), compr_mode_type::zstd));
+                    if (ctxt == &large)
+                    {
+                        vector<seal_byte> corrupted(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(size));
+                        fill(corrupted.end() - 64, corrupted.end(), seal_byte{ 0xFF });
+                        EXPECT_ANY_THROW(loaded.load(context, corrupted.data(), size));
+                    }
+                    loaded.load(context, buffer.data(), size);
+                    EXPECT_EQ(ctxt->dyn_array().size(), loaded.dyn_array().size());
+                    EXPECT_TRUE(is_equal_uint(ctxt->data(), loaded.data(), ctxt->dyn_array().size()));
+                }
+            }
+        };
+        thread other(round_trips, "1x^3 + 2x^2 + 3");
+        round_trips("Ax^10 + 9x^9 + 1");
+        other.join();
+    }
+#endif
+
+    TEST(CiphertextTest, BFVLoadViewCiphertext)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(1024);
+        parms.set_coeff_modulus(CoeffModulus::BFVDefault(1024));
+        parms.set_plain_modulus(0xF0F0);
+        SEALContext context(parms, false);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        Encryptor encryptor(context, pk);
+        Ciphertext ctxt;
+        encryptor.encrypt(Plaintext("Ax^10 + 9x^9 + 1"), ctxt);
+
+        // Place the save so that its coefficient data is aligned, as a column file does
+        size_t save_size = static_cast<size_t>(ctxt.save_size(compr_mode_type::none));
+        vector<uint64_t> buffer(save_size / sizeof(uint64_t) + 2);
+        size_t offset = (sizeof(uint64_t) - ctxt.view_data_offset() % sizeof(uint64_t)) % sizeof(uint64_t);
+        seal_byte *saved = reinterpret_cast<seal_byte *>(buffer.data()) + offset;
+        ctxt.save(saved, save_size, compr_mode_type::none);
+        ASSERT_EQ(0, reinterpret_cast<uintptr_t>(saved + ctxt.view_data_offset()) % sizeof(uint64_t));
+
+        Ciphertext view;
+        ASSERT_EQ(static_cast<streamoff>(save_size), view.load_view(context, saved, save_size));
+        ASSERT_TRUE(view.is_view());
+        ASSERT_FALSE(ctxt.is_view());
+        ASSERT_TRUE(ctxt.parms_id() == view.parms_id());
+        ASSERT_EQ(ctxt.size(), view.size());
+        ASSERT_TRUE(view.data() == reinterpret_cast<const Ciphertext::ct_coeff_type *>(saved + ctxt.view_data_offset()));
+        ASSERT_TRUE(
+            is_equal_uint(ctxt.data(), view.data(), parms.poly_modulus_degree() * parms.coeff_modulus().size() * 2));
+
+        // Copies own their data
+        Ciphertext copy(view);
+        ASSERT_FALSE(copy.is_view());
+        ASSERT_TRUE(copy.data() != view.data());
+        ASSERT_TRUE(
+            is_equal_uint(ctxt.data(), copy.data(), parms.poly_modulus_degree() * parms.coeff_modulus().size() * 2));
+
+        // Misaligned, compressed and truncated saves cannot be viewed
+        Ciphertext other;
+        vector<uint64_t> misaligned_buffer(buffer.size() + 1);
+        seal_byte *misaligned = reinterpret_cast<seal_byte *>(misaligned_buffer.data()) + offset + 1;
+        ctxt.save(misaligned, save_size, compr_mode_type::none);
+        ASSERT_THROW(other.load_view(context, misaligned, save_size), invalid_argument);
+        ASSERT_THROW(other.load_view(context, saved, save_size - 1), invalid_argument);
+#ifdef SEAL_USE_ZSTD
+        vector<seal_byte> compressed(static_cast<size_t>(ctxt.save_size(compr_mode_type::zstd)));
+        size_t compressed_size =
+            static_cast<size_t>(ctxt.save(compressed.data(), compressed.size(), compr_mode_type::zstd));
+        ASSERT_THROW(other.load_view(context, compressed.data(), compressed_size), invalid_argument);
+#endif
+        ASSERT_FALSE(other.is_view());
+    }
+
+    TEST(CiphertextTest, BFVLoadInPlaceCiphertext)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(4096);
+        parms.set_coeff_modulus(CoeffModulus::BFVDefault(4096));
+        parms.set_plain_modulus(0xF0F0);
+        SEALContext context(parms);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+
+        auto saved = [](const Ciphertext &ctxt, compr_mode_type compr_mode) {
+            vector<seal_byte> buffer(static_cast<size_t>(ctxt.save_size(compr_mode)));
+            buffer.resize(static_cast<size_t>(ctxt.save(buffer.data(), buffer.size(), compr_mode)));
+            return buffer;
+        };
+        Ciphertext first, second, lower;
+        encryptor.encrypt(Plaintext("Ax^10 + 9x^9 + 1"), first);
+        encryptor.encrypt(Plaintext("1x^3 + 2x^2 + 3"), second);
+        evaluator.mod_switch_to_next(second, lower);
+
+        // Later loads of the same or a smaller size reuse the first load's allocation
+        Ciphertext loaded;
+        vector<seal_byte> buffer = saved(first, compr_mode_type::none);
+        loaded.load_in_place(context, buffer.data(), buffer.size());
+        const Ciphertext::ct_coeff_type *allocation = loaded.data();
+        for (const Ciphertext *ctxt : { &second, &lower, &first })
+        {
+            buffer = saved(*ctxt, Serialization::compr_mode_default);
+            loaded.load_in_place(context, buffer.data(), buffer.size());
+            ASSERT_TRUE(loaded.data() == allocation);
+            ASSERT_TRUE(ctxt->parms_id() == loaded.parms_id());
+            ASSERT_EQ(ctxt->dyn_array().size(), loaded.dyn_array().size());
+            ASSERT_TRUE(is_equal_uint(ctxt->data(), loaded.data(), ctxt->dyn_array().size()));
+        }
+
+        // A failed load leaves the ciphertext empty, with its allocation
+        const size_t capacity = loaded.dyn_array().capacity();
+        buffer = saved(first, compr_mode_type::none);
+        vector<seal_byte> corrupted = buffer;
+        fill(corrupted.end() - 8, corrupted.end(), seal_byte{ 0xFF });
+        ASSERT_THROW(loaded.load_in_place(context, corrupted.data(), corrupted.size()), logic_error);
+        ASSERT_EQ(size_t(0), loaded.size());
+        ASSERT_TRUE(loaded.parms_id() == parms_id_zero);
+        ASSERT_EQ(capacity, loaded.dyn_array().capacity());
+        loaded.load_in_place(context, buffer.data(), buffer.size());
+        ASSERT_TRUE(loaded.data() == allocation);
+        ASSERT_TRUE(is_equal_uint(first.data(), loaded.data(), first.dyn_array().size()));
+
+        // So does one that fails while loading: here the size after the header, parms_id and NTT flag
+        corrupted = buffer;
+        const size_t size_offset = sizeof(Serialization::SEALHeader) + sizeof(parms_id_type) + 1;
+        fill(corrupted.begin() + size_offset, corrupted.begin() + size_offset + 8, seal_byte{ 0x7F });
+        ASSERT_THROW(loaded.load_in_place(context, corrupted.data(), corrupted.size()), logic_error);
+        ASSERT_EQ(size_t(0), loaded.size());
+        ASSERT_EQ(capacity, loaded.dyn_array().capacity());
+        loaded.load_in_place(context, buffer.data(), buffer.size());
+        ASSERT_TRUE(loaded.data() == allocation);
+
+        // A view's memory is never written
+        size_t save_size = static_cast<size_t>(first.save_size(compr_mode_type::none));
+        vector<uint64_t> view_buffer(save_size / sizeof(uint64_t) + 2);
+        size_t offset = (sizeof(uint64_t) - first.view_data_offset() % sizeof(uint64_t)) % sizeof(uint64_t);
+        seal_byte *view_saved = reinterpret_cast<seal_byte *>(view_buffer.data()) + offset;
+        first.save(view_saved, save_size, compr_mode_type::none);
+        Ciphertext view;
+        view.load_view(context, view_saved, save_size);
+        buffer = saved(second, compr_mode_type::none);
+        view.load_in_place(context, buffer.data(), buffer.size());
+        ASSERT_FALSE(view.is_view());
+        ASSERT_TRUE(is_equal_uint(second.data(), view.data(), second.dyn_array().size()));
+        Ciphertext still;
+        still.load_view(context, view_saved, save_size);
+        ASSERT_TRUE(is_equal_uint(first.data(), still.data(), first.dyn_array().size()));
+    }
+
     TEST(CiphertextTest, BGVCiphertextBasics)
     {
         EncryptionParameters parms(scheme_type::bgv);
@@ -0,0 +1,255 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/batchencoder.h"
+#include "seal/ciphertextbatch.h"
+#include "seal/ckks.h"
+#include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
+#include "seal/keygenerator.h"
+#include "seal/modulus.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <sstream>
+
+using namespace seal;
+using namespace seal::util;
+using namespace std;
+
+namespace sealtest
+{
+    namespace
+    {
+        bool same_data(const Ciphertext &a, const Ciphertext &b)
+        {
+            return a.parms_id() == b.parms_id() && a.size() == b.size() && a.is_ntt_form() == b.is_ntt_form() &&
+                   equal(a.dyn_array().cbegin(), a.dyn_array().cend(), b.dyn_array().cbegin(), b.dyn_array().cend());
+        }
+    } // namespace
+
+    TEST(CiphertextBatchTest, SetGetSave)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(64);
+        parms.set_plain_modulus(1 << 6);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 30, 30, 30 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        Encryptor encryptor(context, pk);
+
+        CiphertextBatch batch;
+        ASSERT_TRUE(batch.empty());
+        ASSERT_THROW(batch.assign(context, vector<Ciphertext>{}), invalid_argument);
+
+        vector<Ciphertext> encrypteds(5);
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            encryptor.encrypt(Plaintext(to_string(i + 1)), encrypteds[i]);
+        }
+        batch.assign(context, encrypteds);
+        ASSERT_EQ(5ULL, batch.count());
+        ASSERT_EQ(2ULL, batch.size());
+        ASSERT_EQ(64ULL, batch.poly_modulus_degree());
+        // The special prime is not part of the data levels
+        ASSERT_EQ(2ULL, batch.coeff_modulus_size());
+        ASSERT_TRUE(batch.parms_id() == context.first_parms_id());
+        ASSERT_FALSE(batch.is_ntt_form());
+
+        // Component 1 of polynomial 0 of ciphertext 2 lies where the layout says it does
+        ASSERT_TRUE(equal(encrypteds[2].data(0) + 64, encrypteds[2].data(0) + 128, batch.data(1, 2, 0)));
+        ASSERT_EQ(batch.data(1) + (1 * 5 + 3) * 64, batch.data(1, 3, 1));
+
+        Ciphertext copy;
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            batch.get(context, i, copy);
+            ASSERT_TRUE(same_data(encrypteds[i], copy));
+        }
+        ASSERT_THROW(batch.get(context, 5, copy), out_of_range);
+
+        batch.set(4, encrypteds[0]);
+        batch.get(context, 4, copy);
+        ASSERT_TRUE(same_data(encrypteds[0], copy));
+        ASSERT_THROW(batch.set(5, encrypteds[0]), out_of_range);
+
+        // Ciphertexts of another shape do not fit
+        Ciphertext lower;
+        encryptor.encrypt(Plaintext("1"), lower);
+        Evaluator evaluator(context);
+        evaluator.mod_switch_to_next_inplace(lower);
+        ASSERT_THROW(batch.set(0, lower), invalid_argument);
+        encrypteds.push_back(lower);
+        ASSERT_THROW(batch.assign(context, encrypteds), invalid_argument);
+
+        // Saved ciphertexts are those Ciphertext::save writes
+        stringstream stream, expected;
+        batch.save(context, 1, stream, compr_mode_type::none);
+        encrypteds[1].save(expected, compr_mode_type::none);
+        ASSERT_EQ(expected.str(), stream.str());
+        vector<seal_byte> buffer(static_cast<size_t>(encrypteds[1].save_size(compr_mode_type::none)));
+        batch.save(context, 1, buffer.data(), buffer.size(), compr_mode_type::none);
+        ASSERT_EQ(expected.str(), string(reinterpret_cast<const char *>(buffer.data()), buffer.size()));
+        Ciphertext loaded;
+        loaded.load(context, stream);
+        ASSERT_TRUE(same_data(encrypteds[1], loaded));
+
+        batch.resize(context, context.first_parms_id(), 3, 3);
+        ASSERT_EQ(3ULL, batch.count());
+        ASSERT_EQ(3ULL, batch.size());
+        ASSERT_TRUE(all_of(batch.data(0), batch.data(0) + 3 * 3 * 64 * 2, [](uint64_t c) { return c == 0; }));
+        ASSERT_THROW(batch.resize(context, context.first_parms_id(), 3, 1), invalid_argument);
+    }
+
+    TEST(CiphertextBatchTest, BFVAddManyAddNTT)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(128);
+        parms.set_plain_modulus(1 << 6);
+        parms.set_coeff_modulus(CoeffModulus::Create(128, { 40, 40 }));
+        SEALContext context(parms, false, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        vector<Ciphertext> encrypteds(100);
+        for (auto &encrypted : encrypteds)
+        {
+            encryptor.encrypt(Plaintext("1x^1 + 1"), encrypted);
+        }
+        CiphertextBatch batch(context, context.first_parms_id(), 1);
+        batch.assign(context, encrypteds);
+
+        // The batch sum equals the fused sum of the same ciphertexts
+        Ciphertext sum, expected;
+        Plaintext plain;
+        evaluator.add_many(batch, sum);
+        evaluator.add_many(encrypteds, expected);
+        ASSERT_TRUE(same_data(expected, sum));
+        decryptor.decrypt(sum, plain);
+        ASSERT_EQ(plain.to_string(), "24x^1 + 24");
+
+        evaluator.add_inplace(batch, batch);
+        batch.get(context, 7, sum);
+        decryptor.decrypt(sum, plain);
+        ASSERT_EQ(plain.to_string(), "2x^1 + 2");
+
+        // A round trip through NTT form leaves every ciphertext unchanged
+        CiphertextBatch original = batch;
+        evaluator.transform_to_ntt_inplace(batch);
+        ASSERT_TRUE(batch.is_ntt_form());
+        batch.get(context, 3, sum);
+        original.get(context, 3, expected);
+        evaluator.transform_to_ntt_inplace(expected);
+        ASSERT_TRUE(same_data(expected, sum));
+        ASSERT_THROW(evaluator.transform_to_ntt_inplace(batch), invalid_argument);
+        ASSERT_THROW(evaluator.add_inplace(batch, original), invalid_argument);
+        evaluator.transform_from_ntt_inplace(batch);
+        for (size_t i = 0; i < batch.count(); i++)
+        {
+            batch.get(context, i, sum);
+            original.get(context, i, expected);
+            ASSERT_TRUE(same_data(expected, sum));
+        }
+
+        CiphertextBatch other(context, context.first_parms_id(), 3);
+        ASSERT_THROW(evaluator.add_inplace(batch, other), invalid_argument);
+        ASSERT_THROW(evaluator.add_many(CiphertextBatch(), sum), invalid_argument);
+    }
+
+    TEST(CiphertextBatchTest, CKKSMultiplyPlain)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        parms.set_poly_modulus_degree(64);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 50, 30, 30, 50 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        CKKSEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        double scale = pow(2.0, 30);
+        vector<Ciphertext> encrypteds(4);
+        Plaintext plain;
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            encoder.encode(static_cast<double>(i + 1), scale, plain);
+            encryptor.encrypt(plain, encrypteds[i]);
+        }
+        CiphertextBatch batch;
+        batch.assign(context, encrypteds);
+
+        Plaintext weight;
+        encoder.encode(3.0, scale, weight);
+        evaluator.multiply_plain_inplace(batch, weight);
+        ASSERT_TRUE(are_close(batch.scale(), scale * scale));
+
+        Ciphertext product, expected;
+        vector<double> values;
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            batch.get(context, i, product);
+            evaluator.multiply_plain(encrypteds[i], weight, expected);
+            ASSERT_TRUE(same_data(expected, product));
+            decryptor.decrypt(product, plain);
+            encoder.decode(plain, values);
+            ASSERT_NEAR(3.0 * static_cast<double>(i + 1), values[0], 0.01);
+        }
+
+        // The weight must be in NTT form at the batch's level
+        Plaintext lower;
+        encoder.encode(3.0, context.first_context_data()->next_context_data()->parms_id(), scale, lower);
+        ASSERT_THROW(evaluator.multiply_plain_inplace(batch, lower), invalid_argument);
+    }
+
+    TEST(CiphertextBatchTest, BGVMultiplyPlainAddMany)
+    {
+        EncryptionParameters parms(scheme_type::bgv);
+        parms.set_poly_modulus_degree(64);
+        parms.set_plain_modulus(PlainModulus::Batching(64, 20));
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40 }));
+        SEALContext context(parms, false, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        BatchEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        // BGV ciphertexts are in NTT form already
+        vector<Ciphertext> encrypteds(10);
+        Plaintext plain;
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            encoder.encode(vector<uint64_t>(encoder.slot_count(), i + 1), plain);
+            encryptor.encrypt(plain, encrypteds[i]);
+        }
+        CiphertextBatch batch;
+        batch.assign(context, encrypteds);
+        ASSERT_TRUE(batch.is_ntt_form());
+
+        Plaintext weight;
+        encoder.encode(vector<uint64_t>(encoder.slot_count(), 2), weight);
+        evaluator.transform_to_ntt_inplace(weight, context.first_parms_id());
+        evaluator.multiply_plain_inplace(batch, weight);
+
+        // Weighted sum: 2 * (1 + 2 + ... + 10)
+        Ciphertext sum;
+        evaluator.add_many(batch, sum);
+        decryptor.decrypt(sum, plain);
+        vector<uint64_t> values;
+        encoder.decode(plain, values);
+        ASSERT_EQ(110ULL, values[0]);
+        ASSERT_EQ(110ULL, values.back());
+    }
+} // namespace sealtest
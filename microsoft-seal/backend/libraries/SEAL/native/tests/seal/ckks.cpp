@@ -5,7 +5,12 @@
 #include "seal/context.h"
 #include "seal/keygenerator.h"
 #include "seal/modulus.h"
+#include "seal/util/cpufeatures.h"
+#include "seal/util/fftavx2.h"
+#include "seal/util/fftavx512.h"
 #include <ctime>
+#include <functional>
+#include <random>
 #include <vector>
 #include "gtest/gtest.h"
 
@@ -341,4 +346,181 @@ namespace sealtest
             }
         }
     }
+
+    TEST(CKKSEncoderTest, CKKSEncoderEncodeConstantVectorTest)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        size_t slots = 32;
+        parms.set_poly_modulus_degree(slots << 1);
+        parms.set_coeff_modulus(CoeffModulus::Create(slots << 1, { 40, 40, 40, 40 }));
+        SEALContext context(parms, false, sec_level_type::none);
+        CKKSEncoder encoder(context);
+        double delta = (1ULL << 16);
+
+        // A vector with the same real value in every slot encodes exactly like that single value
+        for (double value : { 0.0, 1.5, -1234.25 })
+        {
+            Plaintext expected;
+            encoder.encode(value, context.first_parms_id(), delta, expected);
+
+            Plaintext plain;
+            encoder.encode(vector<double>(slots, value), context.first_parms_id(), delta, plain);
+            ASSERT_TRUE(equal(expected.data(), expected.data() + expected.coeff_count(), plain.data()));
+
+            encoder.encode(complex<double>(value, 0), context.first_parms_id(), delta, plain);
+            ASSERT_TRUE(equal(expected.data(), expected.data() + expected.coeff_count(), plain.data()));
+        }
+
+        // Otherwise the FFT is still needed
+        vector<complex<double>> values(slots, complex<double>(2.0, 3.0));
+        Plaintext plain;
+        vector<complex<double>> result;
+        encoder.encode(values[0], context.first_parms_id(), delta, plain);
+        encoder.decode(plain, result);
+        for (size_t i = 0; i < slots; i++)
+        {
+            ASSERT_TRUE(abs(values[i] - result[i]) < 0.5);
+        }
+        values[slots - 1] = 4.0;
+        encoder.encode(values, context.first_parms_id(), delta, plain);
+        encoder.decode(plain, result);
+        for (size_t i = 0; i < slots; i++)
+        {
+            ASSERT_TRUE(abs(values[i] - result[i]) < 0.5);
+        }
+    }
+
+#if defined(SEAL_USE_AVX2) || defined(SEAL_USE_AVX512)
+    namespace
+    {
+        using FFTKernel = function<void(complex<double> *, int, const complex<double> *, const double *)>;
+
+        // The vectorized kernels must reproduce the DWTHandler transforms of CKKSEncoder up to rounding
+        void check_fft_kernels(const FFTKernel &to_rev, const FFTKernel &from_rev)
+        {
+            MemoryPoolHandle pool = MemoryPoolHandle::Global();
+            Arithmetic<complex<double>, complex<double>, double> arithmetic;
+            DWTHandler<complex<double>, complex<double>, double> handler(arithmetic);
+            mt19937_64 rng(42);
+            uniform_real_distribution<double> dist(-1.0, 1.0);
+            for (int log_n = 3; log_n <= 14; log_n++)
+            {
+                // Powers of the primitive 2n-th root, as set up by the CKKSEncoder constructor
+                size_t n = size_t(1) << log_n;
+                ComplexRoots complex_roots(n << 1, pool);
+                vector<complex<double>> roots(n);
+                vector<complex<double>> inv_roots(n);
+                for (size_t i = 1; i < n; i++)
+                {
+                    roots[i] = complex_roots.get_root(reverse_bits(i, log_n));
+                    inv_roots[i] = conj(complex_roots.get_root(reverse_bits(i - 1, log_n) + 1));
+                }
+
+                double tolerance = 1e-12 * static_cast<double>(n);
+                const double fix = 1.0 / static_cast<double>(n);
+                for (const double *scalar : { static_cast<const double *>(nullptr), &fix })
+                {
+                    vector<complex<double>> expected(n);
+                    for (auto &value : expected)
+                    {
+                        value = { dist(rng), dist(rng) };
+                    }
+                    vector<complex<double>> actual = expected;
+                    handler.transform_to_rev(expected.data(), log_n, roots.data(), scalar);
+                    to_rev(actual.data(), log_n, roots.data(), scalar);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        ASSERT_NEAR(expected[i].real(), actual[i].real(), tolerance);
+                        ASSERT_NEAR(expected[i].imag(), actual[i].imag(), tolerance);
+                    }
+
+                    actual = expected;
+                    handler.transform_from_rev(expected.data(), log_n, inv_roots.data(), scalar);
+                    from_rev(actual.data(), log_n, inv_roots.data(), scalar);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        ASSERT_NEAR(expected[i].real(), actual[i].real(), tolerance);
+                        ASSERT_NEAR(expected[i].imag(), actual[i].imag(), tolerance);
+                    }
+                }
+            }
+        }
+    } // namespace
+#endif
+
+    TEST(CKKSEncoderTest, CKKSEncoderDecodeSlotsTest)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        size_t slots = 512;
+        parms.set_poly_modulus_degree(slots << 1);
+        parms.set_coeff_modulus(CoeffModulus::Create(slots << 1, { 60, 40, 60 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        CKKSEncoder encoder(context);
+
+        random_device rd;
+        mt19937 gen(rd());
+        uniform_real_distribution<double> dist(-1000.0, 1000.0);
+        vector<complex<double>> values(slots);
+        for (auto &value : values)
+        {
+            value = complex<double>(dist(gen), dist(gen));
+        }
+
+        Plaintext plain;
+        encoder.encode(values, context.first_parms_id(), pow(2.0, 40), plain);
+        vector<complex<double>> full;
+        encoder.decode(plain, full);
+
+        vector<size_t> indices;
+        for (size_t i = 0; i < slots; i++)
+        {
+            indices.push_back(i);
+        }
+        vector<complex<double>> decoded;
+        encoder.decode_slots(plain, indices, decoded);
+        ASSERT_EQ(slots, decoded.size());
+        for (size_t i = 0; i < slots; i++)
+        {
+            ASSERT_NEAR(full[i].real(), decoded[i].real(), 1e-6);
+            ASSERT_NEAR(full[i].imag(), decoded[i].imag(), 1e-6);
+        }
+
+        // Real parts only, in the requested order, at a lower level
+        vector<double> real_values(slots);
+        for (size_t i = 0; i < slots; i++)
+        {
+            real_values[i] = values[i].real();
+        }
+        encoder.encode(real_values, context.first_context_data()->next_context_data()->parms_id(), pow(2.0, 40), plain);
+        vector<double> sparse;
+        encoder.decode_slots(plain, { 511, 0, 256 }, sparse);
+        ASSERT_EQ(3ULL, sparse.size());
+        ASSERT_NEAR(real_values[511], sparse[0], 1e-6);
+        ASSERT_NEAR(real_values[0], sparse[1], 1e-6);
+        ASSERT_NEAR(real_values[256], sparse[2], 1e-6);
+
+        ASSERT_THROW(encoder.decode_slots(plain, { slots }, sparse), invalid_argument);
+    }
+
+#ifdef SEAL_USE_AVX2
+    TEST(CKKSEncoderTest, AVX2FFTTest)
+    {
+        if (!use_avx2())
+        {
+            return;
+        }
+        check_fft_kernels(avx2::fft_transform_to_rev, avx2::fft_transform_from_rev);
+    }
+#endif
+
+#ifdef SEAL_USE_AVX512
+    TEST(CKKSEncoderTest, AVX512FFTTest)
+    {
+        if (!use_avx512())
+        {
+            return;
+        }
+        check_fft_kernels(avx512::fft_transform_to_rev, avx512::fft_transform_from_rev);
+    }
+#endif
 } // namespace sealtest
@@ -3,6 +3,7 @@
 
 #include "seal/context.h"
 #include "seal/modulus.h"
+#include <algorithm>
 #include "gtest/gtest.h"
 
 using namespace seal;
@@ -414,6 +415,47 @@ namespace sealtest
         }
     }
 
+    TEST(ContextTest, SpecialModulusChain)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        parms.set_poly_modulus_degree(64);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 30, 30, 30, 30, 30, 30 }));
+        parms.set_special_modulus_size(2);
+        SEALContext context(parms, true, sec_level_type::none);
+        ASSERT_TRUE(context.parameters_set());
+        ASSERT_TRUE(context.using_keyswitching());
+
+        // The first data level drops both special primes, later levels one prime each
+        auto context_data = context.key_context_data();
+        ASSERT_EQ(size_t(4), context_data->chain_index());
+        context_data = context_data->next_context_data();
+        ASSERT_EQ(context.first_parms_id(), context_data->parms_id());
+        ASSERT_EQ(size_t(4), context_data->parms().coeff_modulus().size());
+        ASSERT_TRUE(
+            equal(context_data->parms().coeff_modulus().begin(), context_data->parms().coeff_modulus().end(),
+                  parms.coeff_modulus().begin()));
+        ASSERT_EQ(size_t(2), context.key_switch_digit_count());
+        size_t sizes = 0;
+        for (; context_data; context_data = context_data->next_context_data())
+        {
+            ASSERT_EQ(size_t(4) - sizes++, context_data->parms().coeff_modulus().size());
+        }
+        ASSERT_EQ(size_t(4), sizes);
+
+        // Three special primes: one digit holds all three data primes
+        parms.set_special_modulus_size(3);
+        SEALContext context3(parms, false, sec_level_type::none);
+        ASSERT_EQ(size_t(3), context3.first_context_data()->parms().coeff_modulus().size());
+        ASSERT_EQ(size_t(1), context3.key_switch_digit_count());
+
+        // No data prime left: no keyswitching
+        parms.set_special_modulus_size(6);
+        SEALContext context6(parms, true, sec_level_type::none);
+        ASSERT_TRUE(context6.parameters_set());
+        ASSERT_FALSE(context6.using_keyswitching());
+        ASSERT_EQ(context6.key_parms_id(), context6.first_parms_id());
+    }
+
     TEST(EncryptionParameterQualifiersTest, BFVParameterError)
     {
         auto scheme = scheme_type::bfv;
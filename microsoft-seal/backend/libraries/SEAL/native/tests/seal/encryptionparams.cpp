@@ -151,4 +151,35 @@ namespace sealtest
         encryption_parameters_save_load(scheme_type::bfv);
         encryption_parameters_save_load(scheme_type::bgv);
     }
+
+    TEST(EncryptionParametersTest, SpecialModulusSize)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        parms.set_poly_modulus_degree(64);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 30, 30, 30, 30 }));
+        ASSERT_EQ(1ULL, parms.special_modulus_size());
+        auto parms_id = parms.parms_id();
+
+        // The default leaves parms_id as it was
+        parms.set_special_modulus_size(1);
+        ASSERT_TRUE(parms_id == parms.parms_id());
+        parms.set_special_modulus_size(2);
+        ASSERT_EQ(2ULL, parms.special_modulus_size());
+        ASSERT_FALSE(parms_id == parms.parms_id());
+        ASSERT_THROW(parms.set_special_modulus_size(0), invalid_argument);
+
+        stringstream stream;
+        EncryptionParameters parms2;
+        parms.save(stream);
+        parms2.load(stream);
+        ASSERT_EQ(2ULL, parms2.special_modulus_size());
+        ASSERT_TRUE(parms.coeff_modulus() == parms2.coeff_modulus());
+        ASSERT_TRUE(parms == parms2);
+
+        parms.set_special_modulus_size(1);
+        parms.save(stream);
+        parms2.load(stream);
+        ASSERT_EQ(1ULL, parms2.special_modulus_size());
+        ASSERT_TRUE(parms_id == parms2.parms_id());
+    }
 } // namespace sealtest
@@ -9,6 +9,9 @@
 #include "seal/evaluator.h"
 #include "seal/keygenerator.h"
 #include "seal/modulus.h"
+#include "seal/util/uintarithsmallmod.h"
+#include "seal/util/uintcore.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <ctime>
@@ -4290,6 +4293,65 @@ namespace sealtest
         }
     }
 
+    TEST(EvaluatorTest, CKKSEncryptRotateManyDecrypt)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        size_t slot_size = 32;
+        parms.set_poly_modulus_degree(slot_size * 2);
+        parms.set_coeff_modulus(CoeffModulus::Create(slot_size * 2, { 40, 40, 40, 40 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        GaloisKeys glk;
+        keygen.create_galois_keys(glk);
+
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+        CKKSEncoder encoder(context);
+        const double delta = static_cast<double>(1ULL << 30);
+
+        vector<complex<double>> input(slot_size);
+        for (size_t i = 0; i < slot_size; i++)
+        {
+            input[i] = complex<double>(static_cast<double>(i), static_cast<double>(i % 5));
+        }
+        Plaintext plain;
+        encoder.encode(input, context.first_parms_id(), delta, plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        // Step 5 has no Galois key of its own
+        vector<int> steps{ 1, -1, 0, 4, 5, -16 };
+        for (int level = 0; level < 2; level++)
+        {
+            vector<Ciphertext> rotated;
+            evaluator.rotate_many(encrypted, steps, glk, rotated);
+            ASSERT_EQ(steps.size(), rotated.size());
+            for (size_t i = 0; i < steps.size(); i++)
+            {
+                ASSERT_TRUE(rotated[i].parms_id() == encrypted.parms_id());
+                ASSERT_TRUE(rotated[i].is_ntt_form());
+
+                vector<complex<double>> output;
+                decryptor.decrypt(rotated[i], plain);
+                encoder.decode(plain, output);
+                for (size_t k = 0; k < slot_size; k++)
+                {
+                    size_t source = (k + static_cast<size_t>(steps[i] + static_cast<int>(slot_size))) % slot_size;
+                    ASSERT_EQ(input[source].real(), round(output[k].real()));
+                    ASSERT_EQ(input[source].imag(), round(output[k].imag()));
+                }
+            }
+            evaluator.mod_switch_to_next_inplace(encrypted);
+        }
+
+        vector<Ciphertext> rotated;
+        ASSERT_THROW(evaluator.rotate_many(encrypted, { 1, int(slot_size) }, glk, rotated), invalid_argument);
+    }
+
     TEST(EvaluatorTest, CKKSEncryptRescaleRotateDecrypt)
     {
         EncryptionParameters parms(scheme_type::ckks);
@@ -5022,6 +5084,55 @@ namespace sealtest
         ASSERT_TRUE(encrypted.parms_id() == context.first_parms_id());
     }
 
+    TEST(EvaluatorTest, BFVAddManyLarge)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        Modulus plain_modulus(1 << 6);
+        parms.set_poly_modulus_degree(128);
+        parms.set_plain_modulus(plain_modulus);
+        parms.set_coeff_modulus(CoeffModulus::Create(128, { 60, 60 }));
+
+        SEALContext context(parms, false, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        RelinKeys rlk;
+        keygen.create_relin_keys(rlk);
+
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        // Enough operands for the fused sum to reduce lazily several times
+        Ciphertext encrypted, sum;
+        Plaintext plain;
+        encryptor.encrypt(Plaintext("1x^1 + 1"), encrypted);
+        vector<Ciphertext> encrypteds(100, encrypted);
+        evaluator.add_many(encrypteds, sum);
+        decryptor.decrypt(sum, plain);
+        ASSERT_EQ(plain.to_string(), "24x^1 + 24");
+        ASSERT_EQ(2ULL, sum.size());
+
+        vector<const Ciphertext *> pointers{ &encrypteds[0], &encrypteds[1], &encrypteds[2] };
+        evaluator.add_many(pointers.data(), pointers.size(), sum);
+        decryptor.decrypt(sum, plain);
+        ASSERT_EQ(plain.to_string(), "3x^1 + 3");
+
+        // Operands of different sizes are added one by one
+        Ciphertext squared;
+        evaluator.square(encrypted, squared);
+        encrypteds = { encrypted, squared, encrypted };
+        evaluator.add_many(encrypteds, sum);
+        ASSERT_EQ(3ULL, sum.size());
+        evaluator.relinearize_inplace(sum, rlk);
+        decryptor.decrypt(sum, plain);
+        ASSERT_EQ(plain.to_string(), "1x^2 + 4x^1 + 3");
+
+        ASSERT_THROW(evaluator.add_many(pointers.data(), 0, sum), invalid_argument);
+        pointers.push_back(&sum);
+        ASSERT_THROW(evaluator.add_many(pointers.data(), pointers.size(), sum), invalid_argument);
+    }
+
     TEST(EvaluatorTest, BGVEncryptAddManyDecrypt)
     {
         EncryptionParameters parms(scheme_type::bgv);
@@ -5452,6 +5563,74 @@ namespace sealtest
         ASSERT_TRUE((plain_vec == vector<uint64_t>{ 2, 3, 4, 1, 6, 7, 8, 5 }));
     }
 
+    TEST(EvaluatorTest, BFVEncryptRotateManyDecrypt)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        Modulus plain_modulus(257);
+        parms.set_poly_modulus_degree(64);
+        parms.set_plain_modulus(plain_modulus);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40, 40, 40 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        GaloisKeys glk;
+        keygen.create_galois_keys(glk);
+
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+        BatchEncoder batch_encoder(context);
+
+        vector<uint64_t> plain_vec(batch_encoder.slot_count());
+        for (size_t i = 0; i < plain_vec.size(); i++)
+        {
+            plain_vec[i] = (i * 37 + 11) % plain_modulus.value();
+        }
+        Plaintext plain;
+        batch_encoder.encode(plain_vec, plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        // Steps 3 and -7 have no Galois key of their own
+        vector<int> steps{ 1, 0, -1, 2, 3, -7, 16, 31 };
+        for (int level = 0; level < 2; level++)
+        {
+            vector<Ciphertext> rotated;
+            evaluator.rotate_many(encrypted, steps, glk, rotated);
+            ASSERT_EQ(steps.size(), rotated.size());
+            for (size_t i = 0; i < steps.size(); i++)
+            {
+                Ciphertext expected;
+                evaluator.rotate_rows(encrypted, steps[i], glk, expected);
+                ASSERT_TRUE(rotated[i].parms_id() == encrypted.parms_id());
+                ASSERT_FALSE(rotated[i].is_ntt_form());
+
+                vector<uint64_t> expected_vec, rotated_vec;
+                decryptor.decrypt(expected, plain);
+                batch_encoder.decode(plain, expected_vec);
+                decryptor.decrypt(rotated[i], plain);
+                batch_encoder.decode(plain, rotated_vec);
+                ASSERT_TRUE(expected_vec == rotated_vec);
+                ASSERT_EQ(plain_vec[static_cast<size_t>(steps[i] + 32) % 32], rotated_vec[0]);
+            }
+            evaluator.mod_switch_to_next_inplace(encrypted);
+        }
+
+        // destinations may contain encrypted
+        vector<Ciphertext> rotated{ encrypted };
+        evaluator.rotate_many(rotated[0], { 1, 2 }, glk, rotated);
+        ASSERT_EQ(2ULL, rotated.size());
+        decryptor.decrypt(rotated[1], plain);
+        vector<uint64_t> rotated_vec;
+        batch_encoder.decode(plain, rotated_vec);
+        ASSERT_EQ(plain_vec[2], rotated_vec[0]);
+
+        evaluator.rotate_many(encrypted, {}, glk, rotated);
+        ASSERT_TRUE(rotated.empty());
+    }
+
     TEST(EvaluatorTest, BFVEncryptModSwitchToNextDecrypt)
     {
         // The common parameters: the plaintext and the polynomial moduli
@@ -5746,6 +5925,284 @@ namespace sealtest
         ASSERT_TRUE(encrypted.parms_id() == context.first_parms_id());
     }
 
+    TEST(EvaluatorTest, BGVEncryptMultiplyPlainAccumulateDecrypt)
+    {
+        EncryptionParameters parms(scheme_type::bgv);
+        Modulus plain_modulus(65);
+        parms.set_poly_modulus_degree(128);
+        parms.set_plain_modulus(plain_modulus);
+        parms.set_coeff_modulus(CoeffModulus::Create(128, { 60, 60, 60 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        RelinKeys rlk;
+        keygen.create_relin_keys(rlk);
+
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        // Enough terms for the fused sum to reduce lazily several times: sum of (i % 5) * (i % 3 + 1)
+        const size_t count = 50;
+        vector<Ciphertext> encrypteds(count);
+        vector<Plaintext> plains(count);
+        uint64_t expected = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            encryptor.encrypt(Plaintext(to_string(i % 5)), encrypteds[i]);
+            plains[i] = to_string(i % 3 + 1);
+            evaluator.transform_to_ntt_inplace(plains[i], context.first_parms_id());
+            expected += (i % 5) * (i % 3 + 1);
+        }
+
+        // The fused sums match multiply_plain followed by add_inplace exactly
+        Ciphertext sum, accumulated, reference, product;
+        Plaintext plain;
+        evaluator.multiply_plain_add_many(encrypteds, plains, sum);
+        evaluator.multiply_plain(encrypteds[0], plains[0], accumulated);
+        reference = accumulated;
+        for (size_t i = 1; i < count; i++)
+        {
+            evaluator.multiply_plain_accumulate(accumulated, encrypteds[i], plains[i]);
+            evaluator.multiply_plain(encrypteds[i], plains[i], product);
+            evaluator.add_inplace(reference, product);
+        }
+        ASSERT_TRUE(equal(sum.data(), sum.data() + sum.dyn_array().size(), reference.data()));
+        ASSERT_TRUE(equal(accumulated.data(), accumulated.data() + accumulated.dyn_array().size(), reference.data()));
+        decryptor.decrypt(sum, plain);
+        ASSERT_EQ(expected % plain_modulus.value(), plain[0]);
+
+        // Terms of different sizes are accumulated one by one
+        Ciphertext squared;
+        evaluator.square(encrypteds[1], squared);
+        vector<Ciphertext> mixed{ encrypteds[1], squared };
+        vector<Plaintext> weights{ plains[0], plains[1] };
+        evaluator.multiply_plain_add_many(mixed, weights, sum);
+        ASSERT_EQ(3ULL, sum.size());
+        evaluator.relinearize_inplace(sum, rlk);
+        decryptor.decrypt(sum, plain);
+        ASSERT_EQ("3", plain.to_string());
+        evaluator.multiply_plain(encrypteds[1], plains[1], accumulated);
+        evaluator.multiply_plain_accumulate(accumulated, squared, plains[0]);
+        ASSERT_EQ(3ULL, accumulated.size());
+
+        // Different correction factors are combined as add_inplace combines them
+        Ciphertext corrected = encrypteds[2];
+        corrected.correction_factor() = 2;
+        evaluator.multiply_plain(encrypteds[1], plains[1], accumulated);
+        reference = accumulated;
+        evaluator.multiply_plain_accumulate(accumulated, corrected, plains[2]);
+        evaluator.multiply_plain(corrected, plains[2], product);
+        evaluator.add_inplace(reference, product);
+        ASSERT_EQ(reference.correction_factor(), accumulated.correction_factor());
+        ASSERT_TRUE(equal(accumulated.data(), accumulated.data() + accumulated.dyn_array().size(), reference.data()));
+        vector<Ciphertext> corrections{ encrypteds[1], corrected };
+        weights = { plains[1], plains[2] };
+        evaluator.multiply_plain_add_many(corrections, weights, sum);
+        ASSERT_TRUE(equal(sum.data(), sum.data() + sum.dyn_array().size(), reference.data()));
+
+        // Both operands must be in NTT form at one level, and the sum at the product's level
+        Plaintext plain_normal("1");
+        ASSERT_THROW(evaluator.multiply_plain_accumulate(sum, encrypteds[0], plain_normal), invalid_argument);
+        Ciphertext lower = encrypteds[0];
+        evaluator.mod_switch_to_next_inplace(lower);
+        ASSERT_THROW(evaluator.multiply_plain_accumulate(sum, lower, plains[0]), invalid_argument);
+        ASSERT_THROW(evaluator.multiply_plain_add_many(encrypteds, weights, sum), invalid_argument);
+        vector<const Ciphertext *> pointers{ &encrypteds[0], &sum };
+        vector<const Plaintext *> plain_pointers{ &plains[0], &plains[1] };
+        ASSERT_THROW(
+            evaluator.multiply_plain_add_many(pointers.data(), plain_pointers.data(), 2, sum), invalid_argument);
+        ASSERT_THROW(
+            evaluator.multiply_plain_add_many(pointers.data(), plain_pointers.data(), 0, sum), invalid_argument);
+    }
+
+    TEST(EvaluatorTest, CKKSEncryptMultiplyPlainAccumulateDecrypt)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        parms.set_poly_modulus_degree(64);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 60, 40, 60 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+
+        CKKSEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        double scale = pow(2.0, 40);
+        vector<Ciphertext> encrypteds(3);
+        vector<Plaintext> weights(3);
+        Plaintext plain;
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            encoder.encode(static_cast<double>(i + 1), scale, plain);
+            encryptor.encrypt(plain, encrypteds[i]);
+            encoder.encode(0.5 * static_cast<double>(i + 1), scale, weights[i]);
+        }
+
+        // 0.5 * (1 + 4 + 9)
+        Ciphertext sum, accumulated;
+        vector<double> values;
+        evaluator.multiply_plain_add_many(encrypteds, weights, sum);
+        ASSERT_TRUE(util::are_close(sum.scale(), scale * scale));
+        evaluator.rescale_to_next_inplace(sum);
+        decryptor.decrypt(sum, plain);
+        encoder.decode(plain, values);
+        ASSERT_NEAR(7.0, values[0], 0.01);
+
+        evaluator.multiply_plain(encrypteds[0], weights[0], accumulated);
+        evaluator.multiply_plain_accumulate(accumulated, encrypteds[2], weights[2]);
+        evaluator.rescale_to_next_inplace(accumulated);
+        decryptor.decrypt(accumulated, plain);
+        encoder.decode(plain, values);
+        ASSERT_NEAR(5.0, values[0], 0.01);
+
+        // The sum must be at the scale of the product
+        ASSERT_THROW(evaluator.multiply_plain_accumulate(encrypteds[1], encrypteds[0], weights[0]), invalid_argument);
+        encoder.encode(1.0, scale * 2, weights[1]);
+        ASSERT_THROW(evaluator.multiply_plain_add_many(encrypteds, weights, sum), invalid_argument);
+    }
+
+    TEST(EvaluatorTest, BFVEncryptMultiplyAddScalarDecrypt)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        Modulus plain_modulus(PlainModulus::Batching(64, 20));
+        parms.set_poly_modulus_degree(64);
+        parms.set_plain_modulus(plain_modulus);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40 }));
+
+        SEALContext context(parms, false, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+
+        BatchEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        const uint64_t t = plain_modulus.value();
+        vector<uint64_t> values(encoder.slot_count());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            values[i] = i * 1000 % t;
+        }
+        Plaintext plain;
+        Ciphertext encrypted;
+        encoder.encode(values, plain);
+        encryptor.encrypt(plain, encrypted);
+
+        // Small and negative (upper half) scalars, in coefficient and in NTT form
+        for (uint64_t scalar : { uint64_t(3), t - 2 })
+        {
+            Ciphertext product, sum, product_ntt, sum_ntt;
+            evaluator.multiply_scalar(encrypted, scalar, product);
+            evaluator.add_scalar(encrypted, scalar, sum);
+
+            vector<uint64_t> result;
+            decryptor.decrypt(product, plain);
+            encoder.decode(plain, result);
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                ASSERT_EQ(util::multiply_uint_mod(values[i], scalar, plain_modulus), result[i]);
+            }
+            decryptor.decrypt(sum, plain);
+            encoder.decode(plain, result);
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                ASSERT_EQ(util::add_uint_mod(values[i], scalar, plain_modulus), result[i]);
+            }
+
+            // Adding a scalar is adding the constant plaintext
+            Ciphertext expected;
+            evaluator.add_plain(encrypted, Plaintext(util::uint_to_hex_string(&scalar, 1)), expected);
+            ASSERT_TRUE(equal(sum.data(), sum.data() + sum.dyn_array().size(), expected.data()));
+
+            evaluator.transform_to_ntt(encrypted, product_ntt);
+            evaluator.multiply_scalar_inplace(product_ntt, scalar);
+            evaluator.transform_from_ntt_inplace(product_ntt);
+            ASSERT_TRUE(equal(product.data(), product.data() + product.dyn_array().size(), product_ntt.data()));
+            evaluator.transform_to_ntt(encrypted, sum_ntt);
+            evaluator.add_scalar_inplace(sum_ntt, scalar);
+            evaluator.transform_from_ntt_inplace(sum_ntt);
+            ASSERT_TRUE(equal(sum.data(), sum.data() + sum.dyn_array().size(), sum_ntt.data()));
+        }
+    }
+
+    TEST(EvaluatorTest, BGVEncryptMultiplyAddScalarDecrypt)
+    {
+        EncryptionParameters parms(scheme_type::bgv);
+        Modulus plain_modulus(PlainModulus::Batching(64, 20));
+        parms.set_poly_modulus_degree(64);
+        parms.set_plain_modulus(plain_modulus);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40, 40 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+
+        BatchEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        const uint64_t t = plain_modulus.value();
+        Plaintext plain;
+        Ciphertext encrypted;
+        encoder.encode(vector<uint64_t>(encoder.slot_count(), 5), plain);
+        encryptor.encrypt(plain, encrypted);
+
+        // The second round runs at a lower level, where the correction factor is no longer 1
+        for (int round = 0; round < 2; round++)
+        {
+            for (uint64_t scalar : { uint64_t(3), t - 2 })
+            {
+                // The same results as with the constant plaintext, bit for bit
+                Plaintext constant(util::uint_to_hex_string(&scalar, 1));
+                Plaintext constant_ntt = constant;
+                evaluator.transform_to_ntt_inplace(constant_ntt, encrypted.parms_id());
+                Ciphertext product, sum, expected;
+                evaluator.multiply_scalar(encrypted, scalar, product);
+                evaluator.multiply_plain(encrypted, constant_ntt, expected);
+                ASSERT_TRUE(equal(product.data(), product.data() + product.dyn_array().size(), expected.data()));
+                evaluator.add_scalar(encrypted, scalar, sum);
+                evaluator.add_plain(encrypted, constant, expected);
+                ASSERT_TRUE(equal(sum.data(), sum.data() + sum.dyn_array().size(), expected.data()));
+
+                vector<uint64_t> result;
+                decryptor.decrypt(product, plain);
+                encoder.decode(plain, result);
+                ASSERT_EQ(util::multiply_uint_mod(5, scalar, plain_modulus), result[0]);
+                decryptor.decrypt(sum, plain);
+                encoder.decode(plain, result);
+                ASSERT_EQ(util::add_uint_mod(5, scalar, plain_modulus), result.back());
+            }
+            if (round == 0)
+            {
+                evaluator.mod_switch_to_next_inplace(encrypted);
+                ASSERT_NE(1ULL, encrypted.correction_factor());
+            }
+        }
+
+        EncryptionParameters ckks_parms(scheme_type::ckks);
+        ckks_parms.set_poly_modulus_degree(64);
+        ckks_parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40 }));
+        SEALContext ckks_context(ckks_parms, false, sec_level_type::none);
+        KeyGenerator ckks_keygen(ckks_context);
+        ckks_keygen.create_public_key(pk);
+        Encryptor ckks_encryptor(ckks_context, pk);
+        Evaluator ckks_evaluator(ckks_context);
+        ckks_encryptor.encrypt_zero(encrypted);
+        ASSERT_THROW(ckks_evaluator.multiply_scalar_inplace(encrypted, 3), invalid_argument);
+        ASSERT_THROW(ckks_evaluator.add_scalar_inplace(encrypted, 3), invalid_argument);
+    }
+
     TEST(EvaluatorTest, BGVEncryptApplyGaloisDecrypt)
     {
         EncryptionParameters parms(scheme_type::bgv);
@@ -5879,6 +6336,74 @@ namespace sealtest
         ASSERT_TRUE((plain_vec == vector<uint64_t>{ 2, 3, 4, 1, 6, 7, 8, 5 }));
     }
 
+    TEST(EvaluatorTest, BGVEncryptRotateManyDecrypt)
+    {
+        EncryptionParameters parms(scheme_type::bgv);
+        Modulus plain_modulus(257);
+        parms.set_poly_modulus_degree(64);
+        parms.set_plain_modulus(plain_modulus);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40, 40, 40 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        GaloisKeys glk;
+        keygen.create_galois_keys(glk);
+
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+        BatchEncoder batch_encoder(context);
+
+        vector<uint64_t> plain_vec(batch_encoder.slot_count());
+        for (size_t i = 0; i < plain_vec.size(); i++)
+        {
+            plain_vec[i] = (i * 37 + 11) % plain_modulus.value();
+        }
+        Plaintext plain;
+        batch_encoder.encode(plain_vec, plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        // Steps 3 and -7 have no Galois key of their own
+        vector<int> steps{ 1, 0, -1, 2, 3, -7, 16, 31 };
+        for (int level = 0; level < 2; level++)
+        {
+            vector<Ciphertext> rotated;
+            evaluator.rotate_many(encrypted, steps, glk, rotated);
+            ASSERT_EQ(steps.size(), rotated.size());
+            for (size_t i = 0; i < steps.size(); i++)
+            {
+                Ciphertext expected;
+                evaluator.rotate_rows(encrypted, steps[i], glk, expected);
+                ASSERT_TRUE(rotated[i].parms_id() == encrypted.parms_id());
+                ASSERT_TRUE(rotated[i].is_ntt_form());
+
+                vector<uint64_t> expected_vec, rotated_vec;
+                decryptor.decrypt(expected, plain);
+                batch_encoder.decode(plain, expected_vec);
+                decryptor.decrypt(rotated[i], plain);
+                batch_encoder.decode(plain, rotated_vec);
+                ASSERT_TRUE(expected_vec == rotated_vec);
+                ASSERT_EQ(plain_vec[static_cast<size_t>(steps[i] + 32) % 32], rotated_vec[0]);
+            }
+            evaluator.mod_switch_to_next_inplace(encrypted);
+        }
+
+        // destinations may contain encrypted
+        vector<Ciphertext> rotated{ encrypted };
+        evaluator.rotate_many(rotated[0], { 1, 2 }, glk, rotated);
+        ASSERT_EQ(2ULL, rotated.size());
+        decryptor.decrypt(rotated[1], plain);
+        vector<uint64_t> rotated_vec;
+        batch_encoder.decode(plain, rotated_vec);
+        ASSERT_EQ(plain_vec[2], rotated_vec[0]);
+
+        evaluator.rotate_many(encrypted, {}, glk, rotated);
+        ASSERT_TRUE(rotated.empty());
+    }
+
     TEST(EvaluatorTest, BGVEncryptModSwitchToNextDecrypt)
     {
         {
@@ -6140,4 +6665,233 @@ namespace sealtest
         ASSERT_TRUE(encrypted.parms_id() == parms_id);
         ASSERT_TRUE(plain.to_string() == "5x^64 + Ax^5");
     }
+
+    TEST(EvaluatorTest, BFVEncryptScratchArenaDecrypt)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        Modulus plain_modulus(257);
+        parms.set_poly_modulus_degree(64);
+        parms.set_plain_modulus(plain_modulus);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40, 40, 40 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        RelinKeys rlk;
+        keygen.create_relin_keys(rlk);
+        GaloisKeys glk;
+        keygen.create_galois_keys(glk);
+
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+        BatchEncoder batch_encoder(context);
+
+        vector<uint64_t> plain_vec(batch_encoder.slot_count());
+        for (size_t i = 0; i < plain_vec.size(); i++)
+        {
+            plain_vec[i] = (i * 37 + 11) % plain_modulus.value();
+        }
+        Plaintext plain;
+        batch_encoder.encode(plain_vec, plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        auto run = [&](MemoryPoolHandle pool) {
+            Ciphertext result;
+            evaluator.multiply(encrypted, encrypted, result, pool);
+            evaluator.relinearize_inplace(result, rlk, pool);
+            evaluator.rotate_rows_inplace(result, 1, glk, pool);
+            evaluator.multiply_plain_inplace(result, plain, pool);
+            evaluator.mod_switch_to_next_inplace(result, pool);
+            return result;
+        };
+
+        // Results do not depend on the pool, and do not hold memory from it
+        Ciphertext expected = run(MemoryManager::GetPool());
+        ScratchArena arena;
+        Ciphertext actual = run(arena);
+        ASSERT_TRUE(equal(expected.dyn_array().cbegin(), expected.dyn_array().cend(), actual.dyn_array().cbegin()));
+        ASSERT_EQ(0ULL, arena.outstanding_count());
+
+        // Repeating the work after a reset needs no more memory
+        size_t alloc_byte_count = arena.alloc_byte_count();
+        ASSERT_LT(0ULL, alloc_byte_count);
+        arena.reset();
+        actual = run(arena);
+        ASSERT_EQ(alloc_byte_count, arena.alloc_byte_count());
+        arena.reset();
+
+        vector<uint64_t> result_vec;
+        decryptor.decrypt(actual, plain);
+        batch_encoder.decode(plain, result_vec);
+        for (size_t i = 0; i < 32; i++)
+        {
+            uint64_t rotated = plain_vec[(i + 1) % 32];
+            ASSERT_EQ(rotated * rotated % 257 * plain_vec[i] % 257, result_vec[i]);
+        }
+    }
+
+    TEST(EvaluatorTest, CKKSHybridKeySwitching)
+    {
+        for (size_t special_modulus_size : { 2, 3 })
+        {
+            EncryptionParameters parms(scheme_type::ckks);
+            size_t slot_size = 32;
+            parms.set_poly_modulus_degree(slot_size * 2);
+            parms.set_coeff_modulus(CoeffModulus::Create(slot_size * 2, { 40, 40, 40, 40, 40, 40, 40 }));
+            parms.set_special_modulus_size(special_modulus_size);
+
+            SEALContext context(parms, true, sec_level_type::none);
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            RelinKeys rlk;
+            keygen.create_relin_keys(rlk);
+            GaloisKeys glk;
+            keygen.create_galois_keys(glk);
+            ASSERT_EQ(context.key_switch_digit_count(), rlk.key(2).size());
+
+            Encryptor encryptor(context, pk);
+            Evaluator evaluator(context);
+            Decryptor decryptor(context, keygen.secret_key());
+            CKKSEncoder encoder(context);
+            const double delta = static_cast<double>(1ULL << 30);
+
+            vector<complex<double>> input(slot_size);
+            for (size_t i = 0; i < slot_size; i++)
+            {
+                input[i] = complex<double>(static_cast<double>(i % 7), static_cast<double>(i % 3));
+            }
+            Plaintext plain;
+            encoder.encode(input, context.first_parms_id(), delta, plain);
+            Ciphertext encrypted;
+            encryptor.encrypt(plain, encrypted);
+
+            // Digits are cut short at lower levels once the level's primes run out mid-digit
+            for (int level = 0; level < 3; level++)
+            {
+                Ciphertext squared;
+                evaluator.square(encrypted, squared);
+                evaluator.relinearize_inplace(squared, rlk);
+                vector<complex<double>> output;
+                decryptor.decrypt(squared, plain);
+                encoder.decode(plain, output);
+                for (size_t k = 0; k < slot_size; k++)
+                {
+                    complex<double> expected = input[k] * input[k];
+                    ASSERT_EQ(expected.real(), round(output[k].real()));
+                    ASSERT_EQ(expected.imag(), round(output[k].imag()));
+                }
+
+                vector<int> steps{ 1, -3, 0, 8 };
+                vector<Ciphertext> rotated;
+                evaluator.rotate_many(encrypted, steps, glk, rotated);
+                for (size_t i = 0; i < steps.size(); i++)
+                {
+                    Ciphertext expected;
+                    evaluator.rotate_vector(encrypted, steps[i], glk, expected);
+                    for (auto *result : { &rotated[i], &expected })
+                    {
+                        decryptor.decrypt(*result, plain);
+                        encoder.decode(plain, output);
+                        for (size_t k = 0; k < slot_size; k++)
+                        {
+                            size_t source =
+                                (k + static_cast<size_t>(steps[i] + static_cast<int>(slot_size))) % slot_size;
+                            ASSERT_EQ(input[source].real(), round(output[k].real()));
+                            ASSERT_EQ(input[source].imag(), round(output[k].imag()));
+                        }
+                    }
+                }
+
+                Ciphertext conjugated;
+                evaluator.complex_conjugate(encrypted, glk, conjugated);
+                decryptor.decrypt(conjugated, plain);
+                encoder.decode(plain, output);
+                for (size_t k = 0; k < slot_size; k++)
+                {
+                    ASSERT_EQ(input[k].real(), round(output[k].real()));
+                    ASSERT_EQ(-input[k].imag(), round(output[k].imag()));
+                }
+                evaluator.mod_switch_to_next_inplace(encrypted);
+            }
+        }
+    }
+
+    TEST(EvaluatorTest, BFVBGVHybridKeySwitching)
+    {
+        for (scheme_type scheme : { scheme_type::bfv, scheme_type::bgv })
+        {
+            for (size_t special_modulus_size : { 2, 3 })
+            {
+                EncryptionParameters parms(scheme);
+                Modulus plain_modulus = PlainModulus::Batching(64, 20);
+                parms.set_poly_modulus_degree(64);
+                parms.set_plain_modulus(plain_modulus);
+                parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40, 40, 40, 40, 40, 40 }));
+                parms.set_special_modulus_size(special_modulus_size);
+
+                SEALContext context(parms, true, sec_level_type::none);
+                KeyGenerator keygen(context);
+                PublicKey pk;
+                keygen.create_public_key(pk);
+                RelinKeys rlk;
+                keygen.create_relin_keys(rlk);
+                GaloisKeys glk;
+                keygen.create_galois_keys(glk);
+
+                Encryptor encryptor(context, pk);
+                Evaluator evaluator(context);
+                Decryptor decryptor(context, keygen.secret_key());
+                BatchEncoder batch_encoder(context);
+
+                vector<uint64_t> plain_vec(batch_encoder.slot_count());
+                for (size_t i = 0; i < plain_vec.size(); i++)
+                {
+                    plain_vec[i] = (i * 7919 + 11) % plain_modulus.value();
+                }
+                Plaintext plain;
+                batch_encoder.encode(plain_vec, plain);
+                Ciphertext encrypted;
+                encryptor.encrypt(plain, encrypted);
+
+                vector<uint64_t> result_vec;
+                for (int level = 0; level < 3; level++)
+                {
+                    Ciphertext squared;
+                    evaluator.square(encrypted, squared);
+                    evaluator.relinearize_inplace(squared, rlk);
+                    ASSERT_EQ(2ULL, squared.size());
+                    decryptor.decrypt(squared, plain);
+                    batch_encoder.decode(plain, result_vec);
+                    for (size_t i = 0; i < plain_vec.size(); i++)
+                    {
+                        ASSERT_EQ(util::multiply_uint_mod(plain_vec[i], plain_vec[i], plain_modulus), result_vec[i]);
+                    }
+
+                    Ciphertext rotated;
+                    evaluator.rotate_rows(encrypted, 3, glk, rotated);
+                    decryptor.decrypt(rotated, plain);
+                    batch_encoder.decode(plain, result_vec);
+                    ASSERT_EQ(plain_vec[3], result_vec[0]);
+                    ASSERT_EQ(plain_vec[0], result_vec[29]);
+
+                    evaluator.rotate_columns(encrypted, glk, rotated);
+                    decryptor.decrypt(rotated, plain);
+                    batch_encoder.decode(plain, result_vec);
+                    ASSERT_EQ(plain_vec[32], result_vec[0]);
+
+                    vector<Ciphertext> rotated_many;
+                    evaluator.rotate_many(encrypted, { 1, -2 }, glk, rotated_many);
+                    decryptor.decrypt(rotated_many[1], plain);
+                    batch_encoder.decode(plain, result_vec);
+                    ASSERT_EQ(plain_vec[30], result_vec[0]);
+                    ASSERT_EQ(plain_vec[0], result_vec[2]);
+                    evaluator.mod_switch_to_next_inplace(encrypted);
+                }
+            }
+        }
+    }
 } // namespace sealtest
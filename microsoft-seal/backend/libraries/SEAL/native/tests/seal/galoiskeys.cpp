@@ -1,7 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include "seal/batchencoder.h"
 #include "seal/context.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
 #include "seal/galoiskeys.h"
 #include "seal/keygenerator.h"
 #include "seal/modulus.h"
@@ -216,4 +219,109 @@ namespace sealtest
         galoiskey_seeded_save_load(scheme_type::bfv);
         galoiskey_seeded_save_load(scheme_type::bgv);
     }
+
+    TEST(GaloisKeysTest, GaloisKeysCompact)
+    {
+        auto galoiskey_compact = [](scheme_type scheme, vector<int> bit_sizes) {
+            EncryptionParameters parms(scheme);
+            parms.set_poly_modulus_degree(1024);
+            parms.set_plain_modulus(PlainModulus::Batching(1024, 20));
+            parms.set_coeff_modulus(CoeffModulus::Create(1024, bit_sizes));
+            SEALContext context(parms, true, sec_level_type::none);
+            KeyGenerator keygen(context);
+            PublicKey public_key;
+            keygen.create_public_key(public_key);
+            RelinKeys relin_keys;
+            keygen.create_relin_keys(relin_keys);
+            GaloisKeys galois_keys;
+            keygen.create_galois_keys(vector<int>{ 1, -3 }, galois_keys);
+
+            RelinKeys compact_relin_keys = relin_keys;
+            GaloisKeys compact_galois_keys = galois_keys;
+            compact_relin_keys.compact(context);
+            compact_galois_keys.compact(context);
+            ASSERT_TRUE(compact_relin_keys.is_compact(0));
+            size_t index = GaloisKeys::get_index(context.key_context_data()->galois_tool()->get_elt_from_step(1));
+            ASSERT_TRUE(compact_galois_keys.is_compact(index));
+            ASSERT_FALSE(galois_keys.is_compact(index));
+            ASSERT_LT(compact_galois_keys.data_bytes(), galois_keys.data_bytes());
+            ASSERT_EQ(galois_keys.size(), compact_galois_keys.size());
+
+            // Saved in the usual format, equal to the keys before compaction
+            stringstream wide_stream;
+            stringstream compact_stream;
+            galois_keys.save(wide_stream, compr_mode_type::none);
+            compact_galois_keys.save(compact_stream, compr_mode_type::none);
+            ASSERT_EQ(
+                galois_keys.save_size(compr_mode_type::none), compact_galois_keys.save_size(compr_mode_type::none));
+            ASSERT_TRUE(wide_stream.str() == compact_stream.str());
+            auto expanded = compact_galois_keys.expanded_key(index);
+            ASSERT_EQ(galois_keys.data()[index].size(), expanded.size());
+            for (size_t j = 0; j < expanded.size(); j++)
+            {
+                auto &key = galois_keys.data()[index][j].data();
+                ASSERT_TRUE(is_equal_uint(key.data(), expanded[j].data().data(), key.dyn_array().size()));
+            }
+
+            // Key switching reads the same key material, so gives the same ciphertexts
+            Encryptor encryptor(context, public_key);
+            Evaluator evaluator(context);
+            BatchEncoder encoder(context);
+            vector<uint64_t> values(encoder.slot_count());
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                values[i] = i % 7;
+            }
+            Plaintext plain;
+            encoder.encode(values, plain);
+            Ciphertext encrypted;
+            encryptor.encrypt(plain, encrypted);
+            Ciphertext wide;
+            Ciphertext compact;
+            evaluator.square(encrypted, wide);
+            compact = wide;
+            evaluator.relinearize_inplace(wide, relin_keys);
+            evaluator.relinearize_inplace(compact, compact_relin_keys);
+            ASSERT_TRUE(is_equal_uint(wide.data(), compact.data(), wide.dyn_array().size()));
+            evaluator.rotate_rows_inplace(wide, 1, galois_keys);
+            evaluator.rotate_rows_inplace(compact, 1, compact_galois_keys);
+            evaluator.rotate_rows_inplace(wide, -3, galois_keys);
+            evaluator.rotate_rows_inplace(compact, -3, compact_galois_keys);
+            ASSERT_TRUE(is_equal_uint(wide.data(), compact.data(), wide.dyn_array().size()));
+
+            // A key replaced through data() is used as given
+            compact_galois_keys.data()[index] = galois_keys.data()[index];
+            ASSERT_FALSE(compact_galois_keys.is_compact(index));
+            evaluator.rotate_rows(encrypted, 1, galois_keys, wide);
+            evaluator.rotate_rows(encrypted, 1, compact_galois_keys, compact);
+            ASSERT_TRUE(is_equal_uint(wide.data(), compact.data(), wide.dyn_array().size()));
+
+            compact_galois_keys.expand();
+            ASSERT_FALSE(compact_galois_keys.is_compact(index));
+            ASSERT_EQ(galois_keys.data_bytes(), compact_galois_keys.data_bytes());
+            compact_stream.str("");
+            compact_galois_keys.save(compact_stream, compr_mode_type::none);
+            ASSERT_TRUE(wide_stream.str() == compact_stream.str());
+        };
+        galoiskey_compact(scheme_type::bfv, { 30, 30, 30 });
+        galoiskey_compact(scheme_type::bfv, { 50, 30, 30, 50 });
+        galoiskey_compact(scheme_type::bgv, { 50, 30, 30, 50 });
+
+        // Nothing to compact without primes of at most 32 bits
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(1024);
+        parms.set_plain_modulus(PlainModulus::Batching(1024, 20));
+        parms.set_coeff_modulus(CoeffModulus::Create(1024, { 40, 40 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        RelinKeys relin_keys;
+        keygen.create_relin_keys(relin_keys);
+        relin_keys.compact(context);
+        ASSERT_FALSE(relin_keys.is_compact(0));
+
+        // Nor without keys
+        GaloisKeys empty_keys;
+        empty_keys.compact(context);
+        ASSERT_EQ(0ULL, empty_keys.data_bytes());
+    }
 } // namespace sealtest
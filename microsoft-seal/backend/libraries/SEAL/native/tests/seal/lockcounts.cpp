@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/lockcounts.h"
+#include "seal/memorymanager.h"
+#include "seal/util/locks.h"
+#include "seal/util/polycore.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "gtest/gtest.h"
+
+using namespace seal;
+using namespace seal::util;
+using namespace std;
+
+namespace sealtest
+{
+    namespace
+    {
+        LockCounts::ThreadGroup find_group(const string &label)
+        {
+            for (auto &group : LockCounts::ByLabel())
+            {
+                if (group.label == label)
+                {
+                    return group;
+                }
+            }
+            LockCounts::ThreadGroup none;
+            none.label = label;
+            return none;
+        }
+    } // namespace
+
+    TEST(LockCountsTest, Names)
+    {
+        ASSERT_STREQ("memory_pool_head", LockCounts::SiteName(LockSite::memory_pool_head));
+        ASSERT_STREQ("ntt_tables", LockCounts::SiteName(LockSite::ntt_tables));
+        ASSERT_STREQ("other", LockCounts::SiteName(LockSite::other));
+        ASSERT_STREQ("shared", LockCounts::ModeName(LockMode::shared));
+        ASSERT_STREQ("exclusive", LockCounts::ModeName(LockMode::exclusive));
+    }
+
+    TEST(LockCountsTest, CountsContendedAcquisition)
+    {
+#ifndef SEAL_USE_LOCK_COUNTS
+        GTEST_SKIP() << "built without SEAL_USE_LOCK_COUNTS";
+#endif
+        ASSERT_TRUE(LockCounts::Enabled());
+        ReaderWriterLocker locker;
+        atomic<bool> started{ false };
+        thread reader;
+        {
+            WriterLock writer(locker.acquire_write());
+            reader = thread([&] {
+                LockCounts::SetThreadLabel("lockcounts-contended");
+                started = true;
+                ReaderLock lock(locker.acquire_read());
+                ReaderLock again(locker.acquire_read());
+            });
+            while (!started)
+            {
+                this_thread::yield();
+            }
+            this_thread::sleep_for(chrono::milliseconds(20));
+        }
+        reader.join();
+
+        // The reader has exited; its counts stay under its label
+        auto group = find_group("lockcounts-contended");
+        const auto &shared = group.at(LockSite::other, LockMode::shared);
+        ASSERT_EQ(2ULL, shared.acquisitions);
+        ASSERT_EQ(1ULL, shared.contended);
+        ASSERT_LT(0ULL, shared.wait_ns);
+        ASSERT_EQ(0ULL, group.at(LockSite::other, LockMode::exclusive).acquisitions);
+    }
+
+    TEST(LockCountsTest, CountsMemoryPool)
+    {
+#ifndef SEAL_USE_LOCK_COUNTS
+        GTEST_SKIP() << "built without SEAL_USE_LOCK_COUNTS";
+#endif
+        MemoryPoolHandle pool = MemoryPoolHandle::New();
+        thread([&] {
+            LockCounts::SetThreadLabel("lockcounts-pool");
+            auto ptr(allocate_uint(4, pool));
+            ptr.release();
+            auto again(allocate_uint(4, pool));
+        }).join();
+
+        // Each allocation reads the table of sizes and takes the head twice: to take an item and to return it
+        auto group = find_group("lockcounts-pool");
+        ASSERT_LE(2ULL, group.at(LockSite::memory_pool_table, LockMode::shared).acquisitions);
+        ASSERT_EQ(4ULL, group.at(LockSite::memory_pool_head, LockMode::exclusive).acquisitions);
+        ASSERT_EQ(0ULL, group.at(LockSite::memory_pool_head, LockMode::exclusive).contended);
+    }
+} // namespace sealtest
@@ -6,6 +6,7 @@
 #include "seal/util/pointer.h"
 #include "seal/util/uintcore.h"
 #include "gtest/gtest.h"
+#include <thread>
 
 using namespace seal;
 using namespace seal::util;
@@ -67,4 +68,75 @@ namespace sealtest
         }
         ASSERT_EQ(1L, pool.use_count());
     }
+
+    TEST(ScratchArenaTest, ScratchArenaAllocate)
+    {
+        ScratchArena arena;
+        MemoryPoolHandle pool = arena;
+        ASSERT_TRUE(pool == arena.pool());
+        ASSERT_TRUE(0LL == arena.alloc_byte_count());
+        {
+            auto ptr(allocate_uint(5, pool));
+            DynArray<int> arr(10, arena);
+            ASSERT_TRUE(2LL == arena.outstanding_count());
+            ASSERT_TRUE(5LL * bytes_per_uint64 < arena.alloc_byte_count());
+            ASSERT_THROW(arena.reset(), logic_error);
+        }
+        ASSERT_TRUE(0LL == arena.outstanding_count());
+        size_t alloc_byte_count = arena.alloc_byte_count();
+        arena.reset();
+        ASSERT_EQ(alloc_byte_count, arena.alloc_byte_count());
+        {
+            auto ptr(allocate_uint(5, pool));
+            DynArray<int> arr(10, arena);
+        }
+        ASSERT_EQ(alloc_byte_count, arena.alloc_byte_count());
+    }
+
+    TEST(MemoryUsageTest, CountsAttachedThread)
+    {
+        MemoryPoolHandle pool = MemoryPoolHandle::New();
+        MemoryPoolHandle other_pool = MemoryPoolHandle::New();
+        MemoryUsage usage;
+        auto before(allocate_uint(4, pool));
+        {
+            MemoryUsageGuard guard(&usage);
+            {
+                auto ptr(allocate_uint(5, pool));
+                auto ptr2(allocate_uint(3, other_pool));
+                ASSERT_EQ(8 * bytes_per_uint64, usage.held_byte_count());
+                {
+                    MemoryUsageGuard detached(nullptr);
+                    auto ignored(allocate_uint(7, pool));
+                }
+                ASSERT_EQ(2ULL, usage.allocation_count());
+            }
+            ASSERT_EQ(0LL, usage.held_byte_count());
+            ASSERT_EQ(8 * bytes_per_uint64, usage.peak_byte_count());
+
+            // Reused from the pool, still handed out again
+            auto ptr(allocate_uint(5, pool));
+            ASSERT_EQ(13 * bytes_per_uint64, usage.allocated_byte_count());
+
+            // Taken before the guard, given back under it
+            before.release();
+            ASSERT_EQ(1 * bytes_per_uint64, usage.held_byte_count());
+        }
+        auto after(allocate_uint(6, pool));
+        ASSERT_EQ(13 * bytes_per_uint64, usage.allocated_byte_count());
+        ASSERT_EQ(3ULL, usage.allocation_count());
+        ASSERT_EQ(8 * bytes_per_uint64, usage.peak_byte_count());
+
+        // Across threads
+        MemoryUsage shared;
+        auto work = [&] {
+            MemoryUsageGuard guard(&shared);
+            auto ptr(allocate_uint(2, MemoryPoolHandle::ThreadLocal()));
+        };
+        thread t1(work), t2(work);
+        t1.join();
+        t2.join();
+        ASSERT_EQ(4 * bytes_per_uint64, shared.allocated_byte_count());
+        ASSERT_EQ(0LL, shared.held_byte_count());
+    }
 } // namespace sealtest
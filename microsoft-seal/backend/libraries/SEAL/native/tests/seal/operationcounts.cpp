@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/batchencoder.h"
+#include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
+#include "seal/keygenerator.h"
+#include "seal/modulus.h"
+#include "seal/operationcounts.h"
+#include "seal/util/ntt.h"
+#include "seal/util/polycore.h"
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace seal;
+using namespace seal::util;
+using namespace std;
+
+namespace sealtest
+{
+    TEST(OperationCountsTest, CountsAttachedThread)
+    {
+#ifndef SEAL_USE_OPERATION_COUNTS
+        GTEST_SKIP() << "built without SEAL_USE_OPERATION_COUNTS";
+#endif
+        MemoryPoolHandle pool = MemoryPoolHandle::New();
+        int coeff_count_power = 10;
+        size_t coeff_count = size_t(1) << coeff_count_power;
+        vector<Modulus> modulus = CoeffModulus::Create(coeff_count, { 30, 30, 30 });
+        Pointer<NTTTables> tables;
+        CreateNTTTables(coeff_count_power, modulus, tables, pool);
+        auto poly(allocate_zero_poly(coeff_count, modulus.size(), pool));
+        RNSIter poly_iter(poly.get(), coeff_count);
+
+        OperationCounts counts;
+        ntt_negacyclic_harvey(poly_iter, modulus.size(), iter(tables));
+        {
+            OperationCountsGuard guard(&counts);
+
+            // One count per prime, whichever kernel runs
+            ntt_negacyclic_harvey(poly_iter, modulus.size(), iter(tables));
+            ntt_negacyclic_harvey_lazy(poly_iter[0], 2, tables[0]);
+            inverse_ntt_negacyclic_harvey(poly_iter, modulus.size(), iter(tables));
+            ASSERT_EQ(5ULL, counts.forward_ntt_count());
+            ASSERT_EQ(3ULL, counts.inverse_ntt_count());
+            {
+                OperationCountsGuard detached(nullptr);
+                ntt_negacyclic_harvey(poly_iter, modulus.size(), iter(tables));
+                auto ignored(allocate_uint(4, pool));
+            }
+            auto ptr(allocate_uint(4, pool));
+            ASSERT_EQ(1ULL, counts.allocation_count());
+        }
+        ntt_negacyclic_harvey(poly_iter, modulus.size(), iter(tables));
+        ASSERT_EQ(5ULL, counts.forward_ntt_count());
+        ASSERT_EQ(0ULL, counts.key_switch_count());
+        ASSERT_EQ(0ULL, counts.base_conversion_count());
+
+        // Across threads
+        OperationCounts shared;
+        auto work = [&] {
+            OperationCountsGuard guard(&shared);
+            auto local(allocate_zero_poly(coeff_count, 1, MemoryPoolHandle::ThreadLocal()));
+            ntt_negacyclic_harvey(CoeffIter(local.get()), tables[0]);
+        };
+        thread t1(work), t2(work);
+        t1.join();
+        t2.join();
+        ASSERT_EQ(2ULL, shared.forward_ntt_count());
+        ASSERT_EQ(2ULL, shared.allocation_count());
+    }
+
+    TEST(OperationCountsTest, BFVEvaluator)
+    {
+#ifndef SEAL_USE_OPERATION_COUNTS
+        GTEST_SKIP() << "built without SEAL_USE_OPERATION_COUNTS";
+#endif
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(64);
+        parms.set_plain_modulus(PlainModulus::Batching(64, 20));
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 40, 40, 40 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        RelinKeys rlk;
+        keygen.create_relin_keys(rlk);
+        GaloisKeys gk;
+        keygen.create_galois_keys(vector<int>{ 1 }, gk);
+        BatchEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+        Decryptor decryptor(context, keygen.secret_key());
+
+        Plaintext plain;
+        encoder.encode(vector<uint64_t>(encoder.slot_count(), 3), plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        OperationCounts counts;
+        OperationCountsGuard guard(&counts);
+
+        // BFV multiplication converts both operands to the auxiliary base and back
+        evaluator.square_inplace(encrypted);
+        ASSERT_EQ(0ULL, counts.key_switch_count());
+        ASSERT_LT(0ULL, counts.base_conversion_count());
+        ASSERT_LT(0ULL, counts.forward_ntt_count());
+        ASSERT_LT(0ULL, counts.inverse_ntt_count());
+        ASSERT_LT(0ULL, counts.allocation_count());
+
+        evaluator.relinearize_inplace(encrypted, rlk);
+        ASSERT_EQ(1ULL, counts.key_switch_count());
+        evaluator.rotate_rows_inplace(encrypted, 1, gk);
+        ASSERT_EQ(2ULL, counts.key_switch_count());
+
+        // Hoisted rotations count one key switch each
+        vector<Ciphertext> rotated;
+        evaluator.rotate_many(encrypted, vector<int>{ 1, 1 }, gk, rotated);
+        ASSERT_EQ(4ULL, counts.key_switch_count());
+
+        uint64_t base_conversions = counts.base_conversion_count();
+        decryptor.decrypt(encrypted, plain);
+        ASSERT_LT(base_conversions, counts.base_conversion_count());
+        vector<uint64_t> values;
+        encoder.decode(plain, values);
+        ASSERT_EQ(9ULL, values[0]);
+    }
+} // namespace sealtest
@@ -0,0 +1,455 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/batchencoder.h"
+#include "seal/ckks.h"
+#include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
+#include "seal/keygenerator.h"
+#include "seal/operationcounts.h"
+#include "seal/parallel.h"
+#include "seal/randomgen.h"
+#include "seal/util/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace seal;
+using namespace seal::util;
+using namespace std;
+
+namespace sealtest
+{
+    namespace
+    {
+        class TestExecutor : public ParallelExecutor
+        {
+        public:
+            explicit TestExecutor(size_t thread_count)
+            {
+                for (size_t i = 0; i < thread_count; i++)
+                {
+                    threads_.emplace_back([this] { run(); });
+                }
+            }
+
+            ~TestExecutor() override
+            {
+                {
+                    lock_guard<mutex> lock(mutex_);
+                    stop_ = true;
+                }
+                cv_.notify_all();
+                for (auto &t : threads_)
+                {
+                    t.join();
+                }
+            }
+
+            void schedule(function<void()> task) override
+            {
+                {
+                    lock_guard<mutex> lock(mutex_);
+                    tasks_.push_back(move(task));
+                }
+                scheduled_++;
+                cv_.notify_one();
+            }
+
+            size_t concurrency() const override
+            {
+                return threads_.size();
+            }
+
+            size_t scheduled() const
+            {
+                return scheduled_;
+            }
+
+        private:
+            void run()
+            {
+                while (true)
+                {
+                    function<void()> task;
+                    {
+                        unique_lock<mutex> lock(mutex_);
+                        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                        if (tasks_.empty())
+                        {
+                            return;
+                        }
+                        task = move(tasks_.front());
+                        tasks_.pop_front();
+                    }
+                    task();
+                }
+            }
+
+            vector<thread> threads_;
+
+            mutex mutex_;
+
+            condition_variable cv_;
+
+            deque<function<void()>> tasks_;
+
+            atomic<size_t> scheduled_{ 0 };
+
+            bool stop_ = false;
+        };
+
+        // Installs an executor for the duration of a test
+        class ExecutorScope
+        {
+        public:
+            ExecutorScope(shared_ptr<ParallelExecutor> executor, size_t min_coeffs_per_task)
+            {
+                ParallelExecution::SetExecutor(move(executor), min_coeffs_per_task);
+            }
+
+            ~ExecutorScope()
+            {
+                ParallelExecution::SetExecutor(nullptr);
+            }
+        };
+    } // namespace
+
+    TEST(ParallelExecutionTest, Settings)
+    {
+        ASSERT_FALSE(ParallelExecution::GetExecutor());
+        ASSERT_EQ(ParallelExecution::default_min_coeffs_per_task, ParallelExecution::MinCoeffsPerTask());
+        ASSERT_EQ(1ULL, parallel_task_count(64, 1 << 16));
+        ASSERT_EQ(1ULL, parallel_task_count(64));
+
+        auto executor = make_shared<TestExecutor>(3);
+        ASSERT_THROW(ParallelExecution::SetExecutor(executor, 0), invalid_argument);
+        ASSERT_FALSE(ParallelExecution::GetExecutor());
+        {
+            ExecutorScope scope(executor, 4096);
+            ASSERT_EQ(executor, ParallelExecution::GetExecutor());
+            ASSERT_EQ(4096ULL, ParallelExecution::MinCoeffsPerTask());
+
+            // Not enough work, too few items, and capped at concurrency plus the calling thread
+            ASSERT_EQ(1ULL, parallel_task_count(3, 1024));
+            ASSERT_EQ(1ULL, parallel_task_count(1, 1 << 20));
+            ASSERT_EQ(2ULL, parallel_task_count(2, 8192));
+            ASSERT_EQ(3ULL, parallel_task_count(3, 4096));
+            ASSERT_EQ(4ULL, parallel_task_count(16, 8192));
+
+            // Items worth a task each, whatever the minimum
+            ASSERT_EQ(1ULL, parallel_task_count(1));
+            ASSERT_EQ(2ULL, parallel_task_count(2));
+            ASSERT_EQ(4ULL, parallel_task_count(16));
+
+            // Never nested
+            atomic<size_t> nested{ 0 };
+            parallel_for(8, 4, [&](size_t) { nested += parallel_task_count(16, 8192) + parallel_task_count(16); });
+            ASSERT_EQ(16ULL, nested.load());
+        }
+        ASSERT_FALSE(ParallelExecution::GetExecutor());
+        ASSERT_EQ(1ULL, parallel_task_count(16, 8192));
+    }
+
+    TEST(ParallelExecutionTest, ParallelFor)
+    {
+        auto executor = make_shared<TestExecutor>(3);
+        ExecutorScope scope(executor, 1);
+
+        for (size_t count : { 0, 1, 2, 7, 1000 })
+        {
+            vector<atomic<int>> hits(count);
+            parallel_for(count, 4, [&](size_t i) { hits[i]++; });
+            ASSERT_TRUE(all_of(hits.begin(), hits.end(), [](const atomic<int> &h) { return h == 1; }));
+        }
+        ASSERT_LT(0ULL, executor->scheduled());
+
+        // Every item still runs, and the first exception reaches the caller
+        atomic<size_t> calls{ 0 };
+        ASSERT_THROW(
+            parallel_for(
+                100, 4,
+                [&](size_t i) {
+                    calls++;
+                    if (i % 10 == 3)
+                    {
+                        throw logic_error("item");
+                    }
+                }),
+            logic_error);
+        ASSERT_EQ(100ULL, calls.load());
+
+        // Helper tasks allocate from their thread-local pool
+        MemoryPoolHandle pool = MemoryPoolHandle::New();
+        vector<MemoryPoolHandle> pools(64);
+        parallel_for(pools.size(), 4, [&](size_t i) { pools[i] = parallel_pool(pool); });
+        ASSERT_TRUE(all_of(pools.begin(), pools.end(), [](const MemoryPoolHandle &p) { return !!p; }));
+        ASSERT_TRUE(parallel_pool(pool) == pool);
+
+#ifdef SEAL_USE_OPERATION_COUNTS
+        // Helper tasks count for the OperationCounts of the calling thread, and only while they work for it
+        OperationCounts counts;
+        {
+            OperationCountsGuard guard(&counts);
+            parallel_for(64, 4, [&](size_t) { auto ptr(allocate_uint(1, parallel_pool(pool))); });
+        }
+        ASSERT_EQ(64ULL, counts.allocation_count());
+        parallel_for(64, 4, [&](size_t) { auto ptr(allocate_uint(1, parallel_pool(pool))); });
+        ASSERT_EQ(64ULL, counts.allocation_count());
+#endif
+    }
+
+    TEST(ParallelExecutionTest, BFVMatchesSequential)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(1024);
+        parms.set_plain_modulus(PlainModulus::Batching(1024, 20));
+        parms.set_coeff_modulus(CoeffModulus::Create(1024, { 30, 30, 30, 30 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        RelinKeys rlk;
+        keygen.create_relin_keys(rlk);
+        GaloisKeys glk;
+        keygen.create_galois_keys(vector<int>{ 1, 2 }, glk);
+
+        BatchEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+
+        vector<uint64_t> values(encoder.slot_count());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            values[i] = i;
+        }
+        Plaintext plain;
+        encoder.encode(values, plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        auto run = [&] {
+            Ciphertext result;
+            evaluator.square(encrypted, result);
+            evaluator.relinearize_inplace(result, rlk);
+            evaluator.rotate_rows_inplace(result, 1, glk);
+            evaluator.mod_switch_to_next_inplace(result);
+            return result;
+        };
+        auto run_many = [&] {
+            vector<Ciphertext> results;
+            evaluator.rotate_many(encrypted, { 1, 2 }, glk, results);
+            return results;
+        };
+
+        Ciphertext expected = run();
+        vector<Ciphertext> expected_many = run_many();
+        auto executor = make_shared<TestExecutor>(3);
+        ExecutorScope scope(executor, 1);
+        Ciphertext actual = run();
+        vector<Ciphertext> actual_many = run_many();
+
+        ASSERT_LT(0ULL, executor->scheduled());
+        ASSERT_EQ(expected.dyn_array().size(), actual.dyn_array().size());
+        ASSERT_TRUE(equal(expected.dyn_array().cbegin(), expected.dyn_array().cend(), actual.dyn_array().cbegin()));
+        for (size_t i = 0; i < expected_many.size(); i++)
+        {
+            auto &expected_data = expected_many[i].dyn_array();
+            ASSERT_TRUE(equal(expected_data.cbegin(), expected_data.cend(), actual_many[i].dyn_array().cbegin()));
+        }
+    }
+
+    TEST(ParallelExecutionTest, CKKSMatchesSequential)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        parms.set_poly_modulus_degree(1024);
+        parms.set_coeff_modulus(CoeffModulus::Create(1024, { 40, 30, 30, 40 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        RelinKeys rlk;
+        keygen.create_relin_keys(rlk);
+
+        CKKSEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Evaluator evaluator(context);
+
+        vector<double> values(encoder.slot_count(), 1.5);
+        Plaintext plain;
+        encoder.encode(values, pow(2.0, 30), plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        auto run = [&] {
+            Ciphertext result;
+            evaluator.multiply(encrypted, encrypted, result);
+            evaluator.relinearize_inplace(result, rlk);
+            evaluator.rescale_to_next_inplace(result);
+            return result;
+        };
+
+        Ciphertext expected = run();
+        auto executor = make_shared<TestExecutor>(3);
+        ExecutorScope scope(executor, 1);
+        Ciphertext actual = run();
+
+        ASSERT_LT(0ULL, executor->scheduled());
+        ASSERT_EQ(expected.dyn_array().size(), actual.dyn_array().size());
+        ASSERT_TRUE(equal(expected.dyn_array().cbegin(), expected.dyn_array().cend(), actual.dyn_array().cbegin()));
+    }
+
+    TEST(ParallelExecutionTest, KeyGenerationMatchesSequential)
+    {
+        // Fixed randomness, so that keys from two generators can be compared
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(1024);
+        parms.set_plain_modulus(PlainModulus::Batching(1024, 20));
+        parms.set_coeff_modulus(CoeffModulus::Create(1024, { 30, 30, 30, 30 }));
+        parms.set_random_generator(make_shared<Blake2xbPRNGFactory>(prng_seed_type{ 1, 2, 3, 4, 5, 6, 7, 8 }));
+
+        SEALContext context(parms, true, sec_level_type::none);
+        auto generate = [&](RelinKeys &rlk, GaloisKeys &glk) {
+            KeyGenerator keygen(context);
+            keygen.create_relin_keys(rlk);
+            keygen.create_galois_keys(vector<int>{ 1, 2, -1 }, glk);
+        };
+        auto same = [](const KSwitchKeys &expected, const KSwitchKeys &actual) {
+            if (expected.data().size() != actual.data().size())
+            {
+                return false;
+            }
+            for (size_t i = 0; i < expected.data().size(); i++)
+            {
+                if (expected.data()[i].size() != actual.data()[i].size())
+                {
+                    return false;
+                }
+                for (size_t j = 0; j < expected.data()[i].size(); j++)
+                {
+                    auto &expected_data = expected.data()[i][j].data().dyn_array();
+                    auto &actual_data = actual.data()[i][j].data().dyn_array();
+                    if (!equal(expected_data.cbegin(), expected_data.cend(), actual_data.cbegin(), actual_data.cend()))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+
+        RelinKeys expected_rlk;
+        GaloisKeys expected_glk;
+        generate(expected_rlk, expected_glk);
+        auto executor = make_shared<TestExecutor>(3);
+        ExecutorScope scope(executor, 1);
+        RelinKeys actual_rlk;
+        GaloisKeys actual_glk;
+        generate(actual_rlk, actual_glk);
+
+        ASSERT_LT(0ULL, executor->scheduled());
+        ASSERT_TRUE(same(expected_rlk, actual_rlk));
+        ASSERT_TRUE(same(expected_glk, actual_glk));
+        ASSERT_EQ(3ULL, actual_glk.size());
+    }
+
+    TEST(ParallelExecutionTest, MultiplyManyAndExponentiate)
+    {
+        auto test = [](scheme_type scheme) {
+            EncryptionParameters parms(scheme);
+            parms.set_poly_modulus_degree(2048);
+            parms.set_plain_modulus(PlainModulus::Batching(2048, 17));
+            // Depth 3 without modulus switching; BGV noise doubles in bits with each level
+            parms.set_coeff_modulus(CoeffModulus::Create(2048, vector<int>(7, 60)));
+
+            SEALContext context(parms, true, sec_level_type::none);
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            RelinKeys rlk;
+            keygen.create_relin_keys(rlk);
+
+            BatchEncoder encoder(context);
+            Encryptor encryptor(context, pk);
+            Evaluator evaluator(context);
+            Decryptor decryptor(context, keygen.secret_key());
+            uint64_t t = parms.plain_modulus().value();
+
+            // Six factors: the third level carries a product up unchanged
+            vector<Ciphertext> encrypteds(6);
+            vector<uint64_t> expected_product(encoder.slot_count(), 1);
+            for (size_t i = 0; i < encrypteds.size(); i++)
+            {
+                vector<uint64_t> values(encoder.slot_count());
+                for (size_t j = 0; j < values.size(); j++)
+                {
+                    values[j] = (i + j) % 7 + 1;
+                    expected_product[j] = expected_product[j] * values[j] % t;
+                }
+                Plaintext plain;
+                encoder.encode(values, plain);
+                encryptor.encrypt(plain, encrypteds[i]);
+            }
+            auto run = [&] {
+                vector<Ciphertext> results(4);
+                evaluator.multiply_many(encrypteds, rlk, results[0]);
+                for (uint64_t exponent = 5; exponent <= 7; exponent++)
+                {
+                    evaluator.exponentiate(encrypteds[0], exponent, rlk, results[exponent - 4]);
+                }
+                return results;
+            };
+
+            vector<Ciphertext> expected = run();
+            auto executor = make_shared<TestExecutor>(3);
+            ExecutorScope scope(executor, 1);
+            vector<Ciphertext> actual = run();
+
+            ASSERT_LT(0ULL, executor->scheduled());
+            for (size_t i = 0; i < expected.size(); i++)
+            {
+                auto &expected_data = expected[i].dyn_array();
+                ASSERT_EQ(2ULL, actual[i].size());
+                ASSERT_TRUE(equal(
+                    expected_data.cbegin(), expected_data.cend(), actual[i].dyn_array().cbegin(),
+                    actual[i].dyn_array().cend()));
+            }
+
+            Plaintext plain;
+            vector<uint64_t> values;
+            decryptor.decrypt(actual[0], plain);
+            encoder.decode(plain, values);
+            ASSERT_TRUE(values == expected_product);
+            for (uint64_t exponent = 5; exponent <= 7; exponent++)
+            {
+                decryptor.decrypt(actual[exponent - 4], plain);
+                encoder.decode(plain, values);
+                for (size_t j = 0; j < values.size(); j++)
+                {
+                    uint64_t base = j % 7 + 1;
+                    uint64_t power = 1;
+                    for (uint64_t k = 0; k < exponent; k++)
+                    {
+                        power = power * base % t;
+                    }
+                    ASSERT_EQ(power, values[j]);
+                }
+            }
+        };
+        test(scheme_type::bfv);
+        test(scheme_type::bgv);
+    }
+} // namespace sealtest
@@ -111,6 +111,21 @@ namespace sealtest
         ASSERT_TRUE(factory->use_random_seed());
     }
 
+    TEST(RandomGenerator, SetDefaultFactory)
+    {
+        auto original = UniformRandomGeneratorFactory::DefaultFactory();
+        ASSERT_THROW(UniformRandomGeneratorFactory::SetDefaultFactory(nullptr), invalid_argument);
+        ASSERT_EQ(original, UniformRandomGeneratorFactory::DefaultFactory());
+
+        shared_ptr<UniformRandomGeneratorFactory> factory(make_shared<AES128CTRPRNGFactory>());
+        UniformRandomGeneratorFactory::SetDefaultFactory(factory);
+        ASSERT_EQ(factory, UniformRandomGeneratorFactory::DefaultFactory());
+        ASSERT_EQ(prng_type::aes128ctr, UniformRandomGeneratorFactory::DefaultFactory()->create()->info().type());
+
+        UniformRandomGeneratorFactory::SetDefaultFactory(original);
+        ASSERT_EQ(original, UniformRandomGeneratorFactory::DefaultFactory());
+    }
+
     TEST(RandomGenerator, SequentialRandomGenerator)
     {
         unique_ptr<UniformRandomGenerator> sgen = make_unique<SequentialRandomGenerator>();
@@ -265,6 +280,21 @@ namespace sealtest
                 ASSERT_EQ(rg->generate(), rg2->generate());
             }
         }
+        {
+            shared_ptr<UniformRandomGenerator> rg(make_unique<AES128CTRPRNG>(seed_arr));
+            info = rg->info();
+
+            ASSERT_EQ(prng_type::aes128ctr, info.type());
+            ASSERT_TRUE(info.has_valid_prng_type());
+            ASSERT_EQ(seed_arr, info.seed());
+
+            auto rg2 = info.make_prng();
+            ASSERT_TRUE(rg2);
+            for (int i = 0; i < 2000; i++)
+            {
+                ASSERT_EQ(rg->generate(), rg2->generate());
+            }
+        }
         {
             shared_ptr<UniformRandomGenerator> rg(make_unique<SequentialRandomGenerator>(seed_arr));
             info = rg->info();
@@ -302,5 +332,12 @@ namespace sealtest
             info2.load(ss);
             ASSERT_TRUE(info == info2);
         }
+        {
+            shared_ptr<UniformRandomGenerator> rg(make_unique<AES128CTRPRNG>(seed_arr));
+            info = rg->info();
+            info.save(ss);
+            info2.load(ss);
+            ASSERT_TRUE(info == info2);
+        }
     }
 } // namespace sealtest
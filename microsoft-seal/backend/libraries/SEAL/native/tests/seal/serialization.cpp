@@ -62,6 +62,9 @@ namespace sealtest
         ASSERT_TRUE(Serialization::IsValidHeader(header));
 #endif
 
+        header.compr_mode = compr_mode_type::bitpack;
+        ASSERT_TRUE(Serialization::IsValidHeader(header));
+
         Serialization::SEALHeader invalid_header;
         invalid_header.magic = 0x1212;
         ASSERT_FALSE(Serialization::IsValidHeader(invalid_header));
@@ -70,7 +73,7 @@ namespace sealtest
         invalid_header.version_major = 0x02;
         ASSERT_FALSE(Serialization::IsValidHeader(invalid_header));
         invalid_header.version_major = SEAL_VERSION_MAJOR;
-        invalid_header.compr_mode = (compr_mode_type)0x03;
+        invalid_header.compr_mode = (compr_mode_type)0x04;
         ASSERT_FALSE(Serialization::IsValidHeader(invalid_header));
     }
 
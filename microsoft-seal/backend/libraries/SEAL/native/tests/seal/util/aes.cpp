@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/util/aes.h"
+#include "seal/util/aesni.h"
+#include "seal/util/cpufeatures.h"
+#include <cstdint>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace seal::util;
+using namespace std;
+
+namespace sealtest
+{
+    namespace util
+    {
+        namespace
+        {
+            // FIPS 197, Appendix C.1: the plaintext 00112233...eeff is the counter block of this counter and nonce
+            constexpr uint8_t kat_key[16] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                              0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+            constexpr uint64_t kat_counter = 0x7766554433221100;
+            constexpr uint64_t kat_nonce = 0xffeeddccbbaa9988;
+            constexpr uint8_t kat_ciphertext[16] = { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+                                                     0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a };
+        } // namespace
+
+        TEST(AESTest, ExpandKey)
+        {
+            // FIPS 197, Appendix A.1
+            uint8_t key[16] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+            uint8_t last[16] = { 0xd0, 0x14, 0xf9, 0xa8, 0xc9, 0xee, 0x25, 0x89,
+                                 0xe1, 0x3f, 0x0c, 0xc8, 0xb6, 0x63, 0x0c, 0xa6 };
+            AES128RoundKeys round_keys;
+            aes128_expand_key(key, round_keys);
+            ASSERT_TRUE(equal(key, key + 16, round_keys.begin()));
+            ASSERT_TRUE(equal(last, last + 16, round_keys.begin() + 160));
+        }
+
+        TEST(AESTest, CounterMode)
+        {
+            AES128RoundKeys round_keys;
+            aes128_expand_key(kat_key, round_keys);
+            uint8_t block[16];
+            aes128_ctr(round_keys, kat_nonce, kat_counter, 1, block);
+            ASSERT_TRUE(equal(kat_ciphertext, kat_ciphertext + 16, block));
+
+            // Block i of a run is the single block at counter + i, also across the 2^64 wrap
+            for (uint64_t counter : { kat_counter, ~uint64_t(0) - 5 })
+            {
+                size_t block_count = 19;
+                vector<uint8_t> run(16 * block_count);
+                aes128_ctr(round_keys, kat_nonce, counter, block_count, run.data());
+                for (size_t i = 0; i < block_count; i++)
+                {
+                    aes128_ctr(round_keys, kat_nonce, counter + i, 1, block);
+                    ASSERT_TRUE(equal(block, block + 16, run.begin() + 16 * i));
+                }
+                ASSERT_TRUE(equal(kat_ciphertext, kat_ciphertext + 16, run.begin()) == (counter == kat_counter));
+            }
+        }
+
+#ifdef SEAL_USE_AES_NI
+        TEST(AESTest, AESNICounterMode)
+        {
+            if (!use_aes_ni())
+            {
+                return;
+            }
+
+            AES128RoundKeys round_keys;
+            aes128_expand_key(kat_key, round_keys);
+            uint8_t block[16];
+            aesni::aes128_ctr(round_keys.data(), kat_nonce, kat_counter, 1, block);
+            ASSERT_TRUE(equal(kat_ciphertext, kat_ciphertext + 16, block));
+
+            // The eight-block loop and the tail must agree with single blocks
+            size_t block_count = 21;
+            vector<uint8_t> run(16 * block_count);
+            aesni::aes128_ctr(round_keys.data(), kat_nonce, kat_counter, block_count, run.data());
+            ASSERT_TRUE(equal(kat_ciphertext, kat_ciphertext + 16, run.begin()));
+            for (size_t i = 0; i < block_count; i++)
+            {
+                aesni::aes128_ctr(round_keys.data(), kat_nonce, kat_counter + i, 1, block);
+                ASSERT_TRUE(equal(block, block + 16, run.begin() + 16 * i));
+            }
+        }
+#endif
+    } // namespace util
+} // namespace sealtest
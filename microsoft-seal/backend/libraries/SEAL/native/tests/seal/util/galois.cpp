@@ -5,6 +5,7 @@
 #include "seal/memorymanager.h"
 #include "seal/util/galois.h"
 #include <stdexcept>
+#include <thread>
 #include <vector>
 #include "gtest/gtest.h"
 
@@ -111,5 +112,59 @@ namespace sealtest
                 ASSERT_EQ(out_true[i], out[i]);
             }
         }
+
+        TEST(GaloisToolTest, PrecomputeTablesNTT)
+        {
+            EncryptionParameters parms(scheme_type::ckks);
+            parms.set_poly_modulus_degree(8);
+            parms.set_coeff_modulus({ 17 });
+            SEALContext context(parms, false, sec_level_type::none);
+            auto galois_tool = context.key_context_data()->galois_tool();
+            ASSERT_THROW(galois_tool->precompute_tables_ntt({ 3, 4 }), invalid_argument);
+            ASSERT_THROW(galois_tool->precompute_tables_ntt({ 17 }), invalid_argument);
+            ASSERT_NO_THROW(galois_tool->precompute_tables_ntt({}));
+            ASSERT_NO_THROW(galois_tool->precompute_tables_ntt({ 3, 15 }));
+
+            uint64_t in[8]{ 0, 1, 2, 3, 4, 5, 6, 7 };
+            uint64_t out[8];
+            uint64_t out_true[8]{ 4, 5, 7, 6, 1, 0, 2, 3 };
+            galois_tool->apply_galois_ntt(in, 3, out);
+            for (size_t i = 0; i < 8; i++)
+            {
+                ASSERT_EQ(out_true[i], out[i]);
+            }
+
+            // Tables built lazily by concurrent first uses are the same as precomputed ones
+            SEALContext fresh(parms, false, sec_level_type::none);
+            auto fresh_tool = fresh.key_context_data()->galois_tool();
+            auto all_elts = fresh_tool->get_elts_all();
+            vector<thread> threads;
+            vector<vector<uint64_t>> results(4, vector<uint64_t>(8 * all_elts.size()));
+            for (size_t t = 0; t < results.size(); t++)
+            {
+                threads.emplace_back([&, t] {
+                    for (size_t e = 0; e < all_elts.size(); e++)
+                    {
+                        fresh_tool->apply_galois_ntt(in, all_elts[e], results[t].data() + 8 * e);
+                    }
+                });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+            galois_tool->precompute_tables_ntt(all_elts);
+            for (size_t e = 0; e < all_elts.size(); e++)
+            {
+                galois_tool->apply_galois_ntt(in, all_elts[e], out);
+                for (size_t t = 0; t < results.size(); t++)
+                {
+                    for (size_t i = 0; i < 8; i++)
+                    {
+                        ASSERT_EQ(out[i], results[t][8 * e + i]);
+                    }
+                }
+            }
+        }
     } // namespace util
 } // namespace sealtest
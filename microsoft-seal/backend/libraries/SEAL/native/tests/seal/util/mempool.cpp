@@ -3,12 +3,15 @@
 
 #include "seal/modulus.h"
 #include "seal/util/common.h"
+#include "seal/util/hugepages.h"
 #include "seal/util/mempool.h"
 #include "seal/util/ntt.h"
 #include "seal/util/pointer.h"
 #include "seal/util/uintcore.h"
 #include <algorithm>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 #include "gtest/gtest.h"
 
@@ -554,6 +557,81 @@ namespace sealtest
             }
         }
 
+        TEST(MemoryPoolTests, TestMemoryPoolArena)
+        {
+            {
+                MemoryPoolArena pool;
+                ASSERT_TRUE(0LL == pool.pool_count());
+                ASSERT_TRUE(0LL == pool.alloc_byte_count());
+
+                Pointer<uint64_t> pointer{ pool.get_for_byte_count(bytes_per_uint64 * 0) };
+                ASSERT_FALSE(pointer.is_set());
+                ASSERT_TRUE(0LL == pool.outstanding_count());
+
+                pointer = pool.get_for_byte_count(bytes_per_uint64 * 2);
+                uint64_t *allocation1 = pointer.get();
+                ASSERT_TRUE(pointer.is_set());
+                ASSERT_EQ(0ULL, reinterpret_cast<uintptr_t>(allocation1) % MemoryPoolArena::alignment);
+                ASSERT_TRUE(1LL == pool.outstanding_count());
+                ASSERT_THROW(pool.reset(), logic_error);
+                pointer.release();
+                ASSERT_TRUE(0LL == pool.outstanding_count());
+                ASSERT_TRUE(1LL == pool.pool_count());
+
+                // Released items are reused within a size class
+                pointer = pool.get_for_byte_count(bytes_per_uint64 * 2);
+                ASSERT_TRUE(allocation1 == pointer.get());
+                Pointer<uint64_t> pointer2 = pool.get_for_byte_count(bytes_per_uint64 * 2);
+                ASSERT_FALSE(allocation1 == pointer2.get());
+                Pointer<uint64_t> pointer3 = pool.get_for_byte_count(bytes_per_uint64 * 1);
+                ASSERT_FALSE(allocation1 == pointer3.get());
+                ASSERT_TRUE(2LL == pool.pool_count());
+                ASSERT_TRUE(3LL == pool.outstanding_count());
+                pointer.release();
+                pointer2.release();
+                pointer3.release();
+
+                // Growth adds blocks; reset merges them into one of the same total size
+                vector<Pointer<seal_byte>> pointers;
+                for (size_t i = 0; i < 10; i++)
+                {
+                    pointers.push_back(pool.get_for_byte_count(1000));
+                }
+                ASSERT_THROW(pool.reset(), logic_error);
+                pointers.clear();
+                size_t alloc_byte_count = pool.alloc_byte_count();
+                ASSERT_TRUE(10000ULL < alloc_byte_count);
+                pool.reset();
+                ASSERT_EQ(alloc_byte_count, pool.alloc_byte_count());
+                ASSERT_TRUE(3LL == pool.pool_count());
+
+                // After a reset the same workload runs from the start of the merged block
+                pointer = pool.get_for_byte_count(bytes_per_uint64 * 2);
+                allocation1 = pointer.get();
+                pointer.release();
+                for (size_t i = 0; i < 10; i++)
+                {
+                    pointers.push_back(pool.get_for_byte_count(1000));
+                }
+                pointers.clear();
+                ASSERT_EQ(alloc_byte_count, pool.alloc_byte_count());
+                pool.reset();
+                pointer = pool.get_for_byte_count(bytes_per_uint64 * 2);
+                ASSERT_TRUE(allocation1 == pointer.get());
+                pointer.release();
+            }
+            {
+                MemoryPoolArena pool(4096, true);
+                ASSERT_TRUE(4096LL == pool.alloc_byte_count());
+                Pointer<seal_byte> pointer = pool.get_for_byte_count(100);
+                ASSERT_TRUE(4096LL == pool.alloc_byte_count());
+                pointer.release();
+                pool.reset();
+                ASSERT_TRUE(4096LL == pool.alloc_byte_count());
+                ASSERT_THROW(MemoryPoolArena(MemoryPool::max_batch_alloc_byte_count + 1), invalid_argument);
+            }
+        }
+
         TEST(MemoryPoolTests, Allocate)
         {
             MemoryPool &pool = *global_variables::global_memory_pool;
@@ -561,5 +639,164 @@ namespace sealtest
             auto ptr = allocate(bytes.begin(), bytes.size(), pool);
             ASSERT_TRUE(equal(bytes.begin(), bytes.end(), ptr.get()));
         }
+
+        namespace
+        {
+            void check_trim(MemoryPool &pool)
+            {
+                ASSERT_EQ(0ULL, pool.trim());
+                {
+                    // Grow one size class to several blocks, then keep one item in use
+                    vector<Pointer<seal_byte>> items;
+                    for (int i = 0; i < 10; i++)
+                    {
+                        items.push_back(pool.get_for_byte_count(4096));
+                    }
+                    auto other = pool.get_for_byte_count(64);
+                    vector<MemoryPoolSizeClass> classes = pool.size_classes();
+                    ASSERT_EQ(2ULL, classes.size());
+                    ASSERT_EQ(4096ULL, classes[0].item_byte_count);
+                    ASSERT_EQ(10ULL, classes[0].item_count);
+                    ASSERT_EQ(0ULL, classes[0].free_item_count);
+                    ASSERT_EQ(4ULL, classes[0].block_count);
+                    ASSERT_EQ(64ULL, classes[1].item_byte_count);
+
+                    Pointer<seal_byte> kept = move(items.back());
+                    items.clear();
+                    ASSERT_EQ(9ULL, pool.size_classes()[0].free_item_count);
+
+                    // Blocks 1, 2 and 3 (1 + 2 + 3 items) are unused; the last block holds the kept item
+                    size_t alloc_byte_count = pool.alloc_byte_count();
+                    ASSERT_EQ(6ULL * 4096, pool.trim());
+                    ASSERT_EQ(alloc_byte_count - 6 * 4096, pool.alloc_byte_count());
+                    classes = pool.size_classes();
+                    ASSERT_EQ(4ULL, classes[0].item_count);
+                    ASSERT_EQ(3ULL, classes[0].free_item_count);
+                    ASSERT_EQ(1ULL, classes[0].block_count);
+                    ASSERT_EQ(1ULL, classes[1].block_count);
+                    ASSERT_EQ(0ULL, pool.trim());
+
+                    // Freed memory is not handed out again; the remaining free items are
+                    fill_n(kept.get(), 4096, seal_byte(3));
+                    for (int i = 0; i < 3; i++)
+                    {
+                        items.push_back(pool.get_for_byte_count(4096));
+                    }
+                    ASSERT_EQ(1ULL, pool.size_classes()[0].block_count);
+                    items.clear();
+                }
+
+                // With nothing in use, every block goes and the pool grows again from one item
+                pool.trim();
+                ASSERT_EQ(0ULL, pool.alloc_byte_count());
+                ASSERT_EQ(2ULL, pool.pool_count());
+                auto again = pool.get_for_byte_count(4096);
+                ASSERT_EQ(4096ULL, pool.alloc_byte_count());
+                ASSERT_EQ(1ULL, pool.size_classes()[0].block_count);
+            }
+
+            void check_byte_count_limit(MemoryPool &pool)
+            {
+                pool.set_byte_count_limit(3 * 4096);
+                ASSERT_EQ(3ULL * 4096, pool.byte_count_limit());
+                vector<Pointer<seal_byte>> items;
+                for (int i = 0; i < 5; i++)
+                {
+                    items.push_back(pool.get_for_byte_count(4096));
+                    fill_n(items.back().get(), 4096, seal_byte(i));
+                }
+
+                // One block of one item and one of two; three more items would exceed the limit
+                ASSERT_EQ(3ULL * 4096, pool.alloc_byte_count());
+                ASSERT_EQ(2ULL, pool.unpooled_count());
+                for (int i = 0; i < 5; i++)
+                {
+                    ASSERT_EQ(seal_byte(i), items[i].get()[4095]);
+                }
+
+                // Unpooled items are freed on release instead of joining the free list
+                items.clear();
+                ASSERT_EQ(3ULL, pool.size_classes()[0].free_item_count);
+                ASSERT_EQ(3ULL * 4096, pool.trim());
+
+                pool.set_byte_count_limit(numeric_limits<size_t>::max());
+                for (int i = 0; i < 5; i++)
+                {
+                    items.push_back(pool.get_for_byte_count(4096));
+                }
+                ASSERT_EQ(2ULL, pool.unpooled_count());
+            }
+        } // namespace
+
+        TEST(MemoryPoolTests, Trim)
+        {
+            MemoryPoolMT pool_mt;
+            check_trim(pool_mt);
+            MemoryPoolST pool_st;
+            check_trim(pool_st);
+
+            // Cleared pools clear what they free
+            MemoryPoolMT pool_clear(true);
+            check_trim(pool_clear);
+        }
+
+        TEST(MemoryPoolTests, ByteCountLimit)
+        {
+            MemoryPoolMT pool_mt;
+            check_byte_count_limit(pool_mt);
+            MemoryPoolST pool_st(true);
+            check_byte_count_limit(pool_st);
+
+            MemoryPoolArena arena;
+            ASSERT_THROW(arena.set_byte_count_limit(0), logic_error);
+            ASSERT_EQ(0ULL, arena.trim());
+        }
+
+#ifdef __linux__
+        TEST(MemoryPoolTests, HugePages)
+        {
+            HugePageConfig config;
+            config.mode = huge_page_mode::transparent;
+            config.min_byte_count = 1 << 20;
+            config.numa_local = true;
+            set_huge_page_config(config);
+            HugePageStats before = huge_page_stats();
+            {
+                // Small items keep the ordinary allocator; 3 MiB are mapped as two 2 MiB pages
+                MemoryPoolMT pool;
+                auto small = pool.get_for_byte_count(1000);
+                ASSERT_EQ(before.transparent_byte_count, huge_page_stats().transparent_byte_count);
+                auto large = pool.get_for_byte_count(3 << 20);
+                ASSERT_EQ(before.transparent_byte_count + (4 << 20), huge_page_stats().transparent_byte_count);
+                ASSERT_EQ(0, reinterpret_cast<uintptr_t>(large.get()) & 63);
+                fill_n(large.get(), 3 << 20, seal_byte(7));
+                ASSERT_EQ(seal_byte(7), large.get()[(3 << 20) - 1]);
+
+                MemoryPoolArena arena(2 << 20);
+                ASSERT_EQ(before.transparent_byte_count + (8 << 20), huge_page_stats().transparent_byte_count);
+            }
+            ASSERT_EQ(before.transparent_byte_count, huge_page_stats().transparent_byte_count);
+
+            // Explicit huge pages may not be reserved; then the allocation falls back but still succeeds
+            config.mode = huge_page_mode::hugetlb_1gb;
+            set_huge_page_config(config);
+            {
+                MemoryPoolST pool;
+                auto large = pool.get_for_byte_count(3 << 20);
+                fill_n(large.get(), 3 << 20, seal_byte(1));
+                HugePageStats during = huge_page_stats();
+                ASSERT_TRUE(
+                    during.hugetlb_1gb_page_count == before.hugetlb_1gb_page_count + 1 ||
+                    during.fallback_count == before.fallback_count + 1);
+            }
+            HugePageStats after = huge_page_stats();
+            ASSERT_EQ(before.transparent_byte_count, after.transparent_byte_count);
+            ASSERT_EQ(before.hugetlb_2mb_page_count, after.hugetlb_2mb_page_count);
+            ASSERT_EQ(before.hugetlb_1gb_page_count, after.hugetlb_1gb_page_count);
+
+            set_huge_page_config(HugePageConfig());
+            ASSERT_TRUE(huge_page_mode::none == huge_page_config().mode);
+        }
+#endif
     } // namespace util
 } // namespace sealtest
@@ -2,12 +2,16 @@
 // Licensed under the MIT license.
 
 #include "seal/modulus.h"
+#include "seal/util/cpufeatures.h"
 #include "seal/util/ntt.h"
+#include "seal/util/nttavx2.h"
+#include "seal/util/nttsve.h"
 #include "seal/util/numth.h"
 #include "seal/util/polycore.h"
 #include <cstddef>
 #include <cstdint>
 #include <random>
+#include <vector>
 #include "gtest/gtest.h"
 
 using namespace seal;
@@ -72,6 +76,61 @@ namespace sealtest
             ASSERT_EQ(748001537669050592ULL, tables->get_from_root_powers(3).operand);
         }
 
+        TEST(NTTTablesTest, NTTTablesCache)
+        {
+            MemoryPoolHandle pool = MemoryPoolHandle::New();
+            int coeff_count_power = 10;
+            vector<Modulus> modulus = CoeffModulus::Create(uint64_t(1) << coeff_count_power, { 30, 30, 30 });
+            ClearNTTTablesCache();
+            ASSERT_EQ(0ULL, NTTTablesCacheSize());
+
+            Pointer<NTTTables> tables;
+            CreateNTTTables(coeff_count_power, modulus, tables, pool);
+            ASSERT_EQ(3ULL, NTTTablesCacheSize());
+
+            // A prefix of the same primes, as for the next level of a modulus switching chain, hits the cache
+            Pointer<NTTTables> prefix_tables;
+            CreateNTTTables(coeff_count_power, { modulus[0], modulus[1] }, prefix_tables, pool);
+            ASSERT_EQ(3ULL, NTTTablesCacheSize());
+            CreateNTTTables(coeff_count_power - 1, { modulus[0] }, prefix_tables, pool);
+            ASSERT_EQ(4ULL, NTTTablesCacheSize());
+
+            // Copies out of the cache are equal to freshly generated tables and outlive the cache entries
+            ClearNTTTablesCache();
+            for (size_t i = 0; i < modulus.size(); i++)
+            {
+                NTTTables fresh(coeff_count_power, modulus[i], pool);
+                ASSERT_EQ(fresh.get_root(), tables[i].get_root());
+                ASSERT_EQ(fresh.inv_degree_modulo().operand, tables[i].inv_degree_modulo().operand);
+                for (size_t j = 0; j < fresh.coeff_count(); j++)
+                {
+                    ASSERT_EQ(fresh.get_from_root_powers(j).operand, tables[i].get_from_root_powers(j).operand);
+                    ASSERT_EQ(
+                        fresh.get_from_inv_root_powers(j).operand, tables[i].get_from_inv_root_powers(j).operand);
+                }
+
+                vector<uint64_t> a(fresh.coeff_count());
+                for (size_t j = 0; j < a.size(); j++)
+                {
+                    a[j] = j;
+                }
+                vector<uint64_t> b = a;
+                ntt_negacyclic_harvey(a.data(), fresh);
+                ntt_negacyclic_harvey(b.data(), tables[i]);
+                ASSERT_EQ(a, b);
+                inverse_ntt_negacyclic_harvey(b.data(), tables[i]);
+                for (size_t j = 0; j < b.size(); j++)
+                {
+                    ASSERT_EQ(j, b[j]);
+                }
+            }
+            ASSERT_EQ(0ULL, NTTTablesCacheSize());
+
+            // Invalid moduli are rejected and not cached
+            ASSERT_THROW(CreateNTTTables(coeff_count_power, { Modulus(7) }, tables, pool), invalid_argument);
+            ASSERT_EQ(0ULL, NTTTablesCacheSize());
+        }
+
         TEST(NTTTablesTest, NegacyclicNTTTest)
         {
             MemoryPoolHandle pool = MemoryPoolHandle::Global();
@@ -131,5 +190,148 @@ namespace sealtest
                 ASSERT_EQ(temp[i], poly[i]);
             }
         }
+
+        TEST(NTTTablesTest, BatchedNegacyclicNTTTest)
+        {
+            // Transforming polynomials back to back must match transforming each one, tiles and remainder alike
+            MemoryPoolHandle pool = MemoryPoolHandle::Global();
+            mt19937_64 rng(7);
+            for (int coeff_count_power : { 1, 3, 6, 12 })
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                Modulus modulus = get_prime(2 * n, 50);
+                Pointer<NTTTables> tables;
+                ASSERT_NO_THROW(tables = allocate<NTTTables>(pool, coeff_count_power, modulus, pool));
+                for (size_t count : { 1, 3, 4, 9 })
+                {
+                    vector<uint64_t> expected(count * n);
+                    for (auto &coeff : expected)
+                    {
+                        coeff = rng() % modulus.value();
+                    }
+                    vector<uint64_t> actual = expected;
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        ntt_negacyclic_harvey(expected.data() + i * n, *tables);
+                    }
+                    ntt_negacyclic_harvey(actual.data(), count, *tables);
+                    ASSERT_EQ(expected, actual);
+
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        inverse_ntt_negacyclic_harvey_lazy(expected.data() + i * n, *tables);
+                    }
+                    inverse_ntt_negacyclic_harvey_lazy(actual.data(), count, *tables);
+                    ASSERT_EQ(expected, actual);
+
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        inverse_ntt_negacyclic_harvey(expected.data() + i * n, *tables);
+                    }
+                    inverse_ntt_negacyclic_harvey(actual.data(), count, *tables);
+                    ASSERT_EQ(expected, actual);
+                }
+            }
+        }
+
+#ifdef SEAL_USE_AVX2
+        TEST(NTTTablesTest, AVX2NegacyclicNTTTest)
+        {
+            if (!use_avx2())
+            {
+                return;
+            }
+
+            // The AVX2 kernels must reproduce the portable lazy transforms bit for bit
+            MemoryPoolHandle pool = MemoryPoolHandle::Global();
+            mt19937_64 rng(42);
+            for (int coeff_count_power = 3; coeff_count_power <= 13; coeff_count_power++)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                for (int bit_size : { 20, 30, 40, 50, 60 })
+                {
+                    Modulus modulus = get_prime(2 * n, bit_size);
+                    Pointer<NTTTables> tables;
+                    ASSERT_NO_THROW(tables = allocate<NTTTables>(pool, coeff_count_power, modulus, pool));
+                    uint64_t p = modulus.value();
+
+                    // Forward: inputs in [0, 4p)
+                    vector<uint64_t> expected(n);
+                    for (auto &coeff : expected)
+                    {
+                        coeff = rng() % (4 * p);
+                    }
+                    vector<uint64_t> actual = expected;
+                    tables->ntt_handler().transform_to_rev(
+                        expected.data(), coeff_count_power, tables->get_from_root_powers());
+                    avx2::ntt_negacyclic_harvey_lazy(
+                        actual.data(), coeff_count_power, tables->get_from_root_powers(), p);
+                    ASSERT_EQ(expected, actual);
+
+                    // Inverse: inputs in [0, 2p)
+                    for (auto &coeff : expected)
+                    {
+                        coeff = rng() % (2 * p);
+                    }
+                    actual = expected;
+                    MultiplyUIntModOperand inv_degree = tables->inv_degree_modulo();
+                    tables->ntt_handler().transform_from_rev(
+                        expected.data(), coeff_count_power, tables->get_from_inv_root_powers(), &inv_degree);
+                    inverse_ntt_negacyclic_harvey_lazy(actual.data(), *tables);
+                    ASSERT_EQ(expected, actual);
+                }
+            }
+        }
+#endif
+
+#ifdef SEAL_USE_SVE
+        TEST(NTTTablesTest, SVENegacyclicNTTTest)
+        {
+            if (!use_sve())
+            {
+                return;
+            }
+
+            // The SVE kernels must reproduce the portable lazy transforms bit for bit, for any vector length
+            MemoryPoolHandle pool = MemoryPoolHandle::Global();
+            mt19937_64 rng(42);
+            for (int coeff_count_power = 1; coeff_count_power <= 13; coeff_count_power++)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                for (int bit_size : { 20, 30, 40, 50, 60 })
+                {
+                    Modulus modulus = get_prime(2 * n, bit_size);
+                    Pointer<NTTTables> tables;
+                    ASSERT_NO_THROW(tables = allocate<NTTTables>(pool, coeff_count_power, modulus, pool));
+                    uint64_t p = modulus.value();
+
+                    // Forward: inputs in [0, 4p)
+                    vector<uint64_t> expected(n);
+                    for (auto &coeff : expected)
+                    {
+                        coeff = rng() % (4 * p);
+                    }
+                    vector<uint64_t> actual = expected;
+                    tables->ntt_handler().transform_to_rev(
+                        expected.data(), coeff_count_power, tables->get_from_root_powers());
+                    sve::ntt_negacyclic_harvey_lazy(
+                        actual.data(), coeff_count_power, tables->get_from_root_powers(), p);
+                    ASSERT_EQ(expected, actual);
+
+                    // Inverse: inputs in [0, 2p)
+                    for (auto &coeff : expected)
+                    {
+                        coeff = rng() % (2 * p);
+                    }
+                    actual = expected;
+                    MultiplyUIntModOperand inv_degree = tables->inv_degree_modulo();
+                    tables->ntt_handler().transform_from_rev(
+                        expected.data(), coeff_count_power, tables->get_from_inv_root_powers(), &inv_degree);
+                    inverse_ntt_negacyclic_harvey_lazy(actual.data(), *tables);
+                    ASSERT_EQ(expected, actual);
+                }
+            }
+        }
+#endif
     } // namespace util
 } // namespace sealtest
@@ -1,12 +1,21 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include "seal/util/cpufeatures.h"
 #include "seal/util/defines.h"
+#include "seal/util/numth.h"
+#include "seal/util/polyarithavx2.h"
+#include "seal/util/polyarithavx512.h"
 #include "seal/util/polyarithsmallmod.h"
+#include "seal/util/polyarithsve.h"
 #include "seal/util/polycore.h"
+#include "seal/util/uintarith.h"
+#include "seal/util/uintarithsmallmod.h"
 #include "seal/util/uintcore.h"
 #include <cstddef>
 #include <cstdint>
+#include <random>
+#include <vector>
 #include "gtest/gtest.h"
 
 using namespace seal;
@@ -245,6 +254,63 @@ namespace sealtest
             }
         }
 
+        TEST(PolyArithSmallMod, AddPolyCoeffModMany)
+        {
+            MemoryPool &pool = *global_variables::global_memory_pool;
+            {
+                SEAL_ALLOCATE_ZERO_GET_COEFF_ITER(poly1, 3, pool);
+                SEAL_ALLOCATE_ZERO_GET_COEFF_ITER(poly2, 3, pool);
+                SEAL_ALLOCATE_ZERO_GET_COEFF_ITER(poly3, 3, pool);
+                poly1[0] = 1;
+                poly1[1] = 3;
+                poly1[2] = 4;
+                poly2[0] = 1;
+                poly2[1] = 2;
+                poly2[2] = 4;
+                poly3[0] = 4;
+                poly3[1] = 0;
+                poly3[2] = 2;
+                Modulus mod(5);
+                const uint64_t *operands[]{ poly1.ptr(), poly2.ptr(), poly3.ptr() };
+                add_poly_coeffmod_many(operands, 1, 3, mod, poly1);
+                ASSERT_EQ(1ULL, poly1[0]);
+                ASSERT_EQ(3ULL, poly1[1]);
+                ASSERT_EQ(4ULL, poly1[2]);
+                add_poly_coeffmod_many(operands, 3, 3, mod, poly1);
+                ASSERT_EQ(1ULL, poly1[0]);
+                ASSERT_EQ(0ULL, poly1[1]);
+                ASSERT_EQ(0ULL, poly1[2]);
+            }
+            {
+                // Enough operands near a 61-bit modulus to need several intermediate reductions, and more
+                // coefficients than one accumulation block
+                Modulus mod(get_prime(2048, 61));
+                const size_t count = 100;
+                const size_t coeff_count = 2048 + 3;
+                random_device rd;
+                mt19937_64 rng(rd());
+                vector<vector<uint64_t>> polys(count, vector<uint64_t>(coeff_count));
+                vector<const uint64_t *> operands;
+                for (auto &poly : polys)
+                {
+                    for (auto &coeff : poly)
+                    {
+                        coeff = mod.value() - 1 - (rng() & 0xFF);
+                    }
+                    operands.push_back(poly.data());
+                }
+
+                vector<uint64_t> expected(polys[0]);
+                for (size_t k = 1; k < count; k++)
+                {
+                    add_poly_coeffmod(expected.data(), polys[k].data(), coeff_count, mod, expected.data());
+                }
+                vector<uint64_t> result(coeff_count);
+                add_poly_coeffmod_many(operands.data(), count, coeff_count, mod, result.data());
+                ASSERT_EQ(expected, result);
+            }
+        }
+
         TEST(PolyArithSmallMod, SubPolyCoeffMod)
         {
             MemoryPool &pool = *global_variables::global_memory_pool;
@@ -639,6 +705,86 @@ namespace sealtest
             }
         }
 
+        TEST(PolyArithSmallMod, DyadicProductAccumulateCoeffMod)
+        {
+            {
+                Modulus mod(13);
+                uint64_t poly1[]{ 1, 3, 4 };
+                uint64_t poly2[]{ 2, 3, 12 };
+                uint64_t acc[]{ 12, 0, 5 };
+                dyadic_product_accumulate_coeffmod(poly1, poly2, 3, mod, acc);
+                ASSERT_EQ(1ULL, acc[0]);
+                ASSERT_EQ(9ULL, acc[1]);
+                ASSERT_EQ(1ULL, acc[2]);
+            }
+            {
+                // More coefficients than one block, with a tail
+                Modulus mod(get_prime(2048, 61));
+                const size_t coeff_count = 2048 + 3;
+                mt19937_64 rng(7);
+                vector<uint64_t> poly1(coeff_count), poly2(coeff_count), acc(coeff_count), expected(coeff_count);
+                for (size_t i = 0; i < coeff_count; i++)
+                {
+                    poly1[i] = rng() % mod.value();
+                    poly2[i] = rng() % mod.value();
+                    acc[i] = i % 2 ? rng() % mod.value() : mod.value() - 1;
+                    expected[i] = multiply_add_uint_mod(poly1[i], poly2[i], acc[i], mod);
+                }
+                dyadic_product_accumulate_coeffmod(poly1.data(), poly2.data(), coeff_count, mod, acc.data());
+                ASSERT_EQ(expected, acc);
+            }
+        }
+
+        TEST(PolyArithSmallMod, DyadicProductCoeffModMany)
+        {
+            {
+                Modulus mod(13);
+                uint64_t poly1[]{ 1, 3, 4 };
+                uint64_t poly2[]{ 2, 3, 12 };
+                uint64_t poly3[]{ 12, 0, 5 };
+                const uint64_t *operands1[]{ poly1, poly2, poly3 };
+                const uint64_t *operands2[]{ poly2, poly3, poly1 };
+                uint64_t result[3];
+                dyadic_product_coeffmod_many(operands1, operands2, 1, 3, mod, result);
+                ASSERT_EQ(2ULL, result[0]);
+                ASSERT_EQ(9ULL, result[1]);
+                ASSERT_EQ(9ULL, result[2]);
+
+                // 1*2 + 2*12 + 12*1, 3*3 + 3*0 + 0*3, 4*12 + 12*5 + 5*4; result may alias an operand
+                dyadic_product_coeffmod_many(operands1, operands2, 3, 3, mod, poly1);
+                ASSERT_EQ(12ULL, poly1[0]);
+                ASSERT_EQ(9ULL, poly1[1]);
+                ASSERT_EQ(11ULL, poly1[2]);
+            }
+            {
+                // Enough products near a 61-bit modulus to need several intermediate reductions, and more
+                // coefficients than one accumulation block
+                Modulus mod(get_prime(2048, 61));
+                const size_t count = 50;
+                const size_t coeff_count = 2048 + 3;
+                mt19937_64 rng(11);
+                vector<vector<uint64_t>> polys1(count, vector<uint64_t>(coeff_count));
+                vector<vector<uint64_t>> polys2(count, vector<uint64_t>(coeff_count));
+                vector<const uint64_t *> operands1, operands2;
+                vector<uint64_t> expected(coeff_count, 0);
+                for (size_t k = 0; k < count; k++)
+                {
+                    for (size_t i = 0; i < coeff_count; i++)
+                    {
+                        polys1[k][i] = mod.value() - 1 - (rng() & 0xFF);
+                        polys2[k][i] = rng() % mod.value();
+                        expected[i] = multiply_add_uint_mod(polys1[k][i], polys2[k][i], expected[i], mod);
+                    }
+                    operands1.push_back(polys1[k].data());
+                    operands2.push_back(polys2[k].data());
+                }
+                vector<uint64_t> result(coeff_count);
+                dyadic_product_coeffmod_many(
+                    operands1.data(), operands2.data(), count, coeff_count, mod, result.data());
+                ASSERT_EQ(expected, result);
+            }
+        }
+
         TEST(PolyArithSmallMod, PolyInftyNormCoeffMod)
         {
             MemoryPool &pool = *global_variables::global_memory_pool;
@@ -880,5 +1026,170 @@ namespace sealtest
                 ASSERT_EQ(1ULL, result[1][1][3]);
             }
         }
+
+#ifdef SEAL_USE_AVX2
+        TEST(PolyArithSmallMod, AVX2ElementwiseCoeffMod)
+        {
+            if (!use_avx2())
+            {
+                return;
+            }
+
+            // Odd counts exercise the masked tail; moduli cover the smallest and largest supported bit counts
+            mt19937_64 rng(42);
+            vector<Modulus> moduli{ 2, 3, get_prime(8, 20), get_prime(8, 40), get_prime(8, 60), get_prime(8, 61) };
+            for (const Modulus &mod : moduli)
+            {
+                uint64_t p = mod.value();
+                for (size_t count : { 1, 3, 4, 7, 8, 9, 64, 1001 })
+                {
+                    vector<uint64_t> op1(count), op2(count), sum(count), diff(count), prod(count), actual(count);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        // Include the extreme values 0 and p - 1
+                        op1[i] = i % 5 ? rng() % p : (i % 2) * (p - 1);
+                        op2[i] = i % 7 ? rng() % p : (p - 1);
+                        sum[i] = add_uint_mod(op1[i], op2[i], mod);
+                        diff[i] = sub_uint_mod(op1[i], op2[i], mod);
+                    }
+                    avx2::add_poly_coeffmod(op1.data(), op2.data(), count, p, actual.data());
+                    ASSERT_EQ(sum, actual);
+                    avx2::sub_poly_coeffmod(op1.data(), op2.data(), count, p, actual.data());
+                    ASSERT_EQ(diff, actual);
+
+                    // Lazy sums of four operands, the most a 61-bit modulus allows below 2^63
+                    vector<uint64_t> lazy(op1), lazy_sum(count);
+                    avx2::add_poly_lazy(op2.data(), count, lazy.data());
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        ASSERT_EQ(op1[i] + op2[i], lazy[i]);
+                        lazy[i] += 2 * (p - 1);
+                        lazy_sum[i] = add_uint_mod(add_uint_mod(sum[i], p - 1, mod), p - 1, mod);
+                    }
+                    avx2::reduce_lazy_sum(lazy.data(), count, p, 4, actual.data());
+                    ASSERT_EQ(lazy_sum, actual);
+
+                    // The dyadic product also accepts lazy NTT outputs in [0, 4p)
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        op1[i] += (rng() % 4) * p;
+                        op2[i] = i % 3 ? op2[i] + (rng() % 4) * p : 4 * p - 1;
+                        prod[i] = multiply_uint_mod(op1[i], op2[i], mod);
+                    }
+                    uint64_t numerator[2]{ 0, 0 };
+                    uint64_t ratio[2]{ 0, 0 };
+                    numerator[(2 * mod.bit_count()) / 64] = uint64_t(1) << ((2 * mod.bit_count()) % 64);
+                    divide_uint128_inplace(numerator, p, ratio);
+                    avx2::dyadic_product_coeffmod(
+                        op1.data(), op2.data(), count, p, mod.bit_count(), ratio[0], actual.data());
+                    ASSERT_EQ(prod, actual);
+
+                    // Products added to reduced sums, with and without reduction
+                    vector<uint64_t> accumulated(sum), accumulated_lazy(sum);
+                    avx2::dyadic_product_accumulate_coeffmod(
+                        op1.data(), op2.data(), count, p, mod.bit_count(), ratio[0], accumulated.data());
+                    avx2::dyadic_product_lazy(
+                        op1.data(), op2.data(), count, p, mod.bit_count(), ratio[0], accumulated_lazy.data());
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        ASSERT_EQ(add_uint_mod(sum[i], prod[i], mod), accumulated[i]);
+                        ASSERT_EQ(sum[i] + prod[i], accumulated_lazy[i]);
+                    }
+                }
+            }
+        }
+#endif
+
+#ifdef SEAL_USE_AVX512
+        TEST(PolyArithSmallMod, AVX512ElementwiseCoeffMod)
+        {
+            if (!use_avx512())
+            {
+                return;
+            }
+
+            // Odd counts exercise the masked tail; moduli cover the smallest and largest supported bit counts
+            mt19937_64 rng(42);
+            vector<Modulus> moduli{ 2, 3, get_prime(8, 20), get_prime(8, 40), get_prime(8, 60), get_prime(8, 61) };
+            for (const Modulus &mod : moduli)
+            {
+                uint64_t p = mod.value();
+                for (size_t count : { 1, 3, 4, 7, 8, 9, 64, 1001 })
+                {
+                    vector<uint64_t> op1(count), op2(count), sum(count), diff(count), prod(count), actual(count);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        // Include the extreme values 0 and p - 1
+                        op1[i] = i % 5 ? rng() % p : (i % 2) * (p - 1);
+                        op2[i] = i % 7 ? rng() % p : (p - 1);
+                        sum[i] = add_uint_mod(op1[i], op2[i], mod);
+                        diff[i] = sub_uint_mod(op1[i], op2[i], mod);
+                    }
+                    avx512::add_poly_coeffmod(op1.data(), op2.data(), count, p, actual.data());
+                    ASSERT_EQ(sum, actual);
+                    avx512::sub_poly_coeffmod(op1.data(), op2.data(), count, p, actual.data());
+                    ASSERT_EQ(diff, actual);
+
+                    // Lazy sums of four operands, the most a 61-bit modulus allows below 2^63
+                    vector<uint64_t> lazy(op1), lazy_sum(count);
+                    avx512::add_poly_lazy(op2.data(), count, lazy.data());
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        ASSERT_EQ(op1[i] + op2[i], lazy[i]);
+                        lazy[i] += 2 * (p - 1);
+                        lazy_sum[i] = add_uint_mod(add_uint_mod(sum[i], p - 1, mod), p - 1, mod);
+                    }
+                    avx512::reduce_lazy_sum(lazy.data(), count, p, 4, actual.data());
+                    ASSERT_EQ(lazy_sum, actual);
+
+                    // The dyadic product also accepts lazy NTT outputs in [0, 4p)
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        op1[i] += (rng() % 4) * p;
+                        op2[i] = i % 3 ? op2[i] + (rng() % 4) * p : 4 * p - 1;
+                        prod[i] = multiply_uint_mod(op1[i], op2[i], mod);
+                    }
+                    uint64_t numerator[2]{ 0, 0 };
+                    uint64_t ratio[2]{ 0, 0 };
+                    numerator[(2 * mod.bit_count()) / 64] = uint64_t(1) << ((2 * mod.bit_count()) % 64);
+                    divide_uint128_inplace(numerator, p, ratio);
+                    avx512::dyadic_product_coeffmod(
+                        op1.data(), op2.data(), count, p, mod.bit_count(), ratio[0], actual.data());
+                    ASSERT_EQ(prod, actual);
+                }
+            }
+        }
+#endif
+
+#ifdef SEAL_USE_SVE
+        TEST(PolyArithSmallMod, SVEDyadicProductCoeffMod)
+        {
+            if (!use_sve())
+            {
+                return;
+            }
+
+            // Odd counts exercise the partial last vector
+            mt19937_64 rng(42);
+            for (int bit_size : { 20, 30, 40, 50, 60 })
+            {
+                Modulus mod = get_prime(8, bit_size);
+                uint64_t p = mod.value();
+                for (size_t count : { 1, 2, 3, 7, 64, 1001 })
+                {
+                    vector<uint64_t> op1(count), op2(count), expected(count), actual(count);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        op1[i] = rng() % p;
+                        op2[i] = rng() % p;
+                        expected[i] = multiply_uint_mod(op1[i], op2[i], mod);
+                    }
+                    sve::dyadic_product_coeffmod(
+                        op1.data(), op2.data(), count, p, mod.const_ratio()[0], mod.const_ratio()[1], actual.data());
+                    ASSERT_EQ(expected, actual);
+                }
+            }
+        }
+#endif
     } // namespace util
 } // namespace sealtest
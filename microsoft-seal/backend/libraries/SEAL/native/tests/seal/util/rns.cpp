@@ -2,10 +2,14 @@
 // Licensed under the MIT license.
 
 #include "seal/memorymanager.h"
+#include "seal/util/cpufeatures.h"
 #include "seal/util/numth.h"
 #include "seal/util/rns.h"
+#include "seal/util/rnsavx2.h"
+#include "seal/util/rnsavx512.h"
 #include "seal/util/uintarithmod.h"
 #include "seal/util/uintarithsmallmod.h"
+#include <random>
 #include <stdexcept>
 #include <vector>
 #include "gtest/gtest.h"
@@ -437,6 +441,219 @@ namespace sealtest
             }
         }
 
+#if defined(SEAL_USE_AVX2) || defined(SEAL_USE_AVX512)
+        namespace
+        {
+            // Checks a vectorized fast_convert_array kernel against the definition of the fast base conversion
+            template <typename Kernel>
+            void check_fast_convert_kernel(Kernel kernel, size_t block, size_t lanes)
+            {
+                auto pool = MemoryManager::GetPool();
+                mt19937_64 rng(42);
+                vector<pair<vector<Modulus>, vector<Modulus>>> bases{
+                    { { 3 }, { 2 } },
+                    { { 2, 3 }, { 3, 4, 5 } },
+                    { get_primes(1024, 60, 1), get_primes(1024, 61, 1) },
+                    { get_primes(1024, 60, 3), get_primes(1024, 61, 5) },
+                    { get_primes(1024, 40, 6), get_primes(2048, 61, 4) }
+                };
+                for (auto &base : bases)
+                {
+                    RNSBase ibase(base.first, pool);
+                    RNSBase obase(base.second, pool);
+                    size_t ibase_size = ibase.size();
+                    size_t obase_size = obase.size();
+
+                    vector<uint64_t> ibase_values, obase_values;
+                    for (size_t i = 0; i < ibase_size; i++)
+                    {
+                        ibase_values.push_back(ibase[i].value());
+                    }
+                    vector<MultiplyUIntModOperand> matrix;
+                    for (size_t j = 0; j < obase_size; j++)
+                    {
+                        obase_values.push_back(obase[j].value());
+                        for (size_t i = 0; i < ibase_size; i++)
+                        {
+                            MultiplyUIntModOperand entry;
+                            entry.set(
+                                modulo_uint(ibase.punctured_prod_array() + i * ibase_size, ibase_size, obase[j]),
+                                obase[j]);
+                            matrix.push_back(entry);
+                        }
+                    }
+
+                    // Partial and multiple blocks
+                    for (size_t count : { lanes, block, block + lanes, 3 * block - lanes })
+                    {
+                        vector<uint64_t> in(ibase_size * count), expected(obase_size * count, 0);
+                        for (size_t i = 0; i < ibase_size; i++)
+                        {
+                            uint64_t q = ibase[i].value();
+                            for (size_t k = 0; k < count; k++)
+                            {
+                                // Include the extreme values 0 and q - 1
+                                in[i * count + k] = k % 5 ? rng() % q : (k % 2) * (q - 1);
+                            }
+                        }
+                        for (size_t j = 0; j < obase_size; j++)
+                        {
+                            for (size_t k = 0; k < count; k++)
+                            {
+                                for (size_t i = 0; i < ibase_size; i++)
+                                {
+                                    uint64_t scaled = multiply_uint_mod(
+                                        in[i * count + k], ibase.inv_punctured_prod_mod_base_array()[i], ibase[i]);
+                                    expected[j * count + k] = multiply_add_uint_mod(
+                                        scaled, matrix[j * ibase_size + i].operand, expected[j * count + k],
+                                        obase[j]);
+                                }
+                            }
+                        }
+
+                        vector<uint64_t> actual(obase_size * count), temp(ibase_size * block);
+                        kernel(
+                            in.data(), ibase_values.data(), ibase.inv_punctured_prod_mod_base_array(), ibase_size,
+                            obase_values.data(), matrix.data(), obase_size, count, actual.data(), temp.data());
+                        ASSERT_EQ(expected, actual);
+
+                        // The dispatching BaseConverter must agree as well
+                        BaseConverter bct(ibase, obase, pool);
+                        fill(actual.begin(), actual.end(), 0);
+                        bct.fast_convert_array(ConstRNSIter(in.data(), count), RNSIter(actual.data(), count), pool);
+                        ASSERT_EQ(expected, actual);
+                    }
+                }
+            }
+        } // namespace
+#endif
+
+#ifdef SEAL_USE_AVX2
+        TEST(BaseConverterTest, AVX2ConvertArray)
+        {
+            if (!use_avx2())
+            {
+                return;
+            }
+            check_fast_convert_kernel(avx2::fast_convert_array, avx2::fast_convert_block_size, 4);
+        }
+#endif
+
+#ifdef SEAL_USE_AVX512
+        TEST(BaseConverterTest, AVX512ConvertArray)
+        {
+            if (!use_avx512())
+            {
+                return;
+            }
+            check_fast_convert_kernel(avx512::fast_convert_array, avx512::fast_convert_block_size, 8);
+        }
+#endif
+
+#if defined(SEAL_USE_AVX2) || defined(SEAL_USE_AVX512)
+        namespace
+        {
+            // Checks the vectorized steps of decrypt_scale_and_round and divide_and_round_q_last against the scalar
+            // functions the portable code uses
+            template <typename Multiply, typename ModuloAdd, typename SubMultiply, typename Decrypt>
+            void check_rns_step_kernels(
+                Multiply multiply, ModuloAdd modulo_add, SubMultiply sub_multiply, Decrypt decrypt, size_t lanes)
+            {
+                mt19937_64 rng(7);
+                size_t count = 16 * lanes;
+                vector<Modulus> moduli{ 2, 3, 65537, get_prime(1024, 40), get_prime(1024, 60), get_prime(1024, 61) };
+                for (const Modulus &modulus : moduli)
+                {
+                    uint64_t p = modulus.value();
+                    MultiplyUIntModOperand scalar;
+                    scalar.set(rng() % p, modulus);
+
+                    vector<uint64_t> in(count), sub(count), expected(count), actual(count);
+                    for (size_t k = 0; k < count; k++)
+                    {
+                        // Arbitrary 64-bit values, with the extremes 0 and 2^64 - 1
+                        in[k] = k % 7 ? rng() : (k % 2 ? ~uint64_t(0) : 0);
+                        expected[k] = multiply_uint_mod(in[k], scalar, modulus);
+                    }
+                    multiply(in.data(), count, scalar, p, actual.data());
+                    ASSERT_EQ(expected, actual);
+
+                    uint64_t addend = rng() % p;
+                    for (size_t k = 0; k < count; k++)
+                    {
+                        expected[k] = barrett_reduce_64(in[k], modulus) + addend;
+                    }
+                    modulo_add(in.data(), count, p, modulus.const_ratio()[1], addend, actual.data());
+                    ASSERT_EQ(expected, actual);
+
+                    for (size_t k = 0; k < count; k++)
+                    {
+                        in[k] = k % 7 ? rng() % p : (k % 2) * (p - 1);
+                        sub[k] = k % 5 ? rng() % (2 * p) : (k % 2) * (2 * p - 1);
+                        expected[k] = multiply_uint_mod(in[k] + 2 * p - sub[k], scalar, modulus);
+                    }
+                    sub_multiply(in.data(), sub.data(), count, 2 * p, scalar, p, actual.data());
+                    ASSERT_EQ(expected, actual);
+                }
+
+                // t and gamma as in RNSTool: a plain modulus of up to 60 bits and a 61-bit prime
+                Modulus gamma = get_prime(2048, 61);
+                uint64_t g = gamma.value();
+                for (const Modulus &t : { Modulus(2), Modulus(65537), get_prime(1024, 40), get_prime(1024, 60) })
+                {
+                    MultiplyUIntModOperand inv_gamma_mod_t;
+                    uint64_t inv;
+                    ASSERT_TRUE(try_invert_uint_mod(g % t.value(), t.value(), inv));
+                    inv_gamma_mod_t.set(inv, t);
+
+                    vector<uint64_t> t_part(count), gamma_part(count), expected(count), actual(count);
+                    for (size_t k = 0; k < count; k++)
+                    {
+                        t_part[k] = rng() % t.value();
+                        const uint64_t edges[] = { 0, g / 2, g / 2 + 1, g - 1 };
+                        gamma_part[k] = k % 3 ? rng() % g : edges[(k / 3) % 4];
+
+                        // The portable loop of RNSTool::decrypt_scale_and_round
+                        uint64_t r = gamma_part[k] > g / 2
+                                         ? add_uint_mod(t_part[k], barrett_reduce_64(g - gamma_part[k], t), t)
+                                         : sub_uint_mod(t_part[k], barrett_reduce_64(gamma_part[k], t), t);
+                        expected[k] = r ? multiply_uint_mod(r, inv_gamma_mod_t, t) : 0;
+                    }
+                    decrypt(
+                        t_part.data(), gamma_part.data(), count, t.value(), t.const_ratio()[1], g, inv_gamma_mod_t,
+                        actual.data());
+                    ASSERT_EQ(expected, actual);
+                }
+            }
+        } // namespace
+#endif
+
+#ifdef SEAL_USE_AVX2
+        TEST(RNSToolTest, AVX2DecryptAndDivideSteps)
+        {
+            if (!use_avx2())
+            {
+                return;
+            }
+            check_rns_step_kernels(
+                avx2::multiply_poly_scalar, avx2::modulo_poly_add_scalar, avx2::sub_multiply_scalar,
+                avx2::decrypt_scale_and_round, 4);
+        }
+#endif
+
+#ifdef SEAL_USE_AVX512
+        TEST(RNSToolTest, AVX512DecryptAndDivideSteps)
+        {
+            if (!use_avx512())
+            {
+                return;
+            }
+            check_rns_step_kernels(
+                avx512::multiply_poly_scalar, avx512::modulo_poly_add_scalar, avx512::sub_multiply_scalar,
+                avx512::decrypt_scale_and_round, 8);
+        }
+#endif
+
         TEST(RNSToolTest, Initialize)
         {
             auto pool = MemoryManager::GetPool();
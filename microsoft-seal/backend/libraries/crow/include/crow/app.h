@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <string>
 #include <functional>
@@ -399,6 +400,157 @@ namespace crow
             return res_stream_threshold_;
         }
 
+        /// \brief Set the largest request body (in bytes) Crow accepts (Default is unlimited)
+        ///
+        /// A request announcing a larger Content-Length is answered with 413 before its body is read; a chunked body that grows past the limit closes the connection.
+        self_t& max_body_size(uint64_t size)
+        {
+            max_body_size_ = size;
+            return *this;
+        }
+
+        /// \brief Get the largest request body (in bytes) Crow accepts
+        uint64_t max_body_size() const
+        {
+            return max_body_size_;
+        }
+
+        /// \brief Write request bodies over threshold bytes to temporary files in directory instead of memory (Default is never)
+        ///
+        /// A handler reads such a body mapped from its file through request::body_view(); request::body stays empty.
+        self_t& body_spill(uint64_t threshold, std::string directory)
+        {
+            body_spill_threshold_ = threshold;
+            body_spill_dir_ = std::move(directory);
+            return *this;
+        }
+
+        /// \brief Get the body size (in bytes) above which request bodies are written to files
+        uint64_t body_spill_threshold() const
+        {
+            return body_spill_threshold_;
+        }
+
+        /// \brief Get the directory of spilled request bodies
+        const std::string& body_spill_dir() const
+        {
+            return body_spill_dir_;
+        }
+
+        /// \brief Set the size (in bytes) of each connection's socket read buffer (Default is 4KiB)
+        ///
+        /// Larger buffers take large request bodies in fewer reads.
+        self_t& read_buffer_size(size_t size)
+        {
+            read_buffer_size_ = size ? size : 1;
+            return *this;
+        }
+
+        /// \brief Get the size (in bytes) of each connection's socket read buffer
+        size_t read_buffer_size() const
+        {
+            return read_buffer_size_;
+        }
+
+        /// \brief Set TCP_NODELAY on accepted connections (Default is off)
+        self_t& tcp_nodelay(bool enabled)
+        {
+            tcp_nodelay_ = enabled;
+            return *this;
+        }
+
+        /// \brief Whether accepted connections get TCP_NODELAY
+        bool tcp_nodelay() const
+        {
+            return tcp_nodelay_;
+        }
+
+        /// \brief Set SO_RCVBUF and SO_SNDBUF (in bytes) of accepted connections (0 keeps the system default)
+        self_t& socket_buffer_sizes(int receive, int send)
+        {
+            socket_receive_buffer_ = receive;
+            socket_send_buffer_ = send;
+            return *this;
+        }
+
+        /// \brief Get the SO_RCVBUF size (in bytes) of accepted connections (0: the system default)
+        int socket_receive_buffer() const
+        {
+            return socket_receive_buffer_;
+        }
+
+        /// \brief Get the SO_SNDBUF size (in bytes) of accepted connections (0: the system default)
+        int socket_send_buffer() const
+        {
+            return socket_send_buffer_;
+        }
+
+        /// \brief Set SO_REUSEPORT on the listening socket (Default is off)
+        ///
+        /// Lets several processes listen on the same port, with the kernel spreading connections over them.
+        self_t& reuse_port(bool enabled)
+        {
+            reuse_port_ = enabled;
+            return *this;
+        }
+
+        /// \brief Whether the listening socket gets SO_REUSEPORT
+        bool reuse_port() const
+        {
+            return reuse_port_;
+        }
+
+        /// \brief Serve HTTP/2 to clients that open a connection with its preface (h2c with prior knowledge)
+        ///
+        /// Only with CROW_ENABLE_HTTP2 (and nghttp2); on by default then.
+        self_t& http2(bool enabled)
+        {
+            http2_ = enabled;
+            return *this;
+        }
+
+        /// \brief Whether HTTP/2 connections are taken
+        bool http2() const
+        {
+            return http2_;
+        }
+
+        /// \brief Set the concurrent streams a client may open on one HTTP/2 connection (Default is 100)
+        self_t& http2_max_streams(uint32_t streams)
+        {
+            http2_max_streams_ = streams ? streams : 1;
+            return *this;
+        }
+
+        /// \brief Get the concurrent streams a client may open on one HTTP/2 connection
+        uint32_t http2_max_streams() const
+        {
+            return http2_max_streams_;
+        }
+
+        /// \brief Set the HTTP/2 flow-control windows (in bytes) of each stream and of a whole connection
+        ///
+        /// Clients send at most this much of a request body before the server acknowledges it (Default is 64KiB - 1
+        /// each, the protocol's). Windows of a request body's size upload it in one round trip.
+        self_t& http2_window_sizes(uint32_t stream, uint32_t connection)
+        {
+            http2_stream_window_ = std::min<uint32_t>(std::max<uint32_t>(stream, 65535), 0x7fffffff);
+            http2_connection_window_ = std::min<uint32_t>(std::max<uint32_t>(connection, 65535), 0x7fffffff);
+            return *this;
+        }
+
+        /// \brief Get the flow-control window (in bytes) of each HTTP/2 stream
+        uint32_t http2_stream_window() const
+        {
+            return http2_stream_window_;
+        }
+
+        /// \brief Get the flow-control window (in bytes) of each HTTP/2 connection
+        uint32_t http2_connection_window() const
+        {
+            return http2_connection_window_;
+        }
+
 
         self_t& register_blueprint(Blueprint& blueprint)
         {
@@ -450,6 +602,30 @@ namespace crow
         {
             return compression_used_;
         }
+
+        /// \brief Set the zlib level of compressed responses (Default is Z_DEFAULT_COMPRESSION; 1 is fastest)
+        self_t& compression_level(int level)
+        {
+            comp_level_ = level;
+            return *this;
+        }
+
+        int compression_level() const
+        {
+            return comp_level_;
+        }
+
+        /// \brief Set the smallest response body (in bytes) that is compressed (Default is 0)
+        self_t& compression_min_size(size_t size)
+        {
+            comp_min_size_ = size;
+            return *this;
+        }
+
+        size_t compression_min_size() const
+        {
+            return comp_min_size_;
+        }
 #endif
 
         /// \brief Apply blueprints
@@ -764,12 +940,26 @@ namespace crow
         std::string server_name_ = std::string("Crow/") + VERSION;
         std::string bindaddr_ = "0.0.0.0";
         size_t res_stream_threshold_ = 1048576;
+        uint64_t max_body_size_{UINT64_MAX};
+        uint64_t body_spill_threshold_{UINT64_MAX};
+        std::string body_spill_dir_;
+        size_t read_buffer_size_ = 4096;
+        bool tcp_nodelay_{false};
+        int socket_receive_buffer_{0};
+        int socket_send_buffer_{0};
+        bool reuse_port_{false};
+        bool http2_{true};
+        uint32_t http2_max_streams_{100};
+        uint32_t http2_stream_window_{65535};
+        uint32_t http2_connection_window_{65535};
         Router router_;
         bool static_routes_added_{false};
 
 #ifdef CROW_ENABLE_COMPRESSION
         compression::algorithm comp_algorithm_;
         bool compression_used_{false};
+        int comp_level_{Z_DEFAULT_COMPRESSION};
+        size_t comp_min_size_{0};
 #endif
 
         std::chrono::milliseconds tick_interval_;
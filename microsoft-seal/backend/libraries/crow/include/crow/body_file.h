@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace crow
+{
+    /// \brief A request body written to a temporary file instead of memory, and mapped read-only once complete.
+    ///
+    /// The file is unlinked as soon as it is created, so it never outlives the process and its disk space is freed
+    /// when the last request holding it is gone. Its pages are the kernel's page cache, which can write them back
+    /// and drop them under memory pressure, so a body of any size costs the process no resident memory of its own.
+    /// Not available on Windows, where bodies always stay in memory.
+    class body_file
+    {
+    public:
+        /// Create the file in directory; nullptr if that fails (or on Windows).
+        static std::shared_ptr<body_file> create(const std::string& directory)
+        {
+#ifdef _WIN32
+            (void)directory;
+            return nullptr;
+#else
+            std::string path = (directory.empty() ? std::string("/tmp") : directory) + "/crow-body-XXXXXX";
+            int fd = ::mkstemp(&path[0]);
+            if (fd < 0)
+                return nullptr;
+            ::unlink(path.c_str());
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            return std::shared_ptr<body_file>(new body_file(fd));
+#endif
+        }
+
+        ~body_file()
+        {
+#ifndef _WIN32
+            if (data_)
+                ::munmap(const_cast<char*>(data_), static_cast<size_t>(size_));
+            ::close(fd_);
+#endif
+        }
+
+        body_file(const body_file&) = delete;
+        body_file& operator=(const body_file&) = delete;
+
+        /// Write the next chunk of the body; false if the disk is full or the write fails.
+        bool append(const char* data, size_t size)
+        {
+#ifndef _WIN32
+            while (size > 0)
+            {
+                ssize_t written = ::write(fd_, data, size);
+                if (written < 0 && errno == EINTR)
+                    continue;
+                if (written <= 0)
+                    return false;
+                data += written;
+                size -= static_cast<size_t>(written);
+                size_ += static_cast<uint64_t>(written);
+            }
+            return true;
+#else
+            (void)data;
+            (void)size;
+            return false;
+#endif
+        }
+
+        /// Map the complete body for view(); false if it cannot be mapped.
+        bool map()
+        {
+#ifndef _WIN32
+            if (data_ || size_ == 0)
+                return true;
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_SHARED, fd_, 0);
+            if (mapped == MAP_FAILED)
+                return false;
+            ::madvise(mapped, static_cast<size_t>(size_), MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(mapped);
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /// The body, once mapped (empty before).
+        std::string_view view() const
+        {
+            return data_ ? std::string_view(data_, static_cast<size_t>(size_)) : std::string_view();
+        }
+
+        uint64_t size() const
+        {
+            return size_;
+        }
+
+    private:
+        explicit body_file(int fd):
+          fd_(fd)
+        {}
+
+        int fd_ = -1;
+        uint64_t size_ = 0;
+        const char* data_ = nullptr;
+    };
+} // namespace crow
@@ -194,6 +194,7 @@ namespace crow
         PROXY_AUTHENTICATION_REQUIRED = 407,
         CONFLICT                      = 409,
         GONE                          = 410,
+        PRECONDITION_FAILED           = 412,
         PAYLOAD_TOO_LARGE             = 413,
         UNSUPPORTED_MEDIA_TYPE        = 415,
         RANGE_NOT_SATISFIABLE         = 416,
@@ -1,6 +1,8 @@
 #ifdef CROW_ENABLE_COMPRESSION
 #pragma once
 
+#include <cctype>
+#include <cstdlib>
 #include <string>
 #include <zlib.h>
 
@@ -19,35 +21,24 @@ namespace crow // NOTE: Already documented in "crow/app.h"
             GZIP = 15 | 16,
         };
 
-        inline std::string compress_string(std::string const& str, algorithm algo)
+        /// Compress in one pass into an output sized by deflateBound(); an empty result means failure.
+        inline std::string compress_string(std::string const& str, algorithm algo, int level = Z_DEFAULT_COMPRESSION)
         {
             std::string compressed_str;
             z_stream stream{};
-            // Initialize with the default values
-            if (::deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, algo, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+            if (::deflateInit2(&stream, level, Z_DEFLATED, algo, 8, Z_DEFAULT_STRATEGY) == Z_OK)
             {
-                char buffer[8192];
+                compressed_str.resize(::deflateBound(&stream, static_cast<uLong>(str.size())));
 
-                stream.avail_in = str.size();
+                stream.avail_in = static_cast<uInt>(str.size());
                 // zlib does not take a const pointer. The data is not altered.
-                stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(str.c_str()));
+                stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(str.data()));
+                stream.avail_out = static_cast<uInt>(compressed_str.size());
+                stream.next_out = reinterpret_cast<Bytef*>(&compressed_str[0]);
 
-                int code = Z_OK;
-                do
-                {
-                    stream.avail_out = sizeof(buffer);
-                    stream.next_out = reinterpret_cast<Bytef*>(&buffer[0]);
-
-                    code = ::deflate(&stream, Z_FINISH);
-                    // Successful and non-fatal error code returned by deflate when used with Z_FINISH flush
-                    if (code == Z_OK || code == Z_STREAM_END)
-                    {
-                        std::copy(&buffer[0], &buffer[sizeof(buffer) - stream.avail_out], std::back_inserter(compressed_str));
-                    }
-
-                } while (code == Z_OK);
-
-                if (code != Z_STREAM_END)
+                if (str.size() == stream.avail_in && ::deflate(&stream, Z_FINISH) == Z_STREAM_END)
+                    compressed_str.resize(stream.total_out);
+                else
                     compressed_str.clear();
 
                 ::deflateEnd(&stream);
@@ -56,6 +47,44 @@ namespace crow // NOTE: Already documented in "crow/app.h"
             return compressed_str;
         }
 
+        /// Whether an Accept-Encoding header value allows a content coding ("gzip", "deflate"), directly or through "*", with a q-value above 0.
+        inline bool accepts(std::string const& accept_encoding, std::string const& coding)
+        {
+            bool named = false, named_ok = false, wildcard_ok = false;
+            size_t pos = 0;
+            while (pos < accept_encoding.size())
+            {
+                size_t end = accept_encoding.find(',', pos);
+                if (end == std::string::npos)
+                    end = accept_encoding.size();
+                std::string item = accept_encoding.substr(pos, end - pos);
+                pos = end + 1;
+
+                size_t semicolon = item.find(';');
+                std::string token = item.substr(0, semicolon);
+                token.erase(0, token.find_first_not_of(" \t"));
+                token.erase(token.find_last_not_of(" \t") + 1);
+                for (auto& c : token)
+                    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+                bool ok = true;
+                if (semicolon != std::string::npos)
+                {
+                    size_t q = item.find("q=", semicolon);
+                    if (q != std::string::npos)
+                        ok = std::strtod(item.c_str() + q + 2, nullptr) > 0;
+                }
+                if (token == coding)
+                {
+                    named = true;
+                    named_ok = ok;
+                }
+                else if (token == "*")
+                    wildcard_ok = ok;
+            }
+            return named ? named_ok : wildcard_ok;
+        }
+
         inline std::string decompress_string(std::string const& deflated_string)
         {
             std::string inflated_string;
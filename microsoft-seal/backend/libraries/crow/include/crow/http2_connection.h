@@ -0,0 +1,571 @@
+#pragma once
+
+#ifdef CROW_ENABLE_HTTP2
+
+#ifdef CROW_USE_BOOST
+#include <boost/asio.hpp>
+#else
+#ifndef ASIO_STANDALONE
+#define ASIO_STANDALONE
+#endif
+#include <asio.hpp>
+#endif
+
+#include <nghttp2/nghttp2.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "crow/common.h"
+#include "crow/compression.h"
+#include "crow/http_request.h"
+#include "crow/http_response.h"
+#include "crow/logging.h"
+#include "crow/middleware.h"
+#include "crow/middleware_context.h"
+#include "crow/query_string.h"
+#include "crow/task_timer.h"
+
+namespace crow
+{
+#ifdef CROW_USE_BOOST
+    namespace asio = boost::asio;
+    using error_code = boost::system::error_code;
+#else
+    using error_code = asio::error_code;
+#endif
+
+    /// The client connection preface of HTTP/2 (RFC 9113, 3.4), which a cleartext (h2c) client opens with.
+    constexpr char http2_preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+    constexpr size_t http2_preface_size = sizeof(http2_preface) - 1;
+
+    /// An HTTP/2 connection, handed over by a Connection that read the client preface.
+    ///
+    /// Framing, HPACK and flow control are nghttp2's. The session only runs on the
+    /// connection's own I/O context; every request (stream) runs its middlewares and
+    /// handler on an I/O context the server picks, the way an HTTP/1.1 request runs on
+    /// its connection's, so the streams of one connection are handled in parallel.
+    /// Responses go back to the connection's context to be framed.
+    template<typename Adaptor, typename Handler, typename... Middlewares>
+    class Http2Connection : public std::enable_shared_from_this<Http2Connection<Adaptor, Handler, Middlewares...>>
+    {
+        struct Stream
+        {
+            int32_t id;
+            request req;
+            response res;
+            detail::context<Middlewares...> ctx;
+            std::unique_ptr<routing_handle_result> found;
+            std::atomic<bool> closed{false}; ///< Reset by the client, or the connection is gone
+            bool too_large = false;
+            bool dispatched = false;
+            size_t sent = 0; ///< Response body bytes framed so far
+        };
+
+    public:
+        Http2Connection(Adaptor&& adaptor, Handler* handler, const std::string& server_name,
+                        std::tuple<Middlewares...>* middlewares, std::function<std::string()>& get_cached_date_str,
+                        detail::task_timer& task_timer, std::function<asio::io_context&()>& stream_context):
+          adaptor_(std::move(adaptor)),
+          handler_(handler),
+          server_name_(server_name),
+          middlewares_(middlewares),
+          get_cached_date_str_(get_cached_date_str),
+          task_timer_(task_timer),
+          stream_context_(stream_context)
+        {
+            buffer_.resize(handler->read_buffer_size());
+        }
+
+        ~Http2Connection()
+        {
+            if (session_) nghttp2_session_del(session_);
+        }
+
+        /// Start the session with the bytes read after the preface.
+        void start(const char* data, size_t size)
+        {
+            nghttp2_session_callbacks* callbacks;
+            nghttp2_session_callbacks_new(&callbacks);
+            nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, on_begin_headers);
+            nghttp2_session_callbacks_set_on_header_callback(callbacks, on_header);
+            nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, on_data_chunk);
+            nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, on_frame);
+            nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, on_stream_close);
+            nghttp2_option* option;
+            nghttp2_option_new(&option);
+            nghttp2_option_set_no_recv_client_magic(option, 1); // The Connection took the preface
+            const int created = nghttp2_session_server_new2(&session_, callbacks, this, option);
+            nghttp2_option_del(option);
+            nghttp2_session_callbacks_del(callbacks);
+            if (created != 0)
+            {
+                CROW_LOG_ERROR << "Could not start an HTTP/2 session: " << nghttp2_strerror(created);
+                close();
+                return;
+            }
+
+            const nghttp2_settings_entry settings[] = {
+              {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, handler_->http2_max_streams()},
+              {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, handler_->http2_stream_window()},
+            };
+            nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, settings, sizeof(settings) / sizeof(settings[0]));
+            nghttp2_session_set_local_window_size(session_, NGHTTP2_FLAG_NONE, 0,
+                                                  static_cast<int32_t>(handler_->http2_connection_window()));
+
+            try
+            {
+                remote_ip_address_ = adaptor_.remote_endpoint().address().to_string();
+            }
+            catch (const std::exception&)
+            {
+            }
+            if (receive(data, size))
+            {
+                start_deadline();
+                do_read();
+            }
+        }
+
+    private:
+        static Http2Connection* self_of(void* user_data)
+        {
+            return static_cast<Http2Connection*>(user_data);
+        }
+
+        static int on_begin_headers(nghttp2_session*, const nghttp2_frame* frame, void* user_data)
+        {
+            if (frame->hd.type != NGHTTP2_HEADERS || frame->headers.cat != NGHTTP2_HCAT_REQUEST)
+                return 0;
+            auto stream = std::make_shared<Stream>();
+            stream->id = frame->hd.stream_id;
+            self_of(user_data)->streams_[stream->id] = std::move(stream);
+            return 0;
+        }
+
+        static int on_header(nghttp2_session*, const nghttp2_frame* frame, const uint8_t* name, size_t name_size,
+                             const uint8_t* value, size_t value_size, uint8_t, void* user_data)
+        {
+            Stream* stream = self_of(user_data)->find(frame->hd.stream_id);
+            if (!stream)
+                return 0;
+            std::string key(reinterpret_cast<const char*>(name), name_size);
+            std::string text(reinterpret_cast<const char*>(value), value_size);
+            request& req = stream->req;
+            if (key == ":method")
+            {
+                try
+                {
+                    req.method = method_from_string(text.c_str());
+                }
+                catch (const std::runtime_error&)
+                {
+                    req.method = HTTPMethod::InternalMethodCount;
+                }
+            }
+            else if (key == ":path")
+            {
+                req.raw_url = std::move(text);
+                req.url = req.raw_url.substr(0, req.raw_url.find('?'));
+                req.url_params = query_string(req.raw_url);
+            }
+            else if (key == ":authority")
+            {
+                req.add_header("host", std::move(text));
+            }
+            else if (key[0] != ':')
+            {
+                if (key == "content-length" && std::strtoull(text.c_str(), nullptr, 10) > self_of(user_data)->handler_->max_body_size())
+                    stream->too_large = true;
+                req.add_header(std::move(key), std::move(text));
+            }
+            return 0;
+        }
+
+        static int on_data_chunk(nghttp2_session*, uint8_t, int32_t stream_id, const uint8_t* data, size_t size,
+                                 void* user_data)
+        {
+            Http2Connection* self = self_of(user_data);
+            Stream* stream = self->find(stream_id);
+            if (!stream || stream->too_large)
+                return 0;
+            // A body that cannot be spilled is turned away as one over the limit
+            const uint64_t received = stream->req.body_spill ? stream->req.body_spill->size() : stream->req.body.size();
+            bool accepted = received + size <= self->handler_->max_body_size();
+            if (accepted &&
+                !stream->req.append_body(reinterpret_cast<const char*>(data), size, self->handler_->body_spill_threshold(),
+                                         self->handler_->body_spill_dir()))
+            {
+                CROW_LOG_ERROR << "Could not write a request body to " << self->handler_->body_spill_dir();
+                accepted = false;
+            }
+            if (!accepted)
+            {
+                stream->too_large = true;
+                std::string().swap(stream->req.body);
+                stream->req.body_spill.reset();
+                self->dispatch(self->streams_[stream_id]); // 413 without reading the rest
+                return 0;
+            }
+            return 0;
+        }
+
+        static int on_frame(nghttp2_session*, const nghttp2_frame* frame, void* user_data)
+        {
+            if (frame->hd.type != NGHTTP2_HEADERS && frame->hd.type != NGHTTP2_DATA)
+                return 0;
+            Http2Connection* self = self_of(user_data);
+            auto found = self->streams_.find(frame->hd.stream_id);
+            if (found == self->streams_.end())
+                return 0;
+            // Complete, or announced too large by its headers (answered 413 without reading the body)
+            if ((frame->hd.flags & NGHTTP2_FLAG_END_STREAM) || found->second->too_large)
+                self->dispatch(found->second);
+            return 0;
+        }
+
+        static int on_stream_close(nghttp2_session*, int32_t stream_id, uint32_t, void* user_data)
+        {
+            Http2Connection* self = self_of(user_data);
+            auto found = self->streams_.find(stream_id);
+            if (found != self->streams_.end())
+            {
+                found->second->closed = true;
+                self->streams_.erase(found);
+            }
+            return 0;
+        }
+
+        static ssize_t read_body(nghttp2_session*, int32_t, uint8_t* buf, size_t length, uint32_t* data_flags,
+                                 nghttp2_data_source* source, void*)
+        {
+            Stream* stream = static_cast<Stream*>(source->ptr);
+            const std::string& body = stream->res.body;
+            const size_t count = std::min(length, body.size() - stream->sent);
+            std::memcpy(buf, body.data() + stream->sent, count);
+            stream->sent += count;
+            if (stream->sent == body.size())
+                *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+            return static_cast<ssize_t>(count);
+        }
+
+        Stream* find(int32_t stream_id)
+        {
+            auto found = streams_.find(stream_id);
+            return found == streams_.end() ? nullptr : found->second.get();
+        }
+
+        /// Hand a complete request to an I/O context of the server, the way Connection::handle runs one.
+        void dispatch(const std::shared_ptr<Stream>& stream)
+        {
+            if (stream->dispatched)
+                return;
+            stream->dispatched = true;
+            request& req = stream->req;
+            if (!stream->too_large && !req.finish_body())
+            {
+                CROW_LOG_ERROR << "Could not map a spilled request body";
+                stream->too_large = true;
+            }
+            asio::io_context& context = stream_context_();
+            req.http_ver_major = 2;
+            req.http_ver_minor = 0;
+            req.keep_alive = true;
+            req.close_connection = false;
+            req.upgrade = false;
+            req.remote_ip_address = remote_ip_address_;
+            req.middleware_context = static_cast<void*>(&stream->ctx);
+            req.middleware_container = static_cast<void*>(middlewares_);
+            req.io_context = &context;
+            Stream* raw = stream.get();
+            req.peer_closed = [raw] {
+                return raw->closed.load();
+            };
+
+            CROW_LOG_INFO << "Request: " << remote_ip_address_ << " " << this << " HTTP/2 stream " << stream->id << ' '
+                          << method_name(req.method) << " " << req.url;
+            auto self = this->shared_from_this();
+            asio::post(context, [self, stream] {
+                self->handle(stream);
+            });
+        }
+
+        void handle(const std::shared_ptr<Stream>& stream)
+        {
+            request& req = stream->req;
+            response& res = stream->res;
+            if (stream->too_large)
+            {
+                res = response(status::PAYLOAD_TOO_LARGE);
+                complete(stream, false);
+                return;
+            }
+            if (req.method >= HTTPMethod::InternalMethodCount || req.raw_url.empty())
+            {
+                res = response(status::BAD_REQUEST);
+                complete(stream, false);
+                return;
+            }
+            auto self = this->shared_from_this();
+            Stream* raw = stream.get();
+            res.is_alive_helper_ = [raw] {
+                return !raw->closed.load();
+            };
+            stream->found = handler_->handle_initial(req, res);
+            if (!stream->found->rule_index)
+            {
+                complete(stream, true);
+                return;
+            }
+            detail::middleware_call_helper<detail::middleware_call_criteria_only_global,
+                                           0, decltype(stream->ctx), decltype(*middlewares_)>({}, *middlewares_, req, res, stream->ctx);
+            if (!res.completed_)
+            {
+                res.complete_request_handler_ = [self, stream] {
+                    self->complete(stream, true);
+                };
+                handler_->handle(req, res, stream->found);
+            }
+            else
+            {
+                complete(stream, true);
+            }
+        }
+
+        /// Like Connection::complete_request up to the framing, which is left to the connection's context.
+        void complete(const std::shared_ptr<Stream>& stream, bool after_handlers)
+        {
+            request& req = stream->req;
+            response& res = stream->res;
+            res.is_alive_helper_ = nullptr;
+            if (after_handlers)
+            {
+                detail::after_handlers_call_helper<
+                  detail::middleware_call_criteria_only_global,
+                  (static_cast<int>(sizeof...(Middlewares)) - 1),
+                  decltype(stream->ctx),
+                  decltype(*middlewares_)>({}, *middlewares_, stream->ctx, req, res);
+            }
+            if (res.is_static_type() && res.file_info.statResult == 0)
+            {
+                std::ifstream file(res.file_info.path.c_str(), std::ios::in | std::ios::binary);
+                std::ostringstream contents;
+                contents << file.rdbuf();
+                res.body = contents.str();
+            }
+#ifdef CROW_ENABLE_COMPRESSION
+            if (res.compressed && handler_->compression_used() && !res.body.empty() &&
+                res.body.size() >= handler_->compression_min_size() && res.get_header_value("Content-Encoding").empty())
+            {
+                res.add_header("Vary", "Accept-Encoding");
+                std::string accept_encoding = req.get_header_value("Accept-Encoding");
+                const compression::algorithm preferred = handler_->compression_algorithm();
+                const compression::algorithm choices[] = {preferred, preferred == compression::GZIP ? compression::DEFLATE : compression::GZIP};
+                for (compression::algorithm algo : choices)
+                {
+                    const std::string coding = algo == compression::GZIP ? "gzip" : "deflate";
+                    if (accept_encoding.empty() || !compression::accepts(accept_encoding, coding))
+                        continue;
+                    std::string compressed = compression::compress_string(res.body, algo, handler_->compression_level());
+                    if (!compressed.empty() && compressed.size() < res.body.size())
+                    {
+                        res.body = std::move(compressed);
+                        res.set_header("Content-Encoding", coding);
+                    }
+                    break;
+                }
+            }
+#endif
+            CROW_LOG_INFO << "Response: " << this << ' ' << req.raw_url << ' ' << res.code << " (HTTP/2 stream " << stream->id << ')';
+            auto self = this->shared_from_this();
+            asio::post(adaptor_.get_io_context(), [self, stream] {
+                self->submit(stream);
+            });
+        }
+
+        /// Frame a finished response, unless its stream or the connection is gone meanwhile.
+        void submit(const std::shared_ptr<Stream>& stream)
+        {
+            auto found = streams_.find(stream->id);
+            if (closed_ || found == streams_.end() || found->second != stream)
+                return;
+            response& res = stream->res;
+            if (res.code >= 400 && res.body.empty())
+                res.body = std::to_string(res.code);
+
+            std::vector<std::pair<std::string, std::string>> fields;
+            fields.reserve(res.headers.size() + 4);
+            fields.emplace_back(":status", std::to_string(res.code));
+            for (const auto& header : res.headers)
+            {
+                std::string name = header.first;
+                std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+                    return static_cast<char>(std::tolower(c));
+                });
+                // Connection-specific fields are not allowed in HTTP/2 (RFC 9113, 8.2.2)
+                if (name == "connection" || name == "keep-alive" || name == "transfer-encoding" || name == "upgrade" ||
+                    name == "proxy-connection")
+                    continue;
+                fields.emplace_back(std::move(name), header.second);
+            }
+            if (!res.manual_length_header && !res.headers.count("content-length"))
+                fields.emplace_back("content-length", std::to_string(res.body.size()));
+            if (!res.headers.count("server"))
+                fields.emplace_back("server", server_name_);
+            if (!res.headers.count("date"))
+                fields.emplace_back("date", get_cached_date_str_());
+
+            std::vector<nghttp2_nv> nva;
+            nva.reserve(fields.size());
+            for (auto& field : fields)
+            {
+                nva.push_back({reinterpret_cast<uint8_t*>(&field.first[0]), reinterpret_cast<uint8_t*>(&field.second[0]),
+                               field.first.size(), field.second.size(), NGHTTP2_NV_FLAG_NONE});
+            }
+            nghttp2_data_provider provider;
+            provider.source.ptr = stream.get();
+            provider.read_callback = read_body;
+            nghttp2_submit_response(session_, stream->id, nva.data(), nva.size(), res.body.empty() ? nullptr : &provider);
+            flush();
+        }
+
+        /// Feed received bytes to the session; false (and the connection closed) on a protocol error.
+        bool receive(const char* data, size_t size)
+        {
+            const ssize_t consumed = nghttp2_session_mem_recv(session_, reinterpret_cast<const uint8_t*>(data), size);
+            if (consumed < 0)
+            {
+                CROW_LOG_DEBUG << this << " HTTP/2 error: " << nghttp2_strerror(static_cast<int>(consumed));
+                close();
+                return false;
+            }
+            flush();
+            return !closed_;
+        }
+
+        void do_read()
+        {
+            auto self = this->shared_from_this();
+            adaptor_.socket().async_read_some(
+              asio::buffer(buffer_),
+              [self](const error_code& ec, std::size_t bytes_transferred) {
+                  if (ec)
+                  {
+                      self->close();
+                      return;
+                  }
+                  if (self->receive(self->buffer_.data(), bytes_transferred))
+                  {
+                      self->start_deadline();
+                      self->do_read();
+                  }
+              });
+        }
+
+        /// Write what the session has to send, a batch at a time; closes once neither side wants more.
+        void flush()
+        {
+            if (writing_ || closed_)
+                return;
+            output_.clear();
+            for (;;)
+            {
+                const uint8_t* data;
+                const ssize_t size = nghttp2_session_mem_send(session_, &data);
+                if (size < 0)
+                {
+                    close();
+                    return;
+                }
+                if (size == 0)
+                    break;
+                output_.append(reinterpret_cast<const char*>(data), static_cast<size_t>(size));
+                if (output_.size() >= write_batch_size)
+                    break;
+            }
+            if (output_.empty())
+            {
+                if (!nghttp2_session_want_read(session_) && !nghttp2_session_want_write(session_))
+                    close();
+                return;
+            }
+            writing_ = true;
+            auto self = this->shared_from_this();
+            asio::async_write(
+              adaptor_.socket(), asio::buffer(output_),
+              [self](const error_code& ec, std::size_t /*bytes_transferred*/) {
+                  self->writing_ = false;
+                  if (ec)
+                  {
+                      self->close();
+                      return;
+                  }
+                  self->flush();
+              });
+        }
+
+        /// Close after the keep-alive timeout, unless streams are still open.
+        void start_deadline()
+        {
+            task_timer_.cancel(task_id_);
+            auto self = this->shared_from_this();
+            task_id_ = task_timer_.schedule([self] {
+                if (self->closed_)
+                    return;
+                if (self->streams_.empty())
+                {
+                    nghttp2_session_terminate_session(self->session_, NGHTTP2_NO_ERROR);
+                    self->flush();
+                    self->close();
+                }
+                else
+                {
+                    self->start_deadline();
+                }
+            });
+        }
+
+        void close()
+        {
+            if (closed_)
+                return;
+            closed_ = true;
+            task_timer_.cancel(task_id_);
+            for (auto& stream : streams_)
+                stream.second->closed = true;
+            adaptor_.shutdown_readwrite();
+            adaptor_.close();
+        }
+
+    private:
+        static constexpr size_t write_batch_size = 256 * 1024;
+
+        Adaptor adaptor_;
+        Handler* handler_;
+        std::string server_name_;
+        std::tuple<Middlewares...>* middlewares_;
+        std::function<std::string()>& get_cached_date_str_;
+        detail::task_timer& task_timer_;
+        detail::task_timer::identifier_type task_id_{};
+        std::function<asio::io_context&()>& stream_context_;
+
+        nghttp2_session* session_ = nullptr;
+        std::map<int32_t, std::shared_ptr<Stream>> streams_;
+        std::vector<char> buffer_;
+        std::string output_;
+        std::string remote_ip_address_;
+        bool writing_ = false;
+        bool closed_ = false;
+    };
+} // namespace crow
+
+#endif
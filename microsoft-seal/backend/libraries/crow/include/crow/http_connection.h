@@ -11,11 +11,16 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <memory>
 #include <vector>
+#ifndef _WIN32
+#include <sys/socket.h>
+#endif
 
 #include "crow/http_parser_merged.h"
+#include "crow/http2_connection.h"
 #include "crow/common.h"
 #include "crow/compression.h"
 #include "crow/http_response.h"
@@ -57,7 +62,8 @@ namespace crow
           std::function<std::string()>& get_cached_date_str_f,
           detail::task_timer& task_timer,
           typename Adaptor::context* adaptor_ctx_,
-          std::atomic<unsigned int>& queue_length):
+          std::atomic<unsigned int>& queue_length,
+          std::function<asio::io_context&()>& stream_context):
           adaptor_(io_context, adaptor_ctx_),
           handler_(handler),
           parser_(this),
@@ -67,8 +73,11 @@ namespace crow
           get_cached_date_str(get_cached_date_str_f),
           task_timer_(task_timer),
           res_stream_threshold_(handler->stream_threshold()),
-          queue_length_(queue_length)
+          max_body_size_(handler->max_body_size()),
+          queue_length_(queue_length),
+          stream_context_(stream_context)
         {
+            buffer_.resize(handler->read_buffer_size());
 #ifdef CROW_ENABLE_DEBUG
             connectionCount++;
             CROW_LOG_DEBUG << "Connection (" << this << ") allocated, total: " << connectionCount;
@@ -89,12 +98,26 @@ namespace crow
             return adaptor_.raw_socket();
         }
 
+        /// Whether the client has closed its end: peeks without consuming, so pipelined requests stay queued.
+        bool peer_closed()
+        {
+#ifndef _WIN32
+            char byte;
+            ssize_t received = ::recv(adaptor_.raw_socket().native_handle(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+            if (received == 0) return true;
+            return received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+#else
+            return false;
+#endif
+        }
+
         void start()
         {
             auto self = this->shared_from_this();
             adaptor_.start([self](const error_code& ec) {
                 if (!ec)
                 {
+                    self->set_socket_options();
                     self->start_deadline();
                     self->parser_.clear();
 
@@ -107,6 +130,43 @@ namespace crow
             });
         }
 
+        /// Apply the handler's TCP options to the accepted socket; failures leave the system defaults.
+        void set_socket_options()
+        {
+            error_code ec;
+            auto& socket = adaptor_.raw_socket();
+            if (handler_->tcp_nodelay())
+                socket.set_option(asio::ip::tcp::no_delay(true), ec);
+            if (handler_->socket_receive_buffer() > 0)
+                socket.set_option(asio::socket_base::receive_buffer_size(handler_->socket_receive_buffer()), ec);
+            if (handler_->socket_send_buffer() > 0)
+                socket.set_option(asio::socket_base::send_buffer_size(handler_->socket_send_buffer()), ec);
+        }
+
+        uint64_t max_body_size() const
+        {
+            return max_body_size_;
+        }
+
+        uint64_t body_spill_threshold() const
+        {
+            return handler_->body_spill_threshold();
+        }
+
+        const std::string& body_spill_dir() const
+        {
+            return handler_->body_spill_dir();
+        }
+
+        /// Answer a request whose body is over max_body_size() without reading the body; the connection closes after.
+        void handle_body_too_large()
+        {
+            buffers_.clear();
+            static std::string payload_too_large = "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            buffers_.emplace_back(payload_too_large.data(), payload_too_large.size());
+            do_write_sync(buffers_);
+        }
+
         void handle_url()
         {
             routing_handle_result_ = handler_->handle_initial(req_, res);
@@ -144,6 +204,9 @@ namespace crow
             req_.middleware_context = static_cast<void*>(&ctx_);
             req_.middleware_container = static_cast<void*>(middlewares_);
             req_.io_context = &adaptor_.get_io_context();
+            req_.peer_closed = [this] {
+                return peer_closed();
+            };
 
             req_.remote_ip_address = adaptor_.remote_endpoint().address().to_string();
 
@@ -231,30 +294,27 @@ namespace crow
                   decltype(*middlewares_)>({}, *middlewares_, ctx_, req_, res);
             }
 #ifdef CROW_ENABLE_COMPRESSION
-            if (!res.body.empty() && handler_->compression_used())
+            // The configured algorithm if the client accepts it, else the other one; bodies that
+            // do not shrink, or already carry a Content-Encoding, are sent as they are
+            if (res.compressed && handler_->compression_used() && !res.body.empty() &&
+                res.body.size() >= handler_->compression_min_size() && res.get_header_value("Content-Encoding").empty())
             {
+                res.add_header("Vary", "Accept-Encoding");
                 std::string accept_encoding = req_.get_header_value("Accept-Encoding");
-                if (!accept_encoding.empty() && res.compressed)
+                const compression::algorithm preferred = handler_->compression_algorithm();
+                const compression::algorithm choices[] = {preferred, preferred == compression::GZIP ? compression::DEFLATE : compression::GZIP};
+                for (compression::algorithm algo : choices)
                 {
-                    switch (handler_->compression_algorithm())
+                    const std::string coding = algo == compression::GZIP ? "gzip" : "deflate";
+                    if (accept_encoding.empty() || !compression::accepts(accept_encoding, coding))
+                        continue;
+                    std::string compressed = compression::compress_string(res.body, algo, handler_->compression_level());
+                    if (!compressed.empty() && compressed.size() < res.body.size())
                     {
-                        case compression::DEFLATE:
-                            if (accept_encoding.find("deflate") != std::string::npos)
-                            {
-                                res.body = compression::compress_string(res.body, compression::algorithm::DEFLATE);
-                                res.set_header("Content-Encoding", "deflate");
-                            }
-                            break;
-                        case compression::GZIP:
-                            if (accept_encoding.find("gzip") != std::string::npos)
-                            {
-                                res.body = compression::compress_string(res.body, compression::algorithm::GZIP);
-                                res.set_header("Content-Encoding", "gzip");
-                            }
-                            break;
-                        default:
-                            break;
+                        res.body = std::move(compressed);
+                        res.set_header("Content-Encoding", coding);
                     }
+                    break;
                 }
             }
 #endif
@@ -314,6 +374,7 @@ namespace crow
               {status::PROXY_AUTHENTICATION_REQUIRED, "HTTP/1.1 407 Proxy Authentication Required\r\n"},
               {status::CONFLICT, "HTTP/1.1 409 Conflict\r\n"},
               {status::GONE, "HTTP/1.1 410 Gone\r\n"},
+              {status::PRECONDITION_FAILED, "HTTP/1.1 412 Precondition Failed\r\n"},
               {status::PAYLOAD_TOO_LARGE, "HTTP/1.1 413 Payload Too Large\r\n"},
               {status::UNSUPPORTED_MEDIA_TYPE, "HTTP/1.1 415 Unsupported Media Type\r\n"},
               {status::RANGE_NOT_SATISFIABLE, "HTTP/1.1 416 Range Not Satisfiable\r\n"},
@@ -321,6 +382,7 @@ namespace crow
               {status::PRECONDITION_REQUIRED, "HTTP/1.1 428 Precondition Required\r\n"},
               {status::TOO_MANY_REQUESTS, "HTTP/1.1 429 Too Many Requests\r\n"},
               {status::UNAVAILABLE_FOR_LEGAL_REASONS, "HTTP/1.1 451 Unavailable For Legal Reasons\r\n"},
+              {499, "HTTP/1.1 499 Client Closed Request\r\n"},
 
               {status::INTERNAL_SERVER_ERROR, "HTTP/1.1 500 Internal Server Error\r\n"},
               {status::NOT_IMPLEMENTED, "HTTP/1.1 501 Not Implemented\r\n"},
@@ -474,6 +536,10 @@ namespace crow
               asio::buffer(buffer_),
               [self](const error_code& ec, std::size_t bytes_transferred) {
                   bool error_while_reading = true;
+#ifdef CROW_ENABLE_HTTP2
+                  if (!ec && self->take_http2_preface(bytes_transferred))
+                      return;
+#endif
                   if (!ec)
                   {
                       bool ret = self->parser_.feed(self->buffer_.data(), bytes_transferred);
@@ -510,6 +576,37 @@ namespace crow
               });
         }
 
+#ifdef CROW_ENABLE_HTTP2
+        /// On a connection's first bytes: whether they open HTTP/2 (the preface, RFC 9113 3.4), which then
+        /// takes the socket over. Returns true if it did, or if the bytes so far are only the preface's start.
+        bool take_http2_preface(std::size_t bytes_transferred)
+        {
+            if (preface_checked_ || !handler_->http2())
+                return false;
+            const std::size_t compared = std::min(bytes_transferred, http2_preface_size - preface_matched_);
+            if (std::memcmp(buffer_.data(), http2_preface + preface_matched_, compared) != 0)
+            {
+                preface_checked_ = true;
+                // A start of the preface held back, i.e. "P", "PR", ...: no HTTP/1.1 request begins so
+                if (preface_matched_ > 0)
+                    parser_.feed(http2_preface, preface_matched_);
+                return false;
+            }
+            preface_matched_ += compared;
+            if (preface_matched_ < http2_preface_size)
+            {
+                do_read();
+                return true;
+            }
+            preface_checked_ = true;
+            cancel_deadline_timer();
+            auto connection = std::make_shared<Http2Connection<Adaptor, Handler, Middlewares...>>(
+              std::move(adaptor_), handler_, server_name_, middlewares_, get_cached_date_str, task_timer_, stream_context_);
+            connection->start(buffer_.data() + compared, bytes_transferred - compared);
+            return true;
+        }
+#endif
+
         void do_write()
         {
             auto self = this->shared_from_this();
@@ -592,7 +689,7 @@ namespace crow
         Adaptor adaptor_;
         Handler* handler_;
 
-        std::array<char, 4096> buffer_;
+        std::vector<char> buffer_;
 
         HTTPParser<Connection> parser_;
         std::unique_ptr<routing_handle_result> routing_handle_result_;
@@ -622,8 +719,12 @@ namespace crow
         detail::task_timer& task_timer_;
 
         size_t res_stream_threshold_;
+        uint64_t max_body_size_;
 
         std::atomic<unsigned int>& queue_length_;
+        std::function<asio::io_context&()>& stream_context_;
+        bool preface_checked_{};
+        std::size_t preface_matched_{};
     };
 
 } // namespace crow
@@ -9,6 +9,11 @@
 #include <asio.hpp>
 #endif
 
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include "crow/body_file.h"
 #include "crow/common.h"
 #include "crow/ci_map.h"
 #include "crow/query_string.h"
@@ -39,7 +44,8 @@ namespace crow // NOTE: Already documented in "crow/app.h"
         std::string url;         ///< The endpoint without any parameters.
         query_string url_params; ///< The parameters associated with the request. (everything after the `?` in the URL)
         ci_map headers;
-        std::string body;
+        std::string body;                   ///< Empty when the body was spilled to body_spill (see body_view()).
+        std::shared_ptr<body_file> body_spill; ///< The body, when it was larger than the app's body_spill_threshold().
         std::string remote_ip_address; ///< The IP address from which the request was sent.
         unsigned char http_ver_major, http_ver_minor;
         bool keep_alive,    ///< Whether or not the server should send a `connection: Keep-Alive` header to the client.
@@ -49,6 +55,7 @@ namespace crow // NOTE: Already documented in "crow/app.h"
         void* middleware_context{};
         void* middleware_container{};
         asio::io_context* io_context{};
+        std::function<bool()> peer_closed; ///< Whether the client has closed the connection (callable while the request is handled).
 
         /// Construct an empty request. (sets the method to `GET`)
         request():
@@ -60,6 +67,41 @@ namespace crow // NOTE: Already documented in "crow/app.h"
           method(method_), raw_url(std::move(raw_url_)), url(std::move(url_)), url_params(std::move(url_params_)), headers(std::move(headers_)), body(std::move(body_)), http_ver_major(http_major), http_ver_minor(http_minor), keep_alive(has_keep_alive), close_connection(has_close_connection), upgrade(is_upgrade)
         {}
 
+        /// The body wherever it is: in body, or mapped from body_spill.
+        std::string_view body_view() const
+        {
+            return body_spill ? body_spill->view() : std::string_view(body);
+        }
+
+        /// \brief Add the next chunk of the body.
+        ///
+        /// Once the body is over spill_threshold bytes, it moves to a body_file in spill_dir and later chunks are
+        /// written there; if the file cannot be created it stays in memory. Returns false if a spilled body cannot be
+        /// written.
+        bool append_body(const char* data, size_t size, uint64_t spill_threshold, const std::string& spill_dir)
+        {
+            if (!body_spill && body.size() + size > spill_threshold)
+            {
+                body_spill = body_file::create(spill_dir);
+                if (body_spill)
+                {
+                    if (!body_spill->append(body.data(), body.size()))
+                        return false;
+                    std::string().swap(body);
+                }
+            }
+            if (body_spill)
+                return body_spill->append(data, size);
+            body.append(data, size);
+            return true;
+        }
+
+        /// Map a spilled body once it is complete; false if it cannot be mapped.
+        bool finish_body()
+        {
+            return !body_spill || body_spill->map();
+        }
+
         void add_header(std::string key, std::string value)
         {
             headers.emplace(std::move(key), std::move(value));
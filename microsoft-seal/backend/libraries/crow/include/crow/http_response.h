@@ -27,6 +27,9 @@ namespace crow
     template<typename Adaptor, typename Handler, typename... Middlewares>
     class Connection;
 
+    template<typename Adaptor, typename Handler, typename... Middlewares>
+    class Http2Connection;
+
     class Router;
 
     /// HTTP response
@@ -34,6 +37,8 @@ namespace crow
     {
         template<typename Adaptor, typename Handler, typename... Middlewares>
         friend class crow::Connection;
+        template<typename Adaptor, typename Handler, typename... Middlewares>
+        friend class crow::Http2Connection;
 
         friend class Router;
 
@@ -41,9 +46,7 @@ namespace crow
         std::string body; ///< The actual payload containing the response data.
         ci_map headers;   ///< HTTP headers.
 
-#ifdef CROW_ENABLE_COMPRESSION
         bool compressed = true; ///< If compression is enabled and this is false, the individual response will not be compressed.
-#endif
         bool skip_body = false;            ///< Whether this is a response to a HEAD request.
         bool manual_length_header = false; ///< Whether Crow should automatically add a "Content-Length" header.
 
@@ -170,6 +173,7 @@ namespace crow
             headers = std::move(r.headers);
             completed_ = r.completed_;
             file_info = std::move(r.file_info);
+            compressed = r.compressed;
             return *this;
         }
 
@@ -186,6 +190,7 @@ namespace crow
             headers.clear();
             completed_ = false;
             file_info = static_file_info{};
+            compressed = true;
         }
 
         /// Return a "Temporary Redirect" response.
@@ -247,7 +252,11 @@ namespace crow
                 }
                 if (complete_request_handler_)
                 {
-                    complete_request_handler_();
+                    // The connection clears the handler while it runs; for a response ended after its
+                    // handler returned, the handler holds the last reference to the connection
+                    auto complete_request_handler = std::move(complete_request_handler_);
+                    complete_request_handler_ = nullptr;
+                    complete_request_handler();
                     manual_length_header = false;
                     skip_body = false;
                 }
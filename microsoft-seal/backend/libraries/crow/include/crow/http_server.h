@@ -49,7 +49,7 @@ namespace crow // NOTE: Already documented in "crow/app.h"
              uint16_t concurrency = 1,
              uint8_t timeout = 5,
              typename Adaptor::context* adaptor_ctx = nullptr):
-          acceptor_(io_context_,endpoint),
+          acceptor_(io_context_),
           signals_(io_context_),
           tick_timer_(io_context_),
           handler_(handler),
@@ -59,7 +59,17 @@ namespace crow // NOTE: Already documented in "crow/app.h"
           task_queue_length_pool_(concurrency_ - 1),
           middlewares_(middlewares),
           adaptor_ctx_(adaptor_ctx)
-        {}
+        {
+            // What acceptor_(io_context_, endpoint) does, with SO_REUSEPORT before the bind if asked for
+            acceptor_.open(endpoint.protocol());
+            acceptor_.set_option(tcp::acceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+            if (handler_->reuse_port())
+                acceptor_.set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#endif
+            acceptor_.bind(endpoint);
+            acceptor_.listen();
+        }
 
         void set_tick_function(std::chrono::milliseconds d, std::function<void()> f)
         {
@@ -85,6 +95,10 @@ namespace crow // NOTE: Already documented in "crow/app.h"
                 io_context_pool_.emplace_back(new asio::io_context());
             get_cached_date_str_pool_.resize(worker_thread_count);
             task_timer_pool_.resize(worker_thread_count);
+            // HTTP/2 connections hand their streams out in turn, so one connection's requests run in parallel
+            stream_context_ = [this]() -> asio::io_context& {
+                return *io_context_pool_[next_stream_context_++ % io_context_pool_.size()];
+            };
 
             std::vector<std::future<void>> v;
             std::atomic<int> init_count(0);
@@ -250,7 +264,8 @@ namespace crow // NOTE: Already documented in "crow/app.h"
 
                 auto p = std::make_shared<Connection<Adaptor, Handler, Middlewares...>>(
                   ic, handler_, server_name_, middlewares_,
-                  get_cached_date_str_pool_[context_idx], *task_timer_pool_[context_idx], adaptor_ctx_, task_queue_length_pool_[context_idx]);
+                  get_cached_date_str_pool_[context_idx], *task_timer_pool_[context_idx], adaptor_ctx_, task_queue_length_pool_[context_idx],
+                  stream_context_);
 
                 acceptor_.async_accept(
                   p->socket(),
@@ -299,6 +314,8 @@ namespace crow // NOTE: Already documented in "crow/app.h"
         std::uint8_t timeout_;
         std::string server_name_;
         std::vector<std::atomic<unsigned int>> task_queue_length_pool_;
+        std::function<asio::io_context&()> stream_context_;
+        std::atomic<size_t> next_stream_context_{0};
 
         std::chrono::milliseconds tick_interval_;
         std::function<void()> tick_function_;
@@ -42,32 +42,49 @@ namespace crow // NOTE: Already documented in "crow/app.h"
             return 'a' + c - 10;
         }
 
+        inline void escape_char(char c, std::string& ret)
+        {
+            switch (c)
+            {
+                case '"': ret += "\\\""; break;
+                case '\\': ret += "\\\\"; break;
+                case '\n': ret += "\\n"; break;
+                case '\b': ret += "\\b"; break;
+                case '\f': ret += "\\f"; break;
+                case '\r': ret += "\\r"; break;
+                case '\t': ret += "\\t"; break;
+                default:
+                    if (c >= 0 && c < 0x20)
+                    {
+                        ret += "\\u00";
+                        ret += to_hex(c / 16);
+                        ret += to_hex(c % 16);
+                    }
+                    else
+                        ret += c;
+                    break;
+            }
+        }
+
         inline void escape(const std::string& str, std::string& ret)
         {
             ret.reserve(ret.size() + str.size() + str.size() / 4);
-            for (auto c : str)
-            {
-                switch (c)
+            // Copy runs that need no escaping in one append: Base64 ciphertexts of
+            // hundreds of KB have none, and a push_back per character dominated
+            // serializing responses that carry them
+            const char* run = str.data();
+            const char* const end = run + str.size();
+            for (const char* p = run; p != end; ++p)
+            {
+                const char c = *p;
+                if (c == '"' || c == '\\' || (c >= 0 && c < 0x20))
                 {
-                    case '"': ret += "\\\""; break;
-                    case '\\': ret += "\\\\"; break;
-                    case '\n': ret += "\\n"; break;
-                    case '\b': ret += "\\b"; break;
-                    case '\f': ret += "\\f"; break;
-                    case '\r': ret += "\\r"; break;
-                    case '\t': ret += "\\t"; break;
-                    default:
-                        if (c >= 0 && c < 0x20)
-                        {
-                            ret += "\\u00";
-                            ret += to_hex(c / 16);
-                            ret += to_hex(c % 16);
-                        }
-                        else
-                            ret += c;
-                        break;
+                    ret.append(run, p);
+                    escape_char(c, ret);
+                    run = p + 1;
                 }
             }
+            ret.append(run, end);
         }
         inline std::string escape(const std::string& str)
         {
@@ -1627,6 +1644,15 @@ namespace crow // NOTE: Already documented in "crow/app.h"
                 return *this;
             }
 
+            // Moves, so a large string (e.g. a serialized ciphertext) is not copied into the response
+            wvalue& operator=(std::string&& str)
+            {
+                reset();
+                t_ = type::String;
+                s = std::move(str);
+                return *this;
+            }
+
             wvalue& operator=(list&& v)
             {
                 if (t_ != type::List)
@@ -1662,6 +1688,24 @@ namespace crow // NOTE: Already documented in "crow/app.h"
                 return *this;
             }
 
+            template<typename T>
+            wvalue& operator=(std::vector<T>&& v)
+            {
+                if (t_ != type::List)
+                    reset();
+                t_ = type::List;
+                if (!l)
+                    l = std::unique_ptr<list>(new list{});
+                l->clear();
+                l->resize(v.size());
+                size_t idx = 0;
+                for (auto& x : v)
+                {
+                    (*l)[idx++] = std::move(x);
+                }
+                return *this;
+            }
+
             wvalue& operator=(std::initializer_list<std::pair<std::string const, wvalue>> initializer_list)
             {
                 if (t_ != type::Object)
@@ -1896,6 +1940,12 @@ namespace crow // NOTE: Already documented in "crow/app.h"
                             {
                                 //std::cout << *p << std::endl;
                                 char ch = *p;
+                                // Zeros of an exponent are not trailing zeros ("1e-10" must not become "1e-1")
+                                if (ch == 'e' || ch == 'E')
+                                {
+                                    pos_first_trailing_0 = nullptr;
+                                    break;
+                                }
                                 switch (f_state)
                                 {
                                     case start: // Loop and lookahead until a decimal point is found
@@ -150,7 +150,7 @@ namespace crow
                 if (!boundary.empty())
                 {
                     content_type = "multipart/form-data; boundary=" + boundary;
-                    parse_body(req.body);
+                    parse_body(std::string(req.body_view()));
                 }
                 else
                 {
@@ -186,7 +186,7 @@ namespace crow
               headers(req.headers),
               boundary(get_boundary(get_header_value("Content-Type")))
             {
-                parse_body(req.body);
+                parse_body(req.body_view());
             }
 
         private:
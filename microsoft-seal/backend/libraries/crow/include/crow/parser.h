@@ -6,6 +6,7 @@
 
 #include "crow/http_request.h"
 #include "crow/http_parser_merged.h"
+#include "crow/logging.h"
 
 namespace crow
 {
@@ -82,13 +83,35 @@ namespace crow
 
             self->set_connection_parameters();
 
+            // Turn away bodies over the limit before reading them; size the others once
+            if (self->content_length != CROW_ULLONG_MAX)
+            {
+                if (self->content_length > self->handler_->max_body_size())
+                {
+                    self->handler_->handle_body_too_large();
+                    return -1;
+                }
+                // Bodies over the spill threshold go to a file from the first byte
+                if (self->content_length > self->handler_->body_spill_threshold())
+                    self->req.body_spill = body_file::create(self->handler_->body_spill_dir());
+                if (!self->req.body_spill)
+                    self->req.body.reserve(static_cast<size_t>(self->content_length));
+            }
+
             self->process_header();
             return 0;
         }
         static int on_body(http_parser* self_, const char* at, size_t length)
         {
             HTTPParser* self = static_cast<HTTPParser*>(self_);
-            self->req.body.insert(self->req.body.end(), at, at + length);
+            const uint64_t received = self->req.body_spill ? self->req.body_spill->size() : self->req.body.size();
+            if (received + length > self->handler_->max_body_size())
+                return -1;
+            if (!self->req.append_body(at, length, self->handler_->body_spill_threshold(), self->handler_->body_spill_dir()))
+            {
+                CROW_LOG_ERROR << "Could not write a request body to " << self->handler_->body_spill_dir();
+                return -1;
+            }
             return 0;
         }
         static int on_message_complete(http_parser* self_)
@@ -96,6 +119,11 @@ namespace crow
             HTTPParser* self = static_cast<HTTPParser*>(self_);
 
             self->message_complete = true;
+            if (!self->req.finish_body())
+            {
+                CROW_LOG_ERROR << "Could not map a spilled request body";
+                return -1;
+            }
             self->process_message();
             return 0;
         }
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# Build the he-wasm browser module with Emscripten (emcmake/emmake from an
+# activated emsdk) and copy it where the frontend loads it from
+
+# Change to the directory containing this script, then go up to backend/
+cd "$(dirname "$0")/.."
+
+mkdir -p build-wasm
+cd build-wasm
+
+# SEAL's own tests, examples and zstd are not needed in the browser
+emcmake cmake .. -DCMAKE_BUILD_TYPE=Release -DSEAL_BUILD_TESTS=OFF -DSEAL_BUILD_EXAMPLES=OFF -DSEAL_USE_ZSTD=OFF
+emmake make he-wasm
+
+mkdir -p ../../frontend/public/wasm
+cp he-wasm.js he-wasm.wasm ../../frontend/public/wasm/
@@ -0,0 +1,132 @@
+/**
+ * AdmissionControl.cpp
+ *
+ * First-come-first-served admission by cost and the drain rate behind Retry-After.
+ */
+
+#include "AdmissionControl.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    void count(const char* outcome) {
+        metrics::counter("he_admission_requests_total", "Cost-limited requests by admission outcome",
+                         {{"outcome", outcome}}).add();
+    }
+}
+
+AdmissionControl::Ticket& AdmissionControl::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        release();
+        control = other.control;
+        cost = other.cost;
+        status_ = other.status_;
+        retry_after_ = other.retry_after_;
+        other.control = nullptr;
+    }
+    return *this;
+}
+
+void AdmissionControl::Ticket::release() {
+    if (!control) return;
+    control->release(cost);
+    control = nullptr;
+}
+
+AdmissionControl::AdmissionControl(Options options) : options(options) {}
+
+AdmissionControl::Ticket AdmissionControl::admit(uint64_t cost) {
+    cost = std::max<uint64_t>(cost, 1);
+    const Clock::time_point start = Clock::now();
+    const uint64_t max_queued_cost = options.max_queued_cost ? options.max_queued_cost : 4 * options.max_active_cost;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    bool waited = false;
+    if (!waiting.empty() || !fits(cost)) {
+        if (waiting.size() >= options.max_queued || (!waiting.empty() && queued_cost_ + cost > max_queued_cost)) {
+            Ticket refused = refuse(429, cost);
+            lock.unlock();
+            count("queue_full");
+            return refused;
+        }
+        Waiter self{cost};
+        waiting.push_back(&self);
+        queued_cost_ += cost;
+        bool ready = changed.wait_until(lock, start + options.max_wait,
+                                        [&] { return waiting.front() == &self && fits(cost); });
+        waiting.erase(std::find(waiting.begin(), waiting.end(), &self));
+        queued_cost_ -= cost;
+        // The next in line may fit now, next to this one or in its place
+        changed.notify_all();
+        if (!ready) {
+            Ticket refused = refuse(503, cost);
+            lock.unlock();
+            count("timed_out");
+            return refused;
+        }
+        waited = true;
+    }
+    if (active_ == 0) drain_start = Clock::now();  // Idle time does not count against the drain rate
+    active_++;
+    active_cost_ += cost;
+    lock.unlock();
+
+    Ticket ticket;
+    ticket.control = this;
+    ticket.cost = cost;
+    count(waited ? "queued" : "admitted");
+    metrics::histogram("he_admission_wait_microseconds", "Time cost-limited requests waited to be admitted")
+        .record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count()));
+    return ticket;
+}
+
+// The work ahead over the recent drain rate, or max_wait before there is one; 1 to 60 s
+AdmissionControl::Ticket AdmissionControl::refuse(int status, uint64_t cost) {
+    double ahead = static_cast<double>(active_cost_ + queued_cost_ + cost);
+    double seconds = drain_rate > 0 ? std::ceil(ahead / drain_rate)
+                                    : std::ceil(std::chrono::duration<double>(options.max_wait).count());
+    Ticket ticket;
+    ticket.status_ = status;
+    ticket.retry_after_ = std::chrono::seconds(static_cast<int64_t>(std::min(60.0, std::max(1.0, seconds))));
+    return ticket;
+}
+
+void AdmissionControl::release(uint64_t cost) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        active_--;
+        active_cost_ -= cost;
+        drained += cost;
+        Clock::time_point now = Clock::now();
+        double seconds = std::chrono::duration<double>(now - drain_start).count();
+        if ((active_ == 0 || seconds >= 1.0) && seconds > 0) {
+            double sample = static_cast<double>(drained) / seconds;
+            drain_rate = drain_rate > 0 ? 0.5 * drain_rate + 0.5 * sample : sample;
+            drained = 0;
+            drain_start = now;
+        }
+    }
+    changed.notify_all();
+}
+
+uint64_t AdmissionControl::active_cost() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active_cost_;
+}
+
+uint64_t AdmissionControl::queued_cost() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued_cost_;
+}
+
+size_t AdmissionControl::active() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active_;
+}
+
+size_t AdmissionControl::queued() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return waiting.size();
+}
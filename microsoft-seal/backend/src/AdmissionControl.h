@@ -0,0 +1,119 @@
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * Cost-based admission of CPU-heavy requests, with a bounded wait queue
+ *
+ * A request's cost is the number of ciphertext coefficients it evaluates,
+ * operand count x poly modulus degree (see cost()), which tracks both the
+ * compute it fans out to the pool and the memory its deserialized operands
+ * take. Requests run while the costs of those running stay within
+ * max_active_cost; the others wait, first come first served, so a burst of
+ * column sums runs a few at a time at full speed instead of all at once,
+ * thrashing the workers. A request costing more than max_active_cost on its
+ * own still runs, once nothing else does.
+ *
+ * A request that would take the queue past max_queued requests or
+ * max_queued_cost is refused at once (429), and one that waited max_wait
+ * without being admitted gives up (503). Both carry a Retry-After estimate:
+ * the work ahead of the request over the rate costs were completed at
+ * recently.
+ *
+ * Active and queued costs and requests are exported as he_admission_*
+ * gauges, outcomes as he_admission_requests_total{outcome=...} and waits as
+ * he_admission_wait_microseconds. Thread-safe.
+ */
+class AdmissionControl {
+public:
+    struct Options {
+        uint64_t max_active_cost = 0;       // 0 admits every request at once (only counting them)
+        size_t max_queued = 64;             // Requests waiting; 0 refuses what cannot run at once
+        uint64_t max_queued_cost = 0;       // Cost of the requests waiting; 0 = 4 x max_active_cost
+        std::chrono::milliseconds max_wait{10000};
+    };
+
+    /**
+     * A request's admission, released when it goes out of scope
+     *
+     * False if the request was refused; status() is then the HTTP status to
+     * answer with and retry_after() the Retry-After to send.
+     */
+    class Ticket {
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept { *this = std::move(other); }
+        Ticket& operator=(Ticket&& other) noexcept;
+        ~Ticket() { release(); }
+
+        explicit operator bool() const { return status_ == 200; }
+        int status() const { return status_; }
+        std::chrono::seconds retry_after() const { return retry_after_; }
+
+    private:
+        friend class AdmissionControl;
+
+        AdmissionControl* control = nullptr;
+        uint64_t cost = 0;
+        int status_ = 200;
+        std::chrono::seconds retry_after_{0};
+
+        void release();
+    };
+
+    explicit AdmissionControl(Options options);
+
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    // Cost of evaluating operands ciphertexts of the given poly modulus degree
+    static uint64_t cost(size_t operands, size_t poly_modulus_degree) {
+        return static_cast<uint64_t>(operands) * poly_modulus_degree;
+    }
+
+    /**
+     * Admit a request, waiting in the queue if it cannot run yet
+     * @param cost See cost(); at least 1 is charged
+     * @return The admitted ticket, or a refused one (429 queue full, 503 waited too long)
+     */
+    Ticket admit(uint64_t cost);
+
+    bool enabled() const { return options.max_active_cost > 0; }
+    uint64_t active_cost() const;
+    uint64_t queued_cost() const;
+    size_t active() const;
+    size_t queued() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Waiter {
+        uint64_t cost;
+    };
+
+    const Options options;
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Waiter*> waiting;  // First come first
+    uint64_t active_cost_ = 0;
+    uint64_t queued_cost_ = 0;
+    size_t active_ = 0;
+
+    // Completed cost per second, updated about once a second for Retry-After
+    double drain_rate = 0.0;
+    uint64_t drained = 0;
+    Clock::time_point drain_start = Clock::now();
+
+    bool fits(uint64_t cost) const { return !enabled() || active_ == 0 || active_cost_ + cost <= options.max_active_cost; }
+    Ticket refuse(int status, uint64_t cost);
+    void release(uint64_t cost);
+};
+
+#endif // ADMISSION_CONTROL_H
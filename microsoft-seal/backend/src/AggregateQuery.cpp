@@ -0,0 +1,117 @@
+/**
+ * AggregateQuery.cpp
+ *
+ * Compilation of SUM/AVG/COUNT/VAR queries into batched masked sums.
+ */
+
+#include "AggregateQuery.h"
+#include <algorithm>      // For std::find, std::sort, std::unique, std::lower_bound
+#include <stdexcept>      // For std::invalid_argument
+
+namespace {
+    // Cells in compare_cells order, equal ones (e.g. "1" and "1.0") by their text
+    bool cell_order(const std::string& a, const std::string& b) {
+        const int order = compare_cells(a, b);
+        return order != 0 ? order < 0 : a < b;
+    }
+}
+
+QueryAggregate parse_query_aggregate(const std::string& name) {
+    if (name == "sum") return QueryAggregate::sum;
+    if (name == "avg") return QueryAggregate::avg;
+    if (name == "count") return QueryAggregate::count;
+    if (name == "var") return QueryAggregate::var;
+    throw std::invalid_argument("Unknown aggregate: " + name + " (sum, avg, count, var)");
+}
+
+/**
+ * The groups are the distinct GROUP BY cells of the rows WHERE keeps, so no
+ * group is empty; the kernels are listed in the order terms first need them
+ */
+QueryPlan::QueryPlan(const AggregateQuery& query, const PublicColumns& columns) : rows(columns.row_count()) {
+    if (query.select.empty()) throw std::invalid_argument("Query selects nothing");
+    for (const auto& term : query.select) {
+        if (term.aggregate == QueryAggregate::count) continue;
+        if (term.column.empty()) throw std::invalid_argument("Only count may omit its column");
+        if (std::find(sums.begin(), sums.end(), term.column) == sums.end()) sums.push_back(term.column);
+        if (term.aggregate == QueryAggregate::var &&
+            std::find(squares.begin(), squares.end(), term.column) == squares.end()) {
+            squares.push_back(term.column);
+        }
+    }
+
+    std::vector<double> kept = columns.mask(query.where);
+    if (std::find(kept.begin(), kept.end(), 1.0) == kept.end()) throw std::invalid_argument("WHERE keeps no row");
+    if (query.group_by.empty()) {
+        group_values.emplace_back();
+        masks.push_back(std::move(kept));
+    } else {
+        const std::vector<std::string>& cells = columns.column(query.group_by);
+        for (size_t row = 0; row < rows; row++) {
+            if (kept[row] != 0.0) group_values.push_back(cells[row]);
+        }
+        std::sort(group_values.begin(), group_values.end(), cell_order);
+        group_values.erase(std::unique(group_values.begin(), group_values.end()), group_values.end());
+        masks.assign(group_values.size(), std::vector<double>(rows, 0.0));
+        for (size_t row = 0; row < rows; row++) {
+            if (kept[row] == 0.0) continue;
+            auto group = std::lower_bound(group_values.begin(), group_values.end(), cells[row], cell_order);
+            masks[group - group_values.begin()][row] = 1.0;
+        }
+    }
+    for (const auto& mask : masks) counts.push_back(std::count(mask.begin(), mask.end(), 1.0));
+}
+
+size_t QueryPlan::slot(const std::string& column, bool of_squares) const {
+    const std::vector<std::string>& kernels = of_squares ? squares : sums;
+    auto found = std::find(kernels.begin(), kernels.end(), column);
+    return found == kernels.end() ? none : (found - kernels.begin()) * group_values.size();
+}
+
+std::pair<seal::Ciphertext, seal::Ciphertext> QueryPlan::execute(
+    const HomomorphicEncryption& he, const std::map<std::string, EncryptedVector>& encrypted) const {
+    std::pair<seal::Ciphertext, seal::Ciphertext> result;
+    if (!sums.empty()) result.first = run(he, sums, encrypted, false);
+    if (!squares.empty()) result.second = run(he, squares, encrypted, true);
+    return result;
+}
+
+/**
+ * One masked_sums over the columns back to back: column k's group masks are
+ * placed over its own chunks (padded to whole ciphertexts) as masks k G + g
+ */
+seal::Ciphertext QueryPlan::run(const HomomorphicEncryption& he, const std::vector<std::string>& columns,
+                                const std::map<std::string, EncryptedVector>& encrypted, bool of_squares) const {
+    const size_t slots = he.slot_count();
+    const size_t chunks = (rows + slots - 1) / slots;
+    std::vector<seal::Ciphertext> terms;
+    terms.reserve(columns.size() * chunks);
+    for (const auto& name : columns) {
+        auto column = encrypted.find(name);
+        if (column == encrypted.end()) throw std::invalid_argument("Missing encrypted column: " + name);
+        if (column->second.size() != chunks) {
+            throw std::invalid_argument("Column " + name + " has " + std::to_string(column->second.size()) +
+                                        " ciphertexts, " + std::to_string(rows) + " rows need " +
+                                        std::to_string(chunks));
+        }
+        terms.insert(terms.end(), column->second.ciphertexts().begin(), column->second.ciphertexts().end());
+    }
+    if (of_squares) {
+        // The masks multiply the squares, so VAR takes two levels
+        if (he.parameter_profile().depth < 2) {
+            throw std::invalid_argument("var needs a profile with multiplicative depth >= 2, not " +
+                                        he.parameter_profile().name);
+        }
+        terms = he.squares(terms.data(), terms.size());
+    }
+
+    const size_t span = chunks * slots;
+    std::vector<std::vector<double>> placed(columns.size() * masks.size(),
+                                            std::vector<double>(columns.size() * span, 0.0));
+    for (size_t k = 0; k < columns.size(); k++) {
+        for (size_t g = 0; g < masks.size(); g++) {
+            std::copy(masks[g].begin(), masks[g].end(), placed[k * masks.size() + g].begin() + k * span);
+        }
+    }
+    return he.masked_sums(terms.data(), terms.size(), placed);
+}
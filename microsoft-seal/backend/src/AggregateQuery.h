@@ -0,0 +1,104 @@
+#ifndef AGGREGATE_QUERY_H
+#define AGGREGATE_QUERY_H
+
+#include "EncryptedValue.h"
+#include "HomomorphicEncryption.h"
+#include "RowFilter.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Aggregate queries over encrypted columns (POST /query), e.g.
+ *
+ *   SELECT COUNT(*), AVG(Billing Amount), VAR(Billing Amount)
+ *   WHERE Date of Admission >= 2024-01-01 GROUP BY Admission Type
+ *
+ * in one round trip. WHERE and GROUP BY name public columns, so the server
+ * evaluates them in plaintext: each group becomes one 0/1 row mask (see
+ * RowFilter) and its row count is public, which answers COUNT outright.
+ * SUM, AVG and VAR come down to two kernels per encrypted column, its totals
+ * and its totals of squares, each computed once however many terms need
+ * it; the client divides by the counts for AVG and VAR.
+ */
+enum class QueryAggregate { sum, avg, count, var };
+
+/**
+ * API names "sum", "avg", "count" and "var"
+ * @throws std::invalid_argument for other names
+ */
+QueryAggregate parse_query_aggregate(const std::string& name);
+
+struct QueryTerm {
+    QueryAggregate aggregate = QueryAggregate::sum;
+    std::string column;  // Encrypted column; unused for count
+};
+
+struct AggregateQuery {
+    std::vector<QueryTerm> select;
+    RowFilter where;
+    std::string group_by;  // Public column, or empty for one group of every row WHERE keeps
+};
+
+/**
+ * A query compiled against its public columns, run on packed ciphertexts
+ *
+ * Every kernel of one kind is packed into a single masked_sums: with K
+ * columns and G groups, the columns' ciphertexts are concatenated and
+ * column k under group g gets mask k G + g, zero over the other columns.
+ * So all totals come back in one ciphertext and all totals of squares in a
+ * second, each for one plaintext product per ciphertext (spread over the
+ * thread pool), W - 1 + log2(slots / W) rotations with W = K G rounded up
+ * to a power of two, and one level (totals of squares: two, the squares
+ * being computed first, also on the thread pool).
+ */
+class QueryPlan {
+public:
+    static constexpr size_t none = static_cast<size_t>(-1);
+
+    /**
+     * @throws std::invalid_argument for an empty select, a term without its
+     *         column, an unknown public column, or a WHERE that keeps no row
+     */
+    QueryPlan(const AggregateQuery& query, const PublicColumns& columns);
+
+    // GROUP BY values of the rows WHERE keeps, in order (no GROUP BY: one group, "")
+    const std::vector<std::string>& groups() const { return group_values; }
+    const std::vector<size_t>& row_counts() const { return counts; }
+    // Encrypted columns the query reads, in kernel order
+    const std::vector<std::string>& sum_columns() const { return sums; }
+    const std::vector<std::string>& square_columns() const { return squares; }
+
+    /**
+     * Slot of a column's group 0 kernel in its result; group g is at slot + g
+     * @return none if the plan has no such kernel
+     */
+    size_t slot(const std::string& column, bool of_squares) const;
+
+    /**
+     * {totals, totals of squares}, each left empty if no term needs it
+     *
+     * @param encrypted Packed ciphertexts (e.g. from encrypt_vector) of every
+     *                  column the plan reads, one value per row
+     * @throws std::invalid_argument for a missing column or one of the wrong
+     *         length, more kernels times groups than masked_sums takes, var
+     *         on a profile of depth < 2, or (CKKS) too few levels
+     */
+    std::pair<seal::Ciphertext, seal::Ciphertext> execute(const HomomorphicEncryption& he,
+                                                          const std::map<std::string, EncryptedVector>& encrypted) const;
+
+private:
+    std::vector<std::string> group_values;
+    std::vector<std::vector<double>> masks;  // One per group
+    std::vector<size_t> counts;
+    std::vector<std::string> sums;
+    std::vector<std::string> squares;
+    size_t rows = 0;
+
+    seal::Ciphertext run(const HomomorphicEncryption& he, const std::vector<std::string>& columns,
+                         const std::map<std::string, EncryptedVector>& encrypted, bool of_squares) const;
+};
+
+#endif // AGGREGATE_QUERY_H
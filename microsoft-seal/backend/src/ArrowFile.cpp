@@ -0,0 +1,613 @@
+/**
+ * ArrowFile.cpp
+ *
+ * Reading numeric columns of Arrow IPC files without the Arrow library: the
+ * footer, schema and record batch headers are FlatBuffers tables, read here
+ * with bounds checks against the file, and column buffers are used in the
+ * mapping as ColumnFile uses its blocks. Writer builds the same tables front
+ * to back. Layouts follow the Arrow columnar format specification (File.fbs,
+ * Schema.fbs, Message.fbs).
+ */
+
+#include "ArrowFile.h"
+#include "BinaryFraming.h"  // For the little-endian integer helpers
+#include <cerrno>           // For errno
+#include <cstdio>           // For std::remove, std::rename
+#include <cstring>          // For std::memcmp, std::memcpy, std::strerror
+#include <fstream>          // For checking magic bytes, output (and input on non-POSIX platforms)
+#include <iterator>         // For std::istreambuf_iterator
+#include <stdexcept>        // For exception handling
+#include <utility>          // For std::move
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    constexpr char magic[] = "ARROW1";
+    constexpr size_t magic_size = 6;
+    constexpr char parquet_magic[] = "PAR1";
+
+    constexpr size_t block_size = 24;       // File.fbs struct Block
+    constexpr size_t node_size = 16;        // Message.fbs struct FieldNode
+    constexpr size_t buffer_size = 16;      // Message.fbs struct Buffer
+    constexpr size_t chunk_values = 4096;   // Converted values passed on at once
+    constexpr size_t max_nesting = 64;
+
+    // Schema.fbs union Type and Message.fbs union MessageHeader
+    enum Type : uint8_t {
+        null_type = 1, int_type = 2, floating_point = 3, binary = 4, utf8 = 5, date = 8, list = 12, struct_type = 13,
+        union_type = 14, fixed_size_list = 16, map = 17, large_binary = 19, large_utf8 = 20, large_list = 21,
+        run_end_encoded = 22, binary_view = 23, utf8_view = 24, list_view = 25, large_list_view = 26
+    };
+    constexpr uint8_t record_batch_header = 3;
+
+    // Thrown by the readers below; ArrowFile adds the path
+    struct MetadataError : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    uint64_t read(std::string_view in, size_t pos, size_t bytes) {
+        if (pos > in.size() || in.size() - pos < bytes) throw MetadataError("offset out of range");
+        return framing::get_uint(in, pos, bytes);
+    }
+
+    // A FlatBuffers table: a signed offset back to its vtable, whose entries locate the fields
+    class Table {
+    public:
+        Table(std::string_view in, size_t pos) : in(in), pos(pos) {
+            int64_t back = static_cast<int32_t>(static_cast<uint32_t>(read(in, pos, 4)));
+            int64_t vtable = static_cast<int64_t>(pos) - back;
+            if (vtable < 0 || static_cast<uint64_t>(vtable) >= in.size()) throw MetadataError("vtable out of range");
+            this->vtable = static_cast<size_t>(vtable);
+            vtable_size = static_cast<size_t>(read(in, this->vtable, 2));
+        }
+
+        // Table in a vector of tables (see vector())
+        static Table element(std::string_view in, size_t vector, size_t index) {
+            size_t slot = vector + 4 * index;
+            return Table(in, slot + static_cast<size_t>(read(in, slot, 4)));
+        }
+
+        size_t position() const { return pos; }
+        bool has(size_t field) const { return field_position(field) != 0; }
+
+        uint64_t scalar(size_t field, size_t bytes, uint64_t fallback) const {
+            size_t at = field_position(field);
+            return at ? read(in, at, bytes) : fallback;
+        }
+
+        Table table(size_t field) const {
+            size_t at = target(field);
+            if (!at) throw MetadataError("missing table");
+            return Table(in, at);
+        }
+
+        // Position of a vector's first element (0 if absent, with length 0)
+        size_t vector(size_t field, size_t& length) const {
+            size_t at = target(field);
+            length = at ? static_cast<size_t>(read(in, at, 4)) : 0;
+            return at ? at + 4 : 0;
+        }
+
+        std::string string(size_t field) const {
+            size_t length;
+            size_t at = vector(field, length);
+            if (at > in.size() || in.size() - at < length) throw MetadataError("string out of range");
+            return std::string(in.substr(at, length));
+        }
+
+    private:
+        std::string_view in;
+        size_t pos;
+        size_t vtable = 0;
+        size_t vtable_size = 0;
+
+        size_t field_position(size_t field) const {
+            if (4 + 2 * field + 2 > vtable_size) return 0;
+            size_t offset = static_cast<size_t>(read(in, vtable + 4 + 2 * field, 2));
+            return offset ? pos + offset : 0;
+        }
+
+        size_t target(size_t field) const {
+            size_t at = field_position(field);
+            return at ? at + static_cast<size_t>(read(in, at, 4)) : 0;
+        }
+    };
+
+    // Schema.fbs table Field
+    enum FieldSlot { field_name = 0, field_type_type = 2, field_type = 3, field_dictionary = 4, field_children = 5 };
+
+    /**
+     * Step past a field's FieldNodes and buffers in a record batch: one node
+     * per field and its children depth-first, and as many buffers as its
+     * type's layout has. View types have a varying number, so nothing behind
+     * them can be located
+     */
+    void skip_field(std::string_view in, const Table& field, size_t& nodes, size_t& buffers, bool& located,
+                    size_t depth = 0) {
+        if (depth > max_nesting) throw MetadataError("fields nested too deeply");
+        nodes++;
+        if (field.has(field_dictionary)) {  // Dictionary indices; the values are in dictionary batches
+            buffers += 2;
+            return;
+        }
+        switch (field.scalar(field_type_type, 1, 0)) {
+            case null_type: case run_end_encoded: break;
+            case struct_type: case fixed_size_list: buffers += 1; break;
+            case binary: case utf8: case large_binary: case large_utf8: case list_view: case large_list_view:
+                buffers += 3;
+                break;
+            case union_type: buffers += field.table(field_type).scalar(0, 2, 0) == 1 ? 2 : 1; break;  // Dense: offsets
+            case binary_view: case utf8_view: located = false; break;
+            default: buffers += 2; break;  // Validity and values (or offsets, for lists and maps)
+        }
+        size_t child_count;
+        size_t children = field.vector(field_children, child_count);
+        for (size_t i = 0; i < child_count; i++) {
+            skip_field(in, Table::element(in, children, i), nodes, buffers, located, depth + 1);
+        }
+    }
+
+    /**
+     * A FlatBuffer written front to back, the reverse of the FlatBuffers
+     * builder: a table comes before its vtable (a negative soffset) and
+     * before its references' targets, whose uoffsets are patched in by link()
+     * once they are written. Scalars are aligned to their size from the
+     * buffer's start, which Arrow keeps 8-byte aligned
+     */
+    class FlatBuilder {
+    public:
+        // A table field: bytes 0 leaves it out (the default applies); references are 4 bytes, linked later
+        struct Slot {
+            size_t bytes = 0;
+            uint64_t value = 0;
+        };
+
+        FlatBuilder() { out.resize(4); }  // Root uoffset (see root())
+
+        std::string& bytes() { return out; }
+
+        // A table of fields 0..n - 1, returning its position; positions receives the fields' (0 if left out)
+        size_t table(const std::vector<Slot>& slots, std::vector<size_t>* positions = nullptr) {
+            pad(4);
+            const size_t start = out.size();
+            out.resize(start + 4);
+            std::vector<size_t> at(slots.size());
+            for (size_t i = 0; i < slots.size(); i++) {
+                if (!slots[i].bytes) continue;
+                pad(slots[i].bytes);
+                at[i] = out.size();
+                framing::put_uint(out, slots[i].value, slots[i].bytes);
+            }
+            const size_t table_size = out.size() - start;
+            pad(2);
+            const size_t vtable = out.size();
+            framing::put_uint(out, 4 + 2 * slots.size(), 2);
+            framing::put_uint(out, table_size, 2);
+            for (size_t field : at) framing::put_uint(out, field ? field - start : 0, 2);
+            patch(start, static_cast<uint32_t>(static_cast<int32_t>(start) - static_cast<int32_t>(vtable)));
+            if (positions) *positions = std::move(at);
+            return start;
+        }
+
+        size_t string(const std::string& text) {
+            pad(4);
+            const size_t at = out.size();
+            framing::put_uint(out, text.size(), 4);
+            out += text;
+            out += '\0';
+            return at;
+        }
+
+        // Vector of structs of 8-byte fields, elements 8-byte aligned
+        size_t structs(const std::string& elements, size_t count) {
+            pad(4);
+            if ((out.size() + 4) % 8) out.resize(out.size() + 4);
+            const size_t at = out.size();
+            framing::put_uint(out, count, 4);
+            out += elements;
+            return at;
+        }
+
+        // Vector of count references, element i at the returned position + 4 + 4 * i
+        size_t references(size_t count) {
+            pad(4);
+            const size_t at = out.size();
+            framing::put_uint(out, count, 4);
+            out.resize(out.size() + 4 * count);
+            return at;
+        }
+
+        // Point the reference at position at to a target written after it
+        void link(size_t at, size_t target) { patch(at, static_cast<uint32_t>(target - at)); }
+        void root(size_t table) { link(0, table); }
+
+        void pad(size_t alignment) { out.resize((out.size() + alignment - 1) / alignment * alignment); }
+
+    private:
+        std::string out;
+
+        void patch(size_t at, uint32_t value) {
+            for (size_t i = 0; i < 4; i++) out[at + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    };
+
+    constexpr uint64_t metadata_v5 = 4;  // Schema.fbs enum MetadataVersion
+    constexpr uint8_t schema_header = 1;
+
+    // Schema.fbs table Schema, with its fields
+    size_t write_schema(FlatBuilder& out, const std::vector<ArrowFile::Writer::Field>& fields) {
+        using Type = ArrowFile::Writer::Type;
+        std::vector<size_t> at;
+        const size_t schema = out.table({ { 2, 0 }, { 4, 0 } }, &at);  // Little-endian, fields
+        const size_t vector = out.references(fields.size());
+        out.link(at[1], vector);
+        for (size_t i = 0; i < fields.size(); i++) {
+            uint8_t type = utf8;
+            if (fields[i].type == Type::int64) type = int_type;
+            if (fields[i].type == Type::float64) type = floating_point;
+            if (fields[i].type == Type::date32) type = date;
+            // Name, nullable, type_type, type, (no dictionary), children
+            std::vector<size_t> field;
+            const size_t table = out.table({ { 4, 0 }, { 1, 1 }, { 1, type }, { 4, 0 }, {}, { 4, 0 } }, &field);
+            out.link(vector + 4 + 4 * i, table);
+            out.link(field[field_name], out.string(fields[i].name));
+            switch (fields[i].type) {
+                case Type::int64: out.link(field[field_type], out.table({ { 4, 64 }, { 1, 1 } })); break;
+                case Type::float64: out.link(field[field_type], out.table({ { 2, 2 } })); break;  // DOUBLE
+                case Type::date32: out.link(field[field_type], out.table({ { 2, 0 } })); break;   // DAY
+                case Type::utf8: out.link(field[field_type], out.table({})); break;
+            }
+            out.link(field[field_children], out.references(0));
+        }
+        return schema;
+    }
+
+    // An encapsulated message: 0xFFFFFFFF, int32 metadata size, the Message padded to 8 bytes
+    std::string encapsulate(FlatBuilder& message) {
+        message.pad(8);
+        std::string out;
+        framing::put_uint(out, 0xFFFFFFFF, 4);
+        framing::put_uint(out, message.bytes().size(), 4);
+        out += message.bytes();
+        return out;
+    }
+
+    template <typename T>
+    double load(const char* values, size_t index) {
+        T value;
+        std::memcpy(&value, values + index * sizeof(T), sizeof(T));
+        return static_cast<double>(value);
+    }
+}
+
+bool ArrowFile::is_arrow(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char head[magic_size] = {};
+    if (!file.read(head, sizeof(head))) return false;
+    if (std::memcmp(head, parquet_magic, 4) == 0) {
+        throw std::invalid_argument("Parquet files are not supported (" + path + "); convert them to Arrow IPC, e.g. "
+                                    "pyarrow.feather.write_feather(pyarrow.parquet.read_table(...), ..., "
+                                    "compression=\"uncompressed\")");
+    }
+    return std::memcmp(head, magic, magic_size) == 0;
+}
+
+ArrowFile::ArrowFile(const std::string& path) : path(path) {
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::out_of_range("Unknown Arrow file: " + path);
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) throw std::out_of_range("Unknown Arrow file: " + path);
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not read " + path);
+    }
+    size = static_cast<size_t>(status.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the file referenced
+    if (mapped == MAP_FAILED) throw std::runtime_error("Could not map " + path + ": " + std::strerror(errno));
+    data = static_cast<const char*>(mapped);
+#endif
+    try {
+        parse();
+    } catch (...) {
+#if !defined(_WIN32)
+        ::munmap(const_cast<char*>(data), size);
+#endif
+        throw;
+    }
+}
+
+ArrowFile::~ArrowFile() {
+#if !defined(_WIN32)
+    ::munmap(const_cast<char*>(data), size);
+#endif
+}
+
+/**
+ * Footer (File.fbs): the schema and the blocks of the record batches. Every
+ * batch's message header is checked here, so scans only read buffers
+ *
+ * Layout: "ARROW1", padding, messages, footer, int32 footer size, "ARROW1"
+ */
+void ArrowFile::parse() {
+    const std::string_view file = bytes();
+    if (size < 2 * magic_size + 6 || std::memcmp(data, magic, magic_size) != 0 ||
+        std::memcmp(data + size - magic_size, magic, magic_size) != 0) {
+        throw std::runtime_error("Not a valid Arrow IPC file: " + path);
+    }
+    try {
+        const size_t footer_end = size - magic_size - 4;
+        size_t footer_size = static_cast<size_t>(read(file, footer_end, 4));
+        if (footer_size > footer_end - magic_size) throw MetadataError("footer out of range");
+        size_t footer = footer_end - footer_size;
+        Table root(file, footer + static_cast<size_t>(read(file, footer, 4)));
+
+        Table schema = root.table(1);
+        if (schema.scalar(0, 2, 0) != 0) throw std::runtime_error("Big-endian Arrow files are not supported: " + path);
+
+        size_t field_count;
+        size_t fields = schema.vector(1, field_count);
+        size_t nodes = 0, buffers = 0;
+        bool located = true;
+        for (size_t i = 0; i < field_count; i++) {
+            Table field = Table::element(file, fields, i);
+            Column column;
+            column.node = nodes;
+            column.buffer = buffers;
+            column.located = located;
+            if (!field.has(field_dictionary)) {
+                uint64_t type = field.scalar(field_type_type, 1, 0);
+                if (type == int_type) {
+                    Table int_info = field.table(field_type);
+                    bool is_signed = int_info.scalar(1, 1, 0) != 0;
+                    switch (int_info.scalar(0, 4, 0)) {
+                        case 8: column.kind = is_signed ? Kind::int8 : Kind::uint8; break;
+                        case 16: column.kind = is_signed ? Kind::int16 : Kind::uint16; break;
+                        case 32: column.kind = is_signed ? Kind::int32 : Kind::uint32; break;
+                        case 64: column.kind = is_signed ? Kind::int64 : Kind::uint64; break;
+                        default: break;
+                    }
+                } else if (type == floating_point) {
+                    uint64_t precision = field.table(field_type).scalar(0, 2, 0);  // HALF, SINGLE, DOUBLE
+                    if (precision == 1) column.kind = Kind::float32;
+                    if (precision == 2) column.kind = Kind::float64;
+                }
+            }
+            names.push_back(field.string(field_name));
+            columns.push_back(column);
+            skip_field(file, field, nodes, buffers, located);
+        }
+
+        size_t batch_count;
+        size_t blocks = root.vector(3, batch_count);
+        for (size_t i = 0; i < batch_count; i++) {
+            size_t block = blocks + i * block_size;
+            size_t offset = static_cast<size_t>(read(file, block, 8));
+            size_t metadata_size = static_cast<size_t>(read(file, block + 8, 4));
+            size_t body_size = static_cast<size_t>(read(file, block + 16, 8));
+            if (offset > size || metadata_size > size - offset || body_size > size - offset - metadata_size) {
+                throw MetadataError("record batch out of range");
+            }
+
+            // Encapsulated message: 0xFFFFFFFF, int32 size, Message (before Arrow 0.15 without the marker)
+            size_t message = offset + (read(file, offset, 4) == 0xFFFFFFFF ? 8 : 4);
+            Table header(file, message + static_cast<size_t>(read(file, message, 4)));
+            if (header.scalar(1, 1, 0) != record_batch_header) throw MetadataError("block is not a record batch");
+            Table record = header.table(2);
+            if (record.has(3)) throw std::runtime_error("Compressed Arrow record batches are not supported: " + path);
+            batches.push_back({ record.position(), offset + metadata_size, body_size });
+        }
+    } catch (const MetadataError& e) {
+        throw std::runtime_error("Not a valid Arrow IPC file: " + path + " (" + e.what() + ")");
+    }
+}
+
+size_t ArrowFile::scan_column(size_t index, const Sink& sink) const {
+    if (index >= columns.size() || columns[index].kind == Kind::other) return 0;
+    const Column& column = columns[index];
+    if (!column.located) {
+        throw std::runtime_error("Column " + std::to_string(index) + " of " + path +
+                                 " follows a string or binary view column, which is not supported");
+    }
+
+    size_t width = 8;
+    switch (column.kind) {
+        case Kind::int8: case Kind::uint8: width = 1; break;
+        case Kind::int16: case Kind::uint16: width = 2; break;
+        case Kind::int32: case Kind::uint32: case Kind::float32: width = 4; break;
+        default: break;
+    }
+
+    const std::string_view file = bytes();
+    size_t total = 0;
+    std::vector<double> chunk;
+    auto flush = [&] {
+        if (chunk.empty()) return;
+        sink(chunk.data(), chunk.size());
+        total += chunk.size();
+        chunk.clear();
+    };
+
+    try {
+        for (const Batch& batch : batches) {
+            Table record(file, batch.record);
+            size_t node_count, buffer_count;
+            size_t nodes = record.vector(1, node_count);
+            size_t buffers = record.vector(2, buffer_count);
+            if (column.node >= node_count || column.buffer + 1 >= buffer_count) throw MetadataError("too few buffers");
+
+            size_t node = nodes + column.node * node_size;
+            size_t rows = static_cast<size_t>(read(file, node, 8));
+            size_t null_count = static_cast<size_t>(read(file, node + 8, 8));
+
+            // Buffers are relative to the body; a validity buffer may be left out when there are no nulls
+            auto locate = [&](size_t buffer, size_t& length) {
+                size_t at = buffers + buffer * buffer_size;
+                size_t offset = static_cast<size_t>(read(file, at, 8));
+                length = static_cast<size_t>(read(file, at + 8, 8));
+                if (offset > batch.body_size || length > batch.body_size - offset) {
+                    throw MetadataError("buffer out of range");
+                }
+                return data + batch.body + offset;
+            };
+            size_t validity_size, values_size;
+            const auto* validity = reinterpret_cast<const uint8_t*>(locate(column.buffer, validity_size));
+            const char* values = locate(column.buffer + 1, values_size);
+            if (null_count == 0 || validity_size == 0) validity = nullptr;
+            if (values_size / width < rows || (validity && validity_size < (rows + 7) / 8)) {
+                throw MetadataError("buffer shorter than its column");
+            }
+
+            // In place: Arrow's buffers are little-endian and at least 8-byte aligned, as the host reads doubles
+            bool aligned = reinterpret_cast<uintptr_t>(values) % alignof(double) == 0;
+            if (column.kind == Kind::float64 && !validity && aligned) {
+                flush();
+                if (rows > 0) sink(reinterpret_cast<const double*>(values), rows);
+                total += rows;
+                continue;
+            }
+            for (size_t row = 0; row < rows; row++) {
+                if (validity && !((validity[row / 8] >> (row % 8)) & 1)) continue;
+                switch (column.kind) {
+                    case Kind::int8: chunk.push_back(load<int8_t>(values, row)); break;
+                    case Kind::int16: chunk.push_back(load<int16_t>(values, row)); break;
+                    case Kind::int32: chunk.push_back(load<int32_t>(values, row)); break;
+                    case Kind::int64: chunk.push_back(load<int64_t>(values, row)); break;
+                    case Kind::uint8: chunk.push_back(load<uint8_t>(values, row)); break;
+                    case Kind::uint16: chunk.push_back(load<uint16_t>(values, row)); break;
+                    case Kind::uint32: chunk.push_back(load<uint32_t>(values, row)); break;
+                    case Kind::uint64: chunk.push_back(load<uint64_t>(values, row)); break;
+                    case Kind::float32: chunk.push_back(load<float>(values, row)); break;
+                    default: chunk.push_back(load<double>(values, row)); break;
+                }
+                if (chunk.size() == chunk_values) flush();
+            }
+        }
+        flush();
+    } catch (const MetadataError& e) {
+        throw std::runtime_error("Not a valid Arrow IPC file: " + path + " (" + e.what() + ")");
+    }
+    return total;
+}
+
+ArrowFile::Writer::Writer(std::string path, std::vector<Field> fields)
+    : path(std::move(path)), tmp_path(this->path + ".tmp"), fields(std::move(fields)) {
+    if (this->fields.empty()) throw std::invalid_argument("An Arrow file needs at least one column");
+    file.open(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("Cannot write " + tmp_path);
+
+    // Magic padded to 8 bytes, then the schema as a message without a body
+    FlatBuilder message;
+    std::vector<size_t> at;
+    message.root(message.table({ { 2, metadata_v5 }, { 1, schema_header }, { 4, 0 }, { 8, 0 } }, &at));
+    message.link(at[2], write_schema(message, this->fields));
+    write(std::string(magic, magic_size) + std::string(8 - magic_size, '\0'));
+    write(encapsulate(message));
+}
+
+ArrowFile::Writer::~Writer() {
+    if (finished) return;
+    file.close();
+    std::remove(tmp_path.c_str());
+}
+
+/**
+ * Message with a RecordBatch header (Message.fbs), then the body: per
+ * column an empty validity buffer (no nulls) and its values, or its offsets
+ * and characters, each padded to 8 bytes
+ */
+ArrowFile::Writer::Batch ArrowFile::Writer::encode(size_t rows, const std::vector<Column>& columns) const {
+    if (columns.size() != fields.size()) throw std::invalid_argument("Expected one column per Arrow field");
+    std::string nodes, buffers, body;
+    auto add_buffer = [&](const char* data, size_t size) {
+        framing::put_uint(buffers, body.size(), 8);
+        framing::put_uint(buffers, size, 8);
+        if (size) body.append(data, size);
+        body.resize((body.size() + 7) / 8 * 8);
+    };
+    for (size_t i = 0; i < columns.size(); i++) {
+        const Column& column = columns[i];
+        if (fields[i].type == Type::utf8) {
+            if (column.offsets.size() != rows + 1 || column.offsets.front() != 0 ||
+                static_cast<size_t>(column.offsets.back()) != column.values.size()) {
+                throw std::invalid_argument("Offsets of column " + fields[i].name + " do not match its rows");
+            }
+        } else if (column.values.size() != rows * (fields[i].type == Type::date32 ? 4 : 8)) {
+            throw std::invalid_argument("Column " + fields[i].name + " does not hold " + std::to_string(rows) +
+                                        " values");
+        }
+        framing::put_uint(nodes, rows, 8);
+        framing::put_uint(nodes, 0, 8);  // Null count
+        add_buffer(nullptr, 0);
+        if (fields[i].type == Type::utf8) {
+            add_buffer(reinterpret_cast<const char*>(column.offsets.data()), column.offsets.size() * 4);
+        }
+        add_buffer(column.values.data(), column.values.size());
+    }
+
+    FlatBuilder message;
+    std::vector<size_t> at;
+    message.root(message.table({ { 2, metadata_v5 }, { 1, record_batch_header }, { 4, 0 }, { 8, body.size() } }, &at));
+    std::vector<size_t> record;
+    message.link(at[2], message.table({ { 8, rows }, { 4, 0 }, { 4, 0 } }, &record));
+    message.link(record[1], message.structs(nodes, columns.size()));
+    message.link(record[2], message.structs(buffers, buffers.size() / buffer_size));
+
+    Batch batch;
+    batch.bytes = encapsulate(message);
+    batch.metadata_size = batch.bytes.size();
+    batch.bytes += body;
+    return batch;
+}
+
+void ArrowFile::Writer::append(const Batch& batch) {
+    std::string block;
+    framing::put_uint(block, offset, 8);
+    framing::put_uint(block, batch.metadata_size, 4);
+    framing::put_uint(block, 0, 4);  // Padding
+    framing::put_uint(block, batch.bytes.size() - batch.metadata_size, 8);
+    write(batch.bytes);
+    blocks.push_back(std::move(block));
+}
+
+// Footer (File.fbs): the schema again and the batches' blocks, its size and the magic
+void ArrowFile::Writer::finish() {
+    std::string batch_blocks;
+    for (const auto& block : blocks) batch_blocks += block;
+    FlatBuilder footer;
+    std::vector<size_t> at;
+    footer.root(footer.table({ { 2, metadata_v5 }, { 4, 0 }, { 4, 0 }, { 4, 0 } }, &at));
+    footer.link(at[1], write_schema(footer, fields));
+    footer.link(at[2], footer.structs("", 0));  // No dictionaries
+    footer.link(at[3], footer.structs(batch_blocks, blocks.size()));
+
+    std::string tail = footer.bytes();
+    framing::put_uint(tail, footer.bytes().size(), 4);
+    tail.append(magic, magic_size);
+    write(tail);
+    file.close();
+    if (!file) throw std::runtime_error("Failed to write " + tmp_path);
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) throw std::runtime_error("Could not replace " + path);
+    finished = true;
+}
+
+void ArrowFile::Writer::write(const std::string& bytes) {
+    if (!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error("Failed to write " + tmp_path);
+    }
+    offset += bytes.size();
+}
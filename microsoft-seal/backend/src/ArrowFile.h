@@ -0,0 +1,165 @@
+#ifndef ARROW_FILE_H
+#define ARROW_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Numeric columns of an Apache Arrow IPC file (.arrow, Feather v2), read
+ * straight from a memory mapping
+ *
+ * Only the footer, the schema and each record batch's metadata are parsed;
+ * a scan then touches the buffers of the one column asked for, so the other
+ * columns' pages are never read (projection pushdown). Runs of float64
+ * values without nulls are passed on in place, other integer and floating
+ * point types are converted in small chunks. Nulls are skipped, and columns
+ * of other types yield no values, as CsvTable does with non-numeric cells.
+ *
+ * Supported: little-endian files with uncompressed record batches, as
+ * pyarrow.feather.write_feather(..., compression="uncompressed") or
+ * pyarrow.ipc.new_file write them. Parquet files are refused with a hint to
+ * convert them; reading them needs the Arrow C++ library.
+ */
+class ArrowFile {
+public:
+    // Receives a run of a column's values; the pointer is only valid during the call
+    using Sink = std::function<void(const double* values, size_t count)>;
+
+    /**
+     * Whether a file is an Arrow IPC file (by its magic bytes); false for
+     * files that do not exist or are too short
+     * @throws std::invalid_argument for Parquet files
+     */
+    static bool is_arrow(const std::string& path);
+
+    /**
+     * Map an Arrow IPC file and read its footer and schema
+     *
+     * @throws std::out_of_range if the file does not exist
+     * @throws std::runtime_error if it cannot be read, is not a valid Arrow IPC
+     *         file or uses features not supported (big-endian data)
+     */
+    explicit ArrowFile(const std::string& path);
+    ~ArrowFile();
+
+    ArrowFile(const ArrowFile&) = delete;
+    ArrowFile& operator=(const ArrowFile&) = delete;
+
+    // Names of the top-level columns
+    const std::vector<std::string>& header() const { return names; }
+    size_t column_count() const { return columns.size(); }
+
+    /**
+     * Stream the non-null values of a column in row order
+     *
+     * @param index Zero-based column index (unknown columns yield no values)
+     * @param sink Called with consecutive runs of values
+     * @return Number of values passed to sink
+     * @throws std::runtime_error for compressed or malformed record batches
+     */
+    size_t scan_column(size_t index, const Sink& sink) const;
+
+    /**
+     * An Arrow IPC file written one record batch at a time, for tables
+     * larger than memory (e.g. tools/he-gen.cpp)
+     *
+     * Columns are int64, float64, date32 (days since 1970-01-01) or utf8,
+     * without nulls. encode() builds a batch's message and body and may run
+     * on any thread, so batches are encoded concurrently and appended in
+     * order. Values are taken in host byte order and the schema declares
+     * little-endian, as the reader requires. The file is written to
+     * path + ".tmp" and renamed into place by finish(); a writer destroyed
+     * unfinished deletes it. append() and finish() are not thread-safe.
+     */
+    class Writer {
+    public:
+        enum class Type { int64, float64, date32, utf8 };
+
+        struct Field {
+            std::string name;
+            Type type = Type::float64;
+        };
+
+        // A batch's column: fixed-width values back to back, or (utf8) characters and rows + 1 offsets from 0
+        struct Column {
+            std::string values;
+            std::vector<int32_t> offsets;
+        };
+
+        // An encoded record batch: encapsulated message, then body
+        struct Batch {
+            std::string bytes;
+            size_t metadata_size = 0;
+        };
+
+        /**
+         * @throws std::invalid_argument without fields
+         * @throws std::runtime_error if the file cannot be created
+         */
+        Writer(std::string path, std::vector<Field> fields);
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        /**
+         * Encode rows rows of every field's column, in field order
+         * @throws std::invalid_argument for columns that do not match the fields or rows
+         */
+        Batch encode(size_t rows, const std::vector<Column>& columns) const;
+
+        // @throws std::runtime_error if the file cannot be written
+        void append(const Batch& batch);
+
+        /**
+         * Write the footer and rename the file into place
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void finish();
+
+    private:
+        std::string path;
+        std::string tmp_path;
+        std::vector<Field> fields;
+        std::ofstream file;
+        size_t offset = 0;  // Bytes written
+        std::vector<std::string> blocks;  // File.fbs Block structs of the batches
+        bool finished = false;
+
+        void write(const std::string& bytes);
+    };
+
+private:
+    enum class Kind { other, int8, int16, int32, int64, uint8, uint16, uint32, uint64, float32, float64 };
+
+    struct Column {
+        Kind kind = Kind::other;
+        size_t node = 0;    // Index of its FieldNode in a record batch
+        size_t buffer = 0;  // Index of its validity buffer; values follow
+        bool located = true;  // False behind a column whose buffer count varies by batch (view types)
+    };
+
+    struct Batch {
+        size_t record = 0;  // File offset of its RecordBatch table
+        size_t body = 0;    // File offset of its body, which buffer offsets are relative to
+        size_t body_size = 0;
+    };
+
+    std::string path;
+    const char* data = nullptr;
+    size_t size = 0;
+    std::string buffer;  // The file's bytes where it cannot be mapped
+    std::vector<std::string> names;
+    std::vector<Column> columns;
+    std::vector<Batch> batches;
+
+    void parse();
+    std::string_view bytes() const { return { data, size }; }
+};
+
+#endif // ARROW_FILE_H
@@ -0,0 +1,77 @@
+#ifndef ASYNC_HANDLER_H
+#define ASYNC_HANDLER_H
+
+#include "crow.h"
+#include "Cancellation.h"
+#include "Metrics.h"
+#include "Tracing.h"
+#include <exception>
+#include <memory>
+#include <utility>
+
+/**
+ * A response finished after its handler returned, so the handler's I/O
+ * thread serves other connections while the request waits on other nodes
+ *
+ * A route taking (const crow::request&, crow::response&) creates one once it
+ * hands the rest of its work to another thread, e.g. as the continuation of
+ * Cluster::scatter_async, and returns without ending the response. Crow keeps
+ * the connection, request and response until finish() ends it; request bodies
+ * are already read asynchronously before any handler runs.
+ *
+ * Creating it moves the request context (endpoint, StageTimings, trace span,
+ * RequestMemory and cancellation token) off the I/O thread, which is left
+ * serving no request; finish() runs the work under it. The response is sent
+ * from the connection's own I/O thread, so the middlewares' after_handle
+ * still runs on the thread their before_handle did. Release a NUMA binding
+ * (TenantMiddleware) first: the I/O thread would keep it meanwhile.
+ */
+class PendingResponse {
+public:
+    PendingResponse(const crow::request& req, crow::response& res)
+        : req(req), res(res), context(metrics::current_request()) {
+        metrics::set_current_endpoint("none");
+        metrics::set_current_timings(nullptr);
+        metrics::set_current_memory(nullptr);
+        tracing::set_current_span(nullptr);
+        cancellation::current() = nullptr;
+    }
+
+    // What the handler was working for
+    const metrics::RequestContext& request() const { return context; }
+
+    /**
+     * Run `work` under the request's context and send the response it returns;
+     * an exception it throws answers 500. Call once, from any thread
+     */
+    template <typename Work>
+    void finish(Work&& work) const {
+        auto response = std::make_shared<crow::response>();
+        {
+            metrics::EndpointScope scope(context);
+            try {
+                *response = std::forward<Work>(work)();
+            } catch (const std::exception& e) {
+                crow::json::wvalue error;
+                error["error"] = e.what();
+                *response = crow::response(500, error);
+            }
+        }
+        crow::response* target = &res;
+        asio::post(*req.io_context, [target, response] {
+            // Headers Crow set once the handler returned (Connection: Keep-Alive) stay
+            target->code = response->code;
+            target->body = std::move(response->body);
+            target->compressed = response->compressed;
+            for (const auto& header : response->headers) target->set_header(header.first, header.second);
+            target->end();
+        });
+    }
+
+private:
+    const crow::request& req;
+    crow::response& res;
+    metrics::RequestContext context;
+};
+
+#endif // ASYNC_HANDLER_H
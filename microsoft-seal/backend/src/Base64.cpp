@@ -0,0 +1,347 @@
+/**
+ * Base64.cpp
+ *
+ * Vectorized Base64 codec used for ciphertext and key transport over JSON.
+ *
+ * - x86-64: AVX2 kernels (Mula/Lemire reshuffle + translate), picked at runtime
+ *   so one binary runs on CPUs with and without AVX2
+ * - AArch64: NEON kernels built on vld3/vld4 de-interleaving loads and
+ *   64-entry table lookups
+ * - Everywhere: scalar fallback over a constexpr decode table, also used for
+ *   the tails left over by the vector loops
+ */
+
+#include "Base64.h"
+#include <array>          // For the constexpr decode table
+#include <cstdint>        // For fixed-width integer types
+#include <stdexcept>      // For exception handling
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <immintrin.h>
+    #if defined(__GNUC__) || defined(__clang__)
+        #define HE_BASE64_AVX2 1
+        #define HE_TARGET_AVX2 __attribute__((target("avx2")))
+    #elif defined(__AVX2__)
+        #define HE_BASE64_AVX2 1
+        #define HE_TARGET_AVX2
+    #endif
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define HE_BASE64_NEON 1
+#endif
+
+namespace {
+    // Base64 alphabet used for encoding binary data to text
+    constexpr char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz"
+        "0123456789+/";
+
+    constexpr uint8_t invalid = 0xFF;
+
+    // Translation table from character to 6-bit value, built at compile time
+    constexpr std::array<uint8_t, 256> make_decode_table() {
+        std::array<uint8_t, 256> table{};
+        for (auto& entry : table) entry = invalid;
+        for (uint8_t i = 0; i < 64; i++) table[static_cast<uint8_t>(alphabet[i])] = i;
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 256> decode_table = make_decode_table();
+
+    /**
+     * Scalar encoder, also handles the final partial group and padding
+     * @param in Raw bytes
+     * @param size Number of bytes
+     * @param out Destination with room for encoded_size(size) characters
+     */
+    void encode_scalar(const uint8_t* in, size_t size, char* out) {
+        size_t i = 0;
+        for (; i + 3 <= size; i += 3) {
+            uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | in[i + 2];
+            out[0] = alphabet[v >> 18];
+            out[1] = alphabet[(v >> 12) & 0x3F];
+            out[2] = alphabet[(v >> 6) & 0x3F];
+            out[3] = alphabet[v & 0x3F];
+            out += 4;
+        }
+        if (size - i == 1) {
+            uint32_t v = uint32_t(in[i]) << 16;
+            out[0] = alphabet[v >> 18];
+            out[1] = alphabet[(v >> 12) & 0x3F];
+            out[2] = '=';
+            out[3] = '=';
+        } else if (size - i == 2) {
+            uint32_t v = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8);
+            out[0] = alphabet[v >> 18];
+            out[1] = alphabet[(v >> 12) & 0x3F];
+            out[2] = alphabet[(v >> 6) & 0x3F];
+            out[3] = '=';
+        }
+    }
+
+    /**
+     * Scalar decoder for unpadded text
+     * @param in Base64 characters (padding already stripped)
+     * @param size Number of characters (size % 4 != 1)
+     * @param out Destination with room for the decoded bytes
+     */
+    void decode_scalar(const uint8_t* in, size_t size, uint8_t* out) {
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            uint32_t a = decode_table[in[i]], b = decode_table[in[i + 1]];
+            uint32_t c = decode_table[in[i + 2]], d = decode_table[in[i + 3]];
+            if ((a | b | c | d) & 0x80) throw std::invalid_argument("Invalid Base64 input");
+            uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+            out[0] = uint8_t(v >> 16);
+            out[1] = uint8_t(v >> 8);
+            out[2] = uint8_t(v);
+            out += 3;
+        }
+        size_t rest = size - i;
+        if (rest >= 2) {
+            uint32_t a = decode_table[in[i]], b = decode_table[in[i + 1]];
+            uint32_t c = rest == 3 ? decode_table[in[i + 2]] : 0;
+            if ((a | b | c) & 0x80) throw std::invalid_argument("Invalid Base64 input");
+            uint32_t v = (a << 18) | (b << 12) | (c << 6);
+            out[0] = uint8_t(v >> 16);
+            if (rest == 3) out[1] = uint8_t(v >> 8);
+        }
+    }
+
+#if defined(HE_BASE64_AVX2)
+    /**
+     * AVX2 encoder: 24 input bytes -> 32 characters per iteration
+     * @return Number of input bytes consumed (a multiple of 3)
+     */
+    HE_TARGET_AVX2 size_t encode_avx2(const uint8_t* in, size_t size, char* out) {
+        const __m256i shuffle = _mm256_setr_epi8(
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        const __m256i lut = _mm256_setr_epi8(
+            65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+            65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+
+        size_t done = 0;
+        // Each lane reads 16 bytes of which 12 are used, so 28 bytes must be readable
+        while (size - done >= 28) {
+            __m256i v = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + done))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + done + 12)), 1);
+
+            // Spread each 3-byte group over four bytes holding one 6-bit index each
+            v = _mm256_shuffle_epi8(v, shuffle);
+            const __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+            const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+            const __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+            const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+            v = _mm256_or_si256(t1, t3);
+
+            // Translate indices to ASCII by adding a per-range offset
+            __m256i offsets = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+            offsets = _mm256_sub_epi8(offsets, _mm256_cmpgt_epi8(v, _mm256_set1_epi8(25)));
+            v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut, offsets));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+            out += 32;
+            done += 24;
+        }
+        return done;
+    }
+
+    /**
+     * AVX2 decoder: 32 characters -> 24 bytes per iteration
+     * Stores 32 bytes per iteration, so it stops while at least 8 more output bytes remain
+     * @return Number of characters consumed (stops early at the first invalid block)
+     */
+    HE_TARGET_AVX2 size_t decode_avx2(const uint8_t* in, size_t size, uint8_t* out) {
+        const __m256i lut_lo = _mm256_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i lut_hi = _mm256_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i lut_roll = _mm256_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+        const __m256i pack = _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+        size_t done = 0;
+        while (size - done >= 45) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + done));
+
+            // Validate and map characters to 6-bit values via nibble lookups
+            __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(v, 4), mask_2f);
+            const __m256i lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(v, mask_2f));
+            const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+            if (!_mm256_testz_si256(lo, hi)) break;  // Invalid character: let the scalar path report it
+            const __m256i eq_2f = _mm256_cmpeq_epi8(v, mask_2f);
+            v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles)));
+
+            // Pack four 6-bit values into three bytes
+            v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+            v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+            v = _mm256_shuffle_epi8(v, pack);
+            v = _mm256_permutevar8x32_epi32(v, lanes);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+            out += 24;
+            done += 32;
+        }
+        return done;
+    }
+#endif
+
+#if defined(HE_BASE64_NEON)
+    /**
+     * NEON encoder: 48 input bytes -> 64 characters per iteration
+     * @return Number of input bytes consumed (a multiple of 3)
+     */
+    size_t encode_neon(const uint8_t* in, size_t size, char* out) {
+        const uint8_t* table_bytes = reinterpret_cast<const uint8_t*>(alphabet);
+        const uint8x16x4_t table = {{vld1q_u8(table_bytes), vld1q_u8(table_bytes + 16),
+                                     vld1q_u8(table_bytes + 32), vld1q_u8(table_bytes + 48)}};
+        const uint8x16_t mask = vdupq_n_u8(0x3F);
+
+        size_t done = 0;
+        while (size - done >= 48) {
+            uint8x16x3_t src = vld3q_u8(in + done);
+            uint8x16x4_t idx;
+            idx.val[0] = vshrq_n_u8(src.val[0], 2);
+            idx.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(src.val[0], 4), vshrq_n_u8(src.val[1], 4)), mask);
+            idx.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(src.val[1], 2), vshrq_n_u8(src.val[2], 6)), mask);
+            idx.val[3] = vandq_u8(src.val[2], mask);
+
+            uint8x16x4_t chars;
+            for (int i = 0; i < 4; i++) chars.val[i] = vqtbl4q_u8(table, idx.val[i]);
+            vst4q_u8(reinterpret_cast<uint8_t*>(out), chars);
+            out += 64;
+            done += 48;
+        }
+        return done;
+    }
+
+    /**
+     * NEON decoder: 64 characters -> 48 bytes per iteration
+     * @return Number of characters consumed (stops early at the first invalid block)
+     */
+    size_t decode_neon(const uint8_t* in, size_t size, uint8_t* out) {
+        const uint8_t* t = decode_table.data();
+        const uint8x16x4_t table_lo = {{vld1q_u8(t), vld1q_u8(t + 16), vld1q_u8(t + 32), vld1q_u8(t + 48)}};
+        const uint8x16x4_t table_hi = {{vld1q_u8(t + 64), vld1q_u8(t + 80), vld1q_u8(t + 96), vld1q_u8(t + 112)}};
+
+        size_t done = 0;
+        while (size - done >= 64) {
+            uint8x16x4_t src = vld4q_u8(in + done);
+            uint8x16_t error = vdupq_n_u8(0);
+            for (int i = 0; i < 4; i++) {
+                // Characters 0..63 hit table_lo, 64..127 hit table_hi, 128..255 are invalid
+                uint8x16_t v = vqtbl4q_u8(table_lo, src.val[i]);
+                v = vqtbx4q_u8(v, table_hi, vsubq_u8(src.val[i], vdupq_n_u8(64)));
+                v = vorrq_u8(v, vcgeq_u8(src.val[i], vdupq_n_u8(128)));
+                error = vorrq_u8(error, v);
+                src.val[i] = v;
+            }
+            if (vmaxvq_u8(error) > 63) break;  // Invalid character: let the scalar path report it
+
+            uint8x16x3_t bytes;
+            bytes.val[0] = vorrq_u8(vshlq_n_u8(src.val[0], 2), vshrq_n_u8(src.val[1], 4));
+            bytes.val[1] = vorrq_u8(vshlq_n_u8(src.val[1], 4), vshrq_n_u8(src.val[2], 2));
+            bytes.val[2] = vorrq_u8(vshlq_n_u8(src.val[2], 6), src.val[3]);
+            vst3q_u8(out, bytes);
+            out += 48;
+            done += 64;
+        }
+        return done;
+    }
+#endif
+
+    // Vector kernels report how much of the input they consumed; the scalar code finishes the rest
+    using encode_kernel = size_t (*)(const uint8_t*, size_t, char*);
+    using decode_kernel = size_t (*)(const uint8_t*, size_t, uint8_t*);
+
+    size_t encode_none(const uint8_t*, size_t, char*) { return 0; }
+    size_t decode_none(const uint8_t*, size_t, uint8_t*) { return 0; }
+
+    struct Kernels {
+        encode_kernel encode = encode_none;
+        decode_kernel decode = decode_none;
+        const char* name = "scalar";
+    };
+
+    /**
+     * Select the fastest kernels supported by the running CPU (evaluated once)
+     */
+    const Kernels& kernels() {
+        static const Kernels selected = [] {
+            Kernels k;
+#if defined(HE_BASE64_AVX2)
+    #if defined(__GNUC__) || defined(__clang__)
+            bool has_avx2 = __builtin_cpu_supports("avx2");
+    #else
+            bool has_avx2 = true;  // MSVC: only compiled in with /arch:AVX2
+    #endif
+            if (has_avx2) {
+                k.encode = encode_avx2;
+                k.decode = decode_avx2;
+                k.name = "avx2";
+            }
+#elif defined(HE_BASE64_NEON)
+            k.encode = encode_neon;
+            k.decode = decode_neon;
+            k.name = "neon";
+#endif
+            return k;
+        }();
+        return selected;
+    }
+
+    // Length of the text without its '=' padding (at most two characters)
+    size_t unpadded_size(const char* data, size_t size) {
+        size_t pad = 0;
+        while (pad < 2 && size > pad && data[size - 1 - pad] == '=') pad++;
+        return size - pad;
+    }
+}
+
+namespace base64 {
+
+    size_t decoded_size(const char* data, size_t size) {
+        size_t payload = unpadded_size(data, size);
+        size_t rest = payload % 4;
+        return payload / 4 * 3 + (rest == 3 ? 2 : rest == 2 ? 1 : 0);
+    }
+
+    void encode(const char* data, size_t size, std::string& out) {
+        size_t offset = out.size();
+        out.resize(offset + encoded_size(size));
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+        char* dst = &out[offset];
+
+        size_t done = kernels().encode(in, size, dst);
+        encode_scalar(in + done, size - done, dst + done / 3 * 4);
+    }
+
+    void decode(const char* data, size_t size, std::string& out) {
+        size_t payload = unpadded_size(data, size);
+        if (payload % 4 == 1) throw std::invalid_argument("Invalid Base64 length");
+
+        out.resize(decoded_size(data, size));
+        if (out.empty()) return;
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+        uint8_t* dst = reinterpret_cast<uint8_t*>(&out[0]);
+
+        size_t done = kernels().decode(in, payload, dst);
+        decode_scalar(in + done, payload - done, dst + done / 4 * 3);
+    }
+
+    const char* implementation() {
+        return kernels().name;
+    }
+}
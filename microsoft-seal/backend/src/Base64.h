@@ -0,0 +1,57 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Base64 codec (RFC 4648 alphabet, '=' padding) for ciphertext transport
+ *
+ * Output sizes are computed up front so encode/decode never regrow the
+ * destination. Long inputs are processed 24 bytes (32 characters) at a time
+ * with AVX2 on x86-64 (selected at runtime) or 48 bytes at a time with NEON
+ * on AArch64; the tails and other targets use a scalar loop over a
+ * constexpr lookup table.
+ */
+namespace base64 {
+
+    // Number of characters produced for size input bytes (including padding)
+    constexpr size_t encoded_size(size_t size) { return 4 * ((size + 2) / 3); }
+
+    // Number of bytes produced by decoding the given text (accounts for padding)
+    size_t decoded_size(const char* data, size_t size);
+
+    /**
+     * Append the Base64 encoding of a byte range to out
+     * @param data Raw bytes
+     * @param size Number of bytes
+     * @param out String the encoded text is appended to
+     */
+    void encode(const char* data, size_t size, std::string& out);
+
+    /**
+     * Decode Base64 text into out (replacing its contents, reusing its capacity)
+     * @param data Base64 text, optionally padded with '='
+     * @param size Number of characters
+     * @param out Buffer receiving the decoded bytes
+     * @throws std::invalid_argument on characters outside the alphabet
+     */
+    void decode(const char* data, size_t size, std::string& out);
+
+    inline std::string encode(const std::string& input) {
+        std::string out;
+        encode(input.data(), input.size(), out);
+        return out;
+    }
+
+    inline std::string decode(const std::string& input) {
+        std::string out;
+        decode(input.data(), input.size(), out);
+        return out;
+    }
+
+    // Name of the kernel selected for this CPU ("avx2", "neon" or "scalar")
+    const char* implementation();
+}
+
+#endif // BASE64_H
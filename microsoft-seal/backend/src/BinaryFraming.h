@@ -0,0 +1,125 @@
+#ifndef BINARY_FRAMING_H
+#define BINARY_FRAMING_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Length-prefixed framing for sending several binary ciphertexts in one body
+ *
+ * Layout (all integers little-endian):
+ *   uint32 count
+ *   count x { uint64 length, length bytes }
+ *
+ * Used by the /binary/... endpoints (Content-Type: application/octet-stream)
+ * so ciphertexts skip Base64 and JSON entirely.
+ */
+namespace framing {
+
+    inline void put_uint(std::string& out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    inline uint64_t get_uint(std::string_view in, size_t& pos, size_t bytes) {
+        if (in.size() - pos < bytes) throw std::invalid_argument("Truncated binary frame");
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+        }
+        pos += bytes;
+        return value;
+    }
+
+    /**
+     * Pack payloads into a single framed buffer
+     *
+     * @param payloads Binary payloads (e.g. serialized ciphertexts)
+     * @return Framed buffer
+     */
+    inline std::string frame(const std::vector<std::string>& payloads) {
+        size_t total = 4;
+        for (const auto& payload : payloads) total += 8 + payload.size();
+
+        std::string out;
+        out.reserve(total);
+        put_uint(out, payloads.size(), 4);
+        for (const auto& payload : payloads) {
+            put_uint(out, payload.size(), 8);
+            out.append(payload);
+        }
+        return out;
+    }
+
+    /**
+     * Split a framed buffer back into its payloads
+     *
+     * @param body Framed buffer
+     * @return The payloads in order, as views into body (which must outlive them)
+     * @throws std::invalid_argument if the buffer is truncated or has trailing bytes
+     */
+    inline std::vector<std::string_view> unframe(std::string_view body) {
+        size_t pos = 0;
+        uint64_t count = get_uint(body, pos, 4);
+
+        std::vector<std::string_view> payloads;
+        payloads.reserve(static_cast<size_t>(std::min<uint64_t>(count, body.size() / 8)));
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t length = get_uint(body, pos, 8);
+            if (body.size() - pos < length) throw std::invalid_argument("Truncated binary frame");
+            payloads.emplace_back(body.data() + pos, static_cast<size_t>(length));
+            pos += static_cast<size_t>(length);
+        }
+        if (pos != body.size()) throw std::invalid_argument("Trailing bytes after binary frame");
+        return payloads;
+    }
+
+    /**
+     * One timestamped reading of WS /ws/vitals, as one binary websocket message
+     *
+     * Layout (little-endian):
+     *   uint16 patient ID length, patient ID bytes
+     *   uint64 timestamp (milliseconds since the Unix epoch)
+     *   the ciphertext (seeded or not), to the end of the message
+     */
+    struct Reading {
+        std::string_view patient;
+        uint64_t timestamp_ms = 0;
+        std::string_view ciphertext;
+    };
+
+    inline std::string frame_reading(std::string_view patient, uint64_t timestamp_ms, std::string_view ciphertext) {
+        if (patient.empty() || patient.size() > 0xFFFF) throw std::invalid_argument("Invalid patient ID length");
+        std::string out;
+        out.reserve(2 + patient.size() + 8 + ciphertext.size());
+        put_uint(out, patient.size(), 2);
+        out.append(patient);
+        put_uint(out, timestamp_ms, 8);
+        out.append(ciphertext);
+        return out;
+    }
+
+    /**
+     * @return The reading, as views into message (which must outlive them)
+     * @throws std::invalid_argument if the message is truncated or has no patient ID or ciphertext
+     */
+    inline Reading unframe_reading(std::string_view message) {
+        size_t pos = 0;
+        Reading reading;
+        size_t length = static_cast<size_t>(get_uint(message, pos, 2));
+        if (length == 0 || message.size() - pos < length) throw std::invalid_argument("Truncated binary frame");
+        reading.patient = message.substr(pos, length);
+        pos += length;
+        reading.timestamp_ms = get_uint(message, pos, 8);
+        reading.ciphertext = message.substr(pos);
+        if (reading.ciphertext.empty()) throw std::invalid_argument("Reading without a ciphertext");
+        return reading;
+    }
+}
+
+#endif // BINARY_FRAMING_H
@@ -5,12 +5,20 @@
 
 struct CORSMiddleware {
     struct context {};
+
+    // Trace context (TraceMiddleware), the stage timing opt-in, memory and operation reports (MetricsMiddleware)
+    // cross origins too, and so do the shape of /binary/decrypt_batch arrays and routing hints (RouteHintMiddleware)
+    static constexpr const char* allowed_headers =
+        "Content-Type, traceparent, tracestate, X-HE-Timings, X-Deadline-Ms, X-HE-Route-Key";
+    static constexpr const char* exposed_headers =
+        "traceresponse, Server-Timing, X-HE-Memory, X-HE-Operations, X-HE-Count, X-HE-Slots, X-HE-Value-Type, "
+        "X-HE-Route-Key, X-HE-Replica";
     
     void before_handle(crow::request& req, crow::response& res, context& ctx) {
         // Handle preflight requests
         if (req.method == crow::HTTPMethod::OPTIONS) {
             res.add_header("Access-Control-Allow-Origin", "*");
-            res.add_header("Access-Control-Allow-Headers", "Content-Type");
+            res.add_header("Access-Control-Allow-Headers", allowed_headers);
             res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
             res.code = 200;
             res.end();
@@ -19,8 +27,9 @@ struct CORSMiddleware {
 
     void after_handle(crow::request& req, crow::response& res, context& ctx) {
         res.add_header("Access-Control-Allow-Origin", "*");
-        res.add_header("Access-Control-Allow-Headers", "Content-Type");
+        res.add_header("Access-Control-Allow-Headers", allowed_headers);
         res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
+        res.add_header("Access-Control-Expose-Headers", exposed_headers);
     }
 };
 
@@ -0,0 +1,113 @@
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Cooperative cancellation of long-running homomorphic work
+ *
+ * A Token is cancelled explicitly (DELETE /jobs/<id>), by its deadline
+ * passing (X-Deadline-Ms), or when its probe reports the client gone (the
+ * request's connection was closed). Long operations call check() between
+ * chunks, e.g. every few operands of a sum, and stop with Cancelled; the
+ * tasks they fanned out to the compute pool check the same token, which
+ * travels with metrics::RequestContext, so queued ones end at once instead of
+ * running for nobody. A running SEAL call is never interrupted: work stops at
+ * the next chunk boundary.
+ */
+namespace cancellation {
+
+    class Cancelled : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    class Token {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Returns true once the work is abandoned, e.g. its client hung up; called from any thread
+        using Probe = std::function<bool()>;
+
+        // Deadline and probe are set up before the token is shared; cancel() and cancelled() are thread-safe
+        void set_deadline(Clock::time_point deadline) { this->deadline = deadline; }
+
+        // The probe runs at most once per interval however often cancelled() is asked
+        void set_probe(Probe probe, std::chrono::milliseconds interval) {
+            this->probe = std::move(probe);
+            probe_interval_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+        }
+
+        // @param reason Static text for the error message, e.g. "job cancelled"
+        void cancel(const char* reason) { mark(reason); }
+
+        bool cancelled() const {
+            if (why.load(std::memory_order_relaxed)) return true;
+            const Clock::time_point now = Clock::now();
+            if (now >= deadline) {
+                mark("deadline exceeded");
+            } else if (probe) {
+                const int64_t now_ns = now.time_since_epoch().count();
+                int64_t due = next_probe_ns.load(std::memory_order_relaxed);
+                if (now_ns >= due &&
+                    next_probe_ns.compare_exchange_strong(due, now_ns + probe_interval_ns) && probe()) {
+                    mark("client disconnected");
+                }
+            }
+            return why.load(std::memory_order_relaxed) != nullptr;
+        }
+
+        // Why the token was cancelled (nullptr while it is not)
+        const char* reason() const { return why.load(); }
+
+        // Whether it was its deadline that cancelled it
+        bool expired() const { return deadline != Clock::time_point::max() && Clock::now() >= deadline; }
+
+    private:
+        mutable std::atomic<const char*> why{nullptr};  // The first reason wins
+        Clock::time_point deadline = Clock::time_point::max();
+        Probe probe;
+        int64_t probe_interval_ns = 0;
+        mutable std::atomic<int64_t> next_probe_ns{0};
+
+        void mark(const char* reason) const {
+            const char* expected = nullptr;
+            why.compare_exchange_strong(expected, reason);
+        }
+    };
+
+    // Token of the work the calling thread does (nullptr: not cancellable)
+    inline const Token*& current() {
+        thread_local const Token* token = nullptr;
+        return token;
+    }
+
+    // Sets the calling thread's token for the scope's lifetime
+    class Scope {
+    public:
+        explicit Scope(const Token* token) : previous(current()) { current() = token; }
+        ~Scope() { current() = previous; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const Token* previous;
+    };
+
+    /**
+     * Stop the calling thread's work if its token was cancelled
+     * @throws Cancelled naming the reason
+     */
+    inline void check() {
+        const Token* token = current();
+        if (token && token->cancelled()) throw Cancelled(std::string("Cancelled: ") + token->reason());
+    }
+}
+
+#endif // CANCELLATION_H
@@ -0,0 +1,51 @@
+#ifndef CANCELLATION_MIDDLEWARE_H
+#define CANCELLATION_MIDDLEWARE_H
+
+#include "crow.h"
+#include "Cancellation.h"
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+
+/**
+ * Gives every request a cancellation token that long operations check
+ * between chunks: it expires after "X-Deadline-Ms" milliseconds when the
+ * client sends one, and is cancelled once the client closes its connection
+ * (probed at most every probe_interval). A request stopped that way answers
+ * 504 (deadline) or 499 (client gone) instead of its handler's error status.
+ *
+ * Listed last in the middleware list, so its after_handle runs first and the
+ * other middlewares (metrics, traces) see the final status.
+ */
+struct CancellationMiddleware {
+    struct context {
+        std::unique_ptr<cancellation::Token> token;
+        std::unique_ptr<cancellation::Scope> scope;
+    };
+
+    static constexpr std::chrono::milliseconds probe_interval{50};
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        ctx.token = std::make_unique<cancellation::Token>();
+        const std::string& deadline = req.get_header_value("X-Deadline-Ms");
+        if (!deadline.empty()) {
+            char* end = nullptr;
+            const long long ms = std::strtoll(deadline.c_str(), &end, 10);
+            if (*end == '\0' && ms >= 0) {
+                ctx.token->set_deadline(cancellation::Token::Clock::now() + std::chrono::milliseconds(ms));
+            }
+        }
+        if (req.peer_closed) ctx.token->set_probe(req.peer_closed, probe_interval);
+        ctx.scope = std::make_unique<cancellation::Scope>(ctx.token.get());
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        ctx.scope.reset();
+        if (ctx.token && ctx.token->reason() && res.code >= 400) {
+            res.code = ctx.token->expired() ? 504 : 499;
+        }
+        ctx.token.reset();
+    }
+};
+
+#endif // CANCELLATION_MIDDLEWARE_H
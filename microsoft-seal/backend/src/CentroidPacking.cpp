@@ -0,0 +1,73 @@
+#include "CentroidPacking.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+CentroidPacking::CentroidPacking(size_t features, size_t centroids, size_t slots)
+    : features(features), centroids(centroids), slots(slots) {
+    if (features == 0 || centroids == 0) throw std::invalid_argument("Expected at least one feature and centroid");
+    while (block < features) block <<= 1;
+    while (copies < centroids) copies <<= 1;
+    if (features > slots || copies > slots / block) {
+        throw std::invalid_argument(std::to_string(centroids) + " centroids of " + std::to_string(features) +
+                                    " features take more than the " + std::to_string(slots) + " slots per patient");
+    }
+}
+
+std::vector<double> CentroidPacking::pack(const std::vector<std::vector<double>>& patients) const {
+    const size_t per_ciphertext = patients_per_ciphertext();
+    const size_t ciphertexts = (patients.size() + per_ciphertext - 1) / per_ciphertext;
+    std::vector<double> values(ciphertexts * slots, 0.0);
+    size_t used = 0;
+    for (size_t i = 0; i < patients.size(); i++) {
+        if (patients[i].size() != features) throw std::invalid_argument("Patients differ in feature count");
+        const size_t offset = (i / per_ciphertext) * slots;
+        for (size_t j = 0; j < centroids; j++) {
+            for (size_t f = 0; f < features; f++) {
+                const size_t index = offset + slot(i % per_ciphertext, j, f);
+                values[index] = patients[i][f];
+                used = std::max(used, index + 1);
+            }
+        }
+    }
+    values.resize(used);
+    return values;
+}
+
+std::vector<double> CentroidPacking::replicate(const std::vector<std::vector<double>>& centroid_rows) const {
+    if (centroid_rows.size() != centroids) {
+        throw std::invalid_argument("Expected " + std::to_string(centroids) + " centroids");
+    }
+    std::vector<double> replicated(slots, 0.0);
+    for (size_t j = 0; j < centroids; j++) {
+        if (centroid_rows[j].size() != features) {
+            throw std::invalid_argument("Expected " + std::to_string(features) + " features per centroid");
+        }
+        for (size_t p = 0; p < patients_per_ciphertext(); p++) {
+            for (size_t f = 0; f < features; f++) replicated[slot(p, j, f)] = centroid_rows[j][f];
+        }
+    }
+    return replicated;
+}
+
+std::vector<std::vector<double>> CentroidPacking::distances(const std::vector<double>& values, size_t count) const {
+    const size_t per_ciphertext = patients_per_ciphertext();
+    std::vector<std::vector<double>> result;
+    for (size_t i = 0; i < count; i++) {
+        const size_t offset = (i / per_ciphertext) * slots;
+        if (offset + distance_slot(i % per_ciphertext, centroids - 1) >= values.size()) break;
+        std::vector<double> row(centroids);
+        for (size_t j = 0; j < centroids; j++) row[j] = values[offset + distance_slot(i % per_ciphertext, j)];
+        result.push_back(std::move(row));
+    }
+    return result;
+}
+
+std::vector<size_t> CentroidPacking::nearest(const std::vector<std::vector<double>>& distances) {
+    std::vector<size_t> result;
+    result.reserve(distances.size());
+    for (const auto& row : distances) {
+        result.push_back(static_cast<size_t>(std::min_element(row.begin(), row.end()) - row.begin()));
+    }
+    return result;
+}
@@ -0,0 +1,73 @@
+#ifndef CENTROID_PACKING_H
+#define CENTROID_PACKING_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Slot layout for the squared distances of many patients to k centroids at
+ * once, e.g. for a k-means or nearest-centroid assignment step
+ *
+ * Each patient takes a group of centroid_block() * block_size() slots: its
+ * features (block_size() the feature count rounded up to a power of two)
+ * repeated once per centroid (centroid_block() the centroid count rounded up
+ * to a power of two). Feature f of patient p's j-th copy sits in slot
+ * p * group + j * block + f, and replicate() puts centroid j's feature f in
+ * the same slot of every group. One subtraction, one square and a sum over
+ * each block (log2 block rotations) then leave patient p's squared distance
+ * to centroid j in distance_slot(p, j): all n x k distances of a ciphertext's
+ * patients, packed, instead of a multiplication and a block sum per centroid
+ * (see HomomorphicEncryption::centroid_distances).
+ */
+class CentroidPacking {
+public:
+    /**
+     * @param features Features per patient
+     * @param centroids Centroids to compare every patient with
+     * @param slots Slots per ciphertext (a power of two)
+     * @throws std::invalid_argument for no features or centroids, or a group larger than slots
+     */
+    CentroidPacking(size_t features, size_t centroids, size_t slots);
+
+    size_t feature_count() const { return features; }
+    size_t centroid_count() const { return centroids; }
+    size_t block_size() const { return block; }
+    size_t centroid_block() const { return copies; }
+    size_t group_size() const { return block * copies; }
+    size_t patients_per_ciphertext() const { return slots / group_size(); }
+
+    // Slot of a feature of the p-th patient of a ciphertext, in its copy for a centroid
+    size_t slot(size_t patient, size_t centroid, size_t feature) const {
+        return patient * group_size() + centroid * block + feature;
+    }
+    // Slot holding the p-th patient's squared distance to a centroid after the block sum
+    size_t distance_slot(size_t patient, size_t centroid) const { return slot(patient, centroid, 0); }
+
+    /**
+     * Slot values of the ciphertexts holding these patients, one slots-long
+     * chunk per ciphertext (the last one trimmed), for encrypt_vector
+     * @throws std::invalid_argument for a patient with another feature count
+     */
+    std::vector<double> pack(const std::vector<std::vector<double>>& patients) const;
+
+    /**
+     * One slots-long vector with centroid j's features in every group's j-th copy
+     * @throws std::invalid_argument for another centroid or feature count
+     */
+    std::vector<double> replicate(const std::vector<std::vector<double>>& centroids) const;
+
+    // The first count patients' distances (one per centroid) from decrypted ciphertexts
+    std::vector<std::vector<double>> distances(const std::vector<double>& values, size_t count) const;
+
+    // Index of each patient's nearest centroid, the first on ties
+    static std::vector<size_t> nearest(const std::vector<std::vector<double>>& distances);
+
+private:
+    size_t features;
+    size_t centroids;
+    size_t slots;
+    size_t block = 1;
+    size_t copies = 1;
+};
+
+#endif // CENTROID_PACKING_H
@@ -0,0 +1,72 @@
+/**
+ * CiphertextPool.cpp
+ *
+ * Thread-local free lists of ciphertexts by parms_id and size.
+ */
+
+#include "CiphertextPool.h"
+#include "Metrics.h"
+#include <atomic>         // For the limit shared by all threads
+#include <map>            // For the lists by key
+#include <utility>        // For std::pair, std::move
+#include <vector>         // For each key's list
+
+namespace {
+    std::atomic<size_t> limit{16 << 20};
+
+    struct Lists {
+        std::map<std::pair<seal::parms_id_type, size_t>, std::vector<seal::Ciphertext>> free;
+        size_t bytes = 0;
+    };
+    thread_local Lists lists;
+
+    size_t allocated_bytes(const seal::Ciphertext& ciphertext) {
+        return ciphertext.dyn_array().capacity() * sizeof(seal::Ciphertext::ct_coeff_type);
+    }
+
+    metrics::Counter& takes(const char* result) {
+        return metrics::counter("he_ciphertext_pool_total",
+                                "Ciphertexts taken by whether a recycled one was reused (hit, miss)",
+                                {{"result", result}});
+    }
+}
+
+namespace ciphertext_pool {
+    void set_thread_limit(size_t bytes) {
+        limit.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t thread_limit() {
+        return limit.load(std::memory_order_relaxed);
+    }
+
+    seal::Ciphertext take(const seal::parms_id_type& parms_id, size_t size) {
+        static metrics::Counter& hits = takes("hit");
+        static metrics::Counter& misses = takes("miss");
+        auto found = lists.free.find({parms_id, size});
+        if (found == lists.free.end() || found->second.empty()) {
+            misses.add(1);
+            return seal::Ciphertext();
+        }
+        seal::Ciphertext ciphertext = std::move(found->second.back());
+        found->second.pop_back();
+        lists.bytes -= allocated_bytes(ciphertext);
+        hits.add(1);
+        return ciphertext;
+    }
+
+    void recycle(seal::Ciphertext&& ciphertext) {
+        seal::Ciphertext kept = std::move(ciphertext);
+        const size_t bytes = allocated_bytes(kept);
+        if (bytes == 0 || kept.size() == 0 || kept.is_view() || kept.pool() != seal::MemoryManager::GetPool() ||
+            lists.bytes + bytes > thread_limit()) {
+            return;  // Freed as usual
+        }
+        lists.bytes += bytes;
+        lists.free[{kept.parms_id(), kept.size()}].push_back(std::move(kept));
+    }
+
+    size_t thread_bytes() {
+        return lists.bytes;
+    }
+}
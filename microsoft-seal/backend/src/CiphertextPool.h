@@ -0,0 +1,45 @@
+#ifndef CIPHERTEXT_POOL_H
+#define CIPHERTEXT_POOL_H
+
+#include "seal/seal.h"
+#include <cstddef>
+
+/**
+ * Per-thread free lists of ciphertexts, reused across requests
+ *
+ * Every operand a handler deserializes, and every sum or result it computes,
+ * used to be a fresh seal::Ciphertext: its 2 * N * L coefficients allocated
+ * from the SEAL pool (under the pool's lock) and its metadata set up, only to
+ * be freed again once the response is serialized. Handlers now recycle()
+ * the ciphertexts they are done with, and take() hands them out again by
+ * (parms_id, size): Ciphertext::load_in_place, Evaluator destinations and
+ * copies all write into an allocation that is large enough instead of
+ * making a new one, so in the steady state an add or sum allocates nothing.
+ *
+ * The lists are thread-local, so neither call locks; a ciphertext recycled on
+ * another thread than it was taken on simply joins that thread's lists. Only
+ * ciphertexts of SEAL's global pool are kept (scratch-pool and arena ones
+ * must not outlive their request) and views are never kept. Each thread keeps
+ * at most set_thread_limit() bytes (--ciphertext-pool-mb) and drops what would
+ * exceed it; memory kept here is in use for the pool trimmer. Hits and
+ * misses are exported as he_ciphertext_pool_total{result=...}.
+ */
+namespace ciphertext_pool {
+    // Bytes of coefficients each thread keeps at most (default 16 MiB); 0 disables the pool
+    void set_thread_limit(size_t bytes);
+    size_t thread_limit();
+
+    /**
+     * A ciphertext last used with this parms_id and size, or an empty one (of the global pool)
+     * Its contents are whatever it held: load into it, or use it as a destination
+     */
+    seal::Ciphertext take(const seal::parms_id_type& parms_id, size_t size);
+
+    // Keep a ciphertext for a later take() on this thread; moved from either way
+    void recycle(seal::Ciphertext&& ciphertext);
+
+    // Bytes the calling thread keeps
+    size_t thread_bytes();
+}
+
+#endif // CIPHERTEXT_POOL_H
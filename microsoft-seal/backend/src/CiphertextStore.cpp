@@ -0,0 +1,791 @@
+/**
+ * CiphertextStore.cpp
+ *
+ * LRU bookkeeping, disk spilling and materialized aggregates for the
+ * server-side column store.
+ * Spilled columns are saved as uncompressed column files, one per handle,
+ * and mapped where they are when read again. Past the disk budget, spill
+ * files move to the object store as they are, under a key naming their
+ * generation, so a late upload of a file since replaced cannot overwrite
+ * the object of the current one.
+ */
+
+#include "CiphertextStore.h"
+#include "ColumnFile.h"   // Spill file layout and mapping
+#include "Metrics.h"      // For per-tier read and transfer counters
+#include "ObjectStore.h"  // Cold tier
+#include "RandomHandle.h" // Handles
+#include "ThreadPool.h"   // Transfer threads
+#include <cmath>          // For std::exp2
+#include <cstdio>         // For std::remove
+#include <iterator>       // For std::back_inserter, std::next
+#include <stdexcept>      // For exception handling
+
+#if defined(_WIN32)
+    #include <direct.h>
+    #include <filesystem>
+#else
+    #include <sys/stat.h>
+#endif
+
+namespace {
+    const size_t transfer_threads = 4;
+    const size_t victim_candidates = 8;        // Least recently used entries compared by frequency
+    const double frequency_half_life = 600.0;  // Seconds
+
+    void count_read(const char* tier) {
+        metrics::counter("he_store_reads_total", "Column store reads by the tier that held the column",
+                         {{"tier", tier}}).add();
+    }
+
+    void count_transfer(const char* op, bool ok) {
+        metrics::counter("he_store_object_transfers_total", "Column store transfers to and from the object store",
+                         {{"op", op}, {"result", ok ? "ok" : "error"}}).add();
+    }
+
+    // mkdir -p: create every missing directory along path
+    void make_directories(const std::string& path) {
+        for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+            std::string prefix = path.substr(0, pos);
+#if defined(_WIN32)
+            _mkdir(prefix.c_str());
+#else
+            ::mkdir(prefix.c_str(), 0700);
+#endif
+            if (pos == std::string::npos) break;
+        }
+    }
+
+    // What new_handle() makes: only such names are looked up in a shared directory
+    bool is_handle(const std::string& handle) {
+        if (handle.size() != 32) return false;
+        for (char c : handle) {
+            if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+        }
+        return true;
+    }
+}
+
+CiphertextStore::CiphertextStore(std::shared_ptr<seal::SEALContext> context, size_t memory_budget,
+                                 std::string spill_dir, bool shared, std::shared_ptr<ObjectStore> cold,
+                                 size_t disk_budget)
+    : context(std::move(context)), memory_budget(memory_budget), spill_dir(std::move(spill_dir)), shared(shared),
+      cold(std::move(cold)), disk_budget(disk_budget) {
+    if (shared && this->spill_dir.empty()) throw std::invalid_argument("A shared column store needs a directory");
+    if (this->cold && (shared || this->spill_dir.empty())) {
+        throw std::invalid_argument("An object store tier needs a spill directory of the store's own");
+    }
+    if (!this->spill_dir.empty()) make_directories(this->spill_dir);
+    if (this->cold) transfers = std::make_unique<ThreadPool>(transfer_threads);
+}
+
+// Spill files and objects only live as long as the process that wrote them; shared files outlive it
+CiphertextStore::~CiphertextStore() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    if (transfers) transfers.reset();  // Finishes the transfers in flight, which update entries
+    if (shared) return;
+    for (const auto& item : entries) {
+        if (item.second.on_disk) std::remove(spill_path(item.first).c_str());
+        if (item.second.cold || item.second.uploaded) cold->remove(object_key(item.first, item.second.generation));
+    }
+}
+
+std::string CiphertextStore::put(Column column, size_t last_slots) {
+    size_t bytes = column_bytes(column);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string handle = new_handle();
+    make_room(bytes, handle);
+
+    Entry entry;
+    entry.count = column.size();
+    entry.last_slots = last_slots;
+    entry.column = std::make_shared<Column>(std::move(column));
+    entry.bytes = bytes;
+    touch(entry);
+    if (shared) write_shared(handle, entry);  // Other replicas serve the handle from here on
+    lru.push_front(handle);
+    entry.lru_position = lru.begin();
+    resident_bytes += bytes;
+    entries.emplace(handle, std::move(entry));
+    return handle;
+}
+
+std::shared_ptr<const CiphertextStore::Column> CiphertextStore::get(const std::string& handle) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return resident(handle, lock).column;
+}
+
+void CiphertextStore::prefetch(const std::vector<std::string>& handles) {
+    if (!cold) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& handle : handles) {
+        auto it = entries.find(handle);
+        if (it != entries.end() && it->second.cold) start_fetch(handle, it->second);
+    }
+}
+
+bool CiphertextStore::erase(const std::string& handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(handle);
+    if (shared) {
+        if (it != entries.end()) forget(it);
+        return is_handle(handle) && std::remove(spill_path(handle).c_str()) == 0;
+    }
+    if (it == entries.end()) return false;
+    remove(it);
+    return true;
+}
+
+size_t CiphertextStore::append(const std::string& handle, Column tail, size_t last_slots, const Merge& merge) {
+    std::lock_guard<std::mutex> append_lock(append_mutex);
+    std::map<std::string, Aggregate> aggregates;
+    std::unique_ptr<seal::Ciphertext> merged;  // The column's new last ciphertext, if the tail fits into it
+    size_t used = 0;
+    FileVersion version;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        bool mergeable = merge && tail.size() == 1 && last_slots > 0 && find(handle).last_slots > 0;
+        Entry& entry = mergeable ? resident(handle, lock) : find(handle);
+        aggregates = entry.aggregates;
+        version = entry.version;
+        if (mergeable) {
+            merged = std::make_unique<seal::Ciphertext>(entry.column->back());
+            used = entry.last_slots;
+        }
+    }
+    if (merged && !merge(*merged, tail.front(), used, last_slots)) merged.reset();
+
+    // Fold outside the store lock; appends are serialized, so no aggregate can change meanwhile
+    for (auto& item : aggregates) {
+        item.second.fold(item.second.value, tail.data(), tail.size());
+    }
+
+    size_t bytes = merged ? 0 : column_bytes(tail);
+    std::unique_lock<std::mutex> lock(mutex);
+    Entry& entry = resident(handle, lock);
+    if (entry.version != version) {
+        throw std::runtime_error("Column " + handle + " was changed by another replica meanwhile; append again");
+    }
+    if (entry.mapped) {
+        // Copy the views into memory; requests still reading them keep the mapping
+        make_room(entry.bytes + bytes, handle);
+        entry.column = std::make_shared<Column>(*entry.column);
+        entry.mapped = false;
+        drop_file(handle, entry);
+        lru.push_front(handle);
+        entry.lru_position = lru.begin();
+        resident_bytes += entry.bytes;
+    } else {
+        make_room(bytes, handle);
+
+        // Requests still reading the column keep the old one
+        if (entry.column.use_count() > 1) entry.column = std::make_shared<Column>(*entry.column);
+    }
+    if (merged) {
+        entry.column->back() = std::move(*merged);
+        entry.last_slots += last_slots;
+    } else {
+        entry.column->reserve(entry.column->size() + tail.size());
+        std::move(tail.begin(), tail.end(), std::back_inserter(*entry.column));
+        entry.last_slots = last_slots;
+    }
+    entry.count = entry.column->size();
+    entry.bytes += bytes;
+    resident_bytes += bytes;
+    entry.aggregates = std::move(aggregates);
+    if (shared) {
+        try {
+            write_shared(handle, entry);
+        } catch (...) {
+            forget(entries.find(handle));  // Reloaded from the unchanged file when next used
+            throw;
+        }
+    }
+    return entry.count;
+}
+
+seal::Ciphertext CiphertextStore::aggregate(const std::string& handle, const std::string& name, const Fold& fold) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = find(handle);
+        auto it = entry.aggregates.find(name);
+        if (it != entry.aggregates.end()) return it->second.value;
+    }
+
+    // First read: fold the whole column, holding off appends that would miss the new aggregate
+    std::lock_guard<std::mutex> append_lock(append_mutex);
+    std::shared_ptr<const Column> column;
+    FileVersion version;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        Entry& found = find(handle);
+        auto it = found.aggregates.find(name);
+        if (it != found.aggregates.end()) return it->second.value;
+        Entry& entry = resident(handle, lock);
+        column = entry.column;
+        version = entry.version;
+    }
+
+    Aggregate aggregate{ seal::Ciphertext(), fold };
+    fold(aggregate.value, column->data(), column->size());
+
+    // Not kept for a column another replica changed meanwhile
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(handle);
+    if (it != entries.end() && it->second.version == version) {
+        it->second.aggregates[name] = aggregate;
+    }
+    return aggregate.value;
+}
+
+size_t CiphertextStore::rebuild(const std::string& handle) {
+    std::lock_guard<std::mutex> append_lock(append_mutex);
+    std::map<std::string, Aggregate> aggregates;
+    std::shared_ptr<const Column> column;
+    FileVersion version;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (find(handle).aggregates.empty()) return 0;
+        Entry& entry = resident(handle, lock);
+        column = entry.column;
+        aggregates = entry.aggregates;
+        version = entry.version;
+    }
+
+    for (auto& item : aggregates) {
+        item.second.value = seal::Ciphertext();
+        item.second.fold(item.second.value, column->data(), column->size());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(handle);
+    if (it != entries.end() && it->second.version == version) {
+        it->second.aggregates = aggregates;
+    }
+    return aggregates.size();
+}
+
+size_t CiphertextStore::count(const std::string& handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return find(handle).count;
+}
+
+size_t CiphertextStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t CiphertextStore::memory_usage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return resident_bytes;
+}
+
+CiphertextStore::TierUsage CiphertextStore::tier_usage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    TierUsage usage;
+    usage.memory_columns = lru.size();
+    usage.memory_bytes = resident_bytes;
+    usage.disk_columns = disk_lru.size();
+    usage.disk_bytes = disk_bytes;
+    usage.object_columns = cold_columns;
+    usage.object_bytes = cold_bytes;
+    return usage;
+}
+
+MemoryBudget::Usage CiphertextStore::budget_usage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return MemoryBudget::Usage{lru.size(), resident_bytes, static_cast<double>(resident_bytes) * spill_us_per_byte};
+}
+
+bool CiphertextStore::eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tenant || spill_dir.empty()) return false;
+    std::string handle = victim(lru, "", false);
+    if (handle.empty()) return false;
+    const Entry& entry = entries.at(handle);
+    candidate =
+        MemoryBudget::Candidate{entry.touched, entry.bytes, static_cast<double>(entry.bytes) * spill_us_per_byte};
+    return true;
+}
+
+// A spill that fails (e.g. the disk is full) leaves the column resident and evicts nothing
+bool CiphertextStore::evict(const std::string* tenant, MemoryBudget::Candidate& evicted) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tenant || spill_dir.empty()) return false;
+    std::string handle = victim(lru, "", false);
+    if (handle.empty()) return false;
+    Entry& entry = entries.at(handle);
+    MemoryBudget::Candidate spilled{entry.touched, entry.bytes, static_cast<double>(entry.bytes) * spill_us_per_byte};
+    try {
+        spill(handle, entry);
+    } catch (const std::exception&) {
+        return false;
+    }
+    evicted = spilled;
+    return true;
+}
+
+MemoryBudget::Usage CiphertextStore::expire(MemoryBudget::Clock::time_point before) {
+    std::lock_guard<std::mutex> lock(mutex);
+    MemoryBudget::Usage expired;
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto next = std::next(it);
+        const Entry& entry = it->second;
+        if (entry.touched < before) {
+            if (entry.column && !entry.mapped) {
+                expired.bytes += entry.bytes;
+                expired.rebuild_us += static_cast<double>(entry.bytes) * spill_us_per_byte;
+            }
+            expired.entries++;
+            if (shared) {
+                forget(it);
+            } else {
+                remove(it);
+            }
+        }
+        it = next;
+    }
+    return expired;
+}
+
+/**
+ * Random 128-bit handle in hex (see random_handle): the store takes no tenants,
+ * so the handle is all that keeps one client from another's columns
+ * Called with the mutex held
+ */
+std::string CiphertextStore::new_handle() {
+    std::string handle;
+    do {
+        handle = random_handle();
+    } while (entries.count(handle));
+    return handle;
+}
+
+/**
+ * An entry by handle. In a shared store the file is the column: the entry is
+ * mapped from it if there is none here, or again if the file is not the
+ * version the entry was made from, and forgotten if the file is gone
+ * Called with the mutex held
+ */
+CiphertextStore::Entry& CiphertextStore::find(const std::string& handle) {
+    auto it = entries.find(handle);
+    if (shared) {
+        FileVersion version;
+        if (!is_handle(handle) || !file_version(spill_path(handle), version)) {
+            if (it != entries.end()) forget(it);
+            throw std::out_of_range("Unknown ciphertext handle: " + handle);
+        }
+        if (it != entries.end() && it->second.version != version) {
+            forget(it);
+            it = entries.end();
+        }
+        if (it == entries.end()) {
+            Entry entry;
+            entry.column = reload(handle, true);
+            entry.mapped = true;
+            entry.count = entry.column->size();
+            entry.bytes = column_bytes(*entry.column);
+            entry.version = version;
+            it = entries.emplace(handle, std::move(entry)).first;
+        }
+    }
+    if (it == entries.end()) throw std::out_of_range("Unknown ciphertext handle: " + handle);
+    return it->second;
+}
+
+/**
+ * Drop an entry from memory, leaving any file or object of it
+ * Called with the mutex held
+ */
+void CiphertextStore::forget(std::unordered_map<std::string, Entry>::iterator it) {
+    Entry& entry = it->second;
+    if (entry.column && !entry.mapped) {
+        lru.erase(entry.lru_position);
+        resident_bytes -= entry.bytes;
+    }
+    if (entry.on_disk) {
+        disk_lru.erase(entry.disk_position);
+        disk_bytes -= entry.file_bytes;
+        if (entry.uploading) uploading_bytes -= entry.file_bytes;
+    }
+    if (entry.cold) {
+        cold_columns--;
+        cold_bytes -= entry.file_bytes;
+    }
+    entries.erase(it);
+}
+
+/**
+ * Drop an entry with its spill file and object; not for a shared store
+ * Called with the mutex held
+ */
+void CiphertextStore::remove(std::unordered_map<std::string, Entry>::iterator it) {
+    if (it->second.on_disk) std::remove(spill_path(it->first).c_str());
+    if (it->second.cold || it->second.uploaded) remove_object(it->first, it->second.generation);
+    forget(it);
+}
+
+/**
+ * Write a resident entry's column to the shared directory, replacing the
+ * file atomically, and note the file's version
+ * Called with the mutex held
+ */
+void CiphertextStore::write_shared(const std::string& handle, Entry& entry) {
+    std::string path = spill_path(handle);
+    ColumnFile::write(path, *context, *entry.column, seal::compr_mode_type::none);
+    if (!file_version(path, entry.version)) throw std::runtime_error("Could not read back " + path);
+}
+
+/**
+ * An entry by handle, made resident. One in the object store is fetched
+ * first, with the mutex released meanwhile, so the reference is to the
+ * entry as found afterwards
+ * Called with the mutex held by lock
+ */
+CiphertextStore::Entry& CiphertextStore::resident(const std::string& handle, std::unique_lock<std::mutex>& lock) {
+    Entry* entry = &find(handle);
+    count_read(entry->cold ? "object" : entry->column && !entry->mapped ? "memory" : "disk");
+    while (entry->cold) {
+        std::shared_future<void> download = start_fetch(handle, *entry);
+        lock.unlock();
+        download.get();
+        lock.lock();
+        entry = &find(handle);  // Demoted again meanwhile under pressure: fetch again
+    }
+    make_resident(handle, *entry);
+    return *entry;
+}
+
+/**
+ * Mark an entry as most recently used, or map it from the spill directory
+ * if it was spilled. Mapped entries stay mapped (and out of the LRU order)
+ * until appended to
+ * Called with the mutex held; not for entries in the object store
+ */
+void CiphertextStore::make_resident(const std::string& handle, Entry& entry) {
+    touch(entry);
+    if (entry.column && !entry.mapped) {
+        lru.splice(lru.begin(), lru, entry.lru_position);
+        return;
+    }
+
+    if (!entry.column) {
+        entry.column = reload(handle, shared || entry.fetched);  // Unless shared or fetched, this store wrote the file
+        entry.mapped = true;
+    }
+    if (entry.on_disk) disk_lru.splice(disk_lru.begin(), disk_lru, entry.disk_position);
+}
+
+std::string CiphertextStore::spill_path(const std::string& handle) const {
+    return spill_dir + "/" + handle + ".hecol";
+}
+
+std::string CiphertextStore::object_key(const std::string& handle, uint64_t generation) const {
+    return handle + "." + std::to_string(generation) + ".hecol";
+}
+
+/**
+ * Of the least recently used entries at the back of order, the least
+ * frequently used one ("" if none may go); keep, and when skip_uploading
+ * entries being uploaded, are passed over
+ * Called with the mutex held
+ */
+std::string CiphertextStore::victim(const std::list<std::string>& order, const std::string& keep,
+                                    bool skip_uploading) const {
+    const auto now = std::chrono::steady_clock::now();
+    std::string best;
+    double lowest = 0.0;
+    size_t candidates = 0;
+    for (auto it = order.rbegin(); it != order.rend() && candidates < victim_candidates; ++it) {
+        if (*it == keep) continue;
+        const Entry& entry = entries.at(*it);
+        if (skip_uploading && entry.uploading) continue;
+        candidates++;
+        double used = frequency(entry, now);
+        if (best.empty() || used < lowest) {
+            best = *it;
+            lowest = used;
+        }
+    }
+    return best;
+}
+
+/**
+ * Evict entries until bytes more fit into the budget
+ * Called with the mutex held; keep is never evicted
+ */
+void CiphertextStore::make_room(size_t bytes, const std::string& keep) {
+    if (memory_budget == 0) return;
+    if (bytes > memory_budget) throw std::runtime_error("Column exceeds the ciphertext store memory budget");
+
+    while (resident_bytes + bytes > memory_budget) {
+        if (spill_dir.empty()) throw std::runtime_error("Ciphertext store is full");
+        std::string handle = victim(lru, keep, false);
+        if (handle.empty()) break;
+        spill(handle, entries[handle]);
+    }
+}
+
+/**
+ * Write a resident entry to the spill directory and drop it from memory; a
+ * shared directory holds it already
+ * Called with the mutex held
+ */
+void CiphertextStore::spill(const std::string& handle, Entry& entry) {
+    if (!shared) {
+        auto start = std::chrono::steady_clock::now();
+        ColumnFile::write(spill_path(handle), *context, *entry.column, seal::compr_mode_type::none);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (entry.bytes > 0) spill_us_per_byte = 0.9 * spill_us_per_byte + 0.1 * us / static_cast<double>(entry.bytes);
+        entry.generation++;
+        add_to_disk(handle, entry);
+    }
+
+    lru.erase(entry.lru_position);
+    resident_bytes -= entry.bytes;
+    entry.column.reset();
+    if (!shared) make_disk_room("");
+}
+
+/**
+ * Count an entry's new spill file (written or fetched) in the disk tier
+ * Called with the mutex held
+ */
+void CiphertextStore::add_to_disk(const std::string& handle, Entry& entry) {
+    FileVersion version;
+    entry.file_bytes = file_version(spill_path(handle), version) ? static_cast<size_t>(version.size) : entry.bytes;
+    entry.on_disk = true;
+    disk_lru.push_front(handle);
+    entry.disk_position = disk_lru.begin();
+    disk_bytes += entry.file_bytes;
+}
+
+/**
+ * Delete an entry's spill file, and its object, which is stale from here on
+ * Called with the mutex held
+ */
+void CiphertextStore::drop_file(const std::string& handle, Entry& entry) {
+    if (entry.on_disk) {
+        disk_lru.erase(entry.disk_position);
+        disk_bytes -= entry.file_bytes;
+        if (entry.uploading) uploading_bytes -= entry.file_bytes;
+        entry.on_disk = false;
+        entry.uploading = false;
+        entry.fetched = false;
+    }
+    std::remove(spill_path(handle).c_str());
+    if (entry.uploaded) {
+        remove_object(handle, entry.generation);
+        entry.uploaded = false;
+    }
+}
+
+/**
+ * Move spill files to the object store until the rest fit into the disk
+ * budget, counting those being uploaded as gone. Files the object store has
+ * already are deleted right away; the others are uploaded first, and
+ * deleted by evict_to_cold once that succeeded
+ * Called with the mutex held; keep is never evicted
+ */
+void CiphertextStore::make_disk_room(const std::string& keep) {
+    if (!cold || disk_budget == 0 || closing) return;
+
+    while (disk_bytes - uploading_bytes > disk_budget) {
+        std::string handle = victim(disk_lru, keep, true);
+        if (handle.empty()) break;
+        Entry& entry = entries[handle];
+        if (entry.uploaded) {
+            evict_to_cold(handle, entry);
+            continue;
+        }
+        entry.uploading = true;
+        uploading_bytes += entry.file_bytes;
+        uint64_t generation = entry.generation;
+        transfers->post([this, handle, generation] { upload(handle, generation); });
+    }
+}
+
+/**
+ * Upload a spill file, then evict it if the disk is still over budget. A
+ * failed upload leaves the file where it is until the next spill tries
+ * again; an object of a file replaced or erased meanwhile is deleted
+ * Runs on a transfer thread
+ */
+void CiphertextStore::upload(const std::string& handle, uint64_t generation) {
+    bool ok = true;
+    try {
+        cold->put(object_key(handle, generation), spill_path(handle));
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    count_transfer("upload", ok);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(handle);
+    if (it == entries.end() || !it->second.on_disk || !it->second.uploading || it->second.generation != generation) {
+        if (ok) remove_object(handle, generation);
+        return;
+    }
+    Entry& entry = it->second;
+    entry.uploading = false;
+    uploading_bytes -= entry.file_bytes;
+    if (!ok) return;
+    entry.uploaded = true;
+    make_disk_room("");
+}
+
+/**
+ * Delete the spill file of an entry the object store has, leaving it in
+ * the cold tier. Requests still reading its views keep the mapping
+ * Called with the mutex held
+ */
+void CiphertextStore::evict_to_cold(const std::string& handle, Entry& entry) {
+    disk_lru.erase(entry.disk_position);
+    disk_bytes -= entry.file_bytes;
+    std::remove(spill_path(handle).c_str());
+    entry.on_disk = false;
+    entry.fetched = false;
+    entry.column.reset();
+    entry.mapped = false;
+    entry.cold = true;
+    cold_columns++;
+    cold_bytes += entry.file_bytes;
+}
+
+/**
+ * The download of a cold entry's file, started unless one is in flight
+ * Called with the mutex held
+ */
+std::shared_future<void> CiphertextStore::start_fetch(const std::string& handle, Entry& entry) {
+    if (!entry.fetch.valid()) {
+        uint64_t generation = entry.generation;
+        auto task = std::make_shared<std::packaged_task<void()>>([this, handle, generation] {
+            fetch(handle, generation);
+        });
+        entry.fetch = task->get_future().share();
+        transfers->post([task] { (*task)(); });
+    }
+    return entry.fetch;
+}
+
+/**
+ * Download a cold entry's file into the spill directory and move the entry
+ * to the disk tier; its object stays, so evicting it again costs no upload
+ * Runs on a transfer thread
+ * @throws std::runtime_error if the download fails (a later read tries again)
+ */
+void CiphertextStore::fetch(const std::string& handle, uint64_t generation) {
+    std::string path = spill_path(handle);
+    try {
+        cold->get(object_key(handle, generation), path);
+    } catch (const std::exception& e) {
+        count_transfer("download", false);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(handle);
+        if (it != entries.end()) it->second.fetch = {};
+        throw std::runtime_error("Could not fetch column " + handle + " from " + cold->location() + ": " + e.what());
+    }
+    count_transfer("download", true);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(handle);
+    if (it == entries.end() || !it->second.cold) {
+        std::remove(path.c_str());  // Erased meanwhile
+        return;
+    }
+    Entry& entry = it->second;
+    entry.cold = false;
+    entry.fetch = {};
+    entry.fetched = true;
+    cold_columns--;
+    cold_bytes -= entry.file_bytes;
+    add_to_disk(handle, entry);
+    make_disk_room(handle);
+}
+
+/**
+ * Delete an object on a transfer thread, or right away once the store is closing
+ * Called with the mutex held
+ */
+void CiphertextStore::remove_object(const std::string& handle, uint64_t generation) {
+    std::string key = object_key(handle, generation);
+    if (closing) {
+        cold->remove(key);
+        return;
+    }
+    std::shared_ptr<ObjectStore> objects = cold;
+    transfers->post([objects, key] { objects->remove(key); });
+}
+
+/**
+ * One more access to an entry: its earlier ones count half for every
+ * frequency_half_life since the last
+ */
+void CiphertextStore::touch(Entry& entry) {
+    auto now = std::chrono::steady_clock::now();
+    entry.frequency = frequency(entry, now) + 1.0;
+    entry.touched = now;
+}
+
+double CiphertextStore::frequency(const Entry& entry, std::chrono::steady_clock::time_point now) {
+    double age = std::chrono::duration<double>(now - entry.touched).count();
+    return entry.frequency * std::exp2(-age / frequency_half_life);
+}
+
+/**
+ * Map a spilled entry's file and view its ciphertexts there
+ * Called with the mutex held
+ */
+std::shared_ptr<CiphertextStore::Column> CiphertextStore::reload(const std::string& handle, bool verify) const {
+    std::string path = spill_path(handle);
+    std::shared_ptr<ColumnFile> file;
+    try {
+        file = std::make_shared<ColumnFile>(path);
+    } catch (const std::out_of_range&) {
+        throw std::runtime_error("Spilled ciphertexts missing: " + path);
+    }
+
+    auto column = std::make_unique<Column>();
+    column->reserve(file->layout().blocks);
+    for (size_t block = 0; block < file->layout().blocks; block++) {
+        column->push_back(file->view(*context, block, verify));
+    }
+    // The views go before the mapping they alias
+    return std::shared_ptr<Column>(column.release(), [file](Column* views) { delete views; });
+}
+
+// Memory held by a column's coefficient data
+size_t CiphertextStore::column_bytes(const Column& column) {
+    size_t bytes = 0;
+    for (const auto& ct : column) {
+        bytes += ct.dyn_array().size() * sizeof(seal::Ciphertext::ct_coeff_type);
+    }
+    return bytes;
+}
+
+// Version of a file; false if it does not exist
+bool CiphertextStore::file_version(const std::string& path, FileVersion& version) {
+#if defined(_WIN32)
+    std::error_code error;
+    auto mtime = std::filesystem::last_write_time(path, error);
+    if (!error) version.size = std::filesystem::file_size(path, error);
+    if (error) return false;
+    version.time = static_cast<int64_t>(mtime.time_since_epoch().count());
+#else
+    struct stat status;
+    if (::stat(path.c_str(), &status) != 0) return false;
+    version.inode = static_cast<uint64_t>(status.st_ino);
+#if defined(__APPLE__)
+    const struct timespec& mtime = status.st_mtimespec;
+#else
+    const struct timespec& mtime = status.st_mtim;
+#endif
+    version.time = static_cast<int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec;
+    version.size = static_cast<uint64_t>(status.st_size);
+#endif
+    return true;
+}
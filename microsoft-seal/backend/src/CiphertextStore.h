@@ -0,0 +1,284 @@
+#ifndef CIPHERTEXT_STORE_H
+#define CIPHERTEXT_STORE_H
+
+#include "MemoryBudget.h"
+#include "seal/seal.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ObjectStore;
+class ThreadPool;
+
+/**
+ * In-memory store of deserialized encrypted columns, addressed by handle
+ *
+ * Clients upload a column once and then run any number of operations on it
+ * by handle, so ciphertexts are neither re-sent nor re-parsed per request.
+ * Entries are kept in least-recently-used order; with a memory budget and a
+ * spill directory configured, the coldest entries are written to disk as
+ * column files (ColumnFile.h) and, when accessed again, mapped rather than
+ * read back: their ciphertexts are read-only views of the mapping, which
+ * cost nothing against the budget and leave paging them to the OS. An
+ * append copies a mapped column back into memory.
+ *
+ * An object store (ObjectStore.h) adds a cold tier below the spill
+ * directory: once the spill files take more than the disk budget, the
+ * coldest are uploaded there and deleted locally, and a read of such a
+ * column downloads its file back into the spill directory and maps it.
+ * Uploads and downloads run on the store's own threads, outside its lock, and
+ * prefetch() starts the downloads of columns a request is about to read, so
+ * they overlap one another and the work on columns already at hand. A file
+ * fetched back keeps its object until the column changes, so a column read
+ * over and over is uploaded once.
+ *
+ * Victims, from memory to disk and from disk to the object store, are the
+ * least frequently used among the few least recently used entries of their
+ * tier: each access adds one to an entry's frequency, which halves every ten
+ * minutes, so a column scanned once does not push out one read every minute.
+ *
+ * Columns can grow: append() adds ciphertexts to a stored column and folds
+ * them into every aggregate materialized for it by aggregate(), so a running
+ * sum costs one reduction of the new ciphertexts plus one addition per
+ * append, and reading it does not touch the column at all. Aggregates stay in
+ * memory while their column is spilled and are not counted against the
+ * memory budget.
+ *
+ * Packed columns that say how many slots their last ciphertext fills (from
+ * slot 0 up) take small appends into that ciphertext's free slots instead of
+ * a ciphertext of their own: a few hundred values arriving per request would
+ * otherwise each cost a full ciphertext to keep and to fold. The values stay
+ * in order, so the column decrypts as before, and as the free slots were
+ * zero every slot-wise aggregate folds the moved values to the same result.
+ *
+ * A shared spill directory, on storage every replica of a stateless
+ * main-backend mounts, makes the store a cache of that directory instead:
+ * every column is written there when stored or appended to, and handles this
+ * process has not seen are mapped from there, so any replica serves any
+ * handle. Each access compares the file's modification time and size with
+ * the version cached, so a column another replica appended to or erased is
+ * dropped here, aggregates included. Appends to one column are serialized
+ * within a process only: send them to one replica (see RouteHintMiddleware.h).
+ * Evicted columns are dropped rather than spilled, as their files are current.
+ *
+ * Under a MemoryBudget, columns unused for the TTL are erased, handle and
+ * files, as by erase() (in a shared directory they are only dropped from
+ * memory: other replicas may still use them). With a spill directory the
+ * budget may also spill resident columns, costed at the rate spills have
+ * been written so far; without one, columns are the only copy and are never
+ * evicted, only counted.
+ *
+ * One store is used per SEAL context (i.e. per scheme). All methods are
+ * thread-safe; get() hands out shared ownership so an entry being evicted
+ * stays valid for requests still using it.
+ */
+class CiphertextStore : public MemoryBudget::Consumer {
+public:
+    using Column = std::vector<seal::Ciphertext>;
+
+    /**
+     * Folds count ciphertexts into an aggregate, which is empty (size 0) on the
+     * first call. Must be additive: folding a column piecewise gives the
+     * same result as folding it at once
+     */
+    using Fold = std::function<void(seal::Ciphertext& aggregate, const seal::Ciphertext* ciphertexts,
+                                    size_t count)>;
+
+    /**
+     * Moves the values in partial's first slots up by used slots and adds them
+     * into last, whose first used slots hold values and the rest zeros. Returns
+     * false, leaving both unchanged, if they do not fit or the ciphertexts do
+     * not match (level, size, scale). On success partial holds the moved
+     * values, which append() folds into the aggregates
+     */
+    using Merge = std::function<bool(seal::Ciphertext& last, seal::Ciphertext& partial, size_t used,
+                                     size_t slots)>;
+
+    /**
+     * @param context Context the stored ciphertexts belong to (used to reload spilled entries)
+     * @param memory_budget Bytes of ciphertext data kept in memory (0 = unlimited)
+     * @param spill_dir Directory for entries evicted from memory ("" = no spilling;
+     *                  put() fails once the budget is exhausted)
+     * @param shared spill_dir is shared with other processes and holds every column (see above)
+     * @param cold Object store for spill files past disk_budget (nullptr = none; needs a private spill_dir)
+     * @param disk_budget Bytes of spill files kept in spill_dir when there is an object store (0 = unlimited)
+     */
+    CiphertextStore(std::shared_ptr<seal::SEALContext> context, size_t memory_budget = 0,
+                    std::string spill_dir = "", bool shared = false, std::shared_ptr<ObjectStore> cold = nullptr,
+                    size_t disk_budget = 0);
+    ~CiphertextStore();
+
+    CiphertextStore(const CiphertextStore&) = delete;
+    CiphertextStore& operator=(const CiphertextStore&) = delete;
+
+    /**
+     * Store a column and return its handle
+     * @param last_slots Slots the last ciphertext fills from slot 0 (0 = unknown, never merged into)
+     * @throws std::runtime_error if the column does not fit and spilling is disabled
+     */
+    std::string put(Column column, size_t last_slots = 0);
+
+    /**
+     * Look up a column, mapping it from the spill directory, or fetching it
+     * from the object store first, if necessary
+     * @throws std::out_of_range for unknown handles
+     * @throws std::runtime_error if the object store fails
+     */
+    std::shared_ptr<const Column> get(const std::string& handle);
+
+    // Start fetching those of these columns that are in the object store; unknown handles are ignored
+    void prefetch(const std::vector<std::string>& handles);
+
+    // Remove a column and its aggregates; false if the handle is unknown
+    bool erase(const std::string& handle);
+
+    /**
+     * Append ciphertexts to a stored column and fold them into its materialized
+     * aggregates. A single partially filled ciphertext goes into the free slots
+     * of the column's last one when merge succeeds
+     * @param last_slots Slots the tail's last ciphertext fills from slot 0 (0 = unknown)
+     * @param merge Packs the tail into the last ciphertext (nullptr = always append)
+     * @return Number of ciphertexts in the column afterwards
+     * @throws std::out_of_range for unknown handles; on any error the entry is unchanged
+     */
+    size_t append(const std::string& handle, Column tail, size_t last_slots = 0, const Merge& merge = nullptr);
+
+    /**
+     * Running value of a named aggregate of a column. The first read folds the
+     * whole column and keeps the result, and fold, for later appends; later
+     * reads return the kept value
+     * @throws std::out_of_range for unknown handles
+     */
+    seal::Ciphertext aggregate(const std::string& handle, const std::string& name, const Fold& fold);
+
+    /**
+     * Recompute a column's materialized aggregates from its ciphertexts, e.g.
+     * after a fold was found to be wrong
+     * @return Number of aggregates rebuilt
+     * @throws std::out_of_range for unknown handles
+     */
+    size_t rebuild(const std::string& handle);
+
+    // Number of ciphertexts in a column, without reloading it if spilled
+    size_t count(const std::string& handle);
+
+    size_t size() const;
+    size_t memory_usage() const;
+
+    // Columns and bytes in each tier; disk counts this store's own spill files, not a shared directory
+    struct TierUsage {
+        size_t memory_columns = 0;
+        size_t memory_bytes = 0;
+        size_t disk_columns = 0;
+        size_t disk_bytes = 0;
+        size_t object_columns = 0;
+        size_t object_bytes = 0;
+    };
+    TierUsage tier_usage() const;
+
+    // MemoryBudget::Consumer: resident columns, spilled to evict; the store takes no tenants
+    MemoryBudget::Usage budget_usage() const override;
+    bool eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const override;
+    bool evict(const std::string* tenant, MemoryBudget::Candidate& evicted) override;
+    MemoryBudget::Usage expire(MemoryBudget::Clock::time_point before) override;
+
+private:
+    struct Aggregate {
+        seal::Ciphertext value;
+        Fold fold;
+    };
+
+    // Files are replaced on every write, so a new inode tells another replica's write apart
+    struct FileVersion {
+        uint64_t inode = 0;
+        int64_t time = 0;
+        uint64_t size = 0;
+
+        bool operator==(const FileVersion& other) const {
+            return inode == other.inode && time == other.time && size == other.size;
+        }
+        bool operator!=(const FileVersion& other) const { return !(*this == other); }
+    };
+
+    struct Entry {
+        std::shared_ptr<Column> column;  // nullptr while spilled
+        bool mapped = false;             // column views the spill file and is not in lru
+        size_t bytes = 0;
+        size_t count = 0;
+        size_t last_slots = 0;           // Filled slots of the last ciphertext, 0 if unknown
+        std::list<std::string>::iterator lru_position;
+        std::map<std::string, Aggregate> aggregates;
+        FileVersion version;             // Of the shared file the entry caches
+
+        bool on_disk = false;            // Has a spill file of this store's own; in disk_lru
+        bool cold = false;               // Only in the object store
+        bool uploaded = false;           // The object store has the current spill file
+        bool uploading = false;
+        bool fetched = false;            // The spill file came from the object store, so is checked when mapped
+        uint64_t generation = 0;         // Of the spill file; names its object
+        size_t file_bytes = 0;           // Of the spill file or object
+        std::list<std::string>::iterator disk_position;
+        std::shared_future<void> fetch;  // Download in flight
+        double frequency = 0.0;          // Accesses, decayed (see touch())
+        std::chrono::steady_clock::time_point touched;
+    };
+
+    std::shared_ptr<seal::SEALContext> context;
+    size_t memory_budget;
+    std::string spill_dir;
+    bool shared;
+    std::shared_ptr<ObjectStore> cold;
+    size_t disk_budget;
+
+    mutable std::mutex mutex;
+    std::mutex append_mutex;  // Serializes appends, rebuilds and new aggregates; taken before mutex
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru;  // Resident entries, most recently used first
+    size_t resident_bytes = 0;  // Of columns in lru; mapped ones are not counted
+    std::list<std::string> disk_lru;  // Entries with a spill file of this store's own, most recently used first
+    size_t disk_bytes = 0;
+    size_t uploading_bytes = 0;  // Of disk_lru entries being uploaded
+    size_t cold_columns = 0;
+    size_t cold_bytes = 0;
+    double spill_us_per_byte = 1e-3;  // Measured by spill(), from 1 GB/s
+    bool closing = false;  // Being destroyed: no new transfers
+    std::unique_ptr<ThreadPool> transfers;  // Object store uploads and downloads; finished first on destruction
+
+    std::string new_handle();
+    Entry& find(const std::string& handle);
+    void forget(std::unordered_map<std::string, Entry>::iterator it);
+    void remove(std::unordered_map<std::string, Entry>::iterator it);
+    void write_shared(const std::string& handle, Entry& entry);
+    Entry& resident(const std::string& handle, std::unique_lock<std::mutex>& lock);
+    void make_resident(const std::string& handle, Entry& entry);
+    std::string spill_path(const std::string& handle) const;
+    std::string object_key(const std::string& handle, uint64_t generation) const;
+    std::string victim(const std::list<std::string>& order, const std::string& keep, bool skip_uploading) const;
+    void make_room(size_t bytes, const std::string& keep);
+    void spill(const std::string& handle, Entry& entry);
+    void add_to_disk(const std::string& handle, Entry& entry);
+    void drop_file(const std::string& handle, Entry& entry);
+    void make_disk_room(const std::string& keep);
+    void upload(const std::string& handle, uint64_t generation);
+    void evict_to_cold(const std::string& handle, Entry& entry);
+    std::shared_future<void> start_fetch(const std::string& handle, Entry& entry);
+    void fetch(const std::string& handle, uint64_t generation);
+    void remove_object(const std::string& handle, uint64_t generation);
+    std::shared_ptr<Column> reload(const std::string& handle, bool verify) const;
+
+    static void touch(Entry& entry);
+    static double frequency(const Entry& entry, std::chrono::steady_clock::time_point now);
+
+    static size_t column_bytes(const Column& column);
+    static bool file_version(const std::string& path, FileVersion& version);
+};
+
+#endif // CIPHERTEXT_STORE_H
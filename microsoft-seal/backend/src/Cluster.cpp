@@ -0,0 +1,285 @@
+/**
+ * Cluster.cpp
+ *
+ * Worker discovery, retried calls to workers and the sharded column table.
+ */
+
+#include "Cluster.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "RandomHandle.h"  // For column handles
+#include <atomic>         // For scatter_async's count of running calls
+#include <future>         // For scatter's outcomes
+#include <memory>         // For scatter_async's shared state
+#include <stdexcept>      // For std::out_of_range
+
+namespace {
+    metrics::Counter& calls(const char* result) {
+        return metrics::counter("he_cluster_calls_total", "Calls to worker nodes by result", {{"result", result}});
+    }
+}
+
+// A static worker's RPC listener is on the host of its HTTP address
+Cluster::Cluster(Options options)
+    : options(std::move(options)), rpc_client(this->options.timeout),
+      call_pool(this->options.call_threads, {}, [] { metrics::label_thread("cluster"); }) {
+    for (const auto& entry : this->options.workers) {
+        size_t slash = entry.find('/');
+        std::string address = entry.substr(0, slash);
+        Worker& worker = known[address];
+        if (slash != std::string::npos) {
+            worker.rpc = address.substr(0, address.rfind(':') + 1) + entry.substr(slash + 1);
+        }
+    }
+}
+
+Cluster::~Cluster() {
+    shutdown();
+}
+
+void Cluster::shutdown() {
+    std::unique_lock<std::mutex> lock(mutex);
+    stopping = true;
+    drained.wait(lock, [this] { return scatters == 0; });
+}
+
+void Cluster::register_worker(const std::string& address, const std::string& rpc) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = known.find(address);
+    if (it == known.end()) {
+        it = known.emplace(address, Worker()).first;
+        it->second.registered = true;
+        HE_LOG(Info) << "Cluster worker registered: " << address << (rpc.empty() ? "" : " (RPC " + rpc + ")");
+    }
+    if (it->second.registered) it->second.rpc = rpc;
+    it->second.heartbeat = Clock::now();
+    it->second.down_until = Clock::time_point();
+}
+
+// Called with the mutex held
+bool Cluster::live(const Worker& worker, Clock::time_point now) const {
+    if (worker.down_until > now) return false;
+    return !worker.registered || now - worker.heartbeat < options.worker_ttl;
+}
+
+std::vector<Cluster::WorkerInfo> Cluster::workers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = Clock::now();
+    std::vector<WorkerInfo> result;
+    for (const auto& item : known) {
+        WorkerInfo info;
+        info.address = item.first;
+        info.rpc = item.second.rpc;
+        info.registered = item.second.registered;
+        if (info.registered) {
+            info.heartbeat_age_s = std::chrono::duration<double>(now - item.second.heartbeat).count();
+        }
+        info.down = !live(item.second, now);
+        result.push_back(info);
+    }
+    return result;
+}
+
+std::vector<std::string> Cluster::live_workers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = Clock::now();
+    std::vector<std::string> result;
+    for (const auto& item : known) {
+        if (live(item.second, now)) result.push_back(item.first);
+    }
+    return result;
+}
+
+std::string Cluster::rpc_address(const std::string& address) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = known.find(address);
+    return it == known.end() ? "" : it->second.rpc;
+}
+
+void Cluster::mark_down(const std::string& address) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = known.find(address);
+    if (it != known.end()) it->second.down_until = Clock::now() + options.down_time;
+}
+
+std::vector<Cluster::Outcome> Cluster::scatter(const std::vector<Call>& calls) {
+    std::vector<std::future<Outcome>> running;
+    running.reserve(calls.size());
+    for (const auto& call : calls) {
+        running.push_back(call_pool.submit([this, &call] { return run(call); }));
+    }
+    std::vector<Outcome> outcomes;
+    outcomes.reserve(calls.size());
+    for (auto& outcome : running) outcomes.push_back(outcome.get());
+    return outcomes;
+}
+
+// Counted in scatters until `done` returns, so shutdown() waits for it too
+void Cluster::scatter_async(std::vector<Call> calls, ThreadPool& pool,
+                            std::function<void(std::vector<Outcome>)> done) {
+    struct State {
+        std::vector<Call> calls;
+        std::vector<Outcome> outcomes;
+        std::atomic<size_t> remaining;
+        ThreadPool* pool;
+        std::function<void(std::vector<Outcome>)> done;
+    };
+    auto state = std::make_shared<State>();
+    state->outcomes.resize(calls.size());
+    state->remaining = calls.size();
+    state->calls = std::move(calls);
+    state->pool = &pool;
+    state->done = std::move(done);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scatters++;
+    }
+
+    auto finish = [this, state] {
+        state->pool->post([this, state] {
+            state->done(std::move(state->outcomes));
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--scatters == 0) drained.notify_all();
+        });
+    };
+    if (state->calls.empty()) return finish();
+    for (size_t i = 0; i < state->calls.size(); i++) {
+        call_pool.post([this, state, i, finish] {
+            state->outcomes[i] = run(state->calls[i]);
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) finish();
+        });
+    }
+}
+
+// One call with its retries; the backoff doubles from 100 ms
+Cluster::Outcome Cluster::run(const Call& call) {
+    static metrics::Counter& succeeded = calls("ok");
+    static metrics::Counter& retried = calls("retried");
+    static metrics::Counter& failed = calls("failed");
+
+    Outcome outcome;
+    if (call.workers.empty()) {
+        outcome.error = "No live worker";
+        failed.add();
+        return outcome;
+    }
+    auto start = Clock::now();
+    auto backoff = std::chrono::milliseconds(100);
+    for (size_t attempt = 0; attempt <= options.retries; attempt++) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                outcome.error = "Cluster shutting down";
+                break;
+            }
+        }
+        if (attempt > 0) {
+            retried.add();
+            std::this_thread::sleep_for(backoff);
+            backoff *= 2;
+        }
+        outcome.worker = call.workers[attempt % call.workers.size()];
+        outcome.attempts = attempt + 1;
+        std::string rpc = call.rpc.empty() ? "" : rpc_address(outcome.worker);
+        outcome.rpc = !rpc.empty();
+        try {
+            if (outcome.rpc) {
+                std::vector<node_rpc::Request> requests = call.rpc;
+                if (call.rpc_body) requests.back().payload = call.body;
+                std::vector<const node_rpc::Request*> pipeline;
+                for (const auto& request : requests) pipeline.push_back(&request);
+                std::vector<node_rpc::Response> responses = rpc_client.call(rpc, pipeline);
+                size_t chosen = 0;
+                while (chosen + 1 < responses.size() && responses[chosen].status == 200) chosen++;
+                outcome.response = http_client::Response();
+                outcome.response.status = responses[chosen].status;
+                outcome.response.body = std::move(responses[chosen].payload);
+            } else {
+                outcome.response = http_client::request(outcome.worker, call.method, call.target, call.body,
+                                                        call.content_type, options.timeout);
+            }
+            if (outcome.response.status < 500) {
+                outcome.error.clear();
+                break;
+            }
+            outcome.error = "HTTP " + std::to_string(outcome.response.status) + " from " + outcome.worker;
+        } catch (const std::exception& e) {
+            outcome.response = http_client::Response();
+            outcome.error = e.what();
+        }
+        HE_LOG(Warning) << "Cluster call "
+                        << (outcome.rpc ? std::string("RPC ") + node_rpc::op_name(call.rpc.back().op)
+                                        : call.method + " " + call.target)
+                        << " to " << outcome.worker << " failed (attempt " << attempt + 1 << "): " << outcome.error;
+        // Move on from a worker once the call has tried every other one
+        if (call.workers.size() > 1 || attempt == options.retries) mark_down(outcome.worker);
+    }
+    outcome.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    (outcome.error.empty() ? succeeded : failed).add();
+    return outcome;
+}
+
+// The handle is a random_handle(), as the workers' store handles are
+std::string Cluster::add_column(std::vector<Shard> shards) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string handle;
+    do {
+        handle = random_handle();
+    } while (columns.count(handle));
+    columns[handle] = std::move(shards);
+    return handle;
+}
+
+std::vector<Cluster::Shard> Cluster::column(const std::string& handle) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = columns.find(handle);
+    if (it == columns.end()) throw std::out_of_range("Unknown cluster column handle: " + handle);
+    return it->second;
+}
+
+std::vector<Cluster::Shard> Cluster::erase_column(const std::string& handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = columns.find(handle);
+    if (it == columns.end()) return {};
+    std::vector<Shard> shards = std::move(it->second);
+    columns.erase(it);
+    return shards;
+}
+
+ClusterMember::ClusterMember(std::string coordinator, std::string advertise, std::string advertise_rpc,
+                             std::chrono::seconds interval)
+    : coordinator(std::move(coordinator)), advertise(std::move(advertise)), advertise_rpc(std::move(advertise_rpc)),
+      interval(interval) {
+    worker = std::thread([this] { run(); });
+}
+
+ClusterMember::~ClusterMember() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+// First heartbeat right away, so the coordinator sees the worker as soon as it is up
+void ClusterMember::run() {
+    const std::string body = "{\"address\":\"" + advertise + "\"" +
+                             (advertise_rpc.empty() ? "" : ",\"rpc\":\"" + advertise_rpc + "\"") + "}";
+    bool reachable = true;
+    std::unique_lock<std::mutex> lock(mutex);
+    do {
+        lock.unlock();
+        try {
+            auto response = http_client::request(coordinator, "POST", "/cluster/workers", body, "application/json",
+                                                 std::chrono::seconds(5));
+            if (response.status != 200) throw std::runtime_error("HTTP " + std::to_string(response.status));
+            if (!reachable) HE_LOG(Info) << "Coordinator " << coordinator << " reachable again";
+            reachable = true;
+        } catch (const std::exception& e) {
+            if (reachable) HE_LOG(Warning) << "Heartbeat to coordinator " << coordinator << " failed: " << e.what();
+            reachable = false;
+        }
+        lock.lock();
+    } while (!wake.wait_for(lock, interval, [this] { return stopping; }));
+}
@@ -0,0 +1,186 @@
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include "HttpClient.h"
+#include "NodeRpc.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Worker nodes of a coordinating main-backend and the columns sharded across them
+ *
+ * Workers are main-backends themselves: they are listed at startup
+ * (--workers) or announce themselves with a heartbeat (ClusterMember), and a
+ * registered worker that misses heartbeats for worker_ttl drops out. The
+ * coordinator splits a column into one contiguous shard per live worker,
+ * stores each shard in its worker's column store and keeps only the shard
+ * handles; an aggregation then runs on every worker in parallel and ships
+ * back one partial ciphertext per shard for the coordinator to combine.
+ *
+ * Every call to a worker is retried (with backoff) on connection errors and
+ * 5xx responses; a worker that still fails is marked down for down_time,
+ * or until its next heartbeat, so new columns skip it. Calls that carry
+ * their ciphertexts (rather than naming a stored shard) move on to the next
+ * live worker instead. All methods are thread-safe.
+ *
+ * Calls run on a fixed set of call threads (call_threads), shared by every
+ * request: the rest wait their turn. Destroying the cluster (or shutdown())
+ * fails the calls not yet started and waits for the others, and for their
+ * scatter_async continuations.
+ *
+ * A worker that also runs an RPC listener (see NodeRpc.h) is called over it
+ * whenever the call has an RPC form, on connections kept open between calls;
+ * others get the call's HTTP form.
+ */
+class Cluster {
+public:
+    struct Options {
+        std::vector<std::string> workers;                // Static "host:port" or "host:port/rpc_port" list
+        std::chrono::seconds worker_ttl{15};             // Heartbeat expiry of registered workers
+        size_t retries = 2;                              // Retries per call after the first attempt
+        std::chrono::milliseconds timeout{60000};        // Per attempt
+        std::chrono::seconds down_time{30};
+        size_t call_threads = 64;                        // Calls in flight at once, over all requests
+    };
+
+    // One worker's part of a sharded column
+    struct Shard {
+        std::string worker;
+        std::string handle;     // In the worker's column store
+        size_t count = 0;       // Ciphertexts
+    };
+
+    // A request to a worker; workers are tried in turn, one per attempt
+    struct Call {
+        std::vector<std::string> workers;
+        std::string method;
+        std::string target;
+        std::string body;
+        std::string content_type = "application/json";
+        // The same call for RPC workers (none: always HTTP), sent back to back on one connection.
+        // Payloads must outlive the call; rpc_body sends body as the last one's, so it is not held twice
+        std::vector<node_rpc::Request> rpc;
+        bool rpc_body = false;
+    };
+
+    struct Outcome {
+        // Last attempt's, if it got one. Over RPC, the first response that is not a 200, else
+        // the last one, with its payload as body
+        http_client::Response response;
+        bool rpc = false;                // Whether the last attempt went over RPC
+        std::string worker;              // Worker of the last attempt
+        size_t attempts = 0;
+        double elapsed_ms = 0;           // All attempts, backoff included
+        std::string error;               // "" if the last attempt got a response of any status below 500
+    };
+
+    struct WorkerInfo {
+        std::string address;
+        std::string rpc;             // "host:port" of its RPC listener, "" if it has none
+        bool registered = false;     // By heartbeat, rather than --workers
+        double heartbeat_age_s = 0;  // Registered workers only
+        bool down = false;
+    };
+
+    explicit Cluster(Options options);
+    ~Cluster();
+
+    Cluster(const Cluster&) = delete;
+    Cluster& operator=(const Cluster&) = delete;
+
+    // Heartbeat of a worker (POST /cluster/workers); also clears a down mark
+    void register_worker(const std::string& address, const std::string& rpc = "");
+
+    std::vector<WorkerInfo> workers() const;
+    // Workers new shards can go to, in address order
+    std::vector<std::string> live_workers() const;
+
+    // Run the calls concurrently on the call threads; outcomes in call order
+    std::vector<Outcome> scatter(const std::vector<Call>& calls);
+
+    /**
+     * scatter() without a waiting thread: returns at once, and once the last
+     * call finishes `done` runs on `pool` (e.g. the compute pool, for the
+     * combine) with the outcomes in call order
+     * The calls are kept until then, so RPC payloads need only outlive `done`.
+     * `done` must not throw, and `pool` must outlive the cluster.
+     */
+    void scatter_async(std::vector<Call> calls, ThreadPool& pool, std::function<void(std::vector<Outcome>)> done);
+
+    /**
+     * Fail the calls not yet started (and any made later) with "Cluster
+     * shutting down", and wait for the running ones and every scatter_async's
+     * `done`. For the owner to call before what the continuations use goes away
+     */
+    void shutdown();
+
+    // Record a sharded column and return its coordinator handle
+    std::string add_column(std::vector<Shard> shards);
+    // @throws std::out_of_range for unknown handles
+    std::vector<Shard> column(const std::string& handle) const;
+    // Forget a column, returning its shards (none if the handle is unknown)
+    std::vector<Shard> erase_column(const std::string& handle);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Worker {
+        std::string rpc;
+        bool registered = false;
+        Clock::time_point heartbeat;
+        Clock::time_point down_until;
+    };
+
+    const Options options;
+    mutable std::mutex mutex;
+    std::map<std::string, Worker> known;
+    std::map<std::string, std::vector<Shard>> columns;
+    node_rpc::Client rpc_client;
+    std::condition_variable drained;  // scatters reached 0
+    size_t scatters = 0;              // scatter_async calls whose done has not returned
+    bool stopping = false;
+    ThreadPool call_pool;             // Last: joined before the rest goes
+
+    Outcome run(const Call& call);
+    std::string rpc_address(const std::string& address) const;
+    void mark_down(const std::string& address);
+    bool live(const Worker& worker, Clock::time_point now) const;
+};
+
+/**
+ * Heartbeat of a worker to its coordinator (--coordinator): registers
+ * `advertise` (and its RPC listener `advertise_rpc`, unless "") every
+ * `interval` from a background thread, so the coordinator discovers the
+ * worker and keeps it while it is up
+ */
+class ClusterMember {
+public:
+    ClusterMember(std::string coordinator, std::string advertise, std::string advertise_rpc,
+                  std::chrono::seconds interval);
+    ~ClusterMember();
+
+    ClusterMember(const ClusterMember&) = delete;
+    ClusterMember& operator=(const ClusterMember&) = delete;
+
+private:
+    const std::string coordinator;
+    const std::string advertise;
+    const std::string advertise_rpc;
+    const std::chrono::seconds interval;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+};
+
+#endif // CLUSTER_H
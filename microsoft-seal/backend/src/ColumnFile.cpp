@@ -0,0 +1,397 @@
+/**
+ * ColumnFile.cpp
+ *
+ * Writing, block by block, and mapped reading of encrypted column files.
+ * Reads go through a read-only mmap on POSIX systems, as KeyStore's do;
+ * other platforms fall back to reading the whole file. Views of uncompressed blocks alias the
+ * mapping, so a block's pages are only read when something touches them.
+ */
+
+#include "ColumnFile.h"
+#include "BinaryFraming.h"  // For the little-endian integer helpers
+#include <algorithm>        // For std::max
+#include <cerrno>           // For errno
+#include <cstdio>           // For std::rename, std::remove
+#include <cstring>          // For std::memcmp, std::strerror
+#include <filesystem>       // For resuming a partial file
+#include <fstream>          // For file output (and input on non-POSIX platforms)
+#include <iterator>         // For std::istreambuf_iterator
+#include <stdexcept>        // For exception handling
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    constexpr char header_magic[] = "HECOLUMN";
+    constexpr char footer_magic[] = "HECOLEND";
+    constexpr uint32_t version = 1;
+    constexpr size_t alignment = 4096;
+    constexpr size_t entry_size = 32;
+    constexpr size_t footer_size = 24;
+    constexpr size_t header_size = 72;  // Rows and blocks are its last 16 bytes
+
+    constexpr size_t data_alignment = 64;  // Of an uncompressed block's coefficients, for Ciphertext::load_view
+
+    size_t aligned(size_t offset) { return (offset + alignment - 1) / alignment * alignment; }
+
+    // Zeros up to the next section boundary, plus skew bytes past it
+    void pad(std::ostream& file, size_t& offset, size_t skew = 0) {
+        static const std::string zeros(alignment, '\0');
+        size_t padding = aligned(offset) - offset + skew;
+        file.write(zeros.data(), static_cast<std::streamsize>(padding));
+        offset += padding;
+    }
+}
+
+ColumnFile::Layout ColumnFile::write(const std::string& path, const seal::SEALContext& context,
+                                     const std::vector<seal::Ciphertext>& column, seal::compr_mode_type compression,
+                                     size_t rows_per_ciphertext, size_t rows) {
+    if (column.empty()) throw std::invalid_argument("Cannot write an empty column");
+    if (rows_per_ciphertext == 0) throw std::invalid_argument("Rows per ciphertext must be positive");
+    const size_t capacity = column.size() * rows_per_ciphertext;
+    if (rows == 0) rows = capacity;
+    if (rows > capacity || rows <= capacity - rows_per_ciphertext) {
+        throw std::invalid_argument("A column of " + std::to_string(column.size()) + " ciphertexts cannot hold " +
+                                    std::to_string(rows) + " rows");
+    }
+
+    Writer writer(path, context, compression, rows_per_ciphertext);
+    for (size_t i = 0; i < column.size(); i++) {
+        writer.append(column[i], i + 1 < column.size() ? rows_per_ciphertext : rows - i * rows_per_ciphertext);
+    }
+    return writer.finish();
+}
+
+ColumnFile::Writer::Writer(std::string path, const seal::SEALContext& context, seal::compr_mode_type compression,
+                           size_t rows_per_ciphertext, const std::vector<Block>& resume)
+    : path(std::move(path)), tmp_path(this->path + ".tmp"), context(context) {
+    if (rows_per_ciphertext == 0) throw std::invalid_argument("Rows per ciphertext must be positive");
+    info.compression = compression;
+    info.packed = rows_per_ciphertext > 1;
+    info.rows_per_ciphertext = rows_per_ciphertext;
+    if (resume.empty()) {
+        file.open(tmp_path, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!file) throw std::runtime_error("Could not create " + tmp_path);
+        return;
+    }
+
+    // Continue the temporary file after the checkpoint's blocks, once its header agrees
+    const std::runtime_error mismatch("No partial column file matching the checkpoint: " + tmp_path);
+    std::string head(header_size, '\0');
+    {
+        std::ifstream in(tmp_path, std::ios::binary);
+        if (!in.read(&head[0], static_cast<std::streamsize>(head.size())) || head.compare(0, 8, header_magic) != 0) {
+            throw mismatch;
+        }
+    }
+    size_t pos = 8;
+    const std::string_view view(head);
+    if (framing::get_uint(view, pos, 4) != version) throw mismatch;
+    info.scheme = static_cast<seal::scheme_type>(framing::get_uint(view, pos, 1));
+    if (static_cast<seal::compr_mode_type>(framing::get_uint(view, pos, 1)) != compression) throw mismatch;
+    pos += 2;
+    for (auto& word : info.parms_id) word = framing::get_uint(view, pos, 8);
+    if (framing::get_uint(view, pos, 8) != rows_per_ciphertext) throw mismatch;
+    for (const Block& block : resume) {
+        if (block.first_row != info.rows || block.rows != rows_per_ciphertext || block.offset < offset) throw mismatch;
+        offset = static_cast<size_t>(block.offset + block.size);
+        info.rows += static_cast<size_t>(block.rows);
+    }
+
+    std::error_code error;
+    if (std::filesystem::file_size(tmp_path, error) < offset || error) throw mismatch;
+    std::filesystem::resize_file(tmp_path, offset, error);  // Drops blocks written after the checkpoint
+    if (error) throw std::runtime_error("Could not truncate " + tmp_path + ": " + error.message());
+    file.open(tmp_path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    if (!file) throw std::runtime_error("Could not open " + tmp_path);
+    index = resume;
+    info.blocks = index.size();
+    started = true;
+    keep = true;
+}
+
+ColumnFile::Writer::~Writer() {
+    if (finished) return;
+    file.close();
+    if (!keep) std::remove(tmp_path.c_str());
+}
+
+void ColumnFile::Writer::append(const seal::Ciphertext& ciphertext, size_t rows) {
+    if (!started) start(ciphertext.parms_id());
+    std::string bytes(static_cast<size_t>(ciphertext.save_size(info.compression)), '\0');
+    auto written = ciphertext.save(reinterpret_cast<seal::seal_byte*>(&bytes[0]), bytes.size(), info.compression);
+    add(bytes.data(), static_cast<size_t>(written), rows, ciphertext.view_data_offset());
+}
+
+/**
+ * Saves of one shape have their coefficients at one offset, so only the
+ * first ciphertext, and the first of every other size, is loaded to find it
+ * (and, if it is the column's first, its parameters)
+ */
+void ColumnFile::Writer::append(std::string_view saved, size_t rows) {
+    // SEALHeader: magic (2 bytes), header size, major and minor version, then the compression mode
+    if (saved.size() < 8 || static_cast<uint8_t>(saved[5]) != static_cast<uint8_t>(info.compression)) {
+        throw std::invalid_argument("Ciphertext is not saved with the column's compression");
+    }
+    if (!started || (info.compression == seal::compr_mode_type::none && saved.size() != sample_size)) {
+        seal::Ciphertext ciphertext;
+        ciphertext.load(context, reinterpret_cast<const seal::seal_byte*>(saved.data()), saved.size());
+        if (!started) start(ciphertext.parms_id());
+        sample_size = saved.size();
+        sample_data_offset = ciphertext.view_data_offset();
+    }
+    add(saved.data(), saved.size(), rows, sample_data_offset);
+}
+
+const std::vector<ColumnFile::Block>& ColumnFile::Writer::checkpoint() {
+    file.flush();
+    if (!file) throw std::runtime_error("Could not write " + tmp_path);
+    keep = true;
+    return index;
+}
+
+ColumnFile::Layout ColumnFile::Writer::finish() {
+    if (index.empty()) throw std::invalid_argument("Cannot write an empty column");
+    pad(file, offset);
+
+    std::string entries;
+    for (const Block& block : index) {
+        framing::put_uint(entries, block.offset, 8);
+        framing::put_uint(entries, block.size, 8);
+        framing::put_uint(entries, block.first_row, 8);
+        framing::put_uint(entries, block.rows, 8);
+    }
+    std::string footer;
+    framing::put_uint(footer, offset, 8);
+    framing::put_uint(footer, index.size(), 8);
+    footer.append(footer_magic, 8);
+    file.write(entries.data(), static_cast<std::streamsize>(entries.size()));
+    file.write(footer.data(), static_cast<std::streamsize>(footer.size()));
+
+    std::string counts;
+    framing::put_uint(counts, info.rows, 8);
+    framing::put_uint(counts, info.blocks, 8);
+    file.seekp(static_cast<std::streamoff>(header_size - counts.size()));
+    file.write(counts.data(), static_cast<std::streamsize>(counts.size()));
+    file.close();
+    if (!file) throw std::runtime_error("Could not write " + tmp_path);
+#if defined(_WIN32)
+    std::remove(path.c_str());  // rename() does not replace existing files on Windows
+#endif
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) throw std::runtime_error("Could not replace " + path);
+    finished = true;
+    return info;
+}
+
+// Header with zero rows and blocks, which finish() fills in
+void ColumnFile::Writer::start(const seal::parms_id_type& parms_id) {
+    auto context_data = context.get_context_data(parms_id);
+    if (!context_data) throw std::invalid_argument("Ciphertexts do not belong to this context");
+    info.scheme = context_data->parms().scheme();
+    info.parms_id = parms_id;
+
+    std::string head(header_magic, 8);
+    framing::put_uint(head, version, 4);
+    framing::put_uint(head, static_cast<uint8_t>(info.scheme), 1);
+    framing::put_uint(head, static_cast<uint8_t>(info.compression), 1);
+    framing::put_uint(head, info.packed ? 1 : 0, 1);
+    framing::put_uint(head, 0, 1);
+    for (uint64_t word : parms_id) framing::put_uint(head, word, 8);
+    framing::put_uint(head, info.rows_per_ciphertext, 8);
+    framing::put_uint(head, 0, 8);
+    framing::put_uint(head, 0, 8);
+    file.write(head.data(), static_cast<std::streamsize>(head.size()));
+    offset = head.size();
+    started = true;
+}
+
+/**
+ * Write a block, starting uncompressed ones so that their coefficients
+ * (data_offset bytes into them) land on a cache line
+ */
+void ColumnFile::Writer::add(const char* bytes, size_t size, size_t rows, size_t data_offset) {
+    if (rows == 0 || rows > info.rows_per_ciphertext) {
+        throw std::invalid_argument("A block cannot hold " + std::to_string(rows) + " rows");
+    }
+    if (!index.empty() && index.back().rows != info.rows_per_ciphertext) {
+        throw std::invalid_argument("Only the last block of a column can be partly filled");
+    }
+    size_t skew = 0;
+    if (info.compression == seal::compr_mode_type::none) {
+        skew = (data_alignment - data_offset % data_alignment) % data_alignment;
+    }
+    pad(file, offset, skew);
+    file.write(bytes, static_cast<std::streamsize>(size));
+    if (!file) throw std::runtime_error("Could not write " + tmp_path);
+    index.push_back({ offset, size, info.rows, rows });
+    offset += size;
+    info.rows += rows;
+    info.blocks++;
+}
+
+ColumnFile::ColumnFile(const std::string& path) : path(path) {
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::out_of_range("Unknown column file: " + path);
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) throw std::out_of_range("Unknown column file: " + path);
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not read " + path);
+    }
+    size = static_cast<size_t>(status.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the file referenced
+    if (mapped == MAP_FAILED) throw std::runtime_error("Could not map " + path + ": " + std::strerror(errno));
+    data = static_cast<const char*>(mapped);
+#endif
+    try {
+        parse();
+    } catch (...) {
+#if !defined(_WIN32)
+        ::munmap(const_cast<char*>(data), size);
+#endif
+        throw;
+    }
+}
+
+ColumnFile::~ColumnFile() {
+#if !defined(_WIN32)
+    ::munmap(const_cast<char*>(data), size);
+#endif
+}
+
+// Header, footer and index, checked against each other and the file size
+void ColumnFile::parse() {
+    const std::string_view file(data, size);
+    const std::runtime_error invalid("Not a valid column file: " + path);
+    if (size < alignment + footer_size || std::memcmp(data, header_magic, 8) != 0 ||
+        std::memcmp(data + size - 8, footer_magic, 8) != 0) {
+        throw invalid;
+    }
+
+    size_t pos = 8;
+    if (framing::get_uint(file, pos, 4) != version) throw std::runtime_error("Unsupported column file version: " + path);
+    info.scheme = static_cast<seal::scheme_type>(framing::get_uint(file, pos, 1));
+    info.compression = static_cast<seal::compr_mode_type>(framing::get_uint(file, pos, 1));
+    info.packed = framing::get_uint(file, pos, 1) != 0;
+    pos++;
+    for (auto& word : info.parms_id) word = framing::get_uint(file, pos, 8);
+    info.rows_per_ciphertext = static_cast<size_t>(framing::get_uint(file, pos, 8));
+    info.rows = static_cast<size_t>(framing::get_uint(file, pos, 8));
+    info.blocks = static_cast<size_t>(framing::get_uint(file, pos, 8));
+
+    pos = size - footer_size;
+    uint64_t index_offset = framing::get_uint(file, pos, 8);
+    if (framing::get_uint(file, pos, 8) != info.blocks || info.blocks == 0 || index_offset < alignment ||
+        index_offset > size - footer_size || (size - footer_size - index_offset) / entry_size != info.blocks) {
+        throw invalid;
+    }
+
+    pos = static_cast<size_t>(index_offset);
+    uint64_t next_row = 0;
+    index.resize(info.blocks);
+    for (auto& block : index) {
+        block.offset = framing::get_uint(file, pos, 8);
+        block.size = framing::get_uint(file, pos, 8);
+        block.first_row = framing::get_uint(file, pos, 8);
+        block.rows = framing::get_uint(file, pos, 8);
+        if (block.offset < alignment || block.offset > index_offset || block.size > index_offset - block.offset ||
+            block.first_row != next_row) {
+            throw invalid;
+        }
+        next_row += block.rows;
+    }
+    if (next_row != info.rows) throw invalid;
+}
+
+std::pair<size_t, size_t> ColumnFile::block_range(size_t begin_row, size_t end_row) const {
+    auto first_at_or_after = [&](size_t row) {
+        size_t low = 0, high = index.size();
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (index[mid].first_row < row) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    };
+    size_t first = first_at_or_after(begin_row);
+    return { first, std::max(first, first_at_or_after(end_row)) };
+}
+
+void ColumnFile::prefetch(size_t first, size_t last) const {
+    if (first >= last || last > index.size()) return;
+#if !defined(_WIN32)
+    static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = static_cast<size_t>(index[first].offset) / page * page;
+    size_t end = static_cast<size_t>(index[last - 1].offset + index[last - 1].size);
+    ::madvise(const_cast<char*>(data) + begin, end - begin, MADV_WILLNEED);  // Advisory; failures are harmless
+#endif
+}
+
+std::string_view ColumnFile::bytes(size_t block) const {
+    const Block& entry = index.at(block);
+    return std::string_view(data + entry.offset, static_cast<size_t>(entry.size));
+}
+
+std::vector<std::string_view> ColumnFile::views(size_t first, size_t last) const {
+    std::vector<std::string_view> result;
+    result.reserve(last > first ? last - first : 0);
+    for (size_t block = first; block < last; block++) result.push_back(bytes(block));
+    return result;
+}
+
+bool ColumnFile::matches(const seal::SEALContext& context) const {
+    return context.get_context_data(info.parms_id) != nullptr;
+}
+
+/**
+ * Uncompressed blocks are viewed where they are; compressed ones, and
+ * uncompressed ones written before blocks were aligned, are copied as load() does
+ */
+seal::Ciphertext ColumnFile::view(const seal::SEALContext& context, size_t block, bool verify) const {
+    if (info.compression != seal::compr_mode_type::none) return load(context, block, verify);
+    if (!matches(context)) throw std::invalid_argument("Column file " + path + " has other encryption parameters");
+    std::string_view serialized = bytes(block);
+    const auto* in = reinterpret_cast<const seal::seal_byte*>(serialized.data());
+    seal::Ciphertext ct;
+    try {
+        if (verify) {
+            ct.load_view(context, in, serialized.size());
+        } else {
+            ct.unsafe_load_view(context, in, serialized.size());
+        }
+    } catch (const std::invalid_argument&) {
+        ct.load(context, in, serialized.size());
+    }
+    return ct;
+}
+
+seal::Ciphertext ColumnFile::load(const seal::SEALContext& context, size_t block, bool verify) const {
+    if (!matches(context)) throw std::invalid_argument("Column file " + path + " has other encryption parameters");
+    std::string_view serialized = bytes(block);
+    const auto* in = reinterpret_cast<const seal::seal_byte*>(serialized.data());
+    seal::Ciphertext ct;
+    if (verify) {
+        ct.load(context, in, serialized.size());
+    } else {
+        ct.unsafe_load(context, in, serialized.size());
+    }
+    return ct;
+}
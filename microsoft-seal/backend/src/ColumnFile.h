@@ -0,0 +1,212 @@
+#ifndef COLUMN_FILE_H
+#define COLUMN_FILE_H
+
+#include "seal/seal.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Encrypted column file: one column's ciphertexts on disk, e.g. on storage
+ * shared by every node of a cluster, readable by row range
+ *
+ * Layout (integers little-endian, every section aligned to 4096 bytes):
+ *   header: "HECOLUMN", uint32 version, uint8 scheme, uint8 compression,
+ *           uint8 packed, uint8 0, 4 x uint64 parms_id, uint64 rows per
+ *           ciphertext, uint64 rows, uint64 blocks
+ *   blocks: one Ciphertext::save per block; uncompressed ones start where
+ *           their coefficient data is 64-byte aligned (Ciphertext::view_data_offset)
+ *   index:  blocks x { uint64 offset, uint64 size, uint64 first_row, uint64 rows }
+ *   footer: uint64 index offset, uint64 blocks, "HECOLEND" (last 24 bytes)
+ *
+ * A reader maps the file and parses only the header, index and footer; a
+ * block is viewed in place (uncompressed) or loaded from the mapping when
+ * asked for, so a node working on its row range never touches the other
+ * blocks, and processes mapping the same file share its page cache.
+ * Files are written to a temporary name and renamed into place, so readers
+ * never see a half-written column. A Writer writes one block at a time, for
+ * columns larger than memory, and can continue a temporary file it left
+ * behind (see Writer::checkpoint).
+ */
+class ColumnFile {
+public:
+    struct Layout {
+        seal::scheme_type scheme = seal::scheme_type::none;
+        seal::parms_id_type parms_id{};  // Of the first block
+        seal::compr_mode_type compression = seal::compr_mode_type::none;
+        bool packed = false;
+        size_t rows_per_ciphertext = 1;  // Slots holding values, packed columns; else 1
+        size_t rows = 0;                 // Values in the column
+        size_t blocks = 0;               // Ciphertexts
+    };
+
+    struct Block {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint64_t first_row = 0;
+        uint64_t rows = 0;
+    };
+
+    /**
+     * Write a column file, replacing any existing one
+     *
+     * @param context Context the ciphertexts belong to
+     * @param column Ciphertexts in row order
+     * @param compression SEAL compression of the blocks (none lets readers load them fastest)
+     * @param rows_per_ciphertext Values per ciphertext (the slot count for packed columns, else 1)
+     * @param rows Values in the column (0: every ciphertext full); the last ciphertext holds the rest
+     * @return Layout written
+     * @throws std::invalid_argument for an empty column or a row count that does not fit it
+     * @throws std::runtime_error if the file cannot be written
+     */
+    static Layout write(const std::string& path, const seal::SEALContext& context,
+                        const std::vector<seal::Ciphertext>& column, seal::compr_mode_type compression,
+                        size_t rows_per_ciphertext = 1, size_t rows = 0);
+
+    /**
+     * A column file written block by block to path + ".tmp", with its
+     * header completed and the file renamed into place by finish()
+     *
+     * A writer destroyed unfinished deletes the temporary file, unless
+     * checkpoint() was called: then the file stays, and a writer given the
+     * blocks that checkpoint() returned cuts it after them and continues,
+     * e.g. after the process was killed. Not thread-safe.
+     */
+    class Writer {
+    public:
+        /**
+         * @param context Context the ciphertexts belong to (must outlive the writer)
+         * @param compression SEAL compression of the blocks
+         * @param rows_per_ciphertext Values per ciphertext (the slot count for packed columns, else 1)
+         * @param resume Blocks of an earlier writer's checkpoint() to continue after (empty = start anew)
+         * @throws std::runtime_error if the file cannot be created, or there is no
+         *         temporary file matching resume
+         */
+        Writer(std::string path, const seal::SEALContext& context, seal::compr_mode_type compression,
+               size_t rows_per_ciphertext = 1, const std::vector<Block>& resume = {});
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        /**
+         * Add the next block, holding rows values; only the last block of a
+         * column may hold fewer than rows_per_ciphertext
+         * @throws std::invalid_argument for a row count that does not fit, or a
+         *         ciphertext of another context
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void append(const seal::Ciphertext& ciphertext, size_t rows);
+
+        /**
+         * Same for a ciphertext as Ciphertext::save wrote it, with the writer's
+         * compression (e.g. the binary wire format): written as it is, without
+         * saving it again
+         */
+        void append(std::string_view saved, size_t rows);
+
+        // Flush the blocks written so far and keep the temporary file; returns them for a later writer
+        const std::vector<Block>& checkpoint();
+
+        const std::vector<Block>& blocks() const { return index; }
+        size_t rows() const { return info.rows; }
+
+        /**
+         * Write the index and footer, fill in the header and rename the file into place
+         * @return Layout written
+         * @throws std::invalid_argument if no block was appended
+         * @throws std::runtime_error if the file cannot be written
+         */
+        Layout finish();
+
+    private:
+        std::string path;
+        std::string tmp_path;
+        const seal::SEALContext& context;
+        std::fstream file;
+        size_t offset = 0;  // Bytes written
+        Layout info;
+        std::vector<Block> index;
+        bool started = false;  // Header written
+        bool keep = false;     // Leave the temporary file for a later writer
+        bool finished = false;
+        size_t sample_size = 0;  // Saved size and data offset of the last saved ciphertext loaded to align it
+        size_t sample_data_offset = 0;
+
+        void start(const seal::parms_id_type& parms_id);
+        void add(const char* bytes, size_t size, size_t rows, size_t data_offset);
+    };
+
+    /**
+     * Map a column file and read its layout and index
+     *
+     * @throws std::out_of_range if the file does not exist
+     * @throws std::runtime_error if it cannot be read or is not a valid column file
+     */
+    explicit ColumnFile(const std::string& path);
+    ~ColumnFile();
+
+    ColumnFile(const ColumnFile&) = delete;
+    ColumnFile& operator=(const ColumnFile&) = delete;
+
+    const Layout& layout() const { return info; }
+    const std::vector<Block>& blocks() const { return index; }
+    size_t file_size() const { return size; }
+
+    /**
+     * Blocks of a row range: those whose first row lies in [begin_row, end_row),
+     * so ranges that partition the rows partition the blocks
+     *
+     * @return [first, last) block indices
+     */
+    std::pair<size_t, size_t> block_range(size_t begin_row, size_t end_row) const;
+
+    /**
+     * Start reading blocks [first, last) into the page cache without waiting
+     * for them (madvise(MADV_WILLNEED)), so that they are in memory by the
+     * time they are used. A no-op where the file is not mapped
+     */
+    void prefetch(size_t first, size_t last) const;
+
+    // A block's serialized ciphertext, in the mapping (valid while this object lives)
+    std::string_view bytes(size_t block) const;
+    // Serialized ciphertexts of blocks [first, last), e.g. for deserialize_sum(..., WireFormat::binary)
+    std::vector<std::string_view> views(size_t first, size_t last) const;
+
+    /**
+     * Load a block
+     * @param verify Check the coefficients against the parameters (false only for files this process wrote)
+     * @throws std::invalid_argument if the context does not have the column's parameters
+     */
+    seal::Ciphertext load(const seal::SEALContext& context, size_t block, bool verify = true) const;
+
+    /**
+     * A block as a read-only view of the mapping (Ciphertext::load_view) where
+     * it is uncompressed, else loaded as load() does. A view holds no memory of
+     * its own, must not outlive this object and must only be used as a const
+     * operand; copying it makes an ordinary ciphertext
+     *
+     * @param verify Check the coefficients against the parameters (false only for files this process wrote)
+     * @throws std::invalid_argument if the context does not have the column's parameters
+     */
+    seal::Ciphertext view(const seal::SEALContext& context, size_t block, bool verify = true) const;
+
+    // Whether a context can load this column's ciphertexts (its parameters include the column's parms_id)
+    bool matches(const seal::SEALContext& context) const;
+
+private:
+    std::string path;
+    const char* data = nullptr;
+    size_t size = 0;
+    std::string buffer;  // The file's bytes where it cannot be mapped
+    Layout info;
+    std::vector<Block> index;
+
+    void parse();
+};
+
+#endif // COLUMN_FILE_H
@@ -0,0 +1,85 @@
+/**
+ * CpuFeatures.cpp
+ *
+ * CPUID probing and the kernel path report printed at startup.
+ */
+
+#include "CpuFeatures.h"
+#include "seal/util/config.h"
+#include "seal/util/cpufeatures.h"
+
+#ifdef SEAL_USE_INTEL_HEXL
+    #include "hexl/util/cpu_features.hpp"
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #include <immintrin.h>
+#endif
+
+namespace cpu {
+
+namespace {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    // CPUID.(EAX=7,ECX=0):EBX feature bit, plus OS support for the ZMM state
+    bool leaf7_ebx(int bit) {
+        int regs[4];
+        __cpuid(regs, 0);
+        if (regs[0] < 7) return false;
+        __cpuid(regs, 1);
+        bool osxsave = (regs[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 0xE6) != 0xE6) return false;
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << bit)) != 0;
+    }
+#endif
+}
+
+bool has_avx512ifma() {
+#if defined(SEAL_USE_INTEL_HEXL)
+    return intel::hexl::has_avx512ifma;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx512ifma") != 0;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return leaf7_ebx(21);
+#else
+    return false;
+#endif
+}
+
+bool has_avx512dq() {
+#if defined(SEAL_USE_INTEL_HEXL)
+    return intel::hexl::has_avx512dq;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx512dq") != 0;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return leaf7_ebx(17);
+#else
+    return false;
+#endif
+}
+
+std::string seal_kernel_path() {
+#ifdef SEAL_USE_INTEL_HEXL
+    // Same order of preference as HEXL's own dispatch
+    if (has_avx512ifma()) return "Intel HEXL, AVX-512 IFMA";
+    if (has_avx512dq()) return "Intel HEXL, AVX-512 DQ";
+    return "Intel HEXL, scalar fallback (no AVX-512 on this CPU)";
+#else
+    std::string path = "SEAL portable kernels";
+    if (seal::util::use_avx2()) path = "SEAL AVX2 NTT, FFT and element-wise kernels";
+    if (seal::util::use_avx512()) path = "SEAL AVX2 NTT, AVX-512 FFT and element-wise kernels";
+    if (seal::util::use_sve()) path = "SEAL SVE NTT and dyadic product";
+    if (has_avx512ifma() || has_avx512dq()) {
+        path += " (for AVX-512 NTTs rebuild with -DHE_USE_INTEL_HEXL=ON)";
+    }
+    return path;
+#endif
+}
+
+std::string seal_prng_path(const std::string& prng) {
+    if (prng != "aes128ctr") return prng;
+    return prng + " (AES-NI)";  // set_default_prng refuses it without
+}
+
+}
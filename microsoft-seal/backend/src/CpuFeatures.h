@@ -0,0 +1,30 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <string>
+
+/**
+ * Which polynomial arithmetic kernels SEAL uses on this machine
+ *
+ * With HE_USE_INTEL_HEXL the NTTs and dyadic products go through Intel HEXL,
+ * which picks its AVX-512 IFMA, AVX-512 DQ or scalar kernels at runtime, so
+ * one binary serves every x86-64 host. Otherwise SEAL uses its own AVX2
+ * NTT, AVX2/AVX-512 CKKS encoder FFT and AVX2/AVX-512 element-wise kernels
+ * (ciphertext add, dyadic product) where the CPU has them, its SVE kernels
+ * on AArch64 hosts with SVE (e.g. Graviton3) and its portable kernels
+ * elsewhere.
+ */
+namespace cpu {
+
+    // true if the CPU and OS support the AVX-512 IFMA52 / DQ instructions
+    bool has_avx512ifma();
+    bool has_avx512dq();
+
+    // Startup report line, e.g. "Intel HEXL, AVX-512 IFMA"
+    std::string seal_kernel_path();
+
+    // Startup report line of a --prng name, e.g. "aes128ctr (AES-NI)"
+    std::string seal_prng_path(const std::string& prng);
+}
+
+#endif // CPU_FEATURES_H
@@ -0,0 +1,86 @@
+#include "CrtResidues.h"
+#include "seal/util/uintarithsmallmod.h"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    // value modulo modulus in [0, modulus), for either sign
+    uint64_t reduce(int64_t value, const seal::Modulus& modulus) {
+        uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        uint64_t reduced = seal::util::barrett_reduce_64(magnitude, modulus);
+        return value < 0 && reduced ? modulus.value() - reduced : reduced;
+    }
+}
+
+CrtResidues::CrtResidues(const std::vector<uint64_t>& values) {
+    if (values.size() < 2) throw std::invalid_argument("Expected at least two CRT moduli");
+    for (uint64_t value : values) {
+        if (value < 2 || product_ > ((uint64_t(1) << 63) - 1) / value) {
+            throw std::invalid_argument("CRT moduli must be at least 2 and multiply to less than 2^63");
+        }
+        seal::Modulus modulus(value);
+        uint64_t prefix = seal::util::barrett_reduce_64(product_, modulus);
+        uint64_t inverse;
+        if (!seal::util::try_invert_uint_mod(prefix, modulus, inverse)) {
+            throw std::invalid_argument("CRT moduli must be coprime");
+        }
+        moduli.push_back(modulus);
+        inverses.push_back(inverse);
+        product_ *= value;
+    }
+}
+
+std::vector<double> CrtResidues::residues(const std::vector<double>& values, size_t index) const {
+    const seal::Modulus& modulus = moduli.at(index);
+    std::vector<double> out;
+    out.reserve(values.size());
+    for (double value : values) {
+        if (value != std::round(value) || std::abs(value) >= 9223372036854775808.0) {
+            throw std::invalid_argument("CRT values must be integers below 2^63 in magnitude");
+        }
+        uint64_t residue = reduce(static_cast<int64_t>(value), modulus);
+        out.push_back(residue > modulus.value() / 2 ? -static_cast<double>(modulus.value() - residue)
+                                                     : static_cast<double>(residue));
+    }
+    return out;
+}
+
+/**
+ * value = a_0 + a_1 m_0 + a_2 m_0 m_1 + ..., with each digit a_i < m_i found
+ * modulo m_i from the digits before it, so nothing exceeds 64 bits
+ */
+std::vector<int64_t> CrtResidues::combine(const std::vector<std::vector<int64_t>>& residues) const {
+    if (residues.size() != moduli.size()) {
+        throw std::invalid_argument("Expected residues for " + std::to_string(moduli.size()) + " moduli");
+    }
+    const size_t count = residues[0].size();
+    for (const auto& column : residues) {
+        if (column.size() != count) throw std::invalid_argument("Expected as many residues for every modulus");
+    }
+
+    std::vector<int64_t> values(count);
+    std::vector<uint64_t> digits(moduli.size());
+    for (size_t j = 0; j < count; j++) {
+        uint64_t value = 0;
+        uint64_t radix = 1;
+        for (size_t i = 0; i < moduli.size(); i++) {
+            const seal::Modulus& modulus = moduli[i];
+            // The value of the digits so far, modulo m_i
+            uint64_t partial = 0;
+            uint64_t place = 1;
+            for (size_t d = 0; d < i; d++) {
+                uint64_t digit = seal::util::barrett_reduce_64(digits[d], modulus);
+                partial = seal::util::multiply_add_uint_mod(digit, place, partial, modulus);
+                place = seal::util::multiply_uint_mod(
+                    place, seal::util::barrett_reduce_64(moduli[d].value(), modulus), modulus);
+            }
+            uint64_t difference = seal::util::sub_uint_mod(reduce(residues[i][j], modulus), partial, modulus);
+            digits[i] = seal::util::multiply_uint_mod(difference, inverses[i], modulus);
+            value += digits[i] * radix;
+            radix *= modulus.value();
+        }
+        values[j] = value > product_ / 2 ? -static_cast<int64_t>(product_ - value) : static_cast<int64_t>(value);
+    }
+    return values;
+}
@@ -0,0 +1,50 @@
+#ifndef CRT_RESIDUES_H
+#define CRT_RESIDUES_H
+
+#include "seal/modulus.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Integers kept as residues modulo several plain moduli, e.g. under one BFV or
+ * BGV engine per profiles::crt_residue profile
+ *
+ * Each engine adds its residues exactly, modulo its own small prime, so a sum
+ * needs no plain modulus as large as the sum: the key holder recombines the
+ * decrypted residues (Garner's mixed-radix form) into the value modulo the
+ * moduli's product, below 2^63. Results are centered, so negative totals come
+ * back negative.
+ */
+class CrtResidues {
+public:
+    // @throws std::invalid_argument for fewer than two moduli, moduli that are not coprime, or a
+    //         product of 2^63 or more
+    explicit CrtResidues(const std::vector<std::uint64_t>& moduli);
+
+    size_t size() const { return moduli.size(); }
+    std::uint64_t modulus(size_t index) const { return moduli[index].value(); }
+    std::uint64_t product() const { return product_; }
+
+    /**
+     * Integer values modulo moduli[index], centered in (-m / 2, m / 2] for BatchEncoder's
+     * signed encoding (HomomorphicEncryption::encrypt_vector)
+     * @throws std::invalid_argument for a fractional value or one of 2^63 or more in magnitude
+     */
+    std::vector<double> residues(const std::vector<double>& values, size_t index) const;
+
+    /**
+     * Values from their residues: residues[i][j] is value j modulo moduli[i], in any
+     * representative (e.g. decrypt_batch_integers' centered ones)
+     * @return One value per residue, in (-product() / 2, product() / 2]
+     * @throws std::invalid_argument unless there is one residue vector per modulus, all as long
+     */
+    std::vector<std::int64_t> combine(const std::vector<std::vector<std::int64_t>>& residues) const;
+
+private:
+    std::vector<seal::Modulus> moduli;
+    std::vector<std::uint64_t> inverses;  // (m_0 * ... * m_(i-1))^-1 modulo m_i
+    std::uint64_t product_ = 1;
+};
+
+#endif // CRT_RESIDUES_H
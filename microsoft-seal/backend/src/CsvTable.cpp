@@ -0,0 +1,393 @@
+/**
+ * CsvTable.cpp
+ *
+ * Memory-mapped, multi-threaded CSV ingestion. Cells are converted with
+ * std::from_chars, which neither allocates nor throws, so a column full of
+ * text costs a failed parse per cell rather than an exception.
+ *
+ * Quoted fields follow RFC 4180: they may contain commas, newlines and
+ * doubled quotes (""). Large files are split into one chunk per thread; a
+ * parallel quote count tells every nominal split point whether it falls
+ * inside a quoted field, so each chunk can be moved to the next real row
+ * boundary before the chunks are parsed concurrently and concatenated.
+ */
+
+#include "CsvTable.h"
+#include <algorithm>      // For std::min, std::max, std::max_element
+#include <charconv>       // For std::from_chars
+#include <cstring>        // For std::memchr
+#include <filesystem>     // For file size and modification time
+#include <future>         // For std::async
+#include <thread>         // For std::thread::hardware_concurrency
+#include <fstream>        // For the non-POSIX fallback read
+#include <iterator>       // For std::istreambuf_iterator
+#include <stdexcept>      // For exception handling
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    /**
+     * Read-only view of a whole file: mmap on POSIX, a heap copy elsewhere
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) throw std::runtime_error("Could not open file");
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            bytes = buffer.data();
+            length = buffer.size();
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("Could not open file");
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Could not open file");
+            }
+            length = static_cast<size_t>(info.st_size);
+            if (length > 0) {
+                void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("Could not map file");
+                }
+                ::madvise(mapped, length, MADV_SEQUENTIAL);  // Single front-to-back scan
+                bytes = static_cast<const char*>(mapped);
+            }
+            ::close(fd);
+#endif
+        }
+
+        ~MappedFile() {
+#if !defined(_WIN32)
+            if (length > 0) ::munmap(const_cast<char*>(bytes), length);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const { return bytes; }
+        size_t size() const { return length; }
+
+    private:
+        const char* bytes = nullptr;
+        size_t length = 0;
+#if defined(_WIN32)
+        std::string buffer;
+#endif
+    };
+
+    /**
+     * Parse a cell as a number; the whole cell (minus surrounding blanks) must match
+     * @return false for empty or non-numeric cells
+     */
+    bool parse_number(const char* begin, const char* end, double& value) {
+        while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        if (begin < end && *begin == '+') begin++;  // from_chars rejects an explicit plus sign
+        if (begin == end) return false;
+        auto result = std::from_chars(begin, end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    /**
+     * One cell as located in the mapped file
+     * [begin, end) excludes surrounding quotes; escaped means it contains "" pairs
+     */
+    struct Cell {
+        const char* begin;
+        const char* end;
+        bool escaped;
+        bool last;  // True if the cell ends its row
+    };
+
+    /**
+     * Scan the cell starting at pos
+     * @return Position after the cell's delimiter (',' or end of line)
+     */
+    const char* scan_cell(const char* pos, const char* end, Cell& cell) {
+        cell.escaped = false;
+        if (pos < end && *pos == '"') {
+            // Quoted: runs to the first quote not followed by another quote
+            cell.begin = ++pos;
+            for (;;) {
+                const char* quote = static_cast<const char*>(std::memchr(pos, '"', static_cast<size_t>(end - pos)));
+                if (!quote) {
+                    cell.end = pos = end;  // Unterminated quote: take the rest of the file
+                    break;
+                }
+                if (quote + 1 < end && quote[1] == '"') {
+                    cell.escaped = true;
+                    pos = quote + 2;
+                    continue;
+                }
+                cell.end = quote;
+                pos = quote + 1;
+                break;
+            }
+            while (pos < end && *pos != ',' && *pos != '\n') pos++;  // Ignore stray text after the closing quote
+        } else {
+            cell.begin = pos;
+            while (pos < end && *pos != ',' && *pos != '\n') pos++;
+            cell.end = pos;
+            if (cell.end > cell.begin && cell.end[-1] == '\r') cell.end--;
+        }
+        cell.last = pos == end || *pos == '\n';
+        return pos < end ? pos + 1 : end;
+    }
+
+    // Parsed rows of one chunk, merged into the table in chunk order
+    struct Chunk {
+        std::vector<std::vector<double>> columns;
+        size_t rows = 0;
+    };
+
+    // Parse the complete rows in [pos, end)
+    void parse_rows(const char* pos, const char* end, size_t width, Chunk& chunk) {
+        chunk.columns.resize(width);
+        while (pos < end) {
+            if (*pos == '\n' || (*pos == '\r' && pos + 1 < end && pos[1] == '\n')) {
+                pos += *pos == '\n' ? 1 : 2;  // Blank line
+                continue;
+            }
+            chunk.rows++;
+
+            Cell cell;
+            for (size_t col = 0;; col++) {
+                pos = scan_cell(pos, end, cell);
+                if (col >= chunk.columns.size()) chunk.columns.resize(col + 1);  // Ragged row wider than the header
+
+                double value;
+                if (!cell.escaped && parse_number(cell.begin, cell.end, value)) chunk.columns[col].push_back(value);
+                if (cell.last) break;
+            }
+        }
+    }
+
+    // Count quote characters in [pos, end)
+    size_t count_quotes(const char* pos, const char* end) {
+        size_t count = 0;
+        while ((pos = static_cast<const char*>(std::memchr(pos, '"', static_cast<size_t>(end - pos))))) {
+            count++;
+            pos++;
+        }
+        return count;
+    }
+
+    /**
+     * First row start at or after pos
+     * @param in_quotes Whether pos lies inside a quoted field (from the quote parity before it)
+     */
+    const char* next_row_start(const char* pos, const char* end, bool in_quotes) {
+        for (; pos < end; pos++) {
+            if (*pos == '"') {
+                in_quotes = !in_quotes;
+            } else if (*pos == '\n' && !in_quotes) {
+                return pos + 1;
+            }
+        }
+        return end;
+    }
+
+    // Header row: the names of the columns. Returns where the data rows start
+    const char* read_names(const char* pos, const char* end, std::vector<std::string>& names) {
+        Cell cell;
+        do {
+            pos = scan_cell(pos, end, cell);
+            std::string name(cell.begin, cell.end);
+            if (cell.escaped) {
+                std::string unescaped;
+                for (size_t i = 0; i < name.size(); i++) {
+                    unescaped.push_back(name[i]);
+                    if (name[i] == '"') i++;  // "" -> "
+                }
+                name = std::move(unescaped);
+            }
+            names.push_back(std::move(name));
+        } while (!cell.last);
+        return pos;
+    }
+
+    // Below this size a file is parsed on the calling thread
+    constexpr size_t min_parallel_bytes = 1 << 20;
+}
+
+std::shared_ptr<const CsvTable> CsvTable::load(const std::string& path, size_t threads) {
+    MappedFile file(path);
+    auto table = std::make_shared<CsvTable>();
+    table->parse(file.data(), file.size(), threads);
+    return table;
+}
+
+std::vector<std::string> CsvTable::read_header(const std::string& path) {
+    MappedFile file(path);
+    std::vector<std::string> names;
+    if (file.size() > 0) read_names(file.data(), file.data() + file.size(), names);
+    return names;
+}
+
+/**
+ * As scan_column, with each row's cells looked up in a table of the columns
+ * wanted, and the row left as soon as the last of them is passed
+ */
+size_t CsvTable::scan_columns(const std::string& path, const std::vector<size_t>& indices,
+                              const std::function<void(size_t which, double value)>& sink) {
+    if (indices.empty()) return 0;
+    std::vector<size_t> wanted(*std::max_element(indices.begin(), indices.end()) + 1, indices.size());
+    for (size_t i = indices.size(); i-- > 0;) wanted[indices[i]] = i;  // The first occurrence wins
+
+    MappedFile file(path);
+    const char* pos = file.data();
+    const char* end = pos + file.size();
+    size_t count = 0;
+
+    Cell cell;
+    while (pos < end) {
+        pos = scan_cell(pos, end, cell);
+        if (cell.last) break;
+    }
+
+    while (pos < end) {
+        if (*pos == '\n' || (*pos == '\r' && pos + 1 < end && pos[1] == '\n')) {
+            pos += *pos == '\n' ? 1 : 2;  // Blank line
+            continue;
+        }
+        for (size_t col = 0;; col++) {
+            pos = scan_cell(pos, end, cell);
+            double value;
+            if (col < wanted.size() && wanted[col] < indices.size() && !cell.escaped &&
+                parse_number(cell.begin, cell.end, value)) {
+                sink(wanted[col], value);
+                count++;
+            }
+            if (cell.last) break;
+        }
+    }
+    return count;
+}
+
+size_t CsvTable::scan_column(const std::string& path, size_t index, const std::function<void(double)>& sink) {
+    MappedFile file(path);
+    const char* pos = file.data();
+    const char* end = pos + file.size();
+    size_t count = 0;
+
+    // Skip the header row
+    Cell cell;
+    while (pos < end) {
+        pos = scan_cell(pos, end, cell);
+        if (cell.last) break;
+    }
+
+    while (pos < end) {
+        if (*pos == '\n' || (*pos == '\r' && pos + 1 < end && pos[1] == '\n')) {
+            pos += *pos == '\n' ? 1 : 2;  // Blank line
+            continue;
+        }
+        for (size_t col = 0;; col++) {
+            pos = scan_cell(pos, end, cell);
+            double value;
+            if (col == index && !cell.escaped && parse_number(cell.begin, cell.end, value)) {
+                sink(value);
+                count++;
+            }
+            if (cell.last) break;
+        }
+    }
+    return count;
+}
+
+const std::vector<double>& CsvTable::column(size_t index) const {
+    static const std::vector<double> empty;
+    return index < columns.size() ? columns[index] : empty;
+}
+
+void CsvTable::parse(const char* data, size_t size, size_t threads) {
+    const char* pos = data;
+    const char* end = data + size;
+    if (pos == end) return;
+
+    pos = read_names(pos, end, names);
+
+    // Split the data rows into chunks on row boundaries
+    size_t data_size = static_cast<size_t>(end - pos);
+    if (threads == 0) threads = 1;
+    size_t chunks = std::max<size_t>(1, std::min(threads, data_size / min_parallel_bytes));
+
+    std::vector<const char*> bounds(chunks + 1);
+    for (size_t i = 0; i <= chunks; i++) bounds[i] = pos + i * data_size / chunks;
+
+    if (chunks > 1) {
+        // Quote parity before each nominal bound tells whether it sits inside a quoted field
+        std::vector<std::future<size_t>> counts;
+        for (size_t i = 0; i + 1 < chunks; i++) {
+            counts.push_back(std::async(std::launch::async, count_quotes, bounds[i], bounds[i + 1]));
+        }
+        size_t quotes = 0;
+        for (size_t i = 1; i < chunks; i++) {
+            quotes += counts[i - 1].get();
+            bounds[i] = next_row_start(bounds[i], end, quotes % 2 == 1);
+        }
+        for (size_t i = 1; i < chunks; i++) bounds[i] = std::max(bounds[i], bounds[i - 1]);
+    }
+
+    // Parse chunks concurrently (chunk 0 on this thread)
+    std::vector<Chunk> results(chunks);
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 1; i < chunks; i++) {
+        tasks.push_back(std::async(std::launch::async, [&, i] {
+            parse_rows(bounds[i], bounds[i + 1], names.size(), results[i]);
+        }));
+    }
+    parse_rows(bounds[0], bounds[1], names.size(), results[0]);
+    for (auto& task : tasks) task.get();
+
+    // Concatenate the per-chunk columns in file order
+    size_t width = names.size();
+    for (const auto& chunk : results) width = std::max(width, chunk.columns.size());
+    columns.resize(width);
+    for (size_t col = 0; col < width; col++) {
+        size_t total = 0;
+        for (const auto& chunk : results) total += col < chunk.columns.size() ? chunk.columns[col].size() : 0;
+        columns[col].reserve(total);
+        for (const auto& chunk : results) {
+            if (col < chunk.columns.size()) {
+                columns[col].insert(columns[col].end(), chunk.columns[col].begin(), chunk.columns[col].end());
+            }
+        }
+    }
+    for (const auto& chunk : results) rows += chunk.rows;
+}
+
+CsvCache::CsvCache(size_t threads) : threads(threads) {}
+
+std::shared_ptr<const CsvTable> CsvCache::get(const std::string& path) {
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) throw std::runtime_error("Could not open file");
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) throw std::runtime_error("Could not open file");
+    int64_t stamp = static_cast<int64_t>(mtime.time_since_epoch().count());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(path);
+        if (it != entries.end() && it->second.mtime == stamp && it->second.size == size) {
+            return it->second.table;
+        }
+    }
+
+    // Parse outside the lock; concurrent first loads of one file may parse twice, which is harmless
+    auto table = CsvTable::load(path, threads);
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[path] = Entry{stamp, size, table};
+    return table;
+}
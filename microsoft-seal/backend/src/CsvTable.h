@@ -0,0 +1,104 @@
+#ifndef CSV_TABLE_H
+#define CSV_TABLE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Columnar, fully parsed view of a CSV file
+ *
+ * The file is memory-mapped and scanned once; every cell that is a complete
+ * number is stored in its column's contiguous vector (other cells, e.g. names
+ * or dates, are skipped, as read_csv always did). The first row is the header.
+ * Quoted fields (RFC 4180) may contain commas, newlines and "" escapes.
+ * Files larger than a few MB are parsed in parallel chunks.
+ */
+class CsvTable {
+public:
+    /**
+     * Parse a CSV file
+     * @param path File to read
+     * @param threads Maximum number of chunks parsed concurrently
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    static std::shared_ptr<const CsvTable> load(const std::string& path,
+                                                size_t threads = std::thread::hardware_concurrency());
+
+    // Numeric values of a column in row order (empty for unknown or non-numeric columns)
+    const std::vector<double>& column(size_t index) const;
+
+    /**
+     * Stream the numeric values of one column without building the table
+     * Memory use is independent of the file size; nothing is cached
+     * @param path File to read
+     * @param index Zero-based column index
+     * @param sink Called for every numeric cell of the column, in row order
+     * @return Number of values passed to sink
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    static size_t scan_column(const std::string& path, size_t index, const std::function<void(double)>& sink);
+
+    /**
+     * Stream several columns in one pass over the file, e.g. to encrypt all
+     * of them at once; a column listed twice is passed on once
+     * @param indices Zero-based column indices
+     * @param sink Called with the position in indices of the column and the
+     *             value for every numeric cell of those columns, in file order
+     * @return Number of values passed to sink
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    static size_t scan_columns(const std::string& path, const std::vector<size_t>& indices,
+                               const std::function<void(size_t which, double value)>& sink);
+
+    // Names in the header row, without reading the rest of the file
+    static std::vector<std::string> read_header(const std::string& path);
+
+    const std::vector<std::string>& header() const { return names; }
+    size_t column_count() const { return columns.size(); }
+    size_t row_count() const { return rows; }
+
+private:
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> columns;
+    size_t rows = 0;
+
+    void parse(const char* data, size_t size, size_t threads);
+};
+
+/**
+ * Process-wide cache of parsed CSV files, keyed by path
+ *
+ * An entry is reused as long as the file's modification time and size are
+ * unchanged, so repeated queries on the same dataset cost a stat() and a
+ * lookup instead of a full parse. Thread-safe.
+ */
+class CsvCache {
+public:
+    // @param threads Parser threads used for each (re)load
+    explicit CsvCache(size_t threads = std::thread::hardware_concurrency());
+
+    /**
+     * Parsed table for path, (re)loading it if the file changed
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    std::shared_ptr<const CsvTable> get(const std::string& path);
+
+private:
+    struct Entry {
+        int64_t mtime = 0;
+        uintmax_t size = 0;
+        std::shared_ptr<const CsvTable> table;
+    };
+
+    size_t threads;
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+#endif // CSV_TABLE_H
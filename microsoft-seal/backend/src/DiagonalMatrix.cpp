@@ -0,0 +1,155 @@
+#include "DiagonalMatrix.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+    size_t popcount(size_t n) {
+        size_t bits = 0;
+        for (; n; n &= n - 1) bits++;
+        return bits;
+    }
+}
+
+DiagonalMatrix::DiagonalMatrix(const HomomorphicEncryption& he, const std::vector<std::vector<double>>& rows,
+                               const std::vector<double>& bias)
+    : he(he), row_count(rows.size()), column_count(rows.empty() ? 0 : rows[0].size()) {
+    if (he.seal_context()->first_context_data()->parms().scheme() != seal::scheme_type::ckks) {
+        throw std::invalid_argument("Matrix-vector products need CKKS");
+    }
+    if (row_count == 0 || column_count == 0) throw std::invalid_argument("Matrix is empty");
+    for (const auto& row : rows) {
+        if (row.size() != column_count) throw std::invalid_argument("Matrix rows differ in length");
+    }
+    while (d < std::max(row_count, column_count)) d <<= 1;
+    if (d > he.slot_count()) {
+        throw std::invalid_argument("Matrix dimension " + std::to_string(d) + " exceeds the " +
+                                    std::to_string(he.slot_count()) + " slots");
+    }
+
+    diagonals.resize(d);
+    for (size_t k = 0; k < d; k++) {
+        std::vector<double> diagonal(d, 0.0);
+        bool nonzero = false;
+        for (size_t i = 0; i < row_count; i++) {
+            size_t column = (i + k) % d;
+            if (column < column_count && rows[i][column] != 0) {
+                diagonal[i] = rows[i][column];
+                nonzero = true;
+            }
+        }
+        if (nonzero) diagonals[k] = std::move(diagonal);
+    }
+    if (std::all_of(diagonals.begin(), diagonals.end(), [](const std::vector<double>& diagonal) {
+            return diagonal.empty();
+        })) {
+        throw std::invalid_argument("Matrix is all zeros");
+    }
+
+    if (!bias.empty()) {
+        if (bias.size() != row_count) throw std::invalid_argument("Expected one bias per matrix row");
+        tiled_bias.assign(he.slot_count(), 0.0);
+        for (size_t s = 0; s < tiled_bias.size(); s++) {
+            if (s % d < row_count) tiled_bias[s] = bias[s % d];
+        }
+    }
+
+    baby = choose_baby_step();
+    baby_used.assign(baby, false);
+    for (size_t k = 0; k < d; k++) {
+        if (!diagonals[k].empty()) baby_used[k % baby] = true;
+    }
+}
+
+/**
+ * Power-of-two baby step with the fewest key switches: one per baby step
+ * with its own Galois key (several for composed steps) plus d / g - 1 giant
+ * steps; ties go to the larger baby step, whose rotations are hoisted
+ */
+size_t DiagonalMatrix::choose_baby_step() const {
+    size_t best = 1;
+    size_t best_cost = d - 1;
+    size_t baby_cost = 0;
+    for (size_t g = 2; g <= d; g <<= 1) {
+        for (size_t b = g / 2; b < g; b++) baby_cost += he.has_galois_key(static_cast<int>(b)) ? 1 : popcount(b);
+        const size_t cost = baby_cost + d / g - 1;
+        if (cost <= best_cost) {
+            best = g;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+/**
+ * Diagonal g j + b, rotated right by g j and tiled over all slots, encoded
+ * for each giant index j and baby index b at the given level (cached)
+ */
+const std::vector<std::vector<seal::Plaintext>>& DiagonalMatrix::encoded_at(size_t chain_index,
+                                                                             seal::parms_id_type parms_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = encoded.find(chain_index);
+    if (found != encoded.end()) return found->second;
+
+    const size_t slots = he.slot_count();
+    std::vector<std::vector<seal::Plaintext>> plaintexts(d / baby);
+    for (size_t j = 0; j < plaintexts.size(); j++) {
+        for (size_t b = 0; b < baby; b++) {
+            const std::vector<double>& diagonal = diagonals[j * baby + b];
+            if (diagonal.empty()) continue;
+            if (plaintexts[j].empty()) plaintexts[j].resize(baby);
+            std::vector<double> rotated(slots);
+            for (size_t s = 0; s < slots; s++) rotated[s] = diagonal[(s + d - j * baby) % d];
+            plaintexts[j][b] = std::move(he.encode_weights(rotated, true, parms_id)[0]);
+        }
+    }
+    return encoded.emplace(chain_index, std::move(plaintexts)).first->second;
+}
+
+seal::Ciphertext DiagonalMatrix::multiply(const seal::Ciphertext& x, bool tiled, MatrixVectorStats* stats) const {
+    const size_t chain_index = he.chain_index(x);
+    if (chain_index == 0) throw std::invalid_argument("Matrix-vector product needs a level, the ciphertext has none left");
+    MatrixVectorStats counts;
+
+    // Baby steps: x rotated by every b that some nonzero diagonal needs, from one decomposition
+    std::vector<seal::Ciphertext> terms(baby);
+    terms[0] = x;
+    if (!tiled && d < he.slot_count()) he.sum_slots_inplace(terms[0], d);
+    std::vector<int> steps;
+    for (size_t b = 1; b < baby; b++) {
+        if (!baby_used[b]) continue;
+        steps.push_back(static_cast<int>(b));
+        if (he.has_galois_key(static_cast<int>(b))) counts.hoisted_rotations++;
+    }
+    if (!steps.empty()) {
+        std::vector<seal::Ciphertext> rotated = he.rotate_many(terms[0], steps);
+        for (size_t i = 0; i < steps.size(); i++) terms[steps[i]] = std::move(rotated[i]);
+    }
+    counts.baby_rotations = steps.size();
+
+    // Giant steps, outermost first: result = inner_0 + rot(inner_1 + rot(inner_2 + ...), g)
+    const auto& plaintexts = encoded_at(chain_index, x.parms_id());
+    seal::Ciphertext result;
+    bool started = false;
+    for (size_t j = plaintexts.size(); j-- > 0;) {
+        if (started) {
+            result = std::move(he.rotate_many(result, {static_cast<int>(baby)})[0]);
+            counts.giant_rotations++;
+        }
+        if (plaintexts[j].empty()) continue;
+        seal::Ciphertext inner = he.weighted_sum(terms.data(), plaintexts[j]);
+        for (const auto& plaintext : plaintexts[j]) {
+            if (!plaintext.is_zero()) counts.plaintext_products++;
+        }
+        if (started) {
+            he.add_inplace(result, inner);
+        } else {
+            result = std::move(inner);
+            started = true;
+        }
+    }
+    if (!tiled_bias.empty()) he.add_constant_inplace(result, tiled_bias);
+    if (stats) *stats = counts;
+    return result;
+}
@@ -0,0 +1,84 @@
+#ifndef DIAGONAL_MATRIX_H
+#define DIAGONAL_MATRIX_H
+
+#include "HomomorphicEncryption.h"
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Rotations and products a DiagonalMatrix product has done
+struct MatrixVectorStats {
+    size_t baby_rotations = 0;     // Rotations of the input
+    size_t hoisted_rotations = 0;  // Baby rotations sharing one key switching decomposition
+    size_t giant_rotations = 0;    // Rotations of partial sums
+    size_t plaintext_products = 0; // One per nonzero diagonal
+};
+
+/**
+ * A plaintext matrix for products with encrypted vectors (CKKS), encoded by
+ * generalized diagonals (Halevi-Shoup)
+ *
+ * The m x n matrix is padded to d x d, d the next power of two, and diagonal
+ * k holds W[i][(i + k) mod d]. With baby step g and diagonal k = g j + b,
+ *
+ *   W x = sum_j rot(sum_b rot(diag_k, -g j) * rot(x, b), g j)
+ *
+ * The g - 1 baby rotations of x are hoisted (one decomposition shared by
+ * every step with its own Galois key, see
+ * HomomorphicEncryption::rotate_many) and the d / g - 1 giant rotations are
+ * steps of g applied Horner-style, so a product costs about 2 sqrt(d)
+ * rotations instead of d. The diagonals are rotated in plaintext and encoded
+ * once per level, on first use; g minimizes the key switches with the Galois
+ * keys at hand (profile ml-inference has keys for baby steps up to 7).
+ *
+ * Vectors are tiled: x[i mod d] in every slot i. The product is tiled the
+ * same way (rows m .. d - 1 are zero), so it can feed another d x d product.
+ * An optional bias is added after the product, tiled the same way, at no
+ * level (e.g. a standardization folded in by Standardization::fold).
+ * Thread-safe.
+ */
+class DiagonalMatrix {
+public:
+    /**
+     * @param rows m rows of n entries each
+     * @param bias Empty, or m entries added to W x
+     * @throws std::invalid_argument for BFV, an empty, ragged or all-zero
+     *         matrix, d above the slot count, or a bias of another length
+     */
+    DiagonalMatrix(const HomomorphicEncryption& he, const std::vector<std::vector<double>>& rows,
+                   const std::vector<double>& bias = {});
+
+    size_t rows() const { return row_count; }
+    size_t columns() const { return column_count; }
+    size_t dimension() const { return d; }
+    size_t baby_step() const { return baby; }
+
+    /**
+     * W x (+ bias), one level below x, at x's scale
+     *
+     * @param x Tiled vector; or, with tiled false, columns() values in slots
+     *          0 .. n - 1 and zeros elsewhere (as from encrypt_vector), tiled
+     *          here with log2(slots / d) rotations
+     * @param stats If set, receives the rotation and product counts
+     * @throws std::invalid_argument if x has no level left
+     */
+    seal::Ciphertext multiply(const seal::Ciphertext& x, bool tiled = false, MatrixVectorStats* stats = nullptr) const;
+
+private:
+    const HomomorphicEncryption& he;
+    size_t row_count;
+    size_t column_count;
+    size_t d = 1;
+    size_t baby = 1;
+    std::vector<std::vector<double>> diagonals;  // d entries each; empty when all zero
+    std::vector<bool> baby_used;                 // Whether any nonzero diagonal has baby index b
+    std::vector<double> tiled_bias;              // bias[i mod d] in slot i (rows m .. d - 1: 0); empty without
+    mutable std::mutex mutex;
+    mutable std::map<size_t, std::vector<std::vector<seal::Plaintext>>> encoded;  // By chain index, then giant index
+
+    size_t choose_baby_step() const;
+    const std::vector<std::vector<seal::Plaintext>>& encoded_at(size_t chain_index, seal::parms_id_type parms_id) const;
+};
+
+#endif // DIAGONAL_MATRIX_H
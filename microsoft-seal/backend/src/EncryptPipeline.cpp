@@ -0,0 +1,93 @@
+/**
+ * EncryptPipeline.cpp
+ *
+ * Double-buffered packed encryption: the caller fills batch k+1 while the
+ * pool encrypts batch k, and results are drained in order from a bounded
+ * queue of futures.
+ */
+
+#include "EncryptPipeline.h"
+#include "ThreadPool.h"
+#include "Metrics.h"
+#include <algorithm>      // For std::min
+#include <chrono>         // For per-batch timing
+
+EncryptPipeline::EncryptPipeline(const HomomorphicEncryption& he, const WireOptions& wire, Emit emit,
+                                 std::shared_ptr<ThreadPool> pool, bool symmetric, size_t max_in_flight,
+                                 size_t batch_size)
+    : he(he), wire(wire), emit(std::move(emit)), pool(std::move(pool)), symmetric(symmetric),
+      max_in_flight(max_in_flight), batch_size(batch_size) {
+    if (this->max_in_flight == 0) this->max_in_flight = this->pool ? this->pool->size() + 1 : 1;
+    if (this->batch_size == 0) this->batch_size = he.slot_count();
+    this->batch_size = std::min(this->batch_size, he.slot_count());
+    batch.reserve(this->batch_size);
+}
+
+// Pending tasks reference this object, so they must finish before it goes away
+EncryptPipeline::~EncryptPipeline() {
+    for (auto& task : pending) task.wait();
+}
+
+void EncryptPipeline::push(double value) {
+    batch.push_back(value);
+    values++;
+    if (batch.size() == batch_size) submit_batch();
+}
+
+// Copied straight into the slot buffer, a batch at a time
+void EncryptPipeline::push(const double* run, size_t count) {
+    while (count > 0) {
+        size_t take = std::min(count, batch_size - batch.size());
+        batch.insert(batch.end(), run, run + take);
+        values += take;
+        run += take;
+        count -= take;
+        if (batch.size() == batch_size) submit_batch();
+    }
+}
+
+void EncryptPipeline::finish() {
+    if (!batch.empty()) submit_batch();
+    while (!pending.empty()) emit_front();
+}
+
+/**
+ * Hand the current batch to a worker (or encrypt it inline without a pool)
+ * Per-task WireStats keep workers from sharing the caller's counters
+ */
+void EncryptPipeline::submit_batch() {
+    while (pending.size() >= max_in_flight) emit_front();
+
+    auto task = [this, values = std::move(batch), request = metrics::current_request()] {
+        metrics::EndpointScope scope(request);  // Stage timings of workers count for the caller
+        auto start = std::chrono::high_resolution_clock::now();
+        Result result;
+        WireOptions task_wire(wire.format, wire.compression, &result.stats);
+        std::vector<std::string> encrypted = symmetric ? he.encrypt_vector_symmetric(values, task_wire)
+                                                       : he.encrypt_vector(values, task_wire);
+        result.ciphertext = std::move(encrypted.front());
+        auto end = std::chrono::high_resolution_clock::now();
+        result.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        return result;
+    };
+    if (pool) {
+        pending.push_back(pool->submit(std::move(task)));
+    } else {
+        std::promise<Result> done;
+        done.set_value(task());
+        pending.push_back(done.get_future());
+    }
+
+    batch.clear();
+    batch.reserve(batch_size);
+}
+
+// Wait for the oldest batch and pass its ciphertext on
+void EncryptPipeline::emit_front() {
+    Result result = pending.front().get();
+    pending.pop_front();
+    if (wire.stats) wire.stats->merge(result.stats);
+    encrypt_time_us += result.duration_us;
+    emitted++;
+    emit(std::move(result.ciphertext));
+}
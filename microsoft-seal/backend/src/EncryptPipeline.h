@@ -0,0 +1,86 @@
+#ifndef ENCRYPT_PIPELINE_H
+#define ENCRYPT_PIPELINE_H
+
+#include "HomomorphicEncryption.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * Streaming packed encryption: values in, serialized ciphertexts out
+ *
+ * Values are pushed one at a time into a slot buffer; every time
+ * slot_count() values have been collected the batch is encrypted on the
+ * thread pool while the producer keeps filling the next one. Finished
+ * ciphertexts are handed to the emit callback in input order. At most
+ * max_in_flight batches exist at once, so memory stays bounded by a few
+ * ciphertexts no matter how long the input is.
+ */
+class EncryptPipeline {
+public:
+    using Emit = std::function<void(std::string&& ciphertext)>;
+
+    /**
+     * @param he Engine holding the encryption key (must outlive the pipeline)
+     * @param wire Wire encoding and compression; wire.stats receives totals
+     * @param emit Receives each ciphertext, on the thread calling push()/finish()
+     * @param pool Worker pool (nullptr encrypts on the calling thread)
+     * @param symmetric Use seeded secret-key encryption (see encrypt_symmetric)
+     * @param max_in_flight Batches queued or encrypting at once (0 = pool size + 1)
+     * @param batch_size Values per ciphertext (0 = slot_count(); 1 mirrors per-value encrypt())
+     */
+    EncryptPipeline(const HomomorphicEncryption& he, const WireOptions& wire, Emit emit,
+                    std::shared_ptr<ThreadPool> pool = nullptr, bool symmetric = false,
+                    size_t max_in_flight = 0, size_t batch_size = 0);
+    ~EncryptPipeline();
+
+    EncryptPipeline(const EncryptPipeline&) = delete;
+    EncryptPipeline& operator=(const EncryptPipeline&) = delete;
+
+    // Add one value; may block while max_in_flight batches are pending
+    void push(double value);
+
+    // Add a run of values, e.g. a column buffer read in place (see ArrowFile)
+    void push(const double* run, size_t count);
+
+    // Encrypt the final partial batch and emit everything still pending
+    void finish();
+
+    size_t value_count() const { return values; }
+    size_t ciphertext_count() const { return emitted; }
+
+    // Encryption plus serialization time summed over all batches emitted so far
+    int64_t encrypt_us() const { return encrypt_time_us; }
+
+private:
+    struct Result {
+        std::string ciphertext;
+        WireStats stats;
+        int64_t duration_us = 0;
+    };
+
+    const HomomorphicEncryption& he;
+    WireOptions wire;
+    Emit emit;
+    std::shared_ptr<ThreadPool> pool;
+    bool symmetric;
+    size_t max_in_flight;
+    size_t batch_size;
+
+    std::vector<double> batch;
+    std::deque<std::future<Result>> pending;
+    size_t values = 0;
+    size_t emitted = 0;
+    int64_t encrypt_time_us = 0;
+
+    void submit_batch();
+    void emit_front();
+};
+
+#endif // ENCRYPT_PIPELINE_H
@@ -0,0 +1,29 @@
+/**
+ * EncryptedValue.cpp
+ *
+ * The parts of the typed ciphertext layer that need more than one call into
+ * HomomorphicEncryption.
+ */
+
+#include "EncryptedValue.h"
+
+EncryptedValue& EncryptedValue::compact() {
+    auto target = he->seal_context()->get_context_data(he->compact_parms_id(ct));
+    he->mod_switch_to_inplace(ct, target->chain_index());
+    return *this;
+}
+
+EncryptedVector EncryptedVector::from_wire(const HomomorphicEncryption& he, const CiphertextViews& data,
+                                           WireFormat format) {
+    std::vector<seal::Ciphertext> cts;
+    cts.reserve(data.size());
+    for (std::string_view item : data) cts.push_back(he.deserialize(item, format));
+    return EncryptedVector(he, std::move(cts));
+}
+
+std::vector<std::string> EncryptedVector::to_wire(const WireOptions& wire) const {
+    std::vector<std::string> out;
+    out.reserve(cts.size());
+    for (const auto& ct : cts) out.push_back(he->serialize(ct, wire));
+    return out;
+}
@@ -0,0 +1,106 @@
+#ifndef ENCRYPTED_VALUE_H
+#define ENCRYPTED_VALUE_H
+
+#include "HomomorphicEncryption.h"
+#include "CiphertextPool.h"
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Typed in-process layer over HomomorphicEncryption's object API
+ *
+ * An EncryptedValue is a seal::Ciphertext together with the instance (scheme,
+ * profile and keys) it was made under, so the steps of a request compose as
+ * values: its inputs are decoded once with from_wire(), combined in memory,
+ * and only the final result is encoded with to_wire(). Nothing in between is
+ * serialized. The instance must outlive the values made under it. Values
+ * give their ciphertexts to the calling thread's CiphertextPool when they go,
+ * for the next request's operands to load into.
+ */
+class EncryptedValue {
+public:
+    EncryptedValue(const HomomorphicEncryption& he, seal::Ciphertext ciphertext)
+        : he(&he), ct(std::move(ciphertext)) {}
+    EncryptedValue(const EncryptedValue&) = default;
+    EncryptedValue(EncryptedValue&&) = default;
+    EncryptedValue& operator=(const EncryptedValue&) = default;
+    EncryptedValue& operator=(EncryptedValue&&) = default;
+    ~EncryptedValue() { ciphertext_pool::recycle(std::move(ct)); }
+
+    // Decode a serialized ciphertext (at the HTTP boundary)
+    static EncryptedValue from_wire(const HomomorphicEncryption& he, std::string_view data,
+                                    WireFormat format = WireFormat::base64) {
+        return EncryptedValue(he, he.deserialize(data, format));
+    }
+    // Encode the result (at the HTTP boundary); wire sets compression, compaction and size report
+    std::string to_wire(const WireOptions& wire = {}) const { return he->serialize(ct, wire); }
+
+    const HomomorphicEncryption& engine() const { return *he; }
+    const seal::Ciphertext& ciphertext() const { return ct; }
+    seal::Ciphertext& ciphertext() { return ct; }
+    CiphertextInfo info() const { return he->inspect(ct); }
+    double decrypt() const { return he->decrypt(ct); }  // Needs the secret key
+
+    EncryptedValue& operator+=(const EncryptedValue& other) {
+        he->add_inplace(ct, other.ct);
+        return *this;
+    }
+    // Rotate-and-add so every slot of a packed value holds the total
+    EncryptedValue& sum_slots() {
+        he->sum_slots_inplace(ct);
+        return *this;
+    }
+    // Divide by divisor where the scheme and level allow it (CKKS); false leaves the value as is
+    bool divide(size_t divisor) { return he->divide_inplace(ct, divisor); }
+    // Switch to the lowest level that still holds the value (see compact_parms_id)
+    EncryptedValue& compact();
+
+private:
+    const HomomorphicEncryption* he;
+    seal::Ciphertext ct;
+};
+
+inline EncryptedValue operator+(EncryptedValue a, const EncryptedValue& b) {
+    return a += b;
+}
+
+/**
+ * Ciphertexts made under one instance, e.g. the encrypted column of a request
+ * or the results of a batched operation; element-wise like CiphertextStore's
+ * columns, so an upload and a stored column reduce the same way.
+ */
+class EncryptedVector {
+public:
+    explicit EncryptedVector(const HomomorphicEncryption& he, std::vector<seal::Ciphertext> ciphertexts = {})
+        : he(&he), cts(std::move(ciphertexts)) {}
+    EncryptedVector(const EncryptedVector&) = default;
+    EncryptedVector(EncryptedVector&&) = default;
+    EncryptedVector& operator=(const EncryptedVector&) = default;
+    EncryptedVector& operator=(EncryptedVector&&) = default;
+    ~EncryptedVector() {
+        for (auto& ct : cts) ciphertext_pool::recycle(std::move(ct));
+    }
+
+    // Decode each serialized ciphertext once
+    static EncryptedVector from_wire(const HomomorphicEncryption& he, const CiphertextViews& data,
+                                     WireFormat format = WireFormat::base64);
+    std::vector<std::string> to_wire(const WireOptions& wire = {}) const;
+
+    const HomomorphicEncryption& engine() const { return *he; }
+    size_t size() const { return cts.size(); }
+    bool empty() const { return cts.empty(); }
+    const seal::Ciphertext* data() const { return cts.data(); }
+    const std::vector<seal::Ciphertext>& ciphertexts() const { return cts; }
+    std::vector<seal::Ciphertext> release() { return std::move(cts); }
+
+    void push_back(EncryptedValue value) { cts.push_back(std::move(value.ciphertext())); }
+    EncryptedValue sum() const { return EncryptedValue(*he, he->sum(cts)); }
+
+private:
+    const HomomorphicEncryption* he;
+    std::vector<seal::Ciphertext> cts;
+};
+
+#endif // ENCRYPTED_VALUE_H
@@ -0,0 +1,104 @@
+#include "ExpressionEvaluator.h"
+#include <stdexcept>
+#include <utility>
+
+/**
+ * Wrap a regular (size 2, rescaled) ciphertext as an expression input
+ */
+ExpressionEvaluator::Term ExpressionEvaluator::input(seal::Ciphertext ciphertext) const {
+    Term term;
+    term.ciphertext = std::move(ciphertext);
+    return term;
+}
+
+/**
+ * Add two terms without settling either; the sum has the larger of the two sizes
+ *
+ * @throws std::invalid_argument (from SEAL) if CKKS scales differ, e.g. product plus input
+ */
+ExpressionEvaluator::Term ExpressionEvaluator::add(Term a, Term b) {
+    he.match_level_inplace(a.ciphertext, b.ciphertext);
+    if (a.ciphertext.size() < b.ciphertext.size()) std::swap(a, b);
+    he.add_inplace(a.ciphertext, b.ciphertext);
+    a.rescale_pending = a.rescale_pending || b.rescale_pending;
+    return a;
+}
+
+/**
+ * Multiply two terms; the operands are settled first, the product is not
+ */
+ExpressionEvaluator::Term ExpressionEvaluator::multiply(Term a, Term b) {
+    return product(std::move(a), &b);
+}
+
+ExpressionEvaluator::Term ExpressionEvaluator::square(Term a) {
+    return product(std::move(a), nullptr);
+}
+
+/**
+ * Inner product of two equally long ciphertext vectors
+ * All products are accumulated at size 3, so finish() on the result does the
+ * only relinearization (and CKKS rescale) of the whole sum
+ */
+ExpressionEvaluator::Term ExpressionEvaluator::dot(const std::vector<seal::Ciphertext>& a,
+                                                   const std::vector<seal::Ciphertext>& b) {
+    if (a.size() != b.size()) throw std::invalid_argument("Vectors differ in length");
+    if (a.empty()) throw std::invalid_argument("Empty vectors");
+
+    Term sum = multiply(input(a[0]), input(b[0]));
+    for (size_t i = 1; i < a.size(); i++) {
+        Term term = multiply(input(a[i]), input(b[i]));
+        he.match_level_inplace(sum.ciphertext, term.ciphertext);
+        he.add_inplace(sum.ciphertext, term.ciphertext);
+    }
+    return sum;
+}
+
+seal::Ciphertext ExpressionEvaluator::finish(Term term) {
+    settle(term);
+    return std::move(term.ciphertext);
+}
+
+/**
+ * Bring a term back to a regular ciphertext: one key switch if it is of size 3,
+ * one rescale (CKKS) or modulus switch (BGV) if a product is pending
+ */
+void ExpressionEvaluator::settle(Term& term) {
+    if (term.ciphertext.size() > 2) {
+        he.relinearize_inplace(term.ciphertext);
+        counters.relinearizations++;
+    }
+    if (term.rescale_pending) {
+        he.rescale_inplace(term.ciphertext);
+        term.rescale_pending = false;
+        counters.rescales++;
+    }
+}
+
+/**
+ * a * b, or a * a if b is null
+ */
+ExpressionEvaluator::Term ExpressionEvaluator::product(Term a, Term* b) {
+    settle(a);
+    if (b) {
+        settle(*b);
+        he.match_level_inplace(a.ciphertext, b->ciphertext);
+    }
+
+    Term result;
+    result.ciphertext = he.multiply(a.ciphertext, b ? b->ciphertext : a.ciphertext);
+    result.rescale_pending = he.rescales();
+    counters.multiplications++;
+    return result;
+}
+
+/**
+ * Counts so far, with the savings against an eager evaluation that relinearizes
+ * (and for CKKS and BGV rescales) every product right away
+ */
+ExpressionStats ExpressionEvaluator::stats() const {
+    ExpressionStats stats = counters;
+    stats.relinearizations_saved = stats.multiplications - stats.relinearizations;
+    stats.rescales_saved = he.rescales() ? stats.multiplications - stats.rescales : 0;
+    return stats;
+}
@@ -0,0 +1,60 @@
+#ifndef EXPRESSION_EVALUATOR_H
+#define EXPRESSION_EVALUATOR_H
+
+#include "HomomorphicEncryption.h"
+#include <cstddef>
+#include <vector>
+
+// Key switches and rescales an expression used, against one of each per multiplication
+struct ExpressionStats {
+    size_t multiplications = 0;
+    size_t relinearizations = 0;
+    size_t rescales = 0;
+    size_t relinearizations_saved = 0;
+    size_t rescales_saved = 0;  // CKKS and BGV (modulus switches); BFV never rescales
+};
+
+/**
+ * Sums of products over ciphertexts with lazy relinearization and rescaling
+ *
+ * A product stays in its size-3 form, and for CKKS at the squared scale,
+ * until something needs it smaller: only multiply() and finish() settle
+ * their operands. add() accepts size-3 terms, so sum_i a_i * b_i (dot())
+ * costs one relinearization and one rescale instead of one per product.
+ * stats() compares that with relinearizing and rescaling after every
+ * multiplication.
+ *
+ * CKKS terms can only be added if their scales match, i.e. products are
+ * added to products and inputs to inputs. Not thread-safe; use one instance
+ * per request.
+ */
+class ExpressionEvaluator {
+public:
+    // An intermediate value: possibly of size 3, and/or awaiting a CKKS rescale or BGV modulus switch
+    struct Term {
+        seal::Ciphertext ciphertext;
+        bool rescale_pending = false;
+    };
+
+    explicit ExpressionEvaluator(const HomomorphicEncryption& he) : he(he) {}
+
+    Term input(seal::Ciphertext ciphertext) const;
+    Term add(Term a, Term b);
+    Term multiply(Term a, Term b);
+    Term square(Term a);
+    Term dot(const std::vector<seal::Ciphertext>& a, const std::vector<seal::Ciphertext>& b);
+
+    // Relinearize and rescale what is still pending; the result is a regular ciphertext
+    seal::Ciphertext finish(Term term);
+
+    ExpressionStats stats() const;
+
+private:
+    const HomomorphicEncryption& he;
+    ExpressionStats counters;
+
+    void settle(Term& term);
+    Term product(Term a, Term* b);
+};
+
+#endif // EXPRESSION_EVALUATOR_H
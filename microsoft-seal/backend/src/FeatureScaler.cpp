@@ -0,0 +1,73 @@
+#include "FeatureScaler.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+void Standardization::check(size_t features) const {
+    if (mean.size() != features || scale.size() != features) {
+        throw std::invalid_argument("Expected one mean and scale per feature (" + std::to_string(features) + ")");
+    }
+    for (double value : scale) {
+        if (value == 0) throw std::invalid_argument("Standardization scale must be nonzero");
+    }
+}
+
+std::vector<double> Standardization::multipliers() const {
+    std::vector<double> result;
+    result.reserve(scale.size());
+    for (double value : scale) result.push_back(1 / value);
+    return result;
+}
+
+std::vector<double> Standardization::offsets() const {
+    std::vector<double> result;
+    result.reserve(mean.size());
+    for (size_t i = 0; i < mean.size() && i < scale.size(); i++) result.push_back(-mean[i] / scale[i]);
+    return result;
+}
+
+void Standardization::fold(std::vector<std::vector<double>>& rows, std::vector<double>& bias) const {
+    check(rows.empty() ? 0 : rows[0].size());
+    bias.resize(rows.size(), 0.0);
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (rows[i].size() != scale.size()) throw std::invalid_argument("Matrix rows differ in length");
+        for (size_t j = 0; j < scale.size(); j++) {
+            rows[i][j] /= scale[j];
+            bias[i] -= rows[i][j] * mean[j];
+        }
+    }
+}
+
+FeatureScaler::FeatureScaler(const HomomorphicEncryption& he, std::vector<double> multipliers,
+                             std::vector<double> offsets)
+    : he(he), multipliers(std::move(multipliers)), offsets(std::move(offsets)) {
+    if (he.seal_context()->first_context_data()->parms().scheme() != seal::scheme_type::ckks) {
+        throw std::invalid_argument("Feature scaling needs CKKS");
+    }
+    const size_t slots = he.slot_count();
+    if (this->multipliers.size() > slots || this->offsets.size() > slots) {
+        throw std::invalid_argument("Scaling has more values than the " + std::to_string(slots) + " slots");
+    }
+    if (std::all_of(this->multipliers.begin(), this->multipliers.end(), [](double value) { return value == 0; })) {
+        throw std::invalid_argument("Scaling multipliers are all zero");
+    }
+    this->multipliers.resize(slots, 0.0);
+    this->offsets.resize(slots, 0.0);
+}
+
+// Multipliers encoded at the given level, at the scale of the prime the rescale drops (cached)
+const std::vector<seal::Plaintext>& FeatureScaler::encoded_at(size_t chain_index, seal::parms_id_type parms_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = encoded.find(chain_index);
+    if (found != encoded.end()) return found->second;
+    return encoded.emplace(chain_index, he.encode_weights(multipliers, true, parms_id)).first->second;
+}
+
+seal::Ciphertext FeatureScaler::apply(const seal::Ciphertext& x) const {
+    const size_t chain_index = he.chain_index(x);
+    if (chain_index == 0) throw std::invalid_argument("Feature scaling needs a level, the ciphertext has none left");
+    seal::Ciphertext result = he.weighted_sum(&x, encoded_at(chain_index, x.parms_id()));
+    he.add_constant_inplace(result, offsets);
+    return result;
+}
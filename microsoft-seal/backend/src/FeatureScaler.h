@@ -0,0 +1,75 @@
+#ifndef FEATURE_SCALER_H
+#define FEATURE_SCALER_H
+
+#include "HomomorphicEncryption.h"
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * Per-feature standardization (x - mean) / scale, as fit by scikit-learn's
+ * StandardScaler (machine-learning/concrete_*.py export its mean_ and scale_)
+ */
+struct Standardization {
+    std::vector<double> mean;
+    std::vector<double> scale;
+
+    /**
+     * @throws std::invalid_argument unless there is one mean and one nonzero
+     *         scale per feature
+     */
+    void check(size_t features) const;
+
+    // 1 / scale and -mean / scale per feature: standardized x = x * multiplier + offset
+    std::vector<double> multipliers() const;
+    std::vector<double> offsets() const;
+
+    /**
+     * Fold into a linear layer W x + b taking standardized x, so that it takes
+     * raw x instead: W[i][j] / scale[j], and b[i] - sum_j W[i][j] mean[j] /
+     * scale[j] (bias is resized to one entry per row)
+     * @throws std::invalid_argument as check() for the column count
+     */
+    void fold(std::vector<std::vector<double>>& rows, std::vector<double>& bias) const;
+};
+
+/**
+ * Slot-wise x * multiplier + offset on packed CKKS ciphertexts, e.g. a
+ * Standardization replicated over a PatientPacking or CentroidPacking: one
+ * multiply_plain, whose rescale keeps x's scale, and one add_plain. One level.
+ *
+ * Where standardized features feed a linear layer it is cheaper to fold the
+ * standardization into the layer (Standardization::fold,
+ * LogisticModel::fold_standardization), which costs no level; this stage is
+ * for consumers that square or compare the features first, like the k-means
+ * distances. The multipliers are encoded once per level, on first use, and
+ * the offsets come from the engine's plaintext cache. Thread-safe.
+ */
+class FeatureScaler {
+public:
+    /**
+     * @param multipliers Slot-wise factors (missing slots are 0)
+     * @param offsets Slot-wise terms added after the product (missing slots are 0)
+     * @throws std::invalid_argument for BFV or BGV, all-zero multipliers or
+     *         more values than slots
+     */
+    FeatureScaler(const HomomorphicEncryption& he, std::vector<double> multipliers, std::vector<double> offsets);
+
+    /**
+     * x * multipliers + offsets, one level below x, at x's scale
+     * @throws std::invalid_argument if x has no level left
+     */
+    seal::Ciphertext apply(const seal::Ciphertext& x) const;
+
+private:
+    const HomomorphicEncryption& he;
+    std::vector<double> multipliers;
+    std::vector<double> offsets;
+    mutable std::mutex mutex;
+    mutable std::map<size_t, std::vector<seal::Plaintext>> encoded;  // Multipliers (one plaintext) by chain index
+
+    const std::vector<seal::Plaintext>& encoded_at(size_t chain_index, seal::parms_id_type parms_id) const;
+};
+
+#endif // FEATURE_SCALER_H
@@ -0,0 +1,95 @@
+/**
+ * HeClient.cpp
+ *
+ * Public-key packed encryption on the client side, written straight into
+ * the /binary/... framing as the ciphertexts come out of the pipeline.
+ */
+
+#include "HeClient.h"
+#include "BinaryFraming.h"
+#include "EncryptPipeline.h"
+#include "KeyStore.h"
+#include "ThreadPool.h"
+#include <sstream>        // For the single-buffer encrypt_column
+#include <stdexcept>      // For std::out_of_range
+
+HeClient::HeClient(const std::string& scheme, std::string_view public_key, const ParameterProfile& profile,
+                   size_t threads, seal::compr_mode_type compression)
+    : compression(compression),
+      he(std::make_unique<HomomorphicEncryption>(parse_scheme(scheme), false, profile)),
+      pool(std::make_shared<ThreadPool>(threads)) {
+    he->load_public_key(public_key);
+}
+
+HeClient::HeClient(const std::string& scheme, const KeyStore& store, const ParameterProfile& profile,
+                   size_t threads, seal::compr_mode_type compression)
+    : compression(compression),
+      he(std::make_unique<HomomorphicEncryption>(parse_scheme(scheme), false, profile)),
+      pool(std::make_shared<ThreadPool>(threads)) {
+    // Lazy Galois keys: they are never read, as a client does not rotate
+    if (!he->load_keys(store, false, true)) {
+        throw std::out_of_range("No " + profile.name + " " + scheme + " public key in " + store.directory());
+    }
+}
+
+HeClient::~HeClient() = default;
+
+size_t HeClient::encrypt_column(const std::vector<double>& values, std::ostream& out, WireStats* stats) const {
+    auto pipeline = start_column(values.size(), out, stats);
+    for (double value : values) pipeline->push(value);
+    pipeline->finish();
+    if (!out) throw std::runtime_error("Failed to write encrypted column");
+    return pipeline->ciphertext_count();
+}
+
+std::string HeClient::encrypt_column(const std::vector<double>& values, WireStats* stats) const {
+    std::ostringstream out;
+    encrypt_column(values, out, stats);
+    return out.str();
+}
+
+/**
+ * Every column's values are queued before any column is finished, so columns
+ * shorter than slot_count() (one ciphertext each) still keep all threads busy
+ */
+std::vector<std::string> HeClient::encrypt_columns(const std::vector<std::vector<double>>& columns,
+                                                   WireStats* stats) const {
+    std::vector<std::ostringstream> outputs(columns.size());
+    std::vector<std::unique_ptr<EncryptPipeline>> pipelines;
+    pipelines.reserve(columns.size());
+    for (size_t i = 0; i < columns.size(); i++) {
+        pipelines.push_back(start_column(columns[i].size(), outputs[i], stats));
+        for (double value : columns[i]) pipelines.back()->push(value);
+    }
+
+    std::vector<std::string> framed;
+    framed.reserve(columns.size());
+    for (size_t i = 0; i < columns.size(); i++) {
+        pipelines[i]->finish();
+        framed.push_back(outputs[i].str());
+    }
+    return framed;
+}
+
+std::unique_ptr<EncryptPipeline> HeClient::pipeline(std::function<void(std::string&& ciphertext)> emit,
+                                                    WireStats* stats) const {
+    WireOptions wire(WireFormat::binary, compression, stats);
+    return std::make_unique<EncryptPipeline>(*he, wire, std::move(emit), pool);
+}
+
+/**
+ * Write the frame header for count values and return a pipeline that appends
+ * each ciphertext to out as it is emitted
+ */
+std::unique_ptr<EncryptPipeline> HeClient::start_column(size_t count, std::ostream& out, WireStats* stats) const {
+    std::string header;
+    framing::put_uint(header, ciphertext_count(count), 4);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    return pipeline([&out](std::string&& ciphertext) {
+        std::string length;
+        framing::put_uint(length, ciphertext.size(), 8);
+        out.write(length.data(), static_cast<std::streamsize>(length.size()));
+        out.write(ciphertext.data(), static_cast<std::streamsize>(ciphertext.size()));
+    }, stats);
+}
@@ -0,0 +1,99 @@
+#ifndef HE_CLIENT_H
+#define HE_CLIENT_H
+
+#include "HomomorphicEncryption.h"
+#include "ParameterProfile.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+class EncryptPipeline;
+class KeyStore;
+class ThreadPool;
+
+/**
+ * Client-side encryption for ingestion workers (the he-client library)
+ *
+ * Holds only the server's public key, never the secret key, and encrypts
+ * columns of values into packed ciphertexts, slot_count() values each, on a
+ * pool of its own threads. Output is the framed binary format of the
+ * /binary/... endpoints (see BinaryFraming.h), ready to be sent to e.g.
+ * POST /binary/csv/sum?packed=1 or PUT /binary/store, so mini-backend never
+ * has to encrypt on a client's behalf. Thread-safe; the encrypt_* calls of
+ * several threads share the pool.
+ */
+class HeClient {
+public:
+    /**
+     * @param scheme "bfv", "ckks" or "bgv"
+     * @param public_key Base64 public key, as returned by mini-backend's GET /public_key
+     * @param profile Parameters the key was made for (the /public_key ?profile=)
+     * @param threads Encryption threads
+     * @param compression SEAL compression of the ciphertexts
+     * @throws std::invalid_argument for unknown schemes or a key that does not fit the parameters
+     */
+    HeClient(const std::string& scheme, std::string_view public_key,
+             const ParameterProfile& profile = profiles::default_profile(),
+             size_t threads = std::thread::hardware_concurrency(),
+             seal::compr_mode_type compression = seal::Serialization::compr_mode_default);
+
+    /**
+     * Same, with the public key read from a key store shared with the backends
+     * (its secret key, if there, is not loaded)
+     * @throws std::out_of_range if the store has no key for the scheme and profile
+     */
+    HeClient(const std::string& scheme, const KeyStore& store,
+             const ParameterProfile& profile = profiles::default_profile(),
+             size_t threads = std::thread::hardware_concurrency(),
+             seal::compr_mode_type compression = seal::Serialization::compr_mode_default);
+
+    ~HeClient();
+
+    HeClient(const HeClient&) = delete;
+    HeClient& operator=(const HeClient&) = delete;
+
+    // Values per ciphertext
+    size_t slot_count() const { return he->slot_count(); }
+    std::shared_ptr<seal::SEALContext> seal_context() const { return he->seal_context(); }
+    // Ciphertexts encrypt_column writes for count values
+    size_t ciphertext_count(size_t count) const { return (count + slot_count() - 1) / slot_count(); }
+
+    /**
+     * Encrypt a column and write it framed to out, each ciphertext as soon as it is done
+     *
+     * At most threads + 1 ciphertexts are held at once, however long the column.
+     * @param stats Receives the raw and wire sizes (optional)
+     * @return Number of ciphertexts written
+     */
+    size_t encrypt_column(const std::vector<double>& values, std::ostream& out, WireStats* stats = nullptr) const;
+
+    // The same framed output as one buffer
+    std::string encrypt_column(const std::vector<double>& values, WireStats* stats = nullptr) const;
+
+    // One framed buffer per column, in order
+    std::vector<std::string> encrypt_columns(const std::vector<std::vector<double>>& columns,
+                                             WireStats* stats = nullptr) const;
+
+    /**
+     * Streaming encryption of one column, for output other than the framing
+     * (e.g. ColumnFile::Writer): push() its values, then finish(); emit gets
+     * each ciphertext serialized in the binary wire format, in order, on the
+     * pushing thread. Pipelines of several columns share the client's threads
+     */
+    std::unique_ptr<EncryptPipeline> pipeline(std::function<void(std::string&& ciphertext)> emit,
+                                              WireStats* stats = nullptr) const;
+
+private:
+    seal::compr_mode_type compression;
+    std::unique_ptr<HomomorphicEncryption> he;  // Public key only
+    std::shared_ptr<ThreadPool> pool;
+
+    std::unique_ptr<EncryptPipeline> start_column(size_t count, std::ostream& out, WireStats* stats) const;
+};
+
+#endif // HE_CLIENT_H
@@ -0,0 +1,55 @@
+#include "HistogramBuckets.h"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+HistogramBuckets::HistogramBuckets(double min, double width, size_t count) : min(min), width(width), buckets(count) {
+    if (!(width > 0) || !std::isfinite(min) || !std::isfinite(width)) {
+        throw std::invalid_argument("Bucket width must be positive and finite");
+    }
+    if (count == 0 || (count & (count - 1)) != 0) throw std::invalid_argument("Bucket count must be a power of two");
+}
+
+size_t HistogramBuckets::bucket(double value) const {
+    const double position = std::floor((value - min) / width);
+    if (!(position > 0)) return 0;  // Below the range, or NaN
+    if (position >= static_cast<double>(buckets - 1)) return buckets - 1;
+    return static_cast<size_t>(position);
+}
+
+std::vector<double> HistogramBuckets::one_hot(const std::vector<double>& values) const {
+    std::vector<double> slots(values.size() * buckets, 0.0);
+    for (size_t i = 0; i < values.size(); i++) slots[i * buckets + bucket(values[i])] = 1.0;
+    return slots;
+}
+
+/**
+ * The value at percentile q is the (q / 100 * n)-th smallest of the n
+ * counted, assuming a bucket's values are spread evenly over it: the bucket
+ * holding that rank, plus the rank's fraction through the bucket's count
+ */
+std::vector<double> HistogramBuckets::percentiles(const std::vector<double>& cumulative,
+                                                  const std::vector<double>& ranks) const {
+    if (cumulative.size() < buckets) {
+        throw std::invalid_argument("Expected " + std::to_string(buckets) + " cumulative counts");
+    }
+    std::vector<double> counts(buckets);
+    for (size_t b = 0; b < buckets; b++) {
+        counts[b] = std::round(cumulative[b]);
+        if (b > 0 && counts[b] < counts[b - 1]) throw std::invalid_argument("Cumulative counts decrease");
+    }
+    const double total = counts.back();
+    if (!(total > 0)) throw std::invalid_argument("No values were counted");
+
+    std::vector<double> result;
+    result.reserve(ranks.size());
+    for (double q : ranks) {
+        if (!(q >= 0 && q <= 100)) throw std::invalid_argument("Percentiles must be between 0 and 100");
+        const double rank = q / 100 * total;
+        size_t b = 0;
+        while (counts[b] < rank || counts[b] == 0) b++;  // Ends at the last bucket: rank <= total
+        const double before = b > 0 ? counts[b - 1] : 0.0;
+        result.push_back(min + width * (static_cast<double>(b) + (rank - before) / (counts[b] - before)));
+    }
+    return result;
+}
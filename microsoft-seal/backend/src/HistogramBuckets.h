@@ -0,0 +1,52 @@
+#ifndef HISTOGRAM_BUCKETS_H
+#define HISTOGRAM_BUCKETS_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Equal-width buckets of a value range, for percentiles from an encrypted
+ * histogram
+ *
+ * The key holder one-hot encodes every value into count() slots
+ * (one_hot(), packed by encrypt_vector), main-backend's /csv/histogram with
+ * "cumulative" adds them up and prefix-sums the buckets in one pass, and
+ * percentiles() reads any number of percentiles off the one decrypted
+ * result, interpolating linearly within a bucket. Values outside the range
+ * are counted in the first or last bucket, so the outer percentiles are
+ * clamped to it. Precision is the bucket width.
+ */
+class HistogramBuckets {
+public:
+    /**
+     * @param min Lower edge of the first bucket
+     * @param width Width of every bucket
+     * @param count Number of buckets, a power of two (as HomomorphicEncryption::histogram needs)
+     * @throws std::invalid_argument for a width that is not positive or another count
+     */
+    HistogramBuckets(double min, double width, size_t count);
+
+    size_t count() const { return buckets; }
+
+    // Bucket of a value, clamped to the range
+    size_t bucket(double value) const;
+
+    // count() slots per value, a 1 in the slot of its bucket
+    std::vector<double> one_hot(const std::vector<double>& values) const;
+
+    /**
+     * Values at percentiles (0 to 100) of the counted values
+     * @param cumulative Decrypted cumulative counts, slot b the count of buckets 0 .. b
+     *                   (CKKS noise is rounded away)
+     * @throws std::invalid_argument for fewer than count() slots, counts that decrease, no
+     *         values or a percentile outside [0, 100]
+     */
+    std::vector<double> percentiles(const std::vector<double>& cumulative, const std::vector<double>& ranks) const;
+
+private:
+    double min;
+    double width;
+    size_t buckets;
+};
+
+#endif // HISTOGRAM_BUCKETS_H
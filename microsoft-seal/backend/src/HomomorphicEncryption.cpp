@@ -7,99 +7,481 @@
  * 
  * Key features:
  * - Encryption/decryption of numeric values
+ * - Batched (slot-packed) encryption/decryption of numeric vectors
+ * - Seeded symmetric encryption for half-size uploads
+ * - Log-depth slot reduction via rotations and Galois keys
  * - Homomorphic addition operations
- * - Key serialization and management
+ * - Approximate CKKS comparisons (max, min, threshold counts) by Paterson-Stockmeyer
+ *   evaluation of composite sign polynomials
+ * - Encrypted logistic regression scoring of many patients per ciphertext
+ * - Key serialization and management (including a persistent on-disk key store)
  * - Base64 encoding for data transport
+ * - Selectable SEAL compression (none/zlib/zstd/bitpack) with raw vs. wire size reporting
+ * - Per-thread SEAL memory pools for scratch allocations under concurrent load
+ * - Per-stage latency metrics (encode/encrypt/deserialize/evaluate/serialize/decrypt)
  */
 
 #include "HomomorphicEncryption.h"
+#include "ThreadPool.h"
+#include "Base64.h"
+#include "Cancellation.h"
+#include "CiphertextPool.h"
+#include "KeyStore.h"
+#include "Metrics.h"
+#include "PolynomialEvaluator.h"
+#include "InverseApproximation.h"
+#include "LogisticModel.h"
+#include "CentroidPacking.h"
+#include "PrivateSetIntersection.h"
+#include "Probes.h"
+#include "ZeroPool.h"
+#include "seal/util/blake2.h"
+#include "seal/util/cpufeatures.h"
 #include <vector>         // For std::vector containers
 #include <stdexcept>      // For exception handling
 #include <cstdint>        // For fixed-width integer types
 #include <cmath>          // For mathematical operations (pow, round)
-#include <sstream>        // For string stream operations
 #include <iomanip>        // For I/O formatting
 #include <chrono>         // For timing measurements
 #include <iostream>       // For console output
+#include <sstream>        // For the one-line key generation report
+#include <algorithm>      // For std::min
+#include <mutex>          // For the shared source of a streamed sum
+#include <type_traits>    // For std::is_reference_v, std::is_integral_v, std::is_same_v
+#include <utility>        // For std::pair
+#include <atomic>         // For the progress of logistic_gradient
+#include <complex>        // For paired CKKS slots
 
 /**
- * Anonymous namespace containing utility functions for Base64 encoding/decoding
+ * Anonymous namespace containing serialization helpers
  * Used for serializing encrypted data for transmission over HTTP/JSON
  */
 namespace {
-    // Base64 alphabet used for encoding binary data to text
-    const std::string base64_chars = 
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz"
-        "0123456789+/";
+    // Bits of modulus a CKKS result keeps above its scale, so values up to 2^20 cannot wrap
+    constexpr double result_headroom_bits = 20;
+
+    // BFV and BGV plain modulus of a profile: its own prime (a CRT residue) or a batching prime of its size
+    seal::Modulus profile_plain_modulus(const ParameterProfile& profile) {
+        if (profile.plain_modulus) return seal::Modulus(profile.plain_modulus);
+        return seal::PlainModulus::Batching(profile.poly_modulus_degree, profile.plain_modulus_bits);
+    }
+
+    // Microseconds since start, for stage timings that do not fit a scope
+    uint64_t elapsed_us(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    /**
+     * Appends the SEAL serialization of an object (ciphertext or key) to a buffer
+     * Sizes the buffer with save_size() and saves in place, so there is no
+     * stream growth and no intermediate copy
+     * @param obj SEAL object with save_size()/save(seal_byte*, size)
+     * @param out Buffer the bytes are appended to
+     * @param compr_mode SEAL compression applied to the payload
+     */
+    template <typename T>
+    void save_bytes(const T& obj, std::string& out,
+                    seal::compr_mode_type compr_mode = seal::Serialization::compr_mode_default) {
+        size_t offset = out.size();
+        out.resize(offset + static_cast<size_t>(obj.save_size(compr_mode)));
+        auto written = obj.save(reinterpret_cast<seal::seal_byte*>(&out[offset]), out.size() - offset, compr_mode);
+        out.resize(offset + static_cast<size_t>(written));
+    }
+
+    // Probe arguments: in-memory size of ciphertext objects, total size of serialized inputs
+    [[maybe_unused]] uint64_t ciphertext_bytes(const seal::Ciphertext& ct) {
+        return ct.dyn_array().size() * sizeof(seal::Ciphertext::ct_coeff_type);
+    }
+
+    [[maybe_unused]] uint64_t ciphertext_bytes(const seal::Ciphertext* cts, size_t count) {
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < count; i++) bytes += ciphertext_bytes(cts[i]);
+        return bytes;
+    }
+
+    [[maybe_unused]] uint64_t total_size(const CiphertextViews& items) {
+        uint64_t bytes = 0;
+        for (const auto& item : items) bytes += item.size();
+        return bytes;
+    }
 
     /**
-     * Converts binary data to Base64 string representation
-     * @param input Raw binary data as string
-     * @return Base64 encoded string
+     * Loads a SEAL object directly from a contiguous byte range
+     * @param obj Destination SEAL object
+     * @param context SEAL context used for validation
+     * @param data Serialized bytes
+     * @param size Number of bytes
+     * @param check Whether to validate every coefficient or only the metadata and size
+     * Ciphertexts are loaded into their own allocation when it is large enough (see CiphertextPool.h)
      */
-    std::string to_base64(const std::string& input) {
-        std::string ret;
-        int val = 0, valb = -6;
-        for (uint8_t c : input) {
-            val = (val << 8) + c;
-            valb += 8;
-            while (valb >= 0) {
-                ret.push_back(base64_chars[(val >> valb) & 0x3F]);
-                valb -= 6;
+    template <typename T>
+    void load_bytes(T& obj, const seal::SEALContext& context, const char* data, size_t size,
+                    LoadCheck check = LoadCheck::full) {
+        const auto* in = reinterpret_cast<const seal::seal_byte*>(data);
+        if constexpr (std::is_same_v<T, seal::Ciphertext>) {
+            if (check == LoadCheck::trusted) {
+                obj.unsafe_load_in_place(context, in, size);
+            } else {
+                obj.load_in_place(context, in, size);
             }
+        } else if (check == LoadCheck::trusted) {
+            obj.unsafe_load(context, in, size);
+        } else {
+            obj.load(context, in, size);
         }
-        if (valb > -6) ret.push_back(base64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
-        while (ret.size() % 4) ret.push_back('=');  // Add padding
-        return ret;
     }
 
     /**
-     * Converts Base64 string back to binary data
-     * @param input Base64 encoded string
-     * @return Decoded binary data as string
+     * Serializes a SEAL object in the requested wire format, appending to out
+     * Base64 output is staged in a per-thread scratch buffer that is reused across calls
+     * If wire.stats is set, the uncompressed and produced sizes are added to it
+     * The Base64 step is timed as the scheme's "base64_encode" stage
      */
-    std::string from_base64(const std::string& input) {
-        std::vector<int> T(256, -1);  // Translation table
-        for (int i = 0; i < 64; i++) T[base64_chars[i]] = i;
-
-        std::string output;
-        int val = 0, valb = -8;
-        for (uint8_t c : input) {
-            if (T[c] == -1) break;  // Stop at invalid character (padding)
-            val = (val << 6) + T[c];
-            valb += 6;
-            if (valb >= 0) {
-                output.push_back(char((val >> valb) & 0xFF));
-                valb -= 8;
-            }
+    template <typename T>
+    void save_wire(const T& obj, std::string& out, const WireOptions& wire, const char* scheme) {
+        size_t offset = out.size();
+        if (wire.format == WireFormat::binary) {
+            save_bytes(obj, out, wire.compression);
+        } else {
+            thread_local std::string scratch;
+            scratch.clear();
+            save_bytes(obj, scratch, wire.compression);
+            metrics::ScopedTimer timer(metrics::stage(scheme, "base64_encode"));
+            base64::encode(scratch.data(), scratch.size(), out);
+        }
+        if (wire.stats) {
+            wire.stats->raw_bytes += static_cast<size_t>(obj.save_size(seal::compr_mode_type::none));
+            wire.stats->wire_bytes += out.size() - offset;
+        }
+    }
+
+    /**
+     * Loads a SEAL object from its wire representation
+     * Base64 input is decoded into a per-thread scratch buffer that is reused across calls,
+     * timed as the scheme's "base64_decode" stage
+     */
+    template <typename T>
+    void load_wire(T& obj, const seal::SEALContext& context, const char* data, size_t size, WireFormat format,
+                   const char* scheme, LoadCheck check = LoadCheck::full) {
+        if (format == WireFormat::binary) {
+            load_bytes(obj, context, data, size, check);
+            return;
+        }
+        thread_local std::string scratch;
+        {
+            metrics::ScopedTimer timer(metrics::stage(scheme, "base64_decode"));
+            base64::decode(data, size, scratch);
+        }
+        load_bytes(obj, context, scratch.data(), scratch.size(), check);
+    }
+
+    // This thread's scratch arena (set_scratch_arenas), created on first use
+    thread_local std::unique_ptr<seal::ScratchArena> scratch_arena;
+
+    /**
+     * Odd polynomials whose composites approximate sign(x) on [-1, 1] (Cheon, Kim
+     * and Kim, "Efficient Homomorphic Comparison Methods with Optimal Complexity"):
+     * f_n keeps f_n(1) = 1 and is flat to order n at +-1, g_n is the minimax choice
+     * that moves small |x| towards 1 fastest. Coefficients of x^0, x^1, ...
+     */
+    const std::vector<double> sign_f1 = {0, 3.0 / 2, 0, -1.0 / 2};
+    const std::vector<double> sign_f3 = {0, 35.0 / 16, 0, -35.0 / 16, 0, 21.0 / 16, 0, -5.0 / 16};
+    const std::vector<double> sign_g1 = {0, 2126.0 / 1024, 0, -1359.0 / 1024};
+    const std::vector<double> sign_g3 = {0, 4589.0 / 1024, 0, -16577.0 / 1024, 0, 25614.0 / 1024, 0, -12860.0 / 1024};
+
+    /**
+     * Composite for a budget of levels (at least 2): g_3 stages (3 levels each) while
+     * 5 or more levels remain, then f_1 (2 levels), f_3 (3) or two of f_1 (4; g_1 and
+     * f_1 without a g_3 before). Largest error |approximation - sign(x)|:
+     *   |x| >= 0.3:  0.09 with 5 levels, 0.013 with 6 or 7
+     *   |x| >= 0.05: 0.09 with 8 levels, 0.013 with 9 or 10
+     *   |x| >= 0.01: 0.09 with 11 levels, 0.013 with 12 or 13
+     */
+    std::vector<const std::vector<double>*> sign_schedule(size_t levels) {
+        if (levels < 2) throw std::invalid_argument("Approximating sign(x) needs at least 2 levels");
+        std::vector<const std::vector<double>*> stages;
+        for (; levels >= 5; levels -= 3) stages.push_back(&sign_g3);
+        if (levels == 4) stages.push_back(stages.empty() ? &sign_g1 : &sign_f1);
+        stages.push_back(levels == 3 ? &sign_f3 : &sign_f1);
+        return stages;
+    }
+
+    double evaluate_plain(const std::vector<double>& coefficients, double x) {
+        double value = 0;
+        for (size_t i = coefficients.size(); i-- > 0;) value = value * x + coefficients[i];
+        return value;
+    }
+
+    // The composite sign_schedule(levels) evaluated in the clear, e.g. at known padding values
+    double approximate_sign_plain(double x, size_t levels) {
+        for (const auto* stage : sign_schedule(levels)) x = evaluate_plain(*stage, x);
+        return x;
+    }
+
+    size_t ceil_log2(size_t n) {
+        size_t bits = 0;
+        while ((size_t(1) << bits) < n) bits++;
+        return bits;
+    }
+
+    // Context data of the chain level with the given index
+    std::shared_ptr<const seal::SEALContext::ContextData> level_at(const seal::SEALContext& context,
+                                                                   size_t chain_index) {
+        auto context_data = context.first_context_data();
+        while (context_data && context_data->chain_index() > chain_index) {
+            context_data = context_data->next_context_data();
+        }
+        if (!context_data || context_data->chain_index() != chain_index) {
+            throw std::invalid_argument("No level " + std::to_string(chain_index) + " in the modulus chain");
+        }
+        return context_data;
+    }
+
+    // Galois element whose key sits at index of GaloisKeys::data() (see GaloisKeys::get_index)
+    uint32_t galois_element(size_t index) {
+        return static_cast<uint32_t>(2 * index + 1);
+    }
+
+    // Key store kind of the file holding one Galois element's key
+    std::string galois_element_kind(uint32_t element) {
+        return "galois_" + std::to_string(element);
+    }
+
+    // Copy the keys present in from into into (both sparse, as SEAL generates them)
+    void merge_galois_keys(const seal::GaloisKeys& from, seal::GaloisKeys& into) {
+        if (into.data().size() < from.data().size()) into.data().resize(from.data().size());
+        for (size_t index = 0; index < from.data().size(); index++) {
+            if (!from.data()[index].empty()) into.data()[index] = from.expanded_key(index);
+        }
+        into.parms_id() = from.parms_id();
+    }
+
+    // Reject bytes that are not one whole SEAL object before they are kept to be loaded later
+    void check_serialized(std::string_view bytes, const char* what) {
+        seal::Serialization::SEALHeader header;
+        if (bytes.size() >= seal::Serialization::seal_header_size) {
+            seal::Serialization::LoadHeader(reinterpret_cast<const seal::seal_byte*>(bytes.data()), bytes.size(),
+                                            header);
         }
-        return output;
+        if (!seal::Serialization::IsValidHeader(header) || header.size != bytes.size()) {
+            throw std::invalid_argument(std::string("Invalid serialized ") + what);
+        }
+    }
+}
+
+/**
+ * Map an API compression name to the SEAL mode
+ * 
+ * @param name "none", "zlib", "zstd" or "bitpack"
+ * @return The matching seal::compr_mode_type
+ * @throws std::invalid_argument for unknown names or modes SEAL was built without
+ */
+seal::compr_mode_type parse_compr_mode(const std::string& name) {
+    if (name == "none") {
+        return seal::compr_mode_type::none;
+    }
+    if (name == "bitpack") {
+        return seal::compr_mode_type::bitpack;
+    }
+#ifdef SEAL_USE_ZLIB
+    if (name == "zlib") {
+        return seal::compr_mode_type::zlib;
+    }
+#endif
+#ifdef SEAL_USE_ZSTD
+    if (name == "zstd") {
+        return seal::compr_mode_type::zstd;
+    }
+#endif
+    if (name == "zlib" || name == "zstd") {
+        throw std::invalid_argument("Compression mode not available in this build: " + name);
+    }
+    throw std::invalid_argument("Unknown compression mode: " + name);
+}
+
+/**
+ * API name of a SEAL compression mode (inverse of parse_compr_mode)
+ */
+const char* compr_mode_name(seal::compr_mode_type mode) {
+    switch (mode) {
+#ifdef SEAL_USE_ZLIB
+        case seal::compr_mode_type::zlib: return "zlib";
+#endif
+#ifdef SEAL_USE_ZSTD
+        case seal::compr_mode_type::zstd: return "zstd";
+#endif
+        case seal::compr_mode_type::bitpack: return "bitpack";
+        default: return "none";
+    }
+}
+
+/**
+ * Map an API scheme name to the SEAL scheme
+ * 
+ * @throws std::invalid_argument for other names
+ */
+seal::scheme_type parse_scheme(const std::string& name) {
+    if (name == "bfv") return seal::scheme_type::bfv;
+    if (name == "ckks") return seal::scheme_type::ckks;
+    if (name == "bgv") return seal::scheme_type::bgv;
+    throw std::invalid_argument("Unknown scheme: " + name + " (bfv, ckks, bgv)");
+}
+
+/**
+ * Short, stable identity of serialized key bytes (BLAKE2b-128, 32 hex digits)
+ * Unkeyed: it identifies keys, it does not authenticate them
+ */
+std::string key_fingerprint(std::string_view bytes) {
+    uint8_t digest[16];
+    if (blake2b(digest, sizeof(digest), bytes.data(), bytes.size(), nullptr, 0) != 0) {
+        throw std::runtime_error("BLAKE2b failed");
+    }
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(2 * sizeof(digest));
+    for (uint8_t byte : digest) {
+        out += hex[byte >> 4];
+        out += hex[byte & 0xf];
+    }
+    return out;
+}
+
+/**
+ * Map a --huge-pages value to the SEAL memory pool mode
+ * 
+ * @param name "off", "thp" (transparent huge pages), "2mb" or "1gb" (hugetlbfs pages)
+ * @throws std::invalid_argument for unknown names
+ */
+seal::util::huge_page_mode parse_huge_page_mode(const std::string& name) {
+    if (name == "off") return seal::util::huge_page_mode::none;
+    if (name == "thp") return seal::util::huge_page_mode::transparent;
+    if (name == "2mb") return seal::util::huge_page_mode::hugetlb_2mb;
+    if (name == "1gb") return seal::util::huge_page_mode::hugetlb_1gb;
+    throw std::invalid_argument("Unknown huge page mode: " + name);
+}
+
+/**
+ * --huge-pages name of a SEAL memory pool mode (inverse of parse_huge_page_mode)
+ */
+const char* huge_page_mode_name(seal::util::huge_page_mode mode) {
+    switch (mode) {
+        case seal::util::huge_page_mode::transparent: return "thp";
+        case seal::util::huge_page_mode::hugetlb_2mb: return "2mb";
+        case seal::util::huge_page_mode::hugetlb_1gb: return "1gb";
+        default: return "off";
+    }
+}
+
+/**
+ * Map a --prng value to a SEAL PRNG type
+ *
+ * @param name "blake2xb", "shake256" or "aes128ctr"
+ * @throws std::invalid_argument for unknown names
+ */
+seal::prng_type parse_prng(const std::string& name) {
+    if (name == "blake2xb") return seal::prng_type::blake2xb;
+    if (name == "shake256") return seal::prng_type::shake256;
+    if (name == "aes128ctr") return seal::prng_type::aes128ctr;
+    throw std::invalid_argument("Unknown PRNG: " + name + " (blake2xb, shake256, aes128ctr)");
+}
+
+/**
+ * --prng name of a SEAL PRNG type (inverse of parse_prng)
+ */
+const char* prng_name(seal::prng_type type) {
+    switch (type) {
+        case seal::prng_type::shake256: return "shake256";
+        case seal::prng_type::aes128ctr: return "aes128ctr";
+        default: return "blake2xb";
     }
 }
 
+/**
+ * The default factory draws the uniform polynomials of every encryption and
+ * key switching key, and seeded ciphertexts and keys record its type, so
+ * whoever loads them must know it. Set it before the first SEALContext is
+ * created: contexts keep the factory of their time for noise sampling
+ * 
+ * @throws std::invalid_argument for aes128ctr on a CPU without AES-NI, where
+ *         SEAL's portable AES indexes tables by the secret seed (not constant
+ *         time). Loading seeded data made with it still works there
+ */
+void set_default_prng(seal::prng_type type) {
+    if (type == seal::prng_type::aes128ctr && !seal::util::use_aes_ni()) {
+        throw std::invalid_argument("--prng=aes128ctr needs AES-NI, which this CPU lacks; use blake2xb");
+    }
+    std::shared_ptr<seal::UniformRandomGeneratorFactory> factory;
+    switch (type) {
+        case seal::prng_type::shake256: factory = std::make_shared<seal::Shake256PRNGFactory>(); break;
+        case seal::prng_type::aes128ctr: factory = std::make_shared<seal::AES128CTRPRNGFactory>(); break;
+        default: factory = std::make_shared<seal::Blake2xbPRNGFactory>(); break;
+    }
+    seal::UniformRandomGeneratorFactory::SetDefaultFactory(std::move(factory));
+}
+
 /**
  * Constructor for HomomorphicEncryption wrapper class
  * 
  * @param use_ckks If true, uses CKKS scheme (floating-point), otherwise BFV (integers)
  * @param should_generate_keys If true, generates new key pair automatically
+ * @param profile Polynomial degree, prime chain, BFV plain modulus and CKKS scale
+ */
+HomomorphicEncryption::HomomorphicEncryption(bool use_ckks, bool should_generate_keys,
+                                             const ParameterProfile& profile)
+    : HomomorphicEncryption(use_ckks ? seal::scheme_type::ckks : seal::scheme_type::bfv, should_generate_keys,
+                            profile) {}
+
+/**
+ * Constructor for any of the three schemes
+ * 
+ * @param scheme bfv, ckks or bgv
+ * @param should_generate_keys If true, generates new key pair automatically
+ * @param profile Polynomial degree, prime chain, plain modulus (BFV, BGV) and CKKS scale
+ * @throws std::invalid_argument for another scheme or parameters SEAL rejects
  * 
  * CKKS: Supports approximate arithmetic on encrypted floating-point numbers
  * BFV: Supports exact arithmetic on encrypted integers with batching
+ * BGV: The same integer slots as BFV, with ciphertexts that shrink down the chain
  */
-HomomorphicEncryption::HomomorphicEncryption(bool use_ckks, bool should_generate_keys) 
-    : use_ckks(use_ckks), scale(pow(2.0, 40)) {  // Scale factor for CKKS precision
+HomomorphicEncryption::HomomorphicEncryption(seal::scheme_type scheme, bool should_generate_keys,
+                                             const ParameterProfile& profile)
+    : use_ckks(scheme == seal::scheme_type::ckks), use_bgv(scheme == seal::scheme_type::bgv), profile(profile),
+      scale(pow(2.0, profile.scale_bits)) {  // Scale factor for CKKS precision
     
     // Initialize encryption parameters based on chosen scheme
     if (use_ckks) {
         init_ckks();
-    } else {
+    } else if (use_bgv) {
+        init_bgv();
+    } else if (scheme == seal::scheme_type::bfv) {
         init_bfv();
+    } else {
+        throw std::invalid_argument("Unsupported scheme");
     }
 
     // Create SEAL context and evaluator for homomorphic operations
-    context = std::make_shared<seal::SEALContext>(parms);
-    evaluator = std::make_unique<seal::Evaluator>(*context);
+    context = std::make_shared<seal::SEALContext>(parms, true, profile.security);
+    if (!context->parameters_set()) {
+        throw std::invalid_argument("Invalid parameter profile " + profile.name + ": " +
+                                    context->parameter_error_message());
+    }
+    evaluator = std::make_shared<seal::Evaluator>(*context);
+    fresh_parms = context->first_parms_id();
+    if (use_bgv) {
+        // The chain levels above the profile's depth are headroom no product will spend
+        size_t top = context->first_context_data()->chain_index();
+        fresh_parms = level_at(*context, std::min(profile.depth, top))->parms_id();
+    }
+
+    // Initialize the appropriate encoder based on the scheme
+    if (use_ckks) {
+        // CKKS encoder for floating-point numbers
+        ckks_encoder = std::make_shared<seal::CKKSEncoder>(*context);
+    } else {
+        // Batch encoder for integer vectors (BFV and BGV)
+        bfv_encoder = std::make_shared<seal::BatchEncoder>(*context);
+    }
 
     // Generate keys if requested (typically for testing/demo purposes)
     if (should_generate_keys) {
@@ -107,22 +489,92 @@ HomomorphicEncryption::HomomorphicEncryption(bool use_ckks, bool should_generate
     }
 }
 
+/**
+ * Constructor from computation requirements: the smallest parameters that
+ * support their depth, precision and security level
+ * 
+ * @throws std::invalid_argument if no supported parameters meet them
+ */
+HomomorphicEncryption::HomomorphicEncryption(const ParameterRequirements& requirements, bool should_generate_keys)
+    : HomomorphicEncryption(requirements.use_ckks, should_generate_keys, profiles::select(requirements)) {}
+
+/**
+ * Engine over base's parameters for another key set (see share_parameters)
+ */
+HomomorphicEncryption::HomomorphicEncryption(const HomomorphicEncryption& base, SharedParameters)
+    : use_ckks(base.use_ckks), use_bgv(base.use_bgv), profile(base.profile), parms(base.parms),
+      context(base.context), evaluator(base.evaluator), ckks_encoder(base.ckks_encoder),
+      bfv_encoder(base.bfv_encoder), fresh_parms(base.fresh_parms), scale(base.scale),
+      thread_pool(base.thread_pool), min_parallel_operands(base.min_parallel_operands),
+      thread_local_pools(base.thread_local_pools), scratch_arena_bytes(base.scratch_arena_bytes),
+      compact_keys(base.compact_keys), rotation_operations(base.rotation_operations), plaintexts(base.plaintexts) {}
+
+/**
+ * An engine without keys over the same parameters; give it keys with
+ * load_keys or generate_keys
+ * 
+ * Everything but the keys is shared with this engine: the SEALContext with
+ * its NTT and base-conversion tables, the evaluator and encoders (none of
+ * them hold key material) and the plaintext cache, whose entries depend only
+ * on the parameters. Configuration is copied as set at the time of the call.
+ */
+std::unique_ptr<HomomorphicEncryption> HomomorphicEncryption::share_parameters() const {
+    return std::unique_ptr<HomomorphicEncryption>(new HomomorphicEncryption(*this, SharedParameters{}));
+}
+
+/**
+ * Memory held by the current keys, for budgeting caches of engines
+ * Galois keys dominate: one key switching key per rotation step (less when
+ * compact, see set_compact_keys)
+ */
+size_t HomomorphicEncryption::key_bytes() const {
+    auto keys = this->keys();
+    const auto none = seal::compr_mode_type::none;
+    size_t bytes = 0;
+    if (keys->public_key.data().size() > 0) bytes += static_cast<size_t>(keys->public_key.save_size(none));
+    if (keys->secret_key.data().coeff_count() > 0) bytes += static_cast<size_t>(keys->secret_key.save_size(none));
+    bytes += keys->relin_keys.data_bytes();
+    bytes += keys->galois_keys.data_bytes();
+    if (keys->seeded_relin_keys) bytes += keys->seeded_relin_keys->size();
+    if (keys->seeded_galois_keys) bytes += keys->seeded_galois_keys->size();
+    return bytes;
+}
+
 /**
  * Initialize BFV (Brakerski-Fan-Vercauteren) encryption parameters
  * BFV is designed for exact integer arithmetic with SIMD batching capabilities
  */
 void HomomorphicEncryption::init_bfv() {
     parms = seal::EncryptionParameters(seal::scheme_type::bfv);
-    size_t poly_modulus_degree = 8192;  // Polynomial degree (affects security and performance)
+    size_t poly_modulus_degree = profile.poly_modulus_degree;  // Polynomial degree (affects security and performance)
     parms.set_poly_modulus_degree(poly_modulus_degree);
 
     // Coefficient modulus chain for modulus switching (enables more operations)
     // Format: {first_prime, intermediate_primes..., last_prime}
-    parms.set_coeff_modulus(seal::CoeffModulus::Create(
-        poly_modulus_degree, {50, 30, 30, 50}));
+    parms.set_coeff_modulus(seal::CoeffModulus::Create(poly_modulus_degree, profile.coeff_modulus_bits));
+    parms.set_special_modulus_size(profile.special_primes);
 
     // Plaintext modulus - enables batching of multiple integers in one ciphertext
-    parms.set_plain_modulus(seal::PlainModulus::Batching(poly_modulus_degree, 20));
+    parms.set_plain_modulus(profile_plain_modulus(profile));
+}
+
+/**
+ * Initialize BGV (Brakerski-Gentry-Vaikuntanathan) encryption parameters
+ * The same chain and batching plain modulus as BFV. BGV keeps the noise
+ * relative to the modulus when switching down the chain, so levels the
+ * profile's depth does not need are dropped up front: public-key
+ * encryptions start profile.depth levels above the last (one limb less
+ * than BFV with the default profile), and every settled product
+ * (rescale_inplace) switches down one more. Seeded symmetric encryptions
+ * start at the top, as SEAL only seeds those.
+ */
+void HomomorphicEncryption::init_bgv() {
+    parms = seal::EncryptionParameters(seal::scheme_type::bgv);
+    size_t poly_modulus_degree = profile.poly_modulus_degree;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(seal::CoeffModulus::Create(poly_modulus_degree, profile.coeff_modulus_bits));
+    parms.set_special_modulus_size(profile.special_primes);
+    parms.set_plain_modulus(profile_plain_modulus(profile));
 }
 
 /**
@@ -131,63 +583,204 @@ void HomomorphicEncryption::init_bfv() {
  */
 void HomomorphicEncryption::init_ckks() {
     parms = seal::EncryptionParameters(seal::scheme_type::ckks);
-    size_t poly_modulus_degree = 8192;  // Must be power of 2
+    size_t poly_modulus_degree = profile.poly_modulus_degree;  // Must be power of 2
     parms.set_poly_modulus_degree(poly_modulus_degree);
 
     // Coefficient modulus for CKKS - more levels allow more operations
     // Each level corresponds to a prime in the modulus chain
-    parms.set_coeff_modulus(seal::CoeffModulus::Create(
-        poly_modulus_degree, {50, 30, 30, 50}));
+    parms.set_coeff_modulus(seal::CoeffModulus::Create(poly_modulus_degree, profile.coeff_modulus_bits));
+    parms.set_special_modulus_size(profile.special_primes);
     // Note: CKKS doesn't use plain_modulus
 }
 
 
 /**
  * Generate cryptographic keys and initialize encryption/decryption components
- * This includes public key, secret key, and relinearization keys
- * Also measures and reports key generation performance metrics
+ * This includes public key, secret key, relinearization keys and the
+ * Galois keys for the rotations of set_rotation_operations (by default the
+ * power-of-two steps of sum_slots plus the profile's baby steps)
+ * Also reports the key generation time and parameters
  */
 void HomomorphicEncryption::generate_keys() {
+    HE_PROBE_METHOD("generate_keys", 0, 0);
     auto start = std::chrono::high_resolution_clock::now();
 
     // Generate the key pair and auxiliary keys
     seal::KeyGenerator keygen(*context);
-    secret_key = keygen.secret_key();           // Private key for decryption
-    keygen.create_public_key(public_key);       // Public key for encryption
-    keygen.create_relin_keys(relin_keys);       // Relinearization keys for multiplication
-
-    // Initialize encryptor and decryptor with the generated keys
-    encryptor = std::make_unique<seal::Encryptor>(*context, public_key);
-    decryptor = std::make_unique<seal::Decryptor>(*context, secret_key);
-    
-    // Initialize the appropriate encoder based on the scheme
-    if (use_ckks) {
-        // CKKS encoder for floating-point numbers
-        ckks_encoder = std::make_unique<seal::CKKSEncoder>(*context);
-    } else {
-        // BFV batch encoder for integer vectors
-        bfv_encoder = std::make_unique<seal::BatchEncoder>(*context);
+    auto keys = std::make_unique<KeySet>();
+    keys->secret_key = keygen.secret_key();             // Private key for decryption
+    keygen.create_public_key(keys->public_key);         // Public key for encryption
+    // Relinearization keys for multiplication and Galois keys for only the rotations used, made in
+    // seeded form for serialize_evaluation_keys and expanded here for our own use
+    auto seeded = std::make_shared<std::string>();
+    save_bytes(keygen.create_relin_keys(), *seeded);
+    load_bytes(keys->relin_keys, *context, seeded->data(), seeded->size());
+    keys->seeded_relin_keys = std::move(seeded);
+    std::vector<int> steps = rotation_steps(rotation_operations);
+    if (!steps.empty()) {
+        seeded = std::make_shared<std::string>();
+        save_bytes(keygen.create_galois_keys(steps), *seeded);
+        load_bytes(keys->galois_keys, *context, seeded->data(), seeded->size());
+        keys->seeded_galois_keys = std::move(seeded);
+    }
+    {
+        std::lock_guard<std::mutex> lock(key_update_mutex);
+        publish(std::move(keys));
     }
 
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
 
-    // Calculate public key size by serializing it
-    std::stringstream ss;
-    public_key.save(ss);
-    std::string pubkey_str = ss.str();
-    size_t pubkey_size_bytes = pubkey_str.size();
-
-    // Print performance and parameter information
-    std::cout << "Key generation time: " << duration << " microseconds" << std::endl;
-    std::cout << "Poly modulus degree: " << parms.poly_modulus_degree() << std::endl;
-    std::cout << "Modulus Coefficients: [ ";
+    // One line, so the schemes' key generations running side by side at startup
+    // do not interleave; key sizes are what GET /public_key and /binary/evaluation_keys return
+    std::ostringstream report;
+    report << "Key generation time: " << duration << " microseconds | Profile: " << profile.name << " ("
+           << scheme_name() << ") | Poly modulus degree: " << parms.poly_modulus_degree()
+           << " | Modulus Coefficients: [ ";
     for (const auto& mod : parms.coeff_modulus()) {
-        std::cout << mod.value() << " ";
+        report << mod.value() << " ";
+    }
+    report << "]\n";
+    std::cout << report.str() << std::flush;
+}
+
+/**
+ * Create the encryptor and decryptor for a key set and make it the current one
+ * The secret key, when present, is also given to the encryptor so seeded
+ * symmetric uploads work. The Galois permutation tables of its rotation keys
+ * are built here rather than by the first rotations. Callers hold
+ * key_update_mutex, so an update built from the current set (copy_keys) is
+ * not lost to a concurrent one. A new public key is fingerprinted here, once
+ * 
+ * @param keys New key set; operations already running keep the previous one
+ */
+void HomomorphicEncryption::publish(std::unique_ptr<KeySet> keys) const {
+    if (keys->public_key_fingerprint.empty() && keys->public_key.data().size() > 0) {
+        std::string bytes;
+        save_bytes(keys->public_key, bytes, seal::compr_mode_type::none);
+        keys->public_key_fingerprint = key_fingerprint(bytes);
+    }
+    if (compact_keys) {
+        keys->relin_keys.compact(*context);
+        keys->galois_keys.compact(*context);
+    }
+    bool has_secret_key = keys->secret_key.data().coeff_count() > 0;
+    if (has_secret_key) {
+        keys->encryptor = std::make_unique<seal::Encryptor>(*context, keys->public_key, keys->secret_key);
+        keys->decryptor = std::make_unique<seal::Decryptor>(*context, keys->secret_key);
+    } else if (keys->public_key.data().size() > 0) {
+        keys->encryptor = std::make_unique<seal::Encryptor>(*context, keys->public_key);
+    }
+    // Rotations with these keys then only look up their permutation tables
+    std::vector<uint32_t> galois_elements;
+    for (size_t index = 0; index < keys->galois_keys.data().size(); index++) {
+        if (!keys->galois_keys.data()[index].empty()) galois_elements.push_back(galois_element(index));
+    }
+    context->key_context_data()->galois_tool()->precompute_tables_ntt(galois_elements);
+    std::shared_ptr<const KeySet> published(std::move(keys));
+    std::atomic_store(&key_set, std::move(published));
+}
+
+/**
+ * Copy of the current key set, without the objects bound to it, for an update
+ */
+std::unique_ptr<HomomorphicEncryption::KeySet> HomomorphicEncryption::copy_keys() const {
+    auto current = this->keys();
+    auto keys = std::make_unique<KeySet>();
+    keys->public_key = current->public_key;
+    keys->secret_key = current->secret_key;
+    keys->relin_keys = current->relin_keys;
+    keys->galois_keys = current->galois_keys;
+    keys->galois_store = current->galois_store;
+    keys->galois_absent = current->galois_absent;
+    keys->public_key_fingerprint = current->public_key_fingerprint;
+    keys->public_key_source = current->public_key_source;
+    keys->seeded_relin_keys = current->seeded_relin_keys;
+    keys->seeded_galois_keys = current->seeded_galois_keys;
+    keys->relin_pending = current->relin_pending;
+    keys->galois_pending = current->galois_pending;
+    return keys;
+}
+
+/**
+ * Load a key set from the key store instead of generating one
+ * 
+ * @param store Key store shared between the backends
+ * @param include_secret_key If false the secret key is never read (evaluation-only servers)
+ * @param lazy_galois_keys If true no Galois key is read now: each one is read from the
+ *                         store (see save_keys) the first time a rotation needs it, so an
+ *                         engine holds the keys of the rotations it actually serves
+ * @return true if the public key (and, if requested, the secret key) was found;
+ *         relinearization and Galois keys are loaded when present. With the
+ *         secret key, their files are also kept for serialize_evaluation_keys
+ */
+bool HomomorphicEncryption::load_keys(const KeyStore& store, bool include_secret_key, bool lazy_galois_keys) {
+    HE_PROBE_METHOD("load_keys", 0, 0);
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    auto keys = std::make_unique<KeySet>();
+    if (!store.load(*context, "public_key", keys->public_key)) return false;
+    if (include_secret_key && !store.load(*context, "secret_key", keys->secret_key)) return false;
+    auto load_evaluation_key = [&](const char* kind, auto& key, std::shared_ptr<const std::string>& seeded) {
+        if (!include_secret_key) {
+            store.load(*context, kind, key);
+            return;
+        }
+        std::string bytes;
+        if (store.load(*context, kind, key, bytes)) seeded = std::make_shared<const std::string>(std::move(bytes));
+    };
+    load_evaluation_key("relin_keys", keys->relin_keys, keys->seeded_relin_keys);
+    if (lazy_galois_keys) {
+        keys->galois_store = std::make_shared<const KeyStore>(store);
+    } else {
+        load_evaluation_key("galois_keys", keys->galois_keys, keys->seeded_galois_keys);
     }
-    std::cout << "]" << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(key_update_mutex);
+        publish(std::move(keys));
+    }
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    std::cout << "Key load time: " << duration << " microseconds (" << store.directory() << ")" << std::endl;
+    return true;
+}
 
-    std::cout << "Key size: " << pubkey_size_bytes << " bytes" << std::endl;
+/**
+ * Save every key held by this instance to the key store
+ * Galois keys are saved twice: as one file for eager loading and one file
+ * per Galois element ("galois_<elt>") for lazy_galois_keys. Relinearization
+ * keys and the whole set of Galois keys are saved in seeded form when
+ * generate_keys made them, at about half the size
+ * 
+ * @param store Key store shared between the backends
+ */
+void HomomorphicEncryption::save_keys(const KeyStore& store) const {
+    HE_PROBE_METHOD("save_keys", 0, 0);
+    expanded_keys(false);
+    auto keys = expanded_keys(true);
+    store.save(*context, "public_key", keys->public_key);
+    if (keys->secret_key.data().coeff_count() > 0) store.save(*context, "secret_key", keys->secret_key);
+    if (keys->seeded_relin_keys) {
+        store.save_serialized(*context, "relin_keys", *keys->seeded_relin_keys);
+    } else if (keys->relin_keys.size() > 0) {
+        store.save(*context, "relin_keys", keys->relin_keys);
+    }
+    if (keys->galois_keys.size() == 0) return;
+    if (keys->seeded_galois_keys) {
+        store.save_serialized(*context, "galois_keys", *keys->seeded_galois_keys);
+    } else {
+        store.save(*context, "galois_keys", keys->galois_keys);
+    }
+    const auto& all = keys->galois_keys.data();
+    for (size_t index = 0; index < all.size(); index++) {
+        if (all[index].empty()) continue;
+        seal::GaloisKeys element;
+        element.data().resize(all.size());
+        element.data()[index] = keys->galois_keys.expanded_key(index);
+        element.parms_id() = keys->galois_keys.parms_id();
+        store.save(*context, galois_element_kind(galois_element(index)).c_str(), element);
+    }
 }
 
 // Destructor - uses default implementation (smart pointers handle cleanup)
@@ -197,163 +790,3821 @@ HomomorphicEncryption::~HomomorphicEncryption() = default;
  * Encrypt a single numeric value using the configured encryption scheme
  * 
  * @param value The numeric value to encrypt (double for both schemes)
- * @return Base64-encoded serialized ciphertext
+ * @param wire Wire encoding and compression of the returned ciphertext
+ * @return Serialized ciphertext (Base64 or raw bytes)
  * 
  * For CKKS: Directly encodes the floating-point value with specified scale
  * For BFV: Rounds to integer and places in first slot of batch encoding
  */
-std::string HomomorphicEncryption::encrypt(double value) const {
-    if (!encryptor) throw std::runtime_error("Encryptor not initialized");
+std::string HomomorphicEncryption::encrypt(double value, const WireOptions& wire) const {
+    HE_PROBE_METHOD("encrypt", 1, 0);
+    if (!keys()->encryptor) throw std::runtime_error("Encryptor not initialized");
+    
+    seal::Plaintext plain;
+    encode_value(value, plain);
+    
+    std::string out;
+    encrypt_plain(plain, false, out, wire);  // Serialize to Base64 string (or raw bytes) for transport
+    return out;
+}
+
+/**
+ * Encrypt a single numeric value with the secret key in seeded form
+ * 
+ * @param value The numeric value to encrypt
+ * @param wire Wire encoding and compression of the returned ciphertext
+ * @return Serialized seeded ciphertext, about half the size of encrypt()'s output
+ * 
+ * Only available where the secret key is present (mini-backend). The receiver
+ * regenerates the second polynomial from the seed when loading, so the result
+ * is accepted anywhere a regular ciphertext is.
+ */
+std::string HomomorphicEncryption::encrypt_symmetric(double value, const WireOptions& wire) const {
+    HE_PROBE_METHOD("encrypt_symmetric", 1, 0);
+    if (!keys()->encryptor) throw std::runtime_error("Encryptor not initialized");
     
     seal::Plaintext plain;
-    seal::Ciphertext encrypted;
+    encode_value(value, plain);
     
+    std::string out;
+    encrypt_plain(plain, true, out, wire);
+    return out;
+}
+
+/**
+ * Encode a single value into the first slot of a plaintext
+ * 
+ * For CKKS: Directly encodes the floating-point value with specified scale
+ * For BFV: Rounds to integer and places in first slot of batch encoding
+ */
+void HomomorphicEncryption::encode_value(double value, seal::Plaintext& plain) const {
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "encode"));
     if (use_ckks) {
         // CKKS: Encode floating-point value with scaling factor
-        ckks_encoder->encode(value, scale, plain);
-        encryptor->encrypt(plain, encrypted);
+        ckks_encoder->encode(value, scale, plain, scratch_pool());
     } else {
         // BFV: Batch encode with value in first slot
         size_t slot_count = bfv_encoder->slot_count();
         std::vector<uint64_t> values(slot_count, 0);  // Initialize all slots to 0
         values[0] = static_cast<uint64_t>(std::round(value));  // Place value in first slot
         bfv_encoder->encode(values, plain);
-        encryptor->encrypt(plain, encrypted);
     }
-    
-    return serialize(encrypted);  // Convert to Base64 string for transport
+}
+
+/**
+ * Plaintext for values, from the plaintext cache or encoded into it
+ * 
+ * CKKS: values[0] in every slot (broadcast) or values slot-wise, at the given
+ * scale and level. BFV: integer values slot-wise, in NTT form at parms_id, or
+ * as plain coefficients for multiply_plain when parms_id is parms_id_zero
+ * (scale is ignored).
+ */
+std::shared_ptr<const seal::Plaintext> HomomorphicEncryption::encoded(const std::vector<double>& values,
+                                                                      bool broadcast, double scale,
+                                                                      const seal::parms_id_type& parms_id) const {
+    return plaintexts->get(values, broadcast, scale, parms_id, [&](seal::Plaintext& plain) {
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "encode"));
+        if (use_ckks) {
+            if (broadcast) {
+                ckks_encoder->encode(values[0], parms_id, scale, plain, scratch_pool());
+            } else {
+                ckks_encoder->encode(values, parms_id, scale, plain, scratch_pool());
+            }
+            return;
+        }
+        std::vector<int64_t> slots;
+        slots.reserve(values.size());
+        for (double value : values) slots.push_back(static_cast<int64_t>(value));
+        bfv_encoder->encode(slots, plain);
+        if (parms_id != seal::parms_id_zero) evaluator->transform_to_ntt_inplace(plain, parms_id, scratch_pool());
+    });
+}
+
+/**
+ * Encrypt a plaintext and append its wire representation to out
+ * 
+ * @param plain Encoded plaintext
+ * @param symmetric If true, encrypt with the secret key and save the seeded form
+ * @param out Buffer the serialized ciphertext is appended to
+ * @param wire Wire encoding and compression to produce
+ */
+void HomomorphicEncryption::encrypt_plain(const seal::Plaintext& plain, bool symmetric,
+                                          std::string& out, const WireOptions& wire) const {
+    auto keys = this->keys();
+    if (!keys->encryptor) throw std::runtime_error("Encryptor not initialized");
+    if (symmetric) {
+        auto encrypted = [&] {
+            metrics::ScopedTimer timer(metrics::stage(scheme_name(), "encrypt"));
+            return keys->encryptor->encrypt_symmetric(plain, scratch_pool());
+        }();
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "serialize"));
+        save_wire(encrypted, out, wire, scheme_name());
+        if (wire.stats) wire.stats->add_ciphertext(context->first_context_data()->chain_index(), 2);
+        return;
+    }
+    seal::Ciphertext encrypted(scratch_pool());  // Serialized and gone before returning
+    {
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "encrypt"));
+        if (zero_pool && zero_pool->take(keys.get(), encrypted)) {
+            // What Encryptor::encrypt does after its own encrypt_zero
+            if (use_ckks) encrypted.scale() = plain.scale();
+            evaluator->add_plain_inplace(encrypted, plain, scratch_pool());
+        } else if (use_bgv) {
+            // Encryptor::encrypt would start at the top of the chain
+            keys->encryptor->encrypt_zero(fresh_parms, encrypted, scratch_pool());
+            evaluator->add_plain_inplace(encrypted, plain, scratch_pool());
+        } else {
+            keys->encryptor->encrypt(plain, encrypted, scratch_pool());
+        }
+    }
+    serialize_into(encrypted, out, wire);
 }
 
 /**
  * Decrypt a ciphertext back to its original numeric value
  * 
- * @param encrypted_data Base64-encoded serialized ciphertext
+ * @param encrypted_data Serialized ciphertext
+ * @param format Wire encoding of encrypted_data
+ * @param info If set, receives the ciphertext's level, size, scale and noise budget
  * @return The decrypted numeric value as double
  * 
  * For CKKS: Returns the first element of the decoded vector (approximate)
  * For BFV: Returns the first slot value converted to double (exact)
  */
-double HomomorphicEncryption::decrypt(const std::string& encrypted_data) const {
-    if (!decryptor) throw std::runtime_error("Decryptor not initialized");
+double HomomorphicEncryption::decrypt(std::string_view encrypted_data, WireFormat format,
+                                      CiphertextInfo* info) const {
+    HE_PROBE_METHOD("decrypt", 1, encrypted_data.size());
+    if (!keys()->decryptor) throw std::runtime_error("Decryptor not initialized");
     
-    // Deserialize the ciphertext from Base64 string
-    seal::Ciphertext encrypted = deserialize(encrypted_data);
-    seal::Plaintext plain;
-    decryptor->decrypt(encrypted, plain);
+    // Deserialize the ciphertext from Base64 string (or raw bytes)
+    return decrypt(deserialize(encrypted_data, format), info);
+}
+
+/**
+ * Decrypt a ciphertext held in memory (e.g. the result of an in-process reduction)
+ * 
+ * @param encrypted Ciphertext
+ * @param info If set, receives the ciphertext's level, size, scale and noise budget
+ * @return The value of its first slot, as decrypt() of the serialized ciphertext
+ */
+double HomomorphicEncryption::decrypt(const seal::Ciphertext& encrypted, CiphertextInfo* info) const {
+    auto keys = this->keys();
+    if (!keys->decryptor) throw std::runtime_error("Decryptor not initialized");
+    if (info) *info = inspect(encrypted);
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "decrypt"));
+    seal::Plaintext plain(scratch_pool());
+    keys->decryptor->decrypt(encrypted, plain);
     
+    // Only slot 0 is decoded: one inner product instead of the full FFT (NTT for BFV and BGV)
     if (use_ckks) {
-        // CKKS: Decode to vector of doubles and return first element
         std::vector<double> result;
-        ckks_encoder->decode(plain, result);
+        ckks_encoder->decode_slots(plain, {0}, result, scratch_pool());
         return result[0];
     } else {
-        // BFV: Decode to vector of integers and return first element as double
         std::vector<uint64_t> result;
-        bfv_encoder->decode(plain, result);
+        bfv_encoder->decode_slots(plain, {0}, result);
         return static_cast<double>(result[0]);
     }
 }
 
 /**
- * Perform homomorphic addition of two encrypted values
- * Addition is performed directly on the ciphertexts without decryption
- * 
- * @param encrypted_a Base64-encoded first operand
- * @param encrypted_b Base64-encoded second operand
- * @return Base64-encoded result of encrypted addition
- * 
- * This operation works for both BFV and CKKS schemes
- * The result remains encrypted and can be used in further operations
+ * Decrypt chosen slots of a serialized ciphertext (see the in-memory overload)
  */
-std::string HomomorphicEncryption::add(const std::string& encrypted_a, 
-                                      const std::string& encrypted_b) const {
-    // Deserialize both operands from Base64 strings
-    seal::Ciphertext a = deserialize(encrypted_a);
-    seal::Ciphertext b = deserialize(encrypted_b);
-    seal::Ciphertext result;
-    
-    // Perform homomorphic addition: result = a + b (encrypted)
-    evaluator->add(a, b, result);
-    return serialize(result);  // Serialize result back to Base64
+std::vector<double> HomomorphicEncryption::decrypt_slots(std::string_view encrypted_data,
+                                                         const std::vector<size_t>& slots, WireFormat format) const {
+    HE_PROBE_METHOD("decrypt", 1, encrypted_data.size());
+    if (!keys()->decryptor) throw std::runtime_error("Decryptor not initialized");
+    return decrypt_slots(deserialize(encrypted_data, format), slots);
 }
 
 /**
- * Serialize a SEAL ciphertext to Base64 string for network transmission
+ * Decrypt chosen slots of a ciphertext, e.g. the totals a group-by or
+ * feature_sums left in known slots, without decoding the rest
  * 
- * @param ct The ciphertext to serialize
- * @return Base64-encoded string representation
+ * Each slot costs one inner product of the plaintext's N coefficients; the
+ * full decode is an O(N log N) transform, so above log2(N) slots that is used
+ * instead.
+ * 
+ * @param slots Slot indices, each below slot_count()
+ * @return The slots' values in the order given; BFV and BGV ones signed
+ * @throws std::invalid_argument for a slot index out of range
  */
-std::string HomomorphicEncryption::serialize(const seal::Ciphertext& ct) const {
-    std::stringstream ss;
-    ct.save(ss);                    // Save ciphertext to string stream
-    return to_base64(ss.str());     // Encode binary data as Base64
+std::vector<double> HomomorphicEncryption::decrypt_slots(const seal::Ciphertext& encrypted,
+                                                         const std::vector<size_t>& slots) const {
+    auto keys = this->keys();
+    if (!keys->decryptor) throw std::runtime_error("Decryptor not initialized");
+    for (size_t slot : slots) {
+        if (slot >= slot_count()) {
+            throw std::invalid_argument("Slot " + std::to_string(slot) + " is out of range (" +
+                                        std::to_string(slot_count()) + " slots)");
+        }
+    }
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "decrypt"));
+    seal::Plaintext plain(scratch_pool());
+    keys->decryptor->decrypt(encrypted, plain);
+
+    const size_t degree = context->key_context_data()->parms().poly_modulus_degree();
+    const bool sparse = slots.size() <= ceil_log2(degree);
+    std::vector<double> values(slots.size());
+    if (use_ckks) {
+        std::vector<double> decoded;
+        if (sparse) {
+            ckks_encoder->decode_slots(plain, slots, decoded, scratch_pool());
+            return decoded;
+        }
+        ckks_encoder->decode(plain, decoded, scratch_pool());
+        for (size_t i = 0; i < slots.size(); i++) values[i] = decoded[slots[i]];
+        return values;
+    }
+    std::vector<int64_t> decoded;
+    if (sparse) {
+        bfv_encoder->decode_slots(plain, slots, decoded);
+        std::copy(decoded.begin(), decoded.end(), values.begin());
+        return values;
+    }
+    bfv_encoder->decode(plain, decoded, scratch_pool());
+    for (size_t i = 0; i < slots.size(); i++) values[i] = static_cast<double>(decoded[slots[i]]);
+    return values;
 }
 
 /**
- * Deserialize a Base64 string back to SEAL ciphertext
+ * Mask for a client-assisted refresh, encoded for the ciphertext's level and scale
  * 
- * @param str Base64-encoded ciphertext string
- * @return Reconstructed SEAL ciphertext object
+ * Slot values come from a Blake2xb stream keyed by seed and index, so the same
+ * mask is generated again to remove it. BFV and BGV masks are uniform modulo
+ * the plain modulus (a 64-bit draw reduced, bias below 2^-40), which hides
+ * the values completely; CKKS masks are uniform in [-bound, bound], which
+ * hides values well below bound. Never cached: a mask is used twice at most.
  */
-seal::Ciphertext HomomorphicEncryption::deserialize(const std::string& str) const {
-    std::string data = from_base64(str);    // Decode Base64 to binary
-    std::stringstream ss(data);
-    seal::Ciphertext ct;
-    ct.load(*context, ss);                  // Load ciphertext from stream
-    return ct;
+seal::Plaintext HomomorphicEncryption::refresh_mask(const seal::Ciphertext& encrypted,
+                                                    const seal::prng_seed_type& seed, size_t index,
+                                                    double bound) const {
+    seal::prng_seed_type stream = seed;
+    stream[0] ^= index;
+    seal::Blake2xbPRNG prng(stream);
+    std::vector<uint64_t> draws(slot_count());
+    prng.generate(draws.size() * sizeof(uint64_t), reinterpret_cast<seal::seal_byte*>(draws.data()));
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "encode"));
+    seal::Plaintext mask;
+    if (use_ckks) {
+        std::vector<double> values(draws.size());
+        for (size_t i = 0; i < draws.size(); i++) {
+            values[i] = (static_cast<double>(draws[i] >> 11) * 0x1.0p-53 * 2.0 - 1.0) * bound;
+        }
+        ckks_encoder->encode(values, encrypted.parms_id(), encrypted.scale(), mask, scratch_pool());
+    } else {
+        const uint64_t plain_modulus = parms.plain_modulus().value();
+        for (uint64_t& draw : draws) draw %= plain_modulus;
+        bfv_encoder->encode(draws, mask);
+    }
+    return mask;
 }
 
 /**
- * Serialize the public key to Base64 string for sharing
- * Allows clients to encrypt data without access to the private key
+ * Add a refresh mask, before the ciphertext is sent to the key holder
  * 
- * @return Base64-encoded public key
+ * @param encrypted Ciphertext to mask; CKKS and BGV ones are first switched to the
+ *                  lowest level the values still fit (the last, for BGV)
+ * @param seed Seed of the batch (RefreshMasks::Pending)
+ * @param index Position of the ciphertext in the batch
+ * @param bound CKKS: masks are uniform in [-bound, bound], at most refresh_mask_bound();
+ *              ignored for BFV and BGV
+ * @throws std::invalid_argument if a CKKS mask of bound does not fit the ciphertext's level
+ * 
+ * BFV ciphertexts keep their level, as switching down would spend noise
+ * budget the key holder needs to decrypt them.
  */
-std::string HomomorphicEncryption::serialize_public_key() const {
-    std::stringstream ss;
-    public_key.save(ss);
-    return to_base64(ss.str());
+void HomomorphicEncryption::add_refresh_mask(seal::Ciphertext& encrypted, const seal::prng_seed_type& seed,
+                                             size_t index, double bound) const {
+    HE_PROBE_METHOD("add_refresh_mask", 1, ciphertext_bytes(encrypted));
+    auto context_data = context->get_context_data(encrypted.parms_id());
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    if (use_ckks) {
+        // Masked values up to 2 bound, plus a sign bit (see refresh_mask_bound)
+        const double bits = std::log2(encrypted.scale()) + std::log2(bound) + 2;
+        if (context_data->total_coeff_modulus_bit_count() < bits) {
+            throw std::invalid_argument("A refresh mask of " + std::to_string(bound) + " does not fit the "
+                                        "ciphertext's level, which allows " +
+                                        std::to_string(refresh_mask_bound(encrypted)));
+        }
+        auto lowest = context_data;
+        while (lowest->next_context_data() && lowest->next_context_data()->total_coeff_modulus_bit_count() >= bits) {
+            lowest = lowest->next_context_data();
+        }
+        if (lowest != context_data) evaluator->mod_switch_to_inplace(encrypted, lowest->parms_id(), scratch_pool());
+    } else if (use_bgv && context_data->next_context_data()) {
+        evaluator->mod_switch_to_inplace(encrypted, context->last_parms_id(), scratch_pool());
+    }
+    seal::Plaintext mask = refresh_mask(encrypted, seed, index, bound);
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    evaluator->add_plain_inplace(encrypted, mask, scratch_pool());
+}
+
+/**
+ * Largest CKKS refresh mask bound the ciphertext's level fits, a power of two:
+ * masked values up to twice the bound, and a sign bit, within its coefficient modulus
+ * (2^8 at the last level of the default profile, 2^38 one level up)
+ */
+double HomomorphicEncryption::refresh_mask_bound(const seal::Ciphertext& encrypted) const {
+    auto context_data = context->get_context_data(encrypted.parms_id());
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    const double bits = context_data->total_coeff_modulus_bit_count() - std::log2(encrypted.scale()) - 2;
+    if (bits < 0) throw std::invalid_argument("The ciphertext's level leaves no room for a refresh mask");
+    return std::exp2(std::floor(bits));
+}
+
+/**
+ * Remove a refresh mask from the fresh ciphertext the key holder sent back
+ * 
+ * @param encrypted refresh() of the masked ciphertext
+ * @param seed, index, bound As given to add_refresh_mask
+ */
+void HomomorphicEncryption::remove_refresh_mask(seal::Ciphertext& encrypted, const seal::prng_seed_type& seed,
+                                                size_t index, double bound) const {
+    HE_PROBE_METHOD("remove_refresh_mask", 1, ciphertext_bytes(encrypted));
+    seal::Plaintext mask = refresh_mask(encrypted, seed, index, bound);
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    evaluator->sub_plain_inplace(encrypted, mask, scratch_pool());
+}
+
+/**
+ * Key holder's half of a refresh: the ciphertext's values, encrypted afresh
+ * 
+ * @param encrypted Ciphertext at any level
+ * @param symmetric If true, encrypt with the secret key in seeded form (see encrypt_symmetric)
+ * @param wire Wire encoding and compression of the result
+ * @return Serialized ciphertext at the level of a fresh encryption (CKKS: at the default scale)
+ * 
+ * BFV and BGV plaintexts are re-encrypted as decrypted; CKKS ones are decoded
+ * and encoded again at the top of the chain.
+ */
+std::string HomomorphicEncryption::refresh(const seal::Ciphertext& encrypted, bool symmetric,
+                                           const WireOptions& wire) const {
+    HE_PROBE_METHOD("refresh", 1, ciphertext_bytes(encrypted));
+    auto keys = this->keys();
+    if (!keys->decryptor) throw std::runtime_error("Decryptor not initialized");
+    seal::Plaintext plain(scratch_pool());
+    {
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "decrypt"));
+        keys->decryptor->decrypt(encrypted, plain);
+    }
+    if (use_ckks) {
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "encode"));
+        std::vector<double> values;
+        ckks_encoder->decode(plain, values, scratch_pool());
+        ckks_encoder->encode(values, scale, plain, scratch_pool());
+    }
+    std::string out;
+    encrypt_plain(plain, symmetric, out, wire);
+    return out;
+}
+
+/**
+ * Perform homomorphic addition of two encrypted values
+ * Addition is performed directly on the ciphertexts without decryption
+ * 
+ * @param encrypted_a Base64-encoded first operand
+ * @param encrypted_b Base64-encoded second operand
+ * @param wire Wire encoding of the operands and the result, compression of the result
+ * @return Base64-encoded result of encrypted addition
+ * 
+ * This operation works for both BFV and CKKS schemes
+ * The result remains encrypted and can be used in further operations
+ */
+std::string HomomorphicEncryption::add(std::string_view encrypted_a, std::string_view encrypted_b,
+                                      const WireOptions& wire) const {
+    HE_PROBE_METHOD("add", 2, encrypted_a.size() + encrypted_b.size());
+    // Deserialize both operands from Base64 strings
+    seal::Ciphertext a = deserialize(encrypted_a, wire.format);
+    seal::Ciphertext b = deserialize(encrypted_b, wire.format);
+    seal::Ciphertext result = ciphertext_pool::take(a.parms_id(), a.size());
+    
+    // Perform homomorphic addition: result = a + b (encrypted)
+    {
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+        evaluator->add(a, b, result);
+    }
+    std::string serialized = serialize(result, wire);  // Serialize result back to Base64
+    ciphertext_pool::recycle(std::move(a));
+    ciphertext_pool::recycle(std::move(b));
+    ciphertext_pool::recycle(std::move(result));
+    return serialized;
+}
+
+/**
+ * Lowest level a result can be dropped to without losing it, for compact
+ * responses: every level removed is one RNS limb less to send and decrypt
+ * 
+ * BFV and BGV: the last level. Modulus switching keeps the noise relative to the
+ * modulus, so any result that still decrypts keeps decrypting (a fresh
+ * ciphertext's budget shrinks to what the last prime can hold).
+ * CKKS: the lowest level whose modulus still exceeds the ciphertext's scale
+ * by compact_headroom_bits, i.e. keeps values up to about 2^19 in magnitude;
+ * lower levels would wrap larger sums around.
+ * 
+ * @param encrypted Result ciphertext
+ * @return parms_id to switch to; encrypted.parms_id() if nothing can be dropped
+ */
+seal::parms_id_type HomomorphicEncryption::compact_parms_id(const seal::Ciphertext& encrypted) const {
+    auto context_data = context->get_context_data(encrypted.parms_id());
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    if (!use_ckks) return context->last_parms_id();
+
+    double needed_bits = std::log2(encrypted.scale()) + result_headroom_bits;
+    while (context_data->next_context_data() &&
+           context_data->next_context_data()->total_coeff_modulus_bit_count() >= needed_bits) {
+        context_data = context_data->next_context_data();
+    }
+    return context_data->parms_id();
+}
+
+/**
+ * Telemetry for a ciphertext about to be decrypted (or just inspected)
+ * The noise budget needs the secret key and costs about as much as decrypting;
+ * measured budgets and levels also go to he_noise_budget_bits / he_ciphertext_level
+ *
+ * @param encrypted Ciphertext under these parameters
+ * @return Level, size, scale and (BFV) invariant noise budget
+ * @throws std::invalid_argument if the ciphertext is not valid for these parameters
+ */
+CiphertextInfo HomomorphicEncryption::inspect(const seal::Ciphertext& encrypted) const {
+    HE_PROBE_METHOD("inspect", 1, ciphertext_bytes(encrypted));
+    auto context_data = context->get_context_data(encrypted.parms_id());
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    CiphertextInfo info;
+    info.level = context_data->chain_index();
+    info.max_level = context->first_context_data()->chain_index();
+    info.size = encrypted.size();
+    info.coeff_modulus_count = encrypted.coeff_modulus_size();
+    if (use_ckks) info.scale = encrypted.scale();
+    auto keys = this->keys();
+    if (!use_ckks && keys->decryptor) {
+        info.noise_budget = keys->decryptor->invariant_noise_budget(encrypted);
+        metrics::histogram("he_noise_budget_bits", "Invariant noise budget of inspected BFV ciphertexts",
+                           {{"endpoint", metrics::current_endpoint()}})
+            .record(static_cast<uint64_t>(info.noise_budget));
+    }
+    metrics::histogram("he_ciphertext_level", "Chain index of inspected ciphertexts (0 = last prime)",
+                       {{"endpoint", metrics::current_endpoint()}, {"scheme", scheme_name()}})
+        .record(info.level);
+    return info;
+}
+
+/**
+ * Serialize a SEAL ciphertext to Base64 string for network transmission
+ * 
+ * @param ct The ciphertext to serialize
+ * @param wire WireFormat::binary skips the Base64 step; compression selects the SEAL mode
+ * @return Base64-encoded string representation (or raw SEAL bytes)
+ */
+std::string HomomorphicEncryption::serialize(const seal::Ciphertext& ct, const WireOptions& wire) const {
+    std::string out;
+    serialize_into(ct, out, wire);
+    return out;
+}
+
+/**
+ * Serialize a SEAL ciphertext by appending it to an existing buffer
+ * Lets callers write straight into a response body without an extra copy
+ * 
+ * @param ct The ciphertext to serialize
+ * @param out Buffer the serialized ciphertext is appended to
+ * @param wire Wire encoding and compression to produce
+ */
+void HomomorphicEncryption::serialize_into(const seal::Ciphertext& ct, std::string& out, const WireOptions& wire) const {
+    HE_PROBE_METHOD("serialize", 1, ciphertext_bytes(ct));
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "serialize"));
+    size_t offset = out.size();
+    seal::parms_id_type target = wire.compact ? compact_parms_id(ct) : ct.parms_id();
+    if (target != ct.parms_id()) {
+        seal::Ciphertext compacted(scratch_pool());
+        evaluator->mod_switch_to(ct, target, compacted, scratch_pool());
+        save_wire(compacted, out, wire, scheme_name());
+    } else {
+        save_wire(ct, out, wire, scheme_name());
+    }
+    if (wire.stats) wire.stats->add_ciphertext(context->get_context_data(target)->chain_index(), ct.size());
+    metrics::counter("he_serialized_bytes_total", "Ciphertext bytes produced for the wire",
+                     {{"scheme", scheme_name()}}).add(out.size() - offset);
+}
+
+/**
+ * Deserialize a Base64 string back to SEAL ciphertext
+ * 
+ * @param str Base64-encoded ciphertext string (or raw SEAL bytes)
+ * @param format Encoding of str
+ * @param check LoadCheck::trusted only for bytes this deployment produced
+ * @return Reconstructed SEAL ciphertext object
+ */
+seal::Ciphertext HomomorphicEncryption::deserialize(std::string_view str, WireFormat format, LoadCheck check) const {
+    return deserialize(str.data(), str.size(), format, check);
+}
+
+/**
+ * Deserialize a ciphertext from any contiguous byte range (e.g. a slice of a request body)
+ * 
+ * @param data Start of the serialized ciphertext
+ * @param size Number of bytes (or Base64 characters)
+ * @param format Encoding of the data
+ * @param check LoadCheck::trusted only for bytes this deployment produced
+ * @return Reconstructed SEAL ciphertext object
+ * 
+ * A trusted load still rejects bytes whose header, parms_id or size do not
+ * fit the context; it skips the scan of every coefficient against its
+ * modulus, which costs about as much as copying the data.
+ * 
+ * The ciphertext is loaded into a recycled one (see CiphertextPool.h) of the
+ * parms_id and size the thread last loaded, as a request's operands are
+ * nearly always alike.
+ */
+seal::Ciphertext HomomorphicEncryption::deserialize(const char* data, size_t size, WireFormat format,
+                                                    LoadCheck check) const {
+    HE_PROBE_METHOD("deserialize", 1, size);
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "deserialize"));
+    thread_local std::pair<seal::parms_id_type, size_t> last_loaded{seal::parms_id_zero, 0};
+    seal::Ciphertext ct = ciphertext_pool::take(last_loaded.first, last_loaded.second);
+    load_wire(ct, *context, data, size, format, scheme_name(), check);  // Load ciphertext without stream copies
+    last_loaded = {ct.parms_id(), ct.size()};
+    metrics::counter("he_deserialized_bytes_total", "Ciphertext bytes received from the wire",
+                     {{"scheme", scheme_name()}}).add(size);
+    if (metrics::RequestMemory* memory = metrics::current_memory()) {
+        memory->ciphertext_bytes.fetch_add(ct.dyn_array().size() * sizeof(seal::Ciphertext::ct_coeff_type),
+                                           std::memory_order_relaxed);
+    }
+    return ct;
+}
+
+/**
+ * Serialize the public key to Base64 string for sharing
+ * Allows clients to encrypt data without access to the private key
+ * 
+ * @param wire Compression (and optional size report) for the key; the format is always Base64
+ * @return Base64-encoded public key
+ */
+std::string HomomorphicEncryption::serialize_public_key(const WireOptions& wire) const {
+    HE_PROBE_METHOD("serialize_public_key", 0, 0);
+    std::string out;
+    save_wire(keys()->public_key, out, WireOptions(WireFormat::base64, wire.compression, wire.stats), scheme_name());
+    return out;
 }
 
 /**
  * Load a public key from Base64 string and initialize encryptor
- * Used when receiving a public key from another party
+ * Used when receiving a public key from another party. Hashing the bytes
+ * costs a fraction of parsing and validating them, so a key posted again
+ * unchanged is recognized and neither parsed nor given a new encryptor
  * 
  * @param serialized_key Base64-encoded public key string
  */
-void HomomorphicEncryption::load_public_key(const std::string& serialized_key) {
-    std::string data = from_base64(serialized_key);
-    std::stringstream ss(data);
-    public_key.load(*context, ss);
-    // Reinitialize encryptor with the new public key
-    encryptor = std::make_unique<seal::Encryptor>(*context, public_key);
+void HomomorphicEncryption::load_public_key(std::string_view serialized_key) {
+    HE_PROBE_METHOD("load_public_key", 1, serialized_key.size());
+    std::string source = key_fingerprint(serialized_key);
+    if (keys()->public_key_source == source) return;
+    seal::PublicKey loaded;
+    load_wire(loaded, *context, serialized_key.data(), serialized_key.size(), WireFormat::base64, scheme_name());
+    // Publish the new public key with a fresh encryptor; the secret key, if any, stays
+    std::lock_guard<std::mutex> lock(key_update_mutex);
+    auto keys = copy_keys();
+    keys->public_key = std::move(loaded);
+    keys->public_key_fingerprint.clear();
+    keys->public_key_source = std::move(source);
+    publish(std::move(keys));
 }
 
 /**
  * Compute the homomorphic sum of multiple encrypted values
  * Efficiently adds all ciphertexts in a vector without decryption
  * 
- * @param ciphertexts Vector of Base64-encoded ciphertext strings
+ * @param ciphertexts Base64-encoded ciphertexts, by reference
+ * @param wire Wire encoding of the inputs and the result, compression of the result
  * @return Base64-encoded encrypted sum result
  * 
  * This is useful for computing statistics on encrypted datasets,
  * such as sum of encrypted healthcare data or financial records.
  * The operation is performed entirely in the encrypted domain.
+ * With a thread pool configured, large inputs use parallel_sum.
+ */
+std::string HomomorphicEncryption::sum(const CiphertextViews& ciphertexts, const WireOptions& wire) const {
+    HE_PROBE_METHOD("sum", ciphertexts.size(), total_size(ciphertexts));
+    seal::Ciphertext result = deserialize_sum(ciphertexts, wire.format);
+    std::string serialized = serialize(result, wire);  // Return the encrypted sum
+    ciphertext_pool::recycle(std::move(result));
+    return serialized;
+}
+
+/**
+ * Deserialize and sum ciphertexts, keeping the result in memory
+ * 
+ * @param ciphertexts Serialized ciphertexts, by reference
+ * @param format Wire encoding of the inputs
+ * @param check LoadCheck::trusted only for bytes this deployment produced
+ * @return Encrypted sum
+ * 
+ * Each input is decoded once, straight from its view, as the reduction needs it.
+ */
+seal::Ciphertext HomomorphicEncryption::deserialize_sum(const CiphertextViews& ciphertexts, WireFormat format,
+                                                        LoadCheck check) const {
+    if (ciphertexts.empty()) {
+        throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+    }
+    
+    auto load = [&](size_t i) { return deserialize(ciphertexts[i], format, check); };
+    return reduce(load, ciphertexts.size());
+}
+
+/**
+ * Compute the homomorphic sum of ciphertexts read from a source as they are added
+ * 
+ * @param next Source of serialized ciphertexts, e.g. the strings of a request body
+ * @param count Number of ciphertexts the source holds
+ * @param wire Wire encoding of the inputs and the result, compression of the result
+ * @return Serialized encrypted sum
+ * @throws std::invalid_argument if count is 0 or the source holds fewer ciphertexts
+ * 
+ * Same result as sum() without a vector of every input: each operand is
+ * pulled (under a lock, so parallel_sum's leaves share the source),
+ * deserialized and added, with at most sum_batch operands held per thread.
+ * Leaves add operands in the order they pull them, which varies by run;
+ * additions are exact modulo each RNS prime, so the result does not.
+ */
+std::string HomomorphicEncryption::sum(const CiphertextSource& next, size_t count, const WireOptions& wire) const {
+    HE_PROBE_METHOD("sum_stream", count, 0);
+    seal::Ciphertext result = deserialize_sum(next, count, wire.format);
+    std::string serialized = serialize(result, wire);
+    ciphertext_pool::recycle(std::move(result));
+    return serialized;
+}
+
+/**
+ * The streamed sum as an object, for in-process pipelines
+ * 
+ * @param next Source of serialized ciphertexts
+ * @param count Number of ciphertexts the source holds
+ * @param format Wire encoding of the inputs
+ * @return Encrypted sum
+ */
+seal::Ciphertext HomomorphicEncryption::deserialize_sum(const CiphertextSource& next, size_t count,
+                                                        WireFormat format) const {
+    if (count == 0) {
+        throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+    }
+    
+    std::mutex source_mutex;
+    auto load = [&](size_t) {
+        thread_local std::string scratch;
+        const char* data = nullptr;
+        size_t size = 0;
+        {
+            std::lock_guard<std::mutex> lock(source_mutex);
+            if (!next(scratch, data, size)) throw std::invalid_argument("Ciphertext source ended early");
+        }
+        return deserialize(data, size, format);
+    };
+    return reduce(load, count);
+}
+
+/**
+ * Compute sum(x) and sum(x^2) over the same encrypted inputs
+ * 
+ * @param ciphertexts Base64-encoded ciphertexts of x (one value each, or packed)
+ * @param packed Fold the slots of both results, as sum_slots does
+ * @param wire Wire encoding of the inputs and the results, compression of the results
+ * @return Encrypted {sum(x), sum(x^2)}
+ * @throws std::invalid_argument if the parameter profile has no multiplicative depth
+ * @throws std::runtime_error if relinearization (or, packed, Galois) keys are not loaded
+ * 
+ * Each input is deserialized once and squared; the size-3 squares are summed
+ * and relinearized (for CKKS also rescaled, for BGV switched down) once, so
+ * x^2 never needs its own upload. var(x) = sum(x^2) / n - (sum(x) / n)^2 after
+ * decryption. For CKKS and BGV the sum of squares is one level below the sum.
+ */
+std::pair<std::string, std::string> HomomorphicEncryption::moments(const CiphertextViews& ciphertexts,
+                                                                   bool packed, const WireOptions& wire) const {
+    HE_PROBE_METHOD("moments", ciphertexts.size(), total_size(ciphertexts));
+    if (ciphertexts.empty()) {
+        throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+    }
+    if (profile.depth < 1) {
+        throw std::invalid_argument("Squaring needs a profile with multiplicative depth >= 1, not " + profile.name);
+    }
+    if (!has_relin_keys()) throw std::runtime_error("Relinearization keys not loaded");
+    
+    std::vector<seal::Ciphertext> values;
+    values.reserve(ciphertexts.size());
+    for (const auto& ciphertext : ciphertexts) {
+        values.push_back(deserialize(ciphertext, wire.format));
+    }
+    
+    seal::Ciphertext sum_x = sum(values);
+    auto square = [&](size_t i) { return multiply(values[i], values[i]); };
+    seal::Ciphertext sum_x2 = reduce(square, values.size());
+    relinearize_inplace(sum_x2);
+    if (rescales()) rescale_inplace(sum_x2);
+    
+    if (packed) {
+        sum_slots_inplace(sum_x);
+        sum_slots_inplace(sum_x2);
+    }
+    std::pair<std::string, std::string> serialized{ serialize(sum_x, wire), serialize(sum_x2, wire) };
+    for (auto& value : values) ciphertext_pool::recycle(std::move(value));
+    ciphertext_pool::recycle(std::move(sum_x));
+    ciphertext_pool::recycle(std::move(sum_x2));
+    return serialized;
+}
+
+/**
+ * Compute the mean of encrypted values
+ * 
+ * @param ciphertexts Base64-encoded ciphertexts (one value each, or packed)
+ * @param count Number of values they hold
+ * @param packed Fold the slots of the result, as sum_slots does
+ * @param wire Wire encoding of the inputs and the result, compression of the result
+ * @param divided Set to whether the result is the mean (true) or, for BFV, the sum
+ * @return Base64-encoded mean (CKKS) or sum (BFV)
+ * 
+ * The sum is divided before a packed result's slots are folded, so the
+ * rotations run one level lower, on a smaller ciphertext.
  */
-std::string HomomorphicEncryption::sum(const std::vector<std::string>& ciphertexts) const {
+std::string HomomorphicEncryption::average(const CiphertextViews& ciphertexts, size_t count, bool packed,
+                                           const WireOptions& wire, bool* divided) const {
+    HE_PROBE_METHOD("average", ciphertexts.size(), total_size(ciphertexts));
     if (ciphertexts.empty()) {
         throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
     }
     
-    // Start with the first ciphertext as the accumulator
-    seal::Ciphertext result = deserialize(ciphertexts[0]);
+    auto load = [&](size_t i) { return deserialize(ciphertexts[i], wire.format); };
+    seal::Ciphertext result = reduce(load, ciphertexts.size());
+    bool is_mean = divide_inplace(result, count);
+    if (packed) sum_slots_inplace(result);
+    if (divided) *divided = is_mean;
+    std::string serialized = serialize(result, wire);
+    ciphertext_pool::recycle(std::move(result));
+    return serialized;
+}
+
+/**
+ * Sum already deserialized ciphertexts (e.g. a column held in the ciphertext store)
+ * 
+ * @param ciphertexts Ciphertexts to add
+ * @return Encrypted sum
+ */
+seal::Ciphertext HomomorphicEncryption::sum(const std::vector<seal::Ciphertext>& ciphertexts) const {
+    return sum(ciphertexts.data(), ciphertexts.size());
+}
+
+/**
+ * Sum a contiguous range of deserialized ciphertexts (lets callers reduce a
+ * column piecewise, e.g. to report progress, without copying it)
+ * 
+ * @param ciphertexts First ciphertext of the range
+ * @param count Number of ciphertexts
+ * @return Encrypted sum
+ */
+seal::Ciphertext HomomorphicEncryption::sum(const seal::Ciphertext* ciphertexts, size_t count) const {
+    HE_PROBE_METHOD("sum_objects", count, ciphertext_bytes(ciphertexts, count));
+    if (count == 0) {
+        throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+    }
+    
+    auto load = [&](size_t i) -> const seal::Ciphertext& { return ciphertexts[i]; };
+    return reduce(load, count);
+}
+
+/**
+ * Add two deserialized ciphertexts
+ * 
+ * @return Encrypted a + b
+ */
+seal::Ciphertext HomomorphicEncryption::add(const seal::Ciphertext& a, const seal::Ciphertext& b) const {
+    HE_PROBE_METHOD("add_objects", 2, ciphertext_bytes(a) + ciphertext_bytes(b));
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::Ciphertext result;
+    evaluator->add(a, b, result);
+    return result;
+}
+
+/**
+ * Add a deserialized ciphertext into an accumulator
+ * 
+ * @param a Accumulator, receives a + b
+ * @param b Ciphertext to add
+ */
+void HomomorphicEncryption::add_inplace(seal::Ciphertext& a, const seal::Ciphertext& b) const {
+    HE_PROBE_METHOD("add_inplace", 2, ciphertext_bytes(a) + ciphertext_bytes(b));
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    evaluator->add_inplace(a, b);
+}
+
+/**
+ * Multiply two ciphertexts without relinearizing or rescaling the product
+ * 
+ * @param a First factor
+ * @param b Second factor; must be at the same level as a (see match_level_inplace)
+ * @return Product of size a.size() + b.size() - 1, for CKKS at scale a.scale() * b.scale()
+ */
+seal::Ciphertext HomomorphicEncryption::multiply(const seal::Ciphertext& a, const seal::Ciphertext& b) const {
+    HE_PROBE_METHOD("multiply", 2, ciphertext_bytes(a) + ciphertext_bytes(b));
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::Ciphertext result;
+    if (&a == &b) {
+        evaluator->square(a, result, scratch_pool());
+    } else {
+        evaluator->multiply(a, b, result, scratch_pool());
+    }
+    return result;
+}
+
+/**
+ * Relinearize a size-3 product back to size 2 (one key switch)
+ * 
+ * @param encrypted Ciphertext to relinearize; size-2 ciphertexts are left alone
+ */
+void HomomorphicEncryption::relinearize_inplace(seal::Ciphertext& encrypted) const {
+    HE_PROBE_METHOD("relinearize", 1, ciphertext_bytes(encrypted));
+    if (encrypted.size() <= 2) return;
+    auto keys = expanded_keys(false);
+    if (keys->relin_keys.size() == 0) throw std::runtime_error("Relinearization keys not loaded");
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    evaluator->relinearize_inplace(encrypted, keys->relin_keys, scratch_pool());
+}
+
+/**
+ * Divide a CKKS product by the last prime of its modulus, bringing the scale
+ * back near that of the inputs and dropping one level
+ * 
+ * BGV products are switched to the next level instead, which divides their
+ * noise by the dropped prime and leaves a ciphertext one limb smaller; at the
+ * last level they are left alone.
+ * 
+ * @param encrypted CKKS or BGV ciphertext to rescale
+ * @throws std::logic_error for BFV, which has no rescaling
+ */
+void HomomorphicEncryption::rescale_inplace(seal::Ciphertext& encrypted) const {
+    HE_PROBE_METHOD("rescale", 1, ciphertext_bytes(encrypted));
+    if (!rescales()) throw std::logic_error("BFV ciphertexts are not rescaled");
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    if (use_bgv) {
+        auto context_data = context->get_context_data(encrypted.parms_id());
+        if (context_data && context_data->next_context_data()) {
+            evaluator->mod_switch_to_next_inplace(encrypted, scratch_pool());
+        }
+        return;
+    }
+    evaluator->rescale_to_next_inplace(encrypted, scratch_pool());
+}
+
+/**
+ * Divide an encrypted CKKS value by an integer, e.g. a sum by its count
+ * 
+ * @param encrypted Ciphertext to divide; must have a level to spare for the rescale
+ * @param divisor Integer to divide by (> 0)
+ * @return false, leaving encrypted unchanged, for BFV and BGV (no division in the plaintext
+ *         ring), a zero divisor, or a CKKS ciphertext already at the last level
+ * 
+ * One multiply_plain by 1/divisor and one rescale. 1/divisor is encoded at the
+ * scale of the prime the rescale drops, so the result keeps the input's scale
+ * exactly; its relative precision is about divisor / that prime (~2^-30 * divisor
+ * for the default profile).
+ */
+bool HomomorphicEncryption::divide_inplace(seal::Ciphertext& encrypted, size_t divisor) const {
+    HE_PROBE_METHOD("divide", 1, ciphertext_bytes(encrypted));
+    if (!use_ckks || divisor == 0) return false;
+    auto context_data = context->get_context_data(encrypted.parms_id());
+    if (!context_data || !context_data->next_context_data()) return false;
     
-    // Add each subsequent ciphertext to the running sum
-    for (size_t i = 1; i < ciphertexts.size(); i++) {
-        seal::Ciphertext next = deserialize(ciphertexts[i]);
-        evaluator->add_inplace(result, next);  // In-place addition for efficiency
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::MemoryPoolHandle pool = scratch_pool();
+    const double dropped_prime = static_cast<double>(context_data->parms().coeff_modulus().back().value());
+    auto reciprocal = encoded(1.0 / static_cast<double>(divisor), dropped_prime, encrypted.parms_id());
+    evaluator->multiply_plain_inplace(encrypted, *reciprocal, pool);
+    evaluator->rescale_to_next_inplace(encrypted, pool);
+    return true;
+}
+
+/**
+ * Switch whichever of two ciphertexts is at the higher level down to the other's
+ * level, so they can be added or multiplied (the scales are left as they are)
+ */
+void HomomorphicEncryption::match_level_inplace(seal::Ciphertext& a, seal::Ciphertext& b) const {
+    size_t level_a = context->get_context_data(a.parms_id())->chain_index();
+    size_t level_b = context->get_context_data(b.parms_id())->chain_index();
+    if (level_a == level_b) return;
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    if (level_a > level_b) {
+        evaluator->mod_switch_to_inplace(a, b.parms_id(), scratch_pool());
+    } else {
+        evaluator->mod_switch_to_inplace(b, a.parms_id(), scratch_pool());
     }
+}
+
+/**
+ * Level of a ciphertext in the modulus chain: the number of rescales (CKKS)
+ * or modulus switches it has left
+ * 
+ * @throws std::invalid_argument if the ciphertext is not valid for these parameters
+ */
+size_t HomomorphicEncryption::chain_index(const seal::Ciphertext& encrypted) const {
+    auto context_data = context->get_context_data(encrypted.parms_id());
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    return context_data->chain_index();
+}
+
+/**
+ * The prime a rescale from the given level divides by (its last prime)
+ * 
+ * @throws std::invalid_argument if the chain has no such level
+ */
+double HomomorphicEncryption::dropped_prime(size_t chain_index) const {
+    return static_cast<double>(level_at(*context, chain_index)->parms().coeff_modulus().back().value());
+}
+
+/**
+ * Switch a ciphertext down to a lower level of the chain (the scale is kept)
+ * 
+ * @param encrypted Ciphertext at or above chain_index
+ * @param chain_index Level to switch to
+ */
+void HomomorphicEncryption::mod_switch_to_inplace(seal::Ciphertext& encrypted, size_t chain_index) const {
+    HE_PROBE_METHOD("mod_switch", 1, ciphertext_bytes(encrypted));
+    auto target = level_at(*context, chain_index);
+    if (encrypted.parms_id() == target->parms_id()) return;
     
-    return serialize(result);  // Return the encrypted sum
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    evaluator->mod_switch_to_inplace(encrypted, target->parms_id(), scratch_pool());
+}
+
+/**
+ * Encode the weights of a column for weighted_sum, at the level of its ciphertexts
+ * 
+ * Packed: one weight per value, chunked into slot-wise plaintexts like
+ * encrypt_vector chunks the values. Otherwise one weight per ciphertext.
+ * BFV and BGV weights must be integers (negative ones are taken mod the
+ * plain modulus). Slot-wise ones are transformed to NTT form here; a single
+ * BFV weight, or a chunk with the same weight in every slot, stays a constant
+ * polynomial, which weighted_sum applies as a scalar without any NTT, while a
+ * BGV one is transformed too, as BGV ciphertexts are in NTT form and SEAL
+ * would transform the weight on every product. CKKS weights are encoded at the scale of the prime that the final
+ * rescale drops, so the weighted sum keeps its inputs' scale. Encoded chunks
+ * come from the plaintext cache, so the same model weights at the same level
+ * are encoded once.
+ * 
+ * @param weights Weights in column order
+ * @param packed Whether the column holds slot_count() values per ciphertext
+ * @param parms_id Level of the column's ciphertexts
+ * @return One plaintext per ciphertext of the column
+ * @throws std::invalid_argument for a fractional BFV weight or an unknown level
+ */
+std::vector<seal::Plaintext> HomomorphicEncryption::encode_weights(const std::vector<double>& weights, bool packed,
+                                                                   seal::parms_id_type parms_id) const {
+    HE_PROBE_METHOD("encode_weights", weights.size(), 0);
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "encode"));
+    auto context_data = context->get_context_data(parms_id);
+    if (!context_data) throw std::invalid_argument("Unknown ciphertext level");
+    double ckks_scale = static_cast<double>(context_data->parms().coeff_modulus().back().value());
+    const size_t chunk_size = packed ? slot_count() : 1;
+
+    std::vector<seal::Plaintext> encoded((weights.size() + chunk_size - 1) / chunk_size);
+    for (size_t chunk = 0; chunk < encoded.size(); chunk++) {
+        auto first = weights.begin() + chunk * chunk_size;
+        auto last = weights.begin() + std::min(weights.size(), (chunk + 1) * chunk_size);
+        if (use_ckks) {
+            encoded[chunk] = *this->encoded(std::vector<double>(first, last), !packed, ckks_scale, parms_id);
+            continue;
+        }
+
+        std::vector<uint64_t> values;
+        for (auto it = first; it != last; ++it) values.push_back(plain_scalar(*it));
+        bool uniform = values.size() == chunk_size &&
+                       std::all_of(values.begin(), values.end(), [&](uint64_t value) { return value == values[0]; });
+        if (!uniform) {
+            encoded[chunk] = *this->encoded(std::vector<double>(first, last), false, 0.0, parms_id);
+        } else {
+            // A constant polynomial multiplies every batching slot by the same value;
+            // weighted_sum applies a BFV one without a plaintext product
+            encoded[chunk].resize(1);
+            encoded[chunk][0] = values[0];
+            if (use_bgv && values[0]) evaluator->transform_to_ntt_inplace(encoded[chunk], parms_id, scratch_pool());
+        }
+    }
+    return encoded;
 }
 
+/**
+ * An integer BFV or BGV constant reduced modulo the plaintext modulus
+ * 
+ * @throws std::invalid_argument if value is not an integer
+ */
+uint64_t HomomorphicEncryption::plain_scalar(double value) const {
+    if (value != std::round(value)) throw std::invalid_argument("BFV weights must be integers");
+    int64_t plain_modulus = static_cast<int64_t>(parms.plain_modulus().value());
+    int64_t reduced = static_cast<int64_t>(value) % plain_modulus;
+    return static_cast<uint64_t>(reduced < 0 ? reduced + plain_modulus : reduced);
+}
+
+/**
+ * Weighted sum sum_i weights[i] * terms[i] in the evaluation domain
+ * 
+ * Evaluator::multiply_plain on a BFV ciphertext transforms ciphertext and
+ * plaintext to NTT form and back on every call. Here a term with an NTT-form
+ * weight is transformed once, multiplied and accumulated in NTT form, and
+ * only the accumulated sum is transformed back; a constant weight multiplies
+ * its term coefficient-wise in the form the term is in, without any NTT. Terms that already are in NTT form
+ * (see transform_to_ntt_inplace) go through Evaluator::multiply_plain_add_many,
+ * which forms and sums their products without a temporary per term. CKKS and BGV ciphertexts always are
+ * in NTT form, so the chain just ends with one rescale (CKKS) or switch to
+ * the next level (BGV, see rescale_inplace).
+ * 
+ * @param terms weights.size() ciphertexts at the level the weights were encoded for
+ * @param weights Output of encode_weights
+ * @return Encrypted weighted sum; for CKKS one level lower, at the input scale, for BGV
+ *         one level lower unless the terms were at the last
+ * @throws std::invalid_argument if every weight is zero
+ */
+seal::Ciphertext HomomorphicEncryption::weighted_sum(const seal::Ciphertext* terms,
+                                                     const std::vector<seal::Plaintext>& weights) const {
+    HE_PROBE_METHOD("weighted_sum", weights.size(), ciphertext_bytes(terms, weights.size()));
+    if (weights.empty()) throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::MemoryPoolHandle pool = scratch_pool();
+    seal::Ciphertext sums[2];  // Coefficient form, NTT form
+    bool used[2] = { false, false };
+    seal::Ciphertext term;
+    std::vector<const seal::Ciphertext*> ntt_terms;
+    std::vector<const seal::Plaintext*> ntt_weights;
+    for (size_t i = 0; i < weights.size(); i++) {
+        // SEAL rejects products with a zero plaintext (they would be transparent)
+        if (weights[i].is_zero()) continue;
+        // A constant BFV weight multiplies the term in whichever form it is in
+        bool scalar = !weights[i].is_ntt_form() && weights[i].coeff_count() == 1;
+        bool ntt = use_ckks || use_bgv || weights[i].is_ntt_form() || (scalar && terms[i].is_ntt_form());
+        if (ntt && terms[i].is_ntt_form() && weights[i].is_ntt_form()) {
+            ntt_terms.push_back(terms + i);
+            ntt_weights.push_back(&weights[i]);
+            continue;
+        }
+        seal::Ciphertext& target = used[ntt] ? term : sums[ntt];
+        target = terms[i];
+        if (scalar) {
+            evaluator->multiply_scalar_inplace(target, weights[i][0]);
+        } else {
+            if (ntt && !target.is_ntt_form()) evaluator->transform_to_ntt_inplace(target);
+            evaluator->multiply_plain_inplace(target, weights[i], pool);
+        }
+        if (used[ntt]) evaluator->add_inplace(sums[ntt], term);
+        used[ntt] = true;
+    }
+    if (!ntt_terms.empty()) {
+        // Products of terms already in NTT form are summed in one pass that
+        // reads every term and weight once, without writing each product
+        seal::Ciphertext& target = used[1] ? term : sums[1];
+        evaluator->multiply_plain_add_many(ntt_terms.data(), ntt_weights.data(), ntt_terms.size(), target, pool);
+        if (used[1]) evaluator->add_inplace(sums[1], term);
+        used[1] = true;
+    }
+
+    if (!used[0] && !used[1]) throw std::invalid_argument("All weights are zero");
+    if (use_ckks) {
+        evaluator->rescale_to_next_inplace(sums[1], pool);
+        return std::move(sums[1]);
+    }
+    if (use_bgv) {
+        if (context->get_context_data(sums[1].parms_id())->next_context_data()) {
+            evaluator->mod_switch_to_next_inplace(sums[1], pool);
+        }
+        return std::move(sums[1]);
+    }
+    if (!used[1]) return std::move(sums[0]);
+    evaluator->transform_from_ntt_inplace(sums[1]);
+    if (used[0]) evaluator->add_inplace(sums[1], sums[0]);
+    return std::move(sums[1]);
+}
+
+/**
+ * Transform a BFV ciphertext to NTT form ahead of several weighted_sum calls,
+ * which would otherwise transform a copy of it for each; CKKS and BGV
+ * ciphertexts already are in NTT form and are left as they are
+ */
+void HomomorphicEncryption::transform_to_ntt_inplace(seal::Ciphertext& encrypted) const {
+    if (encrypted.is_ntt_form()) return;
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    evaluator->transform_to_ntt_inplace(encrypted);
+}
+
+/**
+ * Group-by sum over a packed column: slot g of the result holds the sum of the
+ * values that masks[g] selects
+ * 
+ * @param column Packed ciphertexts (e.g. from encrypt_vector), all at one level
+ * @param count Number of ciphertexts
+ * @param masks One 0/1 mask per group, one entry per value in column order
+ * @return Packed ciphertext holding every group's total in its own slot
+ * @throws std::invalid_argument for no groups or more groups than slots, masks of
+ *         the wrong length, every group empty, or (CKKS) too few levels left
+ * 
+ * Per group: weighted_sum with the mask as weights, sum_slots, and one
+ * multiply_plain by the unit vector of slot g; groups run concurrently on the
+ * thread pool and the selected totals are added. CKKS spends two levels (mask
+ * and selection), and the level that leaves must keep result_headroom_bits
+ * above the scale; the default profile does not (use mult-depth-2 or
+ * ml-inference). BGV spends the same two levels, which the default
+ * profile's fresh ciphertexts do not have. BFV and BGV totals are taken mod
+ * the plain modulus.
+ */
+seal::Ciphertext HomomorphicEncryption::group_sum(const seal::Ciphertext* column, size_t count,
+                                                  const std::vector<std::vector<double>>& masks) const {
+    HE_PROBE_METHOD("group_sum", count, ciphertext_bytes(column, count));
+    if (count == 0) throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+    if (masks.empty() || masks.size() > slot_count()) {
+        throw std::invalid_argument("Expected between 1 and " + std::to_string(slot_count()) + " groups");
+    }
+    const seal::parms_id_type parms_id = column[0].parms_id();
+    auto context_data = context->get_context_data(parms_id);
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    if (use_ckks) {
+        auto result_level = context_data->next_context_data() ? context_data->next_context_data()->next_context_data()
+                                                              : nullptr;
+        if (!result_level ||
+            result_level->total_coeff_modulus_bit_count() < std::log2(column[0].scale()) + result_headroom_bits) {
+            throw std::invalid_argument("Group-by needs two more levels than profile " + profile.name + " leaves");
+        }
+    } else if (use_bgv && context_data->chain_index() < 2) {
+        throw std::invalid_argument("Group-by needs two more levels than profile " + profile.name + " leaves");
+    }
+    
+    // Total of one group in slot group, or an empty ciphertext for an empty group
+    auto group_total = [&](size_t group) {
+        seal::Ciphertext total;
+        if (std::all_of(masks[group].begin(), masks[group].end(), [](double bit) { return bit == 0; })) return total;
+        std::vector<seal::Plaintext> weights = encode_weights(masks[group], true, parms_id);
+        if (weights.size() != count) throw std::invalid_argument("Expected one mask entry per value");
+        total = weighted_sum(column, weights);
+        sum_slots_inplace(total);
+        
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+        seal::MemoryPoolHandle pool = scratch_pool();
+        std::vector<double> slots(slot_count(), 0.0);
+        slots[group] = 1.0;
+        if (use_ckks) {
+            auto level = context->get_context_data(total.parms_id());
+            double dropped_prime = static_cast<double>(level->parms().coeff_modulus().back().value());
+            evaluator->multiply_plain_inplace(total, *encoded(slots, false, dropped_prime, total.parms_id()), pool);
+            evaluator->rescale_to_next_inplace(total, pool);
+        } else if (use_bgv) {
+            evaluator->multiply_plain_inplace(total, *encoded(slots, false, 0.0, total.parms_id()), pool);
+            evaluator->mod_switch_to_next_inplace(total, pool);
+        } else {
+            evaluator->multiply_plain_inplace(total, *encoded(slots, false, 0.0, seal::parms_id_zero), pool);
+        }
+        return total;
+    };
+    
+    std::vector<seal::Ciphertext> totals(masks.size());
+    parallel_for(masks.size(), [&](size_t group) { totals[group] = group_total(group); });
+    
+    totals.erase(std::remove_if(totals.begin(), totals.end(),
+                                [](const seal::Ciphertext& total) { return total.size() == 0; }),
+                 totals.end());
+    if (totals.empty()) throw std::invalid_argument("Every group is empty");
+    return sum(totals);
+}
+
+/**
+ * Totals of a packed column under many row masks, e.g. the filtered totals
+ * of WHERE clauses on public columns (see RowFilter), all in one ciphertext
+ * 
+ * @param column Packed ciphertexts (e.g. from encrypt_vector), all at one level
+ * @param count Number of ciphertexts
+ * @param masks One 0/1 mask per filter, one entry per value in column order
+ * @return Packed ciphertext holding mask g's total in slot g, and again every
+ *         cross_sum_window(masks.size()) slots
+ * @throws std::invalid_argument for no masks or more than a BFV row holds,
+ *         masks of the wrong length, every mask empty, or (CKKS) no level
+ *         left with headroom
+ * 
+ * Unlike group_sum, the masks also place each value: with W the mask count
+ * rounded up to a power of two, the products for offset d keep value i
+ * under mask (i - d) mod W, so rotating them left by d moves it to a slot =
+ * its mask's index mod W. The W weighted sums (one plaintext product per
+ * ciphertext each, run concurrently, for few masks in shares of the
+ * chunks) are rotated by their offsets Horner-style, W - 1 rotations by
+ * one slot, and one fold strided by W completes every total. That is one level and W - 1 + log2(slots / W)
+ * rotations, where group_sum spends two levels and log2(slots) rotations
+ * per mask. BFV and BGV totals are taken mod the plain modulus.
+ */
+seal::Ciphertext HomomorphicEncryption::masked_sums(const seal::Ciphertext* column, size_t count,
+                                                    const std::vector<std::vector<double>>& masks) const {
+    HE_PROBE_METHOD("masked_sums", count, ciphertext_bytes(column, count));
+    if (count == 0) throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+    const size_t max_masks = use_ckks ? slot_count() : slot_count() / 2;
+    if (masks.empty() || masks.size() > max_masks) {
+        throw std::invalid_argument("Expected between 1 and " + std::to_string(max_masks) + " masks");
+    }
+    const size_t values = masks[0].size();
+    for (const auto& mask : masks) {
+        if (mask.size() != values) throw std::invalid_argument("Masks differ in length");
+    }
+    if ((values + slot_count() - 1) / slot_count() != count) {
+        throw std::invalid_argument("Expected one mask entry per value");
+    }
+    const seal::parms_id_type parms_id = column[0].parms_id();
+    auto context_data = context->get_context_data(parms_id);
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    auto next_level = context_data->next_context_data();
+    if (use_ckks && (!next_level || next_level->total_coeff_modulus_bit_count() <
+                                        std::log2(column[0].scale()) + result_headroom_bits)) {
+        throw std::invalid_argument("Masked sums need one more level than profile " + profile.name + " leaves");
+    }
+    
+    // Offset d: value i under mask (i - d) mod W, rotated left by d afterwards. Few offsets
+    // (few masks) split their chunks into enough shares to keep every thread busy
+    const size_t window = cross_sum_window(masks.size());
+    const size_t threads = thread_pool ? thread_pool->size() : 1;
+    const size_t shares = std::min(count, (threads + window - 1) / window);
+    std::vector<seal::Ciphertext> partials(window * shares);
+    parallel_for(partials.size(), [&](size_t task) {
+        const size_t offset = task / shares;
+        const size_t first = task % shares * count / shares;
+        const size_t last = (task % shares + 1) * count / shares;
+        const size_t end = std::min(values, last * slot_count());
+        std::vector<double> weights(end - std::min(end, first * slot_count()), 0.0);
+        bool any = false;
+        for (size_t i = first * slot_count(); i < end; i++) {
+            const size_t mask = (i + window - offset) % window;
+            if (mask < masks.size() && masks[mask][i] != 0) {
+                weights[i - first * slot_count()] = masks[mask][i];
+                any = true;
+            }
+        }
+        if (!any) return;
+        partials[task] = weighted_sum(column + first, encode_weights(weights, true, parms_id));
+    });
+    std::vector<seal::Ciphertext> offsets(window);
+    for (size_t task = 0; task < partials.size(); task++) {
+        if (partials[task].size() == 0) continue;
+        seal::Ciphertext& offset = offsets[task / shares];
+        if (offset.size() == 0) {
+            offset = std::move(partials[task]);
+        } else {
+            add_inplace(offset, partials[task]);
+        }
+    }
+    if (std::all_of(offsets.begin(), offsets.end(), [](const seal::Ciphertext& c) { return c.size() == 0; })) {
+        throw std::invalid_argument("Every mask is empty");
+    }
+    
+    // result = offsets[0] + rot(offsets[1] + rot(offsets[2] + ..., 1), 1)
+    auto keys = rotation_keys({1});
+    if (window > 1 && keys->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+    seal::Ciphertext result;
+    {
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+        seal::MemoryPoolHandle pool = scratch_pool();
+        for (size_t offset = window; offset-- > 0;) {
+            if (result.size() != 0) {
+                if (use_ckks) {
+                    evaluator->rotate_vector_inplace(result, 1, keys->galois_keys, pool);
+                } else {
+                    evaluator->rotate_rows_inplace(result, 1, keys->galois_keys, pool);
+                }
+                if (offsets[offset].size() != 0) evaluator->add_inplace(result, offsets[offset]);
+            } else if (offsets[offset].size() != 0) {
+                result = std::move(offsets[offset]);
+            }
+        }
+    }
+    if (window < slot_count()) sum_slots_inplace(result, window);
+    return result;
+}
+
+/**
+ * Slot-wise squares of a packed column, one ciphertext each
+ * 
+ * @param column Packed ciphertexts
+ * @param count Number of ciphertexts
+ * @return The squares, relinearized and (CKKS) rescaled or (BGV) switched down a level
+ * @throws std::invalid_argument for an empty column or a profile without depth
+ * @throws std::runtime_error without relinearization keys
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::squares(const seal::Ciphertext* column, size_t count) const {
+    HE_PROBE_METHOD("squares", count, ciphertext_bytes(column, count));
+    if (count == 0) throw std::invalid_argument("Cannot square empty vector of ciphertexts");
+    if (profile.depth < 1) {
+        throw std::invalid_argument("Squaring needs a profile with multiplicative depth >= 1, not " + profile.name);
+    }
+    if (!has_relin_keys()) throw std::runtime_error("Relinearization keys not loaded");
+
+    std::vector<seal::Ciphertext> result(count);
+    parallel_for(count, [&](size_t i) {
+        result[i] = multiply(column[i], column[i]);
+        relinearize_inplace(result[i]);
+        if (rescales()) rescale_inplace(result[i]);
+    });
+    return result;
+}
+
+/**
+ * Histogram of one-hot encodings packed bucket_count slots per value
+ * 
+ * @param ciphertexts Packed ciphertexts; value v's one-hot vector occupies slots
+ *                    v * bucket_count .. v * bucket_count + bucket_count - 1
+ *                    (slots may also hold amounts instead of 0/1, for per-bucket sums)
+ * @param count Number of ciphertexts
+ * @param bucket_count Buckets per value: a power of two, at most one BFV row (slots / 2)
+ * @return Packed ciphertext whose slot b (and every slot = b mod bucket_count)
+ *         holds bucket b's count
+ * @throws std::invalid_argument for bucket counts that do not divide the slots evenly
+ * 
+ * All buckets are accumulated at once: one sum over the ciphertexts, then
+ * log2(slots / bucket_count) rotate-and-add steps of sum_slots_inplace.
+ */
+seal::Ciphertext HomomorphicEncryption::histogram(const seal::Ciphertext* ciphertexts, size_t count,
+                                                  size_t bucket_count) const {
+    HE_PROBE_METHOD("histogram", count, ciphertext_bytes(ciphertexts, count));
+    const size_t max_buckets = use_ckks ? slot_count() : slot_count() / 2;
+    if (bucket_count == 0 || (bucket_count & (bucket_count - 1)) != 0 || bucket_count > max_buckets) {
+        throw std::invalid_argument("bucket_count must be a power of two up to " + std::to_string(max_buckets) +
+                                    " (pad with empty buckets)");
+    }
+    seal::Ciphertext result = sum(ciphertexts, count);
+    sum_slots_inplace(result, bucket_count);
+    return result;
+}
+
+/**
+ * Evaluate a PSI server set's polynomials at a receiver's query
+ * 
+ * @param query Per batch and bundle, the source powers' ciphertexts in ascending order
+ * @param count Number of ciphertexts: batches * bundles * source powers
+ * @return Per batch, bundle and partition, r * P(x) slot-wise for the partition's
+ *         polynomials P and fresh random nonzero factors r, coefficient form
+ * @throws std::invalid_argument for other schemes than BFV, a set built for another
+ *         slot count or plain modulus, or a count that is not whole batches
+ * 
+ * The powers each query bundle lacks are products of two lower ones
+ * (PsiParameters::power_plan), formed level by level so that a level's
+ * products for every bundle run concurrently, and relinearized. All powers
+ * are then moved to NTT form once, and every partition is one weighted_sum
+ * over them plus its constant term. The random factors are folded into the
+ * coefficients as they are encoded, so hiding the nonzero values costs no
+ * extra product (and no noise budget).
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::set_intersection(const seal::Ciphertext* query, size_t count,
+                                                                      const PsiServerSet& set) const {
+    HE_PROBE_METHOD("set_intersection", count, ciphertext_bytes(query, count));
+    if (use_ckks || use_bgv) throw std::invalid_argument("Set intersection needs BFV");
+    const uint64_t plain_modulus = this->plain_modulus();
+    if (set.slot_count() != slot_count() || set.plain_modulus() != plain_modulus) {
+        throw std::invalid_argument("The set was built for other parameters than profile " + profile.name);
+    }
+    const PsiParameters& parameters = set.parameters();
+    const std::vector<size_t> sources = parameters.source_powers();
+    if (count == 0 || count % (parameters.bundles * sources.size()) != 0) {
+        throw std::invalid_argument("Expected " + std::to_string(parameters.bundles * sources.size()) +
+                                    " ciphertexts (bundles times source powers) per batch");
+    }
+
+    // powers[q][j]: x^j of query bundle q
+    const size_t queries = count / sources.size();
+    const size_t degree = parameters.partition_size;
+    std::vector<std::vector<seal::Ciphertext>> powers(queries, std::vector<seal::Ciphertext>(degree + 1));
+    for (size_t q = 0; q < queries; q++) {
+        for (size_t s = 0; s < sources.size(); s++) powers[q][sources[s]] = query[q * sources.size() + s];
+    }
+    const std::vector<PsiParameters::Power> plan = parameters.power_plan();
+    for (size_t depth = 1; depth <= parameters.power_depth(); depth++) {
+        std::vector<size_t> level;
+        for (size_t j = 2; j <= degree; j++) {
+            if (plan[j].left && plan[j].depth == depth) level.push_back(j);
+        }
+        parallel_for(queries * level.size(), [&](size_t task) {
+            std::vector<seal::Ciphertext>& bundle = powers[task / level.size()];
+            const PsiParameters::Power& step = plan[level[task % level.size()]];
+            seal::Ciphertext product = multiply(bundle[step.left], bundle[step.right]);
+            relinearize_inplace(product);
+            bundle[step.left + step.right] = std::move(product);
+        });
+    }
+    parallel_for(queries * degree, [&](size_t task) {
+        evaluator->transform_to_ntt_inplace(powers[task / degree][task % degree + 1]);
+    });
+
+    const size_t partitions = set.partition_count();
+    const seal::parms_id_type parms_id = powers[0][1].parms_id();
+    std::vector<seal::Ciphertext> results(queries * partitions);
+    parallel_for(results.size(), [&](size_t task) {
+        const size_t q = task / partitions;
+        const size_t partition = task % partitions;
+        const size_t bundle = q % parameters.bundles;
+        std::vector<uint64_t> factors(slot_count());
+        std::shared_ptr<seal::UniformRandomGenerator> random =
+            seal::UniformRandomGeneratorFactory::DefaultFactory()->create();
+        random->generate(factors.size() * sizeof(uint64_t), reinterpret_cast<seal::seal_byte*>(factors.data()));
+        for (auto& factor : factors) factor = 1 + factor % (plain_modulus - 1);
+
+        std::vector<int64_t> slots(slot_count());
+        auto scaled = [&](size_t power, seal::Plaintext& plain) {
+            const uint32_t* coefficients = set.coefficients(bundle, partition, power);
+            for (size_t i = 0; i < slots.size(); i++) {
+                const uint64_t value = factors[i] * coefficients[i] % plain_modulus;
+                slots[i] = value > plain_modulus / 2 ? static_cast<int64_t>(value) - static_cast<int64_t>(plain_modulus)
+                                                     : static_cast<int64_t>(value);
+            }
+            bfv_encoder->encode(slots, plain);
+        };
+        std::vector<seal::Plaintext> weights(degree);
+        for (size_t power = 1; power <= degree; power++) {
+            scaled(power, weights[power - 1]);
+            if (!weights[power - 1].is_zero()) {
+                evaluator->transform_to_ntt_inplace(weights[power - 1], parms_id, scratch_pool());
+            }
+        }
+        results[task] = weighted_sum(powers[q].data() + 1, weights);
+        seal::Plaintext constant;
+        scaled(0, constant);
+        evaluator->add_plain_inplace(results[task], constant, scratch_pool());
+    });
+    return results;
+}
+
+/**
+ * Totals of every feature over the patients of packed ciphertexts, e.g.
+ * several CSV columns of the same rows uploaded together
+ * 
+ * @param ciphertexts Rows packed as PatientPacking(layout, features, slot_count())
+ * @param count Number of ciphertexts
+ * @return Packed ciphertext holding feature f's total in slot packing.total_slot(f)
+ * @throws std::invalid_argument for no ciphertexts, a packing of another slot
+ *         count, or (feature_major, CKKS and BGV) no level left for the mask
+ * 
+ * One sum over the ciphertexts, then one fold for all features at once.
+ * sample_major sums slots congruent modulo block_size, log2(slots /
+ * block_size) rotations, which leaves each total in every slot of its
+ * feature. feature_major sums each run of P patients, log2(P) rotations,
+ * which leaves partial sums over a run's later patients in its other slots;
+ * one multiply_plain by a mask of the total slots clears them, so the result
+ * reveals the totals only. The mask costs CKKS and BGV a level, as in
+ * group_sum. BFV and BGV totals are taken mod the plain modulus.
+ */
+seal::Ciphertext HomomorphicEncryption::feature_sums(const seal::Ciphertext* ciphertexts, size_t count,
+                                                     const PatientPacking& packing) const {
+    HE_PROBE_METHOD("feature_sums", count, ciphertext_bytes(ciphertexts, count));
+    if (packing.block_size() * packing.patients_per_ciphertext() != slot_count()) {
+        throw std::invalid_argument("Packing is for another slot count than " + std::to_string(slot_count()));
+    }
+    seal::Ciphertext result = sum(ciphertexts, count);
+    const size_t patients = packing.patients_per_ciphertext();
+    if (packing.layout() == PatientLayout::sample_major) {
+        if (packing.block_size() < slot_count()) sum_slots_inplace(result, packing.block_size());
+        return result;
+    }
+    if (packing.block_size() == 1) {
+        sum_slots_inplace(result);  // One feature: its run is every slot
+        return result;
+    }
+
+    if (!can_mask(result)) {
+        throw std::invalid_argument("feature_major totals need one more level than profile " + profile.name +
+                                    " leaves (use sample_major)");
+    }
+    sum_blocks_inplace(result, patients);
+
+    std::vector<double> mask(slot_count(), 0.0);
+    for (size_t f = 0; f < packing.feature_count(); f++) mask[packing.total_slot(f)] = 1.0;
+    mask_inplace(result, mask);
+    return result;
+}
+
+// Whether mask_inplace has a level to spend on the ciphertext (CKKS and BGV; BFV always)
+bool HomomorphicEncryption::can_mask(const seal::Ciphertext& encrypted) const {
+    auto context_data = context->get_context_data(encrypted.parms_id());
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    auto next_level = context_data->next_context_data();
+    if (use_ckks) {
+        return next_level &&
+               next_level->total_coeff_modulus_bit_count() >= std::log2(encrypted.scale()) + result_headroom_bits;
+    }
+    return !use_bgv || next_level;
+}
+
+/**
+ * Multiply slot-wise by a 0/1 mask, keeping the scale: under CKKS the mask
+ * is encoded at the scale of the prime the rescale drops, and BGV switches
+ * down a level as well, so both spend one level (see can_mask)
+ */
+void HomomorphicEncryption::mask_inplace(seal::Ciphertext& encrypted, const std::vector<double>& mask) const {
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::MemoryPoolHandle pool = scratch_pool();
+    if (use_ckks) {
+        auto context_data = context->get_context_data(encrypted.parms_id());
+        double dropped_prime = static_cast<double>(context_data->parms().coeff_modulus().back().value());
+        evaluator->multiply_plain_inplace(encrypted, *encoded(mask, false, dropped_prime, encrypted.parms_id()), pool);
+        evaluator->rescale_to_next_inplace(encrypted, pool);
+    } else if (use_bgv) {
+        evaluator->multiply_plain_inplace(encrypted, *encoded(mask, false, 0.0, encrypted.parms_id()), pool);
+        evaluator->mod_switch_to_next_inplace(encrypted, pool);
+    } else {
+        evaluator->multiply_plain_inplace(encrypted, *encoded(mask, false, 0.0, seal::parms_id_zero), pool);
+    }
+}
+
+/**
+ * Totals of many products and sums of packed columns, all in one ciphertext
+ * 
+ * @param columns Packed ciphertexts of each column, chunked alike (encrypt_vector):
+ *                columns[c] points at count ciphertexts
+ * @param count Ciphertexts per column
+ * @param terms Column pairs to total the slot-wise products of; b = CrossTerm::none
+ *              totals column a itself
+ * @return Packed ciphertext holding term k's total in slot k, and again every
+ *         cross_sum_window(terms.size()) slots
+ * @throws std::invalid_argument for no ciphertexts or terms, more terms than a
+ *         BFV row holds, a column index out of range, a profile without
+ *         multiplicative depth or (CKKS and BGV) with too few levels left
+ * @throws std::runtime_error if relinearization or Galois keys are not loaded
+ * 
+ * The products are taken concurrently on the thread pool, each term's chunks
+ * split over enough tasks to keep every thread busy, and summed
+ * unrelinearized, so each term is relinearized (and rescaled or switched
+ * down) once. Rather than folding the terms one by one, each is folded in
+ * windows of W slots (W the term count rounded up to a power of two, log2 W
+ * rotations), which leaves every window's total in its first slot; a mask
+ * keeps term k's window totals in the slots = k mod W, which still cover all
+ * the values, and one fold strided by W over the masked terms' sum completes
+ * every total. That is T log2(W) + log2(slots / W) rotations for T terms
+ * instead of T log2(slots). CKKS and BGV spend two levels, product and mask,
+ * as group_sum does (plain sums are switched down to the products' level and
+ * scale under the mask). BFV and BGV totals are taken mod the plain modulus.
+ */
+seal::Ciphertext HomomorphicEncryption::cross_sums(const std::vector<const seal::Ciphertext*>& columns, size_t count,
+                                                   const std::vector<CrossTerm>& terms) const {
+    HE_PROBE_METHOD("cross_sums", columns.size() * count, columns.empty() ? 0 : ciphertext_bytes(columns[0], count));
+    if (count == 0 || columns.empty()) throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+    const size_t max_terms = use_ckks ? slot_count() : slot_count() / 2;
+    if (terms.empty() || terms.size() > max_terms) {
+        throw std::invalid_argument("Expected between 1 and " + std::to_string(max_terms) + " terms");
+    }
+    const size_t window = cross_sum_window(terms.size());
+    std::vector<size_t> products;  // Terms multiplying two columns
+    for (size_t k = 0; k < terms.size(); k++) {
+        if (terms[k].a >= columns.size() || (terms[k].b != CrossTerm::none && terms[k].b >= columns.size())) {
+            throw std::invalid_argument("Term " + std::to_string(k) + " refers to a missing column");
+        }
+        if (terms[k].b != CrossTerm::none) products.push_back(k);
+    }
+    const seal::Ciphertext& first = columns[0][0];
+    auto context_data = context->get_context_data(first.parms_id());
+    if (!context_data) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    if (!products.empty()) {
+        if (profile.depth < 1) {
+            throw std::invalid_argument("Products need a profile with multiplicative depth >= 1, not " + profile.name);
+        }
+        if (!has_relin_keys()) throw std::runtime_error("Relinearization keys not loaded");
+    }
+    if (use_ckks) {
+        auto result_level = context_data->next_context_data() ? context_data->next_context_data()->next_context_data()
+                                                              : nullptr;
+        if (!result_level ||
+            result_level->total_coeff_modulus_bit_count() < std::log2(first.scale()) + result_headroom_bits) {
+            throw std::invalid_argument("Products need two more levels than profile " + profile.name + " leaves");
+        }
+    } else if (use_bgv && context_data->chain_index() < 2) {
+        throw std::invalid_argument("Products need two more levels than profile " + profile.name + " leaves");
+    }
+    
+    // Each product term's chunks in `groups` strided shares, one task per share
+    std::vector<seal::Ciphertext> sums(terms.size());
+    if (!products.empty()) {
+        const size_t threads = thread_pool ? thread_pool->size() : 1;
+        const size_t groups = std::min(count, (threads + products.size() - 1) / products.size());
+        std::vector<seal::Ciphertext> partials(products.size() * groups);
+        parallel_for(partials.size(), [&](size_t task) {
+            const CrossTerm& term = terms[products[task / groups]];
+            seal::Ciphertext& partial = partials[task];
+            for (size_t i = task % groups; i < count; i += groups) {
+                seal::Ciphertext product = multiply(columns[term.a][i], columns[term.b][i]);
+                if (partial.size() == 0) {
+                    partial = std::move(product);
+                } else {
+                    add_inplace(partial, product);
+                }
+            }
+        });
+        parallel_for(products.size(), [&](size_t p) {
+            seal::Ciphertext& total = sums[products[p]];
+            total = std::move(partials[p * groups]);
+            for (size_t g = 1; g < groups; g++) add_inplace(total, partials[p * groups + g]);
+            relinearize_inplace(total);
+            if (rescales()) rescale_inplace(total);
+        });
+    }
+    for (size_t k = 0; k < terms.size(); k++) {
+        if (terms[k].b == CrossTerm::none) sums[k] = sum(columns[terms[k].a], count);
+    }
+    
+    // Every term joins the products at their level and scale under the mask
+    const seal::Ciphertext& lowest = products.empty() ? sums[0] : sums[products[0]];
+    const seal::parms_id_type parms_id = lowest.parms_id();
+    const double scale = lowest.scale();
+    const double dropped_prime =
+        use_ckks ? static_cast<double>(context->get_context_data(parms_id)->parms().coeff_modulus().back().value())
+                 : 0.0;
+    parallel_for(terms.size(), [&](size_t term) {
+        seal::Ciphertext& encrypted = sums[term];
+        sum_blocks_inplace(encrypted, window);
+        
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+        seal::MemoryPoolHandle pool = scratch_pool();
+        std::vector<double> mask(slot_count(), 0.0);
+        for (size_t slot = term; slot < mask.size(); slot += window) mask[slot] = 1.0;
+        if (use_ckks) {
+            evaluator->mod_switch_to_inplace(encrypted, parms_id, pool);
+            const double mask_scale = scale * dropped_prime / encrypted.scale();
+            evaluator->multiply_plain_inplace(encrypted, *encoded(mask, false, mask_scale, parms_id), pool);
+            evaluator->rescale_to_next_inplace(encrypted, pool);
+            encrypted.scale() = scale;
+        } else if (use_bgv) {
+            evaluator->mod_switch_to_inplace(encrypted, parms_id, pool);
+            evaluator->multiply_plain_inplace(encrypted, *encoded(mask, false, 0.0, parms_id), pool);
+            evaluator->mod_switch_to_next_inplace(encrypted, pool);
+        } else {
+            evaluator->multiply_plain_inplace(encrypted, *encoded(mask, false, 0.0, seal::parms_id_zero), pool);
+        }
+    });
+    seal::Ciphertext result = sum(sums);
+    if (window < slot_count()) sum_slots_inplace(result, window);
+    return result;
+}
+
+/**
+ * Running totals (prefix sums) of a series packed in chunks, e.g. admissions
+ * per day over a year
+ * 
+ * @param ciphertexts Chunks of the series in order, prefix_chunk_size() values each
+ *                    in the first slots and zeros in the others (BFV and BGV: in the
+ *                    first row), as mini-backend's /encrypt_vector packs "chunk_size"
+ * @param count Number of ciphertexts
+ * @return One ciphertext per chunk; slot i of result c holds the total of the series up
+ *         to value c * prefix_chunk_size() + i. The other slots hold partial sums
+ * @throws std::invalid_argument for no ciphertexts
+ * @throws std::runtime_error without the Galois keys of rotation operation "prefix_sum"
+ * 
+ * Each chunk is scanned Hillis-Steele style, adding the chunk rotated right
+ * by 1, 2, 4, ... slots: log2(chunk) rotations. The chunk fills only half a
+ * row, so what a rotation wraps around is the zero half and no masks are
+ * needed: the scan costs no levels and no plaintext products. Every chunk's
+ * total (sum_slots of the input, log2(row) rotations) is then carried into
+ * all later chunks by additions. Chunks are scanned concurrently on the
+ * thread pool. BFV and BGV totals are taken mod the plain modulus.
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::prefix_sums(const seal::Ciphertext* ciphertexts,
+                                                                 size_t count) const {
+    HE_PROBE_METHOD("prefix_sums", count, ciphertext_bytes(ciphertexts, count));
+    if (count == 0) throw std::invalid_argument("Cannot scan empty vector of ciphertexts");
+    const std::vector<int> steps = scan_steps(prefix_chunk_size());
+    auto keys = rotation_keys(steps);
+
+    std::vector<seal::Ciphertext> results(ciphertexts, ciphertexts + count);
+    std::vector<seal::Ciphertext> totals(count > 1 ? count - 1 : 0);
+    parallel_for(count, [&](size_t i) {
+        // The last chunk's total is carried nowhere
+        if (i + 1 < count) {
+            totals[i] = ciphertexts[i];
+            sum_slots_inplace(totals[i]);
+        }
+        scan_inplace(results[i], steps, *keys);
+    });
+
+    // Carry c: the totals of chunks 0 .. c - 1
+    for (size_t c = 1; c < totals.size(); c++) add_inplace(totals[c], totals[c - 1]);
+    parallel_for(totals.size(), [&](size_t c) { add_inplace(results[c + 1], totals[c]); });
+    return results;
+}
+
+// Right rotations by 1, 2, 4, ... below width, checked against the loaded Galois keys
+std::vector<int> HomomorphicEncryption::scan_steps(size_t width) const {
+    std::vector<int> steps;
+    for (size_t step = 1; step < width; step <<= 1) steps.push_back(-static_cast<int>(step));
+    for (int step : steps) {
+        if (!has_galois_key(step)) {
+            throw std::runtime_error("Galois keys for prefix sums not loaded (rotation operation prefix_sum)");
+        }
+    }
+    return steps;
+}
+
+// Hillis-Steele scan: slot i gains slots i - 1, i - 2, ..., i - (2 * last step - 1)
+void HomomorphicEncryption::scan_inplace(seal::Ciphertext& encrypted, const std::vector<int>& steps,
+                                         const KeySet& keys) const {
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::MemoryPoolHandle pool = scratch_pool();
+    seal::Ciphertext rotated(pool);
+    for (int step : steps) {
+        if (use_ckks) {
+            evaluator->rotate_vector(encrypted, step, keys.galois_keys, rotated, pool);
+        } else {
+            evaluator->rotate_rows(encrypted, step, keys.galois_keys, rotated, pool);
+        }
+        evaluator->add_inplace(encrypted, rotated);
+    }
+}
+
+/**
+ * Cumulative bucket counts of a histogram, for percentiles and medians
+ * 
+ * @param histogram histogram() result over bucket_count buckets
+ * @param bucket_count Its bucket count, at most prefix_chunk_size()
+ * @return Ciphertext whose slot b holds the count of buckets 0 .. b, for
+ *         b < bucket_count, and zeros in the other slots
+ * @throws std::invalid_argument for other bucket counts or (CKKS and BGV) no
+ *         level left for the mask
+ * @throws std::runtime_error without the Galois keys of rotation operation "prefix_sum"
+ * 
+ * histogram() leaves bucket b's count in every slot = b mod bucket_count. One
+ * multiply_plain keeps the first bucket_count slots and clears the others,
+ * costing CKKS and BGV a level as in feature_sums. prefix_sums' scan then
+ * adds every bucket into the later ones with log2(bucket_count) rotations.
+ * Whatever a rotation wraps around comes from the cleared slots. The key
+ * holder decrypts this one ciphertext and reads any number of percentiles
+ * off it, with no further passes over the column.
+ */
+seal::Ciphertext HomomorphicEncryption::cumulative_counts(const seal::Ciphertext& histogram,
+                                                          size_t bucket_count) const {
+    HE_PROBE_METHOD("cumulative_counts", 1, ciphertext_bytes(&histogram, 1));
+    const size_t max_buckets = prefix_chunk_size();
+    if (bucket_count == 0 || (bucket_count & (bucket_count - 1)) != 0 || bucket_count > max_buckets) {
+        throw std::invalid_argument("Cumulative counts need a power of two of buckets up to " +
+                                    std::to_string(max_buckets));
+    }
+    if (!can_mask(histogram)) {
+        throw std::invalid_argument("Cumulative counts need one more level than profile " + profile.name + " leaves");
+    }
+    const std::vector<int> steps = scan_steps(bucket_count);
+    auto keys = rotation_keys(steps);
+
+    seal::Ciphertext result = histogram;
+    std::vector<double> mask(slot_count(), 0.0);
+    std::fill(mask.begin(), mask.begin() + bucket_count, 1.0);
+    mask_inplace(result, mask);
+    scan_inplace(result, steps, *keys);
+    return result;
+}
+
+/**
+ * Sums for the covariance and correlation of two packed columns, in one ciphertext
+ * 
+ * @param x, y Packed ciphertexts of the two columns, chunked alike (encrypt_vector)
+ * @param count Ciphertexts per column
+ * @return Packed ciphertext holding sum(x y), sum(x), sum(y), sum(x^2) and sum(y^2)
+ *         in slots 0 to 4 (CovarianceTerm), and again every 8 slots
+ * @throws As cross_sums
+ * 
+ * cross_sums of the five terms: 15 + log2(slots / 8) rotations instead of
+ * 5 log2(slots). After decryption cov = sum(x y) / n - sum(x) sum(y) / n^2,
+ * and the correlation divides it by the standard deviations from the squares.
+ */
+seal::Ciphertext HomomorphicEncryption::covariance(const seal::Ciphertext* x, const seal::Ciphertext* y,
+                                                   size_t count) const {
+    std::vector<CrossTerm> terms(covariance_terms);
+    terms[sum_xy] = {0, 1};
+    terms[sum_x] = {0, CrossTerm::none};
+    terms[sum_y] = {1, CrossTerm::none};
+    terms[sum_x2] = {0, 0};
+    terms[sum_y2] = {1, 1};
+    return cross_sums({x, y}, count, terms);
+}
+
+/**
+ * Levels a CKKS ciphertext can still spend: down to compact_parms_id, the
+ * lowest level that keeps result_headroom_bits above its scale
+ */
+size_t HomomorphicEncryption::spare_levels(const seal::Ciphertext& encrypted) const {
+    auto current = context->get_context_data(encrypted.parms_id());
+    if (!current) throw std::invalid_argument("Ciphertext is not valid for these parameters");
+    return current->chain_index() - context->get_context_data(compact_parms_id(encrypted))->chain_index();
+}
+
+/**
+ * Multiply by a constant and land on an exact level and scale
+ * 
+ * @param encrypted CKKS ciphertext above chain_index; switched down to
+ *                  chain_index + 1, multiplied and rescaled once
+ * @param value Nonzero constant
+ * @param chain_index Level of the result
+ * @param target_scale Scale of the result: the constant is encoded at
+ *                     target_scale * dropped prime / encrypted.scale()
+ */
+void HomomorphicEncryption::multiply_constant_to(seal::Ciphertext& encrypted, double value, size_t chain_index,
+                                                 double target_scale) const {
+    mod_switch_to_inplace(encrypted, chain_index + 1);
+    multiply_constant_inplace(encrypted, value, target_scale * dropped_prime(chain_index + 1) / encrypted.scale());
+    rescale_inplace(encrypted);
+    encrypted.scale() = target_scale;
+}
+
+/**
+ * Multiply a ciphertext by a constant without rescaling
+ * 
+ * BFV and BGV ciphertexts are multiplied by the integer constant directly,
+ * coefficient by coefficient, in whichever form they are (no plaintext is
+ * encoded and no NTT is run).
+ * 
+ * @param encrypted Ciphertext; for CKKS its scale becomes encrypted.scale() * value_scale
+ * @param value Nonzero constant; an integer for BFV and BGV
+ * @param value_scale Scale the constant is encoded at (CKKS only)
+ * @throws std::invalid_argument for a fractional BFV or BGV constant
+ */
+void HomomorphicEncryption::multiply_constant_inplace(seal::Ciphertext& encrypted, double value,
+                                                      double value_scale) const {
+    HE_PROBE_METHOD("multiply_constant", 1, ciphertext_bytes(encrypted));
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    if (!use_ckks) {
+        evaluator->multiply_scalar_inplace(encrypted, plain_scalar(value));
+        return;
+    }
+    evaluator->multiply_plain_inplace(encrypted, *encoded(value, value_scale, encrypted.parms_id()), scratch_pool());
+}
+
+/**
+ * Add a constant to every slot of a ciphertext (no level is spent)
+ * 
+ * BFV and BGV constants are integers added without encoding a plaintext.
+ * 
+ * @throws std::invalid_argument for a fractional BFV or BGV constant
+ */
+void HomomorphicEncryption::add_constant_inplace(seal::Ciphertext& encrypted, double value) const {
+    HE_PROBE_METHOD("add_constant", 1, ciphertext_bytes(encrypted));
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    if (!use_ckks) {
+        evaluator->add_scalar_inplace(encrypted, plain_scalar(value));
+        return;
+    }
+    evaluator->add_plain_inplace(encrypted, *encoded(value, encrypted.scale(), encrypted.parms_id()));
+}
+
+/**
+ * Add a plaintext vector slot-wise to a ciphertext (missing slots are 0)
+ * 
+ * A vector with the same value in every slot is added as that constant.
+ * 
+ * @throws std::invalid_argument for fractional BFV or BGV values
+ */
+void HomomorphicEncryption::add_constant_inplace(seal::Ciphertext& encrypted, const std::vector<double>& values) const {
+    if (values.size() == slot_count() &&
+        std::all_of(values.begin(), values.end(), [&](double value) { return value == values[0]; })) {
+        add_constant_inplace(encrypted, values[0]);
+        return;
+    }
+    HE_PROBE_METHOD("add_constant", 1, ciphertext_bytes(encrypted));
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    if (!use_ckks) {
+        // SEAL adds BFV and BGV plaintexts in coefficient form
+        for (double value : values) plain_scalar(value);
+        evaluator->add_plain_inplace(encrypted, *encoded(values, false, 0.0, seal::parms_id_zero), scratch_pool());
+        return;
+    }
+    evaluator->add_plain_inplace(encrypted, *encoded(values, false, encrypted.scale(), encrypted.parms_id()));
+}
+
+/**
+ * factor * sign(x) + offset, approximated by the composite sign_schedule(levels)
+ * 
+ * @param x CKKS ciphertext with values in [-1, 1]
+ * @param levels Levels to spend (at least 2)
+ * @param result_scale Scale of the result; intermediate stages keep x's scale
+ * @return Ciphertext levels below x
+ */
+seal::Ciphertext HomomorphicEncryption::approximate_sign(const seal::Ciphertext& x, size_t levels, double result_scale,
+                                                         double factor, double offset) const {
+    auto stages = sign_schedule(levels);
+    seal::Ciphertext value = x;
+    for (size_t i = 0; i < stages.size(); i++) {
+        std::vector<double> coefficients = *stages[i];
+        double stage_scale = x.scale();
+        if (i + 1 == stages.size()) {
+            for (auto& coefficient : coefficients) coefficient *= factor;
+            coefficients[0] += offset;
+            stage_scale = result_scale;
+        }
+        value = PolynomialEvaluator(*this, std::move(value)).evaluate(coefficients, stage_scale);
+    }
+    return value;
+}
+
+/**
+ * max(a, b) = (a + b) / 2 + (a - b) * sign((a - b) / (2 bound)) / 2
+ * 
+ * @param levels Levels to spend (at least 4): one to normalize a - b, one for
+ *               the product with the sign, the rest on the sign itself
+ * @return Ciphertext levels below the lower of a and b, at a's scale
+ */
+seal::Ciphertext HomomorphicEncryption::max_pair(const seal::Ciphertext& a, const seal::Ciphertext& b, double bound,
+                                                 size_t levels) const {
+    seal::Ciphertext difference = a;
+    seal::Ciphertext other = b;
+    match_level_inplace(difference, other);
+    seal::Ciphertext sum = difference;
+    evaluator->add_inplace(sum, other);
+    evaluator->sub_inplace(difference, other);
+    
+    const double scale = difference.scale();
+    const size_t level = context->get_context_data(difference.parms_id())->chain_index();
+    if (levels < 4 || levels > level) {
+        throw std::invalid_argument("Comparison needs between 4 and " + std::to_string(level) + " levels");
+    }
+    const size_t sign_level = level - levels + 1;
+    
+    seal::Ciphertext normalized = difference;
+    multiply_constant_to(normalized, 1.0 / (2.0 * bound), level - 1, scale);
+    
+    // Half the sign, at the scale that brings the product with a - b back to a's scale
+    auto sign_context = level_at(*context, sign_level);
+    const double dropped_prime = static_cast<double>(sign_context->parms().coeff_modulus().back().value());
+    seal::Ciphertext half_sign = approximate_sign(normalized, levels - 2, dropped_prime, 0.5, 0.0);
+    if (half_sign.parms_id() != sign_context->parms_id()) throw std::logic_error("Sign approximation missed its level");
+    
+    evaluator->mod_switch_to_inplace(difference, half_sign.parms_id(), scratch_pool());
+    seal::Ciphertext result = multiply(difference, half_sign);
+    relinearize_inplace(result);
+    rescale_inplace(result);
+    result.scale() = scale;
+    
+    multiply_constant_to(sum, 0.5, sign_level - 1, scale);
+    evaluator->add_inplace(result, sum);
+    return result;
+}
+
+/**
+ * Approximate maximum of two CKKS ciphertexts, slot by slot
+ * 
+ * @param a, b Ciphertexts with values in [-bound, bound], at one scale
+ * @param bound Bound on the magnitude of the values
+ * @return Every level a and b have above the result headroom is spent; the
+ *         error is |a - b| times that of the sign approximation (see
+ *         sign_schedule with two levels fewer), so close values come out near
+ *         their mean and distant ones near the larger
+ * @throws std::invalid_argument for BFV, a nonpositive bound or fewer than 4 levels
+ */
+seal::Ciphertext HomomorphicEncryption::max(const seal::Ciphertext& a, const seal::Ciphertext& b, double bound) const {
+    HE_PROBE_METHOD("max", 2, ciphertext_bytes(a) + ciphertext_bytes(b));
+    if (!use_ckks) throw std::invalid_argument("Comparisons need CKKS");
+    if (!(bound > 0)) throw std::invalid_argument("bound must be positive");
+    return max_pair(a, b, bound, std::min(spare_levels(a), spare_levels(b)));
+}
+
+// min(a, b) = -max(-a, -b)
+seal::Ciphertext HomomorphicEncryption::min(const seal::Ciphertext& a, const seal::Ciphertext& b, double bound) const {
+    HE_PROBE_METHOD("min", 2, ciphertext_bytes(a) + ciphertext_bytes(b));
+    seal::Ciphertext negated_a = a;
+    seal::Ciphertext negated_b = b;
+    evaluator->negate_inplace(negated_a);
+    evaluator->negate_inplace(negated_b);
+    seal::Ciphertext result = max(negated_a, negated_b, bound);
+    evaluator->negate_inplace(result);
+    return result;
+}
+
+/**
+ * Approximate maximum (or minimum) of packed values: a tournament of max_pair
+ * rounds, first across the ciphertexts, then across the slots by rotations
+ * 
+ * @param ciphertexts Packed ciphertexts (e.g. from encrypt_vector), all at one level
+ * @param count Number of ciphertexts
+ * @param value_count Number of values (0: every slot is a value); the zero
+ *                    padding after them is replaced by -bound (+bound for min)
+ * @param bound Bound on the magnitude of the values
+ * @param maximum Maximum, or minimum
+ * @param rounds If set, receives the number of tournament rounds
+ * @return Ciphertext whose slot 0 holds the result
+ * @throws std::invalid_argument for BFV, a value_count the ciphertexts cannot
+ *         hold, or fewer than 4 levels per round
+ * 
+ * log2(count) + log2(values per ciphertext) rounds (rounded up), each spending
+ * an equal share of the levels, so the depth is known from the count alone.
+ * Rounds of many ciphertexts run concurrently on the thread pool. Needs
+ * Galois keys if a ciphertext holds more than one value.
+ */
+seal::Ciphertext HomomorphicEncryption::extremum(const seal::Ciphertext* ciphertexts, size_t count,
+                                                 size_t value_count, double bound, bool maximum,
+                                                 size_t* rounds) const {
+    HE_PROBE_METHOD("extremum", count, ciphertext_bytes(ciphertexts, count));
+    if (!use_ckks) throw std::invalid_argument("Comparisons need CKKS");
+    if (!(bound > 0)) throw std::invalid_argument("bound must be positive");
+    if (count == 0) throw std::invalid_argument("Cannot compare empty vector of ciphertexts");
+    const size_t slots = slot_count();
+    if (value_count == 0) value_count = count * slots;
+    if (value_count > count * slots || value_count <= (count - 1) * slots) {
+        throw std::invalid_argument("Expected between " + std::to_string((count - 1) * slots + 1) + " and " +
+                                    std::to_string(count * slots) + " values");
+    }
+    
+    std::vector<seal::Ciphertext> contenders(ciphertexts, ciphertexts + count);
+    const size_t padded = count * slots - value_count;
+    if (!maximum) {
+        for (auto& ciphertext : contenders) evaluator->negate_inplace(ciphertext);
+    }
+    if (padded > 0) {
+        std::vector<double> padding(slots, -bound);
+        std::fill(padding.begin(), padding.begin() + (slots - padded), 0.0);
+        add_constant_inplace(contenders.back(), padding);
+    }
+    
+    const size_t span = count > 1 ? slots : (size_t(1) << ceil_log2(value_count));
+    const size_t round_count = ceil_log2(count) + ceil_log2(span);
+    if (rounds) *rounds = round_count;
+    const size_t levels = round_count > 0 ? spare_levels(contenders[0]) / round_count : 0;
+    if (round_count > 0 && levels < 4) {
+        throw std::invalid_argument("Comparing " + std::to_string(value_count) + " values takes " +
+                                    std::to_string(round_count) + " rounds of at least 4 levels; profile " +
+                                    profile.name + " leaves " + std::to_string(spare_levels(contenders[0])));
+    }
+    std::vector<int> steps;
+    for (size_t step = span / 2; step > 0; step >>= 1) steps.push_back(static_cast<int>(step));
+    auto keys = rotation_keys(steps);
+    if (span > 1 && keys->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+    
+    while (contenders.size() > 1) {
+        std::vector<seal::Ciphertext> next((contenders.size() + 1) / 2);
+        parallel_for(contenders.size() / 2, [&](size_t i) {
+            next[i] = max_pair(contenders[2 * i], contenders[2 * i + 1], bound, levels);
+        });
+        if (contenders.size() % 2 == 1) next.back() = std::move(contenders.back());
+        contenders = std::move(next);
+    }
+    
+    seal::Ciphertext result = std::move(contenders[0]);
+    for (size_t step = span / 2; step > 0; step >>= 1) {
+        seal::Ciphertext rotated;
+        {
+            metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+            evaluator->rotate_vector(result, static_cast<int>(step), keys->galois_keys, rotated, scratch_pool());
+        }
+        result = max_pair(result, rotated, bound, levels);
+    }
+    if (!maximum) evaluator->negate_inplace(result);
+    return result;
+}
+
+/**
+ * Approximate number of packed values greater than a threshold, i.e. the sum
+ * of (1 + sign((x - threshold) / (2 bound))) / 2 over the values
+ * 
+ * @param ciphertexts Packed ciphertexts (e.g. from encrypt_vector), all at one level
+ * @param count Number of ciphertexts
+ * @param value_count Number of values (0: every slot is a value)
+ * @param threshold Value to compare with, in [-bound, bound]
+ * @param bound Bound on the magnitude of the values
+ * @return Ciphertext whose every slot holds the count; round it after decryption
+ * @throws std::invalid_argument for BFV, a value_count the ciphertexts cannot
+ *         hold, or fewer than 3 levels
+ * 
+ * One level normalizes, the rest go to the sign (see sign_schedule): values
+ * within that schedule's |x| / (2 bound) of the threshold count partially,
+ * values equal to it count half. The padding slots are moved to -1 before the
+ * sign and their (known) contribution is subtracted from the total. Each
+ * ciphertext's polynomials run concurrently on the thread pool. Needs Galois keys.
+ */
+seal::Ciphertext HomomorphicEncryption::count_greater(const seal::Ciphertext* ciphertexts, size_t count,
+                                                      size_t value_count, double threshold, double bound) const {
+    HE_PROBE_METHOD("count_greater", count, ciphertext_bytes(ciphertexts, count));
+    if (!use_ckks) throw std::invalid_argument("Comparisons need CKKS");
+    if (!(bound > 0) || std::abs(threshold) > bound) {
+        throw std::invalid_argument("bound must be positive and at least |threshold|");
+    }
+    if (count == 0) throw std::invalid_argument("Cannot compare empty vector of ciphertexts");
+    const size_t slots = slot_count();
+    if (value_count == 0) value_count = count * slots;
+    if (value_count > count * slots || value_count <= (count - 1) * slots) {
+        throw std::invalid_argument("Expected between " + std::to_string((count - 1) * slots + 1) + " and " +
+                                    std::to_string(count * slots) + " values");
+    }
+    const size_t levels = spare_levels(ciphertexts[0]);
+    if (levels < 3) {
+        throw std::invalid_argument("Threshold counts need 3 levels; profile " + profile.name + " leaves " +
+                                    std::to_string(levels));
+    }
+    if (rotation_keys(slot_sum_steps())->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+    
+    const size_t padded = count * slots - value_count;
+    const double shift = -threshold / (2.0 * bound);
+    std::vector<seal::Ciphertext> indicators(count);
+    parallel_for(count, [&](size_t i) {
+        seal::Ciphertext normalized = ciphertexts[i];
+        const size_t level = context->get_context_data(normalized.parms_id())->chain_index();
+        multiply_constant_to(normalized, 1.0 / (2.0 * bound), level - 1, ciphertexts[i].scale());
+        if (i + 1 == count && padded > 0) {
+            std::vector<double> shifts(slots, -1.0);
+            std::fill(shifts.begin(), shifts.begin() + (slots - padded), shift);
+            add_constant_inplace(normalized, shifts);
+        } else {
+            add_constant_inplace(normalized, shift);
+        }
+        indicators[i] = approximate_sign(normalized, levels - 1, ciphertexts[i].scale(), 0.5, 0.5);
+    });
+    
+    seal::Ciphertext result = sum(indicators);
+    sum_slots_inplace(result);
+    if (padded > 0) {
+        double padding_total = static_cast<double>(padded) * (0.5 + 0.5 * approximate_sign_plain(-1.0, levels - 1));
+        add_constant_inplace(result, -padding_total);
+    }
+    return result;
+}
+
+/**
+ * Evaluate a polynomial slot-wise in CKKS ciphertexts with PolynomialEvaluator
+ * 
+ * @param ciphertexts CKKS ciphertexts
+ * @param count Number of ciphertexts
+ * @param coefficients Coefficients of x^0, x^1, ... (not constant)
+ * @param stats If set, receives the counts of the first ciphertext's evaluation
+ * @return p(x) for each ciphertext, at its input's scale and about log2(degree)
+ *         levels lower (PolynomialEvaluator::depth)
+ * @throws std::invalid_argument for BFV, no ciphertexts, a constant polynomial
+ *         or too few levels
+ * 
+ * Ciphertexts are evaluated concurrently on the thread pool.
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::evaluate_polynomial(const seal::Ciphertext* ciphertexts,
+                                                                         size_t count,
+                                                                         const std::vector<double>& coefficients,
+                                                                         PolynomialStats* stats) const {
+    HE_PROBE_METHOD("evaluate_polynomial", count, ciphertext_bytes(ciphertexts, count));
+    if (!use_ckks) throw std::invalid_argument("Polynomial evaluation needs CKKS");
+    if (count == 0) throw std::invalid_argument("Cannot evaluate empty vector of ciphertexts");
+    
+    std::vector<seal::Ciphertext> results(count);
+    parallel_for(count, [&](size_t i) {
+        PolynomialEvaluator polynomial(*this, ciphertexts[i]);
+        results[i] = polynomial.evaluate(coefficients);
+        if (i == 0 && stats) *stats = polynomial.stats();
+    });
+    return results;
+}
+
+/**
+ * The cheapest InverseApproximation of f(x) within levels, for u = x / high
+ */
+InverseApproximation HomomorphicEncryption::plan_inverse(const seal::Ciphertext& u, double low, double high,
+                                                         bool square_root, size_t levels, double tolerance) const {
+    PolynomialEvaluator guess(*this, u);
+    return InverseApproximation::plan(low, high, square_root, levels, tolerance,
+                                      [&](const std::vector<double>& coefficients) {
+                                          return guess.depth(coefficients);
+                                      });
+}
+
+/**
+ * f(x) = 1/x or 1/sqrt(x) from u = x / high, plan.depth() levels below u
+ * 
+ * Every Newton step takes two levels and keeps u's scale exactly: the
+ * constant multiple of u in it is encoded at the scale that makes the step's
+ * last rescale land there. Products are rescaled before they are
+ * relinearized, so each key switch runs on one prime fewer. The last step
+ * also multiplies by 1 / high (1 / sqrt(high)); without steps, the guess does.
+ */
+seal::Ciphertext HomomorphicEncryption::newton_inverse(const seal::Ciphertext& u,
+                                                       const InverseApproximation& plan) const {
+    const double scale = u.scale();
+    const double factor = plan.square_root ? 1.0 / std::sqrt(plan.high) : 1.0 / plan.high;
+    std::vector<double> coefficients = plan.guess;
+    if (plan.iterations == 0) {
+        for (auto& coefficient : coefficients) coefficient *= factor;
+    }
+    seal::Ciphertext y = PolynomialEvaluator(*this, u).evaluate(coefficients, scale);
+
+    for (size_t step = 0; step < plan.iterations; step++) {
+        const double c = step + 1 == plan.iterations ? factor : 1.0;
+        const size_t level = chain_index(y);
+        const double prime = dropped_prime(level);
+        const double next_prime = dropped_prime(level - 1);
+        seal::Ciphertext scaled = u;
+        seal::Ciphertext next;
+        if (!plan.square_root) {
+            // c y (2 - u y): -c u y + 2 c at the scale of the prime the product with y drops
+            multiply_constant_to(scaled, -c, level, prime * next_prime / scale);
+            seal::Ciphertext correction = multiply(scaled, y);
+            rescale_inplace(correction);
+            relinearize_inplace(correction);
+            correction.scale() = next_prime;
+            add_constant_inplace(correction, 2.0 * c);
+            mod_switch_to_inplace(y, level - 1);
+            next = multiply(y, correction);
+        } else {
+            // c y (3 - u y^2) / 2 = y^2 (-c u y / 2) + 3 c y / 2
+            seal::Ciphertext square = multiply(y, y);
+            rescale_inplace(square);
+            relinearize_inplace(square);
+            multiply_constant_to(scaled, -0.5 * c, level, prime * prime * next_prime / (scale * scale));
+            seal::Ciphertext cubic = multiply(y, scaled);
+            rescale_inplace(cubic);
+            relinearize_inplace(cubic);
+            next = multiply(square, cubic);
+            multiply_constant_to(y, 1.5 * c, level - 2, scale);
+        }
+        rescale_inplace(next);
+        relinearize_inplace(next);
+        next.scale() = scale;
+        if (plan.square_root) evaluator->add_inplace(next, y);
+        y = std::move(next);
+    }
+    return y;
+}
+
+/**
+ * 1/x or 1/sqrt(x) slot-wise, e.g. to divide by an encrypted count or
+ * standard deviation without a round trip to the key holder
+ * 
+ * @param ciphertexts CKKS ciphertexts, all at one level, every slot in [low, high]
+ * @param count Number of ciphertexts
+ * @param low, high Known range of the values (0 < low < high); slots outside
+ *                  it, e.g. zero padding, come out as garbage
+ * @param square_root 1/sqrt(x) instead of 1/x
+ * @param tolerance Largest acceptable relative error, in the clear (CKKS noise adds ~2^-(scale bits - 20))
+ * @param plan If set, receives the plan the ciphertexts were evaluated with
+ * @return f(x) for each ciphertext, at its input's scale, 1 + plan->depth() levels lower
+ * @throws std::invalid_argument for BFV, no ciphertexts, a bad range, or a
+ *         range too wide for the levels left (InverseApproximation::plan)
+ * 
+ * One level scales x into (0, 1], the rest is InverseApproximation's: a
+ * polynomial guess (PolynomialEvaluator) and Newton steps of 2 levels and
+ * 2 (1/x) or 3 (1/sqrt(x)) ciphertext products each. Ciphertexts run
+ * concurrently on the thread pool. Needs relinearization keys.
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::inverse(const seal::Ciphertext* ciphertexts, size_t count,
+                                                             double low, double high, bool square_root,
+                                                             double tolerance, InverseApproximation* plan) const {
+    HE_PROBE_METHOD("inverse", count, ciphertext_bytes(ciphertexts, count));
+    if (!use_ckks) throw std::invalid_argument("Inverses need CKKS");
+    if (count == 0) throw std::invalid_argument("Cannot invert empty vector of ciphertexts");
+    if (!has_relin_keys()) throw std::runtime_error("Relinearization keys not loaded");
+    if (!(low > 0) || !(high > low)) throw std::invalid_argument("Inverse needs a range 0 < low < high");
+    const size_t levels = spare_levels(ciphertexts[0]);
+    if (levels < 2) {
+        throw std::invalid_argument("Inverses need at least 2 levels; profile " + profile.name + " leaves " +
+                                    std::to_string(levels));
+    }
+
+    std::vector<seal::Ciphertext> scaled(ciphertexts, ciphertexts + count);
+    const size_t level = chain_index(scaled[0]);
+    parallel_for(count, [&](size_t i) {
+        multiply_constant_to(scaled[i], 1.0 / high, level - 1, ciphertexts[i].scale());
+    });
+    InverseApproximation chosen = plan_inverse(scaled[0], low, high, square_root, levels - 1, tolerance);
+    std::vector<seal::Ciphertext> results(count);
+    parallel_for(count, [&](size_t i) { results[i] = newton_inverse(scaled[i], chosen); });
+    if (plan) *plan = std::move(chosen);
+    return results;
+}
+
+/**
+ * z-scores of a packed column: (x - mean) / sd in every value's slot
+ * 
+ * @param column Packed CKKS ciphertexts (encrypt_vector), all at one level
+ * @param count Number of ciphertexts
+ * @param value_count Number of values (0: every slot is a value); padding slots
+ *                    must be zero and come out as -mean / sd
+ * @param variance_low, variance_high Known range of the population variance
+ * @param tolerance, plan As inverse(), for 1/sd
+ * @param reserve Levels to leave unspent, e.g. for a polynomial of the z-scores
+ * @return One ciphertext per input, at its scale, 3 + plan->depth() levels lower
+ * @throws std::invalid_argument for BFV, a value_count the ciphertexts cannot
+ *         hold, or too few levels
+ * 
+ * The mean and the variance stay encrypted: slot sums of the column and of
+ * its squares, the variance scaled by 1 / variance_high on the way (folded
+ * into the division by the count, so it costs no level of its own), 1/sqrt
+ * of it as inverse() computes it, and one product with x - mean. Needs
+ * Galois keys and relinearization keys.
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::standardize(const seal::Ciphertext* column, size_t count,
+                                                                 size_t value_count, double variance_low,
+                                                                 double variance_high, double tolerance,
+                                                                 size_t reserve, InverseApproximation* plan) const {
+    HE_PROBE_METHOD("standardize", count, ciphertext_bytes(column, count));
+    if (!use_ckks) throw std::invalid_argument("Standardizing needs CKKS");
+    if (count == 0) throw std::invalid_argument("Cannot standardize empty vector of ciphertexts");
+    const size_t slots = slot_count();
+    if (value_count == 0) value_count = count * slots;
+    if (value_count > count * slots || value_count <= (count - 1) * slots) {
+        throw std::invalid_argument("Expected between " + std::to_string((count - 1) * slots + 1) + " and " +
+                                    std::to_string(count * slots) + " values");
+    }
+    if (!(variance_low > 0) || !(variance_high > variance_low)) {
+        throw std::invalid_argument("Standardizing needs a variance range 0 < low < high");
+    }
+    if (!has_relin_keys()) throw std::runtime_error("Relinearization keys not loaded");
+    if (rotation_keys(slot_sum_steps())->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+    const size_t levels = spare_levels(column[0]);
+    if (levels < 4 + reserve) {
+        throw std::invalid_argument("Standardizing needs at least " + std::to_string(4 + reserve) +
+                                    " levels; profile " + profile.name + " leaves " + std::to_string(levels));
+    }
+
+    const double scale = column[0].scale();
+    const double n = static_cast<double>(value_count);
+    const size_t level = chain_index(column[0]);
+    seal::Ciphertext total = sum(column, count);
+    sum_slots_inplace(total);
+    std::vector<seal::Ciphertext> squared = squares(column, count);
+    seal::Ciphertext total_squares = sum(squared);
+    squared.clear();
+    sum_slots_inplace(total_squares);
+
+    // u = variance / variance_high = sum(x^2) / (n high) - (sum(x) / (n sqrt(high)))^2
+    seal::Ciphertext u = total_squares;
+    multiply_constant_to(u, 1.0 / (n * variance_high), level - 2, scale);
+    seal::Ciphertext mean_term = total;
+    multiply_constant_to(mean_term, 1.0 / (n * std::sqrt(variance_high)), level - 1,
+                         std::sqrt(scale * dropped_prime(level - 1)));
+    seal::Ciphertext mean_square = multiply(mean_term, mean_term);
+    rescale_inplace(mean_square);
+    relinearize_inplace(mean_square);
+    mean_square.scale() = scale;
+    evaluator->sub_inplace(u, mean_square);
+
+    InverseApproximation chosen = plan_inverse(u, variance_low, variance_high, true, levels - 3 - reserve, tolerance);
+    seal::Ciphertext inverse_sd = newton_inverse(u, chosen);
+    const size_t sd_level = chain_index(inverse_sd);
+    const double prime = dropped_prime(sd_level);
+
+    // (x - mean) at the scale of the prime the product with 1 / sd drops
+    seal::Ciphertext negated_mean = total;
+    multiply_constant_to(negated_mean, -1.0 / n, sd_level, prime);
+    std::vector<seal::Ciphertext> results(count);
+    parallel_for(count, [&](size_t i) {
+        seal::Ciphertext centered = column[i];
+        multiply_constant_to(centered, 1.0, sd_level, prime);
+        evaluator->add_inplace(centered, negated_mean);
+        results[i] = multiply(centered, inverse_sd);
+        rescale_inplace(results[i]);
+        relinearize_inplace(results[i]);
+        results[i].scale() = scale;
+    });
+    if (plan) *plan = std::move(chosen);
+    return results;
+}
+
+/**
+ * Logistic regression scores sigmoid(w . x + b) of packed patients
+ * 
+ * @param ciphertexts Patients packed as PatientPacking(layout, features,
+ *                    slot_count()) lays them out (other slots are ignored)
+ * @param count Number of ciphertexts, all at one level
+ * @param model Weights, bias and sigmoid polynomial
+ * @param depth If set, receives the levels spent
+ * @param layout sample_major: feature i of patient p in slot p * block_size + i;
+ *               feature_major: in slot i * P + p, P patients per ciphertext
+ * @return One ciphertext per input; slot score_slot(p) (p * block_size, or p)
+ *         holds patient p's probability, the other slots partial scores
+ * @throws std::invalid_argument for BFV, no ciphertexts or weights, more
+ *         features than slots, or too few levels (use ml-inference)
+ * 
+ * Per ciphertext: one multiply_plain by the weights replicated to match the
+ * layout (encoded once, at the scale the rescale drops), log2(block_size)
+ * rotations summing each patient's features into its score slot (steps
+ * 1, 2, ... within a block, or P, 2 P, ... across the feature runs), the bias
+ * as a plaintext addition and the sigmoid by Paterson-Stockmeyer evaluation;
+ * 1 + 2 levels for the cubic sigmoid. Ciphertexts run concurrently on the
+ * thread pool.
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::logistic_regression(const seal::Ciphertext* ciphertexts,
+                                                                         size_t count, const LogisticModel& model,
+                                                                         size_t* depth, PatientLayout layout) const {
+    HE_PROBE_METHOD("logistic_regression", count, ciphertext_bytes(ciphertexts, count));
+    if (!use_ckks) throw std::invalid_argument("Logistic regression needs CKKS");
+    if (count == 0) throw std::invalid_argument("Cannot score empty vector of ciphertexts");
+    if (model.weights.empty()) throw std::invalid_argument("Model has no weights");
+    if (model.block_size() > slot_count()) {
+        throw std::invalid_argument("Model has more features than the " + std::to_string(slot_count()) + " slots");
+    }
+    const PatientPacking packing(layout, model.weights.size(), slot_count());
+
+    const size_t levels = 1 + PolynomialEvaluator(*this, ciphertexts[0]).depth(model.sigmoid);
+    if (chain_index(ciphertexts[0]) < levels) {
+        throw std::invalid_argument("Logistic regression needs " + std::to_string(levels) + " levels, profile " +
+                                    profile.name + " leaves " + std::to_string(chain_index(ciphertexts[0])));
+    }
+    if (depth) *depth = levels;
+
+    const std::vector<seal::Plaintext> weights =
+        encode_weights(packing.replicate(model.weights), true, ciphertexts[0].parms_id());
+
+    std::vector<seal::Ciphertext> results(count);
+    parallel_for(count, [&](size_t i) {
+        seal::Ciphertext score = weighted_sum(ciphertexts + i, weights);
+        if (layout == PatientLayout::sample_major) {
+            sum_blocks_inplace(score, packing.block_size());
+        } else if (packing.block_size() > 1) {
+            sum_slots_inplace(score, packing.sum_stride());
+        }
+        add_constant_inplace(score, model.bias);
+        results[i] = PolynomialEvaluator(*this, std::move(score)).evaluate(model.sigmoid);
+    });
+    return results;
+}
+
+/**
+ * One gradient-descent step's gradient of the logistic loss, for training
+ * on encrypted patients
+ *
+ * @param features Patients packed as PatientPacking(feature_major, weights, slot_count());
+ *                 a constant-1 feature gives the bias' component
+ * @param labels   Each patient's label in every feature slot of its own (the same
+ *                 packing of rows [y, y, ...]), one ciphertext per features ciphertext
+ * @param count    Ciphertexts of each
+ * @param model    Current weights and bias, and the sigmoid polynomial
+ * @param progress Called with the fraction of ciphertexts done, from any thread;
+ *                 an exception it throws stops the computation
+ * @return Packed ciphertext holding sum_p (sigmoid(w . x_p + b) - y_p) x_pf in
+ *         slot PatientPacking::total_slot(f); divide by the patient count for the mean
+ * @throws std::invalid_argument for BFV or BGV, no ciphertexts or weights, more
+ *         features than slots, or too few levels (use ml-inference)
+ *
+ * The forward pass is logistic_regression's feature_major path, whose fold
+ * over the feature runs leaves each patient's score in every slot of the
+ * patient, so the error sigmoid - y lines up slot for slot with the features
+ * and one ciphertext product gives every term of X^T (sigmoid - y). The
+ * products are summed unrelinearized, each thread over its own share of the
+ * ciphertexts, and the total is relinearized and rescaled once before
+ * feature_sums folds the runs (log2 P rotations) and masks the gradient
+ * slots. 1 + sigmoid depth + 2 levels: 5 for the cubic sigmoid. With all
+ * weights zero, as training usually starts, every score is the bias and the
+ * error is the constant sigmoid(b) - y, without the forward pass.
+ */
+seal::Ciphertext HomomorphicEncryption::logistic_gradient(const seal::Ciphertext* features,
+                                                          const seal::Ciphertext* labels, size_t count,
+                                                          const LogisticModel& model,
+                                                          const std::function<void(double)>& progress) const {
+    HE_PROBE_METHOD("logistic_gradient", 2 * count, ciphertext_bytes(features, count) + ciphertext_bytes(labels, count));
+    if (!use_ckks) throw std::invalid_argument("Logistic regression needs CKKS");
+    if (count == 0) throw std::invalid_argument("Cannot train on empty vector of ciphertexts");
+    if (model.weights.empty()) throw std::invalid_argument("Model has no weights");
+    if (model.block_size() > slot_count()) {
+        throw std::invalid_argument("Model has more features than the " + std::to_string(slot_count()) + " slots");
+    }
+    if (!has_relin_keys()) throw std::runtime_error("Relinearization keys not loaded");
+    const PatientPacking packing(PatientLayout::feature_major, model.weights.size(), slot_count());
+
+    const size_t levels = 1 + PolynomialEvaluator(*this, features[0]).depth(model.sigmoid) + 2;
+    if (chain_index(features[0]) < levels) {
+        throw std::invalid_argument("Logistic gradient needs " + std::to_string(levels) + " levels, profile " +
+                                    profile.name + " leaves " + std::to_string(chain_index(features[0])));
+    }
+
+    // Zero weights (the usual first step) score every patient sigmoid(b): a plaintext constant
+    const bool constant_score =
+        std::all_of(model.weights.begin(), model.weights.end(), [](double weight) { return weight == 0.0; });
+    double constant_probability = 0.0;
+    for (size_t k = model.sigmoid.size(); k-- > 0;) constant_probability = constant_probability * model.bias + model.sigmoid[k];
+    const std::vector<seal::Plaintext> weights =
+        constant_score ? std::vector<seal::Plaintext>()
+                       : encode_weights(packing.replicate(model.weights), true, features[0].parms_id());
+
+    // Ciphertexts in `groups` strided shares, each summing its products unrelinearized
+    const size_t threads = thread_pool ? thread_pool->size() : 1;
+    const size_t groups = std::min(count, threads);
+    std::vector<seal::Ciphertext> partials(groups);
+    std::atomic<size_t> done{0};
+    parallel_for(groups, [&](size_t group) {
+        for (size_t i = group; i < count; i += groups) {
+            seal::Ciphertext error;
+            if (constant_score) {
+                error = labels[i];
+                {
+                    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+                    evaluator->negate_inplace(error);
+                }
+                add_constant_inplace(error, constant_probability);
+            } else {
+                seal::Ciphertext score = weighted_sum(features + i, weights);
+                if (packing.block_size() > 1) sum_slots_inplace(score, packing.sum_stride());
+                add_constant_inplace(score, model.bias);
+                error = PolynomialEvaluator(*this, std::move(score)).evaluate(model.sigmoid, labels[i].scale());
+                seal::Ciphertext label = labels[i];
+                match_level_inplace(error, label);
+                metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+                evaluator->sub_inplace(error, label);
+            }
+            seal::Ciphertext x = features[i];
+            match_level_inplace(error, x);
+            seal::Ciphertext product = multiply(error, x);
+            if (partials[group].size() == 0) {
+                partials[group] = std::move(product);
+            } else {
+                add_inplace(partials[group], product);
+            }
+            if (progress) progress(static_cast<double>(++done) / count);
+        }
+    });
+
+    seal::Ciphertext total = sum(partials);
+    relinearize_inplace(total);
+    rescale_inplace(total);
+    return feature_sums(&total, 1, packing);
+}
+
+/**
+ * Squared Euclidean distances of many patients to k centroids, all n x k of a
+ * ciphertext's patients in one packed result (nearest-centroid or k-means
+ * assignment)
+ *
+ * @param ciphertexts Patients packed by packing.pack (each patient repeated once per centroid)
+ * @param count       Number of ciphertexts
+ * @param packing     The layout, for slot_count() slots
+ * @param centroids   packing.centroid_count() rows of packing.feature_count() plaintext values
+ * @return One ciphertext per input: slot packing.distance_slot(p, j) holds
+ *         sum_f (x_pf - c_jf)^2; the other slots hold partial sums
+ * @throws std::invalid_argument for no ciphertexts, another slot count, a profile
+ *         without a level to spend, or centroids that do not match the packing
+ *
+ * The negated centroids, replicated into every patient's group, are added
+ * as one plaintext (encoded once, then cached); one square and
+ * log2(block_size) rotate-and-add steps follow. Per ciphertext that is one
+ * multiplication and log2(block_size) rotations for all its n x k distances,
+ * where comparing patients and centroids one pair at a time costs a
+ * multiplication and a block sum per centroid. One level; under BFV and BGV
+ * the distances must stay below the plain modulus.
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::centroid_distances(
+    const seal::Ciphertext* ciphertexts, size_t count, const CentroidPacking& packing,
+    const std::vector<std::vector<double>>& centroids) const {
+    HE_PROBE_METHOD("centroid_distances", count, ciphertext_bytes(ciphertexts, count));
+    if (count == 0) throw std::invalid_argument("Cannot compare empty vector of ciphertexts");
+    if (packing.group_size() * packing.patients_per_ciphertext() != slot_count()) {
+        throw std::invalid_argument("Packing is for another slot count than " + std::to_string(slot_count()));
+    }
+    if (profile.depth < 1) {
+        throw std::invalid_argument("Distances need a profile with multiplicative depth >= 1, not " + profile.name);
+    }
+    if (!has_relin_keys()) throw std::runtime_error("Relinearization keys not loaded");
+
+    std::vector<double> negated = packing.replicate(centroids);
+    for (double& value : negated) value = -value;
+
+    std::vector<seal::Ciphertext> results(count);
+    parallel_for(count, [&](size_t i) {
+        seal::Ciphertext difference = ciphertexts[i];
+        add_constant_inplace(difference, negated);
+        results[i] = multiply(difference, difference);
+        relinearize_inplace(results[i]);
+        if (rescales()) rescale_inplace(results[i]);
+        sum_blocks_inplace(results[i], packing.block_size());
+    });
+    return results;
+}
+
+/**
+ * Choose where SEAL scratch memory comes from
+ * 
+ * @param enabled true (default): each thread's own MemoryPoolHandle::ThreadLocal(),
+ *                so concurrent requests never contend; false: the global,
+ *                locked pool of MemoryManager::GetPool()
+ */
+void HomomorphicEncryption::set_thread_local_pools(bool enabled) {
+    thread_local_pools = enabled;
+}
+
+/**
+ * Keep relinearization and Galois keys in SEAL's compact storage from the
+ * next key update on (KSwitchKeys::compact)
+ * 
+ * Limbs modulo primes of at most 32 bits, e.g. the 30-bit middle primes of
+ * the "{50, 30, 30, 50}" profiles, are held as 32-bit words: a quarter less
+ * key memory there, half on chains of only such primes. Key switching widens
+ * them as it reads them, at no measurable cost. The released 64-bit copies go
+ * back to SEAL's pool, which the idle trimmer returns to the system.
+ * Serialized keys are unchanged.
+ */
+void HomomorphicEncryption::set_compact_keys(bool enabled) {
+    compact_keys = enabled;
+}
+
+/**
+ * Bound the memory of encoded constants and weights kept for reuse
+ * 
+ * @param capacity_bytes Plaintext bytes to keep, least recently used evicted
+ *                       first; 0 encodes every constant afresh
+ */
+void HomomorphicEncryption::set_plaintext_cache(size_t capacity_bytes) {
+    plaintexts->set_capacity(capacity_bytes);
+}
+
+/**
+ * Precompute encryptions of zero for encrypt() and the packed encryptions
+ * 
+ * @param capacity Zeros kept ready; each is a fresh ciphertext's worth of memory
+ *                 (2 * N * data primes * 8 bytes, 256 KiB for the default profile)
+ */
+void HomomorphicEncryption::set_zero_pool(size_t capacity) {
+    zero_pool.reset();
+    if (capacity == 0) return;
+    zero_pool = std::make_unique<ZeroPool>(capacity, [this](seal::Ciphertext& zero) -> std::shared_ptr<const void> {
+        auto keys = this->keys();
+        if (!keys->encryptor || keys->public_key.data().size() == 0) return nullptr;
+        // The global pool, as zeros outlive this thread's scratch memory
+        keys->encryptor->encrypt_zero(fresh_parms, zero,
+                                      seal::MemoryManager::GetPool(seal::mm_prof_opt::mm_force_global));
+        return keys;
+    });
+}
+
+size_t HomomorphicEncryption::zero_pool_size() const {
+    return zero_pool ? zero_pool->size() : 0;
+}
+
+/**
+ * Run the operations requests use before any request does
+ * 
+ * Each of the pool's threads (and the caller) encrypts a packed vector, adds,
+ * multiplies and relinearizes (depth >= 1), sums slots (with slot_sum keys),
+ * serializes and decrypts (with the secret key), growing its memory pool or
+ * scratch arena to what requests need; with lazy Galois keys this loads the
+ * slot sums' ones. Then one word of every page of the resident keys is read.
+ * Galois permutation tables are already built by publish(). Stage timings
+ * are recorded under the endpoint "WARMUP", not mixed into requests'.
+ * 
+ * @param rounds Times each thread runs the operations; 0 does nothing
+ */
+void HomomorphicEncryption::warm_up(size_t rounds) const {
+    auto current = keys();
+    if (rounds == 0 || current->public_key.data().size() == 0) return;
+    HE_PROBE_METHOD("warm_up", rounds, 0);
+    auto start = std::chrono::steady_clock::now();
+    metrics::EndpointScope scope("WARMUP");
+
+    const bool multiplies = profile.depth >= 1 && has_relin_keys();
+    const bool sums = rotation_keys(slot_sum_steps())->galois_keys.size() > 0;
+    const std::vector<double> values(slot_count(), 1.0);
+    try {
+        parallel_for(thread_pool ? thread_pool->size() : 1, [&](size_t) {
+            for (size_t round = 0; round < rounds; round++) {
+                seal::Ciphertext encrypted = deserialize(encrypt_vector(values)[0]);
+                seal::Ciphertext total = add(encrypted, encrypted);
+                if (multiplies) {
+                    seal::Ciphertext product = multiply(total, encrypted);
+                    relinearize_inplace(product);
+                    if (rescales()) rescale_inplace(product);
+                }
+                if (sums) sum_slots_inplace(total);
+                total = deserialize(serialize(total));
+                if (keys()->decryptor) decrypt(total);
+            }
+            reset_scratch_arena();
+        });
+    } catch (const std::exception& e) {
+        // Not worth refusing to serve over: requests report the same failure themselves
+        std::cerr << "Warm-up of " << profile.name << " (" << scheme_name() << ") failed: " << e.what() << "\n";
+        return;
+    }
+
+    // Reading the keys once faults in any page still unmapped (e.g. huge pages placed on
+    // first touch) and leaves the most recent ones in cache
+    current = keys();
+    constexpr size_t page_words = 4096 / sizeof(uint64_t);
+    uint64_t checksum = 0;
+    auto touch = [&](const seal::Ciphertext& key) {
+        for (size_t i = 0; i < key.dyn_array().size(); i += page_words) checksum += key.data()[i];
+    };
+    auto touch_all = [&](const std::vector<std::vector<seal::PublicKey>>& switch_keys) {
+        for (const auto& key_parts : switch_keys) {
+            for (const auto& part : key_parts) touch(part.data());
+        }
+    };
+    touch(current->public_key.data());
+    touch_all(current->relin_keys.data());
+    touch_all(current->galois_keys.data());
+    static std::atomic<uint64_t> sink{0};
+    sink.fetch_add(checksum, std::memory_order_relaxed);  // Keeps the reads
+
+    const uint64_t duration = elapsed_us(start);
+    metrics::histogram("he_warm_up_duration_microseconds", "Time engines spent warming up before serving",
+                       {{"profile", profile.name}, {"scheme", scheme_name()}})
+        .record(duration);
+    std::cout << "Warm-up: " << profile.name << " (" << scheme_name() << ") " << duration / 1000 << " ms\n"
+              << std::flush;
+}
+
+/**
+ * Take SEAL scratch memory from per-thread bump-pointer arenas
+ * 
+ * Each thread carves its temporaries from its own seal::ScratchArena, which
+ * recycles them without locks or allocator calls; reset_scratch_arena() after
+ * a request merges what the request grew into a single block.
+ * 
+ * @param initial_bytes Size of each thread's first arena block; 0 switches
+ *                      back to the pools chosen by set_thread_local_pools
+ */
+void HomomorphicEncryption::set_scratch_arenas(size_t initial_bytes) {
+    scratch_arena_bytes = initial_bytes;
+}
+
+/**
+ * Reclaim the calling thread's scratch arena, e.g. once a request is answered
+ * Does nothing if the thread has no arena or still holds memory from it
+ */
+void HomomorphicEncryption::reset_scratch_arena() {
+    if (scratch_arena && scratch_arena->outstanding_count() == 0) scratch_arena->reset();
+}
+
+/**
+ * Pool for temporaries of a single call: encoder/evaluator scratch space and
+ * plaintexts or rotations that never leave the calling thread. Results that
+ * are returned (and may be freed on another thread) keep the global pool,
+ * since thread-local pools and arenas are not thread-safe.
+ */
+seal::MemoryPoolHandle HomomorphicEncryption::scratch_pool() const {
+    if (scratch_arena_bytes > 0) {
+        if (!scratch_arena) scratch_arena = std::make_unique<seal::ScratchArena>(scratch_arena_bytes);
+        return *scratch_arena;
+    }
+    return thread_local_pools ? seal::MemoryPoolHandle::ThreadLocal() : seal::MemoryManager::GetPool();
+}
+
+/**
+ * Configure the worker pool used by sum() for large inputs
+ * 
+ * @param pool Shared worker pool (nullptr disables parallel mode)
+ * @param min_parallel_operands Smallest input size worth splitting across threads
+ */
+void HomomorphicEncryption::set_thread_pool(std::shared_ptr<ThreadPool> pool, size_t min_parallel_operands) {
+    thread_pool = std::move(pool);
+    this->min_parallel_operands = min_parallel_operands;
+}
+
+/**
+ * Sum count operands, in parallel when a pool is configured and the input is large enough
+ * 
+ * @param load Callable returning operand i (by value or const reference)
+ * @param count Number of operands (must be > 0)
+ * @return Encrypted sum of all operands
+ */
+template <typename Load>
+seal::Ciphertext HomomorphicEncryption::reduce(const Load& load, size_t count) const {
+    if (thread_pool && thread_pool->size() > 1 && count >= min_parallel_operands) {
+        return parallel_sum(load, count);
+    }
+    return sum_range(load, 0, count);
+}
+
+/**
+ * Sum the operands in [begin, end) with Evaluator::add_many
+ * 
+ * @param load Callable returning operand i (deserializing it, or referencing a stored ciphertext)
+ * @param begin First index to add
+ * @param end One past the last index to add (must be > begin)
+ * @return Encrypted sum of the range
+ * 
+ * add_many sums each coefficient across a whole batch in one pass, reducing
+ * modulo q only when 64-bit headroom runs out, instead of reading, adding and
+ * reducing the running sum once per operand. Referenced operands (stored
+ * ciphertexts) are added sum_reference_batch at a time; deserialized ones are
+ * held sum_batch at a time, with the running sum as the first operand of every
+ * later batch. The request's cancellation token is checked before each batch.
+ * Deserialized operands are recycled once added (see CiphertextPool.h), so the
+ * next batch loads into their allocations, and so is the spare accumulator.
+ */
+template <typename Load>
+seal::Ciphertext HomomorphicEncryption::sum_range(const Load& load, size_t begin, size_t end) const {
+    constexpr bool by_reference = std::is_reference_v<decltype(load(begin))>;
+    const size_t batch = by_reference ? sum_reference_batch : sum_batch;
+    
+    std::vector<seal::Ciphertext> held;
+    std::vector<const seal::Ciphertext*> operands;
+    seal::Ciphertext result;
+    seal::Ciphertext next;
+    
+    // Only the adds count as "evaluate" (loads record their own deserialize time)
+    std::chrono::steady_clock::duration evaluating{};
+    for (size_t i = begin; i < end;) {
+        cancellation::check();
+        const size_t stop = std::min(end, i + batch);
+        operands.clear();
+        if (i > begin) operands.push_back(&result);
+        if constexpr (by_reference) {
+            for (; i < stop; i++) operands.push_back(&load(i));
+        } else {
+            for (auto& ciphertext : held) ciphertext_pool::recycle(std::move(ciphertext));
+            held.clear();
+            for (; i < stop; i++) held.push_back(load(i));
+            for (const auto& ciphertext : held) operands.push_back(&ciphertext);
+        }
+        if (next.size() == 0) next = ciphertext_pool::take(operands.back()->parms_id(), operands.back()->size());
+        
+        auto start = std::chrono::steady_clock::now();
+        evaluator->add_many(operands.data(), operands.size(), next);
+        std::swap(result, next);
+        evaluating += std::chrono::steady_clock::now() - start;
+    }
+    for (auto& ciphertext : held) ciphertext_pool::recycle(std::move(ciphertext));
+    ciphertext_pool::recycle(std::move(next));
+    metrics::stage(scheme_name(), "evaluate")
+        .record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(evaluating).count()));
+    
+    return result;
+}
+
+/**
+ * Parallel tree reduction over the configured thread pool
+ * 
+ * @param load Callable returning operand i; must be safe to call concurrently
+ * @param count Number of operands
+ * @return Encrypted sum of all operands
+ * 
+ * The tree is a function of count alone, never of the pool size or of
+ * timing: the input is split into sum_leaves(count) contiguous leaves, which
+ * the workers (the calling thread among them) take in turn, and the leaf sums
+ * are merged pairwise in log2(leaves) rounds, round r adding leaf i + 2^r
+ * into leaf i. Every run, on any host or pool size, performs the same
+ * additions on the same operands. Additions are exact modulo each RNS prime,
+ * so the result is also bit-identical to the serial sum_range.
+ */
+template <typename Load>
+seal::Ciphertext HomomorphicEncryption::parallel_sum(const Load& load, size_t count) const {
+    const size_t n = count;
+    const size_t leaves = sum_leaves(n);
+    const size_t workers = std::min(thread_pool->size(), leaves);
+    std::vector<seal::Ciphertext> partials(leaves);
+    
+    // Every task references locals, so all of them must finish before an exception propagates
+    auto wait_all = [](std::vector<std::future<void>>& tasks) {
+        for (auto& task : tasks) task.wait();
+        for (auto& task : tasks) task.get();
+    };
+    
+    // Workers record their stage timings under the caller's endpoint and request
+    const metrics::RequestContext request = metrics::current_request();
+    
+    // Which worker sums a leaf varies by run; the leaf's operands do not
+    std::atomic<size_t> next_leaf{0};
+    auto sum_leaves_in_turn = [&] {
+        try {
+            for (size_t leaf; (leaf = next_leaf.fetch_add(1)) < leaves;) {
+                partials[leaf] = sum_range(load, leaf * n / leaves, (leaf + 1) * n / leaves);
+            }
+        } catch (...) {
+            next_leaf = leaves;  // The other workers stop at their next leaf
+            throw;
+        }
+    };
+    std::vector<std::future<void>> tasks;
+    for (size_t worker = 1; worker < workers; worker++) {
+        tasks.push_back(thread_pool->submit([&] {
+            metrics::EndpointScope scope(request);
+            sum_leaves_in_turn();
+        }));
+    }
+    try {
+        sum_leaves_in_turn();
+    } catch (...) {
+        for (auto& task : tasks) task.wait();
+        throw;
+    }
+    wait_all(tasks);
+    
+    // Pairwise merge: round r adds partials[i + 2^r] into partials[i]
+    for (size_t stride = 1; stride < leaves; stride <<= 1) {
+        tasks.clear();
+        for (size_t i = 0; i + stride < leaves; i += 2 * stride) {
+            tasks.push_back(thread_pool->submit([&, i, stride] {
+                metrics::EndpointScope scope(request);
+                cancellation::check();
+                add_inplace(partials[i], partials[i + stride]);
+            }));
+        }
+        wait_all(tasks);
+    }
+    
+    for (size_t leaf = 1; leaf < leaves; leaf++) ciphertext_pool::recycle(std::move(partials[leaf]));
+    return std::move(partials[0]);
+}
+
+/**
+ * Run task(0) .. task(count - 1), concurrently on the thread pool when one is
+ * configured (task 0 on the calling thread)
+ * 
+ * @param count Number of tasks
+ * @param task Callable taking the task index; must be safe to call concurrently
+ * @throws The first task's exception, once every task has finished
+ */
+template <typename Task>
+void HomomorphicEncryption::parallel_for(size_t count, const Task& task) const {
+    if (!thread_pool || thread_pool->size() < 2 || count < 2) {
+        for (size_t i = 0; i < count; i++) {
+            cancellation::check();
+            task(i);
+        }
+        return;
+    }
+    
+    const metrics::RequestContext request = metrics::current_request();
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 1; i < count; i++) {
+        tasks.push_back(thread_pool->submit([&, i] {
+            metrics::EndpointScope scope(request);
+            // Tasks still queued when the request is cancelled end without running
+            cancellation::check();
+            task(i);
+        }));
+    }
+    // Every task references locals, so all of them must finish before an exception propagates
+    try {
+        task(0);
+    } catch (...) {
+        for (auto& pending : tasks) pending.wait();
+        throw;
+    }
+    for (auto& pending : tasks) pending.wait();
+    for (auto& pending : tasks) pending.get();
+}
+
+/**
+ * Number of values that fit into a single packed ciphertext
+ * 
+ * @return poly_modulus_degree for BFV (BatchEncoder), poly_modulus_degree / 2 for CKKS
+ */
+size_t HomomorphicEncryption::slot_count() const {
+    if (use_ckks) {
+        return parms.poly_modulus_degree() / 2;
+    }
+    return parms.poly_modulus_degree();
+}
+
+/**
+ * Encrypt a vector of numeric values, packing them into every plaintext slot
+ * 
+ * @param values The values to encrypt
+ * @param wire Wire encoding and compression of the returned ciphertexts
+ * @return Base64-encoded ciphertexts, each holding up to slot_count() values
+ * 
+ * Values are split into consecutive chunks of slot_count(); the last chunk is
+ * zero-padded. For BFV values are rounded to signed integers, so negative
+ * inputs decode correctly as long as they stay within plain_modulus / 2.
+ */
+std::vector<std::string> HomomorphicEncryption::encrypt_vector(const std::vector<double>& values,
+                                                              const WireOptions& wire) const {
+    return encrypt_packed(values, nullptr, false, wire);
+}
+
+/**
+ * Seeded symmetric variant of encrypt_vector (see encrypt_symmetric)
+ * 
+ * @param values The values to encrypt
+ * @param wire Wire encoding and compression of the returned ciphertexts
+ * @return Serialized seeded ciphertexts, each holding up to slot_count() values
+ */
+std::vector<std::string> HomomorphicEncryption::encrypt_vector_symmetric(const std::vector<double>& values,
+                                                                        const WireOptions& wire) const {
+    return encrypt_packed(values, nullptr, true, wire);
+}
+
+/**
+ * Encrypt two equally long columns into one set of CKKS ciphertexts
+ * 
+ * Slot i holds values[i] + i * paired[i]. Anything additive (sum, sum_slots,
+ * add_inplace) acts on both columns at once, so their sums take half the
+ * ciphertexts and traffic of two encrypt_vector columns. The pairs are
+ * encoded at half the profile's scale, which the split in split_pair doubles
+ * back, so the columns it returns combine with other ciphertexts.
+ * 
+ * @param values Real parts
+ * @param paired Imaginary parts
+ * @param symmetric Encrypt with the secret key in seeded form (see encrypt_symmetric)
+ * @param wire Wire encoding and compression of the returned ciphertexts
+ * @return Serialized ciphertexts, each holding up to slot_count() pairs
+ * @throws std::invalid_argument for BFV or BGV, or columns of different lengths
+ */
+std::vector<std::string> HomomorphicEncryption::encrypt_vector_pair(const std::vector<double>& values,
+                                                                   const std::vector<double>& paired, bool symmetric,
+                                                                   const WireOptions& wire) const {
+    if (!use_ckks) throw std::invalid_argument("Only CKKS slots hold value pairs");
+    if (values.size() != paired.size()) throw std::invalid_argument("Paired columns must have the same length");
+    return encrypt_packed(values, &paired, symmetric, wire);
+}
+
+/**
+ * Shared implementation of encrypt_vector, encrypt_vector_symmetric and
+ * encrypt_vector_pair (paired: the imaginary parts, CKKS only)
+ */
+std::vector<std::string> HomomorphicEncryption::encrypt_packed(const std::vector<double>& values,
+                                                              const std::vector<double>* paired, bool symmetric,
+                                                              const WireOptions& wire) const {
+    HE_PROBE_METHOD("encrypt_vector", values.size(), values.size() * sizeof(double));
+    if (!keys()->encryptor) throw std::runtime_error("Encryptor not initialized");
+    
+    const size_t slots = slot_count();
+    std::vector<std::string> ciphertexts;
+    ciphertexts.reserve((values.size() + slots - 1) / slots);
+    
+    seal::Plaintext plain(scratch_pool());
+    // BFV: a few chunks at a time through encode_many, which runs their inverse NTTs batched
+    constexpr size_t bfv_chunks = 4;
+    std::vector<int64_t> rounded;
+    std::vector<seal::Plaintext> bfv_plains;
+    
+    for (size_t offset = 0; offset < values.size(); offset += slots) {
+        size_t chunk = std::min(slots, values.size() - offset);
+        
+        {
+            metrics::ScopedTimer timer(metrics::stage(scheme_name(), "encode"));
+            if (!use_ckks) {
+                // Signed encoding keeps negative values intact
+                const size_t index = (offset / slots) % bfv_chunks;
+                if (index == 0) {
+                    rounded.resize(std::min(bfv_chunks * slots, values.size() - offset));
+                    for (size_t i = 0; i < rounded.size(); i++) {
+                        rounded[i] = static_cast<int64_t>(std::round(values[offset + i]));
+                    }
+                    bfv_encoder->encode_many(rounded.data(), rounded.size(), bfv_plains, scratch_pool());
+                }
+                std::swap(plain, bfv_plains[index]);
+            } else if (paired) {
+                std::vector<std::complex<double>> chunk_values(chunk);
+                for (size_t i = 0; i < chunk; i++) {
+                    chunk_values[i] = std::complex<double>(values[offset + i], (*paired)[offset + i]);
+                }
+                ckks_encoder->encode(chunk_values, scale / 2, plain, scratch_pool());
+            } else {
+                // CKKS: encoder zero-fills the slots past the chunk size
+                std::vector<double> chunk_values(values.begin() + offset, values.begin() + offset + chunk);
+                ckks_encoder->encode(chunk_values, scale, plain, scratch_pool());
+            }
+        }
+        
+        ciphertexts.emplace_back();
+        encrypt_plain(plain, symmetric, ciphertexts.back(), wire);
+    }
+    
+    return ciphertexts;
+}
+
+/**
+ * Decrypt packed ciphertexts back into a flat vector of values
+ * 
+ * @param ciphertexts Base64-encoded ciphertexts produced by encrypt_vector
+ * @param count Number of values to return (0 returns every slot of every ciphertext)
+ * @return The decrypted values in their original order
+ */
+std::vector<double> HomomorphicEncryption::decrypt_vector(const CiphertextViews& ciphertexts, size_t count) const {
+    HE_PROBE_METHOD("decrypt_vector", ciphertexts.size(), total_size(ciphertexts));
+    auto keys = this->keys();
+    if (!keys->decryptor) throw std::runtime_error("Decryptor not initialized");
+    
+    std::vector<double> values;
+    values.reserve(ciphertexts.size() * slot_count());
+    
+    seal::Plaintext plain(scratch_pool());
+    
+    for (const auto& ciphertext : ciphertexts) {
+        seal::Ciphertext encrypted = deserialize(ciphertext);
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "decrypt"));
+        keys->decryptor->decrypt(encrypted, plain);
+        
+        if (use_ckks) {
+            std::vector<double> decoded;
+            ckks_encoder->decode(plain, decoded, scratch_pool());
+            values.insert(values.end(), decoded.begin(), decoded.end());
+        } else {
+            std::vector<int64_t> decoded;
+            bfv_encoder->decode(plain, decoded, scratch_pool());
+            for (int64_t v : decoded) {
+                values.push_back(static_cast<double>(v));
+            }
+        }
+    }
+    
+    // Drop the zero padding of the last chunk
+    if (count > 0 && count < values.size()) {
+        values.resize(count);
+    }
+    
+    return values;
+}
+
+/**
+ * Decrypt encrypt_vector_pair's ciphertexts (or sums of them) back into the
+ * two columns
+ * 
+ * @param ciphertexts Serialized ciphertexts
+ * @param count Number of pairs to return (0 returns every slot of every ciphertext)
+ * @return {values, paired}
+ * @throws std::invalid_argument for BFV or BGV
+ */
+std::pair<std::vector<double>, std::vector<double>> HomomorphicEncryption::decrypt_vector_pair(
+    const CiphertextViews& ciphertexts, size_t count) const {
+    HE_PROBE_METHOD("decrypt_vector", ciphertexts.size(), total_size(ciphertexts));
+    if (!use_ckks) throw std::invalid_argument("Only CKKS slots hold value pairs");
+    auto keys = this->keys();
+    if (!keys->decryptor) throw std::runtime_error("Decryptor not initialized");
+
+    std::pair<std::vector<double>, std::vector<double>> columns;
+    seal::Plaintext plain(scratch_pool());
+    std::vector<std::complex<double>> decoded;
+    for (const auto& ciphertext : ciphertexts) {
+        seal::Ciphertext encrypted = deserialize(ciphertext);
+        metrics::ScopedTimer timer(metrics::stage(scheme_name(), "decrypt"));
+        keys->decryptor->decrypt(encrypted, plain);
+        ckks_encoder->decode(plain, decoded, scratch_pool());
+        for (const auto& slot : decoded) {
+            columns.first.push_back(slot.real());
+            columns.second.push_back(slot.imag());
+        }
+    }
+
+    // Drop the zero padding of the last chunk
+    if (count > 0 && count < columns.first.size()) {
+        columns.first.resize(count);
+        columns.second.resize(count);
+    }
+    return columns;
+}
+
+std::vector<double> HomomorphicEncryption::decrypt_batch(const CiphertextViews& ciphertexts, WireFormat format,
+                                                         size_t slots) const {
+    HE_PROBE_METHOD("decrypt_batch", ciphertexts.size(), total_size(ciphertexts));
+    return decrypt_prefix<double>(ciphertexts, format, slots);
+}
+
+std::vector<int64_t> HomomorphicEncryption::decrypt_batch_integers(const CiphertextViews& ciphertexts,
+                                                                   WireFormat format, size_t slots) const {
+    HE_PROBE_METHOD("decrypt_batch", ciphertexts.size(), total_size(ciphertexts));
+    return decrypt_prefix<int64_t>(ciphertexts, format, slots);
+}
+
+/**
+ * Decrypt and decode many ciphertexts into one array of slot values
+ * 
+ * The ciphertexts are split into one contiguous range per pool worker; each
+ * range reuses its own plaintext and decode buffer, so no decoder state is
+ * shared between the workers.
+ * 
+ * @param ciphertexts Serialized ciphertexts
+ * @param format Their wire format
+ * @param slots Slots kept per ciphertext (0: all)
+ * @return ciphertexts.size() * slots values, ciphertext by ciphertext
+ */
+template <typename T>
+std::vector<T> HomomorphicEncryption::decrypt_prefix(const CiphertextViews& ciphertexts, WireFormat format,
+                                                     size_t slots) const {
+    auto keys = this->keys();
+    if (!keys->decryptor) throw std::runtime_error("Decryptor not initialized");
+    if (slots == 0) slots = slot_count();
+    if (slots > slot_count()) {
+        throw std::invalid_argument("slots must be at most " + std::to_string(slot_count()));
+    }
+    
+    const size_t n = ciphertexts.size();
+    std::vector<T> values(n * slots);
+    const size_t shards = std::min(n, thread_pool ? thread_pool->size() : size_t(1));
+    parallel_for(shards, [&](size_t shard) {
+        seal::Plaintext plain(scratch_pool());
+        std::vector<double> real;
+        std::vector<int64_t> integers;
+        for (size_t i = shard * n / shards; i < (shard + 1) * n / shards; i++) {
+            seal::Ciphertext encrypted = deserialize(ciphertexts[i], format);
+            metrics::ScopedTimer timer(metrics::stage(scheme_name(), "decrypt"));
+            keys->decryptor->decrypt(encrypted, plain);
+            
+            T* out = values.data() + i * slots;
+            if (use_ckks) {
+                ckks_encoder->decode(plain, real, scratch_pool());
+                for (size_t j = 0; j < slots; j++) {
+                    if constexpr (std::is_integral_v<T>) {
+                        out[j] = static_cast<T>(std::llround(real[j]));
+                    } else {
+                        out[j] = real[j];
+                    }
+                }
+            } else {
+                bfv_encoder->decode(plain, integers, scratch_pool());
+                std::transform(integers.begin(), integers.begin() + slots, out,
+                               [](int64_t value) { return static_cast<T>(value); });
+            }
+        }
+    });
+    return values;
+}
+
+/**
+ * Rotation steps required by sum_slots_inplace
+ * 
+ * @param stride As for sum_slots_inplace: the steps start from it
+ * @return Power-of-two steps covering one row (BFV) or the whole vector (CKKS);
+ *         for BFV step 0 is included, which SEAL maps to the row swap
+ */
+std::vector<int> HomomorphicEncryption::slot_sum_steps(size_t stride) const {
+    std::vector<int> steps;
+    size_t span = use_ckks ? slot_count() : slot_count() / 2;  // BFV rotates within 2 x (N/2) rows
+    for (size_t step = stride; step < span; step <<= 1) {
+        steps.push_back(static_cast<int>(step));
+    }
+    if (!use_ckks) {
+        steps.push_back(0);  // Column rotation (swap the two BFV rows)
+    }
+    return steps;
+}
+
+/**
+ * Steps the Galois keys for a set of operations must cover
+ * 
+ * "slot_sum": slot_sum_steps(), which also serve the strided and blocked sums
+ * of group-by, histograms, comparisons and logistic regression. "matvec":
+ * those and, for profiles with baby_steps, every other step below it (see
+ * DiagonalMatrix). "prefix_sum": those and the right rotations by powers of
+ * two below prefix_chunk_size() (see prefix_sums). "conjugate": step 0, which
+ * SEAL's Galois tool maps to complex conjugation under CKKS (see split_pair)
+ * and to the row swap under BFV and BGV. No operation: no Galois keys (plain
+ * sums need none).
+ * 
+ * @throws std::invalid_argument for an unknown operation
+ */
+std::vector<int> HomomorphicEncryption::rotation_steps(const std::vector<std::string>& operations) const {
+    bool slot_sum = false;
+    bool matvec = false;
+    bool prefix_sum = false;
+    bool conjugate = false;
+    for (const auto& operation : operations) {
+        if (operation == "slot_sum") {
+            slot_sum = true;
+        } else if (operation == "matvec") {
+            matvec = true;
+        } else if (operation == "prefix_sum") {
+            prefix_sum = true;
+        } else if (operation == "conjugate") {
+            conjugate = true;
+        } else {
+            throw std::invalid_argument("Unknown rotation operation: " + operation +
+                                        " (slot_sum, matvec, prefix_sum, conjugate)");
+        }
+    }
+    std::vector<int> steps;
+    if (slot_sum || matvec || prefix_sum) steps = slot_sum_steps();
+    if (conjugate && std::find(steps.begin(), steps.end(), 0) == steps.end()) steps.push_back(0);
+    for (size_t step = 3; matvec && step < profile.baby_steps; step++) {
+        if ((step & (step - 1)) != 0) steps.push_back(static_cast<int>(step));
+    }
+    for (size_t step = 1; prefix_sum && step < prefix_chunk_size(); step <<= 1) {
+        steps.push_back(-static_cast<int>(step));
+    }
+    return steps;
+}
+
+/**
+ * Choose the Galois keys generate_keys() creates
+ * 
+ * @param operations Names accepted by rotation_steps; every key costs as much
+ *                   as a relinearization key (about 1.5 MB at N = 8192)
+ */
+void HomomorphicEncryption::set_rotation_operations(std::vector<std::string> operations) {
+    rotation_steps(operations);  // Validate now rather than at key generation
+    rotation_operations = std::move(operations);
+}
+
+/**
+ * The current key set with keys for every step in steps that its Galois key
+ * store has (load_keys with lazy_galois_keys); other sets are returned as they are
+ * 
+ * Missing keys are read under key_update_mutex and published as a new key set,
+ * once: an element the store lacks is remembered, and SEAL composes that
+ * rotation from others. A store written before per-element files existed has
+ * its whole Galois key file read instead.
+ */
+std::shared_ptr<const HomomorphicEncryption::KeySet> HomomorphicEncryption::rotation_keys(
+    const std::vector<int>& steps) const {
+    auto keys = expanded_keys(true);
+    if (!keys->galois_store) return keys;
+    auto galois_tool = context->key_context_data()->galois_tool();
+    auto wanted = [&](const KeySet& set, uint32_t element) {
+        return !set.galois_keys.has_key(element) && set.galois_absent.count(element) == 0;
+    };
+    std::vector<uint32_t> elements;
+    for (int step : steps) {
+        uint32_t element = galois_tool->get_elt_from_step(step);
+        if (wanted(*keys, element)) elements.push_back(element);
+    }
+    if (elements.empty()) return keys;
+
+    HE_PROBE_METHOD("load_galois_element", elements.size(), 0);
+    std::lock_guard<std::mutex> lock(key_update_mutex);
+    auto updated = copy_keys();  // Another thread may have loaded some meanwhile
+    for (uint32_t element : elements) {
+        if (!updated->galois_store || !wanted(*updated, element)) continue;
+        seal::GaloisKeys loaded;
+        if (updated->galois_store->load(*context, galois_element_kind(element).c_str(), loaded)) {
+            merge_galois_keys(loaded, updated->galois_keys);
+        } else if (updated->galois_store->load(*context, "galois_keys", loaded)) {
+            merge_galois_keys(loaded, updated->galois_keys);
+            updated->galois_store.reset();  // Everything there is, is loaded
+        } else {
+            updated->galois_absent.insert(element);
+        }
+    }
+    publish(std::move(updated));
+    return this->keys();
+}
+
+/**
+ * The current key set with its relinearization (or Galois) keys expanded from
+ * what load_evaluation_keys kept; other sets are returned as they are
+ * 
+ * Expanded under key_update_mutex and published once, like rotation_keys'
+ * loads; the seeded bytes are dropped then
+ */
+std::shared_ptr<const HomomorphicEncryption::KeySet> HomomorphicEncryption::expanded_keys(bool galois) const {
+    auto keys = this->keys();
+    if (!(galois ? keys->galois_pending : keys->relin_pending)) return keys;
+
+    HE_PROBE_METHOD("expand_evaluation_keys", galois ? 1 : 0, 0);
+    std::lock_guard<std::mutex> lock(key_update_mutex);
+    auto updated = copy_keys();  // Another thread may have expanded them meanwhile
+    if (galois && updated->galois_pending) {
+        load_bytes(updated->galois_keys, *context, updated->seeded_galois_keys->data(),
+                   updated->seeded_galois_keys->size());
+        updated->seeded_galois_keys.reset();
+        updated->galois_pending = false;
+    } else if (!galois && updated->relin_pending) {
+        load_bytes(updated->relin_keys, *context, updated->seeded_relin_keys->data(),
+                   updated->seeded_relin_keys->size());
+        updated->seeded_relin_keys.reset();
+        updated->relin_pending = false;
+    } else {
+        return this->keys();
+    }
+    publish(std::move(updated));
+    return this->keys();
+}
+
+/**
+ * Whether a rotation by step has a Galois key of its own (else SEAL composes
+ * it from several rotations)
+ */
+bool HomomorphicEncryption::has_galois_key(int step) const {
+    auto keys = rotation_keys({step});
+    if (keys->galois_keys.size() == 0) return false;
+    return keys->galois_keys.has_key(context->key_context_data()->galois_tool()->get_elt_from_step(step));
+}
+
+/**
+ * Reduce all slots of a ciphertext in place with log2(slots) rotate-and-add steps
+ * After this every slot holds the sum of all original slots
+ * 
+ * @param encrypted Packed ciphertext to reduce
+ * @param stride Power of two (at most one BFV row) to sum only slots congruent
+ *               modulo it: slot i then holds the sum over all slots j = i mod
+ *               stride, in log2(slots / stride) steps
+ */
+void HomomorphicEncryption::sum_slots_inplace(seal::Ciphertext& encrypted, size_t stride) const {
+    HE_PROBE_METHOD("sum_slots", 1, ciphertext_bytes(encrypted));
+    auto keys = rotation_keys(slot_sum_steps(stride));
+    if (keys->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+    
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::MemoryPoolHandle pool = scratch_pool();
+    seal::Ciphertext rotated(pool);
+    if (use_ckks) {
+        for (size_t step = stride; step < slot_count(); step <<= 1) {
+            evaluator->rotate_vector(encrypted, static_cast<int>(step), keys->galois_keys, rotated, pool);
+            evaluator->add_inplace(encrypted, rotated);
+        }
+    } else {
+        for (size_t step = stride; step < slot_count() / 2; step <<= 1) {
+            evaluator->rotate_rows(encrypted, static_cast<int>(step), keys->galois_keys, rotated, pool);
+            evaluator->add_inplace(encrypted, rotated);
+        }
+        evaluator->rotate_columns(encrypted, keys->galois_keys, rotated, pool);
+        evaluator->add_inplace(encrypted, rotated);
+    }
+}
+
+/**
+ * Sum each block of block_size consecutive slots into its first slot with
+ * log2(block_size) rotate-and-add steps (the other slots get partial sums)
+ * 
+ * @param encrypted Packed ciphertext
+ * @param block_size Power of two, at most one BFV row
+ * @throws std::invalid_argument for other block sizes
+ */
+void HomomorphicEncryption::sum_blocks_inplace(seal::Ciphertext& encrypted, size_t block_size) const {
+    HE_PROBE_METHOD("sum_blocks", 1, ciphertext_bytes(encrypted));
+    const size_t max_block = use_ckks ? slot_count() : slot_count() / 2;
+    if (block_size == 0 || (block_size & (block_size - 1)) != 0 || block_size > max_block) {
+        throw std::invalid_argument("block_size must be a power of two up to " + std::to_string(max_block));
+    }
+    std::vector<int> steps;
+    for (size_t step = 1; step < block_size; step <<= 1) steps.push_back(static_cast<int>(step));
+    auto keys = rotation_keys(steps);
+    if (block_size > 1 && keys->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+    
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::MemoryPoolHandle pool = scratch_pool();
+    seal::Ciphertext rotated(pool);
+    for (size_t step = 1; step < block_size; step <<= 1) {
+        if (use_ckks) {
+            evaluator->rotate_vector(encrypted, static_cast<int>(step), keys->galois_keys, rotated, pool);
+        } else {
+            evaluator->rotate_rows(encrypted, static_cast<int>(step), keys->galois_keys, rotated, pool);
+        }
+        evaluator->add_inplace(encrypted, rotated);
+    }
+}
+
+/**
+ * Rotate one packed ciphertext by several steps (rows for BFV, the vector for CKKS)
+ * The key switching input is decomposed once and shared by all rotations with
+ * their own Galois key, which is several times cheaper than one rotation per
+ * step; sum_slots_inplace cannot use this since each of its steps depends on
+ * the previous one
+ * 
+ * @param encrypted Packed ciphertext to rotate
+ * @param steps Rotation steps (positive left, negative right)
+ * @return One rotated ciphertext per step
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::rotate_many(const seal::Ciphertext& encrypted,
+                                                                 const std::vector<int>& steps) const {
+    HE_PROBE_METHOD("rotate_many", steps.size(), ciphertext_bytes(encrypted));
+    auto keys = rotation_keys(steps);
+    if (keys->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    std::vector<seal::Ciphertext> rotated;
+    evaluator->rotate_many(encrypted, steps, keys->galois_keys, rotated, scratch_pool());
+    return rotated;
+}
+
+/**
+ * Move the values packed into a ciphertext's first slots up by offset slots,
+ * e.g. to add them after the values of another partially filled ciphertext
+ * 
+ * The move is a rotation of the first row (the whole vector for CKKS) left by
+ * row - offset, one power-of-two step per set bit with the slot_sum keys, so
+ * the slots that wrap around to the front must be zero: those from slot
+ * `slots` on, as encrypt_vector leaves them. A BFV or BGV second row must be
+ * zero as well, since rotate_rows turns both rows alike.
+ * 
+ * @param encrypted Packed ciphertext whose slots from `slots` on are zero
+ * @param offset Slots to move up by
+ * @param slots Slots holding values
+ * @return false, leaving encrypted unchanged, if offset + slots exceeds the row
+ * @throws std::runtime_error without Galois keys
+ */
+bool HomomorphicEncryption::shift_slots_inplace(seal::Ciphertext& encrypted, size_t offset, size_t slots) const {
+    const size_t row = use_ckks ? slot_count() : slot_count() / 2;
+    if (offset + slots > row) return false;
+    const size_t steps = (row - offset) % row;
+    if (steps == 0) return true;
+    HE_PROBE_METHOD("shift_slots", 1, ciphertext_bytes(encrypted));
+    auto keys = rotation_keys(slot_sum_steps());
+    if (keys->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    rotate_left_inplace(encrypted, steps, keys->galois_keys, scratch_pool());
+    return true;
+}
+
+/**
+ * Rotate the rows (the whole vector for CKKS) left by steps, one
+ * power-of-two rotation per set bit with the slot_sum keys
+ */
+void HomomorphicEncryption::rotate_left_inplace(seal::Ciphertext& encrypted, size_t steps,
+                                                const seal::GaloisKeys& galois_keys,
+                                                seal::MemoryPoolHandle pool) const {
+    const size_t row = use_ckks ? slot_count() : slot_count() / 2;
+    for (size_t step = 1; step < row; step <<= 1) {
+        if ((steps & step) == 0) continue;
+        if (use_ckks) {
+            evaluator->rotate_vector_inplace(encrypted, static_cast<int>(step), galois_keys, pool);
+        } else {
+            evaluator->rotate_rows_inplace(encrypted, static_cast<int>(step), galois_keys, pool);
+        }
+    }
+}
+
+/**
+ * Pack single-value ciphertexts, e.g. a column stored before packing, into
+ * as few ciphertexts as encrypt_vector would have made of the values
+ * 
+ * @param ciphertexts Ciphertexts of encrypt(double) (or sums of them), all at one level
+ * @param count Number of ciphertexts
+ * @return ceil(count / slot_count()) packed ciphertexts, the last one's slots
+ *         past the values zero; CKKS ones a level below the inputs
+ * @throws std::invalid_argument for no ciphertexts, ciphertexts of other sizes
+ *         or levels, or (CKKS) an input level without a level below it
+ * @throws std::runtime_error without the slot_sum Galois keys (BFV and BGV)
+ * 
+ * Needs no secret key, so data already stored benefits from packed sums and
+ * its smaller size without the key holder. The inputs are split in chunks of
+ * repack_chunk values, packed concurrently on the thread pool and added into
+ * their packed ciphertext; see repack_chunk_of for each scheme's method.
+ */
+std::vector<seal::Ciphertext> HomomorphicEncryption::repack(const seal::Ciphertext* ciphertexts,
+                                                            size_t count) const {
+    HE_PROBE_METHOD("repack", count, ciphertext_bytes(ciphertexts, count));
+    if (count == 0) throw std::invalid_argument("Cannot repack empty vector of ciphertexts");
+    for (size_t i = 0; i < count; i++) {
+        if (ciphertexts[i].size() != 2 || ciphertexts[i].parms_id() != ciphertexts[0].parms_id()) {
+            throw std::invalid_argument("Repacking needs relinearized ciphertexts at one level");
+        }
+    }
+    std::shared_ptr<const KeySet> keys;
+    if (use_ckks) {
+        if (!can_mask(ciphertexts[0])) throw std::invalid_argument("Repacking CKKS ciphertexts needs a level");
+    } else {
+        keys = rotation_keys(slot_sum_steps());
+        if (keys->galois_keys.size() == 0) throw std::runtime_error("Galois keys not loaded");
+    }
+
+    const size_t slots = slot_count();
+    const size_t chunk = std::min(repack_chunk, use_ckks ? slots : slots / 2);
+    const size_t chunks = (count + chunk - 1) / chunk;
+    std::vector<seal::Ciphertext> partials(chunks);
+    parallel_for(chunks, [&](size_t c) {
+        const size_t begin = c * chunk;
+        partials[c] = repack_chunk_of(ciphertexts + begin, std::min(chunk, count - begin), begin % slots, keys.get());
+    });
+
+    const size_t chunks_per_packed = slots / chunk;
+    std::vector<seal::Ciphertext> packed((count + slots - 1) / slots);
+    parallel_for(packed.size(), [&](size_t p) {
+        const size_t first = p * chunks_per_packed;
+        const size_t last = std::min(chunks, first + chunks_per_packed);
+        packed[p] = std::move(partials[first]);
+        for (size_t c = first + 1; c < last; c++) evaluator->add_inplace(packed[p], partials[c]);
+        if (use_ckks) evaluator->rescale_to_next_inplace(packed[p], scratch_pool());
+    });
+    return packed;
+}
+
+/**
+ * Pack up to repack_chunk single-value ciphertexts into slots offset, offset + 1, ...
+ * (within one row)
+ * 
+ * CKKS: encrypt(double) broadcasts the value, so no rotation is needed: each
+ * ciphertext is multiplied by the one-hot mask of its slot, encoded at the
+ * scale of the prime the caller's rescale drops. BFV and BGV: the value is in
+ * slot 0 and every other slot is zero, so no mask is needed. Horner's scheme
+ * by rotations of one slot, acc = rotate(acc, 1) + next, leaves the chunk's
+ * values in consecutive slots for one key switch per ciphertext, and a final
+ * rotation (one per set bit of its step) moves them to offset; a chunk of the
+ * second batching row also has the rows swapped.
+ */
+seal::Ciphertext HomomorphicEncryption::repack_chunk_of(const seal::Ciphertext* ciphertexts, size_t count,
+                                                        size_t offset, const KeySet* keys) const {
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    // The result outlives this thread's scratch pool (it goes back through
+    // parallel_for and may be freed elsewhere), so only temporaries use it
+    seal::MemoryPoolHandle pool = scratch_pool();
+    seal::Ciphertext packed(seal::MemoryManager::GetPool());
+    if (use_ckks) {
+        auto context_data = context->get_context_data(ciphertexts[0].parms_id());
+        const double dropped_prime = static_cast<double>(context_data->parms().coeff_modulus().back().value());
+        std::vector<double> one_hot(slot_count(), 0.0);
+        seal::Plaintext mask(pool);
+        seal::Ciphertext product(pool);
+        for (size_t i = 0; i < count; i++) {
+            one_hot[offset + i] = 1.0;
+            ckks_encoder->encode(one_hot, ciphertexts[i].parms_id(), dropped_prime, mask, pool);
+            one_hot[offset + i] = 0.0;
+            if (i == 0) {
+                evaluator->multiply_plain(ciphertexts[i], mask, packed, pool);
+            } else {
+                evaluator->multiply_plain(ciphertexts[i], mask, product, pool);
+                evaluator->add_inplace(packed, product);
+            }
+        }
+        return packed;
+    }
+
+    packed = ciphertexts[0];
+    for (size_t i = 1; i < count; i++) {
+        evaluator->rotate_rows_inplace(packed, 1, keys->galois_keys, pool);
+        evaluator->add_inplace(packed, ciphertexts[i]);
+    }
+    // Value i is now in slot i - (count - 1) of the first row
+    const size_t row = slot_count() / 2;
+    const size_t target = offset % row + count - 1;
+    rotate_left_inplace(packed, (row - target % row) % row, keys->galois_keys, pool);
+    if (offset >= row) evaluator->rotate_columns_inplace(packed, keys->galois_keys, pool);
+    return packed;
+}
+
+/**
+ * Exchange the two batching rows of a BFV or BGV ciphertext (rotate_many
+ * only rotates within the rows)
+ * 
+ * @param encrypted Packed ciphertext
+ * @return Ciphertext whose slot r * N/2 + i holds slot (1 - r) * N/2 + i of encrypted
+ * @throws std::invalid_argument for CKKS, whose slots form a single row
+ * @throws std::runtime_error without the column rotation's Galois key
+ */
+seal::Ciphertext HomomorphicEncryption::swap_rows(const seal::Ciphertext& encrypted) const {
+    HE_PROBE_METHOD("swap_rows", 1, ciphertext_bytes(encrypted));
+    if (use_ckks) throw std::invalid_argument("CKKS slots have no rows to swap");
+    auto keys = rotation_keys({0});
+    if (!has_galois_key(0)) throw std::runtime_error("Galois key for the row swap not loaded");
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::Ciphertext swapped;
+    evaluator->rotate_columns(encrypted, keys->galois_keys, swapped, scratch_pool());
+    return swapped;
+}
+
+/**
+ * Separate the two columns of a paired CKKS ciphertext (see encrypt_vector_pair)
+ * 
+ * With z = values + i * paired in a slot, values = (z + conj z) / 2 and
+ * paired = i * (conj z - z) / 2: one conjugation (a key switch), an addition,
+ * a subtraction and a product by the constant i. SEAL's slots have no
+ * monomial that is i in all of them, so i is encoded at the scale of the
+ * prime the rescale drops, like encode_weights' weights, and both columns
+ * end one level down. The halving doubles the scale, which restores the
+ * profile's scale that encrypt_vector_pair halved.
+ * 
+ * @param encrypted Paired ciphertext, e.g. a sum of encrypt_vector_pair's
+ * @return {values, paired} one level below encrypted, at twice its scale
+ * @throws std::invalid_argument for BFV or BGV, or a ciphertext at the last level
+ * @throws std::runtime_error without the "conjugate" Galois key
+ */
+std::pair<seal::Ciphertext, seal::Ciphertext> HomomorphicEncryption::split_pair(
+    const seal::Ciphertext& encrypted) const {
+    HE_PROBE_METHOD("split_pair", 1, ciphertext_bytes(encrypted));
+    if (!use_ckks) throw std::invalid_argument("Only CKKS slots hold value pairs");
+    auto context_data = context->get_context_data(encrypted.parms_id());
+    if (!context_data || !context_data->next_context_data()) {
+        throw std::invalid_argument("Splitting a pair needs a level left");
+    }
+    auto keys = rotation_keys({0});
+    if (!has_galois_key(0)) throw std::runtime_error("Galois key for complex conjugation not loaded");
+
+    metrics::ScopedTimer timer(metrics::stage(scheme_name(), "evaluate"));
+    seal::MemoryPoolHandle pool = scratch_pool();
+    seal::Ciphertext conjugate(pool);
+    evaluator->complex_conjugate(encrypted, keys->galois_keys, conjugate, pool);
+    seal::Plaintext unit(pool);
+    double unit_scale = static_cast<double>(context_data->parms().coeff_modulus().back().value());
+    ckks_encoder->encode(std::complex<double>(0.0, 1.0), encrypted.parms_id(), unit_scale, unit, pool);
+
+    std::pair<seal::Ciphertext, seal::Ciphertext> columns;
+    evaluator->add(encrypted, conjugate, columns.first);
+    evaluator->mod_switch_to_next_inplace(columns.first, pool);
+    evaluator->sub(conjugate, encrypted, columns.second);
+    evaluator->multiply_plain_inplace(columns.second, unit, pool);
+    evaluator->rescale_to_next_inplace(columns.second, pool);
+    columns.first.scale() *= 2;
+    columns.second.scale() = columns.first.scale();  // Exactly: the rescale divides by unit_scale
+    return columns;
+}
+
+/**
+ * Compute the total of all slots of a packed ciphertext
+ * 
+ * @param encrypted_data Base64-encoded packed ciphertext (e.g. from encrypt_vector or sum)
+ * @param wire Wire encoding of the input and the result, compression of the result
+ * @return Base64-encoded ciphertext whose every slot holds the total
+ * 
+ * Combined with encrypt_vector this turns a column total into
+ * ceil(n / slot_count) - 1 additions plus log2(slot_count) rotations.
+ */
+std::string HomomorphicEncryption::sum_slots(std::string_view encrypted_data, const WireOptions& wire) const {
+    seal::Ciphertext encrypted = deserialize(encrypted_data, wire.format);
+    sum_slots_inplace(encrypted);
+    return serialize(encrypted, wire);
+}
+
+/**
+ * Serialize the Galois keys to Base64 string for sharing with an evaluation server
+ * 
+ * @param wire Compression (and optional size report) for the keys; the format is always Base64
+ * @return Base64-encoded Galois keys
+ */
+std::string HomomorphicEncryption::serialize_galois_keys(const WireOptions& wire) const {
+    HE_PROBE_METHOD("serialize_galois_keys", 0, 0);
+    std::string out;
+    auto keys = rotation_keys(rotation_steps({"slot_sum", "matvec"}));
+    save_wire(keys->galois_keys, out, WireOptions(WireFormat::base64, wire.compression, wire.stats), scheme_name());
+    return out;
+}
+
+/**
+ * Serialize the Galois keys of some rotations only, e.g. for a server that
+ * runs packed sums but no matrix products
+ * 
+ * @param steps Rotation steps; those without a key of their own are left out
+ * @param wire Compression (and optional size report); the format is always Base64
+ * @return Base64-encoded Galois keys holding at most one key per step
+ */
+std::string HomomorphicEncryption::serialize_galois_keys(const std::vector<int>& steps,
+                                                         const WireOptions& wire) const {
+    HE_PROBE_METHOD("serialize_galois_keys", steps.size(), 0);
+    auto keys = rotation_keys(steps);
+    seal::GaloisKeys subset;
+    subset.data().resize(keys->galois_keys.data().size());
+    subset.parms_id() = keys->galois_keys.parms_id();
+    auto galois_tool = context->key_context_data()->galois_tool();
+    for (int step : steps) {
+        uint32_t element = galois_tool->get_elt_from_step(step);
+        if (!keys->galois_keys.has_key(element)) continue;
+        size_t index = seal::GaloisKeys::get_index(element);
+        subset.data()[index] = keys->galois_keys.expanded_key(index);
+    }
+    std::string out;
+    save_wire(subset, out, WireOptions(WireFormat::base64, wire.compression, wire.stats), scheme_name());
+    return out;
+}
+
+/**
+ * Load Galois keys from Base64 string, enabling sum_slots on a server without secret key
+ * 
+ * @param serialized_keys Base64-encoded Galois keys string (or raw GaloisKeys::save bytes)
+ * @param format Encoding of serialized_keys
+ */
+void HomomorphicEncryption::load_galois_keys(std::string_view serialized_keys, WireFormat format) {
+    HE_PROBE_METHOD("load_galois_keys", 1, serialized_keys.size());
+    seal::GaloisKeys loaded;
+    load_wire(loaded, *context, serialized_keys.data(), serialized_keys.size(), format, scheme_name());
+    // Parsed outside the lock; requests rotating meanwhile finish with the previous keys
+    std::lock_guard<std::mutex> lock(key_update_mutex);
+    auto keys = copy_keys();
+    keys->galois_keys = std::move(loaded);
+    keys->galois_store.reset();  // The posted keys replace the stored ones, lazy or not
+    keys->galois_absent.clear();
+    keys->seeded_galois_keys.reset();
+    keys->galois_pending = false;
+    publish(std::move(keys));
+}
+
+/**
+ * Relinearization and Galois keys to install on an evaluation server with
+ * load_evaluation_keys, e.g. through mini-backend's GET /binary/evaluation_keys
+ * 
+ * Keys are sent as generate_keys saved them: seeded, the second polynomial of
+ * every key switching key component replaced by its PRNG seed, so about half
+ * of the 20+ MB of the default profile's keys (hundreds of MB for larger
+ * profiles). Keys without seeded bytes (e.g. posted to this instance with
+ * load_galois_keys) are sent in full.
+ * 
+ * @param stats If set, gets the keys' expanded, uncompressed size as raw_bytes
+ *              and the size of what is sent as wire_bytes
+ * @return {relin_keys, galois_keys} as raw SEAL bytes, empty for missing keys
+ */
+std::vector<std::string> HomomorphicEncryption::serialize_evaluation_keys(WireStats* stats) const {
+    HE_PROBE_METHOD("serialize_evaluation_keys", 0, 0);
+    expanded_keys(false);
+    auto keys = expanded_keys(true);
+    std::vector<std::string> out(2);
+    auto serialize_key = [&](const auto& key, const std::shared_ptr<const std::string>& seeded, std::string& bytes) {
+        if (key.size() == 0) return;
+        if (seeded) {
+            bytes = *seeded;
+        } else {
+            save_bytes(key, bytes);
+        }
+        if (stats) {
+            stats->raw_bytes += static_cast<size_t>(key.save_size(seal::compr_mode_type::none));
+            stats->wire_bytes += bytes.size();
+        }
+    };
+    serialize_key(keys->relin_keys, keys->seeded_relin_keys, out[0]);
+    serialize_key(keys->galois_keys, keys->seeded_galois_keys, out[1]);
+    return out;
+}
+
+/**
+ * Install relinearization and Galois keys from serialize_evaluation_keys
+ * 
+ * Only the SEAL headers are checked here: each key is kept as sent (seeded
+ * and compressed) until the first relinearization or rotation needs it, so an
+ * engine that never multiplies never expands its relinearization key, and the
+ * posting request does not wait for hundreds of MB to be expanded. A key
+ * that does not fit the parameters fails that first operation instead.
+ * Galois keys replace any in the key store, as with load_galois_keys.
+ * 
+ * @param relin_keys Raw SEAL bytes of the relinearization keys, or empty
+ * @param galois_keys Raw SEAL bytes of the Galois keys, or empty
+ */
+void HomomorphicEncryption::load_evaluation_keys(std::string_view relin_keys, std::string_view galois_keys) {
+    HE_PROBE_METHOD("load_evaluation_keys", 2, relin_keys.size() + galois_keys.size());
+    if (!relin_keys.empty()) check_serialized(relin_keys, "relinearization keys");
+    if (!galois_keys.empty()) check_serialized(galois_keys, "Galois keys");
+    auto relin_bytes = relin_keys.empty() ? nullptr : std::make_shared<const std::string>(relin_keys);
+    auto galois_bytes = galois_keys.empty() ? nullptr : std::make_shared<const std::string>(galois_keys);
+
+    std::lock_guard<std::mutex> lock(key_update_mutex);
+    auto keys = copy_keys();
+    if (relin_bytes) {
+        keys->relin_keys = seal::RelinKeys();
+        keys->seeded_relin_keys = std::move(relin_bytes);
+        keys->relin_pending = true;
+    }
+    if (galois_bytes) {
+        keys->galois_keys = seal::GaloisKeys();
+        keys->galois_store.reset();
+        keys->galois_absent.clear();
+        keys->seeded_galois_keys = std::move(galois_bytes);
+        keys->galois_pending = true;
+    }
+    publish(std::move(keys));
+}
@@ -1,43 +1,562 @@
 #ifndef HOMOMORPHIC_ENCRYPTION_H
 #define HOMOMORPHIC_ENCRYPTION_H
 
+#include "ParameterProfile.h"
+#include "PatientPacking.h"
+#include "PlaintextCache.h"
 #include "seal/seal.h"
+#include "seal/util/hugepages.h"
+#include <algorithm>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <stdexcept>
 #include <vector>
+#include <utility>
 
+class ThreadPool;
+class KeyStore;
+class ZeroPool;
+struct PolynomialStats;
+struct InverseApproximation;
+struct LogisticModel;
+class CentroidPacking;
+class PsiServerSet;
+
+// Encoding of serialized ciphertexts: Base64 text for JSON, raw SEAL bytes for binary transport
+enum class WireFormat { base64, binary };
+
+// What loading a ciphertext checks. full: every coefficient against its modulus (SEAL's load), for
+// anything a client sent. trusted: only the header, parms_id and buffer size (unsafe_load), for
+// bytes this deployment produced from validated ciphertexts (its column files, --trusted-workers)
+enum class LoadCheck { full, trusted };
+
+// Byte counts of serialized output: uncompressed SEAL size vs. what was actually produced,
+// and the shape of the ciphertexts among it (lowest level, largest size in polynomials)
+struct WireStats {
+    size_t raw_bytes = 0;
+    size_t wire_bytes = 0;
+    size_t ciphertexts = 0;
+    size_t min_level = 0;
+    size_t max_size = 0;
+
+    void add_ciphertext(size_t level, size_t size) {
+        min_level = ciphertexts ? std::min(min_level, level) : level;
+        max_size = std::max(max_size, size);
+        ciphertexts++;
+    }
+    void merge(const WireStats& other) {
+        raw_bytes += other.raw_bytes;
+        wire_bytes += other.wire_bytes;
+        if (!other.ciphertexts) return;
+        min_level = ciphertexts ? std::min(min_level, other.min_level) : other.min_level;
+        max_size = std::max(max_size, other.max_size);
+        ciphertexts += other.ciphertexts;
+    }
+};
+
+// What decrypting a ciphertext can still count on: level (chain index, 0 = last prime) out of
+// max_level, size in polynomials, CKKS scale, and BFV / BGV invariant noise budget in bits (-1
+// when it cannot be measured: CKKS, or no secret key)
+struct CiphertextInfo {
+    size_t level = 0;
+    size_t max_level = 0;
+    size_t size = 0;
+    size_t coeff_modulus_count = 0;
+    double scale = 1.0;
+    int noise_budget = -1;
+};
+
+// How serialized output is produced: wire encoding, SEAL compression mode and optional size report
+struct WireOptions {
+    WireFormat format;
+    seal::compr_mode_type compression;
+    WireStats* stats;
+    bool compact = false;  // Ciphertexts only: switch to the lowest safe level first (see compact_parms_id)
+
+    WireOptions(WireFormat format = WireFormat::base64,
+                seal::compr_mode_type compression = seal::Serialization::compr_mode_default,
+                WireStats* stats = nullptr)
+        : format(format), compression(compression), stats(stats) {}
+};
+
+// Serialized ciphertexts by reference (into a JSON DOM, a request body or owned strings), so a
+// request's ciphertexts are decoded once and never copied on the way in
+using CiphertextViews = std::vector<std::string_view>;
+inline CiphertextViews views(const std::vector<std::string>& ciphertexts) {
+    return CiphertextViews(ciphertexts.begin(), ciphertexts.end());
+}
+
+// Compression mode names used by the HTTP API ("none", "zlib", "zstd", "bitpack")
+seal::compr_mode_type parse_compr_mode(const std::string& name);
+const char* compr_mode_name(seal::compr_mode_type mode);
+
+// Scheme names used by the HTTP API ("bfv", "ckks", "bgv"; see HomomorphicEncryption::scheme_name)
+seal::scheme_type parse_scheme(const std::string& name);
+
+// Hex BLAKE2b-128 of serialized key bytes, e.g. for HomomorphicEncryption::public_key_fingerprint()
+std::string key_fingerprint(std::string_view bytes);
+
+// Huge page mode names of --huge-pages ("off", "thp", "2mb", "1gb")
+seal::util::huge_page_mode parse_huge_page_mode(const std::string& name);
+const char* huge_page_mode_name(seal::util::huge_page_mode mode);
+
+// PRNG names of --prng ("blake2xb", "shake256", "aes128ctr")
+seal::prng_type parse_prng(const std::string& name);
+const char* prng_name(seal::prng_type type);
+// Make SEAL's default PRNG factory one of the given type (see --prng)
+void set_default_prng(seal::prng_type type);
+
+/**
+ * Thread safety: the const methods may be called from any number of threads at
+ * once, and so may the key setters (generate_keys, load_keys, load_public_key,
+ * load_galois_keys, load_evaluation_keys) alongside them. Key setters publish a
+ * new key set atomically and readers never lock: each encryption, decryption or
+ * key switch uses one consistent set, the one current when it started. SEAL's Encryptor,
+ * Evaluator, Decryptor and encoders are safe to share, so there is one of each
+ * rather than one per thread. The set_* configuration methods are for startup,
+ * before the instance is shared.
+ */
 class HomomorphicEncryption {
 public:
-    HomomorphicEncryption(bool use_ckks = false, bool generate_keys = true);
+    HomomorphicEncryption(bool use_ckks = false, bool generate_keys = true,
+                          const ParameterProfile& profile = profiles::default_profile());
+    // Any of bfv, ckks and bgv (see init_bgv for how BGV ciphertexts move down the chain)
+    HomomorphicEncryption(seal::scheme_type scheme, bool generate_keys = true,
+                          const ParameterProfile& profile = profiles::default_profile());
+    // Parameters chosen by profiles::select() for the requirements' scheme
+    explicit HomomorphicEncryption(const ParameterRequirements& requirements, bool generate_keys = true);
     ~HomomorphicEncryption();
 
-    std::string encrypt(double value) const;
-    double decrypt(const std::string& encrypted_data) const;
-    std::string add(const std::string& encrypted_a, const std::string& encrypted_b) const;
-    std::string serialize_public_key() const;
-    void load_public_key(const std::string& serialized_key);
-    std::string sum(const std::vector<std::string>& ciphertexts) const;
+    // An engine without keys over the same parameters, sharing this one's context (and its NTT
+    // tables), evaluator, encoders, plaintext cache and configuration, so that another key set
+    // (e.g. a tenant's, see TenantRegistry) costs only its keys
+    std::unique_ptr<HomomorphicEncryption> share_parameters() const;
+    // Bytes held by the current keys, by their uncompressed serialized size
+    size_t key_bytes() const;
+
+    const ParameterProfile& parameter_profile() const { return profile; }
+    bool is_ckks() const { return use_ckks; }
+    seal::scheme_type scheme() const { return parms.scheme(); }
+    // "bfv", "ckks" or "bgv", as the HTTP API names schemes
+    const char* scheme_name() const { return use_ckks ? "ckks" : use_bgv ? "bgv" : "bfv"; }
+    // Whether products drop a level once settled: CKKS rescales, BGV switches modulus (BFV does neither)
+    bool rescales() const { return use_ckks || use_bgv; }
+
+    std::string encrypt(double value, const WireOptions& wire = {}) const;
+    double decrypt(std::string_view encrypted_data, WireFormat format = WireFormat::base64,
+                   CiphertextInfo* info = nullptr) const;
+    std::string add(std::string_view encrypted_a, std::string_view encrypted_b,
+                    const WireOptions& wire = {}) const;
+    std::string serialize_public_key(const WireOptions& wire = {}) const;
+    // Loading the bytes already loaded last time keeps the key and encryptor as they are
+    void load_public_key(std::string_view serialized_key);
+    // key_fingerprint() of the public key's uncompressed serialization, whatever it was loaded
+    // from (e.g. a weak ETag); empty without a public key
+    std::string public_key_fingerprint() const { return keys()->public_key_fingerprint; }
+    std::string sum(const CiphertextViews& ciphertexts, const WireOptions& wire = {}) const;
+    // The same sum as an object, for in-process pipelines (no serialize/deserialize round trip)
+    seal::Ciphertext deserialize_sum(const CiphertextViews& ciphertexts, WireFormat format = WireFormat::base64,
+                                     LoadCheck check = LoadCheck::full) const;
+    // Serialized ciphertexts pulled one at a time (e.g. json_stream::StringArray::next): points
+    // data/size at the next one, in the source or in scratch, and returns false once exhausted
+    using CiphertextSource = std::function<bool(std::string& scratch, const char*& data, size_t& size)>;
+    // sum() of count ciphertexts deserialized as they are pulled, never all held at once
+    std::string sum(const CiphertextSource& next, size_t count, const WireOptions& wire = {}) const;
+    seal::Ciphertext deserialize_sum(const CiphertextSource& next, size_t count,
+                                     WireFormat format = WireFormat::base64) const;
+    // First two moments from one upload of x: {sum(x), sum(x^2)}, e.g. for the variance.
+    // The squares are added unrelinearized, then relinearized (and rescaled or switched down) once
+    std::pair<std::string, std::string> moments(const CiphertextViews& ciphertexts, bool packed,
+                                                const WireOptions& wire = {}) const;
+    // Mean of the inputs' values (count of them; packed inputs are slot-summed): CKKS divides
+    // server-side, BFV and BGV cannot and return the sum. divided reports which one the result is
+    std::string average(const CiphertextViews& ciphertexts, size_t count, bool packed,
+                        const WireOptions& wire = {}, bool* divided = nullptr) const;
+
+    // Batched API: packs values into every slot, chunking across ciphertexts
+    std::vector<std::string> encrypt_vector(const std::vector<double>& values,
+                                            const WireOptions& wire = {}) const;
+    std::vector<double> decrypt_vector(const CiphertextViews& ciphertexts, size_t count = 0) const;
+    // The first slots slots (0: slot_count()) of every ciphertext, decrypted and decoded concurrently
+    // on the thread pool: ciphertext i's at [i * slots, (i + 1) * slots). BFV slots come out exact as
+    // integers; decrypt_batch_integers rounds CKKS ones
+    std::vector<double> decrypt_batch(const CiphertextViews& ciphertexts, WireFormat format = WireFormat::base64,
+                                      size_t slots = 0) const;
+    std::vector<int64_t> decrypt_batch_integers(const CiphertextViews& ciphertexts,
+                                                WireFormat format = WireFormat::base64, size_t slots = 0) const;
+    // Values of the given slots of one ciphertext (BFV and BGV signed, as decrypt_vector), each decoded
+    // as one inner product with its root of unity instead of a full decode when there are few of them
+    std::vector<double> decrypt_slots(std::string_view encrypted_data, const std::vector<size_t>& slots,
+                                      WireFormat format = WireFormat::base64) const;
+    std::vector<double> decrypt_slots(const seal::Ciphertext& encrypted, const std::vector<size_t>& slots) const;
+    size_t slot_count() const;
+    // BFV and BGV plaintext modulus (0 for CKKS)
+    std::uint64_t plain_modulus() const { return use_ckks ? 0 : parms.plain_modulus().value(); }
+
+    // Seeded symmetric mode: encrypts with the secret key and replaces the second
+    // polynomial by its PRNG seed, roughly halving the upload; load() expands it
+    std::string encrypt_symmetric(double value, const WireOptions& wire = {}) const;
+    std::vector<std::string> encrypt_vector_symmetric(const std::vector<double>& values,
+                                                      const WireOptions& wire = {}) const;
+    // CKKS: two real columns in one set of ciphertexts, values + i * paired in each complex slot,
+    // so sums and slot sums of both take half the ciphertexts. decrypt_vector_pair separates them
+    // on the client; split_pair on the server, e.g. before a product
+    std::vector<std::string> encrypt_vector_pair(const std::vector<double>& values, const std::vector<double>& paired,
+                                                 bool symmetric = false, const WireOptions& wire = {}) const;
+    std::pair<std::vector<double>, std::vector<double>> decrypt_vector_pair(const CiphertextViews& ciphertexts,
+                                                                            size_t count = 0) const;
+
+    // Slot reduction: rotation-and-add so every slot holds the total
+    std::string sum_slots(std::string_view encrypted_data, const WireOptions& wire = {}) const;
+    std::string serialize_galois_keys(const WireOptions& wire = {}) const;
+    // Only the keys for the given rotation steps (e.g. rotation_steps({"slot_sum"}))
+    std::string serialize_galois_keys(const std::vector<int>& steps, const WireOptions& wire = {}) const;
+    void load_galois_keys(std::string_view serialized_keys, WireFormat format = WireFormat::base64);
+
+    // Relinearization and Galois keys for an evaluation server, {relin_keys, galois_keys} as raw
+    // SEAL bytes (empty for keys this instance has none of). Keys from generate_keys are sent in
+    // seeded form, which halves them like encrypt_symmetric's ciphertexts, and compressed with
+    // compr_mode_default; stats gets their expanded, uncompressed size as raw_bytes
+    std::vector<std::string> serialize_evaluation_keys(WireStats* stats = nullptr) const;
+    // Install serialize_evaluation_keys' keys (an empty one leaves the current key alone). They are
+    // kept as sent and expanded the first time a relinearization or rotation needs them
+    // @throws std::invalid_argument for bytes that are not a SEAL object
+    void load_evaluation_keys(std::string_view relin_keys, std::string_view galois_keys);
+
+    // Rotation steps of the operations that need Galois keys: "slot_sum" (packed sums and
+    // averages, group-by, histograms, comparisons, logistic regression), "matvec" (slot
+    // sums plus the profile's baby steps, see DiagonalMatrix), "prefix_sum" and "conjugate"
+    // (CKKS complex conjugation, for split_pair)
+    // @throws std::invalid_argument for other names
+    std::vector<int> rotation_steps(const std::vector<std::string>& operations) const;
+    // Operations generate_keys() creates Galois keys for (default: all of them)
+    void set_rotation_operations(std::vector<std::string> operations);
+
+    // Key management: generate a fresh key set, or share one through a KeyStore. With
+    // lazy_galois_keys, each Galois key is read from the store when a rotation first needs it
+    void generate_keys();
+    bool load_keys(const KeyStore& store, bool include_secret_key = true, bool lazy_galois_keys = false);
+    void save_keys(const KeyStore& store) const;
+
+    // Client-assisted refresh (see RefreshMasks): the server masks a ciphertext that ran out of
+    // levels with values generated from seed (one stream per index), the key holder encrypts
+    // its decryption afresh, and the server removes the mask from the fresh ciphertext
+    void add_refresh_mask(seal::Ciphertext& encrypted, const seal::prng_seed_type& seed, size_t index,
+                          double bound) const;
+    void remove_refresh_mask(seal::Ciphertext& encrypted, const seal::prng_seed_type& seed, size_t index,
+                             double bound) const;
+    std::string refresh(const seal::Ciphertext& encrypted, bool symmetric, const WireOptions& wire = {}) const;
+    // Largest CKKS mask bound the ciphertext's level leaves room for (values must stay below it)
+    double refresh_mask_bound(const seal::Ciphertext& encrypted) const;
+
+    // Object API for server-side stored ciphertexts (no serialization round trip)
+    double decrypt(const seal::Ciphertext& encrypted, CiphertextInfo* info = nullptr) const;
+    seal::Ciphertext add(const seal::Ciphertext& a, const seal::Ciphertext& b) const;
+    void add_inplace(seal::Ciphertext& a, const seal::Ciphertext& b) const;
+    seal::Ciphertext sum(const std::vector<seal::Ciphertext>& ciphertexts) const;
+    seal::Ciphertext sum(const seal::Ciphertext* ciphertexts, size_t count) const;
+    void sum_slots_inplace(seal::Ciphertext& encrypted, size_t stride = 1) const;
+    // Rotate-and-add within blocks of block_size slots: slot b * block_size gets block b's total
+    void sum_blocks_inplace(seal::Ciphertext& encrypted, size_t block_size) const;
+    bool divide_inplace(seal::Ciphertext& encrypted, size_t divisor) const;
+    std::vector<seal::Ciphertext> rotate_many(const seal::Ciphertext& encrypted, const std::vector<int>& steps) const;
+    // Move the values in the first slots up by offset slots within the first rotation row;
+    // false, leaving encrypted unchanged, if offset + slots exceeds the row
+    bool shift_slots_inplace(seal::Ciphertext& encrypted, size_t offset, size_t slots) const;
+    // Single-value ciphertexts of encrypt(double) packed slot_count() to a ciphertext, value i in
+    // slot i as encrypt_vector lays them out; needs the slot_sum Galois keys (BFV and BGV) or a
+    // level (CKKS)
+    std::vector<seal::Ciphertext> repack(const seal::Ciphertext* ciphertexts, size_t count) const;
+    // BFV and BGV: the two batching rows exchanged (a column rotation)
+    seal::Ciphertext swap_rows(const seal::Ciphertext& encrypted) const;
+    // CKKS: a ciphertext of encrypt_vector_pair's (or a sum of them) as {values, paired}, each
+    // at the profile's scale one level down, using the "conjugate" Galois key
+    std::pair<seal::Ciphertext, seal::Ciphertext> split_pair(const seal::Ciphertext& encrypted) const;
+    bool has_galois_key(int step) const;
+
+    // Building blocks for lazy evaluation (see ExpressionEvaluator): multiply() leaves the
+    // product unrelinearized (size 3) and, for CKKS, at the product of the input scales;
+    // rescale_inplace drops the CKKS scale, or a BGV product's level, afterwards
+    seal::Ciphertext multiply(const seal::Ciphertext& a, const seal::Ciphertext& b) const;
+    void relinearize_inplace(seal::Ciphertext& encrypted) const;
+    void rescale_inplace(seal::Ciphertext& encrypted) const;
+    void match_level_inplace(seal::Ciphertext& a, seal::Ciphertext& b) const;
+
+    // Building blocks for polynomial evaluation (see PolynomialEvaluator): multiply_constant_to
+    // lands on an exact level and scale, so terms of different degrees add without fix-ups.
+    // The constant ones also take BFV and BGV ciphertexts and integer constants, which they
+    // apply without encoding a plaintext
+    size_t chain_index(const seal::Ciphertext& encrypted) const;
+    double dropped_prime(size_t chain_index) const;
+    void mod_switch_to_inplace(seal::Ciphertext& encrypted, size_t chain_index) const;
+    void multiply_constant_to(seal::Ciphertext& encrypted, double value, size_t chain_index, double target_scale) const;
+    void multiply_constant_inplace(seal::Ciphertext& encrypted, double value, double value_scale) const;
+    void add_constant_inplace(seal::Ciphertext& encrypted, double value) const;
+    void add_constant_inplace(seal::Ciphertext& encrypted, const std::vector<double>& values) const;
+
+    // Level a result can be switched down to before it is sent for decryption
+    seal::parms_id_type compact_parms_id(const seal::Ciphertext& encrypted) const;
+    // Level, size, scale and noise budget of a ciphertext (the budget costs about one decryption)
+    CiphertextInfo inspect(const seal::Ciphertext& encrypted) const;
+    bool has_relin_keys() const {
+        auto set = keys();
+        return set->relin_keys.size() > 0 || set->relin_pending;
+    }
+
+    // Weighted sums with resident NTT chains: weights are encoded once, slot-wise ones already
+    // in NTT form, and weighted_sum keeps BFV products in the evaluation domain until the end
+    // (CKKS and BGV ciphertexts live there)
+    std::vector<seal::Plaintext> encode_weights(const std::vector<double>& weights, bool packed,
+                                                seal::parms_id_type parms_id) const;
+    seal::Ciphertext weighted_sum(const seal::Ciphertext* terms, const std::vector<seal::Plaintext>& weights) const;
+    // BFV terms used by several weighted sums can be transformed to NTT form once beforehand
+    void transform_to_ntt_inplace(seal::Ciphertext& encrypted) const;
+
+    // Group-by over a packed column with one 0/1 slot mask per group; slot g of the result
+    // holds group g's sum
+    seal::Ciphertext group_sum(const seal::Ciphertext* column, size_t count,
+                               const std::vector<std::vector<double>>& masks) const;
+    // Totals of a packed column under many 0/1 row masks (e.g. WHERE filters) in one level: slot g
+    // (and every slot = g mod cross_sum_window(masks.size())) of the result holds mask g's total
+    seal::Ciphertext masked_sums(const seal::Ciphertext* column, size_t count,
+                                 const std::vector<std::vector<double>>& masks) const;
+    // Slot-wise squares of a packed column, relinearized (and rescaled or switched down), computed
+    // concurrently on the thread pool; e.g. masked_sums of them for filtered variances
+    std::vector<seal::Ciphertext> squares(const seal::Ciphertext* column, size_t count) const;
+
+    // Bucket counts of one-hot encodings packed bucket_count slots per value; slot b of the
+    // result holds bucket b's count
+    seal::Ciphertext histogram(const seal::Ciphertext* ciphertexts, size_t count, size_t bucket_count) const;
+
+    // Server side of private set intersection (see PrivateSetIntersection.h), BFV: the query's
+    // missing powers, then every partition's polynomials at them; one ciphertext per bundle and
+    // partition of each query batch, zero in both slots of the items the set holds
+    std::vector<seal::Ciphertext> set_intersection(const seal::Ciphertext* query, size_t count,
+                                                   const PsiServerSet& set) const;
+
+    // Totals of slot-wise products (or, b = none, sums) of packed columns, all in one ciphertext:
+    // slot k (and every slot = k mod cross_sum_window) of the result holds term k's total
+    struct CrossTerm {
+        static constexpr size_t none = static_cast<size_t>(-1);
+        size_t a = 0;
+        size_t b = none;
+    };
+    static size_t cross_sum_window(size_t terms) {
+        size_t window = 1;
+        while (window < terms) window <<= 1;
+        return window;
+    }
+    seal::Ciphertext cross_sums(const std::vector<const seal::Ciphertext*>& columns, size_t count,
+                                const std::vector<CrossTerm>& terms) const;
+    // Sums of two packed columns for their covariance and correlation (cross_sums of these terms)
+    enum CovarianceTerm : size_t { sum_xy, sum_x, sum_y, sum_x2, sum_y2, covariance_terms };
+    seal::Ciphertext covariance(const seal::Ciphertext* x, const seal::Ciphertext* y, size_t count) const;
+
+    // Totals of every feature (e.g. CSV column) over ciphertexts packed as PatientPacking rows,
+    // in one pass: slot packing.total_slot(f) of the result holds feature f's total
+    seal::Ciphertext feature_sums(const seal::Ciphertext* ciphertexts, size_t count,
+                                  const PatientPacking& packing) const;
+
+    // Running totals of a series chunked prefix_chunk_size() values per ciphertext, in its first
+    // slots: slot i of result c holds the sum of the series up to value c * chunk + i
+    size_t prefix_chunk_size() const { return (use_ckks ? slot_count() : slot_count() / 2) / 2; }
+    std::vector<seal::Ciphertext> prefix_sums(const seal::Ciphertext* ciphertexts, size_t count) const;
+    // Slot b < bucket_count of the result holds the count of histogram buckets 0 .. b (one level
+    // under CKKS and BGV, and the Galois keys of prefix_sum), for percentiles from one decryption
+    seal::Ciphertext cumulative_counts(const seal::Ciphertext& histogram, size_t bucket_count) const;
+
+    // Approximate comparisons (CKKS) of values in [-bound, bound], through a composite polynomial
+    // approximation of sign(x); every level left above the result headroom is spent on precision
+    seal::Ciphertext max(const seal::Ciphertext& a, const seal::Ciphertext& b, double bound) const;
+    seal::Ciphertext min(const seal::Ciphertext& a, const seal::Ciphertext& b, double bound) const;
+    // Largest (or smallest) of value_count packed values, in slot 0 of the result, after
+    // *rounds tournament rounds
+    seal::Ciphertext extremum(const seal::Ciphertext* ciphertexts, size_t count, size_t value_count, double bound,
+                              bool maximum, size_t* rounds = nullptr) const;
+    // How many of value_count packed values exceed threshold, in every slot of the result
+    seal::Ciphertext count_greater(const seal::Ciphertext* ciphertexts, size_t count, size_t value_count,
+                                   double threshold, double bound) const;
+
+    // p(x) slot-wise for each ciphertext (CKKS), e.g. a polynomial activation; stats, if set,
+    // receives the first evaluation's counts (all ciphertexts take the same steps)
+    std::vector<seal::Ciphertext> evaluate_polynomial(const seal::Ciphertext* ciphertexts, size_t count,
+                                                      const std::vector<double>& coefficients,
+                                                      PolynomialStats* stats = nullptr) const;
+    // Slot-wise 1/x, or 1/sqrt(x), of CKKS values known to lie in [low, high] (0 < low < high): a
+    // polynomial guess refined by Newton steps, the cheapest plan within tolerance (relative error;
+    // see InverseApproximation), which plan, if set, receives
+    std::vector<seal::Ciphertext> inverse(const seal::Ciphertext* ciphertexts, size_t count, double low, double high,
+                                          bool square_root, double tolerance = 1e-4,
+                                          InverseApproximation* plan = nullptr) const;
+    // z-scores (x - mean) / sd of a packed column of value_count values (CKKS), its population
+    // variance known to lie in [variance_low, variance_high], without decrypting either; reserve
+    // levels are left for later steps, e.g. a polynomial of the z-scores
+    std::vector<seal::Ciphertext> standardize(const seal::Ciphertext* column, size_t count, size_t value_count,
+                                              double variance_low, double variance_high, double tolerance = 1e-4,
+                                              size_t reserve = 0, InverseApproximation* plan = nullptr) const;
+    // Encrypted logistic regression scores (CKKS) of patients packed in the given layout:
+    // PatientPacking::score_slot(p) of each result holds patient p's probability
+    std::vector<seal::Ciphertext> logistic_regression(const seal::Ciphertext* ciphertexts, size_t count,
+                                                      const LogisticModel& model, size_t* depth = nullptr,
+                                                      PatientLayout layout = PatientLayout::sample_major) const;
+    // Encrypted logistic loss gradient X^T (sigmoid(X w + b) - y) of feature_major packed
+    // patients (CKKS): PatientPacking::total_slot(f) holds feature f's component
+    seal::Ciphertext logistic_gradient(const seal::Ciphertext* features, const seal::Ciphertext* labels,
+                                       size_t count, const LogisticModel& model,
+                                       const std::function<void(double)>& progress = nullptr) const;
+    // Squared distances of patients packed as a CentroidPacking to its centroids (CKKS; BFV and BGV
+    // on integers): distance_slot(p, j) of each result holds patient p's distance to centroid j
+    std::vector<seal::Ciphertext> centroid_distances(const seal::Ciphertext* ciphertexts, size_t count,
+                                                     const CentroidPacking& packing,
+                                                     const std::vector<std::vector<double>>& centroids) const;
+    std::shared_ptr<seal::SEALContext> seal_context() const { return context; }
+
+    // Parallel mode: sum() splits inputs of at least min_parallel_operands across the pool, in a tree
+    // fixed by their count (see parallel_sum), so results do not depend on the pool size
+    void set_thread_pool(std::shared_ptr<ThreadPool> pool, size_t min_parallel_operands = 64);
+
+    // Scratch memory from per-thread pools (default) or SEAL's global locked pool
+    void set_thread_local_pools(bool enabled);
+
+    // Relinearization and Galois key limbs modulo primes of at most 32 bits held as 32-bit words
+    void set_compact_keys(bool enabled);
+
+    // Or from per-thread bump-pointer arenas, reset by each thread after a request
+    void set_scratch_arenas(size_t initial_bytes);
+    static void reset_scratch_arena();
+
+    // Bound on the encoded constants and weights kept for reuse (default 64 MiB; 0 disables)
+    void set_plaintext_cache(size_t capacity_bytes);
+    const PlaintextCache& plaintext_cache() const { return *plaintexts; }
+    PlaintextCache& plaintext_cache() { return *plaintexts; }  // E.g. to put it under a MemoryBudget
+
+    // Keep capacity public-key encryptions of zero ready on a background thread, so encrypting
+    // is encode plus add (0 disables; not carried over by share_parameters)
+    void set_zero_pool(size_t capacity);
+    size_t zero_pool_size() const;
+
+    // Before serving: encrypt, add, multiply, slot-sum, serialize and decrypt rounds times on each
+    // thread of the pool (as far as the keys allow), then read every page of the keys, so the first
+    // requests do not pay for pool growth and page faults. Timed in he_warm_up_duration_microseconds
+    void warm_up(size_t rounds = 1) const;
+
+    // Ciphertext codec: byte-buffer save/load, no stream copies
+    std::string serialize(const seal::Ciphertext& ct, const WireOptions& wire = {}) const;
+    void serialize_into(const seal::Ciphertext& ct, std::string& out, const WireOptions& wire = {}) const;
+    seal::Ciphertext deserialize(std::string_view str, WireFormat format = WireFormat::base64,
+                                 LoadCheck check = LoadCheck::full) const;
+    seal::Ciphertext deserialize(const char* data, size_t size, WireFormat format = WireFormat::base64,
+                                 LoadCheck check = LoadCheck::full) const;
 
 private:
     bool use_ckks; 
+    bool use_bgv = false;  // Integer slots like BFV (every !use_ckks branch), ciphertexts in NTT form
+    ParameterProfile profile;
     seal::EncryptionParameters parms;
     std::shared_ptr<seal::SEALContext> context;
-    seal::PublicKey public_key;
-    seal::SecretKey secret_key;
-    seal::RelinKeys relin_keys;
-    std::unique_ptr<seal::Encryptor> encryptor;
-    std::unique_ptr<seal::Evaluator> evaluator;
-    std::unique_ptr<seal::Decryptor> decryptor;
-    std::unique_ptr<seal::CKKSEncoder> ckks_encoder;
-    std::unique_ptr<seal::BatchEncoder> bfv_encoder;
+    // The keys and the objects bound to them, never modified once published: a request takes
+    // one snapshot and uses it throughout, so a key update (e.g. POST /galois_keys) cannot
+    // change the keys under an operation in flight
+    struct KeySet {
+        seal::PublicKey public_key;
+        seal::SecretKey secret_key;
+        seal::RelinKeys relin_keys;
+        seal::GaloisKeys galois_keys;
+        std::unique_ptr<seal::Encryptor> encryptor;
+        std::unique_ptr<seal::Decryptor> decryptor;  // Only with the secret key
+        std::shared_ptr<const KeyStore> galois_store;  // Source of Galois keys not loaded yet (lazy)
+        std::set<uint32_t> galois_absent;              // Galois elements galois_store turned out not to have
+        std::string public_key_fingerprint;            // Set by publish()
+        std::string public_key_source;                 // key_fingerprint() of the bytes load_public_key parsed
+        // What serialize_evaluation_keys sends, seeded when generate_keys made the keys; pending while
+        // relin_keys / galois_keys are still to be expanded from them (load_evaluation_keys)
+        std::shared_ptr<const std::string> seeded_relin_keys;
+        std::shared_ptr<const std::string> seeded_galois_keys;
+        bool relin_pending = false;
+        bool galois_pending = false;
+    };
+    // Read with keys(); mutable because lazy Galois loads publish from const methods
+    mutable std::shared_ptr<const KeySet> key_set = std::make_shared<const KeySet>();
+    mutable std::mutex key_update_mutex;  // Serializes writers (and lazy Galois loads); readers never take it
+    std::shared_ptr<seal::Evaluator> evaluator;  // Shared with share_parameters() engines, like the encoders
+    std::shared_ptr<seal::CKKSEncoder> ckks_encoder;
+    std::shared_ptr<seal::BatchEncoder> bfv_encoder;  // BFV and BGV
+    seal::parms_id_type fresh_parms;  // Level of public-key encryptions (below the top for BGV)
     double scale;
+    std::shared_ptr<ThreadPool> thread_pool;
+    size_t min_parallel_operands = 64;
+    static constexpr size_t sum_batch = 8;  // Deserialized operands held per add_many call in sum_range
+    static constexpr size_t sum_reference_batch = 256;  // Referenced operands per add_many call (cancellation checks between)
+    static constexpr size_t sum_leaf_operands = 16;  // Fewest operands per leaf of parallel_sum's tree
+    static constexpr size_t max_sum_leaves = 64;
+    // Leaves of parallel_sum's tree for count operands, which depends on nothing else
+    static size_t sum_leaves(size_t count) {
+        return std::max<size_t>(1, std::min(max_sum_leaves, count / sum_leaf_operands));
+    }
+    static constexpr size_t repack_chunk = 64;  // Single-value ciphertexts per repack task (a power of two)
+    bool thread_local_pools = true;
+    size_t scratch_arena_bytes = 0;
+    bool compact_keys = false;
+    std::vector<std::string> rotation_operations{"slot_sum", "matvec"};
+    std::shared_ptr<PlaintextCache> plaintexts = std::make_shared<PlaintextCache>(size_t(64) << 20);
+    std::unique_ptr<ZeroPool> zero_pool;  // Last: its thread uses the members above until destroyed
+
+    struct SharedParameters {};
+    HomomorphicEncryption(const HomomorphicEncryption& base, SharedParameters);
     
-    std::string serialize(const seal::Ciphertext& ct) const;
-    seal::Ciphertext deserialize(const std::string& str) const;
     void init_bfv();
     void init_ckks();
-    void generate_keys();
+    void init_bgv();
+    std::shared_ptr<const KeySet> keys() const { return std::atomic_load(&key_set); }
+    void publish(std::unique_ptr<KeySet> keys) const;
+    std::unique_ptr<KeySet> copy_keys() const;
+    std::shared_ptr<const KeySet> rotation_keys(const std::vector<int>& steps) const;
+    std::shared_ptr<const KeySet> expanded_keys(bool galois) const;
+    seal::MemoryPoolHandle scratch_pool() const;
+    void encode_value(double value, seal::Plaintext& plain) const;
+    std::uint64_t plain_scalar(double value) const;
+    std::shared_ptr<const seal::Plaintext> encoded(const std::vector<double>& values, bool broadcast, double scale,
+                                                   const seal::parms_id_type& parms_id) const;
+    std::shared_ptr<const seal::Plaintext> encoded(double value, double scale,
+                                                   const seal::parms_id_type& parms_id) const {
+        return encoded(std::vector<double>{value}, true, scale, parms_id);
+    }
+    void encrypt_plain(const seal::Plaintext& plain, bool symmetric, std::string& out, const WireOptions& wire) const;
+    std::vector<std::string> encrypt_packed(const std::vector<double>& values, const std::vector<double>* paired,
+                                            bool symmetric, const WireOptions& wire) const;
+    std::vector<int> slot_sum_steps(size_t stride = 1) const;
+    template <typename Load>
+    seal::Ciphertext sum_range(const Load& load, size_t begin, size_t end) const;
+    template <typename Load>
+    seal::Ciphertext reduce(const Load& load, size_t count) const;
+    template <typename Load>
+    seal::Ciphertext parallel_sum(const Load& load, size_t count) const;
+    template <typename Task>
+    void parallel_for(size_t count, const Task& task) const;
+    bool can_mask(const seal::Ciphertext& encrypted) const;
+    void mask_inplace(seal::Ciphertext& encrypted, const std::vector<double>& mask) const;
+    void rotate_left_inplace(seal::Ciphertext& encrypted, size_t steps, const seal::GaloisKeys& galois_keys,
+                             seal::MemoryPoolHandle pool) const;
+    seal::Ciphertext repack_chunk_of(const seal::Ciphertext* ciphertexts, size_t count, size_t offset,
+                                     const KeySet* keys) const;
+    std::vector<int> scan_steps(size_t width) const;
+    void scan_inplace(seal::Ciphertext& encrypted, const std::vector<int>& steps, const KeySet& keys) const;
+    template <typename T>
+    std::vector<T> decrypt_prefix(const CiphertextViews& ciphertexts, WireFormat format, size_t slots) const;
+
+    size_t spare_levels(const seal::Ciphertext& encrypted) const;
+    seal::Ciphertext approximate_sign(const seal::Ciphertext& x, size_t levels, double result_scale, double factor,
+                                      double offset) const;
+    seal::Ciphertext max_pair(const seal::Ciphertext& a, const seal::Ciphertext& b, double bound, size_t levels) const;
+    InverseApproximation plan_inverse(const seal::Ciphertext& u, double low, double high, bool square_root,
+                                      size_t levels, double tolerance) const;
+    seal::Ciphertext newton_inverse(const seal::Ciphertext& u, const InverseApproximation& plan) const;
+    seal::Plaintext refresh_mask(const seal::Ciphertext& encrypted, const seal::prng_seed_type& seed, size_t index,
+                                 double bound) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+/**
+ * HttpClient.cpp
+ *
+ * Blocking HTTP/1.1 requests over an asio TCP stream.
+ */
+
+#include "HttpClient.h"
+#ifndef ASIO_STANDALONE
+    #define ASIO_STANDALONE
+#endif
+#include <asio/ip/tcp.hpp>  // For the blocking peer connection
+#include <algorithm>        // For std::equal
+#include <cctype>           // For std::tolower
+#include <iterator>         // For std::istreambuf_iterator
+#include <stdexcept>        // For std::runtime_error
+
+namespace http_client {
+
+namespace {
+    bool iequals(const std::string& a, const std::string& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+}
+
+std::string Response::header(const std::string& name) const {
+    for (const auto& item : headers) {
+        if (iequals(item.first, name)) return item.second;
+    }
+    return "";
+}
+
+Response request(const std::string& address, const std::string& method, const std::string& target,
+                 const std::string& body, const std::string& content_type, std::chrono::milliseconds timeout) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == address.size()) {
+        throw std::invalid_argument("Peer address must be host:port, not " + address);
+    }
+    std::string host = address.substr(0, colon);
+    std::string port = address.substr(colon + 1);
+
+    asio::ip::tcp::iostream stream;
+    stream.expires_after(timeout);
+    stream.connect(host, port);
+    if (!stream) throw std::runtime_error("Could not connect to " + address + ": " + stream.error().message());
+    stream << method << " " << target << " HTTP/1.1\r\n"
+           << "Host: " << address << "\r\n"
+           << "Content-Type: " << content_type << "\r\n"
+           << "Content-Length: " << body.size() << "\r\n"
+           << "Connection: close\r\n\r\n";
+    stream.write(body.data(), static_cast<std::streamsize>(body.size()));
+    stream.flush();
+
+    Response response;
+    std::string line;
+    if (!std::getline(stream, line)) {
+        throw std::runtime_error("No response from " + address + ": " + stream.error().message());
+    }
+    size_t space = line.find(' ');
+    if (line.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+        throw std::runtime_error("Malformed response from " + address);
+    }
+    response.status = static_cast<unsigned>(std::stoul(line.substr(space + 1)));
+
+    long long content_length = -1;
+    while (std::getline(stream, line) && line != "\r" && !line.empty()) {
+        if (line.back() == '\r') line.pop_back();
+        size_t separator = line.find(':');
+        if (separator == std::string::npos) continue;
+        std::string name = line.substr(0, separator);
+        size_t value_start = line.find_first_not_of(' ', separator + 1);
+        std::string value = value_start == std::string::npos ? "" : line.substr(value_start);
+        if (iequals(name, "Content-Length")) content_length = std::stoll(value);
+        response.headers.emplace_back(std::move(name), std::move(value));
+    }
+
+    if (content_length >= 0) {
+        response.body.resize(static_cast<size_t>(content_length));
+        stream.read(&response.body[0], content_length);
+        if (stream.gcount() != content_length) {
+            throw std::runtime_error("Truncated response from " + address + ": " + stream.error().message());
+        }
+    } else {
+        response.body.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    return response;
+}
+
+}
@@ -0,0 +1,40 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Minimal blocking HTTP/1.1 client for calls between backends (see Cluster)
+ *
+ * One connection per request ("Connection: close"), plain http only. Meant
+ * for a handful of large requests to known peers, not for general use.
+ */
+namespace http_client {
+
+    struct Response {
+        unsigned status = 0;
+        std::string body;
+        std::vector<std::pair<std::string, std::string>> headers;
+
+        // Value of a header (case-insensitive name), "" if absent
+        std::string header(const std::string& name) const;
+    };
+
+    /**
+     * @param address "host:port" of the peer
+     * @param method "GET", "POST", "PUT", "DELETE", ...
+     * @param target Path and query, e.g. "/binary/csv/sum?scheme=ckks"
+     * @param body Request body (sent with Content-Length, also when empty)
+     * @param content_type Content-Type of the body
+     * @param timeout Deadline for the whole exchange
+     * @throws std::runtime_error if the peer cannot be reached, times out or sends a malformed response
+     */
+    Response request(const std::string& address, const std::string& method, const std::string& target,
+                     const std::string& body = "", const std::string& content_type = "application/json",
+                     std::chrono::milliseconds timeout = std::chrono::seconds(60));
+}
+
+#endif // HTTP_CLIENT_H
@@ -0,0 +1,147 @@
+#ifndef HTTP_OPTIONS_H
+#define HTTP_OPTIONS_H
+
+#include "ServerConfig.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Connection settings of a backend's Crow server, shared by both backends
+ *
+ *   --http-keepalive-s      Idle seconds before a kept-alive connection is
+ *                           closed, also the limit for reading one request (5)
+ *   --http-max-body-mb      Largest request body; larger ones get 413 before
+ *                           they are read (0 = no limit)
+ *   --http-spill-body-mb  Bodies larger than this are written to an unlinked
+ *                           temporary file and mapped, not held in memory
+ *                           (64; 0 = never)
+ *   --http-spill-dir        Directory of those files (the system's temporary
+ *                           directory)
+ *   --http-read-buffer-kb   Socket read buffer per connection (64; Crow's
+ *                           own default is 4, i.e. ~140 reads per 550 KB body)
+ *   --http-socket-buffer-kb SO_RCVBUF and SO_SNDBUF of accepted connections
+ *                           (0 = the system's, which autotunes on Linux)
+ *   --http-nodelay          TCP_NODELAY on accepted connections (1)
+ *   --http-compression      gzip | deflate | off: Content-Encoding of response
+ *                           bodies for clients whose Accept-Encoding allows it
+ *                           (the other one if only that is accepted) (gzip)
+ *   --http-compression-min-kb  Smallest body worth compressing (4)
+ *   --http-compression-level   zlib level, 1 (fastest) to 9 (1)
+ *   --http2                 Take HTTP/2 connections (h2c with prior knowledge)
+ *                           on the same port (1 if built with nghttp2)
+ *   --http2-max-streams     Concurrent requests per HTTP/2 connection (100)
+ *   --http2-window-kb       Flow-control window of each HTTP/2 request (1024)
+ *   --http2-connection-window-mb  ... and of each HTTP/2 connection (16)
+ *
+ * Compression pays off on the Base64 JSON results (ciphertexts, keys): they
+ * shrink by a third, and by a quarter even when the SEAL bytes are compressed.
+ * Binary responses whose SEAL bytes are already compressed or bit-packed opt
+ * out per response (crow::response::compressed). Compression needs Crow built
+ * with CROW_ENABLE_COMPRESSION, i.e. SEAL_USE_ZLIB.
+ *
+ * HTTP/2 lets one connection carry a whole column's operations at once:
+ * its requests are streams, each handled in parallel on the I/O threads
+ * (see crow/http2_connection.h), with HPACK-compressed headers. The default
+ * windows take a ~550 KB ciphertext body in one round trip where the
+ * protocol's 64 KB would take nine. HTTP/2 needs Crow built with
+ * CROW_ENABLE_HTTP2, i.e. nghttp2 found at configure time.
+ *
+ * A spilled body's pages are the page cache's, not the process's: a
+ * multi-gigabyte CSV upload to /csv/sum or a framed column to /binary/...
+ * is parsed straight from the mapping (crow::request::body_view()) without
+ * ever being resident all at once. A body whose Content-Length is over the
+ * threshold goes to disk from its first byte; chunked ones once they pass it.
+ *
+ * Options are read before ServerConfig::check_unused() and applied once
+ * the app exists.
+ */
+struct HttpOptions {
+    size_t keepalive_s = 5;
+    uint64_t max_body_bytes = 0;
+    uint64_t spill_body_bytes = 64 << 20;
+    std::string spill_dir;
+    size_t read_buffer_bytes = 64 << 10;
+    size_t socket_buffer_bytes = 0;
+    bool nodelay = true;
+    std::string compression = "gzip";
+    size_t compression_min_bytes = 4 << 10;
+    int compression_level = 1;
+    bool http2 = false;
+    uint32_t http2_max_streams = 100;
+    uint32_t http2_stream_window_bytes = 1 << 20;
+    uint32_t http2_connection_window_bytes = 16 << 20;
+
+    static HttpOptions from(const ServerConfig& config) {
+        HttpOptions options;
+        options.keepalive_s = std::max<size_t>(1, std::min<size_t>(255, config.get_size("http-keepalive-s", 5)));
+        options.max_body_bytes = static_cast<uint64_t>(config.get_size("http-max-body-mb", 0)) << 20;
+        options.spill_body_bytes = static_cast<uint64_t>(config.get_size("http-spill-body-mb", 64)) << 20;
+        options.spill_dir = config.get("http-spill-dir", "");
+        if (options.spill_dir.empty()) {
+            std::error_code error;
+            options.spill_dir = std::filesystem::temp_directory_path(error).string();
+        }
+        if (options.spill_body_bytes && !std::filesystem::is_directory(options.spill_dir)) {
+            throw std::invalid_argument("--http-spill-dir is not a directory: " + options.spill_dir);
+        }
+        options.read_buffer_bytes = std::max<size_t>(1, config.get_size("http-read-buffer-kb", 64)) << 10;
+        options.socket_buffer_bytes = std::min<size_t>(config.get_size("http-socket-buffer-kb", 0) << 10,
+                                                       std::numeric_limits<int>::max());
+        options.nodelay = config.get_size("http-nodelay", 1) != 0;
+#ifdef CROW_ENABLE_COMPRESSION
+        options.compression = config.get("http-compression", "gzip");
+#else
+        options.compression = config.get("http-compression", "off");
+        if (options.compression != "off") {
+            throw std::invalid_argument("--http-compression needs a build with SEAL_USE_ZLIB");
+        }
+#endif
+        if (options.compression != "gzip" && options.compression != "deflate" && options.compression != "off") {
+            throw std::invalid_argument("--http-compression must be gzip, deflate or off, not " + options.compression);
+        }
+        options.compression_min_bytes = config.get_size("http-compression-min-kb", 4) << 10;
+        options.compression_level =
+            static_cast<int>(std::max<size_t>(1, std::min<size_t>(9, config.get_size("http-compression-level", 1))));
+#ifdef CROW_ENABLE_HTTP2
+        options.http2 = config.get_size("http2", 1) != 0;
+#else
+        options.http2 = config.get_size("http2", 0) != 0;
+        if (options.http2) throw std::invalid_argument("--http2 needs a build with nghttp2");
+#endif
+        // Windows are 31-bit (RFC 9113, 6.9.1)
+        options.http2_max_streams = static_cast<uint32_t>(
+            std::max<size_t>(1, std::min<size_t>(UINT32_MAX, config.get_size("http2-max-streams", 100))));
+        options.http2_stream_window_bytes =
+            static_cast<uint32_t>(std::min<size_t>(config.get_size("http2-window-kb", 1024) << 10, INT32_MAX));
+        options.http2_connection_window_bytes =
+            static_cast<uint32_t>(std::min<size_t>(config.get_size("http2-connection-window-mb", 16) << 20, INT32_MAX));
+        return options;
+    }
+
+    template <typename App>
+    void apply(App& app) const {
+        app.timeout(static_cast<uint8_t>(keepalive_s))
+            .max_body_size(max_body_bytes ? max_body_bytes : UINT64_MAX)
+            .body_spill(spill_body_bytes ? spill_body_bytes : UINT64_MAX, spill_dir)
+            .read_buffer_size(read_buffer_bytes)
+            .tcp_nodelay(nodelay)
+            .socket_buffer_sizes(static_cast<int>(socket_buffer_bytes), static_cast<int>(socket_buffer_bytes))
+            .http2(http2)
+            .http2_max_streams(http2_max_streams)
+            .http2_window_sizes(http2_stream_window_bytes, http2_connection_window_bytes);
+#ifdef CROW_ENABLE_COMPRESSION
+        if (compression != "off") {
+            app.use_compression(compression == "gzip" ? crow::compression::GZIP : crow::compression::DEFLATE)
+                .compression_level(compression_level)
+                .compression_min_size(compression_min_bytes);
+        }
+#endif
+    }
+};
+
+#endif // HTTP_OPTIONS_H
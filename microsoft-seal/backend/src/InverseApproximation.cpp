@@ -0,0 +1,180 @@
+#include "InverseApproximation.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+    const size_t max_degree = 7;        // Guesses of degree 1 .. 7 (at most 3 or 4 levels)
+    const size_t fit_nodes = 64;        // Chebyshev nodes the guesses are fit at
+    const size_t lawson_rounds = 40;    // Reweightings towards the minimax fit
+    const size_t check_points = 2049;   // Geometrically spaced points the error is measured at
+    const double pi = 3.14159265358979323846;
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    // Solve a x = b (a small and well conditioned) by Gaussian elimination with partial pivoting
+    std::vector<double> solve(std::vector<std::vector<double>> a, std::vector<double> b) {
+        const size_t n = b.size();
+        for (size_t col = 0; col < n; col++) {
+            size_t pivot = col;
+            for (size_t r = col + 1; r < n; r++) {
+                if (std::abs(a[r][col]) > std::abs(a[pivot][col])) pivot = r;
+            }
+            std::swap(a[col], a[pivot]);
+            std::swap(b[col], b[pivot]);
+            for (size_t r = col + 1; r < n; r++) {
+                const double factor = a[r][col] / a[col][col];
+                for (size_t c = col; c < n; c++) a[r][c] -= factor * a[col][c];
+                b[r] -= factor * b[col];
+            }
+        }
+        std::vector<double> x(n);
+        for (size_t i = n; i-- > 0;) {
+            double value = b[i];
+            for (size_t c = i + 1; c < n; c++) value -= a[i][c] * x[c];
+            x[i] = value / a[i][i];
+        }
+        return x;
+    }
+
+    // Chebyshev polynomials T_0 .. T_degree at t
+    std::vector<double> chebyshev(double t, size_t degree) {
+        std::vector<double> values(degree + 1, 1.0);
+        if (degree > 0) values[1] = t;
+        for (size_t j = 2; j <= degree; j++) values[j] = 2 * t * values[j - 1] - values[j - 2];
+        return values;
+    }
+
+    /**
+     * Guess of degree d for f(u) on [a, 1] with the smallest largest relative
+     * error, approximately: least squares of p(u) g(u) - 1 (g(u) = 1 / f(u)) in
+     * the Chebyshev basis, reweighted by the residuals (Lawson) towards the
+     * minimax solution; the best round is converted to coefficients of u^i
+     */
+    std::vector<double> fit(double a, size_t degree, bool square_root) {
+        std::vector<std::vector<double>> rows(fit_nodes);
+        std::vector<double> weights(fit_nodes, 1.0 / fit_nodes);
+        for (size_t k = 0; k < fit_nodes; k++) {
+            const double t = std::cos(pi * (k + 0.5) / fit_nodes);
+            const double u = (1 + a) / 2 + (1 - a) / 2 * t;
+            rows[k] = chebyshev(t, degree);
+            for (double& value : rows[k]) value *= square_root ? std::sqrt(u) : u;
+        }
+
+        std::vector<double> best;
+        double best_error = infinity;
+        for (size_t round = 0; round < lawson_rounds; round++) {
+            std::vector<std::vector<double>> normal(degree + 1, std::vector<double>(degree + 1, 0.0));
+            std::vector<double> target(degree + 1, 0.0);
+            for (size_t k = 0; k < fit_nodes; k++) {
+                for (size_t i = 0; i <= degree; i++) {
+                    target[i] += weights[k] * rows[k][i];
+                    for (size_t j = 0; j <= degree; j++) normal[i][j] += weights[k] * rows[k][i] * rows[k][j];
+                }
+            }
+            std::vector<double> coefficients = solve(normal, target);
+
+            double error = 0;
+            double total = 0;
+            for (size_t k = 0; k < fit_nodes; k++) {
+                double residual = -1;
+                for (size_t i = 0; i <= degree; i++) residual += coefficients[i] * rows[k][i];
+                error = std::max(error, std::abs(residual));
+                weights[k] *= std::abs(residual);
+                total += weights[k];
+            }
+            if (error < best_error) {
+                best_error = error;
+                best = std::move(coefficients);
+            }
+            if (!(total > 0)) break;
+            for (double& weight : weights) weight /= total;
+        }
+
+        // T_j(alpha u + beta) as coefficients of u^i, by the three-term recurrence
+        const double alpha = 2 / (1 - a);
+        const double beta = -(1 + a) / (1 - a);
+        std::vector<double> previous = {1.0};
+        std::vector<double> current = {beta, alpha};
+        std::vector<double> result(degree + 1, 0.0);
+        result[0] = best[0];
+        for (size_t j = 1; j <= degree; j++) {
+            for (size_t i = 0; i < current.size(); i++) result[i] += best[j] * current[i];
+            std::vector<double> next(current.size() + 1, 0.0);
+            for (size_t i = 0; i < current.size(); i++) {
+                next[i] += 2 * beta * current[i];
+                next[i + 1] += 2 * alpha * current[i];
+            }
+            for (size_t i = 0; i < previous.size(); i++) next[i] -= previous[i];
+            previous = std::move(current);
+            current = std::move(next);
+        }
+        return result;
+    }
+
+    /**
+     * Largest relative error of the guess after each of 0 .. steps Newton steps,
+     * across [a, 1] in the clear; infinity once a step diverges
+     */
+    std::vector<double> errors(const std::vector<double>& guess, double a, size_t steps, bool square_root) {
+        std::vector<double> result(steps + 1, 0.0);
+        for (size_t k = 0; k < check_points; k++) {
+            const double u = a * std::pow(1 / a, static_cast<double>(k) / (check_points - 1));
+            const double root = std::sqrt(u);
+            double y = 0;
+            for (size_t i = guess.size(); i-- > 0;) y = y * u + guess[i];
+            for (size_t step = 0; step <= steps; step++) {
+                if (step > 0) y = square_root ? y * (3 - u * y * y) / 2 : y * (2 - u * y);
+                const double error = std::abs(y * (square_root ? root : u) - 1);
+                result[step] = std::max(result[step], std::isfinite(error) && error < 1 ? error : infinity);
+            }
+        }
+        return result;
+    }
+}
+
+InverseApproximation InverseApproximation::plan(double low, double high, bool square_root, size_t levels,
+                                                double tolerance,
+                                                const std::function<size_t(const std::vector<double>&)>& guess_depth) {
+    if (!(low > 0) || !(high > low) || !std::isfinite(high)) {
+        throw std::invalid_argument("Inverse needs a range 0 < low < high");
+    }
+    if (!(tolerance > 0)) throw std::invalid_argument("tolerance must be positive");
+    const double a = low / high;
+
+    InverseApproximation chosen;
+    chosen.square_root = square_root;
+    chosen.low = low;
+    chosen.high = high;
+    bool found = false;
+    double best_error = infinity;
+    for (size_t degree = 1; degree <= max_degree; degree++) {
+        std::vector<double> guess = fit(a, degree, square_root);
+        const size_t depth = guess_depth(guess);
+        if (depth > levels) continue;
+        std::vector<double> error = errors(guess, a, (levels - depth) / 2, square_root);
+        for (size_t steps = 0; steps < error.size(); steps++) {
+            best_error = std::min(best_error, error[steps]);
+            if (error[steps] > tolerance) continue;
+            // Fewest levels, then fewest Newton steps
+            if (!found || depth + 2 * steps < chosen.depth() ||
+                (depth + 2 * steps == chosen.depth() && steps < chosen.iterations)) {
+                chosen.guess = guess;
+                chosen.guess_depth = depth;
+                chosen.iterations = steps;
+                chosen.relative_error = error[steps];
+                found = true;
+            }
+            break;
+        }
+    }
+    if (!found) {
+        throw std::invalid_argument(std::string(square_root ? "1/sqrt(x)" : "1/x") + " on [" + std::to_string(low) +
+                                    ", " + std::to_string(high) + "] to within " + std::to_string(tolerance) +
+                                    " takes more than the " + std::to_string(levels) + " levels left (best " +
+                                    std::to_string(best_error) + "); narrow the range or use a deeper profile");
+    }
+    return chosen;
+}
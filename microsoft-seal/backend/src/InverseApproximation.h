@@ -0,0 +1,46 @@
+#ifndef INVERSE_APPROXIMATION_H
+#define INVERSE_APPROXIMATION_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * How to compute 1/x or 1/sqrt(x) of CKKS values known to lie in [low, high]
+ *
+ * x is scaled to u = x / high in [low / high, 1] first. A polynomial guess of
+ * f(u), fit for the smallest relative error on that interval (Lawson's
+ * reweighted least squares at Chebyshev nodes), is then refined by Newton
+ * steps of two levels each: y (2 - u y) for 1/u, y (3 - u y^2) / 2 for
+ * 1/sqrt(u), each squaring the relative error (times 3/2 for the square
+ * root). The last step also multiplies by 1 / high (1 / sqrt(high)), which
+ * gives f(x). The wider the range, the better the guess or the more steps it
+ * takes; plan() picks the combination spending the fewest levels whose error,
+ * found by running the steps in the clear across the interval, is within the
+ * tolerance (see HomomorphicEncryption::inverse).
+ */
+struct InverseApproximation {
+    bool square_root = false;
+    double low = 0;
+    double high = 0;
+    std::vector<double> guess;  // Coefficients of u^0, u^1, ... of the initial guess of f(u)
+    size_t guess_depth = 0;     // Levels the guess spends
+    size_t iterations = 0;      // Newton steps after the guess
+    double relative_error = 0;  // Largest |approximation / f(x) - 1| in the clear
+
+    // Levels spent after the scaling of x
+    size_t depth() const { return guess_depth + 2 * iterations; }
+
+    /**
+     * @param levels Levels available after the scaling of x
+     * @param tolerance Largest acceptable relative error
+     * @param guess_depth Levels a polynomial of the given coefficients spends
+     *                    (PolynomialEvaluator::depth)
+     * @throws std::invalid_argument for a range that is not positive, or one no
+     *         plan within levels approximates to the tolerance
+     */
+    static InverseApproximation plan(double low, double high, bool square_root, size_t levels, double tolerance,
+                                     const std::function<size_t(const std::vector<double>&)>& guess_depth);
+};
+
+#endif // INVERSE_APPROXIMATION_H
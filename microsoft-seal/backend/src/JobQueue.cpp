@@ -0,0 +1,247 @@
+/**
+ * JobQueue.cpp
+ *
+ * Job bookkeeping for asynchronous operations: state transitions, progress
+ * throttling (listeners hear about every percent, not every callback) and
+ * retention of finished jobs for polling.
+ */
+
+#include "JobQueue.h"
+#include "Metrics.h"
+#include "RandomHandle.h"  // For job IDs
+#include <algorithm>      // For std::clamp, std::remove
+
+namespace {
+    // Smallest progress step that triggers a notification
+    constexpr double progress_step = 0.01;
+
+    int64_t elapsed_us(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    }
+
+    bool is_terminal(JobQueue::State state) {
+        return state != JobQueue::State::queued && state != JobQueue::State::running;
+    }
+}
+
+JobQueue::JobQueue(size_t threads, size_t max_retained)
+    : max_retained(max_retained), pool(threads, {}, [] { metrics::label_thread("jobs"); }) {}
+
+/**
+ * Cancel everything still pending; the pool's destructor then drains the
+ * queue (each remaining job ends immediately) and joins the workers
+ */
+JobQueue::~JobQueue() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : jobs) {
+        entry.second->cancel_requested = true;
+        entry.second->token.cancel("job cancelled");
+    }
+}
+
+std::string JobQueue::submit(std::string kind, Task task) {
+    auto job = std::make_shared<Job>();
+    job->kind = std::move(kind);
+    job->submitted = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->id = new_id();
+        jobs[job->id] = job;
+        active++;
+    }
+    pool.submit([this, job, task = std::move(task)] { run(job, task); });
+    return job->id;
+}
+
+bool JobQueue::status(const std::string& id, Snapshot& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) return false;
+    out = snapshot(*it->second);
+    return true;
+}
+
+bool JobQueue::cancel(const std::string& id) {
+    std::shared_ptr<Job> job;
+    bool queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(id);
+        if (it == jobs.end() || is_terminal(it->second->state) || it->second->cancel_requested) return false;
+        job = it->second;
+        job->cancel_requested = true;
+        job->token.cancel("job cancelled");
+        queued = job->state == State::queued;
+    }
+    // Queued jobs end now; running ones stop at their next progress report
+    if (queued) finish(job, State::cancelled, "", "");
+    return true;
+}
+
+bool JobQueue::subscribe(const std::string& id, Listener listener) {
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(id);
+        if (it == jobs.end()) return false;
+        job = it->second;
+    }
+
+    auto shared = std::make_shared<Listener>(std::move(listener));
+    std::lock_guard<std::mutex> notify_lock(job->notify_mutex);
+    Snapshot current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = snapshot(*job);
+        if (!is_terminal(current.state)) job->listeners.push_back(shared);
+    }
+    if (!(*shared)(current)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& listeners = job->listeners;
+        listeners.erase(std::remove(listeners.begin(), listeners.end(), shared), listeners.end());
+    }
+    return true;
+}
+
+size_t JobQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active;
+}
+
+const char* JobQueue::state_name(State state) {
+    switch (state) {
+        case State::queued: return "queued";
+        case State::running: return "running";
+        case State::done: return "done";
+        case State::failed: return "failed";
+        case State::cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+/**
+ * Random 128-bit job ID in hex (see random_handle), so one client cannot guess
+ * another's jobs
+ * Called with the mutex held
+ */
+std::string JobQueue::new_id() {
+    std::string id;
+    do {
+        id = random_handle();
+    } while (jobs.count(id));
+    return id;
+}
+
+/**
+ * Worker-side execution of one job
+ */
+void JobQueue::run(const std::shared_ptr<Job>& job, const Task& task) {
+    bool cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (job->state != State::queued) return;  // Already cancelled by cancel()
+        cancelled = job->cancel_requested;
+        job->state = State::running;
+        if (!cancelled) job->started = Clock::now();
+    }
+    if (cancelled) {
+        finish(job, State::cancelled, "", "");
+        return;
+    }
+    notify(job);
+
+    Progress progress = [this, job](double value) {
+        bool report;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (job->cancel_requested) throw JobCancelled();
+            job->progress = std::clamp(value, job->progress, 1.0);
+            report = job->progress - job->reported >= progress_step;
+            if (report) job->reported = job->progress;
+        }
+        if (report) notify(job);
+    };
+
+    // Whatever the job fans out to the compute pool waits for request handlers' tasks
+    ThreadPool::BatchScope batch;
+    cancellation::Scope scope(&job->token);
+    try {
+        std::string result = task(progress);
+        finish(job, State::done, std::move(result), "");
+    } catch (const JobCancelled&) {
+        finish(job, State::cancelled, "", "");
+    } catch (const cancellation::Cancelled&) {
+        finish(job, State::cancelled, "", "");
+    } catch (const std::exception& e) {
+        finish(job, State::failed, "", e.what());
+    }
+}
+
+void JobQueue::finish(const std::shared_ptr<Job>& job, State state, std::string result, std::string error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (is_terminal(job->state)) return;
+        job->state = state;
+        job->finished = Clock::now();
+        if (state == State::done) job->progress = 1.0;
+        job->result = std::move(result);
+        job->error = std::move(error);
+        active--;
+
+        finished.push_back(job->id);
+        while (finished.size() > max_retained) {
+            jobs.erase(finished.front());
+            finished.pop_front();
+        }
+    }
+    notify(job);
+}
+
+/**
+ * Send the job's current snapshot to its listeners, dropping those that
+ * unsubscribe and, once the job has finished, all of them
+ */
+void JobQueue::notify(const std::shared_ptr<Job>& job) {
+    std::lock_guard<std::mutex> notify_lock(job->notify_mutex);
+    Snapshot current;
+    std::vector<std::shared_ptr<Listener>> listeners;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = snapshot(*job);
+        listeners = job->listeners;
+    }
+
+    std::vector<std::shared_ptr<Listener>> dropped;
+    for (const auto& listener : listeners) {
+        if (!(*listener)(current)) dropped.push_back(listener);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (is_terminal(current.state)) {
+        job->listeners.clear();
+        return;
+    }
+    for (const auto& listener : dropped) {
+        auto& remaining = job->listeners;
+        remaining.erase(std::remove(remaining.begin(), remaining.end(), listener), remaining.end());
+    }
+}
+
+/**
+ * Called with the mutex held
+ */
+JobQueue::Snapshot JobQueue::snapshot(const Job& job) const {
+    Snapshot out;
+    out.id = job.id;
+    out.kind = job.kind;
+    out.state = job.state;
+    out.progress = job.progress;
+    out.result = job.result;
+    out.error = job.error;
+
+    auto now = Clock::now();
+    bool started = job.started != Clock::time_point{};
+    out.queued_us = elapsed_us(job.submitted, started ? job.started : (is_terminal(job.state) ? job.finished : now));
+    if (started) out.running_us = elapsed_us(job.started, is_terminal(job.state) ? job.finished : now);
+    return out;
+}
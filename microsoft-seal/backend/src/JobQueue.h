@@ -0,0 +1,125 @@
+#ifndef JOB_QUEUE_H
+#define JOB_QUEUE_H
+
+#include "Cancellation.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Asynchronous jobs for long-running homomorphic operations
+ *
+ * submit() queues a task on the queue's own worker pool and returns a job ID
+ * at once, so HTTP threads never wait on SEAL. Clients poll status() or
+ * subscribe() to receive a snapshot every time the job reports progress or
+ * changes state. Tasks report progress in [0, 1] through the callback they
+ * are given; the same callback throws JobCancelled once cancel() was called,
+ * which is how running jobs stop early. The job's cancellation token is set
+ * for the task too, so SEAL reductions inside it stop between chunks.
+ *
+ * Finished jobs are kept for polling until max_retained newer jobs have
+ * finished. All methods are thread-safe.
+ */
+class JobQueue {
+public:
+    enum class State { queued, running, done, failed, cancelled };
+
+    struct Snapshot {
+        std::string id;
+        std::string kind;
+        State state = State::queued;
+        double progress = 0.0;
+        std::string result;   // Task's return value (JSON text) once done
+        std::string error;    // Exception message once failed
+        int64_t queued_us = 0;
+        int64_t running_us = 0;
+    };
+
+    // Thrown from the progress callback of a cancelled job
+    struct JobCancelled : std::runtime_error {
+        JobCancelled() : std::runtime_error("Job cancelled") {}
+    };
+
+    using Progress = std::function<void(double)>;
+    using Task = std::function<std::string(const Progress&)>;
+    using Listener = std::function<bool(const Snapshot&)>;  // false = unsubscribe
+
+    /**
+     * @param threads Worker threads for jobs (kept apart from the per-operation compute pool)
+     * @param max_retained Finished jobs kept for polling
+     */
+    explicit JobQueue(size_t threads, size_t max_retained = 256);
+    ~JobQueue();
+
+    JobQueue(const JobQueue&) = delete;
+    JobQueue& operator=(const JobQueue&) = delete;
+
+    /**
+     * Queue a task
+     * @param kind Operation name reported in snapshots
+     * @param task Work to run; returns the job result as JSON text
+     * @return Job ID
+     */
+    std::string submit(std::string kind, Task task);
+
+    // Current state of a job; false if the ID is unknown (or expired)
+    bool status(const std::string& id, Snapshot& out) const;
+
+    // Request cancellation of a queued or running job; false if unknown or already finished
+    bool cancel(const std::string& id);
+
+    /**
+     * Deliver the current snapshot and every later update to listener
+     * Updates for one job arrive in order, on the thread that caused them.
+     * @return false if the ID is unknown
+     */
+    bool subscribe(const std::string& id, Listener listener);
+
+    // Jobs queued or running
+    size_t pending() const;
+
+    static const char* state_name(State state);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        std::string id;
+        std::string kind;
+        State state = State::queued;
+        double progress = 0.0;
+        double reported = 0.0;  // Progress at the last notification
+        bool cancel_requested = false;
+        cancellation::Token token;  // Cancelled along with cancel_requested
+        std::string result;
+        std::string error;
+        Clock::time_point submitted;
+        Clock::time_point started;
+        Clock::time_point finished;
+        std::mutex notify_mutex;  // Orders listener calls; taken before JobQueue::mutex
+        std::vector<std::shared_ptr<Listener>> listeners;
+    };
+
+    size_t max_retained;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Job>> jobs;
+    std::deque<std::string> finished;  // Oldest first
+    size_t active = 0;
+    ThreadPool pool;  // Declared last: joined before the job table goes away
+
+    std::string new_id();
+    void run(const std::shared_ptr<Job>& job, const Task& task);
+    void finish(const std::shared_ptr<Job>& job, State state, std::string result, std::string error);
+    void notify(const std::shared_ptr<Job>& job);
+    Snapshot snapshot(const Job& job) const;
+};
+
+#endif // JOB_QUEUE_H
@@ -0,0 +1,195 @@
+/**
+ * JsonStream.cpp
+ *
+ * A scanner for just enough JSON to find the members of an object and the
+ * strings of one array. Strings are skipped with memchr (for the closing
+ * quote, then for a backslash before it), so a Base64 ciphertext costs two
+ * vectorized passes rather than a character-by-character parse. Everything
+ * outside the array is validated afterwards by crow::json::load.
+ */
+
+#include "JsonStream.h"
+#include <cstring>        // For std::memchr
+
+namespace json_stream {
+
+namespace {
+    const char* skip_whitespace(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+        return p;
+    }
+
+    /**
+     * Find the closing quote of a string
+     * @param p First character after the opening quote
+     * @param escaped Set if the string contains escapes
+     * @return Position of the closing quote, or nullptr if the string is unterminated
+     */
+    const char* closing_quote(const char* p, const char* end, bool& escaped) {
+        escaped = false;
+        const char* quote = nullptr;
+        while (p < end) {
+            // The next quote only moves when an escape has skipped it, so a string full of
+            // escapes is not rescanned to its end once per escape
+            if (!quote || quote < p) {
+                quote = static_cast<const char*>(std::memchr(p, '"', static_cast<size_t>(end - p)));
+                if (!quote) return nullptr;
+            }
+            auto backslash = static_cast<const char*>(std::memchr(p, '\\', static_cast<size_t>(quote - p)));
+            if (!backslash) return quote;
+            escaped = true;
+            p = backslash + 2;  // Past the escaped character, which may have been the quote
+        }
+        return nullptr;
+    }
+
+    // Any JSON value (its syntax is left to crow::json::load); nullptr if it runs past the end
+    const char* skip_value(const char* p, const char* end) {
+        bool escaped;
+        if (*p == '"') {
+            const char* quote = closing_quote(p + 1, end, escaped);
+            return quote ? quote + 1 : nullptr;
+        }
+        if (*p != '{' && *p != '[') {
+            while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' && *p != '\n' &&
+                   *p != '\r') {
+                p++;
+            }
+            return p;
+        }
+        size_t depth = 0;
+        for (; p < end; p++) {
+            if (*p == '"') {
+                p = closing_quote(p + 1, end, escaped);
+                if (!p) return nullptr;
+            } else if (*p == '{' || *p == '[') {
+                depth++;
+            } else if ((*p == '}' || *p == ']') && --depth == 0) {
+                return p + 1;
+            }
+        }
+        return nullptr;
+    }
+
+    void append_utf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | code >> 6));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xE0 | code >> 12));
+            out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    // Text of a string with escapes (e.g. "\/" from some encoders); surrogate pairs are not joined
+    void unescape(const char* p, const char* end, std::string& out) {
+        out.clear();
+        out.reserve(static_cast<size_t>(end - p));
+        while (p < end) {
+            if (*p != '\\') {
+                out.push_back(*p++);
+                continue;
+            }
+            char c = ++p < end ? *p++ : '\\';
+            switch (c) {
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    unsigned code = 0;
+                    for (int i = 0; i < 4 && p < end; i++, p++) {
+                        char h = *p;
+                        code = code << 4 | static_cast<unsigned>(h <= '9' ? h - '0' : (h | 0x20) - 'a' + 10);
+                    }
+                    append_utf8(out, code & 0xFFFF);
+                    break;
+                }
+                default: out.push_back(c); break;  // \" \\ \/
+            }
+        }
+    }
+}
+
+bool StringArray::next(std::string& scratch, const char*& data, size_t& size) {
+    if (remaining == 0) return false;
+    // split() has checked the array, so position is at an opening quote
+    bool escaped;
+    const char* begin = position + 1;
+    const char* quote = closing_quote(begin, end, escaped);
+    if (escaped) {
+        unescape(begin, quote, scratch);
+        data = scratch.data();
+        size = scratch.size();
+    } else {
+        data = begin;
+        size = static_cast<size_t>(quote - begin);
+    }
+    const char* p = quote + 1;
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == ',') p++;
+    position = p;
+    remaining--;
+    return true;
+}
+
+std::string split(std::string_view body, const std::string& key, StringArray& array) {
+    array = StringArray();
+    const char* const begin = body.data();
+    const char* const end = begin + body.size();
+    const char* p = skip_whitespace(begin, end);
+    if (p == end || *p != '{') return std::string(body);
+    p = skip_whitespace(p + 1, end);
+    bool escaped;
+    while (p < end && *p == '"') {
+        const char* name = p + 1;
+        const char* name_end = closing_quote(name, end, escaped);
+        if (!name_end) return std::string(body);
+        p = skip_whitespace(name_end + 1, end);
+        if (p == end || *p != ':') return std::string(body);
+        const char* value = skip_whitespace(p + 1, end);
+        if (value == end) return std::string(body);
+
+        if (static_cast<size_t>(name_end - name) == key.size() && key.compare(0, key.size(), name, key.size()) == 0) {
+            if (*value != '[') return std::string();
+            size_t count = 0;
+            p = skip_whitespace(value + 1, end);
+            if (p < end && *p != ']') {
+                while (true) {
+                    if (p == end || *p != '"') return std::string();
+                    const char* quote = closing_quote(p + 1, end, escaped);
+                    if (!quote) return std::string();
+                    count++;
+                    p = skip_whitespace(quote + 1, end);
+                    if (p < end && *p == ',') {
+                        p = skip_whitespace(p + 1, end);
+                        continue;
+                    }
+                    if (p < end && *p == ']') break;
+                    return std::string();
+                }
+            }
+            if (p == end) return std::string();
+            array.position = skip_whitespace(value + 1, end);
+            array.end = p;
+            array.count = count;
+            array.remaining = count;
+            std::string rest;
+            rest.reserve(body.size() - static_cast<size_t>(p + 1 - value) + 2);
+            rest.append(begin, value).append("[]").append(p + 1, end);
+            return rest;
+        }
+
+        p = skip_value(value, end);
+        if (!p) return std::string(body);
+        p = skip_whitespace(p, end);
+        if (p == end || *p != ',') return std::string(body);
+        p = skip_whitespace(p + 1, end);
+    }
+    return std::string(body);
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * In-place reading of the large string array of a JSON request body
+ *
+ * Bodies such as /csv/sum's carry thousands of ~550 KB Base64 ciphertexts in
+ * one array. Loading them with crow::json builds a DOM holding every string
+ * and the handler then copies each one again; split() instead takes the array
+ * out of the body, so only the small members are parsed into a DOM, and a
+ * StringArray hands out the strings one at a time as views into the body.
+ */
+namespace json_stream {
+
+    /**
+     * The strings of one JSON array, read in order without copies (except for
+     * strings with escapes, which are unescaped into the caller's scratch)
+     * Refers to the body it was split from, which must outlive it.
+     */
+    class StringArray {
+    public:
+        size_t size() const { return count; }
+
+        /**
+         * Advance to the next string
+         * @param scratch Buffer for the unescaped text of a string with escapes
+         * @param data Set to the string's first character (in the body or in scratch)
+         * @param size Set to its length
+         * @return false once every string has been read
+         */
+        bool next(std::string& scratch, const char*& data, size_t& size);
+
+    private:
+        friend std::string split(std::string_view body, const std::string& key, StringArray& array);
+
+        const char* position = nullptr;  // Start of the next element (or of the closing bracket)
+        const char* end = nullptr;       // The closing bracket
+        size_t count = 0;
+        size_t remaining = 0;
+    };
+
+    /**
+     * Take an array of strings out of a JSON object body
+     *
+     * @param body Request body
+     * @param key Top-level member holding the array, e.g. "encrypted_values"
+     * @param array Set to read the member's strings from body
+     * @return body with the member's value replaced by [], for crow::json::load; body
+     *         unchanged if it is not an object with that member (array stays empty), or an
+     *         empty string if the member is not an array of strings
+     */
+    std::string split(std::string_view body, const std::string& key, StringArray& array);
+}
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,112 @@
+/**
+ * KeyStore.cpp
+ *
+ * File layout and I/O for the on-disk key store. Reads go through a
+ * read-only mmap on POSIX systems so multi-megabyte Galois keys are loaded
+ * straight from the page cache; other platforms fall back to a buffered read.
+ */
+
+#include "KeyStore.h"
+#include <cerrno>         // For errno
+#include <cstdio>         // For std::rename, std::remove
+#include <cstring>        // For std::strerror
+#include <fstream>        // For file output (and input on non-POSIX platforms)
+#include <iomanip>        // For hex formatting of parms_id
+#include <iterator>       // For std::istreambuf_iterator
+#include <sstream>        // For building file names
+#include <stdexcept>      // For exception handling
+
+#if defined(_WIN32)
+    #include <direct.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+KeyStore::KeyStore(std::string directory, seal::compr_mode_type compression)
+    : dir(std::move(directory)), compression(compression) {
+    if (dir.empty()) throw std::invalid_argument("Key store directory must not be empty");
+}
+
+/**
+ * File path for a key: <dir>/<key parms_id as 64 hex digits>.<kind>
+ */
+std::string KeyStore::path_for(const seal::SEALContext& context, const char* kind) const {
+    std::ostringstream path;
+    path << dir << '/' << std::hex << std::setfill('0');
+    for (uint64_t word : context.key_parms_id()) {
+        path << std::setw(16) << word;
+    }
+    path << '.' << kind;
+    return path.str();
+}
+
+bool KeyStore::read(const std::string& path,
+                    const std::function<void(const seal::seal_byte*, size_t)>& consume) const {
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    consume(reinterpret_cast<const seal::seal_byte*>(bytes.data()), bytes.size());
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) return false;
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not read " + path);
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file referenced
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Could not map " + path + ": " + std::strerror(errno));
+    }
+
+    try {
+        consume(static_cast<const seal::seal_byte*>(mapped), size);
+    } catch (...) {
+        ::munmap(mapped, size);
+        throw;
+    }
+    ::munmap(mapped, size);
+    return true;
+#endif
+}
+
+/**
+ * Write a key file atomically: bytes go to <path>.tmp which is then renamed,
+ * so a concurrently starting server never sees a half-written key
+ */
+void KeyStore::write(const std::string& path, std::string_view bytes) const {
+#if defined(_WIN32)
+    _mkdir(dir.c_str());
+#else
+    ::mkdir(dir.c_str(), 0700);  // Keys include the secret key; keep the directory private
+#endif
+
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file) throw std::runtime_error("Could not create " + tmp_path);
+#if !defined(_WIN32)
+        ::chmod(tmp_path.c_str(), 0600);  // Owner-only, before any key material is written
+#endif
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file) throw std::runtime_error("Could not write " + tmp_path);
+    }
+#if defined(_WIN32)
+    std::remove(path.c_str());  // rename() does not replace existing files on Windows
+#endif
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("Could not replace " + path);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef KEY_STORE_H
+#define KEY_STORE_H
+
+#include "seal/seal.h"
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * On-disk store for SEAL keys, shared by mini-backend and main-backend
+ *
+ * Each key lives in its own file named after the context's key parms_id and
+ * the key kind, e.g. <dir>/<parms_id>.public_key, so keys for BFV and CKKS
+ * (or any other parameter set) can sit side by side in one directory.
+ * Files are written to a temporary name and renamed into place, and read
+ * through a read-only memory mapping where the platform supports it.
+ */
+class KeyStore {
+public:
+    /**
+     * @param directory Directory holding the key files (created on first save)
+     * @param compression SEAL compression used when saving keys
+     */
+    explicit KeyStore(std::string directory,
+                      seal::compr_mode_type compression = seal::Serialization::compr_mode_default);
+
+    /**
+     * Load a key if the store has one for this context
+     *
+     * @param context Context the key belongs to (selects the file by parms_id)
+     * @param kind Key kind, used as the file extension ("public_key", "galois_keys", ...)
+     * @param key Destination key object
+     * @return false if no file exists for this context and kind
+     * @throws std::logic_error / std::runtime_error if the file exists but is invalid
+     */
+    template <typename T>
+    bool load(const seal::SEALContext& context, const char* kind, T& key) const {
+        return read(path_for(context, kind), [&](const seal::seal_byte* data, size_t size) {
+            key.load(context, data, size);
+        });
+    }
+
+    /**
+     * Same, also keeping the file's bytes, e.g. to send the key on as stored
+     *
+     * @param bytes Set to the file's contents (left alone if there is no file)
+     */
+    template <typename T>
+    bool load(const seal::SEALContext& context, const char* kind, T& key, std::string& bytes) const {
+        return read(path_for(context, kind), [&](const seal::seal_byte* data, size_t size) {
+            key.load(context, data, size);
+            bytes.assign(reinterpret_cast<const char*>(data), size);
+        });
+    }
+
+    /**
+     * Save a key for this context, replacing any existing file
+     *
+     * @param context Context the key belongs to
+     * @param kind Key kind, used as the file extension
+     * @param key Key object to save
+     */
+    template <typename T>
+    void save(const seal::SEALContext& context, const char* kind, const T& key) const {
+        std::string bytes(static_cast<size_t>(key.save_size(compression)), '\0');
+        auto written = key.save(reinterpret_cast<seal::seal_byte*>(&bytes[0]), bytes.size(), compression);
+        bytes.resize(static_cast<size_t>(written));
+        write(path_for(context, kind), bytes);
+    }
+
+    // Save a key already serialized (e.g. in seeded form) as it is
+    void save_serialized(const seal::SEALContext& context, const char* kind, std::string_view bytes) const {
+        write(path_for(context, kind), bytes);
+    }
+
+    // File path used for the given context and key kind
+    std::string path_for(const seal::SEALContext& context, const char* kind) const;
+
+    const std::string& directory() const { return dir; }
+    seal::compr_mode_type compression_mode() const { return compression; }
+
+private:
+    std::string dir;
+    seal::compr_mode_type compression;
+
+    // Invoke consume on the file's bytes; false if the file does not exist
+    bool read(const std::string& path, const std::function<void(const seal::seal_byte*, size_t)>& consume) const;
+    void write(const std::string& path, std::string_view bytes) const;
+};
+
+#endif // KEY_STORE_H
@@ -0,0 +1,141 @@
+/**
+ * Logger.cpp
+ *
+ * Ring buffer and background writer behind HE_LOG. The writer takes every
+ * queued entry at once, formats it ("2026-01-31 12:00:00.123 [INFO    ] ...")
+ * and flushes stdout once per batch.
+ */
+
+#include "Logger.h"
+#include <cstdio>         // For fwrite/fflush
+#include <ctime>          // For timestamp formatting
+#include <stdexcept>      // For std::invalid_argument
+#include <utility>        // For std::swap
+
+namespace logging {
+
+namespace {
+    const char* level_name(crow::LogLevel level) {
+        switch (level) {
+            case crow::LogLevel::Debug: return "DEBUG   ";
+            case crow::LogLevel::Info: return "INFO    ";
+            case crow::LogLevel::Warning: return "WARNING ";
+            case crow::LogLevel::Error: return "ERROR   ";
+            case crow::LogLevel::Critical: return "CRITICAL";
+        }
+        return "UNKNOWN ";
+    }
+
+    void append_timestamp(std::string& out, std::chrono::system_clock::time_point time) {
+        std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+        std::tm parts;
+#if defined(_WIN32)
+        localtime_s(&parts, &seconds);
+#else
+        localtime_r(&seconds, &parts);
+#endif
+        auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+        char buffer[32];
+        size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &parts);
+        std::snprintf(buffer + length, sizeof(buffer) - length, ".%03d", static_cast<int>(millis));
+        out += buffer;
+    }
+}
+
+crow::LogLevel parse_level(const std::string& name) {
+    if (name == "debug") return crow::LogLevel::Debug;
+    if (name == "info") return crow::LogLevel::Info;
+    if (name == "warning") return crow::LogLevel::Warning;
+    if (name == "error") return crow::LogLevel::Error;
+    if (name == "critical") return crow::LogLevel::Critical;
+    throw std::invalid_argument("Invalid value for --log-level: " + name);
+}
+
+AsyncLog& AsyncLog::instance() {
+    static AsyncLog log;
+    return log;
+}
+
+AsyncLog::AsyncLog() : ring(capacity) {
+    writer = std::thread([this] { run(); });
+}
+
+AsyncLog::~AsyncLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    writer.join();  // The writer drains the ring before exiting
+}
+
+void AsyncLog::push(crow::LogLevel level, std::string message) {
+    auto now = std::chrono::system_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == capacity) {
+            dropped++;
+            return;
+        }
+        Entry& entry = ring[(head + count) % capacity];
+        entry.time = now;
+        entry.level = level;
+        entry.message = std::move(message);
+        count++;
+        enqueued++;
+    }
+    ready.notify_one();
+}
+
+void AsyncLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = enqueued;
+    drained.wait(lock, [&] { return written >= target; });
+}
+
+void AsyncLog::run() {
+    std::vector<Entry> batch;
+    std::string text;
+    for (;;) {
+        uint64_t lost;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || count > 0; });
+            if (count == 0 && stopping) return;
+
+            // Move the queued entries out so producers are never held up by I/O
+            batch.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                std::swap(batch[i], ring[(head + i) % capacity]);
+            }
+            head = (head + count) % capacity;
+            count = 0;
+            lost = dropped;
+            dropped = 0;
+        }
+
+        text.clear();
+        if (lost > 0) {
+            append_timestamp(text, std::chrono::system_clock::now());
+            text += " [WARNING ] " + std::to_string(lost) + " log messages dropped (buffer full)\n";
+        }
+        for (const Entry& entry : batch) {
+            append_timestamp(text, entry.time);
+            text += " [";
+            text += level_name(entry.level);
+            text += "] ";
+            text += entry.message;
+            if (entry.message.empty() || entry.message.back() != '\n') text.push_back('\n');
+        }
+        std::fwrite(text.data(), 1, text.size(), stdout);
+        std::fflush(stdout);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            written += batch.size();
+        }
+        drained.notify_all();
+    }
+}
+
+}
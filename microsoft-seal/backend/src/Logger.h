@@ -0,0 +1,108 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "crow/logging.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Asynchronous, level-filtered logging for request handlers
+ *
+ *   HE_LOG(Info) << "Homomorphic addition | Scheme: " << scheme;
+ *
+ * The level threshold is Crow's (app.loglevel(...)), and a filtered-out
+ * statement costs one comparison: its arguments are not even evaluated.
+ * Messages that pass are formatted on the calling thread, pushed into a
+ * fixed-size ring buffer and written to stdout by a background thread, so
+ * handlers never wait on console I/O. When the buffer is full new messages
+ * are dropped (and counted) rather than blocking the producer.
+ *
+ * AsyncLog also implements crow::ILogHandler, so Crow's own messages can
+ * share the same writer (crow::logger::setHandler(&logging::AsyncLog::instance())).
+ */
+namespace logging {
+
+    // true if a message at level passes Crow's current threshold
+    inline bool enabled(crow::LogLevel level) {
+        return level >= crow::logger::get_current_log_level();
+    }
+
+    // "debug", "info", "warning", "error" or "critical"; throws std::invalid_argument otherwise
+    crow::LogLevel parse_level(const std::string& name);
+
+    class AsyncLog : public crow::ILogHandler {
+    public:
+        static AsyncLog& instance();
+
+        ~AsyncLog() override;
+
+        AsyncLog(const AsyncLog&) = delete;
+        AsyncLog& operator=(const AsyncLog&) = delete;
+
+        // Queue a message; returns immediately
+        void push(crow::LogLevel level, std::string message);
+
+        // crow::ILogHandler
+        void log(std::string message, crow::LogLevel level) override { push(level, std::move(message)); }
+
+        // Block until everything queued so far has been written
+        void flush();
+
+    private:
+        struct Entry {
+            std::chrono::system_clock::time_point time;
+            crow::LogLevel level = crow::LogLevel::Info;
+            std::string message;
+        };
+
+        static constexpr size_t capacity = 8192;
+
+        std::mutex mutex;
+        std::condition_variable ready;    // Writer waits for entries
+        std::condition_variable drained;  // flush() waits for the writer
+        std::vector<Entry> ring;
+        size_t head = 0;                  // Oldest queued entry
+        size_t count = 0;
+        uint64_t dropped = 0;
+        uint64_t enqueued = 0;
+        uint64_t written = 0;
+        bool stopping = false;
+        std::thread writer;
+
+        AsyncLog();
+        void run();
+    };
+
+    // One log statement; the message is queued when the temporary is destroyed
+    class Line {
+    public:
+        explicit Line(crow::LogLevel level) : level(level) {}
+        ~Line() { AsyncLog::instance().push(level, out.str()); }
+
+        Line(const Line&) = delete;
+        Line& operator=(const Line&) = delete;
+
+        std::ostringstream& stream() { return out; }
+
+    private:
+        crow::LogLevel level;
+        std::ostringstream out;
+    };
+
+    // Lets HE_LOG be a single expression (safe inside unbraced if/else)
+    struct Voidify {
+        void operator&(std::ostream&) {}
+    };
+}
+
+#define HE_LOG(level)                                           \
+    !::logging::enabled(crow::LogLevel::level) ? (void)0 :      \
+        ::logging::Voidify() & ::logging::Line(crow::LogLevel::level).stream()
+
+#endif // LOGGER_H
@@ -0,0 +1,19 @@
+#include "LogisticModel.h"
+#include <stdexcept>
+
+void LogisticModel::fold_standardization(const std::vector<double>& mean, const std::vector<double>& scale) {
+    if (mean.size() != weights.size() || scale.size() != weights.size()) {
+        throw std::invalid_argument("Expected one mean and scale per weight");
+    }
+    for (size_t i = 0; i < weights.size(); i++) {
+        if (scale[i] == 0) throw std::invalid_argument("Standardization scale must be nonzero");
+        weights[i] /= scale[i];
+        bias -= weights[i] * mean[i];
+    }
+}
+
+size_t LogisticModel::block_size() const {
+    size_t block = 1;
+    while (block < weights.size()) block <<= 1;
+    return block;
+}
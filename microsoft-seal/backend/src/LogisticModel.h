@@ -0,0 +1,35 @@
+#ifndef LOGISTIC_MODEL_H
+#define LOGISTIC_MODEL_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * A trained logistic regression model for encrypted scoring:
+ * probability = sigmoid(weights . x + bias), the sigmoid being a polynomial
+ *
+ * Clients pack one patient per block of block_size() slots (feature i of
+ * patient p in slot p * block_size() + i); slot p * block_size() of the
+ * result holds patient p's probability (see
+ * HomomorphicEncryption::logistic_regression).
+ */
+struct LogisticModel {
+    std::string name;
+    std::vector<std::string> features;  // Optional feature names, in packing order
+    std::vector<double> weights;        // One per feature
+    double bias = 0.0;
+    std::vector<double> sigmoid;        // Coefficients of x^0, x^1, ... of the sigmoid approximation
+
+    /**
+     * Fold a standardization (x - mean) / scale, e.g. scikit-learn's
+     * StandardScaler, into weights and bias, so clients encrypt raw features
+     * @throws std::invalid_argument for sizes other than weights.size() or a zero scale
+     */
+    void fold_standardization(const std::vector<double>& mean, const std::vector<double>& scale);
+
+    // Slots per patient: the feature count rounded up to a power of two
+    size_t block_size() const;
+};
+
+#endif // LOGISTIC_MODEL_H
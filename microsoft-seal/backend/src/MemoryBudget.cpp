@@ -0,0 +1,191 @@
+/**
+ * MemoryBudget.cpp
+ *
+ * Idle expiry, per-tenant quotas and cost-aware eviction across the
+ * server's caches.
+ */
+
+#include "MemoryBudget.h"
+#include "Metrics.h"
+#include <algorithm>      // For std::max, std::find_if
+#include <iterator>       // For std::prev
+
+namespace {
+    // Idle seconds x bytes per microsecond of rebuild cost: the higher, the sooner an entry goes
+    double eviction_score(const MemoryBudget::Candidate& candidate, MemoryBudget::Clock::time_point now) {
+        double idle = std::chrono::duration<double>(now - candidate.last_used).count();
+        return std::max(idle, 1e-3) * static_cast<double>(candidate.bytes) / std::max(candidate.rebuild_us, 1.0);
+    }
+}
+
+MemoryBudget::MemoryBudget(Options options) : options_(options) {}
+
+MemoryBudget::Sweeper::Sweeper(MemoryBudget& budget, std::chrono::milliseconds interval)
+    : budget(budget), interval(interval) {
+    if (interval.count() > 0) worker = std::thread([this] { run(); });
+}
+
+MemoryBudget::Sweeper::~Sweeper() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void MemoryBudget::Sweeper::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+        lock.unlock();
+        budget.sweep();
+        lock.lock();
+    }
+}
+
+void MemoryBudget::add(const std::string& type, Consumer& consumer, std::chrono::seconds ttl) {
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        registrations.push_back(Registration{type, &consumer, ttl});
+        first = totals.emplace(type, Totals{}).second;
+    }
+    if (first) {
+        const metrics::Labels labels{{"type", type}};
+        metrics::gauge("he_memory_bytes", "Bytes held per cache entry type", labels,
+                       [this, type] { return static_cast<double>(usage_of(type).bytes); });
+        metrics::gauge("he_memory_entries", "Entries held per cache entry type", labels,
+                       [this, type] { return static_cast<double>(usage_of(type).entries); });
+    }
+}
+
+std::vector<MemoryBudget::Registration> MemoryBudget::consumers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return registrations;
+}
+
+void MemoryBudget::count(const std::string& type, const char* reason, size_t entries, size_t bytes,
+                         double rebuild_us) {
+    if (entries == 0) return;
+    metrics::counter("he_memory_evictions_total", "Cache entries dropped by type and reason (ttl, quota, budget)",
+                     {{"type", type}, {"reason", reason}}).add(entries);
+    metrics::counter("he_memory_evicted_bytes_total", "Bytes of cache entries dropped by type and reason",
+                     {{"type", type}, {"reason", reason}}).add(bytes);
+    metrics::counter("he_memory_eviction_cost_microseconds_total",
+                     "Measured cost of making the dropped cache entries again, by type",
+                     {{"type", type}}).add(static_cast<uint64_t>(rebuild_us));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Totals& total = totals[type];
+    if (std::string(reason) == "ttl") {
+        total.expirations += entries;
+    } else {
+        total.evictions += entries;
+    }
+    total.evicted_bytes += bytes;
+    total.eviction_cost_us += rebuild_us;
+}
+
+/**
+ * Evict the best candidate across the consumers, of the tenant if given,
+ * until bytes is at most limit or nothing may go
+ * @return Bytes evicted
+ */
+size_t MemoryBudget::evict_until(const std::vector<Registration>& consumers, const std::string* tenant,
+                                 size_t bytes, size_t limit, const char* reason) {
+    size_t freed = 0;
+    while (bytes > limit) {
+        const auto now = Clock::now();
+        const Registration* best = nullptr;
+        double best_score = 0;
+        for (const Registration& registration : consumers) {
+            Candidate candidate;
+            if (!registration.consumer->eviction_candidate(tenant, candidate)) continue;
+            double score = eviction_score(candidate, now);
+            if (!best || score > best_score) {
+                best = &registration;
+                best_score = score;
+            }
+        }
+        Candidate evicted;
+        if (!best || !best->consumer->evict(tenant, evicted)) break;
+        count(best->type, reason, 1, evicted.bytes, evicted.rebuild_us);
+        bytes -= std::min(bytes, evicted.bytes);
+        freed += evicted.bytes;
+    }
+    return freed;
+}
+
+size_t MemoryBudget::sweep() {
+    std::lock_guard<std::mutex> sweeping(sweep_mutex);
+    const std::vector<Registration> all = consumers();
+    size_t freed = 0;
+
+    const auto now = Clock::now();
+    for (const Registration& registration : all) {
+        if (registration.ttl.count() == 0) continue;
+        Usage expired = registration.consumer->expire(now - registration.ttl);
+        count(registration.type, "ttl", expired.entries, expired.bytes, expired.rebuild_us);
+        freed += expired.bytes;
+    }
+
+    if (options_.tenant_quota_bytes > 0) {
+        for (const auto& [tenant, bytes] : tenant_usage()) {
+            freed += evict_until(all, &tenant, bytes, options_.tenant_quota_bytes, "quota");
+        }
+    }
+
+    if (options_.max_bytes > 0) freed += evict_until(all, nullptr, used_bytes(), options_.max_bytes, "budget");
+    return freed;
+}
+
+std::vector<MemoryBudget::TypeReport> MemoryBudget::report() const {
+    std::vector<TypeReport> reports;
+    for (const Registration& registration : consumers()) {
+        Usage usage = registration.consumer->budget_usage();
+        auto it = std::find_if(reports.begin(), reports.end(),
+                               [&](const TypeReport& entry) { return entry.type == registration.type; });
+        if (it == reports.end()) {
+            reports.push_back(TypeReport{registration.type, {}, registration.ttl});
+            it = std::prev(reports.end());
+        }
+        it->usage.entries += usage.entries;
+        it->usage.bytes += usage.bytes;
+        it->usage.rebuild_us += usage.rebuild_us;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (TypeReport& entry : reports) {
+        const Totals& total = totals.at(entry.type);
+        entry.evictions = total.evictions;
+        entry.expirations = total.expirations;
+        entry.evicted_bytes = total.evicted_bytes;
+        entry.eviction_cost_us = total.eviction_cost_us;
+    }
+    return reports;
+}
+
+MemoryBudget::Usage MemoryBudget::usage_of(const std::string& type) const {
+    Usage total;
+    for (const Registration& registration : consumers()) {
+        if (registration.type != type) continue;
+        Usage usage = registration.consumer->budget_usage();
+        total.entries += usage.entries;
+        total.bytes += usage.bytes;
+        total.rebuild_us += usage.rebuild_us;
+    }
+    return total;
+}
+
+std::map<std::string, size_t> MemoryBudget::tenant_usage() const {
+    std::map<std::string, size_t> usage;
+    for (const Registration& registration : consumers()) {
+        for (const auto& [tenant, bytes] : registration.consumer->tenant_bytes()) usage[tenant] += bytes;
+    }
+    return usage;
+}
+
+size_t MemoryBudget::used_bytes() const {
+    size_t bytes = 0;
+    for (const Registration& registration : consumers()) bytes += registration.consumer->budget_usage().bytes;
+    return bytes;
+}
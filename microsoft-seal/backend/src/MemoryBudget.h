@@ -0,0 +1,183 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * One memory budget over the server's caches and stores, with idle expiry and
+ * per-tenant quotas (--memory-budget-mb, --tenant-quota-mb, --*-ttl-s)
+ *
+ * Each cache keeps its own bound (--tenant-key-cache-mb, --result-cache-mb,
+ * ...), which caps it on its own; this caps them together. A Sweeper
+ * sweeps them every interval:
+ *
+ *   1. entries of a type unused for longer than its TTL are dropped;
+ *   2. while a tenant holds more than the quota, across every cache that
+ *      records tenants, its entries are evicted;
+ *   3. while all the caches hold more than max_bytes, entries are evicted.
+ *
+ * Each cache offers one candidate at a time, its least recently used entry
+ * that may go, and says what the entry cost to make: the key load, encode,
+ * computation or spill measured when it was made. Of the candidates the one
+ * with the most idle seconds x bytes per microsecond of that cost goes first,
+ * so a response that took a second to compute outlives an encoded constant
+ * of the same size unused for as long. An evicted entry is made again on its
+ * next use, at that cost; the cost is what eviction_cost_us adds up.
+ *
+ * Between sweeps the caches may run over by what one interval brings in, up
+ * to their own bounds. Entries, bytes, evictions, expirations and their cost
+ * per type are exported as he_memory_* on /metrics and on GET /admin/memory.
+ * Thread-safe. Consumers are called without the budget's own lock held;
+ * they must outlive the Sweeper and any sweep().
+ */
+class MemoryBudget {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Entries of a cache, in total
+    struct Usage {
+        size_t entries = 0;
+        size_t bytes = 0;
+        double rebuild_us = 0;  // Summed cost of making the entries again
+    };
+
+    // An entry a cache would give up next
+    struct Candidate {
+        Clock::time_point last_used;
+        size_t bytes = 0;
+        double rebuild_us = 0;
+    };
+
+    /**
+     * A cache or store under the budget
+     *
+     * Implementations take their own lock in each call. A candidate and the
+     * eviction that follows may see different entries if the cache changed
+     * in between; that only makes the choice slightly less exact.
+     */
+    class Consumer {
+    public:
+        virtual ~Consumer() = default;
+
+        virtual Usage budget_usage() const = 0;
+
+        // Bytes held per tenant; empty for caches shared by all tenants
+        virtual std::map<std::string, size_t> tenant_bytes() const { return {}; }
+
+        /**
+         * The entry evict() would drop, of the tenant if one is given
+         * @return false if nothing may go
+         */
+        virtual bool eviction_candidate(const std::string* tenant, Candidate& candidate) const = 0;
+
+        /**
+         * Drop that entry
+         * @return false if nothing may go (evicted is then unchanged)
+         */
+        virtual bool evict(const std::string* tenant, Candidate& evicted) = 0;
+
+        // Drop every entry last used before the given time; returns what was dropped
+        virtual Usage expire(Clock::time_point before) = 0;
+    };
+
+    struct Options {
+        size_t max_bytes = 0;           // Over every consumer; 0 = no shared bound
+        size_t tenant_quota_bytes = 0;  // Per tenant; 0 = none
+    };
+
+    /**
+     * Sweeps a budget on a background thread while it exists. Declared after
+     * the consumers, so that it stops before any of them is destroyed
+     */
+    class Sweeper {
+    public:
+        // @param interval Time between sweeps; zero starts no thread
+        Sweeper(MemoryBudget& budget, std::chrono::milliseconds interval);
+        ~Sweeper();
+
+        Sweeper(const Sweeper&) = delete;
+        Sweeper& operator=(const Sweeper&) = delete;
+
+    private:
+        MemoryBudget& budget;
+        const std::chrono::milliseconds interval;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+        std::thread worker;
+
+        void run();
+    };
+
+    // Per entry type, for reports
+    struct TypeReport {
+        std::string type;
+        Usage usage;
+        std::chrono::seconds ttl{0};
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+        size_t evicted_bytes = 0;       // Evicted and expired
+        double eviction_cost_us = 0;    // Cost of making the evicted and expired entries again
+    };
+
+    explicit MemoryBudget(Options options);
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    /**
+     * Put a consumer under the budget. Consumers of one type (e.g. the
+     * plaintext caches of every engine) are reported together
+     * @param ttl Idle time after which entries are dropped; zero keeps them
+     */
+    void add(const std::string& type, Consumer& consumer, std::chrono::seconds ttl = std::chrono::seconds(0));
+
+    /**
+     * Expire and evict now, as the Sweeper does
+     * @return Bytes dropped
+     */
+    size_t sweep();
+
+    std::vector<TypeReport> report() const;
+    std::map<std::string, size_t> tenant_usage() const;
+    size_t used_bytes() const;
+    const Options& options() const { return options_; }
+
+private:
+    struct Registration {
+        std::string type;
+        Consumer* consumer;
+        std::chrono::seconds ttl;
+    };
+
+    struct Totals {
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+        size_t evicted_bytes = 0;
+        double eviction_cost_us = 0;
+    };
+
+    const Options options_;
+
+    mutable std::mutex mutex;  // Guards registrations and totals
+    std::vector<Registration> registrations;
+    std::map<std::string, Totals> totals;
+
+    std::mutex sweep_mutex;  // One sweep at a time
+
+    std::vector<Registration> consumers() const;
+    Usage usage_of(const std::string& type) const;
+    size_t evict_until(const std::vector<Registration>& consumers, const std::string* tenant, size_t bytes,
+                       size_t limit, const char* reason);
+    void count(const std::string& type, const char* reason, size_t entries, size_t bytes, double rebuild_us);
+};
+
+#endif // MEMORY_BUDGET_H
@@ -0,0 +1,557 @@
+/**
+ * Metrics.cpp
+ *
+ * Series registry, histogram bucketing and Prometheus text rendering.
+ */
+
+#include "Metrics.h"
+#include "Cancellation.h"
+#include "Tracing.h"
+#include "seal/lockcounts.h"
+#include "seal/memorymanager.h"
+#include "seal/operationcounts.h"
+#include "seal/util/hugepages.h"
+#include <cctype>         // For std::isxdigit
+#include <cmath>          // For std::ldexp
+#include <cstring>        // For std::strcmp
+#include <limits>         // For infinity and the unset pool limit
+#include <map>            // Sorted families for stable output
+#include <memory>         // For std::unique_ptr
+#include <mutex>          // For std::lock_guard
+#include <optional>       // The thread's seal::MemoryUsageGuard
+#include <set>            // Distinct endpoint labels
+#include <shared_mutex>   // Readers look series up concurrently
+#include <sstream>        // For number formatting
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+#elif defined(__APPLE__)
+    #include <mach/mach.h>
+#else
+    #include <fstream>
+    #include <unistd.h>
+#endif
+
+namespace metrics {
+
+namespace {
+    // AnonHugePages of /proc/self/smaps_rollup (0 where there is none)
+    size_t anon_huge_page_bytes() {
+#if defined(_WIN32) || defined(__APPLE__)
+        return 0;
+#else
+        std::ifstream rollup("/proc/self/smaps_rollup");
+        std::string field;
+        size_t kilobytes = 0;
+        while (rollup >> field) {
+            if (field == "AnonHugePages:" && rollup >> kilobytes) return kilobytes << 10;
+        }
+        return 0;
+#endif
+    }
+
+    template <typename T>
+    struct Family {
+        std::string help;
+        std::map<std::string, std::unique_ptr<T>> series;  // By rendered label set
+    };
+
+    struct GaugeFamily {
+        std::string help;
+        std::map<std::string, std::function<double()>> series;  // By rendered label set
+    };
+
+    struct Registry {
+        std::shared_mutex mutex;
+        std::map<std::string, Family<Counter>> counters;
+        std::map<std::string, Family<Histogram>> histograms;
+        std::map<std::string, GaugeFamily> gauges;
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    // Distinct endpoint labels kept before falling back to "other"
+    constexpr size_t max_endpoints = 64;
+
+    thread_local std::string thread_endpoint = "none";
+    thread_local StageTimings* thread_timings = nullptr;
+    thread_local RequestMemory* thread_memory = nullptr;
+    thread_local std::optional<seal::MemoryUsageGuard> thread_memory_guard;
+
+    // SEAL operations counted for this thread from its first stage on
+    struct ThreadOperations {
+        seal::OperationCounts counts;
+        seal::OperationCountsGuard guard{&counts};
+    };
+
+    // Stages whose ScopedTimer is running on this thread, innermost last
+    thread_local std::vector<const char*> open_stages;
+
+    bool stage_open(const char* name) {
+        for (const char* open : open_stages) {
+            if (std::strcmp(open, name) == 0) return true;
+        }
+        return false;
+    }
+
+    // The request is traced and sampled, so its stages become spans
+    bool traced() {
+        const tracing::SpanContext* span = tracing::current_span();
+        return span && span->sampled;
+    }
+
+    uint64_t elapsed_us(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::string escape(const std::string& value) {
+        std::string out;
+        out.reserve(value.size());
+        for (char c : value) {
+            if (c == '\\' || c == '"') out.push_back('\\');
+            if (c == '\n') {
+                out += "\\n";
+                continue;
+            }
+            out.push_back(c);
+        }
+        return out;
+    }
+
+    // {a="1",b="2"} (empty string for no labels)
+    std::string format_labels(const Labels& labels) {
+        if (labels.empty()) return "";
+        std::string out = "{";
+        for (size_t i = 0; i < labels.size(); i++) {
+            if (i) out.push_back(',');
+            out += labels[i].first + "=\"" + escape(labels[i].second) + "\"";
+        }
+        out.push_back('}');
+        return out;
+    }
+
+    // Insert one more label into a rendered set: {a="1"} + le -> {a="1",le="2"}
+    std::string with_label(const std::string& labels, const std::string& name, const std::string& value) {
+        std::string label = name + "=\"" + value + "\"";
+        if (labels.empty()) return "{" + label + "}";
+        return labels.substr(0, labels.size() - 1) + "," + label + "}";
+    }
+
+    std::string format_number(double value) {
+        if (value == std::numeric_limits<double>::infinity()) return "+Inf";
+        std::ostringstream out;
+        out.precision(15);
+        out << value;
+        return out.str();
+    }
+
+    template <typename T>
+    T& find_or_create(std::map<std::string, Family<T>>& families, const std::string& name,
+                      const std::string& help, const Labels& labels) {
+        Registry& reg = registry();
+        std::string key = format_labels(labels);
+        {
+            std::shared_lock<std::shared_mutex> lock(reg.mutex);
+            auto family = families.find(name);
+            if (family != families.end()) {
+                auto series = family->second.series.find(key);
+                if (series != family->second.series.end()) return *series->second;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(reg.mutex);
+        Family<T>& family = families[name];
+        if (family.help.empty()) family.help = help;
+        auto& series = family.series[key];
+        if (!series) series = std::make_unique<T>();
+        return *series;
+    }
+
+    // SEAL's lock counters by site, mode and thread group, sites never taken left out
+    std::string render_lock_counts() {
+        std::vector<seal::LockCounts::ThreadGroup> groups = seal::LockCounts::ByLabel();
+        std::string acquisitions, contended, wait;
+        for (const auto& group : groups) {
+            for (size_t site = 0; site < seal::util::lock_site_count; site++) {
+                for (size_t mode = 0; mode < seal::util::lock_mode_count; mode++) {
+                    const seal::LockCounts::Counts& counts = group.counts[site][mode];
+                    if (counts.acquisitions == 0) continue;
+                    std::string labels = std::string("{site=\"") + seal::LockCounts::SiteName(seal::LockSite(site)) +
+                                         "\",mode=\"" + seal::LockCounts::ModeName(seal::LockMode(mode)) +
+                                         "\",thread=\"" + (group.label.empty() ? "unlabeled" : group.label) + "\"}";
+                    acquisitions += "he_seal_lock_acquisitions_total" + labels + " " +
+                                    std::to_string(counts.acquisitions) + "\n";
+                    contended +=
+                        "he_seal_lock_contended_total" + labels + " " + std::to_string(counts.contended) + "\n";
+                    wait +=
+                        "he_seal_lock_wait_seconds_total" + labels + " " + format_number(counts.wait_ns / 1e9) + "\n";
+                }
+            }
+        }
+        return "# HELP he_seal_lock_acquisitions_total SEAL lock acquisitions, by lock site, mode and thread group\n"
+               "# TYPE he_seal_lock_acquisitions_total counter\n" +
+               acquisitions +
+               "# HELP he_seal_lock_contended_total SEAL lock acquisitions that had to wait\n"
+               "# TYPE he_seal_lock_contended_total counter\n" +
+               contended +
+               "# HELP he_seal_lock_wait_seconds_total Time spent waiting for SEAL locks\n"
+               "# TYPE he_seal_lock_wait_seconds_total counter\n" +
+               wait;
+    }
+}
+
+size_t Histogram::bucket_index(uint64_t value_us) {
+    if (value_us <= 1) return 0;
+    // 2^k < value <= 2^(k+1); the range splits at 1.5 * 2^k
+#if defined(_MSC_VER)
+    unsigned long top;
+    _BitScanReverse64(&top, value_us - 1);
+    unsigned k = static_cast<unsigned>(top);
+#else
+    unsigned k = 63 - static_cast<unsigned>(__builtin_clzll(value_us - 1));
+#endif
+    size_t index = 2 * k + ((2 * value_us <= (uint64_t{3} << k)) ? 1 : 2);
+    return index < bucket_count - 1 ? index : bucket_count - 1;
+}
+
+double Histogram::upper_bound(size_t i) {
+    if (i == 0) return 1.0;
+    if (i >= bucket_count - 1) return std::numeric_limits<double>::infinity();
+    size_t k = (i - 1) / 2;
+    return i % 2 ? 1.5 * std::ldexp(1.0, static_cast<int>(k)) : std::ldexp(1.0, static_cast<int>(k + 1));
+}
+
+void Histogram::record(uint64_t value_us) {
+    buckets[bucket_index(value_us)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(value_us, std::memory_order_relaxed);
+}
+
+void Histogram::write(std::string& out, const std::string& name, const std::string& labels) const {
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < bucket_count; i++) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        out += name + "_bucket" + with_label(labels, "le", format_number(upper_bound(i))) + " " +
+               std::to_string(cumulative) + "\n";
+    }
+    out += name + "_sum" + labels + " " + std::to_string(total.load(std::memory_order_relaxed)) + "\n";
+    out += name + "_count" + labels + " " + std::to_string(cumulative) + "\n";
+}
+
+Counter& counter(const std::string& name, const std::string& help, const Labels& labels) {
+    return find_or_create(registry().counters, name, help, labels);
+}
+
+Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels) {
+    return find_or_create(registry().histograms, name, help, labels);
+}
+
+void gauge(const std::string& name, const std::string& help, std::function<double()> sample) {
+    gauge(name, help, {}, std::move(sample));
+}
+
+void gauge(const std::string& name, const std::string& help, const Labels& labels, std::function<double()> sample) {
+    Registry& reg = registry();
+    std::unique_lock<std::shared_mutex> lock(reg.mutex);
+    GaugeFamily& family = reg.gauges[name];
+    if (family.series.empty()) family.help = help;
+    family.series[format_labels(labels)] = std::move(sample);
+}
+
+const char* const SealOperations::names[kind_count] = {"forward_ntt", "inverse_ntt", "key_switch",
+                                                        "base_conversion", "allocation"};
+
+SealOperations SealOperations::current() {
+    static thread_local ThreadOperations thread_operations;
+    const seal::OperationCounts& counts = thread_operations.counts;
+    SealOperations operations;
+    operations.counts = {counts.forward_ntt_count(), counts.inverse_ntt_count(), counts.key_switch_count(),
+                         counts.base_conversion_count(), counts.allocation_count()};
+    return operations;
+}
+
+SealOperations SealOperations::operator-(const SealOperations& since) const {
+    SealOperations difference;
+    for (size_t i = 0; i < kind_count; i++) difference.counts[i] = counts[i] - since.counts[i];
+    return difference;
+}
+
+SealOperations& SealOperations::operator+=(const SealOperations& other) {
+    for (size_t i = 0; i < kind_count; i++) counts[i] += other.counts[i];
+    return *this;
+}
+
+bool SealOperations::empty() const {
+    for (uint64_t count : counts) {
+        if (count) return false;
+    }
+    return true;
+}
+
+std::string SealOperations::json() const {
+    std::string out = "{";
+    for (size_t i = 0; i < kind_count; i++) {
+        out += std::string(i ? "," : "") + "\"" + names[i] + "\":" + std::to_string(counts[i]);
+    }
+    return out + "}";
+}
+
+void StageTimings::add(const char* stage, uint64_t elapsed_us, const SealOperations& operations, bool outermost) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (outermost) total += operations;
+    for (auto& entry : stages) {
+        if (entry.name == stage) {
+            entry.elapsed_us += elapsed_us;
+            entry.operations += operations;
+            return;
+        }
+    }
+    stages.push_back(Entry{stage, elapsed_us, operations});
+}
+
+std::vector<std::pair<std::string, uint64_t>> StageTimings::totals() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, uint64_t>> out;
+    for (const auto& entry : stages) out.emplace_back(entry.name, entry.elapsed_us);
+    return out;
+}
+
+std::vector<std::pair<std::string, SealOperations>> StageTimings::operations() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, SealOperations>> out;
+    for (const auto& entry : stages) {
+        if (!entry.operations.empty()) out.emplace_back(entry.name, entry.operations);
+    }
+    return out;
+}
+
+SealOperations StageTimings::total_operations() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total;
+}
+
+StageTimings* current_timings() {
+    return thread_timings;
+}
+
+void set_current_timings(StageTimings* timings) {
+    thread_timings = timings;
+}
+
+RequestMemory* current_memory() {
+    return thread_memory;
+}
+
+void set_current_memory(RequestMemory* memory) {
+    thread_memory = memory;
+    thread_memory_guard.reset();
+    if (memory) thread_memory_guard.emplace(&memory->pool);
+}
+
+void Stage::record(uint64_t elapsed_us) const {
+    histogram.record(elapsed_us);
+    if (stage_open(name)) return;
+    if (thread_timings) thread_timings->add(name, elapsed_us);
+    if (traced()) {
+        uint64_t end = tracing::unix_ns();
+        tracing::record_stage(scheme, name, end - elapsed_us * 1000, end);
+    }
+}
+
+Stage stage(const char* scheme, const char* stage) {
+    return Stage{histogram("he_stage_duration_microseconds",
+                           "Time spent per homomorphic processing stage",
+                           {{"endpoint", current_endpoint()}, {"scheme", scheme}, {"stage", stage}}),
+                 stage, scheme};
+}
+
+ScopedTimer::ScopedTimer(const Stage& stage) : histogram(stage.histogram) {
+    if (!stage_open(stage.name)) {
+        name = stage.name;
+        scheme = stage.scheme;
+        timings = thread_timings;
+        if (traced()) start_unix_ns = tracing::unix_ns();
+        open_stages.push_back(name);
+        operations = SealOperations::current();
+    }
+    start = std::chrono::steady_clock::now();
+}
+
+ScopedTimer::~ScopedTimer() {
+    uint64_t elapsed = elapsed_us(start);
+    histogram.record(elapsed);
+    if (name) {
+        open_stages.pop_back();
+        SealOperations ran = SealOperations::current() - operations;
+        for (size_t i = 0; i < SealOperations::kind_count; i++) {
+            if (!ran.counts[i]) continue;
+            counter("he_seal_operations_total", "SEAL primitives run per homomorphic processing stage",
+                    {{"scheme", scheme}, {"stage", name}, {"operation", SealOperations::names[i]}})
+                .add(ran.counts[i]);
+        }
+        if (timings) timings->add(name, elapsed, ran, open_stages.empty());
+        if (start_unix_ns) tracing::record_stage(scheme, name, start_unix_ns, tracing::unix_ns());
+    }
+}
+
+std::string render() {
+    Registry& reg = registry();
+    std::string out;
+
+    // Process-level gauges are sampled here rather than registered
+    out += "# HELP process_resident_memory_bytes Current resident set size\n";
+    out += "# TYPE process_resident_memory_bytes gauge\n";
+    out += "process_resident_memory_bytes " + std::to_string(resident_memory_bytes()) + "\n";
+    out += "# HELP he_seal_pool_allocated_bytes Bytes allocated by SEAL's global memory pool\n";
+    out += "# TYPE he_seal_pool_allocated_bytes gauge\n";
+    out += "he_seal_pool_allocated_bytes " + std::to_string(seal::MemoryManager::GetPool().alloc_byte_count()) + "\n";
+    seal::MemoryPoolHandle global_pool = seal::MemoryManager::GetPool(seal::mm_force_global);
+    if (global_pool.byte_count_limit() != std::numeric_limits<size_t>::max()) {
+        out += "# HELP he_seal_pool_limit_bytes Cap on SEAL's global memory pool (--pool-limit-mb)\n";
+        out += "# TYPE he_seal_pool_limit_bytes gauge\n";
+        out += "he_seal_pool_limit_bytes " + std::to_string(global_pool.byte_count_limit()) + "\n";
+        out += "# HELP he_seal_pool_unpooled_total Allocations that bypassed SEAL's global pool at its cap\n";
+        out += "# TYPE he_seal_pool_unpooled_total counter\n";
+        out += "he_seal_pool_unpooled_total " + std::to_string(global_pool.unpooled_count()) + "\n";
+    }
+    if (seal::util::huge_page_config().mode != seal::util::huge_page_mode::none) {
+        seal::util::HugePageStats pages = seal::util::huge_page_stats();
+        out += "# HELP he_seal_huge_page_bytes SEAL pool memory mapped for huge pages, by page kind\n";
+        out += "# TYPE he_seal_huge_page_bytes gauge\n";
+        out += "he_seal_huge_page_bytes{kind=\"thp\"} " + std::to_string(pages.transparent_byte_count) + "\n";
+        out += "he_seal_huge_page_bytes{kind=\"2mb\"} " + std::to_string(pages.hugetlb_2mb_page_count << 21) + "\n";
+        out += "he_seal_huge_page_bytes{kind=\"1gb\"} " + std::to_string(pages.hugetlb_1gb_page_count << 30) + "\n";
+        out += "# HELP he_seal_huge_pages Explicit (hugetlbfs) huge pages held by SEAL's pools\n";
+        out += "# TYPE he_seal_huge_pages gauge\n";
+        out += "he_seal_huge_pages{size=\"2mb\"} " + std::to_string(pages.hugetlb_2mb_page_count) + "\n";
+        out += "he_seal_huge_pages{size=\"1gb\"} " + std::to_string(pages.hugetlb_1gb_page_count) + "\n";
+        out += "# HELP he_seal_huge_page_fallbacks_total Pool blocks that got smaller pages than configured\n";
+        out += "# TYPE he_seal_huge_page_fallbacks_total counter\n";
+        out += "he_seal_huge_page_fallbacks_total " + std::to_string(pages.fallback_count) + "\n";
+        out += "# HELP process_anon_huge_page_bytes Anonymous memory the kernel backs with transparent huge pages\n";
+        out += "# TYPE process_anon_huge_page_bytes gauge\n";
+        out += "process_anon_huge_page_bytes " + std::to_string(anon_huge_page_bytes()) + "\n";
+    }
+    if (seal::LockCounts::Enabled()) out += render_lock_counts();
+
+    std::shared_lock<std::shared_mutex> lock(reg.mutex);
+    for (const auto& gauge : reg.gauges) {
+        out += "# HELP " + gauge.first + " " + gauge.second.help + "\n";
+        out += "# TYPE " + gauge.first + " gauge\n";
+        for (const auto& series : gauge.second.series) {
+            out += gauge.first + series.first + " " + format_number(series.second()) + "\n";
+        }
+    }
+    for (const auto& family : reg.counters) {
+        out += "# HELP " + family.first + " " + family.second.help + "\n";
+        out += "# TYPE " + family.first + " counter\n";
+        for (const auto& series : family.second.series) {
+            out += family.first + series.first + " " + std::to_string(series.second->get()) + "\n";
+        }
+    }
+    for (const auto& family : reg.histograms) {
+        out += "# HELP " + family.first + " " + family.second.help + "\n";
+        out += "# TYPE " + family.first + " histogram\n";
+        for (const auto& series : family.second.series) {
+            series.second->write(out, family.first, series.first);
+        }
+    }
+    return out;
+}
+
+size_t resident_memory_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS info;
+    GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info));
+    return info.WorkingSetSize;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) !=
+        KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    // /proc/self/statm: total and resident size in pages
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+std::string endpoint_label(const std::string& method, const std::string& path) {
+    std::string label = method + " ";
+    size_t start = 0;
+    std::string previous;
+    while (start < path.size()) {
+        size_t slash = path.find('/', start + 1);
+        std::string segment = path.substr(start, slash == std::string::npos ? std::string::npos : slash - start);
+        // Handles and job IDs are 32 hex digits; any long hex segment is treated as one,
+        // as is the patient ID of /vitals/<patient>, which can be anything
+        bool id = segment.size() > 16 || previous == "/vitals";
+        for (size_t i = 1; id && previous != "/vitals" && i < segment.size(); i++) {
+            id = std::isxdigit(static_cast<unsigned char>(segment[i])) != 0;
+        }
+        label += id ? "/:id" : segment;
+        if (slash == std::string::npos) break;
+        previous = std::move(segment);
+        start = slash;
+    }
+
+    static std::mutex mutex;
+    static std::set<std::string> seen;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (seen.count(label)) return label;
+    if (seen.size() >= max_endpoints) return "other";
+    seen.insert(label);
+    return label;
+}
+
+const std::string& current_endpoint() {
+    return thread_endpoint;
+}
+
+void set_current_endpoint(std::string endpoint) {
+    thread_endpoint = std::move(endpoint);
+}
+
+void label_thread(const char* label) {
+    if (seal::LockCounts::Enabled()) seal::LockCounts::SetThreadLabel(label);
+}
+
+RequestContext current_request() {
+    return RequestContext{thread_endpoint, thread_timings, tracing::current_span(), thread_memory,
+                          cancellation::current()};
+}
+
+EndpointScope::EndpointScope(std::string endpoint)
+    : EndpointScope(RequestContext{std::move(endpoint), nullptr, nullptr, nullptr, cancellation::current()}) {}
+
+EndpointScope::EndpointScope(const RequestContext& request)
+    : previous{std::move(thread_endpoint), thread_timings, tracing::current_span(), thread_memory,
+               cancellation::current()} {
+    thread_endpoint = request.endpoint;
+    thread_timings = request.timings;
+    tracing::set_current_span(request.span);
+    set_current_memory(request.memory);
+    cancellation::current() = request.cancellation;
+}
+
+EndpointScope::~EndpointScope() {
+    thread_endpoint = std::move(previous.endpoint);
+    thread_timings = previous.timings;
+    tracing::set_current_span(previous.span);
+    set_current_memory(previous.memory);
+    cancellation::current() = previous.cancellation;
+}
+
+}
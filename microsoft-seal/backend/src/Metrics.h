@@ -0,0 +1,268 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "seal/memorymanager.h"
+#include "seal/operationcounts.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tracing {
+    struct SpanContext;
+}
+
+namespace cancellation {
+    class Token;
+}
+
+/**
+ * Process-wide counters, latency histograms and gauges in Prometheus text format
+ *
+ * Series are created on first use and live for the whole process; recording
+ * into one is a handful of relaxed atomic increments, so handlers and worker
+ * threads never serialize on a lock (finding the series takes a shared lock).
+ * render() produces the GET /metrics body.
+ *
+ * Histograms are log-linear in the HDR style: every power-of-two range of
+ * microseconds is split in two, so the bucket a latency lands in is within
+ * 50% of it from 1 us up to about 2.4 hours.
+ *
+ * Stage timings recorded by HomomorphicEncryption are labelled with the
+ * endpoint of the request the calling thread is serving (see EndpointScope),
+ * and are also added to that request's StageTimings when it asked for them.
+ * Likewise the SEAL pool allocations made on those threads and the ciphertexts
+ * they deserialize count for the request's RequestMemory. Every stage also
+ * counts the SEAL primitives it ran (see SealOperations), in
+ * he_seal_operations_total and in the request's StageTimings.
+ */
+namespace metrics {
+
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    class Counter {
+    public:
+        void add(uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+        uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value{0};
+    };
+
+    class Histogram {
+    public:
+        // Bucket upper bounds: 1, 1.5, 2, 3, 4, 6, 8, ..., 2^33, then +Inf
+        static constexpr size_t bucket_count = 68;
+
+        void record(uint64_t value_us);
+
+        // Upper bound of bucket i (infinity for the last one)
+        static double upper_bound(size_t i);
+
+        // Append the _bucket/_sum/_count lines of this series
+        void write(std::string& out, const std::string& name, const std::string& labels) const;
+
+    private:
+        std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+        std::atomic<uint64_t> total{0};
+
+        static size_t bucket_index(uint64_t value_us);
+    };
+
+    /**
+     * Series lookup; the returned reference stays valid for the life of the process
+     * @param name Metric name, e.g. "he_stage_duration_microseconds"
+     * @param help Description for the # HELP line (taken from the first call)
+     * @param labels Label names and values
+     */
+    Counter& counter(const std::string& name, const std::string& help, const Labels& labels = {});
+    Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    // Value sampled on every scrape (e.g. store size, queue depth)
+    void gauge(const std::string& name, const std::string& help, std::function<double()> sample);
+    void gauge(const std::string& name, const std::string& help, const Labels& labels, std::function<double()> sample);
+
+    /**
+     * SEAL primitives run by a thread and the SEAL helper tasks it started
+     * (see seal::OperationCounts): NTTs per residue polynomial in either
+     * direction, key switches, RNS base conversions and pool allocations
+     * All zero when SEAL is built without SEAL_USE_OPERATION_COUNTS.
+     */
+    struct SealOperations {
+        static constexpr size_t kind_count = 5;
+
+        // "forward_ntt", "inverse_ntt", "key_switch", "base_conversion", "allocation"
+        static const char* const names[kind_count];
+
+        std::array<uint64_t, kind_count> counts{};
+
+        // The calling thread's counts so far
+        static SealOperations current();
+
+        SealOperations operator-(const SealOperations& since) const;
+        SealOperations& operator+=(const SealOperations& other);
+        bool empty() const;
+
+        // {"forward_ntt":12,...}
+        std::string json() const;
+    };
+
+    /**
+     * Per-request totals of each stage, in order of first appearance
+     * Worker threads serving the request add to it concurrently, so a stage
+     * run on four threads for 1 ms each totals 4 ms; a stage that re-enters
+     * itself on the same thread (evaluate inside evaluate) counts once.
+     * The SEAL operations of a stage nest like its time; those of the
+     * outermost stages on each thread add up to the request's total.
+     */
+    class StageTimings {
+    public:
+        void add(const char* stage, uint64_t elapsed_us, const SealOperations& operations = {},
+                 bool outermost = false);
+        std::vector<std::pair<std::string, uint64_t>> totals() const;
+
+        // Stages that ran SEAL operations, and the request's total
+        std::vector<std::pair<std::string, SealOperations>> operations() const;
+        SealOperations total_operations() const;
+
+    private:
+        struct Entry {
+            std::string name;
+            uint64_t elapsed_us;
+            SealOperations operations;
+        };
+
+        mutable std::mutex mutex;
+        std::vector<Entry> stages;
+        SealOperations total;
+    };
+
+    // Timings of the request the calling thread is serving (nullptr when not requested)
+    StageTimings* current_timings();
+    void set_current_timings(StageTimings* timings);
+
+    /**
+     * Memory one request used: the SEAL pool allocations made on the threads
+     * serving it (bytes handed out, and peak bytes held; see seal::MemoryUsage)
+     * and the in-memory size of the ciphertexts it deserialized
+     * Unlike the process's RSS, which the pools keep high once it has grown,
+     * this is what the request itself needed, whatever else runs alongside.
+     */
+    struct RequestMemory {
+        seal::MemoryUsage pool;
+        std::atomic<uint64_t> ciphertext_bytes{0};
+    };
+
+    /**
+     * Memory of the request the calling thread is serving (nullptr outside requests)
+     * Setting it also attaches the thread's SEAL allocations to the request's pool usage.
+     */
+    RequestMemory* current_memory();
+    void set_current_memory(RequestMemory* memory);
+
+    /**
+     * One processing stage of a scheme: its histogram, labelled with the current
+     * endpoint, and its name for the current request's StageTimings
+     */
+    struct Stage {
+        Histogram& histogram;
+        const char* name;
+        const char* scheme;
+
+        void record(uint64_t elapsed_us) const;
+    };
+
+    /**
+     * Stage "parse", "base64_decode", "deserialize", "encode", "encrypt",
+     * "evaluate", "decrypt", "serialize" or "base64_encode" of a scheme
+     * ("none" when the scheme is not known yet)
+     */
+    Stage stage(const char* scheme, const char* stage);
+
+    // Prometheus text exposition of every series, plus process memory gauges
+    std::string render();
+
+    // Current (not peak) resident set size of the process
+    size_t resident_memory_bytes();
+
+    /**
+     * Name the calling thread's group ("io", "compute") in the he_seal_lock_*
+     * series. A no-op unless SEAL was built with SEAL_USE_LOCK_COUNTS
+     */
+    void label_thread(const char* label);
+
+    /**
+     * Endpoint label for a request, e.g. "POST /csv/sum"
+     * Path segments that look like handles or job IDs are collapsed to ":id",
+     * and past a fixed number of distinct labels everything maps to "other",
+     * so arbitrary URLs cannot create unbounded series.
+     */
+    std::string endpoint_label(const std::string& method, const std::string& path);
+
+    // Endpoint the calling thread is working for ("none" outside requests)
+    const std::string& current_endpoint();
+    void set_current_endpoint(std::string endpoint);
+
+    // What the calling thread is working for: endpoint, StageTimings, trace span, RequestMemory and cancellation token
+    struct RequestContext {
+        std::string endpoint;
+        StageTimings* timings = nullptr;
+        const tracing::SpanContext* span = nullptr;
+        RequestMemory* memory = nullptr;
+        const cancellation::Token* cancellation = nullptr;
+    };
+
+    RequestContext current_request();
+
+    /**
+     * Sets the calling thread's request context for the scope's lifetime
+     * Work handed to another thread passes current_request() on, so its stages
+     * and allocations count for the request and it stops when the request is cancelled;
+     * an endpoint alone starts a context of its own (background jobs, websocket messages)
+     * that keeps the thread's cancellation token, e.g. the job's
+     */
+    class EndpointScope {
+    public:
+        explicit EndpointScope(std::string endpoint);
+        explicit EndpointScope(const RequestContext& request);
+        ~EndpointScope();
+
+        EndpointScope(const EndpointScope&) = delete;
+        EndpointScope& operator=(const EndpointScope&) = delete;
+
+    private:
+        RequestContext previous;
+    };
+
+    /**
+     * Adds the elapsed time to a histogram on destruction; for a Stage, also to the
+     * request's timings and, when the request is traced, as a child span, and the
+     * SEAL operations the thread ran meanwhile to he_seal_operations_total
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& histogram)
+            : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+        explicit ScopedTimer(const Stage& stage);
+        ~ScopedTimer();
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram& histogram;
+        const char* name = nullptr;  // Set when this timer is the outermost of its stage
+        const char* scheme = nullptr;
+        StageTimings* timings = nullptr;
+        uint64_t start_unix_ns = 0;  // Set when the stage is traced
+        SealOperations operations;   // The thread's counts when the stage started
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#endif // METRICS_H
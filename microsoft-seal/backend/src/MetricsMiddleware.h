@@ -0,0 +1,183 @@
+#ifndef METRICS_MIDDLEWARE_H
+#define METRICS_MIDDLEWARE_H
+
+#include "crow.h"
+#include "JsonStream.h"
+#include "Metrics.h"
+#include "Probes.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+/**
+ * Records the latency of every request per endpoint and status code, and
+ * tags the handler thread with the endpoint so the stage timings taken
+ * inside HomomorphicEncryption carry it too (Crow runs before_handle, the
+ * handler and after_handle on the same thread)
+ *
+ * A request with ?timings=1 or an "X-HE-Timings: 1" header also gets its
+ * per-stage breakdown back: a "timings" object (microseconds per stage plus
+ * "total") added to a JSON object response, and a Server-Timing header on
+ * any response. Stages nest ("base64_decode" is part of "deserialize",
+ * "encode" may be part of "evaluate"), and time on worker threads adds up,
+ * so the stages need not sum to the total.
+ *
+ * Every request also gets a metrics::RequestMemory for the handler thread
+ * and the workers it hands off to: an X-HE-Memory header on the response
+ * ("pool-allocated", "pool-peak" and "ciphertexts", in bytes), histograms
+ * of the three per endpoint, and with timings a "memory" object next to
+ * "timings" in the body.
+ *
+ * With timings, an "operations" object also lists the SEAL primitives each
+ * stage ran (see metrics::SealOperations), nested like the stage times,
+ * plus the request's "total" and an X-HE-Operations header with it.
+ *
+ * With HE_USDT, request__start / request__done probes bracket every handler
+ * (see Probes.h).
+ */
+struct MetricsMiddleware {
+    struct context {
+        std::chrono::steady_clock::time_point start;
+        std::string endpoint;
+        std::unique_ptr<metrics::StageTimings> timings;  // Only when the request asked for them
+        std::unique_ptr<metrics::RequestMemory> memory;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        static thread_local bool labeled = (metrics::label_thread("io"), true);  // Once per Crow I/O thread
+        (void)labeled;
+        ctx.start = std::chrono::steady_clock::now();
+        ctx.endpoint = metrics::endpoint_label(crow::method_name(req.method), req.url);
+        metrics::set_current_endpoint(ctx.endpoint);
+        if (wants_timings(req)) ctx.timings = std::make_unique<metrics::StageTimings>();
+        metrics::set_current_timings(ctx.timings.get());
+        ctx.memory = std::make_unique<metrics::RequestMemory>();
+        metrics::set_current_memory(ctx.memory.get());
+        HE_PROBE(request__start, ctx.endpoint.c_str(), static_cast<uint64_t>(req.body_view().size()));
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        // Crow answers requests no route matches (404, OPTIONS preflights) with after_handle alone
+        if (!ctx.memory) return;
+        auto elapsed = std::chrono::steady_clock::now() - ctx.start;
+        uint64_t total_us =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        metrics::histogram("he_request_duration_microseconds", "End-to-end request latency",
+                           {{"endpoint", ctx.endpoint}, {"status", std::to_string(res.code)}})
+            .record(total_us);
+        metrics::set_current_endpoint("none");
+        metrics::set_current_timings(nullptr);
+        metrics::set_current_memory(nullptr);
+        std::string memory = report_memory(res, ctx.endpoint, *ctx.memory);
+        if (ctx.timings) {
+            report(res, ctx.timings->totals(), total_us);
+            splice(res, "memory", memory);
+            report_operations(res, *ctx.timings);
+        }
+        HE_PROBE(request__done, ctx.endpoint.c_str(), static_cast<uint64_t>(res.code),
+                 static_cast<uint64_t>(res.body.size()));
+    }
+
+private:
+    static bool wants_timings(const crow::request& req) {
+        const char* param = req.url_params.get("timings");
+        if (param) return std::string(param) != "0" && std::string(param) != "false";
+        const std::string& header = req.get_header_value("X-HE-Timings");
+        return !header.empty() && header != "0" && header != "false";
+    }
+
+    // Splice "timings" into a JSON object body and add the Server-Timing header (milliseconds)
+    static void report(crow::response& res, const std::vector<std::pair<std::string, uint64_t>>& stages,
+                       uint64_t total_us) {
+        std::string object = "{";
+        std::string header;
+        char duration[32];
+        for (const auto& stage : stages) {
+            object += "\"" + stage.first + "\":" + std::to_string(stage.second) + ",";
+            std::snprintf(duration, sizeof(duration), ";dur=%.3f, ", static_cast<double>(stage.second) / 1000);
+            header += stage.first + duration;
+        }
+        object += "\"total\":" + std::to_string(total_us) + "}";
+        std::snprintf(duration, sizeof(duration), ";dur=%.3f", static_cast<double>(total_us) / 1000);
+        header += std::string("total") + duration;
+        res.add_header("Server-Timing", header);
+        splice(res, "timings", object);
+    }
+
+    // Record the request's memory per endpoint and add the X-HE-Memory header; returns it as a JSON object
+    static std::string report_memory(crow::response& res, const std::string& endpoint,
+                                     const metrics::RequestMemory& memory) {
+        uint64_t allocated = memory.pool.allocated_byte_count();
+        uint64_t peak = static_cast<uint64_t>(std::max<int64_t>(memory.pool.peak_byte_count(), 0));
+        uint64_t ciphertexts = memory.ciphertext_bytes.load(std::memory_order_relaxed);
+        metrics::histogram("he_request_pool_allocated_bytes", "SEAL memory pool bytes handed out per request",
+                           {{"endpoint", endpoint}})
+            .record(allocated);
+        metrics::histogram("he_request_pool_peak_bytes", "Peak SEAL memory pool bytes held by a request",
+                           {{"endpoint", endpoint}})
+            .record(peak);
+        metrics::histogram("he_request_ciphertext_bytes", "In-memory size of the ciphertexts a request deserialized",
+                           {{"endpoint", endpoint}})
+            .record(ciphertexts);
+        res.add_header("X-HE-Memory", "pool-allocated=" + std::to_string(allocated) + ", pool-peak=" +
+                                          std::to_string(peak) + ", ciphertexts=" + std::to_string(ciphertexts));
+        return "{\"pool_allocated_bytes\":" + std::to_string(allocated) + ",\"pool_peak_bytes\":" +
+               std::to_string(peak) + ",\"ciphertext_bytes\":" + std::to_string(ciphertexts) + "}";
+    }
+
+    // Splice the SEAL operations per stage and in total, and add the X-HE-Operations header
+    static void report_operations(crow::response& res, const metrics::StageTimings& timings) {
+        metrics::SealOperations total = timings.total_operations();
+        std::string object = "{";
+        for (const auto& stage : timings.operations()) {
+            object += "\"" + stage.first + "\":" + stage.second.json() + ",";
+        }
+        object += "\"total\":" + total.json() + "}";
+        std::string header;
+        for (size_t i = 0; i < metrics::SealOperations::kind_count; i++) {
+            header += std::string(i ? ", " : "") + metrics::SealOperations::names[i] + "=" +
+                      std::to_string(total.counts[i]);
+        }
+        res.add_header("X-HE-Operations", header);
+        splice(res, "operations", object);
+    }
+
+    // Add "key": object to a JSON object body (other bodies are left alone)
+    static void splice(crow::response& res, const char* key, const std::string& object) {
+        std::string& body = res.body;
+        if (res.get_header_value("Content-Type").find("json") == std::string::npos) return;
+        size_t close = body.find_last_not_of(" \t\r\n");
+        if (close == std::string::npos || body[close] != '}' || body[body.find_first_not_of(" \t\r\n")] != '{') {
+            return;
+        }
+        size_t last = body.find_last_not_of(" \t\r\n", close - 1);
+        bool empty = body[last] == '{';
+        body.insert(close, std::string(empty ? "" : ",") + "\"" + key + "\":" + object);
+    }
+};
+
+/**
+ * crow::json::load of a request body, timed as the "parse" stage
+ * Use parse_json(req.body_view()) in place of crow::json::load(req.body) so
+ * the JSON decoding of large ciphertext uploads shows up in the metrics and in
+ * the request's timings, and bodies spilled to disk are read from their mapping.
+ */
+inline crow::json::rvalue parse_json(std::string_view body) {
+    metrics::ScopedTimer timer(metrics::stage("none", "parse"));
+    return crow::json::load(body.data(), body.size());
+}
+
+/**
+ * parse_json of a body whose key member is a large array of strings (e.g. "encrypted_values"):
+ * the array is left in the body for values to read one string at a time, and only the other
+ * members are loaded (json_data[key] is then an empty array; see json_stream::split)
+ */
+inline crow::json::rvalue parse_json(std::string_view body, const std::string& key,
+                                     json_stream::StringArray& values) {
+    metrics::ScopedTimer timer(metrics::stage("none", "parse"));
+    return crow::json::load(json_stream::split(body, key, values));
+}
+
+#endif // METRICS_MIDDLEWARE_H
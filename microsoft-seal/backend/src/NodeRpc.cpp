@@ -0,0 +1,353 @@
+/**
+ * NodeRpc.cpp
+ *
+ * Framing, listener and pooled client connections of the node-to-node protocol.
+ */
+
+#include "NodeRpc.h"
+#include "BinaryFraming.h"  // For the little-endian integer helpers
+#include "Logger.h"
+#ifndef ASIO_STANDALONE
+    #define ASIO_STANDALONE
+#endif
+#include <asio/ip/tcp.hpp>  // For the listener and the client streams
+#include <asio/read.hpp>
+#include <asio/write.hpp>
+#include <array>            // For the gathered response write
+#include <list>             // For the listener's connection threads
+#include <stdexcept>        // For std::runtime_error
+#include <thread>           // For the accept and connection threads
+
+namespace node_rpc {
+
+namespace {
+    constexpr uint32_t magic = 0x31435052;            // "RPC1"
+    constexpr uint64_t max_response = uint64_t(1) << 36;  // Rejects garbage lengths before allocating
+
+    void put_field(std::string& out, const std::string& field) {
+        if (field.size() > 0xFFFF) throw std::invalid_argument("RPC header field too long");
+        framing::put_uint(out, field.size(), 2);
+        out.append(field);
+    }
+
+    std::string get_field(const std::string& in, size_t& pos) {
+        size_t size = static_cast<size_t>(framing::get_uint(in, pos, 2));
+        if (in.size() - pos < size) throw std::invalid_argument("Truncated RPC message");
+        std::string field = in.substr(pos, size);
+        pos += size;
+        return field;
+    }
+
+    // Everything up to the payload (which is written after it, uncopied), length prefix included
+    std::string encode_head(uint64_t id, const Request& request) {
+        std::string out;
+        out.reserve(40 + request.scheme.size() + request.compression.size() + request.handle.size());
+        framing::put_uint(out, 0, 8);
+        framing::put_uint(out, magic, 4);
+        framing::put_uint(out, id, 8);
+        framing::put_uint(out, static_cast<uint16_t>(request.op), 2);
+        put_field(out, request.scheme);
+        put_field(out, request.compression);
+        put_field(out, request.handle);
+        std::string length;
+        framing::put_uint(length, out.size() - 8 + request.payload.size(), 8);
+        out.replace(0, 8, length);
+        return out;
+    }
+
+    std::string encode_head(uint64_t id, const Response& response) {
+        std::string out;
+        framing::put_uint(out, 14 + response.payload.size(), 8);
+        framing::put_uint(out, magic, 4);
+        framing::put_uint(out, id, 8);
+        framing::put_uint(out, response.status, 2);
+        return out;
+    }
+
+    // Magic and id of a message; pos is left at the rest
+    uint64_t decode_prefix(const std::string& message, size_t& pos) {
+        if (framing::get_uint(message, pos, 4) != magic) throw std::invalid_argument("Not an RPC message");
+        return framing::get_uint(message, pos, 8);
+    }
+
+    uint64_t message_length(const char* prefix) {
+        size_t pos = 0;
+        return framing::get_uint(std::string_view(prefix, 8), pos, 8);
+    }
+}
+
+const char* op_name(Op op) {
+    switch (op) {
+        case Op::store: return "store";
+        case Op::store_sum: return "store_sum";
+        case Op::store_delete: return "store_delete";
+        case Op::csv_sum: return "csv_sum";
+        case Op::galois_keys: return "galois_keys";
+        case Op::column_sum: return "column_sum";
+    }
+    return "unknown";
+}
+
+// ---------------------------------------------------------------------------
+// Server
+// ---------------------------------------------------------------------------
+
+struct Server::Impl {
+    struct Connection {
+        asio::ip::tcp::socket socket;
+        std::thread thread;
+        bool finished = false;
+
+        explicit Connection(asio::ip::tcp::socket socket) : socket(std::move(socket)) {}
+    };
+
+    Handler handler;
+    const uint64_t max_request;
+    asio::io_context io;
+    asio::ip::tcp::acceptor acceptor;
+    std::thread io_thread;
+    std::mutex mutex;
+    bool stopping = false;
+    std::list<Connection> connections;
+
+    Impl(uint16_t port, Handler handler, uint64_t max_request)
+        : handler(std::move(handler)), max_request(max_request), acceptor(io) {
+        asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), port);
+        asio::error_code ec;
+        acceptor.open(endpoint.protocol(), ec);
+        if (!ec) acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
+        if (!ec) acceptor.bind(endpoint, ec);
+        if (!ec) acceptor.listen(asio::socket_base::max_listen_connections, ec);
+        if (ec) throw std::runtime_error("Could not listen on RPC port " + std::to_string(port) + ": " + ec.message());
+        accept();
+        io_thread = std::thread([this] { io.run(); });
+    }
+
+    ~Impl() {
+        io.stop();
+        if (io_thread.joinable()) io_thread.join();
+        std::list<Connection> open;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (auto& connection : connections) {
+                asio::error_code ignored;
+                connection.socket.shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+            }
+            open.splice(open.end(), connections);
+        }
+        for (auto& connection : open) {
+            if (connection.thread.joinable()) connection.thread.join();
+        }
+    }
+
+    // Every accepted connection gets its own thread; finished ones are joined here
+    void accept() {
+        acceptor.async_accept([this](const asio::error_code& ec, asio::ip::tcp::socket socket) {
+            if (ec) {
+                if (ec != asio::error::operation_aborted) HE_LOG(Warning) << "RPC accept failed: " << ec.message();
+                if (acceptor.is_open()) accept();
+                return;
+            }
+            socket.set_option(asio::ip::tcp::no_delay(true));
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = connections.begin(); it != connections.end();) {
+                if (!it->finished) {
+                    ++it;
+                    continue;
+                }
+                it->thread.join();
+                it = connections.erase(it);
+            }
+            if (stopping) return;
+            connections.emplace_back(std::move(socket));
+            Connection& connection = connections.back();
+            connection.thread = std::thread([this, &connection] {
+                serve(connection.socket);
+                std::lock_guard<std::mutex> lock(mutex);
+                connection.finished = true;
+            });
+            accept();
+        });
+    }
+
+    // Answer requests until the peer closes the connection or sends something malformed
+    void serve(asio::ip::tcp::socket& socket) {
+        std::string message;
+        char prefix[8];
+        for (;;) {
+            asio::error_code ec;
+            asio::read(socket, asio::buffer(prefix), ec);
+            if (ec) return;  // Closed, also between requests
+            const uint64_t length = message_length(prefix);
+            if (length > max_request) {
+                refuse(socket, length);
+                return;
+            }
+            uint64_t id;
+            Response response;
+            try {
+                message.resize(static_cast<size_t>(length));
+                asio::read(socket, asio::buffer(&message[0], message.size()), ec);
+                if (ec) return;
+
+                size_t pos = 0;
+                id = decode_prefix(message, pos);
+                Request request;
+                request.op = static_cast<Op>(framing::get_uint(message, pos, 2));
+                request.scheme = get_field(message, pos);
+                request.compression = get_field(message, pos);
+                request.handle = get_field(message, pos);
+                request.payload = std::string_view(message).substr(pos);
+                try {
+                    response = handler(request);
+                } catch (const std::exception& e) {
+                    response.status = 500;
+                    response.payload = e.what();
+                }
+            } catch (const std::exception& e) {
+                HE_LOG(Warning) << "Malformed RPC request, closing the connection: " << e.what();
+                return;
+            }
+            std::string head = encode_head(id, response);
+            const std::array<asio::const_buffer, 2> buffers{ asio::buffer(head), asio::buffer(response.payload) };
+            asio::write(socket, buffers, ec);
+            if (ec) return;
+        }
+    }
+
+    // Answer an over-long request 413 from its magic and id only; the rest is never read
+    void refuse(asio::ip::tcp::socket& socket, uint64_t length) {
+        HE_LOG(Warning) << "RPC request of " << length << " bytes exceeds the limit of " << max_request
+                        << ", closing the connection";
+        std::string message(12, '\0');
+        asio::error_code ec;
+        if (length < message.size()) return;
+        asio::read(socket, asio::buffer(&message[0], message.size()), ec);
+        if (ec) return;
+        size_t pos = 0;
+        uint64_t id;
+        try {
+            id = decode_prefix(message, pos);
+        } catch (const std::exception&) {
+            return;
+        }
+        Response response;
+        response.status = 413;
+        response.payload = "RPC request of " + std::to_string(length) + " bytes exceeds the limit of " +
+                           std::to_string(max_request);
+        std::string head = encode_head(id, response);
+        const std::array<asio::const_buffer, 2> buffers{ asio::buffer(head), asio::buffer(response.payload) };
+        asio::write(socket, buffers, ec);
+        socket.shutdown(asio::ip::tcp::socket::shutdown_send, ec);
+    }
+};
+
+Server::Server(uint16_t port, Handler handler, uint64_t max_request_bytes)
+    : impl(std::make_unique<Impl>(port, std::move(handler), max_request_bytes)) {}
+
+Server::~Server() = default;
+
+// ---------------------------------------------------------------------------
+// Client
+// ---------------------------------------------------------------------------
+
+struct Client::Connection {
+    asio::ip::tcp::iostream stream;
+    uint64_t next_id = 1;
+};
+
+Client::Client(std::chrono::milliseconds timeout) : timeout(timeout) {}
+
+Client::~Client() = default;
+
+std::unique_ptr<Client::Connection> Client::take(const std::string& address, bool& reused) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = idle.find(address);
+        if (it != idle.end() && !it->second.empty()) {
+            std::unique_ptr<Connection> connection = std::move(it->second.back());
+            it->second.pop_back();
+            reused = true;
+            return connection;
+        }
+    }
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == address.size()) {
+        throw std::invalid_argument("Peer address must be host:port, not " + address);
+    }
+    auto connection = std::make_unique<Connection>();
+    connection->stream.expires_after(timeout);
+    connection->stream.connect(address.substr(0, colon), address.substr(colon + 1));
+    if (!connection->stream) {
+        throw std::runtime_error("Could not connect to " + address + ": " + connection->stream.error().message());
+    }
+    connection->stream.socket().set_option(asio::ip::tcp::no_delay(true));
+    reused = false;
+    return connection;
+}
+
+void Client::give_back(const std::string& address, std::unique_ptr<Connection> connection) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle[address].push_back(std::move(connection));
+}
+
+std::vector<Response> Client::call(const std::string& address, const std::vector<const Request*>& requests,
+                                   std::vector<double>* elapsed_ms) {
+    // A pooled connection may have been closed by the node meanwhile; that shows as
+    // a failure before the first response, and only then is a new connection tried
+    for (int attempt = 0;; attempt++) {
+        bool reused;
+        std::unique_ptr<Connection> connection = take(address, reused);
+        auto& stream = connection->stream;
+        stream.expires_after(timeout);
+
+        auto start = std::chrono::steady_clock::now();
+        const uint64_t first_id = connection->next_id;
+        std::string buffer;
+        for (const Request* request : requests) {
+            buffer = encode_head(connection->next_id++, *request);
+            stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            stream.write(request->payload.data(), static_cast<std::streamsize>(request->payload.size()));
+        }
+        stream.flush();
+
+        std::vector<Response> responses;
+        if (elapsed_ms) elapsed_ms->clear();
+        char prefix[8];
+        while (responses.size() < requests.size()) {
+            if (!stream.read(prefix, sizeof(prefix))) break;
+            const uint64_t length = message_length(prefix);
+            if (length > max_response) throw std::runtime_error("RPC response from " + address + " too long");
+            buffer.resize(static_cast<size_t>(length));
+            if (!stream.read(&buffer[0], static_cast<std::streamsize>(buffer.size()))) break;
+
+            size_t pos = 0;
+            if (decode_prefix(buffer, pos) != first_id + responses.size()) {
+                throw std::runtime_error("Out-of-order RPC response from " + address);
+            }
+            Response response;
+            response.status = static_cast<uint16_t>(framing::get_uint(buffer, pos, 2));
+            response.payload = buffer.substr(pos);
+            responses.push_back(std::move(response));
+            if (elapsed_ms) {
+                elapsed_ms->push_back(
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+        }
+        if (responses.size() == requests.size()) {
+            give_back(address, std::move(connection));
+            return responses;
+        }
+        if (reused && responses.empty() && attempt == 0) continue;
+        throw std::runtime_error("RPC connection to " + address + " broke after " +
+                                 std::to_string(responses.size()) + " of " + std::to_string(requests.size()) +
+                                 " responses: " + stream.error().message());
+    }
+}
+
+Response Client::call(const std::string& address, const Request& request) {
+    return call(address, std::vector<const Request*>{ &request }).front();
+}
+
+}
@@ -0,0 +1,122 @@
+#ifndef NODE_RPC_H
+#define NODE_RPC_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Binary request/response protocol between backend nodes (see Cluster)
+ *
+ * Runs over persistent TCP connections, separate from the HTTP API. Each
+ * message is length-prefixed (all integers little-endian):
+ *   request:  uint64 length, uint32 magic, uint64 id, uint16 op,
+ *             3 x { uint16 length, bytes } (scheme, compression, handle), payload
+ *   response: uint64 length, uint32 magic, uint64 id, uint16 status, payload
+ * where length counts everything after itself. Payloads are raw
+ * Ciphertext::save / GaloisKeys::save bytes, or several ciphertexts in the
+ * framing of BinaryFraming.h, compressed as the request asks (SEAL's zlib or
+ * zstd), so nothing is Base64- or JSON-encoded on the way.
+ *
+ * A client may send several requests before reading any response
+ * (pipelining); the server answers each connection's requests in order.
+ */
+namespace node_rpc {
+
+    enum class Op : uint16_t {
+        store = 1,         // payload: framed ciphertexts -> payload: handle in the worker's column store
+        store_sum = 2,     // handle -> payload: sum ciphertext
+        store_delete = 3,  // handle -> empty payload (404 if unknown)
+        csv_sum = 4,       // payload: framed ciphertexts -> payload: sum ciphertext
+        galois_keys = 5,   // payload: GaloisKeys::save bytes -> empty payload
+        column_sum = 6,    // handle: column file name, payload: uint64 first row, uint64 end row -> sum ciphertext
+    };
+
+    const char* op_name(Op op);
+
+    struct Request {
+        Op op = Op::store;
+        std::string scheme;
+        std::string compression;  // Of the result; "" for the worker's default
+        std::string handle;
+        // Not owned: the caller's bytes, which must outlive the call; in a Server handler, part of
+        // the received message
+        std::string_view payload;
+    };
+
+    // status follows HTTP (200, 400, 404, 500, ...); for errors, payload is the message
+    struct Response {
+        uint16_t status = 0;
+        std::string payload;
+    };
+
+    using Handler = std::function<Response(const Request&)>;
+
+    /**
+     * Listener answering requests with a handler, one thread per connection
+     * A handler exception becomes a 500 response with its message. A request
+     * longer than max_request_bytes is answered 413 from its length prefix,
+     * before anything is allocated for it, and its connection closed
+     */
+    class Server {
+    public:
+        /**
+         * @param port TCP port to listen on (all interfaces)
+         * @param max_request_bytes Longest request accepted, header included
+         * @throws std::runtime_error if the port cannot be bound
+         */
+        Server(uint16_t port, Handler handler, uint64_t max_request_bytes);
+        ~Server();
+
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+    };
+
+    /**
+     * Connections to other nodes, kept open between calls. Thread-safe;
+     * concurrent calls to the same node use separate connections.
+     */
+    class Client {
+    public:
+        // @param timeout Deadline of every call, from sending the first request to reading the last response
+        explicit Client(std::chrono::milliseconds timeout);
+        ~Client();
+
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        /**
+         * Send the requests back to back on one connection, then read their responses
+         *
+         * @param address "host:port" of the node's RPC listener
+         * @param elapsed_ms If given, set to the time each response arrived after the first request was sent
+         * @return Responses in request order
+         * @throws std::runtime_error if the node cannot be reached or the connection breaks
+         */
+        std::vector<Response> call(const std::string& address, const std::vector<const Request*>& requests,
+                                   std::vector<double>* elapsed_ms = nullptr);
+        Response call(const std::string& address, const Request& request);
+
+    private:
+        struct Connection;
+
+        const std::chrono::milliseconds timeout;
+        std::mutex mutex;
+        std::map<std::string, std::vector<std::unique_ptr<Connection>>> idle;
+
+        std::unique_ptr<Connection> take(const std::string& address, bool& reused);
+        void give_back(const std::string& address, std::unique_ptr<Connection> connection);
+    };
+}
+
+#endif // NODE_RPC_H
@@ -0,0 +1,80 @@
+#include "NormalEquations.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+NormalEquations::NormalEquations(size_t features) : features(features) {
+    if (features == 0) throw std::invalid_argument("Expected at least one feature");
+    using Term = HomomorphicEncryption::CrossTerm;
+    for (size_t i = 0; i < features; i++) {
+        for (size_t j = i; j < features; j++) terms_.push_back(Term{i, j});
+    }
+    for (size_t i = 0; i < features; i++) terms_.push_back(Term{i, features});
+    for (size_t i = 0; i < features; i++) terms_.push_back(Term{i, Term::none});
+    terms_.push_back(Term{features, Term::none});
+    terms_.push_back(Term{features, features});
+}
+
+// Row-major upper triangle: row i starts after the i longer rows above it
+size_t NormalEquations::xtx_slot(size_t i, size_t j) const {
+    if (i > j) std::swap(i, j);
+    return i * features - i * (i - 1) / 2 + (j - i);
+}
+
+/**
+ * Solves [n, sum(x)^T; sum(x), X^T X + ridge I] (b, w) = (sum(y), X^T y) by
+ * Gaussian elimination with partial pivoting, and scores the fit from
+ * sum(y^2): SSE = y^T y - 2 theta^T c + theta^T A theta over the same rows.
+ */
+NormalEquations::Fit NormalEquations::solve(const std::vector<double>& slots, size_t rows, double ridge) const {
+    if (slots.size() < terms_.size()) {
+        throw std::invalid_argument("Expected " + std::to_string(terms_.size()) + " aggregate slots");
+    }
+    if (rows < 2) throw std::invalid_argument("Expected at least two rows");
+    const size_t n = features + 1;  // Intercept first
+    std::vector<std::vector<double>> a(n, std::vector<double>(n + 1, 0.0));
+    a[0][0] = static_cast<double>(rows);
+    a[0][n] = slots[sum_y_slot()];
+    for (size_t i = 0; i < features; i++) {
+        a[0][i + 1] = a[i + 1][0] = slots[sum_x_slot(i)];
+        a[i + 1][n] = slots[xty_slot(i)];
+        for (size_t j = 0; j < features; j++) a[i + 1][j + 1] = slots[xtx_slot(i, j)];
+    }
+    const std::vector<std::vector<double>> system = a;  // Unpenalized, for the SSE
+    for (size_t i = 1; i < n; i++) a[i][i] += ridge;
+
+    for (size_t col = 0; col < n; col++) {
+        size_t pivot = col;
+        for (size_t r = col + 1; r < n; r++) {
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col])) pivot = r;
+        }
+        double magnitude = 0;
+        for (size_t r = 0; r < n; r++) magnitude = std::max(magnitude, std::abs(system[r][col]));
+        if (std::abs(a[pivot][col]) <= 1e-12 * magnitude) {
+            throw std::invalid_argument("Normal equations are singular (constant or collinear features; try a ridge)");
+        }
+        std::swap(a[col], a[pivot]);
+        for (size_t r = 0; r < n; r++) {
+            if (r == col) continue;
+            const double factor = a[r][col] / a[col][col];
+            for (size_t c = col; c <= n; c++) a[r][c] -= factor * a[col][c];
+        }
+    }
+    std::vector<double> theta(n);
+    for (size_t i = 0; i < n; i++) theta[i] = a[i][n] / a[i][i];
+
+    double sse = slots[sum_y2_slot()];
+    for (size_t i = 0; i < n; i++) {
+        sse -= 2 * theta[i] * system[i][n];
+        for (size_t j = 0; j < n; j++) sse += theta[i] * system[i][j] * theta[j];
+    }
+    const double mean_y = slots[sum_y_slot()] / static_cast<double>(rows);
+    const double sst = slots[sum_y2_slot()] - static_cast<double>(rows) * mean_y * mean_y;
+
+    Fit fit;
+    fit.intercept = theta[0];
+    fit.weights.assign(theta.begin() + 1, theta.end());
+    fit.r_squared = sst > 0 ? 1.0 - sse / sst : 0.0;
+    return fit;
+}
@@ -0,0 +1,57 @@
+#ifndef NORMAL_EQUATIONS_H
+#define NORMAL_EQUATIONS_H
+
+#include "HomomorphicEncryption.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * Encrypted aggregates of a least-squares fit y ~ intercept + w . x, and the
+ * solve once they are decrypted
+ *
+ * One pass over d packed feature columns and a packed target column
+ * (HomomorphicEncryption::cross_sums of terms()) gives the normal equations'
+ * ingredients in one ciphertext: X^T X (its d (d + 1) / 2 distinct entries),
+ * X^T y, the feature sums, sum(y) and sum(y^2). That costs one multiplicative
+ * depth plus the mask, and the key holder solves the (d + 1) x (d + 1)
+ * system with the intercept in plaintext (solve()) instead of iterating
+ * encrypted gradient steps.
+ */
+class NormalEquations {
+public:
+    struct Fit {
+        std::vector<double> weights;  // One per feature
+        double intercept = 0.0;
+        double r_squared = 0.0;       // Of the fit on the aggregated rows
+    };
+
+    // @throws std::invalid_argument for no features
+    explicit NormalEquations(size_t features);
+
+    size_t feature_count() const { return features; }
+    // Columns 0 .. d - 1 are the features and column d the target
+    const std::vector<HomomorphicEncryption::CrossTerm>& terms() const { return terms_; }
+
+    // Slots of the aggregates in a cross_sums result
+    size_t xtx_slot(size_t i, size_t j) const;
+    size_t xty_slot(size_t i) const { return xtx_terms() + i; }
+    size_t sum_x_slot(size_t i) const { return xtx_terms() + features + i; }
+    size_t sum_y_slot() const { return xtx_terms() + 2 * features; }
+    size_t sum_y2_slot() const { return sum_y_slot() + 1; }
+
+    /**
+     * Least-squares fit from decrypted aggregates (at least terms().size() slots)
+     * @param rows Rows aggregated
+     * @param ridge L2 penalty added to X^T X's diagonal (not the intercept's)
+     * @throws std::invalid_argument for too few slots or rows, or a singular system
+     */
+    Fit solve(const std::vector<double>& slots, size_t rows, double ridge = 0.0) const;
+
+private:
+    size_t features;
+    std::vector<HomomorphicEncryption::CrossTerm> terms_;
+
+    size_t xtx_terms() const { return features * (features + 1) / 2; }
+};
+
+#endif // NORMAL_EQUATIONS_H
@@ -0,0 +1,103 @@
+/**
+ * NumaTopology.cpp
+ *
+ * NUMA node discovery from sysfs, tenant-to-node assignment and thread binding.
+ */
+
+#include "NumaTopology.h"
+#include "ServerConfig.h"
+#include <algorithm>      // For std::find, std::max
+#include <cstdint>        // For uint64_t
+#include <fstream>        // For reading sysfs
+#include <stdexcept>      // For std::invalid_argument
+#include <thread>         // For std::thread::hardware_concurrency
+
+#if defined(__linux__)
+    #include <pthread.h>
+#endif
+
+namespace {
+    std::vector<int> all_cpus() {
+        std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t i = 0; i < cpus.size(); i++) cpus[i] = static_cast<int>(i);
+        return cpus;
+    }
+}
+
+NumaTopology NumaTopology::detect(const std::vector<int>& allowed_cpus) {
+    const std::vector<int> allowed = allowed_cpus.empty() ? all_cpus() : allowed_cpus;
+    NumaTopology topology;
+#if defined(__linux__)
+    // Node numbers may have gaps (e.g. after hot-unplug), so scan a generous range
+    for (int id = 0; id < 1024; id++) {
+        std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        if (!cpulist) continue;
+        std::string list;
+        std::getline(cpulist, list);
+        Node node{id, {}};
+        try {
+            for (int cpu : ServerConfig::parse_cpu_list(list)) {
+                if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) node.cpus.push_back(cpu);
+            }
+        } catch (const std::invalid_argument&) {
+            continue;
+        }
+        if (!node.cpus.empty()) topology.nodes.push_back(std::move(node));
+    }
+#endif
+    if (topology.nodes.empty()) return single(allowed);
+    topology.index_cpus();
+    return topology;
+}
+
+NumaTopology NumaTopology::single(const std::vector<int>& cpus) {
+    NumaTopology topology;
+    topology.nodes.push_back(Node{0, cpus});
+    topology.index_cpus();
+    return topology;
+}
+
+void NumaTopology::index_cpus() {
+    for (size_t index = 0; index < nodes.size(); index++) {
+        for (int cpu : nodes[index].cpus) {
+            if (static_cast<size_t>(cpu) >= cpu_nodes.size()) cpu_nodes.resize(cpu + 1, 0);
+            cpu_nodes[cpu] = index;
+        }
+    }
+}
+
+// FNV-1a, not std::hash: the assignment must not change between builds
+size_t NumaTopology::tenant_node(const std::string& tenant) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : tenant) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash % nodes.size());
+}
+
+size_t NumaTopology::current_node() const {
+#if defined(__linux__)
+    int cpu = sched_getcpu();
+    if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_nodes.size()) return cpu_nodes[cpu];
+#endif
+    return 0;
+}
+
+NumaTopology::Binding::Binding(const Node& node) {
+#if defined(__linux__)
+    if (node.cpus.empty()) return;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) != 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : node.cpus) CPU_SET(cpu, &set);
+    bound = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)node;
+#endif
+}
+
+NumaTopology::Binding::~Binding() {
+#if defined(__linux__)
+    if (bound) pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+#endif
+}
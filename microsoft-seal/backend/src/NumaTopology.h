@@ -0,0 +1,74 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+    #include <sched.h>
+#endif
+
+/**
+ * The host's NUMA nodes and their CPUs, for placing compute workers and key
+ * replicas per socket (--numa)
+ *
+ * Nodes come from /sys/devices/system/node; elsewhere, or when that is not
+ * readable, the host is one node with every CPU. Nodes are indexed densely
+ * from 0 in the order the kernel numbers them, and nodes without any of the
+ * allowed CPUs (e.g. memory-only nodes) are left out.
+ */
+class NumaTopology {
+public:
+    struct Node {
+        int id;                 // Kernel node number
+        std::vector<int> cpus;
+    };
+
+    /**
+     * @param allowed_cpus CPUs to place work on (e.g. --compute-cpus); empty: all of them
+     */
+    static NumaTopology detect(const std::vector<int>& allowed_cpus = {});
+
+    // A single node with the given CPUs, for when --numa is off
+    static NumaTopology single(const std::vector<int>& cpus);
+
+    size_t size() const { return nodes.size(); }
+    const Node& node(size_t index) const { return nodes[index]; }
+
+    /**
+     * Node that owns a tenant's keys: a stable hash of the ID, so every
+     * process with the same topology routes a tenant alike
+     */
+    size_t tenant_node(const std::string& tenant) const;
+
+    // Node the calling thread is running on (0 if unknown)
+    size_t current_node() const;
+
+    /**
+     * Keeps the calling thread on one node's CPUs for its lifetime, then
+     * restores the thread's previous affinity. A no-op outside Linux and for
+     * an empty CPU list.
+     */
+    class Binding {
+    public:
+        explicit Binding(const Node& node);
+        ~Binding();
+
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+
+    private:
+        bool bound = false;
+#if defined(__linux__)
+        cpu_set_t previous;
+#endif
+    };
+
+private:
+    std::vector<Node> nodes;
+    std::vector<size_t> cpu_nodes;  // Node index by CPU number
+
+    void index_cpus();
+};
+
+#endif // NUMA_TOPOLOGY_H
@@ -0,0 +1,166 @@
+/**
+ * ObjectStore.cpp
+ *
+ * Directory and plain-HTTP object stores for the cold tier of the column
+ * store. Both replace the destination of a transfer only once it is
+ * complete, so a reader never sees half an object.
+ */
+
+#include "ObjectStore.h"
+#include "HttpClient.h"  // For the HTTP endpoint
+#include <atomic>        // For unique partial file names
+#include <filesystem>    // For copies, renames and directories
+#include <fstream>       // For reading and writing whole files
+#include <iterator>      // For std::istreambuf_iterator
+#include <stdexcept>     // For exception handling
+
+namespace {
+    const std::chrono::minutes transfer_timeout(10);
+
+    // Unique per process and call, so concurrent downloads of one key do not collide
+    std::string partial_path(const std::string& path) {
+        static std::atomic<unsigned long> sequence{0};
+        return path + ".part" + std::to_string(sequence.fetch_add(1));
+    }
+
+    void replace(const std::string& from, const std::string& to) {
+        std::error_code error;
+        std::filesystem::rename(from, to, error);
+        if (error) {
+            std::filesystem::remove(from, error);
+            throw std::runtime_error("Could not move " + from + " to " + to);
+        }
+    }
+
+    // A directory, e.g. network storage or a mounted bucket
+    class DirectoryObjectStore : public ObjectStore {
+    public:
+        explicit DirectoryObjectStore(std::string directory) : directory(std::move(directory)) {
+            std::error_code error;
+            std::filesystem::create_directories(this->directory, error);
+            if (error) throw std::runtime_error("Could not create " + this->directory + ": " + error.message());
+        }
+
+        void put(const std::string& key, const std::string& path) override {
+            std::string partial = partial_path(object_path(key));
+            std::error_code error;
+            std::filesystem::copy_file(path, partial, std::filesystem::copy_options::overwrite_existing, error);
+            if (error) {
+                std::filesystem::remove(partial, error);
+                throw std::runtime_error("Could not upload " + path + " to " + directory + ": " + error.message());
+            }
+            replace(partial, object_path(key));
+        }
+
+        void get(const std::string& key, const std::string& path) override {
+            if (!std::filesystem::exists(object_path(key))) throw std::out_of_range("No object " + key);
+            std::string partial = partial_path(path);
+            std::error_code error;
+            std::filesystem::copy_file(object_path(key), partial, std::filesystem::copy_options::overwrite_existing,
+                                       error);
+            if (error) {
+                std::filesystem::remove(partial, error);
+                throw std::runtime_error("Could not download " + key + " from " + directory + ": " +
+                                         error.message());
+            }
+            replace(partial, path);
+        }
+
+        bool remove(const std::string& key) override {
+            std::error_code error;
+            return std::filesystem::remove(object_path(key), error);
+        }
+
+        std::string location() const override { return directory; }
+
+    private:
+        std::string directory;
+
+        std::string object_path(const std::string& key) const { return directory + "/" + key; }
+    };
+
+    /**
+     * http://host:port/prefix: PUT, GET and DELETE of prefix/key, one
+     * connection each (see HttpClient.h). Requests are not signed, so the
+     * endpoint is a gateway in front of the bucket, or one open to this
+     * network; objects travel as whole bodies, which suits column files of
+     * up to a few hundred MB
+     */
+    class HttpObjectStore : public ObjectStore {
+    public:
+        HttpObjectStore(std::string address, std::string prefix)
+            : address(std::move(address)), prefix(std::move(prefix)) {}
+
+        void put(const std::string& key, const std::string& path) override {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) throw std::runtime_error("Could not open " + path);
+            std::string body((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            auto response = http_client::request(address, "PUT", target(key), body, "application/octet-stream",
+                                                 transfer_timeout);
+            if (response.status / 100 != 2) {
+                throw std::runtime_error("Upload of " + key + " to " + location() + " failed with HTTP " +
+                                         std::to_string(response.status));
+            }
+        }
+
+        void get(const std::string& key, const std::string& path) override {
+            auto response = http_client::request(address, "GET", target(key), "", "application/octet-stream",
+                                                 transfer_timeout);
+            if (response.status == 404) throw std::out_of_range("No object " + key);
+            if (response.status / 100 != 2) {
+                throw std::runtime_error("Download of " + key + " from " + location() + " failed with HTTP " +
+                                         std::to_string(response.status));
+            }
+            std::string partial = partial_path(path);
+            {
+                std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+                out.write(response.body.data(), static_cast<std::streamsize>(response.body.size()));
+                if (!out.flush()) {
+                    out.close();
+                    std::filesystem::remove(partial);
+                    throw std::runtime_error("Could not write " + partial);
+                }
+            }
+            replace(partial, path);
+        }
+
+        bool remove(const std::string& key) override {
+            try {
+                auto response = http_client::request(address, "DELETE", target(key), "", "application/octet-stream",
+                                                     transfer_timeout);
+                return response.status / 100 == 2;
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+
+        std::string location() const override { return "http://" + address + prefix; }
+
+    private:
+        std::string address;  // host:port
+        std::string prefix;   // "" or "/path", without a trailing slash
+
+        std::string target(const std::string& key) const { return prefix + "/" + key; }
+    };
+}
+
+std::unique_ptr<ObjectStore> ObjectStore::open(const std::string& location) {
+    const std::string scheme = "http://";
+    if (location.compare(0, scheme.size(), scheme) != 0) {
+        if (location.find("://") != std::string::npos) {
+            throw std::invalid_argument("Object store must be a directory or an http:// URL, not " + location);
+        }
+        return std::make_unique<DirectoryObjectStore>(location);
+    }
+
+    std::string rest = location.substr(scheme.size());
+    size_t slash = rest.find('/');
+    std::string address = rest.substr(0, slash);
+    std::string prefix = slash == std::string::npos ? "" : rest.substr(slash);
+    while (!prefix.empty() && prefix.back() == '/') prefix.pop_back();
+    if (address.empty() || address.front() == ':') {
+        throw std::invalid_argument("Object store URL has no host: " + location);
+    }
+    if (address.find(':') == std::string::npos) address += ":80";
+    return std::make_unique<HttpObjectStore>(address, prefix);
+}
@@ -0,0 +1,50 @@
+#ifndef OBJECT_STORE_H
+#define OBJECT_STORE_H
+
+#include <memory>
+#include <string>
+
+/**
+ * Flat key/value store of whole files: the cold tier of the column store
+ * (see CiphertextStore)
+ *
+ * Objects are written and read whole, from and to local files, so a column
+ * file moves between tiers as it is, without being parsed. Implementations
+ * are thread-safe; every call blocks until the transfer is done, so callers
+ * run them off request threads.
+ */
+class ObjectStore {
+public:
+    virtual ~ObjectStore() = default;
+
+    /**
+     * Upload a local file, replacing any object of that key
+     * @throws std::runtime_error on failure
+     */
+    virtual void put(const std::string& key, const std::string& path) = 0;
+
+    /**
+     * Download an object to a local file, replaced only once the whole
+     * object has arrived
+     * @throws std::out_of_range if there is no such object
+     * @throws std::runtime_error on other failures
+     */
+    virtual void get(const std::string& key, const std::string& path) = 0;
+
+    // Delete an object; false if there was none or it could not be deleted
+    virtual bool remove(const std::string& key) = 0;
+
+    // Where objects go, for logs
+    virtual std::string location() const = 0;
+
+    /**
+     * @param location A directory (e.g. a mounted bucket), created if missing,
+     *                 or "http://host:port/prefix", an endpoint taking
+     *                 PUT/GET/DELETE of prefix/key (e.g. an S3-compatible
+     *                 gateway or a bucket that needs no request signing)
+     * @throws std::invalid_argument for a malformed URL
+     */
+    static std::unique_ptr<ObjectStore> open(const std::string& location);
+};
+
+#endif // OBJECT_STORE_H
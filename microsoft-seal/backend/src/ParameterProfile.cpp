@@ -0,0 +1,289 @@
+/**
+ * ParameterProfile.cpp
+ *
+ * Built-in parameter profiles, and parameters selected from a computation's
+ * requirements. Coefficient moduli stay within CoeffModulus::MaxBitCount for
+ * their degree and security level.
+ */
+
+#include "ParameterProfile.h"
+#include "seal/seal.h"
+#include <algorithm>      // For std::max_element, std::min
+#include <cmath>          // For std::ceil, std::log2
+#include <cstdio>         // For std::snprintf, std::sscanf
+#include <map>            // For the select() results
+#include <mutex>          // For guarding the select() results
+#include <numeric>        // For std::accumulate
+#include <stdexcept>      // For exception handling
+
+namespace {
+    constexpr int max_prime_bits = 60;
+
+    // CKKS: bits of scale kept below the requested precision for encoding and rescaling noise
+    constexpr int ckks_noise_bits = 10;
+
+    // BFV noise budget, measured with SEAL: a fresh ciphertext has about
+    // log q - log t - 8 bits, and each multiplication plus relinearization
+    // costs about log t + log N. The reserve covers additions (a sum of 2^k
+    // ciphertexts costs k bits) and rotations
+    constexpr int bfv_fresh_noise_bits = 8;
+    constexpr int bfv_reserve_bits = 20;
+
+    std::mutex selected_mutex;
+    std::map<std::string, ParameterProfile> selected;  // select() results by name
+
+    std::string auto_name(const ParameterRequirements& requirements) {
+        char name[96];
+        if (requirements.use_ckks) {
+            std::snprintf(name, sizeof(name), "auto-ckks-d%zu-p%d-i%d-s%d", requirements.depth,
+                          requirements.precision_bits, requirements.integer_bits,
+                          profiles::security_bits(requirements.security));
+        } else {
+            std::snprintf(name, sizeof(name), "auto-bfv-d%zu-p%d-s%d", requirements.depth,
+                          requirements.precision_bits, profiles::security_bits(requirements.security));
+        }
+        if (requirements.dnum) {
+            return name + ("-k" + std::to_string(requirements.dnum));
+        }
+        return name;
+    }
+
+    // Inverse of auto_name; false if the name is not one it produces
+    bool parse_auto_name(std::string name, ParameterRequirements& requirements) {
+        size_t depth, dnum;
+        int precision, integer, security;
+        char tail;
+        size_t digits = name.rfind("-k");
+        if (digits != std::string::npos && std::sscanf(name.c_str() + digits, "-k%zu%c", &dnum, &tail) == 1) {
+            requirements.dnum = dnum;
+            name.resize(digits);
+        }
+        if (std::sscanf(name.c_str(), "auto-ckks-d%zu-p%d-i%d-s%d%c", &depth, &precision, &integer, &security,
+                        &tail) == 4) {
+            requirements.use_ckks = true;
+            requirements.integer_bits = integer;
+        } else if (std::sscanf(name.c_str(), "auto-bfv-d%zu-p%d-s%d%c", &depth, &precision, &security, &tail) == 3) {
+            requirements.use_ckks = false;
+        } else {
+            return false;
+        }
+        requirements.depth = depth;
+        requirements.precision_bits = precision;
+        requirements.security = profiles::parse_security(security);
+        return true;
+    }
+
+    /**
+     * Data prime sizes for the requirements at degree n
+     * CKKS: one prime holding integer and fractional bits, then one per rescale
+     * BFV: the noise budget the depth needs, split into equal primes of at most 60 bits
+     */
+    std::vector<int> data_prime_bits(const ParameterRequirements& requirements, size_t n, int scale_bits) {
+        if (requirements.use_ckks) {
+            std::vector<int> bits(1, scale_bits + requirements.integer_bits);
+            bits.insert(bits.end(), requirements.depth, scale_bits);
+            return bits;
+        }
+        int log_n = static_cast<int>(std::log2(static_cast<double>(n)));
+        int needed = requirements.precision_bits + bfv_fresh_noise_bits + bfv_reserve_bits +
+                     static_cast<int>(requirements.depth) * (requirements.precision_bits + log_n);
+        int count = (needed + max_prime_bits - 1) / max_prime_bits;
+        return std::vector<int>(static_cast<size_t>(count), (needed + count - 1) / count);
+    }
+
+    // True if SEAL has enough primes of these sizes for degree n and accepts the parameters
+    bool valid(const ParameterProfile& profile, bool use_ckks) {
+        try {
+            seal::EncryptionParameters parms(use_ckks ? seal::scheme_type::ckks : seal::scheme_type::bfv);
+            parms.set_poly_modulus_degree(profile.poly_modulus_degree);
+            parms.set_coeff_modulus(seal::CoeffModulus::Create(profile.poly_modulus_degree, profile.coeff_modulus_bits));
+            parms.set_special_modulus_size(profile.special_primes);
+            if (!use_ckks) {
+                parms.set_plain_modulus(
+                    seal::PlainModulus::Batching(profile.poly_modulus_degree, profile.plain_modulus_bits));
+            }
+            return seal::SEALContext(parms, false, profile.security).parameters_set();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+}
+
+namespace profiles {
+    const std::vector<ParameterProfile>& all() {
+        static const std::vector<ParameterProfile> builtin = {
+            // Additions and slot sums only: one 54-bit data prime at N = 4096 (109 bits max).
+            // CKKS values must stay below 2^23 in magnitude at scale 2^30
+            {"sum-fast", 4096, {54, 55}, 20, 30, 0},
+            // Pre-profile parameters, kept so existing key stores and clients keep working
+            {"default", 8192, {50, 30, 30, 50}, 20, 40, 1},
+            // Two rescales by 40-bit primes at N = 8192 (218 bits max)
+            {"mult-depth-2", 8192, {60, 40, 40, 60}, 20, 40, 2},
+            // Deeper polynomial evaluation, e.g. approximated activations, at N = 16384 (438 bits max);
+            // rotation keys 1 .. 7 for matrix-vector products up to 64 x 64
+            {"ml-inference", 16384, {60, 40, 40, 40, 40, 40, 40, 60}, 20, 40, 6, seal::sec_level_type::tc128, 8},
+            // ml-inference's chain with two special primes (420 bits): key switching in 4 digits of two
+            // data primes instead of 7 of one, so relinearization and rotations are cheaper and
+            // Galois keys smaller
+            {"ml-inference-dnum4", 16384, {60, 40, 40, 40, 40, 40, 40, 60, 60}, 20, 40, 6, seal::sec_level_type::tc128,
+             8, 0, 2},
+        };
+        return builtin;
+    }
+
+    const ParameterProfile& default_profile() {
+        return get("default");
+    }
+
+    const ParameterProfile& get(const std::string& name) {
+        for (const auto& profile : all()) {
+            if (profile.name == name) return profile;
+        }
+        ParameterRequirements requirements;
+        if (parse_auto_name(name, requirements) && auto_name(requirements) == name) {
+            return select(requirements);
+        }
+        size_t crt = name.rfind("-crt");
+        size_t moduli, index;
+        char tail;
+        if (crt != std::string::npos &&
+            std::sscanf(name.c_str() + crt, "-crt%zu-%zu%c", &moduli, &index, &tail) == 2) {
+            const ParameterProfile& residue = crt_residue(get(name.substr(0, crt)), moduli, index);
+            if (residue.name == name) return residue;
+        }
+        throw std::out_of_range("Unknown parameter profile: " + name);
+    }
+
+    const ParameterProfile& for_depth(size_t depth) {
+        for (const auto& profile : all()) {
+            if (profile.depth >= depth) return profile;
+        }
+        throw std::out_of_range("No parameter profile supports depth " + std::to_string(depth));
+    }
+
+    /**
+     * Try degrees from 1024 up; the first one whose chain fits MaxBitCount and
+     * that SEAL accepts wins. Results are kept, so each requirement is solved once
+     */
+    const ParameterProfile& select(const ParameterRequirements& requirements) {
+        std::string name = auto_name(requirements);
+        std::lock_guard<std::mutex> lock(selected_mutex);
+        auto found = selected.find(name);
+        if (found != selected.end()) return found->second;
+
+        int scale_bits = requirements.use_ckks ? requirements.precision_bits + ckks_noise_bits : 0;
+        if (requirements.precision_bits <= 0 || requirements.integer_bits < 0 ||
+            (requirements.use_ckks && scale_bits + requirements.integer_bits > max_prime_bits) ||
+            (!requirements.use_ckks && requirements.precision_bits > max_prime_bits)) {
+            throw std::invalid_argument("Precision requirements exceed " + std::to_string(max_prime_bits) +
+                                        "-bit primes: " + name);
+        }
+
+        for (size_t n = 1024; n <= 32768; n *= 2) {
+            ParameterProfile profile;
+            profile.name = name;
+            profile.poly_modulus_degree = n;
+            profile.coeff_modulus_bits = data_prime_bits(requirements, n, scale_bits);
+            // Special primes for key switching, each at least as large as any data prime, so their
+            // product covers a digit of as many data primes
+            size_t limbs = profile.coeff_modulus_bits.size();
+            profile.special_primes = requirements.dnum ? (limbs + requirements.dnum - 1) / requirements.dnum : 1;
+            profile.coeff_modulus_bits.insert(
+                profile.coeff_modulus_bits.end(), profile.special_primes,
+                *std::max_element(profile.coeff_modulus_bits.begin(), profile.coeff_modulus_bits.end()));
+            profile.plain_modulus_bits = requirements.use_ckks ? 0 : requirements.precision_bits;
+            profile.scale_bits = scale_bits;
+            profile.depth = requirements.depth;
+            profile.security = requirements.security;
+
+            int total = std::accumulate(profile.coeff_modulus_bits.begin(), profile.coeff_modulus_bits.end(), 0);
+            if (total > seal::CoeffModulus::MaxBitCount(n, requirements.security)) continue;
+            if (!valid(profile, requirements.use_ckks)) continue;
+            return selected.emplace(name, std::move(profile)).first->second;
+        }
+        throw std::invalid_argument("No parameters up to N = 32768 meet the requirements: " + name);
+    }
+
+    /**
+     * PlainModulus::Batching returns distinct primes for a list of sizes; index picks
+     * one of them. Results are kept like select()'s
+     */
+    const ParameterProfile& crt_residue(const ParameterProfile& base, size_t moduli, size_t index) {
+        if (moduli < 2 || index >= moduli) {
+            throw std::invalid_argument("Expected at least two CRT moduli and an index below their count");
+        }
+        std::string name = base.name + "-crt" + std::to_string(moduli) + "-" + std::to_string(index);
+        std::lock_guard<std::mutex> lock(selected_mutex);
+        auto found = selected.find(name);
+        if (found != selected.end()) return found->second;
+
+        std::vector<seal::Modulus> primes = seal::PlainModulus::Batching(
+            base.poly_modulus_degree, std::vector<int>(moduli, base.plain_modulus_bits));
+        uint64_t product = 1;
+        for (const auto& prime : primes) {
+            if (product > ((uint64_t(1) << 63) - 1) / prime.value()) {
+                throw std::invalid_argument("CRT moduli exceed 63 bits together: " + name);
+            }
+            product *= prime.value();
+        }
+        ParameterProfile profile = base;
+        profile.name = name;
+        profile.plain_modulus = primes[index].value();
+        return selected.emplace(name, std::move(profile)).first->second;
+    }
+
+    ParameterReport report(const ParameterProfile& profile, bool use_ckks) {
+        return report(profile, use_ckks ? seal::scheme_type::ckks : seal::scheme_type::bfv);
+    }
+
+    ParameterReport report(const ParameterProfile& profile, seal::scheme_type scheme) {
+        auto costs = [scheme](const ParameterProfile& p, double& add, double& multiply, double& key_switch) {
+            double n = static_cast<double>(p.poly_modulus_degree);
+            double special = static_cast<double>(p.special_primes);
+            double limbs = static_cast<double>(p.coeff_modulus_bits.size() - p.special_primes);
+            if (scheme == seal::scheme_type::bgv) limbs = std::min(limbs, static_cast<double>(p.depth + 1));
+            double ntt = n * std::log2(n);
+            add = n * limbs;
+            multiply = scheme == seal::scheme_type::bfv ? ntt * limbs : n * limbs;
+            key_switch = ntt * std::ceil(limbs / special) * (limbs + special);
+        };
+        double base_add, base_multiply, base_key_switch;
+        costs(default_profile(), base_add, base_multiply, base_key_switch);
+
+        ParameterReport result;
+        result.profile = profile;
+        result.coeff_modulus_bit_count =
+            std::accumulate(profile.coeff_modulus_bits.begin(), profile.coeff_modulus_bits.end(), 0);
+        result.max_bit_count = seal::CoeffModulus::MaxBitCount(profile.poly_modulus_degree, profile.security);
+        size_t data_primes = profile.coeff_modulus_bits.size() - profile.special_primes;
+        size_t limbs = data_primes;
+        if (scheme == seal::scheme_type::bgv) limbs = std::min(limbs, profile.depth + 1);
+        result.ciphertext_bytes = 2 * profile.poly_modulus_degree * limbs * 8;
+        // Keys live at the top of the chain, each digit a ciphertext over every prime
+        result.key_switch_digits = (data_primes + profile.special_primes - 1) / profile.special_primes;
+        result.key_switch_key_bytes =
+            result.key_switch_digits * 2 * profile.poly_modulus_degree * profile.coeff_modulus_bits.size() * 8;
+        costs(profile, result.add_cost, result.multiply_cost, result.key_switch_cost);
+        result.add_cost /= base_add;
+        result.multiply_cost /= base_multiply;
+        result.key_switch_cost /= base_key_switch;
+        return result;
+    }
+
+    seal::sec_level_type parse_security(int bits) {
+        switch (bits) {
+            case 128: return seal::sec_level_type::tc128;
+            case 192: return seal::sec_level_type::tc192;
+            case 256: return seal::sec_level_type::tc256;
+            default: throw std::invalid_argument("Unsupported security level: " + std::to_string(bits));
+        }
+    }
+
+    int security_bits(seal::sec_level_type security) {
+        switch (security) {
+            case seal::sec_level_type::tc192: return 192;
+            case seal::sec_level_type::tc256: return 256;
+            default: return 128;
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef PARAMETER_PROFILE_H
+#define PARAMETER_PROFILE_H
+
+#include "seal/encryptionparams.h"
+#include "seal/modulus.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A named set of encryption parameters, shared by BFV and CKKS
+ *
+ * coeff_modulus_bits lists the data primes followed by the special_primes used
+ * for key switching; depth is the number of sequential multiplications the
+ * chain is sized for. With more than one special prime, key switching splits
+ * the data primes into groups of special_primes (dnum = L / special_primes
+ * digits) instead of one digit per prime: smaller keys and fewer NTTs per
+ * relinearization or rotation, for a larger modulus the security level pays
+ * for. Each profile gets its own SEALContext and key set (keys are stored by
+ * parms_id, so profiles never share key files).
+ */
+struct ParameterProfile {
+    std::string name;
+    size_t poly_modulus_degree = 0;
+    std::vector<int> coeff_modulus_bits;
+    int plain_modulus_bits = 0;  // BFV batching prime
+    int scale_bits = 0;          // CKKS encoding scale, sized to the rescaled-away primes
+    size_t depth = 0;
+    seal::sec_level_type security = seal::sec_level_type::tc128;
+    size_t baby_steps = 0;       // Galois keys for every rotation below this too (hoisted matrix-vector baby steps)
+    std::uint64_t plain_modulus = 0;  // BFV and BGV: this prime instead of one of plain_modulus_bits (crt_residue)
+    size_t special_primes = 1;   // Trailing primes of coeff_modulus_bits kept for key switching
+};
+
+/**
+ * What a computation needs, for profiles::select()
+ *
+ * precision_bits is the CKKS precision after the binary point, or the BFV
+ * plaintext modulus size (values are exact modulo a prime of that size).
+ */
+struct ParameterRequirements {
+    bool use_ckks = true;
+    size_t depth = 0;
+    int precision_bits = 20;
+    int integer_bits = 20;  // CKKS only: magnitude of values before the binary point
+    seal::sec_level_type security = seal::sec_level_type::tc128;
+    size_t dnum = 0;        // Key switching digits (groups of data primes); 0 for one per data prime
+};
+
+/**
+ * Predicted cost of a profile, relative to the default profile for the same scheme
+ *
+ * The model counts RNS limbs L (data primes) and the degree N: additions scale
+ * with N * L, multiplications with N * L (CKKS, BGV) or N log N * L (BFV,
+ * which tensors in NTT form over an extended base), key switches
+ * (relinearization, rotation) with N log N * dnum * (L + K) for K special
+ * primes and dnum = ceil(L / K) digits, N log N * L * (L + 1) with one special
+ * prime. BGV ciphertexts are encrypted depth levels above the last, so they
+ * have min(depth + 1, L) limbs where the others have L.
+ */
+struct ParameterReport {
+    ParameterProfile profile;
+    int coeff_modulus_bit_count = 0;
+    int max_bit_count = 0;  // CoeffModulus::MaxBitCount for the degree and security level
+    size_t ciphertext_bytes = 0;  // Uncompressed size of a fresh ciphertext
+    size_t key_switch_digits = 0;  // dnum: key switching key components per relinearization or rotation key
+    size_t key_switch_key_bytes = 0;  // Uncompressed size of one such key: the relinearization key, each Galois key
+    double add_cost = 0;
+    double multiply_cost = 0;
+    double key_switch_cost = 0;
+};
+
+namespace profiles {
+    // Built-in profiles, smallest (fastest) first
+    const std::vector<ParameterProfile>& all();
+
+    // The profile the backends used before profiles existed: N = 8192, {50, 30, 30, 50}
+    const ParameterProfile& default_profile();
+
+    /**
+     * Built-in profiles by name, and the "auto-..." names select() produces
+     * @throws std::out_of_range for unknown names
+     */
+    const ParameterProfile& get(const std::string& name);
+
+    /**
+     * Smallest built-in profile whose chain supports the given multiplicative depth
+     * @throws std::out_of_range if no profile is deep enough
+     */
+    const ParameterProfile& for_depth(size_t depth);
+
+    /**
+     * Smallest poly_modulus_degree and prime chain meeting the requirements within
+     * CoeffModulus::MaxBitCount. The profile's name encodes the requirements, e.g.
+     * "auto-ckks-d3-p20-i20-s128" ("-k<dnum>" appended when dnum is set), so get()
+     * resolves it again in later requests. dnum adds ceil(L / dnum) special primes
+     * @throws std::invalid_argument if no degree up to 32768 fits or the primes would exceed 60 bits
+     */
+    const ParameterProfile& select(const ParameterRequirements& requirements);
+
+    /**
+     * Profile index of moduli copies of base that differ only in their BFV / BGV plain
+     * modulus: distinct batching primes of base.plain_modulus_bits, which SEAL picks the
+     * same way every time. A value kept modulo each of them is exact modulo their product
+     * (see CrtResidues), so sums of up to 63 bits run at base's degree. Named
+     * "<base>-crt<moduli>-<index>", which get() resolves again
+     * @throws std::invalid_argument if moduli is below 2 or index not below it, the primes'
+     *         product would not stay below 2^63, or the degree has too few such primes
+     */
+    const ParameterProfile& crt_residue(const ParameterProfile& base, size_t moduli, size_t index);
+
+    ParameterReport report(const ParameterProfile& profile, bool use_ckks);
+    ParameterReport report(const ParameterProfile& profile, seal::scheme_type scheme);
+
+    // API names of SEAL security levels (128, 192, 256)
+    seal::sec_level_type parse_security(int bits);
+    int security_bits(seal::sec_level_type security);
+}
+
+#endif // PARAMETER_PROFILE_H
@@ -0,0 +1,88 @@
+#include "PatientPacking.h"
+#include <algorithm>
+#include <stdexcept>
+
+PatientLayout parse_patient_layout(const std::string& name) {
+    if (name == "sample_major") return PatientLayout::sample_major;
+    if (name == "feature_major") return PatientLayout::feature_major;
+    throw std::invalid_argument("Unknown layout: " + name + " (sample_major, feature_major)");
+}
+
+const char* patient_layout_name(PatientLayout layout) {
+    return layout == PatientLayout::sample_major ? "sample_major" : "feature_major";
+}
+
+PatientPacking::PatientPacking(PatientLayout layout, size_t features, size_t slots)
+    : layout_(layout), features(features), slots(slots) {
+    if (features == 0 || features > slots) {
+        throw std::invalid_argument("Expected between 1 and " + std::to_string(slots) + " features");
+    }
+    while (block < features) block <<= 1;
+}
+
+size_t PatientPacking::slot(size_t patient, size_t feature) const {
+    return layout_ == PatientLayout::sample_major ? patient * block + feature
+                                                  : feature * patients_per_ciphertext() + patient;
+}
+
+size_t PatientPacking::score_slot(size_t patient) const {
+    return slot(patient, 0);
+}
+
+size_t PatientPacking::sum_stride() const {
+    return layout_ == PatientLayout::sample_major ? 1 : patients_per_ciphertext();
+}
+
+std::vector<double> PatientPacking::pack(const std::vector<std::vector<double>>& patients) const {
+    const size_t per_ciphertext = patients_per_ciphertext();
+    const size_t ciphertexts = (patients.size() + per_ciphertext - 1) / per_ciphertext;
+    std::vector<double> values(ciphertexts * slots, 0.0);
+    size_t used = 0;
+    for (size_t i = 0; i < patients.size(); i++) {
+        if (patients[i].size() != features) throw std::invalid_argument("Patients differ in feature count");
+        const size_t offset = (i / per_ciphertext) * slots;
+        for (size_t f = 0; f < features; f++) {
+            const size_t index = offset + slot(i % per_ciphertext, f);
+            values[index] = patients[i][f];
+            used = std::max(used, index + 1);
+        }
+    }
+    values.resize(used);
+    return values;
+}
+
+std::vector<double> PatientPacking::replicate(const std::vector<double>& weights) const {
+    std::vector<double> replicated(slots, 0.0);
+    for (size_t p = 0; p < patients_per_ciphertext(); p++) {
+        for (size_t f = 0; f < weights.size() && f < block; f++) replicated[slot(p, f)] = weights[f];
+    }
+    return replicated;
+}
+
+std::vector<double> PatientPacking::scores(const std::vector<double>& values, size_t count) const {
+    const size_t per_ciphertext = patients_per_ciphertext();
+    std::vector<double> result;
+    for (size_t i = 0; i < count; i++) {
+        const size_t index = (i / per_ciphertext) * slots + score_slot(i % per_ciphertext);
+        if (index >= values.size()) break;
+        result.push_back(values[index]);
+    }
+    return result;
+}
+
+std::vector<double> PatientPacking::totals(const std::vector<double>& values) const {
+    std::vector<double> result(features, 0.0);
+    for (size_t f = 0; f < features; f++) {
+        if (total_slot(f) < values.size()) result[f] = values[total_slot(f)];
+    }
+    return result;
+}
+
+std::vector<size_t> PatientPacking::sources(PatientLayout from) const {
+    const PatientPacking other(from, features, slots);
+    std::vector<size_t> result(slots, no_source);
+    for (size_t p = 0; p < patients_per_ciphertext(); p++) {
+        for (size_t f = 0; f < features; f++) result[slot(p, f)] = other.slot(p, f);
+    }
+    return result;
+}
@@ -0,0 +1,89 @@
+#ifndef PATIENT_PACKING_H
+#define PATIENT_PACKING_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Slot layouts for many patients (samples) per ciphertext, and the matching
+ * plaintext weight replication
+ *
+ * Each ciphertext holds patients_per_ciphertext() = slots / block patients,
+ * block the feature count rounded up to a power of two:
+ *
+ *   sample_major:  feature f of patient p in slot p * block + f; the block
+ *                  sum (rotations 1, 2, ..., block / 2) leaves patient p's
+ *                  score in slot p * block
+ *   feature_major: feature f of patient p in slot f * P + p (P patients per
+ *                  ciphertext); the sum over the feature runs (rotations
+ *                  P, 2 P, ..., block / 2 * P) leaves it in slot p
+ *
+ * Both cost log2(block) rotations per ciphertext. Feature-major scores come
+ * back contiguous, and each run is a slice of one CSV column.
+ *
+ * The same layouts pack several CSV columns (features) of each row (patient)
+ * into one upload, whose column totals HomomorphicEncryption::feature_sums
+ * reduces in one pass: feature f's total lands in total_slot(f).
+ */
+enum class PatientLayout { sample_major, feature_major };
+
+/**
+ * API names "sample_major" and "feature_major"
+ * @throws std::invalid_argument for other names
+ */
+PatientLayout parse_patient_layout(const std::string& name);
+const char* patient_layout_name(PatientLayout layout);
+
+class PatientPacking {
+public:
+    /**
+     * @param features Features per patient
+     * @param slots Slots per ciphertext (a power of two)
+     * @throws std::invalid_argument for no features or more than slots
+     */
+    PatientPacking(PatientLayout layout, size_t features, size_t slots);
+
+    PatientLayout layout() const { return layout_; }
+    size_t feature_count() const { return features; }
+    size_t block_size() const { return block; }
+    size_t patients_per_ciphertext() const { return slots / block; }
+
+    // Slot of a feature of the p-th patient of a ciphertext
+    size_t slot(size_t patient, size_t feature) const;
+    // Slot holding the p-th patient's score after the layout's sum
+    size_t score_slot(size_t patient) const;
+    // Rotation stride of the sum: 1 (sample-major) or patients_per_ciphertext()
+    size_t sum_stride() const;
+    // Slot holding a feature's total over all patients after feature_sums: f (sample-major)
+    // or f * patients_per_ciphertext()
+    size_t total_slot(size_t feature) const { return slot(0, feature); }
+
+    /**
+     * Slot values of the ciphertexts holding these patients, one slots-long
+     * chunk per ciphertext (the last one trimmed), for encrypt_vector
+     * @throws std::invalid_argument for a patient with another feature count
+     */
+    std::vector<double> pack(const std::vector<std::vector<double>>& patients) const;
+
+    // One slots-long vector with weight f at every slot of feature f
+    std::vector<double> replicate(const std::vector<double>& weights) const;
+
+    // The first count patients' scores from decrypted ciphertexts (decrypt_vector output)
+    std::vector<double> scores(const std::vector<double>& values, size_t count) const;
+    // Every feature's total from a decrypted feature_sums result
+    std::vector<double> totals(const std::vector<double>& values) const;
+
+    // For every slot of this packing, the slot of the same patient and feature under layout
+    // from, or no_source for a padding slot (see SlotPermutation)
+    static constexpr size_t no_source = static_cast<size_t>(-1);
+    std::vector<size_t> sources(PatientLayout from) const;
+
+private:
+    PatientLayout layout_;
+    size_t features;
+    size_t slots;
+    size_t block = 1;
+};
+
+#endif // PATIENT_PACKING_H
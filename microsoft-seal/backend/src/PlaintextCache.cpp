@@ -0,0 +1,171 @@
+#include "PlaintextCache.h"
+#include "Metrics.h"
+#include <cstring>
+#include <iterator>
+
+namespace {
+    metrics::Counter& lookups(const char* result) {
+        return metrics::counter("he_plaintext_cache_total", "Encoded plaintext cache lookups by result",
+                                {{"result", result}});
+    }
+
+    // FNV-1a over 64-bit words
+    uint64_t mix(uint64_t hash, uint64_t word) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (word >> (8 * i)) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    uint64_t bits(double value) {
+        uint64_t word;
+        std::memcpy(&word, &value, sizeof(word));
+        return word;
+    }
+}
+
+PlaintextCache::PlaintextCache(size_t capacity_bytes) : capacity_bytes(capacity_bytes) {}
+
+uint64_t PlaintextCache::hash_key(const std::vector<double>& values, bool broadcast, double scale,
+                                  const seal::parms_id_type& parms_id) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint64_t word : parms_id) hash = mix(hash, word);
+    hash = mix(hash, bits(scale));
+    hash = mix(hash, broadcast ? 1 : 0);
+    for (double value : values) hash = mix(hash, bits(value));
+    return hash;
+}
+
+std::list<PlaintextCache::Entry>::iterator PlaintextCache::find(uint64_t hash, const std::vector<double>& values,
+                                                                bool broadcast, double scale,
+                                                                const seal::parms_id_type& parms_id) {
+    auto range = index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Entry& entry = *it->second;
+        if (entry.broadcast == broadcast && bits(entry.scale) == bits(scale) && entry.parms_id == parms_id &&
+            entry.values == values) {
+            return it->second;
+        }
+    }
+    return lru.end();
+}
+
+std::shared_ptr<const seal::Plaintext> PlaintextCache::get(const std::vector<double>& values, bool broadcast,
+                                                           double scale, const seal::parms_id_type& parms_id,
+                                                           const Encode& encode) {
+    static metrics::Counter& hits = lookups("hit");
+    static metrics::Counter& misses = lookups("miss");
+
+    const uint64_t hash = hash_key(values, broadcast, scale, parms_id);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = find(hash, values, broadcast, scale, parms_id);
+        if (found != lru.end()) {
+            lru.splice(lru.begin(), lru, found);
+            found->used = MemoryBudget::Clock::now();
+            hits.add();
+            return found->plain;
+        }
+    }
+    misses.add();
+
+    auto plain = std::make_shared<seal::Plaintext>(seal::MemoryManager::GetPool());
+    const auto start = MemoryBudget::Clock::now();
+    encode(*plain);
+    const auto end = MemoryBudget::Clock::now();
+    const double elapsed_us = std::chrono::duration<double, std::micro>(end - start).count();
+    const size_t bytes = plain->coeff_count() * sizeof(uint64_t);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bytes > capacity_bytes) return plain;
+    auto found = find(hash, values, broadcast, scale, parms_id);
+    if (found != lru.end()) return found->plain;
+    evict_to(capacity_bytes - bytes);
+    lru.push_front(Entry{hash, values, broadcast, scale, parms_id, plain, bytes, elapsed_us, end});
+    index.emplace(hash, lru.begin());
+    used_bytes += bytes;
+    encode_us += elapsed_us;
+    return plain;
+}
+
+void PlaintextCache::evict_to(size_t bytes) {
+    static metrics::Counter& evictions = lookups("eviction");
+    while (used_bytes > bytes && !lru.empty()) {
+        erase(std::prev(lru.end()));
+        evictions.add();
+    }
+}
+
+// Called with the mutex held
+void PlaintextCache::erase(std::list<Entry>::iterator entry) {
+    auto range = index.equal_range(entry->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == entry) {
+            index.erase(it);
+            break;
+        }
+    }
+    used_bytes -= entry->bytes;
+    encode_us -= entry->encode_us;
+    lru.erase(entry);
+}
+
+void PlaintextCache::set_capacity(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity_bytes = bytes;
+    evict_to(bytes);
+}
+
+size_t PlaintextCache::capacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacity_bytes;
+}
+
+size_t PlaintextCache::size_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used_bytes;
+}
+
+size_t PlaintextCache::entries() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+MemoryBudget::Usage PlaintextCache::budget_usage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return MemoryBudget::Usage{lru.size(), used_bytes, encode_us};
+}
+
+bool PlaintextCache::eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tenant || lru.empty()) return false;
+    const Entry& last = lru.back();
+    candidate = MemoryBudget::Candidate{last.used, last.bytes, last.encode_us};
+    return true;
+}
+
+bool PlaintextCache::evict(const std::string* tenant, MemoryBudget::Candidate& evicted) {
+    static metrics::Counter& evictions = lookups("eviction");
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tenant || lru.empty()) return false;
+    auto last = std::prev(lru.end());
+    evicted = MemoryBudget::Candidate{last->used, last->bytes, last->encode_us};
+    erase(last);
+    evictions.add();
+    return true;
+}
+
+MemoryBudget::Usage PlaintextCache::expire(MemoryBudget::Clock::time_point before) {
+    static metrics::Counter& expirations = lookups("expired");
+    std::lock_guard<std::mutex> lock(mutex);
+    MemoryBudget::Usage expired;
+    while (!lru.empty() && lru.back().used < before) {
+        expired.entries++;
+        expired.bytes += lru.back().bytes;
+        expired.rebuild_us += lru.back().encode_us;
+        erase(std::prev(lru.end()));
+        expirations.add();
+    }
+    return expired;
+}
@@ -0,0 +1,93 @@
+#ifndef PLAINTEXT_CACHE_H
+#define PLAINTEXT_CACHE_H
+
+#include "MemoryBudget.h"
+#include "seal/seal.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Least-recently-used cache of encoded plaintexts, bounded by their bytes
+ *
+ * Entries are keyed by the encoded values (a single constant broadcast to
+ * every slot, or a slot vector), the scale and the parms_id (level), and
+ * hold the plaintext exactly as the multiply_plain / add_plain that follows
+ * needs it: CKKS plaintexts come out of the encoder in NTT form, packed BFV
+ * weights are stored after transform_to_ntt. Lookups hash the values and
+ * compare them in full, so a hash collision never returns the wrong
+ * plaintext. Hits, misses and evictions are exported as
+ * he_plaintext_cache_total{result=...}.
+ *
+ * Under a MemoryBudget, entries expire and are evicted by their last use and
+ * the time their encoding took.
+ *
+ * Thread-safe. Encoding runs outside the lock; two threads missing on the
+ * same key both encode it and the first insert wins. Plaintexts are allocated
+ * from SEAL's global pool, never a per-request scratch arena, and are shared:
+ * an evicted entry stays valid for callers that still hold it.
+ */
+class PlaintextCache : public MemoryBudget::Consumer {
+public:
+    using Encode = std::function<void(seal::Plaintext&)>;
+
+    // capacity_bytes 0 disables caching: every get() encodes
+    explicit PlaintextCache(size_t capacity_bytes = 0);
+
+    /**
+     * The cached plaintext for the key, or encode() into a new one
+     *
+     * @param values Slot values, or the one constant when broadcast
+     * @param broadcast Whether values[0] fills every slot (encode(double))
+     * @param scale Scale encoded at (0 for BFV)
+     * @param parms_id Level encoded at
+     */
+    std::shared_ptr<const seal::Plaintext> get(const std::vector<double>& values, bool broadcast, double scale,
+                                               const seal::parms_id_type& parms_id, const Encode& encode);
+
+    // Shrinks (evicting the oldest entries) or grows the bound; 0 clears and disables
+    void set_capacity(size_t capacity_bytes);
+    size_t capacity() const;
+    size_t size_bytes() const;
+    size_t entries() const;
+
+    // MemoryBudget::Consumer; the cache is shared by all tenants
+    MemoryBudget::Usage budget_usage() const override;
+    bool eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const override;
+    bool evict(const std::string* tenant, MemoryBudget::Candidate& evicted) override;
+    MemoryBudget::Usage expire(MemoryBudget::Clock::time_point before) override;
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::vector<double> values;
+        bool broadcast;
+        double scale;
+        seal::parms_id_type parms_id;
+        std::shared_ptr<const seal::Plaintext> plain;
+        size_t bytes;
+        double encode_us;
+        MemoryBudget::Clock::time_point used;
+    };
+
+    mutable std::mutex mutex;
+    size_t capacity_bytes;
+    size_t used_bytes = 0;
+    double encode_us = 0;  // Of the entries
+    std::list<Entry> lru;  // Most recently used first
+    std::unordered_multimap<uint64_t, std::list<Entry>::iterator> index;
+
+    static uint64_t hash_key(const std::vector<double>& values, bool broadcast, double scale,
+                             const seal::parms_id_type& parms_id);
+    std::list<Entry>::iterator find(uint64_t hash, const std::vector<double>& values, bool broadcast, double scale,
+                                    const seal::parms_id_type& parms_id);
+    void evict_to(size_t bytes);
+    void erase(std::list<Entry>::iterator entry);
+};
+
+#endif // PLAINTEXT_CACHE_H
@@ -0,0 +1,233 @@
+#include "PolynomialEvaluator.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+    // Degree ignoring trailing zero coefficients; 0 for constants
+    size_t degree(const std::vector<double>& coefficients) {
+        size_t d = coefficients.size();
+        while (d > 1 && coefficients[d - 1] == 0) d--;
+        return d > 0 ? d - 1 : 0;
+    }
+
+    size_t ceil_log2(size_t n) {
+        size_t bits = 0;
+        while ((size_t(1) << bits) < n) bits++;
+        return bits;
+    }
+
+    // The largest power of two below i (i >= 2): x^i is computed as x^low * x^(i - low)
+    size_t lower_factor(size_t i) {
+        return size_t(1) << (ceil_log2(i) - 1);
+    }
+
+    // Largest giant step k * 2^j not above d
+    size_t giant_step(size_t k, size_t d) {
+        size_t g = k;
+        while (2 * g <= d) g <<= 1;
+        return g;
+    }
+
+    // Marks x^i and the powers its product chain needs
+    void mark_power(size_t i, std::vector<bool>& used) {
+        if (i < 2 || used[i]) return;
+        used[i] = true;
+        mark_power(lower_factor(i), used);
+        mark_power(i - lower_factor(i), used);
+    }
+}
+
+PolynomialEvaluator::PolynomialEvaluator(const HomomorphicEncryption& he, seal::Ciphertext x)
+    : he(he), powers(2), input_level(he.chain_index(x)), input_scale(x.scale()) {
+    powers[1] = std::move(x);
+}
+
+size_t PolynomialEvaluator::depth(const std::vector<double>& coefficients) const {
+    return plan(coefficients).depth;
+}
+
+seal::Ciphertext PolynomialEvaluator::evaluate(const std::vector<double>& coefficients) {
+    return evaluate(coefficients, input_scale);
+}
+
+seal::Ciphertext PolynomialEvaluator::evaluate(const std::vector<double>& coefficients, double scale) {
+    Plan chosen = plan(coefficients);
+    if (chosen.depth > input_level) {
+        throw std::invalid_argument("Degree-" + std::to_string(degree(coefficients)) + " polynomial needs " +
+                                    std::to_string(chosen.depth) + " levels, the ciphertext has " +
+                                    std::to_string(input_level) + " left");
+    }
+    baby = chosen.baby;
+    counters.depth = chosen.depth;
+    const size_t result_level = input_level - chosen.depth;
+
+    // Each power is computed at the highest level any of its uses needs, and no higher
+    required.assign(degree(coefficients) + 1, 0);
+    require_levels(coefficients, result_level);
+    for (size_t i = required.size(); i-- > 2;) {
+        if (required[i] == 0) continue;
+        const size_t low = lower_factor(i);
+        required[low] = std::max(required[low], required[i] + 1);
+        required[i - low] = std::max(required[i - low], required[i] + 1);
+    }
+    return piece(coefficients, result_level, scale);
+}
+
+/**
+ * Baby step for a polynomial: fewest levels first, then fewest ciphertext
+ * products (powers not yet cached plus quotient products)
+ */
+PolynomialEvaluator::Plan PolynomialEvaluator::plan(const std::vector<double>& coefficients) const {
+    const size_t d = degree(coefficients);
+    if (d == 0) throw std::invalid_argument("Cannot evaluate a constant polynomial");
+
+    Plan best;
+    size_t best_products = 0;
+    for (size_t k = 2; k / 2 <= d; k <<= 1) {
+        std::vector<bool> used(d + 1, false);
+        size_t products = 0;
+        const size_t depth = piece_depth(coefficients, k, used, products);
+        for (size_t i = 2; i <= d; i++) {
+            if (used[i] && (i >= powers.size() || powers[i].size() == 0)) products++;
+        }
+        if (k == 2 || depth < best.depth || (depth == best.depth && products < best_products)) {
+            best.baby = k;
+            best.depth = depth;
+            best_products = products;
+        }
+    }
+    return best;
+}
+
+/**
+ * Levels below x that piece() needs for p with baby step k; marks the powers
+ * it uses and counts its quotient products
+ */
+size_t PolynomialEvaluator::piece_depth(const std::vector<double>& p, size_t k, std::vector<bool>& used,
+                                        size_t& products) const {
+    const size_t d = degree(p);
+    size_t depth = 0;
+    if (d < k) {
+        for (size_t i = 1; i <= d; i++) {
+            if (p[i] == 0) continue;
+            mark_power(i, used);
+            depth = std::max(depth, ceil_log2(i) + 1);
+        }
+        return depth;
+    }
+
+    const size_t g = giant_step(k, d);
+    mark_power(g, used);
+    std::vector<double> q(p.begin() + g, p.begin() + d + 1);
+    std::vector<double> r(p.begin(), p.begin() + g);
+    depth = ceil_log2(g) + 1;
+    if (degree(q) > 0) {
+        products++;
+        depth = std::max(depth, piece_depth(q, k, used, products) + 1);
+    }
+    return std::max(depth, piece_depth(r, k, used, products));
+}
+
+/**
+ * Records in required the level each power must have for piece(p, chain_index)
+ * (mirrors piece)
+ */
+void PolynomialEvaluator::require_levels(const std::vector<double>& p, size_t chain_index) {
+    const size_t d = degree(p);
+    if (d < baby) {
+        for (size_t i = 1; i <= d; i++) {
+            if (p[i] != 0) required[i] = std::max(required[i], chain_index + 1);
+        }
+        return;
+    }
+
+    const size_t g = giant_step(baby, d);
+    std::vector<double> q(p.begin() + g, p.begin() + d + 1);
+    std::vector<double> r(p.begin(), p.begin() + g);
+    required[g] = std::max(required[g], chain_index + 1);
+    if (degree(q) > 0) require_levels(q, chain_index + 1);
+    if (degree(r) > 0) require_levels(r, chain_index);
+}
+
+/**
+ * x^i at level required[i] or above, cached; computed from x^low * x^(i - low)
+ * (low the largest power of two below i) switched down to one level above it,
+ * so the key switch and rescale run on as few primes as possible. A cached
+ * power below the level now required is computed again
+ */
+const seal::Ciphertext& PolynomialEvaluator::power(size_t i) {
+    const size_t level = i < required.size() ? required[i] : 0;
+    if (i < powers.size() && powers[i].size() > 0 && (i == 1 || he.chain_index(powers[i]) >= level)) {
+        if (i > 1) counters.powers_reused++;
+        return powers[i];
+    }
+    const size_t low = lower_factor(i);
+    seal::Ciphertext a = power(low);
+    seal::Ciphertext b = power(i - low);
+    he.mod_switch_to_inplace(a, level + 1);
+    he.mod_switch_to_inplace(b, level + 1);
+    seal::Ciphertext product = he.multiply(a, low == i - low ? a : b);
+    he.relinearize_inplace(product);
+    he.rescale_inplace(product);
+    counters.power_products++;
+
+    if (powers.size() <= i) powers.resize(i + 1);
+    powers[i] = std::move(product);
+    return powers[i];
+}
+
+// p(x) at exactly the given level and scale; p is not constant
+seal::Ciphertext PolynomialEvaluator::piece(const std::vector<double>& p, size_t chain_index, double scale) {
+    const size_t d = degree(p);
+    seal::Ciphertext result;
+    if (d < baby) {
+        // Every term at chain_index + 1 and scale * prime, so the sum takes a single rescale
+        const double product_scale = scale * he.dropped_prime(chain_index + 1);
+        bool started = false;
+        for (size_t i = 1; i <= d; i++) {
+            if (p[i] == 0) continue;
+            seal::Ciphertext term = power(i);
+            he.mod_switch_to_inplace(term, chain_index + 1);
+            he.multiply_constant_inplace(term, p[i], product_scale / term.scale());
+            term.scale() = product_scale;
+            counters.constant_multiplications++;
+            if (started) {
+                he.add_inplace(result, term);
+            } else {
+                result = std::move(term);
+                started = true;
+            }
+        }
+        he.rescale_inplace(result);
+        result.scale() = scale;
+        if (p[0] != 0) he.add_constant_inplace(result, p[0]);
+        return result;
+    }
+
+    const size_t g = giant_step(baby, d);
+    std::vector<double> q(p.begin() + g, p.begin() + d + 1);
+    std::vector<double> r(p.begin(), p.begin() + g);
+    if (degree(q) == 0) {
+        result = power(g);
+        he.multiply_constant_to(result, q[0], chain_index, scale);
+        counters.constant_multiplications++;
+    } else {
+        // q * x^g rescales by the prime of level chain_index + 1 onto the target scale
+        seal::Ciphertext giant = power(g);
+        he.mod_switch_to_inplace(giant, chain_index + 1);
+        seal::Ciphertext quotient = piece(q, chain_index + 1, scale * he.dropped_prime(chain_index + 1) / giant.scale());
+        result = he.multiply(quotient, giant);
+        he.relinearize_inplace(result);
+        he.rescale_inplace(result);
+        result.scale() = scale;
+        counters.giant_products++;
+    }
+    if (degree(r) > 0) {
+        he.add_inplace(result, piece(r, chain_index, scale));
+    } else if (r[0] != 0) {
+        he.add_constant_inplace(result, r[0]);
+    }
+    return result;
+}
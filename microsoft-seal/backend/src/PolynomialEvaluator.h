@@ -0,0 +1,82 @@
+#ifndef POLYNOMIAL_EVALUATOR_H
+#define POLYNOMIAL_EVALUATOR_H
+
+#include "HomomorphicEncryption.h"
+#include <cstddef>
+#include <vector>
+
+// Ciphertext products and constant multiplications a PolynomialEvaluator has done
+struct PolynomialStats {
+    size_t power_products = 0;     // Products computing powers of x, each done once
+    size_t powers_reused = 0;      // Uses of a power that was already computed
+    size_t giant_products = 0;     // Quotient times giant-step power
+    size_t constant_multiplications = 0;
+    size_t depth = 0;              // Levels the last evaluation spent
+};
+
+/**
+ * Paterson-Stockmeyer evaluation of polynomials in one CKKS ciphertext x
+ *
+ * p is split as p = q * x^g + r at the largest giant step g = k * 2^j <= deg p,
+ * recursively, until the pieces have degree < k; those are sums of constant
+ * multiples c_i * x^i of the baby steps. The baby step k is the power of two
+ * that needs the fewest levels, then the fewest ciphertext products. A
+ * degree-d polynomial spends ceil(log2(d + 1)) or one more levels instead of
+ * Horner's d, and fewer products: 5, 10 and 19 for degrees 7, 15 and 31
+ * against 6, 14 and 30. Each baby-step sum is rescaled once.
+ *
+ * Powers of x are computed on first use as products of two lower powers and
+ * kept: further polynomials in the same x, e.g. several activations of one
+ * layer, reuse them. Each power is computed from factors switched down to
+ * the lowest level its uses allow, so key switches run on as few primes as
+ * possible; a cached power that sits too low for a later polynomial is
+ * computed again.
+ *
+ * Levels and scales are aligned without any fix-up: every piece is produced
+ * at an exact target level and scale, constants being encoded at the scale
+ * that makes the following rescale land on the target, and q at the scale
+ * that makes q * x^g do the same. Not thread-safe; use one instance per
+ * input ciphertext.
+ */
+class PolynomialEvaluator {
+public:
+    PolynomialEvaluator(const HomomorphicEncryption& he, seal::Ciphertext x);
+
+    /**
+     * @param coefficients Coefficients of x^0, x^1, ...
+     * @return Levels below x that evaluate() leaves the result at
+     * @throws std::invalid_argument for a constant polynomial
+     */
+    size_t depth(const std::vector<double>& coefficients) const;
+
+    /**
+     * p(x) at the given scale (default: x's), depth(coefficients) levels below x
+     * @throws std::invalid_argument for a constant polynomial or too few levels left
+     */
+    seal::Ciphertext evaluate(const std::vector<double>& coefficients);
+    seal::Ciphertext evaluate(const std::vector<double>& coefficients, double scale);
+
+    PolynomialStats stats() const { return counters; }
+
+private:
+    struct Plan {
+        size_t baby = 2;
+        size_t depth = 0;
+    };
+
+    const HomomorphicEncryption& he;
+    std::vector<seal::Ciphertext> powers;  // powers[i] = x^i once computed
+    std::vector<size_t> required;          // Lowest level x^i may have in the evaluation in progress
+    size_t input_level;
+    double input_scale;
+    size_t baby = 2;  // Baby step of the evaluation in progress
+    PolynomialStats counters;
+
+    Plan plan(const std::vector<double>& coefficients) const;
+    size_t piece_depth(const std::vector<double>& p, size_t k, std::vector<bool>& used, size_t& products) const;
+    void require_levels(const std::vector<double>& p, size_t chain_index);
+    const seal::Ciphertext& power(size_t exponent);
+    seal::Ciphertext piece(const std::vector<double>& p, size_t chain_index, double scale);
+};
+
+#endif // POLYNOMIAL_EVALUATOR_H
@@ -0,0 +1,68 @@
+/**
+ * PoolTrimmer.cpp
+ *
+ * Idle detection and trimming of SEAL's global memory pool.
+ */
+
+#include "PoolTrimmer.h"
+#include "Metrics.h"
+#include "seal/memorymanager.h"
+#include <algorithm>      // For std::min
+#include <atomic>         // For the time of the last request
+
+#if defined(__GLIBC__)
+    #include <malloc.h>   // For malloc_trim
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Clock ticks of the last finished request
+    std::atomic<Clock::rep> last_activity{Clock::now().time_since_epoch().count()};
+}
+
+PoolTrimmer::PoolTrimmer(std::chrono::milliseconds idle) : idle(idle) {
+    if (idle.count() > 0) worker = std::thread([this] { run(); });
+}
+
+PoolTrimmer::~PoolTrimmer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void PoolTrimmer::activity() {
+    last_activity.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+size_t PoolTrimmer::trim() {
+    static metrics::Counter& trims = metrics::counter("he_seal_pool_trims_total", "Trims of SEAL's global pool");
+    static metrics::Counter& freed =
+        metrics::counter("he_seal_pool_trimmed_bytes_total", "Bytes of pool blocks returned to the system");
+    size_t bytes = seal::MemoryManager::GetPool(seal::mm_force_global).trim();
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    trims.add();
+    freed.add(bytes);
+    return bytes;
+}
+
+// Checks a few times per idle period; an activity stamp already trimmed after is skipped
+void PoolTrimmer::run() {
+    const auto poll = std::min<std::chrono::milliseconds>(idle, std::chrono::seconds(1));
+    Clock::rep trimmed_after = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, poll, [this] { return stopping; })) {
+        Clock::rep last = last_activity.load(std::memory_order_relaxed);
+        if (last == trimmed_after) continue;
+        if (Clock::now() - Clock::time_point(Clock::duration(last)) < idle) continue;
+        lock.unlock();
+        trim();
+        lock.lock();
+        trimmed_after = last;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef POOL_TRIMMER_H
+#define POOL_TRIMMER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+/**
+ * Gives the memory of SEAL's global pool back to the system once the server
+ * has been idle for a while (--pool-trim-idle-s)
+ *
+ * SEAL's pools keep every block they ever allocated, so after one large burst
+ * the process holds the burst's peak for good. After `idle` without a finished
+ * request, the background thread frees the pool blocks no allocation uses
+ * (seal::MemoryPoolHandle::trim) and, with glibc, hands the freed heap back
+ * with malloc_trim. It trims once per idle period, not repeatedly. Keys,
+ * stored ciphertexts and everything else still alive are untouched; the pool
+ * simply grows again with the next burst. Compute threads' thread-local pools
+ * are not trimmed, since only their own thread may touch them.
+ */
+class PoolTrimmer {
+public:
+    /**
+     * @param idle Quiet time before trimming; zero disables the thread (trim() still works)
+     */
+    explicit PoolTrimmer(std::chrono::milliseconds idle);
+    ~PoolTrimmer();
+
+    PoolTrimmer(const PoolTrimmer&) = delete;
+    PoolTrimmer& operator=(const PoolTrimmer&) = delete;
+
+    // A request finished (called by ScratchArenaMiddleware)
+    static void activity();
+
+    /**
+     * Trim the global pool now
+     * @return Bytes of pool blocks freed
+     */
+    static size_t trim();
+
+private:
+    const std::chrono::milliseconds idle;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+};
+
+#endif // POOL_TRIMMER_H
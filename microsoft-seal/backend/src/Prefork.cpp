@@ -0,0 +1,150 @@
+/**
+ * Prefork.cpp
+ *
+ * Forking, pinning and supervising the worker processes of --prefork.
+ */
+
+#include "Prefork.h"
+#include <cerrno>         // For errno
+#include <chrono>         // For the startup window
+#include <cstdlib>        // For std::exit
+#include <cstring>        // For std::strerror
+#include <iostream>       // For the supervisor's messages
+#include <stdexcept>      // For std::invalid_argument, std::runtime_error
+#include <string>         // For std::to_string
+
+#if defined(__linux__)
+    #include <csignal>
+    #include <sched.h>
+    #include <sys/prctl.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // A worker that exits sooner after its start failed to start, and is not restarted
+    constexpr std::chrono::seconds startup_window{10};
+
+    std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    // In the forked worker: follow the supervisor, take its signals again and stay on its CPUs
+    void become_worker(pid_t supervisor, const sigset_t& signal_mask, const std::vector<int>& cpus) {
+        ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (::getppid() != supervisor) std::_Exit(0);  // The supervisor died before the prctl
+        ::sigprocmask(SIG_SETMASK, &signal_mask, nullptr);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) CPU_SET(cpu, &set);
+        ::sched_setaffinity(0, sizeof(set), &set);  // Threads started later inherit it
+    }
+
+    std::string describe(int status) {
+        if (WIFSIGNALED(status)) return "was killed by signal " + std::to_string(WTERMSIG(status));
+        return "exited with status " + std::to_string(WEXITSTATUS(status));
+    }
+
+    int exit_code(int status) {
+        return WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+    }
+}
+#endif
+
+namespace prefork {
+    Worker run(size_t processes, const std::vector<int>& cpus) {
+#if !defined(__linux__)
+        (void)processes;
+        (void)cpus;
+        throw std::invalid_argument("--prefork needs Linux");
+#else
+        const std::vector<int> all = cpus.empty() ? allowed_cpus() : cpus;
+        if (processes < 2 || processes > all.size()) {
+            throw std::invalid_argument("--prefork takes 2 to " + std::to_string(all.size()) +
+                                        " workers (one CPU each at least)");
+        }
+        auto worker = [&](size_t index) {
+            const size_t begin = index * all.size() / processes;
+            const size_t end = (index + 1) * all.size() / processes;
+            return Worker{index, processes, std::vector<int>(all.begin() + begin, all.begin() + end)};
+        };
+
+        // Blocked before the first fork, so no signal is lost before sigwait; workers unblock them
+        sigset_t signals, signal_mask;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGCHLD);
+        sigaddset(&signals, SIGTERM);
+        sigaddset(&signals, SIGINT);
+        ::sigprocmask(SIG_BLOCK, &signals, &signal_mask);
+
+        const pid_t supervisor = ::getpid();
+        std::vector<pid_t> pids(processes, 0);
+        std::vector<Clock::time_point> started(processes);
+        auto start = [&](size_t index) {  // True in the new worker
+            const pid_t pid = ::fork();
+            if (pid < 0) throw std::runtime_error(std::string("Could not fork a worker: ") + std::strerror(errno));
+            if (pid == 0) {
+                become_worker(supervisor, signal_mask, worker(index).cpus);
+                return true;
+            }
+            pids[index] = pid;
+            started[index] = Clock::now();
+            return false;
+        };
+        auto stop_all = [&] {
+            for (pid_t pid : pids) {
+                if (pid > 0) ::kill(pid, SIGTERM);
+            }
+        };
+
+        for (size_t index = 0; index < processes; index++) {
+            if (start(index)) return worker(index);
+        }
+
+        size_t running = processes;
+        bool stopping = false;
+        int status_code = 0;
+        while (running > 0) {
+            int signal = 0;
+            if (::sigwait(&signals, &signal) != 0) continue;
+            if (signal != SIGCHLD) {
+                if (!stopping) stop_all();
+                stopping = true;
+                continue;
+            }
+            int status = 0;
+            for (pid_t pid; (pid = ::waitpid(-1, &status, WNOHANG)) > 0;) {
+                size_t index = 0;
+                while (index < processes && pids[index] != pid) index++;
+                if (index == processes) continue;
+                pids[index] = 0;
+                running--;
+                if (stopping) continue;
+                if (Clock::now() - started[index] < startup_window) {
+                    std::cerr << "prefork: worker " << index << " " << describe(status)
+                              << " while starting; stopping the others\n";
+                    status_code = exit_code(status);
+                    stopping = true;
+                    stop_all();
+                    continue;
+                }
+                std::cerr << "prefork: worker " << index << " " << describe(status) << "; restarting it\n";
+                if (start(index)) return worker(index);
+                running++;
+            }
+        }
+        std::exit(status_code);
+#endif
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef PREFORK_H
+#define PREFORK_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Prefork mode (--prefork): one backend process per core group, all
+ * listening on the same port
+ *
+ * One process running every engine across all cores shares SEAL's memory
+ * pool, the allocator's arenas and the last-level caches between all of
+ * them, and one crash takes every request down with it. Here the process
+ * forks N workers before it starts any thread and only supervises them; each
+ * worker takes one group of CPUs (the allowed CPUs, or --compute-cpus, cut
+ * into N contiguous runs), pins itself to it and then starts up as usual:
+ * its own contexts, keys, pools and threads, sized for its group. Workers
+ * listen with SO_REUSEPORT, so the kernel spreads incoming connections over
+ * them. Keys come from the key store's read-only mappings of the same files,
+ * so their bytes are read from the page cache once for all workers, but
+ * each worker holds its own loaded copy.
+ *
+ * The supervisor restarts a worker that dies once it has served (run for at
+ * least 10 s); a worker that fails sooner is a startup error (a bad option,
+ * the port taken), so the supervisor stops the others and exits with its
+ * status. SIGTERM and SIGINT are passed on to the workers, which shut down
+ * as usual, and workers get SIGTERM should the supervisor die.
+ *
+ * Everything a request leaves behind stays in the worker that served it.
+ */
+namespace prefork {
+    struct Worker {
+        size_t index = 0;       // 0 .. count - 1
+        size_t count = 1;
+        std::vector<int> cpus;  // The worker's core group; empty without prefork
+    };
+
+    /**
+     * Fork and supervise the workers; returns only in them, as that worker.
+     * The supervisor exits the process when the workers are done. Call before
+     * the process starts any thread.
+     *
+     * @param processes Workers to run, at least 2
+     * @param cpus CPUs to split into groups; empty: those the process may run on
+     * @throws std::invalid_argument for fewer CPUs than workers, or off Linux
+     * @throws std::runtime_error if a worker cannot be forked
+     */
+    Worker run(size_t processes, const std::vector<int>& cpus);
+}
+
+#endif // PREFORK_H
@@ -0,0 +1,295 @@
+#include "PrivateSetIntersection.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    constexpr size_t no_item = std::numeric_limits<size_t>::max();
+
+    // Eviction steps before an item is left for the next table
+    constexpr size_t max_evictions = 500;
+
+    // Tables are filled to at most this fraction of their bins, where cuckoo insertion with
+    // three hash functions still rarely needs long eviction chains
+    constexpr double max_table_load = 0.85;
+
+    uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t power_mod(uint64_t base, size_t exponent, uint64_t modulus) {
+        uint64_t result = 1 % modulus;
+        base %= modulus;
+        for (; exponent; exponent >>= 1) {
+            if (exponent & 1) result = result * base % modulus;
+            base = base * base % modulus;
+        }
+        return result;
+    }
+
+    // Residue as BatchEncoder takes it, in (-t / 2, t / 2]
+    double centered(uint64_t value, uint64_t modulus) {
+        return value > modulus / 2 ? -static_cast<double>(modulus - value) : static_cast<double>(value);
+    }
+
+    void check_modulus(uint64_t plain_modulus, size_t slots) {
+        if (plain_modulus < 2 || plain_modulus >= (1ULL << 32)) {
+            throw std::invalid_argument("Set intersection needs a plain modulus below 2^32");
+        }
+        if (slots < PsiParameters::item_slots || slots % PsiParameters::item_slots) {
+            throw std::invalid_argument("Set intersection needs an even slot count");
+        }
+    }
+}
+
+void PsiParameters::validate() const {
+    if (bundles < 1 || bundles > 64) throw std::invalid_argument("bundles must be 1 .. 64");
+    if (partition_size < 1 || partition_size > 256) throw std::invalid_argument("partition_size must be 1 .. 256");
+    if (window_bits < 1 || window_bits > 4) throw std::invalid_argument("window_bits must be 1 .. 4");
+}
+
+std::vector<size_t> PsiParameters::source_powers() const {
+    std::vector<size_t> powers;
+    const size_t base = size_t(1) << window_bits;
+    for (size_t place = 1; place <= partition_size; place *= base) {
+        for (size_t k = 1; k < base && k * place <= partition_size; k++) powers.push_back(k * place);
+        if (place > partition_size / base) break;
+    }
+    std::sort(powers.begin(), powers.end());
+    return powers;
+}
+
+std::vector<PsiParameters::Power> PsiParameters::power_plan() const {
+    std::vector<Power> plan(partition_size + 1);
+    std::vector<bool> source(partition_size + 1, false);
+    for (size_t power : source_powers()) source[power] = true;
+    for (size_t power = 2; power <= partition_size; power++) {
+        if (source[power]) continue;
+        Power& best = plan[power];
+        best.depth = no_item;
+        for (size_t left = 1; left <= power / 2; left++) {
+            const size_t depth = std::max(plan[left].depth, plan[power - left].depth) + 1;
+            if (depth < best.depth) best = {left, power - left, depth};
+        }
+    }
+    return plan;
+}
+
+size_t PsiParameters::power_depth() const {
+    size_t depth = 0;
+    for (const auto& power : power_plan()) depth = std::max(depth, power.depth);
+    return depth;
+}
+
+const ParameterProfile& PsiParameters::profile() const {
+    ParameterRequirements requirements;
+    requirements.use_ckks = false;
+    requirements.depth = power_depth() + 1;
+    requirements.precision_bits = 20;
+    return profiles::select(requirements);
+}
+
+namespace psi {
+    uint64_t hash_id(const std::string& id) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : id) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        return mix(hash);
+    }
+
+    size_t bin(uint64_t hash, size_t function, size_t bins) {
+        return static_cast<size_t>(mix(hash + (function + 1) * 0x9e3779b97f4a7c15ULL) % bins);
+    }
+
+    uint64_t element(uint64_t hash, size_t k, uint64_t plain_modulus) {
+        return 1 + mix(hash + (PsiParameters::hash_count + 1 + k) * 0x9e3779b97f4a7c15ULL) % (plain_modulus - 1);
+    }
+}
+
+/**
+ * Cuckoo insertion table by table: an item evicted max_evictions times in a
+ * row, or one past the table's load limit, waits for the next table. The
+ * evictions draw from a fixed-seed generator, so the placement only depends
+ * on the IDs and their order
+ */
+PsiReceiver::PsiReceiver(const PsiParameters& parameters, size_t slots, uint64_t plain_modulus,
+                         const std::vector<std::string>& ids)
+    : parameters(parameters), slots(slots), plain_modulus(plain_modulus) {
+    parameters.validate();
+    check_modulus(plain_modulus, slots);
+    if (ids.empty()) throw std::invalid_argument("No IDs to look up");
+
+    std::unordered_map<uint64_t, size_t> distinct;  // Repeated IDs share one item
+    for (const auto& id : ids) {
+        const uint64_t hash = psi::hash_id(id);
+        auto inserted = distinct.emplace(hash, hashes.size());
+        if (inserted.second) hashes.push_back(hash);
+        items.push_back(inserted.first->second);
+    }
+    std::vector<size_t> pending(hashes.size());
+    std::iota(pending.begin(), pending.end(), size_t(0));
+
+    const size_t bins = parameters.bundles * slots / PsiParameters::item_slots;
+    const size_t limit = std::max<size_t>(1, static_cast<size_t>(bins * max_table_load));
+    std::mt19937_64 random(0x5eed);
+    while (!pending.empty()) {
+        std::vector<size_t> table(bins, no_item);
+        std::vector<size_t> next;
+        size_t placed = 0;
+        for (size_t item : pending) {
+            if (placed == limit) {
+                next.push_back(item);
+                continue;
+            }
+            size_t current = item;
+            for (size_t step = 0; current != no_item && step < max_evictions; step++) {
+                for (size_t function = 0; function < PsiParameters::hash_count; function++) {
+                    size_t& slot = table[psi::bin(hashes[current], function, bins)];
+                    if (slot == no_item) {
+                        slot = current;
+                        current = no_item;
+                        break;
+                    }
+                }
+                if (current != no_item) {
+                    std::swap(current, table[psi::bin(hashes[current], random() % PsiParameters::hash_count, bins)]);
+                }
+            }
+            if (current != no_item) next.push_back(current);
+            placed++;
+        }
+        tables.push_back(std::move(table));
+        pending.swap(next);
+    }
+}
+
+std::vector<std::vector<double>> PsiReceiver::query(size_t batch) const {
+    const std::vector<size_t>& table = tables.at(batch);
+    const std::vector<size_t> sources = parameters.source_powers();
+    const size_t bins_per_bundle = slots / PsiParameters::item_slots;
+    std::vector<std::vector<double>> values;
+    for (size_t bundle = 0; bundle < parameters.bundles; bundle++) {
+        std::vector<uint64_t> elements(slots, 0);  // Empty bins hold 0, a root of every partition
+        for (size_t local = 0; local < bins_per_bundle; local++) {
+            const size_t item = table[bundle * bins_per_bundle + local];
+            if (item == no_item) continue;
+            for (size_t k = 0; k < PsiParameters::item_slots; k++) {
+                elements[local * PsiParameters::item_slots + k] = psi::element(hashes[item], k, plain_modulus);
+            }
+        }
+        for (size_t power : sources) {
+            std::vector<double> slot_values(slots);
+            for (size_t i = 0; i < slots; i++) {
+                slot_values[i] = centered(power_mod(elements[i], power, plain_modulus), plain_modulus);
+            }
+            values.push_back(std::move(slot_values));
+        }
+    }
+    return values;
+}
+
+std::vector<bool> PsiReceiver::matches(const std::vector<std::vector<double>>& results) const {
+    if (results.size() != tables.size()) {
+        throw std::invalid_argument("Expected the results of " + std::to_string(tables.size()) + " batches");
+    }
+    const size_t bins_per_bundle = slots / PsiParameters::item_slots;
+    std::vector<bool> found(hashes.size(), false);
+    for (size_t batch = 0; batch < tables.size(); batch++) {
+        const std::vector<double>& values = results[batch];
+        const size_t per_partition = parameters.bundles * slots;
+        if (values.empty() || values.size() % per_partition) {
+            throw std::invalid_argument("Expected bundles * partitions result ciphertexts per batch");
+        }
+        const size_t partitions = values.size() / per_partition;
+        for (size_t bin = 0; bin < tables[batch].size(); bin++) {
+            const size_t item = tables[batch][bin];
+            if (item == no_item) continue;
+            const size_t bundle = bin / bins_per_bundle;
+            const size_t slot = bin % bins_per_bundle * PsiParameters::item_slots;
+            for (size_t partition = 0; partition < partitions && !found[item]; partition++) {
+                const double* result = values.data() + (bundle * partitions + partition) * slots + slot;
+                found[item] = std::all_of(result, result + PsiParameters::item_slots,
+                                          [](double value) { return value == 0.0; });
+            }
+        }
+    }
+    std::vector<bool> result(items.size());
+    for (size_t i = 0; i < items.size(); i++) result[i] = found[items[i]];
+    return result;
+}
+
+PsiServerSet::PsiServerSet(const PsiParameters& parameters, size_t slots, uint64_t plain_modulus,
+                           const std::vector<std::string>& ids)
+    : parameters_(parameters), slots(slots), plain_modulus_(plain_modulus) {
+    parameters.validate();
+    check_modulus(plain_modulus, slots);
+    if (ids.empty()) throw std::invalid_argument("No IDs in the set");
+
+    std::vector<uint64_t> hashes;
+    hashes.reserve(ids.size());
+    for (const auto& id : ids) hashes.push_back(psi::hash_id(id));
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    items = hashes.size();
+
+    // Every item in each of its bins (once if two hash functions agree)
+    const size_t bins_per_bundle = slots / PsiParameters::item_slots;
+    const size_t bins = parameters.bundles * bins_per_bundle;
+    std::vector<std::vector<uint64_t>> contents(bins);
+    for (uint64_t hash : hashes) {
+        size_t taken[PsiParameters::hash_count];
+        for (size_t function = 0; function < PsiParameters::hash_count; function++) {
+            taken[function] = psi::bin(hash, function, bins);
+            if (std::find(taken, taken + function, taken[function]) == taken + function) {
+                contents[taken[function]].push_back(hash);
+            }
+        }
+    }
+    for (const auto& content : contents) largest = std::max(largest, content.size());
+    const size_t degree = parameters.partition_size;
+    partitions = std::max<size_t>(1, (largest + degree - 1) / degree);
+
+    // (x - e_1) ... (x - e_m) x^(degree - m) per slot: padded with the root 0, which no item's
+    // element takes, every polynomial has the full degree and a nonzero leading coefficient
+    coefficients_.assign(parameters.bundles * partitions * (degree + 1) * slots, 0);
+    std::vector<uint64_t> polynomial;
+    for (size_t bin = 0; bin < bins; bin++) {
+        const size_t bundle = bin / bins_per_bundle;
+        for (size_t partition = 0; partition < partitions; partition++) {
+            const size_t begin = std::min(contents[bin].size(), partition * degree);
+            const size_t end = std::min(contents[bin].size(), begin + degree);
+            for (size_t k = 0; k < PsiParameters::item_slots; k++) {
+                polynomial.assign(1, 1);
+                for (size_t i = begin; i < end; i++) {
+                    const uint64_t root = psi::element(contents[bin][i], k, plain_modulus);
+                    polynomial.push_back(0);
+                    for (size_t power = polynomial.size() - 1; power > 0; power--) {
+                        polynomial[power] = (polynomial[power - 1] + (plain_modulus - root) * polynomial[power]) %
+                                            plain_modulus;
+                    }
+                    polynomial[0] = (plain_modulus - root) * polynomial[0] % plain_modulus;
+                }
+                const size_t slot = bin % bins_per_bundle * PsiParameters::item_slots + k;
+                const size_t padding = degree + 1 - polynomial.size();
+                for (size_t power = 0; power < polynomial.size(); power++) {
+                    coefficients_[((bundle * partitions + partition) * (degree + 1) + padding + power) * slots + slot] =
+                        static_cast<uint32_t>(polynomial[power]);
+                }
+            }
+        }
+    }
+}
+
+const uint32_t* PsiServerSet::coefficients(size_t bundle, size_t partition, size_t power) const {
+    return coefficients_.data() +
+           ((bundle * partitions + partition) * (parameters_.partition_size + 1) + power) * slots;
+}
@@ -0,0 +1,154 @@
+#ifndef PRIVATE_SET_INTERSECTION_H
+#define PRIVATE_SET_INTERSECTION_H
+
+#include "ParameterProfile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Unbalanced private set intersection over BFV batching (after Chen, Laine
+ * and Rindal, CCS 2017), e.g. linking patients of one hospital's list to
+ * another hospital's registry without either side decrypting the other's IDs
+ *
+ * IDs are hashed to 64 bits, and every item takes two slots holding two
+ * field elements (below the plain modulus t) derived from its hash, so the
+ * compared items are about 2 log2(t) bits wide. The receiver (the smaller
+ * set, which holds the secret key) cuckoo-hashes its items into a table of
+ * bundles * slots / 2 bins, one item per bin, each of hash_count bins an
+ * item may take; the server (the larger set, kept in plaintext) inserts
+ * every item into all hash_count of its bins. A bin's server items are cut
+ * into partitions of partition_size, and each partition becomes, per slot,
+ * the polynomial whose roots are its items' elements, padded to the full
+ * degree with the root 0 (which no element takes; empty receiver bins hold it).
+ *
+ * The receiver sends, per bundle, its elements raised to the source powers
+ * k * 2^(w i) (k < 2^w, w = window_bits) instead of every power up to
+ * partition_size; the server multiplies out the others (power_depth()
+ * levels of products) and evaluates every partition's polynomial with one
+ * weighted sum, its coefficients scaled by fresh random nonzero factors per
+ * slot. A result slot is zero where the receiver's element is a root, and
+ * uniformly random elsewhere, so the receiver learns which of its items
+ * the server holds and nothing else about the server's set but its bins'
+ * largest load (the partition count). The server sees only ciphertexts.
+ * Results are not noise-flooded, so this is the semi-honest protocol of
+ * the paper without its OPRF preprocessing.
+ *
+ * False matches need both elements of a different item to be roots of the
+ * same partition: about hash_count * (partition_size / t)^2 per receiver
+ * item and partition, well below 1e-8 at t around 2^20.
+ */
+struct PsiParameters {
+    static constexpr size_t hash_count = 3;
+    static constexpr size_t item_slots = 2;  // Field elements (slots) per item
+
+    size_t bundles = 4;          // Ciphertexts per table: bundles * slots / 2 bins
+    size_t partition_size = 32;  // Server items per polynomial, its degree
+    size_t window_bits = 2;
+
+    // Step of power_plan(): power = left + right, or a source power (left == 0)
+    struct Power {
+        size_t left = 0;
+        size_t right = 0;
+        size_t depth = 0;  // Products on its longest path from source powers
+    };
+
+    // @throws std::invalid_argument unless bundles is 1 .. 64, partition_size 1 .. 256 and window_bits 1 .. 4
+    void validate() const;
+    // Powers the receiver encrypts, ascending
+    std::vector<size_t> source_powers() const;
+    // Indexed by power 0 .. partition_size: how the server forms each from lower ones at the least depth
+    std::vector<Power> power_plan() const;
+    size_t power_depth() const;
+    /**
+     * BFV profile for these parameters: profiles::select with a 20-bit plain modulus and
+     * power_depth() + 1 (the coefficients' plaintext products) levels
+     */
+    const ParameterProfile& profile() const;
+};
+
+namespace psi {
+    // 64-bit hash of an ID (FNV-1a, then the SplitMix64 finalizer), the same on every build
+    uint64_t hash_id(const std::string& id);
+    // Bin of an item under one of the hash_count hash functions
+    size_t bin(uint64_t hash, size_t function, size_t bins);
+    // Field element k (< item_slots) of an item, 1 .. plain_modulus - 1
+    uint64_t element(uint64_t hash, size_t k, uint64_t plain_modulus);
+}
+
+/**
+ * Receiver side: the IDs cuckoo-hashed into as many tables (query batches) as
+ * they need. Placement is deterministic for the same IDs in the same order,
+ * so the key holder rebuilds it to read the results instead of keeping state
+ */
+class PsiReceiver {
+public:
+    /**
+     * @param slots Slots per ciphertext
+     * @param plain_modulus The BFV plain modulus (below 2^32)
+     * @throws std::invalid_argument for invalid parameters or no IDs
+     */
+    PsiReceiver(const PsiParameters& parameters, size_t slots, uint64_t plain_modulus,
+                const std::vector<std::string>& ids);
+
+    size_t batch_count() const { return tables.size(); }
+
+    /**
+     * Slot values of one batch: for each bundle, for each source power, the bins'
+     * elements raised to it (centered, as BatchEncoder takes them)
+     */
+    std::vector<std::vector<double>> query(size_t batch) const;
+
+    /**
+     * Which IDs the server's set holds, from the decrypted results of every batch
+     * @param results Per batch, the slots of all its result ciphertexts in order
+     *                (bundle-major, then partition)
+     * @throws std::invalid_argument for a batch count or result length that does not fit
+     */
+    std::vector<bool> matches(const std::vector<std::vector<double>>& results) const;
+
+private:
+    PsiParameters parameters;
+    size_t slots;
+    uint64_t plain_modulus;
+    std::vector<uint64_t> hashes;              // Distinct items
+    std::vector<size_t> items;                 // Per ID, its index in hashes
+    std::vector<std::vector<size_t>> tables;  // Per batch, the item in each bin (or none)
+};
+
+/**
+ * Server side: the set's partition polynomials, per bundle and partition the
+ * coefficients of every power for every slot. Independent of keys, so one set
+ * answers receivers with different key sets (tenants) of the same profile
+ */
+class PsiServerSet {
+public:
+    /**
+     * @throws std::invalid_argument for invalid parameters or no IDs
+     */
+    PsiServerSet(const PsiParameters& parameters, size_t slots, uint64_t plain_modulus,
+                 const std::vector<std::string>& ids);
+
+    const PsiParameters& parameters() const { return parameters_; }
+    size_t slot_count() const { return slots; }
+    uint64_t plain_modulus() const { return plain_modulus_; }
+    size_t item_count() const { return items; }
+    size_t partition_count() const { return partitions; }
+    size_t largest_bin() const { return largest; }
+    size_t memory_bytes() const { return coefficients_.size() * sizeof(uint32_t); }
+
+    // Coefficient of x^power (0 .. partition_size) of each slot's polynomial
+    const uint32_t* coefficients(size_t bundle, size_t partition, size_t power) const;
+
+private:
+    PsiParameters parameters_;
+    size_t slots;
+    uint64_t plain_modulus_;
+    size_t items = 0;
+    size_t partitions = 0;
+    size_t largest = 0;
+    std::vector<uint32_t> coefficients_;  // [bundle][partition][power][slot]
+};
+
+#endif // PRIVATE_SET_INTERSECTION_H
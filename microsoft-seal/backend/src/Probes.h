@@ -0,0 +1,55 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+#include <cstdint>
+
+/**
+ * USDT (static tracepoint) markers for perf and bpftrace, compiled in with
+ * -DHE_USDT=ON and empty otherwise
+ *
+ * Provider "he":
+ *   method__entry(const char* method, uint64 operands, uint64 bytes)
+ *   method__return(const char* method)
+ *       around HomomorphicEncryption methods (HE_PROBE_METHOD); operands is
+ *       the number of ciphertexts or values taken, bytes their size (wire
+ *       bytes for serialized input, in-memory bytes for ciphertext objects)
+ *   request__start(const char* endpoint, uint64 body_bytes)
+ *   request__done(const char* endpoint, uint64 status, uint64 body_bytes)
+ *       around every handler (MetricsMiddleware)
+ *
+ * An unattached probe is a single nop plus argument set-up, so the markers
+ * stay in production builds; list them with `perf list 'sdt_he:*'` after
+ * `perf buildid-cache --add <binary>`, or `bpftrace -l 'usdt:<binary>:he:*'`.
+ */
+
+#if defined(HE_USDT)
+    #include <sys/sdt.h>
+
+    #define HE_PROBE(name, ...) STAP_PROBEV(he, name, __VA_ARGS__)
+
+    namespace probes {
+        // Fires method__entry on construction and method__return on destruction
+        class MethodScope {
+        public:
+            MethodScope(const char* method, uint64_t operands, uint64_t bytes) : method(method) {
+                HE_PROBE(method__entry, method, operands, bytes);
+            }
+            ~MethodScope() { HE_PROBE(method__return, method); }
+
+            MethodScope(const MethodScope&) = delete;
+            MethodScope& operator=(const MethodScope&) = delete;
+
+        private:
+            const char* method;
+        };
+    }
+
+    #define HE_PROBE_METHOD(method, operands, bytes) \
+        probes::MethodScope he_probe_method_(method, static_cast<uint64_t>(operands), static_cast<uint64_t>(bytes))
+#else
+    // Arguments are not evaluated without HE_USDT
+    #define HE_PROBE(name, ...) ((void)0)
+    #define HE_PROBE_METHOD(method, operands, bytes) ((void)0)
+#endif
+
+#endif // PROBES_H
@@ -0,0 +1,46 @@
+/**
+ * ProfileRegistry.cpp
+ *
+ * Lazy creation of per-profile HomomorphicEncryption instances.
+ */
+
+#include "ProfileRegistry.h"
+#include <stdexcept>      // For std::runtime_error
+
+HomomorphicEncryption& ProfileRegistry::get(const ParameterProfile& profile, const std::string& scheme) {
+    if (scheme != "bfv" && scheme != "ckks" && scheme != "bgv") throw std::runtime_error("Invalid scheme");
+    return get(profile, parse_scheme(scheme));
+}
+
+HomomorphicEncryption& ProfileRegistry::get(const ParameterProfile& profile, bool use_ckks) {
+    return get(profile, use_ckks ? seal::scheme_type::ckks : seal::scheme_type::bfv);
+}
+
+/**
+ * The instance for a profile and scheme; the first request for it pays for
+ * context creation and key setup. Only that entry is held meanwhile: concurrent
+ * requests for it wait and never build it twice, those for other profiles and
+ * schemes go ahead. If setup throws, the next request tries again
+ */
+HomomorphicEncryption& ProfileRegistry::get(const ParameterProfile& profile, seal::scheme_type scheme) {
+    Entry* entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& slot = instances[{profile.name, scheme}];
+        if (!slot) slot = std::make_unique<Entry>();
+        entry = slot.get();
+    }
+    std::call_once(entry->built, [&] {
+        auto created = std::make_unique<HomomorphicEncryption>(scheme, false, profile);
+        setup(*created);
+        entry->instance = std::move(created);
+        entry->ready.store(entry->instance.get(), std::memory_order_release);
+    });
+    return *entry->instance;
+}
+
+HomomorphicEncryption* ProfileRegistry::find(const ParameterProfile& profile, seal::scheme_type scheme) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = instances.find({profile.name, scheme});
+    return found == instances.end() ? nullptr : found->second->ready.load(std::memory_order_acquire);
+}
@@ -0,0 +1,55 @@
+#ifndef PROFILE_REGISTRY_H
+#define PROFILE_REGISTRY_H
+
+#include "HomomorphicEncryption.h"
+#include "ParameterProfile.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+/**
+ * One HomomorphicEncryption instance per (parameter profile, scheme), created on first use
+ *
+ * Building an instance means a new SEALContext plus loading or generating its
+ * keys, so it is done once per process; setup() does the backend-specific part
+ * (thread pool, scratch memory, key store). Instances are never destroyed
+ * before the registry, so references returned by get() stay valid. Thread-safe;
+ * different instances are built concurrently, so startup can create every
+ * scheme's at once.
+ */
+class ProfileRegistry {
+public:
+    using Setup = std::function<void(HomomorphicEncryption&)>;
+
+    explicit ProfileRegistry(Setup setup) : setup(std::move(setup)) {}
+
+    /**
+     * @throws std::runtime_error ("Invalid scheme") unless scheme is "bfv", "ckks" or "bgv"
+     */
+    HomomorphicEncryption& get(const ParameterProfile& profile, const std::string& scheme);
+    HomomorphicEncryption& get(const ParameterProfile& profile, bool use_ckks);  // CKKS or BFV
+    HomomorphicEncryption& get(const ParameterProfile& profile, seal::scheme_type scheme);
+
+    /**
+     * The instance if it has been built, without waiting for or starting it
+     * @return nullptr while it is missing or still being built
+     */
+    HomomorphicEncryption* find(const ParameterProfile& profile, seal::scheme_type scheme) const;
+
+private:
+    struct Entry {
+        std::once_flag built;
+        std::unique_ptr<HomomorphicEncryption> instance;
+        std::atomic<HomomorphicEncryption*> ready{nullptr};
+    };
+
+    Setup setup;
+    mutable std::mutex mutex;  // Guards the map only, not building an entry
+    std::map<std::pair<std::string, seal::scheme_type>, std::unique_ptr<Entry>> instances;
+};
+
+#endif // PROFILE_REGISTRY_H
@@ -0,0 +1,362 @@
+/**
+ * Profiler.cpp
+ *
+ * SIGPROF sampling with frame-pointer unwinding, and symbolization of the
+ * samples into collapsed stacks.
+ */
+
+#include "Profiler.h"
+#include <algorithm>      // For std::sort, std::clamp
+#include <atomic>         // For the sample buffer shared with the signal handler
+#include <condition_variable>
+#include <cstdint>        // For uintptr_t
+#include <map>            // Collapsed stacks in a stable order
+#include <mutex>          // For one profile at a time
+#include <thread>         // For the sampling thread
+#include <unordered_map>  // Symbol cache by address
+#include <vector>
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+    #define HE_PROFILER_STACKS 1
+    #include <cerrno>
+    #include <csignal>
+    #include <cstdlib>    // For std::free
+    #include <cstring>
+    #include <cxxabi.h>   // For demangling
+    #include <dlfcn.h>    // For dladdr
+    #include <elf.h>
+    #include <fstream>    // For reading the executable's symbol table
+    #include <link.h>     // For dl_iterate_phdr, ElfW
+    #include <sys/prctl.h>
+    #include <sys/time.h>
+    #include <sys/uio.h>  // For process_vm_readv
+    #include <ucontext.h>
+    #include <unistd.h>
+#else
+    #define HE_PROFILER_STACKS 0
+#endif
+
+namespace profiler {
+
+#if HE_PROFILER_STACKS
+namespace {
+    constexpr size_t max_depth = 64;
+    // About 35 MB of samples at most: 60 s of 8 busy cores at 99 Hz, with room to spare
+    constexpr size_t max_samples = 1 << 16;
+    // Frames are followed upwards from the stack pointer at most this far
+    constexpr uintptr_t max_stack_bytes = 64 << 20;
+
+    struct Sample {
+        char thread[16];        // Name of the sampled thread (PR_GET_NAME)
+        uint32_t depth;
+        uintptr_t pcs[max_depth];  // Innermost first: the interrupted pc, then return addresses
+    };
+
+    pid_t self;
+    Sample* samples_end = nullptr;
+    std::atomic<Sample*> samples{nullptr};
+    std::atomic<size_t> next_sample{0};
+    std::atomic<size_t> dropped_samples{0};
+    std::atomic<int> in_handler{0};
+
+    // Copy words of this process's memory; fails instead of faulting on unmapped addresses
+    bool read_words(uintptr_t address, uintptr_t* out, size_t count) {
+        iovec local{out, count * sizeof(uintptr_t)};
+        iovec remote{reinterpret_cast<void*>(address), count * sizeof(uintptr_t)};
+        return process_vm_readv(self, &local, 1, &remote, 1, 0) == static_cast<ssize_t>(local.iov_len);
+    }
+
+    void record(Sample& sample, const ucontext_t& context) {
+        const mcontext_t& registers = context.uc_mcontext;
+#if defined(__x86_64__)
+        uintptr_t pc = static_cast<uintptr_t>(registers.gregs[REG_RIP]);
+        uintptr_t fp = static_cast<uintptr_t>(registers.gregs[REG_RBP]);
+        uintptr_t sp = static_cast<uintptr_t>(registers.gregs[REG_RSP]);
+#else
+        uintptr_t pc = static_cast<uintptr_t>(registers.pc);
+        uintptr_t fp = static_cast<uintptr_t>(registers.regs[29]);
+        uintptr_t sp = static_cast<uintptr_t>(registers.sp);
+#endif
+        prctl(PR_GET_NAME, sample.thread, 0, 0, 0);
+        sample.pcs[0] = pc;
+        uint32_t depth = 1;
+        // A frame is {caller's frame pointer, return address}; frames only move up the stack
+        while (depth < max_depth && fp >= sp && fp - sp < max_stack_bytes && fp % sizeof(uintptr_t) == 0) {
+            uintptr_t frame[2];
+            if (!read_words(fp, frame, 2) || frame[1] == 0) break;
+            sample.pcs[depth++] = frame[1];
+            if (frame[0] <= fp) break;
+            fp = frame[0];
+        }
+        sample.depth = depth;
+    }
+
+    void on_sigprof(int, siginfo_t*, void* context) {
+        int saved_errno = errno;
+        in_handler.fetch_add(1);
+        if (Sample* buffer = samples.load()) {
+            Sample* sample = buffer + next_sample.fetch_add(1, std::memory_order_relaxed);
+            if (sample < samples_end) {
+                record(*sample, *static_cast<const ucontext_t*>(context));
+            } else {
+                dropped_samples.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        in_handler.fetch_sub(1);
+        errno = saved_errno;
+    }
+
+    // Installed once and kept: a SIGPROF still pending when a profile ends must not hit the default action
+    void install_handler() {
+        static std::once_flag installed;
+        std::call_once(installed, [] {
+            self = getpid();
+            struct sigaction action {};
+            action.sa_sigaction = on_sigprof;
+            action.sa_flags = SA_SIGINFO | SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGPROF, &action, nullptr);
+        });
+    }
+
+    /**
+     * The executable's function symbols, from its .symtab (or .dynsym when
+     * stripped), at their runtime addresses. dladdr only knows exported
+     * symbols and would name a static function after the export before it
+     */
+    class Symbols {
+    public:
+        Symbols() {
+            dl_iterate_phdr(
+                [](dl_phdr_info* info, size_t, void* base) {
+                    *static_cast<uintptr_t*>(base) = info->dlpi_addr;  // The executable comes first
+                    return 1;
+                },
+                &base);
+            std::ifstream file("/proc/self/exe", std::ios::binary);
+            ElfW(Ehdr) header;
+            if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+                std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0) {
+                return;
+            }
+            std::vector<ElfW(Shdr)> sections(header.e_shnum);
+            file.seekg(static_cast<std::streamoff>(header.e_shoff));
+            if (!file.read(reinterpret_cast<char*>(sections.data()), sections.size() * sizeof(ElfW(Shdr)))) return;
+            bool has_symtab = std::any_of(sections.begin(), sections.end(),
+                                          [](const ElfW(Shdr)& s) { return s.sh_type == SHT_SYMTAB; });
+            for (const ElfW(Shdr)& section : sections) {
+                if (section.sh_type != (has_symtab ? SHT_SYMTAB : SHT_DYNSYM) || section.sh_link >= sections.size()) {
+                    continue;
+                }
+                std::vector<ElfW(Sym)> entries(section.sh_size / sizeof(ElfW(Sym)));
+                const ElfW(Shdr)& strings = sections[section.sh_link];
+                size_t offset = names.size();
+                names.resize(offset + strings.sh_size + 1);
+                file.seekg(static_cast<std::streamoff>(section.sh_offset));
+                file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(ElfW(Sym)));
+                file.seekg(static_cast<std::streamoff>(strings.sh_offset));
+                file.read(&names[offset], static_cast<std::streamsize>(strings.sh_size));
+                if (!file) return;
+                for (const ElfW(Sym)& entry : entries) {
+                    if ((entry.st_info & 0xf) != STT_FUNC || !entry.st_value || !entry.st_size ||
+                        entry.st_name >= strings.sh_size) {
+                        continue;
+                    }
+                    uintptr_t start = base + entry.st_value;
+                    offsets.push_back({start, start + entry.st_size, offset + entry.st_name});
+                }
+            }
+            std::sort(offsets.begin(), offsets.end(),
+                      [](const Entry& a, const Entry& b) { return a.start < b.start; });
+        }
+
+        // Mangled name of the function containing address, or nullptr
+        const char* find(uintptr_t address) const {
+            auto after = std::upper_bound(offsets.begin(), offsets.end(), address,
+                                          [](uintptr_t a, const Entry& e) { return a < e.start; });
+            if (after == offsets.begin() || address >= std::prev(after)->end) return nullptr;
+            return names.data() + std::prev(after)->name;
+        }
+
+    private:
+        struct Entry {
+            uintptr_t start;
+            uintptr_t end;
+            size_t name;  // Offset into names
+        };
+
+        uintptr_t base = 0;
+        std::vector<char> names;
+        std::vector<Entry> offsets;
+    };
+
+    // "std::vector<int, std::allocator<int> >::push_back" -> "std::vector<>::push_back"; as is when unbalanced (operator<)
+    std::string elide_template_arguments(const std::string& name) {
+        std::string out;
+        int depth = 0;
+        for (char c : name) {
+            if (c == '<' && depth++ == 0) out += c;
+            if (c == '>' && --depth == 0) out += c;
+            if (depth < 0) return name;
+            if (depth == 0 && c != '>') out += c;
+        }
+        return depth == 0 ? out : name;
+    }
+
+    // Demangled, without parameters and template arguments, and safe as a collapsed-stack frame
+    std::string frame_name(const char* mangled) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+        std::string name = status == 0 && demangled ? demangled : mangled;
+        std::free(demangled);
+        size_t close = name.rfind(')');
+        if (close != std::string::npos && name.find('(') != std::string::npos) {
+            int depth = 0;
+            for (size_t i = close + 1; i-- > 0;) {
+                if (name[i] == ')') depth++;
+                if (name[i] == '(' && --depth == 0) {
+                    if (i > 0) name.resize(i);
+                    break;
+                }
+            }
+        }
+        std::replace(name.begin(), name.end(), ';', ':');
+        return elide_template_arguments(name);
+    }
+
+    std::string symbolize(const Symbols& executable, uintptr_t address) {
+        if (const char* name = executable.find(address)) return frame_name(name);
+        Dl_info info;
+        if (dladdr(reinterpret_cast<void*>(address), &info) && info.dli_fname) {
+            if (info.dli_sname) return frame_name(info.dli_sname);
+            const char* slash = std::strrchr(info.dli_fname, '/');
+            return std::string("[") + (slash ? slash + 1 : info.dli_fname) + "]";
+        }
+        return "[unknown]";
+    }
+
+    struct Session {
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool running = false;
+        bool stopping = false;
+        std::shared_ptr<const Profile> last;
+        std::thread worker;
+
+        ~Session() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            if (worker.joinable()) worker.join();
+        }
+    };
+
+    Session& session() {
+        static Session instance;
+        return instance;
+    }
+
+    Profile sample(Session& session, std::chrono::milliseconds duration, unsigned frequency_hz) {
+        // Room for every core busy for the whole duration, with some slack
+        size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        size_t expected = static_cast<size_t>(duration.count()) * frequency_hz / 1000 * cores * 5 / 4 + 64;
+        std::vector<Sample> buffer(std::min(expected, max_samples));
+        samples_end = buffer.data() + buffer.size();
+        next_sample = 0;
+        dropped_samples = 0;
+        samples.store(buffer.data());
+
+        itimerval timer{};
+        long interval_us = 1000000 / static_cast<long>(frequency_hz);
+        timer.it_interval = {interval_us / 1000000, static_cast<suseconds_t>(interval_us % 1000000)};
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_PROF, &timer, nullptr);
+        {
+            std::unique_lock<std::mutex> lock(session.mutex);
+            session.wake.wait_for(lock, duration, [&] { return session.stopping; });
+        }
+        itimerval off{};
+        setitimer(ITIMER_PROF, &off, nullptr);
+
+        // Handlers already past the buffer check finish their sample before it is read
+        samples.store(nullptr);
+        while (in_handler.load() != 0) std::this_thread::yield();
+
+        Profile result;
+        result.samples = std::min(next_sample.load(), buffer.size());
+        result.dropped = dropped_samples.load();
+        result.frequency_hz = frequency_hz;
+        result.duration = duration;
+        Symbols executable;
+        std::unordered_map<uintptr_t, std::string> names;
+        std::map<std::string, size_t> stacks;
+        for (size_t i = 0; i < result.samples; i++) {
+            const Sample& sample = buffer[i];
+            std::string stack(sample.thread, strnlen(sample.thread, sizeof(sample.thread)));
+            for (uint32_t depth = sample.depth; depth-- > 0;) {
+                // A return address is past the call; look up the call itself
+                uintptr_t address = depth == 0 ? sample.pcs[0] : sample.pcs[depth] - 1;
+                auto name = names.find(address);
+                if (name == names.end()) name = names.emplace(address, symbolize(executable, address)).first;
+                stack += ";" + name->second;
+            }
+            stacks[stack]++;
+        }
+        for (const auto& stack : stacks) result.collapsed += stack.first + " " + std::to_string(stack.second) + "\n";
+        return result;
+    }
+}
+
+void start(std::chrono::milliseconds duration, unsigned frequency_hz) {
+    Session& current = session();
+    std::lock_guard<std::mutex> lock(current.mutex);
+    if (current.running) throw Busy("A profile is already running");
+    if (current.worker.joinable()) current.worker.join();  // The previous one, already done
+    install_handler();
+    current.running = true;
+    current.worker = std::thread([duration, frequency_hz = std::clamp(frequency_hz, 1u, 1000u)] {
+        Session& current = session();
+        Profile profile = sample(current, duration, frequency_hz);
+        std::lock_guard<std::mutex> lock(current.mutex);
+        current.last = std::make_shared<const Profile>(std::move(profile));
+        current.running = false;
+    });
+}
+
+bool running() {
+    std::lock_guard<std::mutex> lock(session().mutex);
+    return session().running;
+}
+
+std::shared_ptr<const Profile> last() {
+    std::lock_guard<std::mutex> lock(session().mutex);
+    return session().last;
+}
+
+bool supported() {
+    return true;
+}
+
+#else
+
+bool supported() {
+    return false;
+}
+
+void start(std::chrono::milliseconds, unsigned) {
+    throw std::runtime_error("Sampling is only supported on Linux x86-64 and AArch64");
+}
+
+bool running() {
+    return false;
+}
+
+std::shared_ptr<const Profile> last() {
+    return nullptr;
+}
+
+#endif
+
+}
@@ -0,0 +1,62 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+/**
+ * In-process CPU sampling profiler behind /admin/profile
+ *
+ * While a profile runs, a process-wide ITIMER_PROF timer sends SIGPROF at the
+ * given frequency per second of CPU time the process uses, to whichever
+ * thread is running; the handler walks that thread's frame pointers and
+ * records the return addresses in a preallocated buffer. Stack memory is read
+ * with process_vm_readv, so a frame of code built without frame pointers ends
+ * the walk instead of faulting. Once the time is up the addresses are
+ * symbolized from the executable's own symbol table (static functions and
+ * SEAL internals included) or, in shared libraries, with dladdr, and reduced
+ * to collapsed stacks, "thread;outer;...;inner count" per line, as
+ * flamegraph.pl and speedscope read them.
+ *
+ * Needs no privileges. Build with HE_FRAME_POINTERS (the default) for full
+ * stacks; without frame pointers most samples end at the sampled function.
+ * Only Linux on x86-64 and AArch64 walks stacks; elsewhere start() throws.
+ */
+namespace profiler {
+
+    // Another profile is running (one at a time, as the timer is process-wide)
+    class Busy : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    struct Profile {
+        std::string collapsed;  // One "thread;frame;...;frame count" line per distinct stack
+        size_t samples = 0;
+        size_t dropped = 0;     // Samples lost to a full buffer
+        unsigned frequency_hz = 0;
+        std::chrono::milliseconds duration{0};
+    };
+
+    /**
+     * Sample every thread of the process for `duration` on a background thread
+     * Sampling never blocks the caller; last() has the result once it is done.
+     * @param frequency_hz Samples per second of CPU time (1 to 1000)
+     * @throws Busy while another profile runs, std::runtime_error when sampling is unsupported
+     */
+    void start(std::chrono::milliseconds duration, unsigned frequency_hz);
+
+    // Whether a profile is being taken
+    bool running();
+
+    // The latest finished profile (nullptr before the first)
+    std::shared_ptr<const Profile> last();
+
+    // Whether this build can walk stacks
+    bool supported();
+}
+
+#endif // PROFILER_H
@@ -0,0 +1,156 @@
+/**
+ * PublicKeyCache.cpp
+ *
+ * Fingerprint lookup and LRU eviction of clients' public keys.
+ */
+
+#include "PublicKeyCache.h"
+#include "Metrics.h"
+#include <iterator>       // For std::prev
+#include <utility>        // For std::move
+
+namespace {
+    metrics::Counter& lookups(const char* result) {
+        return metrics::counter("he_public_key_cache_total",
+                                "Client public key lookups by result (hit, load, unknown, eviction, expired)",
+                                {{"result", result}});
+    }
+}
+
+PublicKeyCache::PublicKeyCache(size_t memory_budget) : memory_budget(memory_budget) {}
+
+/**
+ * The key is parsed outside the lock, so a slow load holds up only the
+ * requests posting that key; concurrent first posts of one key may both
+ * parse it, and the first to finish is kept
+ */
+std::shared_ptr<HomomorphicEncryption> PublicKeyCache::load(const HomomorphicEncryption& base,
+                                                            std::string_view serialized_key) {
+    static metrics::Counter& hits = lookups("hit");
+    static metrics::Counter& loads = lookups("load");
+
+    const std::string& profile = base.parameter_profile().name;
+    const std::string scheme = base.scheme_name();
+    Key source(key_fingerprint(serialized_key), profile, scheme);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = by_source.find(source);
+        if (found != by_source.end()) {
+            entries.splice(entries.begin(), entries, found->second);
+            found->second->used = MemoryBudget::Clock::now();
+            hits.add();
+            return found->second->engine;
+        }
+    }
+
+    const auto start = MemoryBudget::Clock::now();
+    std::shared_ptr<HomomorphicEncryption> engine = base.share_parameters();
+    engine->load_public_key(serialized_key);
+    const auto now = MemoryBudget::Clock::now();
+    const double load_us = std::chrono::duration<double, std::micro>(now - start).count();
+    // The encryptor holds a copy of the key
+    const size_t bytes = 2 * engine->key_bytes();
+    loads.add();
+    if (memory_budget == 0) return engine;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Key key(engine->public_key_fingerprint(), profile, scheme);
+    auto found = index.find(key);
+    if (found == index.end()) {
+        entries.push_front(Entry{key, engine, bytes, {}, load_us, now});
+        found = index.emplace(key, entries.begin()).first;
+        total_bytes += bytes;
+        total_load_us += load_us;
+    } else {
+        entries.splice(entries.begin(), entries, found->second);
+        found->second->used = now;
+    }
+    if (by_source.emplace(source, found->second).second) found->second->sources.push_back(source);
+    std::shared_ptr<HomomorphicEncryption> kept = found->second->engine;
+    evict();
+    return kept;
+}
+
+std::shared_ptr<HomomorphicEncryption> PublicKeyCache::find(const HomomorphicEncryption& base,
+                                                            const std::string& fingerprint) {
+    static metrics::Counter& hits = lookups("hit");
+    static metrics::Counter& unknown = lookups("unknown");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(Key(fingerprint, base.parameter_profile().name, base.scheme_name()));
+    if (found == index.end()) {
+        unknown.add();
+        throw UnknownFingerprint("Unknown public key fingerprint " + fingerprint + ", send public_key instead");
+    }
+    entries.splice(entries.begin(), entries, found->second);
+    found->second->used = MemoryBudget::Clock::now();
+    hits.add();
+    return found->second->engine;
+}
+
+// Drop least recently used keys until the budget holds, keeping the newest
+void PublicKeyCache::evict() {
+    static metrics::Counter& evictions = lookups("eviction");
+    while (total_bytes > memory_budget && entries.size() > 1) {
+        erase(std::prev(entries.end()));
+        evictions.add();
+    }
+}
+
+// Called with the mutex held
+void PublicKeyCache::erase(std::list<Entry>::iterator entry) {
+    index.erase(entry->key);
+    for (const Key& source : entry->sources) by_source.erase(source);
+    total_bytes -= entry->bytes;
+    total_load_us -= entry->load_us;
+    entries.erase(entry);
+}
+
+size_t PublicKeyCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t PublicKeyCache::key_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total_bytes;
+}
+
+MemoryBudget::Usage PublicKeyCache::budget_usage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return MemoryBudget::Usage{entries.size(), total_bytes, total_load_us};
+}
+
+bool PublicKeyCache::eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tenant || entries.size() < 2) return false;
+    const Entry& last = entries.back();
+    candidate = MemoryBudget::Candidate{last.used, last.bytes, last.load_us};
+    return true;
+}
+
+bool PublicKeyCache::evict(const std::string* tenant, MemoryBudget::Candidate& evicted) {
+    static metrics::Counter& evictions = lookups("eviction");
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tenant || entries.size() < 2) return false;
+    auto last = std::prev(entries.end());
+    evicted = MemoryBudget::Candidate{last->used, last->bytes, last->load_us};
+    erase(last);
+    evictions.add();
+    return true;
+}
+
+// Idle keys go even if one is the newest: the client has not used it for the TTL either
+MemoryBudget::Usage PublicKeyCache::expire(MemoryBudget::Clock::time_point before) {
+    static metrics::Counter& expirations = lookups("expired");
+    std::lock_guard<std::mutex> lock(mutex);
+    MemoryBudget::Usage expired;
+    while (!entries.empty() && entries.back().used < before) {
+        expired.entries++;
+        expired.bytes += entries.back().bytes;
+        expired.rebuild_us += entries.back().load_us;
+        erase(std::prev(entries.end()));
+        expirations.add();
+    }
+    return expired;
+}
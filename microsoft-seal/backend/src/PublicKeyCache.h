@@ -0,0 +1,93 @@
+#ifndef PUBLIC_KEY_CACHE_H
+#define PUBLIC_KEY_CACHE_H
+
+#include "HomomorphicEncryption.h"
+#include "MemoryBudget.h"
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+/**
+ * Clients' own public keys, parsed once and kept with their encryptors in a
+ * least-recently-used cache bounded by the bytes of their keys
+ *
+ * A request encrypting under a key the client posted (e.g. /encrypt with
+ * "public_key") would otherwise decode, parse and validate the key and build
+ * an encryptor for it every time, a few milliseconds per request at the
+ * default profile. Here the posted bytes are hashed instead (key_fingerprint)
+ * and, if seen before, the engine made for them is reused. Engines share
+ * everything but the key with the server's engine for the profile and scheme
+ * (HomomorphicEncryption::share_parameters).
+ *
+ * Each key is also known by its fingerprint (public_key_fingerprint(), over
+ * the uncompressed key), so a client can send that instead of the key on
+ * later requests, and a key posted under another compression still finds
+ * its engine. Evicted engines stay alive for as long as a request holds
+ * them. Lookups are exported as he_public_key_cache_total{result=...}.
+ * Under a MemoryBudget, keys unused for the TTL expire, and the budget evicts
+ * by how long each key took to load. Thread-safe.
+ */
+class PublicKeyCache : public MemoryBudget::Consumer {
+public:
+    // A fingerprint not (or no longer) in the cache: the client has to send the key itself
+    struct UnknownFingerprint : std::out_of_range {
+        using std::out_of_range::out_of_range;
+    };
+
+    // @param memory_budget Key bytes to keep (the most recently used key always stays; 0 keeps none)
+    explicit PublicKeyCache(size_t memory_budget);
+
+    /**
+     * Engine encrypting under a posted public key, for base's profile and scheme
+     * @param serialized_key Base64 public key, as load_public_key takes it
+     * @throws std::exception from SEAL for a key that does not fit the parameters
+     */
+    std::shared_ptr<HomomorphicEncryption> load(const HomomorphicEncryption& base, std::string_view serialized_key);
+
+    /**
+     * Engine of a key loaded before, by its public_key_fingerprint()
+     * @throws UnknownFingerprint if the cache does not hold it
+     */
+    std::shared_ptr<HomomorphicEncryption> find(const HomomorphicEncryption& base, const std::string& fingerprint);
+
+    size_t size() const;
+    size_t key_bytes() const;
+
+    // MemoryBudget::Consumer; keys are not a tenant's, and the most recently used one is not evicted
+    MemoryBudget::Usage budget_usage() const override;
+    bool eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const override;
+    bool evict(const std::string* tenant, MemoryBudget::Candidate& evicted) override;
+    MemoryBudget::Usage expire(MemoryBudget::Clock::time_point before) override;
+
+private:
+    using Key = std::tuple<std::string, std::string, std::string>;  // Fingerprint or source digest, profile, scheme
+    struct Entry {
+        Key key;
+        std::shared_ptr<HomomorphicEncryption> engine;
+        size_t bytes;
+        std::vector<Key> sources;  // Posted forms of the key, by their digests
+        double load_us;
+        MemoryBudget::Clock::time_point used;
+    };
+
+    const size_t memory_budget;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // Most recently used first
+    std::map<Key, std::list<Entry>::iterator> index;
+    std::map<Key, std::list<Entry>::iterator> by_source;
+    size_t total_bytes = 0;
+    double total_load_us = 0;
+
+    void evict();
+    void erase(std::list<Entry>::iterator entry);
+};
+
+#endif // PUBLIC_KEY_CACHE_H
@@ -0,0 +1,275 @@
+/**
+ * PythonBindings.cpp
+ *
+ * The pyhe extension module (built when pybind11 is found): the backends'
+ * engine for the machine-learning scripts, with the same parameters, packing
+ * and key files, so NumPy arrays are encrypted, scored and decrypted in
+ * native batches instead of per-value Python loops.
+ *
+ *   import numpy as np, pyhe
+ *   engine = pyhe.Engine("ckks", "keys", "ml-inference")  # the backends' --key-dir
+ *   cts = engine.encrypt_patients(X)                      # one row per patient
+ *   scores = engine.logistic_regression(cts, weights, bias)
+ *   probabilities = engine.decrypt_scores(scores, len(X), X.shape[1])
+ *
+ * Ciphertexts are bytes in the binary wire format of the /binary/... endpoints
+ * (wire="base64" gives str for the JSON ones). Every call copies its inputs
+ * while holding the GIL, then releases it and runs on the engine's pool.
+ */
+
+#include "EncryptPipeline.h"
+#include "HomomorphicEncryption.h"
+#include "KeyStore.h"
+#include "LogisticModel.h"
+#include "ParameterProfile.h"
+#include "PatientPacking.h"
+#include "ThreadPool.h"
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+    using Array = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+    WireFormat parse_wire(const std::string& name) {
+        if (name == "binary") return WireFormat::binary;
+        if (name == "base64") return WireFormat::base64;
+        throw std::invalid_argument("Unknown wire format: " + name);
+    }
+
+    /**
+     * Views of a list of bytes or str ciphertexts; they stay valid without
+     * the GIL as long as the list holds the objects, which are immutable
+     */
+    CiphertextViews ciphertext_views(const py::list& ciphertexts) {
+        CiphertextViews result;
+        result.reserve(ciphertexts.size());
+        for (const auto& item : ciphertexts) {
+            if (py::isinstance<py::bytes>(item)) {
+                char* data = nullptr;
+                Py_ssize_t size = 0;
+                if (PyBytes_AsStringAndSize(item.ptr(), &data, &size) != 0) throw py::error_already_set();
+                result.emplace_back(data, static_cast<size_t>(size));
+            } else if (py::isinstance<py::str>(item)) {
+                Py_ssize_t size = 0;
+                const char* data = PyUnicode_AsUTF8AndSize(item.ptr(), &size);
+                if (!data) throw py::error_already_set();
+                result.emplace_back(data, static_cast<size_t>(size));
+            } else {
+                throw std::invalid_argument("Ciphertexts must be bytes or str");
+            }
+        }
+        return result;
+    }
+
+    py::list ciphertext_list(std::vector<std::string>& ciphertexts, WireFormat format) {
+        py::list result;
+        for (auto& ciphertext : ciphertexts) {
+            if (format == WireFormat::binary) {
+                result.append(py::bytes(ciphertext));
+            } else {
+                result.append(py::str(ciphertext));
+            }
+            std::string().swap(ciphertext);  // Keep one copy of each at a time
+        }
+        return result;
+    }
+
+    py::array_t<double> to_array(const std::vector<double>& values) {
+        py::array_t<double> result(values.size());
+        std::copy(values.begin(), values.end(), result.mutable_data());
+        return result;
+    }
+
+    // Patients as rows of a 2-D array, copied for PatientPacking::pack
+    std::vector<std::vector<double>> rows_of(const Array& matrix) {
+        if (matrix.ndim() != 2) throw std::invalid_argument("Expected a 2-D array of patients by features");
+        auto view = matrix.unchecked<2>();
+        std::vector<std::vector<double>> rows(view.shape(0), std::vector<double>(view.shape(1)));
+        for (py::ssize_t i = 0; i < view.shape(0); i++) {
+            for (py::ssize_t f = 0; f < view.shape(1); f++) rows[i][f] = view(i, f);
+        }
+        return rows;
+    }
+
+    /**
+     * Exposed as pyhe.Engine: one scheme and profile with the keys of a key
+     * store shared with the backends, and a thread pool of its own
+     */
+    class PyEngine {
+    public:
+        /**
+         * @param scheme "bfv", "ckks" or "bgv"
+         * @param key_dir The backends' --key-dir; the secret key is loaded if it is there
+         * @param profile Parameter profile name ("" for the default)
+         * @param threads Worker threads (0: one per core)
+         * @throws std::out_of_range (IndexError) if the store has no key for the scheme and profile
+         */
+        PyEngine(const std::string& scheme, const std::string& key_dir, const std::string& profile, size_t threads)
+            : he(std::make_unique<HomomorphicEncryption>(
+                  parse_scheme(scheme), false, profile.empty() ? profiles::default_profile() : profiles::get(profile))),
+              pool(std::make_shared<ThreadPool>(threads ? threads : std::thread::hardware_concurrency())) {
+            KeyStore store(key_dir);
+            secret_key = he->load_keys(store, true);
+            if (!secret_key && !he->load_keys(store, false)) {
+                throw std::out_of_range("No " + (profile.empty() ? profiles::default_profile().name : profile) + " " +
+                                        scheme + " keys in " + key_dir);
+            }
+            he->set_thread_pool(pool);
+        }
+
+        size_t slot_count() const { return he->slot_count(); }
+        bool has_secret_key() const { return secret_key; }
+
+        // A 1-D array packed slot_count() values per ciphertext, as POST /csv/sum?packed expects
+        py::list encrypt(const Array& values, const std::string& wire) const {
+            if (values.ndim() != 1) throw std::invalid_argument("Expected a 1-D array");
+            WireFormat format = parse_wire(wire);
+            std::vector<std::string> ciphertexts;
+            {
+                std::vector<double> copy(values.data(), values.data() + values.size());
+                py::gil_scoped_release release;
+                ciphertexts = encrypt_values(copy.data(), copy.size(), format);
+            }
+            return ciphertext_list(ciphertexts, format);
+        }
+
+        // Patients (rows) by features packed in a PatientLayout, for logistic_regression and /ml/logreg/predict
+        py::list encrypt_patients(const Array& matrix, const std::string& layout, const std::string& wire) const {
+            WireFormat format = parse_wire(wire);
+            std::vector<std::string> ciphertexts;
+            {
+                std::vector<std::vector<double>> rows = rows_of(matrix);
+                if (rows.empty() || rows[0].empty()) throw std::invalid_argument("No patients or no features");
+                const PatientPacking packing(parse_patient_layout(layout), rows[0].size(), he->slot_count());
+                py::gil_scoped_release release;
+                std::vector<double> slots = packing.pack(rows);
+                ciphertexts = encrypt_values(slots.data(), slots.size(), format);
+            }
+            return ciphertext_list(ciphertexts, format);
+        }
+
+        // The first count values (0: all slots) of packed ciphertexts; needs the secret key
+        py::array_t<double> decrypt(const py::list& ciphertexts, size_t count, const std::string& wire) const {
+            require_secret_key();
+            CiphertextViews views = ciphertext_views(ciphertexts);
+            WireFormat format = parse_wire(wire);
+            std::vector<double> values;
+            {
+                py::gil_scoped_release release;
+                values = he->decrypt_batch(views, format);
+                if (count && count < values.size()) values.resize(count);
+            }
+            return to_array(values);
+        }
+
+        /**
+         * Encrypted probabilities of packed patients (CKKS, see
+         * HomomorphicEncryption::logistic_regression); the model as in
+         * /ml/logreg/predict, mean and scale folded into the weights
+         */
+        py::list logistic_regression(const py::list& ciphertexts, const std::vector<double>& weights, double bias,
+                                     const std::vector<double>& sigmoid, const std::vector<double>& mean,
+                                     const std::vector<double>& scale, const std::string& layout,
+                                     const std::string& wire) const {
+            LogisticModel model;
+            model.weights = weights;
+            model.bias = bias;
+            model.sigmoid = sigmoid;
+            if (!mean.empty() || !scale.empty()) model.fold_standardization(mean, scale);
+            PatientLayout patient_layout = parse_patient_layout(layout);
+            CiphertextViews views = ciphertext_views(ciphertexts);
+            WireFormat format = parse_wire(wire);
+
+            std::vector<std::string> results;
+            {
+                py::gil_scoped_release release;
+                std::vector<seal::Ciphertext> inputs = deserialize_all(views, format);
+                if (inputs.empty()) throw std::invalid_argument("Cannot score empty vector of ciphertexts");
+                auto scores = he->logistic_regression(inputs.data(), inputs.size(), model, nullptr, patient_layout);
+                results.reserve(scores.size());
+                for (const auto& score : scores) results.push_back(he->serialize(score, WireOptions(format)));
+            }
+            return ciphertext_list(results, format);
+        }
+
+        // Each of count patients' probability from logistic_regression output; needs the secret key
+        py::array_t<double> decrypt_scores(const py::list& ciphertexts, size_t count, size_t features,
+                                           const std::string& layout, const std::string& wire) const {
+            require_secret_key();
+            const PatientPacking packing(parse_patient_layout(layout), features, he->slot_count());
+            CiphertextViews views = ciphertext_views(ciphertexts);
+            WireFormat format = parse_wire(wire);
+            std::vector<double> scores;
+            {
+                py::gil_scoped_release release;
+                scores = packing.scores(he->decrypt_batch(views, format), count);
+            }
+            return to_array(scores);
+        }
+
+    private:
+        std::unique_ptr<HomomorphicEncryption> he;
+        std::shared_ptr<ThreadPool> pool;
+        bool secret_key = false;
+
+        void require_secret_key() const {
+            if (!secret_key) throw std::invalid_argument("Decryption needs the secret key, which the key store lacks");
+        }
+
+        // Packed public-key encryption on the pool, in input order
+        std::vector<std::string> encrypt_values(const double* values, size_t count, WireFormat format) const {
+            std::vector<std::string> ciphertexts;
+            EncryptPipeline pipeline(*he, WireOptions(format),
+                                     [&](std::string&& ciphertext) { ciphertexts.push_back(std::move(ciphertext)); },
+                                     pool);
+            pipeline.push(values, count);
+            pipeline.finish();
+            return ciphertexts;
+        }
+
+        // Checked loads of every ciphertext, concurrently
+        std::vector<seal::Ciphertext> deserialize_all(const CiphertextViews& views, WireFormat format) const {
+            std::vector<std::future<seal::Ciphertext>> loads;
+            loads.reserve(views.size());
+            for (auto view : views) loads.push_back(pool->submit([this, view, format] {
+                return he->deserialize(view, format);
+            }));
+            std::vector<seal::Ciphertext> ciphertexts;
+            ciphertexts.reserve(loads.size());
+            for (auto& load : loads) ciphertexts.push_back(load.get());
+            return ciphertexts;
+        }
+    };
+}
+
+PYBIND11_MODULE(pyhe, m) {
+    m.doc() = "Packed homomorphic encryption with the backends' engine, parameters and key files";
+
+    py::class_<PyEngine>(m, "Engine")
+        .def(py::init<std::string, std::string, std::string, size_t>(),
+             py::arg("scheme"), py::arg("key_dir"), py::arg("profile") = "", py::arg("threads") = 0)
+        .def_property_readonly("slot_count", &PyEngine::slot_count)
+        .def_property_readonly("has_secret_key", &PyEngine::has_secret_key)
+        .def("encrypt", &PyEngine::encrypt, py::arg("values"), py::arg("wire") = "binary")
+        .def("encrypt_patients", &PyEngine::encrypt_patients,
+             py::arg("patients"), py::arg("layout") = "sample_major", py::arg("wire") = "binary")
+        .def("decrypt", &PyEngine::decrypt, py::arg("ciphertexts"), py::arg("count") = 0, py::arg("wire") = "binary")
+        .def("logistic_regression", &PyEngine::logistic_regression,
+             py::arg("ciphertexts"), py::arg("weights"), py::arg("bias") = 0.0,
+             py::arg("sigmoid") = std::vector<double>{0.5, 0.1973, 0.0, -0.0048},
+             py::arg("mean") = std::vector<double>{}, py::arg("scale") = std::vector<double>{},
+             py::arg("layout") = "sample_major", py::arg("wire") = "binary")
+        .def("decrypt_scores", &PyEngine::decrypt_scores, py::arg("ciphertexts"), py::arg("count"),
+             py::arg("features"), py::arg("layout") = "sample_major", py::arg("wire") = "binary");
+}
@@ -0,0 +1,302 @@
+/**
+ * QueryPlanner.cpp
+ *
+ * Calibration of the per-operation costs, and the operation counts behind every plan.
+ */
+
+#include "QueryPlanner.h"
+#include "HomomorphicEncryption.h"
+#include "seal/seal.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    const char* const packings[] = { "packed", "per_value" };
+    const char* const patient_layouts[] = { "feature_major", "sample_major" };
+
+    // Median microseconds of repetitions runs of op
+    double time_us(size_t repetitions, const std::function<void()>& op) {
+        std::vector<double> samples;
+        for (size_t i = 0; i < std::max<size_t>(1, repetitions); i++) {
+            auto start = std::chrono::steady_clock::now();
+            op();
+            samples.push_back(
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    OperationCosts measure(const HomomorphicEncryption& he, size_t repetitions) {
+        const seal::SEALContext& context = *he.seal_context();
+        const bool use_ckks = context.key_context_data()->parms().scheme() == seal::scheme_type::ckks;
+        seal::KeyGenerator keygen(context);
+        seal::PublicKey public_key;
+        keygen.create_public_key(public_key);
+        seal::RelinKeys relin_keys;
+        keygen.create_relin_keys(relin_keys);
+        seal::GaloisKeys galois_keys;
+        keygen.create_galois_keys(std::vector<int>{ 1 }, galois_keys);
+        seal::Encryptor encryptor(context, public_key);
+        seal::Evaluator evaluator(context);
+
+        seal::Plaintext plain;
+        if (use_ckks) {
+            seal::CKKSEncoder encoder(context);
+            encoder.encode(1.5, std::pow(2.0, he.parameter_profile().scale_bits), plain);
+        } else {
+            seal::BatchEncoder encoder(context);
+            encoder.encode(std::vector<uint64_t>(encoder.slot_count(), 3), plain);
+        }
+        seal::Ciphertext a, b, result, product;
+        encryptor.encrypt(plain, a);
+        encryptor.encrypt(plain, b);
+        evaluator.multiply(a, b, product);
+
+        OperationCosts costs;
+        costs.add = time_us(repetitions, [&] { evaluator.add(a, b, result); });
+        costs.multiply_plain = time_us(repetitions, [&] { evaluator.multiply_plain(a, plain, result); });
+        costs.multiply = time_us(repetitions, [&] { evaluator.multiply(a, b, result); });
+        costs.relinearize = time_us(repetitions, [&] { evaluator.relinearize(product, relin_keys, result); });
+        if (use_ckks) {
+            costs.rotate = time_us(repetitions, [&] { evaluator.rotate_vector(a, 1, galois_keys, result); });
+            costs.rescale = time_us(repetitions, [&] { evaluator.rescale_to_next(a, result); });
+        } else {
+            costs.rotate = time_us(repetitions, [&] { evaluator.rotate_rows(a, 1, galois_keys, result); });
+        }
+        std::string saved;
+        costs.serialize = time_us(repetitions, [&] {
+            std::ostringstream out;
+            a.save(out, seal::compr_mode_type::none);
+            saved = out.str();
+        });
+        costs.deserialize = time_us(repetitions, [&] {
+            std::istringstream in(saved);
+            result.load(context, in);
+        });
+        return costs;
+    }
+
+    size_t log2_ceil(size_t value) {
+        size_t bits = 0;
+        while ((size_t(1) << bits) < value) bits++;
+        return bits;
+    }
+
+    size_t ceil_div(size_t a, size_t b) { return (a + b - 1) / b; }
+
+    size_t required_depth(PlanOperation operation, bool use_ckks) {
+        switch (operation) {
+            case PlanOperation::sum: return 0;
+            case PlanOperation::mean: return use_ckks ? 1 : 0;
+            case PlanOperation::variance: return 1;
+            case PlanOperation::group_by: return use_ckks ? 2 : 1;
+            case PlanOperation::linear_model: return 1;
+        }
+        return 0;
+    }
+}
+
+CostModel CostModel::nominal() {
+    CostModel model;
+    model.costs[0] = { 25, 250, 2500, 1200, 1200, 0, 150, 250 };
+    model.costs[1] = { 25, 40, 120, 1200, 1200, 150, 150, 250 };
+    return model;
+}
+
+CostModel CostModel::calibrate(const HomomorphicEncryption& bfv, const HomomorphicEncryption& ckks,
+                               size_t repetitions) {
+    CostModel model;
+    model.costs[0] = measure(bfv, repetitions);
+    model.costs[1] = measure(ckks, repetitions);
+    model.measured = true;
+    return model;
+}
+
+OperationCosts CostModel::at(const ParameterProfile& profile, bool use_ckks) const {
+    ParameterReport report = profiles::report(profile, use_ckks);
+    OperationCosts scaled = base(use_ckks);
+    scaled.add *= report.add_cost;
+    scaled.multiply_plain *= report.add_cost;
+    scaled.rescale *= report.add_cost;
+    scaled.serialize *= report.add_cost;
+    scaled.deserialize *= report.add_cost;
+    scaled.multiply *= report.multiply_cost;
+    scaled.relinearize *= report.key_switch_cost;
+    scaled.rotate *= report.key_switch_cost;
+    return scaled;
+}
+
+PlanOperation parse_plan_operation(const std::string& name) {
+    if (name == "sum") return PlanOperation::sum;
+    if (name == "mean") return PlanOperation::mean;
+    if (name == "variance") return PlanOperation::variance;
+    if (name == "group_by") return PlanOperation::group_by;
+    if (name == "linear_model") return PlanOperation::linear_model;
+    throw std::invalid_argument("Unknown operation: " + name + " (sum, mean, variance, group_by or linear_model)");
+}
+
+const char* plan_operation_name(PlanOperation operation) {
+    switch (operation) {
+        case PlanOperation::sum: return "sum";
+        case PlanOperation::mean: return "mean";
+        case PlanOperation::variance: return "variance";
+        case PlanOperation::group_by: return "group_by";
+        case PlanOperation::linear_model: return "linear_model";
+    }
+    return "unknown";
+}
+
+QueryPlanner::QueryPlanner(CostModel model, Options options) : model(std::move(model)), options(options) {
+    if (this->options.compute_threads == 0) this->options.compute_threads = 1;
+}
+
+Plan QueryPlanner::plan(const PlanRequest& request) const {
+    return alternatives(request).front();
+}
+
+std::vector<Plan> QueryPlanner::alternatives(const PlanRequest& request) const {
+    if (request.rows == 0 && request.ciphertexts == 0) throw std::invalid_argument("Nothing to plan: no rows");
+    const size_t depth = required_depth(request.operation, request.use_ckks);
+    const bool linear = request.operation == PlanOperation::linear_model;
+
+    std::vector<const ParameterProfile*> candidates;
+    if (request.profile) {
+        if (request.profile->depth < depth) {
+            throw std::invalid_argument(std::string(plan_operation_name(request.operation)) + " needs depth " +
+                                        std::to_string(depth) + ", profile " + request.profile->name + " has " +
+                                        std::to_string(request.profile->depth));
+        }
+        candidates.push_back(request.profile);
+    } else {
+        for (const auto& profile : profiles::all()) {
+            if (profile.depth >= depth) candidates.push_back(&profile);
+        }
+    }
+
+    std::vector<Plan> plans;
+    for (const ParameterProfile* profile : candidates) {
+        size_t slots = request.use_ckks ? profile->poly_modulus_degree / 2 : profile->poly_modulus_degree;
+        if (linear && size_t(1) << log2_ceil(std::max<size_t>(1, request.features)) > slots) continue;
+        if (request.operation == PlanOperation::group_by && request.groups > slots) continue;
+
+        std::vector<std::string> layouts;
+        if (linear) {
+            layouts.assign(std::begin(patient_layouts), std::end(patient_layouts));
+        } else if (request.packed >= 0) {
+            layouts.push_back(request.packed ? "packed" : "per_value");
+        } else {
+            layouts.assign(std::begin(packings), std::end(packings));
+        }
+        for (const auto& layout : layouts) {
+            plans.push_back(cost(request, *profile, layout, 1));
+            if (request.operation == PlanOperation::sum && request.workers > 0 && plans.back().ciphertexts > 1) {
+                plans.push_back(cost(request, *profile, layout, std::min(request.workers, plans.back().ciphertexts)));
+            }
+        }
+    }
+    if (plans.empty()) {
+        throw std::invalid_argument(request.profile ? "Profile " + request.profile->name + " has too few slots"
+                                                    : std::string("No profile fits the operation"));
+    }
+    std::stable_sort(plans.begin(), plans.end(),
+                     [](const Plan& a, const Plan& b) { return a.estimated_us < b.estimated_us; });
+    return plans;
+}
+
+Plan QueryPlanner::cost(const PlanRequest& request, const ParameterProfile& profile, const std::string& packing,
+                        size_t shards) const {
+    const bool ckks = request.use_ckks;
+    const OperationCosts k = model.at(profile, ckks);
+    const size_t slots = ckks ? profile.poly_modulus_degree / 2 : profile.poly_modulus_degree;
+    const size_t threads = options.compute_threads;
+    const size_t fold = log2_ceil(slots);  // sum_slots: BFV folds n / 2 rows and then the two columns
+
+    Plan plan;
+    plan.operation = request.operation;
+    plan.use_ckks = ckks;
+    plan.profile = profile.name;
+    plan.depth = required_depth(request.operation, ckks);
+    plan.packing = packing;
+    plan.calibrated = model.calibrated();
+
+    const size_t block = size_t(1) << log2_ceil(std::max<size_t>(1, request.features));
+    if (request.ciphertexts && (request.packed >= 0 || request.profile)) {
+        plan.ciphertexts = request.ciphertexts;
+    } else if (packing == "per_value") {
+        plan.ciphertexts = request.rows;
+    } else if (packing == "packed") {
+        plan.ciphertexts = ceil_div(request.rows, slots);
+    } else {
+        plan.ciphertexts = ceil_div(request.rows, slots / block);
+    }
+    const size_t c = std::max<size_t>(1, plan.ciphertexts);
+    const bool packed = packing != "per_value";
+
+    // Work per item spread over the compute threads; a reduction's tree adds log2 threads steps
+    auto spread = [&](double per_item, size_t items) {
+        return per_item * static_cast<double>(ceil_div(items, threads));
+    };
+    auto reduce = [&](double per_operand, size_t operands) {
+        return spread(per_operand, operands) + k.add * static_cast<double>(log2_ceil(std::min(operands, threads)));
+    };
+    const double slot_fold = static_cast<double>(fold) * (k.rotate + k.add);
+
+    switch (request.operation) {
+        case PlanOperation::sum:
+        case PlanOperation::mean: {
+            size_t shard = ceil_div(c, shards);
+            plan.compute_us = reduce(k.deserialize + k.add, shard) + k.serialize;
+            if (shards > 1) {
+                plan.compute_us += reduce(k.deserialize + k.add, shards);
+                ParameterReport report = profiles::report(profile, ckks);
+                double bytes_per_us = options.network_mbps / 8;
+                plan.transfer_us = static_cast<double>((c + shards) * report.ciphertext_bytes) / bytes_per_us +
+                                   options.round_trip_ms * 1000;
+                plan.execution = "distributed";
+                plan.shards = shards;
+            }
+            if (request.operation == PlanOperation::mean && ckks) plan.compute_us += k.multiply_plain + k.rescale;
+            if (packed) {
+                plan.compute_us += slot_fold;
+                plan.rotation = "slot_fold";
+                plan.rotations = fold;
+            }
+            break;
+        }
+        case PlanOperation::variance:
+            plan.compute_us = reduce(k.deserialize + 2 * k.add + k.multiply, c) + k.relinearize + k.rescale +
+                              2 * k.serialize;
+            if (packed) {
+                plan.compute_us += 2 * slot_fold;
+                plan.rotation = "slot_fold";
+                plan.rotations = 2 * fold;
+            }
+            break;
+        case PlanOperation::group_by: {
+            // Every group is a weighted sum of all operands folded into its slot, in parallel over groups
+            double group = static_cast<double>(c) * (k.multiply_plain + k.add) + slot_fold + k.multiply_plain +
+                           k.rescale;
+            plan.compute_us = spread(k.deserialize, c) + spread(group, request.groups) +
+                              static_cast<double>(request.groups) * k.add + k.serialize;
+            plan.rotation = "slot_fold";
+            plan.rotations = request.groups * fold;
+            break;
+        }
+        case PlanOperation::linear_model: {
+            size_t steps = log2_ceil(block);
+            double per = k.deserialize + k.multiply_plain + k.rescale +
+                         static_cast<double>(steps) * (k.rotate + k.add) + k.serialize;
+            plan.compute_us = spread(per, c);
+            plan.rotation = steps ? "block_fold" : "none";
+            plan.rotations = c * steps;
+            break;
+        }
+    }
+    plan.estimated_us = plan.compute_us + plan.transfer_us;
+    return plan;
+}
@@ -0,0 +1,146 @@
+#ifndef QUERY_PLANNER_H
+#define QUERY_PLANNER_H
+
+#include "ParameterProfile.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class HomomorphicEncryption;
+
+// Microseconds per ciphertext operation at one profile and scheme
+struct OperationCosts {
+    double add = 0;
+    double multiply_plain = 0;
+    double multiply = 0;        // Ciphertext x ciphertext, before relinearization
+    double relinearize = 0;
+    double rotate = 0;          // One key switch
+    double rescale = 0;         // CKKS only
+    double serialize = 0;       // Uncompressed save of a fresh ciphertext
+    double deserialize = 0;
+};
+
+/**
+ * Per-operation costs of the default profile, scaled to other profiles
+ *
+ * calibrate() times each operation per scheme on a throwaway key set over
+ * the engines' contexts, the way the he-bench microbenchmarks do, in a few
+ * hundred milliseconds at startup. nominal() is the fallback without
+ * measurements: typical timings of the default profile on one x86 core.
+ * Other profiles scale by profiles::report(): additions, plaintext products,
+ * rescaling and serialization with N * L, ciphertext products with the
+ * report's multiply cost, relinearization and rotations with its key switch
+ * cost.
+ */
+class CostModel {
+public:
+    static CostModel nominal();
+
+    /**
+     * @param bfv, ckks Engines of the default profile (only their contexts are used)
+     * @param repetitions Timings per operation; the median is kept
+     */
+    static CostModel calibrate(const HomomorphicEncryption& bfv, const HomomorphicEncryption& ckks,
+                               size_t repetitions = 7);
+
+    OperationCosts at(const ParameterProfile& profile, bool use_ckks) const;
+    const OperationCosts& base(bool use_ckks) const { return costs[use_ckks ? 1 : 0]; }
+    bool calibrated() const { return measured; }
+
+private:
+    OperationCosts costs[2];  // BFV, CKKS at the default profile
+    bool measured = false;
+};
+
+enum class PlanOperation { sum, mean, variance, group_by, linear_model };
+
+/**
+ * API names "sum", "mean", "variance", "group_by" and "linear_model"
+ * @throws std::invalid_argument for other names
+ */
+PlanOperation parse_plan_operation(const std::string& name);
+const char* plan_operation_name(PlanOperation operation);
+
+// An encrypted computation and the size of its data, for QueryPlanner::plan()
+struct PlanRequest {
+    PlanOperation operation = PlanOperation::sum;
+    bool use_ckks = false;
+    size_t rows = 0;                          // Values (patients for linear_model)
+    size_t features = 1;                      // linear_model: weights per patient
+    size_t groups = 1;                        // group_by
+    const ParameterProfile* profile = nullptr;  // Fixed (data already encrypted); else chosen
+    int packed = -1;                          // 0 / 1 fixes the layout (sum, mean, variance, group_by); -1 chooses
+    size_t ciphertexts = 0;                   // Given instead of derived from rows, with a fixed layout
+    size_t workers = 0;                       // Cluster workers a sum may be distributed over
+};
+
+/**
+ * How to run a computation, and what it is predicted to cost
+ *
+ * packing: "per_value" (one value per ciphertext), "packed" (slots filled
+ * in order) or, for linear_model, "sample_major" / "feature_major" (see
+ * PatientPacking.h). rotation: "none", "slot_fold" (sum_slots) or
+ * "block_fold" (sum_blocks). execution: "local" or "distributed" over shards
+ * workers (sums only, as /binary/cluster/csv/sum runs them).
+ */
+struct Plan {
+    PlanOperation operation = PlanOperation::sum;
+    bool use_ckks = false;
+    std::string profile;
+    size_t depth = 0;            // Multiplicative depth the operation needs
+    std::string packing;
+    size_t ciphertexts = 0;
+    std::string rotation = "none";
+    size_t rotations = 0;        // Rotations in all
+    std::string execution = "local";
+    size_t shards = 1;
+    double compute_us = 0;
+    double transfer_us = 0;      // Shipping operands to and results from workers
+    double estimated_us = 0;
+    bool calibrated = false;
+};
+
+/**
+ * Picks packing, parameters, rotations and local or distributed execution
+ * for an encrypted computation from CostModel's per-operation costs
+ *
+ * Every combination of the built-in profiles deep enough for the operation
+ * (or the fixed one), the layouts it allows and the execution modes is
+ * costed by counting its operations: deserializing the operands, the
+ * reduction over them spread over the compute threads, the rotations and
+ * the serialized result. Distributed sums add the transfer of the operands
+ * and partial results at network_mbps and one round trip per call. The
+ * cheapest plan wins; alternatives() lists all of them.
+ *
+ * Plans are estimates for the evaluation alone (not the HTTP, JSON or Base64
+ * work around it). Thread-safe once built.
+ */
+class QueryPlanner {
+public:
+    struct Options {
+        size_t compute_threads = 1;
+        double network_mbps = 1000;
+        double round_trip_ms = 2;
+    };
+
+    QueryPlanner(CostModel model, Options options);
+
+    /**
+     * @throws std::invalid_argument for no rows, no profile deep enough or a fixed
+     *         profile too shallow or too small for the operation
+     */
+    Plan plan(const PlanRequest& request) const;
+    // Every plan considered, cheapest first
+    std::vector<Plan> alternatives(const PlanRequest& request) const;
+
+    const CostModel& cost_model() const { return model; }
+
+private:
+    CostModel model;
+    Options options;
+
+    Plan cost(const PlanRequest& request, const ParameterProfile& profile, const std::string& packing,
+              size_t shards) const;
+};
+
+#endif // QUERY_PLANNER_H
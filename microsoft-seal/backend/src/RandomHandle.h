@@ -0,0 +1,28 @@
+#ifndef RANDOM_HANDLE_H
+#define RANDOM_HANDLE_H
+
+#include "seal/randomgen.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * 128 random bits as 32 lowercase hex digits, from the operating system's
+ * CSPRNG (seal::random_bytes: /dev/urandom, or BCryptGenRandom on Windows)
+ *
+ * For the handles and IDs that are the only access control of what they name
+ * (stored columns, jobs, refresh masks, shared memory regions, ...): seeing
+ * any number of them tells nothing about the others. A seeded generator such
+ * as std::mt19937_64 would not do: its state can be recovered from outputs.
+ * Thread-safe.
+ */
+inline std::string random_handle() {
+    uint64_t words[2];
+    seal::random_bytes(reinterpret_cast<seal::seal_byte*>(words), sizeof(words));
+    char text[33];
+    std::snprintf(text, sizeof(text), "%016llx%016llx", static_cast<unsigned long long>(words[0]),
+                  static_cast<unsigned long long>(words[1]));
+    return std::string(text);
+}
+
+#endif // RANDOM_HANDLE_H
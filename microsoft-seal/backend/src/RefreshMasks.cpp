@@ -0,0 +1,53 @@
+/**
+ * RefreshMasks.cpp
+ *
+ * Bookkeeping of the masks of ciphertexts out for a client-assisted refresh.
+ */
+
+#include "RefreshMasks.h"
+#include "RandomHandle.h"  // For refresh IDs
+#include <iterator>       // For std::prev
+#include <stdexcept>      // For std::out_of_range
+#include <utility>        // For std::move
+
+RefreshMasks::RefreshMasks(size_t max_pending, std::chrono::seconds ttl) : max_pending(max_pending), ttl(ttl) {}
+
+/**
+ * Random 128-bit ID in hex (see random_handle): it is all a caller needs to
+ * redeem the masked ciphertexts; the oldest refreshes are dropped to stay
+ * within max_pending
+ */
+std::string RefreshMasks::put(Pending pending) {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!by_age.empty() && by_age.size() >= max_pending) erase(entries.find(by_age.front()));
+
+    std::string id;
+    do {
+        id = random_handle();
+    } while (entries.count(id));
+    by_age.push_back(id);
+    entries.emplace(id, Entry{std::move(pending), Clock::now(), std::prev(by_age.end())});
+    return id;
+}
+
+RefreshMasks::Pending RefreshMasks::take(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(id);
+    if (found == entries.end()) throw std::out_of_range("Unknown refresh ID: " + id);
+    const bool expired = Clock::now() - found->second.created > ttl;
+    Pending pending = std::move(found->second.pending);
+    erase(found);
+    if (expired) throw std::out_of_range("Refresh " + id + " expired");
+    return pending;
+}
+
+size_t RefreshMasks::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+// Called with the mutex held
+void RefreshMasks::erase(std::unordered_map<std::string, Entry>::iterator entry) {
+    by_age.erase(entry->second.order);
+    entries.erase(entry);
+}
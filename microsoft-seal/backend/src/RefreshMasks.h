@@ -0,0 +1,68 @@
+#ifndef REFRESH_MASKS_H
+#define REFRESH_MASKS_H
+
+#include "seal/randomgen.h"
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Masks of ciphertexts out for a client-assisted refresh, by refresh ID
+ *
+ * A ciphertext that has used up its levels goes to the key holder to be
+ * decrypted and encrypted afresh, instead of the profile being made deep
+ * enough (or bootstrapped) for the whole computation. The server first adds
+ * a random mask (HomomorphicEncryption::add_refresh_mask), so the key holder
+ * only sees values + mask, and subtracts it from the fresh ciphertexts it
+ * gets back (remove_refresh_mask). A batch's masks are generated from one
+ * seed, so only the seed is kept here, not the masks themselves.
+ *
+ * Each refresh is taken once. The oldest are dropped beyond max_pending, and
+ * any older than ttl are refused, so a key holder that never answers leaves
+ * nothing behind. Thread-safe.
+ */
+class RefreshMasks {
+public:
+    struct Pending {
+        seal::prng_seed_type seed{};
+        size_t count = 0;       // Ciphertexts of the batch
+        double bound = 0.0;     // CKKS: masks are uniform in [-bound, bound]
+        std::string scheme;
+        std::string profile;
+    };
+
+    RefreshMasks(size_t max_pending, std::chrono::seconds ttl);
+
+    // Keep a batch's mask, returning its refresh ID
+    std::string put(Pending pending);
+
+    /**
+     * Remove and return a batch's mask
+     * @throws std::out_of_range for unknown, already taken or expired IDs
+     */
+    Pending take(const std::string& id);
+
+    size_t size() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Entry {
+        Pending pending;
+        Clock::time_point created;
+        std::list<std::string>::iterator order;
+    };
+
+    const size_t max_pending;
+    const std::chrono::seconds ttl;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> by_age;  // Oldest first
+
+    void erase(std::unordered_map<std::string, Entry>::iterator entry);
+};
+
+#endif // REFRESH_MASKS_H
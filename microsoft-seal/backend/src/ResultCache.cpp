@@ -0,0 +1,207 @@
+#include "ResultCache.h"
+#include "Metrics.h"
+#include "seal/util/blake2.h"
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+    metrics::Counter& lookups(const char* result) {
+        return metrics::counter("he_result_cache_total", "Cached response lookups by result", {{"result", result}});
+    }
+}
+
+// A computation in flight; guarded by the cache's mutex
+struct ResultCache::Flight::Pending {
+    std::condition_variable done_signal;
+    bool done = false;
+    std::shared_ptr<const Result> result;  // nullptr if the claim was dropped
+};
+
+ResultCache::Flight& ResultCache::Flight::operator=(Flight&& other) noexcept {
+    if (this != &other) {
+        release(nullptr);
+        cache = other.cache;
+        key = other.key;
+        tenant = std::move(other.tenant);
+        started = other.started;
+        pending = std::move(other.pending);
+        other.cache = nullptr;
+    }
+    return *this;
+}
+
+void ResultCache::Flight::complete(Result result) {
+    if (!cache) return;
+    size_t bytes = result.body.size();
+    for (const auto& header : result.headers) bytes += header.first.size() + header.second.size();
+    bool keep = result.status == 200;
+    auto shared = std::make_shared<const Result>(std::move(result));
+    if (keep) cache->insert(*this, shared, bytes);
+    release(std::move(shared));
+}
+
+// Wake the waiting requests and give up the claim
+void ResultCache::Flight::release(std::shared_ptr<const Result> result) {
+    if (!cache) return;
+    {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        pending->done = true;
+        pending->result = std::move(result);
+        auto running = cache->in_flight.find(key);
+        if (running != cache->in_flight.end() && running->second == pending) cache->in_flight.erase(running);
+    }
+    pending->done_signal.notify_all();
+    pending.reset();
+    cache = nullptr;
+}
+
+ResultCache::ResultCache(size_t capacity_bytes, bool coalesce) : capacity_bytes(capacity_bytes), coalesce(coalesce) {}
+
+ResultCache::Digest ResultCache::digest(std::initializer_list<std::string_view> parts) {
+    Digest out;
+    blake2b_state state;
+    if (blake2b_init(&state, out.size()) != 0) throw std::runtime_error("BLAKE2b initialization failed");
+    for (std::string_view part : parts) {
+        uint64_t size = part.size();
+        blake2b_update(&state, &size, sizeof(size));
+        blake2b_update(&state, part.data(), part.size());
+    }
+    blake2b_final(&state, out.data(), out.size());
+    return out;
+}
+
+std::shared_ptr<const ResultCache::Result> ResultCache::find(const Digest& key, Flight& flight, bool* coalesced,
+                                                             const std::string& tenant) {
+    static metrics::Counter& hits = lookups("hit");
+    static metrics::Counter& misses = lookups("miss");
+    static metrics::Counter& joined = lookups("coalesced");
+    if (coalesced) *coalesced = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        auto found = index.find(key);
+        if (found != index.end()) {
+            lru.splice(lru.begin(), lru, found->second);
+            found->second->used = MemoryBudget::Clock::now();
+            hits.add();
+            return found->second->result;
+        }
+        if (!coalesce) break;
+
+        auto running = in_flight.find(key);
+        if (running == in_flight.end()) break;
+        std::shared_ptr<Flight::Pending> pending = running->second;
+        pending->done_signal.wait(lock, [&] { return pending->done; });
+        if (pending->result) {
+            joined.add();
+            if (coalesced) *coalesced = true;
+            return pending->result;
+        }
+        // The computation was abandoned; look again, and claim it if no one else has
+    }
+
+    misses.add();
+    flight.cache = this;
+    flight.key = key;
+    flight.tenant = tenant;
+    flight.started = MemoryBudget::Clock::now();
+    flight.pending = std::make_shared<Flight::Pending>();
+    if (coalesce) in_flight.emplace(key, flight.pending);
+    return nullptr;
+}
+
+void ResultCache::insert(const Flight& flight, std::shared_ptr<const Result> result, size_t bytes) {
+    const auto now = MemoryBudget::Clock::now();
+    const double elapsed_us = std::chrono::duration<double, std::micro>(now - flight.started).count();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bytes > capacity_bytes || index.count(flight.key)) return;
+    evict_to(capacity_bytes - bytes);
+    lru.push_front(Entry{flight.key, std::move(result), bytes, flight.tenant, elapsed_us, now});
+    index.emplace(flight.key, lru.begin());
+    used_bytes += bytes;
+    compute_us += elapsed_us;
+}
+
+void ResultCache::evict_to(size_t bytes) {
+    static metrics::Counter& evictions = lookups("eviction");
+    while (used_bytes > bytes && !lru.empty()) {
+        erase(std::prev(lru.end()));
+        evictions.add();
+    }
+}
+
+// Called with the mutex held
+void ResultCache::erase(std::list<Entry>::const_iterator entry) {
+    index.erase(entry->key);
+    used_bytes -= entry->bytes;
+    compute_us -= entry->compute_us;
+    lru.erase(entry);
+}
+
+/**
+ * The least recently used entry, of the tenant if given (lru.end() if none)
+ * Called with the mutex held
+ */
+std::list<ResultCache::Entry>::const_iterator ResultCache::oldest(const std::string* tenant) const {
+    for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
+        if (!tenant || it->tenant == *tenant) return std::prev(it.base());
+    }
+    return lru.end();
+}
+
+size_t ResultCache::size_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used_bytes;
+}
+
+size_t ResultCache::entries() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+MemoryBudget::Usage ResultCache::budget_usage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return MemoryBudget::Usage{lru.size(), used_bytes, compute_us};
+}
+
+std::map<std::string, size_t> ResultCache::tenant_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, size_t> bytes;
+    for (const Entry& entry : lru) {
+        if (!entry.tenant.empty()) bytes[entry.tenant] += entry.bytes;
+    }
+    return bytes;
+}
+
+bool ResultCache::eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = oldest(tenant);
+    if (entry == lru.end()) return false;
+    candidate = MemoryBudget::Candidate{entry->used, entry->bytes, entry->compute_us};
+    return true;
+}
+
+bool ResultCache::evict(const std::string* tenant, MemoryBudget::Candidate& evicted) {
+    static metrics::Counter& evictions = lookups("eviction");
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = oldest(tenant);
+    if (entry == lru.end()) return false;
+    evicted = MemoryBudget::Candidate{entry->used, entry->bytes, entry->compute_us};
+    erase(entry);
+    evictions.add();
+    return true;
+}
+
+MemoryBudget::Usage ResultCache::expire(MemoryBudget::Clock::time_point before) {
+    static metrics::Counter& expirations = lookups("expired");
+    std::lock_guard<std::mutex> lock(mutex);
+    MemoryBudget::Usage expired;
+    while (!lru.empty() && lru.back().used < before) {
+        expired.entries++;
+        expired.bytes += lru.back().bytes;
+        expired.rebuild_us += lru.back().compute_us;
+        erase(std::prev(lru.end()));
+        expirations.add();
+    }
+    return expired;
+}
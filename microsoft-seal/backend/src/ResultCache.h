@@ -0,0 +1,141 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "MemoryBudget.h"
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Content-addressed cache of complete responses, bounded by their bytes,
+ * with coalescing of identical requests in flight
+ *
+ * Evaluating the same operation on the same ciphertexts gives the same
+ * result, so a response can be replayed for any later request that names
+ * the same operation and parameters and carries the same ciphertext bytes.
+ * Entries are keyed by a BLAKE2b-256 digest of those (see digest()); the
+ * digest is the only thing compared, which at 256 bits is as good as
+ * comparing the requests in full.
+ *
+ * A request missing the cache while an identical one is being computed
+ * waits for that computation and shares its response (any response, errors
+ * included: the same request would fail the same way) instead of repeating
+ * it. Hits, misses, coalesced requests and evictions are exported as
+ * he_result_cache_total{result=...}.
+ *
+ * Entries remember the tenant whose request made them and how long computing
+ * the response took, so under a MemoryBudget they count against the tenant's
+ * quota and a costly response outlives a cheap one.
+ *
+ * Thread-safe.
+ */
+class ResultCache : public MemoryBudget::Consumer {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    struct Result {
+        int status = 200;
+        std::string body;
+        std::vector<std::pair<std::string, std::string>> headers;
+    };
+
+    /**
+     * A request's claim on computing the response for its key, see find()
+     *
+     * Requests waiting on the claim get the response passed to complete();
+     * if the claim is dropped without one (e.g. the computation threw), the
+     * next of them computes it instead.
+     */
+    class Flight {
+    public:
+        Flight() = default;
+        Flight(Flight&& other) noexcept { *this = std::move(other); }
+        Flight& operator=(Flight&& other) noexcept;
+        ~Flight() { release(nullptr); }
+
+        // Hand the response to the waiting requests and, if it is a 200, keep it
+        void complete(Result result);
+
+    private:
+        friend class ResultCache;
+        struct Pending;
+
+        ResultCache* cache = nullptr;
+        Digest key{};
+        std::string tenant;
+        MemoryBudget::Clock::time_point started;
+        std::shared_ptr<Pending> pending;
+
+        void release(std::shared_ptr<const Result> result);
+    };
+
+    /**
+     * @param capacity_bytes Bytes of responses kept; 0 keeps none (requests are still coalesced)
+     * @param coalesce Whether identical concurrent requests share one computation
+     */
+    explicit ResultCache(size_t capacity_bytes = 0, bool coalesce = true);
+
+    // BLAKE2b-256 of the parts, each prefixed with its length so that part boundaries count
+    static Digest digest(std::initializer_list<std::string_view> parts);
+
+    /**
+     * The response kept for the key, or that of an identical request in flight
+     * (waiting for it to complete), or nullptr with flight set to this
+     * caller's claim on computing it
+     *
+     * @param flight Empty claim, e.g. a default-constructed one
+     * @param coalesced Set to whether the response came from a request in flight
+     * @param tenant Tenant the response is kept for, if it is computed here ("" = the server)
+     */
+    std::shared_ptr<const Result> find(const Digest& key, Flight& flight, bool* coalesced = nullptr,
+                                       const std::string& tenant = "");
+
+    // Whether find() can return anything; if not, requests need not be hashed at all
+    bool enabled() const { return capacity_bytes > 0 || coalesce; }
+    size_t capacity() const { return capacity_bytes; }
+    size_t size_bytes() const;
+    size_t entries() const;
+
+    // MemoryBudget::Consumer
+    MemoryBudget::Usage budget_usage() const override;
+    std::map<std::string, size_t> tenant_bytes() const override;
+    bool eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const override;
+    bool evict(const std::string* tenant, MemoryBudget::Candidate& evicted) override;
+    MemoryBudget::Usage expire(MemoryBudget::Clock::time_point before) override;
+
+private:
+    struct Entry {
+        Digest key;
+        std::shared_ptr<const Result> result;
+        size_t bytes;
+        std::string tenant;
+        double compute_us;
+        MemoryBudget::Clock::time_point used;
+    };
+
+    mutable std::mutex mutex;
+    const size_t capacity_bytes;
+    const bool coalesce;
+    size_t used_bytes = 0;
+    double compute_us = 0;  // Of the entries
+    std::list<Entry> lru;  // Most recently used first
+    std::map<Digest, std::list<Entry>::iterator> index;
+    std::map<Digest, std::shared_ptr<Flight::Pending>> in_flight;
+
+    void insert(const Flight& flight, std::shared_ptr<const Result> result, size_t bytes);
+    void evict_to(size_t bytes);
+    void erase(std::list<Entry>::const_iterator entry);
+    std::list<Entry>::const_iterator oldest(const std::string* tenant) const;
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,208 @@
+#include "RollupCube.h"
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+    // Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil)
+    int64_t days_from_civil(int64_t year, unsigned month, unsigned day) {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+        const unsigned day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+        return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+    }
+
+    void civil_from_days(int64_t days, int64_t& year, unsigned& month, unsigned& day) {
+        days += 719468;
+        const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const unsigned day_of_era = static_cast<unsigned>(days - era * 146097);
+        const unsigned year_of_era =
+            (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+        const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        const unsigned shifted_month = (5 * day_of_year + 2) / 153;
+        day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+        month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+        year = static_cast<int64_t>(year_of_era) + era * 400 + (month <= 2);
+    }
+
+    // Digits of date[begin, begin + length), or -1 if any is not a digit
+    int digits(const std::string& date, size_t begin, size_t length) {
+        if (date.size() < begin + length) return -1;
+        int value = 0;
+        for (size_t i = begin; i < begin + length; i++) {
+            if (date[i] < '0' || date[i] > '9') return -1;
+            value = value * 10 + (date[i] - '0');
+        }
+        return value;
+    }
+}
+
+RollupGranularity parse_rollup_granularity(const std::string& name) {
+    if (name == "day") return RollupGranularity::day;
+    if (name == "month") return RollupGranularity::month;
+    if (name == "year") return RollupGranularity::year;
+    throw std::invalid_argument("Unknown granularity: " + name + " (day, month, year)");
+}
+
+const char* rollup_granularity_name(RollupGranularity granularity) {
+    switch (granularity) {
+        case RollupGranularity::day: return "day";
+        case RollupGranularity::month: return "month";
+        default: return "year";
+    }
+}
+
+RollupLayout::RollupLayout(RollupGranularity granularity, int origin_year, std::vector<std::string> categories,
+                           size_t slots)
+    : granularity_(granularity), origin(origin_year), names(std::move(categories)), slots(slots) {
+    if (slots == 0) throw std::invalid_argument("Rollup layout needs slots");
+    for (size_t i = 0; i < names.size(); i++) {
+        if (!indices.emplace(names[i], i).second) throw std::invalid_argument("Repeated category: " + names[i]);
+    }
+}
+
+size_t RollupLayout::period(const std::string& date) const {
+    const int year = digits(date, 0, 4);
+    const bool has_month = date.size() > 4;
+    const bool has_day = date.size() > 7;
+    const int month = has_month && date[4] == '-' ? digits(date, 5, 2) : (has_month ? -1 : 1);
+    const int day = has_day && date[7] == '-' ? digits(date, 8, 2) : (has_day ? -1 : 1);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31 ||
+        (granularity_ == RollupGranularity::day && !has_day) ||
+        (granularity_ == RollupGranularity::month && !has_month)) {
+        throw std::invalid_argument("Expected a date YYYY-MM-DD, got " + date);
+    }
+    if (year < origin) throw std::invalid_argument("Date " + date + " is before the origin year");
+
+    switch (granularity_) {
+        case RollupGranularity::year:
+            return static_cast<size_t>(year - origin);
+        case RollupGranularity::month:
+            return static_cast<size_t>(year - origin) * 12 + static_cast<size_t>(month - 1);
+        default: {
+            const int64_t days = days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+            int64_t check_year;
+            unsigned check_month, check_day;
+            civil_from_days(days, check_year, check_month, check_day);
+            if (check_day != static_cast<unsigned>(day)) throw std::invalid_argument("No such date: " + date);
+            return static_cast<size_t>(days - days_from_civil(origin, 1, 1));
+        }
+    }
+}
+
+std::string RollupLayout::label(size_t period) const {
+    char text[32];
+    switch (granularity_) {
+        case RollupGranularity::year:
+            std::snprintf(text, sizeof(text), "%04lld", static_cast<long long>(origin + static_cast<int64_t>(period)));
+            break;
+        case RollupGranularity::month:
+            std::snprintf(text, sizeof(text), "%04lld-%02u",
+                          static_cast<long long>(origin + static_cast<int64_t>(period / 12)),
+                          static_cast<unsigned>(period % 12 + 1));
+            break;
+        default: {
+            int64_t year;
+            unsigned month, day;
+            civil_from_days(days_from_civil(origin, 1, 1) + static_cast<int64_t>(period), year, month, day);
+            std::snprintf(text, sizeof(text), "%04lld-%02u-%02u", static_cast<long long>(year), month, day);
+        }
+    }
+    return text;
+}
+
+size_t RollupLayout::category(const std::string& name) const {
+    if (names.empty()) return 0;
+    auto found = indices.find(name);
+    if (found == indices.end()) throw std::invalid_argument("Unknown category: " + name);
+    return found->second;
+}
+
+std::map<size_t, RollupLayout::Cell> RollupLayout::aggregate(const std::vector<double>& values,
+                                                             const std::vector<std::string>& dates,
+                                                             const std::vector<std::string>& categories) const {
+    if (dates.size() != values.size() || (!names.empty() && categories.size() != values.size())) {
+        throw std::invalid_argument("Expected a date" + std::string(names.empty() ? "" : " and a category") +
+                                    " for every value");
+    }
+    std::map<size_t, Cell> cells;
+    for (size_t i = 0; i < values.size(); i++) {
+        Cell& cell = cells[this->cell(period(dates[i]), names.empty() ? 0 : category(categories[i]))];
+        cell.sum += values[i];
+        cell.count++;
+    }
+    return cells;
+}
+
+size_t RollupCube::chunk_count() const {
+    return chunks.size();
+}
+
+uint64_t RollupCube::row_count() const {
+    uint64_t total = 0;
+    for (const auto& count : counts) total += count.second;
+    return total;
+}
+
+void RollupCube::add(const HomomorphicEncryption& he, size_t chunk, seal::Ciphertext totals) {
+    auto found = chunks.find(chunk);
+    if (found == chunks.end()) {
+        chunks.emplace(chunk, std::move(totals));
+    } else {
+        he.add_inplace(found->second, totals);
+    }
+}
+
+void RollupCube::add_count(size_t cell, uint64_t count) {
+    counts[cell] += count;
+}
+
+/**
+ * Only the chunks holding the range's cells, and of those only the ones
+ * rows have reached, go into masked_sums; the masks cover their slots back
+ * to back
+ */
+RollupCube::Plan RollupCube::plan(size_t first, size_t last, const std::vector<size_t>& categories,
+                                  GroupBy group_by) const {
+    if (first > last) throw std::invalid_argument("Empty period range");
+    const size_t category_count = layout_.category_count();
+    std::vector<size_t> selected = categories;
+    if (selected.empty()) {
+        for (size_t c = 0; c < category_count; c++) selected.push_back(c);
+    }
+
+    Plan plan;
+    if (group_by == GroupBy::period) {
+        for (size_t p = first; p <= last; p++) plan.groups.push_back(layout_.label(p));
+    } else if (group_by == GroupBy::category) {
+        for (size_t c : selected) plan.groups.push_back(layout_.categories().empty() ? "" : layout_.categories()[c]);
+    } else {
+        plan.groups.push_back("");
+    }
+    if (plan.groups.size() > layout_.slot_count()) throw std::invalid_argument("More groups than slots");
+    plan.row_counts.assign(plan.groups.size(), 0);
+
+    const size_t slots = layout_.slot_count();
+    std::map<size_t, size_t> positions;  // Chunk -> its index in plan.chunks
+    for (auto it = chunks.lower_bound(layout_.cell(first, 0) / slots);
+         it != chunks.end() && it->first <= layout_.cell(last, category_count - 1) / slots; ++it) {
+        positions.emplace(it->first, plan.chunks.size());
+        plan.chunks.push_back(it->second);
+    }
+    if (plan.chunks.empty()) throw std::invalid_argument("No rows in the period range");
+
+    plan.masks.assign(plan.groups.size(), std::vector<double>(plan.chunks.size() * slots, 0.0));
+    for (size_t p = first; p <= last; p++) {
+        for (size_t s = 0; s < selected.size(); s++) {
+            const size_t cell = layout_.cell(p, selected[s]);
+            auto position = positions.find(cell / slots);
+            if (position == positions.end()) continue;
+            const size_t group = group_by == GroupBy::period ? p - first : group_by == GroupBy::category ? s : 0;
+            plan.masks[group][position->second * slots + cell % slots] = 1.0;
+            auto count = counts.find(cell);
+            if (count != counts.end()) plan.row_counts[group] += count->second;
+        }
+    }
+    return plan;
+}
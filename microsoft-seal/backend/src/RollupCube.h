@@ -0,0 +1,133 @@
+#ifndef ROLLUP_CUBE_H
+#define ROLLUP_CUBE_H
+
+#include "HomomorphicEncryption.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Pre-aggregated encrypted rollups of a column by date and category, e.g.
+ * Billing Amount by month of Date of Admission and Admission Type
+ *
+ * At ingestion the key holder totals the rows of every (period, category)
+ * cell in plaintext and encrypts the totals packed, one slot per cell
+ * (mini-backend's /rollup/encrypt). Periods are days, months or years
+ * counted from January 1 of an origin year, so a cell's slot depends only
+ * on its date and category and never moves: a batch of new rows is
+ * encrypted the same way and added slot-wise into the cube (incremental
+ * maintenance), new periods simply filling later slots. Dashboard queries
+ * over a date range then total a handful of cells with one masked_sums,
+ * instead of scanning every row. Row counts per cell are public, as the
+ * dates and categories are in /query.
+ */
+enum class RollupGranularity { day, month, year };
+
+/**
+ * API names "day", "month" and "year"
+ * @throws std::invalid_argument for other names
+ */
+RollupGranularity parse_rollup_granularity(const std::string& name);
+const char* rollup_granularity_name(RollupGranularity granularity);
+
+/**
+ * Cells of one granularity: period p and category c at cell p * C + c
+ * (C the category count), held by ciphertext cell / slots in slot cell % slots
+ */
+class RollupLayout {
+public:
+    struct Cell {
+        double sum = 0.0;
+        uint64_t count = 0;
+    };
+
+    /**
+     * @param origin_year Periods count from January 1 of this year
+     * @param categories Values of the category dimension, in slot order (empty: none)
+     * @param slots Slots per ciphertext
+     * @throws std::invalid_argument for repeated categories or no slots
+     */
+    RollupLayout(RollupGranularity granularity, int origin_year, std::vector<std::string> categories, size_t slots);
+
+    RollupGranularity granularity() const { return granularity_; }
+    int origin_year() const { return origin; }
+    const std::vector<std::string>& categories() const { return names; }
+    size_t category_count() const { return names.empty() ? 1 : names.size(); }
+    size_t slot_count() const { return slots; }
+
+    /**
+     * Period of a date: YYYY-MM-DD, anything after the day (e.g. a time) ignored;
+     * YYYY-MM and YYYY also do for month and year periods
+     * @throws std::invalid_argument for malformed dates and dates before the origin
+     */
+    size_t period(const std::string& date) const;
+    // "2024-01-31", "2024-01" or "2024"
+    std::string label(size_t period) const;
+
+    // @throws std::invalid_argument for a category not in the layout
+    size_t category(const std::string& name) const;
+
+    size_t cell(size_t period, size_t category) const { return period * category_count() + category; }
+
+    /**
+     * Totals and row counts of every cell rows fall into
+     * @param categories One per row, or empty if the layout has no categories
+     * @throws std::invalid_argument for lengths that differ from values', or as period() and category()
+     */
+    std::map<size_t, Cell> aggregate(const std::vector<double>& values, const std::vector<std::string>& dates,
+                                     const std::vector<std::string>& categories) const;
+
+private:
+    RollupGranularity granularity_;
+    int origin;
+    std::vector<std::string> names;
+    std::map<std::string, size_t> indices;
+    size_t slots;
+};
+
+/**
+ * Encrypted cell totals and public row counts of one layout
+ *
+ * Not thread-safe; main-backend serializes appends and queries per rollup.
+ */
+class RollupCube {
+public:
+    enum class GroupBy { none, period, category };
+
+    // Cells a query totals: masked_sums(chunks, masks) puts group g's total in slot g
+    struct Plan {
+        std::vector<std::string> groups;  // Period labels, categories, or one ""
+        std::vector<uint64_t> row_counts;
+        std::vector<seal::Ciphertext> chunks;
+        std::vector<std::vector<double>> masks;
+    };
+
+    explicit RollupCube(RollupLayout layout) : layout_(std::move(layout)) {}
+
+    const RollupLayout& layout() const { return layout_; }
+    size_t chunk_count() const;
+    uint64_t row_count() const;
+
+    /**
+     * Add the encrypted totals of one ciphertext's cells, fresh from encryption, into the cube
+     * @throws std::invalid_argument if they do not match the chunk held (level, scale)
+     */
+    void add(const HomomorphicEncryption& he, size_t chunk, seal::Ciphertext totals);
+    void add_count(size_t cell, uint64_t count);
+
+    /**
+     * The cells of periods first .. last (inclusive) and the given categories (empty: all)
+     * @throws std::invalid_argument if no row falls into them, or for more groups than slots
+     */
+    Plan plan(size_t first, size_t last, const std::vector<size_t>& categories, GroupBy group_by) const;
+
+private:
+    RollupLayout layout_;
+    std::map<size_t, seal::Ciphertext> chunks;  // Those rows have reached
+    std::map<size_t, uint64_t> counts;          // By cell
+};
+
+#endif // ROLLUP_CUBE_H
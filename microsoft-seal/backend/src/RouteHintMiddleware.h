@@ -0,0 +1,68 @@
+#ifndef ROUTE_HINT_MIDDLEWARE_H
+#define ROUTE_HINT_MIDDLEWARE_H
+
+#include "crow.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Consistent-hash routing hints for stateless main-backend replicas behind a
+ * load balancer (--store-shared-dir)
+ *
+ * Every replica serves every column, but the one that served a column last
+ * has it in memory. Responses that create a column name it in an
+ * "X-HE-Route-Key" header; clients send that header with every later request
+ * for the column, and a load balancer hashing on it consistently (HAProxy
+ * "balance hdr(X-HE-Route-Key)" with "hash-type consistent", nginx
+ * "hash $http_x_he_route_key consistent") keeps each column on one replica.
+ * With the replica list (--replicas) responses also carry "X-HE-Replica", the
+ * replica the key belongs to by rendezvous hashing, for clients that pick
+ * replicas themselves. Adding a replica moves only the keys it wins.
+ */
+struct RouteHintMiddleware {
+    struct context {};
+
+    static constexpr const char* header = "X-HE-Route-Key";
+
+    std::vector<std::string> replicas;  // host:port of every replica, the same list on each
+
+    // The replica a key belongs to: the one whose hash with the key is highest
+    static const std::string& owner(const std::vector<std::string>& replicas, const std::string& key) {
+        size_t best = 0;
+        uint64_t best_score = 0;
+        for (size_t i = 0; i < replicas.size(); i++) {
+            uint64_t score = hash(replicas[i], key);
+            if (i == 0 || score > best_score) {
+                best = i;
+                best_score = score;
+            }
+        }
+        return replicas[best];
+    }
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {}
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (replicas.empty()) return;
+        std::string key = res.get_header_value(header);
+        if (key.empty()) key = req.get_header_value(header);
+        if (!key.empty()) res.set_header("X-HE-Replica", owner(replicas, key));
+    }
+
+private:
+    // FNV-1a over both strings, then the SplitMix64 finalizer to spread similar inputs
+    static uint64_t hash(const std::string& replica, const std::string& key) {
+        uint64_t h = 14695981039346656037ull;
+        for (char c : replica) h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+        h = (h ^ 0xFF) * 1099511628211ull;  // Separator no host name contains
+        for (char c : key) h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebull;
+        return h ^ (h >> 31);
+    }
+};
+
+#endif // ROUTE_HINT_MIDDLEWARE_H
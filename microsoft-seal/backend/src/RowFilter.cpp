@@ -0,0 +1,92 @@
+/**
+ * RowFilter.cpp
+ *
+ * Predicates on public columns, evaluated to row masks for filtered aggregates.
+ */
+
+#include "RowFilter.h"
+#include <algorithm>      // For std::any_of
+#include <cstdlib>        // For std::strtod
+#include <stdexcept>      // For std::invalid_argument
+#include <utility>        // For std::move
+
+namespace {
+    // Whether text is a complete number, stored in value
+    bool parse_number(const std::string& text, double& value) {
+        if (text.empty()) return false;
+        char* end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+        return end == text.c_str() + text.size();
+    }
+}
+
+int compare_cells(const std::string& a, const std::string& b) {
+    double x, y;
+    if (parse_number(a, x) && parse_number(b, y)) return (x > y) - (x < y);
+    return a.compare(b);
+}
+
+PredicateOp parse_predicate_op(const std::string& name) {
+    if (name == "eq") return PredicateOp::eq;
+    if (name == "ne") return PredicateOp::ne;
+    if (name == "lt") return PredicateOp::lt;
+    if (name == "le") return PredicateOp::le;
+    if (name == "gt") return PredicateOp::gt;
+    if (name == "ge") return PredicateOp::ge;
+    if (name == "in") return PredicateOp::in;
+    if (name == "between") return PredicateOp::between;
+    throw std::invalid_argument("Unknown predicate: " + name + " (eq, ne, lt, le, gt, ge, in, between)");
+}
+
+bool Predicate::matches(const std::string& cell) const {
+    switch (op) {
+        case PredicateOp::eq: return compare_cells(cell, values[0]) == 0;
+        case PredicateOp::ne: return compare_cells(cell, values[0]) != 0;
+        case PredicateOp::lt: return compare_cells(cell, values[0]) < 0;
+        case PredicateOp::le: return compare_cells(cell, values[0]) <= 0;
+        case PredicateOp::gt: return compare_cells(cell, values[0]) > 0;
+        case PredicateOp::ge: return compare_cells(cell, values[0]) >= 0;
+        case PredicateOp::in:
+            return std::any_of(values.begin(), values.end(),
+                               [&](const std::string& value) { return compare_cells(cell, value) == 0; });
+        case PredicateOp::between: return compare_cells(cell, values[0]) >= 0 && compare_cells(cell, values[1]) <= 0;
+    }
+    return false;
+}
+
+void PublicColumns::add(const std::string& name, std::vector<std::string> cells) {
+    if (!columns.empty() && cells.size() != rows) {
+        throw std::invalid_argument("Column " + name + " has " + std::to_string(cells.size()) + " rows, not " +
+                                    std::to_string(rows));
+    }
+    rows = cells.size();
+    columns[name] = std::move(cells);
+}
+
+const std::vector<std::string>& PublicColumns::column(const std::string& name) const {
+    auto found = columns.find(name);
+    if (found == columns.end()) throw std::invalid_argument("Unknown public column: " + name);
+    return found->second;
+}
+
+/**
+ * The predicates are checked one column at a time, each clearing the rows
+ * it rejects, rather than row by row
+ */
+std::vector<double> PublicColumns::mask(const RowFilter& filter) const {
+    std::vector<double> result(rows, 1.0);
+    for (const auto& predicate : filter) {
+        auto column = columns.find(predicate.column);
+        if (column == columns.end()) throw std::invalid_argument("Unknown public column: " + predicate.column);
+        const size_t expected = predicate.op == PredicateOp::between ? 2 : 1;
+        if (predicate.op == PredicateOp::in ? predicate.values.empty() : predicate.values.size() != expected) {
+            throw std::invalid_argument("Predicate on " + predicate.column + " expects " +
+                                        (predicate.op == PredicateOp::in ? std::string("at least one value")
+                                                                         : std::to_string(expected) + " value(s)"));
+        }
+        for (size_t row = 0; row < rows; row++) {
+            if (result[row] != 0.0 && !predicate.matches(column->second[row])) result[row] = 0.0;
+        }
+    }
+    return result;
+}
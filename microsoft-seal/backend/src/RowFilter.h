@@ -0,0 +1,69 @@
+#ifndef ROW_FILTER_H
+#define ROW_FILTER_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * WHERE clauses on public (plaintext) columns, e.g. Admission Type or Date
+ * of Admission, evaluated server-side to 0/1 row masks for filtered
+ * aggregates of an encrypted column (HomomorphicEncryption::masked_sums)
+ *
+ * A filter is a conjunction of predicates, fused here into a single mask,
+ * so it costs the encrypted column one plaintext product however many
+ * predicates it has. A cell and a value that both parse completely as
+ * numbers compare as numbers; otherwise they compare as strings, which
+ * orders ISO dates (2024-03-01) correctly.
+ */
+enum class PredicateOp { eq, ne, lt, le, gt, ge, in, between };
+
+/**
+ * API names "eq", "ne", "lt", "le", "gt", "ge", "in" and "between"
+ * @throws std::invalid_argument for other names
+ */
+PredicateOp parse_predicate_op(const std::string& name);
+
+// Negative, zero or positive as cell a orders before, with or after b, by the rules above
+int compare_cells(const std::string& a, const std::string& b);
+
+struct Predicate {
+    std::string column;
+    PredicateOp op = PredicateOp::eq;
+    std::vector<std::string> values;  // One; any number for in; low and high (inclusive) for between
+
+    bool matches(const std::string& cell) const;
+};
+
+// Rows for which every predicate holds (no predicates: every row)
+using RowFilter = std::vector<Predicate>;
+
+class PublicColumns {
+public:
+    /**
+     * @throws std::invalid_argument for a row count other than the columns added before
+     */
+    void add(const std::string& name, std::vector<std::string> cells);
+
+    size_t row_count() const { return rows; }
+
+    /**
+     * Cells of a column, one per row
+     * @throws std::invalid_argument for an unknown column
+     */
+    const std::vector<std::string>& column(const std::string& name) const;
+
+    /**
+     * 0/1 mask with one entry per row
+     * @throws std::invalid_argument for an unknown column or a predicate with
+     *         the wrong number of values
+     */
+    std::vector<double> mask(const RowFilter& filter) const;
+
+private:
+    std::map<std::string, std::vector<std::string>> columns;
+    size_t rows = 0;
+};
+
+#endif // ROW_FILTER_H
@@ -0,0 +1,26 @@
+#ifndef SCRATCH_ARENA_MIDDLEWARE_H
+#define SCRATCH_ARENA_MIDDLEWARE_H
+
+#include "crow.h"
+#include "HomomorphicEncryption.h"
+#include "PoolTrimmer.h"
+
+/**
+ * Resets the handler thread's SEAL scratch arena once a request is answered
+ * (--scratch-arena-mb), so every request starts from one contiguous block.
+ * Compute pool threads keep their arenas between tasks; the arena's free
+ * lists recycle the same blocks there. Each finished request also counts as
+ * activity for the PoolTrimmer's idle detection.
+ */
+struct ScratchArenaMiddleware {
+    struct context {};
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {}
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        HomomorphicEncryption::reset_scratch_arena();
+        PoolTrimmer::activity();
+    }
+};
+
+#endif // SCRATCH_ARENA_MIDDLEWARE_H
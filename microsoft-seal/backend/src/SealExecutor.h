@@ -0,0 +1,78 @@
+#ifndef SEAL_EXECUTOR_H
+#define SEAL_EXECUTOR_H
+
+#include "ThreadPool.h"
+#include "seal/parallel.h"
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Runs SEAL's intra-operation work items (per-RNS-limb NTTs, dyadic products,
+ * key switching, and the components of new relinearization and Galois keys)
+ * on a ThreadPool
+ *
+ * SEAL's calling thread claims work items itself, so it is safe for a task
+ * that already runs on the pool (e.g. one slice of a parallel sum) to fan out
+ * onto the same pool. The pool is held weakly: once it is gone, schedule()
+ * throws and SEAL finishes the work on the calling thread.
+ *
+ * With one pool per NUMA node (--numa), work items go to the pool of the node
+ * the calling thread runs on, so they read that node's key replica locally.
+ */
+class SealExecutor : public seal::ParallelExecutor {
+public:
+    // Index into the pools of the one to use for the calling thread
+    using SelectPool = std::function<size_t()>;
+
+    explicit SealExecutor(const std::shared_ptr<ThreadPool>& pool) : SealExecutor({pool}, [] { return size_t(0); }) {}
+
+    SealExecutor(const std::vector<std::shared_ptr<ThreadPool>>& pools, SelectPool select) : select(std::move(select)) {
+        for (const auto& pool : pools) {
+            this->pools.push_back(pool);
+            threads.push_back(pool->size());
+        }
+    }
+
+    void schedule(std::function<void()> task) override {
+        std::shared_ptr<ThreadPool> current = pools[select()].lock();
+        if (!current) throw std::runtime_error("compute pool stopped");
+        current->post(std::move(task));  // Completion and exceptions are tracked by SEAL
+    }
+
+    size_t concurrency() const override { return threads[select()]; }
+
+    /**
+     * Run SEAL's work items on pool (--rns-parallel-min-coeffs)
+     *
+     * Key generation always splits its key components across the pool, so a
+     * new profile or tenant gets its keys in a fraction of the time.
+     *
+     * @param min_coeffs_per_task Minimum coefficients per task of the
+     *        operations; 0 leaves them sequential
+     */
+    static void install(const std::shared_ptr<ThreadPool>& pool, size_t min_coeffs_per_task) {
+        seal::ParallelExecution::SetExecutor(std::make_shared<SealExecutor>(pool), minimum(min_coeffs_per_task));
+    }
+
+    // Same, with one pool per NUMA node
+    static void install(const std::vector<std::shared_ptr<ThreadPool>>& pools, SelectPool select,
+                        size_t min_coeffs_per_task) {
+        seal::ParallelExecution::SetExecutor(std::make_shared<SealExecutor>(pools, std::move(select)),
+                                             minimum(min_coeffs_per_task));
+    }
+
+private:
+    // No operation reaches SIZE_MAX coefficients, so 0 keeps them all on the calling thread
+    static size_t minimum(size_t min_coeffs_per_task) {
+        return min_coeffs_per_task == 0 ? std::numeric_limits<size_t>::max() : min_coeffs_per_task;
+    }
+
+    std::vector<std::weak_ptr<ThreadPool>> pools;
+    std::vector<size_t> threads;
+    SelectPool select;
+};
+
+#endif // SEAL_EXECUTOR_H
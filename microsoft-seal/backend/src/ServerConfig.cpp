@@ -0,0 +1,107 @@
+/**
+ * ServerConfig.cpp
+ *
+ * Command line / environment option lookup shared by both backends.
+ */
+
+#include "ServerConfig.h"
+#include <cctype>         // For std::toupper
+#include <charconv>       // For std::from_chars
+#include <cstdlib>        // For std::getenv
+#include <stdexcept>      // For exception handling
+
+namespace {
+    bool parse_number(const std::string& text, size_t& value) {
+        const char* end = text.data() + text.size();
+        auto result = std::from_chars(text.data(), end, value);
+        return !text.empty() && result.ec == std::errc() && result.ptr == end;
+    }
+}
+
+ServerConfig::ServerConfig(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.size() < 3 || arg.compare(0, 2, "--") != 0) {
+            throw std::invalid_argument("Unexpected argument: " + arg);
+        }
+        size_t equals = arg.find('=');
+        if (equals != std::string::npos) {
+            flags[arg.substr(2, equals - 2)] = arg.substr(equals + 1);
+        } else if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0) {
+            flags[arg.substr(2)] = argv[++i];
+        } else {
+            flags[arg.substr(2)] = "";  // Missing value; rejected by get_size()
+        }
+    }
+}
+
+std::string ServerConfig::get(const std::string& name, const std::string& fallback) const {
+    std::string value;
+    return lookup(name, value) ? value : fallback;
+}
+
+size_t ServerConfig::get_size(const std::string& name, size_t fallback) const {
+    std::string value;
+    if (!lookup(name, value)) return fallback;
+    size_t result;
+    if (!parse_number(value, result)) {
+        throw std::invalid_argument("Invalid value for --" + name + ": " + value);
+    }
+    return result;
+}
+
+bool ServerConfig::has(const std::string& name) const {
+    std::string value;
+    return lookup(name, value);
+}
+
+void ServerConfig::check_unused() const {
+    for (const auto& flag : flags) {
+        if (!queried.count(flag.first)) throw std::invalid_argument("Unknown option: --" + flag.first);
+    }
+}
+
+std::vector<int> ServerConfig::parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    if (list.empty()) return cpus;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        std::string item = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        size_t dash = item.find('-');
+        size_t first, last;
+        if (!parse_number(item.substr(0, dash), first) ||
+            !parse_number(dash == std::string::npos ? item : item.substr(dash + 1), last) || last < first) {
+            throw std::invalid_argument("Invalid CPU list: " + list);
+        }
+        for (size_t cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return cpus;
+}
+
+// "compute-threads" -> "HE_COMPUTE_THREADS"
+std::string ServerConfig::env_name(const std::string& name) {
+    std::string env = "HE_";
+    for (char c : name) {
+        env.push_back(c == '-' ? '_' : static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+    }
+    return env;
+}
+
+bool ServerConfig::lookup(const std::string& name, std::string& value) const {
+    queried.insert(name);
+    auto it = flags.find(name);
+    if (it != flags.end()) {
+        value = it->second;
+        return true;
+    }
+    if (const char* env = std::getenv(env_name(name).c_str())) {
+        value = env;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#ifndef SERVER_CONFIG_H
+#define SERVER_CONFIG_H
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Startup options for the backends, from the command line or the environment
+ *
+ * Every option has a flag name such as "compute-threads", given as
+ * --compute-threads=8 or --compute-threads 8, and an environment fallback
+ * derived from it (HE_COMPUTE_THREADS). Flags win over the environment,
+ * which wins over the built-in default.
+ */
+class ServerConfig {
+public:
+    /**
+     * @throws std::invalid_argument on arguments that are not --name[=value]
+     */
+    ServerConfig(int argc, char** argv);
+
+    // Option value, or fallback if neither the flag nor the variable is set
+    std::string get(const std::string& name, const std::string& fallback = "") const;
+
+    // Non-negative integer option; throws std::invalid_argument if malformed
+    size_t get_size(const std::string& name, size_t fallback) const;
+
+    bool has(const std::string& name) const;
+
+    // Throws std::invalid_argument naming any flag that no get()/has() asked for
+    void check_unused() const;
+
+    /**
+     * Parse a CPU list such as "0-15,32-47" (as in taskset -c); "" gives an empty list
+     * @throws std::invalid_argument if malformed
+     */
+    static std::vector<int> parse_cpu_list(const std::string& list);
+
+private:
+    std::unordered_map<std::string, std::string> flags;
+    mutable std::set<std::string> queried;
+
+    static std::string env_name(const std::string& name);
+    bool lookup(const std::string& name, std::string& value) const;
+};
+
+#endif // SERVER_CONFIG_H
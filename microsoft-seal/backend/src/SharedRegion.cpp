@@ -0,0 +1,145 @@
+/**
+ * SharedRegion.cpp
+ *
+ * POSIX shared memory regions for the same-host ciphertext handoff.
+ */
+
+#include "SharedRegion.h"
+#include "BinaryFraming.h"  // For the little-endian integer helpers
+#include "RandomHandle.h"   // For names
+#include <cctype>           // For checking names
+#include <cerrno>           // For errno
+#include <cstring>          // For std::memcpy, std::strerror
+#include <stdexcept>        // For exception handling
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace shm {
+
+namespace {
+    constexpr char prefix[] = "/he-";
+    constexpr size_t hex_digits = 32;
+
+    // Random 128-bit name (see random_handle), so no other process on the host can guess a region
+    std::string new_name() {
+        return prefix + random_handle();
+    }
+}
+
+bool valid_name(const std::string& name) {
+    const size_t length = sizeof(prefix) - 1;
+    if (name.size() != length + hex_digits || name.compare(0, length, prefix) != 0) return false;
+    for (size_t i = length; i < name.size(); i++) {
+        if (!std::isxdigit(static_cast<unsigned char>(name[i])) || std::isupper(static_cast<unsigned char>(name[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Publisher::Publisher(std::chrono::seconds ttl) : ttl(ttl) {}
+
+Publisher::~Publisher() {
+#if !defined(_WIN32)
+    for (const auto& region : outstanding) ::shm_unlink(region.first.c_str());
+#endif
+}
+
+std::string Publisher::publish(const std::vector<std::string>& payloads) {
+#if defined(_WIN32)
+    throw std::runtime_error("Shared memory handoff needs a POSIX system");
+#else
+    size_t total = 4;
+    for (const auto& payload : payloads) total += 8 + payload.size();
+
+    std::string name = new_name();
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Could not create a shared memory region: ") + std::strerror(errno));
+    }
+    void* mapped = MAP_FAILED;
+    // Exactly owner read and write, whatever the umask
+    if (::fchmod(fd, S_IRUSR | S_IWUSR) == 0 && ::ftruncate(fd, static_cast<off_t>(total)) == 0) {
+        mapped = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int error = errno;
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error(std::string("Could not size a shared memory region: ") + std::strerror(error));
+    }
+
+    // The framing of BinaryFraming.h, written in place
+    char* out = static_cast<char*>(mapped);
+    std::string lengths;
+    framing::put_uint(lengths, payloads.size(), 4);
+    std::memcpy(out, lengths.data(), 4);
+    out += 4;
+    for (const auto& payload : payloads) {
+        lengths.clear();
+        framing::put_uint(lengths, payload.size(), 8);
+        std::memcpy(out, lengths.data(), 8);
+        std::memcpy(out + 8, payload.data(), payload.size());
+        out += 8 + payload.size();
+    }
+    ::munmap(mapped, total);
+
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    expire(now);
+    outstanding.emplace_back(name, now + ttl);
+    return name;
+#endif
+}
+
+// Unlink the regions past their time; consumed ones are gone already. Called with the mutex held
+void Publisher::expire(Clock::time_point now) {
+#if !defined(_WIN32)
+    while (!outstanding.empty() && outstanding.front().second <= now) {
+        ::shm_unlink(outstanding.front().first.c_str());
+        outstanding.pop_front();
+    }
+#endif
+}
+
+Region::Region(const std::string& name) {
+    if (!valid_name(name)) throw std::invalid_argument("Not a shared memory region name: " + name);
+#if defined(_WIN32)
+    throw std::runtime_error("Shared memory handoff needs a POSIX system");
+#else
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        if (errno == ENOENT) throw std::out_of_range("Unknown or consumed shared memory region: " + name);
+        throw std::runtime_error("Could not open " + name + ": " + std::strerror(errno));
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not read " + name);
+    }
+    // Only regions a Publisher of this user made, which no one else could have written
+    if (status.st_uid != ::geteuid() || (status.st_mode & (S_IRWXG | S_IRWXO)) != 0) {
+        ::close(fd);
+        throw std::invalid_argument("Shared memory region " + name + " is not private to this user");
+    }
+    ::shm_unlink(name.c_str());  // Consumed: the open descriptor and the mapping keep it
+    size = static_cast<size_t>(status.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Could not map " + name + ": " + std::strerror(errno));
+    data = static_cast<const char*>(mapped);
+#endif
+}
+
+Region::~Region() {
+#if !defined(_WIN32)
+    if (data) ::munmap(const_cast<char*>(data), size);
+#endif
+}
+
+}
@@ -0,0 +1,80 @@
+#ifndef SHARED_REGION_H
+#define SHARED_REGION_H
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Ciphertext batches handed from mini-backend to a main-backend on the same
+ * host through POSIX shared memory (--shm-handoff), rather than through the
+ * browser as Base64 JSON
+ *
+ * The writer puts the framed ciphertexts (see BinaryFraming.h) into a new
+ * region "/he-<32 hex digits>", readable by the same user only, and passes
+ * its name on. The reader opens the region and unlinks it at once, so every
+ * region is consumed once and cannot be reopened while it is read, then
+ * loads the ciphertexts straight from the mapping: no socket, no Base64 and
+ * no copy of the batch. Regions nobody consumes are unlinked by the writer
+ * once they expire.
+ *
+ * POSIX only; elsewhere publishing and opening regions throw.
+ */
+namespace shm {
+
+    // Whether a name is one Publisher makes; no other shared memory object is ever opened
+    bool valid_name(const std::string& name);
+
+    class Publisher {
+    public:
+        explicit Publisher(std::chrono::seconds ttl);
+        ~Publisher();  // Unlinks the regions still outstanding
+
+        Publisher(const Publisher&) = delete;
+        Publisher& operator=(const Publisher&) = delete;
+
+        /**
+         * Write payloads into a new region
+         * @return The region's name, for Region
+         * @throws std::runtime_error if the region cannot be created
+         */
+        std::string publish(const std::vector<std::string>& payloads);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        const std::chrono::seconds ttl;
+        std::mutex mutex;
+        std::deque<std::pair<std::string, Clock::time_point>> outstanding;  // In publication order
+
+        void expire(Clock::time_point now);
+    };
+
+    // A published region, mapped read-only and already unlinked
+    class Region {
+    public:
+        /**
+         * @throws std::invalid_argument for names Publisher does not make, or a region
+         *         of another user or open to other users
+         * @throws std::out_of_range if the region does not exist (any more)
+         */
+        explicit Region(const std::string& name);
+        ~Region();
+
+        Region(const Region&) = delete;
+        Region& operator=(const Region&) = delete;
+
+        std::string_view bytes() const { return { data, size }; }
+
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+}
+
+#endif // SHARED_REGION_H
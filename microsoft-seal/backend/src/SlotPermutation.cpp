@@ -0,0 +1,189 @@
+#include "SlotPermutation.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+    size_t popcount(size_t n) {
+        size_t bits = 0;
+        for (; n; n &= n - 1) bits++;
+        return bits;
+    }
+}
+
+SlotPermutation::SlotPermutation(const HomomorphicEncryption& he, const std::vector<size_t>& sources)
+    : he(he), rows(he.seal_context()->first_context_data()->parms().scheme() == seal::scheme_type::ckks ? 1 : 2),
+      row_size(he.slot_count() / rows) {
+    const size_t slots = he.slot_count();
+    if (sources.size() != slots) {
+        throw std::invalid_argument("Expected a source for each of the " + std::to_string(slots) + " slots");
+    }
+    targets.resize(rows * row_size);
+    for (size_t t = 0; t < slots; t++) {
+        const size_t s = sources[t];
+        if (s == PatientPacking::no_source) continue;
+        if (s >= slots) throw std::invalid_argument("Source slot " + std::to_string(s) + " is past the slots");
+        const size_t other_row = (s / row_size) != (t / row_size);
+        const size_t k = (s % row_size + row_size - t % row_size) % row_size;
+        targets[other_row * row_size + k].push_back(t);
+    }
+    diagonal_total = std::count_if(targets.begin(), targets.end(), [](const std::vector<size_t>& diagonal) {
+        return !diagonal.empty();
+    });
+    if (diagonal_total == 0) throw std::invalid_argument("Permutation selects no slot");
+
+    baby = choose_baby_step();
+    baby_used.assign(rows * baby, false);
+    for (size_t id = 0; id < targets.size(); id++) {
+        if (!targets[id].empty()) baby_used[id / row_size * baby + id % row_size % baby] = true;
+    }
+}
+
+/**
+ * Power-of-two baby step with the fewest key switches: per row variant, one
+ * per baby step some diagonal needs, which is hoisted if the step has a
+ * Galois key of its own and else taken from the term without its lowest bit
+ * (several when that term is not needed either), plus a giant step for every
+ * giant index up to the highest one used; ties go to the larger baby step
+ */
+size_t SlotPermutation::choose_baby_step() const {
+    std::vector<int> keyed(row_size, -1);  // By rotation step, filled on first use
+    auto has_key = [&](size_t step) {
+        if (keyed[step] < 0) keyed[step] = he.has_galois_key(static_cast<int>(step));
+        return keyed[step] == 1;
+    };
+
+    size_t best = 1;
+    size_t best_cost = static_cast<size_t>(-1);
+    for (size_t g = 1; g <= row_size; g <<= 1) {
+        std::vector<bool> used(rows * g, false);
+        size_t giants = 0;
+        for (size_t id = 0; id < targets.size(); id++) {
+            if (targets[id].empty()) continue;
+            used[id / row_size * g + id % row_size % g] = true;
+            giants = std::max(giants, id % row_size / g);
+        }
+        size_t cost = giants;
+        for (size_t i = 0; i < used.size(); i++) {
+            const size_t b = i % g;
+            if (!used[i] || b == 0) continue;
+            cost += has_key(b) || used[i - b + (b & (b - 1))] ? 1 : popcount(b);
+        }
+        if (cost <= best_cost) {
+            best = g;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+/**
+ * Masks of diagonal g j + b of both row variants, rotated right by g j
+ * within the rows, encoded for each giant index j at the given level
+ * (cached); entry c * g + b of a giant index multiplies rot(x, b), from the
+ * rows swapped when c is 1
+ */
+const std::vector<std::vector<seal::Plaintext>>& SlotPermutation::encoded_at(size_t chain_index,
+                                                                              seal::parms_id_type parms_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = encoded.find(chain_index);
+    if (found != encoded.end()) return found->second;
+
+    std::vector<std::vector<seal::Plaintext>> plaintexts((row_size + baby - 1) / baby);
+    std::vector<double> mask(he.slot_count(), 0.0);
+    for (size_t id = 0; id < targets.size(); id++) {
+        if (targets[id].empty()) continue;
+        const size_t c = id / row_size;
+        const size_t j = id % row_size / baby;
+        const size_t b = id % row_size % baby;
+        const size_t shift = j * baby;
+        for (size_t t : targets[id]) mask[t / row_size * row_size + (t % row_size + shift) % row_size] = 1.0;
+        if (plaintexts[j].empty()) plaintexts[j].resize(rows * baby);
+        plaintexts[j][c * baby + b] = std::move(he.encode_weights(mask, true, parms_id)[0]);
+        std::fill(mask.begin(), mask.end(), 0.0);
+    }
+    return encoded.emplace(chain_index, std::move(plaintexts)).first->second;
+}
+
+seal::Ciphertext SlotPermutation::apply(const seal::Ciphertext& x, PermutationStats* stats) const {
+    const size_t chain_index = he.chain_index(x);
+    if (rows == 1 && chain_index == 0) {
+        throw std::invalid_argument("Slot permutation needs a level, the ciphertext has none left");
+    }
+    PermutationStats counts;
+
+    // Baby steps of x and, if any slot's source is in the other row, of x with its rows swapped
+    std::vector<seal::Ciphertext> terms(rows * baby);
+    for (size_t c = 0; c < rows; c++) {
+        auto first = baby_used.begin() + c * baby;
+        if (std::none_of(first, first + baby, [](bool used) { return used; })) continue;
+        seal::Ciphertext& base = terms[c * baby];
+        if (c == 0) {
+            base = x;
+        } else {
+            base = he.swap_rows(x);
+            counts.row_swaps++;
+        }
+        // Steps with a key of their own share one decomposition; each other one rotates the term
+        // without its lowest bit by that bit, composing the term first if no diagonal needs it
+        // (SEAL would compose from keys for negative steps, which are not generated)
+        std::vector<int> steps;
+        for (size_t b = 1; b < baby; b++) {
+            if (baby_used[c * baby + b] && he.has_galois_key(static_cast<int>(b))) steps.push_back(static_cast<int>(b));
+        }
+        if (!steps.empty()) {
+            std::vector<seal::Ciphertext> rotated = he.rotate_many(base, steps);
+            for (size_t i = 0; i < steps.size(); i++) terms[c * baby + steps[i]] = std::move(rotated[i]);
+            counts.baby_rotations += steps.size();
+            counts.hoisted_rotations += steps.size();
+        }
+        for (size_t b = 1; b < baby; b++) {
+            seal::Ciphertext& term = terms[c * baby + b];
+            if (!baby_used[c * baby + b] || term.size() != 0) continue;
+            const size_t rest = b & (b - 1);
+            seal::Ciphertext composed;
+            const seal::Ciphertext* from = &terms[c * baby + rest];
+            if (from->size() == 0) {
+                composed = base;
+                for (size_t bit = 1; bit < rest; bit <<= 1) {
+                    if (!(rest & bit)) continue;
+                    composed = std::move(he.rotate_many(composed, {static_cast<int>(bit)})[0]);
+                    counts.baby_rotations++;
+                }
+                from = &composed;
+            }
+            term = std::move(he.rotate_many(*from, {static_cast<int>(b - rest)})[0]);
+            counts.baby_rotations++;
+        }
+    }
+
+    // Every term is multiplied by up to one mask per giant index, so BFV ones are transformed once
+    for (auto& term : terms) {
+        if (term.size() != 0) he.transform_to_ntt_inplace(term);
+    }
+
+    // Giant steps, outermost first: result = inner_0 + rot(inner_1 + rot(inner_2 + ...), g)
+    const auto& plaintexts = encoded_at(chain_index, x.parms_id());
+    seal::Ciphertext result;
+    bool started = false;
+    for (size_t j = plaintexts.size(); j-- > 0;) {
+        if (started) {
+            result = std::move(he.rotate_many(result, {static_cast<int>(baby)})[0]);
+            counts.giant_rotations++;
+        }
+        if (plaintexts[j].empty()) continue;
+        seal::Ciphertext inner = he.weighted_sum(terms.data(), plaintexts[j]);
+        for (const auto& plaintext : plaintexts[j]) {
+            if (!plaintext.is_zero()) counts.plaintext_products++;
+        }
+        if (started) {
+            he.add_inplace(result, inner);
+        } else {
+            result = std::move(inner);
+            started = true;
+        }
+    }
+    if (stats) *stats = counts;
+    return result;
+}
@@ -0,0 +1,82 @@
+#ifndef SLOT_PERMUTATION_H
+#define SLOT_PERMUTATION_H
+
+#include "HomomorphicEncryption.h"
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Rotations and products a SlotPermutation has done
+struct PermutationStats {
+    size_t baby_rotations = 0;     // Rotations of the input (and of its swapped rows)
+    size_t hoisted_rotations = 0;  // Baby rotations sharing one key switching decomposition
+    size_t giant_rotations = 0;    // Rotations of partial sums
+    size_t row_swaps = 0;          // BFV and BGV: rotations exchanging the two rows
+    size_t plaintext_products = 0; // One per nonzero diagonal
+};
+
+/**
+ * A fixed rearrangement of the slots of encrypted vectors, e.g. the
+ * transpose between PatientPacking layouts, as a 0/1 matrix product with
+ * masked rotations in one level
+ *
+ * Slot t of the result takes slot sources[t] of the input. The matrix is
+ * split into generalized diagonals as in DiagonalMatrix: diagonal k masks
+ * the slots whose source is k to the left of them, so the product is
+ * sum_k mask_k * rot(x, k), with only the nonzero diagonals kept. BFV and
+ * BGV rotate within two rows of N/2 slots; a slot whose source is in the
+ * other row takes it from the rows swapped once (one more rotation), which
+ * doubles the diagonals. With baby step g and k = g j + b,
+ *
+ *   P x = sum_j rot(sum_b rot(mask_k, -g j) * rot(x, b), g j)
+ *
+ * Baby steps with a Galois key of their own are hoisted
+ * (HomomorphicEncryption::rotate_many), each other one is one rotation of
+ * a smaller baby step, and the giant steps are applied Horner-style; g
+ * minimizes the key switches with the Galois keys at hand. A transpose of
+ * a P x B block has up to P B diagonals (2 B - 1 when square), so it costs
+ * about 2 sqrt(slots) rotations and one plaintext product per diagonal.
+ * The masks are encoded once per level, on first use, and kept: one
+ * plaintext per diagonal.
+ * Thread-safe.
+ */
+class SlotPermutation {
+public:
+    /**
+     * @param sources Input slot of every result slot (slot_count() entries), or
+     *                PatientPacking::no_source for a slot left zero
+     * @throws std::invalid_argument for the wrong length, a source past the
+     *         slots, or no source at all
+     */
+    SlotPermutation(const HomomorphicEncryption& he, const std::vector<size_t>& sources);
+
+    size_t diagonal_count() const { return diagonal_total; }
+    size_t baby_step() const { return baby; }
+
+    /**
+     * The rearranged vector, at x's scale; one level below x for CKKS (and
+     * BGV when x has one to spare)
+     *
+     * @param stats If set, receives the rotation and product counts
+     * @throws std::invalid_argument if a CKKS x has no level left
+     * @throws std::runtime_error without Galois keys
+     */
+    seal::Ciphertext apply(const seal::Ciphertext& x, PermutationStats* stats = nullptr) const;
+
+private:
+    const HomomorphicEncryption& he;
+    size_t rows;      // 1 (CKKS) or 2 (BFV and BGV batching rows)
+    size_t row_size;  // Slots per row
+    size_t baby = 1;
+    size_t diagonal_total = 0;
+    std::vector<std::vector<size_t>> targets;  // By diagonal c * row_size + k (c: from the other row)
+    std::vector<bool> baby_used;               // Whether any diagonal has row c and baby index b (c * baby + b)
+    mutable std::mutex mutex;
+    mutable std::map<size_t, std::vector<std::vector<seal::Plaintext>>> encoded;  // By chain index, then giant index
+
+    size_t choose_baby_step() const;
+    const std::vector<std::vector<seal::Plaintext>>& encoded_at(size_t chain_index, seal::parms_id_type parms_id) const;
+};
+
+#endif // SLOT_PERMUTATION_H
@@ -0,0 +1,231 @@
+/**
+ * SyntheticHealthcare.cpp
+ *
+ * Rows of the healthcare schema from a counter-based random stream per row.
+ */
+
+#include "SyntheticHealthcare.h"
+#include <cctype>       // For std::toupper, std::tolower
+#include <cstdio>       // For std::snprintf
+#include <stdexcept>    // For std::invalid_argument
+#include <utility>      // For std::move
+
+namespace {
+    // Category values of the sample, each about equally frequent there
+    constexpr std::string_view genders[] = { "Male", "Female" };
+    constexpr std::string_view blood_types[] = { "A-", "A+", "AB+", "AB-", "B+", "B-", "O+", "O-" };
+    constexpr std::string_view conditions[] = { "Arthritis", "Diabetes", "Hypertension", "Obesity", "Cancer",
+                                                "Asthma" };
+    constexpr std::string_view insurers[] = { "Cigna", "Medicare", "UnitedHealthcare", "Blue Cross", "Aetna" };
+    constexpr std::string_view admission_types[] = { "Elective", "Urgent", "Emergency" };
+    constexpr std::string_view medications[] = { "Lipitor", "Ibuprofen", "Aspirin", "Paracetamol", "Penicillin" };
+    constexpr std::string_view outcomes[] = { "Abnormal", "Normal", "Inconclusive" };
+
+    constexpr std::string_view first_names[] = {
+        "James", "Mary", "Robert", "Patricia", "John", "Jennifer", "Michael", "Linda", "David", "Elizabeth",
+        "William", "Barbara", "Richard", "Susan", "Joseph", "Jessica", "Thomas", "Sarah", "Christopher", "Karen",
+        "Charles", "Lisa", "Daniel", "Nancy", "Matthew", "Betty", "Anthony", "Sandra", "Mark", "Margaret",
+        "Donald", "Ashley", "Steven", "Kimberly", "Andrew", "Emily", "Paul", "Donna", "Joshua", "Michelle",
+        "Kenneth", "Carol", "Kevin", "Amanda", "Brian", "Melissa", "Timothy", "Deborah", "Ronald", "Stephanie",
+        "Jason", "Rebecca", "George", "Laura", "Edward", "Helen", "Jeffrey", "Sharon", "Ryan", "Cynthia",
+        "Jacob", "Kathleen", "Gary", "Amy", "Nicholas", "Angela", "Eric", "Shirley", "Jonathan", "Brenda",
+        "Stephen", "Emma", "Larry", "Anna", "Justin", "Pamela", "Scott", "Nicole", "Brandon", "Samantha",
+        "Benjamin", "Katherine", "Samuel", "Christine", "Gregory", "Debra", "Alexander", "Rachel", "Patrick",
+        "Carolyn", "Frank", "Janet", "Raymond", "Maria", "Jack", "Olivia", "Dennis", "Heather", "Jerry", "Tiffany"
+    };
+    constexpr std::string_view last_names[] = {
+        "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis", "Rodriguez", "Martinez",
+        "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Thomas", "Taylor", "Moore", "Jackson", "Martin",
+        "Lee", "Perez", "Thompson", "White", "Harris", "Sanchez", "Clark", "Ramirez", "Lewis", "Robinson",
+        "Walker", "Young", "Allen", "King", "Wright", "Scott", "Torres", "Nguyen", "Hill", "Flores",
+        "Green", "Adams", "Nelson", "Baker", "Hall", "Rivera", "Campbell", "Mitchell", "Carter", "Roberts",
+        "Gomez", "Phillips", "Evans", "Turner", "Diaz", "Parker", "Cruz", "Edwards", "Collins", "Reyes",
+        "Stewart", "Morris", "Morales", "Murphy", "Cook", "Rogers", "Gutierrez", "Ortiz", "Morgan", "Cooper",
+        "Peterson", "Bailey", "Reed", "Kelly", "Howard", "Ramos", "Kim", "Cox", "Ward", "Richardson",
+        "Watson", "Brooks", "Chavez", "Wood", "James", "Bennett", "Gray", "Mendoza", "Ruiz", "Hughes",
+        "Price", "Alvarez", "Castillo", "Sanders", "Patel", "Myers", "Long", "Ross", "Foster", "Vang"
+    };
+    constexpr std::string_view company_suffixes[] = { "Inc", "LLC", "Ltd", "PLC", "Group", "and Sons" };
+
+    constexpr int32_t first_admission = 18024;  // 2019-05-08
+    constexpr int32_t admission_days = 1827;    // Through 2024-05-07
+    constexpr double min_billing = -2008.4921398591305;
+    constexpr double max_billing = 52764.276736469175;
+
+    // SplitMix64 over a counter: a stream per (seed, row), independent of every other row's
+    class Stream {
+    public:
+        Stream(uint64_t seed, uint64_t row) : state(mix(seed ^ mix(row + 0x9e3779b97f4a7c15ULL))) {}
+
+        uint64_t next() { return mix(state += 0x9e3779b97f4a7c15ULL); }
+        size_t below(size_t n) { return static_cast<size_t>(next() % n); }
+        double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+        template <size_t n>
+        std::string_view pick(const std::string_view (&values)[n]) { return values[below(n)]; }
+
+    private:
+        uint64_t state;
+
+        static uint64_t mix(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+    };
+
+    std::string person(Stream& random) {
+        std::string name(random.pick(first_names));
+        name += ' ';
+        name += random.pick(last_names);
+        return name;
+    }
+
+    // The sample's patient names have every letter's case at random
+    std::string scramble_case(std::string name, uint64_t bits) {
+        for (char& c : name) {
+            c = static_cast<char>(bits & 1 ? std::toupper(static_cast<unsigned char>(c))
+                                           : std::tolower(static_cast<unsigned char>(c)));
+            bits >>= 1;
+        }
+        return name;
+    }
+
+    std::string company(Stream& random) {
+        std::string name(random.pick(last_names));
+        switch (random.below(3)) {
+            case 0: name += ' '; name += random.pick(company_suffixes); break;
+            case 1: name += '-'; name += random.pick(last_names); break;
+            default:
+                name += ", ";
+                name += random.pick(last_names);
+                name += " and ";
+                name += random.pick(last_names);
+                break;
+        }
+        return name;
+    }
+
+    // Proleptic Gregorian date of a day since 1970-01-01 (H. Hinnant's civil_from_days)
+    void civil_from_days(int64_t days, int64_t& year, unsigned& month, unsigned& day) {
+        days += 719468;
+        const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const unsigned day_of_era = static_cast<unsigned>(days - era * 146097);
+        const unsigned year_of_era =
+            (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+        const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        const unsigned shifted_month = (5 * day_of_year + 2) / 153;
+        day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+        month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+        year = static_cast<int64_t>(year_of_era) + era * 400 + (month <= 2);
+    }
+
+    void append_field(std::string_view field, std::string& out) {
+        if (field.find_first_of(",\"\n") == std::string_view::npos) {
+            out += field;
+            return;
+        }
+        out += '"';
+        for (char c : field) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+}
+
+const std::vector<std::string>& SyntheticHealthcare::header() {
+    static const std::vector<std::string> names = {
+        "Name", "Age", "Gender", "Blood Type", "Medical Condition", "Date of Admission", "Doctor", "Hospital",
+        "Insurance Provider", "Billing Amount", "Room Number", "Admission Type", "Discharge Date", "Medication",
+        "Test Results"
+    };
+    return names;
+}
+
+bool SyntheticHealthcare::is_numeric(size_t column) {
+    return column == age || column == billing_amount || column == room_number;
+}
+
+SyntheticHealthcare::Row SyntheticHealthcare::row(uint64_t index) const {
+    Stream random(seed, index);
+    Row row;
+    row.name = person(random);
+    row.name = scramble_case(std::move(row.name), random.next());
+    row.age = 13 + static_cast<int>(random.below(77));
+    row.gender = random.pick(genders);
+    row.blood_type = random.pick(blood_types);
+    row.medical_condition = random.pick(conditions);
+    row.admission_day = first_admission + static_cast<int32_t>(random.below(admission_days));
+    row.doctor = person(random);
+    row.hospital = company(random);
+    row.insurance_provider = random.pick(insurers);
+    row.billing_amount = min_billing + (max_billing - min_billing) * random.uniform();
+    row.room_number = 101 + static_cast<int>(random.below(400));
+    row.admission_type = random.pick(admission_types);
+    row.discharge_day = row.admission_day + 1 + static_cast<int32_t>(random.below(30));
+    row.medication = random.pick(medications);
+    row.test_results = random.pick(outcomes);
+    return row;
+}
+
+double SyntheticHealthcare::value(const Row& row, size_t column) {
+    switch (column) {
+        case age: return row.age;
+        case billing_amount: return row.billing_amount;
+        case room_number: return row.room_number;
+        default: throw std::invalid_argument("Column " + std::to_string(column) + " is not numeric");
+    }
+}
+
+void SyntheticHealthcare::append_csv(const Row& row, std::string& out) {
+    char number[32];
+    append_field(row.name, out);
+    out += ',';
+    out += std::to_string(row.age);
+    out += ',';
+    out += row.gender;
+    out += ',';
+    out += row.blood_type;
+    out += ',';
+    out += row.medical_condition;
+    out += ',';
+    out += date(row.admission_day);
+    out += ',';
+    append_field(row.doctor, out);
+    out += ',';
+    append_field(row.hospital, out);
+    out += ',';
+    out += row.insurance_provider;
+    out += ',';
+    std::snprintf(number, sizeof(number), "%.17g", row.billing_amount);
+    out += number;
+    out += ',';
+    out += std::to_string(row.room_number);
+    out += ',';
+    out += row.admission_type;
+    out += ',';
+    out += date(row.discharge_day);
+    out += ',';
+    out += row.medication;
+    out += ',';
+    out += row.test_results;
+    out += '\n';
+}
+
+std::string SyntheticHealthcare::date(int32_t day) {
+    int64_t year;
+    unsigned month, day_of_month;
+    civil_from_days(day, year, month, day_of_month);
+    char text[32];
+    std::snprintf(text, sizeof(text), "%04lld-%02u-%02u", static_cast<long long>(year), month, day_of_month);
+    return text;
+}
+
+std::vector<double> SyntheticHealthcare::column(size_t column, uint64_t first, size_t count) const {
+    if (!is_numeric(column)) throw std::invalid_argument("Column " + std::to_string(column) + " is not numeric");
+    std::vector<double> values;
+    values.reserve(count);
+    for (uint64_t i = first; i < first + count; i++) values.push_back(value(row(i), column));
+    return values;
+}
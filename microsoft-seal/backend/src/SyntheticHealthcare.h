@@ -0,0 +1,85 @@
+#ifndef SYNTHETIC_HEALTHCARE_H
+#define SYNTHETIC_HEALTHCARE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Synthetic rows in the schema of src/data/healthcare_dataset.csv, for
+ * datasets of any size (see tools/he-gen.cpp)
+ *
+ * Same 15 columns, in the same order, with the sample's distributions:
+ * categories uniform over the values it has (e.g. eight blood types, six
+ * conditions), Age uniform in [13, 89], Billing Amount uniform in
+ * [-2008.49, 52764.28], Room Number uniform in [101, 500], admissions
+ * uniform from 2019-05-08 to 2024-05-07 and stays of 1 to 30 days. Names
+ * have the sample's random letter case; doctors and hospitals are drawn
+ * from name lists as the sample's generator drew them.
+ *
+ * Row i is a function of the seed and i alone, from a counter-based random
+ * stream, so any range of rows can be generated on its own: threads and
+ * machines split a dataset without coordination, and the same seed gives
+ * the same bytes whatever the split.
+ */
+class SyntheticHealthcare {
+public:
+    // Column indices, as in the sample's header
+    enum Column : size_t {
+        name, age, gender, blood_type, medical_condition, admission_date, doctor, hospital, insurance_provider,
+        billing_amount, room_number, admission_type, discharge_date, medication, test_results, column_count
+    };
+
+    struct Row {
+        std::string name;
+        int age = 0;
+        std::string_view gender;
+        std::string_view blood_type;
+        std::string_view medical_condition;
+        int32_t admission_day = 0;  // Days since 1970-01-01
+        std::string doctor;
+        std::string hospital;
+        std::string_view insurance_provider;
+        double billing_amount = 0;
+        int room_number = 0;
+        std::string_view admission_type;
+        int32_t discharge_day = 0;
+        std::string_view medication;
+        std::string_view test_results;
+    };
+
+    explicit SyntheticHealthcare(uint64_t seed = 1) : seed(seed) {}
+
+    static const std::vector<std::string>& header();
+
+    // Whether a column holds numbers (Age, Billing Amount, Room Number), the columns CsvTable reads
+    static bool is_numeric(size_t column);
+
+    Row row(uint64_t index) const;
+
+    // Value of a numeric column of a row
+    static double value(const Row& row, size_t column);
+
+    /**
+     * A row as a CSV line with its newline, fields quoted where they contain
+     * commas; Billing Amount with 17 significant digits, so CsvTable reads
+     * back the exact double that Arrow and encrypted outputs hold
+     */
+    static void append_csv(const Row& row, std::string& out);
+
+    // ISO date (YYYY-MM-DD) of a day since 1970-01-01
+    static std::string date(int32_t day);
+
+    /**
+     * Values of a numeric column for rows [first, first + count)
+     * @throws std::invalid_argument for columns that are not numeric
+     */
+    std::vector<double> column(size_t column, uint64_t first, size_t count) const;
+
+private:
+    uint64_t seed;
+};
+
+#endif // SYNTHETIC_HEALTHCARE_H
@@ -0,0 +1,48 @@
+#ifndef TENANT_MIDDLEWARE_H
+#define TENANT_MIDDLEWARE_H
+
+#include "crow.h"
+#include "HomomorphicEncryption.h"
+#include "Metrics.h"
+#include "NumaTopology.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Reads the request's tenant from "X-Tenant-ID" (empty: the server's own
+ * keys) and holds the tenant engines its handler uses, so a key set the
+ * TenantRegistry evicts meanwhile stays loaded until the response is sent
+ *
+ * With a multi-node topology (--numa) it also routes the request: the
+ * handler thread is bound to the CPUs of the node owning the tenant (for the
+ * server's own keys, the node it already runs on) until the response is
+ * sent, and the handler uses that node's engines.
+ */
+struct TenantMiddleware {
+    struct context {
+        std::string tenant;
+        std::vector<std::shared_ptr<HomomorphicEncryption>> engines;
+        size_t node = 0;  // Index into the topology's nodes
+        std::unique_ptr<NumaTopology::Binding> binding;
+    };
+
+    const NumaTopology* numa = nullptr;  // Set before the server starts; null: a single node
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        ctx.tenant = req.get_header_value("X-Tenant-ID");
+        if (!numa || numa->size() < 2) return;
+        ctx.node = ctx.tenant.empty() ? numa->current_node() : numa->tenant_node(ctx.tenant);
+        ctx.binding = std::make_unique<NumaTopology::Binding>(numa->node(ctx.node));
+        metrics::counter("he_numa_requests_total", "Requests by the NUMA node that served them",
+                         {{"node", std::to_string(numa->node(ctx.node).id)}})
+            .add();
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        ctx.engines.clear();
+        ctx.binding.reset();
+    }
+};
+
+#endif // TENANT_MIDDLEWARE_H
@@ -0,0 +1,194 @@
+/**
+ * TenantRegistry.cpp
+ *
+ * Lazy loading and LRU eviction of per-tenant key sets.
+ */
+
+#include "TenantRegistry.h"
+#include "Metrics.h"
+#include <iterator>       // For std::next, std::prev
+#include <stdexcept>      // For std::invalid_argument, std::out_of_range
+#include <utility>        // For std::move
+
+namespace {
+    metrics::Counter& lookups(const char* result) {
+        return metrics::counter("he_tenant_keys_total",
+                                "Tenant key set lookups by result (hit, load, eviction, expired)",
+                                {{"result", result}});
+    }
+
+    // IDs become directory names, so nothing that could step out of the key directory
+    bool valid_tenant(const std::string& tenant) {
+        if (tenant.empty() || tenant.size() > 64) return false;
+        for (char c : tenant) {
+            bool allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' ||
+                           c == '_';
+            if (!allowed) return false;
+        }
+        return true;
+    }
+}
+
+TenantRegistry::TenantRegistry(ProfileRegistry& profiles, const KeyStore& key_store, size_t memory_budget,
+                               LoadKeys load_keys)
+    : profiles(profiles), key_dir(key_store.directory()), compression(key_store.compression_mode()),
+      memory_budget(memory_budget), load_keys(std::move(load_keys)) {}
+
+/**
+ * Keys are loaded outside the lock, so a slow load holds up only the requests
+ * for that key set. Requests arriving during its load wait for it and look
+ * again, rather than load (and on mini-backend generate and save) it too
+ */
+std::shared_ptr<HomomorphicEncryption> TenantRegistry::get(const std::string& tenant, const ParameterProfile& profile,
+                                                           const std::string& scheme) {
+    static metrics::Counter& hits = lookups("hit");
+    static metrics::Counter& loads = lookups("load");
+
+    if (!valid_tenant(tenant)) throw std::invalid_argument("Invalid tenant ID: " + tenant);
+    HomomorphicEncryption& base = profiles.get(profile, scheme);  // Checks the scheme
+    Key key(tenant, profile.name, scheme);
+    std::promise<void> loaded;
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            Entry& entry = *found->second;
+            entries.splice(entries.begin(), entries, found->second);
+            entry.used = MemoryBudget::Clock::now();
+            hits.add();
+            // Lazily loaded Galois keys make an engine grow as it serves new rotations
+            const size_t bytes = entry.engine->key_bytes();
+            total_bytes = total_bytes - entry.bytes + bytes;
+            entry.bytes = bytes;
+            evict();
+            return entry.engine;
+        }
+        auto pending = loading.find(key);
+        if (pending == loading.end()) {
+            loading.emplace(key, loaded.get_future().share());
+            break;
+        }
+        std::shared_future<void> done = pending->second;
+        lock.unlock();
+        done.wait();
+    }
+
+    // However the load ends, the requests waiting for it look again
+    struct LoadDone {
+        TenantRegistry& registry;
+        const Key& key;
+        std::promise<void>& loaded;
+
+        ~LoadDone() {
+            {
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.loading.erase(key);
+            }
+            loaded.set_value();
+        }
+    } done{*this, key, loaded};
+
+    const auto start = MemoryBudget::Clock::now();
+    std::shared_ptr<HomomorphicEncryption> engine = base.share_parameters();
+    if (!load_keys(*engine, KeyStore(key_dir + "/tenant-" + tenant, compression))) {
+        throw std::out_of_range("No " + profile.name + " " + scheme + " keys for tenant " + tenant);
+    }
+    const size_t bytes = engine->key_bytes();
+    const auto now = MemoryBudget::Clock::now();
+    const double load_us = std::chrono::duration<double, std::micro>(now - start).count();
+    loads.add();
+
+    std::lock_guard<std::mutex> lock(mutex);  // Released before done
+    entries.push_front(Entry{key, engine, bytes, load_us, now});
+    index.emplace(key, entries.begin());
+    total_bytes += bytes;
+    total_load_us += load_us;
+    evict();
+    return engine;
+}
+
+// Drop least recently used key sets until the budget holds, keeping the newest
+void TenantRegistry::evict() {
+    static metrics::Counter& evictions = lookups("eviction");
+    while (total_bytes > memory_budget && entries.size() > 1) {
+        erase(std::prev(entries.end()));
+        evictions.add();
+    }
+}
+
+// Called with the mutex held
+void TenantRegistry::erase(std::list<Entry>::const_iterator entry) {
+    index.erase(entry->key);
+    total_bytes -= entry->bytes;
+    total_load_us -= entry->load_us;
+    entries.erase(entry);
+}
+
+/**
+ * The least recently used key set but the newest, of the tenant if given
+ * (entries.end() if none)
+ * Called with the mutex held
+ */
+std::list<TenantRegistry::Entry>::const_iterator TenantRegistry::oldest(const std::string* tenant) const {
+    if (entries.size() < 2) return entries.end();
+    for (auto it = entries.rbegin(); std::next(it) != entries.rend(); ++it) {
+        if (!tenant || std::get<0>(it->key) == *tenant) return std::prev(it.base());
+    }
+    return entries.end();
+}
+
+size_t TenantRegistry::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t TenantRegistry::key_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total_bytes;
+}
+
+MemoryBudget::Usage TenantRegistry::budget_usage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return MemoryBudget::Usage{entries.size(), total_bytes, total_load_us};
+}
+
+std::map<std::string, size_t> TenantRegistry::tenant_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, size_t> bytes;
+    for (const Entry& entry : entries) bytes[std::get<0>(entry.key)] += entry.bytes;
+    return bytes;
+}
+
+bool TenantRegistry::eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = oldest(tenant);
+    if (entry == entries.end()) return false;
+    candidate = MemoryBudget::Candidate{entry->used, entry->bytes, entry->load_us};
+    return true;
+}
+
+bool TenantRegistry::evict(const std::string* tenant, MemoryBudget::Candidate& evicted) {
+    static metrics::Counter& evictions = lookups("eviction");
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = oldest(tenant);
+    if (entry == entries.end()) return false;
+    evicted = MemoryBudget::Candidate{entry->used, entry->bytes, entry->load_us};
+    erase(entry);
+    evictions.add();
+    return true;
+}
+
+// Idle key sets go even if one is the newest: no request has used it for the TTL either
+MemoryBudget::Usage TenantRegistry::expire(MemoryBudget::Clock::time_point before) {
+    static metrics::Counter& expirations = lookups("expired");
+    std::lock_guard<std::mutex> lock(mutex);
+    MemoryBudget::Usage expired;
+    while (!entries.empty() && entries.back().used < before) {
+        expired.entries++;
+        expired.bytes += entries.back().bytes;
+        expired.rebuild_us += entries.back().load_us;
+        erase(std::prev(entries.end()));
+        expirations.add();
+    }
+    return expired;
+}
@@ -0,0 +1,95 @@
+#ifndef TENANT_REGISTRY_H
+#define TENANT_REGISTRY_H
+
+#include "HomomorphicEncryption.h"
+#include "KeyStore.h"
+#include "MemoryBudget.h"
+#include "ParameterProfile.h"
+#include "ProfileRegistry.h"
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+/**
+ * Key sets of many tenants (e.g. one per hospital), loaded on first use and
+ * kept in a least-recently-used cache bounded by the bytes of their keys
+ *
+ * A tenant's keys live in a KeyStore of its own, <key-dir>/tenant-<id>. Its engine
+ * for a profile and scheme shares everything but the keys with the
+ * ProfileRegistry's engine for them (HomomorphicEncryption::share_parameters),
+ * so a thousand tenants on one profile still have one SEALContext and one set
+ * of NTT tables. Evicted engines stay alive for as long as a request holds
+ * them. Each key set is loaded once at a time, so concurrent first requests
+ * wait for one load_keys (which may generate and save the keys) rather than
+ * each writing its own keys into the tenant's store. Under a MemoryBudget,
+ * key sets count against their tenant's quota, expire when unused for the TTL
+ * and are evicted by the time they took to load. Thread-safe.
+ */
+class TenantRegistry : public MemoryBudget::Consumer {
+public:
+    /**
+     * Give a new engine the tenant's keys
+     * @return false if the store has none (get() then throws std::out_of_range)
+     */
+    using LoadKeys = std::function<bool(HomomorphicEncryption& he, const KeyStore& store)>;
+
+    /**
+     * @param profiles Engines whose parameters tenants share
+     * @param key_store Server key store; tenants' stores are subdirectories of it, with its compression
+     * @param memory_budget Key bytes to keep loaded (the most recently used tenant always stays)
+     * @param load_keys Backend-specific key setup, e.g. load or generate and save
+     */
+    TenantRegistry(ProfileRegistry& profiles, const KeyStore& key_store, size_t memory_budget, LoadKeys load_keys);
+
+    /**
+     * The tenant's engine for a profile and scheme
+     * @throws std::invalid_argument for a malformed tenant ID (letters, digits, '-', '_', at most 64)
+     * @throws std::out_of_range if the tenant has no keys for the profile and scheme
+     */
+    std::shared_ptr<HomomorphicEncryption> get(const std::string& tenant, const ParameterProfile& profile,
+                                               const std::string& scheme);
+
+    size_t size() const;
+    size_t key_bytes() const;
+
+    // MemoryBudget::Consumer; the most recently used key set is not evicted
+    MemoryBudget::Usage budget_usage() const override;
+    std::map<std::string, size_t> tenant_bytes() const override;
+    bool eviction_candidate(const std::string* tenant, MemoryBudget::Candidate& candidate) const override;
+    bool evict(const std::string* tenant, MemoryBudget::Candidate& evicted) override;
+    MemoryBudget::Usage expire(MemoryBudget::Clock::time_point before) override;
+
+private:
+    using Key = std::tuple<std::string, std::string, std::string>;  // Tenant, profile name, scheme
+    struct Entry {
+        Key key;
+        std::shared_ptr<HomomorphicEncryption> engine;
+        size_t bytes;
+        double load_us;
+        MemoryBudget::Clock::time_point used;
+    };
+
+    ProfileRegistry& profiles;
+    std::string key_dir;
+    seal::compr_mode_type compression;
+    size_t memory_budget;
+    LoadKeys load_keys;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // Most recently used first
+    std::map<Key, std::list<Entry>::iterator> index;
+    size_t total_bytes = 0;
+    double total_load_us = 0;
+    std::map<Key, std::shared_future<void>> loading;  // Key sets being loaded
+
+    void evict();
+    void erase(std::list<Entry>::const_iterator entry);
+    std::list<Entry>::const_iterator oldest(const std::string* tenant) const;
+};
+
+#endif // TENANT_REGISTRY_H
@@ -0,0 +1,170 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+/**
+ * Fixed-size worker pool for CPU-bound homomorphic operations
+ *
+ * Tasks are queued FIFO and executed by a fixed set of worker threads.
+ * submit() returns a std::future so callers can wait for (and rethrow
+ * exceptions from) individual tasks; post() queues a task nobody waits on
+ * through the pool, without the future's allocations. Workers can be pinned
+ * to a CPU list (Linux only; elsewhere the list is ignored), worker i to
+ * cpus[i % size], and run a start hook before taking tasks (e.g. to label
+ * themselves for metrics::label_thread).
+ *
+ * Tasks have a priority: a worker takes batch tasks only when no interactive
+ * one is queued. A task gets the priority of the thread submitting it, which
+ * is interactive unless a BatchScope is open on it, and runs at that
+ * priority, so everything a background job fans out (parallel sums, SEAL's
+ * per-limb work items) yields to request handlers' tasks at every task
+ * boundary. Running tasks are never preempted.
+ */
+class ThreadPool {
+public:
+    enum class Priority { interactive, batch };
+
+    /**
+     * Makes the tasks the current thread submits, until destroyed, batch tasks
+     * (e.g. around a background job). Scopes nest
+     */
+    class BatchScope {
+    public:
+        BatchScope() : saved(current_priority()) { current_priority() = Priority::batch; }
+        ~BatchScope() { current_priority() = saved; }
+
+        BatchScope(const BatchScope&) = delete;
+        BatchScope& operator=(const BatchScope&) = delete;
+
+    private:
+        Priority saved;
+    };
+
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency(), const std::vector<int>& cpus = {},
+                        const std::function<void()>& on_start = {}) {
+        if (threads == 0) threads = 1;
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back([this, on_start] {
+                if (on_start) on_start();
+                worker_loop();
+            });
+            if (!cpus.empty()) pin(workers.back(), cpus[i % cpus.size()]);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queue a task for execution on a worker thread
+     *
+     * @param task Callable taking no arguments
+     * @return Future holding the task's result or exception
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using result_type = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(task));
+        std::future<result_type> result = packaged->get_future();
+        post([packaged] { (*packaged)(); });
+        return result;
+    }
+
+    /**
+     * Queue a task whose completion the caller tracks itself
+     * An exception escaping the task terminates the process, as on any thread.
+     *
+     * @param task Callable taking no arguments
+     */
+    void post(std::function<void()> task) {
+        const Priority priority = current_priority();
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            (priority == Priority::batch ? batch_tasks : tasks).push_back({std::move(task), priority});
+            wake = idle > 0;
+        }
+        if (wake) cv.notify_one();
+    }
+
+    // Number of worker threads
+    size_t size() const { return workers.size(); }
+
+private:
+    struct Task {
+        std::function<void()> run;
+        Priority priority;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<Task> tasks;        // Interactive
+    std::deque<Task> batch_tasks;  // Taken only while tasks is empty
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t idle = 0;  // Workers waiting on cv; post() skips the notify while all are busy
+    bool stopping = false;
+
+    static Priority& current_priority() {
+        thread_local Priority priority = Priority::interactive;
+        return priority;
+    }
+
+    static void pin(std::thread& thread, int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)cpu;
+#endif
+    }
+
+    void worker_loop() {
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!stopping && tasks.empty() && batch_tasks.empty()) {
+                    idle++;
+                    cv.wait(lock);
+                    idle--;
+                }
+                if (tasks.empty() && batch_tasks.empty()) return;  // Stopping, and drained
+                std::deque<Task>& queue = tasks.empty() ? batch_tasks : tasks;
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            current_priority() = task.priority;  // Tasks it submits inherit its priority
+            task.run();
+        }
+    }
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,60 @@
+#ifndef TRACE_MIDDLEWARE_H
+#define TRACE_MIDDLEWARE_H
+
+#include "crow.h"
+#include "Metrics.h"
+#include "Tracing.h"
+#include <string>
+#include <utility>
+
+/**
+ * Server span per request, continuing the caller's W3C trace context
+ *
+ * Reads "traceparent", lets the Tracer decide whether the request is
+ * recorded, and while the handler runs makes the span the thread's current
+ * one so HE stages are recorded as its children. Sampled responses carry
+ * the server span back in "traceresponse". Does nothing unless an OTLP
+ * endpoint is configured (see Tracing.h).
+ */
+struct TraceMiddleware {
+    struct context {
+        tracing::SpanContext span;
+        tracing::SpanId parent_id{};
+        uint64_t start_unix_ns = 0;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        tracing::Tracer& tracer = tracing::Tracer::instance();
+        if (!tracer.enabled()) return;
+        tracing::SpanContext parent;
+        bool has_parent = tracing::parse_traceparent(req.get_header_value("traceparent"), parent);
+        ctx.span = tracer.start_request(has_parent ? &parent : nullptr);
+        if (!ctx.span.sampled) return;
+        if (has_parent) ctx.parent_id = parent.span_id;
+        ctx.start_unix_ns = tracing::unix_ns();
+        tracing::set_current_span(&ctx.span);
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (!ctx.span.sampled) return;
+        tracing::set_current_span(nullptr);
+        tracing::Span span;
+        span.trace_id = ctx.span.trace_id;
+        span.span_id = ctx.span.span_id;
+        span.parent_id = ctx.parent_id;
+        span.name = metrics::endpoint_label(crow::method_name(req.method), req.url);
+        span.kind = 2;
+        span.start_unix_ns = ctx.start_unix_ns;
+        span.end_unix_ns = tracing::unix_ns();
+        span.error = res.code >= 500;
+        span.string_attributes.emplace_back("http.request.method", crow::method_name(req.method));
+        span.string_attributes.emplace_back("url.path", req.url);
+        span.int_attributes.emplace_back("http.response.status_code", res.code);
+        span.int_attributes.emplace_back("http.request.body.size", static_cast<int64_t>(req.body_view().size()));
+        span.int_attributes.emplace_back("http.response.body.size", static_cast<int64_t>(res.body.size()));
+        tracing::Tracer::instance().record(std::move(span));
+        res.set_header("traceresponse", tracing::format_traceparent(ctx.span));
+    }
+};
+
+#endif // TRACE_MIDDLEWARE_H
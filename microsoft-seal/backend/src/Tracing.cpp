@@ -0,0 +1,305 @@
+/**
+ * Tracing.cpp
+ *
+ * W3C trace context parsing, sampling and the OTLP/HTTP JSON exporter.
+ */
+
+#include "Tracing.h"
+#include "Metrics.h"
+#ifndef ASIO_STANDALONE
+    #define ASIO_STANDALONE
+#endif
+#include <asio/ip/tcp.hpp>  // For the blocking collector connection
+#include <algorithm>        // For std::all_of, std::min
+#include <cstdio>           // For std::snprintf
+#include <functional>       // For std::hash of the thread ID
+#include <iterator>         // For std::make_move_iterator
+#include <random>           // For span and trace IDs
+#include <stdexcept>        // For std::invalid_argument
+
+namespace tracing {
+
+namespace {
+    thread_local const SpanContext* thread_span = nullptr;
+
+    std::mt19937_64& generator() {
+        thread_local std::mt19937_64 engine(
+            std::random_device{}() ^ std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        return engine;
+    }
+
+    template <size_t N>
+    void random_id(std::array<uint8_t, N>& id) {
+        do {
+            for (size_t i = 0; i < N; i += 8) {
+                uint64_t bits = generator()();
+                for (size_t j = 0; j < 8 && i + j < N; j++) id[i + j] = static_cast<uint8_t>(bits >> (8 * j));
+            }
+        } while (std::all_of(id.begin(), id.end(), [](uint8_t byte) { return byte == 0; }));
+    }
+
+    int hex_value(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;  // W3C IDs are lowercase
+    }
+
+    template <size_t N>
+    bool parse_hex(const std::string& text, size_t offset, std::array<uint8_t, N>& out) {
+        bool nonzero = false;
+        for (size_t i = 0; i < N; i++) {
+            int high = hex_value(text[offset + 2 * i]);
+            int low = hex_value(text[offset + 2 * i + 1]);
+            if (high < 0 || low < 0) return false;
+            out[i] = static_cast<uint8_t>(high << 4 | low);
+            nonzero |= out[i] != 0;
+        }
+        return nonzero;
+    }
+
+    template <size_t N>
+    std::string hex(const std::array<uint8_t, N>& id) {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(2 * N, '0');
+        for (size_t i = 0; i < N; i++) {
+            out[2 * i] = digits[id[i] >> 4];
+            out[2 * i + 1] = digits[id[i] & 0xf];
+        }
+        return out;
+    }
+
+    void append_string(std::string& out, const std::string& value) {
+        out.push_back('"');
+        for (char c : value) {
+            if (c == '"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out.push_back(c);
+            }
+        }
+        out.push_back('"');
+    }
+
+    metrics::Counter& spans(const char* result) {
+        return metrics::counter("he_trace_spans_total", "Trace spans by outcome (exported, dropped, failed)",
+                                {{"result", result}});
+    }
+}
+
+bool parse_traceparent(const std::string& header, SpanContext& context) {
+    // version "-" trace-id "-" parent-id "-" flags; later versions may append fields
+    if (header.size() < 55 || header[2] != '-' || header[35] != '-' || header[52] != '-') return false;
+    if (header.compare(0, 2, "ff") == 0 || hex_value(header[0]) < 0 || hex_value(header[1]) < 0) return false;
+    if (header.compare(0, 2, "00") == 0 && header.size() != 55) return false;
+    if (header.size() > 55 && header[55] != '-') return false;
+    int high = hex_value(header[53]);
+    int low = hex_value(header[54]);
+    if (high < 0 || low < 0) return false;
+    SpanContext parsed;
+    if (!parse_hex(header, 3, parsed.trace_id) || !parse_hex(header, 36, parsed.span_id)) return false;
+    parsed.sampled = (low & 1) != 0;
+    context = parsed;
+    return true;
+}
+
+std::string format_traceparent(const SpanContext& context) {
+    return "00-" + hex(context.trace_id) + "-" + hex(context.span_id) + (context.sampled ? "-01" : "-00");
+}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::~Tracer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    if (exporter.joinable()) exporter.join();
+}
+
+void Tracer::configure(const std::string& endpoint, const std::string& service_name, double ratio,
+                       size_t max_per_second) {
+    if (endpoint.empty()) return;
+    if (!(ratio >= 0 && ratio <= 1)) throw std::invalid_argument("Trace sample ratio must be in [0, 1]");
+    const std::string scheme = "http://";
+    if (endpoint.compare(0, scheme.size(), scheme) != 0) {
+        throw std::invalid_argument("OTLP endpoint must be an http:// URL: " + endpoint);
+    }
+    size_t authority = scheme.size();
+    size_t slash = endpoint.find('/', authority);
+    std::string host_port = endpoint.substr(authority, slash == std::string::npos ? std::string::npos : slash - authority);
+    size_t colon = host_port.rfind(':');
+    host = host_port.substr(0, colon);
+    port = colon == std::string::npos ? "80" : host_port.substr(colon + 1);
+    path = slash == std::string::npos ? "/v1/traces" : endpoint.substr(slash);
+    if (host.empty() || port.empty()) throw std::invalid_argument("Malformed OTLP endpoint: " + endpoint);
+    service = service_name;
+    sample_ratio = ratio;
+    max_traces_per_second = max_per_second;
+    window_start = std::chrono::steady_clock::now();
+    if (!exporter.joinable()) exporter = std::thread([this] { run(); });
+}
+
+SpanContext Tracer::start_request(const SpanContext* parent) {
+    SpanContext context;
+    if (!enabled()) return context;
+    if (parent) {
+        context.trace_id = parent->trace_id;
+        context.sampled = parent->sampled;
+    } else {
+        random_id(context.trace_id);
+        context.sampled = std::uniform_real_distribution<double>(0, 1)(generator()) < sample_ratio;
+    }
+    random_id(context.span_id);
+    if (context.sampled) context.sampled = admit();
+    return context;
+}
+
+SpanId Tracer::new_span_id() {
+    SpanId id;
+    random_id(id);
+    return id;
+}
+
+// Fixed one-second windows of at most max_traces_per_second recorded traces (0 = no cap)
+bool Tracer::admit() {
+    if (max_traces_per_second == 0) return true;
+    std::lock_guard<std::mutex> lock(budget_mutex);
+    auto now = std::chrono::steady_clock::now();
+    if (now - window_start >= std::chrono::seconds(1)) {
+        window_start = now;
+        window_traces = 0;
+    }
+    if (window_traces >= max_traces_per_second) return false;
+    window_traces++;
+    return true;
+}
+
+void Tracer::record(Span span) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= capacity) {
+            spans("dropped").add();
+            return;
+        }
+        queue.push_back(std::move(span));
+        if (queue.size() < batch_size) return;
+    }
+    ready.notify_one();
+}
+
+// Exporter thread: posts whatever is queued every second, or as soon as a batch is full
+void Tracer::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        ready.wait_for(lock, std::chrono::seconds(1), [this] { return stopping || queue.size() >= batch_size; });
+        if (queue.empty()) {
+            if (stopping) return;
+            continue;
+        }
+        std::vector<Span> pending;
+        pending.swap(queue);
+        lock.unlock();
+        for (size_t begin = 0; begin < pending.size(); begin += batch_size) {
+            size_t end = std::min(pending.size(), begin + batch_size);
+            std::vector<Span> batch(std::make_move_iterator(pending.begin() + begin),
+                                    std::make_move_iterator(pending.begin() + end));
+            spans(post(encode(batch)) ? "exported" : "failed").add(batch.size());
+        }
+        lock.lock();
+    }
+}
+
+// One blocking POST with a short deadline; a slow or missing collector costs only this thread
+bool Tracer::post(const std::string& body) const {
+    asio::ip::tcp::iostream stream;
+    stream.expires_after(std::chrono::seconds(2));
+    stream.connect(host, port);
+    if (!stream) return false;
+    stream << "POST " << path << " HTTP/1.1\r\n"
+           << "Host: " << host << ":" << port << "\r\n"
+           << "Content-Type: application/json\r\n"
+           << "Content-Length: " << body.size() << "\r\n"
+           << "Connection: close\r\n\r\n"
+           << body;
+    stream.flush();
+    std::string version;
+    unsigned status = 0;
+    stream >> version >> status;
+    return stream && status >= 200 && status < 300;
+}
+
+// ExportTraceServiceRequest in OTLP's JSON mapping (hex IDs, nanosecond strings)
+std::string Tracer::encode(const std::vector<Span>& batch) const {
+    std::string out = "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":"
+                      "{\"stringValue\":";
+    append_string(out, service);
+    out += "}}]},\"scopeSpans\":[{\"scope\":{\"name\":\"he-backend\"},\"spans\":[";
+    const SpanId root{};
+    for (size_t i = 0; i < batch.size(); i++) {
+        const Span& span = batch[i];
+        if (i) out.push_back(',');
+        out += "{\"traceId\":\"" + hex(span.trace_id) + "\",\"spanId\":\"" + hex(span.span_id) + "\"";
+        if (span.parent_id != root) out += ",\"parentSpanId\":\"" + hex(span.parent_id) + "\"";
+        out += ",\"name\":";
+        append_string(out, span.name);
+        out += ",\"kind\":" + std::to_string(span.kind);
+        out += ",\"startTimeUnixNano\":\"" + std::to_string(span.start_unix_ns) + "\"";
+        out += ",\"endTimeUnixNano\":\"" + std::to_string(span.end_unix_ns) + "\"";
+        out += ",\"attributes\":[";
+        bool first = true;
+        for (const auto& attribute : span.string_attributes) {
+            if (!first) out.push_back(',');
+            first = false;
+            out += "{\"key\":";
+            append_string(out, attribute.first);
+            out += ",\"value\":{\"stringValue\":";
+            append_string(out, attribute.second);
+            out += "}}";
+        }
+        for (const auto& attribute : span.int_attributes) {
+            if (!first) out.push_back(',');
+            first = false;
+            out += "{\"key\":";
+            append_string(out, attribute.first);
+            out += ",\"value\":{\"intValue\":\"" + std::to_string(attribute.second) + "\"}}";
+        }
+        out += "]";
+        if (span.error) out += ",\"status\":{\"code\":2}";
+        out += "}";
+    }
+    out += "]}]}]}";
+    return out;
+}
+
+const SpanContext* current_span() {
+    return thread_span;
+}
+
+void set_current_span(const SpanContext* span) {
+    thread_span = span;
+}
+
+void record_stage(const char* scheme, const char* stage, uint64_t start_unix_ns, uint64_t end_unix_ns) {
+    const SpanContext* parent = thread_span;
+    if (!parent || !parent->sampled) return;
+    Span span;
+    span.trace_id = parent->trace_id;
+    span.span_id = Tracer::new_span_id();
+    span.parent_id = parent->span_id;
+    span.name = stage;
+    span.start_unix_ns = start_unix_ns;
+    span.end_unix_ns = end_unix_ns;
+    if (std::string(scheme) != "none") span.string_attributes.emplace_back("he.scheme", scheme);
+    Tracer::instance().record(std::move(span));
+}
+
+}
@@ -0,0 +1,140 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Distributed tracing: W3C trace context in, OTLP/HTTP (JSON) spans out
+ *
+ * TraceMiddleware continues the trace of an incoming "traceparent" header
+ * (or starts one) and gives every handler a server span; the HE stages timed
+ * through metrics::ScopedTimer become its children, including those run on
+ * worker threads (the span travels with metrics::EndpointScope). Finished
+ * spans are queued and posted to the collector in batches by a background
+ * thread, so handlers never wait on the network; when the queue is full
+ * spans are dropped (and counted) rather than blocking.
+ *
+ * Overhead is bounded by sampling: a trace whose parent is not sampled is
+ * never recorded, a new trace is sampled with the configured ratio, and at
+ * most max_traces_per_second traces are recorded whatever the callers ask.
+ * Without an endpoint (the default) nothing is sampled or exported.
+ */
+namespace tracing {
+
+    using TraceId = std::array<uint8_t, 16>;
+    using SpanId = std::array<uint8_t, 8>;
+
+    // Position of a span in its trace; sampled spans are recorded
+    struct SpanContext {
+        TraceId trace_id{};
+        SpanId span_id{};
+        bool sampled = false;
+    };
+
+    /**
+     * Parse a W3C traceparent header ("00-<32 hex>-<16 hex>-<2 hex flags>")
+     * @return false if the header is malformed or carries all-zero IDs
+     */
+    bool parse_traceparent(const std::string& header, SpanContext& context);
+    std::string format_traceparent(const SpanContext& context);
+
+    // A finished span, as exported
+    struct Span {
+        TraceId trace_id{};
+        SpanId span_id{};
+        SpanId parent_id{};          // All zero for a root span
+        std::string name;
+        int kind = 1;                // OTLP SpanKind: 1 internal, 2 server
+        uint64_t start_unix_ns = 0;
+        uint64_t end_unix_ns = 0;
+        bool error = false;
+        std::vector<std::pair<std::string, std::string>> string_attributes;
+        std::vector<std::pair<std::string, int64_t>> int_attributes;
+    };
+
+    class Tracer {
+    public:
+        static Tracer& instance();
+
+        ~Tracer();
+
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+        /**
+         * Start exporting (once, at startup)
+         * @param endpoint Collector URL, e.g. "http://localhost:4318/v1/traces" (http only)
+         * @param service service.name resource attribute, e.g. "main-backend"
+         * @param sample_ratio Fraction of new traces to record, in [0, 1]
+         * @param max_traces_per_second Cap on recorded traces, whether sampled here or upstream
+         * @throws std::invalid_argument for a malformed endpoint or ratio
+         */
+        void configure(const std::string& endpoint, const std::string& service, double sample_ratio,
+                       size_t max_traces_per_second);
+        bool enabled() const { return !host.empty(); }
+
+        /**
+         * Context for a request's server span: a child of parent when it is valid,
+         * the root of a new trace otherwise, sampled as described above
+         */
+        SpanContext start_request(const SpanContext* parent);
+
+        static SpanId new_span_id();
+
+        // Queue a finished span for export; drops it if the queue is full
+        void record(Span span);
+
+    private:
+        static constexpr size_t capacity = 4096;   // Queued spans
+        static constexpr size_t batch_size = 512;  // Spans per request to the collector
+
+        std::string host;
+        std::string port;
+        std::string path;
+        std::string service;
+        double sample_ratio = 0;
+        size_t max_traces_per_second = 0;
+
+        std::mutex budget_mutex;
+        std::chrono::steady_clock::time_point window_start;
+        size_t window_traces = 0;
+
+        std::mutex mutex;
+        std::condition_variable ready;  // Exporter waits for spans
+        std::vector<Span> queue;
+        bool stopping = false;
+        std::thread exporter;
+
+        Tracer() = default;
+        bool admit();
+        void run();
+        bool post(const std::string& body) const;
+        std::string encode(const std::vector<Span>& spans) const;
+    };
+
+    // Server span of the request the calling thread is serving (nullptr outside requests)
+    const SpanContext* current_span();
+    void set_current_span(const SpanContext* span);
+
+    // Nanoseconds since the Unix epoch, the OTLP timestamp unit
+    inline uint64_t unix_ns(std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    }
+
+    /**
+     * Record a child span of the calling thread's sampled request span (no-op otherwise)
+     * Used by metrics::ScopedTimer for HE stages
+     */
+    void record_stage(const char* scheme, const char* stage, uint64_t start_unix_ns, uint64_t end_unix_ns);
+}
+
+#endif // TRACING_H
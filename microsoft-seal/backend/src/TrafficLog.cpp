@@ -0,0 +1,215 @@
+/**
+ * TrafficLog.cpp
+ *
+ * Writing traffic logs from a background thread, and reading them back.
+ */
+
+#include "TrafficLog.h"
+#include "BinaryFraming.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace traffic {
+
+namespace {
+    constexpr char magic[] = "HETRAF01";
+    constexpr size_t magic_size = sizeof(magic) - 1;
+    constexpr uint64_t request_kind = 1;
+    constexpr uint64_t outcome_kind = 2;
+
+    void put_string(std::string& out, const std::string& value) {
+        const size_t size = std::min<size_t>(value.size(), UINT16_MAX);
+        framing::put_uint(out, size, 2);
+        out.append(value, 0, size);
+    }
+
+    std::string get_string(std::string_view in, size_t& pos) {
+        const size_t size = static_cast<size_t>(framing::get_uint(in, pos, 2));
+        if (in.size() - pos < size) throw std::invalid_argument("Truncated traffic record");
+        std::string value(in.substr(pos, size));
+        pos += size;
+        return value;
+    }
+
+    // Fill in the length a record starts with, once the rest is appended
+    void set_length(std::string& out) {
+        const uint64_t length = out.size() - 8;
+        for (size_t i = 0; i < 8; i++) out[i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+    }
+}
+
+Recorder& Recorder::instance() {
+    static Recorder recorder;
+    return recorder;
+}
+
+Recorder::~Recorder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    if (writer.joinable()) writer.join();
+}
+
+void Recorder::configure(const std::string& path, const std::string& service, double ratio, bool bodies,
+                         size_t buffer_bytes) {
+    if (path.empty() || writer.joinable()) return;
+    if (!(ratio > 0 && ratio <= 1)) throw std::invalid_argument("Traffic sample ratio must be in (0, 1]");
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("Cannot create traffic log " + path);
+    start = std::chrono::steady_clock::now();
+    const auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+    std::string header(magic, magic_size);
+    put_string(header, service);
+    framing::put_uint(header, std::chrono::duration_cast<std::chrono::microseconds>(since_epoch).count(), 8);
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file.flush();
+    sample_ratio = ratio;
+    keep_bodies = bodies;
+    capacity = buffer_bytes;
+    writer = std::thread([this] { run(); });
+}
+
+bool Recorder::sample() const {
+    if (!enabled()) return false;
+    if (sample_ratio >= 1) return true;
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    return std::uniform_real_distribution<double>(0, 1)(rng) < sample_ratio;
+}
+
+uint64_t Recorder::elapsed_us(std::chrono::steady_clock::time_point time) const {
+    if (time <= start) return 0;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(time - start).count());
+}
+
+bool Recorder::record(const Request& request) {
+    std::string out;
+    out.reserve(64 + request.target.size() + request.endpoint.size() + request.body.size());
+    framing::put_uint(out, 0, 8);
+    framing::put_uint(out, request_kind, 1);
+    framing::put_uint(out, request.id, 8);
+    framing::put_uint(out, request.arrival_us, 8);
+    framing::put_uint(out, request.body_recorded ? 1 : 0, 1);
+    framing::put_uint(out, request.body_size, 8);
+    put_string(out, request.method);
+    put_string(out, request.target);
+    put_string(out, request.endpoint);
+    put_string(out, request.content_type);
+    if (request.body_recorded) out += request.body;
+    set_length(out);
+    return enqueue(std::move(out));
+}
+
+bool Recorder::record(const Outcome& outcome) {
+    std::string out;
+    framing::put_uint(out, 0, 8);
+    framing::put_uint(out, outcome_kind, 1);
+    framing::put_uint(out, outcome.id, 8);
+    framing::put_uint(out, outcome.service_us, 4);
+    framing::put_uint(out, outcome.status, 2);
+    framing::put_uint(out, outcome.response_size, 8);
+    set_length(out);
+    return enqueue(std::move(out));
+}
+
+bool Recorder::enqueue(std::string encoded) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!queue.empty() && queue.size() + encoded.size() > capacity) return false;
+        if (queue.empty()) {
+            queue.swap(encoded);
+        } else {
+            queue += encoded;
+        }
+        enqueued++;
+    }
+    ready.notify_one();
+    return true;
+}
+
+void Recorder::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    const uint64_t target = enqueued;
+    drained.wait(lock, [this, target] { return written >= target || !writer.joinable(); });
+}
+
+// Writer thread: takes everything queued at once and appends it, then flushes the file
+void Recorder::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        ready.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) return;  // Stopping with nothing left
+        std::string pending;
+        pending.swap(queue);
+        const uint64_t taken = enqueued;
+        lock.unlock();
+        file.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+        file.flush();
+        lock.lock();
+        written = taken;
+        drained.notify_all();
+    }
+}
+
+Reader::Reader(const std::string& path) : file(path, std::ios::binary) {
+    if (!file) throw std::runtime_error("Cannot open traffic log " + path);
+    std::string header(magic_size + 2, '\0');
+    file.read(&header[0], static_cast<std::streamsize>(header.size()));
+    if (!file || header.compare(0, magic_size, magic) != 0) throw std::runtime_error(path + " is not a traffic log");
+    size_t pos = magic_size;
+    std::string rest(static_cast<size_t>(framing::get_uint(header, pos, 2)) + 8, '\0');
+    file.read(&rest[0], static_cast<std::streamsize>(rest.size()));
+    if (!file) throw std::runtime_error(path + " has a truncated header");
+    service_name = rest.substr(0, rest.size() - 8);
+    pos = rest.size() - 8;
+    start_us = framing::get_uint(rest, pos, 8);
+}
+
+Reader::Kind Reader::next(Request& request, Outcome& outcome) {
+    char length_bytes[8];
+    file.read(length_bytes, sizeof(length_bytes));
+    if (file.gcount() == 0) return Kind::end;
+    try {
+        size_t pos = 0;
+        const uint64_t length = framing::get_uint(
+            std::string_view(length_bytes, static_cast<size_t>(file.gcount())), pos, 8);
+        std::string data(static_cast<size_t>(length), '\0');
+        file.read(&data[0], static_cast<std::streamsize>(length));
+        if (length == 0 || static_cast<uint64_t>(file.gcount()) != length) {
+            throw std::invalid_argument("Truncated traffic record");
+        }
+        pos = 0;
+        const uint64_t kind = framing::get_uint(data, pos, 1);
+        if (kind == outcome_kind) {
+            outcome.id = framing::get_uint(data, pos, 8);
+            outcome.service_us = static_cast<uint32_t>(framing::get_uint(data, pos, 4));
+            outcome.status = static_cast<uint16_t>(framing::get_uint(data, pos, 2));
+            outcome.response_size = framing::get_uint(data, pos, 8);
+            return Kind::outcome;
+        }
+        if (kind != request_kind) throw std::invalid_argument("Unknown traffic record");
+        request.id = framing::get_uint(data, pos, 8);
+        request.arrival_us = framing::get_uint(data, pos, 8);
+        request.body_recorded = (framing::get_uint(data, pos, 1) & 1) != 0;
+        request.body_size = framing::get_uint(data, pos, 8);
+        request.method = get_string(data, pos);
+        request.target = get_string(data, pos);
+        request.endpoint = get_string(data, pos);
+        request.content_type = get_string(data, pos);
+        if (request.body_recorded && data.size() - pos != request.body_size) {
+            throw std::invalid_argument("Truncated traffic record");
+        }
+        data.erase(0, request.body_recorded ? pos : data.size());
+        request.body = std::move(data);
+        return Kind::request;
+    } catch (const std::invalid_argument&) {
+        cut_short = true;
+        return Kind::end;
+    }
+}
+
+}
@@ -0,0 +1,155 @@
+#ifndef TRAFFIC_LOG_H
+#define TRAFFIC_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Traffic logs: the requests a backend served, for replaying its real load
+ * against another build (tools/he-replay.cpp)
+ *
+ * With --record-traffic=FILE, TrafficMiddleware hands every request (or a
+ * --record-traffic-sample of them) to the Recorder, which appends it to FILE
+ * from a background thread, so handlers never wait on the disk; when more
+ * than --record-traffic-buffer-mb is queued, records are dropped (and
+ * counted) rather than blocking.
+ *
+ * A request is logged as it reaches the handlers, so the log is in arrival
+ * order, with what a replay needs: arrival time, method, path and query,
+ * endpoint label, Content-Type and body. Its outcome (status, response
+ * size, handler time on the recording server) follows in a separate record
+ * once it is answered, matched by id. Client addresses and all other
+ * headers (tenant, trace context, authorization) are never written. Bodies
+ * can be left out (--record-traffic-bodies=0), keeping only their size:
+ * main-backend's carry ciphertexts under the service's keys, but
+ * mini-backend's carry plaintext values and file paths. Requests that no
+ * route matches are not recorded.
+ *
+ * File layout (integers little-endian, see BinaryFraming.h):
+ *   "HETRAF01", uint16 length + service name, uint64 start (Unix us)
+ *   then per record: uint64 length of the rest, uint8 kind, and
+ *     kind 1 (request): uint64 id, uint64 arrival_us, uint8 flags (1: body
+ *       recorded), uint64 body_size, uint16 length + method, + target,
+ *       + endpoint, + content_type, then body_size bytes when recorded
+ *     kind 2 (outcome): uint64 id, uint32 service_us, uint16 status,
+ *       uint64 response_size
+ * A record cut short by a crash ends the log; everything before it reads.
+ */
+namespace traffic {
+
+    struct Request {
+        uint64_t id = 0;
+        uint64_t arrival_us = 0;     // Since the recording started; when the body had been read
+        bool body_recorded = false;
+        uint64_t body_size = 0;
+        std::string method;          // "GET", "POST", ...
+        std::string target;          // Path and query, e.g. "/binary/csv/sum?scheme=ckks"
+        std::string endpoint;        // Label for grouping, e.g. "POST /add_encrypted" (see metrics::endpoint_label)
+        std::string content_type;
+        std::string body;            // Empty unless body_recorded
+    };
+
+    struct Outcome {
+        uint64_t id = 0;
+        uint32_t service_us = 0;     // Middlewares and handler on the recording server
+        uint16_t status = 0;
+        uint64_t response_size = 0;
+    };
+
+    class Recorder {
+    public:
+        static Recorder& instance();
+
+        ~Recorder();
+
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        /**
+         * Start recording (once, at startup); the file is truncated
+         * @param path Log file; empty leaves recording off
+         * @param service Name written in the header, e.g. "main-backend"
+         * @param sample_ratio Fraction of requests to record, in (0, 1]
+         * @param bodies Whether to keep request bodies
+         * @param buffer_bytes Queued bytes beyond which records are dropped
+         * @throws std::invalid_argument for a ratio out of range
+         * @throws std::runtime_error if the file cannot be created
+         */
+        void configure(const std::string& path, const std::string& service, double sample_ratio, bool bodies,
+                       size_t buffer_bytes);
+        bool enabled() const { return writer.joinable(); }
+        bool bodies() const { return keep_bodies; }
+
+        // Whether to record the request being started (false when off)
+        bool sample() const;
+
+        // Id for the next request
+        uint64_t next_id() { return ids.fetch_add(1, std::memory_order_relaxed); }
+
+        // Microseconds since the recording started
+        uint64_t elapsed_us(std::chrono::steady_clock::time_point time) const;
+
+        // Queue a record; false if it was dropped for a full buffer
+        bool record(const Request& request);
+        bool record(const Outcome& outcome);
+
+        // Block until everything queued so far is written
+        void flush();
+
+    private:
+        std::ofstream file;
+        std::chrono::steady_clock::time_point start;
+        double sample_ratio = 1;
+        bool keep_bodies = true;
+        size_t capacity = 0;
+        std::atomic<uint64_t> ids{1};
+
+        std::mutex mutex;
+        std::condition_variable ready;    // Writer waits for records
+        std::condition_variable drained;  // flush() waits for the writer
+        std::string queue;                // Encoded records not yet written
+        uint64_t enqueued = 0;
+        uint64_t written = 0;
+        bool stopping = false;
+        std::thread writer;
+
+        Recorder() = default;
+        bool enqueue(std::string encoded);
+        void run();
+    };
+
+    // Sequential reader of a traffic log
+    class Reader {
+    public:
+        enum class Kind { end, request, outcome };
+
+        /**
+         * @throws std::runtime_error if the file cannot be opened or is not a traffic log
+         */
+        explicit Reader(const std::string& path);
+
+        const std::string& service() const { return service_name; }
+        uint64_t start_unix_us() const { return start_us; }
+
+        /**
+         * Read the next record into request or outcome, by its kind; end at
+         * the end of the log, or at a record cut short (then truncated())
+         */
+        Kind next(Request& request, Outcome& outcome);
+        bool truncated() const { return cut_short; }
+
+    private:
+        std::ifstream file;
+        std::string service_name;
+        uint64_t start_us = 0;
+        bool cut_short = false;
+    };
+}
+
+#endif // TRAFFIC_LOG_H
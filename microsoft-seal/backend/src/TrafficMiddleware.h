@@ -0,0 +1,65 @@
+#ifndef TRAFFIC_MIDDLEWARE_H
+#define TRAFFIC_MIDDLEWARE_H
+
+#include "crow.h"
+#include "Metrics.h"
+#include "TrafficLog.h"
+#include <chrono>
+
+/**
+ * Records requests into the traffic log for replay (--record-traffic, see
+ * TrafficLog.h)
+ *
+ * Listed first in the middleware list: its before_handle logs the request
+ * before any other middleware can answer it, and its after_handle runs
+ * last, so the outcome has the final status and response size and its
+ * handler time covers the other middlewares too. Does nothing unless
+ * recording is on.
+ */
+struct TrafficMiddleware {
+    struct context {
+        uint64_t id = 0;  // 0: not recorded
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        traffic::Recorder& recorder = traffic::Recorder::instance();
+        if (!recorder.sample()) return;
+        ctx.start = std::chrono::steady_clock::now();
+        traffic::Request request;
+        request.id = recorder.next_id();
+        request.arrival_us = recorder.elapsed_us(ctx.start);
+        request.body_recorded = recorder.bodies() && !req.body_spill;  // Spilled bodies are too large to keep
+        request.body_size = req.body_view().size();
+        request.method = crow::method_name(req.method);
+        request.target = req.raw_url;
+        request.endpoint = metrics::endpoint_label(request.method, req.url);
+        request.content_type = req.get_header_value("Content-Type");
+        if (request.body_recorded) request.body.swap(req.body);  // Lent to the record, not copied
+        const bool queued = recorder.record(request);
+        if (request.body_recorded) request.body.swap(req.body);
+        count(queued);
+        if (queued) ctx.id = request.id;
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (ctx.id == 0) return;
+        traffic::Outcome outcome;
+        outcome.id = ctx.id;
+        outcome.service_us = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - ctx.start)
+                .count());
+        outcome.status = static_cast<uint16_t>(res.code);
+        outcome.response_size = res.body.size();
+        count(traffic::Recorder::instance().record(outcome));
+    }
+
+private:
+    static void count(bool queued) {
+        metrics::counter("he_traffic_records_total", "Traffic log records queued for writing or dropped",
+                         {{"result", queued ? "queued" : "dropped"}})
+            .add();
+    }
+};
+
+#endif // TRAFFIC_MIDDLEWARE_H
@@ -0,0 +1,92 @@
+/**
+ * VitalsAggregates.cpp
+ *
+ * Per-patient windows of encrypted vitals sums, maintained one add per reading.
+ */
+
+#include "VitalsAggregates.h"
+#include <stdexcept>      // For std::invalid_argument, std::out_of_range
+#include <utility>        // For std::move
+
+VitalsAggregates::VitalsAggregates(uint64_t window_ms, size_t max_windows, size_t max_patients)
+    : window_length(window_ms), window_limit(max_windows), patient_limit(max_patients) {
+    if (!window_ms || !max_windows) throw std::invalid_argument("Vitals windows need a length and a count");
+}
+
+/**
+ * The first reading of a window becomes its sum as is; later ones are added
+ * into it. Opening a window past max_windows drops the oldest
+ */
+uint64_t VitalsAggregates::add(const HomomorphicEncryption& he, const std::string& patient, uint64_t timestamp_ms,
+                               seal::Ciphertext reading) {
+    const uint64_t start = timestamp_ms - timestamp_ms % window_length;
+    std::shared_ptr<Patient> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = patients.find(patient);
+        if (found == patients.end()) {
+            if (patients.size() >= patient_limit) throw std::invalid_argument("Too many patients");
+            found = patients.emplace(patient, std::make_shared<Patient>()).first;
+        }
+        entry = found->second;
+    }
+
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    auto& windows = entry->windows;
+    auto window = windows.find(start);
+    if (window != windows.end()) {
+        he.add_inplace(window->second.sum, reading);
+        window->second.count++;
+        return start;
+    }
+    if (windows.size() >= window_limit && start < windows.begin()->first) {
+        throw std::invalid_argument("Reading older than the patient's oldest window");
+    }
+    windows.emplace(start, Window{start, 1, std::move(reading)});
+    while (windows.size() > window_limit) windows.erase(windows.begin());
+    return start;
+}
+
+std::vector<VitalsAggregates::Window> VitalsAggregates::windows(const std::string& patient, uint64_t from_ms,
+                                                                uint64_t to_ms) const {
+    std::shared_ptr<Patient> entry = find(patient);
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    std::vector<Window> selected;
+    for (auto window = entry->windows.lower_bound(from_ms);
+         window != entry->windows.end() && window->first <= to_ms; ++window) {
+        selected.push_back(window->second);
+    }
+    return selected;
+}
+
+bool VitalsAggregates::erase(const std::string& patient) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return patients.erase(patient) > 0;
+}
+
+size_t VitalsAggregates::patient_count() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return patients.size();
+}
+
+size_t VitalsAggregates::data_bytes() const {
+    std::vector<std::shared_ptr<Patient>> entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.reserve(patients.size());
+        for (const auto& patient : patients) entries.push_back(patient.second);
+    }
+    size_t bytes = 0;
+    for (const auto& entry : entries) {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        for (const auto& window : entry->windows) bytes += window.second.sum.dyn_array().size() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+std::shared_ptr<VitalsAggregates::Patient> VitalsAggregates::find(const std::string& patient) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = patients.find(patient);
+    if (found == patients.end()) throw std::out_of_range("Unknown patient: " + patient);
+    return found->second;
+}
@@ -0,0 +1,85 @@
+#ifndef VITALS_AGGREGATES_H
+#define VITALS_AGGREGATES_H
+
+#include "HomomorphicEncryption.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Encrypted rolling aggregates of bedside vitals, by patient and time window
+ *
+ * Devices stream readings over WS /ws/vitals (see framing::Reading), each one
+ * ciphertext whose slots the server never interprets. By convention slot 2k
+ * holds vital k and slot 2k + 1 its square, e.g. [heart rate, its square,
+ * systolic, its square, diastolic, its square], so adding readings
+ * slot-wise keeps the sum and the sum of squares of every vital with one add
+ * per message. How many readings a window has is public (the server
+ * receives them) and counted in plaintext; the key holder derives means and
+ * variances (sum_sq / n - mean^2).
+ *
+ * Windows are window_ms long, aligned to the Unix epoch, by the readings'
+ * own timestamps. Each patient keeps its last max_windows windows: a reading
+ * that starts a later window drops the oldest, and one for a window before
+ * the oldest kept is refused. At most max_patients patients are held; others
+ * are refused until one is erased. Thread-safe, with one lock per patient, so
+ * readings of different patients are added concurrently.
+ */
+class VitalsAggregates {
+public:
+    struct Window {
+        uint64_t start_ms = 0;
+        uint64_t count = 0;
+        seal::Ciphertext sum;  // Slot-wise sum of the readings
+    };
+
+    VitalsAggregates(uint64_t window_ms, size_t max_windows, size_t max_patients);
+
+    uint64_t window_ms() const { return window_length; }
+    size_t max_windows() const { return window_limit; }
+
+    /**
+     * Add one reading, fresh from deserialization, into its patient's window
+     * @return Start of the window
+     * @throws std::invalid_argument for readings before the patient's oldest window, readings
+     *         that do not match the window's (level, scale, size), or new patients past max_patients
+     */
+    uint64_t add(const HomomorphicEncryption& he, const std::string& patient, uint64_t timestamp_ms,
+                 seal::Ciphertext reading);
+
+    /**
+     * Copies of a patient's windows that start in [from_ms, to_ms], oldest first
+     * @throws std::out_of_range for unknown patients
+     */
+    std::vector<Window> windows(const std::string& patient, uint64_t from_ms = 0,
+                                uint64_t to_ms = UINT64_MAX) const;
+
+    bool erase(const std::string& patient);
+
+    size_t patient_count() const;
+
+    // Bytes of ciphertext data held, over all patients
+    size_t data_bytes() const;
+
+private:
+    struct Patient {
+        mutable std::mutex mutex;
+        std::map<uint64_t, Window> windows;  // By start
+    };
+
+    const uint64_t window_length;
+    const size_t window_limit;
+    const size_t patient_limit;
+
+    mutable std::mutex mutex;  // The map only; each patient's windows are under its own mutex
+    std::unordered_map<std::string, std::shared_ptr<Patient>> patients;
+
+    std::shared_ptr<Patient> find(const std::string& patient) const;
+};
+
+#endif // VITALS_AGGREGATES_H
@@ -0,0 +1,62 @@
+/**
+ * WasmBindings.cpp
+ *
+ * JavaScript API of the he-wasm module (Emscripten builds only, see
+ * scripts/build-wasm.sh): packed public-key encryption in the browser, with
+ * the same parameters and encoding as the backends, so the frontend encrypts
+ * a whole CSV column locally instead of calling /encrypt once per value.
+ *
+ *   const module = await createHeModule();
+ *   const encryptor = new module.Encryptor("ckks", publicKey, "");  // GET /public_key
+ *   const ciphertexts = encryptor.encryptVector(values);  // Array or Float64Array
+ *   // POST /csv/sum {"scheme": "ckks", "packed": true, "encrypted_values": ciphertexts}
+ *   encryptor.delete();
+ */
+
+#include "HomomorphicEncryption.h"
+#include "ParameterProfile.h"
+#include <emscripten/bind.h>
+#include <emscripten/val.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    /**
+     * Holds only the public key; embind exposes this as module.Encryptor
+     * Failures surface to JavaScript as exceptions (the module is built with -fexceptions)
+     */
+    class WasmEncryptor {
+    public:
+        /**
+         * @param scheme "bfv", "ckks" or "bgv"
+         * @param public_key Base64 public key from mini-backend's GET /public_key
+         * @param profile Profile name the key was requested with ("" for the default)
+         */
+        WasmEncryptor(const std::string& scheme, const std::string& public_key, const std::string& profile) {
+            he = std::make_unique<HomomorphicEncryption>(
+                parse_scheme(scheme), false, profile.empty() ? profiles::default_profile() : profiles::get(profile));
+            he->load_public_key(public_key);
+        }
+
+        size_t slot_count() const { return he->slot_count(); }
+
+        // Base64 ciphertexts of slotCount() values each, as encrypt_vector returns them
+        emscripten::val encrypt_vector(const emscripten::val& values) const {
+            std::vector<double> numbers = emscripten::convertJSArrayToNumberVector<double>(values);
+            emscripten::val ciphertexts = emscripten::val::array();
+            for (auto& ciphertext : he->encrypt_vector(numbers)) ciphertexts.call<void>("push", ciphertext);
+            return ciphertexts;
+        }
+
+    private:
+        std::unique_ptr<HomomorphicEncryption> he;
+    };
+}
+
+EMSCRIPTEN_BINDINGS(he_wasm) {
+    emscripten::class_<WasmEncryptor>("Encryptor")
+        .constructor<std::string, std::string, std::string>()
+        .function("slotCount", &WasmEncryptor::slot_count)
+        .function("encryptVector", &WasmEncryptor::encrypt_vector);
+}
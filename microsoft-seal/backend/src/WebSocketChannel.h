@@ -0,0 +1,59 @@
+#ifndef WEBSOCKET_CHANNEL_H
+#define WEBSOCKET_CHANNEL_H
+
+#include "crow.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Thread-safe sender bound to a Crow websocket connection
+ *
+ * Crow destroys a connection right after its onclose handler returns, so
+ * worker threads must never touch it afterwards. The route's onclose calls
+ * mark_closed(), which waits for an in-progress send and turns every later
+ * send into a no-op returning false; producers use that to stop early.
+ */
+class WebSocketChannel {
+public:
+    explicit WebSocketChannel(crow::websocket::connection& conn) : conn(&conn) {}
+
+    // Queue a text frame; false if the client has gone away
+    bool send_text(std::string message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!conn) return false;
+        conn->send_text(std::move(message));
+        return true;
+    }
+
+    // Queue a binary frame; false if the client has gone away
+    bool send_binary(std::string message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!conn) return false;
+        conn->send_binary(std::move(message));
+        return true;
+    }
+
+    // Server-initiated close once a stream is complete
+    void close(const std::string& reason = "done") {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (conn) conn->close(reason);
+    }
+
+    // Called from the route's onclose handler
+    void mark_closed() {
+        std::lock_guard<std::mutex> lock(mutex);
+        conn = nullptr;
+    }
+
+    bool is_open() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return conn != nullptr;
+    }
+
+private:
+    std::mutex mutex;
+    crow::websocket::connection* conn;
+};
+
+#endif // WEBSOCKET_CHANNEL_H
@@ -0,0 +1,83 @@
+/**
+ * ZeroPool.cpp
+ *
+ * Background refill and one-shot hand-out of precomputed encryptions of zero.
+ */
+
+#include "ZeroPool.h"
+#include "Metrics.h"
+#include <chrono>         // For the retry interval without keys
+#include <iostream>       // For std::cerr
+#include <utility>        // For std::move
+
+namespace {
+    metrics::Counter& takes(const char* result) {
+        return metrics::counter("he_zero_pool_total", "Encryptions by whether a precomputed zero was used (hit, miss)",
+                                {{"result", result}});
+    }
+}
+
+ZeroPool::ZeroPool(size_t capacity, Fill fill)
+    : max_size(capacity), fill(std::move(fill)), worker([this] { run(); }) {}
+
+ZeroPool::~ZeroPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    not_full.notify_all();
+    worker.join();
+}
+
+/**
+ * Zeros are made outside the lock, so take() never waits for one. A zero
+ * under a new key set means the ones before it are stale
+ */
+void ZeroPool::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (entries.size() >= max_size) {
+            not_full.wait(lock);
+            continue;
+        }
+        lock.unlock();
+        Entry entry;
+        try {
+            entry.key_set = fill(entry.zero);
+        } catch (const std::exception& e) {
+            std::cerr << "Zero pool fill failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+        if (!entry.key_set) {
+            // No keys yet (the pool is set up before they are loaded), or a failure
+            not_full.wait_for(lock, std::chrono::milliseconds(100));
+            continue;
+        }
+        if (!entries.empty() && entries.back().key_set != entry.key_set) entries.clear();
+        entries.push_back(std::move(entry));
+    }
+}
+
+bool ZeroPool::take(const void* key_set, seal::Ciphertext& zero) {
+    static metrics::Counter& hits = takes("hit");
+    static metrics::Counter& misses = takes("miss");
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!entries.empty() && entries.front().key_set.get() != key_set) entries.clear();
+        if (entries.empty()) {
+            misses.add();
+            not_full.notify_one();
+            return false;
+        }
+        zero = std::move(entries.front().zero);
+        entries.pop_front();
+    }
+    hits.add();
+    not_full.notify_one();
+    return true;
+}
+
+size_t ZeroPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
@@ -0,0 +1,73 @@
+#ifndef ZERO_POOL_H
+#define ZERO_POOL_H
+
+#include "seal/seal.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * Public-key encryptions of zero made ahead of time by a background thread
+ *
+ * Encrypting is mostly making an encryption of zero (sampling u, e1, e2 and
+ * NTTs of pk * u); the value itself is one add_plain on top. With the zeros
+ * made between requests, an encryption on the request path is encode plus
+ * add. Each zero is handed out once and then gone: reusing one would let two
+ * ciphertexts be subtracted into the difference of their plaintexts.
+ *
+ * Every zero is tagged with the key set it was made under, and take() hands
+ * out only zeros of the key set the caller encrypts with, so after a key
+ * update the stale ones are dropped rather than used. When the pool is empty
+ * the caller encrypts as usual. Hits and misses are exported as
+ * he_zero_pool_total{result=...}. Thread-safe.
+ */
+class ZeroPool {
+public:
+    /**
+     * Make one encryption of zero under the current keys
+     * @return The key set it was made under, or nullptr if there is no public key yet
+     */
+    using Fill = std::function<std::shared_ptr<const void>(seal::Ciphertext& zero)>;
+
+    /**
+     * @param capacity Zeros kept ready (about 2 * N * L * 8 bytes each)
+     * @param fill Runs on the pool's thread
+     */
+    ZeroPool(size_t capacity, Fill fill);
+    ~ZeroPool();
+
+    ZeroPool(const ZeroPool&) = delete;
+    ZeroPool& operator=(const ZeroPool&) = delete;
+
+    /**
+     * Move a zero made under key_set into zero
+     * @return false if there is none (the caller encrypts without the pool)
+     */
+    bool take(const void* key_set, seal::Ciphertext& zero);
+
+    size_t size() const;
+    size_t capacity() const { return max_size; }
+
+private:
+    struct Entry {
+        std::shared_ptr<const void> key_set;
+        seal::Ciphertext zero;
+    };
+
+    const size_t max_size;
+    Fill fill;
+
+    mutable std::mutex mutex;
+    std::condition_variable not_full;
+    std::deque<Entry> entries;  // Oldest first
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+};
+
+#endif // ZERO_POOL_H
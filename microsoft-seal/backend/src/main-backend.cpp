@@ -8,23 +8,82 @@
 
 #include "crow.h"                    // Crow HTTP framework for REST API
 #include "HomomorphicEncryption.h"   // Our custom homomorphic encryption wrapper
+#include "EncryptedValue.h"          // Typed ciphertexts for in-process composition
 #include "CORSMiddleware.h"          // CORS middleware for cross-origin requests
+#include "MetricsMiddleware.h"       // Request latency metrics for GET /metrics
+#include "TraceMiddleware.h"         // W3C trace context and OTLP spans per request
+#include "ScratchArenaMiddleware.h"  // Per-request reset of SEAL scratch arenas
+#include "CiphertextPool.h"          // Per-thread reuse of ciphertext allocations (--ciphertext-pool-mb)
+#include "TenantMiddleware.h"        // X-Tenant-ID and the tenant engines a request holds
+#include "RouteHintMiddleware.h"     // X-HE-Route-Key / X-HE-Replica hints for stateless replicas
+#include "CancellationMiddleware.h"  // X-Deadline-Ms and client disconnects stop long operations
+#include "TrafficMiddleware.h"       // --record-traffic: requests logged for he-replay
+#include "ThreadPool.h"              // Worker pool for parallel reductions
+#include "BinaryFraming.h"           // Length-prefixed framing for binary bodies
+#include "Base64.h"                  // Decoding posted Galois keys once for /cluster/galois_keys
+#include "JsonStream.h"              // In-place reading of /csv/sum's ciphertext array
+#include "KeyStore.h"                // Persistent key set shared with mini-backend
+#include "CiphertextStore.h"         // Server-side encrypted columns addressed by handle
+#include "ObjectStore.h"             // Cold tier of the column store (--store-cold)
+#include "JobQueue.h"                // Asynchronous jobs for long-running operations
+#include "WebSocketChannel.h"        // Thread-safe websocket sends for job updates
+#include "ServerConfig.h"            // Command line / environment options
+#include "HttpOptions.h"             // Keep-alive, body limit and socket options of the Crow server
+#include "Logger.h"                  // Asynchronous, level-filtered request logging
+#include "CpuFeatures.h"             // Startup report of the SEAL kernel path and PRNG
+#include "SealExecutor.h"            // SEAL key generation and opt-in RNS-parallel operations on compute_pool
+#include "ExpressionEvaluator.h"     // Lazy relinearization/rescaling for /store/dot
+#include "PolynomialEvaluator.h"     // Paterson-Stockmeyer evaluation for /evaluate_polynomial
+#include "InverseApproximation.h"    // Plans of /inverse and /csv/standardize
+#include "ProfileRegistry.h"         // Per-profile contexts and keys, created on first use
+#include "TenantRegistry.h"          // Per-tenant key sets, loaded on first use
+#include "NumaTopology.h"            // Per-node compute pools and engine replicas (--numa)
+#include "PoolTrimmer.h"             // Idle-time release of SEAL pool memory
+#include "Prefork.h"                 // Worker processes per core group (--prefork)
+#include "Profiler.h"                // In-process CPU sampling for /admin/profile
+#include "ResultCache.h"             // Replayed responses of repeated aggregation queries
+#include "MemoryBudget.h"            // One memory bound, TTLs and tenant quotas over the caches
+#include "AdmissionControl.h"        // Cost-limited concurrency of the CPU-heavy endpoints
+#include "QueryPlanner.h"            // Calibrated cost model and plans for POST /plan and the aggregates
+#include "Cluster.h"                 // Worker nodes and sharded columns for the /cluster endpoints
+#include "AsyncHandler.h"            // Responses of the /cluster sums, sent once the workers answer
+#include "SharedRegion.h"            // Same-host ciphertext handoff from mini-backend (--shm-handoff)
+#include "NodeRpc.h"                 // Binary node-to-node listener (--rpc-port)
+#include "ColumnFile.h"              // Encrypted column files in --column-dir
+#include "LogisticModel.h"           // Models for /ml/logreg/predict
+#include "DiagonalMatrix.h"          // Halevi-Shoup matrix-vector products for /ml/matvec
+#include "FeatureScaler.h"           // Standardization folded into /ml/matvec or applied for /ml/kmeans/distances
+#include "CentroidPacking.h"         // Patients repeated per centroid for /ml/kmeans/distances
+#include "SlotPermutation.h"         // Masked-rotation layout conversions for /csv/relayout
+#include "NormalEquations.h"         // Least-squares aggregates for /ml/linreg/aggregate
+#include "RefreshMasks.h"            // Masks of ciphertexts out for /refresh/mask and /refresh/unmask
+#include "RowFilter.h"               // WHERE clauses on public columns for /csv/filtered_sums
+#include "AggregateQuery.h"          // SUM/AVG/COUNT/VAR ... WHERE ... GROUP BY for POST /query
+#include "RollupCube.h"              // Pre-aggregated encrypted totals by date and category for /rollups
+#include "PrivateSetIntersection.h"  // Server sets of private set intersection for /psi/sets
+#include "VitalsAggregates.h"        // Per-patient windows of encrypted vitals for /ws/vitals
+#include "RandomHandle.h"            // Handles of rollups and PSI sets
+#include <algorithm>                 // For std::min, std::max
+#include <atomic>                    // For the vitals connections' counts
+#include <cctype>                    // For validating column names
+#include <cstdio>                    // For std::remove of column files
 #include <chrono>                    // For performance timing measurements
-
-// Platform-specific includes for memory usage monitoring
-#if defined(_WIN32)
-    #include <windows.h>
-    #include <psapi.h>
-#else
-    #include <sys/resource.h>
-#endif
+#include <filesystem>                // For scanning --model-dir
+#include <fstream>                   // For reading model files
+#include <functional>                // For the stored aggregates' reductions
+#include <future>                    // For building the engines in parallel
+#include <limits>                    // For the unset pool limit
+#include <map>                       // For the loaded models by name
+#include <mutex>                     // For the encoded model matrices
+#include <sstream>                   // For splitting --workers
+#include <tuple>                     // For the layout conversions by column count and layout
 
 /**
  * Prints a session start delimiter for console logging
  * Used to visually separate different operations in the console output
  */
 void print_session_start() {
-    std::cout << "---------------------------\n";
+    HE_LOG(Info) << "---------------------------";
 }
 
 /**
@@ -32,7 +91,7 @@ void print_session_start() {
  * Used to visually separate different operations in the console output
  */
 void print_session_end() {
-    std::cout << "---------------------------\n";
+    HE_LOG(Info) << "---------------------------";
 }
 
 /**
@@ -42,9 +101,664 @@ void print_session_end() {
  * @param ct The ciphertext string to log
  * @return A truncated version of the ciphertext (first 20 characters) or "[EMPTY]" if empty
  */
-static std::string log_cipher(const std::string& ct) {
+static std::string log_cipher(std::string_view ct) {
     if (ct.empty()) return "[EMPTY]";
-    return ct.substr(0, std::min(20, (int)ct.length()));
+    return std::string(ct.substr(0, 20));
+}
+
+/**
+ * A JSON string as a view into the parsed body, so ciphertexts are not copied out of the DOM
+ * 
+ * @param value String value; the view is valid as long as the document it belongs to
+ * @return The (unescaped) text
+ */
+static std::string_view json_view(const crow::json::rvalue& value) {
+    auto text = value.s();
+    return std::string_view(text.begin(), text.size());
+}
+
+// The strings of a JSON array (e.g. "encrypted_values") as views, see json_view
+static CiphertextViews json_views(const crow::json::rvalue& array) {
+    CiphertextViews views;
+    views.reserve(array.size());
+    for (const auto& value : array) views.push_back(json_view(value));
+    return views;
+}
+
+/**
+ * PSI parameters from JSON, each optional: {"bundles": 4, "partition_size": 32, "window_bits": 2}
+ * @throws std::invalid_argument for values out of range (see PsiParameters::validate)
+ */
+static PsiParameters parse_psi_parameters(const crow::json::rvalue& json) {
+    PsiParameters parameters;
+    if (json.has("bundles")) parameters.bundles = static_cast<size_t>(json["bundles"].u());
+    if (json.has("partition_size")) parameters.partition_size = static_cast<size_t>(json["partition_size"].u());
+    if (json.has("window_bits")) parameters.window_bits = static_cast<size_t>(json["window_bits"].u());
+    parameters.validate();
+    return parameters;
+}
+
+/**
+ * Build an application/octet-stream response for the binary transport endpoints
+ * 
+ * @param body Raw response bytes
+ * @return Crow response with status 200 and binary content type
+ */
+static crow::response binary_response(std::string body) {
+    crow::response res(200, std::move(body));
+    res.set_header("Content-Type", "application/octet-stream");
+    return res;
+}
+
+/**
+ * Contiguous, balanced ranges splitting count ciphertexts into at most parts shards
+ * 
+ * @return [begin, end) of every shard, none empty
+ */
+static std::vector<std::pair<size_t, size_t>> shard_ranges(size_t count, size_t parts) {
+    parts = std::min(parts, count);
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (size_t i = 0, begin = 0; i < parts; i++) {
+        size_t end = begin + count / parts + (i < count % parts ? 1 : 0);
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+    return ranges;
+}
+
+/**
+ * Why a call to a worker did not produce a result
+ * 
+ * @return "" for a 200 response, else the worker and its error
+ */
+static std::string shard_failure(const Cluster::Outcome& outcome) {
+    if (!outcome.error.empty()) return outcome.worker + ": " + outcome.error;
+    if (outcome.response.status == 200) return "";
+    auto body = crow::json::load(outcome.response.body);
+    std::string detail = body && body.has("error") ? std::string(body["error"].s()) : outcome.response.body;
+    return outcome.worker + ": HTTP " + std::to_string(outcome.response.status) + " " + detail;
+}
+
+/**
+ * Column store handle a worker answered PUT /binary/store (or its RPC form) with
+ * 
+ * @return The handle, or "" if the outcome is not a stored shard
+ */
+static std::string shard_handle(const Cluster::Outcome& outcome) {
+    if (!shard_failure(outcome).empty()) return "";
+    if (outcome.rpc) return outcome.response.body;
+    auto stored = crow::json::load(outcome.response.body);
+    return stored && stored.has("handle") ? std::string(stored["handle"].s()) : "";
+}
+
+/**
+ * Path of a column file in --column-dir
+ * 
+ * @param name Letters, digits, '-', '_' and '.', not starting with '.'
+ * @throws std::invalid_argument for other names, or if there is no --column-dir
+ */
+static std::string column_file_path(const std::string& dir, const std::string& name) {
+    if (dir.empty()) throw std::invalid_argument("Column files need --column-dir");
+    bool valid = !name.empty() && name.size() <= 200 && name[0] != '.';
+    for (char c : name) {
+        valid = valid && (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.');
+    }
+    if (!valid) throw std::invalid_argument("Invalid column name: " + name);
+    return dir + "/" + name + ".hecol";
+}
+
+/**
+ * Sum of the blocks of a column file that start in rows [begin_row, end_row)
+ * 
+ * @param chunk_bytes Bytes of blocks added per step (see below)
+ * @param blocks If given, set to the number of blocks summed
+ * @throws std::invalid_argument if the file has other parameters or the range holds no block
+ * 
+ * Uncompressed blocks are added as views of the mapping, without copying
+ * them to the heap; compressed ones are decoded as the adds need them. The
+ * range is walked in chunks of about chunk_bytes, and the reads of the next
+ * chunk are started (ColumnFile::prefetch) before the current one is added
+ * on the compute pool, so on a column that is not in the page cache the disk
+ * reads overlap the adds instead of faulting in one page at a time, and a
+ * column larger than memory only ever needs about two chunks of it resident.
+ * Column files are only written by the backends, from ciphertexts validated on
+ * upload, so blocks are loaded trusted (metadata and size checked, not every
+ * coefficient).
+ */
+static seal::Ciphertext column_file_sum(const HomomorphicEncryption& he, const ColumnFile& file, size_t begin_row,
+                                        size_t end_row, size_t chunk_bytes, size_t* blocks = nullptr) {
+    if (!file.matches(*he.seal_context())) {
+        throw std::invalid_argument("The column file was written with other encryption parameters");
+    }
+    auto range = file.block_range(begin_row, end_row);
+    if (range.first == range.second) throw std::invalid_argument("No column blocks start in the requested rows");
+    if (blocks) *blocks = range.second - range.first;
+
+    // Blocks [first, next_chunk(first)) hold about chunk_bytes (at least one block)
+    auto next_chunk = [&](size_t first) {
+        size_t last = first, bytes = 0;
+        while (last < range.second && (last == first || bytes < chunk_bytes)) {
+            bytes += static_cast<size_t>(file.blocks()[last++].size);
+        }
+        return last;
+    };
+
+    const bool viewable = file.layout().compression == seal::compr_mode_type::none;
+    seal::Ciphertext result;
+    size_t first = range.first;
+    size_t last = next_chunk(first);
+    file.prefetch(first, last);
+    while (first < range.second) {
+        const size_t following = next_chunk(last);
+        file.prefetch(last, following);
+
+        // The running result is the first operand of every later chunk
+        if (viewable) {
+            std::vector<seal::Ciphertext> operands;
+            operands.reserve(last - first + 1);
+            if (first > range.first) operands.push_back(std::move(result));
+            for (size_t block = first; block < last; block++) {
+                operands.push_back(file.view(*he.seal_context(), block, false));
+            }
+            result = he.sum(operands);
+        } else {
+            seal::Ciphertext chunk =
+                he.deserialize_sum(file.views(first, last), WireFormat::binary, LoadCheck::trusted);
+            result = first > range.first ? he.add(result, chunk) : std::move(chunk);
+        }
+        first = last;
+        last = following;
+    }
+    return result;
+}
+
+// DELETE /store/<handle> of a shard on its worker, over RPC where the worker has it
+static Cluster::Call delete_shard(const Cluster::Shard& shard, const std::string& scheme) {
+    Cluster::Call call{ { shard.worker }, "DELETE", "/store/" + shard.handle + "?scheme=" + scheme, "" };
+    call.rpc = { { node_rpc::Op::store_delete, scheme, "", shard.handle } };
+    return call;
+}
+
+/**
+ * Per-shard report of a Cluster::scatter for the /cluster responses
+ * 
+ * @param counts Ciphertexts of each shard
+ * @return [{ "worker", "count", "elapsed_ms", "attempts", "error" (failed shards only) }, ...]
+ */
+static std::vector<crow::json::wvalue> shard_timings(const std::vector<Cluster::Outcome>& outcomes,
+                                                     const std::vector<size_t>& counts) {
+    std::vector<crow::json::wvalue> shards;
+    for (size_t i = 0; i < outcomes.size(); i++) {
+        crow::json::wvalue entry;
+        entry["worker"] = outcomes[i].worker;
+        entry["count"] = counts[i];
+        entry["elapsed_ms"] = outcomes[i].elapsed_ms;
+        entry["attempts"] = outcomes[i].attempts;
+        std::string failure = shard_failure(outcomes[i]);
+        if (!failure.empty()) entry["error"] = failure;
+        shards.push_back(std::move(entry));
+    }
+    return shards;
+}
+
+/**
+ * A response as kept by ResultCache
+ * 
+ * @param res Complete response (body and headers set)
+ * @return Status, body and headers, for replay()
+ */
+static ResultCache::Result cache_entry(const crow::response& res) {
+    ResultCache::Result result;
+    result.status = res.code;
+    result.body = res.body;
+    for (const auto& header : res.headers) result.headers.emplace_back(header.first, header.second);
+    return result;
+}
+
+// The response a ResultCache entry was made from, with an X-HE-Result-Cache header saying how it was found
+static crow::response replay(const ResultCache::Result& result, const char* source) {
+    crow::response res(result.status, result.body);
+    for (const auto& header : result.headers) res.set_header(header.first, header.second);
+    res.set_header("X-HE-Result-Cache", source);
+    return res;
+}
+
+/**
+ * Running value of an aggregate of a stored column, materialized on first read
+ * (see CiphertextStore::aggregate) and updated by every append
+ * 
+ * @param aggregate "sum", "sum_of_squares" or "histogram" (of one-hot encodings, see /csv/histogram)
+ * @param packed Fold the slots of the result, as /csv/sum does; kept as an aggregate of its own,
+ *               so reads skip the rotations
+ * @param bucket_count Buckets of a histogram
+ * @throws std::invalid_argument for unknown aggregates or unsupported parameters
+ * @throws std::out_of_range for unknown handles
+ */
+static seal::Ciphertext stored_aggregate(const HomomorphicEncryption& he, CiphertextStore& store,
+                                         const std::string& handle, const std::string& aggregate, bool packed,
+                                         size_t bucket_count = 0) {
+    std::function<seal::Ciphertext(const seal::Ciphertext*, size_t)> reduce;
+    std::string name = aggregate;
+    if (aggregate == "sum") {
+        reduce = [&he](const seal::Ciphertext* ciphertexts, size_t count) { return he.sum(ciphertexts, count); };
+    } else if (aggregate == "sum_of_squares") {
+        if (he.parameter_profile().depth < 1) {
+            throw std::invalid_argument("Squaring needs a profile with multiplicative depth >= 1, not " +
+                                        he.parameter_profile().name);
+        }
+        if (!he.has_relin_keys()) throw std::runtime_error("Relinearization keys not loaded");
+        // One relinearization (and rescale or BGV modulus switch) per append, not per ciphertext
+        reduce = [&he](const seal::Ciphertext* ciphertexts, size_t count) {
+            seal::Ciphertext squares = he.multiply(ciphertexts[0], ciphertexts[0]);
+            for (size_t i = 1; i < count; i++) he.add_inplace(squares, he.multiply(ciphertexts[i], ciphertexts[i]));
+            he.relinearize_inplace(squares);
+            if (he.rescales()) he.rescale_inplace(squares);
+            return squares;
+        };
+    } else if (aggregate == "histogram") {
+        name += "/" + std::to_string(bucket_count);
+        packed = false;  // Slots are folded per bucket already
+        reduce = [&he, bucket_count](const seal::Ciphertext* ciphertexts, size_t count) {
+            return he.histogram(ciphertexts, count, bucket_count);
+        };
+    } else {
+        throw std::invalid_argument("Unknown aggregate: " + aggregate);
+    }
+    if (packed) name += "/packed";
+
+    return store.aggregate(handle, name, [&he, reduce, packed](seal::Ciphertext& value,
+                                                              const seal::Ciphertext* ciphertexts, size_t count) {
+        seal::Ciphertext partial = reduce(ciphertexts, count);
+        if (packed) he.sum_slots_inplace(partial);
+        if (value.size() == 0) {
+            value = std::move(partial);
+        } else {
+            he.add_inplace(value, partial);
+        }
+    });
+}
+
+/**
+ * Slots the last of a packed column's ciphertexts fills, from a request's
+ * optional "packed_count": the values packed slot_count() per ciphertext from
+ * slot 0 up, i.e. the "count" /encrypt_vector and /csv/encrypt return
+ * 
+ * @param he Engine of the column
+ * @param ciphertexts Ciphertexts in the request
+ * @param packed_count Values in them (0 = not given)
+ * @return Slots of the last ciphertext holding values; 0 if packed_count is 0
+ * @throws std::invalid_argument if that many values do not take this many ciphertexts
+ */
+static size_t packed_last_slots(const HomomorphicEncryption& he, size_t ciphertexts, size_t packed_count) {
+    if (packed_count == 0) return 0;
+    const size_t slots = he.slot_count();
+    if (ciphertexts == 0 || (packed_count + slots - 1) / slots != ciphertexts) {
+        throw std::invalid_argument(std::to_string(packed_count) + " packed values do not take " +
+                                    std::to_string(ciphertexts) + " ciphertexts of " + std::to_string(slots) +
+                                    " slots");
+    }
+    return packed_count - (ciphertexts - 1) * slots;
+}
+
+/**
+ * Packing of small appends into a stored column's partially filled last
+ * ciphertext (see CiphertextStore::Merge): the new values are rotated behind
+ * the stored ones and added in, one key switch per set bit of the offset,
+ * instead of keeping a mostly empty ciphertext. Without Galois keys, or for
+ * ciphertexts at different levels or scales, appends stay separate
+ * 
+ * @param he Engine of the store
+ */
+static CiphertextStore::Merge store_merge(const HomomorphicEncryption& he) {
+    return [&he](seal::Ciphertext& last, seal::Ciphertext& partial, size_t used, size_t slots) {
+        if (last.parms_id() != partial.parms_id() || last.size() != partial.size() ||
+            last.scale() != partial.scale() || !he.has_galois_key(1)) {
+            return false;
+        }
+        if (!he.shift_slots_inplace(partial, used, slots)) return false;
+        he.add_inplace(last, partial);
+        return true;
+    };
+}
+
+/**
+ * Resolve the compression mode for a request
+ * 
+ * @param name Compression requested by the client ("none", "zlib", "zstd", "bitpack") or nullptr
+ * @param fallback Server default used when the client did not ask for one
+ * @return SEAL compression mode
+ * @throws std::invalid_argument for unknown or unavailable modes
+ */
+static seal::compr_mode_type request_compression(const char* name, seal::compr_mode_type fallback) {
+    return name ? parse_compr_mode(name) : fallback;
+}
+
+// Same as above for JSON requests, reading the optional "compression" field
+static seal::compr_mode_type request_compression(const crow::json::rvalue& json, seal::compr_mode_type fallback) {
+    return json.has("compression") ? parse_compr_mode(json["compression"].s()) : fallback;
+}
+
+/**
+ * Parameter profile of a JSON request: "profile" by name; else, with
+ * "precision_bits", "security" or "dnum", parameters selected for "depth",
+ * those and "integer_bits" (CKKS); else the smallest built-in profile
+ * supporting "depth"
+ * 
+ * @return The profile, or nullptr if the request names none of these (server default)
+ * @throws std::out_of_range for unknown profiles or unsupported depths
+ * @throws std::invalid_argument if no parameters meet the requirements
+ */
+static const ParameterProfile* request_profile(const crow::json::rvalue& json) {
+    if (json.has("profile")) return &profiles::get(json["profile"].s());
+    if (json.has("precision_bits") || json.has("security") || json.has("dnum")) {
+        ParameterRequirements requirements;
+        requirements.use_ckks = json.has("scheme") && json["scheme"].s() == "ckks";
+        if (json.has("depth")) requirements.depth = static_cast<size_t>(json["depth"].i());
+        if (json.has("precision_bits")) requirements.precision_bits = static_cast<int>(json["precision_bits"].i());
+        if (json.has("integer_bits")) requirements.integer_bits = static_cast<int>(json["integer_bits"].i());
+        if (json.has("security")) requirements.security = profiles::parse_security(static_cast<int>(json["security"].i()));
+        if (json.has("dnum")) requirements.dnum = static_cast<size_t>(json["dnum"].i());
+        return &profiles::select(requirements);
+    }
+    if (json.has("depth")) return &profiles::for_depth(static_cast<size_t>(json["depth"].i()));
+    return nullptr;
+}
+
+// Same as above for binary requests, reading ?profile= or ?depth=
+static const ParameterProfile* request_profile(const crow::query_string& params) {
+    if (const char* name = params.get("profile")) return &profiles::get(name);
+    if (const char* depth = params.get("depth")) return &profiles::for_depth(std::stoul(depth));
+    return nullptr;
+}
+
+/**
+ * Coefficients (of x^0, x^1, ...) of a named polynomial activation
+ * 
+ * sigmoid: 0.5 + 0.1973 x - 0.0048 x^3, the fit fullyEndtoEndLogisticRegression.py
+ *          uses (within 0.01 of the sigmoid for |x| <= 4)
+ * square:  x^2, as in CryptoNets-style networks
+ * @throws std::invalid_argument for other names
+ */
+static std::vector<double> activation_coefficients(const std::string& name) {
+    if (name == "sigmoid") return {0.5, 0.1973, 0.0, -0.0048};
+    if (name == "square") return {0.0, 0.0, 1.0};
+    throw std::invalid_argument("Unknown activation: " + name);
+}
+
+/**
+ * Logistic regression model from JSON, as exported by
+ * machine-learning/concrete_LogisticRegression.py:
+ * { "weights": [...], "bias": -0.9,
+ *   "mean": [...], "scale": [...],  // optional standardization, folded into the weights
+ *   "features": ["Glucose", ...],   // optional, packing order
+ *   "sigmoid": [0.5, 0.1973, 0, -0.0048] }  // optional, default activation_coefficients("sigmoid")
+ *
+ * @throws std::invalid_argument for missing weights or mismatched sizes
+ */
+static LogisticModel parse_logistic_model(const crow::json::rvalue& json) {
+    if (!json.has("weights")) throw std::invalid_argument("Model has no weights");
+    LogisticModel model;
+    for (const auto& weight : json["weights"]) model.weights.push_back(weight.d());
+    if (json.has("bias")) model.bias = json["bias"].d();
+    if (json.has("features")) {
+        for (const auto& feature : json["features"]) model.features.push_back(feature.s());
+    }
+    if (json.has("sigmoid")) {
+        for (const auto& coefficient : json["sigmoid"]) model.sigmoid.push_back(coefficient.d());
+    } else {
+        model.sigmoid = activation_coefficients("sigmoid");
+    }
+    if (json.has("mean") || json.has("scale")) {
+        std::vector<double> mean, scale;
+        if (json.has("mean")) for (const auto& value : json["mean"]) mean.push_back(value.d());
+        if (json.has("scale")) for (const auto& value : json["scale"]) scale.push_back(value.d());
+        model.fold_standardization(mean, scale);
+    }
+    return model;
+}
+
+/**
+ * Rows of a JSON matrix: [[w00, w01, ...], [w10, ...], ...]
+ */
+static std::vector<std::vector<double>> parse_matrix(const crow::json::rvalue& json) {
+    std::vector<std::vector<double>> rows;
+    for (const auto& row : json) {
+        rows.emplace_back();
+        for (const auto& entry : row) rows.back().push_back(entry.d());
+    }
+    return rows;
+}
+
+/**
+ * Optional "mean" and "scale" of a model or request (StandardScaler's mean_ and
+ * scale_); empty if it has neither
+ */
+static Standardization parse_standardization(const crow::json::rvalue& json) {
+    Standardization standardization;
+    if (json.has("mean")) for (const auto& value : json["mean"]) standardization.mean.push_back(value.d());
+    if (json.has("scale")) for (const auto& value : json["scale"]) standardization.scale.push_back(value.d());
+    return standardization;
+}
+
+// A dense layer W x + b for /ml/matvec
+struct MatrixModel {
+    std::vector<std::vector<double>> rows;
+    std::vector<double> bias;  // Empty, or one per row
+};
+
+/**
+ * Dense layer from JSON:
+ * { "matrix": [[...], ...],
+ *   "bias": [...],                  // optional, one per row
+ *   "mean": [...], "scale": [...] } // optional standardization of x, folded into matrix and bias
+ *
+ * @throws std::invalid_argument for mismatched sizes or a zero scale
+ */
+static MatrixModel parse_matrix_model(const crow::json::rvalue& json) {
+    MatrixModel model;
+    model.rows = parse_matrix(json["matrix"]);
+    if (json.has("bias")) for (const auto& value : json["bias"]) model.bias.push_back(value.d());
+    if (!model.bias.empty() && model.bias.size() != model.rows.size()) {
+        throw std::invalid_argument("Expected one bias per matrix row");
+    }
+    Standardization standardization = parse_standardization(json);
+    if (!standardization.mean.empty() || !standardization.scale.empty()) {
+        standardization.fold(model.rows, model.bias);
+    }
+    return model;
+}
+
+/**
+ * One filter: [{"column": "Admission Type", "op": "eq", "value": "Emergency"},
+ * ...], an AND of predicates; "op" defaults to "eq", and "value" is a list
+ * for "in" and "between". Numbers are kept as written
+ * 
+ * @throws std::invalid_argument for an unknown op or a predicate without column or value
+ */
+static RowFilter parse_row_filter(const crow::json::rvalue& json) {
+    RowFilter filter;
+    for (const auto& clause : json) {
+        if (!clause.has("column") || !clause.has("value")) {
+            throw std::invalid_argument("Predicate needs \"column\" and \"value\"");
+        }
+        Predicate predicate;
+        predicate.column = clause["column"].s();
+        if (clause.has("op")) predicate.op = parse_predicate_op(clause["op"].s());
+        if (clause["value"].t() == crow::json::type::List) {
+            for (const auto& value : clause["value"]) predicate.values.push_back(std::string(value));
+        } else {
+            predicate.values.push_back(std::string(clause["value"]));
+        }
+        filter.push_back(std::move(predicate));
+    }
+    return filter;
+}
+
+// Filters of /csv/filtered_sums: one array of predicates (see above) per filter
+static std::vector<RowFilter> parse_row_filters(const crow::json::rvalue& json) {
+    std::vector<RowFilter> filters;
+    for (const auto& filter : json) filters.push_back(parse_row_filter(filter));
+    return filters;
+}
+
+// Public columns of /csv/filtered_sums and /query: { "name": [cell, ...], ... }
+static PublicColumns parse_public_columns(const crow::json::rvalue& json) {
+    PublicColumns columns;
+    for (const auto& column : json) {
+        std::vector<std::string> cells;
+        cells.reserve(column.size());
+        for (const auto& cell : column) cells.push_back(std::string(cell));
+        columns.add(column.key(), std::move(cells));
+    }
+    return columns;
+}
+
+// Models of --model-dir, by file name without extension
+struct ModelSet {
+    std::map<std::string, LogisticModel> logistic;                     // For /ml/logreg/predict
+    std::map<std::string, MatrixModel> matrices;                       // { "matrix": [[...], ...] }, for /ml/matvec
+};
+
+/**
+ * Every *.json model file of a directory: a matrix if it has "matrix", else a
+ * logistic regression model
+ * 
+ * @throws std::runtime_error for unreadable or malformed files
+ */
+static ModelSet load_models(const std::string& directory) {
+    ModelSet models;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() != ".json") continue;
+        std::ifstream file(entry.path());
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        auto json = crow::json::load(text);
+        if (!file || !json) throw std::runtime_error("Cannot parse model file " + entry.path().string());
+        const std::string name = entry.path().stem().string();
+        try {
+            if (json.has("matrix")) {
+                models.matrices.emplace(name, parse_matrix_model(json));
+                continue;
+            }
+            LogisticModel model = parse_logistic_model(json);
+            model.name = name;
+            models.logistic.emplace(name, std::move(model));
+        } catch (const std::invalid_argument& e) {
+            throw std::runtime_error(entry.path().string() + ": " + e.what());
+        }
+    }
+    return models;
+}
+
+/**
+ * Add serialized size information to a JSON response, and for ciphertext
+ * results the lowest level (chain index, 0 = last prime) and largest size
+ * in polynomials among them
+ * 
+ * @param response Response under construction
+ * @param wire Options the payload was serialized with (stats must be set)
+ */
+static void report_wire_sizes(crow::json::wvalue& response, const WireOptions& wire) {
+    response["compression"] = compr_mode_name(wire.compression);
+    response["raw_bytes"] = wire.stats->raw_bytes;
+    response["wire_bytes"] = wire.stats->wire_bytes;
+    if (wire.stats->ciphertexts) {
+        response["level"] = wire.stats->min_level;
+        response["ciphertext_size"] = wire.stats->max_size;
+    }
+}
+
+/**
+ * Add serialized size information to a binary response as headers
+ * 
+ * @param res Response under construction
+ * @param wire Options the payload was serialized with (stats must be set)
+ */
+static void report_wire_sizes(crow::response& res, const WireOptions& wire) {
+    res.compressed = wire.compression == seal::compr_mode_type::none;  // zlib / zstd / bitpack SEAL bytes would not shrink again
+    res.set_header("X-HE-Compression", compr_mode_name(wire.compression));
+    res.set_header("X-HE-Raw-Bytes", std::to_string(wire.stats->raw_bytes));
+    res.set_header("X-HE-Wire-Bytes", std::to_string(wire.stats->wire_bytes));
+    if (wire.stats->ciphertexts) {
+        res.set_header("X-HE-Level", std::to_string(wire.stats->min_level));
+        res.set_header("X-HE-Ciphertext-Size", std::to_string(wire.stats->max_size));
+    }
+}
+
+/**
+ * Response to a request that stored a new column: its handle, also in an
+ * X-HE-Route-Key header for load balancers (see RouteHintMiddleware.h)
+ *
+ * @param response JSON body under construction
+ * @param handle The column's handle
+ */
+static crow::response stored_response(crow::json::wvalue& response, const std::string& handle) {
+    response["handle"] = handle;
+    crow::response res(200, response);
+    res.set_header(RouteHintMiddleware::header, handle);
+    return res;
+}
+
+/**
+ * Response to a request AdmissionControl refused
+ * 
+ * @param ticket Refused admission
+ * @return 429 (queue full) or 503 (waited too long) with Retry-After and
+ *         { "error", "retry_after_s" }
+ */
+static crow::response admission_refused(const AdmissionControl::Ticket& ticket) {
+    crow::json::wvalue response;
+    response["error"] = ticket.status() == 429 ? "Too many requests queued for compute, retry later"
+                                               : "Timed out waiting for compute, retry later";
+    response["retry_after_s"] = static_cast<int64_t>(ticket.retry_after().count());
+    crow::response res(ticket.status(), response);
+    res.set_header("Retry-After", std::to_string(ticket.retry_after().count()));
+    return res;
+}
+
+/**
+ * JSON view of a plan for POST /plan and the "plan" of aggregate responses
+ * 
+ * @return { "operation", "scheme", "profile", "depth", "packing", "ciphertexts",
+ *           "rotation", "rotations", "execution", "shards", "compute_us",
+ *           "transfer_us", "estimated_us", "costs": "calibrated" | "nominal" }
+ */
+static crow::json::wvalue plan_json(const Plan& plan) {
+    crow::json::wvalue json;
+    json["operation"] = plan_operation_name(plan.operation);
+    json["scheme"] = plan.use_ckks ? "ckks" : "bfv";
+    json["profile"] = plan.profile;
+    json["depth"] = plan.depth;
+    json["packing"] = plan.packing;
+    json["ciphertexts"] = plan.ciphertexts;
+    json["rotation"] = plan.rotation;
+    json["rotations"] = plan.rotations;
+    json["execution"] = plan.execution;
+    json["shards"] = plan.shards;
+    json["compute_us"] = static_cast<int64_t>(plan.compute_us);
+    json["transfer_us"] = static_cast<int64_t>(plan.transfer_us);
+    json["estimated_us"] = static_cast<int64_t>(plan.estimated_us);
+    json["costs"] = plan.calibrated ? "calibrated" : "nominal";
+    return json;
+}
+
+/**
+ * JSON view of a job for GET /jobs/<id> and WS /ws/jobs
+ * 
+ * @param snapshot Job state from JobQueue
+ * @return { "job_id", "operation", "status", "progress", "queued_us",
+ *           "running_us", "result" (once done) or "error" (once failed) }
+ */
+static crow::json::wvalue job_json(const JobQueue::Snapshot& snapshot) {
+    crow::json::wvalue json;
+    json["job_id"] = snapshot.id;
+    json["operation"] = snapshot.kind;
+    json["status"] = JobQueue::state_name(snapshot.state);
+    json["progress"] = snapshot.progress;
+    json["queued_us"] = snapshot.queued_us;
+    json["running_us"] = snapshot.running_us;
+    if (snapshot.state == JobQueue::State::done) json["result"] = crow::json::load(snapshot.result);
+    if (snapshot.state == JobQueue::State::failed) json["error"] = snapshot.error;
+    return json;
 }
 
 /**
@@ -53,18 +767,680 @@ static std::string log_cipher(const std::string& ct) {
  * Sets up two HomomorphicEncryption instances (BFV and CKKS schemes) and
  * configures a Crow web server with multiple REST endpoints for performing
  * homomorphic operations on encrypted data.
+ * 
+ * Options (--name=value, or the HE_NAME environment variable):
+ *   --port, --prefork, --io-threads, --compute-threads, --compute-cpus, --numa, --job-threads,
+ *   --http-keepalive-s, --http-max-body-mb, --http-read-buffer-kb, --http-socket-buffer-kb, --http-nodelay,
+ *   --http-compression, --http-compression-min-kb, --http-compression-level,
+ *   --http2, --http2-max-streams, --http2-window-kb, --http2-connection-window-mb,
+ *   --compression, --key-dir, --tenant-key-cache-mb, --store-memory-mb, --store-spill-dir, --store-shared-dir,
+ *   --store-cold, --store-disk-mb, --replicas,
+ *   --rns-parallel-min-coeffs, --scratch-arena-mb, --ciphertext-pool-mb, --plaintext-cache-mb, --result-cache-mb,
+ *   --coalesce, --compact-keys, --memory-budget-mb, --tenant-quota-mb, --key-ttl-s, --plaintext-cache-ttl-s,
+ *   --result-cache-ttl-s, --store-ttl-s, --memory-sweep-ms,
+ *   --admission-max-cost-m, --admission-max-queued, --admission-max-queued-cost-m, --admission-max-wait-ms,
+ *   --plan-calibrate, --plan-network-mbps, --plan-round-trip-ms,
+ *   --model-dir, --column-dir, --column-chunk-mb, --refresh-max-pending, --refresh-ttl-s,
+ *   --vitals-window-s, --vitals-max-windows, --vitals-max-patients, --vitals-max-frame-kb, --vitals-max-pending,
+ *   --huge-pages, --huge-page-min-kb, --huge-pages-numa, --prng, --pool-limit-mb, --pool-trim-idle-s,
+ *   --profile-max-s, --workers, --worker-ttl-s, --shard-retries, --shard-timeout-s,
+ *   --shard-threads, --trusted-workers, --coordinator, --advertise, --shm-handoff,
+ *   --otlp-endpoint, --trace-sample-ratio, --trace-max-per-second,
+ *   --record-traffic, --record-traffic-sample, --record-traffic-bodies, --record-traffic-buffer-mb
+ * 
+ * Stateless endpoints accept "profile" (or "depth") to run under another
+ * parameter profile than "default" (see ParameterProfile.h), and
+ * "X-Tenant-ID" to use that tenant's keys instead of the server's own
  */
-int main() {
-    // Initialize homomorphic encryption instances for both schemes
+int main(int argc, char** argv) try {
+    ServerConfig config(argc, argv);
+
+    // --prefork=N: run N worker processes, one per group of the CPUs (those of
+    // --compute-cpus, if given), all on --port with SO_REUSEPORT, under a supervisor
+    // that restarts crashed ones (see Prefork.h). Each pins itself to its group and
+    // sizes its I/O and compute threads for it. Forks before any thread starts. Off
+    // by default; everything kept between requests (jobs, rollups, PSI sets, the
+    // result cache, the store without --store-shared-dir, /metrics) is per worker
+    const size_t prefork_processes = config.get_size("prefork", 0);
+    prefork::Worker prefork_worker;
+    if (prefork_processes > 1) {
+        if (config.has("rpc-port") || config.has("coordinator")) {
+            throw std::invalid_argument("--prefork does not combine with --rpc-port or --coordinator");
+        }
+        prefork_worker = prefork::run(prefork_processes, ServerConfig::parse_cpu_list(config.get("compute-cpus", "")));
+    }
+
+    // --huge-pages=off|thp|2mb|1gb: back SEAL's pool blocks of at least
+    // --huge-page-min-kb (default 2048) with transparent or hugetlbfs huge pages,
+    // which cuts TLB misses in key switching over the large keys. 2mb and 1gb need
+    // reserved pages (vm.nr_hugepages) and fall back to smaller pages without them.
+    // --huge-pages-numa=1 places each block on the allocating thread's NUMA node.
+    // Set before anything is allocated; he_seal_huge_page* on /metrics report usage
+    seal::util::HugePageConfig huge_pages;
+    huge_pages.mode = parse_huge_page_mode(config.get("huge-pages", "off"));
+    huge_pages.min_byte_count = config.get_size("huge-page-min-kb", 2048) << 10;
+    huge_pages.numa_local = config.get_size("huge-pages-numa", 0) != 0;
+    seal::util::set_huge_page_config(huge_pages);
+
+    // --prng=blake2xb|shake256|aes128ctr: the PRNG behind the uniform polynomials
+    // of encryptions and keys. aes128ctr expands them about ten times faster on
+    // CPUs with AES-NI (SEAL's bench: UTIL / PRNG*) and is refused without it, as
+    // SEAL's portable AES is not constant time. Seeded ciphertexts and keys record
+    // it, and SEAL builds without it (e.g. browsers on stock SEAL) cannot load
+    // them; hence the default blake2xb. Before any context
+    const seal::prng_type prng = parse_prng(config.get("prng", "blake2xb"));
+    set_default_prng(prng);
+
+    // --pool-limit-mb: cap SEAL's global memory pool. Past the cap, allocations the pool
+    // cannot serve from free memory come from the system allocator and go back to it
+    // when released, so a burst no longer raises the footprint for good. 0: no cap.
+    // --pool-trim-idle-s: after this many seconds without a request, return the pool
+    // blocks nothing uses to the system; 0 disables. Both off by default. GET
+    // /admin/memory shows the pool per allocation size
+    const size_t pool_limit_bytes = config.get_size("pool-limit-mb", 0) << 20;
+    if (pool_limit_bytes) seal::MemoryManager::GetPool(seal::mm_force_global).set_byte_count_limit(pool_limit_bytes);
+    PoolTrimmer pool_trimmer(std::chrono::seconds(config.get_size("pool-trim-idle-s", 0)));
+
+    // --profile-max-s: longest /admin/profile sampling (default 60); 0 disables the endpoint
+    const size_t profile_max_s = config.get_size("profile-max-s", 60);
+
+    // Thread layout: Crow's HTTP workers (--io-threads, default one per core) and the
+    // HE worker pool for parallel sums (--compute-threads) are sized independently.
+    // --compute-cpus pins the compute workers (e.g. "0-47" on a 64-core host, with
+    // --io-threads 16 for the rest) so the two never compete for cores
+    std::vector<int> compute_cpus = prefork_worker.cpus.empty()
+        ? ServerConfig::parse_cpu_list(config.get("compute-cpus", "")) : prefork_worker.cpus;
+    size_t compute_threads = config.get_size("compute-threads",
+        compute_cpus.empty() ? std::thread::hardware_concurrency() : compute_cpus.size());
+    size_t io_threads = config.get_size("io-threads",
+        prefork_worker.cpus.empty() ? std::thread::hardware_concurrency() : prefork_worker.cpus.size());
+    // --http-*: keep-alive, body size limit, read and socket buffers, TCP_NODELAY (see HttpOptions.h)
+    const HttpOptions http_options = HttpOptions::from(config);
+
+    // --numa=1: one compute pool per NUMA node, pinned to the node's CPUs (those of
+    // --compute-cpus, if given) and --compute-threads split evenly, or one thread per
+    // CPU. Every engine is replicated per node and built there, so its context, NTT
+    // tables and keys are first touched on that node; this costs a copy of the keys
+    // per node. TenantMiddleware runs each request on one node: a tenant's on the node
+    // its ID hashes to, others on the node the I/O thread is on. Off by default
+    const bool numa_enabled = config.get_size("numa", 0) != 0;
+    const NumaTopology numa = numa_enabled ? NumaTopology::detect(compute_cpus) : NumaTopology::single(compute_cpus);
+    std::vector<std::shared_ptr<ThreadPool>> compute_pools;
+    auto label_compute = [] { metrics::label_thread("compute"); };
+    if (numa.size() == 1) {
+        compute_pools.push_back(std::make_shared<ThreadPool>(compute_threads, compute_cpus, label_compute));
+    } else {
+        for (size_t node = 0; node < numa.size(); node++) {
+            size_t threads = config.has("compute-threads") ? std::max<size_t>(1, compute_threads / numa.size())
+                                                           : numa.node(node).cpus.size();
+            compute_pools.push_back(std::make_shared<ThreadPool>(threads, numa.node(node).cpus, label_compute));
+        }
+    }
+    auto compute_pool = compute_pools[0];
+
+    // Run setup on a node's CPUs, so what it allocates is placed on that node
+    auto on_node = [&](size_t node, const std::function<void()>& setup) {
+        std::unique_ptr<NumaTopology::Binding> binding;
+        if (numa.size() > 1) binding = std::make_unique<NumaTopology::Binding>(numa.node(node));
+        setup();
+    };
+
+    // --rns-parallel-min-coeffs: split a single operation's per-limb NTTs, dyadic
+    // products and key switching across compute_pool (with --numa, the calling
+    // thread's node's pool), in tasks of at least this many coefficients (16384 = one
+    // limb at n = 16384). Off by default; it only pays when large-parameter requests
+    // are fewer than the compute threads. Key generation uses the pool either way
+    SealExecutor::install(compute_pools, [&numa] { return numa.current_node(); },
+                          config.get_size("rns-parallel-min-coeffs", 0));
+
+    // --scratch-arena-mb: carve SEAL temporaries from per-thread bump-pointer arenas
+    // (first block of this many MiB each), reset after every request, instead of
+    // the thread-local pools. Off by default
+    const size_t scratch_arena_bytes = config.get_size("scratch-arena-mb", 0) << 20;
+
+    // --compact-keys: hold relinearization and Galois key limbs modulo primes of at
+    // most 32 bits as 32-bit words (see HomomorphicEncryption::set_compact_keys):
+    // a quarter less key memory with {50, 30, 30, 50}, at no measurable rotation
+    // cost. Off by default
+    const bool compact_keys = config.get_size("compact-keys", 0) != 0;
+
+    // --ciphertext-pool-mb: ciphertexts each thread keeps once a request is done with
+    // them, so later operands and results load into allocations that already exist
+    // (see CiphertextPool.h). 16 by default; 0 disables the pool
+    ciphertext_pool::set_thread_limit(config.get_size("ciphertext-pool-mb", 16) << 20);
+
+    // --plaintext-cache-mb: memory per engine for encoded constants and model weights
+    // (1/count, masks, biases, sigmoid coefficients) reused across requests; 0 disables
+    const size_t plaintext_cache_bytes = config.get_size("plaintext-cache-mb", 64) << 20;
+
+    // --memory-budget-mb: one bound over the tenant key sets, plaintext and result caches
+    // and resident store columns together, on top of each one's own; --tenant-quota-mb: the
+    // most one tenant's key sets and cached responses may hold. Idle entries are dropped
+    // after --key-ttl-s (tenant key sets), --plaintext-cache-ttl-s, --result-cache-ttl-s
+    // and --store-ttl-s (columns and their handles: uploads not read or appended to for
+    // that long are erased). All off by default; sweeps run every --memory-sweep-ms (1000)
+    // once any is set, evicting by idle time, size and rebuild cost (see MemoryBudget.h).
+    // GET /admin/memory reports every type's entries, bytes and eviction cost
+    MemoryBudget::Options budget_options;
+    budget_options.max_bytes = config.get_size("memory-budget-mb", 0) << 20;
+    budget_options.tenant_quota_bytes = config.get_size("tenant-quota-mb", 0) << 20;
+    MemoryBudget memory_budget(budget_options);
+    const std::chrono::seconds key_ttl(config.get_size("key-ttl-s", 0));
+    const std::chrono::seconds plaintext_ttl(config.get_size("plaintext-cache-ttl-s", 0));
+    const std::chrono::seconds result_ttl(config.get_size("result-cache-ttl-s", 0));
+    const std::chrono::seconds store_ttl(config.get_size("store-ttl-s", 0));
+    const bool budget_sweeps = budget_options.max_bytes > 0 || budget_options.tenant_quota_bytes > 0 ||
+                               key_ttl.count() > 0 || plaintext_ttl.count() > 0 || result_ttl.count() > 0 ||
+                               store_ttl.count() > 0;
+    const std::chrono::milliseconds budget_interval(budget_sweeps ? config.get_size("memory-sweep-ms", 1000) : 0);
+
+    // --result-cache-mb: responses of /csv/sum, /csv/average and /binary/csv/sum kept
+    // by a digest of the request (path and query, tenant, body), so a dashboard
+    // repeating a query gets the earlier result without its ciphertexts being parsed
+    // again; 0 disables. --coalesce=0 stops identical requests that arrive together
+    // from sharing one computation
+    ResultCache result_cache(config.get_size("result-cache-mb", 64) << 20, config.get_size("coalesce", 1) != 0);
+    memory_budget.add("results", result_cache, result_ttl);
+
+    // --admission-max-cost-m: the /csv/* aggregates, /binary/csv/sum and /columns/<name>/sum
+    // run while their operands (ciphertexts x poly modulus degree, in units of 2^20
+    // coefficients) add up to at most this much in all, default one per compute thread
+    // (128 ciphertexts at n = 8192); 0 runs all at once. The rest wait in order, holding
+    // their I/O thread, up to --admission-max-queued requests (64) and
+    // --admission-max-queued-cost-m (0 = four times the active limit), beyond which they
+    // get 429, and for --admission-max-wait-ms (10000), after which they get 503; both
+    // with Retry-After. he_admission_* on /metrics (see AdmissionControl.h)
+    size_t total_compute_threads = 0;
+    for (const auto& pool : compute_pools) total_compute_threads += pool->size();
+    AdmissionControl::Options admission_options;
+    admission_options.max_active_cost = static_cast<uint64_t>(
+        config.get_size("admission-max-cost-m", std::max<size_t>(1, total_compute_threads))) << 20;
+    admission_options.max_queued = config.get_size("admission-max-queued", 64);
+    admission_options.max_queued_cost = static_cast<uint64_t>(config.get_size("admission-max-queued-cost-m", 0)) << 20;
+    admission_options.max_wait = std::chrono::milliseconds(config.get_size("admission-max-wait-ms", 10000));
+    AdmissionControl admission(admission_options);
+
+    // Server-wide compression for serialized output (--compression=none|zlib|zstd);
+    // requests can override it with "compression" (JSON) or ?compression= (binary)
+    const seal::compr_mode_type default_compression =
+        parse_compr_mode(config.get("compression", compr_mode_name(seal::Serialization::compr_mode_default)));
+
+    // --key-dir: load the evaluation keys mini-backend stored there (never the
+    // secret key), so Galois keys need not be POSTed after every restart. Each
+    // Galois key is read when a rotation first needs it, so an engine that only
+    // adds never holds any
+    std::unique_ptr<KeyStore> key_store;
+    if (config.has("key-dir")) {
+        key_store = std::make_unique<KeyStore>(config.get("key-dir"));
+    }
+
+    // Homomorphic encryption instances, one per parameter profile and scheme
     // BFV: Better for integer operations, exact arithmetic
     // CKKS: Better for floating-point operations, approximate arithmetic
-    HomomorphicEncryption he_bfv(false, false);  // BFV without key generation
-    HomomorphicEncryption he_ckks(true, false);  // CKKS without key generation
+    // Keys are loaded, never generated: a profile's keys appear in --key-dir once
+    // mini-backend has served it. One registry per NUMA node; node 0's engines serve
+    // the column stores
+    //
+    // --warm-up-rounds: before an engine serves, run encrypt, add, multiply and slot
+    // sums this many times on each of its compute threads and read its key pages (see
+    // HomomorphicEncryption::warm_up). This loads the slot sums' Galois keys up front;
+    // off by default
+    const size_t warm_up_rounds = config.get_size("warm-up-rounds", 0);
+    std::vector<std::unique_ptr<ProfileRegistry>> registries;
+    std::vector<HomomorphicEncryption*> node_bfv, node_ckks, node_bgv;
+    for (size_t node = 0; node < numa.size(); node++) {
+        registries.push_back(std::make_unique<ProfileRegistry>([&, node](HomomorphicEncryption& he) {
+            he.set_scratch_arenas(scratch_arena_bytes);
+            he.set_plaintext_cache(plaintext_cache_bytes);
+            memory_budget.add("plaintexts", he.plaintext_cache(), plaintext_ttl);
+            he.set_compact_keys(compact_keys);
+            he.set_thread_pool(compute_pools[node]);
+            if (key_store && !he.load_keys(*key_store, false, true) && node == 0) {
+                std::cout << "No " << he.parameter_profile().name << " keys found in " << key_store->directory()
+                          << " (start mini-backend first)\n";
+            }
+            he.warm_up(warm_up_rounds);
+        }));
+    }
+    // Every node's three engines are built at once, each on its own thread bound to
+    // its node; loading their keys is mostly parsing and NTTs of independent data
+    const seal::scheme_type default_schemes[] = {seal::scheme_type::bfv, seal::scheme_type::ckks,
+                                                 seal::scheme_type::bgv};
+    std::vector<std::future<HomomorphicEncryption*>> startup;
+    for (size_t node = 0; node < numa.size(); node++) {
+        for (seal::scheme_type scheme : default_schemes) {
+            startup.push_back(std::async(std::launch::async, [&, node, scheme] {
+                HomomorphicEncryption* he = nullptr;
+                on_node(node, [&] { he = &registries[node]->get(profiles::default_profile(), scheme); });
+                return he;
+            }));
+        }
+    }
+    for (size_t node = 0; node < numa.size(); node++) {
+        node_bfv.push_back(startup[3 * node].get());
+        node_ckks.push_back(startup[3 * node + 1].get());
+        node_bgv.push_back(startup[3 * node + 2].get());
+    }
+    HomomorphicEncryption& he_bfv = *node_bfv[0];
+    HomomorphicEncryption& he_ckks = *node_ckks[0];
+    HomomorphicEncryption& he_bgv = *node_bgv[0];
+
+    // Cost model of POST /plan and the "plan" in aggregate responses: --plan-calibrate=1
+    // times every operation on the default profile at startup (a few hundred ms), 0 uses
+    // nominal costs. Distributed sums are costed at --plan-network-mbps (1000) and
+    // --plan-round-trip-ms (2) per call to a worker
+    QueryPlanner::Options planner_options;
+    planner_options.compute_threads = compute_pool->size();
+    planner_options.network_mbps = std::stod(config.get("plan-network-mbps", "1000"));
+    planner_options.round_trip_ms = std::stod(config.get("plan-round-trip-ms", "2"));
+    auto calibration_start = std::chrono::steady_clock::now();
+    const bool calibrate_costs = config.get_size("plan-calibrate", 1) != 0;
+    QueryPlanner planner(calibrate_costs ? CostModel::calibrate(he_bfv, he_ckks) : CostModel::nominal(),
+                         planner_options);
+    if (calibrate_costs) {
+        std::cout << "Cost model calibrated in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                           calibration_start).count()
+                  << " ms\n";
+    }
+
+
+    // Tenants' own key sets (X-Tenant-ID), each in --key-dir/tenant-<id> as mini-backend
+    // stored it, loaded on first use; --tenant-key-cache-mb bounds the key bytes kept
+    // loaded, least recently used tenants are reloaded when next needed. With --numa a
+    // tenant is only loaded on the node that owns it, and each node gets an equal share
+    // of the budget
+    std::vector<std::unique_ptr<TenantRegistry>> tenants;
+    if (key_store) {
+        const size_t tenant_budget = (config.get_size("tenant-key-cache-mb", 1024) << 20) / numa.size();
+        for (size_t node = 0; node < numa.size(); node++) {
+            tenants.push_back(std::make_unique<TenantRegistry>(
+                *registries[node], *key_store, tenant_budget,
+                [](HomomorphicEncryption& he, const KeyStore& store) { return he.load_keys(store, false, true); }));
+            memory_budget.add("tenant_keys", *tenants.back(), key_ttl);
+        }
+    }
+
+    // Server-side column store, one per scheme (--store-memory-mb caps resident data,
+    // --store-spill-dir lets cold columns move to disk instead of rejecting uploads).
+    // --store-shared-dir makes main-backend a stateless replica: every column is kept in
+    // that directory, on storage all replicas mount, and memory only caches it, so any
+    // replica serves any handle (see CiphertextStore.h). The replicas' --key-dir must be
+    // shared too. --replicas=host:port,...: every replica, the same list on each, for the
+    // X-HE-Replica routing hint (see RouteHintMiddleware.h).
+    // --store-cold=<dir or http://host:port/prefix> adds object storage below the spill
+    // directory: once the spill files pass --store-disk-mb, the coldest are uploaded there
+    // and deleted locally, and fetched back when read (not with --store-shared-dir)
+    size_t store_budget = config.get_size("store-memory-mb", 0) << 20;
+    const std::string shared_dir = config.get("store-shared-dir", "");
+    const std::string spill_dir = shared_dir.empty() ? config.get("store-spill-dir", "") : shared_dir;
+    if (!shared_dir.empty() && !key_store) throw std::invalid_argument("--store-shared-dir needs a shared --key-dir");
+    const bool shared_store = !shared_dir.empty();
+    const std::string cold_location = config.get("store-cold", "");
+    const size_t disk_budget = config.get_size("store-disk-mb", 0) << 20;
+    if (!cold_location.empty() && (shared_store || spill_dir.empty())) {
+        throw std::invalid_argument("--store-cold needs --store-spill-dir and cannot be used with --store-shared-dir");
+    }
+    auto cold_store = [&](const char* scheme) -> std::shared_ptr<ObjectStore> {
+        if (cold_location.empty()) return nullptr;
+        return ObjectStore::open(cold_location + "/" + scheme);
+    };
+    CiphertextStore bfv_store(he_bfv.seal_context(), store_budget, spill_dir.empty() ? "" : spill_dir + "/bfv",
+                              shared_store, cold_store("bfv"), disk_budget);
+    CiphertextStore ckks_store(he_ckks.seal_context(), store_budget, spill_dir.empty() ? "" : spill_dir + "/ckks",
+                               shared_store, cold_store("ckks"), disk_budget);
+    CiphertextStore bgv_store(he_bgv.seal_context(), store_budget, spill_dir.empty() ? "" : spill_dir + "/bgv",
+                              shared_store, cold_store("bgv"), disk_budget);
+    if (!cold_location.empty()) std::cout << "Column store cold tier: " << cold_location << "\n";
+    for (CiphertextStore* store : {&bfv_store, &ckks_store, &bgv_store}) {
+        memory_budget.add("columns", *store, store_ttl);
+    }
+    // After every cache it sweeps, so it stops before they are destroyed
+    MemoryBudget::Sweeper memory_sweeper(memory_budget, budget_interval);
+    std::vector<std::string> replicas;
+    std::stringstream replica_list(config.get("replicas", ""));
+    for (std::string address; std::getline(replica_list, address, ',');) {
+        if (!address.empty()) replicas.push_back(address);
+    }
+
+    // Workers for POST /jobs (--job-threads, default 2). Separate from compute_pool:
+    // a job's sum fans out to compute_pool and waits, which must never happen
+    // from inside compute_pool itself. Its tasks there run at batch priority, behind
+    // those of requests (see ThreadPool)
+    const size_t job_threads = config.get_size("job-threads", 2);
+    JobQueue job_queue(job_threads);
+
+    // Ciphertexts out at the key holder for /refresh/mask: at most --refresh-max-pending
+    // batches (default 1024, the oldest dropped first), unmasked within --refresh-ttl-s
+    // (default 600)
+    const size_t refresh_ttl_s = config.get_size("refresh-ttl-s", 600);
+    RefreshMasks refresh_masks(config.get_size("refresh-max-pending", 1024), std::chrono::seconds(refresh_ttl_s));
+
+    // Encrypted rollups by handle (PUT /rollups): one cube per granularity, under the
+    // default profile of their scheme. They live in this process only, like jobs
+    struct Rollup {
+        std::string scheme;
+        std::mutex mutex;  // Appends and query plans
+        std::map<RollupGranularity, RollupCube> cubes;
+    };
+    std::mutex rollups_mutex;
+    std::map<std::string, std::shared_ptr<Rollup>> rollups;
+    auto find_rollup = [&](const std::string& handle) {
+        std::lock_guard<std::mutex> lock(rollups_mutex);
+        auto found = rollups.find(handle);
+        if (found == rollups.end()) throw std::out_of_range("Unknown rollup handle: " + handle);
+        return found->second;
+    };
+
+    // Encrypted vitals (WS /ws/vitals) in windows of --vitals-window-s seconds (60), the
+    // last --vitals-max-windows (60) of each of at most --vitals-max-patients (1024)
+    // patients. Like rollups, they live in this process only
+    VitalsAggregates vitals(config.get_size("vitals-window-s", 60) * 1000, config.get_size("vitals-max-windows", 60),
+                            config.get_size("vitals-max-patients", 1024));
+
+    // A vitals connection holds at most --vitals-max-pending (64) readings received but
+    // not yet added, each of at most --vitals-max-frame-kb (1024). Past that, readings are
+    // refused instead of queued, so its memory stays below their product
+    const size_t vitals_max_frame_bytes = config.get_size("vitals-max-frame-kb", 1024) << 10;
+    const size_t vitals_max_pending = config.get_size("vitals-max-pending", 64);
+
+    // Server sets of private set intersection by handle (PUT /psi/sets), in this process only
+    std::mutex psi_sets_mutex;
+    std::map<std::string, std::shared_ptr<const PsiServerSet>> psi_sets;
+
+    // --model-dir: logistic regression models and matrices (*.json, see load_models)
+    // that /ml/... requests name by file name
+    ModelSet models;
+    if (config.has("model-dir")) {
+        models = load_models(config.get("model-dir"));
+        std::cout << "Loaded " << models.logistic.size() + models.matrices.size() << " model(s) from "
+                  << config.get("model-dir") << "\n";
+    }
+
+    // A --model-dir matrix encoded for an engine, created on first use; its diagonals
+    // are encoded once per level and kept
+    std::mutex matrix_mutex;
+    std::map<std::pair<std::string, const HomomorphicEncryption*>, std::unique_ptr<DiagonalMatrix>> model_matrices;
+    auto model_matrix = [&](const std::string& name, const HomomorphicEncryption& he) -> const DiagonalMatrix& {
+        auto model = models.matrices.find(name);
+        if (model == models.matrices.end()) throw std::out_of_range("Unknown model: " + name);
+        std::lock_guard<std::mutex> lock(matrix_mutex);
+        auto& matrix = model_matrices[{name, &he}];
+        if (!matrix) matrix = std::make_unique<DiagonalMatrix>(he, model->second.rows, model->second.bias);
+        return *matrix;
+    };
+
+    // A layout conversion of packed columns (/csv/relayout) for an engine, created on first
+    // use; like the model matrices its masks are encoded once per level and kept
+    std::mutex relayout_mutex;
+    std::map<std::tuple<size_t, PatientLayout, const HomomorphicEncryption*>, std::unique_ptr<SlotPermutation>>
+        relayouts;
+    auto relayout = [&](const PatientPacking& to, PatientLayout from,
+                        const HomomorphicEncryption& he) -> const SlotPermutation& {
+        std::lock_guard<std::mutex> lock(relayout_mutex);
+        auto& permutation = relayouts[{to.feature_count(), to.layout(), &he}];
+        if (!permutation) permutation = std::make_unique<SlotPermutation>(he, to.sources(from));
+        return *permutation;
+    };
+
+    const size_t port = config.get_size("port", 18080);
+    const crow::LogLevel log_level = logging::parse_level(config.get("log-level", "warning"));
+
+    // --otlp-endpoint: export spans (per request and per HE stage) to an OpenTelemetry
+    // collector, e.g. http://localhost:4318/v1/traces. Callers' sampled traceparent
+    // headers are followed, --trace-sample-ratio of other requests start a trace, and
+    // at most --trace-max-per-second traces are recorded in all
+    tracing::Tracer::instance().configure(config.get("otlp-endpoint", ""), "main-backend",
+                                          std::stod(config.get("trace-sample-ratio", "0.01")),
+                                          config.get_size("trace-max-per-second", 20));
+
+    // --record-traffic=FILE: log the requests served (arrival time, method, path, endpoint,
+    // body, status, handler time) for tools/he-replay (see TrafficLog.h). Bodies hold
+    // ciphertexts here; --record-traffic-bodies=0 keeps only their sizes.
+    // --record-traffic-sample (1) records a fraction of requests, and records beyond
+    // --record-traffic-buffer-mb (64) not yet on disk are dropped. Prefork workers each
+    // write FILE.<worker index>
+    std::string traffic_log = config.get("record-traffic", "");
+    if (!traffic_log.empty() && prefork_worker.count > 1) traffic_log += "." + std::to_string(prefork_worker.index);
+    traffic::Recorder::instance().configure(traffic_log, "main-backend",
+                                            std::stod(config.get("record-traffic-sample", "1")),
+                                            config.get_size("record-traffic-bodies", 1) != 0,
+                                            config.get_size("record-traffic-buffer-mb", 64) << 20);
+
+    // --workers=host:port,...: coordinate these main-backends, and any that register
+    // themselves, for the /cluster endpoints; host:port/rpc_port names a worker's RPC
+    // listener too. --worker-ttl-s (15) drops registered workers whose heartbeats stop;
+    // --shard-retries (2) and --shard-timeout-s (60, per attempt) bound every call to a
+    // worker; --shard-threads (64) calls to workers run at once, over all requests, the
+    // rest waiting their turn. --trusted-workers: the workers are reached over an
+    // authenticated network, so the partial sums they return are loaded trusted (see
+    // LoadCheck); the ciphertexts clients upload are validated in full on the workers
+    // either way.
+    // --coordinator=host:port: be a worker of that coordinator, announcing
+    // --advertise (default localhost:<port>) every 5 s
+    Cluster::Options cluster_options;
+    std::stringstream worker_list(config.get("workers", ""));
+    for (std::string address; std::getline(worker_list, address, ',');) {
+        if (!address.empty()) cluster_options.workers.push_back(address);
+    }
+    cluster_options.worker_ttl = std::chrono::seconds(config.get_size("worker-ttl-s", 15));
+    cluster_options.retries = config.get_size("shard-retries", 2);
+    cluster_options.timeout = std::chrono::seconds(config.get_size("shard-timeout-s", 60));
+    cluster_options.call_threads = config.get_size("shard-threads", 64);
+    Cluster cluster(cluster_options);
+    const LoadCheck worker_check = config.has("trusted-workers") ? LoadCheck::trusted : LoadCheck::full;
+
+    // --column-dir: encrypted column files (see ColumnFile.h) for the /columns endpoints,
+    // e.g. on storage every node of a cluster mounts, so each can sum its row range
+    // of a column without the ciphertexts passing through the coordinator
+    const std::string column_dir = config.get("column-dir", "");
+    // --column-chunk-mb: column file sums add this much of a column per step while the
+    // next step's blocks are read ahead (see column_file_sum)
+    const size_t column_chunk_bytes = config.get_size("column-chunk-mb", 64) << 20;
+
+    // --shm-handoff=1: PUT /shm/store takes the shared memory regions a mini-backend on
+    // the same host leaves ciphertexts in (see SharedRegion.h)
+    const bool shm_handoff = config.get_size("shm-handoff", 0) != 0;
+
+    // --rpc-port: also answer the coordinator's shard calls and key pushes over the
+    // binary node protocol (see NodeRpc.h) on this port, so ciphertexts travel as raw
+    // SEAL bytes on persistent connections instead of as HTTP bodies. It is announced
+    // to the coordinator on the host of --advertise. Like the HTTP port it takes no
+    // credentials, so keep it on the cluster's private network. --rpc-max-message-mb
+    // bounds a request as --http-max-body-mb does a body, and defaults to it (or to
+    // 1024 without it): longer ones are answered 413 before they are read
+    auto rpc_handler = [&](const node_rpc::Request& request) {
+        metrics::counter("he_rpc_requests_total", "Node RPC requests served by op",
+                         {{"op", node_rpc::op_name(request.op)}}).add();
+        node_rpc::Response response;
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            if (request.scheme == "bfv") {
+                he = &he_bfv;
+                store = &bfv_store;
+            } else if (request.scheme == "ckks") {
+                he = &he_ckks;
+                store = &ckks_store;
+            } else if (request.scheme == "bgv") {
+                he = &he_bgv;
+                store = &bgv_store;
+            } else {
+                throw std::invalid_argument("Invalid scheme");
+            }
+            WireOptions wire(WireFormat::binary, request.compression.empty() ? default_compression
+                                                                             : parse_compr_mode(request.compression));
+            response.status = 200;
+            switch (request.op) {
+                case node_rpc::Op::store: {
+                    CiphertextStore::Column column;
+                    for (const auto& payload : framing::unframe(request.payload)) {
+                        column.push_back(he->deserialize(payload, WireFormat::binary));
+                    }
+                    if (column.empty()) throw std::invalid_argument("Cannot store an empty column");
+                    response.payload = store->put(std::move(column));
+                    break;
+                }
+                case node_rpc::Op::store_sum:
+                    response.payload = he->serialize(stored_aggregate(*he, *store, request.handle, "sum", false), wire);
+                    break;
+                case node_rpc::Op::store_delete:
+                    if (!store->erase(request.handle)) {
+                        throw std::out_of_range("Unknown ciphertext handle: " + request.handle);
+                    }
+                    break;
+                case node_rpc::Op::csv_sum:
+                    response.payload =
+                        he->serialize(he->deserialize_sum(framing::unframe(request.payload), WireFormat::binary), wire);
+                    break;
+                case node_rpc::Op::column_sum: {
+                    size_t pos = 0;
+                    size_t begin_row = static_cast<size_t>(framing::get_uint(request.payload, pos, 8));
+                    size_t end_row = static_cast<size_t>(framing::get_uint(request.payload, pos, 8));
+                    ColumnFile file(column_file_path(column_dir, request.handle));
+                    response.payload =
+                        he->serialize(column_file_sum(*he, file, begin_row, end_row, column_chunk_bytes), wire);
+                    break;
+                }
+                case node_rpc::Op::galois_keys:
+                    for (size_t node = 0; node < numa.size(); node++) {
+                        on_node(node, [&] {
+                            registries[node]->get(profiles::default_profile(), request.scheme)
+                                .load_galois_keys(request.payload, WireFormat::binary);
+                        });
+                    }
+                    break;
+                default:
+                    throw std::invalid_argument("Unknown RPC op " + std::to_string(static_cast<int>(request.op)));
+            }
+        } catch (const std::out_of_range& e) {
+            response.status = 404;
+            response.payload = e.what();
+        } catch (const std::invalid_argument& e) {
+            response.status = 400;
+            response.payload = e.what();
+        }
+        return response;
+    };
+    std::unique_ptr<node_rpc::Server> rpc_server;
+    std::string advertise = config.get("advertise", "localhost:" + std::to_string(port));
+    std::string advertise_rpc;
+    if (config.has("rpc-port")) {
+        const size_t rpc_port = config.get_size("rpc-port", 0);
+        const uint64_t rpc_max_message =
+            static_cast<uint64_t>(config.get_size("rpc-max-message-mb",
+                                                  http_options.max_body_bytes ? http_options.max_body_bytes >> 20
+                                                                              : 1024)) << 20;
+        rpc_server =
+            std::make_unique<node_rpc::Server>(static_cast<uint16_t>(rpc_port), rpc_handler, rpc_max_message);
+        advertise_rpc = advertise.substr(0, advertise.rfind(':') + 1) + std::to_string(rpc_port);
+    }
+    std::unique_ptr<ClusterMember> cluster_member;
+    if (config.has("coordinator")) {
+        cluster_member = std::make_unique<ClusterMember>(config.get("coordinator"), advertise, advertise_rpc,
+                                                         std::chrono::seconds(5));
+    }
+    config.check_unused();
 
     // Initialize Crow web application with CORS middleware
     // CORS middleware allows cross-origin requests from frontend applications
-    crow::App<CORSMiddleware> app;
-    app.loglevel(crow::LogLevel::Warning);  // Set logging level to reduce noise
+    crow::App<TrafficMiddleware, CORSMiddleware, TraceMiddleware, MetricsMiddleware, ScratchArenaMiddleware,
+              TenantMiddleware, CancellationMiddleware, RouteHintMiddleware>
+        app;
+    app.get_middleware<TenantMiddleware>().numa = &numa;
+    app.get_middleware<RouteHintMiddleware>().replicas = replicas;
+    app.loglevel(log_level);  // Warning by default; request logs are Info, per-value logs Debug
+    http_options.apply(app);
+    app.reuse_port(prefork_worker.count > 1);
+    crow::logger::setHandler(&logging::AsyncLog::instance());  // Crow's messages share the async writer
+
+    // Engine for a request's tenant, scheme and, if it names one, parameter profile.
+    // Tenant engines are held by the request's TenantMiddleware context until it is answered.
+    // The engines are those of the node TenantMiddleware put the request on
+    auto select_he = [&](const crow::request& req, const std::string& scheme,
+                         const ParameterProfile* profile) -> HomomorphicEncryption& {
+        auto& tenant = app.get_context<TenantMiddleware>(req);
+        if (!tenant.tenant.empty()) {
+            if (tenants.empty()) throw std::invalid_argument("X-Tenant-ID needs --key-dir");
+            const ParameterProfile& tenant_profile = profile ? *profile : profiles::default_profile();
+            tenant.engines.push_back(tenants[tenant.node]->get(tenant.tenant, tenant_profile, scheme));
+            return *tenant.engines.back();
+        }
+        if (profile) return registries[tenant.node]->get(*profile, scheme);
+        if (scheme == "bfv") return *node_bfv[tenant.node];
+        if (scheme == "ckks") return *node_ckks[tenant.node];
+        if (scheme == "bgv") return *node_bgv[tenant.node];
+        throw std::runtime_error("Invalid scheme");
+    };
+
+    // Pick the engine and column store for a scheme; the stores hold the server's own
+    // ciphertexts, so they are not open to tenants
+    auto select_scheme = [&](const crow::request& req, const std::string& scheme, HomomorphicEncryption*& he,
+                             CiphertextStore*& store) {
+        if (!app.get_context<TenantMiddleware>(req).tenant.empty()) {
+            throw std::invalid_argument("The column store does not take X-Tenant-ID");
+        }
+        if (scheme == "bfv") {
+            he = &he_bfv;
+            store = &bfv_store;
+        } else if (scheme == "ckks") {
+            he = &he_ckks;
+            store = &ckks_store;
+        } else if (scheme == "bgv") {
+            he = &he_bgv;
+            store = &bgv_store;
+        } else {
+            throw std::runtime_error("Invalid scheme");
+        }
+    };
+
+    // Answer a request later, from another thread (see AsyncHandler.h); its handler thread
+    // is released from the tenant's node meanwhile
+    auto defer = [&](const crow::request& req, crow::response& res) {
+        app.get_context<TenantMiddleware>(req).binding.reset();
+        return PendingResponse(req, res);
+    };
+
+    // The response to an identical earlier or concurrent request, replayed; or nullptr
+    // with flight set to this request's claim on computing it, for keep_result()
+    auto find_result = [&](const crow::request& req, ResultCache::Flight& flight) -> std::unique_ptr<crow::response> {
+        if (!result_cache.enabled()) return nullptr;
+        const std::string& tenant = app.get_context<TenantMiddleware>(req).tenant;
+        auto key = ResultCache::digest({req.raw_url, tenant, req.body_view()});
+        bool coalesced;
+        auto result = result_cache.find(key, flight, &coalesced, tenant);
+        if (!result) return nullptr;
+        return std::make_unique<crow::response>(replay(*result, coalesced ? "coalesced" : "hit"));
+    };
+    auto keep_result = [&](ResultCache::Flight& flight, crow::response res) {
+        flight.complete(cache_entry(res));
+        return res;
+    };
+
+    // The plan of a request as it runs here (its profile and layout are the client's), as
+    // "plan" in the response; operations the profile cannot plan for get none, and so does
+    // BGV, which the cost model does not cover
+    auto report_plan = [&](crow::json::wvalue& response, const HomomorphicEncryption& he, PlanOperation operation,
+                           size_t ciphertexts, bool packed, size_t groups = 1) {
+        if (he.scheme() == seal::scheme_type::bgv) return;
+        PlanRequest request;
+        request.operation = operation;
+        request.use_ckks = he.seal_context()->key_context_data()->parms().scheme() == seal::scheme_type::ckks;
+        request.profile = &he.parameter_profile();
+        request.packed = packed ? 1 : 0;
+        request.ciphertexts = ciphertexts;
+        request.groups = groups;
+        try {
+            response["plan"] = plan_json(planner.plan(request));
+        } catch (const std::invalid_argument&) {
+        }
+    };
+
+    // Admission of a request evaluating operands ciphertexts of he's parameters; hold the
+    // ticket until the result is serialized, and answer admission_refused() if it is false
+    auto admit = [&](const HomomorphicEncryption& he, size_t operands) {
+        return admission.admit(AdmissionControl::cost(operands, he.parameter_profile().poly_modulus_degree));
+    };
 
     // ========================================
     // REST API ENDPOINT: Homomorphic Addition
@@ -72,24 +1448,41 @@ int main() {
     // POST /add_encrypted
     // Performs homomorphic addition of two encrypted values
     // Supports both BFV and CKKS encryption schemes
-    // 
+    // Operands may be seeded uploads ("seeded": true on mini-backend's /encrypt);
+    // they are expanded on load like every other endpoint's inputs
+    // With an "X-Tenant-ID: <id>" header (letters, digits, '-' and '_') the operands are
+    // that tenant's, evaluated with its keys from --key-dir/tenant-<id>; so are those of
+    // every endpoint but the column store's, POST /galois_keys and POST /binary/evaluation_keys
+    //
     // Request body (JSON):
     // {
     //   "a": "encrypted_value_1",
     //   "b": "encrypted_value_2", 
-    //   "scheme": "bfv" | "ckks"
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "profile": "sum-fast",                    // optional, parameter profile the operands were
+    //                                             // encrypted under; or "depth": 0 to pick by depth
+    //   "compression": "none" | "zlib" | "zstd" | "bitpack",  // optional, defaults to HE_COMPRESSION
+    //   "compact_result": true                    // optional, switch the result down the modulus
+    //                                             // chain first: smaller and faster to decrypt,
+    //                                             // but no longer a valid input to other operations
     // }
     //
     // Response (JSON):
     // {
     //   "ciphertext": "encrypted_result",
     //   "execution_us": 1234,
-    //   "ram_kb": 5678
+    //   "ram_kb": 5678,
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,      // uncompressed SEAL size of the result
+    //   "wire_bytes": 369780,     // size of "ciphertext" as sent
+    //   "level": 1,               // chain index of the result (0 = last prime; lower after
+    //                             // "compact_result"), on every ciphertext-returning endpoint
+    //   "ciphertext_size": 2      // polynomials in the result (3 before relinearization)
     // }
     CROW_ROUTE(app, "/add_encrypted")
     .methods("POST"_method)
     ([&](const crow::request& req) {
-        auto json_data = crow::json::load(req.body);
+        auto json_data = parse_json(req.body_view());
         crow::json::wvalue response;
 
         // Validate required fields in the request
@@ -98,15 +1491,18 @@ int main() {
             !json_data.has("b") || 
             !json_data.has("scheme")) {
             response["error"] = "Missing required fields";
-            std::cout << "Homomorphic addition failed: Missing required fields" << std::endl;
+            HE_LOG(Info) << "Homomorphic addition failed: Missing required fields";
             return crow::response(400, response);
         }
 
         try {
             // Extract parameters from JSON request
             std::string scheme = json_data["scheme"].s();
-            std::string encrypted_a = json_data["a"].s();
-            std::string encrypted_b = json_data["b"].s();
+            std::string_view encrypted_a = json_view(json_data["a"]);
+            std::string_view encrypted_b = json_view(json_data["b"]);
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
 
             std::string encrypted_result;
 
@@ -115,47 +1511,25 @@ int main() {
             // Start performance timing
             auto start = std::chrono::high_resolution_clock::now();
 
-            // Perform homomorphic addition based on the specified scheme
-            if (scheme == "bfv") {
-                encrypted_result = he_bfv.add(encrypted_a, encrypted_b);
-            } else if (scheme == "ckks") {
-                encrypted_result = he_ckks.add(encrypted_a, encrypted_b);
-            } else {
-                throw std::runtime_error("Invalid scheme");
-            }
+            // Perform homomorphic addition based on the specified scheme and profile
+            encrypted_result = select_he(req, scheme, request_profile(json_data)).add(encrypted_a, encrypted_b, wire);
 
             // Calculate execution time
             auto end = std::chrono::high_resolution_clock::now();
             auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
             
             // Log operation details for debugging and monitoring
-            std::cout << "Homomorphic addition | Scheme: " << scheme
-                      << " | A (first 20): " << log_cipher(encrypted_a)
-                      << " | B (first 20): " << log_cipher(encrypted_b) << std::endl;
-            std::cout << "Homomorphic addition result | Scheme: " << scheme
-                      << " | Result (first 20): " << log_cipher(encrypted_result) << std::endl;
-
-            std::cout << "Homomorphic addition was done in " << duration_us << " microseconds\n";
-            std::cout << "Throughput: " << (1000000.0 / duration_us) << " operations per second\n";
-
-            // Measure current memory usage
-            size_t ram_kb = 0;
-
-            #if defined(_WIN32)
-                // Windows memory measurement
-                PROCESS_MEMORY_COUNTERS memInfo;
-                GetProcessMemoryInfo(GetCurrentProcess(), &memInfo, sizeof(memInfo));
-                ram_kb = memInfo.WorkingSetSize / 1024;
-            #else
-                // Unix/Linux memory measurement
-                struct rusage usage;
-                getrusage(RUSAGE_SELF, &usage);
-                #ifdef __APPLE__
-                    ram_kb = usage.ru_maxrss / 1024;  // macOS returns bytes
-                #else
-                    ram_kb = usage.ru_maxrss;         // Linux returns KB
-                #endif
-            #endif
+            HE_LOG(Info) << "Homomorphic addition | Scheme: " << scheme
+                         << " | A (first 20): " << log_cipher(encrypted_a)
+                         << " | B (first 20): " << log_cipher(encrypted_b);
+            HE_LOG(Info) << "Homomorphic addition result | Scheme: " << scheme
+                         << " | Result (first 20): " << log_cipher(encrypted_result);
+
+            HE_LOG(Info) << "Homomorphic addition was done in " << duration_us << " microseconds";
+            HE_LOG(Info) << "Throughput: " << (1000000.0 / duration_us) << " operations per second";
+
+            // Measure current (not peak) memory usage
+            size_t ram_kb = metrics::resident_memory_bytes() / 1024;
 
             // Prepare response with results and performance metrics
             response["ram_kb"] = ram_kb;
@@ -164,8 +1538,9 @@ int main() {
             print_session_end();  // End of a session
 
             // Return successful response with encrypted result and performance data
-            response["ciphertext"] = encrypted_result;
+            response["ciphertext"] = std::move(encrypted_result);
             response["execution_us"] = duration_us;
+            report_wire_sizes(response, wire);
             return crow::response(200, response);
         } catch (const std::exception& e) {
             // Handle errors and return error response
@@ -184,17 +1559,35 @@ int main() {
     // Request body (JSON):
     // {
     //   "encrypted_values": ["cipher1", "cipher2", ...],
-    //   "scheme": "bfv" | "ckks"
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "packed": true,           // optional, values come from /encrypt_vector;
+    //                             // reduces the slots so every slot holds the total
+    //   "profile": "sum-fast",    // optional, see /add_encrypted
+    //   "compression": "zlib",    // optional, see /add_encrypted
+    //   "compact_result": true    // optional, see /add_encrypted
     // }
     //
     // Response (JSON):
     // {
-    //   "encrypted_result": "sum_ciphertext"
+    //   "encrypted_result": "sum_ciphertext",
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,
+    //   "wire_bytes": 369780
     // }
+    // A request repeating an earlier one byte for byte is answered from the result
+    // cache (see --result-cache-mb), with an "X-HE-Result-Cache: hit" header, and one
+    // arriving while an identical one is computed waits for and shares that one's
+    // response ("X-HE-Result-Cache: coalesced"); so are those of /csv/average and
+    // /binary/csv/sum
     CROW_ROUTE(app, "/csv/sum")
     .methods("POST"_method)
     ([&](const crow::request& req) {
-        auto json_data = crow::json::load(req.body);
+        ResultCache::Flight flight;
+        if (auto replayed = find_result(req, flight)) return std::move(*replayed);
+
+        // The ciphertexts stay in the body and are read one at a time as they are summed
+        json_stream::StringArray encrypted_values;
+        auto json_data = parse_json(req.body_view(), "encrypted_values", encrypted_values);
         crow::json::wvalue response;
         
         // Validate required fields
@@ -207,38 +1600,43 @@ int main() {
 
         try {
             std::string scheme = json_data["scheme"].s();
-            auto encrypted_values = json_data["encrypted_values"];
-            std::vector<std::string> ciphertexts;
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
             
             // Log operation details
-            std::cout << "Homomorphic CSV sum | Scheme: " << scheme
-                    << " | Values count: " << encrypted_values.size() << std::endl;
+            HE_LOG(Info) << "Homomorphic CSV sum | Scheme: " << scheme
+                         << " | Values count: " << encrypted_values.size();
             
-            // Extract encrypted values from JSON array and log each one
-            for (size_t i = 0; i < encrypted_values.size(); ++i) {
-                std::string cipher = encrypted_values[i].s();
-                ciphertexts.push_back(cipher);
-                std::cout << "  Value " << (i+1) << ": " 
-                        << log_cipher(cipher) << std::endl;
-            }
+            // Encrypted values are pulled from the JSON array as the sum needs them
+            // (each one is logged at Debug level)
+            size_t pulled = 0;
+            auto next = [&](std::string& scratch, const char*& data, size_t& size) {
+                if (!encrypted_values.next(scratch, data, size)) return false;
+                HE_LOG(Debug) << "  Value " << ++pulled << ": " << log_cipher(std::string_view(data, size));
+                return true;
+            };
             
             // Perform homomorphic sum operation based on scheme
-            std::string encrypted_sum;
-            if (scheme == "bfv") {
-                encrypted_sum = he_bfv.sum(ciphertexts);
-            } else if (scheme == "ckks") {
-                encrypted_sum = he_ckks.sum(ciphertexts);
-            } else {
-                throw std::runtime_error("Invalid scheme");
-            }
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            auto ticket = admit(he, encrypted_values.size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedValue total(he, he.deserialize_sum(next, encrypted_values.size()));
+
+            // Packed input: fold the per-slot partial sums into a single total
+            if (packed) total.sum_slots();
+            std::string encrypted_sum = total.to_wire(wire);
             
             // Log result
-            std::cout << "Homomorphic CSV sum result | Scheme: " << scheme
-                    << " | Result: " << log_cipher(encrypted_sum) << std::endl;
+            HE_LOG(Info) << "Homomorphic CSV sum result | Scheme: " << scheme
+                         << " | Result: " << log_cipher(encrypted_sum);
             
             // Return encrypted sum result
-            response["encrypted_result"] = encrypted_sum;
-            return crow::response(200, response);
+            response["encrypted_result"] = std::move(encrypted_sum);
+            report_wire_sizes(response, wire);
+            report_plan(response, he, PlanOperation::sum, encrypted_values.size(), packed);
+            return keep_result(flight, crow::response(200, response));
         } catch (const std::exception& e) {
             response["error"] = e.what();
             return crow::response(500, response);
@@ -246,35 +1644,237 @@ int main() {
     });
 
     // ========================================
-    // REST API ENDPOINT: CSV Average Operation
+    // REST API ENDPOINT: CSV Column Sums
     // ========================================
-    // POST /csv/average
-    // Computes homomorphic average of multiple encrypted values
-    // Note: This currently only computes the sum - division would require
-    // additional homomorphic operations or be done on the client side
+    // POST /csv/column_sums
+    // Totals of several columns uploaded together, rows packed in a
+    // PatientPacking layout (from /csv/encrypt_columns on mini-backend), in
+    // one pass: one sum over the ciphertexts, then one fold for all columns.
+    // "sample_major" strides the slot sum by block_size, log2(slots /
+    // block_size) rotations, and puts column c's total in every slot = c mod
+    // block_size. "feature_major" sums each column's run of slots, log2(rows
+    // per ciphertext) rotations, and masks off the partial sums left beside
+    // the totals (one level, CKKS and BGV). Needs Galois keys
     //
     // Request body (JSON):
     // {
-    //   "encrypted_values": ["cipher1", "cipher2", ...],
-    //   "scheme": "bfv" | "ckks",
-    //   "count": number_of_values
+    //   "encrypted_values": ["packed1", ...],
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "columns": 3,             // as /csv/encrypt_columns returned
+    //   "layout": "feature_major",  // optional, default "sample_major"
+    //   "profile": "sum-fast",    // optional, see /add_encrypted
+    //   "compression": "zlib",    // optional, see /add_encrypted
+    //   "compact_result": true    // optional, see /add_encrypted
     // }
     //
     // Response (JSON):
     // {
-    //   "encrypted_result": "sum_ciphertext"  // Division by count needs to be done client-side
+    //   "encrypted_result": "sums_ciphertext",
+    //   "total_slots": [0, 1, 2],  // slot of each column's total (feature_major: c * rows
+    //                              // per ciphertext), for /decrypt_vector
+    //   "layout": "sample_major",
+    //   "block_size": 4,
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,
+    //   "wire_bytes": 369780
     // }
-    CROW_ROUTE(app, "/csv/average")
+    CROW_ROUTE(app, "/csv/column_sums")
     .methods("POST"_method)
     ([&](const crow::request& req) {
-        auto json_data = crow::json::load(req.body);
+        // The ciphertexts stay in the body and are read one at a time as they are summed
+        json_stream::StringArray encrypted_values;
+        auto json_data = parse_json(req.body_view(), "encrypted_values", encrypted_values);
         crow::json::wvalue response;
-        
+
         // Validate required fields
-        if (!json_data || 
-            !json_data.has("encrypted_values") || 
-            !json_data.has("scheme") || 
-            !json_data.has("count")) {
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !json_data.has("columns")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            PatientLayout layout = json_data.has("layout") ? parse_patient_layout(json_data["layout"].s())
+                                                           : PatientLayout::sample_major;
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            PatientPacking packing(layout, static_cast<size_t>(json_data["columns"].u()), he.slot_count());
+            HE_LOG(Info) << "Homomorphic column sums | Scheme: " << scheme
+                         << " | Ciphertexts: " << encrypted_values.size()
+                         << " | Columns: " << packing.feature_count()
+                         << " | Layout: " << patient_layout_name(layout);
+
+            auto ticket = admit(he, encrypted_values.size());
+            if (!ticket) return admission_refused(ticket);
+            auto next = [&](std::string& scratch, const char*& data, size_t& size) {
+                return encrypted_values.next(scratch, data, size);
+            };
+            // Summed as they are pulled, so the fold and mask run once on the total
+            seal::Ciphertext total = he.deserialize_sum(next, encrypted_values.size());
+            EncryptedValue sums(he, he.feature_sums(&total, 1, packing));
+
+            std::vector<size_t> total_slots;
+            for (size_t c = 0; c < packing.feature_count(); c++) total_slots.push_back(packing.total_slot(c));
+            response["encrypted_result"] = sums.to_wire(wire);
+            response["total_slots"] = total_slots;
+            response["layout"] = patient_layout_name(layout);
+            response["block_size"] = packing.block_size();
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: CSV Layout Conversion
+    // ========================================
+    // POST /csv/relayout
+    // Columns uploaded together (/csv/encrypt_columns on mini-backend) in the
+    // other PatientPacking layout, so a client uploads once and each query
+    // gets the layout it runs best on: sample_major for per-row inference,
+    // feature_major for column aggregates. Each ciphertext's P x block_size
+    // table is transposed with masked rotations in one level (see
+    // SlotPermutation): baby steps hoisted, about 2 sqrt(slots) rotations and
+    // one plaintext product per diagonal. The masks are encoded on first use
+    // per column count and kept. Needs Galois keys; under BFV and BGV a row
+    // swap too. BFV spends noise budget instead of a level
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", ...],
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "columns": 3,             // as /csv/encrypt_columns returned
+    //   "layout": "feature_major",  // layout wanted; the ciphertexts are in the other
+    //   "profile": "sum-fast",    // optional, see /add_encrypted
+    //   "compression": "zlib",    // optional, see /add_encrypted
+    //   "compact_result": true    // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_results": ["packed1", ...],  // same rows, in the layout wanted
+    //   "layout": "feature_major",
+    //   "block_size": 4,
+    //   "diagonals": 1706,        // plaintext products per ciphertext
+    //   "baby_step": 64,
+    //   "rotations": 126,         // per ciphertext: baby + giant + row swaps
+    //   "hoisted_rotations": 6,
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    CROW_ROUTE(app, "/csv/relayout")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !json_data.has("columns") ||
+            !json_data.has("layout")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            PatientLayout layout = parse_patient_layout(json_data["layout"].s());
+            PatientLayout from = layout == PatientLayout::sample_major ? PatientLayout::feature_major
+                                                                       : PatientLayout::sample_major;
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            PatientPacking packing(layout, static_cast<size_t>(json_data["columns"].u()), he.slot_count());
+            EncryptedVector inputs = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            HE_LOG(Info) << "Homomorphic layout conversion | Scheme: " << scheme
+                         << " | Ciphertexts: " << inputs.size()
+                         << " | Columns: " << packing.feature_count()
+                         << " | Layout: " << patient_layout_name(from) << " -> " << patient_layout_name(layout);
+
+            auto ticket = admit(he, inputs.size());
+            if (!ticket) return admission_refused(ticket);
+            const SlotPermutation& permutation = relayout(packing, from, he);
+            PermutationStats counts;
+            std::vector<seal::Ciphertext> results;
+            for (size_t i = 0; i < inputs.size(); i++) results.push_back(permutation.apply(inputs.data()[i], &counts));
+
+            response["encrypted_results"] = EncryptedVector(he, std::move(results)).to_wire(wire);
+            response["layout"] = patient_layout_name(layout);
+            response["block_size"] = packing.block_size();
+            response["diagonals"] = permutation.diagonal_count();
+            response["baby_step"] = permutation.baby_step();
+            response["rotations"] = counts.baby_rotations + counts.giant_rotations + counts.row_swaps;
+            response["hoisted_rotations"] = counts.hoisted_rotations;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: CSV Average Operation
+    // ========================================
+    // POST /csv/average
+    // Computes homomorphic average of multiple encrypted values
+    // CKKS: the server multiplies the sum by an encoded 1/count and rescales, so
+    // the result decrypts to the mean (it costs one level). BFV cannot divide
+    // within its plaintext ring and returns the sum, as does CKKS under a profile
+    // with no level to spare (sum-fast); "divided_by_count" tells them apart
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["cipher1", "cipher2", ...],
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "count": number_of_values,  // packed: values, not ciphertexts
+    //   "packed": true,             // optional, see /csv/sum
+    //   "profile": "sum-fast",      // optional, see /add_encrypted
+    //   "compression": "zlib",      // optional, see /add_encrypted
+    //   "compact_result": true      // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "mean_ciphertext",
+    //   "divided_by_count": true,   // false: the result is the sum, divide after decryption
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    CROW_ROUTE(app, "/csv/average")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        ResultCache::Flight flight;
+        if (auto replayed = find_result(req, flight)) return std::move(*replayed);
+
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+        
+        // Validate required fields
+        if (!json_data || 
+            !json_data.has("encrypted_values") || 
+            !json_data.has("scheme") || 
+            !json_data.has("count")) {
             response["error"] = "Missing required fields";
             return crow::response(400, response);
         }
@@ -282,26 +1882,4301 @@ int main() {
         try {
             std::string scheme = json_data["scheme"].s();
             auto encrypted_values = json_data["encrypted_values"];
-            int count = json_data["count"].i();  // Count parameter (currently unused in computation)
+            int64_t count = json_data["count"].i();
+            if (count <= 0) {
+                response["error"] = "count must be positive";
+                return crow::response(400, response);
+            }
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+            
+            // Ciphertexts are read in place from the parsed body
+            CiphertextViews ciphertexts = json_views(encrypted_values);
             
-            // Convert JSON array to vector of ciphertext strings
-            std::vector<std::string> ciphertexts;
-            for (const auto& val : encrypted_values) {
-                ciphertexts.push_back(val.s());
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            auto ticket = admit(he, ciphertexts.size());
+            if (!ticket) return admission_refused(ticket);
+            bool divided = false;
+            response["encrypted_result"] =
+                he.average(ciphertexts, static_cast<size_t>(count), packed, wire, &divided);
+            response["divided_by_count"] = divided;
+            
+            report_wire_sizes(response, wire);
+            report_plan(response, he, PlanOperation::mean, ciphertexts.size(), packed);
+            return keep_result(flight, crow::response(200, response));
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: CSV Variance Operation
+    // ========================================
+    // POST /csv/variance
+    // Computes the first two moments sum(x) and sum(x^2) of encrypted values in
+    // one pass: each ciphertext is squared server-side, so x^2 is not uploaded
+    // separately. The client derives var(x) = sum(x^2) / n - (sum(x) / n)^2
+    // (and the standard deviation) after decryption. Needs relinearization keys
+    // from --key-dir and a profile of depth >= 1
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["cipher1", "cipher2", ...],
+    //   "scheme": "bfv" | "ckks" | "bgv",  // BFV, BGV: sum(x^2) must stay below the plain modulus
+    //   "packed": true,             // optional, see /csv/sum (also needs Galois keys)
+    //   "profile": "default",       // optional, see /add_encrypted
+    //   "compression": "zlib",      // optional, see /add_encrypted
+    //   "compact_result": true      // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_sum": "sum_ciphertext",
+    //   "encrypted_sum_of_squares": "sum_of_squares_ciphertext",
+    //   "compression": "zlib",
+    //   "raw_bytes": 786658,    // both results together
+    //   "wire_bytes": 739560
+    // }
+    CROW_ROUTE(app, "/csv/variance")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            CiphertextViews ciphertexts = json_views(json_data["encrypted_values"]);
+            HE_LOG(Info) << "Homomorphic CSV variance | Scheme: " << scheme
+                         << " | Values count: " << ciphertexts.size();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            auto ticket = admit(he, ciphertexts.size());
+            if (!ticket) return admission_refused(ticket);
+            auto moments = he.moments(ciphertexts, packed, wire);
+
+            response["encrypted_sum"] = std::move(moments.first);
+            response["encrypted_sum_of_squares"] = std::move(moments.second);
+            report_wire_sizes(response, wire);
+            report_plan(response, he, PlanOperation::variance, ciphertexts.size(), packed);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: CSV Covariance Operation
+    // ========================================
+    // POST /csv/covariance
+    // Everything the covariance and correlation of two packed columns need,
+    // e.g. age against billing amount, in one packed result: sum(x y),
+    // sum(x), sum(y), sum(x^2) and sum(y^2). The chunks' products are taken
+    // concurrently, summed unrelinearized and folded together (see
+    // HomomorphicEncryption::covariance). After decryption cov = sum(x y) / n
+    // - sum(x) sum(y) / n^2 and corr = cov / (sd(x) sd(y)). Needs
+    // relinearization and Galois keys; CKKS and BGV need two levels, i.e.
+    // profile mult-depth-2 or ml-inference rather than default
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_x": ["packed1", ...],  // from /encrypt_vector or /csv/encrypt
+    //   "encrypted_y": ["packed1", ...],  // the same number of values, chunked alike
+    //   "scheme": "bfv" | "ckks" | "bgv",  // BFV, BGV: the sums must stay below the plain modulus
+    //   "profile": "mult-depth-2",    // optional, see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed_ciphertext",
+    //   "slots": {"sum_xy": 0, "sum_x": 1, "sum_y": 2, "sum_x2": 3, "sum_y2": 4},
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    CROW_ROUTE(app, "/csv/covariance")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_x") ||
+            !json_data.has("encrypted_y") ||
+            !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            CiphertextViews x_views = json_views(json_data["encrypted_x"]);
+            CiphertextViews y_views = json_views(json_data["encrypted_y"]);
+            if (x_views.size() != y_views.size()) {
+                throw std::invalid_argument("Expected as many ciphertexts of y as of x");
+            }
+            HE_LOG(Info) << "Homomorphic CSV covariance | Scheme: " << scheme
+                         << " | Ciphertexts: " << x_views.size() << " per column";
+
+            auto ticket = admit(he, 2 * x_views.size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedVector x = EncryptedVector::from_wire(he, x_views);
+            EncryptedVector y = EncryptedVector::from_wire(he, y_views);
+            EncryptedValue sums(he, he.covariance(x.data(), y.data(), x.size()));
+
+            response["encrypted_result"] = sums.to_wire(wire);
+            response["slots"]["sum_xy"] = static_cast<size_t>(HomomorphicEncryption::sum_xy);
+            response["slots"]["sum_x"] = static_cast<size_t>(HomomorphicEncryption::sum_x);
+            response["slots"]["sum_y"] = static_cast<size_t>(HomomorphicEncryption::sum_y);
+            response["slots"]["sum_x2"] = static_cast<size_t>(HomomorphicEncryption::sum_x2);
+            response["slots"]["sum_y2"] = static_cast<size_t>(HomomorphicEncryption::sum_y2);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: CSV Group-By Operation
+    // ========================================
+    // POST /csv/group_by
+    // Per-category sums of a packed column (e.g. billing amount per Medical
+    // Condition) in one request: each group's plaintext 0/1 slot mask weights
+    // the column, the slots are summed, and group g's total lands in slot g of
+    // a single packed result. Groups are evaluated in parallel. Divide by the
+    // group sizes (known to the client, which built the masks) for averages.
+    // Needs Galois keys; CKKS needs two levels with headroom left, and BGV two
+    // levels, i.e. profile mult-depth-2 or ml-inference rather than default
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", "packed2", ...],  // from /encrypt_vector
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "masks": [[1, 0, 0, 1, ...], [0, 1, 1, 0, ...]],  // one per group, one entry per value
+    //   "groups": [0, 1, 1, 0, ...],  // or instead: group index per value (-1 = none)
+    //   "profile": "mult-depth-2",    // optional, see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed_ciphertext",  // slot g = total of group g
+    //   "group_count": 2,
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    CROW_ROUTE(app, "/csv/group_by")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !(json_data.has("masks") || json_data.has("groups"))) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            std::vector<std::vector<double>> masks;
+            if (json_data.has("masks")) {
+                for (const auto& mask : json_data["masks"]) {
+                    masks.emplace_back();
+                    for (const auto& bit : mask) masks.back().push_back(bit.d());
+                }
+            } else {
+                const auto& groups = json_data["groups"];
+                for (size_t i = 0; i < groups.size(); i++) {
+                    int64_t group = groups[i].i();
+                    if (group == -1) continue;
+                    // Group g's total lands in slot g, so the slots bound the groups
+                    if (group < 0 || static_cast<size_t>(group) >= he.slot_count()) {
+                        throw std::invalid_argument("Group index " + std::to_string(group) + " out of range [-1, " +
+                                                    std::to_string(he.slot_count()) + ")");
+                    }
+                    if (static_cast<size_t>(group) >= masks.size()) masks.resize(group + 1);
+                    masks[group].resize(groups.size(), 0.0);
+                    masks[group][i] = 1.0;
+                }
+                for (auto& mask : masks) mask.resize(groups.size(), 0.0);  // Groups no value belongs to
+            }
+
+            auto ticket = admit(he, json_data["encrypted_values"].size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedVector column = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            HE_LOG(Info) << "Homomorphic CSV group-by | Scheme: " << scheme
+                         << " | Ciphertexts: " << column.size() << " | Groups: " << masks.size();
+
+            seal::Ciphertext result = he.group_sum(column.data(), column.size(), masks);
+            response["encrypted_result"] = he.serialize(result, wire);
+            response["group_count"] = masks.size();
+            report_wire_sizes(response, wire);
+            report_plan(response, he, PlanOperation::group_by, column.size(),
+                        !masks.empty() && masks[0].size() != column.size(), masks.size());
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: CSV Filtered Sums
+    // ========================================
+    // POST /csv/filtered_sums
+    // Totals of a sensitive packed column (e.g. Billing Amount) under WHERE
+    // clauses on public columns sent in plaintext (e.g. Admission Type =
+    // Emergency, Date of Admission in 2024). The server evaluates each
+    // filter's predicates and fuses them into one 0/1 row mask (RowFilter),
+    // so every filter costs one plaintext product per ciphertext however
+    // many predicates it has. All filters come back in one ciphertext:
+    // filter g's total in slot g, via HomomorphicEncryption::masked_sums, one
+    // level and W - 1 + log2(slots / W) rotations for W = the filter count
+    // rounded up to a power of two. The matching row counts are public and
+    // returned in plaintext, for averages. Needs Galois keys
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", ...],  // from /encrypt_vector, row order
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "public_columns": {                    // one cell per row, strings or numbers
+    //     "Admission Type": ["Emergency", "Elective", ...],
+    //     "Date of Admission": ["2024-01-31", "2023-11-02", ...]
+    //   },
+    //   "filters": [                           // each an AND of predicates
+    //     [{"column": "Admission Type", "value": "Emergency"}],
+    //     [{"column": "Admission Type", "op": "in", "value": ["Urgent", "Emergency"]},
+    //      {"column": "Date of Admission", "op": "between", "value": ["2024-01-01", "2024-12-31"]}]
+    //   ],                                     // op: eq (default), ne, lt, le, gt, ge, in, between
+    //   "profile": "sum-fast",        // optional, see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed_ciphertext",  // slot g = total of filter g
+    //   "filter_count": 2,
+    //   "row_counts": [18210, 9033],  // rows each filter selects
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    CROW_ROUTE(app, "/csv/filtered_sums")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !json_data.has("public_columns") ||
+            !json_data.has("filters")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            PublicColumns columns = parse_public_columns(json_data["public_columns"]);
+            std::vector<RowFilter> filters = parse_row_filters(json_data["filters"]);
+            std::vector<std::vector<double>> masks;
+            std::vector<size_t> row_counts;
+            for (const auto& filter : filters) {
+                masks.push_back(columns.mask(filter));
+                row_counts.push_back(std::count(masks.back().begin(), masks.back().end(), 1.0));
+            }
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            auto ticket = admit(he, json_data["encrypted_values"].size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedVector column = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            HE_LOG(Info) << "Homomorphic CSV filtered sums | Scheme: " << scheme
+                         << " | Ciphertexts: " << column.size() << " | Filters: " << filters.size();
+
+            seal::Ciphertext result = he.masked_sums(column.data(), column.size(), masks);
+            response["encrypted_result"] = he.serialize(result, wire);
+            response["filter_count"] = filters.size();
+            response["row_counts"] = row_counts;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Aggregate Query
+    // ========================================
+    // POST /query
+    // A dashboard query in one round trip: SUM, AVG, COUNT and VAR of
+    // encrypted columns, WHERE and GROUP BY on public columns sent in
+    // plaintext. The server compiles it into a QueryPlan: one 0/1 row mask
+    // per group (WHERE fused in), the row counts (which answer COUNT), and the
+    // distinct kernels the terms need, each column's totals and, for VAR, its
+    // totals of squares. All totals run as one batched masked_sums over the
+    // columns back to back, the plaintext products spread over the thread
+    // pool, and come back in one ciphertext; the totals of squares likewise
+    // in a second. The client divides for AVG (sum / n) and VAR (squares / n
+    // - mean^2). VAR needs relinearization keys and a profile of depth >= 2
+    // (CKKS: one more level, e.g. "ml-inference"). Columns are inline, or
+    // stored ones (default profile) by handle. Needs Galois keys
+    //
+    // Request body (JSON):
+    // {
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "encrypted_columns": {                 // from /encrypt_vector, row order
+    //     "Billing Amount": ["packed1", ...],
+    //     "Length of Stay": "3f2a..."          // or a handle (see /store)
+    //   },
+    //   "public_columns": {                    // one cell per row, strings or numbers
+    //     "Admission Type": ["Emergency", "Elective", ...],
+    //     "Date of Admission": ["2024-01-31", "2023-11-02", ...]
+    //   },
+    //   "select": [
+    //     {"aggregate": "count"},
+    //     {"aggregate": "avg", "column": "Billing Amount"},
+    //     {"aggregate": "var", "column": "Length of Stay"}
+    //   ],                                     // aggregate: sum, avg, count, var
+    //   "where": [{"column": "Date of Admission", "op": "ge", "value": "2024-01-01"}],  // optional
+    //   "group_by": "Admission Type",          // optional
+    //   "profile": "ml-inference",    // optional, inline columns only; see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "groups": ["Elective", "Emergency", "Urgent"],  // GROUP BY values; [""] without
+    //   "row_counts": [3012, 3105, 2998],
+    //   "encrypted_sums": "packed_ciphertext",      // totals (if any term needs them)
+    //   "encrypted_squares": "packed_ciphertext",   // totals of squares (if any var)
+    //   "select": [                                 // group g at slot + g
+    //     {"aggregate": "count"},
+    //     {"aggregate": "avg", "column": "Billing Amount", "sum_slot": 0},
+    //     {"aggregate": "var", "column": "Length of Stay", "sum_slot": 3, "square_slot": 0}
+    //   ],
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    CROW_ROUTE(app, "/query")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("scheme") ||
+            !json_data.has("encrypted_columns") ||
+            !json_data.has("public_columns") ||
+            !json_data.has("select")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            AggregateQuery query;
+            for (const auto& term : json_data["select"]) {
+                if (!term.has("aggregate")) throw std::invalid_argument("Select term needs \"aggregate\"");
+                query.select.push_back({ parse_query_aggregate(term["aggregate"].s()),
+                                         term.has("column") ? std::string(term["column"].s()) : "" });
+            }
+            if (json_data.has("where")) query.where = parse_row_filter(json_data["where"]);
+            if (json_data.has("group_by")) query.group_by = json_data["group_by"].s();
+            QueryPlan plan(query, parse_public_columns(json_data["public_columns"]));
+
+            // Stored columns live under the default profile, so any handle puts the query there
+            std::vector<std::string> handles;
+            size_t operands = 0;
+            for (const auto& column : json_data["encrypted_columns"]) {
+                if (column.t() == crow::json::type::String) handles.push_back(column.s());
+                operands += column.t() == crow::json::type::List ? column.size() : 0;
+            }
+            const bool stored = !handles.empty();
+            HomomorphicEncryption* he;
+            CiphertextStore* store = nullptr;
+            if (stored) {
+                select_scheme(req, scheme, he, store);
+            } else {
+                he = &select_he(req, scheme, request_profile(json_data));
+            }
+            auto ticket = admit(*he, operands);
+            if (!ticket) return admission_refused(ticket);
+            if (store) store->prefetch(handles);  // Columns in object storage download side by side
+            std::map<std::string, EncryptedVector> columns;
+            for (const auto& column : json_data["encrypted_columns"]) {
+                if (column.t() == crow::json::type::String) {
+                    columns.emplace(column.key(), EncryptedVector(*he, *store->get(column.s())));
+                } else {
+                    columns.emplace(column.key(), EncryptedVector::from_wire(*he, json_views(column)));
+                }
+            }
+            HE_LOG(Info) << "Homomorphic query | Scheme: " << scheme << " | Terms: " << query.select.size()
+                         << " | Groups: " << plan.groups().size() << " | Kernels: "
+                         << plan.sum_columns().size() + plan.square_columns().size();
+
+            auto [sums, squares] = plan.execute(*he, columns);
+            response["groups"] = plan.groups();
+            response["row_counts"] = plan.row_counts();
+            if (sums.size() != 0) response["encrypted_sums"] = he->serialize(sums, wire);
+            if (squares.size() != 0) response["encrypted_squares"] = he->serialize(squares, wire);
+            static const char* aggregate_names[] = { "sum", "avg", "count", "var" };
+            for (size_t i = 0; i < query.select.size(); i++) {
+                const QueryTerm& term = query.select[i];
+                auto& entry = response["select"][i];
+                entry["aggregate"] = aggregate_names[static_cast<int>(term.aggregate)];
+                if (term.aggregate == QueryAggregate::count) continue;
+                entry["column"] = term.column;
+                entry["sum_slot"] = plan.slot(term.column, false);
+                if (term.aggregate == QueryAggregate::var) entry["square_slot"] = plan.slot(term.column, true);
+            }
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: CSV Histogram Operation
+    // ========================================
+    // POST /csv/histogram
+    // Bucket counts (e.g. an age distribution) for all buckets in one pass. The
+    // client encodes each value as a one-hot vector of bucket_count slots and
+    // packs them back to back with /encrypt_vector (value v, bucket b at slot
+    // v * bucket_count + b); slot amounts instead of 1s give per-bucket sums.
+    // The server adds the ciphertexts and folds the slots with rotations by
+    // multiples of bucket_count, so slot b of the result holds bucket b's count.
+    // Needs Galois keys. Inputs are inline, or a stored column by "handle".
+    // With "cumulative" the counts are then masked to the first bucket_count
+    // slots and prefix-summed (HomomorphicEncryption::cumulative_counts), so
+    // slot b holds the count of buckets 0 .. b: mini-backend's
+    // /decrypt_percentiles reads any percentiles (e.g. the median) off that
+    // one ciphertext. That takes the Galois keys of rotation operation
+    // "prefix_sum", at most prefix chunk size buckets (2048 at N = 8192) and,
+    // under CKKS and BGV, one level more
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", "packed2", ...],  // or "handle" (see /store)
+    //   "handle": "3f2a...",
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "bucket_count": 8,            // power of two; pad with empty buckets
+    //   "cumulative": true,           // optional, cumulative counts (see above)
+    //   "profile": "sum-fast",        // optional, with "encrypted_values"; see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed_ciphertext",  // slots 0 .. bucket_count - 1 = counts
+    //   "bucket_count": 8,
+    //   "cumulative": true,
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,
+    //   "wire_bytes": 369780
+    // }
+    CROW_ROUTE(app, "/csv/histogram")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !(json_data.has("encrypted_values") || json_data.has("handle")) ||
+            !json_data.has("scheme") ||
+            !json_data.has("bucket_count")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            int64_t bucket_count = json_data["bucket_count"].i();
+            if (bucket_count <= 0) {
+                response["error"] = "bucket_count must be positive";
+                return crow::response(400, response);
+            }
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            seal::Ciphertext result;
+            HomomorphicEncryption* he;
+            AdmissionControl::Ticket ticket;
+            if (json_data.has("handle")) {
+                // Stored columns live under the default profile; their histograms are kept up to date
+                // by appends (see stored_aggregate)
+                CiphertextStore* store;
+                select_scheme(req, scheme, he, store);
+                result = stored_aggregate(*he, *store, json_data["handle"].s(), "histogram", false,
+                                          static_cast<size_t>(bucket_count));
+            } else {
+                he = &select_he(req, scheme, request_profile(json_data));
+                ticket = admit(*he, json_data["encrypted_values"].size());
+                if (!ticket) return admission_refused(ticket);
+                EncryptedVector column = EncryptedVector::from_wire(*he, json_views(json_data["encrypted_values"]));
+                if (column.empty()) {
+                    response["error"] = "Empty column";
+                    return crow::response(400, response);
+                }
+                result = he->histogram(column.data(), column.size(), static_cast<size_t>(bucket_count));
+            }
+            const bool cumulative = json_data.has("cumulative") && json_data["cumulative"].b();
+            if (cumulative) result = he->cumulative_counts(result, static_cast<size_t>(bucket_count));
+            HE_LOG(Info) << "Homomorphic CSV histogram | Scheme: " << scheme << " | Buckets: " << bucket_count
+                         << (cumulative ? " | Cumulative" : "");
+
+            response["encrypted_result"] = he->serialize(result, wire);
+            response["bucket_count"] = bucket_count;
+            response["cumulative"] = cumulative;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINTS: CSV Max / Min Operations
+    // ========================================
+    // POST /csv/max, POST /csv/min
+    // Approximate largest (smallest) of packed CKKS values, as a tournament of
+    // pairwise maxima max(a, b) = (a + b + (a - b) * sign(a - b)) / 2 with sign
+    // approximated by composite polynomials. One packed ciphertext of count
+    // values takes log2(count) rounds (several take log2 of all their slots),
+    // each needing at least 4 levels. Every level the profile has is spent, so
+    // deeper profiles give sharper results: the error is |a - b| / 2 times the
+    // sign error for two levels fewer than a round has (e.g. ml-inference,
+    // one 6-level round: 11% once |a - b| >= 0.6 * bound; a depth-7 profile
+    // such as {"depth": 7, "precision_bits": 20}: 4.4%).
+    // Needs relinearization and Galois keys
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", ...],  // from /encrypt_vector
+    //   "scheme": "ckks",
+    //   "count": 4,                   // number of values packed
+    //   "bound": 100.0,               // |value| <= bound for every value
+    //   "profile": "ml-inference",    // or "depth"/"precision_bits", see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed_ciphertext",  // slot 0 = maximum (minimum)
+    //   "rounds": 2,
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    auto extremum_route = [&](const crow::request& req, bool maximum) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !json_data.has("count") ||
+            !json_data.has("bound")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            int64_t count = json_data["count"].i();
+            if (count <= 0) {
+                response["error"] = "count must be positive";
+                return crow::response(400, response);
+            }
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            auto ticket = admit(he, json_data["encrypted_values"].size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedVector column = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            if (column.empty()) {
+                response["error"] = "Empty column";
+                return crow::response(400, response);
+            }
+            HE_LOG(Info) << "Homomorphic CSV " << (maximum ? "max" : "min") << " | Scheme: " << scheme
+                         << " | Values: " << count;
+
+            size_t rounds = 0;
+            seal::Ciphertext result = he.extremum(column.data(), column.size(), static_cast<size_t>(count),
+                                                  json_data["bound"].d(), maximum, &rounds);
+            response["encrypted_result"] = he.serialize(result, wire);
+            response["rounds"] = rounds;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    };
+
+    CROW_ROUTE(app, "/csv/max")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        return extremum_route(req, true);
+    });
+
+    CROW_ROUTE(app, "/csv/min")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        return extremum_route(req, false);
+    });
+
+    // ========================================
+    // REST API ENDPOINT: CSV Threshold Count Operation
+    // ========================================
+    // POST /csv/count_greater
+    // Approximate number of packed CKKS values above a threshold (e.g. patients
+    // with glucose > 140): the sum of (1 + sign(x - threshold)) / 2, with sign
+    // approximated by composite polynomials using all levels but one. Values
+    // equal to the threshold count half, values close to it partially: with
+    // ml-inference each value is off by at most 4.4% once it is 0.6 * bound
+    // from the threshold, with a depth-10 profile by 0.7% once it is 0.1 * bound
+    // away. Needs relinearization and Galois keys
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", ...],  // from /encrypt_vector
+    //   "scheme": "ckks",
+    //   "count": 768,                 // number of values packed
+    //   "threshold": 140.0,
+    //   "bound": 200.0,               // |value| <= bound for every value, and |threshold| <= bound
+    //   "profile": "ml-inference",    // or "depth"/"precision_bits", see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed_ciphertext",  // every slot = count (round after decrypting)
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    CROW_ROUTE(app, "/csv/count_greater")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !json_data.has("count") ||
+            !json_data.has("threshold") ||
+            !json_data.has("bound")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            int64_t count = json_data["count"].i();
+            if (count <= 0) {
+                response["error"] = "count must be positive";
+                return crow::response(400, response);
+            }
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            auto ticket = admit(he, json_data["encrypted_values"].size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedVector column = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            if (column.empty()) {
+                response["error"] = "Empty column";
+                return crow::response(400, response);
+            }
+            HE_LOG(Info) << "Homomorphic CSV threshold count | Scheme: " << scheme << " | Values: " << count;
+
+            seal::Ciphertext result = he.count_greater(column.data(), column.size(), static_cast<size_t>(count),
+                                                       json_data["threshold"].d(), json_data["bound"].d());
+            response["encrypted_result"] = he.serialize(result, wire);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Polynomial Evaluation
+    // ========================================
+    // POST /evaluate_polynomial
+    // p(x) slot-wise on packed CKKS ciphertexts, e.g. a polynomial activation
+    // of logistic regression scores. Paterson-Stockmeyer evaluation: a degree-d
+    // polynomial spends ceil(log2(d + 1)) (at most one more) levels rather
+    // than Horner's d, with powers of x computed once and reused. Every
+    // ciphertext is evaluated on its own worker. Needs relinearization keys
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", ...],  // from /encrypt_vector
+    //   "scheme": "ckks",
+    //   "coefficients": [0.5, 0.1973, 0, -0.0048],  // x^0, x^1, ...
+    //   "activation": "sigmoid",      // or instead: "sigmoid" | "square", see activation_coefficients
+    //   "profile": "ml-inference",    // or "depth"/"precision_bits", see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_results": ["packed1", ...],  // one per input
+    //   "depth": 2,                   // levels spent
+    //   "multiplications": 2,         // ciphertext products per input (relinearized and rescaled)
+    //   "constant_multiplications": 2,
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    CROW_ROUTE(app, "/evaluate_polynomial")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !(json_data.has("coefficients") || json_data.has("activation"))) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            std::vector<double> coefficients;
+            if (json_data.has("coefficients")) {
+                for (const auto& coefficient : json_data["coefficients"]) coefficients.push_back(coefficient.d());
+            } else {
+                coefficients = activation_coefficients(json_data["activation"].s());
+            }
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            EncryptedVector inputs = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            HE_LOG(Info) << "Homomorphic polynomial | Scheme: " << scheme << " | Ciphertexts: " << inputs.size()
+                         << " | Degree: " << (coefficients.empty() ? 0 : coefficients.size() - 1);
+
+            PolynomialStats polynomial;
+            std::vector<seal::Ciphertext> results =
+                he.evaluate_polynomial(inputs.data(), inputs.size(), coefficients, &polynomial);
+            response["encrypted_results"] = EncryptedVector(he, std::move(results)).to_wire(wire);
+            response["depth"] = polynomial.depth;
+            response["multiplications"] = polynomial.power_products + polynomial.giant_products;
+            response["constant_multiplications"] = polynomial.constant_multiplications;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Reciprocals and Standardization
+    // ========================================
+    // POST /inverse
+    // 1/x, or 1/sqrt(x), slot-wise on packed CKKS values known to lie in
+    // [low, high], so divisions need no round trip to the key holder: one
+    // level scales x into (0, 1], a polynomial guess and Newton steps of two
+    // levels each take the rest (see InverseApproximation.h). The cheapest
+    // plan within the tolerance is used; the wider high / low, the more levels
+    // it takes (1/x on [1, 10] to 1e-4: 8, 1/sqrt(x): 6). Needs
+    // relinearization keys
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", ...],  // from /encrypt_vector
+    //   "scheme": "ckks",
+    //   "low": 1.0,                   // every slot in [low, high], 0 < low < high
+    //   "high": 10.0,
+    //   "square_root": false,         // optional: 1/sqrt(x) instead of 1/x
+    //   "tolerance": 1e-4,            // optional, largest relative error (default 1e-4)
+    //   "profile": "ml-inference",    // or "depth"/"precision_bits", see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_results": ["packed1", ...],  // one per input
+    //   "depth": 6,                   // levels spent
+    //   "guess_degree": 3,
+    //   "iterations": 1,              // Newton steps
+    //   "relative_error": 2.1e-05,    // of the plan in the clear, before CKKS noise
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    auto report_inverse = [](crow::json::wvalue& response, const InverseApproximation& plan, size_t depth) {
+        response["depth"] = depth;
+        response["guess_degree"] = plan.guess.size() - 1;
+        response["iterations"] = plan.iterations;
+        response["relative_error"] = plan.relative_error;
+    };
+
+    CROW_ROUTE(app, "/inverse")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !json_data.has("low") ||
+            !json_data.has("high")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            bool square_root = json_data.has("square_root") && json_data["square_root"].b();
+            double tolerance = json_data.has("tolerance") ? json_data["tolerance"].d() : 1e-4;
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            auto ticket = admit(he, json_data["encrypted_values"].size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedVector inputs = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            HE_LOG(Info) << "Homomorphic inverse | Scheme: " << scheme << " | Ciphertexts: " << inputs.size()
+                         << " | Square root: " << square_root;
+
+            InverseApproximation plan;
+            std::vector<seal::Ciphertext> results = he.inverse(inputs.data(), inputs.size(), json_data["low"].d(),
+                                                               json_data["high"].d(), square_root, tolerance, &plan);
+            response["encrypted_results"] = EncryptedVector(he, std::move(results)).to_wire(wire);
+            report_inverse(response, plan, 1 + plan.depth());
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /csv/standardize
+    // z-scores (x - mean) / sd of a packed CKKS column, the mean and the
+    // population variance computed and inverted under encryption (see
+    // HomomorphicEncryption::standardize), optionally followed by a polynomial
+    // of the z-scores, so standardize-then-score runs in one request. The
+    // variance must lie in [variance_low, variance_high]; 3 levels plus those
+    // of 1/sqrt on that range, plus the polynomial's. Padding slots come out
+    // as -mean / sd. Needs relinearization and Galois keys
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", ...],  // from /encrypt_vector
+    //   "scheme": "ckks",
+    //   "count": 768,                 // number of values packed
+    //   "variance_low": 100.0,
+    //   "variance_high": 400.0,
+    //   "tolerance": 1e-4,            // optional, of 1/sd, see /inverse
+    //   "coefficients": [0.5, 0.1973, 0, -0.0048],  // optional, see /evaluate_polynomial
+    //   "activation": "sigmoid",      // optional, instead of coefficients
+    //   "profile": "ml-inference",    // or "depth"/"precision_bits", see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_results": ["packed1", ...],  // one per input
+    //   "depth": 8,                   // levels spent, polynomial included
+    //   "guess_degree": 3,            // of 1/sqrt(variance), see /inverse
+    //   "iterations": 1,
+    //   "relative_error": 3.6e-05,
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    CROW_ROUTE(app, "/csv/standardize")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_values") ||
+            !json_data.has("scheme") ||
+            !json_data.has("count") ||
+            !json_data.has("variance_low") ||
+            !json_data.has("variance_high")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            int64_t count = json_data["count"].i();
+            if (count <= 0) {
+                response["error"] = "count must be positive";
+                return crow::response(400, response);
+            }
+            double tolerance = json_data.has("tolerance") ? json_data["tolerance"].d() : 1e-4;
+            std::vector<double> coefficients;
+            if (json_data.has("coefficients")) {
+                for (const auto& coefficient : json_data["coefficients"]) coefficients.push_back(coefficient.d());
+            } else if (json_data.has("activation")) {
+                coefficients = activation_coefficients(json_data["activation"].s());
+            }
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            auto ticket = admit(he, json_data["encrypted_values"].size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedVector column = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            if (column.empty()) {
+                response["error"] = "Empty column";
+                return crow::response(400, response);
+            }
+            HE_LOG(Info) << "Homomorphic CSV standardize | Scheme: " << scheme << " | Values: " << count
+                         << " | Degree: " << (coefficients.empty() ? 0 : coefficients.size() - 1);
+
+            const size_t reserve =
+                coefficients.empty() ? 0 : PolynomialEvaluator(he, *column.data()).depth(coefficients);
+            InverseApproximation plan;
+            std::vector<seal::Ciphertext> results =
+                he.standardize(column.data(), column.size(), static_cast<size_t>(count), json_data["variance_low"].d(),
+                               json_data["variance_high"].d(), tolerance, reserve, &plan);
+            size_t depth = 3 + plan.depth();
+            if (!coefficients.empty()) {
+                PolynomialStats polynomial;
+                results = he.evaluate_polynomial(results.data(), results.size(), coefficients, &polynomial);
+                depth += polynomial.depth;
+            }
+            response["encrypted_results"] = EncryptedVector(he, std::move(results)).to_wire(wire);
+            report_inverse(response, plan, depth);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Prefix Sums
+    // ========================================
+    // POST /prefix_sum
+    // Running totals of an encrypted series, e.g. admissions per day or billing
+    // to date (HomomorphicEncryption::prefix_sums). The series comes in chunks
+    // of chunk_size values, one per ciphertext, from mini-backend's
+    // /encrypt_vector with "prefix_sum": half a CKKS vector or half a BFV row
+    // (2048 values at N = 8192), so a year of days fits one ciphertext. Per
+    // chunk log2(chunk_size) rotations for the scan and log2(slots) for the
+    // total carried into later chunks, and no levels or plaintext products.
+    // Needs the Galois keys of rotation operation "prefix_sum" (mini-backend
+    // --galois-operations)
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["packed1", ...],  // chunks in series order
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "profile": "sum-fast",        // optional, see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_results": ["packed1", ...],  // one per chunk; slot i of result c holds
+    //                                 // the total up to value c * chunk_size + i
+    //   "chunk_size": 2048,           // read back with /decrypt_vector's "chunk_size"
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    CROW_ROUTE(app, "/prefix_sum")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("encrypted_values") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            EncryptedVector inputs = EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"]));
+            HE_LOG(Info) << "Homomorphic prefix sum | Scheme: " << scheme << " | Ciphertexts: " << inputs.size();
+
+            std::vector<seal::Ciphertext> results = he.prefix_sums(inputs.data(), inputs.size());
+            response["encrypted_results"] = EncryptedVector(he, std::move(results)).to_wire(wire);
+            response["chunk_size"] = he.prefix_chunk_size();
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Logistic Regression Inference
+    // ========================================
+    // POST /ml/logreg/predict
+    // Diabetes-style risk scores sigmoid(w . x + b) for many patients per
+    // ciphertext (CKKS), in either PatientPacking layout: "sample_major" puts
+    // patient p's features in slots p * block_size .. p * block_size +
+    // features - 1, "feature_major" puts feature i of all P patients in slots
+    // i * P .. i * P + P - 1; block_size is the feature count rounded up to a
+    // power of two (8 diabetes features: 1024 patients per ciphertext under
+    // ml-inference). /ml/encrypt_patients on mini-backend packs rows either
+    // way and /ml/decrypt_scores reads the scores back. Per ciphertext one multiply_plain, log2(block_size) rotations
+    // and the cubic sigmoid of fullyEndtoEndLogisticRegression.py: 3 levels,
+    // so use profile ml-inference. The sigmoid fit is close for scores in
+    // [-4, 4] only. Needs relinearization and Galois keys
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_features": ["packed1", ...],  // from /ml/encrypt_patients
+    //   "scheme": "ckks",
+    //   "layout": "feature_major",    // optional, default "sample_major"
+    //   "model": "diabetes_logreg",   // a --model-dir file; or instead inline:
+    //   "weights": [0.4, 1.1, ...], "bias": -0.9,  // plus optional "mean", "scale",
+    //                                 // "sigmoid" as in parse_logistic_model
+    //   "profile": "ml-inference",    // or "depth"/"precision_bits", see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_results": ["packed1", ...],  // one per input; slot p * block_size
+    //                                 // (feature_major: slot p) holds patient p's probability
+    //   "layout": "sample_major",
+    //   "block_size": 8,
+    //   "patients_per_ciphertext": 512,
+    //   "features": ["Glucose", ...], // model's packing order, if it has names
+    //   "depth": 3,
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    CROW_ROUTE(app, "/ml/logreg/predict")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_features") ||
+            !json_data.has("scheme") ||
+            !(json_data.has("model") || json_data.has("weights"))) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            LogisticModel inline_model;
+            const LogisticModel* model = &inline_model;
+            if (json_data.has("model")) {
+                auto found = models.logistic.find(json_data["model"].s());
+                if (found == models.logistic.end()) throw std::out_of_range("Unknown model: " + std::string(json_data["model"].s()));
+                model = &found->second;
+            } else {
+                inline_model = parse_logistic_model(json_data);
+            }
+
+            PatientLayout layout = json_data.has("layout") ? parse_patient_layout(json_data["layout"].s())
+                                                           : PatientLayout::sample_major;
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            EncryptedVector inputs = EncryptedVector::from_wire(he, json_views(json_data["encrypted_features"]));
+            HE_LOG(Info) << "Homomorphic logistic regression | Scheme: " << scheme << " | Ciphertexts: "
+                         << inputs.size() << " | Features: " << model->weights.size()
+                         << " | Layout: " << patient_layout_name(layout);
+
+            size_t depth = 0;
+            std::vector<seal::Ciphertext> results = he.logistic_regression(inputs.data(), inputs.size(), *model, &depth, layout);
+            response["encrypted_results"] = EncryptedVector(he, std::move(results)).to_wire(wire);
+            response["layout"] = patient_layout_name(layout);
+            response["block_size"] = model->block_size();
+            response["patients_per_ciphertext"] = he.slot_count() / model->block_size();
+            if (!model->features.empty()) response["features"] = model->features;
+            response["depth"] = depth;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Linear Regression Aggregates
+    // ========================================
+    // POST /ml/linreg/aggregate
+    // Everything a least-squares fit y ~ intercept + w . x needs from packed
+    // feature and target columns, in one pass and one packed result: X^T X,
+    // X^T y, the feature sums, sum(y) and sum(y^2) (see NormalEquations).
+    // The products are spread over the compute threads and all the totals
+    // folded together (HomomorphicEncryption::cross_sums); the key holder
+    // decrypts the (d + 1) x (d + 1) system and solves it, e.g. with
+    // /ml/linreg/solve on mini-backend, instead of training with encrypted
+    // gradient steps. Needs relinearization and Galois keys; CKKS and BGV
+    // need two levels, i.e. profile mult-depth-2 or ml-inference
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_features": [["packed1", ...], ...],  // one packed column per feature
+    //   "encrypted_target": ["packed1", ...],            // the same rows, chunked alike
+    //   "scheme": "ckks",             // BFV, BGV: integer data, sums below the plain modulus
+    //   "profile": "mult-depth-2",    // optional, see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed_ciphertext",
+    //   "features": 3,
+    //   "terms": 14,                  // slots holding aggregates
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    CROW_ROUTE(app, "/ml/linreg/aggregate")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_features") ||
+            !json_data.has("encrypted_target") ||
+            !json_data.has("scheme") ||
+            json_data["encrypted_features"].size() == 0) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            const NormalEquations equations(json_data["encrypted_features"].size());
+            std::vector<CiphertextViews> views;
+            for (const auto& column : json_data["encrypted_features"]) views.push_back(json_views(column));
+            views.push_back(json_views(json_data["encrypted_target"]));
+            for (const auto& column : views) {
+                if (column.size() != views.back().size() || column.empty()) {
+                    throw std::invalid_argument("Expected as many ciphertexts of every feature as of the target");
+                }
+            }
+            HE_LOG(Info) << "Homomorphic linear regression aggregates | Scheme: " << scheme
+                         << " | Features: " << equations.feature_count()
+                         << " | Ciphertexts: " << views.back().size() << " per column";
+
+            auto ticket = admit(he, views.size() * views.back().size());
+            if (!ticket) return admission_refused(ticket);
+            std::vector<EncryptedVector> columns;
+            std::vector<const seal::Ciphertext*> column_data;
+            for (const auto& column : views) columns.push_back(EncryptedVector::from_wire(he, column));
+            for (const auto& column : columns) column_data.push_back(column.data());
+            EncryptedValue sums(he, he.cross_sums(column_data, views.back().size(), equations.terms()));
+
+            response["encrypted_result"] = sums.to_wire(wire);
+            response["features"] = equations.feature_count();
+            response["terms"] = equations.terms().size();
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Matrix-Vector Product
+    // ========================================
+    // POST /ml/matvec
+    // W x for a plaintext m x n matrix W and an encrypted vector x (CKKS), e.g.
+    // a dense layer: Halevi-Shoup diagonals with baby-step/giant-step rotations,
+    // about 2 sqrt(d) rotations for d = max(m, n) rounded up to a power of two
+    // (see DiagonalMatrix). One level. Model matrices keep their encoded
+    // diagonals across requests; inline ones are encoded per request. A
+    // bias is added at no level, and a standardization of x ("mean" and
+    // "scale", as StandardScaler fit it) is folded into matrix and bias, so
+    // raw features go in at no extra level (see parse_matrix_model). Needs
+    // Galois keys; profile ml-inference has baby-step keys for hoisting
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_vector": "packed",  // n values from /encrypt_vector, or tiled (below)
+    //   "scheme": "ckks",
+    //   "model": "layer1",            // a --model-dir matrix file; or instead inline:
+    //   "matrix": [[0.5, -1], [2, 0.25]],  // rows, plus optional "bias", "mean", "scale"
+    //   "tiled": false,               // optional: x[i mod d] in every slot i already
+    //                                 // (e.g. a previous product), saves log2(slots / d) rotations
+    //   "profile": "ml-inference",    // or "depth"/"precision_bits", see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed",  // W x + b in slots 0 .. m - 1, tiled with period dimension
+    //   "dimension": 16,
+    //   "baby_step": 4,
+    //   "rotations": 6,               // baby + giant (tiling not included)
+    //   "hoisted_rotations": 3,
+    //   "plaintext_products": 16,
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    CROW_ROUTE(app, "/ml/matvec")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_vector") ||
+            !json_data.has("scheme") ||
+            !(json_data.has("model") || json_data.has("matrix"))) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+            const bool tiled = json_data.has("tiled") && json_data["tiled"].b();
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            std::unique_ptr<DiagonalMatrix> inline_matrix;
+            const DiagonalMatrix* matrix;
+            if (json_data.has("model")) {
+                matrix = &model_matrix(json_data["model"].s(), he);
+            } else {
+                MatrixModel model = parse_matrix_model(json_data);
+                inline_matrix = std::make_unique<DiagonalMatrix>(he, model.rows, model.bias);
+                matrix = inline_matrix.get();
+            }
+            seal::Ciphertext x = he.deserialize(json_view(json_data["encrypted_vector"]));
+            HE_LOG(Info) << "Homomorphic matrix-vector product | Scheme: " << scheme << " | Matrix: "
+                         << matrix->rows() << "x" << matrix->columns();
+
+            MatrixVectorStats products;
+            seal::Ciphertext result = matrix->multiply(x, tiled, &products);
+            response["encrypted_result"] = he.serialize(result, wire);
+            response["dimension"] = matrix->dimension();
+            response["baby_step"] = matrix->baby_step();
+            response["rotations"] = products.baby_rotations + products.giant_rotations;
+            response["hoisted_rotations"] = products.hoisted_rotations;
+            response["plaintext_products"] = products.plaintext_products;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Centroid Distances
+    // ========================================
+    // POST /ml/kmeans/distances
+    // Squared distances of encrypted patients to k plaintext centroids, the
+    // assignment step of k-means or a nearest-centroid classifier. Patients
+    // come packed by /ml/encrypt_patients with "centroid_count": k, each
+    // repeated once per centroid (see CentroidPacking), so one sub_plain, one
+    // square and log2(block_size) rotations per ciphertext give all n x k
+    // distances of its patients, packed. /ml/kmeans/assign on mini-backend
+    // decrypts them and picks each patient's nearest centroid. The centroids
+    // are plaintext; send the next iteration's with the same ciphertexts. One
+    // level; relinearization and Galois keys. BFV and BGV take integer
+    // features whose distances stay below the plain modulus. With "mean" and
+    // "scale" the features are standardized first and the centroids are
+    // taken as standardized ones (CKKS, one more level: the squares would
+    // need 1 / scale^2 weights, so unlike a linear layer it cannot be folded)
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_features": ["packed1", ...],  // from /ml/encrypt_patients
+    //   "scheme": "ckks",
+    //   "centroids": [[120, 70, ...], [160, 85, ...], ...],  // k rows, one value per feature
+    //   "mean": [120.9, 69.1, ...],   // optional standardization (x - mean) / scale, one per feature
+    //   "scale": [31.9, 19.3, ...],
+    //   "profile": "mult-depth-1",    // or "depth"/"precision_bits", see /add_encrypted
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_results": ["packed1", ...],  // one per input; slot p * block_size * centroid_block
+    //                                 // + j * block_size holds patient p's distance to centroid j
+    //   "features": 8,
+    //   "centroid_count": 3,
+    //   "block_size": 8,
+    //   "centroid_block": 4,
+    //   "patients_per_ciphertext": 128,
+    //   "compression": "zlib",
+    //   "raw_bytes": 524440,
+    //   "wire_bytes": 493620
+    // }
+    CROW_ROUTE(app, "/ml/kmeans/distances")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data ||
+            !json_data.has("encrypted_features") ||
+            !json_data.has("scheme") ||
+            !json_data.has("centroids") ||
+            json_data["centroids"].size() == 0) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            std::vector<std::vector<double>> centroids = parse_matrix(json_data["centroids"]);
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            CentroidPacking packing(centroids[0].size(), centroids.size(), he.slot_count());
+            EncryptedVector inputs = EncryptedVector::from_wire(he, json_views(json_data["encrypted_features"]));
+            HE_LOG(Info) << "Homomorphic centroid distances | Scheme: " << scheme << " | Ciphertexts: "
+                         << inputs.size() << " | Centroids: " << centroids.size()
+                         << " | Features: " << packing.feature_count();
+
+            Standardization standardization = parse_standardization(json_data);
+            if (!standardization.mean.empty() || !standardization.scale.empty()) {
+                standardization.check(packing.feature_count());
+                const std::vector<std::vector<double>> copies(centroids.size(), standardization.multipliers());
+                const std::vector<std::vector<double>> offsets(centroids.size(), standardization.offsets());
+                FeatureScaler scaler(he, packing.replicate(copies), packing.replicate(offsets));
+                std::vector<seal::Ciphertext> scaled(inputs.size());
+                for (size_t i = 0; i < inputs.size(); i++) scaled[i] = scaler.apply(inputs.data()[i]);
+                inputs = EncryptedVector(he, std::move(scaled));
+            }
+
+            std::vector<seal::Ciphertext> results =
+                he.centroid_distances(inputs.data(), inputs.size(), packing, centroids);
+            response["encrypted_results"] = EncryptedVector(he, std::move(results)).to_wire(wire);
+            response["features"] = packing.feature_count();
+            response["centroid_count"] = packing.centroid_count();
+            response["block_size"] = packing.block_size();
+            response["centroid_block"] = packing.centroid_block();
+            response["patients_per_ciphertext"] = packing.patients_per_ciphertext();
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // BINARY TRANSPORT ENDPOINTS
+    // ========================================
+    // Same operations as above, but ciphertexts travel as raw SEAL bytes
+    // (Content-Type: application/octet-stream) instead of Base64 inside JSON.
+    // Multiple ciphertexts are length-prefixed (see BinaryFraming.h).
+    // An optional &compression=none|zlib|zstd selects the result's compression,
+    // &profile= (or &depth=) the parameter profile, &compact_result=1 a compact
+    // result (see /add_encrypted);
+    // X-HE-Compression / X-HE-Raw-Bytes / X-HE-Wire-Bytes report what was sent.
+
+    // POST /binary/add_encrypted?scheme=bfv|ckks
+    // Request body: framed [a, b]
+    // Response body: raw result ciphertext
+    CROW_ROUTE(app, "/binary/add_encrypted")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            std::vector<std::string_view> operands = framing::unframe(req.body_view());
+            WireStats stats;
+            WireOptions wire(WireFormat::binary,
+                             request_compression(req.url_params.get("compression"), default_compression), &stats);
+            wire.compact = req.url_params.get("compact_result") != nullptr;
+            if (operands.size() != 2) {
+                response["error"] = "Expected exactly two ciphertexts";
+                return crow::response(400, response);
+            }
+
+            std::string encrypted_result =
+                select_he(req, scheme, request_profile(req.url_params)).add(operands[0], operands[1], wire);
+            crow::response res = binary_response(std::move(encrypted_result));
+            report_wire_sizes(res, wire);
+            return res;
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /binary/csv/sum?scheme=bfv|ckks[&packed=1]
+    // Request body: framed [cipher1, cipher2, ...]
+    // Response body: raw sum ciphertext
+    CROW_ROUTE(app, "/binary/csv/sum")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        ResultCache::Flight flight;
+        if (auto replayed = find_result(req, flight)) return std::move(*replayed);
+
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            bool packed = req.url_params.get("packed") != nullptr;
+            CiphertextViews ciphertexts = framing::unframe(req.body_view());
+            WireStats stats;
+            WireOptions wire(WireFormat::binary,
+                             request_compression(req.url_params.get("compression"), default_compression), &stats);
+            wire.compact = req.url_params.get("compact_result") != nullptr;
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(req.url_params));
+            auto ticket = admit(he, ciphertexts.size());
+            if (!ticket) return admission_refused(ticket);
+            EncryptedValue total(he, he.deserialize_sum(ciphertexts, WireFormat::binary));
+            if (packed) total.sum_slots();
+            crow::response res = binary_response(total.to_wire(wire));
+            report_wire_sizes(res, wire);
+            return keep_result(flight, std::move(res));
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // CIPHERTEXT STORE ENDPOINTS
+    // ========================================
+    // Upload an encrypted column once, then run operations on it by handle.
+    // Stored ciphertexts are deserialized once at upload time; every operation
+    // below works on the in-memory objects and transfers only its result.
+
+    // PUT /store
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["cipher1", "cipher2", ...],   // regular, packed or seeded
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "packed_count": 9300      // optional, values packed into them from slot 0 (the "count"
+    //                             // of /encrypt_vector or /csv/encrypt): later appends of a single
+    //                             // ciphertext with a "packed_count" go into the free slots of the
+    //                             // column's last one while they fit, rather than a new ciphertext
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "handle": "3f2a...",
+    //   "count": 2
+    // }
+    CROW_ROUTE(app, "/store")
+    .methods("PUT"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("encrypted_values") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+
+            CiphertextStore::Column column =
+                EncryptedVector::from_wire(*he, json_views(json_data["encrypted_values"])).release();
+            if (column.empty()) throw std::invalid_argument("Cannot store an empty column");
+            size_t last_slots = packed_last_slots(
+                *he, column.size(), json_data.has("packed_count") ? json_data["packed_count"].u() : 0);
+
+            response["count"] = column.size();
+            return stored_response(response, store->put(std::move(column), last_slots));
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // PUT /binary/store?scheme=bfv|ckks[&packed_count=...]
+    // Request body: framed [cipher1, cipher2, ...] (see BinaryFraming.h)
+    // Response (JSON): same as PUT /store
+    CROW_ROUTE(app, "/binary/store")
+    .methods("PUT"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme_param ? scheme_param : "", he, store);
+
+            std::vector<std::string_view> payloads = framing::unframe(req.body_view());
+            CiphertextStore::Column column;
+            column.reserve(payloads.size());
+            for (const auto& payload : payloads) {
+                column.push_back(he->deserialize(payload, WireFormat::binary));
+            }
+            if (column.empty()) throw std::invalid_argument("Cannot store an empty column");
+            const char* packed_count = req.url_params.get("packed_count");
+            size_t last_slots = packed_last_slots(*he, column.size(), packed_count ? std::stoul(packed_count) : 0);
+
+            response["count"] = column.size();
+            return stored_response(response, store->put(std::move(column), last_slots));
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // PUT /shm/store (--shm-handoff)
+    // Store the ciphertexts a mini-backend on the same host left in a shared memory
+    // region (/csv/encrypt with "shared_memory"), loading them straight from the
+    // mapping. The region is consumed: it cannot be stored twice
+    //
+    // Request body (JSON):
+    // {
+    //   "region": "/he-3f2a...",
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "packed_count": 9300      // optional, see PUT /store
+    // }
+    //
+    // Response (JSON): same as PUT /store
+    CROW_ROUTE(app, "/shm/store")
+    .methods("PUT"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("region") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            if (!shm_handoff) throw std::invalid_argument("Shared memory regions need --shm-handoff");
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+
+            shm::Region region(json_data["region"].s());
+            std::vector<std::string_view> payloads = framing::unframe(region.bytes());
+            CiphertextStore::Column column;
+            column.reserve(payloads.size());
+            for (const auto& payload : payloads) {
+                column.push_back(he->deserialize(payload, WireFormat::binary));
+            }
+            if (column.empty()) throw std::invalid_argument("Cannot store an empty column");
+            size_t last_slots = packed_last_slots(
+                *he, column.size(), json_data.has("packed_count") ? json_data["packed_count"].u() : 0);
+
+            response["count"] = column.size();
+            return stored_response(response, store->put(std::move(column), last_slots));
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // GET /store/<handle>?scheme=bfv|ckks[&compression=...]
+    // Response (JSON):
+    // {
+    //   "encrypted_values": ["cipher1", ...]
+    // }
+    //
+    // DELETE /store/<handle>?scheme=bfv|ckks
+    // Response (JSON):
+    // {
+    //   "status": "ok"
+    // }
+    CROW_ROUTE(app, "/store/<string>")
+    .methods("GET"_method, "DELETE"_method)
+    ([&](const crow::request& req, const std::string& handle) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme_param ? scheme_param : "", he, store);
+
+            if (req.method == "DELETE"_method) {
+                if (!store->erase(handle)) {
+                    response["error"] = "Unknown ciphertext handle: " + handle;
+                    return crow::response(404, response);
+                }
+                response["status"] = "ok";
+                return crow::response(200, response);
+            }
+
+            WireOptions wire(WireFormat::base64,
+                             request_compression(req.url_params.get("compression"), default_compression));
+            auto column = store->get(handle);
+            std::vector<std::string> encrypted_values;
+            encrypted_values.reserve(column->size());
+            for (const auto& ct : *column) {
+                encrypted_values.push_back(he->serialize(ct, wire));
+            }
+            response["encrypted_values"] = std::move(encrypted_values);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /store/<handle>/append
+    // Append ciphertexts to a stored column, e.g. a day's new records; every
+    // aggregate materialized for it (see /store/aggregate) is updated in place
+    //
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["cipher1", ...],   // as for PUT /store
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "packed_count": 300       // optional, see PUT /store
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "count": 3                // stored ciphertexts afterwards (unchanged if merged)
+    // }
+    CROW_ROUTE(app, "/store/<string>/append")
+    .methods("POST"_method)
+    ([&](const crow::request& req, const std::string& handle) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("encrypted_values") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+
+            CiphertextStore::Column tail =
+                EncryptedVector::from_wire(*he, json_views(json_data["encrypted_values"])).release();
+            if (tail.empty()) throw std::invalid_argument("Nothing to append");
+            size_t last_slots = packed_last_slots(
+                *he, tail.size(), json_data.has("packed_count") ? json_data["packed_count"].u() : 0);
+
+            response["count"] = store->append(handle, std::move(tail), last_slots, store_merge(*he));
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /binary/store/<handle>/append?scheme=bfv|ckks[&packed_count=...]
+    // Request body: framed [cipher1, cipher2, ...] (see BinaryFraming.h)
+    // Response (JSON): same as POST /store/<handle>/append
+    CROW_ROUTE(app, "/binary/store/<string>/append")
+    .methods("POST"_method)
+    ([&](const crow::request& req, const std::string& handle) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme_param ? scheme_param : "", he, store);
+
+            std::vector<std::string_view> payloads = framing::unframe(req.body_view());
+            CiphertextStore::Column tail;
+            tail.reserve(payloads.size());
+            for (const auto& payload : payloads) {
+                tail.push_back(he->deserialize(payload, WireFormat::binary));
+            }
+            if (tail.empty()) throw std::invalid_argument("Nothing to append");
+            const char* packed_count = req.url_params.get("packed_count");
+            size_t last_slots = packed_last_slots(*he, tail.size(), packed_count ? std::stoul(packed_count) : 0);
+
+            response["count"] = store->append(handle, std::move(tail), last_slots, store_merge(*he));
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /store/sum
+    // POST /store/average
+    // Sum (or, for average, sum plus the number of stored ciphertexts; division
+    // stays client-side, since a packed column does not record how many values
+    // it holds) of a stored column. The sum is materialized on first use and
+    // kept up to date by appends, so repeated reads cost no evaluation
+    //
+    // Request body (JSON):
+    // {
+    //   "handle": "3f2a...",
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "packed": true,           // optional, see /csv/sum
+    //   "compression": "zlib",    // optional, see /add_encrypted
+    //   "compact_result": true    // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "sum_ciphertext",
+    //   "count": 2,               // /store/average only: stored ciphertexts
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,
+    //   "wire_bytes": 369780
+    // }
+    auto store_sum = [&](const crow::request& req, bool average) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("handle") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            std::string handle = json_data["handle"].s();
+            seal::Ciphertext sum = stored_aggregate(*he, *store, handle, "sum", packed);
+
+            response["encrypted_result"] = he->serialize(sum, wire);
+            if (average) response["count"] = store->count(handle);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    };
+
+    CROW_ROUTE(app, "/store/sum")
+    .methods("POST"_method)
+    ([&](const crow::request& req) { return store_sum(req, false); });
+
+    CROW_ROUTE(app, "/store/average")
+    .methods("POST"_method)
+    ([&](const crow::request& req) { return store_sum(req, true); });
+
+    // POST /store/aggregate
+    // Running aggregate of a stored column: materialized by the first read,
+    // updated by every append with one reduction of the appended ciphertexts
+    // and one addition, and returned as kept by later reads
+    //
+    // Request body (JSON):
+    // {
+    //   "handle": "3f2a...",
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "aggregate": "sum" | "sum_of_squares" | "count" | "histogram",
+    //   "packed": true,           // optional, see /csv/sum (sum and sum_of_squares)
+    //   "bucket_count": 8,        // histogram only, see /csv/histogram
+    //   "compression": "zlib",    // optional, see /add_encrypted
+    //   "compact_result": true    // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "aggregate_ciphertext",   // not for count
+    //   "count": 2,               // stored ciphertexts
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,
+    //   "wire_bytes": 369780
+    // }
+    CROW_ROUTE(app, "/store/aggregate")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("handle") || !json_data.has("scheme") || !json_data.has("aggregate")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+            std::string handle = json_data["handle"].s();
+            std::string aggregate = json_data["aggregate"].s();
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            if (aggregate != "count") {
+                int64_t bucket_count = json_data.has("bucket_count") ? json_data["bucket_count"].i() : 0;
+                if (aggregate == "histogram" && bucket_count <= 0) {
+                    response["error"] = "bucket_count must be positive";
+                    return crow::response(400, response);
+                }
+                seal::Ciphertext result = stored_aggregate(*he, *store, handle, aggregate, packed,
+                                                           static_cast<size_t>(bucket_count));
+                response["encrypted_result"] = he->serialize(result, wire);
+                report_wire_sizes(response, wire);
+            }
+            response["count"] = store->count(handle);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /store/<handle>/rebuild?scheme=bfv|ckks
+    // Recompute the column's materialized aggregates from its ciphertexts,
+    // e.g. after a correction
+    //
+    // Response (JSON):
+    // {
+    //   "rebuilt": 3,             // aggregates recomputed
+    //   "count": 2
+    // }
+    CROW_ROUTE(app, "/store/<string>/rebuild")
+    .methods("POST"_method)
+    ([&](const crow::request& req, const std::string& handle) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme_param ? scheme_param : "", he, store);
+
+            response["rebuilt"] = store->rebuild(handle);
+            response["count"] = store->count(handle);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /store/add
+    // Element-wise homomorphic addition of two stored columns of equal length;
+    // the result is stored as a new column
+    //
+    // Request body (JSON):
+    // {
+    //   "a": "handle_1",
+    //   "b": "handle_2",
+    //   "scheme": "bfv" | "ckks" | "bgv"
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "handle": "9c41...",
+    //   "count": 2
+    // }
+    CROW_ROUTE(app, "/store/add")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("a") || !json_data.has("b") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+
+            store->prefetch({json_data["a"].s(), json_data["b"].s()});
+            auto a = store->get(json_data["a"].s());
+            auto b = store->get(json_data["b"].s());
+            if (a->size() != b->size()) {
+                response["error"] = "Columns differ in length";
+                return crow::response(400, response);
+            }
+
+            CiphertextStore::Column result;
+            result.reserve(a->size());
+            for (size_t i = 0; i < a->size(); i++) {
+                result.push_back(he->add((*a)[i], (*b)[i]));
+            }
+
+            response["count"] = result.size();
+            return stored_response(response, store->put(std::move(result)));
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /store/dot
+    // Encrypted inner product sum_i a[i] * b[i] of two stored columns of equal
+    // length, stored as a one-element column. The products are added before
+    // they are relinearized (and for CKKS rescaled), see ExpressionEvaluator
+    //
+    // Request body (JSON):
+    // {
+    //   "a": "handle_1",
+    //   "b": "handle_2",
+    //   "scheme": "bfv" | "ckks" | "bgv"
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "handle": "7e02...",
+    //   "count": 1,
+    //   "multiplications": 16,
+    //   "key_switches": 1,        // relinearizations performed
+    //   "key_switches_saved": 15, // against relinearizing every product
+    //   "rescales": 1,            // CKKS and BGV only
+    //   "rescales_saved": 15
+    // }
+    CROW_ROUTE(app, "/store/dot")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("a") || !json_data.has("b") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+
+            store->prefetch({json_data["a"].s(), json_data["b"].s()});
+            auto a = store->get(json_data["a"].s());
+            auto b = store->get(json_data["b"].s());
+            if (a->size() != b->size() || a->empty()) {
+                response["error"] = "Columns must be non-empty and of equal length";
+                return crow::response(400, response);
+            }
+            if (!he->has_relin_keys()) {
+                response["error"] = "Relinearization keys not loaded";
+                return crow::response(400, response);
+            }
+
+            ExpressionEvaluator expression(*he);
+            CiphertextStore::Column result;
+            result.push_back(expression.finish(expression.dot(*a, *b)));
+
+            ExpressionStats stats = expression.stats();
+            std::string handle = store->put(std::move(result));
+            response["count"] = 1;
+            response["multiplications"] = stats.multiplications;
+            response["key_switches"] = stats.relinearizations;
+            response["key_switches_saved"] = stats.relinearizations_saved;
+            if (he->rescales()) {
+                response["rescales"] = stats.rescales;
+                response["rescales_saved"] = stats.rescales_saved;
+            }
+            return stored_response(response, handle);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /store/weighted_sum
+    // Homomorphic sum_i weights[i] * value_i over a stored column, e.g. billing
+    // amounts weighted per row by an age-bucket factor. Packed columns take one
+    // weight per value and end with a slot reduction, as /store/sum does; divide
+    // by sum(weights) after decryption for the weighted average. BFV and BGV
+    // weights must be integers
+    //
+    // Request body (JSON):
+    // {
+    //   "handle": "3f2a...",
+    //   "weights": [2, 0, 1, ...],  // one per value (packed) or per ciphertext
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "packed": true,             // optional, see /csv/sum
+    //   "compression": "zlib",      // optional, see /add_encrypted
+    //   "compact_result": true      // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "weighted_sum_ciphertext",
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,
+    //   "wire_bytes": 369780
+    // }
+    CROW_ROUTE(app, "/store/weighted_sum")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("handle") || !json_data.has("weights") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            auto column = store->get(json_data["handle"].s());
+            std::vector<double> weights;
+            weights.reserve(json_data["weights"].size());
+            for (const auto& weight : json_data["weights"]) {
+                weights.push_back(weight.d());
+            }
+            if (column->empty()) {
+                response["error"] = "Empty column";
+                return crow::response(400, response);
+            }
+
+            std::vector<seal::Plaintext> encoded = he->encode_weights(weights, packed, column->front().parms_id());
+            if (encoded.size() != column->size()) {
+                response["error"] = "Expected one weight per " + std::string(packed ? "value" : "ciphertext");
+                return crow::response(400, response);
+            }
+            seal::Ciphertext sum = he->weighted_sum(column->data(), encoded);
+            if (packed) he->sum_slots_inplace(sum);
+
+            response["encrypted_result"] = he->serialize(sum, wire);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // COLUMN FILE ENDPOINTS
+    // ========================================
+    // Encrypted columns written once to --column-dir as column files (see
+    // ColumnFile.h): each ciphertext is a block of its own, indexed by the rows
+    // it holds, so a sum over a row range maps the file and loads only the
+    // blocks of that range. Like the column store, these do not take X-Tenant-ID
+    auto column_path = [&](const crow::request& req, const std::string& name) {
+        if (!app.get_context<TenantMiddleware>(req).tenant.empty()) {
+            throw std::invalid_argument("Column files do not take X-Tenant-ID");
+        }
+        return column_file_path(column_dir, name);
+    };
+
+    // PUT /binary/columns/<name>?scheme=bfv|ckks[&packed=1][&rows=N][&compression=none]
+    // Write a column file, replacing any of that name. packed: every ciphertext
+    // holds slot_count() values, the last one rows' remainder (rows defaults to
+    // all slots). compression is of the blocks; none (the default) loads fastest
+    // Request body: framed [cipher1, cipher2, ...] (see BinaryFraming.h)
+    //
+    // Response (JSON):
+    // {
+    //   "name": "glucose-2024",
+    //   "count": 1000,            // ciphertexts (blocks)
+    //   "rows": 1000,
+    //   "bytes": 401412096        // file size
+    // }
+    //
+    // GET /columns/<name>
+    // Response (JSON):
+    // {
+    //   "scheme": "bfv", "compression": "none", "packed": false, "rows_per_ciphertext": 1,
+    //   "rows": 1000, "count": 1000, "bytes": 401412096
+    // }
+    //
+    // DELETE /columns/<name>
+    // Response (JSON):
+    // {
+    //   "status": "ok"
+    // }
+    CROW_ROUTE(app, "/binary/columns/<string>")
+    .methods("PUT"_method)
+    ([&](const crow::request& req, const std::string& name) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme_param ? scheme_param : "", he, store);
+            std::string path = column_path(req, name);
+            const char* rows_param = req.url_params.get("rows");
+            size_t rows = rows_param ? static_cast<size_t>(std::stoull(rows_param)) : 0;
+            size_t rows_per_ciphertext = req.url_params.get("packed") ? he->slot_count() : 1;
+            seal::compr_mode_type compression =
+                request_compression(req.url_params.get("compression"), seal::compr_mode_type::none);
+
+            std::vector<std::string_view> payloads = framing::unframe(req.body_view());
+            CiphertextStore::Column column;
+            column.reserve(payloads.size());
+            for (const auto& payload : payloads) {
+                column.push_back(he->deserialize(payload, WireFormat::binary));
+            }
+            ColumnFile::Layout layout =
+                ColumnFile::write(path, *he->seal_context(), column, compression, rows_per_ciphertext, rows);
+
+            response["name"] = name;
+            response["count"] = layout.blocks;
+            response["rows"] = layout.rows;
+            response["bytes"] = ColumnFile(path).file_size();
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    CROW_ROUTE(app, "/columns/<string>")
+    .methods("GET"_method, "DELETE"_method)
+    ([&](const crow::request& req, const std::string& name) {
+        crow::json::wvalue response;
+        try {
+            std::string path = column_path(req, name);
+            if (req.method == "DELETE"_method) {
+                if (std::remove(path.c_str()) != 0) {
+                    response["error"] = "Unknown column file: " + name;
+                    return crow::response(404, response);
+                }
+                response["status"] = "ok";
+                return crow::response(200, response);
+            }
+
+            ColumnFile file(path);
+            const ColumnFile::Layout& layout = file.layout();
+            response["scheme"] = layout.scheme == seal::scheme_type::ckks  ? "ckks"
+                                 : layout.scheme == seal::scheme_type::bgv ? "bgv"
+                                                                           : "bfv";
+            response["compression"] = compr_mode_name(layout.compression);
+            response["packed"] = layout.packed;
+            response["rows_per_ciphertext"] = layout.rows_per_ciphertext;
+            response["rows"] = layout.rows;
+            response["count"] = layout.blocks;
+            response["bytes"] = file.file_size();
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /columns/<name>/sum
+    // Sum of a column file, or of the blocks starting in a row range of it
+    //
+    // Request body (JSON):
+    // {
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "first_row": 0,           // optional, default 0
+    //   "end_row": 500,           // optional, exclusive, default all rows
+    //   "packed": true,           // optional, see /csv/sum
+    //   "compression": "zlib",    // optional, see /add_encrypted
+    //   "compact_result": true    // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "sum_ciphertext",
+    //   "count": 500,             // blocks summed
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,
+    //   "wire_bytes": 369780
+    // }
+    CROW_ROUTE(app, "/columns/<string>/sum")
+    .methods("POST"_method)
+    ([&](const crow::request& req, const std::string& name) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            ColumnFile file(column_path(req, name));
+            size_t begin_row = json_data.has("first_row") ? static_cast<size_t>(json_data["first_row"].u()) : 0;
+            size_t end_row = json_data.has("end_row") ? static_cast<size_t>(json_data["end_row"].u())
+                                                      : file.layout().rows;
+            auto range = file.block_range(begin_row, end_row);
+            auto ticket = admit(*he, range.second - range.first);
+            if (!ticket) return admission_refused(ticket);
+            size_t blocks = 0;
+            seal::Ciphertext sum = column_file_sum(*he, file, begin_row, end_row, column_chunk_bytes, &blocks);
+            if (packed) he->sum_slots_inplace(sum);
+
+            response["encrypted_result"] = he->serialize(sum, wire);
+            response["count"] = blocks;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // ROLLUP ENDPOINTS
+    // ========================================
+    // Pre-aggregated encrypted totals of a column by day, month or year and by
+    // a category (see RollupCube.h), e.g. Billing Amount by month of admission
+    // and Admission Type. mini-backend's /rollup/encrypt totals the rows per
+    // cell and encrypts the totals packed; the cubes are kept here and grow by
+    // slot-wise addition as batches of rows are appended. A dashboard query
+    // over a date range totals a few of these ciphertexts with one
+    // masked_sums, whatever the number of rows behind them. Rollups are held
+    // in this process's memory only (not in --store-shared-dir), under the
+    // default profile; like the column store they do not take X-Tenant-ID.
+    // Queries need Galois keys
+
+    // Cubes of a /rollup/encrypt response, deserialized and checked
+    struct RollupDelta {
+        RollupLayout layout;
+        std::vector<std::pair<size_t, seal::Ciphertext>> chunks;
+        std::vector<std::pair<size_t, uint64_t>> counts;
+    };
+    auto parse_rollup_cubes = [&](const HomomorphicEncryption& he, const crow::json::rvalue& json) {
+        if (!json.has("origin_year") || !json.has("cubes")) {
+            throw std::invalid_argument("Expected the origin_year and cubes of /rollup/encrypt");
+        }
+        std::vector<std::string> categories;
+        if (json.has("category_values")) {
+            for (const auto& category : json["category_values"]) categories.push_back(category.s());
+        }
+        std::vector<RollupDelta> deltas;
+        for (const auto& cube : json["cubes"]) {
+            if (!cube.has("granularity") || !cube.has("chunks") || !cube.has("ciphertexts") ||
+                !cube.has("cells") || !cube.has("counts") || cube["chunks"].size() != cube["ciphertexts"].size() ||
+                cube["cells"].size() != cube["counts"].size()) {
+                throw std::invalid_argument("Expected a granularity, chunks with their ciphertexts, and cells "
+                                            "with their counts in every cube");
+            }
+            deltas.push_back({RollupLayout(parse_rollup_granularity(cube["granularity"].s()),
+                                           static_cast<int>(json["origin_year"].i()), categories, he.slot_count()),
+                              {}, {}});
+            for (size_t i = 0; i < cube["chunks"].size(); i++) {
+                seal::Ciphertext totals = he.deserialize(json_view(cube["ciphertexts"][i]), WireFormat::base64);
+                deltas.back().chunks.emplace_back(cube["chunks"][i].u(), std::move(totals));
+            }
+            for (size_t i = 0; i < cube["cells"].size(); i++) {
+                deltas.back().counts.emplace_back(cube["cells"][i].u(), cube["counts"][i].u());
+            }
+        }
+        if (deltas.empty()) throw std::invalid_argument("No cubes");
+        return deltas;
+    };
+
+    // Add cubes into a rollup, with its mutex held; all are checked before any is added, so a
+    // rejected append leaves the rollup as it was
+    auto add_rollup_cubes = [&](Rollup& rollup, const HomomorphicEncryption& he, std::vector<RollupDelta>& deltas,
+                                bool create) {
+        for (const auto& delta : deltas) {
+            auto cube = rollup.cubes.find(delta.layout.granularity());
+            if (cube == rollup.cubes.end()) {
+                if (!create) {
+                    throw std::invalid_argument(std::string("The rollup has no ") +
+                                                rollup_granularity_name(delta.layout.granularity()) + " cube");
+                }
+            } else if (create) {
+                throw std::invalid_argument("Repeated granularity");
+            } else if (cube->second.layout().origin_year() != delta.layout.origin_year() ||
+                       cube->second.layout().categories() != delta.layout.categories()) {
+                throw std::invalid_argument("Appended cubes need the rollup's origin_year and category_values");
+            }
+        }
+        for (auto& delta : deltas) {
+            RollupCube& cube = rollup.cubes.emplace(delta.layout.granularity(), delta.layout).first->second;
+            for (auto& chunk : delta.chunks) cube.add(he, chunk.first, std::move(chunk.second));
+            for (const auto& count : delta.counts) cube.add_count(count.first, count.second);
+        }
+    };
+
+    auto rollup_summary = [](crow::json::wvalue& response, const Rollup& rollup) {
+        std::vector<crow::json::wvalue> cubes;
+        for (const auto& cube : rollup.cubes) {
+            crow::json::wvalue summary;
+            summary["granularity"] = rollup_granularity_name(cube.first);
+            summary["ciphertexts"] = cube.second.chunk_count();
+            summary["rows"] = cube.second.row_count();
+            cubes.push_back(std::move(summary));
+        }
+        response["cubes"] = std::move(cubes);
+    };
+
+    // PUT /rollups
+    // Request body (JSON): a /rollup/encrypt response and the scheme
+    // {
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "origin_year": 2019,
+    //   "category_values": ["Elective", "Emergency", "Urgent"],  // optional
+    //   "cubes": [{"granularity": "month", "chunks": [0], "ciphertexts": ["..."],
+    //              "cells": [0, 1, ...], "counts": [310, 295, ...]}, ...]
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "handle": "3f2a...",
+    //   "cubes": [{"granularity": "month", "ciphertexts": 1, "rows": 55500}, ...]
+    // }
+    CROW_ROUTE(app, "/rollups")
+    .methods("PUT"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, json_data["scheme"].s(), he, store);
+            std::vector<RollupDelta> deltas = parse_rollup_cubes(*he, json_data);
+            auto rollup = std::make_shared<Rollup>();
+            rollup->scheme = json_data["scheme"].s();
+            add_rollup_cubes(*rollup, *he, deltas, true);
+
+            std::string handle;
+            {
+                std::lock_guard<std::mutex> lock(rollups_mutex);
+                do {
+                    handle = random_handle();
+                } while (rollups.count(handle));
+                rollups.emplace(handle, rollup);
+            }
+            HE_LOG(Info) << "Rollup created | Scheme: " << rollup->scheme << " | Cubes: " << rollup->cubes.size();
+
+            response["handle"] = handle;
+            rollup_summary(response, *rollup);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /rollups/<handle>/append
+    // Incremental maintenance: add a /rollup/encrypt response for new rows (same
+    // origin_year and category_values, granularities the rollup has) into its cubes
+    //
+    // Request body (JSON): as for PUT /rollups
+    // Response (JSON): the rollup's "cubes", as for PUT /rollups
+    //
+    // DELETE /rollups/<handle>
+    // Response (JSON):
+    // {
+    //   "status": "ok"
+    // }
+    CROW_ROUTE(app, "/rollups/<string>/append")
+    .methods("POST"_method)
+    ([&](const crow::request& req, const std::string& handle) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+        if (!json_data) {
+            response["error"] = "Invalid JSON";
+            return crow::response(400, response);
+        }
+
+        try {
+            auto rollup = find_rollup(handle);
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, rollup->scheme, he, store);
+            std::vector<RollupDelta> deltas = parse_rollup_cubes(*he, json_data);
+
+            std::lock_guard<std::mutex> lock(rollup->mutex);
+            add_rollup_cubes(*rollup, *he, deltas, false);
+            rollup_summary(response, *rollup);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    CROW_ROUTE(app, "/rollups/<string>")
+    .methods("DELETE"_method)
+    ([&](const crow::request&, const std::string& handle) {
+        crow::json::wvalue response;
+        std::lock_guard<std::mutex> lock(rollups_mutex);
+        if (!rollups.erase(handle)) {
+            response["error"] = "Unknown rollup handle: " + handle;
+            return crow::response(404, response);
+        }
+        response["status"] = "ok";
+        return crow::response(200, response);
+    });
+
+    // POST /rollups/<handle>/query
+    // Totals of the cells of a date range, optionally of some categories only and
+    // grouped by period or category, from the pre-aggregated cube of one
+    // granularity: one masked_sums over the few ciphertexts holding the range's
+    // cells. Row counts are public and returned in plaintext, for averages
+    //
+    // Request body (JSON):
+    // {
+    //   "granularity": "month",       // day, month or year
+    //   "from": "2023-01",            // first and last period, inclusive (dates as in
+    //   "to": "2023-12",              // /rollup/encrypt; a day of a month counts as its month)
+    //   "categories": ["Emergency"],  // optional, default all
+    //   "group_by": "period",         // optional: "period" or "category", default one total
+    //   "compression": "zlib",        // optional, see /add_encrypted
+    //   "compact_result": true        // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "packed_ciphertext",  // slot g = total of group g
+    //   "groups": ["2023-01", "2023-02", ...],    // period labels, categories, or [""]
+    //   "row_counts": [4610, 4398, ...],
+    //   "ciphertexts": 1,             // cube ciphertexts the query read
+    //   "execution_us": 1234,
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    CROW_ROUTE(app, "/rollups/<string>/query")
+    .methods("POST"_method)
+    ([&](const crow::request& req, const std::string& handle) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("granularity") || !json_data.has("from") || !json_data.has("to")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            auto rollup = find_rollup(handle);
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, rollup->scheme, he, store);
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+            RollupCube::GroupBy group_by = RollupCube::GroupBy::none;
+            if (json_data.has("group_by")) {
+                const std::string name = json_data["group_by"].s();
+                if (name == "period") {
+                    group_by = RollupCube::GroupBy::period;
+                } else if (name == "category") {
+                    group_by = RollupCube::GroupBy::category;
+                } else {
+                    throw std::invalid_argument("Unknown group_by: " + name + " (period, category)");
+                }
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            RollupCube::Plan plan;
+            {
+                std::lock_guard<std::mutex> lock(rollup->mutex);
+                const RollupGranularity granularity = parse_rollup_granularity(json_data["granularity"].s());
+                auto cube = rollup->cubes.find(granularity);
+                if (cube == rollup->cubes.end()) {
+                    throw std::invalid_argument(std::string("The rollup has no ") +
+                                                rollup_granularity_name(granularity) + " cube");
+                }
+                const RollupLayout& layout = cube->second.layout();
+                std::vector<size_t> categories;
+                if (json_data.has("categories")) {
+                    for (const auto& category : json_data["categories"]) {
+                        categories.push_back(layout.category(category.s()));
+                    }
+                }
+                plan = cube->second.plan(layout.period(json_data["from"].s()), layout.period(json_data["to"].s()),
+                                         categories, group_by);
+            }
+            seal::Ciphertext result = he->masked_sums(plan.chunks.data(), plan.chunks.size(), plan.masks);
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            HE_LOG(Info) << "Rollup query | Scheme: " << rollup->scheme << " | Ciphertexts: " << plan.chunks.size()
+                         << " | Groups: " << plan.groups.size() << " | " << duration_us << " microseconds";
+
+            response["encrypted_result"] = he->serialize(result, wire);
+            response["groups"] = plan.groups;
+            response["row_counts"] = plan.row_counts;
+            response["ciphertexts"] = plan.chunks.size();
+            response["execution_us"] = duration_us;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // VITALS ENDPOINTS
+    // ========================================
+    // Continuous ingestion of bedside readings (heart rate, blood pressure, ...)
+    // over one websocket per device or gateway, instead of an HTTP request per
+    // reading. Each reading is a ciphertext added into its patient's current
+    // time window, so the window's sum, sum of squares and count are kept up to
+    // date at one add per message (see VitalsAggregates.h for the slot layout).
+    // Readings use the default profile of their scheme and, like rollups, do not
+    // take X-Tenant-ID
+
+    struct VitalsConnection {
+        HomomorphicEncryption* he = nullptr;
+        std::shared_ptr<WebSocketChannel> channel;
+        std::atomic<size_t> pending{0};
+        std::atomic<uint64_t> accepted{0};
+        std::atomic<uint64_t> refused{0};
+    };
+    auto vitals_he = [&](const char* scheme) -> HomomorphicEncryption* {
+        const std::string name = scheme ? scheme : "ckks";
+        if (name == "bfv") return &he_bfv;
+        if (name == "ckks") return &he_ckks;
+        if (name == "bgv") return &he_bgv;
+        return nullptr;
+    };
+    auto& vitals_accepted = metrics::counter("he_vitals_readings_total", "Vitals readings received by result",
+                                             {{"result", "accepted"}});
+    auto& vitals_refused = metrics::counter("he_vitals_readings_total", "Vitals readings received by result",
+                                            {{"result", "refused"}});
+
+    // WS /ws/vitals?scheme=bfv|ckks|bgv (default ckks)
+    // One binary message per reading (see framing::Reading in BinaryFraming.h):
+    // patient ID, timestamp in milliseconds, and the ciphertext, seeded or not.
+    // Readings are deserialized and added on the compute threads; nothing is sent
+    // back for one that is added. A refused reading (too old, not matching its
+    // window, too many in flight, ...) is answered so the device can resend it:
+    // { "error": "...", "patient": "bed-12", "timestamp_ms": 1718000000000 }
+    //
+    // A text message { "ack": true } is answered with the connection's counts:
+    // { "accepted": 1200, "refused": 0, "pending": 3 }
+    CROW_WEBSOCKET_ROUTE(app, "/ws/vitals")
+    .max_payload(vitals_max_frame_bytes)
+    .onaccept([&](const crow::request& req, void** userdata) {
+        HomomorphicEncryption* he = vitals_he(req.url_params.get("scheme"));
+        if (!he) return false;
+        auto connection = std::make_shared<VitalsConnection>();
+        connection->he = he;
+        *userdata = new std::shared_ptr<VitalsConnection>(std::move(connection));
+        return true;
+    })
+    .onopen([&](crow::websocket::connection& conn) {
+        auto& connection = *static_cast<std::shared_ptr<VitalsConnection>*>(conn.userdata());
+        connection->channel = std::make_shared<WebSocketChannel>(conn);
+    })
+    .onclose([&](crow::websocket::connection& conn, const std::string& reason, uint16_t) {
+        auto* connection = static_cast<std::shared_ptr<VitalsConnection>*>(conn.userdata());
+        if (!connection) return;
+        if ((*connection)->channel) (*connection)->channel->mark_closed();  // Pending readings still get added
+        delete connection;
+        conn.userdata(nullptr);
+    })
+    .onmessage([&](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
+        std::shared_ptr<VitalsConnection> connection = *static_cast<std::shared_ptr<VitalsConnection>*>(conn.userdata());
+        auto refuse = [&vitals_refused](VitalsConnection& connection, const std::string& error,
+                                        std::string_view patient, uint64_t timestamp_ms) {
+            connection.refused++;
+            vitals_refused.add();
+            crow::json::wvalue response;
+            response["error"] = error;
+            response["patient"] = std::string(patient);
+            response["timestamp_ms"] = timestamp_ms;
+            connection.channel->send_text(response.dump());  // No-op if the device is gone
+        };
+
+        if (!is_binary) {
+            auto json_data = crow::json::load(data);
+            crow::json::wvalue response;
+            if (json_data && json_data.has("ack") && json_data["ack"].b()) {
+                response["accepted"] = connection->accepted.load();
+                response["refused"] = connection->refused.load();
+                response["pending"] = connection->pending.load();
+            } else {
+                response["error"] = "Expected { \"ack\": true } or binary readings";
+            }
+            connection->channel->send_text(response.dump());
+            return;
+        }
+
+        framing::Reading reading;
+        try {
+            reading = framing::unframe_reading(data);
+        } catch (const std::invalid_argument& e) {
+            refuse(*connection, e.what(), "", 0);
+            return;
+        }
+        if (connection->pending.fetch_add(1) >= vitals_max_pending) {
+            connection->pending--;
+            refuse(*connection, "Too many readings in flight", reading.patient, reading.timestamp_ms);
+            return;
+        }
+
+        // Off the I/O thread: expanding a seeded ciphertext costs more than the add
+        compute_pool->post([&, connection, refuse, patient = std::string(reading.patient),
+                            timestamp_ms = reading.timestamp_ms, bytes = std::string(reading.ciphertext)] {
+            try {
+                seal::Ciphertext ciphertext = connection->he->deserialize(bytes, WireFormat::binary);
+                vitals.add(*connection->he, patient, timestamp_ms, std::move(ciphertext));
+                connection->accepted++;
+                vitals_accepted.add();
+            } catch (const std::exception& e) {
+                refuse(*connection, e.what(), patient, timestamp_ms);
+            }
+            connection->pending--;
+        });
+    });
+
+    // GET /vitals/<patient>?scheme=bfv|ckks|bgv[&from_ms=...][&to_ms=...][&compression=...]
+    // The patient's windows that start in [from_ms, to_ms] (default all), oldest first
+    //
+    // Response (JSON):
+    // {
+    //   "window_ms": 60000,
+    //   "windows": [{"start_ms": 1718000040000, "count": 58, "sum": "base64..."}, ...],
+    //   "compression": "zlib",
+    //   "raw_bytes": ...,
+    //   "wire_bytes": ...
+    // }
+    //
+    // DELETE /vitals/<patient>
+    // Drops the patient's windows
+    // Response (JSON):
+    // {
+    //   "status": "ok"
+    // }
+    CROW_ROUTE(app, "/vitals/<string>")
+    .methods("GET"_method, "DELETE"_method)
+    ([&](const crow::request& req, const std::string& patient) {
+        crow::json::wvalue response;
+        if (req.method == "DELETE"_method) {
+            if (!vitals.erase(patient)) {
+                response["error"] = "Unknown patient: " + patient;
+                return crow::response(404, response);
+            }
+            response["status"] = "ok";
+            return crow::response(200, response);
+        }
+
+        try {
+            HomomorphicEncryption* he = vitals_he(req.url_params.get("scheme"));
+            if (!he) throw std::invalid_argument("Invalid scheme");
+            const char* from_ms = req.url_params.get("from_ms");
+            const char* to_ms = req.url_params.get("to_ms");
+            std::vector<VitalsAggregates::Window> windows =
+                vitals.windows(patient, from_ms ? std::stoull(from_ms) : 0, to_ms ? std::stoull(to_ms) : UINT64_MAX);
+
+            WireStats stats;
+            WireOptions wire(WireFormat::base64,
+                             request_compression(req.url_params.get("compression"), default_compression), &stats);
+            std::vector<crow::json::wvalue> entries;
+            entries.reserve(windows.size());
+            for (const auto& window : windows) {
+                crow::json::wvalue entry;
+                entry["start_ms"] = window.start_ms;
+                entry["count"] = window.count;
+                entry["sum"] = he->serialize(window.sum, wire);
+                entries.push_back(std::move(entry));
+            }
+            response["window_ms"] = vitals.window_ms();
+            response["windows"] = std::move(entries);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // PRIVATE SET INTERSECTION ENDPOINTS
+    // ========================================
+    // Unbalanced private set intersection over BFV batching (see
+    // PrivateSetIntersection.h), e.g. record linkage across hospitals: one
+    // hospital's registry (millions of IDs) is kept here as a set of
+    // partition polynomials, and another hospital (the key holder, through
+    // mini-backend's /psi/query and /psi/decrypt) learns which of its IDs
+    // the registry holds; this server only ever sees its ciphertexts. A query
+    // costs the missing powers (power_depth levels of products) and one
+    // weighted sum per partition for each bundle, whatever the query's size
+    // up to a table's bins. The sets are built without keys, so receivers of
+    // any tenant (X-Tenant-ID) can query them under the set's profile, and
+    // they live in this process's memory only, like rollups. Queries need
+    // relinearization keys
+
+    // PUT /psi/sets
+    // Request body (JSON):
+    // {
+    //   "ids": ["MRN-000001", "MRN-000002", ...],
+    //   "bundles": 4,          // optional: ciphertexts per query table, bundles * slots / 2 bins
+    //   "partition_size": 32,  // optional: items per polynomial (its degree)
+    //   "window_bits": 2       // optional: the query sends powers k * 2^(w i), k < 2^w
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "handle": "3f2a...",
+    //   "parameters": {"bundles": 4, "partition_size": 32, "window_bits": 2},  // for /psi/query
+    //   "profile": "auto-bfv-d3-p20-s128",
+    //   "items": 1000000,      // distinct IDs
+    //   "partitions": 8,       // polynomials per bin: the largest bin's items / partition_size
+    //   "memory_bytes": 34603008,
+    //   "execution_us": 1234
+    // }
+    //
+    // DELETE /psi/sets/<handle>
+    // Response (JSON):
+    // {
+    //   "status": "ok"
+    // }
+    CROW_ROUTE(app, "/psi/sets")
+    .methods("PUT"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("ids")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            const PsiParameters parameters = parse_psi_parameters(json_data);
+            std::vector<std::string> ids;
+            ids.reserve(json_data["ids"].size());
+            for (const auto& id : json_data["ids"]) ids.push_back(id.s());
+            HomomorphicEncryption& he = select_he(req, "bfv", &parameters.profile());
+
+            auto start = std::chrono::high_resolution_clock::now();
+            auto set = std::make_shared<const PsiServerSet>(parameters, he.slot_count(), he.plain_modulus(), ids);
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count();
+
+            std::string handle;
+            {
+                std::lock_guard<std::mutex> lock(psi_sets_mutex);
+                do {
+                    handle = random_handle();
+                } while (psi_sets.count(handle));
+                psi_sets.emplace(handle, set);
+            }
+            HE_LOG(Info) << "PSI set created | Items: " << set->item_count()
+                         << " | Partitions: " << set->partition_count()
+                         << " | " << duration_us << " microseconds";
+
+            response["handle"] = handle;
+            response["parameters"]["bundles"] = parameters.bundles;
+            response["parameters"]["partition_size"] = parameters.partition_size;
+            response["parameters"]["window_bits"] = parameters.window_bits;
+            response["profile"] = he.parameter_profile().name;
+            response["items"] = set->item_count();
+            response["partitions"] = set->partition_count();
+            response["memory_bytes"] = set->memory_bytes();
+            response["execution_us"] = duration_us;
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    CROW_ROUTE(app, "/psi/sets/<string>")
+    .methods("DELETE"_method)
+    ([&](const crow::request&, const std::string& handle) {
+        crow::json::wvalue response;
+        std::lock_guard<std::mutex> lock(psi_sets_mutex);
+        if (!psi_sets.erase(handle)) {
+            response["error"] = "Unknown PSI set handle: " + handle;
+            return crow::response(404, response);
+        }
+        response["status"] = "ok";
+        return crow::response(200, response);
+    });
+
+    // POST /psi/sets/<handle>/query
+    // Request body (JSON):
+    // {
+    //   "batches": [["...", ...], ...],  // /psi/query's "batches"
+    //   "compression": "zlib"            // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON): results at the lowest level, for /psi/decrypt
+    // {
+    //   "batches": [["...", ...], ...],  // per batch, bundles times partitions ciphertexts
+    //   "execution_us": 1234,
+    //   "compression": "zlib",
+    //   "raw_bytes": 262220,
+    //   "wire_bytes": 246810
+    // }
+    CROW_ROUTE(app, "/psi/sets/<string>/query")
+    .methods("POST"_method)
+    ([&](const crow::request& req, const std::string& handle) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("batches")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::shared_ptr<const PsiServerSet> set;
+            {
+                std::lock_guard<std::mutex> lock(psi_sets_mutex);
+                auto found = psi_sets.find(handle);
+                if (found == psi_sets.end()) throw std::out_of_range("Unknown PSI set handle: " + handle);
+                set = found->second;
+            }
+            HomomorphicEncryption& he = select_he(req, "bfv", &set->parameters().profile());
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            wire.compact = true;
+
+            const size_t batches = json_data["batches"].size();
+            CiphertextViews views;
+            for (const auto& batch : json_data["batches"]) {
+                CiphertextViews batch_views = json_views(batch);
+                views.insert(views.end(), batch_views.begin(), batch_views.end());
+            }
+            auto ticket = admit(he, views.size() * set->parameters().partition_size);
+            if (!ticket) return admission_refused(ticket);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            EncryptedVector query = EncryptedVector::from_wire(he, views);
+            if (batches == 0 || query.size() % batches) throw std::invalid_argument("Batches differ in size");
+            std::vector<seal::Ciphertext> results = he.set_intersection(query.data(), query.size(), *set);
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            HE_LOG(Info) << "PSI query | Ciphertexts: " << query.size() << " | Results: " << results.size()
+                         << " | " << duration_us << " microseconds";
+
+            std::vector<crow::json::wvalue> batch_results;
+            const size_t per_batch = results.size() / batches;
+            for (size_t batch = 0; batch < batches; batch++) {
+                std::vector<std::string> ciphertexts;
+                for (size_t i = batch * per_batch; i < (batch + 1) * per_batch; i++) {
+                    ciphertexts.push_back(he.serialize(results[i], wire));
+                }
+                batch_results.emplace_back();
+                batch_results.back() = std::move(ciphertexts);
+            }
+            response["batches"] = std::move(batch_results);
+            response["execution_us"] = duration_us;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // CLUSTER ENDPOINTS
+    // ========================================
+    // A coordinating main-backend (--workers, or workers started with --coordinator)
+    // shards columns across worker main-backends: each worker stores and sums its
+    // shard locally, in parallel with the others, and sends back one partial
+    // ciphertext, which the coordinator adds up (as a parallel tree, like /csv/sum).
+    // Workers need the coordinator's parameters and evaluation keys, e.g. the same
+    // --key-dir or POST /cluster/galois_keys. Workers with an RPC listener
+    // (--rpc-port) are called over it, the others over HTTP. Responses report every
+    // shard's worker, size, time and attempts.
+    // Like the column store, these endpoints do not take X-Tenant-ID
+
+    // POST /cluster/workers
+    // Heartbeat of a worker (sent by ClusterMember)
+    //
+    // Request body (JSON):
+    // {
+    //   "address": "10.0.0.7:18080",
+    //   "rpc": "10.0.0.7:19090"   // optional, the worker's --rpc-port listener
+    // }
+    //
+    // GET /cluster/workers
+    // Response (JSON):
+    // {
+    //   "workers": [{ "address": "10.0.0.7:18080", "rpc": "10.0.0.7:19090", "registered": true,
+    //                 "heartbeat_age_s": 1.2, "down": false }, ...]
+    // }
+    CROW_ROUTE(app, "/cluster/workers")
+    .methods("GET"_method, "POST"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        if (req.method == "POST"_method) {
+            auto json_data = parse_json(req.body_view());
+            if (!json_data || !json_data.has("address")) {
+                response["error"] = "Missing required fields";
+                return crow::response(400, response);
+            }
+            std::string rpc = json_data.has("rpc") ? std::string(json_data["rpc"].s()) : "";
+            cluster.register_worker(json_data["address"].s(), rpc);
+            response["status"] = "ok";
+            return crow::response(200, response);
+        }
+
+        std::vector<crow::json::wvalue> workers;
+        for (const Cluster::WorkerInfo& info : cluster.workers()) {
+            crow::json::wvalue entry;
+            entry["address"] = info.address;
+            if (!info.rpc.empty()) entry["rpc"] = info.rpc;
+            entry["registered"] = info.registered;
+            if (info.registered) entry["heartbeat_age_s"] = info.heartbeat_age_s;
+            entry["down"] = info.down;
+            workers.push_back(std::move(entry));
+        }
+        response["workers"] = std::move(workers);
+        return crow::response(200, response);
+    });
+
+    // PUT /binary/cluster/store?scheme=bfv|ckks
+    // Split a column into one contiguous shard per live worker and store each
+    // shard in its worker's column store. If any shard fails, the stored ones are
+    // deleted again
+    // Request body: framed [cipher1, cipher2, ...] (see BinaryFraming.h)
+    //
+    // Response (JSON):
+    // {
+    //   "handle": "7d0e...",      // coordinator handle of the sharded column
+    //   "count": 1000,
+    //   "shards": [{ "worker": "10.0.0.7:18080", "count": 500, "elapsed_ms": 41.5, "attempts": 1 }, ...]
+    // }
+    CROW_ROUTE(app, "/binary/cluster/store")
+    .methods("PUT"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme, he, store);
+
+            std::vector<std::string_view> payloads = framing::unframe(req.body_view());
+            if (payloads.empty()) throw std::invalid_argument("Cannot store an empty column");
+            std::vector<std::string> workers = cluster.live_workers();
+            if (workers.empty()) {
+                response["error"] = "No live cluster workers";
+                return crow::response(503, response);
+            }
+
+            std::vector<Cluster::Call> calls;
+            std::vector<size_t> counts;
+            for (const auto& range : shard_ranges(payloads.size(), workers.size())) {
+                Cluster::Call call;
+                call.workers = { workers[calls.size()] };
+                call.method = "PUT";
+                call.target = "/binary/store?scheme=" + scheme;
+                call.body = framing::frame(std::vector<std::string>(payloads.begin() + range.first,
+                                                                    payloads.begin() + range.second));
+                call.content_type = "application/octet-stream";
+                call.rpc = { { node_rpc::Op::store, scheme } };
+                call.rpc_body = true;
+                calls.push_back(std::move(call));
+                counts.push_back(range.second - range.first);
+            }
+            std::vector<Cluster::Outcome> outcomes = cluster.scatter(calls);
+
+            std::vector<Cluster::Shard> shards;
+            std::string failure;
+            for (size_t i = 0; i < outcomes.size(); i++) {
+                std::string error = shard_failure(outcomes[i]);
+                std::string handle = shard_handle(outcomes[i]);
+                if (!handle.empty()) {
+                    shards.push_back({ outcomes[i].worker, handle, counts[i] });
+                } else if (failure.empty()) {
+                    failure = error.empty() ? outcomes[i].worker + ": malformed response" : error;
+                }
+            }
+            response["shards"] = shard_timings(outcomes, counts);
+            if (!failure.empty()) {
+                std::vector<Cluster::Call> cleanup;
+                for (const auto& shard : shards) cleanup.push_back(delete_shard(shard, scheme));
+                cluster.scatter(cleanup);
+                response["error"] = "Storing a shard failed: " + failure;
+                return crow::response(502, response);
+            }
+
+            response["handle"] = cluster.add_column(std::move(shards));
+            response["count"] = payloads.size();
+            return crow::response(200, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /cluster/sum
+    // Sum of a sharded column: every worker sums its shard, the coordinator adds
+    // the partials and, for packed columns, folds the slots of the total once
+    //
+    // Request body (JSON):
+    // {
+    //   "handle": "7d0e...",
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "packed": true,           // optional, see /csv/sum
+    //   "compression": "zlib",    // optional, see /add_encrypted
+    //   "compact_result": true    // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_result": "sum_ciphertext",
+    //   "count": 1000,
+    //   "shards": [...],          // as for PUT /binary/cluster/store
+    //   "combine_ms": 3.1,
+    //   "compression": "zlib",
+    //   "raw_bytes": 393329,
+    //   "wire_bytes": 369780
+    // }
+    CROW_ROUTE(app, "/cluster/sum")
+    .methods("POST"_method)
+    ([&](const crow::request& req, crow::response& res) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("handle") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            res = crow::response(400, response);
+            return res.end();
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme, he, store);
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            seal::compr_mode_type compression = request_compression(json_data, default_compression);
+            bool compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            std::vector<Cluster::Shard> shards = cluster.column(json_data["handle"].s());
+            std::vector<Cluster::Call> calls;
+            std::vector<size_t> counts;
+            for (const auto& shard : shards) {
+                crow::json::wvalue body;
+                body["handle"] = shard.handle;
+                body["scheme"] = scheme;
+                Cluster::Call call{ { shard.worker }, "POST", "/store/sum", body.dump() };
+                call.rpc = { { node_rpc::Op::store_sum, scheme, "", shard.handle } };
+                calls.push_back(std::move(call));
+                counts.push_back(shard.count);
+            }
+
+            // Combined on compute_pool once the last shard answers
+            PendingResponse pending = defer(req, res);
+            cluster.scatter_async(std::move(calls), *compute_pool, [&, pending, he, packed, compression, compact,
+                                                     counts](std::vector<Cluster::Outcome> outcomes) {
+                pending.finish([&] {
+                    crow::json::wvalue response;
+                    WireStats stats;
+                    WireOptions wire(WireFormat::base64, compression, &stats);
+                    wire.compact = compact;
+                    response["shards"] = shard_timings(outcomes, counts);
+
+                    auto start = std::chrono::steady_clock::now();
+                    std::vector<seal::Ciphertext> partials;
+                    for (const auto& outcome : outcomes) {
+                        std::string failure = shard_failure(outcome);
+                        if (failure.empty() && outcome.rpc) {
+                            partials.push_back(
+                                he->deserialize(outcome.response.body, WireFormat::binary, worker_check));
+                            continue;
+                        }
+                        auto result =
+                            failure.empty() ? crow::json::load(outcome.response.body) : crow::json::rvalue();
+                        if (!result || !result.has("encrypted_result")) {
+                            response["error"] = "Summing a shard failed: " +
+                                                (failure.empty() ? outcome.worker + ": malformed response" : failure);
+                            return crow::response(502, response);
+                        }
+                        partials.push_back(
+                            he->deserialize(json_view(result["encrypted_result"]), WireFormat::base64, worker_check));
+                    }
+                    seal::Ciphertext total = he->sum(partials);
+                    if (packed) he->sum_slots_inplace(total);
+                    response["encrypted_result"] = he->serialize(total, wire);
+                    response["combine_ms"] =
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                    size_t count = 0;
+                    for (size_t shard_count : counts) count += shard_count;
+                    response["count"] = count;
+                    report_wire_sizes(response, wire);
+                    return crow::response(200, response);
+                });
+            });
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            res = crow::response(404, response);
+            res.end();
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            res = crow::response(500, response);
+            res.end();
+        }
+    });
+
+    // POST /binary/cluster/csv/sum?scheme=bfv|ckks[&packed=1][&compression=...][&compact_result=1]
+    // /binary/csv/sum spread over the live workers without storing anything: the
+    // body is split into one shard per worker, and a shard whose worker fails is
+    // retried on the next one
+    // Request body: framed [cipher1, cipher2, ...]
+    // Response body: raw sum ciphertext; X-HE-Shards holds the per-shard report
+    // (as for PUT /binary/cluster/store) as JSON
+    CROW_ROUTE(app, "/binary/cluster/csv/sum")
+    .methods("POST"_method)
+    ([&](const crow::request& req, crow::response& res) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme, he, store);
+            bool packed = req.url_params.get("packed") != nullptr;
+            seal::compr_mode_type compression =
+                request_compression(req.url_params.get("compression"), default_compression);
+            bool compact = req.url_params.get("compact_result") != nullptr;
+
+            std::vector<std::string_view> payloads = framing::unframe(req.body_view());
+            if (payloads.empty()) throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+            std::vector<std::string> workers = cluster.live_workers();
+            if (workers.empty()) {
+                response["error"] = "No live cluster workers";
+                res = crow::response(503, response);
+                return res.end();
+            }
+
+            std::vector<Cluster::Call> calls;
+            std::vector<size_t> counts;
+            for (const auto& range : shard_ranges(payloads.size(), workers.size())) {
+                Cluster::Call call;
+                // Own worker first, then the others in turn
+                for (size_t i = 0; i < workers.size(); i++) {
+                    call.workers.push_back(workers[(calls.size() + i) % workers.size()]);
+                }
+                call.method = "POST";
+                call.target = "/binary/csv/sum?scheme=" + scheme;
+                call.body = framing::frame(std::vector<std::string>(payloads.begin() + range.first,
+                                                                    payloads.begin() + range.second));
+                call.content_type = "application/octet-stream";
+                call.rpc = { { node_rpc::Op::csv_sum, scheme } };
+                call.rpc_body = true;
+                calls.push_back(std::move(call));
+                counts.push_back(range.second - range.first);
+            }
+
+            // Combined on compute_pool once the last shard answers
+            PendingResponse pending = defer(req, res);
+            cluster.scatter_async(std::move(calls), *compute_pool, [&, pending, he, packed, compression, compact,
+                                                     counts](std::vector<Cluster::Outcome> outcomes) {
+                pending.finish([&] {
+                    crow::json::wvalue timings;
+                    timings = shard_timings(outcomes, counts);
+
+                    std::vector<seal::Ciphertext> partials;
+                    for (const auto& outcome : outcomes) {
+                        std::string failure = shard_failure(outcome);
+                        if (!failure.empty()) {
+                            crow::json::wvalue response;
+                            response["error"] = "Summing a shard failed: " + failure;
+                            crow::response res(502, response);
+                            res.set_header("X-HE-Shards", timings.dump());
+                            return res;
+                        }
+                        partials.push_back(he->deserialize(outcome.response.body, WireFormat::binary, worker_check));
+                    }
+                    seal::Ciphertext total = he->sum(partials);
+                    if (packed) he->sum_slots_inplace(total);
+
+                    WireStats stats;
+                    WireOptions wire(WireFormat::binary, compression, &stats);
+                    wire.compact = compact;
+                    crow::response res = binary_response(he->serialize(total, wire));
+                    report_wire_sizes(res, wire);
+                    res.set_header("X-HE-Shards", timings.dump());
+                    return res;
+                });
+            });
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            res = crow::response(500, response);
+            res.end();
+        }
+    });
+
+    // POST /cluster/columns/<name>/sum
+    // /columns/<name>/sum spread over the live workers: the coordinator reads the
+    // column file's index, gives every worker a contiguous range of its blocks,
+    // and each worker sums its range from its own mount of --column-dir (the
+    // workers' files must be the coordinator's, e.g. on shared storage). A range
+    // whose worker fails is retried on the next one
+    //
+    // Request body (JSON): as for /columns/<name>/sum, without first_row/end_row
+    //
+    // Response (JSON): as for POST /cluster/sum; "count" is blocks
+    CROW_ROUTE(app, "/cluster/columns/<string>/sum")
+    .methods("POST"_method)
+    ([&](const crow::request& req, crow::response& res, const std::string& name) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            res = crow::response(400, response);
+            return res.end();
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme, he, store);
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            seal::compr_mode_type compression = request_compression(json_data, default_compression);
+            bool compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            ColumnFile file(column_path(req, name));
+            if (!file.matches(*he->seal_context())) {
+                throw std::invalid_argument("The column file was written with other encryption parameters");
+            }
+            std::vector<std::string> workers = cluster.live_workers();
+            if (workers.empty()) {
+                response["error"] = "No live cluster workers";
+                res = crow::response(503, response);
+                return res.end();
+            }
+
+            const auto& blocks = file.blocks();
+            std::vector<Cluster::Call> calls;
+            // RPC payloads, referenced by the calls until they are combined
+            auto ranges = std::make_shared<std::vector<std::string>>();
+            std::vector<size_t> counts;
+            auto block_ranges = shard_ranges(blocks.size(), workers.size());
+            ranges->reserve(block_ranges.size());
+            for (const auto& range : block_ranges) {
+                uint64_t begin_row = blocks[range.first].first_row;
+                uint64_t end_row = blocks[range.second - 1].first_row + blocks[range.second - 1].rows;
+                crow::json::wvalue body;
+                body["scheme"] = scheme;
+                body["first_row"] = begin_row;
+                body["end_row"] = end_row;
+                Cluster::Call call{ {}, "POST", "/columns/" + name + "/sum", body.dump() };
+                // Own worker first, then the others in turn
+                for (size_t i = 0; i < workers.size(); i++) {
+                    call.workers.push_back(workers[(calls.size() + i) % workers.size()]);
+                }
+                ranges->emplace_back();
+                framing::put_uint(ranges->back(), begin_row, 8);
+                framing::put_uint(ranges->back(), end_row, 8);
+                call.rpc = { { node_rpc::Op::column_sum, scheme, "", name, ranges->back() } };
+                calls.push_back(std::move(call));
+                counts.push_back(range.second - range.first);
+            }
+
+            // Combined on compute_pool once the last range answers
+            PendingResponse pending = defer(req, res);
+            size_t block_count = blocks.size();
+            cluster.scatter_async(std::move(calls), *compute_pool, [&, pending, he, packed, compression, compact, counts, ranges,
+                                                     block_count](std::vector<Cluster::Outcome> outcomes) {
+                pending.finish([&] {
+                    crow::json::wvalue response;
+                    WireStats stats;
+                    WireOptions wire(WireFormat::base64, compression, &stats);
+                    wire.compact = compact;
+                    response["shards"] = shard_timings(outcomes, counts);
+
+                    auto start = std::chrono::steady_clock::now();
+                    std::vector<seal::Ciphertext> partials;
+                    for (const auto& outcome : outcomes) {
+                        std::string failure = shard_failure(outcome);
+                        if (failure.empty() && outcome.rpc) {
+                            partials.push_back(
+                                he->deserialize(outcome.response.body, WireFormat::binary, worker_check));
+                            continue;
+                        }
+                        auto result =
+                            failure.empty() ? crow::json::load(outcome.response.body) : crow::json::rvalue();
+                        if (!result || !result.has("encrypted_result")) {
+                            response["error"] = "Summing a range failed: " +
+                                                (failure.empty() ? outcome.worker + ": malformed response" : failure);
+                            return crow::response(502, response);
+                        }
+                        partials.push_back(
+                            he->deserialize(json_view(result["encrypted_result"]), WireFormat::base64, worker_check));
+                    }
+                    seal::Ciphertext total = he->sum(partials);
+                    if (packed) he->sum_slots_inplace(total);
+                    response["encrypted_result"] = he->serialize(total, wire);
+                    response["combine_ms"] =
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    response["count"] = block_count;
+                    report_wire_sizes(response, wire);
+                    return crow::response(200, response);
+                });
+            });
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            res = crow::response(404, response);
+            res.end();
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            res = crow::response(400, response);
+            res.end();
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            res = crow::response(500, response);
+            res.end();
+        }
+    });
+
+    // POST /cluster/galois_keys
+    // Install Galois keys (as for POST /galois_keys, default profile) on the
+    // coordinator and every live worker. An RPC worker gets all key sets back to
+    // back on one connection as raw GaloisKeys::save bytes; others get one
+    // POST /galois_keys each
+    //
+    // Request body (JSON):
+    // {
+    //   "keys": [{ "scheme": "bfv" | "ckks" | "bgv", "galois_keys": "base64_encoded_galois_keys" }, ...]
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "status": "ok",
+    //   "workers": [...]          // as "shards" for PUT /binary/cluster/store; "count" is key sets
+    // }
+    CROW_ROUTE(app, "/cluster/galois_keys")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("keys") || json_data["keys"].t() != crow::json::type::List) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::vector<std::string> schemes;
+            std::vector<std::string> keys;
+            for (const auto& item : json_data["keys"]) {
+                if (!item.has("scheme") || !item.has("galois_keys")) throw std::invalid_argument("Missing required fields");
+                HomomorphicEncryption* he;
+                CiphertextStore* store;
+                select_scheme(req, item["scheme"].s(), he, store);
+                std::string_view encoded = json_view(item["galois_keys"]);
+                schemes.push_back(item["scheme"].s());
+                keys.emplace_back();
+                base64::decode(encoded.data(), encoded.size(), keys.back());
+            }
+            for (size_t i = 0; i < keys.size(); i++) {
+                for (size_t node = 0; node < numa.size(); node++) {
+                    on_node(node, [&] {
+                        registries[node]->get(profiles::default_profile(), schemes[i])
+                            .load_galois_keys(keys[i], WireFormat::binary);
+                    });
+                }
+            }
+
+            std::vector<Cluster::Call> calls;
+            std::vector<size_t> counts;
+            for (const Cluster::WorkerInfo& info : cluster.workers()) {
+                if (info.down) continue;
+                if (!info.rpc.empty()) {
+                    Cluster::Call call;
+                    call.workers = { info.address };
+                    for (size_t i = 0; i < keys.size(); i++) {
+                        call.rpc.push_back({ node_rpc::Op::galois_keys, schemes[i], "", "", keys[i] });
+                    }
+                    calls.push_back(std::move(call));
+                    counts.push_back(keys.size());
+                    continue;
+                }
+                for (const auto& item : json_data["keys"]) {
+                    crow::json::wvalue body;
+                    body["scheme"] = item["scheme"].s();
+                    body["galois_keys"] = item["galois_keys"].s();
+                    calls.push_back({ { info.address }, "POST", "/galois_keys", body.dump() });
+                    counts.push_back(1);
+                }
+            }
+            std::vector<Cluster::Outcome> outcomes = cluster.scatter(calls);
+            response["workers"] = shard_timings(outcomes, counts);
+            for (const auto& outcome : outcomes) {
+                std::string failure = shard_failure(outcome);
+                if (!failure.empty()) {
+                    response["error"] = "Installing keys on a worker failed: " + failure;
+                    return crow::response(502, response);
+                }
+            }
+            response["status"] = "ok";
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // DELETE /cluster/store/<handle>?scheme=bfv|ckks
+    // Delete a sharded column from its workers
+    //
+    // Response (JSON):
+    // {
+    //   "status": "ok",
+    //   "shards": [...]           // as for PUT /binary/cluster/store
+    // }
+    CROW_ROUTE(app, "/cluster/store/<string>")
+    .methods("DELETE"_method)
+    ([&](const crow::request& req, const std::string& handle) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            HomomorphicEncryption* he;
+            CiphertextStore* store;
+            select_scheme(req, scheme, he, store);
+
+            std::vector<Cluster::Shard> shards = cluster.erase_column(handle);
+            if (shards.empty()) {
+                response["error"] = "Unknown cluster column handle: " + handle;
+                return crow::response(404, response);
+            }
+            std::vector<Cluster::Call> calls;
+            std::vector<size_t> counts;
+            for (const auto& shard : shards) {
+                calls.push_back(delete_shard(shard, scheme));
+                counts.push_back(shard.count);
+            }
+            response["shards"] = shard_timings(cluster.scatter(calls), counts);
+            response["status"] = "ok";
+            return crow::response(200, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // CLIENT-ASSISTED REFRESH
+    // ========================================
+    // Ciphertexts that used up their levels are refreshed by the key holder
+    // rather than computed under a profile deep enough for the whole pipeline:
+    // /refresh/mask adds a random mask, mini-backend's /refresh (or a client
+    // holding the key) decrypts and encrypts afresh, and /refresh/unmask
+    // removes the mask, giving fresh ciphertexts of the same values. The key
+    // holder never sees the values: BFV and BGV masks are uniform modulo the
+    // plain modulus, CKKS masks uniform in [-mask_bound, mask_bound], which
+    // hides values well below the bound; how large a bound fits depends on
+    // the level (2^8 at the last of the default profile). Batches are independent, so any
+    // number can be out at once (see RefreshMasks)
+
+    // POST /refresh/mask
+    // Request body (JSON):
+    // {
+    //   "encrypted_values": ["cipher1", ...],
+    //   "scheme": "ckks",
+    //   "profile": "default",     // optional, see /add_encrypted
+    //   "mask_bound": 256,        // optional, CKKS only: values must be smaller; default the
+    //                             // largest the ciphertexts' level leaves room for
+    //   "compression": "zlib"     // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "refresh_id": "9c1e...",
+    //   "masked_values": ["cipher1", ...],  // for the key holder; CKKS and BGV at the
+    //                                       // lowest level the mask fits
+    //   "count": 2,
+    //   "mask_bound": 256,
+    //   "expires_s": 600
+    // }
+    CROW_ROUTE(app, "/refresh/mask")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("encrypted_values") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+
+            RefreshMasks::Pending pending;
+            pending.scheme = he.scheme_name();
+            pending.profile = he.parameter_profile().name;
+            seal::UniformRandomGeneratorFactory::DefaultFactory()->create()->generate(
+                sizeof(pending.seed), reinterpret_cast<seal::seal_byte*>(pending.seed.data()));
+
+            std::vector<seal::Ciphertext> ciphertexts =
+                EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"])).release();
+            if (ciphertexts.empty()) throw std::invalid_argument("Cannot refresh empty vector of ciphertexts");
+            if (json_data.has("mask_bound")) {
+                pending.bound = json_data["mask_bound"].d();
+                if (!(pending.bound > 0)) throw std::invalid_argument("mask_bound must be positive");
+            } else if (he.is_ckks()) {
+                pending.bound = he.refresh_mask_bound(ciphertexts[0]);
             }
-            
-            // Perform sum operation (average = sum / count, but division is done client-side)
-            if (scheme == "bfv") {
-                std::string sum = he_bfv.sum(ciphertexts);
-                response["encrypted_result"] = sum;
-            } else if (scheme == "ckks") {
-                std::string sum = he_ckks.sum(ciphertexts);
-                response["encrypted_result"] = sum;
+            for (size_t i = 0; i < ciphertexts.size(); i++) {
+                he.add_refresh_mask(ciphertexts[i], pending.seed, i, pending.bound);
+            }
+            pending.count = ciphertexts.size();
+            HE_LOG(Info) << "Refresh mask | Scheme: " << scheme << " | Ciphertexts: " << pending.count;
+
+            response["masked_values"] = EncryptedVector(he, std::move(ciphertexts)).to_wire(wire);
+            response["count"] = pending.count;
+            if (he.is_ckks()) response["mask_bound"] = pending.bound;
+            response["refresh_id"] = refresh_masks.put(std::move(pending));
+            response["expires_s"] = refresh_ttl_s;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // POST /refresh/unmask
+    // Request body (JSON):
+    // {
+    //   "refresh_id": "9c1e...",
+    //   "encrypted_values": ["cipher1", ...],  // the key holder's refresh of masked_values, in order
+    //   "scheme": "ckks",
+    //   "profile": "default",     // as for /refresh/mask
+    //   "compression": "zlib"     // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "encrypted_values": ["cipher1", ...]   // fresh ciphertexts of the values first masked
+    // }
+    // Each refresh_id is taken by the first unmask, even one rejected for its
+    // ciphertexts; unknown, taken or expired IDs get 404
+    CROW_ROUTE(app, "/refresh/unmask")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("refresh_id") || !json_data.has("encrypted_values") ||
+            !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+
+            std::vector<seal::Ciphertext> ciphertexts =
+                EncryptedVector::from_wire(he, json_views(json_data["encrypted_values"])).release();
+            RefreshMasks::Pending pending = refresh_masks.take(json_data["refresh_id"].s());
+            if (pending.scheme != he.scheme_name() || pending.profile != he.parameter_profile().name) {
+                throw std::invalid_argument("Refresh was masked under " + pending.scheme + " and profile " +
+                                            pending.profile);
+            }
+            if (ciphertexts.size() != pending.count) {
+                throw std::invalid_argument("Expected " + std::to_string(pending.count) + " refreshed ciphertexts");
+            }
+            for (size_t i = 0; i < ciphertexts.size(); i++) {
+                he.remove_refresh_mask(ciphertexts[i], pending.seed, i, pending.bound);
+            }
+            HE_LOG(Info) << "Refresh unmask | Scheme: " << scheme << " | Ciphertexts: " << pending.count;
+
+            response["encrypted_values"] = EncryptedVector(he, std::move(ciphertexts)).to_wire(wire);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // ASYNC JOB ENDPOINTS
+    // ========================================
+    // Large sums run as jobs on job_queue's own workers, so the Crow threads only
+    // parse the request and hand back a job ID; /json and short requests stay
+    // responsive however much compute is queued. Poll GET /jobs/<id> or
+    // subscribe over WS /ws/jobs for progress and the result.
+
+    // POST /jobs
+    // Request body (JSON):
+    // {
+    //   "operation": "sum" | "average",     // or "logreg_gradient" or "repack", below
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "encrypted_values": ["cipher1", ...],   // or "handle" of a stored column
+    //   "handle": "3f2a...",
+    //   "profile": "sum-fast",    // optional, with "encrypted_values" only; see /add_encrypted
+    //   "packed": true,           // optional, see /csv/sum
+    //   "compression": "zlib",    // optional, see /add_encrypted
+    //   "compact_result": true    // optional, see /add_encrypted
+    // }
+    //
+    // "logreg_gradient" runs one gradient-descent step of logistic regression
+    // training on encrypted patients (HomomorphicEncryption::logistic_gradient):
+    // the gradient X^T (sigmoid(X w + b) - y) under the current weights, which
+    // the key holder decrypts, divides by the patient count and applies before
+    // sending the next step's weights. Patients come feature_major from
+    // /ml/encrypt_patients, with "labels" for encrypted_labels; add a
+    // constant-1 feature to train the bias. Needs profile ml-inference
+    // {
+    //   "operation": "logreg_gradient",
+    //   "scheme": "ckks",
+    //   "encrypted_features": ["packed1", ...],
+    //   "encrypted_labels": ["packed1", ...],  // one per features ciphertext
+    //   "weights": [0.0, ...], "bias": 0.0,    // or "model", as /ml/logreg/predict
+    //   "profile": "ml-inference",
+    //   "compression": "zlib", "compact_result": true  // optional
+    // }
+    // Its result: { "encrypted_result": "...", "gradient_slots": [0, 1024, ...],
+    //   "patients_per_ciphertext": 1024, ... }; slot gradient_slots[f] holds
+    //   feature f's component
+    //
+    // "repack" packs a stored column of single-value ciphertexts (the slot-0
+    // layout of /encrypt) into a new stored column laid out as /encrypt_vector's,
+    // slot_count() values a ciphertext (HomomorphicEncryption::repack), without
+    // the key holder: sums of it can then be "packed", at a slot_count()-th of
+    // the memory. Needs the Galois keys under BFV and BGV, a level under CKKS.
+    // The source column is left as it is
+    // {
+    //   "operation": "repack",
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "handle": "3f2a..."
+    // }
+    // Its result: { "handle": "9c41...", "count": 55500, "ciphertexts": 7, "slot_count": 8192 }
+    //
+    // Response (JSON, 202):
+    // {
+    //   "job_id": "b71c...",
+    //   "status": "queued"
+    // }
+    CROW_ROUTE(app, "/jobs")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        const bool gradient = json_data && json_data.has("operation") && json_data["operation"].s() == "logreg_gradient";
+        const bool repack = json_data && json_data.has("operation") && json_data["operation"].s() == "repack";
+        if (!json_data || !json_data.has("operation") || !json_data.has("scheme") ||
+            (gradient ? !json_data.has("encrypted_features") || !json_data.has("encrypted_labels") ||
+                            !(json_data.has("model") || json_data.has("weights"))
+             : repack ? !json_data.has("handle")
+                      : !(json_data.has("encrypted_values") || json_data.has("handle")))) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string operation = json_data["operation"].s();
+            if (operation != "sum" && operation != "average" && !gradient && !repack) {
+                throw std::invalid_argument("Invalid operation: " + operation);
+            }
+            if (gradient) {
+                LogisticModel model;
+                if (json_data.has("model")) {
+                    auto found = models.logistic.find(json_data["model"].s());
+                    if (found == models.logistic.end()) throw std::out_of_range("Unknown model: " + std::string(json_data["model"].s()));
+                    model = found->second;
+                } else {
+                    model = parse_logistic_model(json_data);
+                }
+                HomomorphicEncryption* he = &select_he(req, json_data["scheme"].s(), request_profile(json_data));
+                auto engines = app.get_context<TenantMiddleware>(req).engines;
+                WireOptions output(WireFormat::base64, request_compression(json_data, default_compression));
+                output.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+                auto features = std::make_shared<EncryptedVector>(
+                    EncryptedVector::from_wire(*he, json_views(json_data["encrypted_features"])));
+                auto labels = std::make_shared<EncryptedVector>(
+                    EncryptedVector::from_wire(*he, json_views(json_data["encrypted_labels"])));
+                if (features->size() != labels->size()) {
+                    throw std::invalid_argument("Expected one labels ciphertext per features ciphertext");
+                }
+
+                std::string id = job_queue.submit(operation,
+                    [he, engines, features, labels, model = std::move(model), output]
+                    (const JobQueue::Progress& progress) {
+                        metrics::EndpointScope scope("JOB /jobs");
+                        seal::Ciphertext gradient = he->logistic_gradient(features->data(), labels->data(),
+                                                                          features->size(), model, progress);
+                        const PatientPacking packing(PatientLayout::feature_major, model.weights.size(),
+                                                     he->slot_count());
+                        std::vector<size_t> slots;
+                        for (size_t f = 0; f < packing.feature_count(); f++) slots.push_back(packing.total_slot(f));
+
+                        WireStats stats;
+                        WireOptions wire(output.format, output.compression, &stats);
+                        wire.compact = output.compact;
+                        crow::json::wvalue result;
+                        result["encrypted_result"] = he->serialize(gradient, wire);
+                        result["gradient_slots"] = slots;
+                        result["patients_per_ciphertext"] = packing.patients_per_ciphertext();
+                        report_wire_sizes(result, wire);
+                        return result.dump();
+                    });
+                response["job_id"] = id;
+                response["status"] = "queued";
+                return crow::response(202, response);
+            }
+            if (repack) {
+                HomomorphicEncryption* he;
+                CiphertextStore* store;
+                select_scheme(req, json_data["scheme"].s(), he, store);
+                auto column = store->get(json_data["handle"].s());
+
+                std::string id = job_queue.submit(operation, [he, store, column](const JobQueue::Progress& progress) {
+                    metrics::EndpointScope scope("JOB /jobs");
+                    // A packed ciphertext's worth of inputs at a time, each slice repacked on all
+                    // threads, so progress (and cancellation) is seen between slices
+                    const size_t count = column->size();
+                    const size_t slice = he->slot_count() * std::max<size_t>(1, count / he->slot_count() / 20);
+                    CiphertextStore::Column packed;
+                    for (size_t begin = 0; begin < count; begin += slice) {
+                        size_t end = std::min(count, begin + slice);
+                        for (auto& ciphertext : he->repack(column->data() + begin, end - begin)) {
+                            packed.push_back(std::move(ciphertext));
+                        }
+                        progress(static_cast<double>(end) / count);
+                    }
+                    const size_t ciphertexts = packed.size();
+
+                    crow::json::wvalue result;
+                    result["handle"] = store->put(std::move(packed), packed_last_slots(*he, ciphertexts, count));
+                    result["count"] = count;
+                    result["ciphertexts"] = ciphertexts;
+                    result["slot_count"] = he->slot_count();
+                    return result.dump();
+                });
+                response["job_id"] = id;
+                response["status"] = "queued";
+                return crow::response(202, response);
+            }
+            HomomorphicEncryption* he;
+            CiphertextStore* store = nullptr;
+            if (json_data.has("handle")) {
+                // Stored columns live under the default profile and keys; inline values may use any
+                select_scheme(req, json_data["scheme"].s(), he, store);
             } else {
-                throw std::runtime_error("Invalid scheme");
+                he = &select_he(req, json_data["scheme"].s(), request_profile(json_data));
             }
-            
+            // A tenant's engine must outlive the request, until the job is done
+            auto engines = app.get_context<TenantMiddleware>(req).engines;
+            bool average = operation == "average";
+            bool packed = json_data.has("packed") && json_data["packed"].b();
+            WireOptions output(WireFormat::base64, request_compression(json_data, default_compression));
+            output.compact = json_data.has("compact_result") && json_data["compact_result"].b();
+
+            // Resolve the inputs now so bad requests fail here rather than in the job
+            std::shared_ptr<const CiphertextStore::Column> column;
+            std::vector<std::string> values;
+            if (json_data.has("handle")) {
+                column = store->get(json_data["handle"].s());
+            } else {
+                values.reserve(json_data["encrypted_values"].size());
+                for (const auto& val : json_data["encrypted_values"]) {
+                    values.push_back(val.s());
+                }
+                if (values.empty()) throw std::invalid_argument("Cannot sum empty vector of ciphertexts");
+            }
+
+            std::string id = job_queue.submit(operation,
+                [he, engines, column, values = std::move(values), packed, average, output]
+                (const JobQueue::Progress& progress) mutable {
+                    metrics::EndpointScope scope("JOB /jobs");
+                    // Reduce in slices so progress (and cancellation) is seen
+                    // regularly; each slice still uses the parallel sum
+                    size_t count = column ? column->size() : values.size();
+                    size_t slice = std::max<size_t>(64, (count + 19) / 20);
+                    seal::Ciphertext total;
+                    for (size_t begin = 0; begin < count; begin += slice) {
+                        size_t end = std::min(count, begin + slice);
+                        seal::Ciphertext part;
+                        if (column) {
+                            part = he->sum(column->data() + begin, end - begin);
+                        } else {
+                            part = he->deserialize_sum(CiphertextViews(values.begin() + begin, values.begin() + end));
+                            // Release the slice's uploads as soon as they are added
+                            for (size_t i = begin; i < end; i++) std::string().swap(values[i]);
+                        }
+                        if (begin == 0) {
+                            total = std::move(part);
+                        } else {
+                            he->add_inplace(total, part);
+                        }
+                        progress(static_cast<double>(end) / count);
+                    }
+                    if (packed) he->sum_slots_inplace(total);
+
+                    WireStats stats;
+                    WireOptions wire(output.format, output.compression, &stats);
+                    wire.compact = output.compact;
+                    crow::json::wvalue result;
+                    result["encrypted_result"] = he->serialize(total, wire);
+                    if (average) result["count"] = count;
+                    report_wire_sizes(result, wire);
+                    return result.dump();
+                });
+
+            response["job_id"] = id;
+            response["status"] = "queued";
+            return crow::response(202, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(404, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // GET /jobs/<id>
+    // Response (JSON): see job_json(); "result" holds the fields /csv/sum
+    // (or /store/average) would have returned
+    //
+    // DELETE /jobs/<id>
+    // Cancels a queued or running job
+    // Response (JSON): the job's snapshot after the request
+    CROW_ROUTE(app, "/jobs/<string>")
+    .methods("GET"_method, "DELETE"_method)
+    ([&](const crow::request& req, const std::string& id) {
+        crow::json::wvalue response;
+        if (req.method == "DELETE"_method && !job_queue.cancel(id)) {
+            JobQueue::Snapshot snapshot;
+            if (job_queue.status(id, snapshot)) {
+                response["error"] = std::string("Job already ") + JobQueue::state_name(snapshot.state);
+                return crow::response(409, response);
+            }
+        }
+
+        JobQueue::Snapshot snapshot;
+        if (!job_queue.status(id, snapshot)) {
+            response["error"] = "Unknown job: " + id;
+            return crow::response(404, response);
+        }
+        return crow::response(200, job_json(snapshot));
+    });
+
+    // WS /ws/jobs
+    // Client sends { "job_id": "b71c..." } (any number of times, one per job);
+    // the server replies with the job's snapshot and then every progress or
+    // state change until it finishes, or { "error": "..." } for unknown jobs
+    CROW_WEBSOCKET_ROUTE(app, "/ws/jobs")
+    .onopen([&](crow::websocket::connection& conn) {
+        conn.userdata(new std::shared_ptr<WebSocketChannel>(std::make_shared<WebSocketChannel>(conn)));
+    })
+    .onclose([&](crow::websocket::connection& conn, const std::string& reason, uint16_t) {
+        auto* channel = static_cast<std::shared_ptr<WebSocketChannel>*>(conn.userdata());
+        (*channel)->mark_closed();  // Subscriptions drop out at their next update
+        delete channel;
+        conn.userdata(nullptr);
+    })
+    .onmessage([&](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
+        std::shared_ptr<WebSocketChannel> channel = *static_cast<std::shared_ptr<WebSocketChannel>*>(conn.userdata());
+        auto json_data = crow::json::load(data);
+        std::string id = json_data && json_data.has("job_id") ? std::string(json_data["job_id"].s()) : "";
+
+        bool known = !id.empty() && job_queue.subscribe(id, [channel](const JobQueue::Snapshot& snapshot) {
+            return channel->send_text(job_json(snapshot).dump());
+        });
+        if (!known) {
+            crow::json::wvalue response;
+            response["error"] = id.empty() ? "Missing required fields" : "Unknown job: " + id;
+            channel->send_text(response.dump());
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Load Galois Keys
+    // ========================================
+    // POST /galois_keys
+    // Installs the rotation keys used by packed sums ("packed": true)
+    // The keys come from mini-backend's GET /galois_keys. Tenants' keys are only
+    // read from --key-dir, so X-Tenant-ID is rejected here
+    //
+    // Request body (JSON):
+    // {
+    //   "galois_keys": "base64_encoded_galois_keys",
+    //   "scheme": "bfv" | "ckks" | "bgv",
+    //   "profile": "sum-fast"     // optional, see /add_encrypted
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "status": "ok"
+    // }
+    CROW_ROUTE(app, "/galois_keys")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("galois_keys") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        if (!app.get_context<TenantMiddleware>(req).tenant.empty()) {
+            response["error"] = "POST /galois_keys does not take X-Tenant-ID";
+            return crow::response(400, response);
+        }
+
+        try {
+            // Every node's replica gets the keys, each loaded on its own node
+            std::string scheme = json_data["scheme"].s();
+            const ParameterProfile* requested = request_profile(json_data);
+            const ParameterProfile& profile = requested ? *requested : profiles::default_profile();
+            for (size_t node = 0; node < numa.size(); node++) {
+                on_node(node, [&] {
+                    registries[node]->get(profile, scheme).load_galois_keys(json_view(json_data["galois_keys"]));
+                });
+            }
+            response["status"] = "ok";
+            return crow::response(200, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Load Evaluation Keys
+    // ========================================
+    // POST /binary/evaluation_keys?scheme=bfv|ckks|bgv[&profile=...]
+    // Installs relinearization and Galois keys from mini-backend's
+    // GET /binary/evaluation_keys, kept seeded and compressed as sent: each key
+    // is expanded the first time a request relinearizes or rotates with it.
+    // Galois keys replace those read from --key-dir; X-Tenant-ID is rejected,
+    // as for POST /galois_keys
+    //
+    // Request body: framed [relin_keys, galois_keys], either payload may be empty
+    //
+    // Response (JSON):
+    // {
+    //   "status": "ok"
+    // }
+    CROW_ROUTE(app, "/binary/evaluation_keys")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        if (!app.get_context<TenantMiddleware>(req).tenant.empty()) {
+            response["error"] = "POST /binary/evaluation_keys does not take X-Tenant-ID";
+            return crow::response(400, response);
+        }
+
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::vector<std::string_view> keys = framing::unframe(req.body_view());
+            if (!scheme_param || keys.size() != 2) {
+                response["error"] = "Expected scheme and framed [relin_keys, galois_keys]";
+                return crow::response(400, response);
+            }
+            const ParameterProfile* requested = request_profile(req.url_params);
+            const ParameterProfile& profile = requested ? *requested : profiles::default_profile();
+            for (size_t node = 0; node < numa.size(); node++) {
+                on_node(node, [&] {
+                    registries[node]->get(profile, scheme_param).load_evaluation_keys(keys[0], keys[1]);
+                });
+            }
+            response["status"] = "ok";
             return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
         } catch (const std::exception& e) {
             response["error"] = e.what();
             return crow::response(500, response);
@@ -318,22 +6193,374 @@ int main() {
     // Response (JSON):
     // {
     //   "status": "ok",
-    //   "message": "Main backend is running"
+    //   "message": "Main backend is running",
+    //   "pending_jobs": 0,
+    //   "schemes": { "bfv": "ready", "ckks": "ready", "bgv": "ready" }
     // }
+    //
+    // "schemes": the default profile's engines, as on mini-backend's GET /health.
+    // Here they are all built before the server listens; "no_keys" if --key-dir
+    // had no evaluation keys for the scheme (additions still work, products do not)
     CROW_ROUTE(app, "/json")
     .methods("GET"_method)
-    ([]() {
+    ([&]() {
         crow::json::wvalue response;
         response["status"] = "ok";
         response["message"] = "Main backend is running";
+        response["pending_jobs"] = job_queue.pending();
+        for (HomomorphicEncryption* he : {&he_bfv, &he_ckks, &he_bgv}) {
+            response["schemes"][he->scheme_name()] = he->has_relin_keys() ? "ready" : "no_keys";
+        }
+        return response;
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Memory
+    // ========================================
+    // GET /admin/memory
+    // SEAL's global pool by allocation size: items held, items free and the blocks
+    // they live in. Free items are what POST /admin/memory/trim (or --pool-trim-idle-s)
+    // can give back, as far as whole blocks are free. "caches": what each entry type
+    // under the memory budget holds, what remaking it would cost, and what evictions
+    // (budget, quota) and expirations (ttl) have dropped so far, at what cost
+    //
+    // Response (JSON):
+    // {
+    //   "resident_bytes": 123456789,
+    //   "pool_bytes": 98765432,
+    //   "pool_limit_bytes": null,          // --pool-limit-mb, when set
+    //   "unpooled_allocations": 0,         // allocations that bypassed the pool at the limit
+    //   "classes": [{"item_bytes": 262144, "items": 40, "free_items": 12, "blocks": 8}, ...],
+    //   "budget": {"used_bytes": 7340032, "max_bytes": null, "tenant_quota_bytes": null},
+    //   "caches": [{"type": "results", "entries": 12, "bytes": 7340032, "ttl_s": 600,
+    //               "rebuild_us": 48210, "evictions": 3, "expirations": 40,
+    //               "evicted_bytes": 1048576, "eviction_cost_us": 90210}, ...],
+    //   "tenants": {"st-marys": 52428800, ...}   // key sets and cached responses per tenant
+    // }
+    //
+    // POST /admin/memory/trim
+    // Sweeps the memory budget (expiry and eviction) and trims the pool right away.
+    // Response: {"freed_bytes": 1234, "pool_bytes": 5678, "evicted_bytes": 0}
+    CROW_ROUTE(app, "/admin/memory")
+    .methods("GET"_method)
+    ([&]() {
+        seal::MemoryPoolHandle pool = seal::MemoryManager::GetPool(seal::mm_force_global);
+        crow::json::wvalue response;
+        response["resident_bytes"] = metrics::resident_memory_bytes();
+        response["pool_bytes"] = pool.alloc_byte_count();
+        if (pool.byte_count_limit() != std::numeric_limits<size_t>::max()) {
+            response["pool_limit_bytes"] = pool.byte_count_limit();
+        } else {
+            response["pool_limit_bytes"] = nullptr;
+        }
+        response["unpooled_allocations"] = pool.unpooled_count();
+        std::vector<crow::json::wvalue> classes;
+        for (const seal::util::MemoryPoolSizeClass& size_class : pool.size_classes()) {
+            crow::json::wvalue entry;
+            entry["item_bytes"] = size_class.item_byte_count;
+            entry["items"] = size_class.item_count;
+            entry["free_items"] = size_class.free_item_count;
+            entry["blocks"] = size_class.block_count;
+            classes.push_back(std::move(entry));
+        }
+        response["classes"] = std::move(classes);
+
+        const MemoryBudget::Options& limits = memory_budget.options();
+        response["budget"]["used_bytes"] = memory_budget.used_bytes();
+        if (limits.max_bytes) {
+            response["budget"]["max_bytes"] = limits.max_bytes;
+        } else {
+            response["budget"]["max_bytes"] = nullptr;
+        }
+        if (limits.tenant_quota_bytes) {
+            response["budget"]["tenant_quota_bytes"] = limits.tenant_quota_bytes;
+        } else {
+            response["budget"]["tenant_quota_bytes"] = nullptr;
+        }
+        std::vector<crow::json::wvalue> caches;
+        for (const MemoryBudget::TypeReport& type : memory_budget.report()) {
+            crow::json::wvalue entry;
+            entry["type"] = type.type;
+            entry["entries"] = type.usage.entries;
+            entry["bytes"] = type.usage.bytes;
+            entry["ttl_s"] = static_cast<uint64_t>(type.ttl.count());
+            entry["rebuild_us"] = static_cast<uint64_t>(type.usage.rebuild_us);
+            entry["evictions"] = type.evictions;
+            entry["expirations"] = type.expirations;
+            entry["evicted_bytes"] = type.evicted_bytes;
+            entry["eviction_cost_us"] = static_cast<uint64_t>(type.eviction_cost_us);
+            caches.push_back(std::move(entry));
+        }
+        response["caches"] = std::move(caches);
+        response["tenants"] = crow::json::wvalue::empty_object();
+        for (const auto& [tenant, bytes] : memory_budget.tenant_usage()) response["tenants"][tenant] = bytes;
+        return response;
+    });
+
+    CROW_ROUTE(app, "/admin/memory/trim")
+    .methods("POST"_method)
+    ([&]() {
+        crow::json::wvalue response;
+        response["evicted_bytes"] = memory_budget.sweep();
+        response["freed_bytes"] = PoolTrimmer::trim();
+        response["pool_bytes"] = seal::MemoryManager::GetPool(seal::mm_force_global).alloc_byte_count();
         return response;
     });
 
+    // ========================================
+    // REST API ENDPOINT: CPU Profile
+    // ========================================
+    // POST /admin/profile?seconds=10&frequency=99
+    // Starts sampling every thread's stack while the process uses CPU, for `seconds`
+    // (at most --profile-max-s, default 60; 0 disables the endpoint) at `frequency`
+    // samples per CPU-second, in the background (see Profiler.h). Needs no privileges;
+    // one profile at a time (409 otherwise). Response: 202 {"running": true, ...}
+    //
+    // GET /admin/profile
+    // The latest profile as collapsed stacks for flamegraph.pl or speedscope, SEAL's
+    // internal functions included; X-HE-Samples / X-HE-Dropped-Samples count them.
+    // 202 {"running": true} while one is being taken, 404 before the first
+    //
+    // Response (text/plain):
+    //   main-backend;ThreadPool<>::worker;...;seal::util::ntt_negacyclic_harvey_lazy 412
+    CROW_ROUTE(app, "/admin/profile")
+    .methods("GET"_method, "POST"_method)
+    ([profile_max_s](const crow::request& req) {
+        crow::json::wvalue response;
+        if (profile_max_s == 0) {
+            response["error"] = "Profiling is disabled (--profile-max-s=0)";
+            return crow::response(404, response);
+        }
+        if (req.method == crow::HTTPMethod::GET) {
+            if (profiler::running()) {
+                response["running"] = true;
+                return crow::response(202, response);
+            }
+            std::shared_ptr<const profiler::Profile> profile = profiler::last();
+            if (!profile) {
+                response["error"] = "No profile taken yet (POST /admin/profile starts one)";
+                return crow::response(404, response);
+            }
+            crow::response res(200, profile->collapsed);
+            res.set_header("Content-Type", "text/plain");
+            res.set_header("X-HE-Samples", std::to_string(profile->samples));
+            res.set_header("X-HE-Dropped-Samples", std::to_string(profile->dropped));
+            return res;
+        }
+        try {
+            const char* seconds_param = req.url_params.get("seconds");
+            const char* frequency_param = req.url_params.get("frequency");
+            size_t seconds = seconds_param ? std::stoul(seconds_param) : 10;
+            size_t frequency = frequency_param ? std::stoul(frequency_param) : 99;
+            if (seconds == 0 || seconds > profile_max_s || frequency == 0 || frequency > 1000) {
+                response["error"] = "seconds must be 1 to " + std::to_string(profile_max_s) + ", frequency 1 to 1000";
+                return crow::response(400, response);
+            }
+            profiler::start(std::chrono::seconds(seconds), static_cast<unsigned>(frequency));
+            response["running"] = true;
+            response["seconds"] = seconds;
+            response["frequency"] = frequency;
+            return crow::response(202, response);
+        } catch (const std::logic_error&) {  // std::stoul: not a number, or out of range
+            response["error"] = "seconds and frequency must be numbers";
+            return crow::response(400, response);
+        } catch (const profiler::Busy& e) {
+            response["error"] = e.what();
+            return crow::response(409, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(501, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Query Plan
+    // ========================================
+    // POST /plan
+    // Picks how to run an encrypted computation before its data is encrypted: the
+    // layout, parameter profile, rotations and local or distributed execution with
+    // the lowest predicted cost, from per-operation costs calibrated at startup
+    // (see QueryPlanner.h). The /csv/* aggregates report the plan they ran under as
+    // "plan" in their responses
+    //
+    // Request body (JSON):
+    // {
+    //   "operation": "sum" | "mean" | "variance" | "group_by" | "linear_model",
+    //   "scheme": "bfv" | "ckks",
+    //   "rows": 100000,           // values, or patients for linear_model
+    //   "features": 16,           // linear_model: weights per patient
+    //   "groups": 8,              // group_by
+    //   "packed": true,           // optional, fixes the layout; else chosen
+    //   "profile": "default",     // optional, fixes the profile (or "depth", "precision_bits"
+    //                             // as for /add_encrypted); else chosen
+    //   "distributed": false      // optional, leave the cluster's workers out
+    // }
+    //
+    // Response (JSON):
+    // {
+    //   "plan": { "operation": "sum", "scheme": "bfv", "profile": "sum-fast", "depth": 0,
+    //             "packing": "packed", "ciphertexts": 25, "rotation": "slot_fold",
+    //             "rotations": 12, "execution": "local", "shards": 1, "compute_us": 4210,
+    //             "transfer_us": 0, "estimated_us": 4210, "costs": "calibrated" },
+    //   "alternatives": [ ...every plan considered, cheapest first ]
+    // }
+    CROW_ROUTE(app, "/plan")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("operation") || !json_data.has("scheme") || !json_data.has("rows")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            if (scheme != "bfv" && scheme != "ckks") throw std::invalid_argument("Invalid scheme");
+            PlanRequest request;
+            request.operation = parse_plan_operation(json_data["operation"].s());
+            request.use_ckks = scheme == "ckks";
+            request.rows = static_cast<size_t>(json_data["rows"].u());
+            if (json_data.has("features")) request.features = static_cast<size_t>(json_data["features"].u());
+            if (json_data.has("groups")) request.groups = static_cast<size_t>(json_data["groups"].u());
+            if (json_data.has("packed")) request.packed = json_data["packed"].b() ? 1 : 0;
+            request.profile = request_profile(json_data);
+            if (!json_data.has("distributed") || json_data["distributed"].b()) {
+                request.workers = cluster.live_workers().size();
+            }
+
+            std::vector<Plan> plans = planner.alternatives(request);
+            std::vector<crow::json::wvalue> alternatives;
+            for (const auto& plan : plans) alternatives.push_back(plan_json(plan));
+            response["plan"] = plan_json(plans.front());
+            response["alternatives"] = std::move(alternatives);
+            return crow::response(200, response);
+        } catch (const std::out_of_range& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // REST API ENDPOINT: Metrics
+    // ========================================
+    // GET /metrics
+    // Prometheus text exposition: request latency per endpoint and status,
+    // stage latency per endpoint, scheme and stage, current RSS, SEAL pool
+    // usage, ciphertext store size and pending jobs
+    metrics::gauge("he_store_resident_bytes", "Ciphertext bytes held in memory by the column stores",
+                   [&] {
+                       return static_cast<double>(bfv_store.memory_usage() + ckks_store.memory_usage() +
+                                                  bgv_store.memory_usage());
+                   });
+    metrics::gauge("he_store_columns", "Columns held by the ciphertext stores",
+                   [&] { return static_cast<double>(bfv_store.size() + ckks_store.size() + bgv_store.size()); });
+    using TierUsage = CiphertextStore::TierUsage;
+    auto tier_total = [&](size_t TierUsage::*field) {
+        return static_cast<double>(bfv_store.tier_usage().*field + ckks_store.tier_usage().*field +
+                                   bgv_store.tier_usage().*field);
+    };
+    const std::tuple<const char*, size_t TierUsage::*, size_t TierUsage::*> tiers[] = {
+        {"memory", &TierUsage::memory_columns, &TierUsage::memory_bytes},
+        {"disk", &TierUsage::disk_columns, &TierUsage::disk_bytes},
+        {"object", &TierUsage::object_columns, &TierUsage::object_bytes},
+    };
+    for (const auto& [tier, columns, bytes] : tiers) {
+        metrics::gauge("he_store_tier_columns", "Columns of the ciphertext stores per tier", {{"tier", tier}},
+                       [tier_total, field = columns] { return tier_total(field); });
+        metrics::gauge("he_store_tier_bytes", "Bytes of the ciphertext stores per tier (of files below memory)",
+                       {{"tier", tier}}, [tier_total, field = bytes] { return tier_total(field); });
+    }
+    metrics::gauge("he_vitals_bytes", "Ciphertext bytes of the vitals windows",
+                   [&] { return static_cast<double>(vitals.data_bytes()); });
+    metrics::gauge("he_vitals_patients", "Patients with vitals windows",
+                   [&] { return static_cast<double>(vitals.patient_count()); });
+    metrics::gauge("he_result_cache_bytes", "Bytes of the responses held by the result cache",
+                   [&] { return static_cast<double>(result_cache.size_bytes()); });
+    metrics::gauge("he_jobs_pending", "Jobs queued or running",
+                   [&] { return static_cast<double>(job_queue.pending()); });
+    metrics::gauge("he_admission_active_cost", "Cost (operand coefficients) of the admitted requests running",
+                   [&] { return static_cast<double>(admission.active_cost()); });
+    metrics::gauge("he_admission_queued_cost", "Cost (operand coefficients) of the requests waiting for admission",
+                   [&] { return static_cast<double>(admission.queued_cost()); });
+    metrics::gauge("he_admission_active_requests", "Admitted cost-limited requests running",
+                   [&] { return static_cast<double>(admission.active()); });
+    metrics::gauge("he_admission_queued_requests", "Cost-limited requests waiting for admission",
+                   [&] { return static_cast<double>(admission.queued()); });
+    if (!tenants.empty()) {
+        metrics::gauge("he_tenant_key_sets", "Tenant key sets loaded", [&] {
+            size_t total = 0;
+            for (const auto& node : tenants) total += node->size();
+            return static_cast<double>(total);
+        });
+        metrics::gauge("he_tenant_key_bytes", "Bytes of the tenant keys loaded", [&] {
+            size_t total = 0;
+            for (const auto& node : tenants) total += node->key_bytes();
+            return static_cast<double>(total);
+        });
+    }
+    if (numa.size() > 1) {
+        for (size_t node = 0; node < numa.size(); node++) {
+            const metrics::Labels labels{{"node", std::to_string(numa.node(node).id)}};
+            metrics::gauge("he_numa_compute_threads", "Compute pool threads pinned to each NUMA node", labels,
+                           [&, node] { return static_cast<double>(compute_pools[node]->size()); });
+            if (tenants.empty()) continue;
+            metrics::gauge("he_numa_tenant_key_sets", "Tenant key sets loaded on each NUMA node", labels,
+                           [&, node] { return static_cast<double>(tenants[node]->size()); });
+            metrics::gauge("he_numa_tenant_key_bytes", "Bytes of the tenant keys loaded on each NUMA node", labels,
+                           [&, node] { return static_cast<double>(tenants[node]->key_bytes()); });
+        }
+    }
+
+    CROW_ROUTE(app, "/metrics")
+    .methods("GET"_method)
+    ([]() {
+        crow::response res(200, metrics::render());
+        res.set_header("Content-Type", "text/plain; version=0.0.4");
+        return res;
+    });
+
     // ========================================
     // SERVER STARTUP
     // ========================================
-    // Start the HTTP server on port 18080 with multithreading support
-    std::cout << "Starting main backend on port 18080...\n";
+    // Start the HTTP server (port 18080 unless --port is given)
+    std::cout << "Starting main backend on port " << port << "...\n";
+    if (prefork_worker.count > 1) {
+        std::cout << "Prefork worker " << prefork_worker.index << " of " << prefork_worker.count << ": "
+                  << prefork_worker.cpus.size() << " CPUs, " << prefork_worker.cpus.front() << " to "
+                  << prefork_worker.cpus.back() << "\n";
+    }
+    std::cout << "I/O threads: " << io_threads << " | Compute threads: " << compute_pool->size()
+              << (compute_cpus.empty() ? "" : " (pinned)") << " | Job threads: " << job_threads << "\n";
+    if (numa_enabled) {
+        std::cout << "NUMA nodes: " << numa.size() << " (";
+        for (size_t node = 0; node < numa.size(); node++) {
+            std::cout << (node ? ", " : "") << "node " << numa.node(node).id << ": " << compute_pools[node]->size()
+                      << " compute threads";
+        }
+        std::cout << ")" << (numa.size() > 1 ? "" : ", single node: no replicas") << "\n";
+    }
+    std::cout << "SEAL kernels: " << cpu::seal_kernel_path() << "\n";
+    std::cout << "SEAL PRNG: " << cpu::seal_prng_path(prng_name(prng)) << "\n";
+    if (huge_pages.mode != seal::util::huge_page_mode::none) {
+        std::cout << "SEAL huge pages: " << huge_page_mode_name(huge_pages.mode) << " for blocks of "
+                  << (huge_pages.min_byte_count >> 10) << " KiB and more"
+                  << (huge_pages.numa_local ? ", NUMA-local" : "") << "\n";
+    }
     std::cout << "###########################\n";
-    app.port(18080).multithreaded().run();  // Blocks here until server is stopped
+    app.port(static_cast<uint16_t>(port)).concurrency(static_cast<uint16_t>(io_threads)).run();  // Blocks here until server is stopped
+    // Cluster sums still in flight combine with main()'s locals: finish them while those exist
+    cluster.shutdown();
+    return 0;
+} catch (const std::invalid_argument& e) {
+    std::cerr << "main-backend: " << e.what() << "\n";
+    return 2;
 }
@@ -6,23 +6,53 @@
  * 2. CSV file reading and processing capabilities
  * 3. Public key distribution endpoints
  * 
- * Unlike the main backend, this server generates keys automatically and
- * provides direct encrypt/decrypt endpoints for development and testing.
+ * Unlike the main backend, this server holds the secret key (generated at
+ * startup, or loaded from --key-dir / HE_KEY_DIR) and provides direct encrypt/decrypt
+ * endpoints for development and testing.
  */
 
 #include "crow.h"                    // Crow HTTP framework for REST API
 #include "HomomorphicEncryption.h"   // Our custom homomorphic encryption wrapper
 #include "CORSMiddleware.h"          // CORS middleware for cross-origin requests
+#include "MetricsMiddleware.h"       // Request latency metrics for GET /metrics
+#include "TraceMiddleware.h"         // W3C trace context and OTLP spans per request
+#include "ScratchArenaMiddleware.h"  // Per-request reset of SEAL scratch arenas
+#include "CiphertextPool.h"          // Per-thread reuse of ciphertext allocations (--ciphertext-pool-mb)
+#include "TenantMiddleware.h"        // X-Tenant-ID and the tenant engines a request holds
+#include "CancellationMiddleware.h"  // X-Deadline-Ms and client disconnects stop long operations
+#include "TrafficMiddleware.h"       // --record-traffic: requests logged for he-replay
+#include "KeyStore.h"                // Persistent key set shared with main-backend
+#include "BinaryFraming.h"           // Length-prefixed framing for binary bodies
+#include "ProfileRegistry.h"         // Per-profile contexts and keys, created on first use
+#include "TenantRegistry.h"          // Per-tenant key sets, created on first use
+#include "PublicKeyCache.h"          // Clients' own public keys, parsed once
+#include "MemoryBudget.h"            // One memory bound and TTLs over the key and plaintext caches
+#include "Profiler.h"                // In-process CPU sampling for /admin/profile
+#include "CsvTable.h"                // Memory-mapped, cached CSV columns
+#include "ArrowFile.h"               // Numeric columns of Arrow IPC files, read in place
+#include "EncryptPipeline.h"         // Streaming CSV column -> packed ciphertexts
+#include "ThreadPool.h"              // Worker pool for pipelined encryption
+#include "WebSocketChannel.h"        // Thread-safe websocket sends for streamed results
+#include "ServerConfig.h"            // Command line / environment options
+#include "HttpOptions.h"             // Keep-alive, body limit and socket options of the Crow server
+#include "Logger.h"                  // Asynchronous, level-filtered request logging
+#include "CpuFeatures.h"             // Startup report of the SEAL kernel path and PRNG
+#include "SealExecutor.h"            // SEAL key generation and opt-in RNS-parallel operations on compute_pool
+#include "NormalEquations.h"         // Solving /ml/linreg/aggregate results
+#include "CentroidPacking.h"         // Patients repeated per centroid, and their /ml/kmeans/assign
+#include "HistogramBuckets.h"        // One-hot bucketing and percentiles of cumulative histograms
+#include "RollupCube.h"              // Per-cell totals by date and category for /rollup/encrypt
+#include "PrivateSetIntersection.h"  // Cuckoo-hashed queries and their matches for /psi/query and /psi/decrypt
+#include "CrtResidues.h"             // Recombining /decrypt_vector's CRT residues
+#include "SharedRegion.h"            // Same-host handoff of /csv/encrypt results (--shm-handoff)
+#include <atomic>                    // For the shared encryption counter
 #include <iostream>                  // For console I/O operations
 #include <chrono>                    // For performance timing measurements
-
-// Platform-specific includes for memory usage monitoring
-#if defined(_WIN32)
-    #include <windows.h>
-    #include <psapi.h>
-#else
-    #include <sys/resource.h>
-#endif
+#include <cmath>                     // For std::log2
+#include <cstdlib>                   // For std::strtod
+#include <cstring>                   // For std::memcpy of /binary/encrypt_bulk bodies
+#include <future>                    // For building the default engines in parallel
+#include <sstream>                   // For comma-separated operation lists
 
 /**
  * Utility function to safely log ciphertext for debugging
@@ -31,11 +61,202 @@
  * @param ct The ciphertext string to log
  * @return A truncated version of the ciphertext (first 20 characters) or "[EMPTY]" if empty
  */
-static std::string log_cipher(const std::string& ct) {
+static std::string log_cipher(std::string_view ct) {
     if (ct.empty()) return "[EMPTY]";
-    return ct.substr(0, std::min(20, (int)ct.length()));
+    return std::string(ct.substr(0, 20));
+}
+
+/**
+ * A JSON string as a view into the parsed body, so ciphertexts are not copied out of the DOM
+ * 
+ * @param value String value; the view is valid as long as the document it belongs to
+ * @return The (unescaped) text
+ */
+static std::string_view json_view(const crow::json::rvalue& value) {
+    auto text = value.s();
+    return std::string_view(text.begin(), text.size());
+}
+
+// The strings of a JSON array (e.g. "encrypted_values") as views, see json_view
+static CiphertextViews json_views(const crow::json::rvalue& array) {
+    CiphertextViews views;
+    views.reserve(array.size());
+    for (const auto& value : array) views.push_back(json_view(value));
+    return views;
+}
+
+/**
+ * Build an application/octet-stream response for the binary transport endpoints
+ * 
+ * @param body Raw response bytes
+ * @return Crow response with status 200 and binary content type
+ */
+static crow::response binary_response(std::string body) {
+    crow::response res(200, std::move(body));
+    res.set_header("Content-Type", "application/octet-stream");
+    return res;
+}
+
+/**
+ * Resolve the compression mode for a request
+ * 
+ * @param name Compression requested by the client ("none", "zlib", "zstd", "bitpack") or nullptr
+ * @param fallback Server default used when the client did not ask for one
+ * @return SEAL compression mode
+ * @throws std::invalid_argument for unknown or unavailable modes
+ */
+static seal::compr_mode_type request_compression(const char* name, seal::compr_mode_type fallback) {
+    return name ? parse_compr_mode(name) : fallback;
+}
+
+// Same as above for JSON requests, reading the optional "compression" field
+static seal::compr_mode_type request_compression(const crow::json::rvalue& json, seal::compr_mode_type fallback) {
+    return json.has("compression") ? parse_compr_mode(json["compression"].s()) : fallback;
+}
+
+/**
+ * Parameter profile of a JSON request: "profile" by name; else, with
+ * "precision_bits", "security" or "dnum", parameters selected for "depth",
+ * those and "integer_bits" (CKKS); else the smallest built-in profile
+ * supporting "depth"
+ * 
+ * @return The profile, or nullptr if the request names none of these (server default)
+ * @throws std::out_of_range for unknown profiles or unsupported depths
+ * @throws std::invalid_argument if no parameters meet the requirements
+ */
+static const ParameterProfile* request_profile(const crow::json::rvalue& json) {
+    if (json.has("profile")) return &profiles::get(json["profile"].s());
+    if (json.has("precision_bits") || json.has("security") || json.has("dnum")) {
+        ParameterRequirements requirements;
+        requirements.use_ckks = json.has("scheme") && json["scheme"].s() == "ckks";
+        if (json.has("depth")) requirements.depth = static_cast<size_t>(json["depth"].i());
+        if (json.has("precision_bits")) requirements.precision_bits = static_cast<int>(json["precision_bits"].i());
+        if (json.has("integer_bits")) requirements.integer_bits = static_cast<int>(json["integer_bits"].i());
+        if (json.has("security")) requirements.security = profiles::parse_security(static_cast<int>(json["security"].i()));
+        if (json.has("dnum")) requirements.dnum = static_cast<size_t>(json["dnum"].i());
+        return &profiles::select(requirements);
+    }
+    if (json.has("depth")) return &profiles::for_depth(static_cast<size_t>(json["depth"].i()));
+    return nullptr;
+}
+
+// Same as above for query parameters, reading ?profile= or ?depth=
+static const ParameterProfile* request_profile(const crow::query_string& params) {
+    if (const char* name = params.get("profile")) return &profiles::get(name);
+    if (const char* depth = params.get("depth")) return &profiles::for_depth(std::stoul(depth));
+    return nullptr;
+}
+
+/**
+ * Add serialized size information to a JSON response, and for ciphertext
+ * results the lowest level (chain index, 0 = last prime) and largest size
+ * in polynomials among them
+ * 
+ * @param response Response under construction
+ * @param wire Options the payload was serialized with (stats must be set)
+ */
+static void report_wire_sizes(crow::json::wvalue& response, const WireOptions& wire) {
+    response["compression"] = compr_mode_name(wire.compression);
+    response["raw_bytes"] = wire.stats->raw_bytes;
+    response["wire_bytes"] = wire.stats->wire_bytes;
+    if (wire.stats->ciphertexts) {
+        response["level"] = wire.stats->min_level;
+        response["ciphertext_size"] = wire.stats->max_size;
+    }
+}
+
+/**
+ * Add serialized size information to a binary response as headers
+ * 
+ * @param res Response under construction
+ * @param wire Options the payload was serialized with (stats must be set)
+ */
+static void report_wire_sizes(crow::response& res, const WireOptions& wire) {
+    res.compressed = wire.compression == seal::compr_mode_type::none;  // zlib / zstd / bitpack SEAL bytes would not shrink again
+    res.set_header("X-HE-Compression", compr_mode_name(wire.compression));
+    res.set_header("X-HE-Raw-Bytes", std::to_string(wire.stats->raw_bytes));
+    res.set_header("X-HE-Wire-Bytes", std::to_string(wire.stats->wire_bytes));
+    if (wire.stats->ciphertexts) {
+        res.set_header("X-HE-Level", std::to_string(wire.stats->min_level));
+        res.set_header("X-HE-Ciphertext-Size", std::to_string(wire.stats->max_size));
+    }
+}
+
+/**
+ * With a client's own public key (see encryption_he in main), tell the client
+ * the key's fingerprint, which it can send instead of the key from then on
+ * 
+ * @param response Response under construction
+ * @param json Request body
+ * @param he Engine the request encrypted with
+ */
+static void report_client_key(crow::json::wvalue& response, const crow::json::rvalue& json,
+                              const HomomorphicEncryption& he) {
+    if (json.has("public_key") || json.has("public_key_fingerprint")) {
+        response["public_key_fingerprint"] = he.public_key_fingerprint();
+    }
+}
+
+/**
+ * Add a ciphertext's telemetry to a JSON response: "level" out of "max_level",
+ * "ciphertext_size" in polynomials and "coeff_modulus_count", plus "scale" and
+ * "scale_bits" for CKKS or "noise_budget" (bits) for BFV
+ * 
+ * @param response Response under construction
+ * @param info What HomomorphicEncryption::inspect reported
+ */
+static void report_ciphertext_info(crow::json::wvalue& response, const CiphertextInfo& info) {
+    response["level"] = info.level;
+    response["max_level"] = info.max_level;
+    response["ciphertext_size"] = info.size;
+    response["coeff_modulus_count"] = info.coeff_modulus_count;
+    if (info.noise_budget >= 0) {
+        response["noise_budget"] = info.noise_budget;
+    } else {
+        response["scale"] = info.scale;
+        response["scale_bits"] = std::log2(info.scale);
+    }
+}
+
+/**
+ * Buckets of a histogram from JSON: {"min": 0, "width": 5, "buckets": 64}
+ * @throws std::invalid_argument for missing fields or invalid buckets
+ */
+static HistogramBuckets parse_buckets(const crow::json::rvalue& json) {
+    if (!json.has("min") || !json.has("width") || !json.has("buckets")) {
+        throw std::invalid_argument("Histogram needs min, width and buckets");
+    }
+    return HistogramBuckets(json["min"].d(), json["width"].d(), static_cast<size_t>(json["buckets"].u()));
+}
+
+/**
+ * PSI parameters from JSON, each optional: {"bundles": 4, "partition_size": 32, "window_bits": 2}
+ * @throws std::invalid_argument for values out of range (see PsiParameters::validate)
+ */
+static PsiParameters parse_psi_parameters(const crow::json::rvalue& json) {
+    PsiParameters parameters;
+    if (json.has("bundles")) parameters.bundles = static_cast<size_t>(json["bundles"].u());
+    if (json.has("partition_size")) parameters.partition_size = static_cast<size_t>(json["partition_size"].u());
+    if (json.has("window_bits")) parameters.window_bits = static_cast<size_t>(json["window_bits"].u());
+    parameters.validate();
+    return parameters;
+}
+
+/**
+ * Split a comma-separated list of names, skipping empty entries
+ */
+static std::vector<std::string> split_names(const std::string& names) {
+    std::vector<std::string> result;
+    std::stringstream list(names);
+    for (std::string name; std::getline(list, name, ',');) {
+        if (!name.empty()) result.push_back(name);
+    }
+    return result;
 }
 
+// Parsed CSV files, reused across requests until the file changes
+static CsvCache csv_cache;
+
 /**
  * Read numeric values from a specific column in a CSV file
  * This function is used for processing datasets before encryption
@@ -45,51 +266,54 @@ static std::string log_cipher(const std::string& ct) {
  * @return Vector of double values from the specified column
  * @throws std::runtime_error if file cannot be opened
  * 
- * Note: Automatically skips the header row and ignores conversion errors
+ * Note: The header row is skipped and non-numeric cells are ignored.
+ * The whole file is parsed into columns on first use and served from
+ * csv_cache afterwards (see CsvTable.h). Arrow IPC files are read in place
+ * instead, only the requested column (see ArrowFile.h).
  */
 std::vector<double> read_csv(const std::string& file_path, int column_index) {
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file");
+    if (ArrowFile::is_arrow(file_path)) {
+        std::vector<double> values;
+        if (column_index < 0) return values;
+        ArrowFile(file_path).scan_column(static_cast<size_t>(column_index), [&](const double* run, size_t count) {
+            values.insert(values.end(), run, run + count);
+        });
+        return values;
     }
-    
-    std::vector<double> values;
-    std::string line, cell;
-    
-    // Skip header row
-    std::getline(file, line);
-    
-    // Process each data row
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        int current_col = 0;
-        
-        // Parse each cell in the row
-        while (std::getline(ss, cell, ',')) {
-            if (current_col++ == column_index) {
-                try {
-                    values.push_back(std::stod(cell));  // Convert string to double
-                } catch (...) {
-                    // Ignore conversion errors for invalid/missing data
-                }
-                break;  // Found target column, move to next row
-            }
-        }
+    auto table = csv_cache.get(file_path);
+    if (column_index < 0) return {};
+    return table->column(static_cast<size_t>(column_index));
+}
+
+/**
+ * Stream one column of a CSV or Arrow IPC file into an encryption pipeline
+ * (see CsvTable::scan_column). Only the column's own buffers of an Arrow file
+ * are read, and runs of them go to the pipeline straight from the mapping
+ *
+ * @throws std::invalid_argument for Parquet files (see ArrowFile::is_arrow)
+ * @throws std::runtime_error if the file cannot be read
+ */
+void stream_column(const std::string& file_path, size_t column_index, EncryptPipeline& pipeline) {
+    if (ArrowFile::is_arrow(file_path)) {
+        ArrowFile(file_path).scan_column(column_index, [&](const double* run, size_t count) {
+            pipeline.push(run, count);
+        });
+    } else {
+        CsvTable::scan_column(file_path, column_index, [&](double value) { pipeline.push(value); });
     }
-    
-    return values;
 }
 
 
 // Global counter to track encryption operations for session management
-int encryption_count = 0;
+// (atomic: /encrypt runs on every Crow worker thread)
+std::atomic<int> encryption_count{0};
 
 /**
  * Print session start delimiter for console logging
  * Used to visually group related operations in the console output
  */
 void print_session_start() {
-    std::cout << "###########################\n";
+    HE_LOG(Info) << "###########################";
 }
 
 /**
@@ -97,7 +321,7 @@ void print_session_start() {
  * Marks the completion of a logical group of operations
  */
 void print_session_end() {
-    std::cout << "###########################\n";
+    HE_LOG(Info) << "###########################";
 }
 
 /**
@@ -105,7 +329,7 @@ void print_session_end() {
  * Used to separate individual operations within a session
  */
 void print_op_separator() {
-    std::cout << "---------------------------\n";
+    HE_LOG(Info) << "---------------------------";
 }
 
 /**
@@ -116,16 +340,273 @@ void print_op_separator() {
  * - Provides direct encrypt/decrypt endpoints for testing
  * - Includes CSV processing capabilities for dataset operations
  * - Runs on port 18081 to avoid conflicts with the main backend
+ * 
+ * Options (--name=value, or the HE_NAME environment variable):
+ *   --port, --io-threads, --compute-threads, --compute-cpus, --stream-threads,
+ *   --http-keepalive-s, --http-max-body-mb, --http-read-buffer-kb, --http-socket-buffer-kb, --http-nodelay,
+ *   --http-compression, --http-compression-min-kb, --http-compression-level,
+ *   --http2, --http2-max-streams, --http2-window-kb, --http2-connection-window-mb,
+ *   --compression, --key-dir, --tenant-key-cache-mb, --public-key-cache-mb, --galois-operations,
+ *   --memory-budget-mb, --tenant-quota-mb, --key-ttl-s, --plaintext-cache-ttl-s, --memory-sweep-ms,
+ *   --rns-parallel-min-coeffs, --scratch-arena-mb, --compact-keys, --ciphertext-pool-mb, --zero-pool,
+ *   --huge-pages, --huge-page-min-kb, --huge-pages-numa, --prng, --profile-max-s, --shm-handoff, --shm-ttl-s,
+ *   --otlp-endpoint, --trace-sample-ratio, --trace-max-per-second,
+ *   --record-traffic, --record-traffic-sample, --record-traffic-bodies, --record-traffic-buffer-mb
+ * 
+ * Every HE endpoint accepts "profile" (or "depth") to use another parameter
+ * profile than "default"; GET /profiles lists them. A profile's keys are
+ * generated (or loaded from --key-dir) the first time it is used. With
+ * --key-dir, "X-Tenant-ID" selects a tenant's own key set instead
  */
-int main() {
-    // Initialize homomorphic encryption instances with automatic key generation
-    // This makes the mini backend ready to use immediately for testing
-    HomomorphicEncryption he_bfv(false, true);   // BFV with key generation
-    HomomorphicEncryption he_ckks(true, true);   // CKKS with key generation
+int main(int argc, char** argv) try {
+    ServerConfig config(argc, argv);
+
+    // --huge-pages, --huge-page-min-kb, --huge-pages-numa: SEAL's pool blocks on
+    // huge pages, as on main-backend; set before the keys are generated or loaded
+    seal::util::HugePageConfig huge_pages;
+    huge_pages.mode = parse_huge_page_mode(config.get("huge-pages", "off"));
+    huge_pages.min_byte_count = config.get_size("huge-page-min-kb", 2048) << 10;
+    huge_pages.numa_local = config.get_size("huge-pages-numa", 0) != 0;
+    seal::util::set_huge_page_config(huge_pages);
+
+    // --prng: the PRNG of encryptions and keys, as on main-backend; both servers
+    // must use one their peers (and the browser) can load
+    const seal::prng_type prng = parse_prng(config.get("prng", "blake2xb"));
+    set_default_prng(prng);
+
+    // Server-wide compression for ciphertexts and keys (--compression=none|zlib|zstd);
+    // requests can override it with "compression" (JSON) or ?compression= (query)
+    const seal::compr_mode_type default_compression =
+        parse_compr_mode(config.get("compression", compr_mode_name(seal::Serialization::compr_mode_default)));
+
+    // With --key-dir set, reuse the key set from a previous run (and share it with
+    // main-backend); otherwise, or on first start, generate keys and store them
+    std::unique_ptr<KeyStore> key_store;
+    if (config.has("key-dir")) {
+        key_store = std::make_unique<KeyStore>(config.get("key-dir"), default_compression);
+    }
+
+    // --scratch-arena-mb: carve SEAL temporaries from per-thread bump-pointer arenas
+    // (first block of this many MiB each), reset after every request, instead of
+    // the thread-local pools. Off by default
+    const size_t scratch_arena_bytes = config.get_size("scratch-arena-mb", 0) << 20;
+
+    // --compact-keys: hold relinearization and Galois key limbs modulo primes of at
+    // most 32 bits as 32-bit words (see HomomorphicEncryption::set_compact_keys):
+    // a quarter less key memory with {50, 30, 30, 50}, at no measurable rotation
+    // cost. Off by default
+    const bool compact_keys = config.get_size("compact-keys", 0) != 0;
+
+    // --ciphertext-pool-mb: ciphertexts each thread keeps once a request is done with
+    // them, so later operands and results load into allocations that already exist
+    // (see CiphertextPool.h). 16 by default; 0 disables the pool
+    ciphertext_pool::set_thread_limit(config.get_size("ciphertext-pool-mb", 16) << 20);
+
+    // --profile-max-s: longest /admin/profile sampling (default 60); 0 disables the endpoint
+    const size_t profile_max_s = config.get_size("profile-max-s", 60);
+
+    // --memory-budget-mb: one bound over the tenant key sets, client public keys and
+    // plaintext caches together, on top of each one's own; --tenant-quota-mb: the most
+    // one tenant's key sets may hold. Keys idle for --key-ttl-s and plaintexts idle for
+    // --plaintext-cache-ttl-s are dropped. All off by default; sweeps run every
+    // --memory-sweep-ms (1000) once any is set (see MemoryBudget.h, he_memory_* on /metrics)
+    MemoryBudget::Options budget_options;
+    budget_options.max_bytes = config.get_size("memory-budget-mb", 0) << 20;
+    budget_options.tenant_quota_bytes = config.get_size("tenant-quota-mb", 0) << 20;
+    MemoryBudget memory_budget(budget_options);
+    const std::chrono::seconds key_ttl(config.get_size("key-ttl-s", 0));
+    const std::chrono::seconds plaintext_ttl(config.get_size("plaintext-cache-ttl-s", 0));
+    const bool budget_sweeps = budget_options.max_bytes > 0 || budget_options.tenant_quota_bytes > 0 ||
+                               key_ttl.count() > 0 || plaintext_ttl.count() > 0;
+    const std::chrono::milliseconds budget_interval(budget_sweeps ? config.get_size("memory-sweep-ms", 1000) : 0);
+
+    // --zero-pool: encryptions of zero each engine keeps ready on a background
+    // thread, so /encrypt and the packed encryptions skip the sampling and NTTs
+    // on the request path. Each costs a ciphertext's memory; off by default
+    const size_t zero_pool = config.get_size("zero-pool", 0);
+
+    // --galois-operations: rotations to generate Galois keys for, by operation
+    // ("slot_sum", "matvec", "prefix_sum", "conjugate", comma-separated; empty for
+    // none). Each key is about as large as the relinearization key, so servers that
+    // never use packed sums or matrix products are better off without them;
+    // prefix_sum adds about log2(slots) keys for main-backend's /prefix_sum, and
+    // conjugate one key for separating /encrypt_vector's paired CKKS columns
+    const std::vector<std::string> galois_operations = split_names(config.get("galois-operations", "slot_sum,matvec"));
+
+    // Worker pool for pipelined encryption and batched decryption, sized apart from
+    // Crow's HTTP workers (--io-threads); --compute-cpus pins it, as on main-backend
+    std::vector<int> compute_cpus = ServerConfig::parse_cpu_list(config.get("compute-cpus", ""));
+    size_t compute_threads = config.get_size("compute-threads",
+        compute_cpus.empty() ? std::thread::hardware_concurrency() : compute_cpus.size());
+    size_t io_threads = config.get_size("io-threads", std::thread::hardware_concurrency());
+    // --http-*: keep-alive, body size limit, read and socket buffers, TCP_NODELAY (see HttpOptions.h)
+    const HttpOptions http_options = HttpOptions::from(config);
+    auto compute_pool =
+        std::make_shared<ThreadPool>(compute_threads, compute_cpus, [] { metrics::label_thread("compute"); });
+
+    // --rns-parallel-min-coeffs: split a single operation's per-limb NTTs, dyadic
+    // products and key switching across compute_pool, in tasks of at least this many
+    // coefficients (16384 = one limb at n = 16384). Off by default; it only pays when
+    // large-parameter requests are fewer than the compute threads. Key generation
+    // uses the pool either way
+    SealExecutor::install(compute_pool, config.get_size("rns-parallel-min-coeffs", 0));
+
+    // --warm-up-rounds: before an engine serves, run encrypt, add, multiply, slot sum
+    // and decrypt this many times on each compute thread and read its key pages (see
+    // HomomorphicEncryption::warm_up), so the first requests after a deploy do not pay
+    // for pool growth and page faults. Delays readiness by about that many requests'
+    // worth of work per thread; off by default
+    const size_t warm_up_rounds = config.get_size("warm-up-rounds", 0);
+
+    // Homomorphic encryption instances, one per parameter profile and scheme;
+    // the default profile's are created (and keyed) right away, see below
+    ProfileRegistry registry([&](HomomorphicEncryption& he) {
+        he.set_scratch_arenas(scratch_arena_bytes);
+        memory_budget.add("plaintexts", he.plaintext_cache(), plaintext_ttl);
+        he.set_zero_pool(zero_pool);
+        he.set_compact_keys(compact_keys);
+        he.set_thread_pool(compute_pool);
+        he.set_rotation_operations(galois_operations);
+        if (!key_store || !he.load_keys(*key_store)) {
+            he.generate_keys();
+            if (key_store) he.save_keys(*key_store);
+        }
+        he.warm_up(warm_up_rounds);
+    });
+
+    // The default profile's engines are built in the background, every scheme at
+    // once, while the server already listens: a request waits in registry.get until
+    // its scheme's engine is ready, and GET /health says which are. One whose setup
+    // failed (e.g. an unreadable --key-dir) is tried again by the next request for it
+    const char* const default_schemes[] = {"bfv", "ckks", "bgv"};
+    std::vector<std::future<void>> startup;
+    for (const char* scheme : default_schemes) {
+        startup.push_back(std::async(std::launch::async, [&registry, scheme] {
+            try {
+                registry.get(profiles::default_profile(), parse_scheme(scheme));
+            } catch (const std::exception& e) {
+                std::cerr << "mini-backend: " << scheme << " setup failed: " << e.what() << "\n";
+            }
+        }));
+    }
+
+    // Engine for a scheme and, if it names one, parameter profile, under the server's own keys
+    auto default_he = [&](const std::string& scheme, const ParameterProfile* profile) -> HomomorphicEncryption& {
+        return registry.get(profile ? *profile : profiles::default_profile(), scheme);
+    };
+
+    // Tenants' own key sets (X-Tenant-ID), generated the first time a tenant uses a profile
+    // and stored in --key-dir/tenant-<id>, where main-backend finds the evaluation keys;
+    // --tenant-key-cache-mb bounds the key bytes kept loaded. Without --key-dir an evicted
+    // secret key would be lost, so there are no tenants
+    std::unique_ptr<TenantRegistry> tenants;
+    if (key_store) {
+        tenants = std::make_unique<TenantRegistry>(
+            registry, *key_store, config.get_size("tenant-key-cache-mb", 1024) << 20,
+            [](HomomorphicEncryption& he, const KeyStore& store) {
+                if (he.load_keys(store)) return true;
+                he.generate_keys();
+                he.save_keys(store);
+                return true;
+            });
+        memory_budget.add("tenant_keys", *tenants, key_ttl);
+    }
+    auto tenant_he = [&](const std::string& tenant, const std::string& scheme, const ParameterProfile* profile) {
+        if (!tenants) throw std::invalid_argument("X-Tenant-ID needs --key-dir");
+        return tenants->get(tenant, profile ? *profile : profiles::default_profile(), scheme);
+    };
+
+    // --public-key-cache-mb: clients' own public keys ("public_key" on the encryption
+    // endpoints) kept parsed, with their encryptors, so a client posting its key
+    // again (or only its fingerprint) skips the parse; see PublicKeyCache.h
+    PublicKeyCache client_keys(config.get_size("public-key-cache-mb", 64) << 20);
+    memory_budget.add("public_keys", client_keys, key_ttl);
+    // After every cache it sweeps, so it stops before they are destroyed
+    MemoryBudget::Sweeper memory_sweeper(memory_budget, budget_interval);
+
+    // --shm-handoff=1: /csv/encrypt's "shared_memory" option leaves the ciphertexts in a
+    // shared memory region for a main-backend on the same host (see SharedRegion.h);
+    // regions it has not consumed after --shm-ttl-s seconds are unlinked
+    const std::chrono::seconds shm_ttl(config.get_size("shm-ttl-s", 60));
+    std::unique_ptr<shm::Publisher> shm_publisher;
+    if (config.get_size("shm-handoff", 0) != 0) shm_publisher = std::make_unique<shm::Publisher>(shm_ttl);
+
+    // Drivers for websocket streams; kept apart from compute_pool, whose
+    // workers the drivers wait on
+    const size_t max_concurrent_streams = config.get_size("stream-threads", 4);
+    ThreadPool stream_pool(max_concurrent_streams);
+
+    const size_t port = config.get_size("port", 18081);
+    const crow::LogLevel log_level = logging::parse_level(config.get("log-level", "warning"));
+
+    // --otlp-endpoint: export spans (per request and per HE stage) to an OpenTelemetry
+    // collector, e.g. http://localhost:4318/v1/traces. Callers' sampled traceparent
+    // headers are followed, --trace-sample-ratio of other requests start a trace, and
+    // at most --trace-max-per-second traces are recorded in all
+    tracing::Tracer::instance().configure(config.get("otlp-endpoint", ""), "mini-backend",
+                                          std::stod(config.get("trace-sample-ratio", "0.01")),
+                                          config.get_size("trace-max-per-second", 20));
+
+    // --record-traffic=FILE: log the requests served (arrival time, method, path, endpoint,
+    // status, handler time) for tools/he-replay (see TrafficLog.h). Bodies here carry
+    // plaintext values and file paths, so they are kept only with --record-traffic-bodies=1.
+    // --record-traffic-sample (1) records a fraction of requests, and records beyond
+    // --record-traffic-buffer-mb (64) not yet on disk are dropped
+    traffic::Recorder::instance().configure(config.get("record-traffic", ""), "mini-backend",
+                                            std::stod(config.get("record-traffic-sample", "1")),
+                                            config.get_size("record-traffic-bodies", 0) != 0,
+                                            config.get_size("record-traffic-buffer-mb", 64) << 20);
+    config.check_unused();
 
     // Initialize Crow web application with CORS middleware
-    crow::App<CORSMiddleware> app;
-    app.loglevel(crow::LogLevel::Warning);  // Reduce log verbosity
+    crow::App<TrafficMiddleware, CORSMiddleware, TraceMiddleware, MetricsMiddleware, ScratchArenaMiddleware,
+              TenantMiddleware, CancellationMiddleware>
+        app;
+    app.loglevel(log_level);  // Warning by default; request logs are Info, per-value logs Debug
+    http_options.apply(app);
+    crow::logger::setHandler(&logging::AsyncLog::instance());  // Crow's messages share the async writer
+
+    // Engine for a request's tenant, scheme and profile. Tenant engines are held by the
+    // request's TenantMiddleware context until it is answered
+    auto select_he = [&](const crow::request& req, const std::string& scheme,
+                         const ParameterProfile* profile) -> HomomorphicEncryption& {
+        auto& tenant = app.get_context<TenantMiddleware>(req);
+        if (tenant.tenant.empty()) return default_he(scheme, profile);
+        tenant.engines.push_back(tenant_he(tenant.tenant, scheme, profile));
+        return *tenant.engines.back();
+    };
+
+    // Engine for an encryption request: under the client's own public key if the body has
+    // "public_key" (Base64, as GET /public_key returns one) or the "public_key_fingerprint" an
+    // earlier response returned for it, else select_he's. The request holds it like a tenant's
+    auto encryption_he = [&](const crow::request& req, const crow::json::rvalue& json, const std::string& scheme,
+                             bool seeded) -> HomomorphicEncryption& {
+        const ParameterProfile* profile = request_profile(json);
+        const bool has_key = json.has("public_key");
+        if (!has_key && !json.has("public_key_fingerprint")) return select_he(req, scheme, profile);
+        if (seeded) throw std::invalid_argument("\"seeded\" needs the server's secret key, not a public_key");
+        HomomorphicEncryption& base = default_he(scheme, profile);
+        auto& held = app.get_context<TenantMiddleware>(req).engines;
+        held.push_back(has_key ? client_keys.load(base, json_view(json["public_key"]))
+                               : client_keys.find(base, json["public_key_fingerprint"].s()));
+        return *held.back();
+    };
+
+    // Engines of a CRT request ("crt_moduli": k, BFV or BGV): one per profiles::crt_residue
+    // profile of the request's profile (default: the default profile), in residue order
+    auto crt_engines = [&](const crow::request& req, const crow::json::rvalue& json, const std::string& scheme,
+                           size_t moduli) {
+        if (scheme == "ckks") throw std::invalid_argument("CRT moduli are for bfv and bgv");
+        const ParameterProfile* profile = request_profile(json);
+        const ParameterProfile& base = profile ? *profile : profiles::default_profile();
+        std::vector<HomomorphicEncryption*> engines;
+        std::vector<uint64_t> moduli_values;
+        for (size_t i = 0; i < moduli; i++) {
+            engines.push_back(&select_he(req, scheme, &profiles::crt_residue(base, moduli, i)));
+            moduli_values.push_back(engines.back()->parameter_profile().plain_modulus);
+        }
+        return std::make_pair(std::move(engines), CrtResidues(moduli_values));
+    };
 
     // ========================================
     // CSV PROCESSING ENDPOINTS
@@ -152,7 +633,7 @@ int main() {
     CROW_ROUTE(app, "/csv/read")
     .methods("POST"_method)
     ([&](const crow::request& req) {
-        auto json_data = crow::json::load(req.body);
+        auto json_data = parse_json(req.body_view());
         crow::json::wvalue response;
         
         // Validate required fields
@@ -195,7 +676,7 @@ int main() {
     CROW_ROUTE(app, "/csv/sum") // sum for non-encrypted calculations
     .methods("POST"_method)
     ([&](const crow::request& req) {
-        auto json_data = crow::json::load(req.body);
+        auto json_data = parse_json(req.body_view());
         crow::json::wvalue response;
         
         // Validate required fields
@@ -246,7 +727,7 @@ int main() {
     CROW_ROUTE(app, "/csv/average") // average for non-encrypted calculations
     .methods("POST"_method)
     ([&](const crow::request& req) {
-        auto json_data = crow::json::load(req.body);
+        auto json_data = parse_json(req.body_view());
         crow::json::wvalue response;
         
         // Validate required fields
@@ -277,13 +758,6 @@ int main() {
             return crow::response(500, response);
         }
     });
-            response["values_processed"] = values.size();
-            return crow::response(200, response);
-        } catch (const std::exception& e) {
-            response["error"] = e.what();
-            return crow::response(500, response);
-        }
-    });
 
     // ========================================
     // HOMOMORPHIC ENCRYPTION ENDPOINTS
@@ -295,24 +769,39 @@ int main() {
      * 
      * Encrypts a single numeric value using the specified scheme
      * Includes performance timing and memory usage monitoring
+     * With "X-Tenant-ID: <id>" (here and on every other endpoint) the tenant's own
+     * keys are used, created on its first request; see TenantRegistry.h
      * 
      * Request body (JSON):
      * {
      *   "value": 42.5,
-     *   "scheme": "bfv" | "ckks"
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "profile": "sum-fast",                    // optional, parameter profile (GET /profiles), or
+     *                                             // "depth": 2 for the smallest one that supports it
+     *   "compression": "none" | "zlib" | "zstd" | "bitpack",  // optional, defaults to HE_COMPRESSION
+     *   "seeded": true,                           // optional, secret-key encryption in seeded
+     *                                             // form (about half the size)
+     *   "public_key": "base64_encoded_public_key",  // optional, encrypt under the client's own key
+     *   "public_key_fingerprint": "9f86d0..."       // or, instead, the fingerprint returned for it
      * }
      * 
      * Response (JSON):
      * {
      *   "ciphertext": "base64_encoded_ciphertext",
+     *   "profile": "default",     // pass it on to every later request on this ciphertext
+     *   "public_key_fingerprint": "9f86d0...",  // with a client key: send this instead of the key
+     *                                          // next time (412 once the server has dropped it)
      *   "execution_us": 1234,
-     *   "ram_kb": 5678
+     *   "ram_kb": 5678,
+     *   "compression": "zlib",
+     *   "raw_bytes": 393329,      // uncompressed SEAL size
+     *   "wire_bytes": 369780      // size of "ciphertext" as sent
      * }
      */
     CROW_ROUTE(app, "/encrypt")
     .methods("POST"_method)
     ([&](const crow::request& req) {
-        auto json_data = crow::json::load(req.body);
+        auto json_data = parse_json(req.body_view());
         crow::json::wvalue response;
 
         // Validate required fields
@@ -324,55 +813,36 @@ int main() {
         try {
             std::string scheme = json_data["scheme"].s();
             double value = json_data["value"].d();
+            bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
             std::string ciphertext;
 
             // Session management: Start new session every 2 encryptions
-            if (encryption_count % 2 == 0) {
+            if (encryption_count.load(std::memory_order_relaxed) % 2 == 0) {
                 print_session_start();  // Start of session every 2 encryptions
             }
 
             // Start performance timing
             auto start = std::chrono::high_resolution_clock::now();
 
-            // Perform encryption based on the specified scheme
-            if (scheme == "bfv") {
-                ciphertext = he_bfv.encrypt(value);
-            } else if (scheme == "ckks") {
-                ciphertext = he_ckks.encrypt(value);
-            } else {
-                throw std::runtime_error("Invalid scheme");
-            }
+            // Perform encryption based on the specified scheme and profile
+            HomomorphicEncryption& he = encryption_he(req, json_data, scheme, seeded);
+            ciphertext = seeded ? he.encrypt_symmetric(value, wire) : he.encrypt(value, wire);
 
             // Calculate execution time
             auto end = std::chrono::high_resolution_clock::now();
             auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
             
             // Log operation details for monitoring
-            std::cout << "Encrypted | Scheme: " << scheme 
-                      << " | Ciphertext (first 20): " << log_cipher(ciphertext) << std::endl;
-
-            std::cout << "Encryption was done in " << duration_us << " microseconds\n";
-            std::cout << "Throughput: " << (1000000.0 / duration_us) << " operations per second\n";
-
-            // Measure current memory usage
-            size_t ram_kb = 0;
-
-            // Platform-specific memory measurement
-            #if defined(_WIN32)
-                // Windows memory measurement
-                PROCESS_MEMORY_COUNTERS memInfo;
-                GetProcessMemoryInfo(GetCurrentProcess(), &memInfo, sizeof(memInfo));
-                ram_kb = memInfo.WorkingSetSize / 1024;
-            #else
-                // Unix/Linux memory measurement
-                struct rusage usage;
-                getrusage(RUSAGE_SELF, &usage);
-                #ifdef __APPLE__
-                    ram_kb = usage.ru_maxrss / 1024;  // macOS returns bytes
-                #else
-                    ram_kb = usage.ru_maxrss;         // Linux returns KB
-                #endif
-            #endif
+            HE_LOG(Info) << "Encrypted | Scheme: " << scheme 
+                         << " | Ciphertext (first 20): " << log_cipher(ciphertext);
+
+            HE_LOG(Info) << "Encryption was done in " << duration_us << " microseconds";
+            HE_LOG(Info) << "Throughput: " << (1000000.0 / duration_us) << " operations per second";
+
+            // Measure current (not peak) memory usage
+            size_t ram_kb = metrics::resident_memory_bytes() / 1024;
 
             // Include memory usage in response
             response["ram_kb"] = ram_kb;
@@ -382,9 +852,104 @@ int main() {
             encryption_count++;   // Increment operation counter
 
             // Prepare response with encrypted data and performance metrics
-            response["ciphertext"] = ciphertext;
+            response["ciphertext"] = std::move(ciphertext);
+            response["profile"] = he.parameter_profile().name;
+            response["execution_us"] = duration_us;
+            report_client_key(response, json_data, he);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const PublicKeyCache::UnknownFingerprint& e) {
+            response["error"] = e.what();
+            return crow::response(412, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Bulk Encryption Endpoint
+     * POST /encrypt_bulk
+     * 
+     * Encrypts many values in one request: chunks of batch_size values are
+     * encoded and encrypted concurrently on the compute threads (see
+     * EncryptPipeline) while the next chunk is cut, and the ciphertexts come
+     * back in input order. batch_size 1 gives one ciphertext per value, as
+     * from that many /encrypt calls; the default packs slot_count values per
+     * ciphertext, as /encrypt_vector does on a single thread
+     * 
+     * Request body (JSON):
+     * {
+     *   "values": [42.5, 17, ...],
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "batch_size": 1,         // optional, values per ciphertext (default and most: slot_count)
+     *   "profile": "sum-fast",   // optional, see /encrypt
+     *   "compression": "zlib",   // optional, see /encrypt
+     *   "seeded": true,          // optional, see /encrypt
+     *   "public_key": "..."      // optional, or "public_key_fingerprint", see /encrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],
+     *   "count": 1000,
+     *   "batch_size": 1,
+     *   "threads": 8,            // compute threads the chunks were spread over
+     *   "profile": "default",
+     *   "execution_us": 1234,
+     *   "encrypt_us": 8765,      // encryption time summed over the threads
+     *   "compression": "zlib",
+     *   "raw_bytes": 393329,     // totals over all ciphertexts
+     *   "wire_bytes": 369780
+     * }
+     */
+    CROW_ROUTE(app, "/encrypt_bulk")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("values") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+            size_t batch_size = json_data.has("batch_size") ? static_cast<size_t>(json_data["batch_size"].u()) : 0;
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+
+            HomomorphicEncryption& he = encryption_he(req, json_data, scheme, seeded);
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::string> ciphertexts;
+            EncryptPipeline pipeline(he, wire, [&](std::string&& ct) { ciphertexts.push_back(std::move(ct)); },
+                                     compute_pool, seeded, 0, batch_size);
+            for (const auto& value : json_data["values"]) pipeline.push(value.d());
+            pipeline.finish();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count();
+
+            HE_LOG(Info) << "Bulk encryption | Scheme: " << scheme
+                         << " | Values: " << pipeline.value_count()
+                         << " | Ciphertexts: " << pipeline.ciphertext_count()
+                         << " | " << duration_us << " microseconds";
+
+            response["ciphertexts"] = std::move(ciphertexts);
+            response["count"] = pipeline.value_count();
+            response["batch_size"] = batch_size ? std::min(batch_size, he.slot_count()) : he.slot_count();
+            response["threads"] = compute_pool->size();
+            response["profile"] = he.parameter_profile().name;
             response["execution_us"] = duration_us;
+            response["encrypt_us"] = pipeline.encrypt_us();
+            report_client_key(response, json_data, he);
+            report_wire_sizes(response, wire);
             return crow::response(200, response);
+        } catch (const PublicKeyCache::UnknownFingerprint& e) {
+            response["error"] = e.what();
+            return crow::response(412, response);
         } catch (const std::exception& e) {
             response["error"] = e.what();
             return crow::response(500, response);
@@ -401,20 +966,31 @@ int main() {
      * Request body (JSON):
      * {
      *   "ciphertext": "base64_encoded_ciphertext", 
-     *   "scheme": "bfv" | "ckks"
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "profile": "sum-fast",    // optional, profile the ciphertext was encrypted under
+     *   "inspect": false,         // optional, skip the telemetry (the BFV noise budget
+     *                             // costs about one more decryption)
+     *   "slots": [0, 5]           // optional, return these slots' values instead of
+     *                             // "value" (no telemetry); a few are decoded one by one
      * }
      * 
+     * "value" is slot 0, decoded alone rather than by a full decode.
+     * 
      * Response (JSON):
      * {
-     *   "value": 42.5,
+     *   "value": 42.5,                        // "values": [42.5, 7] with "slots"
      *   "execution_us": 1234,
-     *   "ram_kb": 5678
+     *   "ram_kb": 5678,
+     *   "level": 0, "max_level": 1,           // chain index, 0 = last prime
+     *   "ciphertext_size": 2, "coeff_modulus_count": 1,
+     *   "noise_budget": 37                    // BFV: bits left before decryption fails
+     *   "scale": 1073741824, "scale_bits": 30 // CKKS instead of noise_budget
      * }
      */
     CROW_ROUTE(app, "/decrypt")
     .methods("POST"_method)
     ([&](const crow::request& req) {
-        auto json_data = crow::json::load(req.body);
+        auto json_data = parse_json(req.body_view());
         crow::json::wvalue response;
 
         // Validate required fields
@@ -425,19 +1001,29 @@ int main() {
 
         try {
             std::string scheme = json_data["scheme"].s();
-            std::string ciphertext = json_data["ciphertext"].s();
-            double value;
+            std::string_view ciphertext = json_view(json_data["ciphertext"]);
+            const bool sparse = json_data.has("slots");
+            bool inspect = !sparse && (!json_data.has("inspect") || json_data["inspect"].b());
+            std::vector<size_t> slots;
+            if (sparse) {
+                for (const auto& slot : json_data["slots"]) {
+                    if (slot.d() < 0) throw std::invalid_argument("Slot indices must not be negative");
+                    slots.push_back(static_cast<size_t>(slot.i()));
+                }
+            }
+            CiphertextInfo info;
+            double value = 0;
+            std::vector<double> values;
 
             // Start performance timing
             auto start = std::chrono::high_resolution_clock::now();
 
             // Perform decryption based on the specified scheme
-            if (scheme == "bfv") {
-                value = he_bfv.decrypt(ciphertext);
-            } else if (scheme == "ckks") {
-                value = he_ckks.decrypt(ciphertext);
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            if (sparse) {
+                values = he.decrypt_slots(ciphertext, slots, WireFormat::base64);
             } else {
-                throw std::runtime_error("Invalid scheme");
+                value = he.decrypt(ciphertext, WireFormat::base64, inspect ? &info : nullptr);
             }
 
             // Calculate execution time
@@ -445,31 +1031,14 @@ int main() {
             auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
             
             // Log operation details for monitoring
-            std::cout << "Decrypting | Scheme: " << scheme 
-                      << " | Ciphertext (first 20): " << log_cipher(ciphertext) << std::endl;
-
-            std::cout << "Decryption was done in " << duration_us << " microseconds\n";
-            std::cout << "Throughput: " << (1000000.0 / duration_us) << " operations per second\n";
-
-            // Measure current memory usage
-            size_t ram_kb = 0;
-
-            // Platform-specific memory measurement
-            #if defined(_WIN32)
-                // Windows memory measurement
-                PROCESS_MEMORY_COUNTERS memInfo;
-                GetProcessMemoryInfo(GetCurrentProcess(), &memInfo, sizeof(memInfo));
-                ram_kb = memInfo.WorkingSetSize / 1024;
-            #else
-                // Unix/Linux memory measurement
-                struct rusage usage;
-                getrusage(RUSAGE_SELF, &usage);
-                #ifdef __APPLE__
-                    ram_kb = usage.ru_maxrss / 1024;  // macOS returns bytes
-                #else
-                    ram_kb = usage.ru_maxrss;         // Linux returns KB
-                #endif
-            #endif
+            HE_LOG(Info) << "Decrypting | Scheme: " << scheme 
+                         << " | Ciphertext (first 20): " << log_cipher(ciphertext);
+
+            HE_LOG(Info) << "Decryption was done in " << duration_us << " microseconds";
+            HE_LOG(Info) << "Throughput: " << (1000000.0 / duration_us) << " operations per second";
+
+            // Measure current (not peak) memory usage
+            size_t ram_kb = metrics::resident_memory_bytes() / 1024;
 
             // Include memory usage in response
             response["ram_kb"] = ram_kb;
@@ -479,48 +1048,72 @@ int main() {
             print_session_end();  // End of session after 2 encryptions + 1 decryption
 
             // Prepare response with decrypted value and performance metrics
-            response["value"] = value;
+            if (sparse) {
+                response["values"] = values;
+            } else {
+                response["value"] = value;
+            }
             response["execution_us"] = duration_us;
+            if (inspect) report_ciphertext_info(response, info);
             return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
         } catch (const std::exception& e) {
             response["error"] = e.what();
             return crow::response(500, response);
         }
     });
 
-    // ========================================
-    // KEY DISTRIBUTION ENDPOINT
-    // ========================================
-
     /**
-     * Public Key Endpoint
-     * GET /public_key?scheme=bfv|ckks
+     * Ciphertext Telemetry Endpoint
+     * POST /admin/inspect
      * 
-     * Returns the public key for the specified encryption scheme
-     * Allows clients to encrypt data without access to private keys
+     * Reports how much a ciphertext has left without decrypting it: level,
+     * size and, for BFV, the invariant noise budget (CKKS: the scale). Use it
+     * to check that a result still decrypts after more operations or after
+     * compaction ("compact_result") before picking smaller parameters.
      * 
-     * Query parameters:
-     * - scheme: "bfv" or "ckks"
+     * Request body (JSON):
+     * {
+     *   "ciphertext": "base64_encoded_ciphertext",
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "profile": "sum-fast"     // optional, profile the ciphertext was encrypted under
+     * }
      * 
      * Response (JSON):
      * {
-     *   "public_key": "base64_encoded_public_key"
+     *   "profile": "default",
+     *   "poly_modulus_degree": 8192,
+     *   "level": 2, "max_level": 2, "ciphertext_size": 2, "coeff_modulus_count": 3,
+     *   "noise_budget": 146,                  // BFV
+     *   "scale": 1073741824, "scale_bits": 30 // CKKS instead of noise_budget
+     *   "raw_bytes": 393329                   // uncompressed SEAL size
      * }
      */
-    CROW_ROUTE(app, "/public_key")
-    .methods("GET"_method)
+    CROW_ROUTE(app, "/admin/inspect")
+    .methods("POST"_method)
     ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
         crow::json::wvalue response;
+
+        if (!json_data || !json_data.has("ciphertext") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
         try {
-            std::string scheme = req.url_params.get("scheme");
-            if (scheme == "bfv") {
-                response["public_key"] = he_bfv.serialize_public_key();
-            } else if (scheme == "ckks") {
-                response["public_key"] = he_ckks.serialize_public_key();
-            } else {
-                throw std::runtime_error("Invalid scheme");
-            }
+            std::string scheme = json_data["scheme"].s();
+            const HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            seal::Ciphertext ciphertext = he.deserialize(json_view(json_data["ciphertext"]));
+            response["profile"] = he.parameter_profile().name;
+            response["poly_modulus_degree"] = he.parameter_profile().poly_modulus_degree;
+            report_ciphertext_info(response, he.inspect(ciphertext));
+            response["raw_bytes"] = static_cast<size_t>(ciphertext.save_size(seal::compr_mode_type::none));
             return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
         } catch (const std::exception& e) {
             response["error"] = e.what();
             return crow::response(500, response);
@@ -528,30 +1121,2153 @@ int main() {
     });
 
     // ========================================
-    // CORS PREFLIGHT ENDPOINT
+    // BINARY TRANSPORT ENDPOINTS
     // ========================================
 
     /**
-     * CORS Preflight Handler
-     * OPTIONS /
+     * Binary Encryption Endpoint
+     * POST /binary/encrypt?scheme=bfv|ckks|bgv&value=42.5[&compression=none|zlib|zstd][&seeded=1][&profile=...]
      * 
-     * Handles CORS preflight requests for cross-origin API access
-     * Required for web frontend applications
+     * Same as /encrypt, but returns the raw SEAL ciphertext bytes
+     * (Content-Type: application/octet-stream) instead of Base64 inside JSON;
+     * sizes are reported in X-HE-Compression / X-HE-Raw-Bytes / X-HE-Wire-Bytes,
+     * the profile in X-HE-Profile
      */
-    CROW_ROUTE(app, "/")
-    .methods("OPTIONS"_method)
-    ([](const crow::request& req, crow::response& res) {
-        res.code = 200;
-        res.end();
+    CROW_ROUTE(app, "/binary/encrypt")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            const char* value_param = req.url_params.get("value");
+            if (!scheme_param || !value_param) {
+                response["error"] = "Missing required fields";
+                return crow::response(400, response);
+            }
+            std::string scheme = scheme_param;
+            double value = std::strtod(value_param, nullptr);
+            bool seeded = req.url_params.get("seeded") != nullptr;
+            WireStats stats;
+            WireOptions wire(WireFormat::binary,
+                             request_compression(req.url_params.get("compression"), default_compression), &stats);
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(req.url_params));
+            std::string ciphertext = seeded ? he.encrypt_symmetric(value, wire) : he.encrypt(value, wire);
+            crow::response res = binary_response(std::move(ciphertext));
+            res.set_header("X-HE-Profile", he.parameter_profile().name);
+            report_wire_sizes(res, wire);
+            return res;
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
     });
 
-    // ========================================
-    // SERVER STARTUP
-    // ========================================
-    // Start the HTTP server on port 18081 with multithreading support
-    // Port 18081 is used to avoid conflicts with the main backend (18080)
-    std::cout << "Starting mini-backend on port 18081...\n";
+    /**
+     * Binary Bulk Encryption Endpoint
+     * POST /binary/encrypt_bulk?scheme=bfv|ckks|bgv[&batch_size=N][&compression=...][&seeded=1][&profile=...]
+     * 
+     * Same as /encrypt_bulk for a binary client: the request body is the
+     * values as little-endian float64, the response body the ciphertexts,
+     * framed in input order (see BinaryFraming.h); each frame is appended as
+     * its chunk finishes. X-HE-Count holds the value count, X-HE-Profile the
+     * profile
+     */
+    CROW_ROUTE(app, "/binary/encrypt_bulk")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            const char* batch_param = req.url_params.get("batch_size");
+            if (!scheme_param) {
+                response["error"] = "Missing required fields";
+                return crow::response(400, response);
+            }
+            const std::string_view body_bytes = req.body_view();
+            if (body_bytes.size() % sizeof(double) != 0) {
+                response["error"] = "Body must be float64 values";
+                return crow::response(400, response);
+            }
+            std::string scheme = scheme_param;
+            bool seeded = req.url_params.get("seeded") != nullptr;
+            size_t batch_size = batch_param ? static_cast<size_t>(std::strtoull(batch_param, nullptr, 10)) : 0;
+            WireStats stats;
+            WireOptions wire(WireFormat::binary,
+                             request_compression(req.url_params.get("compression"), default_compression), &stats);
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(req.url_params));
+            // Numbers arrive in host byte order, which is little-endian on the supported targets
+            std::vector<double> values(body_bytes.size() / sizeof(double));
+            std::memcpy(values.data(), body_bytes.data(), body_bytes.size());
+            const size_t per_ciphertext = batch_size ? std::min(batch_size, he.slot_count()) : he.slot_count();
+
+            std::string body;
+            framing::put_uint(body, (values.size() + per_ciphertext - 1) / per_ciphertext, 4);
+            EncryptPipeline pipeline(he, wire, [&](std::string&& ct) {
+                framing::put_uint(body, ct.size(), 8);
+                body.append(ct);
+            }, compute_pool, seeded, 0, per_ciphertext);
+            pipeline.push(values.data(), values.size());
+            pipeline.finish();
+
+            crow::response res = binary_response(std::move(body));
+            res.set_header("X-HE-Count", std::to_string(values.size()));
+            res.set_header("X-HE-Profile", he.parameter_profile().name);
+            report_wire_sizes(res, wire);
+            return res;
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Binary Decryption Endpoint
+     * POST /binary/decrypt?scheme=bfv|ckks|bgv[&profile=...]
+     * 
+     * Request body: raw SEAL ciphertext bytes (application/octet-stream)
+     * 
+     * Response (JSON):
+     * {
+     *   "value": 42.5
+     * }
+     */
+    CROW_ROUTE(app, "/binary/decrypt")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            response["value"] =
+                select_he(req, scheme, request_profile(req.url_params)).decrypt(req.body_view(), WireFormat::binary);
+            return crow::response(200, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Batched Binary Decryption Endpoint
+     * POST /binary/decrypt_batch?scheme=bfv|ckks|bgv[&slots=N][&type=float64|int64][&profile=...]
+     * 
+     * Decrypts many results (e.g. the per-group totals of a group-by or the bins
+     * of a histogram) in one request, spread over the compute threads
+     * 
+     * Request body: framed [cipher1, cipher2, ...] (see BinaryFraming.h)
+     * 
+     * Response body (application/octet-stream): count * slots little-endian
+     * values, ciphertext by ciphertext, each ciphertext's first slots slots
+     * (default: all of them). type defaults to int64 for BFV and BGV, whose
+     * slots are exact integers, and float64 for CKKS (int64 rounds). X-HE-Count,
+     * X-HE-Slots and X-HE-Value-Type describe the array
+     */
+    CROW_ROUTE(app, "/binary/decrypt_batch")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            const char* slots_param = req.url_params.get("slots");
+            const char* type_param = req.url_params.get("type");
+            std::string scheme = scheme_param ? scheme_param : "";
+            std::string type = type_param ? type_param : (scheme == "ckks" ? "float64" : "int64");
+            if (type != "float64" && type != "int64") {
+                response["error"] = "Invalid type: " + type;
+                return crow::response(400, response);
+            }
+            size_t slots = slots_param ? static_cast<size_t>(std::strtoull(slots_param, nullptr, 10)) : 0;
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(req.url_params));
+            CiphertextViews ciphertexts = framing::unframe(req.body_view());
+            if (slots == 0) slots = he.slot_count();
+
+            // Numbers are sent in host byte order, which is little-endian on the supported targets
+            std::string body;
+            if (type == "int64") {
+                std::vector<int64_t> values = he.decrypt_batch_integers(ciphertexts, WireFormat::binary, slots);
+                body.assign(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int64_t));
+            } else {
+                std::vector<double> values = he.decrypt_batch(ciphertexts, WireFormat::binary, slots);
+                body.assign(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+            }
+            crow::response res = binary_response(std::move(body));
+            res.set_header("X-HE-Count", std::to_string(ciphertexts.size()));
+            res.set_header("X-HE-Slots", std::to_string(slots));
+            res.set_header("X-HE-Value-Type", type);
+            return res;
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // BATCHED (SLOT-PACKED) ENDPOINTS
+    // ========================================
+
+    /**
+     * Batched Encryption Endpoint
+     * POST /encrypt_vector
+     * 
+     * Encrypts a whole vector of values, packing slot_count values per ciphertext
+     * (8192 for BFV, 4096 for CKKS) instead of one value per ciphertext
+     * 
+     * Request body (JSON):
+     * {
+     *   "values": [1.0, 2.0, 3.0, ...],
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "profile": "sum-fast",  // optional, see /encrypt
+     *   "compression": "zlib",  // optional, see /encrypt
+     *   "seeded": true,         // optional, see /encrypt
+     *   "public_key": "...",    // optional, or "public_key_fingerprint", see /encrypt
+     *   "prefix_sum": true,     // optional: chunk_size values per ciphertext, in its first
+     *                           // slots, for main-backend's /prefix_sum
+     *   "paired_values": [...], // optional, CKKS: a second column as long as "values", held
+     *                           // in the imaginary parts of the same slots (half the
+     *                           // ciphertexts for both); read back with /decrypt_vector's "paired"
+     *   "crt_moduli": 3,        // optional, BFV and BGV: integer values as residues modulo this
+     *                           // many plain moduli of the profile's size, so sums up to 63
+     *                           // bits stay exact; see "crt_profiles" below
+     *   "histogram": {          // optional: each value one-hot encoded into "buckets" slots
+     *     "min": 0, "width": 5, // (a power of two) for main-backend's /csv/histogram, e.g.
+     *     "buckets": 64         // "cumulative" for /decrypt_percentiles; values outside the
+     *   }                       // range count in the first or last bucket
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],
+     *   "crt_ciphertexts": [[...], ...],  // with "crt_moduli", instead of "ciphertexts": one
+     *                                     // array per modulus, to be summed under the
+     *   "crt_profiles": ["default-crt3-0", ...],  // profile of the same index; read back
+     *                                     // with /decrypt_vector's "crt_ciphertexts"
+     *   "count": 3,
+     *   "slot_count": 8192,
+     *   "chunk_size": 2048,     // with "prefix_sum"
+     *   "bucket_count": 64,     // with "histogram"
+     *   "profile": "default",
+     *   "execution_us": 1234,
+     *   "compression": "zlib",
+     *   "raw_bytes": 393329,    // totals over all ciphertexts
+     *   "wire_bytes": 369780
+     * }
+     */
+    CROW_ROUTE(app, "/encrypt_vector")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("values") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            std::vector<double> values;
+            values.reserve(json_data["values"].size());
+            for (const auto& val : json_data["values"]) {
+                values.push_back(val.d());
+            }
+            bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+
+            std::vector<double> paired_values;
+            const bool paired = json_data.has("paired_values");
+            if (paired) {
+                for (const auto& val : json_data["paired_values"]) paired_values.push_back(val.d());
+            }
+
+            if (json_data.has("crt_moduli")) {
+                if (paired || json_data.has("prefix_sum") || json_data.has("public_key") ||
+                    json_data.has("public_key_fingerprint")) {
+                    throw std::invalid_argument("crt_moduli takes no paired_values, prefix_sum or public key");
+                }
+                auto start = std::chrono::high_resolution_clock::now();
+                auto crt = crt_engines(req, json_data, scheme, static_cast<size_t>(json_data["crt_moduli"].u()));
+                std::vector<crow::json::wvalue> residues;
+                std::vector<std::string> names;
+                for (size_t i = 0; i < crt.first.size(); i++) {
+                    HomomorphicEncryption& he = *crt.first[i];
+                    std::vector<double> residue = crt.second.residues(values, i);
+                    residues.emplace_back();
+                    residues.back() = seeded ? he.encrypt_vector_symmetric(residue, wire)
+                                             : he.encrypt_vector(residue, wire);
+                    names.push_back(he.parameter_profile().name);
+                }
+                auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - start).count();
+
+                HE_LOG(Info) << "Batched CRT encryption | Scheme: " << scheme
+                             << " | Values: " << values.size()
+                             << " | Moduli: " << names.size()
+                             << " | " << duration_us << " microseconds";
+
+                response["crt_ciphertexts"] = std::move(residues);
+                response["crt_profiles"] = names;
+                response["count"] = values.size();
+                response["slot_count"] = crt.first[0]->slot_count();
+                response["profile"] = crt.first[0]->parameter_profile().name;
+                response["execution_us"] = duration_us;
+                report_wire_sizes(response, wire);
+                return crow::response(200, response);
+            }
+
+            HomomorphicEncryption* he = &encryption_he(req, json_data, scheme, seeded);
+            const bool prefix_sum = json_data.has("prefix_sum") && json_data["prefix_sum"].b();
+            if (prefix_sum && paired) throw std::invalid_argument("prefix_sum cannot be paired");
+            const bool histogram = json_data.has("histogram");
+            if (histogram && (paired || prefix_sum)) {
+                throw std::invalid_argument("histogram cannot be paired or prefix_sum");
+            }
+            if (histogram) values = parse_buckets(json_data["histogram"]).one_hot(values);
+            if (prefix_sum) {
+                // Each chunk at the start of its own ciphertext, zeros after it
+                const size_t chunk = he->prefix_chunk_size();
+                std::vector<double> chunked;
+                for (size_t begin = 0; begin < values.size(); begin += chunk) {
+                    chunked.resize(begin / chunk * he->slot_count(), 0.0);
+                    chunked.insert(chunked.end(), values.begin() + begin,
+                                   values.begin() + std::min(values.size(), begin + chunk));
+                }
+                values.swap(chunked);
+            }
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::string> ciphertexts;
+            if (paired) {
+                ciphertexts = he->encrypt_vector_pair(values, paired_values, seeded, wire);
+            } else {
+                ciphertexts = seeded ? he->encrypt_vector_symmetric(values, wire) : he->encrypt_vector(values, wire);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Batched encryption | Scheme: " << scheme
+                         << " | Values: " << values.size()
+                         << " | Ciphertexts: " << ciphertexts.size()
+                         << " | " << duration_us << " microseconds";
+
+            response["ciphertexts"] = std::move(ciphertexts);
+            response["count"] = json_data["values"].size();
+            response["slot_count"] = he->slot_count();
+            if (prefix_sum) response["chunk_size"] = he->prefix_chunk_size();
+            if (histogram) response["bucket_count"] = json_data["histogram"]["buckets"].u();
+            response["profile"] = he->parameter_profile().name;
+            response["execution_us"] = duration_us;
+            report_client_key(response, json_data, *he);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const PublicKeyCache::UnknownFingerprint& e) {
+            response["error"] = e.what();
+            return crow::response(412, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Streaming Column Encryption Endpoint
+     * POST /csv/encrypt
+     * 
+     * Encrypts a CSV column straight from the file into packed ciphertexts.
+     * Rows are streamed into a slot buffer and each full batch is encrypted on
+     * the worker pool while the next one is read, so the column is never held
+     * as a whole (unlike /csv/read followed by /encrypt_vector)
+     * 
+     * Request body (JSON):
+     * {
+     *   "file_path": "path/to/file.csv",
+     *   "column_index": 9,
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "profile": "sum-fast",  // optional, see /encrypt
+     *   "compression": "zlib",  // optional, see /encrypt
+     *   "seeded": true,         // optional, see /encrypt
+     *   "public_key": "...",    // optional, or "public_key_fingerprint", see /encrypt
+     *   "shared_memory": true   // optional (--shm-handoff): see below
+     * }
+     * 
+     * Response (JSON): same fields as /encrypt_vector. With "shared_memory" the
+     * binary ciphertexts are left in a shared memory region for main-backend's
+     * PUT /shm/store instead, and "ciphertexts" is replaced by
+     *   "region": "/he-3f2a...",
+     *   "ciphertext_count": 3
+     */
+    CROW_ROUTE(app, "/csv/encrypt")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("file_path") || !json_data.has("column_index") ||
+            !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string file_path = json_data["file_path"].s();
+            int column_index = json_data["column_index"].i();
+            std::string scheme = json_data["scheme"].s();
+            bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+            bool shared_memory = json_data.has("shared_memory") && json_data["shared_memory"].b();
+            if (shared_memory && !shm_publisher) throw std::invalid_argument("shared_memory needs --shm-handoff");
+            WireStats stats;
+            WireOptions wire(shared_memory ? WireFormat::binary : WireFormat::base64,
+                             request_compression(json_data, default_compression), &stats);
+            if (column_index < 0) throw std::invalid_argument("Invalid column index");
+
+            HomomorphicEncryption* he = &encryption_he(req, json_data, scheme, seeded);
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::string> ciphertexts;
+            EncryptPipeline pipeline(*he, wire, [&](std::string&& ct) { ciphertexts.push_back(std::move(ct)); },
+                                     compute_pool, seeded);
+            stream_column(file_path, static_cast<size_t>(column_index), pipeline);
+            pipeline.finish();
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Streaming column encryption | Scheme: " << scheme
+                         << " | Values: " << pipeline.value_count()
+                         << " | Ciphertexts: " << pipeline.ciphertext_count()
+                         << " | " << duration_us << " microseconds";
+
+            if (shared_memory) {
+                response["region"] = shm_publisher->publish(ciphertexts);
+                response["ciphertext_count"] = ciphertexts.size();
+            } else {
+                response["ciphertexts"] = std::move(ciphertexts);
+            }
+            response["count"] = pipeline.value_count();
+            response["slot_count"] = he->slot_count();
+            response["profile"] = he->parameter_profile().name;
+            response["execution_us"] = duration_us;
+            report_client_key(response, json_data, *he);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const PublicKeyCache::UnknownFingerprint& e) {
+            response["error"] = e.what();
+            return crow::response(412, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Record Packing Endpoint
+     * POST /csv/encrypt_columns
+     * 
+     * Encrypts several numeric CSV columns of the same rows into one set of
+     * packed ciphertexts, for main-backend's /csv/column_sums to total them
+     * all in one pass: each row's columns are packed like a patient's
+     * features (see PatientPacking), block_size the column count rounded
+     * up to a power of two. Three columns cost one upload (about a quarter
+     * as many values per ciphertext), instead of three
+     * 
+     * Request body (JSON):
+     * {
+     *   "file_path": "path/to/file.csv",
+     *   "column_indices": [2, 9, 10],  // equal numeric row counts
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "layout": "feature_major",     // optional, default "sample_major"
+     *   "profile": "sum-fast",         // optional, see /encrypt
+     *   "compression": "zlib",         // optional, see /encrypt
+     *   "seeded": true,                // optional, see /encrypt
+     *   "public_key": "..."            // optional, or "public_key_fingerprint", see /encrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],
+     *   "count": 55500,                // rows
+     *   "columns": 3,
+     *   "layout": "sample_major",
+     *   "block_size": 4,
+     *   "rows_per_ciphertext": 1024,
+     *   "slot_count": 4096,
+     *   "profile": "default",
+     *   "execution_us": 1234,
+     *   "compression": "zlib",
+     *   "raw_bytes": 262270,
+     *   "wire_bytes": 246870
+     * }
+     */
+    CROW_ROUTE(app, "/csv/encrypt_columns")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("file_path") || !json_data.has("column_indices") ||
+            !json_data.has("scheme") || json_data["column_indices"].size() == 0) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string file_path = json_data["file_path"].s();
+            std::string scheme = json_data["scheme"].s();
+            PatientLayout layout = json_data.has("layout") ? parse_patient_layout(json_data["layout"].s())
+                                                           : PatientLayout::sample_major;
+            bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+
+            auto table = csv_cache.get(file_path);
+            std::vector<const std::vector<double>*> columns;
+            for (const auto& index : json_data["column_indices"]) {
+                if (index.i() < 0) throw std::invalid_argument("Invalid column index");
+                columns.push_back(&table->column(static_cast<size_t>(index.i())));
+                if (columns.back()->empty() || columns.back()->size() != columns.front()->size()) {
+                    throw std::invalid_argument("Column " + std::to_string(index.i()) +
+                                                " is not numeric or has another row count");
+                }
+            }
+            std::vector<std::vector<double>> rows(columns.front()->size(), std::vector<double>(columns.size()));
+            for (size_t r = 0; r < rows.size(); r++) {
+                for (size_t c = 0; c < columns.size(); c++) rows[r][c] = (*columns[c])[r];
+            }
+
+            HomomorphicEncryption* he = &encryption_he(req, json_data, scheme, seeded);
+            PatientPacking packing(layout, columns.size(), he->slot_count());
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<double> values = packing.pack(rows);
+            std::vector<std::string> ciphertexts = seeded ? he->encrypt_vector_symmetric(values, wire)
+                                                           : he->encrypt_vector(values, wire);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Record packing | Scheme: " << scheme
+                         << " | Rows: " << rows.size()
+                         << " | Columns: " << columns.size()
+                         << " | Layout: " << patient_layout_name(layout)
+                         << " | Ciphertexts: " << ciphertexts.size()
+                         << " | " << duration_us << " microseconds";
+
+            response["ciphertexts"] = std::move(ciphertexts);
+            response["count"] = rows.size();
+            response["columns"] = columns.size();
+            response["layout"] = patient_layout_name(layout);
+            response["block_size"] = packing.block_size();
+            response["rows_per_ciphertext"] = packing.patients_per_ciphertext();
+            response["slot_count"] = he->slot_count();
+            response["profile"] = he->parameter_profile().name;
+            response["execution_us"] = duration_us;
+            report_client_key(response, json_data, *he);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const PublicKeyCache::UnknownFingerprint& e) {
+            response["error"] = e.what();
+            return crow::response(412, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * End-to-end Analytics Pipeline (trusted deployments only)
+     * POST /pipeline
+     * 
+     * Runs encrypt -> aggregate -> decrypt in one call, the same work the
+     * frontend spreads over /encrypt, main-backend's /csv/sum and /decrypt, but
+     * without the network in between. Batches are encrypted on the worker pool
+     * while the request thread deserializes and adds the previous ones, so the
+     * stages overlap. The server sees the plaintext, so this is meant for
+     * measuring per-stage cost, not for untrusted hosts
+     * 
+     * Request body (JSON):
+     * {
+     *   "file_path": "path/to/file.csv",  // with "column_index", as in /csv/encrypt
+     *   "column_index": 9,
+     *   "values": [1.0, 2.0, 3.0],        // or inline values instead of a file
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "operation": "sum" | "average",   // optional, default "sum"
+     *   "packed": false,                  // optional, one value per ciphertext like /encrypt
+     *   "profile": "sum-fast",            // optional, see /encrypt
+     *   "compression": "zlib",            // optional, see /encrypt
+     *   "seeded": true                    // optional, see /encrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "result": 15.0,
+     *   "count": 5,
+     *   "ciphertexts": 1,
+     *   "timings_us": { "encrypt": ..., "aggregate": ..., "slot_sum": ...,
+     *                   "decrypt": ..., "total": ... },
+     *   "compression": "zlib", "raw_bytes": ..., "wire_bytes": ...
+     * }
+     * "encrypt" is worker time summed over batches, so with several threads it
+     * can exceed "total"; the other stages run on the request thread
+     */
+    CROW_ROUTE(app, "/pipeline")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("scheme") ||
+            !(json_data.has("values") || (json_data.has("file_path") && json_data.has("column_index")))) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            std::string operation = json_data.has("operation") ? std::string(json_data["operation"].s()) : "sum";
+            bool packed = !json_data.has("packed") || json_data["packed"].b();
+            bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::binary, request_compression(json_data, default_compression), &stats);
+            if (operation != "sum" && operation != "average") {
+                throw std::invalid_argument("Invalid operation: " + operation);
+            }
+
+            HomomorphicEncryption* he = &select_he(req, scheme, request_profile(json_data));
+
+            auto start = std::chrono::high_resolution_clock::now();
+            seal::Ciphertext total;
+            bool has_total = false;
+            int64_t aggregate_us = 0;
+            EncryptPipeline pipeline(*he, wire, [&](std::string&& ct) {
+                auto stage_start = std::chrono::high_resolution_clock::now();
+                seal::Ciphertext next = he->deserialize(ct, WireFormat::binary);
+                if (has_total) {
+                    he->add_inplace(total, next);
+                } else {
+                    total = std::move(next);
+                    has_total = true;
+                }
+                auto stage_end = std::chrono::high_resolution_clock::now();
+                aggregate_us += std::chrono::duration_cast<std::chrono::microseconds>(stage_end - stage_start).count();
+            }, compute_pool, seeded, 0, packed ? 0 : 1);
+
+            if (json_data.has("values")) {
+                for (const auto& val : json_data["values"]) {
+                    pipeline.push(val.d());
+                }
+            } else {
+                int column_index = json_data["column_index"].i();
+                if (column_index < 0) throw std::invalid_argument("Invalid column index");
+                stream_column(json_data["file_path"].s(), static_cast<size_t>(column_index), pipeline);
+            }
+            pipeline.finish();
+            if (!has_total) throw std::invalid_argument("No values to aggregate");
+
+            // Fold the slots of a packed sum into slot 0; unpacked ciphertexts only use slot 0
+            auto slot_start = std::chrono::high_resolution_clock::now();
+            if (packed) he->sum_slots_inplace(total);
+            auto slot_end = std::chrono::high_resolution_clock::now();
+
+            double result = he->decrypt(total);
+            if (operation == "average") result /= static_cast<double>(pipeline.value_count());
+            auto end = std::chrono::high_resolution_clock::now();
+
+            auto elapsed_us = [](auto from, auto to) {
+                return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+            };
+            HE_LOG(Info) << "Pipeline " << operation << " | Scheme: " << scheme
+                         << " | Values: " << pipeline.value_count()
+                         << " | Ciphertexts: " << pipeline.ciphertext_count()
+                         << " | " << elapsed_us(start, end) << " microseconds";
+
+            response["result"] = result;
+            response["count"] = pipeline.value_count();
+            response["ciphertexts"] = pipeline.ciphertext_count();
+            response["timings_us"]["encrypt"] = pipeline.encrypt_us();
+            response["timings_us"]["aggregate"] = aggregate_us;
+            response["timings_us"]["slot_sum"] = elapsed_us(slot_start, slot_end);
+            response["timings_us"]["decrypt"] = elapsed_us(slot_end, end);
+            response["timings_us"]["total"] = elapsed_us(start, end);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Batched Decryption Endpoint
+     * POST /decrypt_vector
+     * 
+     * Decrypts packed ciphertexts back into a flat vector of values
+     * 
+     * Request body (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "profile": "sum-fast",  // optional, see /decrypt
+     *   "count": 3,             // optional, trims the zero padding
+     *   "chunk_size": 2048,     // optional, only the first chunk_size slots of each
+     *                           // ciphertext (as /encrypt_vector's "prefix_sum" packs them)
+     *   "paired": true          // optional, CKKS: ciphertexts of /encrypt_vector's
+     *                           // "paired_values" (or sums of them); not with chunk_size
+     * }
+     * 
+     * With "crt_ciphertexts" (one array per modulus, as /encrypt_vector's "crt_moduli"
+     * returned them, or sums of them) instead of "ciphertexts", the residues are decrypted
+     * and recombined into exact integers; "profile" is the one they were encrypted for
+     * 
+     * Response (JSON):
+     * {
+     *   "values": [1.0, 2.0, 3.0],
+     *   "paired_values": [4.0, 5.0, 6.0],  // with "paired"
+     *   "execution_us": 1234
+     * }
+     */
+    CROW_ROUTE(app, "/decrypt_vector")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !(json_data.has("ciphertexts") || json_data.has("crt_ciphertexts")) ||
+            !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            size_t count = json_data.has("count") ? static_cast<size_t>(json_data["count"].u()) : 0;
+            if (json_data.has("crt_ciphertexts")) {
+                auto start = std::chrono::high_resolution_clock::now();
+                const auto& arrays = json_data["crt_ciphertexts"];
+                auto crt = crt_engines(req, json_data, scheme, arrays.size());
+                std::vector<std::vector<int64_t>> residues;
+                for (size_t i = 0; i < crt.first.size(); i++) {
+                    residues.push_back(crt.first[i]->decrypt_batch_integers(json_views(arrays[i])));
+                }
+                std::vector<int64_t> values = crt.second.combine(residues);
+                if (count && count < values.size()) values.resize(count);
+                auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - start).count();
+
+                response["values"] = values;
+                response["execution_us"] = duration_us;
+                return crow::response(200, response);
+            }
+            CiphertextViews ciphertexts = json_views(json_data["ciphertexts"]);
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            std::vector<double> values;
+            std::vector<double> paired_values;
+            const bool paired = json_data.has("paired") && json_data["paired"].b();
+            if (paired) {
+                if (json_data.has("chunk_size")) throw std::invalid_argument("chunk_size cannot be paired");
+                auto columns = he.decrypt_vector_pair(ciphertexts, count);
+                values = std::move(columns.first);
+                paired_values = std::move(columns.second);
+            } else if (json_data.has("chunk_size")) {
+                const size_t chunk = static_cast<size_t>(json_data["chunk_size"].u());
+                if (chunk == 0 || chunk > he.slot_count()) {
+                    throw std::invalid_argument("chunk_size must be between 1 and " + std::to_string(he.slot_count()));
+                }
+                std::vector<double> slots = he.decrypt_vector(ciphertexts);
+                for (size_t begin = 0; begin < slots.size(); begin += he.slot_count()) {
+                    values.insert(values.end(), slots.begin() + begin, slots.begin() + begin + chunk);
+                }
+                if (count && count < values.size()) values.resize(count);
+            } else {
+                values = he.decrypt_vector(ciphertexts, count);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Batched decryption | Scheme: " << scheme
+                         << " | Ciphertexts: " << ciphertexts.size()
+                         << " | " << duration_us << " microseconds";
+
+            response["values"] = values;
+            if (paired) response["paired_values"] = paired_values;
+            response["execution_us"] = duration_us;
+            return crow::response(200, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Refresh Endpoint
+     * POST /refresh
+     * 
+     * The key holder's half of main-backend's client-assisted refresh:
+     * decrypts /refresh/mask's masked ciphertexts and encrypts their values
+     * afresh, at the top of the chain, for /refresh/unmask. The values seen
+     * here are masked
+     * 
+     * Request body (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],  // masked_values, in order
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "profile": "default",   // optional, see /encrypt
+     *   "seeded": true,         // optional, secret-key encryption in seeded form (see /encrypt)
+     *   "compression": "zlib"   // optional, see /encrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],
+     *   "execution_us": 1234,
+     *   "compression": "zlib",
+     *   "raw_bytes": 262270,
+     *   "wire_bytes": 246870
+     * }
+     */
+    CROW_ROUTE(app, "/refresh")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("ciphertexts") || !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            CiphertextViews masked = json_views(json_data["ciphertexts"]);
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::string> ciphertexts;
+            ciphertexts.reserve(masked.size());
+            for (std::string_view ciphertext : masked) {
+                ciphertexts.push_back(he.refresh(he.deserialize(ciphertext), seeded, wire));
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Refresh | Scheme: " << scheme
+                         << " | Ciphertexts: " << ciphertexts.size()
+                         << " | " << duration_us << " microseconds";
+
+            response["ciphertexts"] = std::move(ciphertexts);
+            response["execution_us"] = duration_us;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Patient Packing Endpoint
+     * POST /ml/encrypt_patients
+     * 
+     * Encrypts feature rows of many patients per ciphertext for
+     * main-backend's /ml/logreg/predict: slots / block_size patients each,
+     * block_size the feature count rounded up to a power of two (8 diabetes
+     * features: 512 patients per ciphertext at N = 8192). "sample_major"
+     * keeps each patient's features together, "feature_major" each feature
+     * of all patients (see PatientPacking). With "labels" (feature_major), each
+     * patient's label is also encrypted into every feature slot of the
+     * patient, for main-backend's "logreg_gradient" job. With
+     * "centroid_count": k, each patient is instead repeated once per
+     * centroid (see CentroidPacking) for main-backend's /ml/kmeans/distances;
+     * its block then spans block_size * centroid_block slots
+     * 
+     * Request body (JSON):
+     * {
+     *   "patients": [[6, 148, 72, ...], [1, 85, 66, ...], ...],  // equal lengths
+     *   "scheme": "ckks",
+     *   "layout": "feature_major",  // optional, default "sample_major"
+     *   "labels": [1, 0, ...],      // optional, one per patient
+     *   "centroid_count": 3,        // optional, instead of "layout" and "labels"
+     *   "profile": "ml-inference",  // optional, see /encrypt
+     *   "compression": "zlib"       // optional, see /encrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],
+     *   "encrypted_labels": ["base64_encoded_ciphertext", ...],  // with "labels"
+     *   "count": 768,
+     *   "layout": "feature_major",
+     *   "block_size": 8,
+     *   "centroid_block": 4,        // with "centroid_count"
+     *   "patients_per_ciphertext": 1024,
+     *   "execution_us": 1234,
+     *   "compression": "zlib",
+     *   "raw_bytes": 262270,
+     *   "wire_bytes": 246870
+     * }
+     */
+    CROW_ROUTE(app, "/ml/encrypt_patients")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("patients") || !json_data.has("scheme") ||
+            json_data["patients"].size() == 0) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            PatientLayout layout = json_data.has("layout") ? parse_patient_layout(json_data["layout"].s())
+                                                           : PatientLayout::sample_major;
+            std::vector<std::vector<double>> patients;
+            patients.reserve(json_data["patients"].size());
+            for (const auto& row : json_data["patients"]) {
+                std::vector<double> features;
+                for (const auto& val : row) features.push_back(val.d());
+                patients.push_back(std::move(features));
+            }
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+
+            HomomorphicEncryption* he = &select_he(req, scheme, request_profile(json_data));
+            PatientPacking packing(layout, patients[0].size(), he->slot_count());
+            std::unique_ptr<CentroidPacking> repeated;
+            if (json_data.has("centroid_count")) {
+                if (json_data.has("layout") || json_data.has("labels")) {
+                    throw std::invalid_argument("centroid_count takes no layout or labels");
+                }
+                repeated = std::make_unique<CentroidPacking>(
+                    patients[0].size(), static_cast<size_t>(json_data["centroid_count"].u()), he->slot_count());
+            }
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::string> ciphertexts =
+                he->encrypt_vector(repeated ? repeated->pack(patients) : packing.pack(patients), wire);
+            if (json_data.has("labels")) {
+                if (layout != PatientLayout::feature_major) {
+                    throw std::invalid_argument("Labels need the feature_major layout");
+                }
+                if (json_data["labels"].size() != patients.size()) {
+                    throw std::invalid_argument("Expected one label per patient");
+                }
+                std::vector<std::vector<double>> labels;
+                labels.reserve(patients.size());
+                for (const auto& label : json_data["labels"]) labels.emplace_back(patients[0].size(), label.d());
+                response["encrypted_labels"] = he->encrypt_vector(packing.pack(labels), wire);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Patient packing | Scheme: " << scheme
+                         << " | Patients: " << patients.size()
+                         << " | Layout: " << patient_layout_name(layout)
+                         << " | Ciphertexts: " << ciphertexts.size()
+                         << " | " << duration_us << " microseconds";
+
+            response["ciphertexts"] = std::move(ciphertexts);
+            response["count"] = patients.size();
+            response["layout"] = patient_layout_name(layout);
+            response["block_size"] = packing.block_size();
+            response["patients_per_ciphertext"] = packing.patients_per_ciphertext();
+            if (repeated) {
+                response["centroid_block"] = repeated->centroid_block();
+                response["patients_per_ciphertext"] = repeated->patients_per_ciphertext();
+            }
+            response["execution_us"] = duration_us;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Patient Scores Endpoint
+     * POST /ml/decrypt_scores
+     * 
+     * Decrypts /ml/logreg/predict results and reads each patient's score
+     * from its slot in the layout the patients were packed with
+     * 
+     * Request body (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],  // "encrypted_results"
+     *   "scheme": "ckks",
+     *   "count": 768,               // patients, as /ml/encrypt_patients returned
+     *   "block_size": 8,            // likewise
+     *   "layout": "feature_major",  // optional, default "sample_major"
+     *   "profile": "ml-inference"   // optional, see /decrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "scores": [0.71, 0.08, ...],  // one per patient, in request order
+     *   "execution_us": 1234
+     * }
+     */
+    CROW_ROUTE(app, "/ml/decrypt_scores")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("ciphertexts") || !json_data.has("scheme") ||
+            !json_data.has("count") || !json_data.has("block_size")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            PatientLayout layout = json_data.has("layout") ? parse_patient_layout(json_data["layout"].s())
+                                                           : PatientLayout::sample_major;
+            size_t count = static_cast<size_t>(json_data["count"].u());
+            CiphertextViews ciphertexts = json_views(json_data["ciphertexts"]);
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            PatientPacking packing(layout, static_cast<size_t>(json_data["block_size"].u()), he.slot_count());
+            if (count > ciphertexts.size() * packing.patients_per_ciphertext()) {
+                throw std::invalid_argument("More patients than the ciphertexts hold");
+            }
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<double> scores = packing.scores(he.decrypt_vector(ciphertexts), count);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Patient scores | Scheme: " << scheme
+                         << " | Patients: " << count
+                         << " | Ciphertexts: " << ciphertexts.size()
+                         << " | " << duration_us << " microseconds";
+
+            response["scores"] = scores;
+            response["execution_us"] = duration_us;
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Centroid Assignment Endpoint
+     * POST /ml/kmeans/assign
+     * 
+     * Decrypts main-backend's /ml/kmeans/distances results and picks each
+     * patient's nearest centroid (the first on ties), for the key holder's
+     * k-means step: average the patients assigned to each centroid for the
+     * next iteration's centroids
+     * 
+     * Request body (JSON):
+     * {
+     *   "ciphertexts": ["base64_encoded_ciphertext", ...],  // "encrypted_results"
+     *   "scheme": "ckks",
+     *   "count": 768,               // patients, as /ml/encrypt_patients returned
+     *   "features": 8,              // as /ml/kmeans/distances returned
+     *   "centroid_count": 3,        // likewise
+     *   "distances": true,          // optional: also return every distance
+     *   "profile": "mult-depth-1"   // optional, see /decrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "assignments": [2, 0, ...], // nearest centroid per patient, in request order
+     *   "cluster_sizes": [301, 250, 217],
+     *   "distances": [[812.5, 40.1, 93.0], ...],  // with "distances"
+     *   "execution_us": 1234
+     * }
+     */
+    CROW_ROUTE(app, "/ml/kmeans/assign")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("ciphertexts") || !json_data.has("scheme") || !json_data.has("count") ||
+            !json_data.has("features") || !json_data.has("centroid_count")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            size_t count = static_cast<size_t>(json_data["count"].u());
+            CiphertextViews ciphertexts = json_views(json_data["ciphertexts"]);
+
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            CentroidPacking packing(static_cast<size_t>(json_data["features"].u()),
+                                    static_cast<size_t>(json_data["centroid_count"].u()), he.slot_count());
+            if (count > ciphertexts.size() * packing.patients_per_ciphertext()) {
+                throw std::invalid_argument("More patients than the ciphertexts hold");
+            }
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::vector<double>> distances = packing.distances(he.decrypt_vector(ciphertexts), count);
+            std::vector<size_t> assignments = CentroidPacking::nearest(distances);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Centroid assignment | Scheme: " << scheme
+                         << " | Patients: " << count
+                         << " | Centroids: " << packing.centroid_count()
+                         << " | Ciphertexts: " << ciphertexts.size()
+                         << " | " << duration_us << " microseconds";
+
+            std::vector<size_t> sizes(packing.centroid_count(), 0);
+            for (size_t centroid : assignments) sizes[centroid]++;
+            response["assignments"] = assignments;
+            response["cluster_sizes"] = sizes;
+            if (json_data.has("distances") && json_data["distances"].b()) {
+                std::vector<crow::json::wvalue> rows;
+                rows.reserve(distances.size());
+                for (const auto& row : distances) {
+                    rows.emplace_back();
+                    rows.back() = row;
+                }
+                response["distances"] = std::move(rows);
+            }
+            response["execution_us"] = duration_us;
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Linear Regression Solve Endpoint
+     * POST /ml/linreg/solve
+     * 
+     * Decrypts main-backend's /ml/linreg/aggregate result and solves the
+     * normal equations for a least-squares fit with an intercept (see
+     * NormalEquations): only the (d + 1) x (d + 1) system is decrypted,
+     * never a row
+     * 
+     * Request body (JSON):
+     * {
+     *   "ciphertext": "base64_encoded_ciphertext",  // "encrypted_result"
+     *   "scheme": "ckks",
+     *   "features": 3,              // as /ml/linreg/aggregate returned
+     *   "count": 55500,             // rows aggregated
+     *   "ridge": 0.1,               // optional L2 penalty, default 0
+     *   "profile": "mult-depth-2"   // optional, see /decrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "weights": [0.52, -1.3, 4.1],
+     *   "intercept": 12.5,
+     *   "r_squared": 0.83,
+     *   "execution_us": 1234
+     * }
+     */
+    CROW_ROUTE(app, "/ml/linreg/solve")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("ciphertext") || !json_data.has("scheme") ||
+            !json_data.has("features") || !json_data.has("count")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            const NormalEquations equations(static_cast<size_t>(json_data["features"].u()));
+            const size_t count = static_cast<size_t>(json_data["count"].u());
+            const double ridge = json_data.has("ridge") ? json_data["ridge"].d() : 0.0;
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            CiphertextViews ciphertexts{json_view(json_data["ciphertext"])};
+            std::vector<double> slots = he.decrypt_vector(ciphertexts, equations.terms().size());
+            NormalEquations::Fit fit = equations.solve(slots, count, ridge);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Linear regression solve | Scheme: " << scheme
+                         << " | Features: " << equations.feature_count()
+                         << " | Rows: " << count
+                         << " | " << duration_us << " microseconds";
+
+            response["weights"] = fit.weights;
+            response["intercept"] = fit.intercept;
+            response["r_squared"] = fit.r_squared;
+            response["execution_us"] = duration_us;
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Percentile Endpoint
+     * POST /decrypt_percentiles
+     * 
+     * Decrypts main-backend's /csv/histogram result with "cumulative" and
+     * reads percentiles off it (see HistogramBuckets): the median and any
+     * other percentiles of a column from one decryption, to within a bucket
+     * width. Only the cumulative bucket counts are decrypted, never a value
+     * 
+     * Request body (JSON):
+     * {
+     *   "ciphertext": "base64_encoded_ciphertext",  // "encrypted_result"
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "histogram": {"min": 0, "width": 5, "buckets": 64},  // as /encrypt_vector encoded it
+     *   "percentiles": [25, 50, 75],  // optional, default [50]
+     *   "profile": "sum-fast"         // optional, see /decrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "values": [31.2, 44.8, 61.0], // one per percentile
+     *   "count": 55500,               // values counted
+     *   "execution_us": 1234
+     * }
+     */
+    CROW_ROUTE(app, "/decrypt_percentiles")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("ciphertext") || !json_data.has("scheme") || !json_data.has("histogram")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            const HistogramBuckets buckets = parse_buckets(json_data["histogram"]);
+            std::vector<double> ranks;
+            if (json_data.has("percentiles")) {
+                for (const auto& rank : json_data["percentiles"]) ranks.push_back(rank.d());
+            } else {
+                ranks.push_back(50.0);
+            }
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(json_data));
+            if (buckets.count() > he.prefix_chunk_size()) {
+                throw std::invalid_argument("More buckets than the " + std::to_string(he.prefix_chunk_size()) +
+                                            " cumulative counts of a ciphertext");
+            }
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            CiphertextViews ciphertexts{json_view(json_data["ciphertext"])};
+            std::vector<double> cumulative = he.decrypt_vector(ciphertexts, buckets.count());
+            std::vector<double> values = buckets.percentiles(cumulative, ranks);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Percentiles | Scheme: " << scheme
+                         << " | Buckets: " << buckets.count()
+                         << " | Percentiles: " << ranks.size()
+                         << " | " << duration_us << " microseconds";
+
+            response["values"] = values;
+            response["count"] = std::llround(cumulative[buckets.count() - 1]);
+            response["execution_us"] = duration_us;
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Rollup Encryption Endpoint
+     * POST /rollup/encrypt
+     * 
+     * Totals a column by day, month and year and by a category in plaintext
+     * and encrypts the cell totals packed (see RollupCube.h), for
+     * main-backend's PUT /rollups, or for its POST /rollups/<handle>/append
+     * when the rows are a later batch. Only the ciphertexts holding cells
+     * the rows fall into are encrypted, so a day's batch costs one or two
+     * ciphertexts per granularity
+     * 
+     * Request body (JSON):
+     * {
+     *   "values": [18856.28, 33643.33, ...],
+     *   "dates": ["2024-01-31", "2019-08-20", ...],  // one per value, YYYY-MM-DD
+     *   "categories": ["Urgent", "Emergency", ...],  // optional, one per value
+     *   "category_values": ["Elective", "Emergency", "Urgent"],  // with "categories": every
+     *                                // category, in the same order for every batch
+     *   "origin_year": 2019,         // periods count from January 1 of this year
+     *   "granularities": ["month"],  // optional, default ["day", "month", "year"]
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "compression": "zlib",       // optional, see /encrypt
+     *   "seeded": true,              // optional, see /encrypt
+     *   "public_key": "..."          // optional, or "public_key_fingerprint", see /encrypt
+     * }
+     * 
+     * Response (JSON): the layout, and one cube per granularity
+     * {
+     *   "origin_year": 2019,
+     *   "category_values": ["Elective", "Emergency", "Urgent"],
+     *   "cubes": [{
+     *     "granularity": "month",
+     *     "chunks": [0],             // indices of the cube's ciphertexts
+     *     "ciphertexts": ["..."],    // their cell totals
+     *     "cells": [0, 1, 2, ...],   // cells the rows fall into
+     *     "counts": [310, 295, ...]  // and their row counts
+     *   }, ...],
+     *   "count": 55500,
+     *   "slot_count": 8192,
+     *   "execution_us": 1234,
+     *   "compression": "zlib",
+     *   "raw_bytes": 393329,         // totals over all ciphertexts
+     *   "wire_bytes": 369780
+     * }
+     */
+    CROW_ROUTE(app, "/rollup/encrypt")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("values") || !json_data.has("dates") || !json_data.has("origin_year") ||
+            !json_data.has("scheme")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            std::vector<double> values;
+            std::vector<std::string> dates, categories, category_values;
+            for (const auto& val : json_data["values"]) values.push_back(val.d());
+            for (const auto& date : json_data["dates"]) dates.push_back(date.s());
+            if (json_data.has("categories")) {
+                for (const auto& category : json_data["categories"]) categories.push_back(category.s());
+                if (!json_data.has("category_values")) throw std::invalid_argument("categories need category_values");
+            }
+            if (json_data.has("category_values")) {
+                for (const auto& category : json_data["category_values"]) category_values.push_back(category.s());
+            }
+            std::vector<RollupGranularity> granularities;
+            if (json_data.has("granularities")) {
+                for (const auto& name : json_data["granularities"]) {
+                    granularities.push_back(parse_rollup_granularity(name.s()));
+                }
+            } else {
+                granularities = {RollupGranularity::day, RollupGranularity::month, RollupGranularity::year};
+            }
+            if (json_data.has("profile")) throw std::invalid_argument("Rollups are kept under the default profile");
+            const int origin_year = static_cast<int>(json_data["origin_year"].i());
+            bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            HomomorphicEncryption& he = encryption_he(req, json_data, scheme, seeded);
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            const size_t slots = he.slot_count();
+            std::vector<crow::json::wvalue> cubes;
+            size_t ciphertext_count = 0;
+            for (RollupGranularity granularity : granularities) {
+                const RollupLayout layout(granularity, origin_year, category_values, slots);
+                std::map<size_t, RollupLayout::Cell> cells = layout.aggregate(values, dates, categories);
+
+                std::vector<size_t> chunks, cell_indices;
+                std::vector<uint64_t> counts;
+                std::vector<std::string> ciphertexts;
+                std::vector<double> totals;
+                for (auto cell = cells.begin(); cell != cells.end();) {
+                    // Every cell of this ciphertext, then the ciphertext
+                    const size_t chunk = cell->first / slots;
+                    totals.assign(slots, 0.0);
+                    for (; cell != cells.end() && cell->first / slots == chunk; ++cell) {
+                        totals[cell->first % slots] = cell->second.sum;
+                        cell_indices.push_back(cell->first);
+                        counts.push_back(cell->second.count);
+                    }
+                    chunks.push_back(chunk);
+                    ciphertexts.push_back(seeded ? he.encrypt_vector_symmetric(totals, wire)[0]
+                                                 : he.encrypt_vector(totals, wire)[0]);
+                }
+                ciphertext_count += ciphertexts.size();
+
+                crow::json::wvalue cube;
+                cube["granularity"] = rollup_granularity_name(granularity);
+                cube["chunks"] = chunks;
+                cube["ciphertexts"] = std::move(ciphertexts);
+                cube["cells"] = cell_indices;
+                cube["counts"] = counts;
+                cubes.push_back(std::move(cube));
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "Rollup encryption | Scheme: " << scheme
+                         << " | Values: " << values.size()
+                         << " | Ciphertexts: " << ciphertext_count
+                         << " | " << duration_us << " microseconds";
+
+            response["origin_year"] = origin_year;
+            response["category_values"] = category_values;
+            response["cubes"] = std::move(cubes);
+            response["count"] = values.size();
+            response["slot_count"] = slots;
+            response["execution_us"] = duration_us;
+            report_client_key(response, json_data, he);
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const PublicKeyCache::UnknownFingerprint& e) {
+            response["error"] = e.what();
+            return crow::response(412, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Private Set Intersection Query Endpoint
+     * POST /psi/query
+     * 
+     * Receiver side of an unbalanced private set intersection (see
+     * PrivateSetIntersection.h), e.g. which of this hospital's patient IDs
+     * another hospital's registry on main-backend holds. The IDs are
+     * cuckoo-hashed into query tables and each table's elements are
+     * encrypted at the source powers, for POST /psi/sets/<handle>/query.
+     * Nothing needs to be kept: /psi/decrypt rebuilds the placement from
+     * the same IDs
+     * 
+     * Request body (JSON):
+     * {
+     *   "ids": ["MRN-000123", "MRN-004711", ...],
+     *   "parameters": {"bundles": 4, "partition_size": 32, "window_bits": 2},  // those of
+     *                                // the set's PUT /psi/sets response; optional, default these
+     *   "compression": "zlib"        // optional, see /encrypt
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "batches": [["...", ...], ...],  // per table, bundles times source powers ciphertexts
+     *   "source_powers": [1, 2, 3, 4, 8, 12, 16, 32],
+     *   "profile": "auto-bfv-d3-p20-s128",
+     *   "ids": 20000,
+     *   "execution_us": 1234,
+     *   "compression": "zlib",
+     *   "raw_bytes": 393329,
+     *   "wire_bytes": 369780
+     * }
+     */
+    CROW_ROUTE(app, "/psi/query")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("ids")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            const PsiParameters parameters =
+                json_data.has("parameters") ? parse_psi_parameters(json_data["parameters"]) : PsiParameters();
+            std::vector<std::string> ids;
+            ids.reserve(json_data["ids"].size());
+            for (const auto& id : json_data["ids"]) ids.push_back(id.s());
+            WireStats stats;
+            WireOptions wire(WireFormat::base64, request_compression(json_data, default_compression), &stats);
+            HomomorphicEncryption& he = select_he(req, "bfv", &parameters.profile());
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            const PsiReceiver receiver(parameters, he.slot_count(), he.plain_modulus(), ids);
+            std::vector<crow::json::wvalue> batches;
+            size_t ciphertext_count = 0;
+            for (size_t batch = 0; batch < receiver.batch_count(); batch++) {
+                std::vector<std::string> ciphertexts;
+                for (const auto& values : receiver.query(batch)) {
+                    ciphertexts.push_back(he.encrypt_vector_symmetric(values, wire)[0]);
+                }
+                ciphertext_count += ciphertexts.size();
+                batches.emplace_back();
+                batches.back() = std::move(ciphertexts);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            HE_LOG(Info) << "PSI query | IDs: " << ids.size()
+                         << " | Batches: " << batches.size()
+                         << " | Ciphertexts: " << ciphertext_count
+                         << " | " << duration_us << " microseconds";
+
+            response["batches"] = std::move(batches);
+            response["source_powers"] = parameters.source_powers();
+            response["profile"] = he.parameter_profile().name;
+            response["ids"] = ids.size();
+            response["execution_us"] = duration_us;
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Private Set Intersection Result Endpoint
+     * POST /psi/decrypt
+     * 
+     * Decrypts main-backend's answer to a /psi/query and reports which IDs
+     * the server's set holds
+     * 
+     * Request body (JSON):
+     * {
+     *   "ids": ["MRN-000123", ...],  // the query's IDs, in the same order
+     *   "parameters": {...},         // optional, as for the query
+     *   "batches": [["...", ...], ...]  // POST /psi/sets/<handle>/query's "batches"
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "matches": [true, false, ...],  // one per ID
+     *   "matched": 1234,
+     *   "execution_us": 1234
+     * }
+     */
+    CROW_ROUTE(app, "/psi/decrypt")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("ids") || !json_data.has("batches")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            const PsiParameters parameters =
+                json_data.has("parameters") ? parse_psi_parameters(json_data["parameters"]) : PsiParameters();
+            std::vector<std::string> ids;
+            ids.reserve(json_data["ids"].size());
+            for (const auto& id : json_data["ids"]) ids.push_back(id.s());
+            HomomorphicEncryption& he = select_he(req, "bfv", &parameters.profile());
+
+            // Start performance timing
+            auto start = std::chrono::high_resolution_clock::now();
+            const PsiReceiver receiver(parameters, he.slot_count(), he.plain_modulus(), ids);
+            std::vector<std::vector<double>> results;
+            for (const auto& batch : json_data["batches"]) results.push_back(he.decrypt_batch(json_views(batch)));
+            std::vector<bool> matches = receiver.matches(results);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            const size_t matched = std::count(matches.begin(), matches.end(), true);
+            HE_LOG(Info) << "PSI decrypt | IDs: " << ids.size()
+                         << " | Matched: " << matched
+                         << " | " << duration_us << " microseconds";
+
+            std::vector<crow::json::wvalue> flags;
+            for (bool match : matches) flags.emplace_back(match);
+            response["matches"] = std::move(flags);
+            response["matched"] = matched;
+            response["execution_us"] = duration_us;
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // STREAMING ENDPOINT
+    // ========================================
+
+    /**
+     * Streaming Encryption WebSocket
+     * WS /ws/encrypt
+     * 
+     * Bulk encryption whose ciphertexts are sent as soon as each one is
+     * produced, instead of after the whole JSON response is built, so clients
+     * can start forwarding them to main-backend right away. Each text message
+     * on the socket starts one job; several jobs may run over one connection.
+     * 
+     * Job message (JSON), either a CSV column or explicit values:
+     * {
+     *   "op": "encrypt_column",       // "file_path" and "column_index" as in /csv/encrypt
+     *   "op": "encrypt_vector",       // "values" as in /encrypt_vector
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "profile": "sum-fast",        // optional, see /encrypt
+     *   "tenant": "st-marys",         // optional, as the X-Tenant-ID header of /encrypt
+     *   "compression": "zlib",        // optional, see /encrypt
+     *   "seeded": true,               // optional, see /encrypt
+     *   "binary": true                // optional, send raw SEAL bytes as binary frames
+     * }
+     * 
+     * Server messages, in order:
+     * { "index": 0, "ciphertext": "base64..." }     // one per ciphertext (or a binary frame)
+     * ...
+     * { "done": true, "count": 55500, "ciphertexts": 7, "slot_count": 8192, "profile": "default",
+     *   "execution_us": 1234, "compression": "zlib", "raw_bytes": ..., "wire_bytes": ... }
+     * or { "error": "..." } if the job fails
+     */
+    CROW_WEBSOCKET_ROUTE(app, "/ws/encrypt")
+    .onopen([&](crow::websocket::connection& conn) {
+        conn.userdata(new std::shared_ptr<WebSocketChannel>(std::make_shared<WebSocketChannel>(conn)));
+    })
+    .onclose([&](crow::websocket::connection& conn, const std::string& reason, uint16_t) {
+        auto* channel = static_cast<std::shared_ptr<WebSocketChannel>*>(conn.userdata());
+        (*channel)->mark_closed();  // Running jobs stop at their next send
+        delete channel;
+        conn.userdata(nullptr);
+    })
+    .onmessage([&](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
+        std::shared_ptr<WebSocketChannel> channel = *static_cast<std::shared_ptr<WebSocketChannel>*>(conn.userdata());
+
+        // Run the job off the I/O thread; the channel keeps it safe if the client leaves
+        stream_pool.submit([&, channel, data] {
+            metrics::EndpointScope scope("WS /ws/encrypt");
+            crow::json::wvalue response;
+            try {
+                auto json_data = crow::json::load(data);
+                if (!json_data || !json_data.has("op") || !json_data.has("scheme")) {
+                    throw std::invalid_argument("Missing required fields");
+                }
+                std::string op = json_data["op"].s();
+                std::string scheme = json_data["scheme"].s();
+                bool seeded = json_data.has("seeded") && json_data["seeded"].b();
+                bool binary = json_data.has("binary") && json_data["binary"].b();
+                WireStats stats;
+                WireOptions wire(binary ? WireFormat::binary : WireFormat::base64,
+                                 request_compression(json_data, default_compression), &stats);
+
+                // Sockets carry no per-message headers, so the tenant is a field of the job
+                std::shared_ptr<HomomorphicEncryption> tenant_engine;
+                if (json_data.has("tenant")) {
+                    tenant_engine = tenant_he(json_data["tenant"].s(), scheme, request_profile(json_data));
+                }
+                HomomorphicEncryption* he =
+                    tenant_engine ? tenant_engine.get() : &default_he(scheme, request_profile(json_data));
+
+                auto start = std::chrono::high_resolution_clock::now();
+                size_t index = 0;
+                EncryptPipeline pipeline(*he, wire, [&](std::string&& ct) {
+                    bool sent;
+                    if (binary) {
+                        sent = channel->send_binary(std::move(ct));
+                    } else {
+                        crow::json::wvalue message;
+                        message["index"] = index;
+                        message["ciphertext"] = std::move(ct);
+                        sent = channel->send_text(message.dump());
+                    }
+                    if (!sent) throw std::runtime_error("Client disconnected");
+                    index++;
+                }, compute_pool, seeded);
+
+                if (op == "encrypt_column") {
+                    if (!json_data.has("file_path") || !json_data.has("column_index") ||
+                        json_data["column_index"].i() < 0) {
+                        throw std::invalid_argument("Missing required fields");
+                    }
+                    stream_column(json_data["file_path"].s(), static_cast<size_t>(json_data["column_index"].i()),
+                                  pipeline);
+                } else if (op == "encrypt_vector") {
+                    if (!json_data.has("values")) throw std::invalid_argument("Missing required fields");
+                    for (const auto& val : json_data["values"]) {
+                        pipeline.push(val.d());
+                    }
+                } else {
+                    throw std::invalid_argument("Unknown op: " + op);
+                }
+                pipeline.finish();
+                auto end = std::chrono::high_resolution_clock::now();
+
+                response["done"] = true;
+                response["count"] = pipeline.value_count();
+                response["ciphertexts"] = pipeline.ciphertext_count();
+                response["slot_count"] = he->slot_count();
+                response["profile"] = he->parameter_profile().name;
+                response["execution_us"] = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+                report_wire_sizes(response, wire);
+            } catch (const std::exception& e) {
+                response = crow::json::wvalue();
+                response["error"] = e.what();
+            }
+            channel->send_text(response.dump());  // No-op if the client is gone
+        });
+    });
+
+    // ========================================
+    // KEY DISTRIBUTION ENDPOINT
+    // ========================================
+
+    /**
+     * Public Key Endpoint
+     * GET /public_key?scheme=bfv|ckks|bgv
+     * 
+     * Returns the public key for the specified encryption scheme
+     * Allows clients to encrypt data without access to private keys
+     * 
+     * Query parameters:
+     * - scheme: "bfv", "ckks" or "bgv"
+     * - profile: parameter profile (optional, see /encrypt)
+     * - compression: "none", "zlib", "zstd" or "bitpack" (optional, defaults to HE_COMPRESSION)
+     * 
+     * Response (JSON):
+     * {
+     *   "public_key": "base64_encoded_public_key",
+     *   "fingerprint": "9f86d0...",  // public_key_fingerprint, the same for every compression
+     *   "compression": "zlib",
+     *   "raw_bytes": 524401,
+     *   "wire_bytes": 529220
+     * }
+     * 
+     * The fingerprint is also the (weak) ETag: a client holding the key sends it
+     * back in If-None-Match and gets 304 Not Modified, without the key, until
+     * the key changes
+     */
+    CROW_ROUTE(app, "/public_key")
+    .methods("GET"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            const HomomorphicEncryption& he = select_he(req, scheme, request_profile(req.url_params));
+            const std::string fingerprint = he.public_key_fingerprint();
+            const std::string etag = "W/\"" + fingerprint + "\"";
+            const std::string& if_none_match = req.get_header_value("If-None-Match");
+            if (if_none_match == "*" || if_none_match.find(fingerprint) != std::string::npos) {
+                crow::response res(304);
+                res.set_header("ETag", etag);
+                return res;
+            }
+            WireStats stats;
+            WireOptions wire(WireFormat::base64,
+                             request_compression(req.url_params.get("compression"), default_compression), &stats);
+            response["public_key"] = he.serialize_public_key(wire);
+            response["fingerprint"] = fingerprint;
+            report_wire_sizes(response, wire);
+            crow::response res(200, response);
+            res.set_header("ETag", etag);
+            res.set_header("Cache-Control", "no-cache");  // Revalidate: keys can be regenerated
+            return res;
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Galois Keys Endpoint
+     * GET /galois_keys?scheme=bfv|ckks|bgv
+     * 
+     * Returns the power-of-two rotation keys needed for packed slot sums,
+     * to be installed on main-backend via POST /galois_keys
+     * 
+     * Query parameters:
+     * - scheme: "bfv", "ckks" or "bgv"
+     * - profile: parameter profile (optional, see /encrypt)
+     * - operations: only the keys these need, e.g. "slot_sum" without the matrix-vector
+     *   baby steps (optional, comma-separated, see --galois-operations)
+     * - compression: "none", "zlib", "zstd" or "bitpack" (optional, defaults to HE_COMPRESSION)
+     * 
+     * Response (JSON):
+     * {
+     *   "galois_keys": "base64_encoded_galois_keys",
+     *   "compression": "zlib",
+     *   "raw_bytes": 20517231,
+     *   "wire_bytes": 20637664
+     * }
+     */
+    CROW_ROUTE(app, "/galois_keys")
+    .methods("GET"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            WireStats stats;
+            WireOptions wire(WireFormat::base64,
+                             request_compression(req.url_params.get("compression"), default_compression), &stats);
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(req.url_params));
+            if (const char* operations_param = req.url_params.get("operations")) {
+                response["galois_keys"] =
+                    he.serialize_galois_keys(he.rotation_steps(split_names(operations_param)), wire);
+            } else {
+                response["galois_keys"] = he.serialize_galois_keys(wire);
+            }
+            report_wire_sizes(response, wire);
+            return crow::response(200, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Evaluation Keys Endpoint
+     * GET /binary/evaluation_keys?scheme=bfv|ckks|bgv[&profile=...]
+     * 
+     * Returns the relinearization and Galois keys for main-backend's
+     * POST /binary/evaluation_keys in seeded form, about half their size
+     * (see HomomorphicEncryption::serialize_evaluation_keys), as raw SEAL bytes
+     * compressed with zstd where SEAL has it
+     * 
+     * Response body (application/octet-stream): framed [relin_keys, galois_keys]
+     * (see BinaryFraming.h), a missing key as an empty payload; the expanded and
+     * sent sizes are in X-HE-Raw-Bytes / X-HE-Wire-Bytes, the profile in X-HE-Profile
+     */
+    CROW_ROUTE(app, "/binary/evaluation_keys")
+    .methods("GET"_method)
+    ([&](const crow::request& req) {
+        crow::json::wvalue response;
+        try {
+            const char* scheme_param = req.url_params.get("scheme");
+            std::string scheme = scheme_param ? scheme_param : "";
+            WireStats stats;
+            WireOptions wire(WireFormat::binary, seal::Serialization::compr_mode_default, &stats);
+            HomomorphicEncryption& he = select_he(req, scheme, request_profile(req.url_params));
+            crow::response res = binary_response(framing::frame(he.serialize_evaluation_keys(&stats)));
+            res.set_header("X-HE-Profile", he.parameter_profile().name);
+            report_wire_sizes(res, wire);
+            return res;
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    /**
+     * Parameter Profiles Endpoint
+     * GET /profiles
+     * 
+     * Lists the parameter profiles requests can name in "profile", smallest first;
+     * "depth" picks the first one whose depth is at least the requested one
+     * 
+     * Response (JSON):
+     * {
+     *   "default": "default",
+     *   "profiles": [
+     *     { "name": "sum-fast", "poly_modulus_degree": 4096, "coeff_modulus_bits": [54, 55],
+     *       "plain_modulus_bits": 20, "scale_bits": 30, "depth": 0, "special_primes": 1 },
+     *     ...
+     *   ]
+     * }
+     */
+    CROW_ROUTE(app, "/profiles")
+    .methods("GET"_method)
+    ([]() {
+        crow::json::wvalue response;
+        std::vector<crow::json::wvalue> list;
+        for (const auto& profile : profiles::all()) {
+            crow::json::wvalue entry;
+            entry["name"] = profile.name;
+            entry["poly_modulus_degree"] = profile.poly_modulus_degree;
+            entry["coeff_modulus_bits"] = profile.coeff_modulus_bits;
+            entry["plain_modulus_bits"] = profile.plain_modulus_bits;
+            entry["scale_bits"] = profile.scale_bits;
+            entry["depth"] = profile.depth;
+            entry["special_primes"] = profile.special_primes;
+            list.push_back(std::move(entry));
+        }
+        response["default"] = profiles::default_profile().name;
+        response["profiles"] = std::move(list);
+        return response;
+    });
+
+    /**
+     * Parameter Selection Endpoint
+     * POST /profiles/select
+     * 
+     * Picks the smallest degree and prime chain for a computation and predicts
+     * its cost; pass the returned name as "profile" to encrypt under it (or send
+     * the same requirement fields with the request itself)
+     * 
+     * Request body (JSON):
+     * {
+     *   "scheme": "bfv" | "ckks" | "bgv",
+     *   "depth": 3,               // sequential multiplications
+     *   "precision_bits": 20,     // CKKS bits after the binary point; BFV plaintext modulus bits
+     *   "integer_bits": 20,       // optional, CKKS bits before the binary point
+     *   "security": 128,          // optional, 128 | 192 | 256
+     *   "dnum": 2                 // optional, key switching digits (hybrid key switching)
+     * }
+     * 
+     * Response (JSON):
+     * {
+     *   "name": "auto-ckks-d3-p20-i20-s128",
+     *   "poly_modulus_degree": 8192,
+     *   "coeff_modulus_bits": [50, 30, 30, 30, 50],
+     *   "coeff_modulus_bit_count": 190,
+     *   "max_bit_count": 218,
+     *   "plain_modulus_bits": 0, "scale_bits": 30, "depth": 3, "security": 128,
+     *   "ciphertext_bytes": 524288,
+     *   "special_primes": 1, "key_switch_digits": 4, "key_switch_key_bytes": 2621440,
+     *   "relative_cost": { "add": 1.33, "multiply": 1.33, "key_switch": 1.67 }  // vs. "default"
+     * }
+     */
+    CROW_ROUTE(app, "/profiles/select")
+    .methods("POST"_method)
+    ([&](const crow::request& req) {
+        auto json_data = parse_json(req.body_view());
+        crow::json::wvalue response;
+
+        // Validate required fields
+        if (!json_data || !json_data.has("scheme") || !json_data.has("depth") || !json_data.has("precision_bits")) {
+            response["error"] = "Missing required fields";
+            return crow::response(400, response);
+        }
+
+        try {
+            std::string scheme = json_data["scheme"].s();
+            ParameterReport report = profiles::report(*request_profile(json_data), parse_scheme(scheme));
+            response["name"] = report.profile.name;
+            response["poly_modulus_degree"] = report.profile.poly_modulus_degree;
+            response["coeff_modulus_bits"] = report.profile.coeff_modulus_bits;
+            response["coeff_modulus_bit_count"] = report.coeff_modulus_bit_count;
+            response["max_bit_count"] = report.max_bit_count;
+            response["plain_modulus_bits"] = report.profile.plain_modulus_bits;
+            response["scale_bits"] = report.profile.scale_bits;
+            response["depth"] = report.profile.depth;
+            response["security"] = profiles::security_bits(report.profile.security);
+            response["ciphertext_bytes"] = report.ciphertext_bytes;
+            response["special_primes"] = report.profile.special_primes;
+            response["key_switch_digits"] = report.key_switch_digits;
+            response["key_switch_key_bytes"] = report.key_switch_key_bytes;
+            response["relative_cost"]["add"] = report.add_cost;
+            response["relative_cost"]["multiply"] = report.multiply_cost;
+            response["relative_cost"]["key_switch"] = report.key_switch_cost;
+            return crow::response(200, response);
+        } catch (const std::invalid_argument& e) {
+            response["error"] = e.what();
+            return crow::response(400, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(500, response);
+        }
+    });
+
+    // ========================================
+    // HEALTH ENDPOINT
+    // ========================================
+
+    /**
+     * Readiness
+     * GET /health
+     * 
+     * Which of the default profile's engines are keyed (and warmed up). The server
+     * listens while they are built, so an orchestrator can send a scheme its
+     * traffic as soon as that scheme is ready; requests for one still starting
+     * wait for it. Other profiles are built by their first request
+     * 
+     * Response (JSON):
+     * {
+     *   "status": "ok",                   // "starting" until every scheme is ready
+     *   "schemes": { "bfv": "ready", "ckks": "starting", "bgv": "ready" }
+     * }
+     */
+    CROW_ROUTE(app, "/health")
+    .methods("GET"_method)
+    ([&]() {
+        crow::json::wvalue response;
+        bool all_ready = true;
+        for (const char* scheme : default_schemes) {
+            const bool ready = registry.find(profiles::default_profile(), parse_scheme(scheme)) != nullptr;
+            response["schemes"][scheme] = ready ? "ready" : "starting";
+            all_ready = all_ready && ready;
+        }
+        response["status"] = all_ready ? "ok" : "starting";
+        return response;
+    });
+
+    // ========================================
+    // METRICS ENDPOINT
+    // ========================================
+
+    /**
+     * Prometheus Metrics
+     * GET /metrics
+     * 
+     * Request latency per endpoint and status, stage latency (encode, encrypt,
+     * serialize, decrypt, ...) per endpoint and scheme, current RSS and SEAL
+     * pool usage, in Prometheus text format
+     */
+    if (zero_pool) {
+        metrics::gauge("he_zero_pool_ciphertexts", "Precomputed encryptions of zero ready (default profile)",
+                       [&] {
+                           size_t ready = 0;
+                           for (const char* scheme : default_schemes) {
+                               auto he = registry.find(profiles::default_profile(), parse_scheme(scheme));
+                               if (he) ready += he->zero_pool_size();
+                           }
+                           return static_cast<double>(ready);
+                       });
+    }
+
+    /**
+     * CPU Profile Endpoint
+     * POST /admin/profile?seconds=10&frequency=99, then GET /admin/profile
+     * 
+     * Samples every thread's stack in the background while the process uses
+     * CPU; GET answers with the latest profile as collapsed stacks (text/plain)
+     * for flamegraph.pl or speedscope. See the same endpoint of main-backend
+     * and Profiler.h
+     */
+    CROW_ROUTE(app, "/admin/profile")
+    .methods("GET"_method, "POST"_method)
+    ([profile_max_s](const crow::request& req) {
+        crow::json::wvalue response;
+        if (profile_max_s == 0) {
+            response["error"] = "Profiling is disabled (--profile-max-s=0)";
+            return crow::response(404, response);
+        }
+        if (req.method == crow::HTTPMethod::GET) {
+            if (profiler::running()) {
+                response["running"] = true;
+                return crow::response(202, response);
+            }
+            std::shared_ptr<const profiler::Profile> profile = profiler::last();
+            if (!profile) {
+                response["error"] = "No profile taken yet (POST /admin/profile starts one)";
+                return crow::response(404, response);
+            }
+            crow::response res(200, profile->collapsed);
+            res.set_header("Content-Type", "text/plain");
+            res.set_header("X-HE-Samples", std::to_string(profile->samples));
+            res.set_header("X-HE-Dropped-Samples", std::to_string(profile->dropped));
+            return res;
+        }
+        try {
+            const char* seconds_param = req.url_params.get("seconds");
+            const char* frequency_param = req.url_params.get("frequency");
+            size_t seconds = seconds_param ? std::stoul(seconds_param) : 10;
+            size_t frequency = frequency_param ? std::stoul(frequency_param) : 99;
+            if (seconds == 0 || seconds > profile_max_s || frequency == 0 || frequency > 1000) {
+                response["error"] = "seconds must be 1 to " + std::to_string(profile_max_s) + ", frequency 1 to 1000";
+                return crow::response(400, response);
+            }
+            profiler::start(std::chrono::seconds(seconds), static_cast<unsigned>(frequency));
+            response["running"] = true;
+            response["seconds"] = seconds;
+            response["frequency"] = frequency;
+            return crow::response(202, response);
+        } catch (const std::logic_error&) {  // std::stoul: not a number, or out of range
+            response["error"] = "seconds and frequency must be numbers";
+            return crow::response(400, response);
+        } catch (const profiler::Busy& e) {
+            response["error"] = e.what();
+            return crow::response(409, response);
+        } catch (const std::exception& e) {
+            response["error"] = e.what();
+            return crow::response(501, response);
+        }
+    });
+
+    CROW_ROUTE(app, "/metrics")
+    .methods("GET"_method)
+    ([]() {
+        crow::response res(200, metrics::render());
+        res.set_header("Content-Type", "text/plain; version=0.0.4");
+        return res;
+    });
+
+    // ========================================
+    // CORS PREFLIGHT ENDPOINT
+    // ========================================
+
+    /**
+     * CORS Preflight Handler
+     * OPTIONS /
+     * 
+     * Handles CORS preflight requests for cross-origin API access
+     * Required for web frontend applications
+     */
+    CROW_ROUTE(app, "/")
+    .methods("OPTIONS"_method)
+    ([](const crow::request& req, crow::response& res) {
+        res.code = 200;
+        res.end();
+    });
+
+    // ========================================
+    // SERVER STARTUP
+    // ========================================
+    // Start the HTTP server on port 18081 (unless --port is given)
+    // Port 18081 is used to avoid conflicts with the main backend (18080)
+    std::cout << "Starting mini-backend on port " << port << "...\n";
+    std::cout << "I/O threads: " << io_threads << " | Compute threads: " << compute_pool->size()
+              << (compute_cpus.empty() ? "" : " (pinned)") << " | Stream threads: " << max_concurrent_streams << "\n";
+    std::cout << "SEAL kernels: " << cpu::seal_kernel_path() << "\n";
+    std::cout << "SEAL PRNG: " << cpu::seal_prng_path(prng_name(prng)) << "\n";
+    if (huge_pages.mode != seal::util::huge_page_mode::none) {
+        std::cout << "SEAL huge pages: " << huge_page_mode_name(huge_pages.mode) << " for blocks of "
+                  << (huge_pages.min_byte_count >> 10) << " KiB and more"
+                  << (huge_pages.numa_local ? ", NUMA-local" : "") << "\n";
+    }
     std::cout << "###########################\n"; 
 
-    app.port(18081).multithreaded().run();  // Blocks here until server is stopped
+    app.port(static_cast<uint16_t>(port)).concurrency(static_cast<uint16_t>(io_threads)).run();  // Blocks here until server is stopped
+    return 0;
+} catch (const std::invalid_argument& e) {
+    std::cerr << "mini-backend: " << e.what() << "\n";
+    return 2;
 }
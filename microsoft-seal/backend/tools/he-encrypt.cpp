@@ -0,0 +1,346 @@
+/**
+ * he-encrypt: encrypt CSV or Arrow columns on the ingestion side with he-client
+ *
+ * Packs the numeric cells of columns into ciphertexts under the server's
+ * public key. With --output, one column is written in the framed binary
+ * format of the /binary/... endpoints, e.g. for
+ *
+ *   curl --data-binary @column.bin -H 'Content-Type: application/octet-stream' \
+ *        'http://localhost:18080/binary/csv/sum?scheme=ckks&packed=1'
+ *
+ * With --output-dir, every column given is written as a packed column file
+ * (see ColumnFile.h), <name>.hecol after its header name, for main-backend's
+ * --column-dir: bulk onboarding of exports too large for any request. The
+ * input is read once, in a single pass for CSV, each column feeding its own
+ * pipeline on the shared encryption threads, and ciphertexts go to their
+ * files as they come out, so memory stays at a few ciphertexts per column
+ * and thread whatever the input's size. Every --checkpoint-every ciphertexts
+ * a column's file is flushed and its blocks noted in <name>.hecol.checkpoint;
+ * run again with the same options after an interruption, each column
+ * continues from its checkpoint, and columns already finished are skipped.
+ * A checkpoint of another input file (size or modification time), scheme,
+ * profile or compression is ignored.
+ *
+ * The public key is a file holding the "public_key" string of mini-backend's
+ * GET /public_key (--public-key), or the backends' key directory (--key-dir).
+ *
+ * Options (--name=value, or the HE_NAME environment variable):
+ *   --scheme (ckks), --profile, --public-key or --key-dir, --csv-file
+ *   (src/data/healthcare_dataset.csv) or --arrow-file, --csv-column (1), or
+ *   --columns (comma-separated header names or zero-based indices),
+ *   --threads (hardware threads), --compression (none, zlib or zstd; SEAL's
+ *   default for --output, none for --output-dir), --output (column.bin; not
+ *   stdout, which HomomorphicEncryption logs to) or --output-dir,
+ *   --checkpoint-every (64 ciphertexts), --progress-s (5; 0 = quiet)
+ */
+
+#include "ArrowFile.h"
+#include "ColumnFile.h"
+#include "CsvTable.h"
+#include "EncryptPipeline.h"
+#include "HeClient.h"
+#include "KeyStore.h"
+#include "ServerConfig.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::string read_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open " + path);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // Base64 has no whitespace, so a trailing newline (e.g. from jq -r) is not part of the key
+    std::string trim(std::string text) {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+        return text;
+    }
+
+    // Column indices for --columns entries, each a header name or an index
+    std::vector<size_t> resolve_columns(const std::string& list, const std::vector<std::string>& header) {
+        std::vector<size_t> indices;
+        std::stringstream entries(list);
+        for (std::string entry; std::getline(entries, entry, ',');) {
+            if (entry.empty()) continue;
+            auto named = std::find(header.begin(), header.end(), entry);
+            if (named != header.end()) {
+                indices.push_back(static_cast<size_t>(named - header.begin()));
+            } else if (std::all_of(entry.begin(), entry.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                indices.push_back(std::stoul(entry));
+            } else {
+                throw std::invalid_argument("No column named " + entry);
+            }
+            if (std::count(indices.begin(), indices.end(), indices.back()) > 1) indices.pop_back();
+        }
+        if (indices.empty()) throw std::invalid_argument("--columns names no column");
+        return indices;
+    }
+
+    // A file name main-backend's /columns endpoints accept: letters, digits, '-', '_' and '.'
+    std::string file_name(const std::vector<std::string>& header, size_t index) {
+        std::string name = index < header.size() ? header[index] : "";
+        for (char& c : name) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.') c = '_';
+        }
+        if (name.empty() || name[0] == '.' || name.size() > 200) name = "column" + std::to_string(index);
+        return name;
+    }
+
+    // One column on its way into a column file
+    struct ColumnJob {
+        size_t index = 0;   // In the input
+        std::string name;
+        std::string path;   // Of the finished file
+        size_t skip = 0;    // Values in the blocks resumed from a checkpoint
+        size_t seen = 0;    // Values scanned
+        size_t pushed = 0;  // Values pushed into the pipeline
+        size_t since_checkpoint = 0;
+        std::unique_ptr<ColumnFile::Writer> writer;
+        std::unique_ptr<EncryptPipeline> pipeline;
+        bool done = false;  // Finished by an earlier run
+    };
+
+    struct Progress {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point next;
+        std::chrono::seconds every;
+        size_t threads = 1;
+        size_t values = 0;
+        size_t ciphertexts = 0;
+        size_t bytes = 0;
+
+        double seconds() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // Ciphertexts per second, overall and per encryption thread
+        std::string rate() const {
+            double per_second = ciphertexts / std::max(seconds(), 1e-9);
+            std::ostringstream out;
+            out.setf(std::ios::fixed);
+            out.precision(1);
+            out << per_second << " ciphertexts/s, " << per_second / threads << " per thread";
+            return out.str();
+        }
+
+        void report() {
+            if (every.count() == 0 || std::chrono::steady_clock::now() < next) return;
+            next = std::chrono::steady_clock::now() + every;
+            std::cerr << "he-encrypt: " << values << " values, " << ciphertexts << " ciphertexts, "
+                      << (bytes >> 20) << " MB written in " << static_cast<long>(seconds()) << " s (" << rate()
+                      << ")" << std::endl;
+        }
+    };
+
+    /**
+     * What a checkpoint is valid for: the input file as it was, the column
+     * and everything that shapes the ciphertexts
+     */
+    std::string fingerprint(const std::string& input, size_t index, const std::string& scheme,
+                            const std::string& profile, seal::compr_mode_type compression, size_t slots) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(input, error);
+        auto mtime = std::filesystem::last_write_time(input, error).time_since_epoch().count();
+        std::ostringstream out;
+        out << "he-encrypt-checkpoint 1 input=" << input << " size=" << size << " mtime=" << mtime
+            << " column=" << index << " scheme=" << scheme << " profile=" << profile
+            << " compression=" << compr_mode_name(compression) << " slots=" << slots;
+        return out.str();
+    }
+
+    // Blocks of a checkpoint of this fingerprint; empty if there is none or it is of something else
+    std::vector<ColumnFile::Block> read_checkpoint(const std::string& path, const std::string& expected) {
+        std::vector<ColumnFile::Block> blocks;
+        std::ifstream in(path);
+        std::string line;
+        if (!std::getline(in, line) || line != expected) return blocks;
+        ColumnFile::Block block;
+        while (in >> block.offset >> block.size >> block.first_row >> block.rows) blocks.push_back(block);
+        return blocks;
+    }
+
+    // Replaced atomically, so an interrupted write leaves the previous checkpoint
+    void write_checkpoint(const std::string& path, const std::string& fingerprint,
+                          const std::vector<ColumnFile::Block>& blocks) {
+        std::string tmp_path = path + ".tmp";
+        {
+            std::ofstream out(tmp_path, std::ios::trunc);
+            out << fingerprint << "\n";
+            for (const auto& block : blocks) {
+                out << block.offset << " " << block.size << " " << block.first_row << " " << block.rows << "\n";
+            }
+            if (!out.flush()) throw std::runtime_error("Could not write " + tmp_path);
+        }
+        if (std::rename(tmp_path.c_str(), path.c_str()) != 0) throw std::runtime_error("Could not replace " + path);
+    }
+}
+
+int main(int argc, char** argv) try {
+    ServerConfig config(argc, argv);
+    const std::string scheme = config.get("scheme", "ckks");
+    const std::string profile_name = config.get("profile", "");
+    const std::string public_key_file = config.get("public-key", "");
+    const std::string key_dir = config.get("key-dir", "");
+    const std::string arrow_file = config.get("arrow-file", "");
+    const std::string csv_file = config.get("csv-file", "src/data/healthcare_dataset.csv");
+    const std::string column_list = config.get("columns", config.get("csv-column", "1"));
+    const size_t threads = config.get_size("threads", std::thread::hardware_concurrency());
+    const std::string output_dir = config.get("output-dir", "");
+    const seal::compr_mode_type compression = parse_compr_mode(config.get(
+        "compression", output_dir.empty() ? compr_mode_name(seal::Serialization::compr_mode_default) : "none"));
+    const std::string output = config.get("output", "column.bin");
+    const size_t checkpoint_every = std::max<size_t>(config.get_size("checkpoint-every", 64), 1);
+    const size_t progress_s = config.get_size("progress-s", 5);
+    config.check_unused();
+
+    const ParameterProfile& profile = profile_name.empty() ? profiles::default_profile() : profiles::get(profile_name);
+    std::unique_ptr<HeClient> client;
+    if (!public_key_file.empty()) {
+        client = std::make_unique<HeClient>(scheme, trim(read_file(public_key_file)), profile, threads, compression);
+    } else if (!key_dir.empty()) {
+        client = std::make_unique<HeClient>(scheme, KeyStore(key_dir, compression), profile, threads, compression);
+    } else {
+        throw std::invalid_argument("Either --public-key or --key-dir is required");
+    }
+
+    const std::string input = arrow_file.empty() ? csv_file : arrow_file;
+    std::unique_ptr<ArrowFile> arrow;
+    if (!arrow_file.empty()) arrow = std::make_unique<ArrowFile>(arrow_file);
+    const std::vector<std::string> header = arrow ? arrow->header() : CsvTable::read_header(csv_file);
+    const std::vector<size_t> indices = resolve_columns(column_list, header);
+
+    if (output_dir.empty()) {
+        if (indices.size() != 1) throw std::invalid_argument("Several columns need --output-dir");
+        std::vector<double> values;
+        if (arrow) {
+            arrow->scan_column(indices[0], [&](const double* run, size_t count) {
+                values.insert(values.end(), run, run + count);
+            });
+        } else {
+            values = CsvTable::load(csv_file)->column(indices[0]);
+        }
+        if (values.empty()) throw std::invalid_argument("Column " + std::to_string(indices[0]) + " has no numbers");
+
+        auto start = std::chrono::steady_clock::now();
+        WireStats stats;
+        std::ofstream out(output, std::ios::binary);
+        if (!out) throw std::runtime_error("Cannot write " + output);
+        const size_t ciphertexts = client->encrypt_column(values, out, &stats);
+        out.close();
+        if (!out) throw std::runtime_error("Failed to write " + output);
+        auto elapsed_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+        std::cerr << values.size() << " values -> " << ciphertexts << " ciphertexts, " << stats.wire_bytes
+                  << " bytes (" << stats.raw_bytes << " uncompressed) in " << elapsed_ms << " ms" << std::endl;
+        return 0;
+    }
+
+    std::filesystem::create_directories(output_dir);
+    const seal::SEALContext& context = *client->seal_context();
+    const size_t slots = client->slot_count();
+    Progress progress;
+    progress.every = std::chrono::seconds(progress_s);
+    progress.next = progress.start + progress.every;
+    progress.threads = std::max<size_t>(threads, 1);
+
+    // Resume each column from its checkpoint, or start it anew
+    std::vector<ColumnJob> jobs(indices.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+        ColumnJob& job = jobs[i];
+        job.index = indices[i];
+        job.name = file_name(header, job.index);
+        job.path = output_dir + "/" + job.name + ".hecol";
+        const std::string checkpoint_path = job.path + ".checkpoint";
+        const std::string print = fingerprint(input, job.index, scheme, profile.name, compression, slots);
+        std::vector<ColumnFile::Block> resume = read_checkpoint(checkpoint_path, print);
+        if (resume.empty() && std::filesystem::exists(job.path) && !std::filesystem::exists(checkpoint_path)) {
+            std::cerr << "he-encrypt: " << job.path << " exists, skipping column " << job.name << std::endl;
+            job.done = true;
+            continue;
+        }
+        try {
+            job.writer = std::make_unique<ColumnFile::Writer>(job.path, context, compression, slots, resume);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "he-encrypt: " << e.what() << "; starting column " << job.name << " over" << std::endl;
+            resume.clear();
+            job.writer = std::make_unique<ColumnFile::Writer>(job.path, context, compression, slots);
+        }
+        job.skip = job.writer->rows();
+        if (job.skip > 0) {
+            std::cerr << "he-encrypt: column " << job.name << " resumes after " << job.skip << " values" << std::endl;
+        }
+
+        // Ciphertexts come out in order; all but the column's last are full
+        job.pipeline = client->pipeline([&job, &progress, print, checkpoint_path, slots,
+                                         checkpoint_every](std::string&& ciphertext) {
+            const size_t rows = std::min(slots, job.pushed - (job.writer->rows() - job.skip));
+            job.writer->append(ciphertext, rows);
+            progress.ciphertexts++;
+            progress.bytes += ciphertext.size();
+            if (++job.since_checkpoint == checkpoint_every && rows == slots) {
+                write_checkpoint(checkpoint_path, print, job.writer->checkpoint());
+                job.since_checkpoint = 0;
+            }
+            progress.report();
+        });
+    }
+
+    // One pass over the input; values already in resumed blocks are skipped
+    auto push = [&](ColumnJob& job, const double* run, size_t count) {
+        size_t skipped = std::min(count, job.skip - std::min(job.skip, job.seen));
+        job.seen += count;
+        if (skipped == count) return;
+        job.pipeline->push(run + skipped, count - skipped);
+        job.pushed += count - skipped;
+        progress.values += count - skipped;
+    };
+    if (arrow) {
+        for (auto& job : jobs) {
+            if (job.done) continue;
+            arrow->scan_column(job.index, [&](const double* run, size_t count) { push(job, run, count); });
+        }
+    } else {
+        std::vector<size_t> pending;
+        std::vector<ColumnJob*> targets;
+        for (auto& job : jobs) {
+            if (job.done) continue;
+            pending.push_back(job.index);
+            targets.push_back(&job);
+        }
+        CsvTable::scan_columns(csv_file, pending,
+                               [&](size_t which, double value) { push(*targets[which], &value, 1); });
+    }
+
+    for (auto& job : jobs) {
+        if (job.done) continue;
+        job.pipeline->finish();
+        if (job.writer->blocks().empty()) {
+            throw std::invalid_argument("Column " + job.name + " has no numbers");
+        }
+        ColumnFile::Layout layout = job.writer->finish();
+        std::remove((job.path + ".checkpoint").c_str());
+        std::cerr << "he-encrypt: " << job.path << ": " << layout.rows << " values in " << layout.blocks
+                  << " ciphertexts" << std::endl;
+    }
+    std::cerr << "he-encrypt: " << progress.values << " values -> " << progress.ciphertexts << " ciphertexts, "
+              << progress.bytes << " bytes in " << static_cast<long>(progress.seconds() * 1000) << " ms ("
+              << progress.rate() << ")" << std::endl;
+    return 0;
+} catch (const std::exception& e) {
+    std::cerr << "he-encrypt: " << e.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,314 @@
+/**
+ * he-gen: synthetic healthcare datasets of any size, for scaling benchmarks
+ *
+ * Writes rows in the schema of src/data/healthcare_dataset.csv (same 15
+ * columns and distributions, see SyntheticHealthcare.h) as CSV (--csv), as
+ * an Arrow IPC file (--arrow) and as pre-encrypted column files
+ * (--output-dir, <name>.hecol per --columns entry, for main-backend's
+ * --column-dir), any of them in one run. Rows are generated and formatted in
+ * chunks of --chunk-rows on --threads threads, and written in order as they
+ * finish, so memory stays at a few chunks whatever --rows is; encryption
+ * runs on he-client's pipelines, on the same threads. Row i depends only on
+ * --seed and i, so the output does not depend on --threads, and a dataset
+ * can be generated in shards on several machines with --first-row, e.g.
+ *
+ *   he-gen --rows=100000000 --first-row=0 --csv=part0.csv
+ *   he-gen --rows=100000000 --first-row=100000000 --csv=part1.csv
+ *
+ * Arrow rather than Parquet: the backends read Arrow IPC files in place (see
+ * ArrowFile.h) and Parquet needs the Arrow C++ library; convert with
+ * pyarrow where Parquet is wanted. Text columns are utf8 and the dates
+ * date32 in the Arrow file, Age and Room Number int64, Billing Amount float64.
+ *
+ * Encrypted columns need the public key, as he-encrypt takes it: a file
+ * holding mini-backend's GET /public_key "public_key" string (--public-key)
+ * or the backends' key directory (--key-dir).
+ *
+ * Options (--name=value, or the HE_NAME environment variable):
+ *   --rows (1000000), --first-row (0), --seed (1), --csv, --arrow,
+ *   --output-dir, --columns (Age,Billing Amount,Room Number; names or
+ *   zero-based indices of numeric columns), --scheme (ckks), --profile,
+ *   --public-key or --key-dir, --compression (none), --threads (hardware
+ *   threads), --chunk-rows (65536), --progress-s (5; 0 = quiet)
+ */
+
+#include "ArrowFile.h"
+#include "ColumnFile.h"
+#include "EncryptPipeline.h"
+#include "HeClient.h"
+#include "KeyStore.h"
+#include "ServerConfig.h"
+#include "SyntheticHealthcare.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Synthetic = SyntheticHealthcare;
+    using ArrowType = ArrowFile::Writer::Type;
+
+    std::string read_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open " + path);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // Base64 has no whitespace, so a trailing newline (e.g. from jq -r) is not part of the key
+    std::string trim(std::string text) {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+        return text;
+    }
+
+    // Column indices for --columns entries, each a header name or an index of a numeric column
+    std::vector<size_t> resolve_columns(const std::string& list) {
+        const std::vector<std::string>& header = Synthetic::header();
+        std::vector<size_t> indices;
+        std::stringstream entries(list);
+        for (std::string entry; std::getline(entries, entry, ',');) {
+            if (entry.empty()) continue;
+            auto named = std::find(header.begin(), header.end(), entry);
+            size_t index = header.size();
+            if (named != header.end()) {
+                index = static_cast<size_t>(named - header.begin());
+            } else if (std::all_of(entry.begin(), entry.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                index = std::stoul(entry);
+            }
+            if (!Synthetic::is_numeric(index)) throw std::invalid_argument("No numeric column " + entry);
+            if (std::find(indices.begin(), indices.end(), index) == indices.end()) indices.push_back(index);
+        }
+        if (indices.empty()) throw std::invalid_argument("--columns names no column");
+        return indices;
+    }
+
+    // A file name main-backend's /columns endpoints accept: letters, digits, '-', '_' and '.'
+    std::string file_name(const std::string& column) {
+        std::string name = column;
+        for (char& c : name) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.') c = '_';
+        }
+        return name;
+    }
+
+    std::vector<ArrowFile::Writer::Field> arrow_fields() {
+        std::vector<ArrowFile::Writer::Field> fields;
+        for (size_t i = 0; i < Synthetic::column_count; i++) {
+            ArrowType type = ArrowType::utf8;
+            if (i == Synthetic::age || i == Synthetic::room_number) type = ArrowType::int64;
+            if (i == Synthetic::billing_amount) type = ArrowType::float64;
+            if (i == Synthetic::admission_date || i == Synthetic::discharge_date) type = ArrowType::date32;
+            fields.push_back({ Synthetic::header()[i], type });
+        }
+        return fields;
+    }
+
+    // The Arrow columns of a chunk, filled row by row
+    struct ArrowColumns {
+        std::vector<ArrowFile::Writer::Column> columns{ Synthetic::column_count };
+
+        ArrowColumns() {
+            for (auto& column : columns) column.offsets.push_back(0);
+        }
+
+        void text(size_t column, std::string_view value) {
+            columns[column].values += value;
+            columns[column].offsets.push_back(static_cast<int32_t>(columns[column].values.size()));
+        }
+
+        template <typename T>
+        void number(size_t column, T value) {
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            columns[column].values.append(bytes, sizeof(T));
+        }
+
+        void add(const Synthetic::Row& row) {
+            text(Synthetic::name, row.name);
+            number<int64_t>(Synthetic::age, row.age);
+            text(Synthetic::gender, row.gender);
+            text(Synthetic::blood_type, row.blood_type);
+            text(Synthetic::medical_condition, row.medical_condition);
+            number<int32_t>(Synthetic::admission_date, row.admission_day);
+            text(Synthetic::doctor, row.doctor);
+            text(Synthetic::hospital, row.hospital);
+            text(Synthetic::insurance_provider, row.insurance_provider);
+            number<double>(Synthetic::billing_amount, row.billing_amount);
+            number<int64_t>(Synthetic::room_number, row.room_number);
+            text(Synthetic::admission_type, row.admission_type);
+            number<int32_t>(Synthetic::discharge_date, row.discharge_day);
+            text(Synthetic::medication, row.medication);
+            text(Synthetic::test_results, row.test_results);
+        }
+    };
+
+    // One chunk of rows in every output's form
+    struct Chunk {
+        size_t rows = 0;
+        std::string csv;
+        ArrowFile::Writer::Batch arrow;
+        std::vector<std::vector<double>> values;  // Per encrypted column
+    };
+
+    // One column on its way into a column file
+    struct ColumnJob {
+        size_t index = 0;
+        std::string path;
+        size_t pushed = 0;
+        std::unique_ptr<ColumnFile::Writer> writer;
+        std::unique_ptr<EncryptPipeline> pipeline;
+    };
+}
+
+int main(int argc, char** argv) try {
+    ServerConfig config(argc, argv);
+    const size_t rows = config.get_size("rows", 1000000);
+    const size_t first_row = config.get_size("first-row", 0);
+    const size_t seed = config.get_size("seed", 1);
+    const std::string csv_path = config.get("csv", "");
+    const std::string arrow_path = config.get("arrow", "");
+    const std::string output_dir = config.get("output-dir", "");
+    const std::string column_list = config.get("columns", "Age,Billing Amount,Room Number");
+    const std::string scheme = config.get("scheme", "ckks");
+    const std::string profile_name = config.get("profile", "");
+    const std::string public_key_file = config.get("public-key", "");
+    const std::string key_dir = config.get("key-dir", "");
+    const seal::compr_mode_type compression = parse_compr_mode(config.get("compression", "none"));
+    const size_t threads = std::max<size_t>(config.get_size("threads", std::thread::hardware_concurrency()), 1);
+    const size_t chunk_rows = std::min<size_t>(std::max<size_t>(config.get_size("chunk-rows", 65536), 1), 1 << 24);
+    const size_t progress_s = config.get_size("progress-s", 5);
+    config.check_unused();
+
+    if (rows == 0) throw std::invalid_argument("--rows must be at least 1");
+    if (csv_path.empty() && arrow_path.empty() && output_dir.empty()) {
+        throw std::invalid_argument("Nothing to write: give --csv, --arrow or --output-dir");
+    }
+
+    // Encrypted outputs: one pipeline and column file per column
+    std::unique_ptr<HeClient> client;
+    std::vector<ColumnJob> jobs;
+    if (!output_dir.empty()) {
+        const ParameterProfile& profile =
+            profile_name.empty() ? profiles::default_profile() : profiles::get(profile_name);
+        if (!public_key_file.empty()) {
+            client = std::make_unique<HeClient>(scheme, trim(read_file(public_key_file)), profile, threads,
+                                                compression);
+        } else if (!key_dir.empty()) {
+            client = std::make_unique<HeClient>(scheme, KeyStore(key_dir, compression), profile, threads,
+                                                compression);
+        } else {
+            throw std::invalid_argument("--output-dir needs --public-key or --key-dir");
+        }
+        std::filesystem::create_directories(output_dir);
+        const size_t slots = client->slot_count();
+        const std::vector<size_t> indices = resolve_columns(column_list);
+        jobs.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); i++) {
+            ColumnJob& job = jobs[i];
+            job.index = indices[i];
+            job.path = output_dir + "/" + file_name(Synthetic::header()[job.index]) + ".hecol";
+            job.writer = std::make_unique<ColumnFile::Writer>(job.path, *client->seal_context(), compression, slots);
+            // Ciphertexts come out in order; all but the column's last are full
+            job.pipeline = client->pipeline([&job, slots](std::string&& ciphertext) {
+                job.writer->append(ciphertext, std::min(slots, job.pushed - job.writer->rows()));
+            });
+        }
+    }
+
+    std::ofstream csv;
+    if (!csv_path.empty()) {
+        csv.open(csv_path, std::ios::binary | std::ios::trunc);
+        if (!csv) throw std::runtime_error("Cannot write " + csv_path);
+        std::string header;
+        for (const auto& name : Synthetic::header()) header += (header.empty() ? "" : ",") + name;
+        csv << header << "\n";
+    }
+    std::unique_ptr<ArrowFile::Writer> arrow;
+    if (!arrow_path.empty()) arrow = std::make_unique<ArrowFile::Writer>(arrow_path, arrow_fields());
+
+    const Synthetic generator(seed);
+    const bool write_csv = csv.is_open();
+    auto make_chunk = [&](size_t first, size_t count) {
+        Chunk chunk;
+        chunk.rows = count;
+        chunk.values.resize(jobs.size());
+        ArrowColumns columns;
+        for (size_t i = first; i < first + count; i++) {
+            const Synthetic::Row row = generator.row(i);
+            if (write_csv) Synthetic::append_csv(row, chunk.csv);
+            if (arrow) columns.add(row);
+            for (size_t j = 0; j < jobs.size(); j++) chunk.values[j].push_back(Synthetic::value(row, jobs[j].index));
+        }
+        if (arrow) chunk.arrow = arrow->encode(count, columns.columns);
+        return chunk;
+    };
+
+    // Chunks generate concurrently, a few ahead of the one being written
+    ThreadPool pool(threads);
+    std::deque<std::future<Chunk>> pending;
+    size_t next = 0, written = 0, bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto next_report = start + std::chrono::seconds(progress_s);
+    auto seconds = [&] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    while (written < rows) {
+        while (next < rows && pending.size() < 2 * threads) {
+            const size_t count = std::min(chunk_rows, rows - next);
+            pending.push_back(pool.submit([&make_chunk, first = first_row + next, count] {
+                return make_chunk(first, count);
+            }));
+            next += count;
+        }
+        Chunk chunk = pending.front().get();
+        pending.pop_front();
+        if (write_csv && !csv.write(chunk.csv.data(), static_cast<std::streamsize>(chunk.csv.size()))) {
+            throw std::runtime_error("Failed to write " + csv_path);
+        }
+        if (arrow) arrow->append(chunk.arrow);
+        for (size_t j = 0; j < jobs.size(); j++) {
+            jobs[j].pushed += chunk.values[j].size();  // Before the push, whose emits count these rows
+            jobs[j].pipeline->push(chunk.values[j].data(), chunk.values[j].size());
+        }
+        written += chunk.rows;
+        bytes += chunk.csv.size() + chunk.arrow.bytes.size();
+
+        if (progress_s && std::chrono::steady_clock::now() >= next_report) {
+            next_report = std::chrono::steady_clock::now() + std::chrono::seconds(progress_s);
+            std::cerr << "he-gen: " << written << " of " << rows << " rows, " << (bytes >> 20) << " MB in "
+                      << static_cast<long>(seconds()) << " s" << std::endl;
+        }
+    }
+
+    if (write_csv) {
+        csv.close();
+        if (!csv) throw std::runtime_error("Failed to write " + csv_path);
+        std::cerr << "he-gen: " << csv_path << ": " << rows << " rows" << std::endl;
+    }
+    if (arrow) {
+        arrow->finish();
+        std::cerr << "he-gen: " << arrow_path << ": " << rows << " rows" << std::endl;
+    }
+    for (auto& job : jobs) {
+        job.pipeline->finish();
+        ColumnFile::Layout layout = job.writer->finish();
+        std::cerr << "he-gen: " << job.path << ": " << layout.rows << " values in " << layout.blocks
+                  << " ciphertexts" << std::endl;
+    }
+    std::cerr << "he-gen: rows " << first_row << " to " << first_row + rows << " (seed " << seed << ") in "
+              << static_cast<long>(seconds() * 1000) << " ms" << std::endl;
+    return 0;
+} catch (const std::exception& e) {
+    std::cerr << "he-gen: " << e.what() << std::endl;
+    return 1;
+}
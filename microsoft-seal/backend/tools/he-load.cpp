@@ -0,0 +1,518 @@
+/**
+ * he-load: sustained HTTP load against mini-backend and main-backend
+ *
+ * Replays the frontend's request mix at a fixed concurrency and reports
+ * per-endpoint latency percentiles and throughput, for tracking against a
+ * stored baseline (--json). Operations:
+ *
+ *   encrypt        POST /encrypt on mini-backend, a random value
+ *   add_encrypted  POST /add_encrypted on main-backend, two ciphertexts
+ *                  fetched from mini-backend at startup
+ *   csv_sum        POST /csv/sum on main-backend, packed, with a CSV column
+ *                  encrypted by mini-backend's /csv/encrypt at startup
+ *
+ * Each of --concurrency connections is a closed loop: it picks an operation
+ * by the --mix weights, sends it over its keep-alive connection to that
+ * backend, waits for the response and sends the next one. Latencies are
+ * taken from the first byte written to the last byte read; requests that
+ * complete during --warmup seconds are not counted. Non-200 responses and
+ * connection failures are counted as errors and excluded from the
+ * percentiles.
+ *
+ * Options (--name=value, or the HE_NAME environment variable):
+ *   --mini (localhost:18081), --main (localhost:18080), --concurrency (16),
+ *   --threads (1), --duration (30 s), --warmup (2 s), --requests (0 = no
+ *   limit), --mix (encrypt:5,add_encrypted:4,csv_sum:1), --scheme (bfv),
+ *   --profile, --csv-file (src/data/healthcare_dataset.csv; e.g. a he-gen
+ *   CSV for columns beyond the sample's 55,500 rows), --csv-column (1),
+ *   --seed (1), --json (write the summary to this file, "-" for stdout)
+ */
+
+#include "ServerConfig.h"
+#include "crow/json.h"
+#include <asio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Target {
+        std::string host;
+        std::string port;
+        tcp::resolver::results_type endpoints;
+    };
+
+    struct HttpResponse {
+        int status = 0;
+        std::string body;
+    };
+
+    // An operation of the mix, with its request pre-serialized
+    struct Operation {
+        std::string name;
+        size_t target = 0;  // 0 = mini-backend, 1 = main-backend
+        double weight = 0;
+        std::string path;
+        std::vector<std::string> bodies;  // One is picked per request
+    };
+
+    struct OperationStats {
+        std::vector<uint32_t> latencies_us;
+        uint64_t errors = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t bytes_received = 0;
+    };
+
+    Target parse_target(const std::string& address) {
+        const size_t colon = address.rfind(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == address.size()) {
+            throw std::invalid_argument("Expected host:port, got " + address);
+        }
+        return Target{address.substr(0, colon), address.substr(colon + 1), {}};
+    }
+
+    std::string http_request(const Target& target, const std::string& path, const std::string& body,
+                             bool keep_alive) {
+        std::string request = "POST " + path + " HTTP/1.1\r\nHost: " + target.host + ":" + target.port +
+                              "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+                              (keep_alive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+        request += body;
+        return request;
+    }
+
+    // Status code and Content-Length of a response head (up to and including "\r\n\r\n")
+    void parse_head(const std::string& head, int& status, size_t& content_length, bool& close) {
+        if (head.compare(0, 5, "HTTP/") != 0) throw std::runtime_error("Malformed HTTP response");
+        status = std::atoi(head.c_str() + head.find(' ') + 1);
+        content_length = 0;
+        close = false;
+        std::istringstream lines(head);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(' '));
+            if (name == "content-length") content_length = std::stoull(value);
+            if (name == "connection" && (value == "close" || value == "Close")) close = true;
+        }
+    }
+
+    // Blocking request for the setup phase
+    HttpResponse fetch(asio::io_context& io, const Target& target, const std::string& path, const std::string& body) {
+        tcp::socket socket(io);
+        asio::connect(socket, target.endpoints);
+        asio::write(socket, asio::buffer(http_request(target, path, body, false)));
+        asio::streambuf buffer;
+        const size_t head_size = asio::read_until(socket, buffer, "\r\n\r\n");
+        std::string data(asio::buffers_begin(buffer.data()), asio::buffers_end(buffer.data()));
+        HttpResponse response;
+        size_t content_length;
+        bool close;
+        parse_head(data.substr(0, head_size), response.status, content_length, close);
+        response.body = data.substr(head_size);
+        if (response.body.size() < content_length) {
+            std::string rest(content_length - response.body.size(), '\0');
+            asio::read(socket, asio::buffer(rest));
+            response.body += rest;
+        }
+        return response;
+    }
+
+    crow::json::rvalue fetch_json(asio::io_context& io, const Target& target, const std::string& path,
+                                  const std::string& body) {
+        HttpResponse response = fetch(io, target, path, body);
+        auto json = crow::json::load(response.body);
+        if (response.status != 200 || !json) {
+            throw std::runtime_error(path + " returned " + std::to_string(response.status) + ": " +
+                                     response.body.substr(0, 200));
+        }
+        return json;
+    }
+
+    std::string quoted(const std::string& text) {
+        crow::json::wvalue value = text;
+        return value.dump();
+    }
+
+    std::vector<Operation> parse_mix(const std::string& mix) {
+        std::vector<Operation> operations;
+        std::istringstream items(mix);
+        std::string item;
+        while (std::getline(items, item, ',')) {
+            const size_t colon = item.find(':');
+            Operation op;
+            op.name = item.substr(0, colon);
+            op.weight = colon == std::string::npos ? 1.0 : std::stod(item.substr(colon + 1));
+            if (op.name == "encrypt") {
+                op.target = 0;
+                op.path = "/encrypt";
+            } else if (op.name == "add_encrypted") {
+                op.target = 1;
+                op.path = "/add_encrypted";
+            } else if (op.name == "csv_sum") {
+                op.target = 1;
+                op.path = "/csv/sum";
+            } else {
+                throw std::invalid_argument("Unknown operation in --mix: " + op.name +
+                                            " (encrypt, add_encrypted, csv_sum)");
+            }
+            if (op.weight < 0) throw std::invalid_argument("Negative weight in --mix: " + item);
+            if (op.weight > 0) operations.push_back(std::move(op));
+        }
+        if (operations.empty()) throw std::invalid_argument("--mix has no operations");
+        return operations;
+    }
+
+    struct Limits {
+        Clock::time_point measure_from;
+        Clock::time_point stop_at;
+        uint64_t max_requests = 0;             // 0: until stop_at
+        std::atomic<uint64_t> started{0};
+    };
+
+    /**
+     * One client connection per backend, issuing requests back to back
+     * Handlers of a session never run concurrently (each starts the next
+     * step), so its state needs no locking even with several io threads.
+     */
+    class Session : public std::enable_shared_from_this<Session> {
+    public:
+        Session(asio::io_context& io, const std::vector<Target>& targets, const std::vector<Operation>& operations,
+                Limits& limits, uint64_t seed)
+            : targets(targets), operations(operations), limits(limits), rng(seed),
+              stats(operations.size()), backoff(io) {
+            for (size_t i = 0; i < targets.size(); i++) sockets.emplace_back(io);
+            std::vector<double> weights;
+            for (const auto& op : operations) weights.push_back(op.weight);
+            pick = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+        }
+
+        void start() { next(); }
+
+        const std::vector<OperationStats>& results() const { return stats; }
+
+    private:
+        const std::vector<Target>& targets;
+        const std::vector<Operation>& operations;
+        Limits& limits;
+        std::mt19937_64 rng;
+        std::discrete_distribution<size_t> pick;
+        std::vector<tcp::socket> sockets;
+        std::vector<OperationStats> stats;
+        asio::steady_timer backoff;  // Before reconnecting after a failure, so a down backend is not spun on
+
+        size_t current = 0;
+        std::string request;
+        asio::streambuf buffer;
+        Clock::time_point started_at;
+        int status = 0;
+        bool close_after = false;
+
+        void next() {
+            if (Clock::now() >= limits.stop_at) return;
+            if (limits.max_requests && limits.started.fetch_add(1) >= limits.max_requests) return;
+            current = pick(rng);
+            const Operation& op = operations[current];
+            request = http_request(targets[op.target], op.path, op.bodies[rng() % op.bodies.size()], true);
+            started_at = Clock::now();
+            tcp::socket& socket = sockets[op.target];
+            if (socket.is_open()) {
+                send();
+                return;
+            }
+            auto self = shared_from_this();
+            asio::async_connect(socket, targets[op.target].endpoints,
+                                [self](const asio::error_code& error, const tcp::endpoint&) {
+                                    if (error) return self->fail();
+                                    self->sockets[self->operations[self->current].target].set_option(
+                                        tcp::no_delay(true));
+                                    self->send();
+                                });
+        }
+
+        void send() {
+            auto self = shared_from_this();
+            asio::async_write(sockets[operations[current].target], asio::buffer(request),
+                              [self](const asio::error_code& error, size_t) {
+                                  if (error) return self->fail();
+                                  self->read_head();
+                              });
+        }
+
+        void read_head() {
+            auto self = shared_from_this();
+            asio::async_read_until(sockets[operations[current].target], buffer, "\r\n\r\n",
+                                   [self](const asio::error_code& error, size_t head_size) {
+                                       if (error) return self->fail();
+                                       self->read_body(head_size);
+                                   });
+        }
+
+        void read_body(size_t head_size) {
+            std::string head(asio::buffers_begin(buffer.data()), asio::buffers_begin(buffer.data()) + head_size);
+            buffer.consume(head_size);
+            size_t content_length;
+            try {
+                parse_head(head, status, content_length, close_after);
+            } catch (const std::exception&) {
+                return fail();
+            }
+            stats[current].bytes_received += head_size + content_length;
+            const size_t buffered = std::min(buffer.size(), content_length);
+            buffer.consume(buffered);
+            if (buffered == content_length) return finish();
+
+            auto self = shared_from_this();
+            asio::async_read(sockets[operations[current].target], buffer,
+                             asio::transfer_exactly(content_length - buffered),
+                             [self](const asio::error_code& error, size_t received) {
+                                 if (error) return self->fail();
+                                 self->buffer.consume(received);
+                                 self->finish();
+                             });
+        }
+
+        void finish() {
+            const auto end = Clock::now();
+            if (started_at >= limits.measure_from) {
+                OperationStats& op_stats = stats[current];
+                op_stats.bytes_sent += request.size();
+                if (status == 200) {
+                    op_stats.latencies_us.push_back(static_cast<uint32_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(end - started_at).count()));
+                } else {
+                    op_stats.errors++;
+                }
+            }
+            if (close_after) close(operations[current].target);
+            next();
+        }
+
+        void fail() {
+            if (started_at >= limits.measure_from) stats[current].errors++;
+            close(operations[current].target);
+            backoff.expires_after(std::chrono::milliseconds(10));
+            auto self = shared_from_this();
+            backoff.async_wait([self](const asio::error_code&) { self->next(); });
+        }
+
+        void close(size_t target) {
+            asio::error_code ignored;
+            sockets[target].close(ignored);
+            buffer.consume(buffer.size());
+        }
+    };
+
+    // Nearest-rank percentile of sorted values
+    double percentile(const std::vector<uint32_t>& sorted, double q) {
+        if (sorted.empty()) return 0;
+        size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    struct Summary {
+        uint64_t requests = 0;
+        uint64_t errors = 0;
+        double requests_per_second = 0;
+        double mean_us = 0;
+        double p50_us = 0;
+        double p99_us = 0;
+        double p999_us = 0;
+        double max_us = 0;
+        double sent_bytes_per_second = 0;
+        double received_bytes_per_second = 0;
+    };
+
+    Summary summarize(OperationStats& merged, double seconds) {
+        std::sort(merged.latencies_us.begin(), merged.latencies_us.end());
+        const auto& latencies = merged.latencies_us;
+        Summary summary;
+        summary.requests = latencies.size();
+        summary.errors = merged.errors;
+        summary.requests_per_second = static_cast<double>(latencies.size()) / seconds;
+        if (!latencies.empty()) {
+            double total = 0;
+            for (uint32_t latency : latencies) total += latency;
+            summary.mean_us = total / static_cast<double>(latencies.size());
+            summary.max_us = latencies.back();
+        }
+        summary.p50_us = percentile(latencies, 0.50);
+        summary.p99_us = percentile(latencies, 0.99);
+        summary.p999_us = percentile(latencies, 0.999);
+        summary.sent_bytes_per_second = static_cast<double>(merged.bytes_sent) / seconds;
+        summary.received_bytes_per_second = static_cast<double>(merged.bytes_received) / seconds;
+        return summary;
+    }
+
+    crow::json::wvalue to_json(const Summary& summary) {
+        crow::json::wvalue json;
+        json["requests"] = summary.requests;
+        json["errors"] = summary.errors;
+        json["requests_per_second"] = summary.requests_per_second;
+        json["mean_us"] = summary.mean_us;
+        json["p50_us"] = summary.p50_us;
+        json["p99_us"] = summary.p99_us;
+        json["p999_us"] = summary.p999_us;
+        json["max_us"] = summary.max_us;
+        json["sent_bytes_per_second"] = summary.sent_bytes_per_second;
+        json["received_bytes_per_second"] = summary.received_bytes_per_second;
+        return json;
+    }
+
+    void print_header() {
+        std::cout << "\n" << std::left << std::setw(16) << "operation" << std::right << std::setw(10) << "requests"
+                  << std::setw(8) << "errors" << std::setw(10) << "req/s" << std::setw(11) << "p50 ms"
+                  << std::setw(11) << "p99 ms" << std::setw(11) << "p999 ms" << std::setw(11) << "max ms" << "\n";
+    }
+
+    void print_row(const std::string& name, const Summary& summary) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << summary.requests << std::setw(8) << summary.errors << std::setw(10)
+                  << summary.requests_per_second << std::setw(11) << summary.p50_us / 1000 << std::setw(11)
+                  << summary.p99_us / 1000 << std::setw(11) << summary.p999_us / 1000 << std::setw(11)
+                  << summary.max_us / 1000 << "\n";
+    }
+}
+
+int main(int argc, char** argv) try {
+    ServerConfig config(argc, argv);
+    std::vector<Target> targets = {parse_target(config.get("mini", "localhost:18081")),
+                                   parse_target(config.get("main", "localhost:18080"))};
+    const size_t concurrency = std::max<size_t>(1, config.get_size("concurrency", 16));
+    const size_t threads = std::max<size_t>(1, config.get_size("threads", 1));
+    const size_t duration = config.get_size("duration", 30);
+    const size_t warmup = config.get_size("warmup", 2);
+    const uint64_t max_requests = config.get_size("requests", 0);
+    const uint64_t seed = config.get_size("seed", 1);
+    const std::string scheme = config.get("scheme", "bfv");
+    const std::string profile = config.get("profile", "");
+    const std::string csv_file =
+        std::filesystem::absolute(config.get("csv-file", "src/data/healthcare_dataset.csv")).string();
+    const size_t csv_column = config.get_size("csv-column", 1);
+    const std::string json_output = config.get("json", "");
+    const std::string mix = config.get("mix", "encrypt:5,add_encrypted:4,csv_sum:1");
+    std::vector<Operation> operations = parse_mix(mix);
+    config.check_unused();
+
+    asio::io_context io;
+    tcp::resolver resolver(io);
+    for (Target& target : targets) target.endpoints = resolver.resolve(target.host, target.port);
+
+    // Request bodies, with ciphertexts prepared through mini-backend
+    const std::string common = "\"scheme\": " + quoted(scheme) +
+                               (profile.empty() ? std::string() : ", \"profile\": " + quoted(profile));
+    std::mt19937_64 rng(seed);
+    for (Operation& op : operations) {
+        if (op.name == "encrypt") {
+            for (int i = 0; i < 64; i++) {
+                op.bodies.push_back("{\"value\": " + std::to_string(rng() % 1000) + ", " + common + "}");
+            }
+        } else if (op.name == "add_encrypted") {
+            std::vector<std::string> ciphertexts;
+            for (int i = 0; i < 4; i++) {
+                auto json = fetch_json(io, targets[0], "/encrypt",
+                                       "{\"value\": " + std::to_string(i + 1) + ", " + common + "}");
+                ciphertexts.push_back(quoted(json["ciphertext"].s()));
+            }
+            for (size_t i = 0; i < ciphertexts.size(); i++) {
+                op.bodies.push_back("{\"a\": " + ciphertexts[i] + ", \"b\": " +
+                                    ciphertexts[(i + 1) % ciphertexts.size()] + ", " + common + "}");
+            }
+        } else {
+            auto json = fetch_json(io, targets[0], "/csv/encrypt",
+                                   "{\"file_path\": " + quoted(csv_file) + ", \"column_index\": " +
+                                       std::to_string(csv_column) + ", " + common + "}");
+            std::string values;
+            for (const auto& ciphertext : json["ciphertexts"]) {
+                values += (values.empty() ? "" : ", ") + quoted(ciphertext.s());
+            }
+            op.bodies.push_back("{\"encrypted_values\": [" + values + "], \"packed\": true, " + common + "}");
+        }
+        std::cout << op.name << ": " << op.bodies.size() << " request bodies, " << op.bodies.front().size()
+                  << " bytes each\n";
+    }
+
+    // Closed-loop sessions; the clock starts once every connection is launched
+    Limits limits;
+    const auto start = Clock::now();
+    limits.measure_from = start + std::chrono::seconds(warmup);
+    limits.stop_at = max_requests ? Clock::time_point::max() : limits.measure_from + std::chrono::seconds(duration);
+    limits.max_requests = max_requests;
+    std::vector<std::shared_ptr<Session>> sessions;
+    for (size_t i = 0; i < concurrency; i++) {
+        sessions.push_back(std::make_shared<Session>(io, targets, operations, limits, seed * 1000003 + i));
+        sessions.back()->start();
+    }
+    std::cout << "Running " << concurrency << " connections for "
+              << (max_requests ? std::to_string(max_requests) + " requests" : std::to_string(duration) + " s")
+              << " after " << warmup << " s of warmup\n";
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; i++) workers.emplace_back([&io] { io.run(); });
+    io.run();
+    for (auto& worker : workers) worker.join();
+    const double seconds =
+        std::chrono::duration<double>(Clock::now() - std::max(limits.measure_from, start)).count();
+
+    // Merge per-session results
+    OperationStats all;
+    crow::json::wvalue report;
+    print_header();
+    for (size_t i = 0; i < operations.size(); i++) {
+        OperationStats merged;
+        for (const auto& session : sessions) {
+            const OperationStats& part = session->results()[i];
+            merged.latencies_us.insert(merged.latencies_us.end(), part.latencies_us.begin(), part.latencies_us.end());
+            merged.errors += part.errors;
+            merged.bytes_sent += part.bytes_sent;
+            merged.bytes_received += part.bytes_received;
+        }
+        all.latencies_us.insert(all.latencies_us.end(), merged.latencies_us.begin(), merged.latencies_us.end());
+        all.errors += merged.errors;
+        all.bytes_sent += merged.bytes_sent;
+        all.bytes_received += merged.bytes_received;
+        const Summary summary = summarize(merged, seconds);
+        report["operations"][operations[i].name] = to_json(summary);
+        print_row(operations[i].name, summary);
+    }
+    const Summary total = summarize(all, seconds);
+    report["total"] = to_json(total);
+    print_row("total", total);
+
+    if (!json_output.empty()) {
+        report["config"]["concurrency"] = concurrency;
+        report["config"]["threads"] = threads;
+        report["config"]["seconds"] = seconds;
+        report["config"]["scheme"] = scheme;
+        report["config"]["profile"] = profile.empty() ? "default" : profile;
+        report["config"]["mix"] = mix;
+        if (json_output == "-") {
+            std::cout << report.dump() << "\n";
+        } else {
+            std::ofstream(json_output) << report.dump() << "\n";
+            std::cout << "Wrote " << json_output << "\n";
+        }
+    }
+    return all.errors == 0 ? 0 : 2;
+} catch (const std::exception& e) {
+    std::cerr << "he-load: " << e.what() << "\n";
+    return 1;
+}
@@ -0,0 +1,528 @@
+/**
+ * he-replay: re-issue a recorded traffic log against a backend
+ *
+ * Reads a log written with --record-traffic (see src/TrafficLog.h) and
+ * sends its requests to --target at their recorded arrival times, divided
+ * by --speed (2 replays an hour of traffic in half an hour; with a log
+ * recorded at --record-traffic-sample=0.1, 10 restores the original rate).
+ * Replay is open loop: a request goes out when it is due, on an idle
+ * keep-alive connection or a new one, whether or not earlier ones have been
+ * answered. Beyond --connections open connections, due requests wait for
+ * one to free up. Latency is taken from when a request was due to the last
+ * byte of its response, so time spent waiting for a connection counts, as
+ * it would for a real client; "lag" reports how late requests went out.
+ *
+ * Requests are grouped by their recorded endpoint label. A replayed request
+ * counts towards the latencies only when it gets the status it got when
+ * recorded; others are "mismatched" (e.g. a handle or job that exists only
+ * on the recording server). Requests whose bodies were not recorded are
+ * skipped.
+ *
+ * The report lists each endpoint's replay latency percentiles next to the
+ * recording server's own handler times, or, with --compare, next to an
+ * earlier he-replay --json report, with the change in percent: replay the
+ * same log against two builds to compare them under production-shaped load.
+ *
+ * Options (--name=value, or the HE_NAME environment variable):
+ *   --log (required), --target (localhost:18080 for main-backend logs,
+ *   localhost:18081 for mini-backend ones), --speed (1), --connections (64),
+ *   --requests (0 = all), --json (write the summary to this file, "-" for
+ *   stdout), --compare (he-replay --json report to diff against)
+ */
+
+#include "ServerConfig.h"
+#include "TrafficLog.h"
+#include "crow/json.h"
+#include <asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    // A request of the log, due at a point of the replay
+    struct Pending {
+        traffic::Request request;
+        Clock::time_point due;
+    };
+
+    // What a replayed request got, kept until the log's outcomes are all read
+    struct Result {
+        uint64_t id = 0;
+        size_t endpoint = 0;
+        int status = 0;        // 0: connection failed
+        uint32_t latency_us = 0;
+    };
+
+    struct EndpointStats {
+        std::string label;
+        std::vector<uint32_t> latencies_us;
+        std::vector<uint32_t> recorded_us;  // Handler times on the recording server
+        uint64_t requests = 0;
+        uint64_t mismatched = 0;
+        uint64_t failed = 0;
+    };
+
+    // Status code and Content-Length of a response head (up to and including "\r\n\r\n")
+    void parse_head(const std::string& head, int& status, size_t& content_length, bool& close) {
+        if (head.compare(0, 5, "HTTP/") != 0) throw std::runtime_error("Malformed HTTP response");
+        status = std::atoi(head.c_str() + head.find(' ') + 1);
+        content_length = 0;
+        close = false;
+        std::istringstream lines(head);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(' '));
+            if (name == "content-length") content_length = std::stoull(value);
+            if (name == "connection" && (value == "close" || value == "Close")) close = true;
+        }
+    }
+
+    /**
+     * One keep-alive connection to the target, carrying one request at a time
+     * Everything runs on the replay's single io thread.
+     */
+    class Connection : public std::enable_shared_from_this<Connection> {
+    public:
+        using Done = std::function<void(std::shared_ptr<Connection>, int status)>;
+
+        Connection(asio::io_context& io, const tcp::resolver::results_type& endpoints, std::string host)
+            : socket(io), endpoints(endpoints), host(std::move(host)) {}
+
+        void send(const traffic::Request& request, Done done) {
+            on_done = std::move(done);
+            message = request.method + " " + request.target + " HTTP/1.1\r\nHost: " + host +
+                      "\r\nConnection: keep-alive\r\nContent-Length: " + std::to_string(request.body.size()) +
+                      (request.content_type.empty() ? "" : "\r\nContent-Type: " + request.content_type) + "\r\n\r\n";
+            message += request.body;
+            reused = socket.is_open();
+            if (reused) return write();
+            connect();
+        }
+
+    private:
+        tcp::socket socket;
+        const tcp::resolver::results_type& endpoints;
+        std::string host;
+        std::string message;
+        asio::streambuf buffer;
+        Done on_done;
+        int status = 0;
+        bool close_after = false;
+        bool reused = false;  // Sent on a kept-alive connection, which the server may have closed meanwhile
+
+        void connect() {
+            auto self = shared_from_this();
+            asio::async_connect(socket, endpoints, [self](const asio::error_code& error, const tcp::endpoint&) {
+                if (error) return self->finish(0);
+                self->socket.set_option(tcp::no_delay(true));
+                self->write();
+            });
+        }
+
+        void write() {
+            auto self = shared_from_this();
+            asio::async_write(socket, asio::buffer(message), [self](const asio::error_code& error, size_t) {
+                if (error) return self->retry();
+                asio::async_read_until(self->socket, self->buffer, "\r\n\r\n",
+                                       [self](const asio::error_code& error, size_t head_size) {
+                                           if (error) return self->retry();
+                                           self->read_body(head_size);
+                                       });
+            });
+        }
+
+        // Before any of the response: a kept-alive connection that timed out is reopened once
+        void retry() {
+            if (!reused) return finish(0);
+            reused = false;
+            asio::error_code ignored;
+            socket.close(ignored);
+            buffer.consume(buffer.size());
+            connect();
+        }
+
+        void read_body(size_t head_size) {
+            std::string head(asio::buffers_begin(buffer.data()), asio::buffers_begin(buffer.data()) + head_size);
+            buffer.consume(head_size);
+            size_t content_length;
+            try {
+                parse_head(head, status, content_length, close_after);
+            } catch (const std::exception&) {
+                return finish(0);
+            }
+            const size_t buffered = std::min(buffer.size(), content_length);
+            buffer.consume(buffered);
+            if (buffered == content_length) return finish(status);
+            auto self = shared_from_this();
+            asio::async_read(socket, buffer, asio::transfer_exactly(content_length - buffered),
+                             [self](const asio::error_code& error, size_t received) {
+                                 if (error) return self->finish(0);
+                                 self->buffer.consume(received);
+                                 self->finish(self->status);
+                             });
+        }
+
+        void finish(int result) {
+            if (result == 0 || close_after) {
+                asio::error_code ignored;
+                socket.close(ignored);
+                buffer.consume(buffer.size());
+            }
+            message.clear();
+            Done done = std::move(on_done);
+            done(shared_from_this(), result);
+        }
+    };
+
+    /**
+     * Reads the log as the replay goes and sends each request when it is due
+     * Only the requests due but not yet answered (and one read ahead) are in
+     * memory, so logs with bodies may be far larger than RAM.
+     */
+    class Replay {
+    public:
+        Replay(asio::io_context& io, traffic::Reader& reader, const std::string& host, const std::string& port,
+               double speed, size_t max_connections, uint64_t max_requests)
+            : io(io), reader(reader), host(host + ":" + port), speed(speed), max_connections(max_connections),
+              max_requests(max_requests), timer(io) {
+            endpoints = tcp::resolver(io).resolve(host, port);
+        }
+
+        void start() {
+            started = Clock::now();
+            schedule();
+        }
+
+        uint64_t skipped = 0;             // Bodies not recorded
+        uint64_t max_lag_us = 0;
+        std::vector<uint32_t> lags_us;
+        std::vector<EndpointStats> stats;
+        std::unordered_map<uint64_t, traffic::Outcome> outcomes;  // Recorded, by request id
+        std::vector<Result> results;
+
+    private:
+        asio::io_context& io;
+        traffic::Reader& reader;
+        tcp::resolver::results_type endpoints;
+        std::string host;
+        double speed;
+        size_t max_connections;
+        uint64_t max_requests;
+        asio::steady_timer timer;
+        Clock::time_point started;
+        uint64_t first_arrival_us = 0;
+        uint64_t read = 0;
+
+        std::vector<std::shared_ptr<Connection>> idle;
+        size_t open = 0;
+        std::deque<std::shared_ptr<Pending>> waiting;  // Due, but every connection is busy
+        std::map<std::string, size_t> endpoint_index;
+
+        // Next request of the log (collecting the outcomes read on the way), or null at its end
+        std::shared_ptr<Pending> read_next() {
+            auto pending = std::make_shared<Pending>();
+            traffic::Outcome outcome;
+            while (!max_requests || read < max_requests) {
+                const auto kind = reader.next(pending->request, outcome);
+                if (kind == traffic::Reader::Kind::end) break;
+                if (kind == traffic::Reader::Kind::outcome) {
+                    outcomes[outcome.id] = outcome;
+                    continue;
+                }
+                if (!pending->request.body_recorded && pending->request.body_size > 0) {
+                    skipped++;
+                    continue;
+                }
+                if (read++ == 0) first_arrival_us = pending->request.arrival_us;
+                const double offset_us =
+                    static_cast<double>(pending->request.arrival_us - std::min(first_arrival_us,
+                                                                               pending->request.arrival_us)) /
+                    speed;
+                pending->due = started + std::chrono::microseconds(static_cast<int64_t>(offset_us));
+                return pending;
+            }
+            return nullptr;
+        }
+
+        void schedule() {
+            std::shared_ptr<Pending> pending = read_next();
+            if (!pending) return drain_outcomes();
+            timer.expires_at(pending->due);
+            timer.async_wait([this, pending](const asio::error_code&) {
+                dispatch(pending);
+                schedule();
+            });
+        }
+
+        // After the last request: the outcomes of requests still in flight at the end of the recording
+        void drain_outcomes() {
+            traffic::Request request;
+            traffic::Outcome outcome;
+            for (traffic::Reader::Kind kind; (kind = reader.next(request, outcome)) != traffic::Reader::Kind::end;) {
+                if (kind == traffic::Reader::Kind::outcome) outcomes[outcome.id] = outcome;
+            }
+        }
+
+        void dispatch(const std::shared_ptr<Pending>& pending) {
+            if (!idle.empty()) {
+                auto connection = idle.back();
+                idle.pop_back();
+                return send(connection, pending);
+            }
+            if (open < max_connections) {
+                open++;
+                return send(std::make_shared<Connection>(io, endpoints, host), pending);
+            }
+            waiting.push_back(pending);
+        }
+
+        void send(const std::shared_ptr<Connection>& connection, const std::shared_ptr<Pending>& pending) {
+            const uint64_t lag_us = static_cast<uint64_t>(
+                std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - pending->due)
+                                         .count()));
+            lags_us.push_back(static_cast<uint32_t>(std::min<uint64_t>(lag_us, UINT32_MAX)));
+            max_lag_us = std::max(max_lag_us, lag_us);
+            connection->send(pending->request, [this, pending](std::shared_ptr<Connection> connection, int status) {
+                Result result;
+                result.id = pending->request.id;
+                result.endpoint = endpoint(pending->request.endpoint);
+                result.status = status;
+                result.latency_us = static_cast<uint32_t>(std::min<int64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - pending->due).count(),
+                    UINT32_MAX));
+                results.push_back(result);
+                if (!waiting.empty()) {
+                    auto next = waiting.front();
+                    waiting.pop_front();
+                    return send(connection, next);
+                }
+                idle.push_back(std::move(connection));
+            });
+        }
+
+        size_t endpoint(const std::string& label) {
+            auto found = endpoint_index.find(label);
+            if (found != endpoint_index.end()) return found->second;
+            endpoint_index.emplace(label, stats.size());
+            stats.push_back(EndpointStats{label, {}, {}, 0, 0, 0});
+            return stats.size() - 1;
+        }
+    };
+
+    // Nearest-rank percentile of sorted values
+    double percentile(const std::vector<uint32_t>& sorted, double q) {
+        if (sorted.empty()) return 0;
+        size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    struct Summary {
+        uint64_t requests = 0;
+        uint64_t mismatched = 0;
+        uint64_t failed = 0;
+        double mean_us = 0;
+        double p50_us = 0;
+        double p90_us = 0;
+        double p99_us = 0;
+        double p999_us = 0;
+        double max_us = 0;
+        double recorded_p50_us = 0;
+        double recorded_p99_us = 0;
+    };
+
+    Summary summarize(EndpointStats& stats) {
+        std::sort(stats.latencies_us.begin(), stats.latencies_us.end());
+        std::sort(stats.recorded_us.begin(), stats.recorded_us.end());
+        const auto& latencies = stats.latencies_us;
+        Summary summary;
+        summary.requests = stats.requests;
+        summary.mismatched = stats.mismatched;
+        summary.failed = stats.failed;
+        if (!latencies.empty()) {
+            double total = 0;
+            for (uint32_t latency : latencies) total += latency;
+            summary.mean_us = total / static_cast<double>(latencies.size());
+            summary.max_us = latencies.back();
+        }
+        summary.p50_us = percentile(latencies, 0.50);
+        summary.p90_us = percentile(latencies, 0.90);
+        summary.p99_us = percentile(latencies, 0.99);
+        summary.p999_us = percentile(latencies, 0.999);
+        summary.recorded_p50_us = percentile(stats.recorded_us, 0.50);
+        summary.recorded_p99_us = percentile(stats.recorded_us, 0.99);
+        return summary;
+    }
+
+    crow::json::wvalue to_json(const Summary& summary) {
+        crow::json::wvalue json;
+        json["requests"] = summary.requests;
+        json["mismatched"] = summary.mismatched;
+        json["failed"] = summary.failed;
+        json["mean_us"] = summary.mean_us;
+        json["p50_us"] = summary.p50_us;
+        json["p90_us"] = summary.p90_us;
+        json["p99_us"] = summary.p99_us;
+        json["p999_us"] = summary.p999_us;
+        json["max_us"] = summary.max_us;
+        json["recorded_p50_us"] = summary.recorded_p50_us;
+        json["recorded_p99_us"] = summary.recorded_p99_us;
+        return json;
+    }
+
+    void print_header(bool compare) {
+        std::cout << "\n" << std::left << std::setw(34) << "endpoint" << std::right << std::setw(9) << "requests"
+                  << std::setw(7) << "mism" << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10)
+                  << "p99 ms" << std::setw(10) << "p999 ms" << std::setw(11) << (compare ? "base p50" : "rec p50")
+                  << std::setw(11) << (compare ? "base p99" : "rec p99") << std::setw(9) << "d p50" << std::setw(9)
+                  << "d p99" << "\n";
+    }
+
+    std::string change(double now, double before) {
+        if (before <= 0 || now <= 0) return "-";
+        std::ostringstream out;
+        out << std::showpos << std::fixed << std::setprecision(1) << (now / before - 1) * 100 << "%";
+        return out.str();
+    }
+
+    // One row; base_p50 / base_p99 are the compared report's (or the recording's) percentiles, 0 if absent
+    void print_row(const std::string& name, const Summary& summary, double base_p50_us, double base_p99_us) {
+        std::cout << std::left << std::setw(34) << name.substr(0, 33) << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(9) << summary.requests << std::setw(7) << summary.mismatched
+                  << std::setw(10) << summary.p50_us / 1000 << std::setw(10) << summary.p90_us / 1000 << std::setw(10)
+                  << summary.p99_us / 1000 << std::setw(10) << summary.p999_us / 1000 << std::setw(11)
+                  << base_p50_us / 1000 << std::setw(11) << base_p99_us / 1000 << std::setw(9)
+                  << change(summary.p50_us, base_p50_us) << std::setw(9) << change(summary.p99_us, base_p99_us)
+                  << "\n";
+    }
+}
+
+int main(int argc, char** argv) try {
+    ServerConfig config(argc, argv);
+    const std::string log_path = config.get("log", "");
+    if (log_path.empty()) throw std::invalid_argument("--log is required");
+    traffic::Reader reader(log_path);
+    const std::string target =
+        config.get("target", reader.service() == "mini-backend" ? "localhost:18081" : "localhost:18080");
+    const double speed = std::stod(config.get("speed", "1"));
+    if (!(speed > 0)) throw std::invalid_argument("--speed must be positive");
+    const size_t connections = std::max<size_t>(1, config.get_size("connections", 64));
+    const uint64_t max_requests = config.get_size("requests", 0);
+    const std::string json_output = config.get("json", "");
+    const std::string compare_path = config.get("compare", "");
+    config.check_unused();
+    const size_t colon = target.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == target.size()) {
+        throw std::invalid_argument("Expected host:port, got " + target);
+    }
+
+    crow::json::rvalue baseline;
+    if (!compare_path.empty()) {
+        std::ifstream file(compare_path);
+        std::stringstream text;
+        text << file.rdbuf();
+        baseline = crow::json::load(text.str());
+        if (!file || !baseline || !baseline.has("endpoints")) {
+            throw std::runtime_error(compare_path + " is not an he-replay --json report");
+        }
+    }
+
+    asio::io_context io;
+    Replay replay(io, reader, target.substr(0, colon), target.substr(colon + 1), speed, connections, max_requests);
+    std::cout << "Replaying " << reader.service() << " traffic from " << log_path << " against " << target << " at "
+              << speed << "x, up to " << connections << " connections\n";
+    const auto start = Clock::now();
+    replay.start();
+    io.run();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (reader.truncated()) std::cout << "The log ends in a record cut short; replayed what came before it\n";
+
+    // Join the replayed requests with their recorded outcomes
+    EndpointStats all{"total", {}, {}, 0, 0, 0};
+    for (const Result& result : replay.results) {
+        EndpointStats& stats = replay.stats[result.endpoint];
+        stats.requests++;
+        auto recorded = replay.outcomes.find(result.id);
+        const bool known = recorded != replay.outcomes.end();
+        if (known) stats.recorded_us.push_back(recorded->second.service_us);
+        if (result.status == 0) {
+            stats.failed++;
+        } else if (known ? result.status != recorded->second.status : result.status >= 400) {
+            stats.mismatched++;
+        } else {
+            stats.latencies_us.push_back(result.latency_us);
+        }
+    }
+
+    crow::json::wvalue report;
+    print_header(!compare_path.empty());
+    std::sort(replay.stats.begin(), replay.stats.end(),
+              [](const EndpointStats& a, const EndpointStats& b) { return a.label < b.label; });
+    for (EndpointStats& stats : replay.stats) {
+        all.requests += stats.requests;
+        all.mismatched += stats.mismatched;
+        all.failed += stats.failed;
+        all.latencies_us.insert(all.latencies_us.end(), stats.latencies_us.begin(), stats.latencies_us.end());
+        all.recorded_us.insert(all.recorded_us.end(), stats.recorded_us.begin(), stats.recorded_us.end());
+        const Summary summary = summarize(stats);
+        report["endpoints"][stats.label] = to_json(summary);
+        double base_p50 = summary.recorded_p50_us, base_p99 = summary.recorded_p99_us;
+        if (!compare_path.empty()) {
+            const bool present = baseline["endpoints"].has(stats.label);
+            base_p50 = present ? baseline["endpoints"][stats.label]["p50_us"].d() : 0;
+            base_p99 = present ? baseline["endpoints"][stats.label]["p99_us"].d() : 0;
+        }
+        print_row(stats.label, summary, base_p50, base_p99);
+    }
+    const Summary total = summarize(all);
+    report["total"] = to_json(total);
+    print_row("total", total, compare_path.empty() ? total.recorded_p50_us : baseline["total"]["p50_us"].d(),
+              compare_path.empty() ? total.recorded_p99_us : baseline["total"]["p99_us"].d());
+
+    std::sort(replay.lags_us.begin(), replay.lags_us.end());
+    std::cout << "\n" << total.requests << " requests in " << std::fixed << std::setprecision(1) << seconds << " s ("
+              << replay.skipped << " skipped without bodies, " << total.failed << " failed); sent late by p99 "
+              << percentile(replay.lags_us, 0.99) / 1000 << " ms, max " << replay.max_lag_us / 1000.0 << " ms\n";
+
+    if (!json_output.empty()) {
+        report["config"]["log"] = log_path;
+        report["config"]["service"] = reader.service();
+        report["config"]["target"] = target;
+        report["config"]["speed"] = speed;
+        report["config"]["connections"] = connections;
+        report["config"]["seconds"] = seconds;
+        report["config"]["skipped"] = replay.skipped;
+        report["config"]["lag_p99_us"] = percentile(replay.lags_us, 0.99);
+        report["config"]["lag_max_us"] = replay.max_lag_us;
+        if (json_output == "-") {
+            std::cout << report.dump() << "\n";
+        } else {
+            std::ofstream(json_output) << report.dump() << "\n";
+            std::cout << "Wrote " << json_output << "\n";
+        }
+    }
+    return total.failed == 0 ? 0 : 2;
+} catch (const std::exception& e) {
+    std::cerr << "he-replay: " << e.what() << "\n";
+    return 1;
+}
@@ -2,10 +2,24 @@ import { useState, useEffect } from 'react';
 import './App.css';
 import axios from 'axios';
 import Experiment from './Experiment';
+import { startTrace } from './tracing';
+import { getEncryptor } from './heWasm';
 
 const MINI_BACKEND_URL = 'http://localhost:18081'; // mini-backend
 const MAIN_BACKEND_URL = 'http://localhost:18080'; // main-backend
 
+// Cleared once either backend turns the shared memory handoff down (not started
+// with --shm-handoff, or not on the same host)
+let sharedMemoryHandoff = true;
+
+// Decrypted result of an encrypted CSV operation as shown. /csv/average returns
+// the mean itself when it could divide (divided_by_count: CKKS with a level to
+// spare); otherwise, as for /store/average, the sum is divided here
+const displayedResult = (operation, value, response, count) => {
+    if (operation !== 'average' || response.divided_by_count || count == 0) return value;
+    return value / count;
+};
+
 function App() {
     const [backendData, setBackendData] = useState(null);
     const [numberA, setNumberA] = useState('');
@@ -37,37 +51,100 @@ function App() {
         }
     };
 
+    // Same-host fast path: mini-backend encrypts the column into a shared memory
+    // region and main-backend stores it from there, so no ciphertext passes
+    // through the browser. Returns null when the backends do not offer it
+    const processCSVSharedMemory = async (operation, traced) => {
+        if (!sharedMemoryHandoff) return null;
+        let encryptResponse;
+        try {
+            encryptResponse = await axios.post(`${MINI_BACKEND_URL}/csv/encrypt`, {
+                file_path: csvFile,
+                column_index: parseInt(columnIndex),
+                scheme: csvScheme,
+                shared_memory: true
+            }, traced());
+        } catch (err) {
+            if (!String(err.response?.data?.error).includes('--shm-handoff')) throw err;
+            sharedMemoryHandoff = false;
+            return null;
+        }
+        const count = encryptResponse.data.count;
+
+        let handle;
+        try {
+            const storeResponse = await axios.put(`${MAIN_BACKEND_URL}/shm/store`, {
+                region: encryptResponse.data.region,
+                scheme: csvScheme,
+                packed_count: count
+            }, traced());
+            handle = storeResponse.data.handle;
+        } catch (err) {
+            sharedMemoryHandoff = false;
+            return null;
+        }
+
+        try {
+            const processResponse = await axios.post(`${MAIN_BACKEND_URL}/store/${operation}`, {
+                handle,
+                scheme: csvScheme,
+                packed: true
+            }, traced());
+            const decryptResponse = await axios.post(`${MINI_BACKEND_URL}/decrypt`, {
+                ciphertext: processResponse.data.encrypted_result,
+                scheme: csvScheme
+            }, traced());
+
+            const resultValue = displayedResult(operation, decryptResponse.data.value, processResponse.data, count);
+            return { operation, result: resultValue, values_processed: count, encrypted: true };
+        } finally {
+            axios.delete(`${MAIN_BACKEND_URL}/store/${handle}?scheme=${csvScheme}`, traced()).catch(() => {});
+        }
+    };
+
     const processCSV = async (operation) => {
         setLoading(true);
         setError(null);
+        const traced = startTrace();
         
         try {
-            if (useEncryption) {
+            const handedOff = useEncryption && await processCSVSharedMemory(operation, traced);
+            if (handedOff) {
+                setCsvResult(handedOff);
+            } else if (useEncryption) {
                 // 1. read csv by mini-backend
                 const readResponse = await axios.post(`${MINI_BACKEND_URL}/csv/read`, {
                     file_path: csvFile,
                     column_index: parseInt(columnIndex)
-                });
+                }, traced());
                 
                 const values = readResponse.data.values;
                 const count = values.length;
                 
-                // 2. Encrypt values form csv using mini-backend
-                const encryptedValues = [];
-                for (const value of values) {
-                    const encryptResponse = await axios.post(`${MINI_BACKEND_URL}/encrypt`, {
-                        value: value,
-                        scheme: csvScheme
-                    });
-                    encryptedValues.push(encryptResponse.data.ciphertext);
+                // 2. Encrypt the column in the browser (packed, a few ciphertexts in
+                //    all) or, without the he-wasm module, value by value on mini-backend
+                const encryptor = await getEncryptor(MINI_BACKEND_URL, csvScheme);
+                let encryptedValues;
+                if (encryptor) {
+                    encryptedValues = encryptor.encryptVector(values);
+                } else {
+                    encryptedValues = [];
+                    for (const value of values) {
+                        const encryptResponse = await axios.post(`${MINI_BACKEND_URL}/encrypt`, {
+                            value: value,
+                            scheme: csvScheme
+                        }, traced());
+                        encryptedValues.push(encryptResponse.data.ciphertext);
+                    }
                 }
                 
                 // 3. Send encrypted values to main backend
                 const processResponse = await axios.post(`${MAIN_BACKEND_URL}/csv/${operation}`, {
                     encrypted_values: encryptedValues,
                     scheme: csvScheme,
-                    count: count
-                });
+                    count: count,
+                    packed: Boolean(encryptor)
+                }, traced());
                 
                 const encryptedResult = processResponse.data.encrypted_result;
                 
@@ -75,17 +152,11 @@ function App() {
                 const decryptResponse = await axios.post(`${MINI_BACKEND_URL}/decrypt`, {
                     ciphertext: encryptedResult,
                     scheme: csvScheme
-                });
-                
-                let resultValue = decryptResponse.data.value;
-                
-                if (operation === 'average' && count != 0) {
-                    resultValue = resultValue / count;
-                }
+                }, traced());
                 
                 setCsvResult({
                     operation,
-                    result: resultValue,
+                    result: displayedResult(operation, decryptResponse.data.value, processResponse.data, count),
                     values_processed: count,
                     encrypted: true
                 });
@@ -94,7 +165,7 @@ function App() {
                 const response = await axios.post(`${MINI_BACKEND_URL}/csv/${operation}`, {
                     file_path: csvFile,
                     column_index: parseInt(columnIndex)
-                });
+                }, traced());
                 
                 setCsvResult({
                     operation,
@@ -125,18 +196,19 @@ function App() {
     
         setLoading(true);
         setError(null);
+        const traced = startTrace();
 
         try {
             // 1. Encrypting by mini-backend
             const encryptResponseA = await axios.post(`${MINI_BACKEND_URL}/encrypt`, {
                 value: a,
                 scheme: numberScheme
-            });
+            }, traced());
 
             const encryptResponseB = await axios.post(`${MINI_BACKEND_URL}/encrypt`, {
                 value: b,
                 scheme: numberScheme
-            });
+            }, traced());
 
             const encryptedA = encryptResponseA.data.ciphertext;
             const encryptedB = encryptResponseB.data.ciphertext;
@@ -146,7 +218,7 @@ function App() {
                 a: encryptedA,
                 b: encryptedB,
                 scheme: numberScheme
-            });
+            }, traced());
 
             const encryptedResult = addResponse.data.ciphertext;
 
@@ -154,7 +226,7 @@ function App() {
             const decryptResponse = await axios.post(`${MINI_BACKEND_URL}/decrypt`, {
                 ciphertext: encryptedResult,
                 scheme: numberScheme
-            });
+            }, traced());
 
             setHomDecryptedResult(decryptResponse.data.value);
         } catch (err) {
@@ -0,0 +1,33 @@
+// Browser-side packed encryption with the he-wasm module (backend/scripts/build-wasm.sh
+// copies it to public/wasm). One encryptor per scheme, under mini-backend's public key; a
+// column becomes a few packed ciphertexts instead of one /encrypt request per value.
+// Resolves to null when the module has not been built, so callers fall back to the server.
+import axios from 'axios';
+
+let modulePromise = null;
+const encryptors = new Map();
+
+function loadModule() {
+    if (!modulePromise) {
+        const url = `${import.meta.env.BASE_URL}wasm/he-wasm.js`;
+        modulePromise = import(/* @vite-ignore */ url)
+            .then((exports) => exports.default())
+            .catch(() => null);
+    }
+    return modulePromise;
+}
+
+export async function getEncryptor(miniBackendUrl, scheme) {
+    if (!encryptors.has(scheme)) {
+        encryptors.set(scheme, (async () => {
+            const module = await loadModule();
+            if (!module) return null;
+            const { data } = await axios.get(`${miniBackendUrl}/public_key`, { params: { scheme } });
+            return new module.Encryptor(scheme, data.public_key, '');
+        })().catch((err) => {
+            encryptors.delete(scheme);  // Retry with the next action (e.g. backend restarted)
+            throw err;
+        }));
+    }
+    return encryptors.get(scheme);
+}
@@ -0,0 +1,12 @@
+// W3C trace context for one user action: every request it makes carries the same
+// trace ID (each with a fresh parent span ID), so the spans both backends export
+// line up under one trace. The sampled flag asks the backends to record it; they
+// still cap how many traces per second they keep.
+const randomHex = (bytes) =>
+    Array.from(crypto.getRandomValues(new Uint8Array(bytes)), (b) => b.toString(16).padStart(2, '0')).join('');
+
+// Returns a function giving the axios request config for the next request of the action
+export function startTrace() {
+    const traceId = randomHex(16);
+    return () => ({ headers: { traceparent: `00-${traceId}-${randomHex(8)}-01` } });
+}
@@ -0,0 +1,77 @@
+/**
+ * SEAL contexts for the parameters the clients encrypt with, and the sum
+ * over them
+ *
+ * Shared by the server (index.js) and its sum workers (sum-worker.js), each of
+ * which loads its own node-seal instance: ciphertexts move between them as
+ * bytes and are only valid under identical parameters. native.js passes the
+ * same parameters to the native engine.
+ */
+
+/**
+ * Create the BFV and CKKS contexts and their evaluators
+ *
+ * - BFV: For exact integer arithmetic on encrypted data
+ * - CKKS: For approximate floating-point arithmetic on encrypted data
+ *
+ * Parameters chosen for balance between security and performance:
+ * - Polynomial modulus degree: 4096 (provides good security/performance tradeoff)
+ * - Coefficient modulus: Custom bit sizes for optimal noise management
+ * - Security level: TC128 (128-bit security standard)
+ *
+ * @param {Object} seal - node-seal library instance
+ * @returns {Object} { bfv: { context, evaluator }, ckks: { context, evaluator } }
+ */
+export function createContexts(seal) {
+  // ==================== BFV Scheme Setup ====================
+  // BFV is used for exact integer computations on encrypted data
+  const bfvParms = seal.EncryptionParameters(seal.SchemeType.bfv);
+
+  // Set polynomial modulus degree (higher = more security but slower)
+  bfvParms.setPolyModulusDegree(4096);
+
+  // Set coefficient modulus chain for noise management
+  // Bit sizes: [36, 36, 37] provide good balance for 4096-degree polynomial
+  bfvParms.setCoeffModulus(
+    seal.CoeffModulus.Create(4096, Int32Array.from([36, 36, 37])),
+  );
+
+  // Set plaintext modulus for batching (enables SIMD operations)
+  // Batching allows packing multiple values into single ciphertext
+  bfvParms.setPlainModulus(seal.PlainModulus.Batching(4096, 20));
+
+  // Create BFV context with parameter validation and 128-bit security
+  const bfvContext = seal.Context(bfvParms, true, seal.SecurityLevel.tc128);
+
+  // ==================== CKKS Scheme Setup ====================
+  // CKKS is used for approximate floating-point computations on encrypted data
+  const ckksParms = seal.EncryptionParameters(seal.SchemeType.ckks);
+
+  // Same polynomial degree for consistency
+  ckksParms.setPolyModulusDegree(4096);
+
+  // CKKS uses same coefficient modulus structure as BFV
+  ckksParms.setCoeffModulus(
+    seal.CoeffModulus.Create(4096, Int32Array.from([36, 36, 37])),
+  );
+
+  // Create CKKS context (no plaintext modulus needed for CKKS)
+  const ckksContext = seal.Context(ckksParms, true, seal.SecurityLevel.tc128);
+
+  return {
+    bfv: { context: bfvContext, evaluator: seal.Evaluator(bfvContext) },
+    ckks: { context: ckksContext, evaluator: seal.Evaluator(ckksContext) },
+  };
+}
+
+/**
+ * Sum ciphertexts with node-seal, adding into the first one in place
+ * rather than allocating a new CipherText per step
+ */
+export function sumCiphertexts(evaluator, ciphertexts) {
+  const result = ciphertexts[0];
+  for (let i = 1; i < ciphertexts.length; i++) {
+    evaluator.add(result, ciphertexts[i], result);
+  }
+  return result;
+}
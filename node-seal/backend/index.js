@@ -7,7 +7,8 @@
  * 
  * Key Features:
  * - Encrypted arithmetic operations (addition, etc.)
- * - Dataset calculations on encrypted values (sum, average, min, max)
+ * - Dataset calculations on encrypted values (sum, average, min, max), with sums
+ *   on worker threads (workers.js) or the native engine (native.js)
  * - Performance benchmarking for different value sizes and parameters
  * - Support for both BFV (integer) and CKKS (floating-point) schemes
  * 
@@ -19,6 +20,9 @@ import express, { json } from "express";
 import cors from "cors";
 import SEAL from "node-seal";
 import { log } from "./logger.js";
+import { createNativeEngine } from "./native.js";
+import { createContexts, sumCiphertexts } from "./contexts.js";
+import { createSumPool } from "./workers.js";
 
 // Initialize Express application with necessary middleware
 const app = express();
@@ -43,61 +47,28 @@ let seal;                  // Main SEAL library instance
 let bfvContext, ckksContext;   // Encryption contexts for BFV and CKKS schemes
 let bfvEvaluator, ckksEvaluator; // Evaluators for homomorphic operations
 
+// microsoft-seal's native engine for additions and sums (null without the addon, see native.js)
+const nativeEngines = {
+  bfv: createNativeEngine("bfv"),
+  ckks: createNativeEngine("ckks"),
+};
+
+// Worker threads for node-seal sums when the native engine is not built (null for SEAL_WORKERS=0)
+const sumPool = nativeEngines.bfv ? null : createSumPool();
+
 /**
  * Initialize SEAL library and encryption schemes
  * 
- * Sets up both BFV and CKKS encryption contexts with optimal parameters:
- * - BFV: For exact integer arithmetic on encrypted data
- * - CKKS: For approximate floating-point arithmetic on encrypted data
- * 
- * Parameters chosen for balance between security and performance:
- * - Polynomial modulus degree: 4096 (provides good security/performance tradeoff)
- * - Coefficient modulus: Custom bit sizes for optimal noise management
- * - Security level: TC128 (128-bit security standard)
+ * Sets up both BFV and CKKS encryption contexts (see contexts.js)
  */
 (async () => {
   try {
     // Initialize the SEAL library
     seal = await SEAL();
 
-    // ==================== BFV Scheme Setup ====================
-    // BFV is used for exact integer computations on encrypted data
-    const bfvSchemeType = seal.SchemeType.bfv;
-    const bfvParms = seal.EncryptionParameters(bfvSchemeType);
-    
-    // Set polynomial modulus degree (higher = more security but slower)
-    bfvParms.setPolyModulusDegree(4096);
-    
-    // Set coefficient modulus chain for noise management
-    // Bit sizes: [36, 36, 37] provide good balance for 4096-degree polynomial
-    bfvParms.setCoeffModulus(
-      seal.CoeffModulus.Create(4096, Int32Array.from([36, 36, 37])),
-    );
-    
-    // Set plaintext modulus for batching (enables SIMD operations)
-    // Batching allows packing multiple values into single ciphertext
-    bfvParms.setPlainModulus(seal.PlainModulus.Batching(4096, 20));
-    
-    // Create BFV context with parameter validation and 128-bit security
-    bfvContext = seal.Context(bfvParms, true, seal.SecurityLevel.tc128);
-    bfvEvaluator = seal.Evaluator(bfvContext);
-
-    // ==================== CKKS Scheme Setup ====================
-    // CKKS is used for approximate floating-point computations on encrypted data
-    const ckksSchemeType = seal.SchemeType.ckks;
-    const ckksParms = seal.EncryptionParameters(ckksSchemeType);
-    
-    // Same polynomial degree for consistency
-    ckksParms.setPolyModulusDegree(4096);
-    
-    // CKKS uses same coefficient modulus structure as BFV
-    ckksParms.setCoeffModulus(
-      seal.CoeffModulus.Create(4096, Int32Array.from([36, 36, 37])),
-    );
-    
-    // Create CKKS context (no plaintext modulus needed for CKKS)
-    ckksContext = seal.Context(ckksParms, true, seal.SecurityLevel.tc128);
-    ckksEvaluator = seal.Evaluator(ckksContext);
+    const contexts = createContexts(seal);
+    ({ context: bfvContext, evaluator: bfvEvaluator } = contexts.bfv);
+    ({ context: ckksContext, evaluator: ckksEvaluator } = contexts.ckks);
 
     log("Startup", "SEAL initialized on server with both BFV and CKKS schemes");
   } catch (err) {
@@ -163,34 +134,39 @@ app.post("/api/demo/addition", (req, res) => {
     // Create encryptor with client's public key (though not used in this operation)
     const encryptor = seal.Encryptor(context, publicKey);
 
-    // Create ciphertext objects to hold the encrypted operands
-    const cipher1 = seal.CipherText();
-    const cipher2 = seal.CipherText();
+    const computeStart = Date.now();
+    let encryptedResult;
+    if (nativeEngines[schemeType]) {
+      // Native engine: the Base64 ciphertexts go straight to C++ and back
+      encryptedResult = nativeEngines[schemeType].add(cipher1Base64, cipher2Base64);
+    } else {
+      // Create ciphertext objects to hold the encrypted operands
+      const cipher1 = seal.CipherText();
+      const cipher2 = seal.CipherText();
+
+      try {
+        // Load the encrypted values from base64-encoded strings
+        cipher1.load(context, cipher1Base64);
+        cipher2.load(context, cipher2Base64);
+      } catch (err) {
+        throw new Error(`Failed to load ciphertexts: ${err.message}`);
+      }
 
-    try {
-      // Load the encrypted values from base64-encoded strings
-      cipher1.load(context, cipher1Base64);
-      cipher2.load(context, cipher2Base64);
-    } catch (err) {
-      throw new Error(`Failed to load ciphertexts: ${err.message}`);
-    }
+      log("Add", `Ciphertexts loaded successfully for ${schemeType} scheme`);
 
-    log("Add", `Ciphertexts loaded successfully for ${schemeType} scheme`);
+      // This is the key operation: adding encrypted values without decryption!
+      const result = seal.CipherText();
+      evaluator.add(cipher1, cipher2, result);
+      encryptedResult = result.save(); // Serialize result to base64
+    }
 
-    // Perform the homomorphic addition
-    const result = seal.CipherText();
-    const computeStart = Date.now();
-    
-    // This is the key operation: adding encrypted values without decryption!
-    evaluator.add(cipher1, cipher2, result);
-    
     timings.serverProcessing = Date.now() - computeStart;
     log("Add", "Homomorphic addition performed");
 
     // Prepare response with encrypted result and timing data
     const responseStart = Date.now();
     const response = {
-      encryptedResult: result.save(), // Serialize result to base64
+      encryptedResult,
       timings: {
         ...timings,
         serverResponse: Date.now() - responseStart,
@@ -229,7 +205,7 @@ app.post("/api/demo/addition", (req, res) => {
  * @returns {string} encryptedResult - Base64 encoded encrypted calculation result
  * @returns {Object} timings - Performance metrics for the operation
  */
-app.post("/api/demo/dataset", (req, res) => {
+app.post("/api/demo/dataset", async (req, res) => {
   const start = Date.now();
   log("Dataset", "Received dataset calculation request");
 
@@ -260,6 +236,25 @@ app.post("/api/demo/dataset", (req, res) => {
     // Create encryptor with client's public key
     const encryptor = seal.Encryptor(context, publicKey);
 
+    // Sums and averages on the native engine: one pass in C++, split across its
+    // threads, off the event loop
+    const nativeEngine = nativeEngines[schemeType];
+    if (nativeEngine && (calculationType === "sum" || calculationType === "average")) {
+      const encryptedResult = await nativeEngine.sum(encryptedValues);
+      const duration = Date.now() - start;
+      log("Dataset", `${calculationType} calculation completed natively in ${duration}ms`);
+      return res.json({ encryptedResult, timings: { serverProcessing: duration } });
+    }
+
+    // Otherwise on the worker threads, split and tree-combined, with the
+    // event loop left to I/O
+    if (sumPool && sumPool.size > 0 && (calculationType === "sum" || calculationType === "average")) {
+      const encryptedResult = await sumPool.sum(schemeType, encryptedValues);
+      const duration = Date.now() - start;
+      log("Dataset", `${calculationType} calculation completed on ${sumPool.size} workers in ${duration}ms`);
+      return res.json({ encryptedResult, timings: { serverProcessing: duration } });
+    }
+
     // Load all encrypted values from the dataset
     // Each value is deserialized from base64 into a SEAL ciphertext object
     const ciphertexts = encryptedValues.map((base64) => {
@@ -278,23 +273,14 @@ app.post("/api/demo/dataset", (req, res) => {
     switch (calculationType) {
       case "sum":
         // Sum all encrypted values using homomorphic addition
-        // Note: reduce() performs sequential additions on encrypted data
-        result = ciphertexts.reduce((acc, cipher) => {
-          const temp = seal.CipherText();
-          evaluator.add(acc, cipher, temp);
-          return temp;
-        });
+        result = sumCiphertexts(evaluator, ciphertexts);
         break;
 
       case "average":
         // For average calculation, we compute the sum first
         // The frontend will handle division by count (or use scalar multiplication)
         // Note: Division by plaintext is more efficient than division by ciphertext
-        result = ciphertexts.reduce((acc, cipher) => {
-          const temp = seal.CipherText();
-          evaluator.add(acc, cipher, temp);
-          return temp;
-        });
+        result = sumCiphertexts(evaluator, ciphertexts);
         break;
 
       case "min":
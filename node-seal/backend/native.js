@@ -0,0 +1,48 @@
+/**
+ * Native engine loader
+ *
+ * Loads the he_native addon (native/, built with `npm run build:native`),
+ * which runs additions and sums on microsoft-seal's C++ HomomorphicEncryption
+ * engine instead of node-seal's WASM build. Exports null when the addon has
+ * not been built, so callers fall back to node-seal.
+ */
+
+import { createRequire } from "module";
+import { cpus } from "os";
+import { log } from "./logger.js";
+
+const require = createRequire(import.meta.url);
+
+// Single-config generators (make, Ninja) build into native/build, multi-config ones (MSVC) below it
+const ADDON_PATHS = ["./native/build/he_native.node", "./native/build/Release/he_native.node"];
+
+function load() {
+  for (const path of ADDON_PATHS) {
+    try {
+      return require(path);
+    } catch (err) {
+      if (err.code !== "MODULE_NOT_FOUND") {
+        log("Error", `Failed to load native engine ${path}: ${err.message}`);
+      }
+    }
+  }
+  log("Startup", "Native engine not built (npm run build:native), using node-seal");
+  return null;
+}
+
+const addon = load();
+
+/**
+ * Engine for the parameters the clients encrypt with (see the SEAL setup in index.js)
+ * @param {string} schemeType - "bfv" or "ckks"
+ * @returns {Object|null} Engine with add(a, b) and async sum(ciphertexts), or null
+ */
+export function createNativeEngine(schemeType) {
+  if (!addon) return null;
+  return new addon.Engine(schemeType, {
+    polyModulusDegree: 4096,
+    coeffModulusBits: [36, 36, 37],
+    plainModulusBits: 20,
+    threads: cpus().length,
+  });
+}
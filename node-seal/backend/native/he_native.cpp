@@ -0,0 +1,331 @@
+/**
+ * he_native.cpp
+ *
+ * N-API addon exposing microsoft-seal's C++ HomomorphicEncryption engine to
+ * the Node backend (see native.js), in place of node-seal's WASM evaluator:
+ *
+ *   const engine = new Engine("bfv", { polyModulusDegree: 4096, coeffModulusBits: [36, 36, 37],
+ *                                      plainModulusBits: 20, threads: 8 });
+ *   engine.add(a, b)              // Synchronous; strings are Base64, Buffers raw SEAL bytes
+ *   await engine.sum(ciphertexts) // On a libuv worker, split across the engine's threads
+ *
+ * Results come back in the encoding of the (first) input, so a client that
+ * sends Buffers (node-seal's saveArray) skips Base64 both ways. The engine
+ * holds no keys: addition needs none, and the parameters must match the
+ * client's exactly for its ciphertexts to load.
+ */
+
+#include "HomomorphicEncryption.h"
+#include "ParameterProfile.h"
+#include "ThreadPool.h"
+#include <node_api.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Throws std::runtime_error for a failed N-API call, which the entry points turn into a JS error
+    void check(napi_env env, napi_status status) {
+        if (status == napi_ok) return;
+        const napi_extended_error_info* info = nullptr;
+        napi_get_last_error_info(env, &info);
+        throw std::runtime_error(info && info->error_message ? info->error_message : "N-API call failed");
+    }
+
+    // Run an entry point, turning C++ exceptions into a pending JS exception
+    template <typename F>
+    napi_value guarded(napi_env env, F&& body) {
+        try {
+            return body();
+        } catch (const std::exception& e) {
+            napi_throw_error(env, nullptr, e.what());
+            return nullptr;
+        }
+    }
+
+    std::string to_string(napi_env env, napi_value value) {
+        size_t length = 0;
+        check(env, napi_get_value_string_utf8(env, value, nullptr, 0, &length));
+        std::string result(length, '\0');
+        check(env, napi_get_value_string_utf8(env, value, result.data(), length + 1, &length));
+        return result;
+    }
+
+    bool is_buffer(napi_env env, napi_value value) {
+        bool result = false;
+        check(env, napi_is_buffer(env, value, &result));
+        return result;
+    }
+
+    // Optional property of an options object
+    napi_value property(napi_env env, napi_value object, const char* name) {
+        napi_valuetype type = napi_undefined;
+        if (object) check(env, napi_typeof(env, object, &type));
+        if (type != napi_object) return nullptr;
+        bool has = false;
+        check(env, napi_has_named_property(env, object, name, &has));
+        if (!has) return nullptr;
+        napi_value value;
+        check(env, napi_get_named_property(env, object, name, &value));
+        return value;
+    }
+
+    size_t to_size(napi_env env, napi_value value) {
+        double number = 0;
+        check(env, napi_get_value_double(env, value, &number));
+        if (number < 0) throw std::invalid_argument("Expected a non-negative number");
+        return static_cast<size_t>(number);
+    }
+
+    /**
+     * Ciphertext operands of one call: Buffers are referenced in place (and kept
+     * alive until the call completes), strings copied out of the JS heap
+     */
+    class Operands {
+    public:
+        Operands(napi_env env, const napi_value* values, size_t count) : env(env) {
+            if (count == 0) throw std::invalid_argument("Expected at least one ciphertext");
+            format = is_buffer(env, values[0]) ? WireFormat::binary : WireFormat::base64;
+            strings.reserve(count);  // Views into them must not move
+            try {
+                add_all(values, count);
+            } catch (...) {
+                for (napi_ref ref : refs) napi_delete_reference(env, ref);
+                throw;
+            }
+        }
+
+        ~Operands() {
+            for (napi_ref ref : refs) napi_delete_reference(env, ref);
+        }
+
+        Operands(const Operands&) = delete;
+        Operands& operator=(const Operands&) = delete;
+
+        WireFormat format;
+        CiphertextViews ciphertexts;
+
+        // A result in the operands' encoding
+        napi_value wrap(const std::string& result) const {
+            napi_value value;
+            if (format == WireFormat::binary) {
+                check(env, napi_create_buffer_copy(env, result.size(), result.data(), nullptr, &value));
+            } else {
+                check(env, napi_create_string_utf8(env, result.data(), result.size(), &value));
+            }
+            return value;
+        }
+
+    private:
+        napi_env env;
+        std::vector<std::string> strings;
+        std::vector<napi_ref> refs;
+
+        void add_all(const napi_value* values, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                if ((format == WireFormat::binary) != is_buffer(env, values[i])) {
+                    throw std::invalid_argument("Ciphertexts must all be Buffers or all Base64 strings");
+                }
+                if (format == WireFormat::binary) {
+                    void* data = nullptr;
+                    size_t length = 0;
+                    check(env, napi_get_buffer_info(env, values[i], &data, &length));
+                    napi_ref ref;
+                    check(env, napi_create_reference(env, values[i], 1, &ref));
+                    refs.push_back(ref);
+                    ciphertexts.emplace_back(static_cast<const char*>(data), length);
+                } else {
+                    strings.push_back(to_string(env, values[i]));
+                    ciphertexts.emplace_back(strings.back());
+                }
+            }
+        }
+    };
+
+    struct Engine {
+        std::unique_ptr<HomomorphicEncryption> he;
+        seal::compr_mode_type compression = seal::Serialization::compr_mode_default;
+    };
+
+    Engine& unwrap(napi_env env, napi_value self) {
+        void* engine = nullptr;
+        check(env, napi_unwrap(env, self, &engine));
+        return *static_cast<Engine*>(engine);
+    }
+
+    // Arguments of a call, at most N; missing ones are nullptr
+    template <size_t N>
+    struct Arguments {
+        napi_value self = nullptr;
+        napi_value values[N] = {};
+        size_t count = N;
+
+        Arguments(napi_env env, napi_callback_info info) {
+            check(env, napi_get_cb_info(env, info, &count, values, &self, nullptr));
+            for (size_t i = count; i < N; i++) values[i] = nullptr;
+        }
+    };
+
+    /**
+     * new Engine(scheme, options)
+     *
+     * options: polyModulusDegree (8192), coeffModulusBits ([50, 30, 30, 50]), plainModulusBits
+     * (20, BFV), scaleBits (40, CKKS), threads (hardware threads), compression ("none", "zlib" or
+     * "zstd"; SEAL's default). The defaults are microsoft-seal's default profile.
+     */
+    napi_value construct(napi_env env, napi_callback_info info) {
+        return guarded(env, [&]() -> napi_value {
+            Arguments<2> args(env, info);
+            if (!args.values[0]) throw std::invalid_argument("Expected a scheme (\"bfv\" or \"ckks\")");
+            const std::string scheme = to_string(env, args.values[0]);
+            if (scheme != "bfv" && scheme != "ckks") throw std::invalid_argument("Unknown scheme: " + scheme);
+            napi_value options = args.values[1];
+
+            ParameterProfile profile = profiles::default_profile();
+            profile.name = "node";
+            if (napi_value degree = property(env, options, "polyModulusDegree")) {
+                profile.poly_modulus_degree = to_size(env, degree);
+            }
+            if (napi_value bits = property(env, options, "coeffModulusBits")) {
+                uint32_t length = 0;
+                check(env, napi_get_array_length(env, bits, &length));
+                profile.coeff_modulus_bits.clear();
+                for (uint32_t i = 0; i < length; i++) {
+                    napi_value element;
+                    check(env, napi_get_element(env, bits, i, &element));
+                    profile.coeff_modulus_bits.push_back(static_cast<int>(to_size(env, element)));
+                }
+            }
+            if (napi_value bits = property(env, options, "plainModulusBits")) {
+                profile.plain_modulus_bits = static_cast<int>(to_size(env, bits));
+            }
+            if (napi_value bits = property(env, options, "scaleBits")) {
+                profile.scale_bits = static_cast<int>(to_size(env, bits));
+            }
+            profile.depth = 0;  // Addition only
+
+            auto engine = std::make_unique<Engine>();
+            engine->he = std::make_unique<HomomorphicEncryption>(scheme == "ckks", false, profile);
+            size_t threads = std::thread::hardware_concurrency();
+            if (napi_value value = property(env, options, "threads")) threads = to_size(env, value);
+            if (threads > 1) engine->he->set_thread_pool(std::make_shared<ThreadPool>(threads));
+            if (napi_value value = property(env, options, "compression")) {
+                engine->compression = parse_compr_mode(to_string(env, value));
+            }
+
+            check(env, napi_wrap(env, args.self, engine.get(), [](napi_env, void* data, void*) {
+                delete static_cast<Engine*>(data);
+            }, nullptr, nullptr));
+            engine.release();
+            return args.self;
+        });
+    }
+
+    // engine.add(a, b): the sum of two ciphertexts
+    napi_value add(napi_env env, napi_callback_info info) {
+        return guarded(env, [&]() -> napi_value {
+            Arguments<2> args(env, info);
+            if (!args.values[1]) throw std::invalid_argument("Expected two ciphertexts");
+            Engine& engine = unwrap(env, args.self);
+            Operands operands(env, args.values, 2);
+            WireOptions wire(operands.format, engine.compression);
+            return operands.wrap(engine.he->add(operands.ciphertexts[0], operands.ciphertexts[1], wire));
+        });
+    }
+
+    // engine.slotCount(): values per packed ciphertext
+    napi_value slot_count(napi_env env, napi_callback_info info) {
+        return guarded(env, [&]() -> napi_value {
+            Arguments<1> args(env, info);
+            napi_value result;
+            check(env, napi_create_double(env, static_cast<double>(unwrap(env, args.self).he->slot_count()), &result));
+            return result;
+        });
+    }
+
+    // State of one engine.sum() between the JS thread and the libuv worker
+    struct SumWork {
+        const Engine* engine = nullptr;
+        napi_ref engine_ref = nullptr;  // Keeps the engine alive while the worker uses it
+        std::unique_ptr<Operands> operands;
+        napi_deferred deferred = nullptr;
+        napi_async_work work = nullptr;
+        std::string result;
+        std::string error;
+    };
+
+    /**
+     * engine.sum(ciphertexts): a Promise of their sum, computed off the JS thread
+     * In one pass over the inputs, without a ciphertext allocated per addition
+     */
+    napi_value sum(napi_env env, napi_callback_info info) {
+        return guarded(env, [&]() -> napi_value {
+            Arguments<1> args(env, info);
+            bool is_array = false;
+            if (args.values[0]) check(env, napi_is_array(env, args.values[0], &is_array));
+            if (!is_array) throw std::invalid_argument("Expected an array of ciphertexts");
+            uint32_t length = 0;
+            check(env, napi_get_array_length(env, args.values[0], &length));
+            std::vector<napi_value> values(length);
+            for (uint32_t i = 0; i < length; i++) check(env, napi_get_element(env, args.values[0], i, &values[i]));
+
+            auto work = std::make_unique<SumWork>();
+            work->engine = &unwrap(env, args.self);
+            work->operands = std::make_unique<Operands>(env, values.data(), values.size());
+            check(env, napi_create_reference(env, args.self, 1, &work->engine_ref));
+            napi_value promise;
+            check(env, napi_create_promise(env, &work->deferred, &promise));
+
+            napi_value name;
+            check(env, napi_create_string_utf8(env, "he_native.sum", NAPI_AUTO_LENGTH, &name));
+            check(env, napi_create_async_work(env, nullptr, name,
+                [](napi_env, void* data) {
+                    auto* work = static_cast<SumWork*>(data);
+                    try {
+                        WireOptions wire(work->operands->format, work->engine->compression);
+                        work->result = work->engine->he->sum(work->operands->ciphertexts, wire);
+                    } catch (const std::exception& e) {
+                        work->error = e.what();
+                    }
+                },
+                [](napi_env env, napi_status, void* data) {
+                    std::unique_ptr<SumWork> work(static_cast<SumWork*>(data));
+                    if (work->error.empty()) {
+                        napi_resolve_deferred(env, work->deferred, work->operands->wrap(work->result));
+                    } else {
+                        napi_value message, error;
+                        napi_create_string_utf8(env, work->error.c_str(), NAPI_AUTO_LENGTH, &message);
+                        napi_create_error(env, nullptr, message, &error);
+                        napi_reject_deferred(env, work->deferred, error);
+                    }
+                    work->operands.reset();
+                    napi_delete_reference(env, work->engine_ref);
+                    napi_delete_async_work(env, work->work);
+                },
+                work.get(), &work->work));
+            check(env, napi_queue_async_work(env, work->work));
+            work.release();
+            return promise;
+        });
+    }
+
+    napi_value init(napi_env env, napi_value exports) {
+        return guarded(env, [&]() -> napi_value {
+            napi_property_descriptor methods[] = {
+                {"add", nullptr, add, nullptr, nullptr, nullptr, napi_default, nullptr},
+                {"sum", nullptr, sum, nullptr, nullptr, nullptr, napi_default, nullptr},
+                {"slotCount", nullptr, slot_count, nullptr, nullptr, nullptr, napi_default, nullptr},
+            };
+            napi_value engine;
+            check(env, napi_define_class(env, "Engine", NAPI_AUTO_LENGTH, construct, nullptr,
+                                         sizeof(methods) / sizeof(methods[0]), methods, &engine));
+            check(env, napi_set_named_property(env, exports, "Engine", engine));
+            return exports;
+        });
+    }
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)
@@ -0,0 +1,40 @@
+/**
+ * Sum worker (see workers.js)
+ *
+ * Loads its own node-seal instance and contexts, then sums the ciphertexts
+ * of each job: { id, schemeType, buffer, offsets }, where buffer is an
+ * ArrayBuffer (transferred, not copied) holding the serialized ciphertexts
+ * back to back and offsets[i] is where the i-th one starts, offsets[n] the
+ * end. The sum goes back serialized, with its buffer transferred too:
+ * { id, buffer } or { id, error }.
+ */
+
+import { parentPort } from "worker_threads";
+import SEAL from "node-seal";
+import { createContexts, sumCiphertexts } from "./contexts.js";
+
+let seal;
+const ready = SEAL().then((library) => {
+  seal = library;
+  return createContexts(seal);
+});
+
+parentPort.on("message", async ({ id, schemeType, buffer, offsets }) => {
+  const ciphertexts = [];
+  try {
+    const { context, evaluator } = (await ready)[schemeType];
+    const bytes = new Uint8Array(buffer);
+    for (let i = 0; i + 1 < offsets.length; i++) {
+      const cipher = seal.CipherText();
+      ciphertexts.push(cipher);
+      cipher.loadArray(context, bytes.subarray(offsets[i], offsets[i + 1]));
+    }
+    // A copy of its own, so transferring it cannot detach node-seal's heap
+    const saved = sumCiphertexts(evaluator, ciphertexts).saveArray().slice();
+    parentPort.postMessage({ id, buffer: saved.buffer }, [saved.buffer]);
+  } catch (err) {
+    parentPort.postMessage({ id, error: err.message || String(err) });
+  } finally {
+    for (const cipher of ciphertexts) cipher.delete();
+  }
+});
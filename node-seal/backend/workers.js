@@ -0,0 +1,153 @@
+/**
+ * Sum worker pool
+ *
+ * Runs node-seal dataset sums on worker_threads (sum-worker.js) instead of
+ * the event loop, so one large sum no longer stalls every other request.
+ * Each worker holds its own node-seal instance and contexts. A sum is split
+ * into one chunk per worker; each chunk is decoded from Base64 straight into
+ * one ArrayBuffer, which is transferred rather than copied. The workers'
+ * partial sums are then added pairwise, again on the workers, level by
+ * level until one is left, so the event loop only decodes and encodes.
+ *
+ * SEAL_WORKERS sets the number of workers (default: one per core; 0 keeps
+ * sums on the event loop).
+ */
+
+import { Worker } from "worker_threads";
+import { cpus } from "os";
+import { log } from "./logger.js";
+
+// Chunks smaller than this are not worth a round trip to a worker
+const MIN_CHUNK = 16;
+
+/**
+ * Serialized ciphertexts (Base64 strings or byte arrays) back to back in
+ * one ArrayBuffer
+ * @returns {Object} { buffer, offsets }, offsets[i] the start of the i-th, offsets[n] the end
+ */
+function pack(items) {
+  let total = 0;
+  for (const item of items) {
+    total += typeof item === "string" ? Buffer.byteLength(item, "base64") : item.byteLength;
+  }
+  const buffer = new ArrayBuffer(total);
+  const bytes = Buffer.from(buffer);
+  const offsets = [0];
+  for (const item of items) {
+    const start = offsets[offsets.length - 1];
+    if (typeof item === "string") {
+      offsets.push(start + bytes.write(item, start, "base64"));
+    } else {
+      bytes.set(item, start);
+      offsets.push(start + item.byteLength);
+    }
+  }
+  return { buffer, offsets };
+}
+
+class SumPool {
+  constructor(size) {
+    this.idle = [];
+    this.queue = [];
+    this.jobs = new Map();
+    this.nextId = 0;
+    this.workers = new Set();
+    for (let i = 0; i < size; i++) this.spawn();
+  }
+
+  get size() {
+    return this.workers.size;
+  }
+
+  spawn() {
+    const worker = new Worker(new URL("./sum-worker.js", import.meta.url));
+    worker.served = false;
+    worker.on("message", ({ id, buffer, error }) => {
+      const job = this.jobs.get(id);
+      this.jobs.delete(id);
+      worker.job = undefined;
+      worker.served = true;
+      this.idle.push(worker);
+      this.dispatch();
+      if (error) job.reject(new Error(error));
+      else job.resolve(new Uint8Array(buffer));
+    });
+    worker.on("error", (err) => log("Error", `Sum worker failed: ${err.message}`));
+    worker.on("exit", () => {
+      this.workers.delete(worker);
+      this.idle = this.idle.filter((w) => w !== worker);
+      if (worker.job !== undefined) {
+        this.jobs.get(worker.job).reject(new Error("Sum worker exited"));
+        this.jobs.delete(worker.job);
+      }
+      // A worker that never served (e.g. node-seal failed to load) would fail again
+      if (worker.served) {
+        this.spawn();
+      } else if (this.workers.size === 0) {
+        log("Error", "No sum workers left, summing on the event loop");
+        for (const job of this.queue.splice(0)) job.reject(new Error("No sum workers"));
+      }
+    });
+    this.workers.add(worker);
+    this.idle.push(worker);
+  }
+
+  dispatch() {
+    while (this.idle.length > 0 && this.queue.length > 0) {
+      const worker = this.idle.pop();
+      const job = this.queue.shift();
+      this.jobs.set(job.id, job);
+      worker.job = job.id;
+      worker.postMessage(job.message, [job.message.buffer]);
+    }
+  }
+
+  /**
+   * Sum of serialized ciphertexts on one worker
+   * @returns {Promise<Uint8Array>} The serialized sum
+   */
+  sumChunk(schemeType, items) {
+    return new Promise((resolve, reject) => {
+      const id = this.nextId++;
+      this.queue.push({ id, message: { id, schemeType, ...pack(items) }, resolve, reject });
+      this.dispatch();
+    });
+  }
+
+  /**
+   * Sum of Base64 ciphertexts, split across the workers and combined as a tree
+   * @returns {Promise<string>} The Base64 sum
+   */
+  async sum(schemeType, encryptedValues) {
+    if (!encryptedValues || encryptedValues.length === 0) {
+      throw new Error("No encrypted values to sum");
+    }
+    const chunkCount = Math.max(1, Math.min(this.size, Math.floor(encryptedValues.length / MIN_CHUNK)));
+    const chunkSize = Math.ceil(encryptedValues.length / chunkCount);
+    const chunks = [];
+    for (let i = 0; i < encryptedValues.length; i += chunkSize) {
+      chunks.push(encryptedValues.slice(i, i + chunkSize));
+    }
+
+    let partials = await Promise.all(chunks.map((chunk) => this.sumChunk(schemeType, chunk)));
+    while (partials.length > 1) {
+      const next = [];
+      for (let i = 0; i < partials.length; i += 2) {
+        next.push(i + 1 < partials.length ? this.sumChunk(schemeType, [partials[i], partials[i + 1]]) : partials[i]);
+      }
+      partials = await Promise.all(next);
+    }
+    return Buffer.from(partials[0].buffer, partials[0].byteOffset, partials[0].byteLength).toString("base64");
+  }
+}
+
+/**
+ * Pool of SEAL_WORKERS sum workers
+ * @returns {SumPool|null} Pool with async sum(schemeType, encryptedValues), or null for SEAL_WORKERS=0
+ */
+export function createSumPool() {
+  const size = process.env.SEAL_WORKERS !== undefined ? parseInt(process.env.SEAL_WORKERS, 10) : cpus().length;
+  if (!(size > 0)) return null;
+  log("Startup", `Summing on ${size} worker threads`);
+  return new SumPool(size);
+}